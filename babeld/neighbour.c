@@ -67,6 +67,7 @@ flush_neighbour(struct neighbour *neigh)
     if(unicast_neighbour == neigh)
         flush_unicast(1);
     flush_resends(neigh);
+    neigh_routes_fini(&neigh->routes);
 
     if(neighs == neigh) {
         neighs = neigh->next;
@@ -112,6 +113,7 @@ find_neighbour(const unsigned char *address, struct interface *ifp)
     neigh->rtt = 0;
     neigh->rtt_time = zero;
     neigh->ifp = ifp;
+    neigh_routes_init(&neigh->routes);
     neigh->next = neighs;
     neighs = neigh;
     send_hello(ifp);
@@ -23,6 +23,11 @@ THE SOFTWARE.
 #ifndef BABEL_NEIGHBOUR_H
 #define BABEL_NEIGHBOUR_H
 
+#include "typesafe.h"
+
+/* routes learnt from a neighbour, see route.h */
+PREDECL_DLIST(neigh_routes);
+
 struct neighbour {
     struct neighbour *next;
     /* This is -1 when unknown, so don't make it unsigned */
@@ -42,6 +47,7 @@ struct neighbour {
     unsigned int rtt;
     struct timeval rtt_time;
     struct interface *ifp;
+    struct neigh_routes_head routes;
 };
 
 extern struct neighbour *neighs;
@@ -35,6 +35,7 @@ THE SOFTWARE.
 #include "babel_main.h"
 #include "babeld.h"
 #include "util.h"
+#include "jhash.h"
 #include "neighbour.h"
 #include "resend.h"
 #include "message.h"
@@ -43,14 +44,29 @@ THE SOFTWARE.
 struct timeval resend_time = {0, 0};
 struct resend *to_resend = NULL;
 
+/* to_resend is walked on every resend tick, lookups go through a hash so
+   that a storm of updates and requests doesn't scan it each time. */
 static int
-resend_match(struct resend *resend,
-             int kind, const unsigned char *prefix, unsigned char plen)
+resend_cmp(const struct resend *r1, const struct resend *r2)
 {
-    return (resend->kind == kind &&
-            resend->plen == plen && memcmp(resend->prefix, prefix, 16) == 0);
+    if(r1->kind != r2->kind)
+        return r1->kind < r2->kind ? -1 : 1;
+    if(r1->plen != r2->plen)
+        return r1->plen < r2->plen ? -1 : 1;
+    return memcmp(r1->prefix, r2->prefix, 16);
 }
 
+static uint32_t
+resend_hash_key(const struct resend *resend)
+{
+    return jhash(resend->prefix, 16, (resend->kind << 8) | resend->plen);
+}
+
+DECLARE_HASH(resend_hash, struct resend, hash_item, resend_cmp,
+             resend_hash_key);
+
+static struct resend_hash_head resends = INIT_HASH(resends);
+
 /* This is called by neigh.c when a neighbour is flushed */
 
 void
@@ -60,31 +76,20 @@ flush_resends(struct neighbour *neigh)
 }
 
 static struct resend *
-find_resend(int kind, const unsigned char *prefix, unsigned char plen,
-             struct resend **previous_return)
+find_resend(int kind, const unsigned char *prefix, unsigned char plen)
 {
-    struct resend *current, *previous;
-
-    previous = NULL;
-    current = to_resend;
-    while(current) {
-        if(resend_match(current, kind, prefix, plen)) {
-            if(previous_return)
-                *previous_return = previous;
-            return current;
-        }
-        previous = current;
-        current = current->next;
-    }
+    struct resend ref;
 
-    return NULL;
+    ref.kind = kind;
+    memcpy(ref.prefix, prefix, 16);
+    ref.plen = plen;
+    return resend_hash_find(&resends, &ref);
 }
 
 struct resend *
-find_request(const unsigned char *prefix, unsigned char plen,
-             struct resend **previous_return)
+find_request(const unsigned char *prefix, unsigned char plen)
 {
-    return find_resend(RESEND_REQUEST, prefix, plen, previous_return);
+    return find_resend(RESEND_REQUEST, prefix, plen);
 }
 
 int
@@ -104,7 +109,7 @@ record_resend(int kind, const unsigned char *prefix, unsigned char plen,
     if(delay >= 0xFFFF)
         delay = 0xFFFF;
 
-    resend = find_resend(kind, prefix, plen, NULL);
+    resend = find_resend(kind, prefix, plen);
     if(resend) {
         if(resend->delay && delay)
             resend->delay = MIN(resend->delay, delay);
@@ -141,6 +146,7 @@ record_resend(int kind, const unsigned char *prefix, unsigned char plen,
         resend->time = babel_now;
         resend->next = to_resend;
         to_resend = resend;
+        resend_hash_add(&resends, resend);
     }
 
     if(resend->delay) {
@@ -168,7 +174,7 @@ unsatisfied_request(const unsigned char *prefix, unsigned char plen,
 {
     struct resend *request;
 
-    request = find_request(prefix, plen, NULL);
+    request = find_request(prefix, plen);
     if(request == NULL || resend_expired(request))
         return 0;
 
@@ -187,7 +193,7 @@ request_redundant(struct interface *ifp,
 {
     struct resend *request;
 
-    request = find_request(prefix, plen, NULL);
+    request = find_request(prefix, plen);
     if(request == NULL || resend_expired(request))
         return 0;
 
@@ -215,9 +221,9 @@ satisfy_request(const unsigned char *prefix, unsigned char plen,
                 unsigned short seqno, const unsigned char *id,
                 struct interface *ifp)
 {
-    struct resend *request, *previous;
+    struct resend *request;
 
-    request = find_request(prefix, plen, &previous);
+    request = find_request(prefix, plen);
     if(request == NULL)
         return 0;
 
@@ -227,10 +233,12 @@ satisfy_request(const unsigned char *prefix, unsigned char plen,
     if(memcmp(request->id, id, 8) != 0 ||
        seqno_compare(request->seqno, seqno) <= 0) {
         /* We cannot remove the request, as we may be walking the list right
-           now.  Mark it as expired, so that expire_resend will remove it. */
+           now.  Mark it as expired, so that expire_resend will remove it.
+           resend_time is not recomputed here, that would walk the list for
+           every satisfied request: at worst do_resend runs early and
+           recomputes it. */
         request->max = 0;
         request->time.tv_sec = 0;
-        recompute_resend_time();
         return 1;
     }
 
@@ -247,6 +255,7 @@ expire_resend(void)
     current = to_resend;
     while(current) {
         if(resend_expired(current)) {
+            resend_hash_del(&resends, current);
             if(previous == NULL) {
                 to_resend = current->next;
                 free(current);
@@ -22,12 +22,16 @@ THE SOFTWARE.
 #ifndef BABEL_RESEND_H
 #define BABEL_RESEND_H
 
+#include "typesafe.h"
+
 #define REQUEST_TIMEOUT 65000
 #define RESEND_MAX 3
 
 #define RESEND_REQUEST 1
 #define RESEND_UPDATE 2
 
+PREDECL_HASH(resend_hash);
+
 struct resend {
     unsigned char kind;
     unsigned char max;
@@ -39,12 +43,12 @@ struct resend {
     unsigned char id[8];
     struct interface *ifp;
     struct resend *next;
+    struct resend_hash_item hash_item;
 };
 
 extern struct timeval resend_time;
 
-struct resend *find_request(const unsigned char *prefix, unsigned char plen,
-                            struct resend **previous_return);
+struct resend *find_request(const unsigned char *prefix, unsigned char plen);
 void flush_resends(struct neighbour *neigh);
 int record_resend(int kind, const unsigned char *prefix, unsigned char plen,
                    unsigned short seqno, const unsigned char *id,
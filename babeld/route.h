@@ -25,6 +25,7 @@ THE SOFTWARE.
 #define BABEL_ROUTE_H
 
 #include "babel_interface.h"
+#include "neighbour.h"
 #include "source.h"
 
 enum babel_diversity {
@@ -51,11 +52,13 @@ struct babel_route {
     short installed;
     unsigned char channels[DIVERSITY_HOPS];
     struct babel_route *next;
+    struct neigh_routes_item neigh_item;
 };
 
+DECLARE_DLIST(neigh_routes, struct babel_route, neigh_item);
+
 struct route_stream;
 
-extern struct babel_route **routes;
 extern int kernel_metric;
 extern enum babel_diversity diversity_kind;
 extern int diversity_factor;
@@ -32,31 +32,47 @@ THE SOFTWARE.
 #include "babel_main.h"
 #include "babeld.h"
 #include "util.h"
+#include "jhash.h"
 #include "source.h"
 #include "babel_interface.h"
 #include "route.h"
 #include "babel_errors.h"
 
-struct source *srcs = NULL;
+static int
+source_cmp(const struct source *s1, const struct source *s2)
+{
+    int i = memcmp(s1->id, s2->id, 8);
+    if(i != 0)
+        return i;
+    if(s1->plen != s2->plen)
+        return s1->plen < s2->plen ? -1 : 1;
+    return memcmp(s1->prefix, s2->prefix, 16);
+}
+
+static uint32_t
+source_hash_key(const struct source *src)
+{
+    return jhash(src->prefix, 16, jhash(src->id, 8, src->plen));
+}
+
+DECLARE_HASH(source_hash, struct source, hash_item, source_cmp,
+             source_hash_key);
+
+static struct source_hash_head srcs = INIT_HASH(srcs);
 
 struct source*
 find_source(const unsigned char *id, const unsigned char *p, unsigned char plen,
             int create, unsigned short seqno)
 {
-    struct source *src;
+    struct source *src, ref;
 
-    for(src = srcs; src; src = src->next) {
-        /* This should really be a hash table.  For now, check the
-           last byte first. */
-        if(src->id[7] != id[7])
-            continue;
-        if(memcmp(src->id, id, 8) != 0)
-            continue;
-        if(src->plen != plen)
-            continue;
-        if(memcmp(src->prefix, p, 16) == 0)
-            return src;
-    }
+    memcpy(ref.id, id, 8);
+    memcpy(ref.prefix, p, 16);
+    ref.plen = plen;
+
+    src = source_hash_find(&srcs, &ref);
+    if(src)
+        return src;
 
     if(!create)
         return NULL;
@@ -74,8 +90,7 @@ find_source(const unsigned char *id, const unsigned char *p, unsigned char plen,
     src->metric = INFINITY;
     src->time = babel_now.tv_sec;
     src->route_count = 0;
-    src->next = srcs;
-    srcs = src;
+    source_hash_add(&srcs, src);
     return src;
 }
 
@@ -101,15 +116,7 @@ flush_source(struct source *src)
         /* The source is in use by a route. */
         return 0;
 
-    if(srcs == src) {
-        srcs = src->next;
-    } else {
-        struct source *previous = srcs;
-        while(previous->next != src)
-            previous = previous->next;
-        previous->next = src->next;
-    }
-
+    source_hash_del(&srcs, src);
     free(src);
     return 1;
 }
@@ -139,18 +146,12 @@ expire_sources(void)
 {
     struct source *src;
 
-    src = srcs;
-    while(src) {
+    frr_each_safe(source_hash, &srcs, src) {
         if(src->time > babel_now.tv_sec)
             /* clock stepped */
             src->time = babel_now.tv_sec;
-        if(src->time < babel_now.tv_sec - SOURCE_GC_TIME) {
-            struct source *old = src;
-            src = src->next;
-            flush_source(old);
-            continue;
-        }
-        src = src->next;
+        if(src->time < babel_now.tv_sec - SOURCE_GC_TIME)
+            flush_source(src);
     }
 }
 
@@ -159,7 +160,7 @@ check_sources_released(void)
 {
     struct source *src;
 
-    for(src = srcs; src; src = src->next) {
+    frr_each(source_hash, &srcs, src) {
         if(src->route_count != 0)
             fprintf(stderr, "Warning: source %s %s has refcount %d.\n",
                     format_eui64(src->id),
@@ -23,10 +23,14 @@ THE SOFTWARE.
 #ifndef BABEL_SOURCE_H
 #define BABEL_SOURCE_H
 
+#include "typesafe.h"
+
 #define SOURCE_GC_TIME 200
 
+PREDECL_HASH(source_hash);
+
 struct source {
-    struct source *next;
+    struct source_hash_item hash_item;
     unsigned char id[8];
     unsigned char prefix[16];
     unsigned char plen;
@@ -36,11 +36,13 @@ DEFINE_MTYPE_STATIC(BFDD, BFDD_CONFIG, "long-lived configuration memory");
 DEFINE_MTYPE_STATIC(BFDD, BFDD_PROFILE, "long-lived profile memory");
 DEFINE_MTYPE_STATIC(BFDD, BFDD_SESSION_OBSERVER, "Session observer");
 DEFINE_MTYPE_STATIC(BFDD, BFDD_VRF, "BFD VRF");
+DEFINE_MTYPE_STATIC(BFDD, BFDD_ID_TABLE, "BFD discriminator table");
 
 /*
  * Prototypes
  */
 static uint32_t ptm_bfd_gen_ID(void);
+static bool bfd_id_index_get(uint32_t *index);
 static void ptm_bfd_echo_xmt_TO(struct bfd_session *bfd);
 static struct bfd_session *bfd_find_disc(struct sockaddr_any *sa,
 					 uint32_t ldisc);
@@ -416,12 +418,22 @@ void bfd_session_disable(struct bfd_session *bs)
 
 static uint32_t ptm_bfd_gen_ID(void)
 {
-	uint32_t session_id;
+	uint32_t session_id, index;
 
 	/*
 	 * RFC 5880, Section 6.8.1. recommends that we should generate
-	 * random session identification numbers.
+	 * random session identification numbers.  The low bits hold a free
+	 * index of the discriminator table, which makes the ID unique.
 	 */
+	if (bfd_id_index_get(&index)) {
+		do {
+			session_id = (frr_weak_random() << BFD_ID_INDEX_BITS)
+				     | index;
+		} while (session_id == 0 || bfd_id_lookup(session_id) != NULL);
+
+		return session_id;
+	}
+
 	do {
 		session_id = ((frr_weak_random() << 16) & 0xFFFF0000)
 			     | (frr_weak_random() & 0x0000FFFF);
@@ -631,13 +643,6 @@ struct bfd_session *ptm_bfd_sess_find(struct bfd_pkt *cp,
 	return bfd_key_lookup(key);
 }
 
-void bfd_xmt_cb(struct thread *t)
-{
-	struct bfd_session *bs = THREAD_ARG(t);
-
-	ptm_bfd_xmt_TO(bs, 0);
-}
-
 void bfd_echo_xmt_cb(struct thread *t)
 {
 	struct bfd_session *bs = THREAD_ARG(t);
@@ -650,6 +655,22 @@ void bfd_echo_xmt_cb(struct thread *t)
 void bfd_recvtimer_cb(struct thread *t)
 {
 	struct bfd_session *bs = THREAD_ARG(t);
+	struct bfd_vrf_global *bvrf;
+
+	if (bfd_recvtimer_extended(bs))
+		return;
+
+	/*
+	 * Under load, packets of this session may still be waiting in the
+	 * socket buffers: handle them before declaring the session down.
+	 * Receiving one restarts the timer.
+	 */
+	bvrf = bfd_vrf_look_by_session(bs);
+	if (bvrf && !bglobal.bg_use_dplane) {
+		bfd_recv_pending(bvrf);
+		if (bs->recvtimer_ev)
+			return;
+	}
 
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
@@ -664,6 +685,9 @@ void bfd_echo_recvtimer_cb(struct thread *t)
 {
 	struct bfd_session *bs = THREAD_ARG(t);
 
+	if (bfd_echo_recvtimer_extended(bs))
+		return;
+
 	switch (bs->ses_state) {
 	case PTM_BFD_INIT:
 	case PTM_BFD_UP:
@@ -1588,6 +1612,44 @@ void bs_to_bpc(struct bfd_session *bs, struct bfd_peer_cfg *bpc)
 static struct hash *bfd_id_hash;
 static struct hash *bfd_key_hash;
 
+/*
+ * Sessions indexed by the low BFD_ID_INDEX_BITS of their discriminator,
+ * so received packets find their session with a single array access.  The
+ * hash above is still used for iteration and for discriminators outside
+ * of the table.
+ */
+static struct bfd_session **bfd_id_table;
+static uint32_t bfd_id_table_size;
+static uint32_t bfd_id_table_next;
+
+static bool bfd_id_index_get(uint32_t *index)
+{
+	uint32_t i, size;
+
+	for (i = 0; i < bfd_id_table_size; i++) {
+		*index = (bfd_id_table_next + i) % bfd_id_table_size;
+		if (bfd_id_table[*index] == NULL) {
+			bfd_id_table_next = *index + 1;
+			return true;
+		}
+	}
+
+	/* Table is full: grow it. */
+	if (bfd_id_table_size > BFD_ID_INDEX_MASK)
+		return false;
+
+	size = bfd_id_table_size ? bfd_id_table_size * 2 : 64;
+	bfd_id_table = XREALLOC(MTYPE_BFDD_ID_TABLE, bfd_id_table,
+				size * sizeof(bfd_id_table[0]));
+	memset(&bfd_id_table[bfd_id_table_size], 0,
+	       (size - bfd_id_table_size) * sizeof(bfd_id_table[0]));
+	*index = bfd_id_table_size;
+	bfd_id_table_next = *index + 1;
+	bfd_id_table_size = size;
+
+	return true;
+}
+
 static unsigned int bfd_id_hash_do(const void *p);
 static unsigned int bfd_key_hash_do(const void *p);
 
@@ -1672,6 +1734,11 @@ static bool bfd_key_hash_cmp(const void *n1, const void *n2)
 struct bfd_session *bfd_id_lookup(uint32_t id)
 {
 	struct bfd_session bs;
+	uint32_t index = id & BFD_ID_INDEX_MASK;
+
+	if (index < bfd_id_table_size && bfd_id_table[index]
+	    && bfd_id_table[index]->discrs.my_discr == id)
+		return bfd_id_table[index];
 
 	bs.discrs.my_discr = id;
 
@@ -1700,6 +1767,11 @@ struct bfd_session *bfd_key_lookup(struct bfd_key key)
 struct bfd_session *bfd_id_delete(uint32_t id)
 {
 	struct bfd_session bs;
+	uint32_t index = id & BFD_ID_INDEX_MASK;
+
+	if (index < bfd_id_table_size && bfd_id_table[index]
+	    && bfd_id_table[index]->discrs.my_discr == id)
+		bfd_id_table[index] = NULL;
 
 	bs.discrs.my_discr = id;
 
@@ -1734,7 +1806,15 @@ void bfd_key_iterate(hash_iter_func hif, void *arg)
  */
 bool bfd_id_insert(struct bfd_session *bs)
 {
-	return (hash_get(bfd_id_hash, bs, hash_alloc_intern) == bs);
+	uint32_t index = bs->discrs.my_discr & BFD_ID_INDEX_MASK;
+
+	if (hash_get(bfd_id_hash, bs, hash_alloc_intern) != bs)
+		return false;
+
+	if (index < bfd_id_table_size && bfd_id_table[index] == NULL)
+		bfd_id_table[index] = bs;
+
+	return true;
 }
 
 bool bfd_key_insert(struct bfd_session *bs)
@@ -1776,6 +1856,8 @@ void bfd_shutdown(void)
 	/* Now free the hashes themselves. */
 	hash_free(bfd_id_hash);
 	hash_free(bfd_key_hash);
+	XFREE(MTYPE_BFDD_ID_TABLE, bfd_id_table);
+	bfd_id_table_size = 0;
 
 	/* Free all profile allocations. */
 	while ((bp = TAILQ_FIRST(&bplist)) != NULL)
@@ -31,6 +31,7 @@
 #include "lib/libfrr.h"
 #include "lib/qobj.h"
 #include "lib/queue.h"
+#include "lib/typesafe.h"
 #include "lib/vrf.h"
 
 #include "bfdctl.h"
@@ -243,6 +244,10 @@ TAILQ_HEAD(bfdproflist, bfd_profile);
 /* bfd_session shortcut label forwarding. */
 struct peer_label;
 
+/* Sessions sharing a transmit timer, see event.c. */
+struct bfd_xmt_bucket;
+PREDECL_DLIST(bfd_xmt_slot);
+
 struct bfd_config_timers {
 	uint32_t desired_min_tx;
 	uint32_t required_min_rx;
@@ -280,9 +285,13 @@ struct bfd_session {
 	uint64_t detect_TO;
 	struct thread *echo_recvtimer_ev;
 	struct thread *recvtimer_ev;
+	/* Detection deadlines, the timers may be scheduled earlier. */
+	struct timeval detect_deadline;
+	struct timeval echo_detect_deadline;
 	uint64_t xmt_TO;
 	uint64_t echo_xmt_TO;
-	struct thread *xmttimer_ev;
+	struct bfd_xmt_bucket *xmt_bucket;
+	struct bfd_xmt_slot_item xmt_item;
 	struct thread *echo_xmttimer_ev;
 	uint64_t echo_detect_TO;
 
@@ -378,6 +387,9 @@ TAILQ_HEAD(obslist, bfd_session_observer);
 #define BFD_DEFDESTPORT 3784
 #define BFD_DEF_ECHO_PORT 3785
 #define BFD_DEF_MHOP_DEST_PORT 4784
+#define BFD_RECV_BURST 32 /* Control packets read per socket wakeup */
+#define BFD_ID_INDEX_BITS 20 /* Discriminator bits indexing the ID table */
+#define BFD_ID_INDEX_MASK ((1U << BFD_ID_INDEX_BITS) - 1)
 
 /*
  * control.c
@@ -567,6 +579,7 @@ void ptm_bfd_echo_snd(struct bfd_session *bfd);
 void ptm_bfd_echo_fp_snd(struct bfd_session *bfd);
 
 void bfd_recv_cb(struct thread *t);
+void bfd_recv_pending(struct bfd_vrf_global *bvrf);
 
 
 /*
@@ -577,6 +590,8 @@ void bfd_recv_cb(struct thread *t);
 typedef void (*bfd_ev_cb)(struct thread *t);
 
 void bfd_recvtimer_update(struct bfd_session *bs);
+bool bfd_recvtimer_extended(struct bfd_session *bs);
+bool bfd_echo_recvtimer_extended(struct bfd_session *bs);
 void bfd_echo_recvtimer_update(struct bfd_session *bs);
 void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter);
 void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter);
@@ -703,7 +718,6 @@ extern struct thread_master *master;
 
 void bfd_recvtimer_cb(struct thread *t);
 void bfd_echo_recvtimer_cb(struct thread *t);
-void bfd_xmt_cb(struct thread *t);
 void bfd_echo_xmt_cb(struct thread *t);
 
 extern struct in6_addr zero_addr;
@@ -838,6 +852,14 @@ int bfd_dplane_delete_session(struct bfd_session *bs);
  */
 int bfd_dplane_update_session_counters(struct bfd_session *bs);
 
+/**
+ * Asks the data planes supporting it for the counters of all sessions in
+ * one request, so `bfd_dplane_update_session_counters` doesn't need to ask
+ * for each session until `bfd_dplane_counters_bulk_end` is called.
+ */
+void bfd_dplane_counters_bulk_begin(void);
+void bfd_dplane_counters_bulk_end(void);
+
 void bfd_dplane_show_counters(struct vty *vty);
 
 #endif /* _BFD_H_ */
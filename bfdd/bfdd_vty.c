@@ -472,16 +472,19 @@ static void _display_peers_counter(struct vty *vty, char *vrfname, bool use_json
 	struct bfd_vrf_tuple bvt = {0};
 
 	bvt.vrfname = vrfname;
+	bfd_dplane_counters_bulk_begin();
 	if (!use_json) {
 		bvt.vty = vty;
 		vty_out(vty, "BFD Peers:\n");
 		bfd_id_iterate(_display_peer_counter_iter, &bvt);
+		bfd_dplane_counters_bulk_end();
 		return;
 	}
 
 	jo = json_object_new_array();
 	bvt.jo = jo;
 	bfd_id_iterate(_display_peer_counter_json_iter, &bvt);
+	bfd_dplane_counters_bulk_end();
 
 	vty_json(vty, jo);
 }
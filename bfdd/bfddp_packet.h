@@ -88,8 +88,25 @@ enum bfddp_message_type {
 	DP_REQUEST_SESSION_COUNTERS = 5,
 	/** Tell BFD daemon about counters values. */
 	BFD_SESSION_COUNTERS = 6,
+
+	/** Tell BFD daemon which optional messages the data plane handles. */
+	BFD_CAPABILITIES = 7,
+	/** Add or update many BFD peer sessions. */
+	DP_ADD_SESSIONS = 8,
+	/** Ask for the counters of all sessions. */
+	DP_REQUEST_ALL_COUNTERS = 9,
+	/** Tell BFD daemon about the counters of many sessions. */
+	BFD_SESSIONS_COUNTERS = 10,
+	/** Tell BFD daemon about the state changes of many sessions. */
+	BFD_STATE_CHANGES = 11,
 };
 
+/**
+ * Maximum length of a message.  Messages carrying many entries must be
+ * split to stay within this length.
+ */
+#define BFD_DP_MAX_MESSAGE_LEN 4096
+
 /**
  * `ECHO_REQUEST`/`ECHO_REPLY` data payload.
  *
@@ -365,6 +382,82 @@ struct bfddp_session_counters {
 	uint64_t echo_output_packets;
 };
 
+/** Optional messages support. \see bfddp_capabilities. */
+enum bfddp_capability_flag {
+	/** Data plane handles `DP_ADD_SESSIONS`. */
+	CAPABILITY_BATCH_SESSIONS = (1 << 0),
+	/** Data plane answers `DP_REQUEST_ALL_COUNTERS`. */
+	CAPABILITY_BULK_COUNTERS = (1 << 1),
+};
+
+/**
+ * Data plane supported optional messages.
+ *
+ * Message type: `BFD_CAPABILITIES`.
+ *
+ * A data plane supporting any of the optional messages sends this as its
+ * first message after connecting.  The BFD daemon waits a short moment for
+ * it before installing the sessions, then falls back to the basic
+ * messages.
+ */
+struct bfddp_capabilities {
+	/** Supported optional messages. \see bfddp_capability_flag. */
+	uint32_t flags;
+};
+
+/**
+ * Batched session programming.
+ *
+ * Message type: `DP_ADD_SESSIONS`.
+ *
+ * Same as `count` `DP_ADD_SESSION` messages.
+ */
+struct bfddp_sessions {
+	/** Amount of sessions. */
+	uint32_t count;
+	/** Sessions to add or update. */
+	struct bfddp_session sessions[];
+};
+
+/** `bfddp_sessions_counters` flags. */
+enum bfddp_sessions_counters_flag {
+	/** Last message answering the request. */
+	COUNTERS_LAST = (1 << 0),
+};
+
+/**
+ * Bulk session counters reply.
+ *
+ * Message type: `BFD_SESSIONS_COUNTERS`.
+ *
+ * `DP_REQUEST_ALL_COUNTERS` is answered by one or more of these messages,
+ * using the request ID; the last one has `COUNTERS_LAST` set.
+ */
+struct bfddp_sessions_counters {
+	/** Amount of sessions. */
+	uint32_t count;
+	/** Flags. \see bfddp_sessions_counters_flag. */
+	uint32_t flags;
+	/** Counters of each session. */
+	struct bfddp_session_counters counters[];
+};
+
+/**
+ * Batched session state changes.
+ *
+ * Message type: `BFD_STATE_CHANGES`.
+ *
+ * Same as `count` `BFD_STATE_CHANGE` messages.  Data planes may use it to
+ * report the changes of many sessions at once (e.g. on link failure),
+ * without being asked to.
+ */
+struct bfddp_state_changes {
+	/** Amount of state changes. */
+	uint32_t count;
+	/** State changes. */
+	struct bfddp_state_change changes[];
+};
+
 /**
  * The protocol wire messages structure.
  */
@@ -380,6 +473,7 @@ struct bfddp_message {
 		struct bfddp_control_packet control;
 		struct bfddp_request_counters counters_req;
 		struct bfddp_session_counters session_counters;
+		struct bfddp_capabilities capabilities;
 	} data;
 };
 
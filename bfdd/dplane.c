@@ -51,6 +51,10 @@ DEFINE_MTYPE_STATIC(BFDD, BFDD_DPLANE_CTX,
 
 /** Data plane client socket buffer size. */
 #define BFD_DPLANE_CLIENT_BUF_SIZE 8192
+/** Data plane client output buffer maximum size (grows when full). */
+#define BFD_DPLANE_CLIENT_OUTBUF_MAX (4 * 1024 * 1024)
+/** Time to wait for `BFD_CAPABILITIES` before installing sessions. */
+#define BFD_DPLANE_CAPABILITIES_WAIT 200 /* milliseconds */
 
 struct bfd_dplane_ctx {
 	/** Client file descriptor. */
@@ -81,6 +85,13 @@ struct bfd_dplane_ctx {
 	struct thread *outbufev;
 	/** Connection event. */
 	struct thread *connectev;
+	/** Session installation event. */
+	struct thread *bootstrapev;
+
+	/** Optional messages supported. \see bfddp_capability_flag. */
+	uint32_t capabilities;
+	/** Session counters were just updated in bulk. */
+	bool counters_valid;
 
 	/** Amount of bytes read. */
 	uint64_t in_bytes;
@@ -112,6 +123,10 @@ static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc);
 static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc);
 static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 				   struct bfd_session *bs);
+static void _bfd_dplane_session_payload_fill(const struct bfd_session *bs,
+					     struct bfddp_session *session);
+static void bfd_dplane_bootstrap_cancel(struct bfd_dplane_ctx *bdc);
+static void bfd_dplane_register_sessions(struct bfd_dplane_ctx *bdc);
 
 /*
  * BFD data plane helper functions.
@@ -133,6 +148,16 @@ static const char *bfd_dplane_messagetype2str(enum bfddp_message_type bmt)
 		return "DP_REQUEST_SESSION_COUNTERS";
 	case BFD_SESSION_COUNTERS:
 		return "BFD_SESSION_COUNTERS";
+	case BFD_CAPABILITIES:
+		return "BFD_CAPABILITIES";
+	case DP_ADD_SESSIONS:
+		return "DP_ADD_SESSIONS";
+	case DP_REQUEST_ALL_COUNTERS:
+		return "DP_REQUEST_ALL_COUNTERS";
+	case BFD_SESSIONS_COUNTERS:
+		return "BFD_SESSIONS_COUNTERS";
+	case BFD_STATE_CHANGES:
+		return "BFD_STATE_CHANGES";
 	default:
 		return "UNKNOWN";
 	}
@@ -258,6 +283,22 @@ static void bfd_dplane_debug_message(const struct bfddp_message *msg)
 			be64toh(msg->data.session_counters
 				.echo_output_packets));
 		break;
+
+	case BFD_CAPABILITIES:
+		zlog_debug("  [flags=0x%08x]",
+			   ntohl(msg->data.capabilities.flags));
+		break;
+
+	case DP_ADD_SESSIONS:
+	case BFD_SESSIONS_COUNTERS:
+	case BFD_STATE_CHANGES:
+		/* All of them start with the amount of entries. */
+		zlog_debug("  [count=%u]", ntohl(*(uint32_t *)&msg->data));
+		break;
+
+	case DP_REQUEST_ALL_COUNTERS:
+		/* NOTHING: no payload. */
+		break;
 	}
 }
 
@@ -421,10 +462,20 @@ static int bfd_dplane_enqueue(struct bfd_dplane_ctx *bdc, const void *buf,
 	if (bdc->client && bdc->sock == -1)
 		return -1;
 
-	/* Not enough space. */
+	/*
+	 * Not enough space: grow the buffer, so installing many sessions at
+	 * once doesn't fail before the socket gets a chance to drain it.
+	 */
 	if (buflen > STREAM_WRITEABLE(bdc->outbuf)) {
-		bdc->out_fullev++;
-		return -1;
+		rlen = MAX(STREAM_SIZE(bdc->outbuf) * 2,
+			   STREAM_READABLE(bdc->outbuf) + buflen);
+		if (rlen > BFD_DPLANE_CLIENT_OUTBUF_MAX) {
+			bdc->out_fullev++;
+			return -1;
+		}
+
+		stream_pulldown(bdc->outbuf);
+		stream_resize_inplace(&bdc->outbuf, rlen);
 	}
 
 	/* Show debug message if active. */
@@ -471,6 +522,35 @@ static void bfd_dplane_echo_request_handle(struct bfd_dplane_ctx *bdc,
 	bfd_dplane_enqueue(bdc, &msg, msglen);
 }
 
+static void bfd_dplane_capabilities_handle(struct bfd_dplane_ctx *bdc,
+					   const struct bfddp_message *bm)
+{
+	bdc->capabilities = ntohl(bm->data.capabilities.flags);
+
+	/* Install the sessions now if we were waiting for this. */
+	if (bdc->bootstrapev) {
+		bfd_dplane_bootstrap_cancel(bdc);
+		bfd_dplane_register_sessions(bdc);
+	}
+}
+
+static void bfd_dplane_state_changes_handle(struct bfd_dplane_ctx *bdc,
+					    const struct bfddp_message *bm)
+{
+	const struct bfddp_state_changes *bsc =
+		(const struct bfddp_state_changes *)&bm->data;
+	size_t len = ntohs(bm->header.length);
+	uint32_t count, i;
+
+	if (len < sizeof(bm->header) + sizeof(*bsc))
+		return;
+
+	len -= sizeof(bm->header) + sizeof(*bsc);
+	count = MIN(ntohl(bsc->count), len / sizeof(bsc->changes[0]));
+	for (i = 0; i < count; i++)
+		bfd_dplane_session_state_change(bdc, &bsc->changes[i]);
+}
+
 static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 {
 	enum bfddp_message_type bmt;
@@ -485,15 +565,24 @@ static void bfd_dplane_handle_message(struct bfddp_message *msg, void *arg)
 	case BFD_STATE_CHANGE:
 		bfd_dplane_session_state_change(bdc, &msg->data.state);
 		break;
+	case BFD_STATE_CHANGES:
+		bfd_dplane_state_changes_handle(bdc, msg);
+		break;
+	case BFD_CAPABILITIES:
+		bfd_dplane_capabilities_handle(bdc, msg);
+		break;
 	case ECHO_REPLY:
 		/* NOTHING: we don't do anything with this information. */
 		break;
 	case DP_ADD_SESSION:
 	case DP_DELETE_SESSION:
 	case DP_REQUEST_SESSION_COUNTERS:
+	case DP_ADD_SESSIONS:
+	case DP_REQUEST_ALL_COUNTERS:
 		/* NOTHING: we are not supposed to receive this. */
 		break;
 	case BFD_SESSION_COUNTERS:
+	case BFD_SESSIONS_COUNTERS:
 		/*
 		 * NOTHING: caller of DP_REQUEST_SESSION_COUNTERS should
 		 * handle this with `bfd_dplane_expect`.
@@ -640,6 +729,119 @@ static void _bfd_session_register_dplane(struct hash_bucket *hb, void *arg)
 	_bfd_dplane_add_session(bdc, bs);
 }
 
+/** Sessions being installed with `DP_ADD_SESSIONS` messages. */
+struct bfd_dplane_batch {
+	struct bfd_dplane_ctx *bdc;
+	/** Sessions in the message being built. */
+	struct bfd_session *bs[(BFD_DP_MAX_MESSAGE_LEN
+				- sizeof(struct bfddp_message_header)
+				- sizeof(struct bfddp_sessions))
+			       / sizeof(struct bfddp_session)];
+	uint32_t count;
+	/** Message being built. */
+	union {
+		struct bfddp_message_header header;
+		uint8_t buf[BFD_DP_MAX_MESSAGE_LEN];
+	} msg;
+};
+
+static void bfd_dplane_batch_flush(struct bfd_dplane_batch *batch)
+{
+	struct bfddp_sessions *bss =
+		(struct bfddp_sessions *)(&batch->msg.header + 1);
+	uint16_t msglen;
+	uint32_t i;
+
+	if (batch->count == 0)
+		return;
+
+	msglen = sizeof(batch->msg.header) + sizeof(*bss)
+		 + batch->count * sizeof(bss->sessions[0]);
+	batch->msg.header.version = BFD_DP_VERSION;
+	batch->msg.header.zero = 0;
+	batch->msg.header.type = htons(DP_ADD_SESSIONS);
+	batch->msg.header.id = 0;
+	batch->msg.header.length = htons(msglen);
+	bss->count = htonl(batch->count);
+
+	/* Sessions that didn't make it stay unattached. */
+	if (bfd_dplane_enqueue(batch->bdc, &batch->msg, msglen) != 0) {
+		for (i = 0; i < batch->count; i++)
+			batch->bs[i]->bdc = NULL;
+	}
+
+	batch->count = 0;
+}
+
+static void _bfd_session_register_dplane_batch(struct hash_bucket *hb,
+					       void *arg)
+{
+	struct bfd_session *bs = hb->data;
+	struct bfd_dplane_batch *batch = arg;
+	struct bfddp_sessions *bss =
+		(struct bfddp_sessions *)(&batch->msg.header + 1);
+
+	if (bs->bdc != NULL)
+		return;
+
+	/* Disable software session. */
+	bfd_session_disable(bs);
+
+	/* Move session to data plane. */
+	bs->bdc = batch->bdc;
+	bs->remote_diag = 0;
+	bs->local_diag = 0;
+	bs->ses_state = PTM_BFD_DOWN;
+
+	memset(&bss->sessions[batch->count], 0, sizeof(bss->sessions[0]));
+	_bfd_dplane_session_payload_fill(bs, &bss->sessions[batch->count]);
+	batch->bs[batch->count++] = bs;
+
+	if (batch->count == array_size(batch->bs))
+		bfd_dplane_batch_flush(batch);
+}
+
+static void bfd_dplane_register_sessions(struct bfd_dplane_ctx *bdc)
+{
+	struct bfd_dplane_batch *batch;
+
+	if (!CHECK_FLAG(bdc->capabilities, CAPABILITY_BATCH_SESSIONS)) {
+		bfd_key_iterate(_bfd_session_register_dplane, bdc);
+		return;
+	}
+
+	batch = XCALLOC(MTYPE_BFDD_DPLANE_CTX, sizeof(*batch));
+	batch->bdc = bdc;
+	bfd_key_iterate(_bfd_session_register_dplane_batch, batch);
+	bfd_dplane_batch_flush(batch);
+	XFREE(MTYPE_BFDD_DPLANE_CTX, batch);
+}
+
+static void bfd_dplane_bootstrap(struct thread *t)
+{
+	struct bfd_dplane_ctx *bdc = THREAD_ARG(t);
+
+	/* Data plane didn't tell its capabilities: use basic messages. */
+	bfd_dplane_register_sessions(bdc);
+}
+
+/*
+ * Data planes supporting optional messages announce it first thing after
+ * connecting, so give them a moment before installing the sessions.
+ */
+static void bfd_dplane_bootstrap_schedule(struct bfd_dplane_ctx *bdc)
+{
+	bdc->capabilities = 0;
+	THREAD_OFF(bdc->bootstrapev);
+	thread_add_timer_msec(master, bfd_dplane_bootstrap, bdc,
+			      BFD_DPLANE_CAPABILITIES_WAIT, &bdc->bootstrapev);
+}
+
+static void bfd_dplane_bootstrap_cancel(struct bfd_dplane_ctx *bdc)
+{
+	THREAD_OFF(bdc->bootstrapev);
+}
+
 static struct bfd_dplane_ctx *bfd_dplane_ctx_new(int sock)
 {
 	struct bfd_dplane_ctx *bdc;
@@ -657,7 +859,7 @@ static struct bfd_dplane_ctx *bfd_dplane_ctx_new(int sock)
 	thread_add_read(master, bfd_dplane_read, bdc, sock, &bdc->inbufev);
 
 	/* Register all unattached sessions. */
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_bootstrap_schedule(bdc);
 
 	return bdc;
 }
@@ -695,6 +897,7 @@ static void bfd_dplane_ctx_free(struct bfd_dplane_ctx *bdc)
 		socket_close(&bdc->sock);
 		THREAD_OFF(bdc->inbufev);
 		THREAD_OFF(bdc->outbufev);
+		bfd_dplane_bootstrap_cancel(bdc);
 		thread_add_timer(master, bfd_dplane_client_connect, bdc, 3,
 				 &bdc->connectev);
 		return;
@@ -714,6 +917,7 @@ free_resources:
 	stream_free(bdc->outbuf);
 	THREAD_OFF(bdc->inbufev);
 	THREAD_OFF(bdc->outbufev);
+	bfd_dplane_bootstrap_cancel(bdc);
 	XFREE(MTYPE_BFDD_DPLANE_CTX, bdc);
 }
 
@@ -728,38 +932,44 @@ static void _bfd_dplane_session_fill(const struct bfd_session *bs,
 	msg->header.type = ntohs(DP_ADD_SESSION);
 
 	/* Message payload. */
-	msg->data.session.dst = bs->key.peer;
-	msg->data.session.src = bs->key.local;
-	msg->data.session.detect_mult = bs->detect_mult;
+	_bfd_dplane_session_payload_fill(bs, &msg->data.session);
+}
+
+static void _bfd_dplane_session_payload_fill(const struct bfd_session *bs,
+					     struct bfddp_session *session)
+{
+	session->dst = bs->key.peer;
+	session->src = bs->key.local;
+	session->detect_mult = bs->detect_mult;
 
 	if (bs->ifp) {
-		msg->data.session.ifindex = htonl(bs->ifp->ifindex);
-		strlcpy(msg->data.session.ifname, bs->ifp->name,
-			sizeof(msg->data.session.ifname));
+		session->ifindex = htonl(bs->ifp->ifindex);
+		strlcpy(session->ifname, bs->ifp->name,
+			sizeof(session->ifname));
 	}
 	if (bs->flags & BFD_SESS_FLAG_MH) {
-		msg->data.session.flags |= SESSION_MULTIHOP;
-		msg->data.session.ttl = bs->mh_ttl;
+		session->flags |= SESSION_MULTIHOP;
+		session->ttl = bs->mh_ttl;
 	} else
-		msg->data.session.ttl = BFD_TTL_VAL;
+		session->ttl = BFD_TTL_VAL;
 
 	if (bs->flags & BFD_SESS_FLAG_IPV6)
-		msg->data.session.flags |= SESSION_IPV6;
+		session->flags |= SESSION_IPV6;
 	if (bs->flags & BFD_SESS_FLAG_ECHO)
-		msg->data.session.flags |= SESSION_ECHO;
+		session->flags |= SESSION_ECHO;
 	if (bs->flags & BFD_SESS_FLAG_CBIT)
-		msg->data.session.flags |= SESSION_CBIT;
+		session->flags |= SESSION_CBIT;
 	if (bs->flags & BFD_SESS_FLAG_PASSIVE)
-		msg->data.session.flags |= SESSION_PASSIVE;
+		session->flags |= SESSION_PASSIVE;
 	if (bs->flags & BFD_SESS_FLAG_SHUTDOWN)
-		msg->data.session.flags |= SESSION_SHUTDOWN;
-
-	msg->data.session.flags = htonl(msg->data.session.flags);
-	msg->data.session.lid = htonl(bs->discrs.my_discr);
-	msg->data.session.min_tx = htonl(bs->timers.desired_min_tx);
-	msg->data.session.min_rx = htonl(bs->timers.required_min_rx);
-	msg->data.session.min_echo_tx = htonl(bs->timers.desired_min_echo_tx);
-	msg->data.session.min_echo_rx = htonl(bs->timers.required_min_echo_rx);
+		session->flags |= SESSION_SHUTDOWN;
+
+	session->flags = htonl(session->flags);
+	session->lid = htonl(bs->discrs.my_discr);
+	session->min_tx = htonl(bs->timers.desired_min_tx);
+	session->min_rx = htonl(bs->timers.required_min_rx);
+	session->min_echo_tx = htonl(bs->timers.desired_min_echo_tx);
+	session->min_echo_rx = htonl(bs->timers.required_min_echo_rx);
 }
 
 static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
@@ -783,19 +993,92 @@ static int _bfd_dplane_add_session(struct bfd_dplane_ctx *bdc,
 	return rv;
 }
 
+static void
+_bfd_dplane_session_counters_set(struct bfd_session *bs,
+				 const struct bfddp_session_counters *counters)
+{
+	bs->stats.rx_ctrl_pkt = be64toh(counters->control_input_packets);
+	bs->stats.tx_ctrl_pkt = be64toh(counters->control_output_packets);
+	bs->stats.rx_echo_pkt = be64toh(counters->echo_input_packets);
+	bs->stats.tx_echo_pkt = be64toh(counters->echo_output_bytes);
+}
+
 static void _bfd_dplane_update_session_counters(struct bfddp_message *msg,
 						void *arg)
 {
 	struct bfd_session *bs = arg;
 
-	bs->stats.rx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_input_packets);
-	bs->stats.tx_ctrl_pkt =
-		be64toh(msg->data.session_counters.control_output_packets);
-	bs->stats.rx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_input_packets);
-	bs->stats.tx_echo_pkt =
-		be64toh(msg->data.session_counters.echo_output_bytes);
+	_bfd_dplane_session_counters_set(bs, &msg->data.session_counters);
+}
+
+/** State of a `DP_REQUEST_ALL_COUNTERS` request. */
+struct bfd_dplane_counters_req {
+	struct bfd_dplane_ctx *bdc;
+	bool done;
+};
+
+static void _bfd_dplane_update_all_counters(struct bfddp_message *msg,
+					    void *arg)
+{
+	struct bfd_dplane_counters_req *req = arg;
+	const struct bfddp_sessions_counters *bsc =
+		(const struct bfddp_sessions_counters *)&msg->data;
+	struct bfd_session *bs;
+	size_t len = ntohs(msg->header.length);
+	uint32_t count, i;
+
+	if (ntohs(msg->header.type) != BFD_SESSIONS_COUNTERS
+	    || len < sizeof(msg->header) + sizeof(*bsc)) {
+		req->done = true;
+		return;
+	}
+
+	len -= sizeof(msg->header) + sizeof(*bsc);
+	count = MIN(ntohl(bsc->count), len / sizeof(bsc->counters[0]));
+	for (i = 0; i < count; i++) {
+		bs = bfd_id_lookup(ntohl(bsc->counters[i].lid));
+		if (bs == NULL || bs->bdc != req->bdc)
+			continue;
+
+		_bfd_dplane_session_counters_set(bs, &bsc->counters[i]);
+	}
+
+	if (ntohl(bsc->flags) & COUNTERS_LAST)
+		req->done = true;
+}
+
+/**
+ * Asks the data plane for the counters of all its sessions at once.
+ *
+ * eturns `0` on success or `-1` on failure.
+ */
+static int bfd_dplane_request_all_counters(struct bfd_dplane_ctx *bdc)
+{
+	struct bfd_dplane_counters_req req = {.bdc = bdc};
+	struct bfddp_message msg = {};
+	size_t msglen = sizeof(msg.header);
+	uint16_t id;
+	int rv;
+
+	msg.header.version = BFD_DP_VERSION;
+	msg.header.length = htons(msglen);
+	msg.header.type = htons(DP_REQUEST_ALL_COUNTERS);
+	id = bfd_dplane_next_id(bdc);
+	msg.header.id = htons(id);
+
+	if (bfd_dplane_enqueue(bdc, &msg, msglen) == -1)
+		return -1;
+
+	/* Flush socket. */
+	bfd_dplane_flush(bdc);
+
+	/* The answer may be split in many messages. */
+	do {
+		rv = bfd_dplane_expect(bdc, id, _bfd_dplane_update_all_counters,
+				       &req);
+	} while (rv == -2 || (rv == 0 && !req.done));
+
+	return rv;
 }
 
 /**
@@ -873,7 +1156,7 @@ static void _bfd_dplane_client_bootstrap(struct bfd_dplane_ctx *bdc)
 
 	/* Remove all sessions then register again to send them all. */
 	bfd_key_iterate(_bfd_session_unregister_dplane, bdc);
-	bfd_key_iterate(_bfd_session_register_dplane, bdc);
+	bfd_dplane_bootstrap_schedule(bdc);
 }
 
 static bool bfd_dplane_client_connecting(struct bfd_dplane_ctx *bdc)
@@ -1163,6 +1446,29 @@ void bfd_dplane_show_counters(struct vty *vty)
 #undef SHOW_COUNTER
 }
 
+void bfd_dplane_counters_bulk_begin(void)
+{
+	struct bfd_dplane_ctx *bdc, *bdcn;
+
+	TAILQ_FOREACH_SAFE (bdc, &bglobal.bg_dplaneq, entry, bdcn) {
+		if (bdc->sock == -1 || bdc->connecting
+		    || !CHECK_FLAG(bdc->capabilities, CAPABILITY_BULK_COUNTERS))
+			continue;
+
+		/* On failure the context may be gone already. */
+		if (bfd_dplane_request_all_counters(bdc) == 0)
+			bdc->counters_valid = true;
+	}
+}
+
+void bfd_dplane_counters_bulk_end(void)
+{
+	struct bfd_dplane_ctx *bdc;
+
+	TAILQ_FOREACH (bdc, &bglobal.bg_dplaneq, entry)
+		bdc->counters_valid = false;
+}
+
 int bfd_dplane_update_session_counters(struct bfd_session *bs)
 {
 	uint16_t id;
@@ -1172,6 +1478,10 @@ int bfd_dplane_update_session_counters(struct bfd_session *bs)
 	if (bs->bdc == NULL)
 		return 0;
 
+	/* Already updated by bfd_dplane_counters_bulk_begin(). */
+	if (bs->bdc->counters_valid)
+		return 0;
+
 	/* Make the request. */
 	id = bfd_dplane_request_counters(bs);
 	if (id == 0) {
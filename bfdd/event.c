@@ -35,45 +35,148 @@ void tv_normalize(struct timeval *tv)
 	tv->tv_usec = tv->tv_usec % 1000000;
 }
 
-void bfd_recvtimer_update(struct bfd_session *bs)
+/*
+ * Detection timers are restarted by every received packet.  Instead of
+ * cancelling and adding a timer each time, only the deadline is moved while
+ * a timer is pending; the timer re-arms itself for the remaining time when
+ * it fires early (see bfd_recvtimer_extended()).
+ */
+static void bfd_detect_timer_update(struct bfd_session *bs, uint64_t timeout,
+				    struct timeval *deadline,
+				    void (*func)(struct thread *),
+				    struct thread **ev)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = bs->detect_TO};
-
-	/* Remove previous schedule if any. */
-	bfd_recvtimer_delete(bs);
+	struct timeval tv = {.tv_sec = 0, .tv_usec = timeout};
+	struct timeval now, new_deadline;
 
 	/* Don't add event if peer is deactivated. */
 	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
-	    bs->sock == -1)
+	    bs->sock == -1) {
+		THREAD_OFF(*ev);
 		return;
+	}
 
 	tv_normalize(&tv);
+	monotime(&now);
+	timeradd(&now, &tv, &new_deadline);
+
+	/* The pending timer fires no later than the new deadline. */
+	if (*ev && timercmp(&new_deadline, deadline, >=)) {
+		*deadline = new_deadline;
+		return;
+	}
+
+	/* Remove previous schedule if any. */
+	THREAD_OFF(*ev);
+
+	*deadline = new_deadline;
+	thread_add_timer_tv(master, func, bs, &tv, ev);
+}
+
+static bool bfd_detect_timer_extended(struct bfd_session *bs,
+				      struct timeval *deadline,
+				      void (*func)(struct thread *),
+				      struct thread **ev)
+{
+	struct timeval now, tv;
+
+	monotime(&now);
+	if (!timercmp(deadline, &now, >))
+		return false;
 
-	thread_add_timer_tv(master, bfd_recvtimer_cb, bs, &tv,
-			    &bs->recvtimer_ev);
+	timersub(deadline, &now, &tv);
+	thread_add_timer_tv(master, func, bs, &tv, ev);
+	return true;
+}
+
+void bfd_recvtimer_update(struct bfd_session *bs)
+{
+	bfd_detect_timer_update(bs, bs->detect_TO, &bs->detect_deadline,
+				bfd_recvtimer_cb, &bs->recvtimer_ev);
 }
 
 void bfd_echo_recvtimer_update(struct bfd_session *bs)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = bs->echo_detect_TO};
+	bfd_detect_timer_update(bs, bs->echo_detect_TO,
+				&bs->echo_detect_deadline,
+				bfd_echo_recvtimer_cb, &bs->echo_recvtimer_ev);
+}
 
-	/* Remove previous schedule if any. */
-	bfd_echo_recvtimer_delete(bs);
+/*
+ * Called from an expired detection timer: if packets moved the deadline
+ * since the timer was scheduled, re-arm it and return true.
+ */
+bool bfd_recvtimer_extended(struct bfd_session *bs)
+{
+	return bfd_detect_timer_extended(bs, &bs->detect_deadline,
+					 bfd_recvtimer_cb, &bs->recvtimer_ev);
+}
 
-	/* Don't add event if peer is deactivated. */
-	if (CHECK_FLAG(bs->flags, BFD_SESS_FLAG_SHUTDOWN) ||
-	    bs->sock == -1)
-		return;
+bool bfd_echo_recvtimer_extended(struct bfd_session *bs)
+{
+	return bfd_detect_timer_extended(bs, &bs->echo_detect_deadline,
+					 bfd_echo_recvtimer_cb,
+					 &bs->echo_recvtimer_ev);
+}
 
-	tv_normalize(&tv);
+/*
+ * Control packet transmit timers.  Sessions due in the same slot of
+ * BFD_XMT_SLOT_USEC share a bucket with one thread timer, instead of each
+ * session having its own timer.  Each packet keeps its own jitter (RFC 5880
+ * Section 6.8.7); the expiry is only moved to a slot boundary when that
+ * stays within the jittered range.
+ */
+#define BFD_XMT_SLOT_USEC 1000
+
+DEFINE_MTYPE_STATIC(BFDD, BFDD_XMT_BUCKET, "BFD transmit timer bucket");
+
+PREDECL_RBTREE_UNIQ(bfd_xmt_buckets);
+
+struct bfd_xmt_bucket {
+	struct bfd_xmt_buckets_item item;
+
+	/* monotonic expiry time, in microseconds */
+	int64_t expiry;
+	struct bfd_xmt_slot_head sessions;
+	struct thread *ev;
+};
+
+DECLARE_DLIST(bfd_xmt_slot, struct bfd_session, xmt_item);
+
+static int bfd_xmt_bucket_cmp(const struct bfd_xmt_bucket *a,
+			      const struct bfd_xmt_bucket *b)
+{
+	return numcmp(a->expiry, b->expiry);
+}
+
+DECLARE_RBTREE_UNIQ(bfd_xmt_buckets, struct bfd_xmt_bucket, item,
+		    bfd_xmt_bucket_cmp);
+
+static struct bfd_xmt_buckets_head bfd_xmt_buckets =
+	INIT_RBTREE_UNIQ(bfd_xmt_buckets);
+
+static void bfd_xmt_bucket_cb(struct thread *t)
+{
+	struct bfd_xmt_bucket *bucket = THREAD_ARG(t);
+	struct bfd_session *bs;
+
+	bfd_xmt_buckets_del(&bfd_xmt_buckets, bucket);
 
-	thread_add_timer_tv(master, bfd_echo_recvtimer_cb, bs, &tv,
-			    &bs->echo_recvtimer_ev);
+	/* Sessions deleted meanwhile leave the list, the bucket stays. */
+	while ((bs = bfd_xmt_slot_pop(&bucket->sessions))) {
+		bs->xmt_bucket = NULL;
+		ptm_bfd_xmt_TO(bs, 0);
+	}
+
+	bfd_xmt_slot_fini(&bucket->sessions);
+	XFREE(MTYPE_BFDD_XMT_BUCKET, bucket);
 }
 
 void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
 {
-	struct timeval tv = {.tv_sec = 0, .tv_usec = jitter};
+	struct bfd_xmt_bucket *bucket, ref;
+	struct timeval now, tv;
+	int64_t expiry, slot, min_jitter;
 
 	/* Remove previous schedule if any. */
 	bfd_xmttimer_delete(bs);
@@ -83,9 +186,32 @@ void bfd_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
 	    bs->sock == -1)
 		return;
 
-	tv_normalize(&tv);
+	monotime(&now);
+	expiry = now.tv_sec * 1000000LL + now.tv_usec + jitter;
+
+	/* Round down to the slot, but never below 75% of the interval. */
+	min_jitter = bs->xmt_TO * 3 / 4;
+	slot = expiry - expiry % BFD_XMT_SLOT_USEC;
+	if ((int64_t)jitter - (expiry - slot) >= min_jitter)
+		expiry = slot;
+
+	ref.expiry = expiry;
+	bucket = bfd_xmt_buckets_find(&bfd_xmt_buckets, &ref);
+	if (bucket == NULL) {
+		bucket = XCALLOC(MTYPE_BFDD_XMT_BUCKET, sizeof(*bucket));
+		bucket->expiry = expiry;
+		bfd_xmt_slot_init(&bucket->sessions);
+		bfd_xmt_buckets_add(&bfd_xmt_buckets, bucket);
 
-	thread_add_timer_tv(master, bfd_xmt_cb, bs, &tv, &bs->xmttimer_ev);
+		tv.tv_sec = 0;
+		tv.tv_usec = expiry - (now.tv_sec * 1000000LL + now.tv_usec);
+		tv_normalize(&tv);
+		thread_add_timer_tv(master, bfd_xmt_bucket_cb, bucket, &tv,
+				    &bucket->ev);
+	}
+
+	bfd_xmt_slot_add_tail(&bucket->sessions, bs);
+	bs->xmt_bucket = bucket;
 }
 
 void bfd_echo_xmttimer_update(struct bfd_session *bs, uint64_t jitter)
@@ -118,7 +244,22 @@ void bfd_echo_recvtimer_delete(struct bfd_session *bs)
 
 void bfd_xmttimer_delete(struct bfd_session *bs)
 {
-	THREAD_OFF(bs->xmttimer_ev);
+	struct bfd_xmt_bucket *bucket = bs->xmt_bucket;
+
+	if (bucket == NULL)
+		return;
+
+	bfd_xmt_slot_del(&bucket->sessions, bs);
+	bs->xmt_bucket = NULL;
+
+	/* A bucket whose timer is running is freed by bfd_xmt_bucket_cb(). */
+	if (bfd_xmt_slot_count(&bucket->sessions) || bucket->ev == NULL)
+		return;
+
+	THREAD_OFF(bucket->ev);
+	bfd_xmt_buckets_del(&bfd_xmt_buckets, bucket);
+	bfd_xmt_slot_fini(&bucket->sessions);
+	XFREE(MTYPE_BFDD_XMT_BUCKET, bucket);
 }
 
 void bfd_echo_xmttimer_delete(struct bfd_session *bs)
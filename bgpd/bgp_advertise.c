@@ -184,6 +184,7 @@ void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
 		    uint32_t addpath_id)
 {
 	struct bgp_adj_in *adj;
+	struct bgp_table *table;
 
 	for (adj = dest->adj_in; adj; adj = adj->next) {
 		if (adj->peer == peer && adj->addpath_rx_id == addpath_id) {
@@ -201,10 +202,15 @@ void bgp_adj_in_set(struct bgp_dest *dest, struct peer *peer, struct attr *attr,
 	adj->addpath_rx_id = addpath_id;
 	BGP_ADJ_IN_ADD(dest, adj);
 	bgp_dest_lock_node(dest);
+	table = bgp_dest_table(dest);
+	peer->adj_in_count[table->afi][table->safi]++;
 }
 
 void bgp_adj_in_remove(struct bgp_dest *dest, struct bgp_adj_in *bai)
 {
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	bai->peer->adj_in_count[table->afi][table->safi]--;
 	bgp_attr_unintern(&bai->attr);
 	BGP_ADJ_IN_DEL(dest, bai);
 	bgp_dest_unlock_node(dest);
@@ -62,7 +62,10 @@ struct bgp_advertise {
 
 DECLARE_DLIST(bgp_adv_fifo, struct bgp_advertise, fifo);
 
-/* BGP adjacency out.  */
+/* BGP adjacency out.  There is one of these per prefix, subgroup and
+ * addpath ID, which on route servers makes them the bulk of bgpd's memory;
+ * anything that can be derived does not belong in here.
+ */
 struct bgp_adj_out {
 	/* RB Tree of adjacency entries */
 	RB_ENTRY(bgp_adj_out) adj_entry;
@@ -83,9 +86,6 @@ struct bgp_adj_out {
 
 	/* Advertisement information.  */
 	struct bgp_advertise *adv;
-
-	/* Attribute hash */
-	uint32_t attr_hash;
 };
 
 RB_HEAD(bgp_adj_out_rb, bgp_adj_out);
@@ -93,10 +93,13 @@ RB_PROTOTYPE(bgp_adj_out_rb, bgp_adj_out, adj_entry,
 	     bgp_adj_out_compare);
 
 /* BGP adjacency in. */
+/* There is one of these per prefix and peer with soft-reconfiguration
+ * inbound, so keep it small: the list is singly linked, since every
+ * removal walks dest->adj_in anyway to find the peer's entries.
+ */
 struct bgp_adj_in {
 	/* Linked list pointer.  */
 	struct bgp_adj_in *next;
-	struct bgp_adj_in *prev;
 
 	/* Received peer.  */
 	struct peer *peer;
@@ -119,28 +122,23 @@ struct bgp_synchronize {
 };
 
 /* BGP adjacency linked list.  */
-#define BGP_PATH_INFO_ADD(N, A, TYPE)                                          \
+#define BGP_ADJ_IN_ADD(N, A)                                                   \
 	do {                                                                   \
-		(A)->prev = NULL;                                              \
-		(A)->next = (N)->TYPE;                                         \
-		if ((N)->TYPE)                                                 \
-			(N)->TYPE->prev = (A);                                 \
-		(N)->TYPE = (A);                                               \
+		(A)->next = (N)->adj_in;                                       \
+		(N)->adj_in = (A);                                             \
 	} while (0)
 
-#define BGP_PATH_INFO_DEL(N, A, TYPE)                                          \
+#define BGP_ADJ_IN_DEL(N, A)                                                   \
 	do {                                                                   \
-		if ((A)->next)                                                 \
-			(A)->next->prev = (A)->prev;                           \
-		if ((A)->prev)                                                 \
-			(A)->prev->next = (A)->next;                           \
-		else                                                           \
-			(N)->TYPE = (A)->next;                                 \
+		struct bgp_adj_in **_pp;                                       \
+                                                                               \
+		for (_pp = &(N)->adj_in; *_pp; _pp = &(*_pp)->next)            \
+			if (*_pp == (A)) {                                     \
+				*_pp = (A)->next;                              \
+				break;                                         \
+			}                                                      \
 	} while (0)
 
-#define BGP_ADJ_IN_ADD(N, A) BGP_PATH_INFO_ADD(N, A, adj_in)
-#define BGP_ADJ_IN_DEL(N, A) BGP_PATH_INFO_DEL(N, A, adj_in)
-
 /* Prototypes.  */
 extern bool bgp_adj_out_lookup(struct peer *peer, struct bgp_dest *dest,
 			       uint32_t addpath_tx_id);
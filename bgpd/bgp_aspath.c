@@ -656,16 +656,25 @@ static void aspath_make_str_count(struct aspath *as, bool make_json)
 	return;
 }
 
+/*
+ * Drop the string and JSON representations after the segments of as were
+ * changed.  The string is only built again when it is asked for through
+ * aspath_print(), or right away together with the JSON if make_json is set.
+ */
 void aspath_str_update(struct aspath *as, bool make_json)
 {
 	XFREE(MTYPE_AS_STR, as->str);
+	as->str_len = 0;
 
 	if (as->json) {
 		json_object_free(as->json);
 		as->json = NULL;
 	}
 
-	aspath_make_str_count(as, make_json);
+	memset(as->filter_cache, 0, sizeof(as->filter_cache));
+
+	if (make_json)
+		aspath_make_str_count(as, true);
 }
 
 /* Intern allocated AS path. */
@@ -673,10 +682,8 @@ struct aspath *aspath_intern(struct aspath *aspath)
 {
 	struct aspath *find;
 
-	/* Assert this AS path structure is not interned and has the string
-	   representation built. */
+	/* Assert this AS path structure is not interned. */
 	assert(aspath->refcnt == 0);
-	assert(aspath->str);
 
 	/* Check AS path hash. */
 	find = hash_get(ashash, aspath, hash_alloc_intern);
@@ -721,9 +728,6 @@ static void *aspath_hash_alloc(void *arg)
 	const struct aspath *aspath = arg;
 	struct aspath *new;
 
-	/* Malformed AS path value. */
-	assert(aspath->str);
-
 	/* New aspath structure is needed. */
 	new = XMALLOC(MTYPE_AS_PATH, sizeof(struct aspath));
 
@@ -733,6 +737,8 @@ static void *aspath_hash_alloc(void *arg)
 	new->str = aspath->str;
 	new->str_len = aspath->str_len;
 	new->json = aspath->json;
+	memcpy(new->filter_cache, aspath->filter_cache,
+	       sizeof(new->filter_cache));
 
 	return new;
 }
@@ -1728,7 +1734,7 @@ struct aspath *aspath_reconcile_as4(struct aspath *aspath,
 	if (BGP_DEBUG(as4, AS4))
 		zlog_debug(
 			"[AS4] got AS_PATH %s and AS4_PATH %s synthesizing now",
-			aspath->str, as4path->str);
+			aspath_print(aspath), aspath_print(as4path));
 
 	while (seg && hops > 0) {
 		switch (seg->type) {
@@ -1786,7 +1792,7 @@ struct aspath *aspath_reconcile_as4(struct aspath *aspath,
 
 	if (BGP_DEBUG(as4, AS4))
 		zlog_debug("[AS4] result of synthesizing is %s",
-			   mergedpath->str);
+			   aspath_print(mergedpath));
 
 	return mergedpath;
 }
@@ -1905,7 +1911,6 @@ struct aspath *aspath_empty_get(void)
 	struct aspath *aspath;
 
 	aspath = aspath_new();
-	aspath_make_str_count(aspath, false);
 	return aspath;
 }
 
@@ -2056,8 +2061,6 @@ struct aspath *aspath_str2aspath(const char *str)
 		}
 	}
 
-	aspath_make_str_count(aspath, false);
-
 	return aspath;
 }
 
@@ -2065,12 +2068,16 @@ struct aspath *aspath_str2aspath(const char *str)
 unsigned int aspath_key_make(const void *p)
 {
 	const struct aspath *aspath = p;
-	unsigned int key = 0;
-
-	if (!aspath->str)
-		aspath_str_update((struct aspath *)aspath, false);
+	const struct assegment *seg;
+	unsigned int key = 2334325;
 
-	key = jhash(aspath->str, aspath->str_len, 2334325);
+	/* Hash the same fields aspath_cmp() compares, the string is not
+	 * necessarily built yet.
+	 */
+	for (seg = aspath->segments; seg; seg = seg->next) {
+		key = jhash_2words(seg->type, seg->length, key);
+		key = jhash(seg->as, seg->length * sizeof(seg->as[0]), key);
+	}
 
 	return key;
 }
@@ -2116,9 +2123,16 @@ void aspath_finish(void)
 }
 
 /* return and as path value */
+/* return and as path value, the string is built on first use */
 const char *aspath_print(struct aspath *as)
 {
-	return (as ? as->str : NULL);
+	if (!as)
+		return NULL;
+
+	if (!as->str)
+		aspath_make_str_count(as, false);
+
+	return as->str;
 }
 
 /* Printing functions */
@@ -2129,7 +2143,7 @@ void aspath_print_vty(struct vty *vty, const char *format, struct aspath *as,
 		      const char *suffix)
 {
 	assert(format);
-	vty_out(vty, format, as->str);
+	vty_out(vty, format, aspath_print(as));
 	if (as->str_len && strlen(suffix))
 		vty_out(vty, "%s", suffix);
 }
@@ -2142,7 +2156,7 @@ static void aspath_show_all_iterator(struct hash_bucket *bucket,
 	as = (struct aspath *)bucket->data;
 
 	vty_out(vty, "[%p:%u] (%ld) ", (void *)bucket, bucket->key, as->refcnt);
-	vty_out(vty, "%s\n", as->str);
+	vty_out(vty, "%s\n", aspath_print(as));
 }
 
 /* Print all aspath and hash information.  This function is used from
@@ -2174,9 +2188,13 @@ static void bgp_aggr_aspath_prepare(struct hash_bucket *hb, void *arg)
 	struct aspath *hb_aspath = hb->data;
 	struct aspath **aggr_aspath = arg;
 
-	if (*aggr_aspath)
-		*aggr_aspath = aspath_aggregate(*aggr_aspath, hb_aspath);
-	else
+	struct aspath *asmerge;
+
+	if (*aggr_aspath) {
+		asmerge = aspath_aggregate(*aggr_aspath, hb_aspath);
+		aspath_free(*aggr_aspath);
+		*aggr_aspath = asmerge;
+	} else
 		*aggr_aspath = aspath_dup(hb_aspath);
 }
 
@@ -2190,19 +2208,29 @@ void bgp_aggr_aspath_remove(void *arg)
 void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
 				  struct aspath *aspath)
 {
-	bgp_compute_aggregate_aspath_hash(aggregate, aspath);
+	struct aspath *asmerge;
 
-	bgp_compute_aggregate_aspath_val(aggregate);
+	/* Only an as-path new to the aggregate changes it, and then it
+	 * is enough to merge that one into the current value.
+	 */
+	if (!bgp_compute_aggregate_aspath_hash(aggregate, aspath))
+		return;
 
+	if (aggregate->aspath) {
+		asmerge = aspath_aggregate(aggregate->aspath, aspath);
+		aspath_free(aggregate->aspath);
+		aggregate->aspath = asmerge;
+	} else
+		aggregate->aspath = aspath_dup(aspath);
 }
 
-void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
+bool bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 				       struct aspath *aspath)
 {
 	struct aspath *aggr_aspath = NULL;
 
 	if ((aggregate == NULL) || (aspath == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -2221,7 +2249,7 @@ void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_aspath->refcnt++;
+	return ++aggr_aspath->refcnt == 1;
 }
 
 void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate)
@@ -69,9 +69,19 @@ struct aspath {
 	json_object *json;
 
 	/* String expression of AS path.  This string is used by vty output
-	   and AS path regular expression match.  */
+	   and AS path regular expression match, it is built on demand by
+	   aspath_print().  */
 	char *str;
 	unsigned short str_len;
+
+	/* Verdicts of the last as-path access-lists applied to str, see
+	 * as_list_apply().  Reset by aspath_str_update().
+	 */
+#define ASPATH_FILTER_CACHE 2
+	struct {
+		uint32_t version;
+		uint8_t type;
+	} filter_cache[ASPATH_FILTER_CACHE];
 };
 
 #define ASPATH_STR_DEFAULT_LEN 32
@@ -145,7 +155,7 @@ extern uint8_t *aspath_snmp_pathseg(struct aspath *aspath, size_t *varlen);
 extern void bgp_compute_aggregate_aspath(struct bgp_aggregate *aggregate,
 					 struct aspath *aspath);
 
-extern void bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
+extern bool bgp_compute_aggregate_aspath_hash(struct bgp_aggregate *aggregate,
 					      struct aspath *aspath);
 extern void bgp_compute_aggregate_aspath_val(struct bgp_aggregate *aggregate);
 extern void bgp_remove_aspath_from_aggregate(struct bgp_aggregate *aggregate,
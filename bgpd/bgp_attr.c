@@ -46,6 +46,7 @@
 #include "bgpd/bgp_ecommunity.h"
 #include "bgpd/bgp_lcommunity.h"
 #include "bgpd/bgp_updgrp.h"
+#include "bgpd/bgp_rtc.h"
 #include "bgpd/bgp_encap_types.h"
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
@@ -117,7 +118,7 @@ static void *cluster_hash_alloc(void *p)
 }
 
 /* Cluster list related functions. */
-static struct cluster_list *cluster_parse(struct in_addr *pnt, int length)
+struct cluster_list *cluster_parse(struct in_addr *pnt, int length)
 {
 	struct cluster_list tmp = {};
 	struct cluster_list *cluster;
@@ -747,11 +748,22 @@ static void transit_finish(void)
 }
 
 /* Attribute hash routines. */
-static struct hash *attrhash;
+static int attr_intern_hash_cmp(const struct attr *a1, const struct attr *a2);
+static uint32_t attr_intern_hash_key(const struct attr *attr);
+
+/* The struct attr embeds its own hash item and keeps the computed hash
+ * value, so interning does not allocate a separate bucket and releasing
+ * an attribute does not need to recompute its (aspath/community
+ * hashing) key.
+ */
+DECLARE_HASH(attr_intern_hash, struct attr, hashitem, attr_intern_hash_cmp,
+	     attr_intern_hash_key);
+
+static struct attr_intern_hash_head attrhash[1];
 
 unsigned long int attr_count(void)
 {
-	return attrhash->count;
+	return attr_intern_hash_count(attrhash);
 }
 
 unsigned long int attr_unknown_count(void)
@@ -880,30 +892,32 @@ bool attrhash_cmp(const void *p1, const void *p2)
 	return false;
 }
 
-static void attrhash_init(void)
+static int attr_intern_hash_cmp(const struct attr *a1, const struct attr *a2)
 {
-	attrhash =
-		hash_create(attrhash_key_make, attrhash_cmp, "BGP Attributes");
+	return attrhash_cmp(a1, a2) ? 0 : 1;
 }
 
-/*
- * special for hash_clean below
- */
-static void attr_vfree(void *attr)
+static uint32_t attr_intern_hash_key(const struct attr *attr)
 {
-	XFREE(MTYPE_ATTR, attr);
+	return attrhash_key_make(attr);
+}
+
+static void attrhash_init(void)
+{
+	attr_intern_hash_init(attrhash);
 }
 
 static void attrhash_finish(void)
 {
-	hash_clean(attrhash, attr_vfree);
-	hash_free(attrhash);
-	attrhash = NULL;
+	struct attr *attr;
+
+	while ((attr = attr_intern_hash_pop(attrhash)))
+		XFREE(MTYPE_ATTR, attr);
+	attr_intern_hash_fini(attrhash);
 }
 
-static void attr_show_all_iterator(struct hash_bucket *bucket, struct vty *vty)
+static void attr_show_all_iterator(struct attr *attr, struct vty *vty)
 {
-	struct attr *attr = bucket->data;
 	struct in6_addr *sid = NULL;
 
 	if (attr->srv6_l3vpn)
@@ -922,14 +936,32 @@ static void attr_show_all_iterator(struct hash_bucket *bucket, struct vty *vty)
 
 void attr_show_all(struct vty *vty)
 {
-	hash_iterate(attrhash, (void (*)(struct hash_bucket *,
-					 void *))attr_show_all_iterator,
-		     vty);
+	struct attr *attr;
+
+	frr_each (attr_intern_hash, attrhash, attr)
+		attr_show_all_iterator(attr, vty);
+}
+
+/*
+ * Precompute the leading steps of bgp_path_info_cmp().  The local-pref
+ * part is 0 if the attribute is absent, the comparison fills in the
+ * instance's default.
+ */
+static void bgp_attr_decision_key_set(struct attr *attr)
+{
+	struct community *comm = bgp_attr_get_community(attr);
+
+	attr->decision_key = (uint64_t)attr->weight << 32;
+	if (CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)))
+		attr->decision_key |= attr->local_pref;
+
+	attr->decision_flags = ATTR_DECISION_VALID;
+	if (comm && community_include(comm, COMMUNITY_LLGR_STALE))
+		SET_FLAG(attr->decision_flags, ATTR_DECISION_LLGR_STALE);
 }
 
-static void *bgp_attr_hash_alloc(void *p)
+static struct attr *bgp_attr_hash_alloc(struct attr *val)
 {
-	struct attr *val = (struct attr *)p;
 	struct attr *attr;
 
 	attr = XMALLOC(MTYPE_ATTR, sizeof(struct attr));
@@ -946,6 +978,7 @@ static void *bgp_attr_hash_alloc(void *p)
 #endif
 
 	attr->refcnt = 0;
+	bgp_attr_decision_key_set(attr);
 	return attr;
 }
 
@@ -1055,7 +1088,11 @@ struct attr *bgp_attr_intern(struct attr *attr)
 	 * If we don't find it, we need to allocate a one because in all
 	 * cases this returns a new reference to a hashed attr, but the input
 	 * wasn't on hash. */
-	find = (struct attr *)hash_get(attrhash, attr, bgp_attr_hash_alloc);
+	find = attr_intern_hash_find(attrhash, attr);
+	if (!find) {
+		find = bgp_attr_hash_alloc(attr);
+		attr_intern_hash_add(attrhash, find);
+	}
 	find->refcnt++;
 
 	return find;
@@ -1254,6 +1291,49 @@ void bgp_attr_unintern_sub(struct attr *attr)
 		srv6_vpn_unintern(&attr->srv6_vpn);
 }
 
+/*
+ * Take another reference on all sub-attributes of an attr whose
+ * sub-attributes are interned already, e.g. one that bgp_attr_parse()
+ * returned successfully.  The counterpart of bgp_attr_unintern_sub().
+ */
+void bgp_attr_ref_sub(struct attr *attr)
+{
+	struct community *comm = bgp_attr_get_community(attr);
+	struct ecommunity *ecomm = bgp_attr_get_ecommunity(attr);
+	struct ecommunity *ipv6_ecomm = bgp_attr_get_ipv6_ecommunity(attr);
+	struct lcommunity *lcomm = bgp_attr_get_lcommunity(attr);
+	struct cluster_list *cluster = bgp_attr_get_cluster(attr);
+	struct transit *transit = bgp_attr_get_transit(attr);
+
+	if (attr->aspath)
+		attr->aspath->refcnt++;
+	if (comm)
+		comm->refcnt++;
+	if (ecomm)
+		ecomm->refcnt++;
+	if (ipv6_ecomm)
+		ipv6_ecomm->refcnt++;
+	if (lcomm)
+		lcomm->refcnt++;
+	if (cluster)
+		cluster->refcnt++;
+	if (transit)
+		transit->refcnt++;
+	if (attr->encap_subtlvs)
+		attr->encap_subtlvs->refcnt++;
+#ifdef ENABLE_BGP_VNC
+	struct bgp_attr_encap_subtlv *vnc_subtlvs =
+		bgp_attr_get_vnc_subtlvs(attr);
+
+	if (vnc_subtlvs)
+		vnc_subtlvs->refcnt++;
+#endif
+	if (attr->srv6_l3vpn)
+		attr->srv6_l3vpn->refcnt++;
+	if (attr->srv6_vpn)
+		attr->srv6_vpn->refcnt++;
+}
+
 /* Free bgp attribute and aspath. */
 void bgp_attr_unintern(struct attr **pattr)
 {
@@ -1268,7 +1348,7 @@ void bgp_attr_unintern(struct attr **pattr)
 
 	/* If reference becomes zero then free attribute object. */
 	if (attr->refcnt == 0) {
-		ret = hash_release(attrhash, attr);
+		ret = attr_intern_hash_del(attrhash, attr);
 		assert(ret != NULL);
 		XFREE(MTYPE_ATTR, attr);
 		*pattr = NULL;
@@ -2189,6 +2269,10 @@ int bgp_mp_reach_parse(struct bgp_attr_parser_args *args,
 	pkt_afi = stream_getw(s);
 	pkt_safi = stream_getc(s);
 
+	/* Route target memberships are not kept in a RIB */
+	if (pkt_afi == IANA_AFI_IPV4 && pkt_safi == IANA_SAFI_RTC)
+		return bgp_rtc_attr_parse(peer, attr, s, LEN_LEFT, false);
+
 	/* Convert AFI, SAFI to internal values, check. */
 	if (bgp_map_afi_safi_iana2int(pkt_afi, pkt_safi, &afi, &safi)) {
 		/* Log if AFI or SAFI is unrecognized. This is not an error
@@ -2368,6 +2452,11 @@ int bgp_mp_unreach_parse(struct bgp_attr_parser_args *args,
 	pkt_afi = stream_getw(s);
 	pkt_safi = stream_getc(s);
 
+	if (pkt_afi == IANA_AFI_IPV4 && pkt_safi == IANA_SAFI_RTC)
+		return bgp_rtc_attr_parse(peer, attr, s,
+					  length - BGP_MP_UNREACH_MIN_SIZE,
+					  true);
+
 	/* Convert AFI, SAFI to internal values, check. */
 	if (bgp_map_afi_safi_iana2int(pkt_afi, pkt_safi, &afi, &safi)) {
 		/* Log if AFI or SAFI is unrecognized. This is not an error
@@ -22,6 +22,7 @@
 #define _QUAGGA_BGP_ATTR_H
 
 #include "mpls.h"
+#include "typesafe.h"
 #include "bgp_attr_evpn.h"
 #include "bgpd/bgp_encap_types.h"
 #include "srte.h"
@@ -151,6 +152,8 @@ struct bgp_attr_srv6_l3vpn {
 	uint8_t transposition_offset;
 };
 
+PREDECL_HASH(attr_intern_hash);
+
 /* BGP core attribute structure. */
 struct attr {
 	/* AS Path structure */
@@ -162,6 +165,9 @@ struct attr {
 	/* Reference count of this attribute. */
 	unsigned long refcnt;
 
+	/* Intern table entry, only valid while refcnt != 0 */
+	struct attr_intern_hash_item hashitem;
+
 	/* Flag of attribute is set or not. */
 	uint64_t flag;
 
@@ -181,6 +187,12 @@ struct attr {
 	   Used on the peer outbound side. */
 	uint32_t rmap_change_flags;
 
+	/* Weight and local-pref packed for the best path decision, and
+	 * ATTR_DECISION_* flags.  Set when the attribute gets interned.
+	 */
+	uint64_t decision_key;
+	uint8_t decision_flags;
+
 	/* Multi-Protocol Nexthop, AFI IPv6 */
 	struct in6_addr mp_nexthop_global;
 	struct in6_addr mp_nexthop_local;
@@ -361,6 +373,10 @@ struct transit {
 	uint8_t *val;
 };
 
+/* attr->decision_flags */
+#define ATTR_DECISION_VALID	 (1 << 0)
+#define ATTR_DECISION_LLGR_STALE (1 << 1)
+
 /* "(void) 0" will generate a compiler error.  this is a safety check to
  * ensure we're not using a value that exceeds the bit size of attr->flag. */
 #define ATTR_FLAG_BIT(X)                                                       \
@@ -392,6 +408,7 @@ bgp_attr_parse(struct peer *peer, struct attr *attr, bgp_size_t size,
 	       struct bgp_nlri *mp_update, struct bgp_nlri *mp_withdraw);
 extern struct attr *bgp_attr_intern(struct attr *attr);
 extern void bgp_attr_unintern_sub(struct attr *attr);
+extern void bgp_attr_ref_sub(struct attr *attr);
 extern void bgp_attr_unintern(struct attr **pattr);
 extern void bgp_attr_flush(struct attr *attr);
 extern struct attr *bgp_attr_default_set(struct attr *attr, struct bgp *bgp,
@@ -416,6 +433,7 @@ extern unsigned long int attr_count(void);
 extern unsigned long int attr_unknown_count(void);
 
 /* Cluster list prototypes. */
+extern struct cluster_list *cluster_parse(struct in_addr *pnt, int length);
 extern bool cluster_loop_check(struct cluster_list *cluster,
 			       struct in_addr originator);
 
@@ -922,12 +922,13 @@ static struct stream *bmp_withdraw(const struct prefix *p,
 	return s;
 }
 
-static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
-			const struct prefix *p, struct prefix_rd *prd,
-			struct attr *attr, afi_t afi, safi_t safi,
-			time_t uptime)
+static struct stream *bmp_monitor_encode(struct peer *peer, uint8_t flags,
+					  const struct prefix *p,
+					  struct prefix_rd *prd,
+					  struct attr *attr, afi_t afi,
+					  safi_t safi, time_t uptime)
 {
-	struct stream *hdr, *msg;
+	struct stream *hdr, *msg, *s;
 	struct timeval tv = { .tv_sec = uptime, .tv_usec = 0 };
 	struct timeval uptime_real;
 
@@ -944,11 +945,24 @@ static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
 	stream_putl_at(hdr, BMP_LENGTH_POS,
 			stream_get_endp(hdr) + stream_get_endp(msg));
 
-	bmp->cnt_update++;
-	pullwr_write_stream(bmp->pullwr, hdr);
-	pullwr_write_stream(bmp->pullwr, msg);
+	s = stream_dupcat(hdr, msg, stream_get_endp(hdr));
 	stream_free(hdr);
 	stream_free(msg);
+	return s;
+}
+
+static void bmp_monitor(struct bmp *bmp, struct peer *peer, uint8_t flags,
+			const struct prefix *p, struct prefix_rd *prd,
+			struct attr *attr, afi_t afi, safi_t safi,
+			time_t uptime)
+{
+	struct stream *s;
+
+	s = bmp_monitor_encode(peer, flags, p, prd, attr, afi, safi, uptime);
+
+	bmp->cnt_update++;
+	pullwr_write_stream(bmp->pullwr, s);
+	stream_free(s);
 }
 
 static bool bmp_wrsync(struct bmp *bmp, struct pullwr *pullwr)
@@ -1127,6 +1141,20 @@ afibreak:
 	return true;
 }
 
+static void bmp_qentry_uncache(struct bmp_queue_entry *bqe)
+{
+	stream_free(bqe->monitor[0]);
+	stream_free(bqe->monitor[1]);
+	bqe->monitor[0] = bqe->monitor[1] = NULL;
+	bqe->encoded = false;
+}
+
+static void bmp_qentry_free(struct bmp_queue_entry *bqe)
+{
+	bmp_qentry_uncache(bqe);
+	XFREE(MTYPE_BMP_QUEUE, bqe);
+}
+
 static struct bmp_queue_entry *bmp_pull(struct bmp *bmp)
 {
 	struct bmp_queue_entry *bqe;
@@ -1184,6 +1212,18 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 	if (!peer_established(peer))
 		goto out;
 
+	if (bqe->encoded) {
+		for (size_t i = 0; i < array_size(bqe->monitor); i++) {
+			if (!bqe->monitor[i])
+				continue;
+
+			bmp->cnt_update++;
+			pullwr_write_stream(bmp->pullwr, bqe->monitor[i]);
+			written = true;
+		}
+		goto out;
+	}
+
 	bool is_vpn = (bqe->afi == AFI_L2VPN && bqe->safi == SAFI_EVPN) ||
 		      (bqe->safi == SAFI_MPLS_VPN);
 
@@ -1203,10 +1243,10 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 				break;
 		}
 
-		bmp_monitor(bmp, peer, BMP_PEER_FLAG_L, &bqe->p, prd,
-			    bpi ? bpi->attr : NULL, afi, safi,
-			    bpi ? bpi->uptime : monotime(NULL));
-		written = true;
+		bqe->monitor[0] = bmp_monitor_encode(
+			peer, BMP_PEER_FLAG_L, &bqe->p, prd,
+			bpi ? bpi->attr : NULL, afi, safi,
+			bpi ? bpi->uptime : monotime(NULL));
 	}
 
 	if (bmp->targets->afimon[afi][safi] & BMP_MON_PREPOLICY) {
@@ -1217,15 +1257,24 @@ static bool bmp_wrqueue(struct bmp *bmp, struct pullwr *pullwr)
 			if (adjin->peer == peer)
 				break;
 		}
-		bmp_monitor(bmp, peer, 0, &bqe->p, prd,
-			    adjin ? adjin->attr : NULL, afi, safi,
-			    adjin ? adjin->uptime : monotime(NULL));
+		bqe->monitor[1] = bmp_monitor_encode(
+			peer, 0, &bqe->p, prd, adjin ? adjin->attr : NULL, afi,
+			safi, adjin ? adjin->uptime : monotime(NULL));
+	}
+
+	for (size_t i = 0; i < array_size(bqe->monitor); i++) {
+		if (!bqe->monitor[i])
+			continue;
+
+		bmp->cnt_update++;
+		pullwr_write_stream(bmp->pullwr, bqe->monitor[i]);
 		written = true;
 	}
+	bqe->encoded = true;
 
 out:
 	if (!bqe->refcount)
-		XFREE(MTYPE_BMP_QUEUE, bqe);
+		bmp_qentry_free(bqe);
 
 	if (bn)
 		bgp_dest_unlock_node(bn);
@@ -1293,6 +1342,7 @@ static void bmp_process_one(struct bmp_targets *bt, struct bgp *bgp, afi_t afi,
 			return;
 
 		bmp_qlist_del(&bt->updlist, bqe);
+		bmp_qentry_uncache(bqe);
 	} else {
 		bqe = XMALLOC(MTYPE_BMP_QUEUE, sizeof(*bqe));
 		memcpy(bqe, &bqeref, sizeof(*bqe));
@@ -1540,7 +1590,7 @@ static void bmp_close(struct bmp *bmp)
 			XFREE(MTYPE_BMP_MIRRORQ, bmq);
 	while ((bqe = bmp_pull(bmp)))
 		if (!bqe->refcount)
-			XFREE(MTYPE_BMP_QUEUE, bqe);
+			bmp_qentry_free(bqe);
 
 	THREAD_OFF(bmp->t_read);
 	pullwr_del(bmp->pullwr);
@@ -82,6 +82,13 @@ struct bmp_queue_entry {
 
 	/* initialized only for L2VPN/EVPN (S)AFIs */
 	struct prefix_rd rd;
+
+	/* route monitoring messages (post-, pre-policy) built by the first
+	 * session that pulled this entry, for use by the other sessions of
+	 * the target.  Dropped when the entry is queued again.
+	 */
+	bool encoded;
+	struct stream *monitor[2];
 };
 
 /* This is for BMP Route Mirroring, which feeds fully raw BGP PDUs out to BMP
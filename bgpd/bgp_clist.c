@@ -273,6 +273,47 @@ struct community_list *community_list_lookup(struct community_list_handler *ch,
 	return hash_get(cm->hash, &lookup, NULL);
 }
 
+/* Hash of the entries of a community-list, 0 for a NULL community-list. */
+uint32_t community_list_hash(const struct community_list *list)
+{
+	const struct community_entry *entry;
+	uint32_t hash;
+
+	if (!list)
+		return 0;
+
+	hash = jhash_1word(list->sort, 0);
+	for (entry = list->head; entry; entry = entry->next) {
+		hash = jhash_3words(entry->direct, entry->style, entry->any,
+				    hash);
+		hash = jhash_1word((uint32_t)entry->seq, hash);
+		if (entry->config)
+			hash = jhash(entry->config, strlen(entry->config),
+				     hash);
+		if (entry->any)
+			continue;
+
+		switch (entry->style) {
+		case COMMUNITY_LIST_STANDARD:
+			hash = jhash_1word(community_hash_make(entry->u.com),
+					   hash);
+			break;
+		case LARGE_COMMUNITY_LIST_STANDARD:
+			hash = jhash_1word(lcommunity_hash_make(entry->u.lcom),
+					   hash);
+			break;
+		case EXTCOMMUNITY_LIST_STANDARD:
+			hash = jhash_1word(ecommunity_hash_make(entry->u.ecom),
+					   hash);
+			break;
+		default:
+			break;
+		}
+	}
+
+	return hash;
+}
+
 static struct community_list *
 community_list_get(struct community_list_handler *ch, const char *name,
 		   int master)
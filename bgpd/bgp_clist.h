@@ -165,6 +165,7 @@ community_list_master_lookup(struct community_list_handler *ch, int master);
 extern struct community_list *
 community_list_lookup(struct community_list_handler *c, const char *name,
 		      uint32_t name_hash, int master);
+extern uint32_t community_list_hash(const struct community_list *list);
 
 extern bool community_list_match(struct community *com,
 				 struct community_list *list);
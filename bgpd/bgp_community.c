@@ -136,7 +136,7 @@ bool community_include(struct community *com, uint32_t val)
 	val = htonl(val);
 
 	for (i = 0; i < com->size; i++)
-		if (memcmp(&val, com_nthval(com, i), sizeof(uint32_t)) == 0)
+		if (com->val[i] == val)
 			return true;
 	return false;
 }
@@ -488,10 +488,9 @@ struct community *community_intern(struct community *com)
 	/* Increment refrence counter.  */
 	find->refcnt++;
 
-	/* Make string.  */
-	if (!find->str)
-		set_community_string(find, false, true);
-
+	/* The string is built by community_str() on first use, most
+	 * communities are never displayed or matched against a regexp.
+	 */
 	return find;
 }
 
@@ -589,7 +588,7 @@ bool community_match(const struct community *com1, const struct community *com2)
 
 	/* Every community on com2 needs to be on com1 for this to match */
 	while (i < com1->size && j < com2->size) {
-		if (memcmp(com1->val + i, com2->val + j, sizeof(uint32_t)) == 0)
+		if (com1->val[i] == com2->val[j])
 			j++;
 		i++;
 	}
@@ -966,18 +965,30 @@ void bgp_aggr_community_remove(void *arg)
 void bgp_compute_aggregate_community(struct bgp_aggregate *aggregate,
 				     struct community *community)
 {
-	bgp_compute_aggregate_community_hash(aggregate, community);
-	bgp_compute_aggregate_community_val(aggregate);
+	struct community *commerge;
+
+	/* Only a community list new to the aggregate changes it, and then
+	 * it is enough to merge that one into the current value.
+	 */
+	if (!bgp_compute_aggregate_community_hash(aggregate, community))
+		return;
+
+	if (aggregate->community)
+		commerge = community_merge(aggregate->community, community);
+	else
+		commerge = community_dup(community);
+	aggregate->community = community_uniq_sort(commerge);
+	community_free(&commerge);
 }
 
 
-void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
+bool bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
 					  struct community *community)
 {
 	struct community *aggr_community = NULL;
 
 	if ((aggregate == NULL) || (community == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -997,7 +1008,7 @@ void bgp_compute_aggregate_community_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_community->refcnt++;
+	return ++aggr_community->refcnt == 1;
 }
 
 void bgp_compute_aggregate_community_val(struct bgp_aggregate *aggregate)
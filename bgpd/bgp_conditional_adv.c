@@ -23,6 +23,8 @@
 #include "bgpd/bgp_conditional_adv.h"
 #include "bgpd/bgp_vty.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_CONDITION_MAPS, "BGP condition-map list");
+
 static route_map_result_t
 bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
 				     struct route_map *rmap)
@@ -68,6 +70,152 @@ bgp_check_rmap_prefixes_in_bgp_table(struct bgp_table *table,
 	return ret;
 }
 
+/* Does any path of dest match one of the condition-maps of its table? */
+static bool bgp_conditional_adv_dest_match(struct bgp *bgp,
+					   struct bgp_dest *dest, afi_t afi,
+					   safi_t safi)
+{
+	struct attr dummy_attr;
+	struct bgp_path_info *pi;
+	struct bgp_path_info path = {0};
+	struct bgp_path_info_extra path_extra = {0};
+	const struct prefix *dest_p = bgp_dest_get_prefix(dest);
+	route_map_result_t ret;
+	uint32_t i;
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+		if (CHECK_FLAG(pi->flags, BGP_PATH_REMOVED))
+			continue;
+
+		for (i = 0; i < bgp->condition_map_count[afi][safi]; i++) {
+			dummy_attr = *pi->attr;
+			prep_for_rmap_apply(&path, &path_extra, dest, pi,
+					    pi->peer, &dummy_attr);
+			RESET_FLAG(dummy_attr.rmap_change_flags);
+
+			ret = route_map_apply(bgp->condition_maps[afi][safi][i],
+					      dest_p, &path);
+			bgp_attr_flush(&dummy_attr);
+
+			if (ret == RMAP_PERMITMATCH)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Collect the distinct condition-maps configured on the peers, and record
+ * which routes match them.  From then on only routes whose match changes
+ * need to trigger a new evaluation of the conditions.
+ */
+static void bgp_conditional_adv_maps_build(struct bgp *bgp)
+{
+	struct bgp_filter *filter;
+	struct bgp_table *table;
+	struct bgp_dest *dest;
+	struct route_map *cmap;
+	struct listnode *node;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi, tsafi;
+	uint32_t i, count;
+
+	bgp_conditional_adv_maps_free(bgp);
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		FOREACH_AFI_SAFI (afi, safi) {
+			filter = &peer->filter[afi][safi];
+			cmap = filter->advmap.cmap;
+			if (!filter->advmap.aname || !cmap)
+				continue;
+
+			/* labeled-unicast shares the unicast table */
+			tsafi = (safi == SAFI_LABELED_UNICAST) ? SAFI_UNICAST
+							       : safi;
+			count = bgp->condition_map_count[afi][tsafi];
+			for (i = 0; i < count; i++)
+				if (bgp->condition_maps[afi][tsafi][i] == cmap)
+					break;
+			if (i < count)
+				continue;
+
+			bgp->condition_maps[afi][tsafi] = XREALLOC(
+				MTYPE_BGP_CONDITION_MAPS,
+				bgp->condition_maps[afi][tsafi],
+				(count + 1) * sizeof(cmap));
+			bgp->condition_maps[afi][tsafi][count] = cmap;
+			bgp->condition_map_count[afi][tsafi] = count + 1;
+		}
+	}
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		table = bgp->rib[afi][safi];
+		if (!table || !bgp->condition_map_count[afi][safi])
+			continue;
+
+		for (dest = bgp_table_top(table); dest;
+		     dest = bgp_route_next(dest)) {
+			if (bgp_conditional_adv_dest_match(bgp, dest, afi,
+							   safi))
+				SET_FLAG(dest->flags, BGP_NODE_CONDITION_MATCH);
+			else
+				UNSET_FLAG(dest->flags,
+					   BGP_NODE_CONDITION_MATCH);
+		}
+	}
+
+	bgp->condition_maps_valid = true;
+}
+
+void bgp_conditional_adv_maps_reset(struct bgp *bgp)
+{
+	bgp->condition_maps_valid = false;
+}
+
+void bgp_conditional_adv_maps_free(struct bgp *bgp)
+{
+	afi_t afi;
+	safi_t safi;
+
+	FOREACH_AFI_SAFI (afi, safi) {
+		XFREE(MTYPE_BGP_CONDITION_MAPS, bgp->condition_maps[afi][safi]);
+		bgp->condition_map_count[afi][safi] = 0;
+	}
+	bgp->condition_maps_valid = false;
+}
+
+void bgp_conditional_adv_dest_process(struct bgp *bgp, struct bgp_dest *dest,
+				      afi_t afi, safi_t safi)
+{
+	bool match, matched;
+
+	if (safi == SAFI_LABELED_UNICAST)
+		safi = SAFI_UNICAST;
+
+	if (!bgp->condition_maps_valid)
+		bgp_conditional_adv_maps_build(bgp);
+
+	if (!bgp->condition_map_count[afi][safi])
+		return;
+
+	match = bgp_conditional_adv_dest_match(bgp, dest, afi, safi);
+	matched = CHECK_FLAG(dest->flags, BGP_NODE_CONDITION_MATCH);
+	if (match)
+		SET_FLAG(dest->flags, BGP_NODE_CONDITION_MATCH);
+	else
+		UNSET_FLAG(dest->flags, BGP_NODE_CONDITION_MATCH);
+
+	/*
+	 * With several condition-maps the route may now match a different
+	 * one than before, so any matching route counts as a change then.
+	 */
+	if (match != matched
+	    || (match && bgp->condition_map_count[afi][safi] > 1))
+		bgp->condition_table_change[afi][safi] = true;
+}
+
 static void bgp_conditional_adv_routes(struct peer *peer, afi_t afi,
 				       safi_t safi, struct bgp_table *table,
 				       struct route_map *rmap,
@@ -176,7 +324,8 @@ static void bgp_conditional_adv_timer(struct thread *t)
 	struct listnode *node, *nnode = NULL;
 	struct update_subgroup *subgrp = NULL;
 	route_map_result_t ret;
-	bool advmap_table_changed = false;
+	enum update_type prev_update_type;
+	bool config_change;
 
 	bgp = THREAD_ARG(t);
 	assert(bgp);
@@ -184,19 +333,8 @@ static void bgp_conditional_adv_timer(struct thread *t)
 	thread_add_timer(bm->master, bgp_conditional_adv_timer, bgp,
 			 bgp->condition_check_period, &bgp->t_condition_check);
 
-	/* loop through each peer and check if we have peers with
-	 * advmap_table_change attribute set, to make sure we send
-	 * conditional advertisements properly below.
-	 * peer->advmap_table_change is added on incoming BGP UPDATES,
-	 * but here it's used for outgoing UPDATES, hence we need to
-	 * check if at least one peer got advmap_table_change.
-	 */
-	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-		if (peer->advmap_table_change) {
-			advmap_table_changed = true;
-			break;
-		}
-	}
+	if (!bgp->condition_maps_valid)
+		bgp_conditional_adv_maps_build(bgp);
 
 	/* loop through each peer and advertise or withdraw routes if
 	 * advertise-map is configured and prefix(es) in condition-map
@@ -207,8 +345,11 @@ static void bgp_conditional_adv_timer(struct thread *t)
 		if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE))
 			continue;
 
-		if (!peer_established(peer))
+		/* Evaluate the conditions once the session is up again */
+		if (!peer_established(peer)) {
+			peer->advmap_table_change = true;
 			continue;
+		}
 
 		FOREACH_AFI_SAFI (afi, safi) {
 			if (!peer->afc_nego[afi][safi])
@@ -232,16 +373,17 @@ static void bgp_conditional_adv_timer(struct thread *t)
 			    || !filter->advmap.amap || !filter->advmap.cmap)
 				continue;
 
-			if (!peer->advmap_config_change[afi][safi] &&
-			    !advmap_table_changed)
+			config_change = peer->advmap_config_change[afi][safi];
+			if (!config_change && !peer->advmap_table_change
+			    && !bgp->condition_table_change[afi][pfx_rcd_safi])
 				continue;
 
 			if (BGP_DEBUG(cond_adv, COND_ADV)) {
-				if (peer->advmap_table_change)
+				if (!config_change)
 					zlog_debug(
 						"%s: %s - routes changed in BGP table.",
 						__func__, peer->host);
-				if (peer->advmap_config_change[afi][safi])
+				else
 					zlog_debug(
 						"%s: %s for %s - advertise/condition map configuration is changed.",
 						__func__, peer->host,
@@ -259,6 +401,7 @@ static void bgp_conditional_adv_timer(struct thread *t)
 			 * condition and return value of condition-map
 			 * validation.
 			 */
+			prev_update_type = filter->advmap.update_type;
 			if (filter->advmap.condition == CONDITION_EXIST)
 				filter->advmap.update_type =
 					(ret == RMAP_PERMITMATCH)
@@ -292,7 +435,7 @@ static void bgp_conditional_adv_timer(struct thread *t)
 			 * There is a change in route-map, match-rule, ACLs,
 			 * or route-map filter configuration on the same peer.
 			 */
-			if (peer->advmap_config_change[afi][safi]) {
+			if (config_change) {
 
 				bgp_cond_adv_debug(
 					"%s: Configuration is changed on peer %s for %s, send the normal update first.",
@@ -309,6 +452,15 @@ static void bgp_conditional_adv_timer(struct thread *t)
 				peer->advmap_config_change[afi][safi] = false;
 			}
 
+			/* While the advertisement state stays the same, route
+			 * updates already honour it through
+			 * subgroup_announce_check(), so only walk the table
+			 * when something changed for this peer.
+			 */
+			if (!config_change
+			    && prev_update_type == filter->advmap.update_type)
+				continue;
+
 			/* Send update as per the conditional advertisement */
 			bgp_conditional_adv_routes(peer, afi, safi, table,
 						   filter->advmap.amap,
@@ -316,6 +468,9 @@ static void bgp_conditional_adv_timer(struct thread *t)
 		}
 		peer->advmap_table_change = false;
 	}
+
+	memset(bgp->condition_table_change, 0,
+	       sizeof(bgp->condition_table_change));
 }
 
 void bgp_conditional_adv_enable(struct peer *peer, afi_t afi, safi_t safi)
@@ -365,6 +520,7 @@ void bgp_conditional_adv_disable(struct peer *peer, afi_t afi, safi_t safi)
 
 	/* Last filter removed. So cancel conditional routes polling thread. */
 	THREAD_OFF(bgp->t_condition_check);
+	bgp_conditional_adv_maps_free(bgp);
 }
 
 static void peer_advertise_map_filter_update(struct peer *peer, afi_t afi,
@@ -378,6 +534,7 @@ static void peer_advertise_map_filter_update(struct peer *peer, afi_t afi,
 	bool filter_exists = false;
 
 	filter = &peer->filter[afi][safi];
+	bgp_conditional_adv_maps_reset(peer->bgp);
 
 	/* advertise-map is already configured. */
 	if (filter->advmap.aname) {
@@ -47,6 +47,17 @@ extern void bgp_conditional_adv_enable(struct peer *peer, afi_t afi,
 				       safi_t safi);
 extern void bgp_conditional_adv_disable(struct peer *peer, afi_t afi,
 					safi_t safi);
+/*
+ * dest has been through best path selection; note whether a condition-map
+ * may now evaluate differently.  Only relevant while any advertise-map is
+ * configured on bgp.
+ */
+extern void bgp_conditional_adv_dest_process(struct bgp *bgp,
+					     struct bgp_dest *dest, afi_t afi,
+					     safi_t safi);
+/* Condition-maps changed, look them up again before the next use */
+extern void bgp_conditional_adv_maps_reset(struct bgp *bgp);
+extern void bgp_conditional_adv_maps_free(struct bgp *bgp);
 extern int peer_advertise_map_set(struct peer *peer, afi_t afi, safi_t safi,
 				  const char *advertise_name,
 				  struct route_map *advertise_map,
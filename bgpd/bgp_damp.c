@@ -40,10 +40,56 @@
 /* Global variable to access damping configuration */
 static struct bgp_damp_config damp[AFI_MAX][SAFI_MAX];
 
-/* Utility macro to add and delete BGP dampening information to no
-   used list.  */
-#define BGP_DAMP_LIST_ADD(N, A) BGP_PATH_INFO_ADD(N, A, no_reuse_list)
-#define BGP_DAMP_LIST_DEL(N, A) BGP_PATH_INFO_DEL(N, A, no_reuse_list)
+/* Reuse list holding the routes of expired reuse lists */
+#define BGP_REUSE_PENDING(bdc) ((bdc)->reuse_list_size)
+
+/* Routes evaluated between checks for whether to yield */
+#define BGP_REUSE_YIELD_CHECK 256
+
+/* List holding bdi: one of the reuse lists, or the no reuse list.  */
+static struct bgp_damp_info **bgp_damp_list_head(struct bgp_damp_info *bdi,
+						 struct bgp_damp_config *bdc)
+{
+	if (bdi->index < 0)
+		return &bdc->no_reuse_list;
+
+	return &bdc->reuse_list[bdi->index];
+}
+
+static void bgp_damp_list_add(struct bgp_damp_info *bdi,
+			      struct bgp_damp_config *bdc, int index)
+{
+	struct bgp_damp_info **head;
+
+	bdi->index = index;
+	head = bgp_damp_list_head(bdi, bdc);
+
+	bdi->prev = NULL;
+	bdi->next = *head;
+	if (*head)
+		(*head)->prev = bdi;
+	*head = bdi;
+}
+
+/* Delete BGP dampening information from the list it is on.  */
+static void bgp_damp_list_delete(struct bgp_damp_info *bdi,
+				 struct bgp_damp_config *bdc)
+{
+	if (bdi->next)
+		bdi->next->prev = bdi->prev;
+	if (bdi->prev)
+		bdi->prev->next = bdi->next;
+	else
+		*bgp_damp_list_head(bdi, bdc) = bdi->next;
+	bdi->next = bdi->prev = NULL;
+}
+
+/* Add BGP dampening information to no used list.  */
+static void bgp_no_reuse_list_add(struct bgp_damp_info *bdi,
+				  struct bgp_damp_config *bdc)
+{
+	bgp_damp_list_add(bdi, bdc, -1);
+}
 
 /* Calculate reuse list index by penalty value.  */
 static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
@@ -72,27 +118,7 @@ static int bgp_reuse_index(int penalty, struct bgp_damp_config *bdc)
 static void bgp_reuse_list_add(struct bgp_damp_info *bdi,
 			       struct bgp_damp_config *bdc)
 {
-	int index;
-
-	index = bdi->index = bgp_reuse_index(bdi->penalty, bdc);
-
-	bdi->prev = NULL;
-	bdi->next = bdc->reuse_list[index];
-	if (bdc->reuse_list[index])
-		bdc->reuse_list[index]->prev = bdi;
-	bdc->reuse_list[index] = bdi;
-}
-
-/* Delete BGP dampening information from reuse list.  */
-static void bgp_reuse_list_delete(struct bgp_damp_info *bdi,
-				  struct bgp_damp_config *bdc)
-{
-	if (bdi->next)
-		bdi->next->prev = bdi->prev;
-	if (bdi->prev)
-		bdi->prev->next = bdi->next;
-	else
-		bdc->reuse_list[bdi->index] = bdi->next;
+	bgp_damp_list_add(bdi, bdc, bgp_reuse_index(bdi->penalty, bdc));
 }
 
 /* Return decayed penalty value.  */
@@ -100,7 +126,7 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 {
 	unsigned int i;
 
-	i = (int)((double)tdiff / DELTA_T);
+	i = tdiff / DELTA_T;
 
 	if (i == 0)
 		return penalty;
@@ -111,36 +137,30 @@ int bgp_damp_decay(time_t tdiff, int penalty, struct bgp_damp_config *bdc)
 	return (int)(penalty * bdc->decay_array[i]);
 }
 
-/* Handler of reuse timer event.  Each route in the current reuse-list
-   is evaluated.  RFC2439 Section 4.8.7.  */
-static void bgp_reuse_timer(struct thread *t)
+/* Evaluate the routes of the expired reuse list, yielding as needed so
+ * a burst of routes coming up for reuse at once doesn't stall the main
+ * thread.  RFC2439 Section 4.8.7.
+ */
+static void bgp_reuse_process(struct thread *t)
 {
 	struct bgp_damp_info *bdi;
-	struct bgp_damp_info *next;
-	time_t t_now, t_diff;
-
 	struct bgp_damp_config *bdc = THREAD_ARG(t);
-
-	bdc->t_reuse = NULL;
-	thread_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
-			 &bdc->t_reuse);
+	struct bgp_damp_info **pending;
+	unsigned int count = 0;
+	time_t t_now, t_diff;
 
 	t_now = monotime(NULL);
+	pending = &bdc->reuse_list[BGP_REUSE_PENDING(bdc)];
 
-	/* 1.  save a pointer to the current zeroth queue head and zero the
-	   list head entry.  */
-	bdi = bdc->reuse_list[bdc->reuse_offset];
-	bdc->reuse_list[bdc->reuse_offset] = NULL;
-
-	/* 2.  set offset = modulo reuse-list-size ( offset + 1 ), thereby
-	   rotating the circular queue of list-heads.  */
-	bdc->reuse_offset = (bdc->reuse_offset + 1) % bdc->reuse_list_size;
-
-	/* 3. if ( the saved list head pointer is non-empty ) */
-	for (; bdi; bdi = next) {
+	while ((bdi = *pending)) {
 		struct bgp *bgp = bdi->path->peer->bgp;
 
-		next = bdi->next;
+		if ((++count % BGP_REUSE_YIELD_CHECK) == 0
+		    && thread_should_yield(t)) {
+			thread_add_event(bm->master, bgp_reuse_process, bdc, 0,
+					 &bdc->t_reuse_process);
+			return;
+		}
 
 		/* Set t-diff = t-now - t-updated.  */
 		t_diff = t_now - bdi->t_updated;
@@ -171,15 +191,62 @@ static void bgp_reuse_timer(struct thread *t)
 
 			if (bdi->penalty <= bdc->reuse_limit / 2.0)
 				bgp_damp_info_free(bdi, 1, bdc->afi, bdc->safi);
-			else
-				BGP_DAMP_LIST_ADD(bdc, bdi);
-		} else
+			else {
+				bgp_damp_list_delete(bdi, bdc);
+				bgp_no_reuse_list_add(bdi, bdc);
+			}
+		} else {
 			/* Re-insert into another list (See RFC2439 Section
 			 * 4.8.6).  */
+			bgp_damp_list_delete(bdi, bdc);
 			bgp_reuse_list_add(bdi, bdc);
+		}
 	}
 }
 
+/* Handler of reuse timer event.  The current reuse-list is handed to
+   bgp_reuse_process().  RFC2439 Section 4.8.7.  */
+static void bgp_reuse_timer(struct thread *t)
+{
+	struct bgp_damp_info *bdi;
+	struct bgp_damp_info *last = NULL;
+	struct bgp_damp_info **pending;
+
+	struct bgp_damp_config *bdc = THREAD_ARG(t);
+
+	bdc->t_reuse = NULL;
+	thread_add_timer(bm->master, bgp_reuse_timer, bdc, DELTA_REUSE,
+			 &bdc->t_reuse);
+
+	/* 1.  save a pointer to the current zeroth queue head and zero the
+	   list head entry.  */
+	bdi = bdc->reuse_list[bdc->reuse_offset];
+	bdc->reuse_list[bdc->reuse_offset] = NULL;
+
+	/* 2.  set offset = modulo reuse-list-size ( offset + 1 ), thereby
+	   rotating the circular queue of list-heads.  */
+	bdc->reuse_offset = (bdc->reuse_offset + 1) % bdc->reuse_list_size;
+
+	/* 3. if ( the saved list head pointer is non-empty ), queue it up
+	   for evaluation, ahead of whatever is left of the previous one.  */
+	if (!bdi)
+		return;
+
+	pending = &bdc->reuse_list[BGP_REUSE_PENDING(bdc)];
+	for (last = bdi;; last = last->next) {
+		last->index = BGP_REUSE_PENDING(bdc);
+		if (!last->next)
+			break;
+	}
+	last->next = *pending;
+	if (*pending)
+		(*pending)->prev = last;
+	*pending = bdi;
+
+	thread_add_event(bm->master, bgp_reuse_process, bdc, 0,
+			 &bdc->t_reuse_process);
+}
+
 /* A route becomes unreachable (RFC2439 Section 4.8.2).  */
 int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		      afi_t afi, safi_t safi, int attr_change)
@@ -212,11 +279,10 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 		bdi->flap = 1;
 		bdi->start_time = t_now;
 		bdi->suppress_time = 0;
-		bdi->index = -1;
 		bdi->afi = afi;
 		bdi->safi = safi;
 		(bgp_path_info_extra_get(path))->damp_info = bdi;
-		BGP_DAMP_LIST_ADD(bdc, bdi);
+		bgp_no_reuse_list_add(bdi, bdc);
 	} else {
 		last_penalty = bdi->penalty;
 
@@ -244,7 +310,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 	if (CHECK_FLAG(bdi->path->flags, BGP_PATH_DAMPED)) {
 		/* If decay rate isn't equal to 0, reinsert brn. */
 		if (bdi->penalty != last_penalty && bdi->index >= 0) {
-			bgp_reuse_list_delete(bdi, bdc);
+			bgp_damp_list_delete(bdi, bdc);
 			bgp_reuse_list_add(bdi, bdc);
 		}
 		return BGP_DAMP_SUPPRESSED;
@@ -255,7 +321,7 @@ int bgp_damp_withdraw(struct bgp_path_info *path, struct bgp_dest *dest,
 	if (bdi->penalty >= bdc->suppress_value) {
 		bgp_path_info_set_flag(dest, path, BGP_PATH_DAMPED);
 		bdi->suppress_time = t_now;
-		BGP_DAMP_LIST_DEL(bdc, bdi);
+		bgp_damp_list_delete(bdi, bdc);
 		bgp_reuse_list_add(bdi, bdc);
 	}
 
@@ -286,8 +352,8 @@ int bgp_damp_update(struct bgp_path_info *path, struct bgp_dest *dest,
 	else if (CHECK_FLAG(bdi->path->flags, BGP_PATH_DAMPED)
 		 && (bdi->penalty < bdc->reuse_limit)) {
 		bgp_path_info_unset_flag(dest, path, BGP_PATH_DAMPED);
-		bgp_reuse_list_delete(bdi, bdc);
-		BGP_DAMP_LIST_ADD(bdc, bdi);
+		bgp_damp_list_delete(bdi, bdc);
+		bgp_no_reuse_list_add(bdi, bdc);
 		bdi->suppress_time = 0;
 		status = BGP_DAMP_USED;
 	} else
@@ -313,10 +379,7 @@ void bgp_damp_info_free(struct bgp_damp_info *bdi, int withdraw, afi_t afi,
 	path = bdi->path;
 	path->extra->damp_info = NULL;
 
-	if (CHECK_FLAG(path->flags, BGP_PATH_DAMPED))
-		bgp_reuse_list_delete(bdi, bdc);
-	else
-		BGP_DAMP_LIST_DEL(bdc, bdi);
+	bgp_damp_list_delete(bdi, bdc);
 
 	bgp_path_info_unset_flag(bdi->dest, path,
 				 BGP_PATH_HISTORY | BGP_PATH_DAMPED);
@@ -365,9 +428,10 @@ static void bgp_damp_parameter_set(int hlife, int reuse, int sup, int maxsup,
 		i = REUSE_LIST_SIZE;
 	bdc->reuse_list_size = i;
 
-	bdc->reuse_list =
-		XCALLOC(MTYPE_BGP_DAMP_ARRAY,
-			bdc->reuse_list_size * sizeof(struct bgp_reuse_node *));
+	/* plus the list of routes pending evaluation */
+	bdc->reuse_list = XCALLOC(MTYPE_BGP_DAMP_ARRAY,
+				  (bdc->reuse_list_size + 1)
+					  * sizeof(struct bgp_damp_info *));
 
 	/* Reuse-array computations */
 	bdc->reuse_index = XCALLOC(MTYPE_BGP_DAMP_ARRAY,
@@ -439,7 +503,7 @@ void bgp_damp_info_clean(afi_t afi, safi_t safi)
 
 	bdc->reuse_offset = 0;
 
-	for (i = 0; i < bdc->reuse_list_size; i++) {
+	for (i = 0; i <= BGP_REUSE_PENDING(bdc); i++) {
 		if (!bdc->reuse_list[i])
 			continue;
 
@@ -466,6 +530,7 @@ int bgp_damp_disable(struct bgp *bgp, afi_t afi, safi_t safi)
 
 	/* Cancel reuse event. */
 	THREAD_OFF(bdc->t_reuse);
+	THREAD_OFF(bdc->t_reuse_process);
 
 	/* Clean BGP dampening information.  */
 	bgp_damp_info_clean(afi, safi);
@@ -51,7 +51,7 @@ struct bgp_damp_info {
 	/* Back reference to bgp_node. */
 	struct bgp_dest *dest;
 
-	/* Current index in the reuse_list. */
+	/* Current index in the reuse_list, -1 for the no_reuse_list. */
 	int index;
 
 	/* Last time message type. */
@@ -99,7 +99,9 @@ struct bgp_damp_config {
 	/* Reuse index array per-set based. */
 	int *reuse_index;
 
-	/* Reuse list array per-set based. */
+	/* Reuse list array per-set based, and after its reuse_list_size
+	 * slots the routes of expired slots still to be evaluated.
+	 */
 	struct bgp_damp_info **reuse_list;
 	int reuse_offset;
 
@@ -108,6 +110,7 @@ struct bgp_damp_config {
 
 	/* Reuse timer thread per-set base. */
 	struct thread *t_reuse;
+	struct thread *t_reuse_process;
 
 	afi_t afi;
 	safi_t safi;
@@ -400,43 +400,107 @@ bgp_dump_route_node_record(int afi, struct bgp_dest *dest,
 }
 
 
-/* Runs under child process. */
-static unsigned int bgp_dump_routes_func(int afi, int first_run,
-					 unsigned int seq)
-{
-	struct bgp_path_info *path;
-	struct bgp_dest *dest;
+/*
+ * A routes dump is spread over several events, BGP_DUMP_ROUTES_WALK_MAX
+ * bgp_dests at a time, so a full table doesn't hold up the main thread
+ * for seconds.  Between two runs the bgp_dest to continue at is kept
+ * locked, and the instance too.  Routes changing while the dump is in
+ * progress are dumped in whatever state the walk finds them; peers
+ * coming up after the peer index table was written are dumped as the
+ * local peer (index 0).
+ */
+#define BGP_DUMP_ROUTES_WALK_MAX 1000
+
+static struct bgp_dump_routes_walk {
 	struct bgp *bgp;
-	struct bgp_table *table;
+	afi_t afi;
+	struct bgp_dest *dest;
+	unsigned int seq;
+	struct thread *t_walk;
+} bgp_dump_routes_walk;
 
-	bgp = bgp_get_default();
-	if (!bgp)
-		return seq;
+static void bgp_dump_routes_walk_stop(void)
+{
+	struct bgp_dump_routes_walk *walk = &bgp_dump_routes_walk;
 
-	if (bgp_dump_routes.fp == NULL)
-		return seq;
+	THREAD_OFF(walk->t_walk);
 
-	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6 peers,
-	   so this should only be done on the first call to
-	   bgp_dump_routes_func.
-	   ( this function will be called once for ipv4 and once for ipv6 ) */
-	if (first_run)
-		bgp_dump_routes_index_table(bgp);
+	if (walk->dest) {
+		bgp_dest_unlock_node(walk->dest);
+		walk->dest = NULL;
+	}
 
-	/* Walk down each BGP route. */
-	table = bgp->rib[afi][SAFI_UNICAST];
+	if (walk->bgp) {
+		bgp_unlock(walk->bgp);
+		walk->bgp = NULL;
+	}
+}
+
+static void bgp_dump_routes_walk_func(struct thread *t)
+{
+	struct bgp_dump_routes_walk *walk = &bgp_dump_routes_walk;
+	struct bgp_path_info *path;
+	unsigned int count = 0;
 
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		path = bgp_dest_get_bgp_path_info(dest);
+	if (CHECK_FLAG(walk->bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS)) {
+		bgp_dump_routes_walk_stop();
+		fclose(bgp_dump_routes.fp);
+		bgp_dump_routes.fp = NULL;
+		return;
+	}
+
+	while (walk->dest && count++ < BGP_DUMP_ROUTES_WALK_MAX) {
+		path = bgp_dest_get_bgp_path_info(walk->dest);
 		while (path) {
-			path = bgp_dump_route_node_record(afi, dest, path, seq);
-			seq++;
+			path = bgp_dump_route_node_record(walk->afi, walk->dest,
+							  path, walk->seq);
+			walk->seq++;
+		}
+
+		walk->dest = bgp_route_next(walk->dest);
+		if (!walk->dest && walk->afi == AFI_IP) {
+			walk->afi = AFI_IP6;
+			walk->dest = bgp_table_top(
+				walk->bgp->rib[AFI_IP6][SAFI_UNICAST]);
 		}
 	}
 
-	fflush(bgp_dump_routes.fp);
+	if (walk->dest) {
+		thread_add_event(bm->master, bgp_dump_routes_walk_func, NULL, 0,
+				 &walk->t_walk);
+		return;
+	}
+
+	bgp_dump_routes_walk_stop();
+
+	/* For a RIB dump there's no point in leaving the file open until
+	 * the next scheduled dump starts.
+	 */
+	fclose(bgp_dump_routes.fp);
+	bgp_dump_routes.fp = NULL;
+}
+
+static bool bgp_dump_routes_func(void)
+{
+	struct bgp_dump_routes_walk *walk = &bgp_dump_routes_walk;
+	struct bgp *bgp;
+
+	bgp = bgp_get_default();
+	if (!bgp)
+		return false;
 
-	return seq;
+	/* Note that bgp_dump_routes_index_table will do ipv4 and ipv6
+	 * peers. */
+	bgp_dump_routes_index_table(bgp);
+
+	walk->bgp = bgp_lock(bgp);
+	walk->afi = AFI_IP;
+	walk->seq = 0;
+	walk->dest = bgp_table_top(bgp->rib[AFI_IP][SAFI_UNICAST]);
+
+	thread_add_event(bm->master, bgp_dump_routes_walk_func, NULL, 0,
+			 &walk->t_walk);
+	return true;
 }
 
 static void bgp_dump_interval_func(struct thread *t)
@@ -444,16 +508,18 @@ static void bgp_dump_interval_func(struct thread *t)
 	struct bgp_dump *bgp_dump;
 	bgp_dump = THREAD_ARG(t);
 
-	/* Reschedule dump even if file couldn't be opened this time... */
-	if (bgp_dump_open_file(bgp_dump) != NULL) {
+	/* Reschedule dump even if file couldn't be opened this time, or the
+	 * previous routes dump is still being written.
+	 */
+	if (bgp_dump->type == BGP_DUMP_ROUTES && bgp_dump_routes_walk.bgp) {
+		flog_warn(EC_BGP_DUMP,
+			  "%s: previous routes dump still in progress, skipping",
+			  __func__);
+	} else if (bgp_dump_open_file(bgp_dump) != NULL) {
 		/* In case of bgp_dump_routes, we need special route dump
-		 * function. */
-		if (bgp_dump->type == BGP_DUMP_ROUTES) {
-			unsigned int seq = bgp_dump_routes_func(AFI_IP, 1, 0);
-			bgp_dump_routes_func(AFI_IP6, 0, seq);
-			/* Close the file now. For a RIB dump there's no point
-			 * in leaving
-			 * it open until the next scheduled dump starts. */
+		 * function, which closes the file when done. */
+		if (bgp_dump->type == BGP_DUMP_ROUTES
+		    && !bgp_dump_routes_func()) {
 			fclose(bgp_dump->fp);
 			bgp_dump->fp = NULL;
 		}
@@ -695,6 +761,9 @@ static int bgp_dump_unset(struct bgp_dump *bgp_dump)
 	/* Removing file name. */
 	XFREE(MTYPE_BGP_DUMP_STR, bgp_dump->filename);
 
+	if (bgp_dump == &bgp_dump_routes)
+		bgp_dump_routes_walk_stop();
+
 	/* Closing file. */
 	if (bgp_dump->fp) {
 		fclose(bgp_dump->fp);
@@ -313,10 +313,7 @@ struct ecommunity *ecommunity_intern(struct ecommunity *ecom)
 
 	find->refcnt++;
 
-	if (!find->str)
-		find->str =
-			ecommunity_ecom2str(find, ECOMMUNITY_FORMAT_DISPLAY, 0);
-
+	/* The string is built by ecommunity_str() on first use */
 	return find;
 }
 
@@ -1472,18 +1469,31 @@ void bgp_aggr_ecommunity_remove(void *arg)
 void bgp_compute_aggregate_ecommunity(struct bgp_aggregate *aggregate,
 				      struct ecommunity *ecommunity)
 {
-	bgp_compute_aggregate_ecommunity_hash(aggregate, ecommunity);
-	bgp_compute_aggregate_ecommunity_val(aggregate);
+	struct ecommunity *ecommerge;
+
+	/* Only an ecommunity new to the aggregate changes it, and then it
+	 * is enough to merge that one into the current value.
+	 */
+	if (!bgp_compute_aggregate_ecommunity_hash(aggregate, ecommunity))
+		return;
+
+	if (aggregate->ecommunity)
+		ecommerge = ecommunity_merge(aggregate->ecommunity,
+					     ecommunity);
+	else
+		ecommerge = ecommunity_dup(ecommunity);
+	aggregate->ecommunity = ecommunity_uniq_sort(ecommerge);
+	ecommunity_free(&ecommerge);
 }
 
 
-void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
+bool bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
 					   struct ecommunity *ecommunity)
 {
 	struct ecommunity *aggr_ecommunity = NULL;
 
 	if ((aggregate == NULL) || (ecommunity == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -1503,7 +1513,7 @@ void bgp_compute_aggregate_ecommunity_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_ecommunity->refcnt++;
+	return ++aggr_ecommunity->refcnt == 1;
 }
 
 void bgp_compute_aggregate_ecommunity_val(struct bgp_aggregate *aggregate)
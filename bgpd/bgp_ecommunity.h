@@ -323,7 +323,7 @@ extern void bgp_compute_aggregate_ecommunity(
 					struct bgp_aggregate *aggregate,
 					struct ecommunity *ecommunity);
 
-extern void bgp_compute_aggregate_ecommunity_hash(
+extern bool bgp_compute_aggregate_ecommunity_hash(
 					struct bgp_aggregate *aggregate,
 					struct ecommunity *ecommunity);
 extern void bgp_compute_aggregate_ecommunity_val(
@@ -187,6 +187,12 @@ static struct log_ref ferr_bgp_warn[] = {
 		.description = "The BGP peer does not seem to be receiving or processing any data received from us, causing updates to be delayed.",
 		.suggestion = "Check connectivity to the peer and that it is not overloaded",
 	},
+	{
+		.code = EC_BGP_MEMORY_PRESSURE_TEARDOWN,
+		.title = "BGP is shutting down a peer due to critical memory pressure",
+		.description = "The daemon is about to run out of memory and \"bgp memory-pressure teardown\" is configured; the peer with the most accepted prefixes was shut down to free memory.",
+		.suggestion = "Find out why the peer sent so many prefixes, e.g. a route leak, and configure maximum-prefix for it.  The peer stays down until cleared with \"clear bgp\"",
+	},
 	{
 		.code = END_FERR,
 	}
@@ -105,6 +105,7 @@ enum bgp_log_refs {
 	EC_BGP_NO_LL_ADDRESS_AVAILABLE,
 	EC_BGP_SENDQ_STUCK_WARN,
 	EC_BGP_SENDQ_STUCK_PROPER,
+	EC_BGP_MEMORY_PRESSURE_TEARDOWN,
 };
 
 extern void bgp_error_init(void);
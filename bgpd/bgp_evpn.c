@@ -54,6 +54,7 @@
 #include "bgpd/bgp_mac.h"
 #include "bgpd/bgp_vty.h"
 #include "bgpd/bgp_nht.h"
+#include "bgpd/bgp_rtc.h"
 #include "bgpd/bgp_trace.h"
 
 /*
@@ -64,6 +65,16 @@ DEFINE_QOBJ_TYPE(bgp_evpn_es);
 
 DEFINE_MTYPE_STATIC(BGPD, VRF_ROUTE_TARGET, "L3 Route Target");
 
+DECLARE_DLIST(bgp_evpn_vni_install, struct bgpevpn, install_item);
+
+/* VNIs that became live and still need their remote routes installed, see
+ * install_routes_for_vnis_queued().
+ */
+static struct bgp_evpn_vni_install_head vni_install_queue =
+	INIT_DLIST(vni_install_queue);
+static struct thread *t_vni_install;
+static uint32_t vni_install_stamp;
+
 /*
  * Static function declarations
  */
@@ -168,6 +179,7 @@ static struct vrf_irt_node *vrf_import_rt_new(struct ecommunity_val *rt)
 
 	/* Add to hash */
 	(void)hash_get(bgp_evpn->vrf_import_rt_hash, irt, hash_alloc_intern);
+	bgp_rtc_local_changed();
 
 	return irt;
 }
@@ -187,6 +199,7 @@ static void vrf_import_rt_free(struct vrf_irt_node *irt)
 	}
 
 	hash_release(bgp_evpn->vrf_import_rt_hash, irt);
+	bgp_rtc_local_changed();
 	list_delete(&irt->vrfs);
 	XFREE(MTYPE_BGP_EVPN_VRF_IMPORT_RT, irt);
 }
@@ -272,6 +285,7 @@ static struct irt_node *import_rt_new(struct bgp *bgp,
 
 	/* Add to hash */
 	(void)hash_get(bgp->import_rt_hash, irt, hash_alloc_intern);
+	bgp_rtc_local_changed();
 
 	return irt;
 }
@@ -282,6 +296,7 @@ static struct irt_node *import_rt_new(struct bgp *bgp,
 static void import_rt_free(struct bgp *bgp, struct irt_node *irt)
 {
 	hash_release(bgp->import_rt_hash, irt);
+	bgp_rtc_local_changed();
 	list_delete(&irt->vnis);
 	XFREE(MTYPE_BGP_EVPN_IMPORT_RT, irt);
 }
@@ -338,16 +353,7 @@ int bgp_evpn_route_target_cmp(struct ecommunity *ecom1,
 	if (!ecom1 && !ecom2)
 		return 0;
 
-	if (ecom1->str && !ecom2->str)
-		return -1;
-
-	if (!ecom1->str && ecom2->str)
-		return 1;
-
-	if (!ecom1->str && !ecom2->str)
-		return 0;
-
-	return strcmp(ecom1->str, ecom2->str);
+	return strcmp(ecommunity_str(ecom1), ecommunity_str(ecom2));
 }
 
 /*
@@ -2785,8 +2791,8 @@ bgp_create_evpn_bgp_path_info(struct bgp_path_info *parent_pi,
 		memcpy(&pi->extra->label, &parent_pi->extra->label,
 		       sizeof(pi->extra->label));
 		pi->extra->num_labels = parent_pi->extra->num_labels;
-		pi->extra->igpmetric = parent_pi->extra->igpmetric;
 	}
+	pi->igpmetric = parent_pi->igpmetric;
 
 	bgp_path_info_add(dest, pi);
 
@@ -3818,6 +3824,177 @@ static int uninstall_routes_for_vni(struct bgp *bgp, struct bgpevpn *vpn)
 						0);
 }
 
+/*
+ * Install route in those of the VNIs (list) that are queued for installing
+ * and did not get it yet through another RT of the route.
+ */
+static void install_route_in_queued_vnis(struct bgp *bgp,
+					 const struct prefix_evpn *evp,
+					 struct bgp_path_info *pi,
+					 struct list *vnis)
+{
+	struct bgpevpn *vpn;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(vnis, node, vpn)) {
+		if (!bgp_evpn_vni_install_anywhere(vpn)
+		    || vpn->install_stamp == vni_install_stamp)
+			continue;
+		vpn->install_stamp = vni_install_stamp;
+
+		if (!is_vni_live(vpn))
+			continue;
+
+		if (install_evpn_route_entry(bgp, vpn, evp, pi))
+			flog_err(EC_BGP_EVPN_FAIL,
+				 "%u: Failed to install EVPN %s route in VNI %u",
+				 bgp->vrf_id,
+				 evp->prefix.route_type == BGP_EVPN_MAC_IP_ROUTE
+					 ? "MACIP"
+					 : "IMET",
+				 vpn->vni);
+	}
+}
+
+/*
+ * Install route in all queued VNIs matching one of its RTs, see
+ * is_route_matching_for_vni().
+ */
+static void install_route_in_queued_vnis_by_rt(struct bgp *bgp,
+					       const struct prefix_evpn *evp,
+					       struct bgp_path_info *pi)
+{
+	struct attr *attr = pi->attr;
+	struct ecommunity *ecom;
+	uint32_t i;
+
+	if (!(attr->flag & ATTR_FLAG_BIT(BGP_ATTR_EXT_COMMUNITIES)))
+		return;
+
+	ecom = bgp_attr_get_ecommunity(attr);
+	if (!ecom || !ecom->size)
+		return;
+
+	vni_install_stamp++;
+
+	for (i = 0; i < ecom->size; i++) {
+		uint8_t *pnt;
+		uint8_t type, sub_type;
+		struct ecommunity_val *eval;
+		struct ecommunity_val eval_tmp;
+		struct irt_node *irt;
+
+		/* Only deal with RTs */
+		pnt = (ecom->val + (i * ecom->unit_size));
+		eval = (struct ecommunity_val *)(ecom->val
+						 + (i * ecom->unit_size));
+		type = *pnt++;
+		sub_type = *pnt++;
+		if (sub_type != ECOMMUNITY_ROUTE_TARGET)
+			continue;
+
+		irt = lookup_import_rt(bgp, eval);
+		if (irt)
+			install_route_in_queued_vnis(bgp, evp, pi, irt->vnis);
+
+		/* Also check for non-exact match */
+		if (type != ECOMMUNITY_ENCODE_AS
+		    && type != ECOMMUNITY_ENCODE_AS4
+		    && type != ECOMMUNITY_ENCODE_IP)
+			continue;
+
+		memcpy(&eval_tmp, eval, ecom->unit_size);
+		mask_ecom_global_admin(&eval_tmp, eval);
+		irt = lookup_import_rt(bgp, &eval_tmp);
+		if (irt)
+			install_route_in_queued_vnis(bgp, evp, pi, irt->vnis);
+	}
+}
+
+/*
+ * Install the existing remote routes applicable for all the VNIs queued by
+ * install_routes_for_vni_queue().  Rather than walking the entire global
+ * routing table for each VNI, the table is walked once per route type and
+ * the VNIs are found through the import RTs of each route.
+ */
+static void install_routes_for_vnis_queued(struct thread *t)
+{
+	static const bgp_evpn_route_type rtypes[] = {
+		BGP_EVPN_IMET_ROUTE,
+		BGP_EVPN_AD_ROUTE,
+		BGP_EVPN_MAC_IP_ROUTE,
+	};
+	struct bgp *bgp = THREAD_ARG(t);
+	struct bgp_dest *rd_dest, *dest;
+	struct bgp_table *table;
+	struct bgp_path_info *pi;
+	size_t r;
+
+	/* Install type-3 routes followed by type-2 routes, as for a single
+	 * VNI.  EVPN routes are a 2-level table.
+	 */
+	for (r = 0; r < array_size(rtypes); r++) {
+		for (rd_dest = bgp_table_top(bgp->rib[AFI_L2VPN][SAFI_EVPN]);
+		     rd_dest; rd_dest = bgp_route_next(rd_dest)) {
+			table = bgp_dest_get_bgp_table_info(rd_dest);
+			if (!table)
+				continue;
+
+			for (dest = bgp_table_top(table); dest;
+			     dest = bgp_route_next(dest)) {
+				const struct prefix_evpn *evp =
+					(const struct prefix_evpn *)
+						bgp_dest_get_prefix(dest);
+
+				if (evp->prefix.route_type != rtypes[r])
+					continue;
+
+				for (pi = bgp_dest_get_bgp_path_info(dest); pi;
+				     pi = pi->next) {
+					/* Consider "valid" remote routes */
+					if (!(CHECK_FLAG(pi->flags,
+							 BGP_PATH_VALID)
+					      && pi->type == ZEBRA_ROUTE_BGP
+					      && pi->sub_type
+							 == BGP_ROUTE_NORMAL))
+						continue;
+
+					install_route_in_queued_vnis_by_rt(
+						bgp, evp, pi);
+				}
+			}
+		}
+	}
+
+	while (bgp_evpn_vni_install_pop(&vni_install_queue))
+		;
+}
+
+/*
+ * Queue installing the existing remote routes for a VNI that became live.
+ * VNIs typically come up in large numbers (e.g. when zebra connects), which
+ * are then handled together.
+ */
+static void install_routes_for_vni_queue(struct bgp *bgp, struct bgpevpn *vpn)
+{
+	if (!bgp_evpn_vni_install_anywhere(vpn))
+		bgp_evpn_vni_install_add_tail(&vni_install_queue, vpn);
+
+	thread_add_event(bm->master, install_routes_for_vnis_queued, bgp, 0,
+			 &t_vni_install);
+}
+
+/* Drop a VNI from the install queue, its routes are handled otherwise */
+static void install_routes_for_vni_dequeue(struct bgpevpn *vpn)
+{
+	if (!bgp_evpn_vni_install_anywhere(vpn))
+		return;
+
+	bgp_evpn_vni_install_del(&vni_install_queue, vpn);
+	if (!bgp_evpn_vni_install_count(&vni_install_queue))
+		THREAD_OFF(t_vni_install);
+}
+
 /*
  * Install or uninstall route in matching VRFs (list).
  */
@@ -5500,6 +5677,7 @@ void bgp_evpn_handle_rd_change(struct bgp *bgp, struct bgpevpn *vpn,
  */
 int bgp_evpn_install_routes(struct bgp *bgp, struct bgpevpn *vpn)
 {
+	install_routes_for_vni_dequeue(vpn);
 	return install_routes_for_vni(bgp, vpn);
 }
 
@@ -5509,6 +5687,7 @@ int bgp_evpn_install_routes(struct bgp *bgp, struct bgpevpn *vpn)
  */
 int bgp_evpn_uninstall_routes(struct bgp *bgp, struct bgpevpn *vpn)
 {
+	install_routes_for_vni_dequeue(vpn);
 	return uninstall_routes_for_vni(bgp, vpn);
 }
 
@@ -6020,6 +6199,7 @@ struct bgpevpn *bgp_evpn_new(struct bgp *bgp, vni_t vni,
  */
 void bgp_evpn_free(struct bgp *bgp, struct bgpevpn *vpn)
 {
+	install_routes_for_vni_dequeue(vpn);
 	bgp_evpn_remote_ip_hash_destroy(vpn);
 	bgp_evpn_vni_es_cleanup(vpn);
 	bgpevpn_unlink_from_l3vni(vpn);
@@ -6449,6 +6629,7 @@ int bgp_evpn_local_vni_del(struct bgp *bgp, vni_t vni)
 	 * withdraw from peers).
 	 */
 	delete_routes_for_vni(bgp, vpn);
+	install_routes_for_vni_dequeue(vpn);
 
 	bgp_evpn_unlink_from_vni_svi_hash(bgp, vpn);
 
@@ -6597,7 +6778,7 @@ int bgp_evpn_local_vni_add(struct bgp *bgp, vni_t vni,
 	 * VNI,
 	 * install them.
 	 */
-	install_routes_for_vni(bgp, vpn);
+	install_routes_for_vni_queue(bgp, vpn);
 
 	/* If we are advertising gateway mac-ip
 	   It needs to be conveyed again to zebra */
@@ -1036,6 +1036,16 @@ static int bgp_evpn_type1_route_update(struct bgp *bgp, struct bgp_evpn_es *es,
  * table and advertise these routes to peers.
  */
 
+static void bgp_evpn_ead_es_update_pend_del(struct bgp_evpn_es *es)
+{
+	if (!CHECK_FLAG(es->flags, BGP_EVPNES_EAD_ES_PEND))
+		return;
+
+	UNSET_FLAG(es->flags, BGP_EVPNES_EAD_ES_PEND);
+	list_delete_node(bgp_mh_info->ead_es_pend_list,
+			 &es->ead_es_pend_listnode);
+}
+
 static void bgp_evpn_ead_es_route_update(struct bgp *bgp,
 					 struct bgp_evpn_es *es)
 {
@@ -1043,6 +1053,9 @@ static void bgp_evpn_ead_es_route_update(struct bgp *bgp,
 	struct bgp_evpn_es_frag *es_frag;
 	struct prefix_evpn p;
 
+	/* done now, whatever was queued */
+	bgp_evpn_ead_es_update_pend_del(es);
+
 	build_evpn_type1_prefix(&p, BGP_EVPN_AD_ES_ETH_TAG, &es->esi,
 				es->originator_ip);
 	for (ALL_LIST_ELEMENTS_RO(es->es_frag_list, node, es_frag)) {
@@ -1058,6 +1071,39 @@ static void bgp_evpn_ead_es_route_update(struct bgp *bgp,
 	}
 }
 
+static void bgp_evpn_ead_es_update_run(struct thread *t)
+{
+	struct bgp *bgp = bgp_get_evpn();
+	struct bgp_evpn_es *es;
+
+	while (listcount(bgp_mh_info->ead_es_pend_list)) {
+		es = listgetdata(listhead(bgp_mh_info->ead_es_pend_list));
+		bgp_evpn_ead_es_update_pend_del(es);
+
+		/* the ES may have gone down or away since it was queued, then
+		 * there is nothing to (re)advertise
+		 */
+		if (bgp && bgp_evpn_local_es_is_active(es))
+			bgp_evpn_ead_es_route_update(bgp, es);
+	}
+}
+
+/* regenerate the EAD-ES routes once the current burst of changes is done */
+static void bgp_evpn_ead_es_update_pend_add(struct bgp_evpn_es *es)
+{
+	if (CHECK_FLAG(es->flags, BGP_EVPNES_EAD_ES_PEND))
+		return;
+
+	SET_FLAG(es->flags, BGP_EVPNES_EAD_ES_PEND);
+	listnode_init(&es->ead_es_pend_listnode, es);
+	listnode_add_after(bgp_mh_info->ead_es_pend_list,
+			   listtail_unchecked(bgp_mh_info->ead_es_pend_list),
+			   &es->ead_es_pend_listnode);
+
+	thread_add_event(bm->master, bgp_evpn_ead_es_update_run, NULL, 0,
+			 &bgp_mh_info->t_ead_es_update);
+}
+
 static void bgp_evpn_ead_evi_route_update(struct bgp *bgp,
 					  struct bgp_evpn_es *es,
 					  struct bgpevpn *vpn,
@@ -1083,7 +1129,7 @@ void update_type1_routes_for_evi(struct bgp *bgp, struct bgpevpn *vpn)
 			continue;
 
 		/* Update EAD-ES */
-		bgp_evpn_ead_es_route_update(bgp, es);
+		bgp_evpn_ead_es_update_pend_add(es);
 
 		/* Update EAD-EVI */
 		if (CHECK_FLAG(es->flags, BGP_EVPNES_ADV_EVI)) {
@@ -2016,6 +2062,7 @@ static void bgp_evpn_es_local_info_clear(struct bgp_evpn_es *es, bool finish)
 
 	/* remove from the ES local list */
 	list_delete_node(bgp_mh_info->local_es_list, &es->es_listnode);
+	bgp_evpn_ead_es_update_pend_del(es);
 
 	bgp_evpn_es_free(es, __func__);
 }
@@ -3637,7 +3684,7 @@ bgp_evpn_local_es_evi_do_del(struct bgp_evpn_es_evi *es_evi)
 	if (bgp) {
 		/* update EAD-ES with new list of VNIs */
 		if (bgp_evpn_local_es_is_active(es))
-			bgp_evpn_ead_es_route_update(bgp, es);
+			bgp_evpn_ead_es_update_pend_add(es);
 
 		/* withdraw and delete EAD-EVI */
 		if (CHECK_FLAG(es->flags, BGP_EVPNES_ADV_EVI)) {
@@ -3746,7 +3793,7 @@ int bgp_evpn_local_es_evi_add(struct bgp *bgp, esi_t *esi, vni_t vni)
 
 	/* update EAD-ES */
 	if (bgp_evpn_local_es_is_active(es))
-		bgp_evpn_ead_es_route_update(bgp, es);
+		bgp_evpn_ead_es_update_pend_add(es);
 
 	return 0;
 }
@@ -4902,6 +4949,8 @@ void bgp_evpn_mh_init(void)
 	/* list of ESs with pending processing */
 	bgp_mh_info->pend_es_list = list_new();
 	listset_app_node_mem(bgp_mh_info->pend_es_list);
+	bgp_mh_info->ead_es_pend_list = list_new();
+	listset_app_node_mem(bgp_mh_info->ead_es_pend_list);
 
 	bgp_mh_info->ead_evi_rx = BGP_EVPN_MH_EAD_EVI_RX_DEF;
 	bgp_mh_info->ead_evi_tx = BGP_EVPN_MH_EAD_EVI_TX_DEF;
@@ -4935,8 +4984,10 @@ void bgp_evpn_mh_finish(void)
 	}
 	if (bgp_mh_info->t_cons_check)
 		THREAD_OFF(bgp_mh_info->t_cons_check);
+	THREAD_OFF(bgp_mh_info->t_ead_es_update);
 	list_delete(&bgp_mh_info->local_es_list);
 	list_delete(&bgp_mh_info->pend_es_list);
+	list_delete(&bgp_mh_info->ead_es_pend_list);
 	list_delete(&bgp_mh_info->ead_es_export_rtl);
 
 	XFREE(MTYPE_BGP_EVPN_MH_INFO, bgp_mh_info);
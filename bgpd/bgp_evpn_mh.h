@@ -87,6 +87,8 @@ struct bgp_evpn_es {
 #define BGP_EVPNES_CONS_CHECK_PEND (1 << 4)
 	/* ES is in LACP bypass mode - don't advertise EAD-ES or ESR */
 #define BGP_EVPNES_BYPASS (1 << 5)
+	/* EAD-ES routes to be regenerated, the EVI list changed */
+#define BGP_EVPNES_EAD_ES_PEND (1 << 6)
 	/* bits needed for printing the flags + null */
 #define BGP_EVPN_FLAG_STR_SZ 7
 
@@ -103,6 +105,11 @@ struct bgp_evpn_es {
 	 */
 	struct listnode pend_es_listnode;
 
+	/* [EVPNES_LOCAL] memory used for linking the es to
+	 * bgp_mh_info->ead_es_pend_list
+	 */
+	struct listnode ead_es_pend_listnode;
+
 	/* [EVPNES_LOCAL] List of RDs for this ES (bgp_evpn_es_frag) */
 	struct list *es_frag_list;
 	struct bgp_evpn_es_frag *es_base_frag;
@@ -311,6 +318,13 @@ struct bgp_evpn_mh_info {
 	struct list *pend_es_list;
 	/* periodic timer for running background consistency checks */
 	struct thread *t_cons_check;
+	/* Local ESs whose EAD-ES routes are to be regenerated.  ES-EVI
+	 * changes arrive in bursts (one per VNI), the routes carry the RTs
+	 * of all the VNIs of the fragment, so they are rebuilt once per
+	 * burst from an event rather than on every ES-EVI add or delete.
+	 */
+	struct list *ead_es_pend_list;
+	struct thread *t_ead_es_update;
 
 	/* config knobs for optimizing or interop */
 	/* Generate EAD-EVI routes even if the ES is oper-down. This can be
@@ -51,6 +51,8 @@
 RB_HEAD(bgp_es_evi_rb_head, bgp_evpn_es_evi);
 RB_PROTOTYPE(bgp_es_evi_rb_head, bgp_evpn_es_evi, rb_node,
 		bgp_es_evi_rb_cmp);
+
+PREDECL_DLIST(bgp_evpn_vni_install);
 /*
  * Hash table of EVIs. Right now, the only type of EVI supported is with
  * VxLAN encapsulation, hence each EVI corresponds to a L2 VNI.
@@ -123,6 +125,10 @@ struct bgpevpn {
 	/* List of local ESs */
 	struct list *local_es_evi_list;
 
+	/* Queued for installing remote routes after becoming live */
+	struct bgp_evpn_vni_install_item install_item;
+	uint32_t install_stamp;
+
 	QOBJ_FIELDS;
 };
 
@@ -32,6 +32,8 @@
 #include "bgpd/bgp_regex.h"
 #include "bgpd/bgp_filter.h"
 
+PREDECL_HASH(as_list_hash);
+
 /* List of AS filter list. */
 struct as_list_list {
 	struct as_list *head;
@@ -43,6 +45,9 @@ struct as_list_master {
 	/* List of access_list which name is string. */
 	struct as_list_list str;
 
+	/* The same, indexed by name for route-map matches */
+	struct as_list_hash_head hash;
+
 	/* Hook function which is executed when new access_list is added. */
 	void (*add_hook)(char *);
 
@@ -71,10 +76,38 @@ struct as_list {
 	struct as_list *next;
 	struct as_list *prev;
 
+	struct as_list_hash_item hash_item;
+
+	/* Changes with every edit, unique across all lists */
+	uint32_t version;
+
 	struct as_filter *head;
 	struct as_filter *tail;
 };
 
+static int as_list_hash_cmp(const struct as_list *a, const struct as_list *b)
+{
+	return strcmp(a->name, b->name);
+}
+
+static uint32_t as_list_hash_key(const struct as_list *aslist)
+{
+	return string_hash_make(aslist->name);
+}
+
+DECLARE_HASH(as_list_hash, struct as_list, hash_item, as_list_hash_cmp,
+	     as_list_hash_key);
+
+static uint32_t as_list_version;
+
+static void as_list_version_bump(struct as_list *aslist)
+{
+	/* 0 marks an empty aspath cache slot */
+	if (++as_list_version == 0)
+		as_list_version++;
+	aslist->version = as_list_version;
+}
+
 
 /* Calculate new sequential number. */
 static int64_t bgp_alist_new_seq_get(struct as_list *list)
@@ -109,9 +142,9 @@ static struct as_filter *bgp_aslist_seq_check(struct as_list *list, int64_t seq)
 
 /* as-path access-list 10 permit AS1. */
 
-static struct as_list_master as_list_master = {{NULL, NULL},
-					       NULL,
-					       NULL};
+static struct as_list_master as_list_master = {
+	.str = {NULL, NULL},
+};
 
 /* Allocate new AS filter. */
 static struct as_filter *as_filter_new(void)
@@ -183,6 +216,8 @@ static void as_list_filter_add(struct as_list *aslist,
 	struct as_filter *point;
 	struct as_filter *replace;
 
+	as_list_version_bump(aslist);
+
 	if (aslist->tail && asfilter->seq > aslist->tail->seq)
 		point = NULL;
 	else {
@@ -227,16 +262,13 @@ hook:
 /* Lookup as_list from list of as_list by name. */
 struct as_list *as_list_lookup(const char *name)
 {
-	struct as_list *aslist;
+	struct as_list lookup;
 
 	if (name == NULL)
 		return NULL;
 
-	for (aslist = as_list_master.str.head; aslist; aslist = aslist->next)
-		if (strcmp(aslist->name, name) == 0)
-			return aslist;
-
-	return NULL;
+	lookup.name = (char *)name;
+	return as_list_hash_find(&as_list_master.hash, &lookup);
 }
 
 static struct as_list *as_list_new(void)
@@ -262,6 +294,8 @@ static struct as_list *as_list_insert(const char *name)
 	aslist = as_list_new();
 	aslist->name = XSTRDUP(MTYPE_AS_STR, name);
 	assert(aslist->name);
+	as_list_hash_add(&as_list_master.hash, aslist);
+	as_list_version_bump(aslist);
 
 	/* Set access_list to string list. */
 	list = &as_list_master.str;
@@ -337,6 +371,7 @@ static void as_list_delete(struct as_list *aslist)
 		as_filter_free(filter);
 	}
 
+	as_list_hash_del(&as_list_master.hash, aslist);
 	list = &as_list_master.str;
 
 	if (aslist->next)
@@ -362,6 +397,8 @@ static void as_list_filter_delete(struct as_list *aslist,
 {
 	char *name = XSTRDUP(MTYPE_AS_STR, aslist->name);
 
+	as_list_version_bump(aslist);
+
 	if (asfilter->next)
 		asfilter->next->prev = asfilter->prev;
 	else
@@ -389,22 +426,43 @@ static bool as_filter_match(struct as_filter *asfilter, struct aspath *aspath)
 	return bgp_regexec(asfilter->reg, aspath) != REG_NOMATCH;
 }
 
-/* Apply AS path filter to AS. */
+/*
+ * Apply AS path filter to AS.
+ *
+ * Running the regular expressions is expensive, and the same interned
+ * aspath is checked against the same lists for many routes, so the
+ * verdicts for the last lists are kept in the aspath.  The list's version
+ * identifies both the list and its content.
+ */
 enum as_filter_type as_list_apply(struct as_list *aslist, void *object)
 {
 	struct as_filter *asfilter;
 	struct aspath *aspath;
+	enum as_filter_type type = AS_FILTER_DENY;
+	int i;
 
 	aspath = (struct aspath *)object;
 
 	if (aslist == NULL)
 		return AS_FILTER_DENY;
 
+	for (i = 0; i < ASPATH_FILTER_CACHE; i++)
+		if (aspath->filter_cache[i].version == aslist->version)
+			return aspath->filter_cache[i].type;
+
 	for (asfilter = aslist->head; asfilter; asfilter = asfilter->next) {
-		if (as_filter_match(asfilter, aspath))
-			return asfilter->type;
+		if (as_filter_match(asfilter, aspath)) {
+			type = asfilter->type;
+			break;
+		}
 	}
-	return AS_FILTER_DENY;
+
+	memmove(&aspath->filter_cache[1], &aspath->filter_cache[0],
+		sizeof(aspath->filter_cache[0]) * (ASPATH_FILTER_CACHE - 1));
+	aspath->filter_cache[0].version = aslist->version;
+	aspath->filter_cache[0].type = type;
+
+	return type;
 }
 
 /* Add hook function. */
@@ -764,6 +822,8 @@ static const struct cmd_variable_handler aspath_filter_handlers[] = {
 /* Register functions. */
 void bgp_filter_init(void)
 {
+	as_list_hash_init(&as_list_master.hash);
+
 	install_node(&as_list_node);
 
 	install_element(CONFIG_NODE, &bgp_as_path_cmd);
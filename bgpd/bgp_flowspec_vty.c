@@ -490,6 +490,37 @@ DEFUN (no_debug_bgp_flowspec,
 	return CMD_SUCCESS;
 }
 
+DEFUN (show_bgp_flowspec_pbr_statistics,
+       show_bgp_flowspec_pbr_statistics_cmd,
+       "show bgp [<view|vrf> VIEWVRFNAME] flowspec pbr-statistics",
+       SHOW_STR
+       BGP_STR
+       BGP_INSTANCE_HELP_STR
+       "BGP flowspec\n"
+       "Policy routing entries installed for flowspec\n")
+{
+	int idx = 0;
+	struct bgp *bgp;
+
+	if (argv_find(argv, argc, "VIEWVRFNAME", &idx)) {
+		bgp = bgp_lookup_by_name(argv[idx]->arg);
+		if (!bgp) {
+			vty_out(vty, "%% Can't find BGP instance %s\n",
+				argv[idx]->arg);
+			return CMD_WARNING;
+		}
+	} else {
+		bgp = bgp_get_default();
+		if (!bgp) {
+			vty_out(vty, "%% No BGP process is configured\n");
+			return CMD_WARNING;
+		}
+	}
+
+	bgp_pbr_show_statistics(vty, bgp);
+	return CMD_SUCCESS;
+}
+
 int bgp_fs_config_write_pbr(struct vty *vty, struct bgp *bgp,
 			    afi_t afi, safi_t safi)
 {
@@ -626,4 +657,5 @@ void bgp_flowspec_vty_init(void)
 	install_element(CONFIG_NODE, &no_debug_bgp_flowspec_cmd);
 	install_element(BGP_FLOWSPECV4_NODE, &bgp_fs_local_install_ifname_cmd);
 	install_element(BGP_FLOWSPECV6_NODE, &bgp_fs_local_install_ifname_cmd);
+	install_element(VIEW_NODE, &show_bgp_flowspec_pbr_statistics_cmd);
 }
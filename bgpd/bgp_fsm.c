@@ -57,6 +57,7 @@
 #include "bgpd/bgp_io.h"
 #include "bgpd/bgp_zebra.h"
 #include "bgpd/bgp_vty.h"
+#include "bgpd/bgp_rtc.h"
 
 DEFINE_HOOK(peer_backward_transition, (struct peer * peer), (peer));
 DEFINE_HOOK(peer_status_changed, (struct peer * peer), (peer));
@@ -428,8 +429,9 @@ void bgp_timer_set(struct peer *peer)
 		THREAD_OFF(peer->t_start);
 		THREAD_OFF(peer->t_connect);
 		if (peer->v_holdtime != 0) {
-			BGP_TIMER_ON(peer->t_holdtime, bgp_holdtime_timer,
-				     peer->v_holdtime);
+			BGP_TIMER_ON_COARSE(peer->t_holdtime,
+					    bgp_holdtime_timer,
+					    peer->v_holdtime);
 		} else {
 			THREAD_OFF(peer->t_holdtime);
 		}
@@ -449,8 +451,9 @@ void bgp_timer_set(struct peer *peer)
 			THREAD_OFF(peer->t_holdtime);
 			bgp_keepalives_off(peer);
 		} else {
-			BGP_TIMER_ON(peer->t_holdtime, bgp_holdtime_timer,
-				     peer->v_holdtime);
+			BGP_TIMER_ON_COARSE(peer->t_holdtime,
+					    bgp_holdtime_timer,
+					    peer->v_holdtime);
 			bgp_keepalives_on(peer);
 		}
 		THREAD_OFF(peer->t_routeadv);
@@ -470,8 +473,9 @@ void bgp_timer_set(struct peer *peer)
 			THREAD_OFF(peer->t_holdtime);
 			bgp_keepalives_off(peer);
 		} else {
-			BGP_TIMER_ON(peer->t_holdtime, bgp_holdtime_timer,
-				     peer->v_holdtime);
+			BGP_TIMER_ON_COARSE(peer->t_holdtime,
+					    bgp_holdtime_timer,
+					    peer->v_holdtime);
 			bgp_keepalives_on(peer);
 		}
 		break;
@@ -564,8 +568,8 @@ static void bgp_holdtime_timer(struct thread *thread)
 	inq_count = atomic_load_explicit(&peer->ibuf->count,
 					 memory_order_relaxed);
 	if (inq_count)
-		BGP_TIMER_ON(peer->t_holdtime, bgp_holdtime_timer,
-			     peer->v_holdtime);
+		BGP_TIMER_ON_COARSE(peer->t_holdtime, bgp_holdtime_timer,
+				    peer->v_holdtime);
 
 	THREAD_VAL(thread) = Hold_Timer_expired;
 	bgp_event(thread); /* bgp_event unlocks peer */
@@ -1545,6 +1549,7 @@ enum bgp_fsm_state_progress bgp_stop(struct peer *peer)
 
 	/* Reset capabilities. */
 	peer->cap = 0;
+	bgp_rtc_peer_reset(peer);
 
 	/* Resetting neighbor role to the default value */
 	peer->remote_role = ROLE_UNDEFINED;
@@ -2148,6 +2153,9 @@ static enum bgp_fsm_state_progress bgp_establish(struct peer *peer)
 					 : VRF_DEFAULT_NAME)
 			      : "");
 	}
+	/* route target constraint filter, before update-groups use it */
+	bgp_rtc_peer_established(peer);
+
 	/* assign update-group/subgroup */
 	update_group_adjust_peer_afs(peer);
 
@@ -2161,18 +2169,26 @@ static enum bgp_fsm_state_progress bgp_establish(struct peer *peer)
 	}
 
 	FOREACH_AFI_SAFI_NSF (afi, safi) {
+		/* Paths restored from a RIB snapshot are kept until End-of-RIB
+		 * (or the snapshot stale timer), the peer re-sending the same
+		 * path just clears its stale flag.
+		 */
+		bool restored =
+			CHECK_FLAG(peer->sflags, PEER_STATUS_RIB_RESTORED) &&
+			peer->nsf[afi][safi] && peer->afc_nego[afi][safi];
+
 		if (peer->afc_nego[afi][safi] &&
 		    CHECK_FLAG(peer->cap, PEER_CAP_RESTART_ADV) &&
 		    CHECK_FLAG(peer->af_cap[afi][safi],
 			       PEER_CAP_RESTART_AF_RCV)) {
-			if (peer->nsf[afi][safi] &&
+			if (peer->nsf[afi][safi] && !restored &&
 			    !CHECK_FLAG(peer->af_cap[afi][safi],
 					PEER_CAP_RESTART_AF_PRESERVE_RCV))
 				bgp_clear_stale_route(peer, afi, safi);
 
 			peer->nsf[afi][safi] = 1;
 			nsf_af_count++;
-		} else {
+		} else if (!restored) {
 			if (peer->nsf[afi][safi])
 				bgp_clear_stale_route(peer, afi, safi);
 			peer->nsf[afi][safi] = 0;
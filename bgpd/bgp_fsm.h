@@ -29,6 +29,14 @@
 			thread_add_timer(bm->master, (F), peer, (V), &(T));    \
 	} while (0)
 
+/* For timers that are fine firing a little late and are rearmed often */
+#define BGP_TIMER_ON_COARSE(T, F, V)                                           \
+	do {                                                                   \
+		if ((peer->status != Deleted))                                 \
+			thread_add_timer_coarse(bm->master, (F), peer, (V),    \
+						&(T));                         \
+	} while (0)
+
 #define BGP_EVENT_ADD(P, E)                                                    \
 	do {                                                                   \
 		if ((P)->status != Deleted)                                    \
@@ -28,6 +28,7 @@
 #include "linklist.h"		// for list_delete, list_delete_all_node, lis...
 #include "log.h"		// for zlog_debug, safe_strerror, zlog_err
 #include "memory.h"		// for MTYPE_TMP, XCALLOC, XFREE
+#include "mempressure.h"	// for mempressure_level
 #include "network.h"		// for ERRNO_IO_RETRY
 #include "stream.h"		// for stream_get_endp, stream_getw_from, str...
 #include "ringbuf.h"		// for ringbuf_remain, ringbuf_peek, ringbuf_...
@@ -54,12 +55,106 @@ static bool validate_header(struct peer *);
 #define BGP_IO_FATAL_ERR (1 << 1) /* some kind of fatal TCP error */
 #define BGP_IO_WORK_FULL_ERR (1 << 2) /* No room in work buffer */
 
+/* I/O pthread pool -------------------------------------------------------- */
+
+/*
+ * Peers are spread across up to bm->io_threads I/O pthreads, bgp_pth_io
+ * always being the first one.  A peer is bound to the least loaded pthread
+ * when its reads or writes are turned on and stays there until both are
+ * turned off again, i.e. until the session goes down; so changing the pool
+ * size rebalances existing peers as their sessions are reset.
+ *
+ * Pool bookkeeping is only touched by the main pthread.  The keepalives
+ * pthread calls bgp_writes_on() as well, but only for peers whose writes
+ * are on already, so it never (re)binds a peer.
+ */
+static struct frr_pthread *bgp_io_pths[BGP_IO_THREADS_MAX];
+static unsigned int bgp_io_pth_peers[BGP_IO_THREADS_MAX];
+static unsigned int bgp_io_pths_running;
+
+static void bgp_io_pth_start(unsigned int idx)
+{
+	struct frr_pthread_attr io = {
+		.start = frr_pthread_attr_default.start,
+		.stop = frr_pthread_attr_default.stop,
+	};
+	char name[32], os_name[OS_THREAD_NAMELEN];
+
+	if (idx == 0) {
+		bgp_io_pths[0] = bgp_pth_io;
+	} else {
+		snprintf(name, sizeof(name), "BGP I/O thread %u", idx);
+		snprintf(os_name, sizeof(os_name), "bgpd_io%u", idx);
+		bgp_io_pths[idx] = frr_pthread_new(&io, name, os_name);
+	}
+
+	frr_pthread_run(bgp_io_pths[idx], NULL);
+	frr_pthread_wait_running(bgp_io_pths[idx]);
+}
+
+void bgp_io_threads_run(void)
+{
+	while (bgp_io_pths_running < bm->io_threads)
+		bgp_io_pth_start(bgp_io_pths_running++);
+}
+
+void bgp_io_threads_set(unsigned int count)
+{
+	assert(count >= 1 && count <= BGP_IO_THREADS_MAX);
+
+	bm->io_threads = count;
+
+	/*
+	 * Before bgp_pthreads_run() nothing is running yet, the pool is
+	 * started there.  Pthreads beyond a lowered count are kept running
+	 * until their remaining peers go away, they just get no new ones.
+	 */
+	if (bgp_io_pths_running)
+		bgp_io_threads_run();
+}
+
+static struct frr_pthread *bgp_io_pth(struct peer *peer)
+{
+	struct frr_pthread *fpt = bgp_io_pths[peer->io_pth];
+
+	assert(fpt && fpt->running);
+	return fpt;
+}
+
+/* Bind peer to an I/O pthread unless its reads or writes are on already */
+static struct frr_pthread *bgp_io_pth_bind(struct peer *peer)
+{
+	unsigned int i, best = 0;
+
+	if (CHECK_FLAG(peer->thread_flags,
+		       PEER_THREAD_READS_ON | PEER_THREAD_WRITES_ON))
+		return bgp_io_pth(peer);
+
+	for (i = 1; i < MIN(bm->io_threads, bgp_io_pths_running); i++)
+		if (bgp_io_pth_peers[i] < bgp_io_pth_peers[best])
+			best = i;
+
+	peer->io_pth = best;
+	bgp_io_pth_peers[best]++;
+	return bgp_io_pth(peer);
+}
+
+/* Called after reads or writes were turned off */
+static void bgp_io_pth_unbind(struct peer *peer, bool was_on)
+{
+	if (!was_on || CHECK_FLAG(peer->thread_flags,
+				  PEER_THREAD_READS_ON | PEER_THREAD_WRITES_ON))
+		return;
+
+	assert(bgp_io_pth_peers[peer->io_pth] > 0);
+	bgp_io_pth_peers[peer->io_pth]--;
+}
+
 /* Thread external API ----------------------------------------------------- */
 
 void bgp_writes_on(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	struct frr_pthread *fpt = bgp_io_pth_bind(peer);
 
 	assert(peer->status != Deleted);
 	assert(peer->obuf);
@@ -76,19 +171,19 @@ void bgp_writes_on(struct peer *peer)
 
 void bgp_writes_off(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	struct frr_pthread *fpt = bgp_io_pth(peer);
+	bool was_on = CHECK_FLAG(peer->thread_flags, PEER_THREAD_WRITES_ON);
 
 	thread_cancel_async(fpt->master, &peer->t_write, NULL);
 	THREAD_OFF(peer->t_generate_updgrp_packets);
 
 	UNSET_FLAG(peer->thread_flags, PEER_THREAD_WRITES_ON);
+	bgp_io_pth_unbind(peer, was_on);
 }
 
 void bgp_reads_on(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	struct frr_pthread *fpt = bgp_io_pth_bind(peer);
 
 	assert(peer->status != Deleted);
 	assert(peer->ibuf);
@@ -107,14 +202,15 @@ void bgp_reads_on(struct peer *peer)
 
 void bgp_reads_off(struct peer *peer)
 {
-	struct frr_pthread *fpt = bgp_pth_io;
-	assert(fpt->running);
+	struct frr_pthread *fpt = bgp_io_pth(peer);
+	bool was_on = CHECK_FLAG(peer->thread_flags, PEER_THREAD_READS_ON);
 
 	thread_cancel_async(fpt->master, &peer->t_read, NULL);
 	THREAD_OFF(peer->t_process_packet);
 	THREAD_OFF(peer->t_process_packet_error);
 
 	UNSET_FLAG(peer->thread_flags, PEER_THREAD_READS_ON);
+	bgp_io_pth_unbind(peer, was_on);
 }
 
 /* Thread internal functions ----------------------------------------------- */
@@ -124,8 +220,7 @@ void bgp_reads_off(struct peer *peer)
  */
 static void bgp_process_writes(struct thread *thread)
 {
-	static struct peer *peer;
-	peer = THREAD_ARG(thread);
+	struct peer *peer = THREAD_ARG(thread);
 	uint16_t status;
 	bool reschedule;
 	bool fatal = false;
@@ -133,7 +228,7 @@ static void bgp_process_writes(struct thread *thread)
 	if (peer->fd < 0)
 		return;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct frr_pthread *fpt = bgp_io_pths[peer->io_pth];
 
 	frr_with_mutex (&peer->io_mtx) {
 		status = bgp_write(peer);
@@ -164,6 +259,16 @@ static void bgp_process_writes(struct thread *thread)
 	}
 }
 
+/* Under memory pressure, stop reading earlier rather than queueing more
+ * updates than the main pthread can get through.
+ */
+static uint32_t bgp_inq_limit(void)
+{
+	if (mempressure_level() == MEMPRESSURE_NONE)
+		return bm->inq_limit;
+	return MAX(bm->inq_limit / 10, 1U);
+}
+
 static int read_ibuf_work(struct peer *peer)
 {
 	/* static buffer for transferring packets */
@@ -177,7 +282,7 @@ static int read_ibuf_work(struct peer *peer)
 	frr_mutex_lock_autounlock(&peer->io_mtx);
 	/* ============================================== */
 
-	if (peer->ibuf->count >= bm->inq_limit)
+	if (peer->ibuf->count >= bgp_inq_limit())
 		return -ENOMEM;
 
 	/* check that we have enough data for a header */
@@ -211,6 +316,8 @@ static int read_ibuf_work(struct peer *peer)
 	stream_set_endp(pkt, pktsize);
 
 	frrtrace(2, frr_bgp, packet_read, peer, pkt);
+	if (!peer->ibuf->count)
+		peer->ibuf_stamp = bgp_pipeline_now();
 	stream_fifo_push(peer->ibuf, pkt);
 
 	return pktsize;
@@ -226,13 +333,13 @@ static int read_ibuf_work(struct peer *peer)
 static void bgp_process_reads(struct thread *thread)
 {
 	/* clang-format off */
-	static struct peer *peer;       /* peer to read from */
+	struct peer *peer;              /* peer to read from */
 	uint16_t status;                /* bgp_read status code */
 	bool fatal = false;             /* whether fatal error occurred */
 	bool added_pkt = false;         /* whether we pushed onto ->ibuf */
 	int code = 0;                   /* FSM code if error occurred */
 	bool ibuf_full = false;         /* Is peer fifo IN Buffer full */
-	static bool ibuf_full_logged;   /* Have we logged full already */
+	static atomic_bool ibuf_full_logged; /* Have we logged full already */
 	int ret = 1;
 	/* clang-format on */
 
@@ -241,7 +348,7 @@ static void bgp_process_reads(struct thread *thread)
 	if (peer->fd < 0 || bm->terminating)
 		return;
 
-	struct frr_pthread *fpt = bgp_pth_io;
+	struct frr_pthread *fpt = bgp_io_pths[peer->io_pth];
 
 	frr_with_mutex (&peer->io_mtx) {
 		status = bgp_read(peer, &code);
@@ -283,7 +390,7 @@ static void bgp_process_reads(struct thread *thread)
 			if (bgp_debug_neighbor_events(peer))
 				zlog_debug(
 					"%s [Event] Peer Input-Queue is full: limit (%u)",
-					peer->host, bm->inq_limit);
+					peer->host, bgp_inq_limit());
 
 			ibuf_full_logged = true;
 		}
@@ -487,6 +594,8 @@ done : {
 		atomic_store_explicit(&peer->last_write, now,
 				      memory_order_relaxed);
 		peer->last_sendq_ok = now;
+		bgp_pipeline_record(&peer->pipeline, peer->host, AFI_UNSPEC,
+				    BGP_PIPELINE_WRITE, peer->obuf_stamp);
 	}
 }
 
@@ -503,21 +612,16 @@ done : {
  */
 static uint16_t bgp_read(struct peer *peer, int *code_p)
 {
-	size_t readsize; /* how many bytes we want to read */
 	ssize_t nbytes;  /* how many bytes we actually read */
-	size_t ibuf_work_space; /* space we can read into the work buf */
 	uint16_t status = 0;
 
-	ibuf_work_space = ringbuf_space(peer->ibuf_work);
-
-	if (ibuf_work_space == 0) {
+	if (ringbuf_space(peer->ibuf_work) == 0) {
 		SET_FLAG(status, BGP_IO_WORK_FULL_ERR);
 		return status;
 	}
 
-	readsize = MIN(ibuf_work_space, sizeof(peer->ibuf_scratch));
-
-	nbytes = read(peer->fd, peer->ibuf_scratch, readsize);
+	/* straight into the work buffer, saving a copy through scratch space */
+	nbytes = ringbuf_read(peer->ibuf_work, peer->fd);
 
 	/* EAGAIN or EWOULDBLOCK; come back later */
 	if (nbytes < 0 && ERRNO_IO_RETRY(errno)) {
@@ -545,9 +649,6 @@ static uint16_t bgp_read(struct peer *peer, int *code_p)
 			*code_p = TCP_connection_closed;
 
 		SET_FLAG(status, BGP_IO_FATAL_ERR);
-	} else {
-		assert(ringbuf_put(peer->ibuf_work, peer->ibuf_scratch, nbytes)
-		       == (size_t)nbytes);
 	}
 
 	return status;
@@ -28,6 +28,26 @@
 #include "bgpd/bgpd.h"
 #include "frr_pthread.h"
 
+/**
+ * Starts the I/O pthread pool.
+ *
+ * Starts bgp_pth_io and as many additional I/O pthreads as configured by
+ * bm->io_threads.
+ */
+extern void bgp_io_threads_run(void);
+
+/**
+ * Sets the number of I/O pthreads peers are spread across.
+ *
+ * Missing pthreads are started right away if the pool is running already.
+ * Established sessions keep their pthread; peers are (re)assigned to the
+ * least loaded pthread whenever their reads or writes are turned on while
+ * both were off.
+ *
+ * @param count - number of I/O pthreads, 1 to BGP_IO_THREADS_MAX
+ */
+extern void bgp_io_threads_set(unsigned int count);
+
 /**
  * Start function for write thread.
  *
@@ -28,7 +28,8 @@
 #include "hash.h"		// for hash, hash_clean, hash_create_size...
 #include "log.h"		// for zlog_debug
 #include "memory.h"		// for MTYPE_TMP, XFREE, XCALLOC, XMALLOC
-#include "monotime.h"		// for monotime, monotime_since
+#include "monotime.h"		// for monotime
+#include "typesafe.h"		// for PREDECL_HEAP, DECLARE_HEAP
 
 #include "bgpd/bgpd.h"          // for peer, PEER_THREAD_KEEPALIVES_ON, peer...
 #include "bgpd/bgp_debug.h"	// for bgp_debug_neighbor_events
@@ -40,27 +41,63 @@ DEFINE_MTYPE_STATIC(BGPD, BGP_PKAT, "Peer KeepAlive Timer");
 DEFINE_MTYPE_STATIC(BGPD, BGP_COND, "BGP Peer pthread Conditional");
 DEFINE_MTYPE_STATIC(BGPD, BGP_MUTEX, "BGP Peer pthread Mutex");
 
+PREDECL_HEAP(pkat_heap);
+
 /*
  * Peer KeepAlive Timer.
- * Associates a peer with the time of its last keepalive.
+ * Associates a peer with the time its next keepalive is due.
  */
 struct pkat {
 	/* the peer to send keepalives to */
 	struct peer *peer;
-	/* absolute time of last keepalive sent */
-	struct timeval last;
+	/* absolute time the next keepalive is due */
+	struct timeval due;
+	struct pkat_heap_item heapitem;
 };
 
+static int pkat_cmp(const struct pkat *a, const struct pkat *b)
+{
+	if (a->due.tv_sec < b->due.tv_sec)
+		return -1;
+	if (a->due.tv_sec > b->due.tv_sec)
+		return 1;
+	if (a->due.tv_usec < b->due.tv_usec)
+		return -1;
+	if (a->due.tv_usec > b->due.tv_usec)
+		return 1;
+	return 0;
+}
+
+DECLARE_HEAP(pkat_heap, struct pkat, heapitem, pkat_cmp);
+
 /* List of peers we are sending keepalives for, and associated mutex. */
 static pthread_mutex_t *peerhash_mtx;
 static pthread_cond_t *peerhash_cond;
 static struct hash *peerhash;
+/* the same peers, ordered by when their next keepalive is due */
+static struct pkat_heap_head pkat_heap[1];
+
+/* Schedule the next keepalive for pkat, last sent at time last. */
+static void pkat_schedule(struct pkat *pkat, const struct timeval *last)
+{
+	uint32_t v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
+					     memory_order_relaxed);
+	struct timeval ka = {0};
+
+	/* 0 keepalive timer means no keepalives, check again later */
+	ka.tv_sec = v_ka ? v_ka : 1;
+	timeradd(last, &ka, &pkat->due);
+	pkat_heap_add(pkat_heap, pkat);
+}
 
 static struct pkat *pkat_new(struct peer *peer)
 {
-	struct pkat *pkat = XMALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	struct pkat *pkat = XCALLOC(MTYPE_BGP_PKAT, sizeof(struct pkat));
+	struct timeval now;
+
 	pkat->peer = peer;
-	monotime(&pkat->last);
+	monotime(&now);
+	pkat_schedule(pkat, &now);
 	return pkat;
 }
 
@@ -71,67 +108,46 @@ static void pkat_del(void *pkat)
 
 
 /*
- * Callback for hash_iterate. Determines if a peer needs a keepalive and if so,
- * generates and sends it.
+ * Sends keepalives to all peers that are due for one, and schedules their
+ * next keepalive.
  *
- * For any given peer, if the elapsed time since its last keepalive exceeds its
- * configured keepalive timer, a keepalive is sent to the peer and its
- * last-sent time is reset. Additionally, If the elapsed time does not exceed
- * the configured keepalive timer, but the time until the next keepalive is due
- * is within a hardcoded tolerance, a keepalive is sent as if the configured
- * timer was exceeded. Doing this helps alleviate nanosecond sleeps between
- * ticks by grouping together peers who are due for keepalives at roughly the
- * same time. This tolerance value is arbitrarily chosen to be 100ms.
+ * A keepalive is also sent to peers whose keepalive is due within a hardcoded
+ * tolerance. Doing this helps alleviate nanosecond sleeps between ticks by
+ * grouping together peers who are due for keepalives at roughly the same
+ * time. This tolerance value is arbitrarily chosen to be 100ms.
  *
- * In addition, this function calculates the maximum amount of time that the
- * keepalive thread can sleep before another tick needs to take place. This is
- * equivalent to shortest time until a keepalive is due for any one peer.
+ * Only the peers that are due are looked at, so the cost of a tick does not
+ * depend on the number of peers with keepalives on.
  *
- * @return maximum time to wait until next update (0 if infinity)
+ * @return the peer whose keepalive is due next, if any
  */
-static void peer_process(struct hash_bucket *hb, void *arg)
+static struct pkat *peer_process(const struct timeval *now)
 {
-	struct pkat *pkat = hb->data;
-
-	struct timeval *next_update = arg;
-
-	static struct timeval elapsed;  // elapsed time since keepalive
-	static struct timeval ka = {0}; // peer->v_keepalive as a timeval
-	static struct timeval diff;     // ka - elapsed
-
 	static const struct timeval tolerance = {0, 100000};
+	struct timeval limit;
+	struct pkat *pkat;
+	uint32_t v_ka;
 
-	uint32_t v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
-					     memory_order_relaxed);
-
-	/* 0 keepalive timer means no keepalives */
-	if (v_ka == 0)
-		return;
-
-	/* calculate elapsed time since last keepalive */
-	monotime_since(&pkat->last, &elapsed);
+	timeradd(now, &tolerance, &limit);
 
-	/* calculate difference between elapsed time and configured time */
-	ka.tv_sec = v_ka;
-	timersub(&ka, &elapsed, &diff);
+	while ((pkat = pkat_heap_first(pkat_heap))
+	       && timercmp(&pkat->due, &limit, <)) {
+		pkat_heap_pop(pkat_heap);
 
-	int send_keepalive =
-		elapsed.tv_sec >= ka.tv_sec || timercmp(&diff, &tolerance, <);
+		v_ka = atomic_load_explicit(&pkat->peer->v_keepalive,
+					    memory_order_relaxed);
+		if (v_ka) {
+			if (bgp_debug_keepalive(pkat->peer))
+				zlog_debug(
+					"%s [FSM] Timer (keepalive timer expire)",
+					pkat->peer->host);
 
-	if (send_keepalive) {
-		if (bgp_debug_keepalive(pkat->peer))
-			zlog_debug("%s [FSM] Timer (keepalive timer expire)",
-				   pkat->peer->host);
-
-		bgp_keepalive_send(pkat->peer);
-		monotime(&pkat->last);
-		memset(&elapsed, 0, sizeof(elapsed));
-		diff = ka;
+			bgp_keepalive_send(pkat->peer);
+		}
+		pkat_schedule(pkat, now);
 	}
 
-	/* if calculated next update for this peer < current delay, use it */
-	if (next_update->tv_sec < 0 || timercmp(&diff, next_update, <))
-		*next_update = diff;
+	return pkat;
 }
 
 static bool peer_hash_cmp(const void *f, const void *s)
@@ -152,6 +168,9 @@ static unsigned int peer_hash_key(const void *arg)
 static void bgp_keepalives_finish(void *arg)
 {
 	if (peerhash) {
+		while (pkat_heap_pop(pkat_heap))
+			;
+		pkat_heap_fini(pkat_heap);
 		hash_clean(peerhash, pkat_del);
 		hash_free(peerhash);
 	}
@@ -175,9 +194,8 @@ void *bgp_keepalives_start(void *arg)
 	fpt->master->owner = pthread_self();
 
 	struct timeval currtime = {0, 0};
-	struct timeval aftertime = {0, 0};
-	struct timeval next_update = {0, 0};
 	struct timespec next_update_ts = {0, 0};
+	struct pkat *next;
 
 	/*
 	 * The RCU mechanism for each pthread is initialized in a "locked"
@@ -209,6 +227,7 @@ void *bgp_keepalives_start(void *arg)
 
 	/* initialize peer hashtable */
 	peerhash = hash_create_size(2048, peer_hash_key, peer_hash_cmp, NULL);
+	pkat_heap_init(pkat_heap);
 	pthread_mutex_lock(peerhash_mtx);
 
 	/* register cleanup handler */
@@ -229,16 +248,9 @@ void *bgp_keepalives_start(void *arg)
 
 		monotime(&currtime);
 
-		next_update.tv_sec = -1;
-
-		hash_iterate(peerhash, peer_process, &next_update);
-		if (next_update.tv_sec == -1)
-			memset(&next_update, 0, sizeof(next_update));
-
-		monotime_since(&currtime, &aftertime);
-
-		timeradd(&currtime, &next_update, &next_update);
-		TIMEVAL_TO_TIMESPEC(&next_update, &next_update_ts);
+		next = peer_process(&currtime);
+		if (next)
+			TIMEVAL_TO_TIMESPEC(&next->due, &next_update_ts);
 	}
 
 	/* clean up */
@@ -297,6 +309,7 @@ void bgp_keepalives_off(struct peer *peer)
 		holder.peer = peer;
 		struct pkat *res = hash_release(peerhash, &holder);
 		if (res) {
+			pkat_heap_del(pkat_heap, res);
 			pkat_del(res);
 			peer_unlock(peer);
 		}
@@ -458,8 +458,22 @@ void bgp_lp_get(
 	lp_fifo_add_tail(&lp->requests, lf);
 
 	if (lp_fifo_count(&lp->requests) > lp->pending_count) {
+		uint32_t labels_needed;
+
 		if (!zclient || zclient->sock < 0)
 			return;
+
+		/*
+		 * A burst of requests (e.g., many VRFs or labeled-unicast
+		 * prefixes coming up at once) would otherwise be served by a
+		 * series of chunk requests that only double in size one at a
+		 * time.  Ask for enough to cover the whole backlog instead.
+		 */
+		labels_needed = lp_fifo_count(&lp->requests) - lp->pending_count;
+		while ((lp->next_chunksize < labels_needed) &&
+		       ((lp->next_chunksize << 1) <= LP_CHUNK_SIZE_MAX))
+			lp->next_chunksize <<= 1;
+
 		if (zclient_send_get_label_chunk(zclient, 0, lp->next_chunksize,
 						 MPLS_LABEL_BASE_ANY) !=
 		    ZCLIENT_SEND_FAILURE) {
@@ -507,6 +521,7 @@ void bgp_lp_release(
 				bf_release_index(chunk->allocated_map, index);
 				chunk->nfree += 1;
 				deallocated = true;
+				break;
 			}
 			assert(deallocated);
 		}
@@ -265,9 +265,7 @@ struct lcommunity *lcommunity_intern(struct lcommunity *lcom)
 
 	find->refcnt++;
 
-	if (!find->str)
-		set_lcommunity_string(find, false, true);
-
+	/* The string is built by lcommunity_str() on first use */
 	return find;
 }
 
@@ -566,19 +564,31 @@ void bgp_aggr_lcommunity_remove(void *arg)
 void bgp_compute_aggregate_lcommunity(struct bgp_aggregate *aggregate,
 				      struct lcommunity *lcommunity)
 {
+	struct lcommunity *lcommerge;
+
+	/* Only a large community new to the aggregate changes it, and then
+	 * it is enough to merge that one into the current value.
+	 */
+	if (!bgp_compute_aggregate_lcommunity_hash(aggregate, lcommunity))
+		return;
 
-	bgp_compute_aggregate_lcommunity_hash(aggregate, lcommunity);
-	bgp_compute_aggregate_lcommunity_val(aggregate);
+	if (aggregate->lcommunity)
+		lcommerge = lcommunity_merge(aggregate->lcommunity,
+					     lcommunity);
+	else
+		lcommerge = lcommunity_dup(lcommunity);
+	aggregate->lcommunity = lcommunity_uniq_sort(lcommerge);
+	lcommunity_free(&lcommerge);
 }
 
-void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
+bool bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
 					   struct lcommunity *lcommunity)
 {
 
 	struct lcommunity *aggr_lcommunity = NULL;
 
 	if ((aggregate == NULL) || (lcommunity == NULL))
-		return;
+		return false;
 
 	/* Create hash if not already created.
 	 */
@@ -598,7 +608,7 @@ void bgp_compute_aggregate_lcommunity_hash(struct bgp_aggregate *aggregate,
 
 	/* Increment reference counter.
 	 */
-	aggr_lcommunity->refcnt++;
+	return ++aggr_lcommunity->refcnt == 1;
 }
 
 void bgp_compute_aggregate_lcommunity_val(struct bgp_aggregate *aggregate)
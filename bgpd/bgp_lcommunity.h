@@ -78,7 +78,7 @@ extern void bgp_compute_aggregate_lcommunity(
 					struct bgp_aggregate *aggregate,
 					struct lcommunity *lcommunity);
 
-extern void bgp_compute_aggregate_lcommunity_hash(
+extern bool bgp_compute_aggregate_lcommunity_hash(
 					struct bgp_aggregate *aggregate,
 					struct lcommunity *lcommunity);
 extern void bgp_compute_aggregate_lcommunity_val(
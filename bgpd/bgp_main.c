@@ -63,13 +63,19 @@
 #include "bgpd/bgp_script.h"
 #include "bgpd/bgp_evpn_mh.h"
 #include "bgpd/bgp_nht.h"
+#include "bgpd/bgp_nhg.h"
 #include "bgpd/bgp_routemap_nb.h"
 #include "bgpd/bgp_community_alias.h"
+#include "bgpd/bgp_snapshot.h"
+#include "bgpd/bgp_rtc.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
 #endif
 
+#define OPTION_RIB_SNAPSHOT 2000
+#define OPTION_RIB_SNAPSHOT_INTERVAL 2001
+
 /* bgpd options, we use GNU getopt library. */
 static const struct option longopts[] = {
 	{"bgp_port", required_argument, NULL, 'p'},
@@ -80,6 +86,9 @@ static const struct option longopts[] = {
 	{"int_num", required_argument, NULL, 'I'},
 	{"no_zebra", no_argument, NULL, 'Z'},
 	{"socket_size", required_argument, NULL, 's'},
+	{"rib-snapshot", required_argument, NULL, OPTION_RIB_SNAPSHOT},
+	{"rib-snapshot-interval", required_argument, NULL,
+	 OPTION_RIB_SNAPSHOT_INTERVAL},
 	{0}};
 
 /* signal definitions */
@@ -165,6 +174,9 @@ __attribute__((__noreturn__)) void sigint(void)
 	/* Disable BFD events to avoid wasting processing. */
 	bfd_protocol_integration_set_shutdown(true);
 
+	/* while all paths are still there */
+	bgp_snapshot_finish();
+
 	bgp_terminate();
 
 	bgp_exit(0);
@@ -212,6 +224,7 @@ static __attribute__((__noreturn__)) void bgp_exit(int status)
 		bgp_delete(bgp_default);
 
 	bgp_evpn_mh_finish();
+	bgp_nhg_finish();
 	bgp_l3nhg_finish();
 
 	/* reverse bgp_dump_init */
@@ -223,6 +236,9 @@ static __attribute__((__noreturn__)) void bgp_exit(int status)
 	/* reverse bgp_route_init */
 	bgp_route_finish();
 
+	/* reverse bgp_rtc_init */
+	bgp_rtc_finish();
+
 	/* cleanup route maps */
 	bgp_route_map_terminate();
 
@@ -398,6 +414,8 @@ int main(int argc, char **argv)
 	int buffer_size = BGP_SOCKET_SNDBUF_SIZE;
 	char *address;
 	struct listnode *node;
+	const char *rib_snapshot = NULL;
+	unsigned int rib_snapshot_interval = 300;
 
 	addresses->cmp = (int (*)(void *, void *))strcmp;
 
@@ -411,7 +429,9 @@ int main(int argc, char **argv)
 		"  -S, --skip_runas   Skip capabilities checks, and changing user and group IDs.\n"
 		"  -e, --ecmp         Specify ECMP to use.\n"
 		"  -I, --int_num      Set instance number (label-manager)\n"
-		"  -s, --socket_size  Set BGP peer socket send buffer size\n");
+		"  -s, --socket_size  Set BGP peer socket send buffer size\n"
+		"      --rib-snapshot Keep a RIB snapshot in this file for fast restarts\n"
+		"      --rib-snapshot-interval Seconds between snapshots (0: only on shutdown)\n");
 
 	/* Command line argument treatment. */
 	while (1) {
@@ -473,6 +493,12 @@ int main(int argc, char **argv)
 		case 's':
 			buffer_size = atoi(optarg);
 			break;
+		case OPTION_RIB_SNAPSHOT:
+			rib_snapshot = optarg;
+			break;
+		case OPTION_RIB_SNAPSHOT_INTERVAL:
+			rib_snapshot_interval = strtoul(optarg, NULL, 10);
+			break;
 		default:
 			frr_help_exit(1);
 		}
@@ -500,6 +526,9 @@ int main(int argc, char **argv)
 	/* BGP related initialization.  */
 	bgp_init((unsigned short)instance);
 
+	if (rib_snapshot)
+		bgp_snapshot_init(rib_snapshot, rib_snapshot_interval);
+
 	if (list_isempty(bm->addresses)) {
 		snprintf(bgpd_di.startinfo, sizeof(bgpd_di.startinfo),
 			 ", bgp@<all>:%d", bm->port);
@@ -49,8 +49,8 @@ DEFINE_MTYPE(BGPD, AS_SEG_DATA, "BGP aspath segment data");
 DEFINE_MTYPE(BGPD, AS_STR, "BGP aspath str");
 
 DEFINE_MTYPE(BGPD, BGP_TABLE, "BGP table");
-DEFINE_MTYPE(BGPD, BGP_NODE, "BGP node");
-DEFINE_MTYPE(BGPD, BGP_ROUTE, "BGP route");
+DEFINE_MTYPE_POOL(BGPD, BGP_NODE, "BGP node");
+DEFINE_MTYPE_POOL(BGPD, BGP_ROUTE, "BGP route");
 DEFINE_MTYPE(BGPD, BGP_ROUTE_EXTRA, "BGP ancillary route info");
 DEFINE_MTYPE(BGPD, BGP_CONN, "BGP connected");
 DEFINE_MTYPE(BGPD, BGP_STATIC, "BGP static");
@@ -137,6 +137,7 @@ DEFINE_MTYPE(BGPD, BGP_SRV6_VPN, "BGP prefix-sid srv6 vpn service");
 
 DEFINE_MTYPE(BGPD, BGP_SRV6_SID, "BGP srv6 segment-id");
 DEFINE_MTYPE(BGPD, BGP_SRV6_FUNCTION, "BGP srv6 function");
+DEFINE_MTYPE(BGPD, BGP_SRV6_SID_MAP, "BGP srv6 function index map");
 DEFINE_MTYPE(BGPD, EVPN_REMOTE_IP, "BGP EVPN Remote IP hash entry");
 
 DEFINE_MTYPE(BGPD, BGP_NOTIFICATION, "BGP Notification Message");
@@ -133,6 +133,7 @@ DECLARE_MTYPE(BGP_SRV6_L3VPN);
 DECLARE_MTYPE(BGP_SRV6_VPN);
 DECLARE_MTYPE(BGP_SRV6_SID);
 DECLARE_MTYPE(BGP_SRV6_FUNCTION);
+DECLARE_MTYPE(BGP_SRV6_SID_MAP);
 
 DECLARE_MTYPE(EVPN_REMOTE_IP);
 
@@ -516,6 +516,37 @@ static void bgp_path_info_mpath_attr_set(struct bgp_path_info *path,
 	mpath->mp_attr = attr;
 }
 
+/*
+ * bgp_path_info_mpath_unchanged
+ *
+ * Check whether the multipath list of a bestpath that stays the bestpath
+ * already holds exactly the candidates in mp_list, with no attribute
+ * change on any of them, so a rebuild would produce the same list.
+ */
+static bool bgp_path_info_mpath_unchanged(struct bgp_path_info *best,
+					  struct list *mp_list,
+					  uint16_t maxpaths)
+{
+	struct listnode *mp_node;
+	struct bgp_path_info *cand, *cur_mpath;
+
+	if (CHECK_FLAG(best->flags, BGP_PATH_ATTR_CHANGED)
+	    || bgp_path_info_mpath_count(best) >= maxpaths)
+		return false;
+
+	cur_mpath = bgp_path_info_mpath_first(best);
+	for (ALL_LIST_ELEMENTS_RO(mp_list, mp_node, cand)) {
+		if (cand == best)
+			continue;
+		if (cand != cur_mpath
+		    || CHECK_FLAG(cand->flags, BGP_PATH_ATTR_CHANGED))
+			return false;
+		cur_mpath = bgp_path_info_mpath_next(cur_mpath);
+	}
+
+	return cur_mpath == NULL;
+}
+
 /*
  * bgp_path_info_mpath_update
  *
@@ -556,6 +587,16 @@ void bgp_path_info_mpath_update(struct bgp *bgp, struct bgp_dest *dest,
 				   : mpath_cfg->maxpaths_ebgp;
 	}
 
+	/* Nothing to do if the same multipaths were selected again */
+	if (new_best && new_best == old_best
+	    && bgp_path_info_mpath_unchanged(new_best, mp_list, maxpaths)) {
+		if (debug)
+			zlog_debug("%pRN(%s): mpath list unchanged, count %d",
+				   bgp_dest_to_rnode(dest), bgp->name_pretty,
+				   bgp_path_info_mpath_count(new_best));
+		return;
+	}
+
 	if (old_best) {
 		cur_mpath = bgp_path_info_mpath_first(old_best);
 		old_mpath_count = bgp_path_info_mpath_count(old_best);
@@ -801,6 +842,26 @@ void bgp_mp_dmed_deselect(struct bgp_path_info *dmed_best)
  * is no change in multipath selection and no attribute change in
  * any multipath.
  */
+static bool bgp_path_info_mpath_aggregate_valid(struct bgp_path_info *best,
+						bool as_set)
+{
+	struct bgp_path_info *mpinfo;
+
+	if (!bgp_path_info_mpath_attr(best)
+	    || CHECK_FLAG(best->flags, BGP_PATH_MULTIPATH_CHG)
+	    || CHECK_FLAG(best->flags, BGP_PATH_ATTR_CHANGED)
+	    || !!CHECK_FLAG(best->mpath->mp_flags, BGP_MP_AGGR_AS_SET)
+		       != as_set)
+		return false;
+
+	for (mpinfo = bgp_path_info_mpath_first(best); mpinfo;
+	     mpinfo = bgp_path_info_mpath_next(mpinfo))
+		if (CHECK_FLAG(mpinfo->flags, BGP_PATH_ATTR_CHANGED))
+			return false;
+
+	return true;
+}
+
 void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 					  struct bgp_path_info *old_best)
 {
@@ -813,6 +874,7 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 	struct ecommunity *ecomm, *ecommerge;
 	struct lcommunity *lcomm, *lcommerge;
 	struct attr attr = {0};
+	bool as_set;
 
 	if (old_best && (old_best != new_best)
 	    && (old_attr = bgp_path_info_mpath_attr(old_best))) {
@@ -832,11 +894,17 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 		return;
 	}
 
+	as_set = new_best->peer
+		 && CHECK_FLAG(new_best->peer->bgp->flags,
+			       BGP_FLAG_MULTIPATH_RELAX_AS_SET);
+
+	if (new_best == old_best
+	    && bgp_path_info_mpath_aggregate_valid(new_best, as_set))
+		return;
+
 	attr = *new_best->attr;
 
-	if (new_best->peer
-	    && CHECK_FLAG(new_best->peer->bgp->flags,
-			  BGP_FLAG_MULTIPATH_RELAX_AS_SET)) {
+	if (as_set) {
 
 		/* aggregate attribute from multipath constituents */
 		aspath = aspath_dup(attr.aspath);
@@ -921,6 +989,12 @@ void bgp_path_info_mpath_aggregate_update(struct bgp_path_info *new_best,
 
 	new_attr = bgp_attr_intern(&attr);
 
+	/* mp_count is set, so the mpath info exists */
+	if (as_set)
+		SET_FLAG(new_best->mpath->mp_flags, BGP_MP_AGGR_AS_SET);
+	else
+		UNSET_FLAG(new_best->mpath->mp_flags, BGP_MP_AGGR_AS_SET);
+
 	if (new_attr != bgp_path_info_mpath_attr(new_best)) {
 		if ((old_attr = bgp_path_info_mpath_attr(new_best)))
 			bgp_attr_unintern(&old_attr);
@@ -42,6 +42,7 @@ struct bgp_path_info_mpath {
 	uint16_t mp_flags;
 #define BGP_MP_LB_PRESENT 0x1 /* Link-bandwidth present for >= 1 path */
 #define BGP_MP_LB_ALL 0x2 /* Link-bandwidth present for all multipaths */
+#define BGP_MP_AGGR_AS_SET 0x4 /* mp_attr was aggregated with an AS_SET */
 
 	/* Aggregated attribute for advertising multipath route */
 	struct attr *mp_attr;
@@ -30,6 +30,7 @@
 #include "mpls.h"
 #include "json.h"
 #include "zclient.h"
+#include "jhash.h"
 
 #include "bgpd/bgpd.h"
 #include "bgpd/bgp_debug.h"
@@ -49,11 +50,14 @@
 #include "bgpd/bgp_nht.h"
 #include "bgpd/bgp_evpn.h"
 #include "bgpd/bgp_memory.h"
+#include "bgpd/bgp_rtc.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/rfapi_backend.h"
 #endif
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_VPN_IMPORT_RT, "BGP VPN import RT index");
+
 /*
  * Definitions and external declarations.
  */
@@ -596,8 +600,69 @@ int vpn_leak_label_callback(
 	return 0;
 }
 
+/*
+ * bf_set_bit()/bf_find_bit() keep a count of full words that assumes bits
+ * are never released, the map is scanned and changed directly instead.
+ */
+static void sid_map_set(struct bgp_srv6_sid_map *map, uint32_t index)
+{
+	map->used.data[bf_index(index)] |= 1 << bf_offset(index);
+}
+
+/* lowest unused index, or one past the last word if there is none */
+static uint32_t sid_map_find_free(const struct bgp_srv6_sid_map *map)
+{
+	size_t w;
+
+	for (w = 0; w < map->used.m; w++)
+		if (map->used.data[w] != WORD_MAX)
+			return w * WORD_SIZE
+			       + __builtin_ctz(~map->used.data[w]);
+	return map->used.m * WORD_SIZE;
+}
+
+/* The function index map of a locator chunk, created on first use */
+static struct bgp_srv6_sid_map *
+sid_map_get(struct bgp *bgp, const struct srv6_locator_chunk *chunk)
+{
+	struct bgp_srv6_sid_map *map;
+	uint32_t index_max = (1 << chunk->function_bits_length) - 1;
+	uint8_t shift_len = BGP_PREFIX_SID_SRV6_MAX_FUNCTION_LENGTH
+			    - chunk->function_bits_length;
+	uint32_t i;
+
+	frr_each (bgp_srv6_sid_maps, &bgp->srv6_sid_maps, map)
+		if (map->index_max == index_max
+		    && prefix_same(&map->prefix, &chunk->prefix))
+			return map;
+
+	map = XCALLOC(MTYPE_BGP_SRV6_SID_MAP, sizeof(*map));
+	map->prefix = chunk->prefix;
+	map->index_max = index_max;
+	bf_init(map->used, index_max);
+	for (i = 0; i <= index_max
+		    && (i << shift_len) < MPLS_LABEL_UNRESERVED_MIN;
+	     i++)
+		sid_map_set(map, i);
+
+	bgp_srv6_sid_maps_add_tail(&bgp->srv6_sid_maps, map);
+	return map;
+}
+
+/* once no function is allocated from it */
+static void sid_map_put(struct bgp *bgp, struct bgp_srv6_sid_map *map)
+{
+	if (map->count)
+		return;
+
+	bgp_srv6_sid_maps_del(&bgp->srv6_sid_maps, map);
+	bf_free(map->used);
+	XFREE(MTYPE_BGP_SRV6_SID_MAP, map);
+}
+
 static void sid_register(struct bgp *bgp, const struct in6_addr *sid,
-			 const char *locator_name)
+			 const char *locator_name,
+			 struct bgp_srv6_sid_map *map, uint32_t index)
 {
 	struct bgp_srv6_function *func;
 	func = XCALLOC(MTYPE_BGP_SRV6_FUNCTION,
@@ -605,30 +670,30 @@ static void sid_register(struct bgp *bgp, const struct in6_addr *sid,
 	func->sid = *sid;
 	snprintf(func->locator_name, sizeof(func->locator_name),
 		 "%s", locator_name);
-	listnode_add(bgp->srv6_functions, func);
+	func->map = map;
+	func->index = index;
+	map->count++;
+	bgp_srv6_functions_add(&bgp->srv6_functions, func);
 }
 
-static void sid_unregister(struct bgp *bgp, const struct in6_addr *sid)
+void bgp_srv6_function_del(struct bgp *bgp, struct bgp_srv6_function *func)
 {
-	struct listnode *node, *nnode;
-	struct bgp_srv6_function *func;
-
-	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func))
-		if (sid_same(&func->sid, sid)) {
-			listnode_delete(bgp->srv6_functions, func);
-			XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-		}
+	bgp_srv6_functions_del(&bgp->srv6_functions, func);
+	if (func->map) {
+		bf_release_index(func->map->used, func->index);
+		func->map->count--;
+		sid_map_put(bgp, func->map);
+	}
+	XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
 }
 
-static bool sid_exist(struct bgp *bgp, const struct in6_addr *sid)
+static void sid_unregister(struct bgp *bgp, const struct in6_addr *sid)
 {
-	struct listnode *node;
-	struct bgp_srv6_function *func;
+	struct bgp_srv6_function ref = { .sid = *sid }, *func;
 
-	for (ALL_LIST_ELEMENTS_RO(bgp->srv6_functions, node, func))
-		if (sid_same(&func->sid, sid))
-			return true;
-	return false;
+	func = bgp_srv6_functions_find(&bgp->srv6_functions, &ref);
+	if (func)
+		bgp_srv6_function_del(bgp, func);
 }
 
 /*
@@ -646,11 +711,13 @@ static uint32_t alloc_new_sid(struct bgp *bgp, uint32_t index,
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_LABEL);
 	struct listnode *node;
 	struct srv6_locator_chunk *chunk;
+	struct bgp_srv6_sid_map *map = NULL;
 	bool alloced = false;
 	int label = 0;
 	uint8_t offset = 0;
 	uint8_t func_len = 0, shift_len = 0;
 	uint32_t index_max = 0;
+	uint32_t i = 0;
 
 	if (!bgp || !sid_locator_chunk || !sid)
 		return false;
@@ -693,35 +760,35 @@ static uint32_t alloc_new_sid(struct bgp *bgp, uint32_t index,
 				continue;
 			}
 
-			transpose_sid(sid, label, offset, func_len);
-			if (sid_exist(bgp, sid))
-				continue;
-			alloced = true;
-			break;
-		}
-
-		for (uint32_t i = 1; i < index_max; i++) {
-			label = i << shift_len;
-			if (label < MPLS_LABEL_UNRESERVED_MIN) {
-				if (debug)
-					zlog_debug(
-						"%s: skipped to allocate SRv6 SID (%pFX): Label (%u) is too small to use",
-						__func__, &chunk->prefix,
-						label);
+			map = sid_map_get(bgp, chunk);
+			if (bf_test_index(map->used, index)) {
+				sid_map_put(bgp, map);
 				continue;
 			}
+			i = index;
 			transpose_sid(sid, label, offset, func_len);
-			if (sid_exist(bgp, sid))
-				continue;
 			alloced = true;
 			break;
 		}
+
+		/* the lowest unused index, the last one is never picked */
+		map = sid_map_get(bgp, chunk);
+		i = sid_map_find_free(map);
+		if (i >= index_max) {
+			sid_map_put(bgp, map);
+			continue;
+		}
+		label = i << shift_len;
+		transpose_sid(sid, label, offset, func_len);
+		alloced = true;
+		break;
 	}
 
 	if (!alloced)
 		return 0;
 
-	sid_register(bgp, sid, bgp->srv6_locator_name);
+	sid_map_set(map, i);
+	sid_register(bgp, sid, bgp->srv6_locator_name, map, i);
 	return label;
 }
 
@@ -2073,42 +2140,318 @@ static bool vpn_leak_to_vrf_update_onevrf(struct bgp *to_bgp,   /* to */
 	return true;
 }
 
+/*
+ * Index of the VRFs importing each route target, so that a VPN route is
+ * only offered to the VRFs importing one of its RTs rather than to every
+ * instance.  It is rebuilt from bm->bgp on first use after
+ * vpn_leak_import_index_reset().
+ */
+PREDECL_HASH(vpn_import_rt);
+
+struct vpn_import_rt {
+	struct vpn_import_rt_item item;
+	uint8_t val[ECOMMUNITY_SIZE];
+
+	/* positions in vpn_import_index.vrfs */
+	uint32_t count;
+	uint32_t *vrfs;
+};
+
+static int vpn_import_rt_cmp(const struct vpn_import_rt *a,
+			     const struct vpn_import_rt *b)
+{
+	return memcmp(a->val, b->val, ECOMMUNITY_SIZE);
+}
+
+static uint32_t vpn_import_rt_hash(const struct vpn_import_rt *rt)
+{
+	return jhash(rt->val, ECOMMUNITY_SIZE, 0x9c3d1f27);
+}
+
+DECLARE_HASH(vpn_import_rt, struct vpn_import_rt, item, vpn_import_rt_cmp,
+	     vpn_import_rt_hash);
+
+struct vpn_import_vrf {
+	struct bgp *bgp;
+	/* walk this VRF was last visited by, a route may carry several of
+	 * its RTs
+	 */
+	uint32_t stamp;
+};
+
+struct vpn_import_index {
+	bool valid;
+	uint32_t stamp;
+
+	struct vpn_import_rt_head rts;
+
+	/* instances with a FROMVPN rtlist */
+	uint32_t vrf_count;
+	struct vpn_import_vrf *vrfs;
+
+	/* instances whose rtlist is not made of plain RTs, and so can't be
+	 * hashed; these are visited for every route
+	 */
+	uint32_t other_count;
+	uint32_t *others;
+};
+
+static struct vpn_import_index vpn_import_index[AFI_MAX];
+
+static void vpn_import_index_clear(struct vpn_import_index *idx)
+{
+	struct vpn_import_rt *rt;
+
+	if (!idx->valid)
+		return;
+
+	while ((rt = vpn_import_rt_pop(&idx->rts))) {
+		XFREE(MTYPE_BGP_VPN_IMPORT_RT, rt->vrfs);
+		XFREE(MTYPE_BGP_VPN_IMPORT_RT, rt);
+	}
+	vpn_import_rt_fini(&idx->rts);
+	XFREE(MTYPE_BGP_VPN_IMPORT_RT, idx->vrfs);
+	XFREE(MTYPE_BGP_VPN_IMPORT_RT, idx->others);
+	idx->vrf_count = 0;
+	idx->other_count = 0;
+	idx->valid = false;
+}
+
+/*
+ * Must be called whenever the FROMVPN rtlist of an instance changes, and
+ * when an instance is created or deleted.
+ */
+void vpn_leak_import_index_reset(void)
+{
+	afi_t afi;
+
+	for (afi = AFI_IP; afi < AFI_MAX; afi++)
+		vpn_import_index_clear(&vpn_import_index[afi]);
+
+	/* these are also our route target memberships */
+	bgp_rtc_local_changed();
+}
+
+static struct vpn_import_index *vpn_import_index_get(afi_t afi)
+{
+	struct vpn_import_index *idx = &vpn_import_index[afi];
+	struct vpn_import_rt *rt, lookup;
+	struct ecommunity *ecom;
+	struct listnode *node;
+	struct bgp *bgp;
+	uint32_t pos, i;
+
+	if (idx->valid)
+		return idx;
+
+	vpn_import_rt_init(&idx->rts);
+	idx->vrfs = XCALLOC(MTYPE_BGP_VPN_IMPORT_RT,
+			    (listcount(bm->bgp) + 1) * sizeof(idx->vrfs[0]));
+	idx->stamp = 0;
+	idx->valid = true;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		ecom = bgp->vpn_policy[afi].rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+		if (!ecom || !ecom->size)
+			continue;
+
+		pos = idx->vrf_count++;
+		idx->vrfs[pos].bgp = bgp;
+
+		if (ecom->unit_size != ECOMMUNITY_SIZE) {
+			idx->others = XREALLOC(MTYPE_BGP_VPN_IMPORT_RT,
+					       idx->others,
+					       (idx->other_count + 1)
+						       * sizeof(idx->others[0]));
+			idx->others[idx->other_count++] = pos;
+			continue;
+		}
+
+		for (i = 0; i < ecom->size; i++) {
+			memcpy(lookup.val, ecom->val + i * ECOMMUNITY_SIZE,
+			       ECOMMUNITY_SIZE);
+			rt = vpn_import_rt_find(&idx->rts, &lookup);
+			if (!rt) {
+				rt = XCALLOC(MTYPE_BGP_VPN_IMPORT_RT,
+					     sizeof(*rt));
+				memcpy(rt->val, lookup.val, ECOMMUNITY_SIZE);
+				vpn_import_rt_add(&idx->rts, rt);
+			} else if (rt->vrfs[rt->count - 1] == pos)
+				/* RT listed twice by this instance */
+				continue;
+
+			rt->vrfs = XREALLOC(MTYPE_BGP_VPN_IMPORT_RT, rt->vrfs,
+					    (rt->count + 1) * sizeof(rt->vrfs[0]));
+			rt->vrfs[rt->count++] = pos;
+		}
+	}
+
+	return idx;
+}
+
+static bool vpn_import_vrf_visit(struct vpn_import_index *idx, uint32_t pos,
+				 uint32_t stamp,
+				 bool (*func)(struct bgp *to_bgp, void *arg),
+				 void *arg)
+{
+	struct vpn_import_vrf *vrf = &idx->vrfs[pos];
+
+	if (vrf->stamp == stamp)
+		return false;
+	vrf->stamp = stamp;
+
+	return func(vrf->bgp, arg);
+}
+
+/*
+ * Call func for each instance importing at least one of the RTs in ecom,
+ * or possibly doing so.  func still has to check the intersection.
+ *
+ * A walk may nest in another one (leak_update() withdraws a VRF route
+ * whose RTs changed); the outer walk may then visit an instance twice,
+ * which is harmless as leaking and withdrawing a route are idempotent.
+ */
+static bool vpn_import_vrfs_walk(afi_t afi, struct ecommunity *ecom,
+				 bool (*func)(struct bgp *to_bgp, void *arg),
+				 void *arg)
+{
+	struct vpn_import_index *idx;
+	struct vpn_import_rt *rt, lookup;
+	uint32_t stamp, i, j;
+	bool ret = false;
+
+	if (!ecom || !ecom->size)
+		return false;
+
+	idx = vpn_import_index_get(afi);
+
+	stamp = ++idx->stamp;
+	if (!stamp) {
+		for (i = 0; i < idx->vrf_count; i++)
+			idx->vrfs[i].stamp = 0;
+		stamp = idx->stamp = 1;
+	}
+
+	if (ecom->unit_size != ECOMMUNITY_SIZE) {
+		for (i = 0; i < idx->vrf_count; i++)
+			ret |= vpn_import_vrf_visit(idx, i, stamp, func, arg);
+		return ret;
+	}
+
+	for (i = 0; i < ecom->size; i++) {
+		memcpy(lookup.val, ecom->val + i * ECOMMUNITY_SIZE,
+		       ECOMMUNITY_SIZE);
+		rt = vpn_import_rt_find(&idx->rts, &lookup);
+		if (!rt)
+			continue;
+
+		for (j = 0; j < rt->count; j++)
+			ret |= vpn_import_vrf_visit(idx, rt->vrfs[j], stamp,
+						    func, arg);
+	}
+
+	for (i = 0; i < idx->other_count; i++)
+		ret |= vpn_import_vrf_visit(idx, idx->others[i], stamp, func,
+					    arg);
+
+	return ret;
+}
+
+struct vpn_leak_to_vrf_update_ctx {
+	struct bgp *from_bgp;
+	struct bgp_path_info *path_vpn;
+	struct prefix_rd *prd;
+};
+
+static bool vpn_leak_to_vrf_update_visit(struct bgp *bgp, void *arg)
+{
+	struct vpn_leak_to_vrf_update_ctx *ctx = arg;
+	struct bgp_path_info *path_vpn = ctx->path_vpn;
+
+	if (path_vpn->extra && path_vpn->extra->bgp_orig == bgp) /* no loop */
+		return false;
+
+	return vpn_leak_to_vrf_update_onevrf(bgp, ctx->from_bgp, path_vpn,
+					     ctx->prd);
+}
+
 bool vpn_leak_to_vrf_update(struct bgp *from_bgp,
 			    struct bgp_path_info *path_vpn,
 			    struct prefix_rd *prd)
 {
-	struct listnode *mnode, *mnnode;
-	struct bgp *bgp;
-	bool leak_success = false;
+	struct vpn_leak_to_vrf_update_ctx ctx = {
+		.from_bgp = from_bgp,
+		.path_vpn = path_vpn,
+		.prd = prd,
+	};
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
 	if (debug)
 		zlog_debug("%s: start (path_vpn=%p)", __func__, path_vpn);
 
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
+	/* Loop over VRFs importing one of the route's RTs */
+	return vpn_import_vrfs_walk(family2afi(p->family),
+				    bgp_attr_get_ecommunity(path_vpn->attr),
+				    vpn_leak_to_vrf_update_visit, &ctx);
+}
+
+static bool vpn_leak_to_vrf_withdraw_onevrf(struct bgp *bgp, void *arg)
+{
+	struct bgp_path_info *path_vpn = arg;
+	const struct prefix *p = bgp_dest_get_prefix(path_vpn->net);
+	afi_t afi = family2afi(p->family);
+	safi_t safi = SAFI_UNICAST;
+	struct bgp_dest *bn;
+	struct bgp_path_info *bpi;
+	const char *debugmsg;
+
+	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
+
+	if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
+		if (debug)
+			zlog_debug("%s: skipping: %s", __func__, debugmsg);
+		return false;
+	}
+
+	/* Check for intersection of route targets */
+	if (!ecommunity_include(
+		    bgp->vpn_policy[afi].rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
+		    bgp_attr_get_ecommunity(path_vpn->attr))) {
+
+		return false;
+	}
+
+	if (debug)
+		zlog_debug("%s: withdrawing from vrf %s", __func__,
+			   bgp->name_pretty);
 
-		if (!path_vpn->extra
-		    || path_vpn->extra->bgp_orig != bgp) { /* no loop */
-			leak_success |= vpn_leak_to_vrf_update_onevrf(
-				bgp, from_bgp, path_vpn, prd);
+	bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+
+	for (bpi = bgp_dest_get_bgp_path_info(bn); bpi; bpi = bpi->next) {
+		if (bpi->extra
+		    && (struct bgp_path_info *)bpi->extra->parent == path_vpn) {
+			break;
 		}
 	}
-	return leak_success;
+
+	if (bpi) {
+		if (debug)
+			zlog_debug("%s: deleting bpi %p", __func__, bpi);
+		bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
+		bgp_path_info_delete(bn, bpi);
+		bgp_process(bgp, bn, afi, safi);
+	}
+	bgp_dest_unlock_node(bn);
+
+	return true;
 }
 
 void vpn_leak_to_vrf_withdraw(struct bgp *from_bgp,	   /* from */
 			      struct bgp_path_info *path_vpn) /* route */
 {
 	const struct prefix *p;
-	afi_t afi;
-	safi_t safi = SAFI_UNICAST;
-	struct bgp *bgp;
-	struct listnode *mnode, *mnnode;
-	struct bgp_dest *bn;
-	struct bgp_path_info *bpi;
-	const char *debugmsg;
 
 	int debug = BGP_DEBUG(vpn, VPN_LEAK_TO_VRF);
 
@@ -2136,51 +2479,11 @@ void vpn_leak_to_vrf_withdraw(struct bgp *from_bgp,	   /* from */
 	}
 
 	p = bgp_dest_get_prefix(path_vpn->net);
-	afi = family2afi(p->family);
-
-	/* Loop over VRFs */
-	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
-		if (!vpn_leak_from_vpn_active(bgp, afi, &debugmsg)) {
-			if (debug)
-				zlog_debug("%s: skipping: %s", __func__,
-					   debugmsg);
-			continue;
-		}
 
-		/* Check for intersection of route targets */
-		if (!ecommunity_include(
-			    bgp->vpn_policy[afi]
-				    .rtlist[BGP_VPN_POLICY_DIR_FROMVPN],
-			    bgp_attr_get_ecommunity(path_vpn->attr))) {
-
-			continue;
-		}
-
-		if (debug)
-			zlog_debug("%s: withdrawing from vrf %s", __func__,
-				   bgp->name_pretty);
-
-		bn = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
-
-		for (bpi = bgp_dest_get_bgp_path_info(bn); bpi;
-		     bpi = bpi->next) {
-			if (bpi->extra
-			    && (struct bgp_path_info *)bpi->extra->parent
-				       == path_vpn) {
-				break;
-			}
-		}
-
-		if (bpi) {
-			if (debug)
-				zlog_debug("%s: deleting bpi %p", __func__,
-					   bpi);
-			bgp_aggregate_decrement(bgp, p, bpi, afi, safi);
-			bgp_path_info_delete(bn, bpi);
-			bgp_process(bgp, bn, afi, safi);
-		}
-		bgp_dest_unlock_node(bn);
-	}
+	/* Loop over VRFs importing one of the route's RTs */
+	vpn_import_vrfs_walk(family2afi(p->family),
+			     bgp_attr_get_ecommunity(path_vpn->attr),
+			     vpn_leak_to_vrf_withdraw_onevrf, path_vpn);
 }
 
 void vpn_leak_to_vrf_withdraw_all(struct bgp *to_bgp, afi_t afi)
@@ -2220,9 +2523,17 @@ void vpn_leak_to_vrf_update_all(struct bgp *to_bgp, struct bgp *vpn_from,
 {
 	struct bgp_dest *pdest;
 	safi_t safi = SAFI_MPLS_VPN;
+	const char *debugmsg;
 
 	assert(vpn_from);
 
+	/* Rather than rejecting each route in turn */
+	if (!vpn_leak_from_vpn_active(to_bgp, afi, &debugmsg)) {
+		if (BGP_DEBUG(vpn, VPN_LEAK_TO_VRF))
+			zlog_debug("%s: skipping: %s", __func__, debugmsg);
+		return;
+	}
+
 	/*
 	 * Walk vpn table
 	 */
@@ -2390,6 +2701,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 						.rtlist[idir],
 					(struct ecommunity_val *)ecom->val);
 			}
+			vpn_leak_import_index_reset();
 		} else {
 			/* New router-id derive auto RD and RT and export
 			 * to VPN
@@ -2428,6 +2740,7 @@ void vpn_handle_router_id_update(struct bgp *bgp, bool withdraw,
 					bgp_import->vpn_policy[afi].rtlist[idir]
 						= ecommunity_dup(ecom);
 			}
+			vpn_leak_import_index_reset();
 
 			/* Update routes to VPN */
 			vpn_leak_postchange(BGP_VPN_POLICY_DIR_TOVPN,
@@ -2549,6 +2862,7 @@ void vrf_import_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 					 .rtlist[idir], ecom);
 	else
 		to_bgp->vpn_policy[afi].rtlist[idir] = ecommunity_dup(ecom);
+	vpn_leak_import_index_reset();
 	SET_FLAG(to_bgp->af_flags[afi][safi], BGP_CONFIG_VRF_TO_VRF_IMPORT);
 
 	if (debug) {
@@ -2639,11 +2953,13 @@ void vrf_unimport_from_vrf(struct bgp *to_bgp, struct bgp *from_bgp,
 				   BGP_CONFIG_VRF_TO_VRF_IMPORT);
 		if (to_bgp->vpn_policy[afi].rtlist[idir])
 			ecommunity_free(&to_bgp->vpn_policy[afi].rtlist[idir]);
+		vpn_leak_import_index_reset();
 	} else {
 		ecom = from_bgp->vpn_policy[afi].rtlist[edir];
 		if (ecom)
 			ecommunity_del_val(to_bgp->vpn_policy[afi].rtlist[idir],
 				   (struct ecommunity_val *)ecom->val);
+		vpn_leak_import_index_reset();
 		vpn_leak_postchange(idir, afi, bgp_get_default(), to_bgp);
 	}
 
@@ -3366,6 +3682,12 @@ void vpn_leak_postchange_all(void)
 
 	assert(bgp_default);
 
+	/* This (re)programs the SRv6 SIDs of every VRF, send the seg6local
+	 * routes to zebra in as few writes as possible.
+	 */
+	if (zclient)
+		zclient_batch_start(zclient);
+
 	/* First, do any exporting from VRFs to the single VPN RIB */
 	for (ALL_LIST_ELEMENTS_RO(bm->bgp, next, bgp)) {
 
@@ -3403,6 +3725,9 @@ void vpn_leak_postchange_all(void)
 			bgp_default,
 			bgp);
 	}
+
+	if (zclient)
+		zclient_batch_end(zclient);
 }
 
 /* When a bgp vrf instance is unconfigured, remove its routes
@@ -3559,6 +3884,7 @@ void bgp_vpn_leak_export(struct bgp *from_bgp)
 						to_vpolicy->rtlist[idir],
 						(struct ecommunity_val *)
 							ecom->val);
+				vpn_leak_import_index_reset();
 				vrf_import_from_vrf(to_bgp, from_bgp,
 						    afi, safi);
 				break;
@@ -1663,10 +1663,7 @@ static uint8_t *mplsL3vpnRteTable(struct variable *v, oid name[],
 	case MPLSL3VPNVRFRTEINETCIDRNEXTHOPAS:
 		return SNMP_INTEGER(pi->peer ? pi->peer->as : 0);
 	case MPLSL3VPNVRFRTEINETCIDRMETRIC1:
-		if (bpi_ultimate->extra)
-			return SNMP_INTEGER(bpi_ultimate->extra->igpmetric);
-		else
-			return SNMP_INTEGER(0);
+		return SNMP_INTEGER(bpi_ultimate->igpmetric);
 	case MPLSL3VPNVRFRTEINETCIDRMETRIC2:
 		return SNMP_INTEGER(-1);
 	case MPLSL3VPNVRFRTEINETCIDRMETRIC3:
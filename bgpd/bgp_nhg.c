@@ -0,0 +1,274 @@
+/* BGP shared nexthop groups
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "memory.h"
+#include "jhash.h"
+#include "nexthop.h"
+#include "zclient.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_nexthop.h"
+#include "bgpd/bgp_nht.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_nhg.h"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_NHG_CACHE, "BGP nexthop group");
+
+extern struct zclient *zclient;
+
+static uint32_t bgp_nhg_cache_hash(const struct bgp_nhg_cache *nhg)
+{
+	const struct zapi_nexthop *nh;
+	uint32_t key;
+	int i;
+
+	key = jhash_2words(nhg->afi, nhg->nexthop_num, 0xbeefcafe);
+	for (i = 0; i < nhg->nexthop_num; i++) {
+		nh = &nhg->nexthops[i];
+
+		key = jhash_3words(nh->type, nh->vrf_id, nh->ifindex, key);
+		if (nh->type == NEXTHOP_TYPE_IPV4_IFINDEX)
+			key = jhash_1word(nh->gate.ipv4.s_addr, key);
+		else
+			key = jhash(&nh->gate.ipv6, sizeof(nh->gate.ipv6), key);
+		key = jhash_2words(nh->weight, nh->label_num, key);
+		if (nh->label_num)
+			key = jhash(nh->labels,
+				    nh->label_num * sizeof(nh->labels[0]), key);
+	}
+
+	return key;
+}
+
+static int bgp_nhg_cache_cmp(const struct bgp_nhg_cache *a,
+			     const struct bgp_nhg_cache *b)
+{
+	int i, ret;
+
+	if (a->afi != b->afi)
+		return a->afi < b->afi ? -1 : 1;
+	if (a->nexthop_num != b->nexthop_num)
+		return a->nexthop_num < b->nexthop_num ? -1 : 1;
+
+	for (i = 0; i < a->nexthop_num; i++) {
+		ret = zapi_nexthop_cmp(&a->nexthops[i], &b->nexthops[i]);
+		if (ret)
+			return ret;
+	}
+
+	return 0;
+}
+
+DECLARE_HASH(bgp_nhg_cache, struct bgp_nhg_cache, entry, bgp_nhg_cache_cmp,
+	     bgp_nhg_cache_hash);
+
+static struct bgp_nhg_cache_head bgp_nhg_cache[1];
+
+/* Lookup key, with room for MULTIPATH_NUM nexthops */
+static struct bgp_nhg_cache *bgp_nhg_lookup;
+
+static void bgp_nhg_zebra_send(struct bgp_nhg_cache *nhg, bool add)
+{
+	struct zapi_nhg api_nhg = {};
+
+	if (!zclient || zclient->sock < 0)
+		return;
+
+	if (BGP_DEBUG(zebra, ZEBRA))
+		zlog_debug("Tx nexthop group %s id %u afi %s nexthops %u",
+			   add ? "add" : "delete", nhg->id, afi2str(nhg->afi),
+			   nhg->nexthop_num);
+
+	api_nhg.id = nhg->id;
+	if (add) {
+		api_nhg.nexthop_num = nhg->nexthop_num;
+		memcpy(api_nhg.nexthops, nhg->nexthops,
+		       nhg->nexthop_num * sizeof(nhg->nexthops[0]));
+	}
+
+	zclient_nhg_send(zclient, add ? ZEBRA_NHG_ADD : ZEBRA_NHG_DEL,
+			 &api_nhg);
+}
+
+/*
+ * zebra does not resolve the nexthops of protocol groups, so every nexthop
+ * needs a gateway and an interface.  Nexthops towards a connected peer get
+ * their interface from nexthop tracking.
+ */
+static bool bgp_nhg_nexthop_usable(struct zapi_nexthop *nh,
+				   struct bgp_path_info *path)
+{
+	struct bgp_nexthop_cache *bnc;
+
+	if (CHECK_FLAG(nh->flags, ZAPI_NEXTHOP_FLAG_HAS_BACKUP
+					  | ZAPI_NEXTHOP_FLAG_SEG6
+					  | ZAPI_NEXTHOP_FLAG_SEG6LOCAL
+					  | ZAPI_NEXTHOP_FLAG_EVPN))
+		return false;
+
+	switch (nh->type) {
+	case NEXTHOP_TYPE_IPV4_IFINDEX:
+	case NEXTHOP_TYPE_IPV6_IFINDEX:
+		return nh->ifindex != IFINDEX_INTERNAL;
+	case NEXTHOP_TYPE_IPV4:
+	case NEXTHOP_TYPE_IPV6:
+		break;
+	case NEXTHOP_TYPE_IFINDEX:
+	case NEXTHOP_TYPE_BLACKHOLE:
+		return false;
+	}
+
+	bnc = path ? path->nexthop : NULL;
+	if (!bnc || !CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID)
+	    || !CHECK_FLAG(bnc->flags, BGP_NEXTHOP_CONNECTED)
+	    || bnc->nexthop_num != 1 || !bnc->nexthop
+	    || bnc->nexthop->ifindex == IFINDEX_INTERNAL)
+		return false;
+
+	/* the route's nexthop may have been rewritten by a table-map */
+	if (nh->type == NEXTHOP_TYPE_IPV4) {
+		if (bnc->prefix.family != AF_INET
+		    || !IPV4_ADDR_SAME(&bnc->prefix.u.prefix4, &nh->gate.ipv4))
+			return false;
+		nh->type = NEXTHOP_TYPE_IPV4_IFINDEX;
+	} else {
+		if (bnc->prefix.family != AF_INET6
+		    || !IPV6_ADDR_SAME(&bnc->prefix.u.prefix6, &nh->gate.ipv6))
+			return false;
+		nh->type = NEXTHOP_TYPE_IPV6_IFINDEX;
+	}
+	nh->ifindex = bnc->nexthop->ifindex;
+
+	return true;
+}
+
+struct bgp_nhg_cache *
+bgp_nhg_route_get(struct zapi_route *api, struct bgp_path_info **nh_paths)
+{
+	struct bgp_nhg_cache *lookup = bgp_nhg_lookup;
+	struct bgp_nhg_cache *nhg;
+	uint32_t id;
+	int i;
+
+	if (!CHECK_FLAG(bm->flags, BM_FLAG_INSTALL_NHG) || !lookup)
+		return NULL;
+
+	if (!zclient || zclient->sock < 0)
+		return NULL;
+
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG)
+	    || CHECK_FLAG(api->message, ZAPI_MESSAGE_BACKUP_NEXTHOPS)
+	    || !CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP)
+	    || !api->nexthop_num)
+		return NULL;
+
+	lookup->afi = family2afi(api->prefix.family);
+	lookup->nexthop_num = api->nexthop_num;
+	for (i = 0; i < api->nexthop_num; i++) {
+		lookup->nexthops[i] = api->nexthops[i];
+		if (!bgp_nhg_nexthop_usable(&lookup->nexthops[i], nh_paths[i]))
+			return NULL;
+	}
+	qsort(lookup->nexthops, lookup->nexthop_num,
+	      sizeof(lookup->nexthops[0]), zapi_nexthop_cmp);
+
+	nhg = bgp_nhg_cache_find(bgp_nhg_cache, lookup);
+	if (!nhg) {
+		id = bgp_l3nhg_id_alloc();
+		if (!id)
+			return NULL;
+
+		nhg = XCALLOC(MTYPE_BGP_NHG_CACHE,
+			      sizeof(*nhg)
+				      + lookup->nexthop_num
+						* sizeof(nhg->nexthops[0]));
+		nhg->id = id;
+		nhg->afi = lookup->afi;
+		nhg->nexthop_num = lookup->nexthop_num;
+		memcpy(nhg->nexthops, lookup->nexthops,
+		       nhg->nexthop_num * sizeof(nhg->nexthops[0]));
+		bgp_nhg_cache_add(bgp_nhg_cache, nhg);
+
+		bgp_nhg_zebra_send(nhg, true);
+	}
+	nhg->refcnt++;
+
+	api->nhgid = nhg->id;
+	SET_FLAG(api->message, ZAPI_MESSAGE_NHG);
+	UNSET_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP);
+	api->nexthop_num = 0;
+
+	return nhg;
+}
+
+static void bgp_nhg_release(struct bgp_nhg_cache *nhg)
+{
+	if (--nhg->refcnt)
+		return;
+
+	bgp_nhg_zebra_send(nhg, false);
+	bgp_nhg_cache_del(bgp_nhg_cache, nhg);
+	bgp_l3nhg_id_free(nhg->id);
+	XFREE(MTYPE_BGP_NHG_CACHE, nhg);
+}
+
+void bgp_nhg_route_done(struct bgp_dest *dest, struct bgp_nhg_cache *nhg)
+{
+	struct bgp_nhg_cache *old = dest->nhg;
+
+	dest->nhg = nhg;
+	if (old)
+		bgp_nhg_release(old);
+}
+
+void bgp_nhg_zebra_replay(void)
+{
+	struct bgp_nhg_cache *nhg;
+
+	frr_each (bgp_nhg_cache, bgp_nhg_cache, nhg)
+		bgp_nhg_zebra_send(nhg, true);
+}
+
+void bgp_nhg_init(void)
+{
+	bgp_nhg_cache_init(bgp_nhg_cache);
+	bgp_nhg_lookup = XCALLOC(MTYPE_BGP_NHG_CACHE,
+				 sizeof(*bgp_nhg_lookup)
+					 + MULTIPATH_NUM
+						   * sizeof(bgp_nhg_lookup
+								    ->nexthops[0]));
+}
+
+void bgp_nhg_finish(void)
+{
+	struct bgp_nhg_cache *nhg;
+
+	/* zebra drops the groups of a departing client by itself */
+	while ((nhg = bgp_nhg_cache_pop(bgp_nhg_cache))) {
+		bgp_l3nhg_id_free(nhg->id);
+		XFREE(MTYPE_BGP_NHG_CACHE, nhg);
+	}
+	bgp_nhg_cache_fini(bgp_nhg_cache);
+	XFREE(MTYPE_BGP_NHG_CACHE, bgp_nhg_lookup);
+}
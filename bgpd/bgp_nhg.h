@@ -0,0 +1,67 @@
+/* BGP shared nexthop groups
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _BGP_NHG_H
+#define _BGP_NHG_H
+
+#include "typesafe.h"
+#include "zclient.h"
+
+PREDECL_HASH(bgp_nhg_cache);
+
+/*
+ * A protocol nexthop group installed in zebra for a set of nexthops used
+ * by one or more routes.  Routes using it are sent with its ID only,
+ * instead of repeating the nexthops.
+ */
+struct bgp_nhg_cache {
+	struct bgp_nhg_cache_item entry;
+
+	uint32_t id;
+	afi_t afi;
+
+	/* number of bgp_dests installed with this group */
+	uint32_t refcnt;
+
+	uint16_t nexthop_num;
+	struct zapi_nexthop nexthops[];
+};
+
+/*
+ * Try to move the nexthops of the route in api, which is about to be sent
+ * for dest, into a shared group.  nh_paths holds the path each nexthop was
+ * derived from.  On success api references the group ID only.  Any group
+ * previously used by dest is released after the route has been sent, with
+ * bgp_nhg_route_done().
+ */
+extern struct bgp_nhg_cache *
+bgp_nhg_route_get(struct zapi_route *api, struct bgp_path_info **nh_paths);
+
+/* dest has been sent to zebra using nhg (may be NULL) */
+extern void bgp_nhg_route_done(struct bgp_dest *dest,
+			       struct bgp_nhg_cache *nhg);
+
+/* Re-install all groups, after (re)connecting to zebra */
+extern void bgp_nhg_zebra_replay(void);
+
+extern void bgp_nhg_init(void);
+extern void bgp_nhg_finish(void);
+
+#endif /* _BGP_NHG_H */
@@ -61,24 +61,27 @@ static int bgp_isvalid_nexthop(struct bgp_nexthop_cache *bnc)
 		    && bnc->nexthop_num > 0));
 }
 
-static int bgp_isvalid_nexthop_for_ebgp(struct bgp_nexthop_cache *bnc,
-					struct bgp_path_info *path)
+/*
+ * The interface lookups of the MPLS validity checks only depend on the
+ * nexthop.  A nexthop may be used by thousands of paths, of hundreds of
+ * instances when L3VPN routes are leaked (they all use the nexthop of the
+ * instance the VPN routes were received in), so evaluate_paths() makes
+ * these lookups once per update rather than once per path.  Interfaces
+ * change without nexthop updates, the results are not kept in the bnc.
+ */
+struct bnc_mpls_eval {
+	bool done;
+	/* one of the nexthops is an interface with mpls bgp-forwarding */
+	bool bgp_forwarding;
+	/* the nexthop goes over a GRE tunnel */
+	bool gre;
+};
+
+static bool bnc_has_bgp_forwarding(struct bgp_nexthop_cache *bnc)
 {
 	struct interface *ifp = NULL;
 	struct nexthop *nexthop;
 	struct bgp_interface *iifp;
-	struct peer *peer;
-
-	if (!path->extra || !path->extra->peer_orig)
-		return false;
-
-	peer = path->extra->peer_orig;
-
-	/* only connected ebgp peers are valid */
-	if (peer->sort != BGP_PEER_EBGP || peer->ttl != BGP_DEFAULT_TTL ||
-	    CHECK_FLAG(peer->flags, PEER_FLAG_DISABLE_CONNECTED_CHECK) ||
-	    CHECK_FLAG(peer->bgp->flags, BGP_FLAG_DISABLE_NH_CONNECTED_CHK))
-		return false;
 
 	for (nexthop = bnc->nexthop; nexthop; nexthop = nexthop->next) {
 		if (nexthop->type == NEXTHOP_TYPE_IFINDEX ||
@@ -97,8 +100,7 @@ static int bgp_isvalid_nexthop_for_ebgp(struct bgp_nexthop_cache *bnc,
 	return false;
 }
 
-static int bgp_isvalid_nexthop_for_mplsovergre(struct bgp_nexthop_cache *bnc,
-					       struct bgp_path_info *path)
+static bool bnc_is_gre(struct bgp_nexthop_cache *bnc)
 {
 	struct interface *ifp = NULL;
 	struct nexthop *nexthop;
@@ -113,18 +115,56 @@ static int bgp_isvalid_nexthop_for_mplsovergre(struct bgp_nexthop_cache *bnc,
 				break;
 		}
 	}
-	if (!ifp)
+	return ifp != NULL;
+}
+
+static void bnc_mpls_eval(struct bgp_nexthop_cache *bnc,
+			  struct bnc_mpls_eval *eval)
+{
+	if (eval->done)
+		return;
+
+	eval->bgp_forwarding = bnc_has_bgp_forwarding(bnc);
+	eval->gre = bnc_is_gre(bnc);
+	eval->done = true;
+}
+
+static int bgp_isvalid_nexthop_for_ebgp(struct bgp_nexthop_cache *bnc,
+					struct bgp_path_info *path,
+					struct bnc_mpls_eval *eval)
+{
+	struct peer *peer;
+
+	if (!path->extra || !path->extra->peer_orig)
 		return false;
 
-	if (CHECK_FLAG(path->attr->rmap_change_flags,
-		       BATTR_RMAP_L3VPN_ACCEPT_GRE))
-		return true;
+	peer = path->extra->peer_orig;
 
-	return false;
+	/* only connected ebgp peers are valid */
+	if (peer->sort != BGP_PEER_EBGP || peer->ttl != BGP_DEFAULT_TTL ||
+	    CHECK_FLAG(peer->flags, PEER_FLAG_DISABLE_CONNECTED_CHECK) ||
+	    CHECK_FLAG(peer->bgp->flags, BGP_FLAG_DISABLE_NH_CONNECTED_CHK))
+		return false;
+
+	bnc_mpls_eval(bnc, eval);
+	return eval->bgp_forwarding;
+}
+
+static int bgp_isvalid_nexthop_for_mplsovergre(struct bgp_nexthop_cache *bnc,
+					       struct bgp_path_info *path,
+					       struct bnc_mpls_eval *eval)
+{
+	if (!CHECK_FLAG(path->attr->rmap_change_flags,
+			BATTR_RMAP_L3VPN_ACCEPT_GRE))
+		return false;
+
+	bnc_mpls_eval(bnc, eval);
+	return eval->gre;
 }
 
 static int bgp_isvalid_nexthop_for_mpls(struct bgp_nexthop_cache *bnc,
-					struct bgp_path_info *path)
+					struct bgp_path_info *path,
+					struct bnc_mpls_eval *eval)
 {
 	/*
 	 * - In the case of MPLS-VPN, the label is learned from LDP or other
@@ -142,8 +182,9 @@ static int bgp_isvalid_nexthop_for_mpls(struct bgp_nexthop_cache *bnc,
 			 (CHECK_FLAG(path->flags, BGP_PATH_ACCEPT_OWN) ||
 			  CHECK_FLAG(bnc->flags, BGP_NEXTHOP_LABELED_VALID) ||
 			  bnc->bgp->srv6_enabled ||
-			  bgp_isvalid_nexthop_for_ebgp(bnc, path) ||
-			  bgp_isvalid_nexthop_for_mplsovergre(bnc, path)))));
+			  bgp_isvalid_nexthop_for_ebgp(bnc, path, eval) ||
+			  bgp_isvalid_nexthop_for_mplsovergre(bnc, path,
+							      eval)))));
 }
 
 static void bgp_unlink_nexthop_check(struct bgp_nexthop_cache *bnc)
@@ -452,11 +493,10 @@ int bgp_find_or_add_nexthop(struct bgp *bgp_route, struct bgp *bgp_nexthop,
 		path_nh_map(pi, bnc, true);
 
 		bpi_ultimate = bgp_get_imported_bpi_ultimate(pi);
-		if (CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID) && bnc->metric)
-			(bgp_path_info_extra_get(bpi_ultimate))->igpmetric =
-				bnc->metric;
-		else if (bpi_ultimate->extra)
-			bpi_ultimate->extra->igpmetric = 0;
+		if (CHECK_FLAG(bnc->flags, BGP_NEXTHOP_VALID))
+			bpi_ultimate->igpmetric = bnc->metric;
+		else
+			bpi_ultimate->igpmetric = 0;
 	} else if (peer) {
 		/*
 		 * Let's not accidentally save the peer data for a peer
@@ -477,9 +517,11 @@ int bgp_find_or_add_nexthop(struct bgp *bgp_route, struct bgp *bgp_nexthop,
 		return 1;
 	else if (safi == SAFI_UNICAST && pi &&
 		 pi->sub_type == BGP_ROUTE_IMPORTED && pi->extra &&
-		 pi->extra->num_labels && !bnc->is_evpn_gwip_nexthop)
-		return bgp_isvalid_nexthop_for_mpls(bnc, pi);
-	else
+		 pi->extra->num_labels && !bnc->is_evpn_gwip_nexthop) {
+		struct bnc_mpls_eval eval = {};
+
+		return bgp_isvalid_nexthop_for_mpls(bnc, pi, &eval);
+	} else
 		return (bgp_isvalid_nexthop(bnc));
 }
 
@@ -1133,6 +1175,8 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 	safi_t safi;
 	struct bgp *bgp_path;
 	const struct prefix *p;
+	struct bnc_mpls_eval eval = {};
+	bool bnc_valid = bgp_isvalid_nexthop(bnc);
 
 	if (BGP_DEBUG(nht, NHT)) {
 		char bnc_buf[BNC_FLAG_DUMP_SIZE];
@@ -1189,8 +1233,9 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 		    && (path->attr->evpn_overlay.type
 			!= OVERLAY_INDEX_GATEWAY_IP)) {
 			bnc_is_valid_nexthop =
-				bgp_isvalid_nexthop_for_mpls(bnc, path) ? true
-									: false;
+				bgp_isvalid_nexthop_for_mpls(bnc, path, &eval)
+					? true
+					: false;
 		} else {
 			if (bgp_update_martian_nexthop(
 				    bnc->bgp, afi, safi, path->type,
@@ -1200,8 +1245,7 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 						"%s: prefix %pBD (vrf %s), ignoring path due to martian or self-next-hop",
 						__func__, dest, bgp_path->name);
 			} else
-				bnc_is_valid_nexthop =
-					bgp_isvalid_nexthop(bnc) ? true : false;
+				bnc_is_valid_nexthop = bnc_valid;
 		}
 
 		if (BGP_DEBUG(nht, NHT)) {
@@ -1227,11 +1271,10 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 		/* Copy the metric to the path. Will be used for bestpath
 		 * computation */
 		bpi_ultimate = bgp_get_imported_bpi_ultimate(path);
-		if (bgp_isvalid_nexthop(bnc) && bnc->metric)
-			(bgp_path_info_extra_get(bpi_ultimate))->igpmetric =
-				bnc->metric;
-		else if (bpi_ultimate->extra)
-			bpi_ultimate->extra->igpmetric = 0;
+		if (bnc_valid)
+			bpi_ultimate->igpmetric = bnc->metric;
+		else
+			bpi_ultimate->igpmetric = 0;
 
 		if (CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_METRIC_CHANGED)
 		    || CHECK_FLAG(bnc->change_flags, BGP_NEXTHOP_CHANGED)
@@ -1271,7 +1314,7 @@ void evaluate_paths(struct bgp_nexthop_cache *bnc)
 	}
 
 	if (peer) {
-		int valid_nexthops = bgp_isvalid_nexthop(bnc);
+		int valid_nexthops = bnc_valid;
 
 		if (valid_nexthops) {
 			/*
@@ -41,6 +41,7 @@
 #include "bgpd/bgp_aspath.h"
 #include "bgpd/bgp_vty.h"
 #include "bgpd/bgp_memory.h"
+#include "bgpd/bgp_rtc.h"
 
 static const struct message capcode_str[] = {
 	{CAPABILITY_CODE_MP, "MultiProtocol Extensions"},
@@ -331,6 +332,12 @@ static int bgp_capability_mp(struct peer *peer, struct capability_header *hdr)
 			   peer->host, lookup_msg(capcode_str, hdr->code, NULL),
 			   iana_afi2str(mpc.afi), iana_safi2str(mpc.safi));
 
+	/* Route target constraint has no RIB of its own (bgp_rtc.c) */
+	if (mpc.afi == IANA_AFI_IPV4 && mpc.safi == IANA_SAFI_RTC) {
+		SET_FLAG(peer->cap, PEER_CAP_RTC_RCV);
+		return 0;
+	}
+
 	/* Convert AFI, SAFI to internal values, check. */
 	if (bgp_map_afi_safi_iana2int(mpc.afi, mpc.safi, &afi, &safi))
 		return -1;
@@ -1736,6 +1743,19 @@ uint16_t bgp_open_capability(struct stream *s, struct peer *peer,
 		}
 	}
 
+	/* Route target constraint, along with VPN or EVPN */
+	if (bgp_rtc_wanted(peer)) {
+		SET_FLAG(peer->cap, PEER_CAP_RTC_ADV);
+		stream_putc(s, BGP_OPEN_OPT_CAP);
+		ext_opt_params ? stream_putw(s, CAPABILITY_CODE_MP_LEN + 2)
+			       : stream_putc(s, CAPABILITY_CODE_MP_LEN + 2);
+		stream_putc(s, CAPABILITY_CODE_MP);
+		stream_putc(s, CAPABILITY_CODE_MP_LEN);
+		stream_putw(s, IANA_AFI_IPV4);
+		stream_putc(s, 0);
+		stream_putc(s, IANA_SAFI_RTC);
+	}
+
 	/* Route refresh. */
 	SET_FLAG(peer->cap, PEER_CAP_REFRESH_ADV);
 	stream_putc(s, BGP_OPEN_OPT_CAP);
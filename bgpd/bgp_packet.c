@@ -65,6 +65,8 @@
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_trace.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_UPD_ATTR_CACHE, "BGP UPDATE attribute cache");
+
 DEFINE_HOOK(bgp_packet_dump,
 		(struct peer *peer, uint8_t type, bgp_size_t size,
 			struct stream *s),
@@ -131,8 +133,10 @@ static void bgp_packet_add(struct peer *peer, struct stream *s)
 		 * now, otherwise if we write another packet immediately
 		 * after it'll get confused
 		 */
-		if (!stream_fifo_count_safe(peer->obuf))
+		if (!stream_fifo_count_safe(peer->obuf)) {
 			peer->last_sendq_ok = monotime(NULL);
+			peer->obuf_stamp = bgp_pipeline_now();
+		}
 
 		stream_fifo_push(peer->obuf, s);
 
@@ -173,6 +177,16 @@ static void bgp_packet_add(struct peer *peer, struct stream *s)
 	}
 }
 
+/*
+ * Queue a complete message built outside of the update-group machinery,
+ * eg. route target constraint updates (bgp_rtc.c).
+ */
+void bgp_packet_send(struct peer *peer, struct stream *s)
+{
+	bgp_packet_add(peer, s);
+	bgp_writes_on(peer);
+}
+
 static struct stream *bgp_update_packet_eor(struct peer *peer, afi_t afi,
 					    safi_t safi)
 {
@@ -506,11 +520,18 @@ void bgp_generate_updgrp_packets(struct thread *thread)
 			 * WITHDRAWs first.
 			 */
 			if (!next_pkt || !next_pkt->buffer) {
+				int64_t t_gen = bgp_pipeline_now();
+
 				next_pkt = subgroup_withdraw_packet(
 					PAF_SUBGRP(paf));
 				if (!next_pkt || !next_pkt->buffer)
 					subgroup_update_packet(PAF_SUBGRP(paf));
 				next_pkt = paf->next_pkt_to_send;
+				if (next_pkt && next_pkt->buffer)
+					bgp_pipeline_record(
+						&peer->pipeline, peer->host,
+						afi, BGP_PIPELINE_UPDATE,
+						t_gen);
 			}
 
 			/*
@@ -519,10 +540,12 @@ void bgp_generate_updgrp_packets(struct thread *thread)
 			 * if not, skip to the next AFI, SAFI. Don't send the
 			 * EOR prematurely; if the subgroup's coalesce timer is
 			 * running, the adjacency-out structure is not created
-			 * yet.
+			 * yet, and while it walks the table it is incomplete.
 			 */
 			if (!next_pkt || !next_pkt->buffer) {
-				if (!paf->t_announce_route) {
+				if (!paf->t_announce_route
+				    && !subgroup_announce_pending(
+					    PAF_SUBGRP(paf))) {
 					/* Make sure we supress BGP UPDATES
 					 * for normal processing later again.
 					 */
@@ -564,6 +587,8 @@ void bgp_generate_updgrp_packets(struct thread *thread)
 				if (CHECK_FLAG(peer->cap,
 					       PEER_CAP_RESTART_RCV)) {
 					if (!(PAF_SUBGRP(paf))->t_coalesce
+					    && !subgroup_announce_pending(
+						    PAF_SUBGRP(paf))
 					    && peer->afc_nego[afi][safi]
 					    && peer->synctime
 					    && !CHECK_FLAG(
@@ -1812,6 +1837,59 @@ static void bgp_refresh_stalepath_timer_expire(struct thread *thread)
 	bgp_timer_set(peer);
 }
 
+/*
+ * UPDATE attribute parse cache.
+ *
+ * A peer sending a large table packs as many NLRI per UPDATE as fit, so
+ * consecutive UPDATEs very often carry byte-identical path attributes.
+ * The parse result of the last UPDATE is kept for the duration of one
+ * bgp_process_packet() run (so peer configuration can't change under it)
+ * and reused when the next one's raw attributes are the same.
+ *
+ * Only attributes without MP_REACH_NLRI/MP_UNREACH_NLRI are cached since
+ * those carry the NLRI, and only if they parsed without any error.
+ */
+static void bgp_update_attr_cache_flush(struct peer *peer)
+{
+	if (!peer->upd_attr)
+		return;
+
+	bgp_attr_unintern_sub(peer->upd_attr);
+	XFREE(MTYPE_BGP_UPD_ATTR_CACHE, peer->upd_attr);
+	XFREE(MTYPE_BGP_UPD_ATTR_CACHE, peer->upd_attr_raw);
+	peer->upd_attr_len = 0;
+}
+
+static bool bgp_update_attr_cache_get(struct peer *peer, const uint8_t *raw,
+				      bgp_size_t len, struct attr *attr)
+{
+	if (!peer->upd_attr || peer->upd_attr_len != len
+	    || memcmp(peer->upd_attr_raw, raw, len))
+		return false;
+
+	*attr = *peer->upd_attr;
+	bgp_attr_ref_sub(attr);
+	return true;
+}
+
+static void bgp_update_attr_cache_set(struct peer *peer, const uint8_t *raw,
+				      bgp_size_t len, const struct attr *attr)
+{
+	bgp_update_attr_cache_flush(peer);
+
+	if (CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_MP_REACH_NLRI)
+					   | ATTR_FLAG_BIT(BGP_ATTR_MP_UNREACH_NLRI)))
+		return;
+
+	peer->upd_attr = XMALLOC(MTYPE_BGP_UPD_ATTR_CACHE, sizeof(*attr));
+	*peer->upd_attr = *attr;
+	bgp_attr_ref_sub(peer->upd_attr);
+
+	peer->upd_attr_raw = XMALLOC(MTYPE_BGP_UPD_ATTR_CACHE, len);
+	memcpy(peer->upd_attr_raw, raw, len);
+	peer->upd_attr_len = len;
+}
+
 /**
  * Process BGP UPDATE message for peer.
  *
@@ -1938,12 +2016,26 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 
 	/* Parse attribute when it exists. */
 	if (attribute_len) {
-		attr_parse_ret = bgp_attr_parse(peer, &attr, attribute_len,
-						&nlris[NLRI_MP_UPDATE],
-						&nlris[NLRI_MP_WITHDRAW]);
-		if (attr_parse_ret == BGP_ATTR_PARSE_ERROR) {
-			bgp_attr_unintern_sub(&attr);
-			return BGP_Stop;
+		uint8_t *attr_raw = stream_pnt(s);
+
+		if (bgp_update_attr_cache_get(peer, attr_raw, attribute_len,
+					      &attr)) {
+			stream_forward_getp(s, attribute_len);
+		} else {
+			attr_parse_ret = bgp_attr_parse(peer, &attr,
+							attribute_len,
+							&nlris[NLRI_MP_UPDATE],
+							&nlris[NLRI_MP_WITHDRAW]);
+			if (attr_parse_ret == BGP_ATTR_PARSE_ERROR) {
+				bgp_attr_unintern_sub(&attr);
+				return BGP_Stop;
+			}
+
+			if (attr_parse_ret == BGP_ATTR_PARSE_PROCEED)
+				bgp_update_attr_cache_set(peer, attr_raw,
+							  attribute_len, &attr);
+			else
+				bgp_update_attr_cache_flush(peer);
 		}
 	}
 
@@ -2132,9 +2224,6 @@ static int bgp_update_receive(struct peer *peer, bgp_size_t size)
 
 	peer->update_time = monotime(NULL);
 
-	/* Notify BGP Conditional advertisement scanner process */
-	peer->advmap_table_change = true;
-
 	return Receive_UPDATE_message;
 }
 
@@ -2886,13 +2975,24 @@ void bgp_process_packet(struct thread *thread)
 		uint8_t type = 0;
 		bgp_size_t size;
 		char notify_data_length[2];
+		int64_t t_read = 0, t_parse;
 
 		frr_with_mutex (&peer->io_mtx) {
 			peer->curr = stream_fifo_pop(peer->ibuf);
+			t_read = peer->ibuf_stamp;
 		}
 
-		if (peer->curr == NULL) // no packets to process, hmm...
+		if (peer->curr == NULL) { // no packets to process, hmm...
+			bgp_update_attr_cache_flush(peer);
 			return;
+		}
+
+		/* time in ibuf of the oldest packet of this run */
+		if (!processed)
+			bgp_pipeline_record(&peer->pipeline, peer->host,
+					    AFI_UNSPEC, BGP_PIPELINE_READ,
+					    t_read);
+		t_parse = bgp_pipeline_now();
 
 		/* skip the marker and copy the packet length */
 		stream_forward_getp(peer->curr, BGP_MARKER_SIZE);
@@ -2996,13 +3096,19 @@ void bgp_process_packet(struct thread *thread)
 		stream_free(peer->curr);
 		peer->curr = NULL;
 		processed++;
+		bgp_pipeline_record(&peer->pipeline, peer->host, AFI_UNSPEC,
+				    BGP_PIPELINE_PARSE, t_parse);
 
 		/* Update FSM */
-		if (mprc != BGP_PACKET_NOOP)
-			fsm_update_result = bgp_event_update(peer, mprc);
-		else
+		if (mprc == BGP_PACKET_NOOP)
 			continue;
 
+		/* Anything but an UPDATE may stop (and free) the peer */
+		if (mprc != Receive_UPDATE_message)
+			bgp_update_attr_cache_flush(peer);
+
+		fsm_update_result = bgp_event_update(peer, mprc);
+
 		/*
 		 * If peer was deleted, do not process any more packets. This
 		 * is usually due to executing BGP_Stop or a stub deletion.
@@ -3014,6 +3120,8 @@ void bgp_process_packet(struct thread *thread)
 
 	if (fsm_update_result != FSM_PEER_TRANSFERRED
 	    && fsm_update_result != FSM_PEER_STOPPED) {
+		bgp_update_attr_cache_flush(peer);
+
 		frr_with_mutex (&peer->io_mtx) {
 			// more work to do, come back later
 			if (peer->ibuf->count > 0)
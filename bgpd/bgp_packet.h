@@ -80,6 +80,7 @@ extern void bgp_check_update_delay(struct bgp *);
 
 extern int bgp_packet_set_marker(struct stream *s, uint8_t type);
 extern void bgp_packet_set_size(struct stream *s);
+extern void bgp_packet_send(struct peer *peer, struct stream *s);
 
 extern void bgp_generate_updgrp_packets(struct thread *);
 extern void bgp_process_packet(struct thread *);
@@ -58,122 +58,76 @@ static int bgp_pbr_match_entry_counter_unique;
 static int bgp_pbr_action_counter_unique;
 static int bgp_pbr_match_iptable_counter_unique;
 
-struct bgp_pbr_match_iptable_unique {
-	uint32_t unique;
-	struct bgp_pbr_match *bpm_found;
-};
-
-struct bgp_pbr_match_entry_unique {
-	uint32_t unique;
-	struct bgp_pbr_match_entry *bpme_found;
-};
+static int bgp_pbr_rule_id_cmp(const struct bgp_pbr_rule *a,
+			       const struct bgp_pbr_rule *b)
+{
+	return numcmp(a->unique, b->unique);
+}
 
-struct bgp_pbr_action_unique {
-	uint32_t unique;
-	struct bgp_pbr_action *bpa_found;
-};
+static uint32_t bgp_pbr_rule_id_hash(const struct bgp_pbr_rule *a)
+{
+	return a->unique;
+}
 
-struct bgp_pbr_rule_unique {
-	uint32_t unique;
-	struct bgp_pbr_rule *bpr_found;
-};
+DECLARE_HASH(bgp_pbr_rule_id, struct bgp_pbr_rule, id_item, bgp_pbr_rule_id_cmp,
+	     bgp_pbr_rule_id_hash);
 
-static int bgp_pbr_rule_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_match_id_cmp(const struct bgp_pbr_match *a,
+				const struct bgp_pbr_match *b)
 {
-	struct bgp_pbr_rule *bpr = (struct bgp_pbr_rule *)bucket->data;
-	struct bgp_pbr_rule_unique *bpru = (struct bgp_pbr_rule_unique *)
-		arg;
-	uint32_t unique = bpru->unique;
-
-	if (bpr->unique == unique) {
-		bpru->bpr_found = bpr;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return numcmp(a->unique, b->unique);
 }
 
-static int bgp_pbr_action_walkcb(struct hash_bucket *bucket, void *arg)
+static uint32_t bgp_pbr_match_id_hash(const struct bgp_pbr_match *a)
 {
-	struct bgp_pbr_action *bpa = (struct bgp_pbr_action *)bucket->data;
-	struct bgp_pbr_action_unique *bpau = (struct bgp_pbr_action_unique *)
-		arg;
-	uint32_t unique = bpau->unique;
-
-	if (bpa->unique == unique) {
-		bpau->bpa_found = bpa;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return a->unique;
 }
 
-static int bgp_pbr_match_entry_walkcb(struct hash_bucket *bucket, void *arg)
+DECLARE_HASH(bgp_pbr_match_id, struct bgp_pbr_match, id_item,
+	     bgp_pbr_match_id_cmp, bgp_pbr_match_id_hash);
+
+static int bgp_pbr_iptable_id_cmp(const struct bgp_pbr_match *a,
+				  const struct bgp_pbr_match *b)
 {
-	struct bgp_pbr_match_entry *bpme =
-		(struct bgp_pbr_match_entry *)bucket->data;
-	struct bgp_pbr_match_entry_unique *bpmeu =
-		(struct bgp_pbr_match_entry_unique *)arg;
-	uint32_t unique = bpmeu->unique;
+	return numcmp(a->unique2, b->unique2);
+}
 
-	if (bpme->unique == unique) {
-		bpmeu->bpme_found = bpme;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+static uint32_t bgp_pbr_iptable_id_hash(const struct bgp_pbr_match *a)
+{
+	return a->unique2;
 }
 
-struct bgp_pbr_match_ipsetname {
-	char *ipsetname;
-	struct bgp_pbr_match *bpm_found;
-};
+DECLARE_HASH(bgp_pbr_iptable_id, struct bgp_pbr_match, iptable_id_item,
+	     bgp_pbr_iptable_id_cmp, bgp_pbr_iptable_id_hash);
 
-static int bgp_pbr_match_pername_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_entry_id_cmp(const struct bgp_pbr_match_entry *a,
+				const struct bgp_pbr_match_entry *b)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_ipsetname *bpmi =
-		(struct bgp_pbr_match_ipsetname *)arg;
-	char *ipset_name = bpmi->ipsetname;
-
-	if (!strncmp(ipset_name, bpm->ipset_name,
-		     ZEBRA_IPSET_NAME_SIZE)) {
-		bpmi->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return numcmp(a->unique, b->unique);
 }
 
-static int bgp_pbr_match_iptable_walkcb(struct hash_bucket *bucket, void *arg)
+static uint32_t bgp_pbr_entry_id_hash(const struct bgp_pbr_match_entry *a)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_iptable_unique *bpmiu =
-		(struct bgp_pbr_match_iptable_unique *)arg;
-	uint32_t unique = bpmiu->unique;
-
-	if (bpm->unique2 == unique) {
-		bpmiu->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+	return a->unique;
 }
 
-struct bgp_pbr_match_unique {
-	uint32_t unique;
-	struct bgp_pbr_match *bpm_found;
-};
+DECLARE_HASH(bgp_pbr_entry_id, struct bgp_pbr_match_entry, id_item,
+	     bgp_pbr_entry_id_cmp, bgp_pbr_entry_id_hash);
 
-static int bgp_pbr_match_walkcb(struct hash_bucket *bucket, void *arg)
+static int bgp_pbr_action_id_cmp(const struct bgp_pbr_action *a,
+				 const struct bgp_pbr_action *b)
 {
-	struct bgp_pbr_match *bpm = (struct bgp_pbr_match *)bucket->data;
-	struct bgp_pbr_match_unique *bpmu = (struct bgp_pbr_match_unique *)
-		arg;
-	uint32_t unique = bpmu->unique;
+	return numcmp(a->unique, b->unique);
+}
 
-	if (bpm->unique == unique) {
-		bpmu->bpm_found = bpm;
-		return HASHWALK_ABORT;
-	}
-	return HASHWALK_CONTINUE;
+static uint32_t bgp_pbr_action_id_hash(const struct bgp_pbr_action *a)
+{
+	return a->unique;
 }
 
+DECLARE_HASH(bgp_pbr_action_id, struct bgp_pbr_action, id_item,
+	     bgp_pbr_action_id_cmp, bgp_pbr_action_id_hash);
+
 static int snprintf_bgp_pbr_match_val(char *str, int len,
 				      struct bgp_pbr_match_val *mval,
 				      const char *prepend)
@@ -1317,88 +1271,131 @@ bool bgp_pbr_action_hash_equal(const void *arg1, const void *arg2)
 	return nexthop_same(&r1->nh, &r2->nh);
 }
 
+static struct bgp_pbr_config *bgp_pbr_config_lookup(vrf_id_t vrf_id)
+{
+	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
+
+	return bgp ? bgp->bgp_pbr_cfg : NULL;
+}
+
 struct bgp_pbr_rule *bgp_pbr_rule_lookup(vrf_id_t vrf_id,
 					 uint32_t unique)
 {
-	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_rule_unique bpru;
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	struct bgp_pbr_rule ref = { .unique = unique };
 
-	if (!bgp || unique == 0)
+	if (!cfg || unique == 0)
 		return NULL;
-	bpru.unique = unique;
-	bpru.bpr_found = NULL;
-	hash_walk(bgp->pbr_rule_hash, bgp_pbr_rule_walkcb, &bpru);
-	return bpru.bpr_found;
+	return bgp_pbr_rule_id_find(&cfg->rule_ids, &ref);
 }
 
 struct bgp_pbr_action *bgp_pbr_action_rule_lookup(vrf_id_t vrf_id,
 						  uint32_t unique)
 {
-	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_action_unique bpau;
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	struct bgp_pbr_action ref = { .unique = unique };
 
-	if (!bgp || unique == 0)
+	if (!cfg || unique == 0)
 		return NULL;
-	bpau.unique = unique;
-	bpau.bpa_found = NULL;
-	hash_walk(bgp->pbr_action_hash, bgp_pbr_action_walkcb, &bpau);
-	return bpau.bpa_found;
+	return bgp_pbr_action_id_find(&cfg->action_ids, &ref);
 }
 
 struct bgp_pbr_match *bgp_pbr_match_ipset_lookup(vrf_id_t vrf_id,
 						 uint32_t unique)
 {
-	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_unique bpmu;
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	struct bgp_pbr_match ref = { .unique = unique };
 
-	if (!bgp || unique == 0)
+	if (!cfg || unique == 0)
 		return NULL;
-	bpmu.unique = unique;
-	bpmu.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_walkcb, &bpmu);
-	return bpmu.bpm_found;
+	return bgp_pbr_match_id_find(&cfg->match_ids, &ref);
 }
 
 struct bgp_pbr_match_entry *bgp_pbr_match_ipset_entry_lookup(vrf_id_t vrf_id,
 						       char *ipset_name,
 						       uint32_t unique)
 {
-	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_entry_unique bpmeu;
-	struct bgp_pbr_match_ipsetname bpmi;
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	struct bgp_pbr_match_entry ref = { .unique = unique };
+	struct bgp_pbr_match_entry *bpme;
 
-	if (!bgp || unique == 0)
+	if (!cfg || unique == 0)
 		return NULL;
-	bpmi.ipsetname = XCALLOC(MTYPE_TMP, ZEBRA_IPSET_NAME_SIZE);
-	snprintf(bpmi.ipsetname, ZEBRA_IPSET_NAME_SIZE, "%s", ipset_name);
-	bpmi.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_pername_walkcb, &bpmi);
-	XFREE(MTYPE_TMP, bpmi.ipsetname);
-	if (!bpmi.bpm_found)
+	bpme = bgp_pbr_entry_id_find(&cfg->entry_ids, &ref);
+	if (!bpme || !bpme->backpointer
+	    || strncmp(ipset_name, bpme->backpointer->ipset_name,
+		       ZEBRA_IPSET_NAME_SIZE))
 		return NULL;
-	bpmeu.bpme_found = NULL;
-	bpmeu.unique = unique;
-	hash_walk(bpmi.bpm_found->entry_hash,
-		  bgp_pbr_match_entry_walkcb, &bpmeu);
-	return bpmeu.bpme_found;
+	return bpme;
 }
 
 struct bgp_pbr_match *bgp_pbr_match_iptable_lookup(vrf_id_t vrf_id,
 						   uint32_t unique)
 {
-	struct bgp *bgp = bgp_lookup_by_vrf_id(vrf_id);
-	struct bgp_pbr_match_iptable_unique bpmiu;
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	struct bgp_pbr_match ref = { .unique2 = unique };
 
-	if (!bgp || unique == 0)
+	if (!cfg || unique == 0)
 		return NULL;
-	bpmiu.unique = unique;
-	bpmiu.bpm_found = NULL;
-	hash_walk(bgp->pbr_match_hash, bgp_pbr_match_iptable_walkcb, &bpmiu);
-	return bpmiu.bpm_found;
+	return bgp_pbr_iptable_id_find(&cfg->iptable_ids, &ref);
+}
+
+void bgp_pbr_install_done(vrf_id_t vrf_id, struct timeval *install_time)
+{
+	struct bgp_pbr_config *cfg = bgp_pbr_config_lookup(vrf_id);
+	uint64_t usec;
+
+	if (!cfg || !timerisset(install_time))
+		return;
+
+	usec = monotime_since(install_time, NULL);
+	timerclear(install_time);
+
+	cfg->install_count++;
+	cfg->install_usec_total += usec;
+	if (usec > cfg->install_usec_max)
+		cfg->install_usec_max = usec;
+}
+
+void bgp_pbr_show_statistics(struct vty *vty, struct bgp *bgp)
+{
+	struct bgp_pbr_config *cfg = bgp->bgp_pbr_cfg;
+
+	if (!cfg)
+		return;
+
+	vty_out(vty, "Actions: %lu\n", hashcount(bgp->pbr_action_hash));
+	vty_out(vty, "IP rules: %lu\n", hashcount(bgp->pbr_rule_hash));
+	vty_out(vty, "Match sets: %lu, with %zu entries\n",
+		hashcount(bgp->pbr_match_hash),
+		bgp_pbr_entry_id_count(&cfg->entry_ids));
+	vty_out(vty, "Installed: %" PRIu64 "\n", cfg->install_count);
+	if (cfg->install_count)
+		vty_out(vty,
+			"Install latency: %" PRIu64 " usec average, %" PRIu64
+			" usec max\n",
+			cfg->install_usec_total / cfg->install_count,
+			cfg->install_usec_max);
 }
 
 void bgp_pbr_cleanup(struct bgp *bgp)
 {
+	struct bgp_pbr_config *cfg = bgp->bgp_pbr_cfg;
+
+	/* the objects are freed below */
+	if (cfg) {
+		while (bgp_pbr_rule_id_pop(&cfg->rule_ids))
+			;
+		while (bgp_pbr_match_id_pop(&cfg->match_ids))
+			;
+		while (bgp_pbr_iptable_id_pop(&cfg->iptable_ids))
+			;
+		while (bgp_pbr_entry_id_pop(&cfg->entry_ids))
+			;
+		while (bgp_pbr_action_id_pop(&cfg->action_ids))
+			;
+	}
+
 	if (bgp->pbr_match_hash) {
 		hash_clean(bgp->pbr_match_hash, bgp_pbr_match_free);
 		hash_free(bgp->pbr_match_hash);
@@ -1418,6 +1415,11 @@ void bgp_pbr_cleanup(struct bgp *bgp)
 		return;
 	bgp_pbr_reset(bgp, AFI_IP);
 	bgp_pbr_reset(bgp, AFI_IP6);
+	bgp_pbr_rule_id_fini(&cfg->rule_ids);
+	bgp_pbr_match_id_fini(&cfg->match_ids);
+	bgp_pbr_iptable_id_fini(&cfg->iptable_ids);
+	bgp_pbr_entry_id_fini(&cfg->entry_ids);
+	bgp_pbr_action_id_fini(&cfg->action_ids);
 	XFREE(MTYPE_PBR, bgp->bgp_pbr_cfg);
 }
 
@@ -1439,6 +1441,11 @@ void bgp_pbr_init(struct bgp *bgp)
 
 	bgp->bgp_pbr_cfg = XCALLOC(MTYPE_PBR, sizeof(struct bgp_pbr_config));
 	bgp->bgp_pbr_cfg->pbr_interface_any_ipv4 = true;
+	bgp_pbr_rule_id_init(&bgp->bgp_pbr_cfg->rule_ids);
+	bgp_pbr_match_id_init(&bgp->bgp_pbr_cfg->match_ids);
+	bgp_pbr_iptable_id_init(&bgp->bgp_pbr_cfg->iptable_ids);
+	bgp_pbr_entry_id_init(&bgp->bgp_pbr_cfg->entry_ids);
+	bgp_pbr_action_id_init(&bgp->bgp_pbr_cfg->action_ids);
 }
 
 void bgp_pbr_print_policy_route(struct bgp_pbr_entry_main *api)
@@ -1696,6 +1703,7 @@ static void bgp_pbr_flush_iprule(struct bgp *bgp, struct bgp_pbr_action *bpa,
 		}
 	}
 	hash_release(bgp->pbr_rule_hash, bpr);
+	bgp_pbr_rule_id_del(&bgp->bgp_pbr_cfg->rule_ids, bpr);
 	bgp_pbr_bpa_remove(bpa);
 }
 
@@ -1725,6 +1733,7 @@ static void bgp_pbr_flush_entry(struct bgp *bgp, struct bgp_pbr_action *bpa,
 		}
 	}
 	hash_release(bpm->entry_hash, bpme);
+	bgp_pbr_entry_id_del(&bgp->bgp_pbr_cfg->entry_ids, bpme);
 	if (hashcount(bpm->entry_hash) == 0) {
 		/* delete iptable entry first */
 		/* then delete ipset match */
@@ -1740,6 +1749,8 @@ static void bgp_pbr_flush_entry(struct bgp *bgp, struct bgp_pbr_action *bpa,
 			bpm->action = NULL;
 		}
 		hash_release(bgp->pbr_match_hash, bpm);
+		bgp_pbr_match_id_del(&bgp->bgp_pbr_cfg->match_ids, bpm);
+		bgp_pbr_iptable_id_del(&bgp->bgp_pbr_cfg->iptable_ids, bpm);
 		/* XXX release pbr_match_action if not used
 		 * note that drop does not need to call send_pbr_action
 		 */
@@ -2336,6 +2347,7 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 		bpa->unique = ++bgp_pbr_action_counter_unique;
 		/* 0 value is forbidden */
 		bpa->install_in_progress = false;
+		bgp_pbr_action_id_add(&bgp->bgp_pbr_cfg->action_ids, bpa);
 	}
 	if (bpf->type == BGP_PBR_IPRULE) {
 		memset(&pbr_rule, 0, sizeof(pbr_rule));
@@ -2354,6 +2366,7 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 			       bgp_pbr_rule_alloc_intern);
 		if (bpr->unique == 0) {
 			bpr->unique = ++bgp_pbr_action_counter_unique;
+			bgp_pbr_rule_id_add(&bgp->bgp_pbr_cfg->rule_ids, bpr);
 			bpr->installed = false;
 			bpr->install_in_progress = false;
 			/* link bgp info to bpr */
@@ -2487,6 +2500,8 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 
 		/* unique2 should be updated too */
 		bpm->unique2 = ++bgp_pbr_match_iptable_counter_unique;
+		bgp_pbr_match_id_add(&bgp->bgp_pbr_cfg->match_ids, bpm);
+		bgp_pbr_iptable_id_add(&bgp->bgp_pbr_cfg->iptable_ids, bpm);
 		bpm->installed_in_iptable = false;
 		bpm->install_in_progress = false;
 		bpm->install_iptable_in_progress = false;
@@ -2511,6 +2526,7 @@ static void bgp_pbr_policyroute_add_to_zebra_unit(struct bgp *bgp,
 	if (bpme->unique == 0) {
 		bpme->unique = ++bgp_pbr_match_entry_counter_unique;
 		/* 0 value is forbidden */
+		bgp_pbr_entry_id_add(&bgp->bgp_pbr_cfg->entry_ids, bpme);
 		bpme->backpointer = bpm;
 		bpme->installed = false;
 		bpme->install_in_progress = false;
@@ -21,6 +21,7 @@
 
 #include "nexthop.h"
 #include "zclient.h"
+#include "typesafe.h"
 
 /* flowspec case: 0 to 3 actions maximum:
  * 1 redirect
@@ -157,16 +158,38 @@ RB_PROTOTYPE(bgp_pbr_interface_head, bgp_pbr_interface, id_entry,
 extern int bgp_pbr_interface_compare(const struct bgp_pbr_interface *a,
 				     const struct bgp_pbr_interface *b);
 
+/* zebra notifications refer to the objects below by their unique ID */
+PREDECL_HASH(bgp_pbr_rule_id);
+PREDECL_HASH(bgp_pbr_match_id);
+PREDECL_HASH(bgp_pbr_iptable_id);
+PREDECL_HASH(bgp_pbr_entry_id);
+PREDECL_HASH(bgp_pbr_action_id);
+
 struct bgp_pbr_config {
 	struct bgp_pbr_interface_head ifaces_by_name_ipv4;
 	bool pbr_interface_any_ipv4;
 	struct bgp_pbr_interface_head ifaces_by_name_ipv6;
 	bool pbr_interface_any_ipv6;
+
+	struct bgp_pbr_rule_id_head rule_ids;
+	struct bgp_pbr_match_id_head match_ids;
+	struct bgp_pbr_iptable_id_head iptable_ids;
+	struct bgp_pbr_entry_id_head entry_ids;
+	struct bgp_pbr_action_id_head action_ids;
+
+	/* time from sending an ipset entry or ip rule to zebra until it
+	 * reports the entry installed
+	 */
+	uint64_t install_count;
+	uint64_t install_usec_total;
+	uint64_t install_usec_max;
 };
 
 extern struct bgp_pbr_config *bgp_pbr_cfg;
 
 struct bgp_pbr_rule {
+	struct bgp_pbr_rule_id_item id_item;
+
 	uint32_t flags;
 	struct prefix src;
 	struct prefix dst;
@@ -176,10 +199,14 @@ struct bgp_pbr_rule {
 	uint32_t priority;
 	bool installed;
 	bool install_in_progress;
+	struct timeval install_time;
 	void *path;
 };
 
 struct bgp_pbr_match {
+	struct bgp_pbr_match_id_item id_item;
+	struct bgp_pbr_iptable_id_item iptable_id_item;
+
 	char ipset_name[ZEBRA_IPSET_NAME_SIZE];
 
 	/* mapped on enum ipset_type
@@ -221,6 +248,8 @@ struct bgp_pbr_match {
 };
 
 struct bgp_pbr_match_entry {
+	struct bgp_pbr_entry_id_item id_item;
+
 	struct bgp_pbr_match *backpointer;
 
 	uint32_t unique;
@@ -238,9 +267,11 @@ struct bgp_pbr_match_entry {
 
 	bool installed;
 	bool install_in_progress;
+	struct timeval install_time;
 };
 
 struct bgp_pbr_action {
+	struct bgp_pbr_action_id_item id_item;
 
 	/*
 	 * The Unique identifier of this specific pbrms
@@ -282,6 +313,12 @@ extern struct bgp_pbr_match_entry *bgp_pbr_match_ipset_entry_lookup(
 extern struct bgp_pbr_match *bgp_pbr_match_iptable_lookup(vrf_id_t vrf_id,
 							  uint32_t unique);
 
+/* An ipset entry or ip rule sent by bgp_send_pbr_*() has been installed */
+extern void bgp_pbr_install_done(vrf_id_t vrf_id,
+				 struct timeval *install_time);
+
+extern void bgp_pbr_show_statistics(struct vty *vty, struct bgp *bgp);
+
 extern void bgp_pbr_cleanup(struct bgp *bgp);
 extern void bgp_pbr_init(struct bgp *bgp);
 
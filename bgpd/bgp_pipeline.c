@@ -0,0 +1,339 @@
+/*
+ * BGP pipeline latency statistics
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "json.h"
+#include "linklist.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_pipeline.h"
+#include "bgpd/bgp_vty.h"
+#include "bgpd/bgp_trace.h"
+
+#include "bgpd/bgp_pipeline_clippy.c"
+
+static const char *const bgp_pipeline_stage_names[BGP_PIPELINE_STAGE_MAX] = {
+	[BGP_PIPELINE_READ] = "read",
+	[BGP_PIPELINE_PARSE] = "parse",
+	[BGP_PIPELINE_PROCESS] = "process",
+	[BGP_PIPELINE_ZEBRA] = "zebra",
+	[BGP_PIPELINE_UPDATE] = "update",
+	[BGP_PIPELINE_WRITE] = "write",
+};
+
+void bgp_pipeline_record(struct bgp_pipeline *pl, const char *name,
+			 afi_t afi, enum bgp_pipeline_stage stage,
+			 int64_t start)
+{
+	struct bgp_pipeline_hist *h = &pl->hist[afi][stage];
+	int64_t elapsed = bgp_pipeline_now() - start;
+	uint64_t usec = elapsed > 0 ? elapsed : 0;
+	uint64_t max;
+	unsigned int bucket = 0;
+
+	while (bucket < BGP_PIPELINE_BUCKETS - 1 && usec >= (1ULL << bucket))
+		bucket++;
+
+	atomic_fetch_add_explicit(&h->count, 1, memory_order_relaxed);
+	atomic_fetch_add_explicit(&h->sum_usec, usec, memory_order_relaxed);
+	atomic_fetch_add_explicit(&h->buckets[bucket], 1,
+				  memory_order_relaxed);
+
+	max = atomic_load_explicit(&h->max_usec, memory_order_relaxed);
+	while (usec > max
+	       && !atomic_compare_exchange_weak_explicit(
+		       &h->max_usec, &max, usec, memory_order_relaxed,
+		       memory_order_relaxed))
+		;
+
+	frrtrace(4, frr_bgp, pipeline_stage, name, afi, stage, usec);
+}
+
+void bgp_pipeline_clear(struct bgp_pipeline *pl)
+{
+	struct bgp_pipeline_hist *h;
+	unsigned int i, j, b;
+
+	for (i = 0; i < AFI_MAX; i++)
+		for (j = 0; j < BGP_PIPELINE_STAGE_MAX; j++) {
+			h = &pl->hist[i][j];
+			atomic_store_explicit(&h->count, 0,
+					      memory_order_relaxed);
+			atomic_store_explicit(&h->sum_usec, 0,
+					      memory_order_relaxed);
+			atomic_store_explicit(&h->max_usec, 0,
+					      memory_order_relaxed);
+			for (b = 0; b < BGP_PIPELINE_BUCKETS; b++)
+				atomic_store_explicit(&h->buckets[b], 0,
+						      memory_order_relaxed);
+		}
+}
+
+/* Snapshot of a histogram, for consistent output */
+struct bgp_pipeline_snap {
+	uint64_t count;
+	uint64_t sum_usec;
+	uint64_t max_usec;
+	uint32_t buckets[BGP_PIPELINE_BUCKETS];
+};
+
+static bool bgp_pipeline_snap(const struct bgp_pipeline_hist *h,
+			      struct bgp_pipeline_snap *snap)
+{
+	unsigned int b;
+
+	snap->count = atomic_load_explicit(&h->count, memory_order_relaxed);
+	if (!snap->count)
+		return false;
+
+	snap->sum_usec = atomic_load_explicit(&h->sum_usec,
+					      memory_order_relaxed);
+	snap->max_usec = atomic_load_explicit(&h->max_usec,
+					      memory_order_relaxed);
+	for (b = 0; b < BGP_PIPELINE_BUCKETS; b++)
+		snap->buckets[b] = atomic_load_explicit(&h->buckets[b],
+							memory_order_relaxed);
+	return true;
+}
+
+/* Upper bound of the bucket holding the given percentile */
+static uint64_t bgp_pipeline_pct(const struct bgp_pipeline_snap *snap,
+				 unsigned int pct)
+{
+	uint64_t total = 0, seen = 0, want;
+	unsigned int b;
+
+	for (b = 0; b < BGP_PIPELINE_BUCKETS; b++)
+		total += snap->buckets[b];
+	want = (total * pct + 99) / 100;
+
+	for (b = 0; b < BGP_PIPELINE_BUCKETS - 1; b++) {
+		seen += snap->buckets[b];
+		if (seen >= want && seen)
+			return MIN(1ULL << b, snap->max_usec);
+	}
+	return snap->max_usec;
+}
+
+static const char *bgp_pipeline_afi_name(afi_t afi)
+{
+	return afi == AFI_UNSPEC ? "all" : afi2str(afi);
+}
+
+static void bgp_pipeline_show_one(struct vty *vty, struct bgp_pipeline *pl)
+{
+	struct bgp_pipeline_snap snap;
+	unsigned int stage;
+	afi_t afi;
+
+	for (stage = 0; stage < BGP_PIPELINE_STAGE_MAX; stage++)
+		for (afi = AFI_UNSPEC; afi < AFI_MAX; afi++) {
+			if (!bgp_pipeline_snap(&pl->hist[afi][stage], &snap))
+				continue;
+
+			vty_out(vty,
+				"  %-8s %-6s %10" PRIu64 " %9" PRIu64
+				" %9" PRIu64 " %9" PRIu64 " %9" PRIu64
+				" %9" PRIu64 "\n",
+				bgp_pipeline_stage_names[stage],
+				bgp_pipeline_afi_name(afi), snap.count,
+				snap.sum_usec / snap.count,
+				bgp_pipeline_pct(&snap, 50),
+				bgp_pipeline_pct(&snap, 90),
+				bgp_pipeline_pct(&snap, 99), snap.max_usec);
+		}
+}
+
+static json_object *bgp_pipeline_json(struct bgp_pipeline *pl)
+{
+	struct bgp_pipeline_snap snap;
+	json_object *json, *json_stage, *json_afi, *json_buckets;
+	unsigned int stage, b;
+	char key[16];
+	afi_t afi;
+
+	json = json_object_new_object();
+	for (stage = 0; stage < BGP_PIPELINE_STAGE_MAX; stage++) {
+		json_stage = NULL;
+		for (afi = AFI_UNSPEC; afi < AFI_MAX; afi++) {
+			if (!bgp_pipeline_snap(&pl->hist[afi][stage], &snap))
+				continue;
+
+			json_afi = json_object_new_object();
+			json_object_int_add(json_afi, "count", snap.count);
+			json_object_int_add(json_afi, "avgUsec",
+					    snap.sum_usec / snap.count);
+			json_object_int_add(json_afi, "p50Usec",
+					    bgp_pipeline_pct(&snap, 50));
+			json_object_int_add(json_afi, "p90Usec",
+					    bgp_pipeline_pct(&snap, 90));
+			json_object_int_add(json_afi, "p99Usec",
+					    bgp_pipeline_pct(&snap, 99));
+			json_object_int_add(json_afi, "maxUsec",
+					    snap.max_usec);
+
+			/* keyed by upper bound in usec, "inf" for the last */
+			json_buckets = json_object_new_object();
+			for (b = 0; b < BGP_PIPELINE_BUCKETS; b++) {
+				if (!snap.buckets[b])
+					continue;
+				if (b == BGP_PIPELINE_BUCKETS - 1)
+					strlcpy(key, "inf", sizeof(key));
+				else
+					snprintf(key, sizeof(key), "%llu",
+						 1ULL << b);
+				json_object_int_add(json_buckets, key,
+						    snap.buckets[b]);
+			}
+			json_object_object_add(json_afi, "buckets",
+					       json_buckets);
+
+			if (!json_stage)
+				json_stage = json_object_new_object();
+			json_object_object_add(json_stage,
+					       bgp_pipeline_afi_name(afi),
+					       json_afi);
+		}
+		if (json_stage)
+			json_object_object_add(
+				json, bgp_pipeline_stage_names[stage],
+				json_stage);
+	}
+
+	return json;
+}
+
+static void bgp_pipeline_show_header(struct vty *vty)
+{
+	vty_out(vty, "  %-8s %-6s %10s %9s %9s %9s %9s %9s\n", "Stage", "AFI",
+		"Count", "Avg(us)", "p50", "p90", "p99", "Max(us)");
+}
+
+static bool bgp_pipeline_peer_match(const struct peer *peer, const char *nbr)
+{
+	if (!nbr)
+		return true;
+	if (peer->conf_if && strmatch(peer->conf_if, nbr))
+		return true;
+	return strmatch(peer->host, nbr);
+}
+
+static struct bgp *bgp_pipeline_instance(struct vty *vty, const char *name)
+{
+	struct bgp *bgp;
+
+	if (!name || strmatch(name, VRF_DEFAULT_NAME))
+		bgp = bgp_get_default();
+	else
+		bgp = bgp_lookup_by_name(name);
+
+	if (!bgp)
+		vty_out(vty, "%% BGP instance not found\n");
+	return bgp;
+}
+
+DEFPY(show_bgp_pipeline, show_bgp_pipeline_cmd,
+      "show bgp [<view|vrf> VIEWVRFNAME$vrf_name] pipeline-statistics [neighbor <A.B.C.D|X:X::X:X|WORD>$nbr] [json$uj]",
+      SHOW_STR BGP_STR BGP_INSTANCE_HELP_STR
+      "Latency of the stages BGP routes pass through\n"
+      "Only for one neighbor\n"
+      "Neighbor to display information about\n"
+      "Neighbor to display information about\n"
+      "Neighbor on BGP configured interface\n"
+      JSON_STR)
+{
+	json_object *json = NULL, *json_peers = NULL;
+	struct listnode *node;
+	struct peer *peer;
+	struct bgp *bgp;
+
+	bgp = bgp_pipeline_instance(vty, vrf_name);
+	if (!bgp)
+		return CMD_WARNING;
+
+	if (uj) {
+		json = json_object_new_object();
+		if (!nbr)
+			json_object_object_add(
+				json, "instance",
+				bgp_pipeline_json(&bgp->pipeline));
+		json_peers = json_object_new_object();
+		json_object_object_add(json, "neighbors", json_peers);
+	} else if (!nbr) {
+		vty_out(vty, "Instance %s:\n", bgp->name_pretty);
+		bgp_pipeline_show_header(vty);
+		bgp_pipeline_show_one(vty, &bgp->pipeline);
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE)
+		    && !peer_dynamic_neighbor(peer))
+			continue;
+		if (!bgp_pipeline_peer_match(peer, nbr))
+			continue;
+
+		if (uj) {
+			json_object_object_add(
+				json_peers,
+				peer->conf_if ? peer->conf_if : peer->host,
+				bgp_pipeline_json(&peer->pipeline));
+			continue;
+		}
+
+		vty_out(vty, "\nNeighbor %s:\n",
+			peer->conf_if ? peer->conf_if : peer->host);
+		bgp_pipeline_show_header(vty);
+		bgp_pipeline_show_one(vty, &peer->pipeline);
+	}
+
+	if (uj)
+		return vty_json(vty, json);
+	return CMD_SUCCESS;
+}
+
+DEFPY(clear_bgp_pipeline, clear_bgp_pipeline_cmd,
+      "clear bgp [<view|vrf> VIEWVRFNAME$vrf_name] pipeline-statistics",
+      CLEAR_STR BGP_STR BGP_INSTANCE_HELP_STR
+      "Latency of the stages BGP routes pass through\n")
+{
+	struct listnode *node;
+	struct peer *peer;
+	struct bgp *bgp;
+
+	bgp = bgp_pipeline_instance(vty, vrf_name);
+	if (!bgp)
+		return CMD_WARNING;
+
+	bgp_pipeline_clear(&bgp->pipeline);
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer))
+		bgp_pipeline_clear(&peer->pipeline);
+
+	return CMD_SUCCESS;
+}
+
+void bgp_pipeline_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_bgp_pipeline_cmd);
+	install_element(ENABLE_NODE, &clear_bgp_pipeline_cmd);
+}
@@ -0,0 +1,84 @@
+/*
+ * BGP pipeline latency statistics
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_BGP_PIPELINE_H
+#define _FRR_BGP_PIPELINE_H
+
+#include "frratomic.h"
+#include "monotime.h"
+
+/*
+ * Stages a route goes through, from the packet being read to the UPDATE
+ * being written.  Read, parse and write are per peer only and kept under
+ * AFI_UNSPEC, update is per peer and AFI, process and zebra are per
+ * instance and AFI.
+ */
+enum bgp_pipeline_stage {
+	/* oldest packet waiting in peer->ibuf, read by the I/O pthread */
+	BGP_PIPELINE_READ,
+	/* bgp_process_packet() of one message */
+	BGP_PIPELINE_PARSE,
+	/* oldest prefix waiting in the process work queue to best path */
+	BGP_PIPELINE_PROCESS,
+	/* encoding a route for zebra */
+	BGP_PIPELINE_ZEBRA,
+	/* subgroup packet generation for a peer */
+	BGP_PIPELINE_UPDATE,
+	/* oldest packet waiting in peer->obuf until written */
+	BGP_PIPELINE_WRITE,
+	BGP_PIPELINE_STAGE_MAX,
+};
+
+/* Bucket i counts samples below 2^i usec, the last one everything else */
+#define BGP_PIPELINE_BUCKETS 24
+
+struct bgp_pipeline_hist {
+	_Atomic uint64_t count;
+	_Atomic uint64_t sum_usec;
+	_Atomic uint64_t max_usec;
+	_Atomic uint32_t buckets[BGP_PIPELINE_BUCKETS];
+};
+
+struct bgp_pipeline {
+	struct bgp_pipeline_hist hist[AFI_MAX][BGP_PIPELINE_STAGE_MAX];
+};
+
+static inline int64_t bgp_pipeline_now(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+/*
+ * Add a sample of the time since `start` (bgp_pipeline_now()) and hit the
+ * pipeline_stage tracepoint.  `name` identifies the peer or instance in the
+ * trace.  Safe to call from any pthread.
+ */
+extern void bgp_pipeline_record(struct bgp_pipeline *pl, const char *name,
+				afi_t afi, enum bgp_pipeline_stage stage,
+				int64_t start);
+extern void bgp_pipeline_clear(struct bgp_pipeline *pl);
+
+extern void bgp_pipeline_vty_init(void);
+
+#endif /* _FRR_BGP_PIPELINE_H */
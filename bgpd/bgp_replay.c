@@ -0,0 +1,979 @@
+/*
+ * BGP table replay peer emulator
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * bgp_replay brings up a number of emulated eBGP sessions towards a router
+ * under test, replays a routing table on each of them and reports how long
+ * it took until all sessions were up, until the table was sent and until
+ * the router sent its last UPDATE, i.e. converged.
+ *
+ * The table is read from the IPv4 unicast RIB entries of an MRT
+ * TABLE_DUMP_V2 file, or generated.  It is encoded into UPDATEs once; only
+ * the AS and the address of a session are patched in while writing them
+ * out.  Every session binds to its own local address, which on Linux can
+ * simply be taken out of 127.0.0.0/8.
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "stream.h"
+#include "sockunion.h"
+#include "network.h"
+#include "memory.h"
+#include "monotime.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_dump.h"
+#include "bgpd/bgp_open.h"
+
+#define MRT_TABLE_DUMP_V2 13
+
+#define REPLAY_BUFSIZE 65536
+
+static struct thread_master *master;
+
+/* Configuration */
+static union sockunion remote;
+static unsigned short remote_port = BGP_PORT_DEFAULT;
+static union sockunion local_base;
+static unsigned int session_count = 1;
+static as_t as_base = 65001;
+static bool as_increment;
+static uint16_t holdtime = BGP_DEFAULT_HOLDTIME;
+static unsigned int connect_rate = 100;
+static unsigned int quiet_time = 5;
+
+/* UPDATE templates, back to back in `table` */
+struct replay_msg {
+	size_t offset;
+	uint16_t length;
+
+	/* where the session's AS and NEXT_HOP go */
+	uint16_t as_pos;
+	uint16_t nh_pos;
+};
+
+static uint8_t *table;
+static size_t table_len, table_alloc;
+static struct replay_msg *msgs;
+static size_t msg_count, msg_alloc;
+static bool msg_open;
+static uint64_t table_prefixes;
+
+/* attributes of the open message, to pack routes sharing them */
+static uint8_t last_attrs[BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE];
+static size_t last_attrs_len;
+
+enum replay_state {
+	RS_IDLE,
+	RS_CONNECT,
+	RS_OPENSENT,
+	RS_OPENCONFIRM,
+	RS_ESTABLISHED,
+	RS_CLOSED,
+};
+
+struct replay_session {
+	unsigned int idx;
+	union sockunion su;
+	as_t as;
+	int fd;
+	enum replay_state state;
+
+	struct stream *ibuf;
+	struct stream *obuf;
+
+	/* next template to send */
+	size_t next_msg;
+	bool eor_sent;
+
+	uint16_t holdtime;
+
+	struct thread *t_read;
+	struct thread *t_write;
+	struct thread *t_keepalive;
+
+	struct timeval t_established;
+	struct timeval t_sent;
+	uint64_t updates_rcvd;
+};
+
+static struct replay_session *sessions;
+static unsigned int sessions_started, sessions_established;
+
+static struct timeval t_start, t_all_established, t_last_rcvd;
+static uint64_t updates_rcvd;
+static bool done;
+
+static struct thread *t_connect, *t_status;
+
+/*
+ * Table
+ */
+static void table_reserve(size_t len)
+{
+	if (table_len + len <= table_alloc)
+		return;
+
+	while (table_len + len > table_alloc)
+		table_alloc = table_alloc ? table_alloc * 2 : 1 << 20;
+	table = XREALLOC(MTYPE_TMP, table, table_alloc);
+}
+
+static void table_msg_finish(void)
+{
+	struct replay_msg *msg = &msgs[msg_count - 1];
+
+	if (!msg_open)
+		return;
+
+	table[msg->offset + BGP_MARKER_SIZE] = msg->length >> 8;
+	table[msg->offset + BGP_MARKER_SIZE + 1] = msg->length & 0xff;
+	msg_open = false;
+}
+
+static void table_msg_new(const uint8_t *attrs, size_t attrs_len,
+			  size_t as_pos, size_t nh_pos)
+{
+	struct replay_msg *msg;
+	uint8_t *p;
+
+	table_msg_finish();
+
+	if (msg_count == msg_alloc) {
+		msg_alloc = msg_alloc ? msg_alloc * 2 : 1024;
+		msgs = XREALLOC(MTYPE_TMP, msgs, msg_alloc * sizeof(*msgs));
+	}
+	msg = &msgs[msg_count++];
+
+	table_reserve(BGP_MSG_UPDATE_MIN_SIZE + attrs_len);
+	p = table + table_len;
+	memset(p, 0xff, BGP_MARKER_SIZE);
+	p[BGP_MARKER_SIZE + 2] = BGP_MSG_UPDATE;
+	/* no withdrawn routes */
+	p[BGP_HEADER_SIZE] = 0;
+	p[BGP_HEADER_SIZE + 1] = 0;
+	p[BGP_HEADER_SIZE + 2] = attrs_len >> 8;
+	p[BGP_HEADER_SIZE + 3] = attrs_len & 0xff;
+	memcpy(p + BGP_MSG_UPDATE_MIN_SIZE, attrs, attrs_len);
+
+	msg->offset = table_len;
+	msg->length = BGP_MSG_UPDATE_MIN_SIZE + attrs_len;
+	msg->as_pos = BGP_MSG_UPDATE_MIN_SIZE + as_pos;
+	msg->nh_pos = BGP_MSG_UPDATE_MIN_SIZE + nh_pos;
+	table_len += msg->length;
+	msg_open = true;
+
+	memcpy(last_attrs, attrs, attrs_len);
+	last_attrs_len = attrs_len;
+}
+
+/* Add one prefix (length byte + prefix bytes) announced with `attrs` */
+static void table_add_route(const uint8_t *nlri, size_t nlri_len,
+			    const uint8_t *attrs, size_t attrs_len,
+			    size_t as_pos, size_t nh_pos)
+{
+	struct replay_msg *msg = msg_open ? &msgs[msg_count - 1] : NULL;
+
+	if (!msg || attrs_len != last_attrs_len
+	    || memcmp(attrs, last_attrs, attrs_len)
+	    || msg->length + nlri_len > BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE)
+		table_msg_new(attrs, attrs_len, as_pos, nh_pos);
+
+	msg = &msgs[msg_count - 1];
+	table_reserve(nlri_len);
+	memcpy(table + table_len, nlri, nlri_len);
+	table_len += nlri_len;
+	msg->length += nlri_len;
+	table_prefixes++;
+}
+
+static size_t attr_put_hdr(uint8_t *out, uint8_t flags, uint8_t type,
+			   size_t len)
+{
+	if (len > 255) {
+		out[0] = flags | BGP_ATTR_FLAG_EXTLEN;
+		out[1] = type;
+		out[2] = len >> 8;
+		out[3] = len & 0xff;
+		return 4;
+	}
+	out[0] = flags & ~BGP_ATTR_FLAG_EXTLEN;
+	out[1] = type;
+	out[2] = len;
+	return 3;
+}
+
+/*
+ * Turn the attributes of a RIB entry (4 octet AS_PATH) into the ones sent
+ * by an emulated eBGP peer: the peer's AS is prepended, NEXT_HOP is set to
+ * the peer's address and attributes an eBGP peer wouldn't send are dropped.
+ */
+static ssize_t attrs_rewrite(const uint8_t *in, size_t in_len, uint8_t *out,
+			     size_t *as_pos, size_t *nh_pos)
+{
+	size_t off = 0, olen = 0, len, hdr;
+	bool have_origin = false, have_aspath = false;
+	uint8_t flags, type;
+	const uint8_t *val;
+
+	while (off < in_len) {
+		if (off + 3 > in_len)
+			return -1;
+		flags = in[off];
+		type = in[off + 1];
+		if (flags & BGP_ATTR_FLAG_EXTLEN) {
+			if (off + 4 > in_len)
+				return -1;
+			len = (in[off + 2] << 8) | in[off + 3];
+			hdr = 4;
+		} else {
+			len = in[off + 2];
+			hdr = 3;
+		}
+		if (off + hdr + len > in_len)
+			return -1;
+		val = in + off + hdr;
+		off += hdr + len;
+
+		/* leave room for AS_PATH, NEXT_HOP and ORIGIN we may add */
+		if (olen + hdr + len + 24 > sizeof(last_attrs) - 512)
+			return -1;
+
+		switch (type) {
+		case BGP_ATTR_ORIGIN:
+			have_origin = true;
+			/* fallthrough */
+		case BGP_ATTR_MULTI_EXIT_DISC:
+		case BGP_ATTR_ATOMIC_AGGREGATE:
+		case BGP_ATTR_AGGREGATOR:
+		case BGP_ATTR_COMMUNITIES:
+		case BGP_ATTR_EXT_COMMUNITIES:
+		case BGP_ATTR_LARGE_COMMUNITIES:
+			olen += attr_put_hdr(out + olen, flags, type, len);
+			memcpy(out + olen, val, len);
+			olen += len;
+			break;
+		case BGP_ATTR_AS_PATH:
+			have_aspath = true;
+			olen += attr_put_hdr(out + olen, BGP_ATTR_FLAG_TRANS,
+					     type, len + 6);
+			out[olen++] = AS_SEQUENCE;
+			out[olen++] = 1;
+			*as_pos = olen;
+			olen += 4;
+			memcpy(out + olen, val, len);
+			olen += len;
+			break;
+		default:
+			break;
+		}
+	}
+
+	if (!have_origin) {
+		olen += attr_put_hdr(out + olen, BGP_ATTR_FLAG_TRANS,
+				     BGP_ATTR_ORIGIN, 1);
+		out[olen++] = BGP_ORIGIN_INCOMPLETE;
+	}
+	if (!have_aspath) {
+		olen += attr_put_hdr(out + olen, BGP_ATTR_FLAG_TRANS,
+				     BGP_ATTR_AS_PATH, 6);
+		out[olen++] = AS_SEQUENCE;
+		out[olen++] = 1;
+		*as_pos = olen;
+		olen += 4;
+	}
+	olen += attr_put_hdr(out + olen, BGP_ATTR_FLAG_TRANS,
+			     BGP_ATTR_NEXT_HOP, 4);
+	*nh_pos = olen;
+	olen += 4;
+
+	return olen;
+}
+
+static void table_add_entry(const uint8_t *nlri, size_t nlri_len,
+			    const uint8_t *attrs, size_t attrs_len)
+{
+	uint8_t out[sizeof(last_attrs)];
+	size_t as_pos = 0, nh_pos = 0;
+	ssize_t olen;
+
+	olen = attrs_rewrite(attrs, attrs_len, out, &as_pos, &nh_pos);
+	if (olen < 0)
+		return;
+
+	table_add_route(nlri, nlri_len, out, olen, as_pos, nh_pos);
+}
+
+static int table_load_mrt(const char *path, int peer_index)
+{
+	const uint8_t *p, *end, *attrs;
+	size_t len, off = 0, mlen, plen, alen;
+	uint16_t type, subtype, count, idx;
+	struct stat st;
+	uint8_t *buf;
+	FILE *f;
+
+	f = fopen(path, "r");
+	if (!f || fstat(fileno(f), &st) < 0) {
+		fprintf(stderr, "%s: %s\n", path, safe_strerror(errno));
+		if (f)
+			fclose(f);
+		return -1;
+	}
+
+	len = st.st_size;
+	buf = XMALLOC(MTYPE_TMP, len ? len : 1);
+	if (fread(buf, 1, len, f) != len) {
+		fprintf(stderr, "%s: short read\n", path);
+		fclose(f);
+		XFREE(MTYPE_TMP, buf);
+		return -1;
+	}
+	fclose(f);
+
+	while (off + BGP_DUMP_HEADER_SIZE <= len) {
+		type = (buf[off + 4] << 8) | buf[off + 5];
+		subtype = (buf[off + 6] << 8) | buf[off + 7];
+		mlen = ((uint32_t)buf[off + 8] << 24) | (buf[off + 9] << 16)
+		       | (buf[off + 10] << 8) | buf[off + 11];
+		if (mlen > len - off - BGP_DUMP_HEADER_SIZE)
+			break;
+		p = buf + off + BGP_DUMP_HEADER_SIZE;
+		end = p + mlen;
+		off += BGP_DUMP_HEADER_SIZE + mlen;
+
+		if (type != MRT_TABLE_DUMP_V2
+		    || subtype != TABLE_DUMP_V2_RIB_IPV4_UNICAST)
+			continue;
+
+		/* sequence number, prefix */
+		if (p + 5 > end)
+			continue;
+		plen = p[4];
+		if (plen > IPV4_MAX_BITLEN || p + 5 + PSIZE(plen) + 2 > end)
+			continue;
+		p += 4;
+		count = (p[1 + PSIZE(plen)] << 8) | p[2 + PSIZE(plen)];
+		attrs = p + 3 + PSIZE(plen);
+
+		for (; count; count--) {
+			/* peer index, originated time, attribute length */
+			if (attrs + 8 > end)
+				break;
+			idx = (attrs[0] << 8) | attrs[1];
+			alen = (attrs[6] << 8) | attrs[7];
+			if (attrs + 8 + alen > end)
+				break;
+			if (peer_index < 0 || idx == peer_index) {
+				table_add_entry(p, 1 + PSIZE(plen), attrs + 8,
+						alen);
+				break;
+			}
+			attrs += 8 + alen;
+		}
+	}
+
+	table_msg_finish();
+	XFREE(MTYPE_TMP, buf);
+	return 0;
+}
+
+/*
+ * Synthetic table: `prefixes` /24s out of 16.0.0.0/4 with a few hundred
+ * different AS paths.
+ */
+static void table_generate(unsigned int prefixes)
+{
+	uint8_t attrs[32], nlri[4];
+	unsigned int i;
+	uint32_t addr, as;
+
+	for (i = 0; i < prefixes; i++) {
+		as = 64600 + (i / 64) % 256;
+
+		attrs[0] = BGP_ATTR_FLAG_TRANS;
+		attrs[1] = BGP_ATTR_ORIGIN;
+		attrs[2] = 1;
+		attrs[3] = BGP_ORIGIN_IGP;
+		attrs[4] = BGP_ATTR_FLAG_TRANS;
+		attrs[5] = BGP_ATTR_AS_PATH;
+		attrs[6] = 6;
+		attrs[7] = AS_SEQUENCE;
+		attrs[8] = 1;
+		attrs[9] = as >> 24;
+		attrs[10] = as >> 16;
+		attrs[11] = as >> 8;
+		attrs[12] = as;
+
+		addr = (16U << 24) + (i << 8);
+		nlri[0] = 24;
+		nlri[1] = addr >> 24;
+		nlri[2] = addr >> 16;
+		nlri[3] = addr >> 8;
+
+		table_add_entry(nlri, sizeof(nlri), attrs, 13);
+	}
+	table_msg_finish();
+}
+
+/*
+ * Sessions
+ */
+static void replay_read(struct thread *thread);
+static void replay_write(struct thread *thread);
+static void replay_keepalive(struct thread *thread);
+
+static size_t replay_put_header(struct stream *s, uint8_t type)
+{
+	size_t pos = stream_get_endp(s);
+	int i;
+
+	for (i = 0; i < BGP_MARKER_SIZE; i++)
+		stream_putc(s, 0xff);
+	stream_putw(s, 0);
+	stream_putc(s, type);
+	return pos;
+}
+
+static void replay_put_size(struct stream *s, size_t pos)
+{
+	stream_putw_at(s, pos + BGP_MARKER_SIZE, stream_get_endp(s) - pos);
+}
+
+static void replay_close(struct replay_session *rs, const char *reason)
+{
+	char buf[SU_ADDRSTRLEN];
+
+	if (rs->state == RS_CLOSED)
+		return;
+
+	fprintf(stderr, "session %u (%s): %s\n", rs->idx,
+		sockunion2str(&rs->su, buf, sizeof(buf)), reason);
+
+	THREAD_OFF(rs->t_read);
+	THREAD_OFF(rs->t_write);
+	THREAD_OFF(rs->t_keepalive);
+	if (rs->fd >= 0)
+		close(rs->fd);
+	rs->fd = -1;
+	rs->state = RS_CLOSED;
+}
+
+/* Top up the output buffer with UPDATEs from the table */
+static void replay_fill(struct replay_session *rs)
+{
+	struct stream *s = rs->obuf;
+	struct replay_msg *msg;
+	uint8_t *p;
+	size_t pos;
+
+	if (rs->state != RS_ESTABLISHED || rs->eor_sent)
+		return;
+
+	while (rs->next_msg < msg_count) {
+		msg = &msgs[rs->next_msg];
+		if (STREAM_WRITEABLE(s) < msg->length)
+			return;
+
+		pos = stream_get_endp(s);
+		stream_put(s, table + msg->offset, msg->length);
+		p = STREAM_DATA(s) + pos;
+		p[msg->as_pos] = rs->as >> 24;
+		p[msg->as_pos + 1] = rs->as >> 16;
+		p[msg->as_pos + 2] = rs->as >> 8;
+		p[msg->as_pos + 3] = rs->as;
+		memcpy(p + msg->nh_pos, &rs->su.sin.sin_addr, 4);
+		rs->next_msg++;
+	}
+
+	if (STREAM_WRITEABLE(s) < BGP_MSG_UPDATE_MIN_SIZE)
+		return;
+
+	/* End-of-RIB */
+	pos = replay_put_header(s, BGP_MSG_UPDATE);
+	stream_putw(s, 0);
+	stream_putw(s, 0);
+	replay_put_size(s, pos);
+	rs->eor_sent = true;
+	monotime(&rs->t_sent);
+}
+
+static void replay_flush(struct replay_session *rs)
+{
+	struct stream *s = rs->obuf;
+	ssize_t nbytes;
+	size_t avail;
+
+	for (;;) {
+		stream_pulldown(s);
+		replay_fill(rs);
+
+		avail = STREAM_READABLE(s);
+		if (!avail)
+			return;
+
+		nbytes = write(rs->fd, stream_pnt(s), avail);
+		if (nbytes < 0) {
+			if (ERRNO_IO_RETRY(errno))
+				break;
+			replay_close(rs, safe_strerror(errno));
+			return;
+		}
+		stream_forward_getp(s, nbytes);
+		if ((size_t)nbytes < avail)
+			break;
+	}
+
+	thread_add_write(master, replay_write, rs, rs->fd, &rs->t_write);
+}
+
+static void replay_write(struct thread *thread)
+{
+	replay_flush(THREAD_ARG(thread));
+}
+
+static void replay_send_open(struct replay_session *rs)
+{
+	struct stream *s = rs->obuf;
+	size_t pos, opt_pos;
+
+	pos = replay_put_header(s, BGP_MSG_OPEN);
+	stream_putc(s, BGP_VERSION_4);
+	stream_putw(s, rs->as > UINT16_MAX ? BGP_AS_TRANS : rs->as);
+	stream_putw(s, holdtime);
+	stream_put_in_addr(s, &rs->su.sin.sin_addr);
+
+	opt_pos = stream_get_endp(s);
+	stream_putc(s, 0);
+
+	/* IPv4 unicast */
+	stream_putc(s, BGP_OPEN_OPT_CAP);
+	stream_putc(s, CAPABILITY_CODE_MP_LEN + 2);
+	stream_putc(s, CAPABILITY_CODE_MP);
+	stream_putc(s, CAPABILITY_CODE_MP_LEN);
+	stream_putw(s, IANA_AFI_IPV4);
+	stream_putc(s, 0);
+	stream_putc(s, IANA_SAFI_UNICAST);
+
+	/* route refresh */
+	stream_putc(s, BGP_OPEN_OPT_CAP);
+	stream_putc(s, CAPABILITY_CODE_REFRESH_LEN + 2);
+	stream_putc(s, CAPABILITY_CODE_REFRESH);
+	stream_putc(s, CAPABILITY_CODE_REFRESH_LEN);
+
+	/* 4 octet AS */
+	stream_putc(s, BGP_OPEN_OPT_CAP);
+	stream_putc(s, CAPABILITY_CODE_AS4_LEN + 2);
+	stream_putc(s, CAPABILITY_CODE_AS4);
+	stream_putc(s, CAPABILITY_CODE_AS4_LEN);
+	stream_putl(s, rs->as);
+
+	stream_putc_at(s, opt_pos, stream_get_endp(s) - opt_pos - 1);
+	replay_put_size(s, pos);
+}
+
+static void replay_send_keepalive(struct replay_session *rs)
+{
+	size_t pos;
+
+	/* a full buffer means UPDATEs are going out, which is as good */
+	if (STREAM_WRITEABLE(rs->obuf) < BGP_HEADER_SIZE)
+		return;
+
+	pos = replay_put_header(rs->obuf, BGP_MSG_KEEPALIVE);
+	replay_put_size(rs->obuf, pos);
+}
+
+static void replay_keepalive(struct thread *thread)
+{
+	struct replay_session *rs = THREAD_ARG(thread);
+
+	replay_send_keepalive(rs);
+	replay_flush(rs);
+
+	if (rs->state != RS_CLOSED)
+		thread_add_timer(master, replay_keepalive, rs, rs->holdtime / 3,
+				 &rs->t_keepalive);
+}
+
+static void replay_established(struct replay_session *rs)
+{
+	rs->state = RS_ESTABLISHED;
+	monotime(&rs->t_established);
+
+	if (++sessions_established == session_count)
+		monotime(&t_all_established);
+}
+
+/* Returns false if the session was closed */
+static bool replay_process(struct replay_session *rs, uint8_t type,
+			   const uint8_t *body, size_t len)
+{
+	char buf[64];
+	uint16_t hold;
+
+	switch (type) {
+	case BGP_MSG_OPEN:
+		if (rs->state != RS_OPENSENT || len < 9) {
+			replay_close(rs, "unexpected OPEN");
+			return false;
+		}
+		hold = (body[3] << 8) | body[4];
+		rs->holdtime = MIN(hold, holdtime);
+		if (rs->holdtime && rs->holdtime < 3) {
+			replay_close(rs, "unacceptable hold time");
+			return false;
+		}
+		replay_send_keepalive(rs);
+		rs->state = RS_OPENCONFIRM;
+		if (rs->holdtime)
+			thread_add_timer(master, replay_keepalive, rs,
+					 rs->holdtime / 3, &rs->t_keepalive);
+		break;
+	case BGP_MSG_KEEPALIVE:
+		if (rs->state == RS_OPENCONFIRM)
+			replay_established(rs);
+		break;
+	case BGP_MSG_UPDATE:
+		if (rs->state != RS_ESTABLISHED) {
+			replay_close(rs, "UPDATE before Established");
+			return false;
+		}
+		rs->updates_rcvd++;
+		updates_rcvd++;
+		monotime(&t_last_rcvd);
+		break;
+	case BGP_MSG_NOTIFY:
+		snprintf(buf, sizeof(buf), "NOTIFICATION %u/%u received",
+			 len > 0 ? body[0] : 0, len > 1 ? body[1] : 0);
+		replay_close(rs, buf);
+		return false;
+	default:
+		break;
+	}
+
+	return true;
+}
+
+static void replay_read(struct thread *thread)
+{
+	struct replay_session *rs = THREAD_ARG(thread);
+	struct stream *s = rs->ibuf;
+	ssize_t nbytes;
+	size_t len;
+	uint8_t *p;
+
+	nbytes = stream_read_try(s, rs->fd, STREAM_WRITEABLE(s));
+	if (nbytes == 0 || nbytes == -1) {
+		replay_close(rs, nbytes ? "read error" : "connection closed");
+		return;
+	}
+
+	while (STREAM_READABLE(s) >= BGP_HEADER_SIZE) {
+		p = stream_pnt(s);
+		len = (p[BGP_MARKER_SIZE] << 8) | p[BGP_MARKER_SIZE + 1];
+		if (len < BGP_HEADER_SIZE || len > STREAM_SIZE(s)) {
+			replay_close(rs, "bad message length");
+			return;
+		}
+		if (STREAM_READABLE(s) < len)
+			break;
+
+		if (!replay_process(rs, p[BGP_MARKER_SIZE + 2],
+				    p + BGP_HEADER_SIZE,
+				    len - BGP_HEADER_SIZE))
+			return;
+		stream_forward_getp(s, len);
+	}
+	stream_pulldown(s);
+
+	replay_flush(rs);
+	if (rs->state != RS_CLOSED)
+		thread_add_read(master, replay_read, rs, rs->fd, &rs->t_read);
+}
+
+static void replay_connected(struct thread *thread)
+{
+	struct replay_session *rs = THREAD_ARG(thread);
+	socklen_t optlen = sizeof(int);
+	int err = 0;
+
+	if (getsockopt(rs->fd, SOL_SOCKET, SO_ERROR, &err, &optlen) < 0)
+		err = errno;
+	if (err) {
+		replay_close(rs, safe_strerror(err));
+		return;
+	}
+
+	rs->state = RS_OPENSENT;
+	replay_send_open(rs);
+	thread_add_read(master, replay_read, rs, rs->fd, &rs->t_read);
+	replay_flush(rs);
+}
+
+static void replay_session_start(struct replay_session *rs)
+{
+	union sockunion su = rs->su;
+
+	rs->fd = sockunion_socket(&remote);
+	if (rs->fd < 0) {
+		replay_close(rs, safe_strerror(errno));
+		return;
+	}
+	set_nonblocking(rs->fd);
+
+	if (sockunion_bind(rs->fd, &su, 0, &su) < 0) {
+		replay_close(rs, "cannot bind local address");
+		return;
+	}
+
+	if (sockunion_connect(rs->fd, &remote, htons(remote_port), 0)
+	    == connect_error) {
+		replay_close(rs, safe_strerror(errno));
+		return;
+	}
+
+	rs->state = RS_CONNECT;
+	thread_add_write(master, replay_connected, rs, rs->fd, &rs->t_write);
+}
+
+static void replay_connect_timer(struct thread *thread)
+{
+	unsigned int i, n = MAX(connect_rate / 10, 1);
+
+	for (i = 0; i < n && sessions_started < session_count; i++)
+		replay_session_start(&sessions[sessions_started++]);
+
+	if (sessions_started < session_count)
+		thread_add_timer_msec(master, replay_connect_timer, NULL, 100,
+				      &t_connect);
+}
+
+static void replay_status(struct thread *thread)
+{
+	struct replay_session *rs;
+	unsigned int pending = 0, closed = 0;
+	int64_t quiet;
+
+	for (rs = sessions; rs < sessions + sessions_started; rs++) {
+		if (rs->state == RS_CLOSED)
+			closed++;
+		else if (!rs->eor_sent)
+			pending++;
+	}
+
+	printf("%6.1fs: %u/%u established, %u closed, %u sending, %" PRIu64
+	       " UPDATEs received\n",
+	       monotime_since(&t_start, NULL) / 1000000.0,
+	       sessions_established, session_count, closed, pending,
+	       updates_rcvd);
+
+	quiet = monotime_since(timercmp(&t_last_rcvd, &t_start, >)
+				       ? &t_last_rcvd
+				       : &t_start,
+			       NULL);
+	if (sessions_started == session_count && !pending
+	    && quiet >= quiet_time * 1000000LL) {
+		done = true;
+		return;
+	}
+
+	thread_add_timer(master, replay_status, NULL, 1, &t_status);
+}
+
+static double replay_secs(const struct timeval *t)
+{
+	struct timeval r;
+
+	if (!timerisset(t))
+		return 0.0;
+	timersub(t, &t_start, &r);
+	return r.tv_sec + r.tv_usec / 1000000.0;
+}
+
+static void replay_report(void)
+{
+	struct replay_session *rs;
+	struct timeval t_all_sent = {};
+	unsigned int sent = 0;
+
+	for (rs = sessions; rs < sessions + session_count; rs++) {
+		if (!rs->eor_sent)
+			continue;
+		sent++;
+		if (timercmp(&rs->t_sent, &t_all_sent, >))
+			t_all_sent = rs->t_sent;
+	}
+
+	printf("\n");
+	printf("table:                 %" PRIu64 " prefixes in %zu UPDATEs\n",
+	       table_prefixes, msg_count);
+	printf("sessions:              %u configured, %u established, %u done\n",
+	       session_count, sessions_established, sent);
+	if (sessions_established == session_count)
+		printf("all established after: %.3fs\n",
+		       replay_secs(&t_all_established));
+	printf("table sent after:      %.3fs\n", replay_secs(&t_all_sent));
+	printf("last UPDATE rcvd:      %.3fs (%" PRIu64 " UPDATEs received)\n",
+	       replay_secs(&t_last_rcvd), updates_rcvd);
+	if (timercmp(&t_last_rcvd, &t_all_sent, >))
+		printf("converged:             %.3fs after the table was sent\n",
+		       replay_secs(&t_last_rcvd) - replay_secs(&t_all_sent));
+}
+
+static void usage(const char *progname)
+{
+	fprintf(stderr,
+		"usage: %s -r ADDRESS [-p PORT] [-l ADDRESS] [-c SESSIONS]\n"
+		"       [-a AS] [-i] [-t HOLDTIME] [-R RATE] [-q SECONDS]\n"
+		"       [-P PEER-INDEX] [-n PREFIXES] [MRT-FILE]\n"
+		"\n"
+		"  -r  address of the router under test\n"
+		"  -p  its port (179)\n"
+		"  -l  local address of the first session, incremented for\n"
+		"      every further session (127.0.1.1)\n"
+		"  -c  number of sessions (1)\n"
+		"  -a  AS of the emulated peers (65001)\n"
+		"  -i  use a different AS for every session, starting at -a\n"
+		"  -t  hold time (180)\n"
+		"  -R  sessions to bring up per second (100)\n"
+		"  -q  seconds without UPDATEs after which the router is\n"
+		"      considered converged (5)\n"
+		"  -P  MRT peer index to take the routes from (first entry)\n"
+		"  -n  prefixes to generate without MRT-FILE (100000)\n",
+		progname);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	struct replay_session *rs;
+	struct thread thread;
+	unsigned int prefixes = 100000, i;
+	int peer_index = -1;
+	int opt;
+
+	str2sockunion("127.0.1.1", &local_base);
+
+	while ((opt = getopt(argc, argv, "r:p:l:c:a:it:R:q:P:n:h")) != -1) {
+		switch (opt) {
+		case 'r':
+			if (str2sockunion(optarg, &remote) < 0)
+				usage(argv[0]);
+			break;
+		case 'p':
+			remote_port = strtoul(optarg, NULL, 10);
+			break;
+		case 'l':
+			if (str2sockunion(optarg, &local_base) < 0)
+				usage(argv[0]);
+			break;
+		case 'c':
+			session_count = strtoul(optarg, NULL, 10);
+			break;
+		case 'a':
+			as_base = strtoul(optarg, NULL, 10);
+			break;
+		case 'i':
+			as_increment = true;
+			break;
+		case 't':
+			holdtime = strtoul(optarg, NULL, 10);
+			break;
+		case 'R':
+			connect_rate = strtoul(optarg, NULL, 10);
+			break;
+		case 'q':
+			quiet_time = strtoul(optarg, NULL, 10);
+			break;
+		case 'P':
+			peer_index = strtol(optarg, NULL, 10);
+			break;
+		case 'n':
+			prefixes = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+
+	/* the replayed table is IPv4 unicast with IPv4 next hops */
+	if (remote.sa.sa_family != AF_INET
+	    || local_base.sa.sa_family != AF_INET || !session_count
+	    || !as_base || (holdtime && holdtime < 3))
+		usage(argv[0]);
+
+	if (optind < argc) {
+		if (table_load_mrt(argv[optind], peer_index) < 0)
+			return 1;
+	} else
+		table_generate(prefixes);
+
+	if (!msg_count) {
+		fprintf(stderr, "no IPv4 unicast routes to replay\n");
+		return 1;
+	}
+
+	signal(SIGPIPE, SIG_IGN);
+	master = thread_master_create("bgp replay");
+
+	sessions = XCALLOC(MTYPE_TMP, session_count * sizeof(*sessions));
+	for (i = 0; i < session_count; i++) {
+		rs = &sessions[i];
+		rs->idx = i;
+		rs->fd = -1;
+		rs->su = local_base;
+		rs->su.sin.sin_addr.s_addr =
+			htonl(ntohl(local_base.sin.sin_addr.s_addr) + i);
+		rs->as = as_increment ? as_base + i : as_base;
+		rs->ibuf = stream_new(REPLAY_BUFSIZE);
+		rs->obuf = stream_new(REPLAY_BUFSIZE);
+	}
+
+	printf("replaying %" PRIu64 " prefixes in %zu UPDATEs on %u sessions\n",
+	       table_prefixes, msg_count, session_count);
+
+	monotime(&t_start);
+	thread_add_event(master, replay_connect_timer, NULL, 0, &t_connect);
+	thread_add_timer(master, replay_status, NULL, 1, &t_status);
+
+	while (!done && thread_fetch(master, &thread))
+		thread_call(&thread);
+
+	replay_report();
+
+	for (i = 0; i < session_count; i++) {
+		rs = &sessions[i];
+		replay_close(rs, "done");
+		stream_free(rs->ibuf);
+		stream_free(rs->obuf);
+	}
+	XFREE(MTYPE_TMP, sessions);
+	XFREE(MTYPE_TMP, msgs);
+	XFREE(MTYPE_TMP, table);
+	thread_master_free(master);
+
+	return 0;
+}
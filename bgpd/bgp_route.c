@@ -89,6 +89,8 @@
 #include "bgpd/bgp_flowspec.h"
 #include "bgpd/bgp_flowspec_util.h"
 #include "bgpd/bgp_pbr.h"
+#include "bgpd/bgp_conditional_adv.h"
+#include "bgpd/bgp_rtc.h"
 
 #include "bgpd/bgp_route_clippy.c"
 
@@ -392,6 +394,7 @@ static int bgp_dest_set_defer_flag(struct bgp_dest *dest, bool delete)
 void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
 {
 	struct bgp_path_info *top;
+	struct bgp_table *table;
 
 	top = bgp_dest_get_bgp_path_info(dest);
 
@@ -401,6 +404,9 @@ void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
 		top->prev = pi;
 	bgp_dest_set_bgp_path_info(dest, pi);
 
+	table = bgp_dest_table(dest);
+	bgp_peer_paths_add_tail(&pi->peer->paths[table->afi][table->safi], pi);
+
 	bgp_path_info_lock(pi);
 	bgp_dest_lock_node(dest);
 	peer_lock(pi->peer); /* bgp_path_info peer reference */
@@ -412,6 +418,10 @@ void bgp_path_info_add(struct bgp_dest *dest, struct bgp_path_info *pi)
    completion callback *only* */
 void bgp_path_info_reap(struct bgp_dest *dest, struct bgp_path_info *pi)
 {
+	struct bgp_table *table = bgp_dest_table(dest);
+
+	bgp_peer_paths_del(&pi->peer->paths[table->afi][table->safi], pi);
+
 	if (pi->next)
 		pi->next->prev = pi->prev;
 	if (pi->prev)
@@ -553,6 +563,42 @@ struct bgp_path_info *bgp_get_imported_bpi_ultimate(struct bgp_path_info *info)
 	return bpi_ultimate;
 }
 
+/*
+ * Decide the LLGR_STALE, weight and local preference steps of
+ * bgp_path_info_cmp() with the keys precomputed in the interned attributes.
+ * Returns 1 or 0 like bgp_path_info_cmp() if they differ, -1 if they tie
+ * and -2 if the steps have to be evaluated one by one.
+ */
+static int bgp_path_info_cmp_key(struct bgp *bgp, const struct attr *newattr,
+				 const struct attr *existattr,
+				 enum bgp_path_selection_reason *reason)
+{
+	uint64_t new_key, exist_key;
+
+	if (!CHECK_FLAG(newattr->decision_flags, ATTR_DECISION_VALID)
+	    || !CHECK_FLAG(existattr->decision_flags, ATTR_DECISION_VALID)
+	    || CHECK_FLAG(newattr->decision_flags, ATTR_DECISION_LLGR_STALE)
+	    || CHECK_FLAG(existattr->decision_flags, ATTR_DECISION_LLGR_STALE))
+		return -2;
+
+	new_key = newattr->decision_key;
+	if (!CHECK_FLAG(newattr->flag, ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)))
+		new_key |= bgp->default_local_pref;
+	exist_key = existattr->decision_key;
+	if (!CHECK_FLAG(existattr->flag, ATTR_FLAG_BIT(BGP_ATTR_LOCAL_PREF)))
+		exist_key |= bgp->default_local_pref;
+
+	if (new_key == exist_key)
+		return -1;
+
+	if ((new_key >> 32) != (exist_key >> 32))
+		*reason = bgp_path_selection_weight;
+	else
+		*reason = bgp_path_selection_local_pref;
+
+	return new_key > exist_key;
+}
+
 /* Compare two bgp route entity.  If 'new' is preferable over 'exist' return 1.
  */
 static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
@@ -582,6 +628,7 @@ static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	int ret = 0;
 	int igp_metric_ret = 0;
 	int peer_sort_ret = -1;
+	int key_ret;
 	char new_buf[PATH_ADDPATH_STR_BUFFER];
 	char exist_buf[PATH_ADDPATH_STR_BUFFER];
 	uint32_t new_mm_seq;
@@ -636,6 +683,19 @@ static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	newattr = new->attr;
 	existattr = exist->attr;
 
+	/* Most comparisons are decided, or known to tie, by weight and
+	 * local-pref.  EVPN has steps of its own ahead of these, and the
+	 * debug output wants each step spelled out.
+	 */
+	if (!debug && safi != SAFI_EVPN) {
+		key_ret = bgp_path_info_cmp_key(bgp, newattr, existattr,
+						reason);
+		if (key_ret >= 0)
+			return key_ret;
+		if (key_ret == -1)
+			goto local_pref_done;
+	}
+
 	/* A BGP speaker that has advertised the "Long-lived Graceful Restart
 	 * Capability" to a neighbor MUST perform the following upon receiving
 	 * a route from that neighbor with the "LLGR_STALE" community, or upon
@@ -875,6 +935,7 @@ static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 		return 0;
 	}
 
+local_pref_done:
 	/* If a BGP speaker supports ACCEPT_OWN and is configured for the
 	 * extensions defined in this document, the following step is inserted
 	 * after the LOCAL_PREF comparison step in the BGP decision process:
@@ -1128,12 +1189,8 @@ static int bgp_path_info_cmp(struct bgp *bgp, struct bgp_path_info *new,
 	}
 
 	/* 8. IGP metric check. */
-	newm = existm = 0;
-
-	if (new->extra)
-		newm = new->extra->igpmetric;
-	if (exist->extra)
-		existm = exist->extra->igpmetric;
+	newm = new->igpmetric;
+	existm = exist->igpmetric;
 
 	if (new->peer->orr_group_name[afi][safi]) {
 		ret = str2prefix(new->peer->host, &exist_p);
@@ -1972,24 +2029,6 @@ void bgp_attr_add_gshut_community(struct attr *attr)
 }
 
 
-/* Notify BGP Conditional advertisement scanner process. */
-void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp)
-{
-	struct peer *peer = SUBGRP_PEER(subgrp);
-	afi_t afi = SUBGRP_AFI(subgrp);
-	safi_t safi = SUBGRP_SAFI(subgrp);
-	struct bgp_filter *filter = &peer->filter[afi][safi];
-
-	if (!ADVERTISE_MAP_NAME(filter))
-		return;
-
-	if (!CHECK_FLAG(peer->flags, PEER_FLAG_CONFIG_NODE))
-		return;
-
-	peer->advmap_table_change = true;
-}
-
-
 void subgroup_announce_reset_nhop(uint8_t family, struct attr *attr)
 {
 	if (family == AF_INET) {
@@ -2049,6 +2088,16 @@ bool subgroup_announce_check(struct bgp_dest *dest, struct bgp_path_info *pi,
 		return false;
 	}
 
+	/* Route target constraint: the peer has no member of this VPN */
+	if (peer->rtc_filter && bgp_rtc_safi(safi)
+	    && !bgp_rtc_filter_match(peer->rtc_filter,
+				     bgp_attr_get_ecommunity(piattr))) {
+		if (bgp_debug_update(NULL, p, subgrp->update_group, 0))
+			zlog_debug("%s: %pFX not in any route target membership of %s",
+				   __func__, p, peer->host);
+		return false;
+	}
+
 #ifdef ENABLE_BGP_VNC
 	if (((afi == AFI_IP) || (afi == AFI_IP6)) && (safi == SAFI_MPLS_VPN)
 	    && ((pi->type == ZEBRA_ROUTE_BGP_DIRECT)
@@ -2715,7 +2764,8 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 					if (pi2->peer != bgp->peer_self
 					    && !CHECK_FLAG(
 						    pi2->peer->sflags,
-						    PEER_STATUS_NSF_WAIT))
+						    PEER_STATUS_NSF_WAIT
+						    | PEER_STATUS_RIB_RESTORED))
 						if (pi2->peer->status
 						    != Established)
 							continue;
@@ -2785,7 +2835,9 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 		}
 
 		if (pi->peer && pi->peer != bgp->peer_self
-		    && !CHECK_FLAG(pi->peer->sflags, PEER_STATUS_NSF_WAIT))
+		    && !CHECK_FLAG(pi->peer->sflags,
+				   PEER_STATUS_NSF_WAIT
+					   | PEER_STATUS_RIB_RESTORED))
 			if (!peer_established(pi->peer)) {
 
 				if (debug)
@@ -2856,7 +2908,8 @@ void bgp_best_selection(struct bgp *bgp, struct bgp_dest *dest,
 
 			if (pi->peer && pi->peer != bgp->peer_self
 			    && !CHECK_FLAG(pi->peer->sflags,
-					   PEER_STATUS_NSF_WAIT))
+					   PEER_STATUS_NSF_WAIT
+						   | PEER_STATUS_RIB_RESTORED))
 				if (!peer_established(pi->peer))
 					continue;
 
@@ -3018,6 +3071,8 @@ struct bgp_process_queue {
 #define BGP_PROCESS_QUEUE_EOIU_MARKER		(1 << 0)
 	unsigned int flags;
 	unsigned int queued;
+	/* when the first dest was queued, see bgp_pipeline_now() */
+	int64_t t_queued;
 };
 
 static void bgp_process_evpn_route_injection(struct bgp *bgp, afi_t afi,
@@ -3165,6 +3220,10 @@ static void bgp_process_main_one(struct bgp *bgp, struct bgp_dest *dest,
 	old_select = old_and_new.old;
 	new_select = old_and_new.new;
 
+	/* Let the conditional advertisement scanner know about changes. */
+	if (bgp->condition_filter_count)
+		bgp_conditional_adv_dest_process(bgp, dest, afi, safi);
+
 	/* Do we need to allocate or free labels?
 	 * Right now, since we only deal with per-prefix labels, it is not
 	 * necessary to do this upon changes to best path. Exceptions:
@@ -3449,12 +3508,21 @@ static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 	struct bgp *bgp = pqnode->bgp;
 	struct bgp_table *table;
 	struct bgp_dest *dest;
+	struct zclient *zc = zclient;
+
+	/* Route installs for the whole queue item go out to zebra as one
+	 * batch of writes rather than one write per prefix.
+	 */
+	if (zc)
+		zclient_batch_start(zc);
 
 	/* eoiu marker */
 	if (CHECK_FLAG(pqnode->flags, BGP_PROCESS_QUEUE_EOIU_MARKER)) {
 		bgp_process_main_one(bgp, NULL, 0, 0);
 		/* should always have dedicated wq call */
 		assert(STAILQ_FIRST(&pqnode->pqueue) == NULL);
+		if (zc)
+			zclient_batch_end(zc);
 		return WQ_SUCCESS;
 	}
 
@@ -3465,11 +3533,17 @@ static wq_item_status bgp_process_wq(struct work_queue *wq, void *data)
 		table = bgp_dest_table(dest);
 		/* note, new DESTs may be added as part of processing */
 		bgp_process_main_one(bgp, dest, table->afi, table->safi);
+		bgp_pipeline_record(&bgp->pipeline, bgp->name_pretty,
+				    table->afi, BGP_PIPELINE_PROCESS,
+				    pqnode->t_queued);
 
 		bgp_dest_unlock_node(dest);
 		bgp_table_unlock(table);
 	}
 
+	if (zc)
+		zclient_batch_end(zc);
+
 	return WQ_SUCCESS;
 }
 
@@ -3509,6 +3583,7 @@ static struct bgp_process_queue *bgp_processq_alloc(struct bgp *bgp)
 	/* unlocked in bgp_processq_del */
 	pqnode->bgp = bgp_lock(bgp);
 	STAILQ_INIT(&pqnode->pqueue);
+	pqnode->t_queued = bgp_pipeline_now();
 
 	return pqnode;
 }
@@ -4941,6 +5016,81 @@ filtered:
 	return 0;
 }
 
+/*
+ * Put a path from before a restart (bgp_snapshot.c) back into the RIB.
+ * attr is already post inbound policy and interned.  The path is STALE
+ * until the peer sends it again;  bgp_update() then finds an identical
+ * attribute and just clears the flag.
+ */
+bool bgp_path_restore(struct peer *peer, const struct prefix *p,
+		      uint32_t addpath_id, struct attr *attr, afi_t afi,
+		      safi_t safi)
+{
+	struct bgp *bgp = peer->bgp;
+	struct bgp_dest *dest;
+	struct bgp_path_info *pi, *new;
+	const struct prefix *bgp_nht_param_prefix;
+	int connected;
+
+	if (safi != SAFI_UNICAST && safi != SAFI_MULTICAST)
+		return false;
+
+	dest = bgp_afi_node_get(bgp->rib[afi][safi], afi, safi, p, NULL);
+
+	for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next)
+		if (pi->peer == peer && pi->type == ZEBRA_ROUTE_BGP &&
+		    pi->sub_type == BGP_ROUTE_NORMAL &&
+		    pi->addpath_rx_id == addpath_id)
+			break;
+	if (pi) {
+		bgp_dest_unlock_node(dest);
+		return false;
+	}
+
+	new = info_make(ZEBRA_ROUTE_BGP, BGP_ROUTE_NORMAL, 0, peer,
+			bgp_attr_intern(attr), dest);
+	new->addpath_rx_id = addpath_id;
+	bgp_path_info_set_flag(dest, new, BGP_PATH_STALE);
+
+	if (safi == SAFI_UNICAST) {
+		if (peer->sort == BGP_PEER_EBGP && peer->ttl == BGP_DEFAULT_TTL
+		    && !CHECK_FLAG(peer->flags,
+				   PEER_FLAG_DISABLE_CONNECTED_CHECK)
+		    && !CHECK_FLAG(bgp->flags,
+				   BGP_FLAG_DISABLE_NH_CONNECTED_CHK))
+			connected = 1;
+		else
+			connected = 0;
+
+		if (CHECK_FLAG(peer->af_flags[afi][safi],
+			       PEER_FLAG_REFLECTOR_CLIENT))
+			bgp_nht_param_prefix = NULL;
+		else
+			bgp_nht_param_prefix = p;
+
+		if (bgp_find_or_add_nexthop(bgp, bgp,
+					    BGP_ATTR_NH_AFI(afi, new->attr),
+					    safi, new, NULL, connected,
+					    bgp_nht_param_prefix))
+			bgp_path_info_set_flag(dest, new, BGP_PATH_VALID);
+	} else
+		bgp_path_info_set_flag(dest, new, BGP_PATH_VALID);
+
+	bgp_aggregate_increment(bgp, p, new, afi, safi);
+	bgp_path_info_add(dest, new);
+	bgp_dest_unlock_node(dest);
+
+	hook_call(bgp_process, bgp, afi, safi, dest, peer, false);
+	bgp_process(bgp, dest, afi, safi);
+
+	if (safi == SAFI_UNICAST &&
+	    (bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+	     bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+		vpn_leak_from_vrf_update(bgp_get_default(), bgp, new);
+
+	return true;
+}
+
 int bgp_withdraw(struct peer *peer, const struct prefix *p, uint32_t addpath_id,
 		 struct attr *attr, afi_t afi, safi_t safi, int type,
 		 int sub_type, struct prefix_rd *prd, mpls_label_t *label,
@@ -5257,32 +5407,33 @@ static void bgp_soft_reconfig_table_task(struct thread *thread)
 
 		UNSET_FLAG(dest->flags, BGP_NODE_SOFT_RECONFIG);
 
+		/* With many peers on the list, checking each adj_in against
+		 * the whole list dominated the run time.
+		 */
 		for (ain = dest->adj_in; ain; ain = ain->next) {
-			for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node,
-					       nnode, peer)) {
-				if (ain->peer != peer)
-					continue;
+			peer = ain->peer;
+			if (!peer->soft_reconfig_pending[table->afi]
+							[table->safi])
+				continue;
 
-				ret = bgp_soft_reconfig_table_update(
-					peer, dest, ain, table->afi,
-					table->safi, prd);
-				iter++;
+			ret = bgp_soft_reconfig_table_update(
+				peer, dest, ain, table->afi, table->safi, prd);
+			iter++;
 
-				if (ret < 0) {
-					bgp_dest_unlock_node(dest);
-					listnode_delete(
-						table->soft_reconfig_peers,
+			if (ret < 0) {
+				bgp_dest_unlock_node(dest);
+				peer->soft_reconfig_pending[table->afi]
+							   [table->safi] = false;
+				listnode_delete(table->soft_reconfig_peers,
 						peer);
-					bgp_announce_route(peer, table->afi,
-							   table->safi, false);
-					if (list_isempty(
-						    table->soft_reconfig_peers)) {
-						list_delete(
-							&table->soft_reconfig_peers);
-						bgp_soft_reconfig_table_flag(
-							table, false);
-						return;
-					}
+				bgp_announce_route(peer, table->afi,
+						   table->safi, false);
+				if (list_isempty(table->soft_reconfig_peers)) {
+					list_delete(
+						&table->soft_reconfig_peers);
+					bgp_soft_reconfig_table_flag(table,
+								     false);
+					return;
 				}
 			}
 		}
@@ -5301,6 +5452,7 @@ static void bgp_soft_reconfig_table_task(struct thread *thread)
 	schedule route annoucement
 	*/
 	for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node, nnode, peer)) {
+		peer->soft_reconfig_pending[table->afi][table->safi] = false;
 		listnode_delete(table->soft_reconfig_peers, peer);
 		bgp_announce_route(peer, table->afi, table->safi, false);
 	}
@@ -5340,6 +5492,7 @@ void bgp_soft_reconfig_table_task_cancel(const struct bgp *bgp,
 				       npeer)) {
 			if (peer && peer != npeer)
 				continue;
+			npeer->soft_reconfig_pending[afi][safi] = false;
 			listnode_delete(ntable->soft_reconfig_peers, npeer);
 		}
 
@@ -5360,8 +5513,6 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 {
 	struct bgp_dest *dest;
 	struct bgp_table *table;
-	struct listnode *node, *nnode;
-	struct peer *npeer;
 	struct peer_af *paf;
 
 	if (!CHECK_FLAG(peer->af_flags[afi][safi], PEER_FLAG_SOFT_RECONFIG))
@@ -5377,17 +5528,13 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 
 		if (!table->soft_reconfig_peers)
 			table->soft_reconfig_peers = list_new();
-		npeer = NULL;
 		/* add peer to the table soft_reconfig_peers if not already
 		 * there
 		 */
-		for (ALL_LIST_ELEMENTS(table->soft_reconfig_peers, node, nnode,
-				       npeer)) {
-			if (peer == npeer)
-				break;
-		}
-		if (peer != npeer)
+		if (!peer->soft_reconfig_pending[afi][safi]) {
+			peer->soft_reconfig_pending[afi][safi] = true;
 			listnode_add(table->soft_reconfig_peers, peer);
+		}
 
 		/* (re)flag all bgp_dest in table. Existing soft_reconfig_in job
 		 * on table would start back at the beginning.
@@ -5435,6 +5582,19 @@ bool bgp_soft_reconfig_in(struct peer *peer, afi_t afi, safi_t safi)
 	return true;
 }
 
+/*
+ * peer->paths also holds copies of the peer's paths in other tables, only
+ * bgp->rib[afi][safi] (and its per-RD tables) are wanted here.
+ */
+static bool bgp_peer_path_in_rib(struct peer *peer, struct bgp_dest *dest,
+				 afi_t afi, safi_t safi)
+{
+	struct bgp_table *rib = peer->bgp->rib[afi][safi];
+
+	if (dest->pdest)
+		return bgp_dest_table(dest->pdest) == rib;
+	return bgp_dest_table(dest) == rib;
+}
 
 struct bgp_clear_node_queue {
 	struct bgp_dest *dest;
@@ -5533,59 +5693,14 @@ static void bgp_clear_node_queue_init(struct peer *peer)
 	peer->clear_node_queue->spec.data = peer;
 }
 
-static void bgp_clear_route_table(struct peer *peer, afi_t afi, safi_t safi,
-				  struct bgp_table *table)
+/* Remove the peer's entries from the (optional) adj-in index of table. */
+static void bgp_clear_route_adj_in(struct peer *peer, struct bgp_table *table)
 {
 	struct bgp_dest *dest;
-	int force = peer->bgp->process_queue ? 0 : 1;
-
-	if (!table)
-		table = peer->bgp->rib[afi][safi];
-
-	/* If still no table => afi/safi isn't configured at all or smth. */
-	if (!table)
-		return;
+	struct bgp_adj_in *ain;
+	struct bgp_adj_in *ain_next;
 
 	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		struct bgp_path_info *pi, *next;
-		struct bgp_adj_in *ain;
-		struct bgp_adj_in *ain_next;
-
-		/* XXX:TODO: This is suboptimal, every non-empty route_node is
-		 * queued for every clearing peer, regardless of whether it is
-		 * relevant to the peer at hand.
-		 *
-		 * Overview: There are 3 different indices which need to be
-		 * scrubbed, potentially, when a peer is removed:
-		 *
-		 * 1 peer's routes visible via the RIB (ie accepted routes)
-		 * 2 peer's routes visible by the (optional) peer's adj-in index
-		 * 3 other routes visible by the peer's adj-out index
-		 *
-		 * 3 there is no hurry in scrubbing, once the struct peer is
-		 * removed from bgp->peer, we could just GC such deleted peer's
-		 * adj-outs at our leisure.
-		 *
-		 * 1 and 2 must be 'scrubbed' in some way, at least made
-		 * invisible via RIB index before peer session is allowed to be
-		 * brought back up. So one needs to know when such a 'search' is
-		 * complete.
-		 *
-		 * Ideally:
-		 *
-		 * - there'd be a single global queue or a single RIB walker
-		 * - rather than tracking which route_nodes still need to be
-		 *   examined on a peer basis, we'd track which peers still
-		 *   aren't cleared
-		 *
-		 * Given that our per-peer prefix-counts now should be reliable,
-		 * this may actually be achievable. It doesn't seem to be a huge
-		 * problem at this time,
-		 *
-		 * It is possible that we have multiple paths for a prefix from
-		 * a peer
-		 * if that peer is using AddPath.
-		 */
 		ain = dest->adj_in;
 		while (ain) {
 			ain_next = ain->next;
@@ -5595,30 +5710,53 @@ static void bgp_clear_route_table(struct peer *peer, afi_t afi, safi_t safi,
 
 			ain = ain_next;
 		}
+	}
+}
 
-		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = next) {
-			next = pi->next;
-			if (pi->peer != peer)
-				continue;
+/* Queue (or, without a process queue, reap) the peer's accepted routes.
+ *
+ * Only the peer's own paths are visited, through peer->paths, rather than
+ * every route_node of the table.  The adj-out index of other routes needs
+ * no hurry, and the adj-in index is scrubbed separately when the peer has
+ * any entries in it.
+ */
+static void bgp_clear_route_paths(struct peer *peer, afi_t afi, safi_t safi)
+{
+	struct bgp_dest *dest;
+	struct bgp_path_info *pi, *prev;
+	int force = peer->bgp->process_queue ? 0 : 1;
 
-			if (force)
-				bgp_path_info_reap(dest, pi);
-			else {
-				struct bgp_clear_node_queue *cnq;
-
-				/* both unlocked in bgp_clear_node_queue_del */
-				bgp_table_lock(bgp_dest_table(dest));
-				bgp_dest_lock_node(dest);
-				cnq = XCALLOC(
-					MTYPE_BGP_CLEAR_NODE_QUEUE,
-					sizeof(struct bgp_clear_node_queue));
-				cnq->dest = dest;
-				work_queue_add(peer->clear_node_queue, cnq);
-				break;
-			}
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		struct bgp_clear_node_queue *cnq;
+
+		dest = pi->net;
+		if (!bgp_peer_path_in_rib(peer, dest, afi, safi))
+			continue;
+
+		if (force) {
+			bgp_path_info_reap(dest, pi);
+			continue;
 		}
+
+		/* It is possible that we have multiple paths for a prefix from
+		 * a peer if that peer is using AddPath.  bgp_clear_route_node
+		 * handles all of them, so queue the dest for the first one.
+		 */
+		for (prev = bgp_dest_get_bgp_path_info(dest); prev != pi;
+		     prev = prev->next)
+			if (prev->peer == peer)
+				break;
+		if (prev != pi)
+			continue;
+
+		/* both unlocked in bgp_clear_node_queue_del */
+		bgp_table_lock(bgp_dest_table(dest));
+		bgp_dest_lock_node(dest);
+		cnq = XCALLOC(MTYPE_BGP_CLEAR_NODE_QUEUE,
+			      sizeof(struct bgp_clear_node_queue));
+		cnq->dest = dest;
+		work_queue_add(peer->clear_node_queue, cnq);
 	}
-	return;
 }
 
 void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
@@ -5649,17 +5787,25 @@ void bgp_clear_route(struct peer *peer, afi_t afi, safi_t safi)
 	if (!peer->clear_node_queue->thread)
 		peer_lock(peer);
 
-	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN)
-		bgp_clear_route_table(peer, afi, safi, NULL);
-	else
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+	/* If no table => afi/safi isn't configured at all or smth. */
+	table = peer->bgp->rib[afi][safi];
+	if (table && peer->adj_in_count[afi][safi]) {
+		if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP
+		    && safi != SAFI_EVPN)
+			bgp_clear_route_adj_in(peer, table);
+		else
+			for (dest = bgp_table_top(table); dest;
+			     dest = bgp_route_next(dest)) {
+				struct bgp_table *inner;
 
-			bgp_clear_route_table(peer, afi, safi, table);
-		}
+				inner = bgp_dest_get_bgp_table_info(dest);
+				if (inner)
+					bgp_clear_route_adj_in(peer, inner);
+			}
+	}
+
+	if (table)
+		bgp_clear_route_paths(peer, afi, safi);
 
 	/* unlock if no nodes got added to the clear-node-queue. */
 	if (!peer->clear_node_queue->thread)
@@ -5714,154 +5860,67 @@ void bgp_clear_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
 	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
+	bool two_level;
 
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			struct bgp_dest *rm;
+	two_level = (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP
+		     || safi == SAFI_EVPN);
 
-			/* look for neighbor in tables */
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+	frr_each_safe (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
+		if (!bgp_peer_path_in_rib(peer, dest, afi, safi))
+			continue;
+		if (CHECK_FLAG(peer->af_sflags[afi][safi],
+			       PEER_STATUS_LLGR_WAIT) &&
+		    bgp_attr_get_community(pi->attr) &&
+		    !community_include(bgp_attr_get_community(pi->attr),
+				       COMMUNITY_NO_LLGR))
+			continue;
+		if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
+			continue;
 
-			for (rm = bgp_table_top(table); rm;
-			     rm = bgp_route_next(rm))
-				for (pi = bgp_dest_get_bgp_path_info(rm); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
-					if (CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_LLGR_WAIT) &&
-					    bgp_attr_get_community(pi->attr) &&
-					    !community_include(
-						    bgp_attr_get_community(
-							    pi->attr),
-						    COMMUNITY_NO_LLGR))
-						continue;
-					if (!CHECK_FLAG(pi->flags,
-							BGP_PATH_STALE))
-						continue;
+		if (two_level) {
+			/*
+			 * If this is VRF leaked route
+			 * process for withdraw.
+			 */
+			if (pi->sub_type == BGP_ROUTE_IMPORTED &&
+			    peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT)
+				vpn_leak_to_vrf_withdraw(peer->bgp, pi);
+		} else if (safi == SAFI_UNICAST &&
+			   (peer->bgp->inst_type == BGP_INSTANCE_TYPE_VRF ||
+			    peer->bgp->inst_type == BGP_INSTANCE_TYPE_DEFAULT))
+			vpn_leak_from_vrf_withdraw(bgp_get_default(),
+						   peer->bgp, pi);
 
-					/*
-					 * If this is VRF leaked route
-					 * process for withdraw.
-					 */
-					if (pi->sub_type ==
-						    BGP_ROUTE_IMPORTED &&
-					    peer->bgp->inst_type ==
-						    BGP_INSTANCE_TYPE_DEFAULT)
-						vpn_leak_to_vrf_withdraw(
-							peer->bgp, pi);
-
-					bgp_rib_remove(rm, pi, peer, afi, safi);
-					break;
-				}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest))
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
-				if (CHECK_FLAG(peer->af_sflags[afi][safi],
-					       PEER_STATUS_LLGR_WAIT) &&
-				    bgp_attr_get_community(pi->attr) &&
-				    !community_include(
-					    bgp_attr_get_community(pi->attr),
-					    COMMUNITY_NO_LLGR))
-					continue;
-				if (!CHECK_FLAG(pi->flags, BGP_PATH_STALE))
-					continue;
-				if (safi == SAFI_UNICAST &&
-				    (peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_VRF ||
-				     peer->bgp->inst_type ==
-					     BGP_INSTANCE_TYPE_DEFAULT))
-					vpn_leak_from_vrf_withdraw(
-						bgp_get_default(), peer->bgp,
-						pi);
-
-				bgp_rib_remove(dest, pi, peer, afi, safi);
-				break;
-			}
+		bgp_rib_remove(dest, pi, peer, afi, safi);
 	}
 }
 
 void bgp_set_stale_route(struct peer *peer, afi_t afi, safi_t safi)
 {
-	struct bgp_dest *dest, *ndest;
+	struct bgp_dest *dest;
 	struct bgp_path_info *pi;
-	struct bgp_table *table;
 
-	if (safi == SAFI_MPLS_VPN || safi == SAFI_ENCAP || safi == SAFI_EVPN) {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			table = bgp_dest_get_bgp_table_info(dest);
-			if (!table)
-				continue;
+	if (!CHECK_FLAG(peer->af_sflags[afi][safi],
+			PEER_STATUS_ENHANCED_REFRESH))
+		return;
 
-			for (ndest = bgp_table_top(table); ndest;
-			     ndest = bgp_route_next(ndest)) {
-				for (pi = bgp_dest_get_bgp_path_info(ndest); pi;
-				     pi = pi->next) {
-					if (pi->peer != peer)
-						continue;
+	frr_each (bgp_peer_paths, &peer->paths[afi][safi], pi) {
+		dest = pi->net;
+		if (!bgp_peer_path_in_rib(peer, dest, afi, safi))
+			continue;
 
-					if ((CHECK_FLAG(
-						    peer->af_sflags[afi][safi],
-						    PEER_STATUS_ENHANCED_REFRESH))
-					    && !CHECK_FLAG(pi->flags,
-							   BGP_PATH_STALE)
-					    && !CHECK_FLAG(
-						       pi->flags,
-						       BGP_PATH_UNUSEABLE)) {
-						if (bgp_debug_neighbor_events(
-							    peer))
-							zlog_debug(
-								"%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
-								peer,
-								afi2str(afi),
-								safi2str(safi),
-								bgp_dest_get_prefix(
-									ndest));
-
-						bgp_path_info_set_flag(
-							ndest, pi,
-							BGP_PATH_STALE);
-					}
-				}
-			}
-		}
-	} else {
-		for (dest = bgp_table_top(peer->bgp->rib[afi][safi]); dest;
-		     dest = bgp_route_next(dest)) {
-			for (pi = bgp_dest_get_bgp_path_info(dest); pi;
-			     pi = pi->next) {
-				if (pi->peer != peer)
-					continue;
+		if (CHECK_FLAG(pi->flags, BGP_PATH_STALE)
+		    || CHECK_FLAG(pi->flags, BGP_PATH_UNUSEABLE))
+			continue;
 
-				if ((CHECK_FLAG(peer->af_sflags[afi][safi],
-						PEER_STATUS_ENHANCED_REFRESH))
-				    && !CHECK_FLAG(pi->flags, BGP_PATH_STALE)
-				    && !CHECK_FLAG(pi->flags,
-						   BGP_PATH_UNUSEABLE)) {
-					if (bgp_debug_neighbor_events(peer))
-						zlog_debug(
-							"%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
-							peer, afi2str(afi),
-							safi2str(safi),
-							bgp_dest_get_prefix(
-								dest));
+		if (bgp_debug_neighbor_events(peer))
+			zlog_debug(
+				"%pBP route-refresh for %s/%s, marking prefix %pFX as stale",
+				peer, afi2str(afi), safi2str(safi),
+				bgp_dest_get_prefix(dest));
 
-					bgp_path_info_set_flag(dest, pi,
-							       BGP_PATH_STALE);
-				}
-			}
-		}
+		bgp_path_info_set_flag(dest, pi, BGP_PATH_STALE);
 	}
 }
 
@@ -9518,7 +9577,7 @@ void route_vty_out(struct vty *vty, const struct prefix *p,
 	if (attr->aspath) {
 		if (json_paths)
 			json_object_string_add(json_path, "path",
-					       attr->aspath->str);
+					       aspath_print(attr->aspath));
 		else
 			aspath_print_vty(vty, "%s", attr->aspath, " ");
 	}
@@ -9541,7 +9600,7 @@ void route_vty_out(struct vty *vty, const struct prefix *p,
 			json_ext_community = json_object_new_object();
 			json_object_string_add(
 				json_ext_community, "string",
-				bgp_attr_get_ecommunity(attr)->str);
+				ecommunity_str(bgp_attr_get_ecommunity(attr)));
 			json_object_object_add(json_path,
 					       "extendedCommunity",
 					       json_ext_community);
@@ -9595,7 +9654,8 @@ void route_vty_out(struct vty *vty, const struct prefix *p,
 				ATTR_FLAG_BIT(BGP_ATTR_EXT_COMMUNITIES)) {
 				vty_out(vty, "%*s", 20, " ");
 				vty_out(vty, "%s\n",
-					bgp_attr_get_ecommunity(attr)->str);
+					ecommunity_str(
+						bgp_attr_get_ecommunity(attr)));
 			}
 		}
 
@@ -9683,8 +9743,9 @@ void route_vty_out_tmp(struct vty *vty, struct bgp_dest *dest,
 
 			/* Print aspath */
 			if (attr->aspath)
-				json_object_string_add(json_net, "path",
-						       attr->aspath->str);
+				json_object_string_add(
+					json_net, "path",
+					aspath_print(attr->aspath));
 
 			/* Print origin */
 #if CONFDATE > 20231208
@@ -10016,7 +10077,7 @@ static void damp_route_vty_out(struct vty *vty, const struct prefix *p,
 
 		if (attr->aspath)
 			json_object_string_add(json_path, "asPath",
-					       attr->aspath->str);
+					       aspath_print(attr->aspath));
 
 		json_object_string_add(json_path, "origin",
 				       bgp_origin_str[attr->origin]);
@@ -10102,7 +10163,7 @@ static void flap_route_vty_out(struct vty *vty, const struct prefix *p,
 
 		if (attr->aspath)
 			json_object_string_add(json_path, "asPath",
-					       attr->aspath->str);
+					       aspath_print(attr->aspath));
 
 		json_object_string_add(json_path, "origin",
 				       bgp_origin_str[attr->origin]);
@@ -10524,14 +10585,14 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				import ? ", import-check enabled" : "");
 		}
 	} else {
-		if (bpi_ultimate->extra && bpi_ultimate->extra->igpmetric) {
+		if (bpi_ultimate->igpmetric) {
 			if (json_paths)
-				json_object_int_add(
-					json_nexthop_global, "metric",
-					bpi_ultimate->extra->igpmetric);
+				json_object_int_add(json_nexthop_global,
+						    "metric",
+						    bpi_ultimate->igpmetric);
 			else
 				vty_out(vty, " (metric %u)",
-					bpi_ultimate->extra->igpmetric);
+					bpi_ultimate->igpmetric);
 		}
 
 		/* IGP cost is 0, display this only for json */
@@ -10917,7 +10978,8 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				bgp_attr_get_community(attr)->json);
 		} else {
 			vty_out(vty, "      Community: %s\n",
-				bgp_attr_get_community(attr)->str);
+				community_str(bgp_attr_get_community(attr),
+					      false, true));
 		}
 	}
 
@@ -10927,12 +10989,12 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 			json_ext_community = json_object_new_object();
 			json_object_string_add(
 				json_ext_community, "string",
-				bgp_attr_get_ecommunity(attr)->str);
+				ecommunity_str(bgp_attr_get_ecommunity(attr)));
 			json_object_object_add(json_path, "extendedCommunity",
 					       json_ext_community);
 		} else {
 			vty_out(vty, "      Extended Community: %s\n",
-				bgp_attr_get_ecommunity(attr)->str);
+				ecommunity_str(bgp_attr_get_ecommunity(attr)));
 		}
 	}
 
@@ -10948,7 +11010,8 @@ void route_vty_out_detail(struct vty *vty, struct bgp *bgp, struct bgp_dest *bn,
 				bgp_attr_get_lcommunity(attr)->json);
 		} else {
 			vty_out(vty, "      Large Community: %s\n",
-				bgp_attr_get_lcommunity(attr)->str);
+				lcommunity_str(bgp_attr_get_lcommunity(attr),
+					       false, true));
 		}
 	}
 
@@ -11325,8 +11388,9 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 				bool found = false;
 
 				if (picomm) {
-					frrstr_split(picomm->str, " ",
-						     &communities, &num);
+					frrstr_split(community_str(picomm, false,
+								   true),
+						     " ", &communities, &num);
 					for (int i = 0; i < num; i++) {
 						const char *com2alias =
 							bgp_community2alias(
@@ -11343,9 +11407,10 @@ static int bgp_show_table(struct vty *vty, struct bgp *bgp, safi_t safi,
 
 				if (!found &&
 				    bgp_attr_get_lcommunity(pi->attr)) {
-					frrstr_split(bgp_attr_get_lcommunity(
-							     pi->attr)
-							     ->str,
+					frrstr_split(lcommunity_str(
+							     bgp_attr_get_lcommunity(
+								     pi->attr),
+							     false, true),
 						     " ", &communities, &num);
 					for (int i = 0; i < num; i++) {
 						const char *com2alias =
@@ -170,9 +170,6 @@ struct bgp_path_info_extra {
 	/** List of aggregations that suppress this path. */
 	struct list *aggr_suppressors;
 
-	/* Nexthop reachability check.  */
-	uint32_t igpmetric;
-
 	/* MPLS label(s) - VNI(s) for EVPN-VxLAN  */
 	mpls_label_t label[BGP_MAX_LABELS];
 	uint32_t num_labels;
@@ -260,38 +257,29 @@ struct bgp_path_info_extra {
 	struct bgp_path_mh_info *mh_info;
 };
 
+/*
+ * The fields consulted by the decision process come first, so comparing
+ * two paths normally touches a single cache line.  Data only needed for
+ * some paths lives in the lazily allocated bgp_path_info_extra.
+ */
 struct bgp_path_info {
 	/* For linked list. */
 	struct bgp_path_info *next;
-	struct bgp_path_info *prev;
-
-	/* For nexthop linked list */
-	LIST_ENTRY(bgp_path_info) nh_thread;
-
-	/* Back pointer to the prefix node */
-	struct bgp_dest *net;
 
-	/* Back pointer to the nexthop structure */
-	struct bgp_nexthop_cache *nexthop;
+	/* Attribute structure.  */
+	struct attr *attr;
 
 	/* Peer structure.  */
 	struct peer *peer;
 
-	/* Attribute structure.  */
-	struct attr *attr;
-
 	/* Extra information */
 	struct bgp_path_info_extra *extra;
 
+	/* Back pointer to the prefix node */
+	struct bgp_dest *net;
 
-	/* Multipath information */
-	struct bgp_path_info_mpath *mpath;
-
-	/* Uptime.  */
-	time_t uptime;
-
-	/* reference count */
-	int lock;
+	/* Back pointer to the nexthop structure */
+	struct bgp_nexthop_cache *nexthop;
 
 	/* BGP information status.  */
 	uint32_t flags;
@@ -313,6 +301,9 @@ struct bgp_path_info {
 #define BGP_PATH_LINK_BW_CHG (1 << 15)
 #define BGP_PATH_ACCEPT_OWN (1 << 16)
 
+	/* IGP metric to the nexthop, from nexthop tracking. */
+	uint32_t igpmetric;
+
 	/* BGP route type.  This can be static, RIP, OSPF, BGP etc.  */
 	uint8_t type;
 
@@ -330,11 +321,30 @@ struct bgp_path_info {
 
 	unsigned short instance;
 
+	/* reference count */
+	int lock;
+
+	/* Uptime.  */
+	time_t uptime;
+
+	/* Multipath information */
+	struct bgp_path_info_mpath *mpath;
+
+	struct bgp_path_info *prev;
+
+	/* peer->paths[afi][safi] linkage */
+	struct bgp_peer_paths_item peer_item;
+
+	/* For nexthop linked list */
+	LIST_ENTRY(bgp_path_info) nh_thread;
+
 	/* Addpath identifiers */
 	uint32_t addpath_rx_id;
 	struct bgp_addpath_info_data tx_addpath;
 };
 
+DECLARE_DLIST(bgp_peer_paths, struct bgp_path_info, peer_item);
+
 /* Structure used in BGP path selection */
 struct bgp_path_info_pair {
 	struct bgp_path_info *old;
@@ -755,6 +765,9 @@ extern int bgp_update(struct peer *peer, const struct prefix *p,
 		      struct prefix_rd *prd, mpls_label_t *label,
 		      uint32_t num_labels, int soft_reconfig,
 		      struct bgp_route_evpn *evpn);
+extern bool bgp_path_restore(struct peer *peer, const struct prefix *p,
+			     uint32_t addpath_id, struct attr *attr, afi_t afi,
+			     safi_t safi);
 extern int bgp_withdraw(struct peer *peer, const struct prefix *p,
 			uint32_t addpath_id, struct attr *attr, afi_t afi,
 			safi_t safi, int type, int sub_type,
@@ -814,7 +827,6 @@ extern void route_vty_out_overlay(struct vty *vty, const struct prefix *p,
 				  struct bgp_path_info *path, int display,
 				  json_object *json);
 
-extern void bgp_notify_conditional_adv_scanner(struct update_subgroup *subgrp);
 
 extern void subgroup_process_announce_selected(struct update_subgroup *subgrp,
 					       struct bgp_path_info *selected,
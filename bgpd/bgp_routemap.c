@@ -74,6 +74,7 @@
 #include "bgpd/bgp_encap_types.h"
 #include "bgpd/bgp_mpath.h"
 #include "bgpd/bgp_script.h"
+#include "bgpd/bgp_conditional_adv.h"
 
 #ifdef ENABLE_BGP_VNC
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
@@ -1273,7 +1274,9 @@ route_match_alias(void *rule, const struct prefix *prefix, void *object)
 
 	if (bgp_attr_get_community(path->attr)) {
 		found = false;
-		frrstr_split(bgp_attr_get_community(path->attr)->str, " ",
+		frrstr_split(community_str(bgp_attr_get_community(path->attr),
+					   false, true),
+			     " ",
 			     &communities, &num);
 		for (int i = 0; i < num; i++) {
 			const char *com2alias =
@@ -1289,7 +1292,9 @@ route_match_alias(void *rule, const struct prefix *prefix, void *object)
 
 	if (bgp_attr_get_lcommunity(path->attr)) {
 		found = false;
-		frrstr_split(bgp_attr_get_lcommunity(path->attr)->str, " ",
+		frrstr_split(lcommunity_str(bgp_attr_get_lcommunity(path->attr),
+					    false, true),
+			     " ",
 			     &communities, &num);
 		for (int i = 0; i < num; i++) {
 			const char *com2alias =
@@ -4069,6 +4074,9 @@ static void bgp_route_map_process_update(struct bgp *bgp, const char *rmap_name,
 
 	map = route_map_lookup_by_name(rmap_name);
 
+	/* condition-maps may have been edited or deleted */
+	bgp_conditional_adv_maps_reset(bgp);
+
 	for (ALL_LIST_ELEMENTS(bgp->peer, node, nnode, peer)) {
 
 		/* Ignore dummy peer-group structure */
@@ -4265,6 +4273,13 @@ static void bgp_route_map_process_update_cb(char *rmap_name)
 	struct listnode *node, *nnode;
 	struct bgp *bgp;
 
+	/* re-applied with identical content, nothing to re-evaluate */
+	if (!route_map_content_changed(rmap_name)) {
+		for (ALL_LIST_ELEMENTS(bm->bgp, node, nnode, bgp))
+			update_group_route_map_unchanged(bgp, rmap_name);
+		return;
+	}
+
 	for (ALL_LIST_ELEMENTS(bm->bgp, node, nnode, bgp)) {
 		bgp_route_map_process_update(bgp, rmap_name, true);
 
@@ -4302,7 +4317,7 @@ static void bgp_route_map_mark_update(const char *rmap_name)
 		for (ALL_LIST_ELEMENTS(bm->bgp, node, nnode, bgp))
 			update_group_policy_update(bgp, BGP_POLICY_ROUTE_MAP,
 						   rmap_name, true, 1);
-	} else {
+	} else if (route_map_content_changed(rmap_name)) {
 		for (ALL_LIST_ELEMENTS(bm->bgp, node, nnode, bgp)) {
 			bgp_route_map_process_update(bgp, rmap_name, false);
 #ifdef ENABLE_BGP_VNC
@@ -4330,6 +4345,31 @@ static void bgp_route_map_delete(const char *rmap_name)
 	route_map_notify_dependencies(rmap_name, RMAP_EVENT_MATCH_DELETED);
 }
 
+/* Content hash of the BGP specific lists route-map rules depend on. */
+static bool bgp_route_map_content(route_map_event_t type, const char *name,
+				  uint32_t *hash)
+{
+	int master;
+
+	switch (type) {
+	case RMAP_EVENT_CLIST_ADDED:
+		master = COMMUNITY_LIST_MASTER;
+		break;
+	case RMAP_EVENT_ECLIST_ADDED:
+		master = EXTCOMMUNITY_LIST_MASTER;
+		break;
+	case RMAP_EVENT_LLIST_ADDED:
+		master = LARGE_COMMUNITY_LIST_MASTER;
+		break;
+	default:
+		return false;
+	}
+
+	*hash = community_list_hash(
+		community_list_lookup(bgp_clist, name, 0, master));
+	return true;
+}
+
 static void bgp_route_map_event(const char *rmap_name)
 {
 	if (route_map_mark_updated(rmap_name) == 0)
@@ -7007,6 +7047,7 @@ void bgp_route_map_init(void)
 	route_map_add_hook(bgp_route_map_add);
 	route_map_delete_hook(bgp_route_map_delete);
 	route_map_event_hook(bgp_route_map_event);
+	route_map_content_hook(bgp_route_map_content);
 
 	route_map_match_interface_hook(generic_match_add);
 	route_map_no_match_interface_hook(generic_match_delete);
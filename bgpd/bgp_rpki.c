@@ -387,32 +387,78 @@ static void pfx_record_to_prefix(struct pfx_record *record,
 	}
 }
 
+PREDECL_DLIST(rpki_revalidate_queue);
+
 struct rpki_revalidate_prefix {
+	struct rpki_revalidate_queue_item item;
+
 	struct bgp *bgp;
 	struct prefix prefix;
 	afi_t afi;
 	safi_t safi;
 };
 
+DECLARE_DLIST(rpki_revalidate_queue, struct rpki_revalidate_prefix, item);
+
+/*
+ * ROA changes are queued here and handled RPKI_REVALIDATE_PREFIX_MAX at a
+ * time, so a burst of changes from the cache neither loses any of them nor
+ * blocks other events for long.
+ */
+static struct rpki_revalidate_queue_head rpki_revalidate_queue;
+static struct thread *t_rpki_revalidate;
+
+#define RPKI_REVALIDATE_PREFIX_MAX 64
+
 static void rpki_revalidate_prefix(struct thread *thread)
 {
-	struct rpki_revalidate_prefix *rrp = THREAD_ARG(thread);
+	struct rpki_revalidate_prefix *rrp;
 	struct bgp_dest *match, *node;
+	unsigned int count = 0;
+
+	while (count++ < RPKI_REVALIDATE_PREFIX_MAX
+	       && (rrp = rpki_revalidate_queue_pop(&rpki_revalidate_queue))) {
+		match = bgp_table_subtree_lookup(
+			rrp->bgp->rib[rrp->afi][rrp->safi], &rrp->prefix);
 
-	match = bgp_table_subtree_lookup(rrp->bgp->rib[rrp->afi][rrp->safi],
-					 &rrp->prefix);
+		node = match;
 
-	node = match;
+		while (node) {
+			if (bgp_dest_has_bgp_path_info_data(node)) {
+				revalidate_bgp_node(node, rrp->afi, rrp->safi);
+			}
 
-	while (node) {
-		if (bgp_dest_has_bgp_path_info_data(node)) {
-			revalidate_bgp_node(node, rrp->afi, rrp->safi);
+			node = bgp_route_next_until(node, match);
 		}
 
-		node = bgp_route_next_until(node, match);
+		XFREE(MTYPE_BGP_RPKI_REVALIDATE, rrp);
 	}
 
-	XFREE(MTYPE_BGP_RPKI_REVALIDATE, rrp);
+	if (rpki_revalidate_queue_count(&rpki_revalidate_queue))
+		thread_add_event(bm->master, rpki_revalidate_prefix, NULL, 0,
+				 &t_rpki_revalidate);
+}
+
+static void rpki_revalidate_queue_flush(struct bgp *bgp)
+{
+	struct rpki_revalidate_prefix *rrp;
+
+	frr_each_safe (rpki_revalidate_queue, &rpki_revalidate_queue, rrp) {
+		if (bgp && rrp->bgp != bgp)
+			continue;
+
+		rpki_revalidate_queue_del(&rpki_revalidate_queue, rrp);
+		XFREE(MTYPE_BGP_RPKI_REVALIDATE, rrp);
+	}
+
+	if (!rpki_revalidate_queue_count(&rpki_revalidate_queue))
+		THREAD_OFF(t_rpki_revalidate);
+}
+
+static int rpki_bgp_inst_delete(struct bgp *bgp)
+{
+	rpki_revalidate_queue_flush(bgp);
+	return 0;
 }
 
 static void bgpd_sync_callback(struct thread *thread)
@@ -432,6 +478,7 @@ static void bgpd_sync_callback(struct thread *thread)
 
 		atomic_store_explicit(&rtr_update_overflow, 0,
 				      memory_order_seq_cst);
+		rpki_revalidate_queue_flush(NULL);
 		revalidate_all_routes();
 		return;
 	}
@@ -461,10 +508,13 @@ static void bgpd_sync_callback(struct thread *thread)
 			rrp->prefix = prefix;
 			rrp->afi = afi;
 			rrp->safi = safi;
-			thread_add_event(bm->master, rpki_revalidate_prefix,
-					 rrp, 0, &bgp->t_revalidate[afi][safi]);
+			rpki_revalidate_queue_add_tail(&rpki_revalidate_queue,
+						       rrp);
 		}
 	}
+
+	thread_add_event(bm->master, rpki_revalidate_prefix, NULL, 0,
+			 &t_rpki_revalidate);
 }
 
 static void revalidate_bgp_node(struct bgp_dest *bgp_dest, afi_t afi,
@@ -614,6 +664,8 @@ static int bgp_rpki_init(struct thread_master *master)
 	cache_list = list_new();
 	cache_list->del = (void (*)(void *)) & free_cache;
 
+	rpki_revalidate_queue_init(&rpki_revalidate_queue);
+
 	polling_period = POLLING_PERIOD_DEFAULT;
 	expire_interval = EXPIRE_INTERVAL_DEFAULT;
 	retry_interval = RETRY_INTERVAL_DEFAULT;
@@ -627,6 +679,9 @@ static int bgp_rpki_fini(void)
 	stop();
 	list_delete(&cache_list);
 
+	rpki_revalidate_queue_flush(NULL);
+	rpki_revalidate_queue_fini(&rpki_revalidate_queue);
+
 	close(rpki_sync_socket_rtr);
 	close(rpki_sync_socket_bgpd);
 
@@ -640,6 +695,7 @@ static int bgp_rpki_module_init(void)
 	hook_register(bgp_rpki_prefix_status, rpki_validate_prefix);
 	hook_register(frr_late_init, bgp_rpki_init);
 	hook_register(frr_early_fini, bgp_rpki_fini);
+	hook_register(bgp_inst_delete, rpki_bgp_inst_delete);
 
 	return 0;
 }
@@ -0,0 +1,953 @@
+/*
+ * BGP route target constraint (RFC 4684)
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "hash.h"
+#include "jhash.h"
+#include "memory.h"
+#include "stream.h"
+#include "thread.h"
+#include "typesafe.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_errors.h"
+#include "bgpd/bgp_evpn_private.h"
+#include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_rtc.h"
+
+#include "bgpd/bgp_rtc_clippy.c"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_RTC, "BGP route target membership");
+DEFINE_MTYPE_STATIC(BGPD, BGP_RTC_FILTER, "BGP route target filter");
+
+/* NLRI prefix lengths: the default membership, origin AS only, and a
+ * full route target
+ */
+#define BGP_RTC_PLEN_DEFAULT 0
+#define BGP_RTC_PLEN_AS 32
+#define BGP_RTC_PLEN_MAX 96
+
+/* a membership without the origin AS, plen counts the origin AS bits and
+ * rt bits beyond it are zero
+ */
+struct bgp_rtc_nlri {
+	uint8_t plen;
+	uint8_t rt[ECOMMUNITY_SIZE];
+};
+
+PREDECL_HASH(bgp_rtc_routes);
+
+/* membership received from a peer */
+struct bgp_rtc_route {
+	struct bgp_rtc_routes_item item;
+
+	as_t origin;
+	struct bgp_rtc_nlri nlri;
+};
+
+struct bgp_rtc_peer {
+	struct bgp_rtc_routes_head routes;
+
+	/* End-of-RIB received, or waited long enough for it */
+	bool eor;
+
+	struct thread *t_update;
+	struct thread *t_eor;
+};
+
+struct bgp_rtc_filter {
+	unsigned long refcnt;
+	uint32_t key;
+
+	/* default or origin AS only membership, everything matches */
+	bool all;
+
+	/* sorted by length, the full route targets come last and are
+	 * searched, the shorter ones before them are compared one by one
+	 */
+	uint32_t count;
+	uint32_t partial;
+	struct bgp_rtc_nlri nlri[];
+};
+
+/* a sorted, duplicate free array of memberships */
+struct bgp_rtc_set {
+	uint32_t count;
+	uint32_t size;
+	struct bgp_rtc_nlri *nlri;
+};
+
+struct bgp_rtc {
+	/* local memberships, as advertised to peers */
+	struct bgp_rtc_set local;
+
+	struct thread *t_local;
+};
+
+static struct hash *bgp_rtc_filters;
+
+static int bgp_rtc_nlri_cmp(const void *va, const void *vb)
+{
+	const struct bgp_rtc_nlri *a = va, *b = vb;
+
+	if (a->plen != b->plen)
+		return numcmp(a->plen, b->plen);
+	return memcmp(a->rt, b->rt, sizeof(a->rt));
+}
+
+static int bgp_rtc_route_cmp(const struct bgp_rtc_route *a,
+			     const struct bgp_rtc_route *b)
+{
+	if (a->origin != b->origin)
+		return numcmp(a->origin, b->origin);
+	return bgp_rtc_nlri_cmp(&a->nlri, &b->nlri);
+}
+
+static uint32_t bgp_rtc_route_hash(const struct bgp_rtc_route *r)
+{
+	return jhash(&r->nlri, sizeof(r->nlri), r->origin);
+}
+
+DECLARE_HASH(bgp_rtc_routes, struct bgp_rtc_route, item, bgp_rtc_route_cmp,
+	     bgp_rtc_route_hash);
+
+static void bgp_rtc_set_add(struct bgp_rtc_set *set,
+			    const struct bgp_rtc_nlri *nlri)
+{
+	if (set->count == set->size) {
+		set->size = MAX(set->size * 2, 16U);
+		set->nlri = XREALLOC(MTYPE_BGP_RTC, set->nlri,
+				     set->size * sizeof(*set->nlri));
+	}
+	set->nlri[set->count++] = *nlri;
+}
+
+static void bgp_rtc_set_sort(struct bgp_rtc_set *set)
+{
+	uint32_t i, j;
+
+	if (!set->count)
+		return;
+
+	qsort(set->nlri, set->count, sizeof(*set->nlri), bgp_rtc_nlri_cmp);
+	for (i = 1, j = 0; i < set->count; i++)
+		if (bgp_rtc_nlri_cmp(&set->nlri[j], &set->nlri[i]))
+			set->nlri[++j] = set->nlri[i];
+	set->count = j + 1;
+}
+
+static void bgp_rtc_set_fini(struct bgp_rtc_set *set)
+{
+	XFREE(MTYPE_BGP_RTC, set->nlri);
+	set->count = set->size = 0;
+}
+
+static bool bgp_rtc_is_rt(const uint8_t *val)
+{
+	if (val[1] != ECOMMUNITY_ROUTE_TARGET)
+		return false;
+	return val[0] == ECOMMUNITY_ENCODE_AS || val[0] == ECOMMUNITY_ENCODE_IP
+	       || val[0] == ECOMMUNITY_ENCODE_AS4;
+}
+
+static void bgp_rtc_set_add_rt(struct bgp_rtc_set *set, const void *val)
+{
+	struct bgp_rtc_nlri nlri = { .plen = BGP_RTC_PLEN_MAX };
+
+	if (!bgp_rtc_is_rt(val))
+		return;
+	memcpy(nlri.rt, val, sizeof(nlri.rt));
+	bgp_rtc_set_add(set, &nlri);
+}
+
+/*
+ * Filters
+ */
+static unsigned int bgp_rtc_filter_hash_key(const void *arg)
+{
+	const struct bgp_rtc_filter *f = arg;
+
+	return f->key;
+}
+
+static bool bgp_rtc_filter_hash_cmp(const void *va, const void *vb)
+{
+	const struct bgp_rtc_filter *a = va, *b = vb;
+
+	return a->all == b->all && a->count == b->count
+	       && !memcmp(a->nlri, b->nlri, a->count * sizeof(a->nlri[0]));
+}
+
+/* an interned filter for these memberships, with a reference */
+static struct bgp_rtc_filter *bgp_rtc_filter_get(const struct bgp_rtc_set *set)
+{
+	struct bgp_rtc_filter *f, *found;
+	uint32_t count = set->count;
+	bool all;
+
+	/* sorted by length, a default or origin AS only membership is first */
+	all = count && set->nlri[0].plen <= BGP_RTC_PLEN_AS;
+	if (all)
+		count = 0;
+
+	f = XCALLOC(MTYPE_BGP_RTC_FILTER,
+		    sizeof(*f) + count * sizeof(f->nlri[0]));
+	f->all = all;
+	f->count = count;
+	memcpy(f->nlri, set->nlri, count * sizeof(f->nlri[0]));
+	while (f->partial < count
+	       && f->nlri[f->partial].plen < BGP_RTC_PLEN_MAX)
+		f->partial++;
+	f->key = jhash(f->nlri, count * sizeof(f->nlri[0]), all);
+
+	found = hash_get(bgp_rtc_filters, f, hash_alloc_intern);
+	if (found != f)
+		XFREE(MTYPE_BGP_RTC_FILTER, f);
+	found->refcnt++;
+	return found;
+}
+
+struct bgp_rtc_filter *bgp_rtc_filter_ref(struct bgp_rtc_filter *f)
+{
+	if (f)
+		f->refcnt++;
+	return f;
+}
+
+void bgp_rtc_filter_unref(struct bgp_rtc_filter **fp)
+{
+	struct bgp_rtc_filter *f = *fp;
+
+	if (!f)
+		return;
+
+	*fp = NULL;
+	if (--f->refcnt)
+		return;
+
+	hash_release(bgp_rtc_filters, f);
+	XFREE(MTYPE_BGP_RTC_FILTER, f);
+}
+
+uint32_t bgp_rtc_filter_key(const struct bgp_rtc_filter *f)
+{
+	return f ? f->key : 0;
+}
+
+static bool bgp_rtc_nlri_match(const struct bgp_rtc_nlri *nlri,
+			       const uint8_t *rt)
+{
+	unsigned int bits = nlri->plen - BGP_RTC_PLEN_AS;
+	unsigned int bytes = bits / 8;
+	uint8_t mask = 0xff << (8 - bits % 8);
+
+	if (memcmp(nlri->rt, rt, bytes))
+		return false;
+	return !(bits % 8) || !((nlri->rt[bytes] ^ rt[bytes]) & mask);
+}
+
+bool bgp_rtc_filter_match(const struct bgp_rtc_filter *f,
+			  const struct ecommunity *ecom)
+{
+	struct bgp_rtc_nlri key = { .plen = BGP_RTC_PLEN_MAX };
+	const uint8_t *val;
+	bool has_rt = false;
+	uint32_t i, j;
+
+	if (f->all)
+		return true;
+	/* routes without route targets are not constrained */
+	if (!ecom || ecom->unit_size != ECOMMUNITY_SIZE)
+		return true;
+
+	for (i = 0; i < ecom->size; i++) {
+		val = ecom->val + i * ECOMMUNITY_SIZE;
+		if (!bgp_rtc_is_rt(val))
+			continue;
+
+		has_rt = true;
+		memcpy(key.rt, val, sizeof(key.rt));
+		if (bsearch(&key, f->nlri + f->partial, f->count - f->partial,
+			    sizeof(key), bgp_rtc_nlri_cmp))
+			return true;
+		for (j = 0; j < f->partial; j++)
+			if (bgp_rtc_nlri_match(&f->nlri[j], val))
+				return true;
+	}
+
+	return !has_rt;
+}
+
+/*
+ * Sending memberships
+ */
+static struct stream *bgp_rtc_packet_start(struct peer *peer, bool withdraw,
+					   size_t *attrlen_pos,
+					   size_t *mplen_pos)
+{
+	struct stream *s = stream_new(peer->max_packet_size);
+	struct aspath *aspath;
+	size_t aspath_pos;
+
+	bgp_packet_set_marker(s, BGP_MSG_UPDATE);
+	/* withdrawn routes length */
+	stream_putw(s, 0);
+	*attrlen_pos = stream_get_endp(s);
+	stream_putw(s, 0);
+
+	if (withdraw) {
+		stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_EXTLEN);
+		stream_putc(s, BGP_ATTR_MP_UNREACH_NLRI);
+		*mplen_pos = stream_get_endp(s);
+		stream_putw(s, 0);
+		stream_putw(s, IANA_AFI_IPV4);
+		stream_putc(s, IANA_SAFI_RTC);
+		return s;
+	}
+
+	stream_putc(s, BGP_ATTR_FLAG_TRANS);
+	stream_putc(s, BGP_ATTR_ORIGIN);
+	stream_putc(s, 1);
+	stream_putc(s, BGP_ORIGIN_IGP);
+
+	/* memberships are originated here, only our AS towards EBGP */
+	aspath = aspath_empty();
+	if (peer->sort == BGP_PEER_EBGP)
+		aspath = aspath_add_seq(aspath, peer->local_as);
+	stream_putc(s, BGP_ATTR_FLAG_TRANS | BGP_ATTR_FLAG_EXTLEN);
+	stream_putc(s, BGP_ATTR_AS_PATH);
+	aspath_pos = stream_get_endp(s);
+	stream_putw(s, 0);
+	stream_putw_at(s, aspath_pos,
+		       aspath_put(s, aspath,
+				  CHECK_FLAG(peer->cap, PEER_CAP_AS4_RCV)));
+	aspath_free(aspath);
+
+	if (peer->sort != BGP_PEER_EBGP) {
+		stream_putc(s, BGP_ATTR_FLAG_TRANS);
+		stream_putc(s, BGP_ATTR_LOCAL_PREF);
+		stream_putc(s, 4);
+		stream_putl(s, peer->bgp->default_local_pref);
+	}
+
+	stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_EXTLEN);
+	stream_putc(s, BGP_ATTR_MP_REACH_NLRI);
+	*mplen_pos = stream_get_endp(s);
+	stream_putw(s, 0);
+	stream_putw(s, IANA_AFI_IPV4);
+	stream_putc(s, IANA_SAFI_RTC);
+	/* our address on the session, as for the VPN routes */
+	if (peer->nexthop.v4.s_addr == INADDR_ANY
+	    && peer->su.sa.sa_family == AF_INET6) {
+		stream_putc(s, IPV6_MAX_BYTELEN);
+		stream_put(s, &peer->nexthop.v6_global, IPV6_MAX_BYTELEN);
+	} else {
+		stream_putc(s, IPV4_MAX_BYTELEN);
+		stream_put_in_addr(s, &peer->nexthop.v4);
+	}
+	/* SNPA */
+	stream_putc(s, 0);
+
+	return s;
+}
+
+static void bgp_rtc_packet_end(struct peer *peer, struct stream *s,
+			       size_t attrlen_pos, size_t mplen_pos)
+{
+	size_t endp = stream_get_endp(s);
+
+	stream_putw_at(s, mplen_pos, endp - mplen_pos - 2);
+	stream_putw_at(s, attrlen_pos, endp - attrlen_pos - 2);
+	bgp_packet_set_size(s);
+	bgp_packet_send(peer, s);
+}
+
+static void bgp_rtc_send(struct peer *peer, const struct bgp_rtc_set *set,
+			 bool withdraw)
+{
+	uint8_t buf[BGP_RTC_PLEN_MAX / 8];
+	size_t attrlen_pos = 0, mplen_pos = 0, len;
+	struct stream *s = NULL;
+	uint32_t origin;
+	uint32_t i;
+
+	for (i = 0; i < set->count; i++) {
+		len = PSIZE(set->nlri[i].plen);
+		if (s && STREAM_WRITEABLE(s) < len + 1) {
+			bgp_rtc_packet_end(peer, s, attrlen_pos, mplen_pos);
+			s = NULL;
+		}
+		if (!s)
+			s = bgp_rtc_packet_start(peer, withdraw, &attrlen_pos,
+						 &mplen_pos);
+
+		origin = htonl(peer->bgp->as);
+		memcpy(buf, &origin, sizeof(origin));
+		memcpy(buf + sizeof(origin), set->nlri[i].rt,
+		       sizeof(set->nlri[i].rt));
+		stream_putc(s, set->nlri[i].plen);
+		stream_put(s, buf, len);
+	}
+
+	if (s)
+		bgp_rtc_packet_end(peer, s, attrlen_pos, mplen_pos);
+
+	if (set->count && bgp_debug_neighbor_events(peer))
+		zlog_debug("%pBP: sent %u route target memberships%s", peer,
+			   set->count, withdraw ? " withdrawn" : "");
+}
+
+/* an empty MP_UNREACH_NLRI */
+static void bgp_rtc_send_eor(struct peer *peer)
+{
+	size_t attrlen_pos, mplen_pos;
+	struct stream *s;
+
+	s = bgp_rtc_packet_start(peer, true, &attrlen_pos, &mplen_pos);
+	bgp_rtc_packet_end(peer, s, attrlen_pos, mplen_pos);
+}
+
+/*
+ * Local memberships
+ */
+static bool bgp_rtc_local_all(struct bgp *bgp)
+{
+	struct listnode *node;
+	struct peer *peer;
+	afi_t afi;
+	bool vpn[AFI_MAX] = {};
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		if (peer_af_flag_check(peer, AFI_L2VPN, SAFI_EVPN,
+				       PEER_FLAG_REFLECTOR_CLIENT))
+			return true;
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+			if (!peer->afc[afi][SAFI_MPLS_VPN])
+				continue;
+			if (peer_af_flag_check(peer, afi, SAFI_MPLS_VPN,
+					       PEER_FLAG_REFLECTOR_CLIENT))
+				return true;
+			vpn[afi] = true;
+		}
+	}
+
+	/* all VPN routes are kept anyway, might as well receive them */
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+		if (vpn[afi]
+		    && CHECK_FLAG(bgp->af_flags[afi][SAFI_MPLS_VPN],
+				  BGP_VPNVX_RETAIN_ROUTE_TARGET_ALL))
+			return true;
+
+	return false;
+}
+
+static void bgp_rtc_collect_irt(struct hash_bucket *bucket, void *arg)
+{
+	struct irt_node *irt = bucket->data;
+
+	bgp_rtc_set_add_rt(arg, irt->rt.val);
+}
+
+static void bgp_rtc_collect_vrf_irt(struct hash_bucket *bucket, void *arg)
+{
+	struct vrf_irt_node *irt = bucket->data;
+
+	bgp_rtc_set_add_rt(arg, irt->rt.val);
+}
+
+static void bgp_rtc_local_collect(struct bgp *bgp, struct bgp_rtc_set *set)
+{
+	struct bgp_rtc_nlri def = { .plen = BGP_RTC_PLEN_DEFAULT };
+	struct ecommunity *ecom;
+	struct listnode *node;
+	struct bgp *bgp_vrf, *bgp_evpn;
+	afi_t afi;
+	uint32_t i;
+
+	if (bgp_rtc_local_all(bgp)) {
+		bgp_rtc_set_add(set, &def);
+		return;
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp_vrf)) {
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+			ecom = bgp_vrf->vpn_policy[afi]
+				       .rtlist[BGP_VPN_POLICY_DIR_FROMVPN];
+			if (!ecom)
+				continue;
+			/* IPv6 route targets can't be constrained */
+			if (ecom->unit_size != ECOMMUNITY_SIZE) {
+				bgp_rtc_set_fini(set);
+				bgp_rtc_set_add(set, &def);
+				return;
+			}
+			for (i = 0; i < ecom->size; i++)
+				bgp_rtc_set_add_rt(
+					set, ecom->val + i * ECOMMUNITY_SIZE);
+		}
+	}
+
+	bgp_evpn = bgp_get_evpn();
+	if (bgp_evpn) {
+		if (bgp_evpn->import_rt_hash)
+			hash_iterate(bgp_evpn->import_rt_hash,
+				     bgp_rtc_collect_irt, set);
+		if (bgp_evpn->vrf_import_rt_hash)
+			hash_iterate(bgp_evpn->vrf_import_rt_hash,
+				     bgp_rtc_collect_vrf_irt, set);
+	}
+
+	bgp_rtc_set_sort(set);
+}
+
+/* recompute the local memberships, and update peers with the difference */
+static void bgp_rtc_local_update(struct bgp *bgp)
+{
+	struct bgp_rtc *rtc = bgp->rtc;
+	struct bgp_rtc_set set = {}, add = {}, del = {};
+	struct listnode *node;
+	struct peer *peer;
+	uint32_t i = 0, j = 0;
+	int cmp;
+
+	THREAD_OFF(rtc->t_local);
+
+	bgp_rtc_local_collect(bgp, &set);
+
+	while (i < rtc->local.count || j < set.count) {
+		if (i == rtc->local.count)
+			cmp = 1;
+		else if (j == set.count)
+			cmp = -1;
+		else
+			cmp = bgp_rtc_nlri_cmp(&rtc->local.nlri[i],
+					       &set.nlri[j]);
+
+		if (cmp < 0)
+			bgp_rtc_set_add(&del, &rtc->local.nlri[i++]);
+		else if (cmp > 0)
+			bgp_rtc_set_add(&add, &set.nlri[j++]);
+		else
+			i++, j++;
+	}
+
+	bgp_rtc_set_fini(&rtc->local);
+	rtc->local = set;
+
+	if (add.count || del.count) {
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+			if (!peer->rtc || !peer_established(peer))
+				continue;
+			bgp_rtc_send(peer, &del, true);
+			bgp_rtc_send(peer, &add, false);
+		}
+	}
+
+	bgp_rtc_set_fini(&add);
+	bgp_rtc_set_fini(&del);
+}
+
+static void bgp_rtc_local_timer(struct thread *thread)
+{
+	bgp_rtc_local_update(THREAD_ARG(thread));
+}
+
+void bgp_rtc_local_changed(void)
+{
+	struct listnode *node;
+	struct bgp *bgp;
+
+	if (!bm || bm->terminating)
+		return;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		if (bgp->rtc)
+			thread_add_timer(bm->master, bgp_rtc_local_timer, bgp,
+					 BGP_RTC_LOCAL_DELAY,
+					 &bgp->rtc->t_local);
+}
+
+/*
+ * Peers
+ */
+bool bgp_rtc_wanted(struct peer *peer)
+{
+	if (!peer->bgp->rtc)
+		return false;
+	return peer->afc[AFI_IP][SAFI_MPLS_VPN]
+	       || peer->afc[AFI_IP6][SAFI_MPLS_VPN]
+	       || peer->afc[AFI_L2VPN][SAFI_EVPN];
+}
+
+/* rebuild the peer's filter, and re-evaluate what it is sent */
+static void bgp_rtc_peer_update(struct thread *thread)
+{
+	struct peer *peer = THREAD_ARG(thread);
+	struct bgp_rtc_set set = {};
+	struct bgp_rtc_route *route;
+	struct bgp_rtc_filter *filter;
+
+	frr_each (bgp_rtc_routes, &peer->rtc->routes, route)
+		bgp_rtc_set_add(&set, &route->nlri);
+	bgp_rtc_set_sort(&set);
+	filter = bgp_rtc_filter_get(&set);
+	bgp_rtc_set_fini(&set);
+
+	if (filter == peer->rtc_filter) {
+		bgp_rtc_filter_unref(&filter);
+		return;
+	}
+
+	if (bgp_debug_neighbor_events(peer))
+		zlog_debug("%pBP: route target filter now %s%u memberships",
+			   peer, filter->all ? "all routes, " : "",
+			   filter->count);
+
+	bgp_rtc_filter_unref(&peer->rtc_filter);
+	peer->rtc_filter = filter;
+
+	if (peer->afc_nego[AFI_IP][SAFI_MPLS_VPN])
+		peer_on_policy_change(peer, AFI_IP, SAFI_MPLS_VPN, 1);
+	if (peer->afc_nego[AFI_IP6][SAFI_MPLS_VPN])
+		peer_on_policy_change(peer, AFI_IP6, SAFI_MPLS_VPN, 1);
+	if (peer->afc_nego[AFI_L2VPN][SAFI_EVPN])
+		peer_on_policy_change(peer, AFI_L2VPN, SAFI_EVPN, 1);
+}
+
+static void bgp_rtc_peer_changed(struct peer *peer)
+{
+	if (peer->rtc->eor)
+		thread_add_event(bm->master, bgp_rtc_peer_update, peer, 0,
+				 &peer->rtc->t_update);
+}
+
+static void bgp_rtc_peer_eor(struct peer *peer)
+{
+	if (peer->rtc->eor)
+		return;
+
+	THREAD_OFF(peer->rtc->t_eor);
+	peer->rtc->eor = true;
+	bgp_rtc_peer_changed(peer);
+}
+
+static void bgp_rtc_eor_timer(struct thread *thread)
+{
+	struct peer *peer = THREAD_ARG(thread);
+
+	zlog_info("%pBP: no route target membership End-of-RIB after %us, using the %zu memberships received",
+		  peer, BGP_RTC_EOR_TIMEOUT,
+		  bgp_rtc_routes_count(&peer->rtc->routes));
+	bgp_rtc_peer_eor(peer);
+}
+
+void bgp_rtc_peer_established(struct peer *peer)
+{
+	struct bgp *bgp = peer->bgp;
+	struct bgp_rtc_set empty = {};
+	struct bgp_rtc_peer *rtc;
+
+	bgp_rtc_peer_reset(peer);
+	if (!bgp_rtc_active(peer) || !bgp->rtc)
+		return;
+
+	/* send what is configured right now */
+	bgp_rtc_local_update(bgp);
+
+	rtc = XCALLOC(MTYPE_BGP_RTC, sizeof(*rtc));
+	bgp_rtc_routes_init(&rtc->routes);
+	peer->rtc = rtc;
+
+	/* nothing with a route target until the peer's memberships are in */
+	peer->rtc_filter = bgp_rtc_filter_get(&empty);
+	thread_add_timer(bm->master, bgp_rtc_eor_timer, peer,
+			 BGP_RTC_EOR_TIMEOUT, &rtc->t_eor);
+
+	bgp_rtc_send(peer, &bgp->rtc->local, false);
+	bgp_rtc_send_eor(peer);
+}
+
+void bgp_rtc_peer_reset(struct peer *peer)
+{
+	struct bgp_rtc_peer *rtc = peer->rtc;
+	struct bgp_rtc_route *route;
+
+	bgp_rtc_filter_unref(&peer->rtc_filter);
+	if (!rtc)
+		return;
+
+	THREAD_OFF(rtc->t_update);
+	THREAD_OFF(rtc->t_eor);
+	while ((route = bgp_rtc_routes_pop(&rtc->routes)))
+		XFREE(MTYPE_BGP_RTC, route);
+	bgp_rtc_routes_fini(&rtc->routes);
+	XFREE(MTYPE_BGP_RTC, peer->rtc);
+}
+
+static bool bgp_rtc_nlri_parse(struct peer *peer, const uint8_t *pnt,
+			       bgp_size_t length, bool withdraw)
+{
+	const uint8_t *end = pnt + length;
+	struct bgp_rtc_route lookup, *route;
+	uint8_t buf[BGP_RTC_PLEN_MAX / 8];
+	uint32_t origin;
+	uint8_t plen;
+
+	while (pnt < end) {
+		plen = *pnt++;
+		if ((plen && plen < BGP_RTC_PLEN_AS) || plen > BGP_RTC_PLEN_MAX
+		    || pnt + PSIZE(plen) > end) {
+			flog_err(EC_BGP_UPDATE_RCV,
+				 "%pBP: malformed route target membership, prefix length %u",
+				 peer, plen);
+			return false;
+		}
+
+		memset(buf, 0, sizeof(buf));
+		memcpy(buf, pnt, PSIZE(plen));
+		pnt += PSIZE(plen);
+		if (plen % 8)
+			buf[plen / 8] &= 0xff << (8 - plen % 8);
+
+		memset(&lookup, 0, sizeof(lookup));
+		memcpy(&origin, buf, sizeof(origin));
+		lookup.origin = ntohl(origin);
+		lookup.nlri.plen = plen;
+		memcpy(lookup.nlri.rt, buf + sizeof(origin),
+		       sizeof(lookup.nlri.rt));
+
+		route = bgp_rtc_routes_find(&peer->rtc->routes, &lookup);
+		if (withdraw && route) {
+			bgp_rtc_routes_del(&peer->rtc->routes, route);
+			XFREE(MTYPE_BGP_RTC, route);
+		} else if (!withdraw && !route) {
+			route = XCALLOC(MTYPE_BGP_RTC, sizeof(*route));
+			route->origin = lookup.origin;
+			route->nlri = lookup.nlri;
+			bgp_rtc_routes_add(&peer->rtc->routes, route);
+		}
+	}
+
+	bgp_rtc_peer_changed(peer);
+	return true;
+}
+
+enum bgp_attr_parse_ret bgp_rtc_attr_parse(struct peer *peer,
+					   struct attr *attr, struct stream *s,
+					   bgp_size_t length, bool withdraw)
+{
+	struct bgp_rtc_peer *rtc = peer->rtc;
+	const uint8_t *nlri;
+	uint8_t nhlen;
+
+	if (!withdraw) {
+		/* nexthop length, nexthop, SNPA */
+		if (length < 2)
+			return BGP_ATTR_PARSE_ERROR_NOTIFYPLS;
+		nhlen = stream_getc(s);
+		if (nhlen + 2 > length)
+			return BGP_ATTR_PARSE_ERROR_NOTIFYPLS;
+		stream_forward_getp(s, nhlen);
+		(void)stream_getc(s);
+		length -= nhlen + 2;
+		attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_MP_REACH_NLRI);
+	} else
+		attr->flag |= ATTR_FLAG_BIT(BGP_ATTR_MP_UNREACH_NLRI);
+
+	nlri = stream_pnt(s);
+	stream_forward_getp(s, length);
+
+	/* not negotiated, or not configured any more */
+	if (!rtc)
+		return BGP_ATTR_PARSE_PROCEED;
+
+	if (withdraw && !length) {
+		if (bgp_debug_neighbor_events(peer))
+			zlog_debug("%pBP: route target membership End-of-RIB, %zu memberships",
+				   peer, bgp_rtc_routes_count(&rtc->routes));
+		bgp_rtc_peer_eor(peer);
+		return BGP_ATTR_PARSE_PROCEED;
+	}
+
+	if (!bgp_rtc_nlri_parse(peer, nlri, length, withdraw))
+		return BGP_ATTR_PARSE_ERROR_NOTIFYPLS;
+	return BGP_ATTR_PARSE_PROCEED;
+}
+
+/*
+ * Configuration
+ */
+void bgp_rtc_set(struct bgp *bgp, bool enable)
+{
+	struct listnode *node, *nnode;
+	struct peer *peer;
+
+	if (enable == !!bgp->rtc)
+		return;
+
+	if (enable) {
+		SET_FLAG(bgp->flags, BGP_FLAG_RTC);
+		bgp->rtc = XCALLOC(MTYPE_BGP_RTC, sizeof(*bgp->rtc));
+		bgp_rtc_local_collect(bgp, &bgp->rtc->local);
+	} else {
+		UNSET_FLAG(bgp->flags, BGP_FLAG_RTC);
+		bgp_rtc_delete(bgp);
+	}
+
+	/* the capability is only exchanged in the OPEN message */
+	for (ALL_LIST_ELEMENTS(bgp->peer, node, nnode, peer)) {
+		if (!peer->afc[AFI_IP][SAFI_MPLS_VPN]
+		    && !peer->afc[AFI_IP6][SAFI_MPLS_VPN]
+		    && !peer->afc[AFI_L2VPN][SAFI_EVPN])
+			continue;
+
+		peer->last_reset = PEER_DOWN_CAPABILITY_CHANGE;
+		if (BGP_IS_VALID_STATE_FOR_NOTIF(peer->status))
+			bgp_notify_send(peer, BGP_NOTIFY_CEASE,
+					BGP_NOTIFY_CEASE_CONFIG_CHANGE);
+		else
+			bgp_session_reset(peer);
+	}
+}
+
+void bgp_rtc_delete(struct bgp *bgp)
+{
+	if (!bgp->rtc)
+		return;
+
+	THREAD_OFF(bgp->rtc->t_local);
+	bgp_rtc_set_fini(&bgp->rtc->local);
+	XFREE(MTYPE_BGP_RTC, bgp->rtc);
+}
+
+void bgp_rtc_init(void)
+{
+	bgp_rtc_filters = hash_create(bgp_rtc_filter_hash_key,
+				      bgp_rtc_filter_hash_cmp,
+				      "BGP route target filters");
+}
+
+void bgp_rtc_finish(void)
+{
+	hash_clean(bgp_rtc_filters, NULL);
+	hash_free(bgp_rtc_filters);
+	bgp_rtc_filters = NULL;
+}
+
+static void bgp_rtc_nlri_str(const struct bgp_rtc_nlri *nlri, char *buf,
+			     size_t size)
+{
+	const uint8_t *rt = nlri->rt;
+	uint32_t as4;
+	uint16_t as2;
+	struct in_addr ip;
+
+	if (nlri->plen <= BGP_RTC_PLEN_AS) {
+		snprintf(buf, size, "default");
+		return;
+	}
+	if (nlri->plen < BGP_RTC_PLEN_MAX) {
+		snprintf(buf, size, "%02x%02x:%02x%02x%02x%02x%02x%02x/%u",
+			 rt[0], rt[1], rt[2], rt[3], rt[4], rt[5], rt[6], rt[7],
+			 nlri->plen - BGP_RTC_PLEN_AS);
+		return;
+	}
+
+	switch (rt[0]) {
+	case ECOMMUNITY_ENCODE_AS:
+		memcpy(&as2, rt + 2, sizeof(as2));
+		memcpy(&as4, rt + 4, sizeof(as4));
+		snprintf(buf, size, "RT:%u:%u", ntohs(as2), ntohl(as4));
+		break;
+	case ECOMMUNITY_ENCODE_IP:
+		memcpy(&ip, rt + 2, sizeof(ip));
+		memcpy(&as2, rt + 6, sizeof(as2));
+		snprintfrr(buf, size, "RT:%pI4:%u", &ip, ntohs(as2));
+		break;
+	default:
+		memcpy(&as4, rt + 2, sizeof(as4));
+		memcpy(&as2, rt + 6, sizeof(as2));
+		snprintf(buf, size, "RT:%u:%u", ntohl(as4), ntohs(as2));
+		break;
+	}
+}
+
+DEFPY(show_bgp_rtc, show_bgp_rtc_cmd,
+      "show bgp route-target-constraint [detail$detail]",
+      SHOW_STR
+      BGP_STR
+      "Route target constraint (RFC 4684)\n"
+      "Show memberships\n")
+{
+	struct bgp *bgp = bgp_get_default();
+	struct bgp_rtc_route *route;
+	struct listnode *node;
+	struct peer *peer;
+	char buf[64];
+	uint32_t i;
+
+	if (!bgp || !bgp->rtc) {
+		vty_out(vty, "Route target constraint not enabled\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Local memberships: %u%s\n", bgp->rtc->local.count,
+		bgp->rtc->t_local ? " (update pending)" : "");
+	for (i = 0; detail && i < bgp->rtc->local.count; i++) {
+		bgp_rtc_nlri_str(&bgp->rtc->local.nlri[i], buf, sizeof(buf));
+		vty_out(vty, "  %s\n", buf);
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+		if (!peer->rtc)
+			continue;
+
+		vty_out(vty, "Neighbor %s: %zu memberships, %s", peer->host,
+			bgp_rtc_routes_count(&peer->rtc->routes),
+			peer->rtc->eor ? "complete" : "End-of-RIB pending");
+		if (peer->rtc_filter->all)
+			vty_out(vty, ", sent all routes\n");
+		else
+			vty_out(vty, ", filter %u route targets\n",
+				peer->rtc_filter->count);
+
+		if (!detail)
+			continue;
+		frr_each (bgp_rtc_routes, &peer->rtc->routes, route) {
+			bgp_rtc_nlri_str(&route->nlri, buf, sizeof(buf));
+			vty_out(vty, "  %u %s\n", route->origin, buf);
+		}
+	}
+
+	return CMD_SUCCESS;
+}
+
+void bgp_rtc_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_bgp_rtc_cmd);
+}
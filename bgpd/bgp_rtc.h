@@ -0,0 +1,96 @@
+/*
+ * BGP route target constraint (RFC 4684)
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_BGP_RTC_H
+#define _FRR_BGP_RTC_H
+
+#include "bgpd/bgp_attr.h"
+
+/*
+ * Route target membership NLRI (IPv4, SAFI 132) are exchanged with peers
+ * that negotiated the capability, but not kept in a RIB:  each peer's
+ * memberships are reduced to a filter applied to VPN and EVPN routes
+ * sent to it.  Filters are interned, peers with the same memberships
+ * share one and stay in the same update-group.
+ *
+ * Until a peer's End-of-RIB for memberships arrives its filter is the
+ * empty one, that only lets routes without any route target through.
+ *
+ * Local memberships are the VRF and EVPN import route targets, or the
+ * default membership (all routes) on route reflectors and when all
+ * VPN routes are retained.
+ */
+
+/* wait this long for a peer's membership End-of-RIB, then go with what
+ * was received
+ */
+#define BGP_RTC_EOR_TIMEOUT 60
+/* coalesce local import route target changes */
+#define BGP_RTC_LOCAL_DELAY 1
+
+struct bgp_rtc_filter;
+struct ecommunity;
+
+extern void bgp_rtc_init(void);
+extern void bgp_rtc_finish(void);
+extern void bgp_rtc_vty_init(void);
+
+/* "bgp route-target-constraint", resets the VPN/EVPN sessions */
+extern void bgp_rtc_set(struct bgp *bgp, bool enable);
+extern void bgp_rtc_delete(struct bgp *bgp);
+
+/* to be advertised in the OPEN message */
+extern bool bgp_rtc_wanted(struct peer *peer);
+/* negotiated */
+static inline bool bgp_rtc_active(const struct peer *peer)
+{
+	return CHECK_FLAG(peer->cap, PEER_CAP_RTC_ADV)
+	       && CHECK_FLAG(peer->cap, PEER_CAP_RTC_RCV);
+}
+
+extern void bgp_rtc_peer_established(struct peer *peer);
+extern void bgp_rtc_peer_reset(struct peer *peer);
+
+/* MP_(UN)REACH_NLRI for IPv4 / route target constraint, s is positioned
+ * after AFI/SAFI and length is what is left of the attribute
+ */
+extern enum bgp_attr_parse_ret bgp_rtc_attr_parse(struct peer *peer,
+						  struct attr *attr,
+						  struct stream *s,
+						  bgp_size_t length,
+						  bool withdraw);
+
+/* import route targets changed somewhere */
+extern void bgp_rtc_local_changed(void);
+
+extern struct bgp_rtc_filter *bgp_rtc_filter_ref(struct bgp_rtc_filter *f);
+extern void bgp_rtc_filter_unref(struct bgp_rtc_filter **fp);
+extern uint32_t bgp_rtc_filter_key(const struct bgp_rtc_filter *f);
+/* may a route with these extended communities be sent */
+extern bool bgp_rtc_filter_match(const struct bgp_rtc_filter *f,
+				 const struct ecommunity *ecom);
+
+static inline bool bgp_rtc_safi(safi_t safi)
+{
+	return safi == SAFI_MPLS_VPN || safi == SAFI_EVPN;
+}
+
+#endif /* _FRR_BGP_RTC_H */
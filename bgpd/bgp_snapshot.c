@@ -0,0 +1,944 @@
+/*
+ * BGP RIB snapshot for fast restarts
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <sys/mman.h>
+
+#include "command.h"
+#include "jhash.h"
+#include "libfrr.h"
+#include "memory.h"
+#include "monotime.h"
+#include "sockunion.h"
+#include "stream.h"
+#include "thread.h"
+#include "typesafe.h"
+#include "vty.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_community.h"
+#include "bgpd/bgp_debug.h"
+#include "bgpd/bgp_ecommunity.h"
+#include "bgpd/bgp_lcommunity.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_snapshot.h"
+#include "bgpd/bgp_table.h"
+
+#include "bgpd/bgp_snapshot_clippy.c"
+
+DEFINE_MTYPE_STATIC(BGPD, BGP_SNAPSHOT, "BGP RIB snapshot");
+
+/* On disk format: a header, then records in the order they are needed
+ * on load;  a peer or attribute record precedes the first path using it.
+ * All integers are host order, the file is only read by the same build.
+ */
+#define BGP_SNAP_MAGIC 0x42475053 /* "BGPS" */
+#define BGP_SNAP_VERSION 1
+
+struct bgp_snap_hdr {
+	uint32_t magic;
+	uint32_t version;
+	/* layout check */
+	uint32_t attr_size;
+	uint32_t npeers;
+	uint32_t nattrs;
+	uint32_t npaths;
+};
+
+enum bgp_snap_rec_type {
+	BGP_SNAP_REC_PEER = 1,
+	BGP_SNAP_REC_ATTR,
+	BGP_SNAP_REC_PATH,
+};
+
+struct bgp_snap_rec {
+	uint16_t type;
+	uint16_t reserved;
+	/* length of the body following this */
+	uint32_t len;
+};
+
+/* followed by the instance name, without terminating NUL */
+#define BGP_SNAP_NAMSIZ 256
+
+struct bgp_snap_peer {
+	uint32_t family;
+	uint8_t addr[IPV6_MAX_BYTELEN];
+};
+
+#define BGP_SNAP_ASPATH (1U << 0)
+#define BGP_SNAP_COMMUNITY (1U << 1)
+#define BGP_SNAP_ECOMMUNITY (1U << 2)
+#define BGP_SNAP_LCOMMUNITY (1U << 3)
+#define BGP_SNAP_CLUSTER (1U << 4)
+
+/* followed by the wire format AS path (4 byte ASNs) and the community,
+ * extended, large community and cluster list values, in this order
+ */
+struct bgp_snap_attr {
+	uint64_t flag;
+	uint64_t aigp_metric;
+	struct in6_addr mp_nexthop_global;
+	struct in6_addr mp_nexthop_local;
+	struct in_addr nexthop;
+	struct in_addr mp_nexthop_global_in;
+	struct in_addr aggregator_addr;
+	struct in_addr originator_id;
+	uint32_t med;
+	uint32_t local_pref;
+	uint32_t weight;
+	uint32_t aggregator_as;
+	uint32_t tag;
+	uint32_t label_index;
+	uint32_t label;
+	uint32_t rmap_table_id;
+	uint32_t rmap_change_flags;
+	uint32_t link_bw;
+	uint32_t srte_color;
+	uint32_t otc;
+	int32_t nh_ifindex;
+	int32_t nh_lla_ifindex;
+	uint32_t nh_type;
+	uint32_t bh_type;
+	uint8_t origin;
+	uint8_t mp_nexthop_len;
+	uint8_t mp_nexthop_prefer_global;
+	uint8_t distance;
+	uint8_t ecom_ieee_disabled;
+	uint8_t reserved[3];
+
+	uint32_t present;
+	uint32_t aspath_len;
+	uint32_t community_len;
+	uint32_t ecommunity_len;
+	uint32_t lcommunity_len;
+	uint32_t cluster_len;
+};
+
+struct bgp_snap_path {
+	uint32_t peer;
+	uint32_t attr;
+	uint32_t addpath_rx_id;
+	uint8_t afi;
+	uint8_t safi;
+	uint8_t family;
+	uint8_t prefixlen;
+	uint8_t prefix[IPV6_MAX_BYTELEN];
+};
+
+/* pointer -> record index, while writing */
+PREDECL_HASH(bgp_snap_idx);
+
+struct bgp_snap_ref {
+	struct bgp_snap_idx_item item;
+	const void *ptr;
+	uint32_t index;
+};
+
+static int bgp_snap_ref_cmp(const struct bgp_snap_ref *a,
+			    const struct bgp_snap_ref *b)
+{
+	return numcmp((uintptr_t)a->ptr, (uintptr_t)b->ptr);
+}
+
+static uint32_t bgp_snap_ref_hash(const struct bgp_snap_ref *a)
+{
+	return jhash(&a->ptr, sizeof(a->ptr), 0x5d5a8a1c);
+}
+
+DECLARE_HASH(bgp_snap_idx, struct bgp_snap_ref, item, bgp_snap_ref_cmp,
+	     bgp_snap_ref_hash);
+
+/* peers with restored paths, until the stale timer */
+PREDECL_LIST(bgp_snap_peers);
+
+struct bgp_snap_peer_ref {
+	struct bgp_snap_peers_item item;
+	struct peer *peer;
+	bool afs[AFI_MAX][SAFI_MAX];
+};
+
+DECLARE_LIST(bgp_snap_peers, struct bgp_snap_peer_ref, item);
+
+static struct bgp_snapshot {
+	char *path;
+	unsigned int interval;
+
+	struct thread *t_load;
+	struct thread *t_write;
+	struct thread *t_stale;
+	/* only write after the old snapshot has been loaded */
+	bool loaded;
+
+	struct bgp_snap_peers_head peers;
+
+	/* last load */
+	uint32_t restored_paths;
+	uint32_t restored_attrs;
+	uint32_t load_errors;
+	int64_t load_usec;
+
+	/* last write */
+	time_t written;
+	uint32_t written_peers;
+	uint32_t written_attrs;
+	uint32_t written_paths;
+	uint32_t unsupported;
+	int64_t write_usec;
+	int write_errno;
+} snap;
+
+/* Attributes the snapshot can't represent, not expected on unicast */
+static bool bgp_snap_attr_supported(const struct attr *attr)
+{
+	static const struct bgp_route_evpn zero_overlay;
+	static const esi_t zero_esi;
+
+	if (bgp_attr_get_transit(attr) || bgp_attr_get_ipv6_ecommunity(attr)
+	    || attr->srv6_l3vpn || attr->srv6_vpn || attr->encap_subtlvs
+	    || bgp_attr_get_vnc_subtlvs(attr) || attr->encap_tunneltype
+	    || attr->es_flags)
+		return false;
+
+	if (memcmp(&attr->evpn_overlay, &zero_overlay, sizeof(zero_overlay))
+	    || memcmp(&attr->esi, &zero_esi, sizeof(zero_esi)))
+		return false;
+
+	return true;
+}
+
+static void bgp_snap_put_rec(FILE *fp, enum bgp_snap_rec_type type,
+			     const void *body, size_t len, const void *extra,
+			     size_t extra_len)
+{
+	struct bgp_snap_rec rec = {
+		.type = type,
+		.len = len + extra_len,
+	};
+
+	fwrite(&rec, sizeof(rec), 1, fp);
+	fwrite(body, len, 1, fp);
+	if (extra_len)
+		fwrite(extra, extra_len, 1, fp);
+}
+
+static void bgp_snap_put_peer(FILE *fp, struct peer *peer)
+{
+	struct bgp_snap_peer rec = {};
+	const char *name = peer->bgp->name ? peer->bgp->name : "";
+
+	rec.family = sockunion_family(&peer->su);
+	memcpy(rec.addr, sockunion_get_addr(&peer->su),
+	       sockunion_get_addrlen(&peer->su));
+
+	bgp_snap_put_rec(fp, BGP_SNAP_REC_PEER, &rec, sizeof(rec), name,
+			 strlen(name));
+}
+
+static void bgp_snap_put_attr(FILE *fp, struct stream *s,
+			      const struct attr *attr, struct peer *peer)
+{
+	struct bgp_snap_attr rec = {};
+	struct community *comm = bgp_attr_get_community(attr);
+	struct ecommunity *ecomm = bgp_attr_get_ecommunity(attr);
+	struct lcommunity *lcomm = bgp_attr_get_lcommunity(attr);
+	struct cluster_list *cluster = bgp_attr_get_cluster(attr);
+	int i;
+
+	rec.flag = attr->flag;
+	rec.aigp_metric = attr->aigp_metric;
+	rec.mp_nexthop_global = attr->mp_nexthop_global;
+	rec.mp_nexthop_local = attr->mp_nexthop_local;
+	rec.nexthop = attr->nexthop;
+	rec.mp_nexthop_global_in = attr->mp_nexthop_global_in;
+	rec.aggregator_addr = attr->aggregator_addr;
+	rec.originator_id = attr->originator_id;
+	rec.med = attr->med;
+	rec.local_pref = attr->local_pref;
+	rec.weight = attr->weight;
+	rec.aggregator_as = attr->aggregator_as;
+	rec.tag = attr->tag;
+	rec.label_index = attr->label_index;
+	rec.label = attr->label;
+	rec.rmap_table_id = attr->rmap_table_id;
+	rec.rmap_change_flags = attr->rmap_change_flags;
+	rec.link_bw = attr->link_bw;
+	rec.srte_color = attr->srte_color;
+	rec.otc = attr->otc;
+	rec.nh_ifindex = attr->nh_ifindex;
+	rec.nh_lla_ifindex = attr->nh_lla_ifindex;
+	rec.nh_type = attr->nh_type;
+	rec.bh_type = attr->bh_type;
+	rec.origin = attr->origin;
+	rec.mp_nexthop_len = attr->mp_nexthop_len;
+	rec.mp_nexthop_prefer_global = attr->mp_nexthop_prefer_global;
+	rec.distance = attr->distance;
+	/* as ecommunity_parse() was called when receiving it */
+	rec.ecom_ieee_disabled = !!CHECK_FLAG(
+		peer->flags, PEER_FLAG_DISABLE_LINK_BW_ENCODING_IEEE);
+
+	/* everything variable goes through the stream, in record order */
+	stream_reset(s);
+	if (attr->aspath) {
+		rec.present |= BGP_SNAP_ASPATH;
+		rec.aspath_len = aspath_put(s, attr->aspath, 1);
+	}
+	if (comm) {
+		rec.present |= BGP_SNAP_COMMUNITY;
+		rec.community_len = comm->size * COMMUNITY_SIZE;
+		for (i = 0; i < comm->size; i++)
+			stream_putl(s, comm->val[i]);
+	}
+	if (ecomm) {
+		rec.present |= BGP_SNAP_ECOMMUNITY;
+		rec.ecommunity_len = ecomm->size * ecomm->unit_size;
+		stream_put(s, ecomm->val, rec.ecommunity_len);
+	}
+	if (lcomm) {
+		rec.present |= BGP_SNAP_LCOMMUNITY;
+		rec.lcommunity_len = lcomm->size * LCOMMUNITY_SIZE;
+		stream_put(s, lcomm->val, rec.lcommunity_len);
+	}
+	if (cluster) {
+		rec.present |= BGP_SNAP_CLUSTER;
+		rec.cluster_len = cluster->length;
+		stream_put(s, cluster->list, rec.cluster_len);
+	}
+
+	bgp_snap_put_rec(fp, BGP_SNAP_REC_ATTR, &rec, sizeof(rec),
+			 stream_pnt(s), stream_get_endp(s));
+}
+
+static uint32_t bgp_snap_ref_get(struct bgp_snap_idx_head *head,
+				 const void *ptr, bool *added)
+{
+	struct bgp_snap_ref ref = { .ptr = ptr }, *found;
+
+	found = bgp_snap_idx_find(head, &ref);
+	*added = !found;
+	if (found)
+		return found->index;
+
+	found = XCALLOC(MTYPE_BGP_SNAPSHOT, sizeof(*found));
+	found->ptr = ptr;
+	found->index = bgp_snap_idx_count(head);
+	bgp_snap_idx_add(head, found);
+	return found->index;
+}
+
+static void bgp_snap_ref_fini(struct bgp_snap_idx_head *head)
+{
+	struct bgp_snap_ref *ref;
+
+	while ((ref = bgp_snap_idx_pop(head)))
+		XFREE(MTYPE_BGP_SNAPSHOT, ref);
+	bgp_snap_idx_fini(head);
+}
+
+static bool bgp_snap_path_wanted(struct bgp *bgp, struct bgp_path_info *pi)
+{
+	if (pi->type != ZEBRA_ROUTE_BGP || pi->sub_type != BGP_ROUTE_NORMAL)
+		return false;
+	if (CHECK_FLAG(pi->flags, BGP_PATH_REMOVED | BGP_PATH_HISTORY))
+		return false;
+	if (!pi->peer || pi->peer == bgp->peer_self
+	    || peer_dynamic_neighbor(pi->peer))
+		return false;
+	return true;
+}
+
+static void bgp_snap_put_table(FILE *fp, struct stream *s, struct bgp *bgp,
+			       afi_t afi, safi_t safi,
+			       struct bgp_snap_idx_head *peers,
+			       struct bgp_snap_idx_head *attrs)
+{
+	struct bgp_dest *dest;
+	struct bgp_path_info *pi;
+	struct bgp_snap_path rec;
+	const struct prefix *p;
+	bool added;
+
+	for (dest = bgp_table_top(bgp->rib[afi][safi]); dest;
+	     dest = bgp_route_next(dest)) {
+		p = bgp_dest_get_prefix(dest);
+
+		for (pi = bgp_dest_get_bgp_path_info(dest); pi; pi = pi->next) {
+			if (!bgp_snap_path_wanted(bgp, pi))
+				continue;
+			if (!bgp_snap_attr_supported(pi->attr)) {
+				snap.unsupported++;
+				continue;
+			}
+
+			memset(&rec, 0, sizeof(rec));
+			rec.peer = bgp_snap_ref_get(peers, pi->peer, &added);
+			if (added)
+				bgp_snap_put_peer(fp, pi->peer);
+			rec.attr = bgp_snap_ref_get(attrs, pi->attr, &added);
+			if (added)
+				bgp_snap_put_attr(fp, s, pi->attr, pi->peer);
+			rec.addpath_rx_id = pi->addpath_rx_id;
+			rec.afi = afi;
+			rec.safi = safi;
+			rec.family = p->family;
+			rec.prefixlen = p->prefixlen;
+			memcpy(rec.prefix, &p->u.prefix, prefix_blen(p));
+
+			bgp_snap_put_rec(fp, BGP_SNAP_REC_PATH, &rec,
+					 sizeof(rec), NULL, 0);
+			snap.written_paths++;
+		}
+	}
+}
+
+static void bgp_snapshot_write(void)
+{
+	struct bgp_snap_idx_head peers[1], attrs[1];
+	struct bgp_snap_hdr hdr = {
+		.magic = BGP_SNAP_MAGIC,
+		.version = BGP_SNAP_VERSION,
+		.attr_size = sizeof(struct bgp_snap_attr),
+	};
+	char tmp[MAXPATHLEN];
+	struct timeval start;
+	struct listnode *node;
+	struct stream *s;
+	struct bgp *bgp;
+	afi_t afi;
+	FILE *fp;
+
+	monotime(&start);
+	snprintf(tmp, sizeof(tmp), "%s.tmp", snap.path);
+	fp = fopen(tmp, "w");
+	if (!fp) {
+		snap.write_errno = errno;
+		zlog_warn("%s: cannot create %s: %m", __func__, tmp);
+		return;
+	}
+
+	bgp_snap_idx_init(peers);
+	bgp_snap_idx_init(attrs);
+	s = stream_new(BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE);
+	snap.written_paths = 0;
+	snap.unsupported = 0;
+
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		if (bgp->inst_type == BGP_INSTANCE_TYPE_VIEW)
+			continue;
+
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+			bgp_snap_put_table(fp, s, bgp, afi, SAFI_UNICAST, peers,
+					   attrs);
+			bgp_snap_put_table(fp, s, bgp, afi, SAFI_MULTICAST,
+					   peers, attrs);
+		}
+	}
+
+	hdr.npeers = snap.written_peers = bgp_snap_idx_count(peers);
+	hdr.nattrs = snap.written_attrs = bgp_snap_idx_count(attrs);
+	hdr.npaths = snap.written_paths;
+	rewind(fp);
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+
+	stream_free(s);
+	bgp_snap_ref_fini(attrs);
+	bgp_snap_ref_fini(peers);
+
+	if (fflush(fp) || fsync(fileno(fp)) || ferror(fp)) {
+		snap.write_errno = errno ? errno : EIO;
+		zlog_warn("%s: writing %s failed: %s", __func__, tmp,
+			  safe_strerror(snap.write_errno));
+		fclose(fp);
+		unlink(tmp);
+		return;
+	}
+	fclose(fp);
+
+	if (rename(tmp, snap.path)) {
+		snap.write_errno = errno;
+		zlog_warn("%s: cannot rename %s: %m", __func__, tmp);
+		unlink(tmp);
+		return;
+	}
+
+	snap.write_errno = 0;
+	snap.written = monotime(NULL);
+	snap.write_usec = monotime_since(&start, NULL);
+	if (BGP_DEBUG(update, UPDATE_IN))
+		zlog_debug("%s: %u paths, %u attributes written in %" PRId64
+			   "us",
+			   __func__, snap.written_paths, snap.written_attrs,
+			   snap.write_usec);
+}
+
+static void bgp_snapshot_write_timer(struct thread *thread)
+{
+	bgp_snapshot_write();
+	thread_add_timer(bm->master, bgp_snapshot_write_timer, NULL,
+			 snap.interval, &snap.t_write);
+}
+
+static void bgp_snapshot_stale_timer(struct thread *thread)
+{
+	struct bgp_snap_peer_ref *ref;
+	struct peer *peer;
+	afi_t afi;
+	safi_t safi;
+
+	while ((ref = bgp_snap_peers_pop(&snap.peers))) {
+		peer = ref->peer;
+		UNSET_FLAG(peer->sflags, PEER_STATUS_RIB_RESTORED);
+
+		FOREACH_AFI_SAFI (afi, safi) {
+			if (!ref->afs[afi][safi]
+			    || CHECK_FLAG(peer->flags, PEER_FLAG_DELETE))
+				continue;
+			if (peer->nsf[afi][safi])
+				bgp_clear_stale_route(peer, afi, safi);
+
+			/* leave the flag alone if GR negotiated it */
+			if (!peer_established(peer)
+			    || !CHECK_FLAG(peer->af_cap[afi][safi],
+					   PEER_CAP_RESTART_AF_RCV))
+				peer->nsf[afi][safi] = 0;
+		}
+
+		peer_unlock(peer);
+		XFREE(MTYPE_BGP_SNAPSHOT, ref);
+	}
+}
+
+static struct peer *bgp_snap_get_peer(const uint8_t *body, uint32_t len)
+{
+	struct bgp_snap_peer rec;
+	char name[BGP_SNAP_NAMSIZ];
+	union sockunion su = {};
+	size_t name_len;
+	struct bgp *bgp;
+	struct peer *peer;
+
+	if (len < sizeof(rec))
+		return NULL;
+	memcpy(&rec, body, sizeof(rec));
+	name_len = MIN(len - sizeof(rec), sizeof(name) - 1);
+	memcpy(name, body + sizeof(rec), name_len);
+	name[name_len] = '\0';
+
+	if (rec.family == AF_INET)
+		sockunion_set(&su, AF_INET, rec.addr, IPV4_MAX_BYTELEN);
+	else if (rec.family == AF_INET6)
+		sockunion_set(&su, AF_INET6, rec.addr, IPV6_MAX_BYTELEN);
+	else
+		return NULL;
+
+	bgp = bgp_lookup_by_name(name_len ? name : NULL);
+	if (!bgp)
+		return NULL;
+
+	/* an established peer is already sending the real thing */
+	peer = peer_lookup(bgp, &su);
+	if (!peer || peer_dynamic_neighbor(peer) || peer_established(peer)
+	    || CHECK_FLAG(peer->flags, PEER_FLAG_SHUTDOWN))
+		return NULL;
+	return peer;
+}
+
+static struct attr *bgp_snap_get_attr(struct stream *s, const uint8_t *body,
+				      uint32_t len)
+{
+	struct bgp_snap_attr rec;
+	struct attr tmp = {};
+	struct attr *attr;
+	uint64_t total;
+
+	if (len < sizeof(rec))
+		return NULL;
+	memcpy(&rec, body, sizeof(rec));
+	total = (uint64_t)rec.aspath_len + rec.community_len
+		+ rec.ecommunity_len + rec.lcommunity_len + rec.cluster_len;
+	if (total != len - sizeof(rec) || rec.community_len > UINT16_MAX
+	    || rec.ecommunity_len > UINT16_MAX
+	    || rec.lcommunity_len > UINT16_MAX
+	    || rec.cluster_len > UINT16_MAX
+	    || rec.aspath_len > STREAM_SIZE(s))
+		return NULL;
+	body += sizeof(rec);
+
+	tmp.flag = rec.flag;
+	tmp.aigp_metric = rec.aigp_metric;
+	tmp.mp_nexthop_global = rec.mp_nexthop_global;
+	tmp.mp_nexthop_local = rec.mp_nexthop_local;
+	tmp.nexthop = rec.nexthop;
+	tmp.mp_nexthop_global_in = rec.mp_nexthop_global_in;
+	tmp.aggregator_addr = rec.aggregator_addr;
+	tmp.originator_id = rec.originator_id;
+	tmp.med = rec.med;
+	tmp.local_pref = rec.local_pref;
+	tmp.weight = rec.weight;
+	tmp.aggregator_as = rec.aggregator_as;
+	tmp.tag = rec.tag;
+	tmp.label_index = rec.label_index;
+	tmp.label = rec.label;
+	tmp.rmap_table_id = rec.rmap_table_id;
+	tmp.rmap_change_flags = rec.rmap_change_flags;
+	tmp.link_bw = rec.link_bw;
+	tmp.srte_color = rec.srte_color;
+	tmp.otc = rec.otc;
+	tmp.nh_ifindex = rec.nh_ifindex;
+	tmp.nh_lla_ifindex = rec.nh_lla_ifindex;
+	tmp.nh_type = rec.nh_type;
+	tmp.bh_type = rec.bh_type;
+	tmp.origin = rec.origin;
+	tmp.mp_nexthop_len = rec.mp_nexthop_len;
+	tmp.mp_nexthop_prefer_global = rec.mp_nexthop_prefer_global;
+	tmp.distance = rec.distance;
+
+	/* the parsers return interned values, like when reading UPDATEs */
+	if (CHECK_FLAG(rec.present, BGP_SNAP_ASPATH)) {
+		stream_reset(s);
+		stream_put(s, body, rec.aspath_len);
+		tmp.aspath = aspath_parse(s, rec.aspath_len, 1);
+		if (!tmp.aspath)
+			goto fail;
+	}
+	body += rec.aspath_len;
+
+	if (CHECK_FLAG(rec.present, BGP_SNAP_COMMUNITY)) {
+		bgp_attr_set_community(
+			&tmp, community_parse((uint32_t *)body,
+					      rec.community_len));
+		if (!bgp_attr_get_community(&tmp))
+			goto fail;
+	}
+	body += rec.community_len;
+
+	if (CHECK_FLAG(rec.present, BGP_SNAP_ECOMMUNITY)) {
+		bgp_attr_set_ecommunity(
+			&tmp, ecommunity_parse((uint8_t *)body,
+					       rec.ecommunity_len,
+					       rec.ecom_ieee_disabled));
+		if (!bgp_attr_get_ecommunity(&tmp))
+			goto fail;
+	}
+	body += rec.ecommunity_len;
+
+	if (CHECK_FLAG(rec.present, BGP_SNAP_LCOMMUNITY)) {
+		bgp_attr_set_lcommunity(
+			&tmp, lcommunity_parse((uint8_t *)body,
+					       rec.lcommunity_len));
+		if (!bgp_attr_get_lcommunity(&tmp))
+			goto fail;
+	}
+	body += rec.lcommunity_len;
+
+	if (CHECK_FLAG(rec.present, BGP_SNAP_CLUSTER)) {
+		if (rec.cluster_len % IPV4_MAX_BYTELEN)
+			goto fail;
+		bgp_attr_set_cluster(&tmp, cluster_parse((struct in_addr *)body,
+							 rec.cluster_len));
+	}
+
+	/* the setters above touch the flags, restore them as saved */
+	tmp.flag = rec.flag;
+	attr = bgp_attr_intern(&tmp);
+	bgp_attr_unintern_sub(&tmp);
+	return attr;
+
+fail:
+	bgp_attr_unintern_sub(&tmp);
+	return NULL;
+}
+
+static bool bgp_snap_get_prefix(const struct bgp_snap_path *rec,
+				struct prefix *p)
+{
+	if (rec->afi != AFI_IP && rec->afi != AFI_IP6)
+		return false;
+	if (rec->safi != SAFI_UNICAST && rec->safi != SAFI_MULTICAST)
+		return false;
+	if (rec->family != afi2family(rec->afi))
+		return false;
+
+	memset(p, 0, sizeof(*p));
+	p->family = rec->family;
+	p->prefixlen = rec->prefixlen;
+	if (p->prefixlen > prefix_blen(p) * 8)
+		return false;
+	memcpy(&p->u.prefix, rec->prefix, prefix_blen(p));
+	apply_mask(p);
+	return true;
+}
+
+static struct bgp_snap_peer_ref *bgp_snap_peer_ref(struct peer *peer)
+{
+	struct bgp_snap_peer_ref *ref;
+
+	frr_each (bgp_snap_peers, &snap.peers, ref)
+		if (ref->peer == peer)
+			return ref;
+
+	ref = XCALLOC(MTYPE_BGP_SNAPSHOT, sizeof(*ref));
+	ref->peer = peer_lock(peer);
+	SET_FLAG(peer->sflags, PEER_STATUS_RIB_RESTORED);
+	bgp_snap_peers_add_tail(&snap.peers, ref);
+	return ref;
+}
+
+static void bgp_snapshot_load(struct thread *thread)
+{
+	struct bgp_snap_hdr hdr;
+	struct bgp_snap_rec rec;
+	struct bgp_snap_path path;
+	struct bgp_snap_peer_ref *ref;
+	struct peer **peers = NULL;
+	struct attr **attrs = NULL;
+	uint32_t npeers = 0, nattrs = 0, i;
+	uint32_t stale_time = BGP_DEFAULT_STALEPATH_TIME;
+	struct timeval start;
+	struct stream *s;
+	struct prefix p;
+	struct stat st;
+	const uint8_t *base, *body;
+	size_t pos;
+	int fd;
+
+	snap.loaded = true;
+	if (snap.interval)
+		thread_add_timer(bm->master, bgp_snapshot_write_timer, NULL,
+				 snap.interval, &snap.t_write);
+
+	monotime(&start);
+	fd = open(snap.path, O_RDONLY);
+	if (fd < 0) {
+		if (errno != ENOENT)
+			zlog_warn("%s: cannot open %s: %m", __func__,
+				  snap.path);
+		return;
+	}
+	if (fstat(fd, &st) || (size_t)st.st_size < sizeof(hdr)) {
+		close(fd);
+		return;
+	}
+	base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (base == MAP_FAILED) {
+		zlog_warn("%s: cannot map %s: %m", __func__, snap.path);
+		return;
+	}
+
+	memcpy(&hdr, base, sizeof(hdr));
+	if (hdr.magic != BGP_SNAP_MAGIC || hdr.version != BGP_SNAP_VERSION
+	    || hdr.attr_size != sizeof(struct bgp_snap_attr)) {
+		zlog_warn("%s: %s is not a snapshot of this version, ignored",
+			  __func__, snap.path);
+		munmap((void *)base, st.st_size);
+		return;
+	}
+
+	peers = XCALLOC(MTYPE_BGP_SNAPSHOT, (hdr.npeers + 1) * sizeof(*peers));
+	attrs = XCALLOC(MTYPE_BGP_SNAPSHOT, (hdr.nattrs + 1) * sizeof(*attrs));
+	s = stream_new(BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE);
+
+	for (pos = sizeof(hdr); pos + sizeof(rec) <= (size_t)st.st_size;
+	     pos += sizeof(rec) + rec.len) {
+		memcpy(&rec, base + pos, sizeof(rec));
+		if (rec.len > st.st_size - pos - sizeof(rec)) {
+			snap.load_errors++;
+			break;
+		}
+		body = base + pos + sizeof(rec);
+
+		switch (rec.type) {
+		case BGP_SNAP_REC_PEER:
+			if (npeers < hdr.npeers)
+				peers[npeers++] = bgp_snap_get_peer(body,
+								    rec.len);
+			break;
+		case BGP_SNAP_REC_ATTR:
+			if (nattrs >= hdr.nattrs)
+				break;
+			attrs[nattrs] = bgp_snap_get_attr(s, body, rec.len);
+			if (!attrs[nattrs])
+				snap.load_errors++;
+			nattrs++;
+			break;
+		case BGP_SNAP_REC_PATH:
+			if (rec.len < sizeof(path))
+				break;
+			memcpy(&path, body, sizeof(path));
+			if (path.peer >= npeers || !peers[path.peer]
+			    || path.attr >= nattrs || !attrs[path.attr])
+				break;
+			if (!bgp_snap_get_prefix(&path, &p)) {
+				snap.load_errors++;
+				break;
+			}
+			if (!peers[path.peer]->afc[path.afi][path.safi])
+				break;
+
+			ref = bgp_snap_peer_ref(peers[path.peer]);
+			ref->peer->nsf[path.afi][path.safi] = 1;
+			ref->afs[path.afi][path.safi] = true;
+			stale_time = MAX(stale_time,
+					 ref->peer->bgp->stalepath_time);
+
+			if (bgp_path_restore(ref->peer, &p, path.addpath_rx_id,
+					     attrs[path.attr], path.afi,
+					     path.safi))
+				snap.restored_paths++;
+			break;
+		}
+	}
+
+	/* every restored path holds its own reference */
+	for (i = 0; i < nattrs; i++) {
+		if (!attrs[i])
+			continue;
+		snap.restored_attrs++;
+		bgp_attr_unintern(&attrs[i]);
+	}
+
+	stream_free(s);
+	XFREE(MTYPE_BGP_SNAPSHOT, attrs);
+	XFREE(MTYPE_BGP_SNAPSHOT, peers);
+	munmap((void *)base, st.st_size);
+
+	snap.load_usec = monotime_since(&start, NULL);
+	zlog_info("%s: restored %u paths from %s in %" PRId64 "ms", __func__,
+		  snap.restored_paths, snap.path, snap.load_usec / 1000);
+
+	if (bgp_snap_peers_count(&snap.peers))
+		thread_add_timer(bm->master, bgp_snapshot_stale_timer, NULL,
+				 stale_time, &snap.t_stale);
+}
+
+/* vtysh -b, called for each instance in a row, load once they all exist */
+static int bgp_snapshot_config_end(struct bgp *bgp)
+{
+	if (!snap.loaded)
+		thread_add_event(bm->master, bgp_snapshot_load, NULL, 0,
+				 &snap.t_load);
+	return 0;
+}
+
+/* bgpd.conf, unless it is empty and the configuration comes from vtysh */
+static int bgp_snapshot_config_post(struct thread_master *master)
+{
+	if (!snap.loaded && listcount(bm->bgp))
+		thread_add_event(bm->master, bgp_snapshot_load, NULL, 0,
+				 &snap.t_load);
+	return 0;
+}
+
+void bgp_snapshot_init(const char *path, unsigned int interval)
+{
+	snap.path = XSTRDUP(MTYPE_BGP_SNAPSHOT, path);
+	snap.interval = interval;
+	bgp_snap_peers_init(&snap.peers);
+
+	hook_register(bgp_config_end, bgp_snapshot_config_end);
+	hook_register(frr_config_post, bgp_snapshot_config_post);
+}
+
+void bgp_snapshot_finish(void)
+{
+	struct bgp_snap_peer_ref *ref;
+
+	if (!snap.path)
+		return;
+
+	THREAD_OFF(snap.t_load);
+	THREAD_OFF(snap.t_write);
+	THREAD_OFF(snap.t_stale);
+
+	/* a shutdown before the configuration was read keeps the old one */
+	if (snap.loaded)
+		bgp_snapshot_write();
+
+	while ((ref = bgp_snap_peers_pop(&snap.peers))) {
+		UNSET_FLAG(ref->peer->sflags, PEER_STATUS_RIB_RESTORED);
+		peer_unlock(ref->peer);
+		XFREE(MTYPE_BGP_SNAPSHOT, ref);
+	}
+	bgp_snap_peers_fini(&snap.peers);
+
+	hook_unregister(bgp_config_end, bgp_snapshot_config_end);
+	hook_unregister(frr_config_post, bgp_snapshot_config_post);
+	XFREE(MTYPE_BGP_SNAPSHOT, snap.path);
+}
+
+DEFPY(show_bgp_rib_snapshot, show_bgp_rib_snapshot_cmd,
+      "show bgp rib-snapshot",
+      SHOW_STR
+      BGP_STR
+      "RIB snapshot for fast restarts\n")
+{
+	struct bgp_snap_peer_ref *ref;
+
+	if (!snap.path) {
+		vty_out(vty, "RIB snapshot not enabled (--rib-snapshot)\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "File: %s\n", snap.path);
+	if (snap.interval)
+		vty_out(vty, "Written every %u seconds and on shutdown\n",
+			snap.interval);
+	else
+		vty_out(vty, "Written on shutdown\n");
+
+	vty_out(vty, "Restored at startup: %u paths, %u attributes in %" PRId64
+		     "ms, %u errors\n",
+		snap.restored_paths, snap.restored_attrs,
+		snap.load_usec / 1000, snap.load_errors);
+	if (bgp_snap_peers_count(&snap.peers)) {
+		vty_out(vty, "Peers with restored paths pending (%lus left):\n",
+			thread_timer_remain_second(snap.t_stale));
+		frr_each (bgp_snap_peers, &snap.peers, ref)
+			vty_out(vty, "  %s%s\n", ref->peer->host,
+				peer_established(ref->peer) ? " (Established)"
+							    : "");
+	}
+
+	if (snap.written)
+		vty_out(vty, "Last written %llds ago: %u peers, %u attributes, %u paths in %" PRId64
+			     "ms, %u paths not supported\n",
+			(long long)(monotime(NULL) - snap.written),
+			snap.written_peers, snap.written_attrs,
+			snap.written_paths, snap.write_usec / 1000,
+			snap.unsupported);
+	else
+		vty_out(vty, "Not written yet\n");
+	if (snap.write_errno)
+		vty_out(vty, "Last write failed: %s\n",
+			safe_strerror(snap.write_errno));
+
+	return CMD_SUCCESS;
+}
+
+void bgp_snapshot_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_bgp_rib_snapshot_cmd);
+}
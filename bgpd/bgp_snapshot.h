@@ -0,0 +1,43 @@
+/*
+ * BGP RIB snapshot for fast restarts
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_BGP_SNAPSHOT_H
+#define _FRR_BGP_SNAPSHOT_H
+
+/*
+ * The snapshot holds the IPv4/IPv6 unicast and multicast paths received
+ * from configured peers, with their (post inbound policy) attributes
+ * stored once each, in the order they are interned again on load.  It is
+ * written periodically and on shutdown, and mmap()ed and loaded once the
+ * configuration has been read at startup.
+ *
+ * Loaded paths are STALE and take part in best path selection before
+ * their peer is up (PEER_STATUS_RIB_RESTORED).  A peer re-sending the
+ * same path finds the identical interned attribute and only clears the
+ * stale flag;  End-of-RIB or the stalepath-time removes the rest.
+ */
+extern void bgp_snapshot_init(const char *path, unsigned int interval);
+/* write the snapshot a last time, before bgp_terminate() */
+extern void bgp_snapshot_finish(void);
+
+extern void bgp_snapshot_vty_init(void);
+
+#endif /* _FRR_BGP_SNAPSHOT_H */
@@ -45,6 +45,178 @@
 #include "bgpd/bgp_snmp_bgp4v2.h"
 #include "bgpd/bgp_mplsvpn_snmp.h"
 
+DEFINE_MTYPE_STATIC(BGPD, BGP_SNMP_PEER_INDEX, "BGP SNMP peer index");
+
+/*
+ * Peers of all instances sorted by address, for the peer tables.  GETNEXT
+ * used to look at every peer, making a table walk quadratic in the number
+ * of peers.  The index holds a reference on each peer and is dropped
+ * whenever a peer changes state or goes away, then rebuilt by the next
+ * request that needs it.
+ */
+struct bgp_snmp_peer_ent {
+	struct peer *peer;
+	/* configuration order, the first of duplicate addresses wins */
+	uint32_t seq;
+};
+
+static struct bgp_snmp_peer_index {
+	struct bgp_snmp_peer_ent *ent;
+	uint32_t count;
+	bool valid;
+} peer_index;
+
+static int bgp_snmp_peer_addr_cmp(const struct peer *peer, int family,
+				  const void *addr)
+{
+	int pfamily = sockunion_family(&peer->su);
+
+	if (pfamily != family)
+		return pfamily < family ? -1 : 1;
+	if (family == AF_INET)
+		return memcmp(&peer->su.sin.sin_addr, addr, IPV4_MAX_BYTELEN);
+	return memcmp(&peer->su.sin6.sin6_addr, addr, IPV6_MAX_BYTELEN);
+}
+
+static const void *bgp_snmp_peer_addr(const struct peer *peer)
+{
+	if (sockunion_family(&peer->su) == AF_INET)
+		return &peer->su.sin.sin_addr;
+	return &peer->su.sin6.sin6_addr;
+}
+
+static int bgp_snmp_peer_ent_cmp(const void *a, const void *b)
+{
+	const struct bgp_snmp_peer_ent *e1 = a, *e2 = b;
+	int ret;
+
+	ret = bgp_snmp_peer_addr_cmp(e1->peer, sockunion_family(&e2->peer->su),
+				     bgp_snmp_peer_addr(e2->peer));
+	if (ret)
+		return ret;
+	return e1->seq < e2->seq ? -1 : (e1->seq > e2->seq);
+}
+
+static void bgp_snmp_peer_index_drop(void)
+{
+	uint32_t i;
+
+	for (i = 0; i < peer_index.count; i++)
+		peer_unlock(peer_index.ent[i].peer);
+
+	XFREE(MTYPE_BGP_SNMP_PEER_INDEX, peer_index.ent);
+	peer_index.count = 0;
+	peer_index.valid = false;
+}
+
+static uint32_t bgp_snmp_peer_total(void)
+{
+	struct listnode *node;
+	struct bgp *bgp;
+	uint32_t total = 0;
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		total += listcount(bgp->peer);
+
+	return total;
+}
+
+static void bgp_snmp_peer_index_build(void)
+{
+	struct listnode *bgpnode, *node;
+	struct bgp *bgp;
+	struct peer *peer;
+	uint32_t total = bgp_snmp_peer_total();
+
+	/* peers are created without a state change, catch them here */
+	if (peer_index.valid && total == peer_index.count)
+		return;
+
+	bgp_snmp_peer_index_drop();
+
+	if (total)
+		peer_index.ent = XCALLOC(MTYPE_BGP_SNMP_PEER_INDEX,
+					 total * sizeof(*peer_index.ent));
+
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, bgpnode, bgp)) {
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
+			struct bgp_snmp_peer_ent *ent;
+
+			ent = &peer_index.ent[peer_index.count];
+			ent->peer = peer_lock(peer);
+			ent->seq = peer_index.count++;
+		}
+	}
+
+	if (peer_index.count > 1)
+		qsort(peer_index.ent, peer_index.count,
+		      sizeof(*peer_index.ent), bgp_snmp_peer_ent_cmp);
+
+	peer_index.valid = true;
+}
+
+/* first entry not below family/addr */
+static uint32_t bgp_snmp_peer_index_lower(int family, const void *addr)
+{
+	uint32_t lo = 0, hi = peer_index.count;
+
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (bgp_snmp_peer_addr_cmp(peer_index.ent[mid].peer, family,
+					   addr) < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+struct peer *bgp_snmp_peer_lookup(int family, const void *addr)
+{
+	uint32_t i;
+
+	bgp_snmp_peer_index_build();
+
+	i = bgp_snmp_peer_index_lower(family, addr);
+	if (i < peer_index.count
+	    && !bgp_snmp_peer_addr_cmp(peer_index.ent[i].peer, family, addr))
+		return peer_index.ent[i].peer;
+
+	return NULL;
+}
+
+struct peer *bgp_snmp_peer_lookup_next(int family, const void *addr)
+{
+	uint32_t i;
+
+	bgp_snmp_peer_index_build();
+
+	for (i = bgp_snmp_peer_index_lower(family, addr);
+	     i < peer_index.count; i++) {
+		struct peer *peer = peer_index.ent[i].peer;
+		int ret = bgp_snmp_peer_addr_cmp(peer, family, addr);
+
+		if (ret == 0)
+			continue;
+		if (sockunion_family(&peer->su) != family)
+			break;
+		return peer;
+	}
+
+	return NULL;
+}
+
+static int bgp_snmp_peer_status_changed(struct peer *peer)
+{
+	/* unnumbered peers get their address on the way up, and deleted
+	 * peers must not be held on to
+	 */
+	bgp_snmp_peer_index_drop();
+	return 0;
+}
+
 static int bgp_snmp_init(struct thread_master *tm)
 {
 	smux_init(tm);
@@ -58,6 +230,7 @@ static int bgp_snmp_module_init(void)
 {
 	hook_register(peer_status_changed, bgpTrapEstablished);
 	hook_register(peer_backward_transition, bgpTrapBackwardTransition);
+	hook_register(peer_status_changed, bgp_snmp_peer_status_changed);
 	hook_register(frr_late_init, bgp_snmp_init);
 	return 0;
 }
@@ -29,4 +29,14 @@
 #define IPADDRESS ASN_IPADDRESS
 #define GAUGE32 ASN_UNSIGNED
 
+struct peer;
+
+/* Peers of all instances by address, through an index so that walking a
+ * peer table is not quadratic.  Duplicate addresses in different VRFs
+ * resolve to the first one configured.
+ */
+extern struct peer *bgp_snmp_peer_lookup(int family, const void *addr);
+/* the peer with the next higher address of the same family */
+extern struct peer *bgp_snmp_peer_lookup_next(int family, const void *addr);
+
 #endif /* _FRR_BGP_SNMP_H_ */
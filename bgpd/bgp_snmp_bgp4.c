@@ -92,48 +92,14 @@ static uint8_t *bgpLocalAs(struct variable *v, oid name[], size_t *length,
 
 static struct peer *peer_lookup_addr_ipv4(struct in_addr *src)
 {
-	struct bgp *bgp;
-	struct peer *peer;
-	struct listnode *node;
-	struct listnode *bgpnode;
-
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, bgpnode, bgp)) {
-		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-			if (sockunion_family(&peer->su) != AF_INET)
-				continue;
-
-			if (sockunion2ip(&peer->su) == src->s_addr)
-				return peer;
-		}
-	}
-
-	return NULL;
+	return bgp_snmp_peer_lookup(AF_INET, src);
 }
 
 static struct peer *bgp_peer_lookup_next(struct in_addr *src)
 {
-	struct bgp *bgp;
-	struct peer *peer;
-	struct peer *next_peer = NULL;
-	struct listnode *node;
-	struct listnode *bgpnode;
-
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, bgpnode, bgp)) {
-		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-			if (sockunion_family(&peer->su) != AF_INET)
-				continue;
-			if (ntohl(sockunion2ip(&peer->su)) <=
-			    ntohl(src->s_addr))
-				continue;
-
-			if (!next_peer ||
-			    ntohl(sockunion2ip(&next_peer->su)) >
-				    ntohl(sockunion2ip(&peer->su))) {
-				next_peer = peer;
-			}
-		}
-	}
+	struct peer *next_peer;
 
+	next_peer = bgp_snmp_peer_lookup_next(AF_INET, src);
 	if (next_peer) {
 		src->s_addr = sockunion2ip(&next_peer->su);
 		return next_peer;
@@ -50,90 +50,28 @@ SNMP_LOCAL_VARIABLES
 static oid bgpv2_oid[] = {BGP4V2MIB};
 static struct in_addr bgp_empty_addr = {};
 
-static struct peer *peer_lookup_all_vrf(struct ipaddr *addr)
+static struct peer *peer_lookup_all_vrf(struct ipaddr *addr,
+				       sa_family_t family)
 {
-	struct bgp *bgp;
-	struct peer *peer;
-	struct listnode *node;
-	struct listnode *bgpnode;
-
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, bgpnode, bgp)) {
-		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-			switch (sockunion_family(&peer->su)) {
-			case AF_INET:
-				if (IPV4_ADDR_SAME(&peer->su.sin.sin_addr,
-						   &addr->ip._v4_addr))
-					return peer;
-				break;
-			case AF_INET6:
-				if (IPV6_ADDR_SAME(&peer->su.sin6.sin6_addr,
-						   &addr->ip._v6_addr))
-					return peer;
-				break;
-			default:
-				break;
-			}
-		}
-	}
-
-	return NULL;
+	if (family == AF_INET)
+		return bgp_snmp_peer_lookup(AF_INET, &addr->ip._v4_addr);
+	return bgp_snmp_peer_lookup(AF_INET6, &addr->ip._v6_addr);
 }
 
 static struct peer *peer_lookup_all_vrf_next(struct ipaddr *addr, oid *offset,
 					     sa_family_t family)
 {
-	struct bgp *bgp;
-	struct peer *peer;
-	struct peer *next_peer = NULL;
-	struct listnode *node;
-	struct listnode *bgpnode;
-
-	for (ALL_LIST_ELEMENTS_RO(bm->bgp, bgpnode, bgp)) {
-		for (ALL_LIST_ELEMENTS_RO(bgp->peer, node, peer)) {
-			sa_family_t peer_family = sockunion_family(&peer->su);
-
-			if (peer_family != family)
-				continue;
-
-			switch (sockunion_family(&peer->su)) {
-			case AF_INET:
-				oid2in_addr(offset, IN_ADDR_SIZE,
-					    &addr->ip._v4_addr);
-				if (IPV4_ADDR_CMP(&peer->su.sin.sin_addr,
-						  &addr->ip._v4_addr) < 0 ||
-				    IPV4_ADDR_SAME(&peer->su.sin.sin_addr,
-						   &addr->ip._v4_addr))
-					continue;
-
-				if (!next_peer ||
-				    IPV4_ADDR_CMP(&next_peer->su.sin.sin_addr,
-						  &peer->su.sin.sin_addr) > 0)
-					next_peer = peer;
-
-				break;
-			case AF_INET6:
-				oid2in6_addr(offset, &addr->ip._v6_addr);
-				if (IPV6_ADDR_CMP(&peer->su.sin6.sin6_addr,
-						  &addr->ip._v6_addr) < 0 ||
-				    IPV6_ADDR_SAME(&peer->su.sin6.sin6_addr,
-						   &addr->ip._v6_addr))
-					continue;
-
-				if (!next_peer ||
-				    IPV6_ADDR_CMP(&next_peer->su.sin6.sin6_addr,
-						  &peer->su.sin6.sin6_addr) > 0)
-					next_peer = peer;
-
-				break;
-			default:
-				break;
-			}
-		}
+	switch (family) {
+	case AF_INET:
+		oid2in_addr(offset, IN_ADDR_SIZE, &addr->ip._v4_addr);
+		return bgp_snmp_peer_lookup_next(AF_INET, &addr->ip._v4_addr);
+	case AF_INET6:
+		oid2in6_addr(offset, &addr->ip._v6_addr);
+		return bgp_snmp_peer_lookup_next(AF_INET6, &addr->ip._v6_addr);
+	default:
+		break;
 	}
 
-	if (next_peer)
-		return next_peer;
-
 	return NULL;
 }
 
@@ -163,11 +101,11 @@ static struct peer *bgpv2PeerTable_lookup(struct variable *v, oid name[],
 	if (exact) {
 		if (family == AF_INET) {
 			oid2in_addr(offset, afi_len, &addr->ip._v4_addr);
-			peer = peer_lookup_all_vrf(addr);
+			peer = peer_lookup_all_vrf(addr, family);
 			return peer;
 		} else if (family == AF_INET6) {
 			oid2in6_addr(offset, &addr->ip._v6_addr);
-			return peer_lookup_all_vrf(addr);
+			return peer_lookup_all_vrf(addr, family);
 		}
 	} else {
 		peer = peer_lookup_all_vrf_next(addr, offset, family);
@@ -115,10 +115,14 @@ struct bgp_node {
 #define BGP_NODE_FIB_INSTALLED          (1 << 6)
 #define BGP_NODE_LABEL_REQUESTED        (1 << 7)
 #define BGP_NODE_SOFT_RECONFIG (1 << 8)
+#define BGP_NODE_CONDITION_MATCH (1 << 9)
 
 	struct bgp_addpath_node_data tx_addpath;
 
 	enum bgp_path_selection_reason reason;
+
+	/* Shared nexthop group the route was installed with, if any */
+	struct bgp_nhg_cache *nhg;
 };
 
 extern void bgp_delete_listnode(struct bgp_dest *dest);
@@ -475,6 +475,20 @@ TRACEPOINT_EVENT(
 	)
 )
 TRACEPOINT_LOGLEVEL(frr_bgp, evpn_local_l3vni_del_zrecv, TRACE_INFO)
+
+/* name is the peer's host or the instance's name_pretty */
+TRACEPOINT_EVENT(
+	frr_bgp,
+	pipeline_stage,
+	TP_ARGS(const char *, name, afi_t, afi, int, stage, uint64_t, usec),
+	TP_FIELDS(
+		ctf_string(name, name)
+		ctf_integer(afi_t, afi, afi)
+		ctf_integer(int, stage, stage)
+		ctf_integer(uint64_t, usec, usec)
+	)
+)
+TRACEPOINT_LOGLEVEL(frr_bgp, pipeline_stage, TRACE_INFO)
 /* clang-format on */
 
 #include <lttng/tracepoint-event.h>
@@ -56,6 +56,7 @@
 #include "bgpd/bgp_route.h"
 #include "bgpd/bgp_filter.h"
 #include "bgpd/bgp_io.h"
+#include "bgpd/bgp_rtc.h"
 
 /********************
  * PRIVATE FUNCTIONS
@@ -115,6 +116,7 @@ static void sync_init(struct update_subgroup *subgrp,
 
 static void sync_delete(struct update_subgroup *subgrp)
 {
+	subgroup_attr_cache_clear(subgrp);
 	XFREE(MTYPE_BGP_SYNCHRONISE, subgrp->sync);
 	if (subgrp->hash) {
 		hash_clean(subgrp->hash,
@@ -226,6 +228,11 @@ static void conf_copy(struct peer *dst, struct peer *src, afi_t afi,
 	}
 
 	dstfilter->advmap.update_type = srcfilter->advmap.update_type;
+
+	if (bgp_rtc_safi(safi)) {
+		bgp_rtc_filter_unref(&dst->rtc_filter);
+		dst->rtc_filter = bgp_rtc_filter_ref(src->rtc_filter);
+	}
 }
 
 /**
@@ -256,6 +263,8 @@ static void conf_release(struct peer *src, afi_t afi, safi_t safi)
 	XFREE(MTYPE_BGP_PEER_HOST, src->host);
 
 	ecommunity_free(&src->soo[afi][safi]);
+
+	bgp_rtc_filter_unref(&src->rtc_filter);
 }
 
 static void peer2_updgrp_copy(struct update_group *updgrp, struct peer_af *paf)
@@ -447,6 +456,12 @@ static unsigned int updgrp_hash_key_make(const void *p)
 		key = jhash_1word(jhash(soo_str, strlen(soo_str), SEED1), key);
 	}
 
+	/* Neighbors with different route target memberships are sent
+	 * different VPN/EVPN routes.
+	 */
+	if (bgp_rtc_safi(safi))
+		key = jhash_1word(bgp_rtc_filter_key(peer->rtc_filter), key);
+
 	if (bgp_debug_neighbor_events(peer)) {
 		zlog_debug(
 			"%pBP Update Group Hash: sort: %d UpdGrpFlags: %ju UpdGrpAFFlags: %ju",
@@ -629,6 +644,10 @@ static bool updgrp_hash_cmp(const void *p1, const void *p2)
 	if ((afi == AFI_IP6) && (pe1->shared_network != pe2->shared_network))
 		return false;
 
+	/* route target constraint filters are interned */
+	if (bgp_rtc_safi(safi) && pe1->rtc_filter != pe2->rtc_filter)
+		return false;
+
 	if ((CHECK_FLAG(pe1->flags, PEER_FLAG_LONESOUL)
 	     || CHECK_FLAG(pe1->af_cap[afi][safi], PEER_CAP_ORF_PREFIX_SM_RCV)
 	     || CHECK_FLAG(pe1->af_cap[afi][safi],
@@ -869,6 +888,9 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				json_subgrp, "needsRefresh",
 				CHECK_FLAG(subgrp->flags,
 					   SUBGRP_FLAG_NEEDS_REFRESH));
+			json_object_boolean_add(
+				json_subgrp, "tableAnnouncePending",
+				subgroup_announce_pending(subgrp));
 		} else {
 			vty_out(vty, "    Join events: %u\n",
 				subgrp->join_events);
@@ -888,6 +910,8 @@ static int update_group_show_walkcb(struct update_group *updgrp, void *arg)
 				(UPDGRP_INST(subgrp->update_group))
 					->coalesce_time,
 				subgrp->t_coalesce ? "(Running)" : "");
+			if (subgroup_announce_pending(subgrp))
+				vty_out(vty, "    Table announce in progress\n");
 			vty_out(vty, "    Version: %" PRIu64 "\n",
 				subgrp->version);
 			vty_out(vty, "    Packet queue length: %d\n",
@@ -1097,6 +1121,7 @@ static void update_subgroup_delete(struct update_subgroup *subgrp)
 
 	THREAD_OFF(subgrp->t_merge_check);
 	THREAD_OFF(subgrp->t_coalesce);
+	subgroup_announce_cancel(subgrp);
 
 	bpacket_queue_cleanup(SUBGRP_PKTQ(subgrp));
 	subgroup_clear_table(subgrp);
@@ -1266,6 +1291,10 @@ static struct update_subgroup *update_subgroup_find(struct update_group *updgrp,
 		if (update_subgroup_needs_refresh(subgrp))
 			continue;
 
+		/* Nor on one still being walked through the table */
+		if (subgroup_announce_pending(subgrp))
+			continue;
+
 		break;
 	}
 
@@ -1302,6 +1331,13 @@ static bool update_subgroup_ready_for_merge(struct update_subgroup *subgrp)
 	if (update_subgroup_needs_refresh(subgrp))
 		return false;
 
+	/*
+	 * Nor one with a table announce in progress, its adj_out is
+	 * incomplete.
+	 */
+	if (subgroup_announce_pending(subgrp))
+		return false;
+
 	return true;
 }
 
@@ -1753,6 +1789,39 @@ void update_group_policy_update(struct bgp *bgp, enum bgp_policy_type ptype,
 	update_group_walk(bgp, updgrp_policy_update_walkcb, &ctx);
 }
 
+static int updgrp_route_map_unchanged_walkcb(struct update_group *updgrp,
+					     void *arg)
+{
+	struct updwalk_context *ctx = arg;
+	struct update_subgroup *subgrp;
+	int def_changed = 0;
+
+	if (!updgrp_route_map_update(updgrp, ctx->policy_name, &def_changed)
+	    && !def_changed)
+		return UPDWALK_CONTINUE;
+
+	UPDGRP_FOREACH_SUBGRP (updgrp, subgrp)
+		update_subgroup_set_needs_refresh(subgrp, 0);
+
+	return UPDWALK_CONTINUE;
+}
+
+/*
+ * A route-map change event started with update_group_policy_update() turned
+ * out to leave the route-map content unchanged: no update generation is
+ * needed, just clear the dirty flag set at the start of the event.
+ */
+void update_group_route_map_unchanged(struct bgp *bgp, const char *pname)
+{
+	struct updwalk_context ctx;
+
+	memset(&ctx, 0, sizeof(ctx));
+	ctx.policy_type = BGP_POLICY_ROUTE_MAP;
+	ctx.policy_name = pname;
+
+	update_group_walk(bgp, updgrp_route_map_unchanged_walkcb, &ctx);
+}
+
 /*
  * update_subgroup_split_peer
  *
@@ -1826,6 +1895,7 @@ void update_subgroup_split_peer(struct peer_af *paf,
 	 */
 	update_subgroup_copy_adj_out(paf->subgroup, subgrp);
 	update_subgroup_copy_packets(subgrp, paf->next_pkt_to_send);
+	subgroup_announce_inherit(subgrp, old_subgrp);
 
 	if (BGP_DEBUG(update_groups, UPDATE_GROUPS))
 		zlog_debug("u%" PRIu64 ":s%" PRIu64" peer %s split and moved into u%" PRIu64":s%" PRIu64,
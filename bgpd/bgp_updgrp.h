@@ -200,6 +200,14 @@ struct update_subgroup {
 	 */
 	struct stream *scratch;
 
+	/* Attributes encoded for the last UPDATE, reused as long as the
+	 * following UPDATEs carry the same attributes from the same peer.
+	 */
+	struct attr *enc_attr;
+	struct peer *enc_from;
+	struct stream *enc_buf;
+	struct bpacket_attr_vec_arr enc_vecarr;
+
 	/* synchronization list and time */
 	struct bgp_synchronize *sync;
 
@@ -217,6 +225,13 @@ struct update_subgroup {
 
 	struct thread *t_merge_check;
 
+	/* Background table walk of subgroup_announce_route(), the next dest
+	 * to look at is locked.
+	 */
+	struct thread *t_announce;
+	struct bgp_table *announce_table;
+	struct bgp_dest *announce_dest;
+
 	/* table version that the subgroup has caught up to. */
 	uint64_t version;
 
@@ -383,6 +398,8 @@ extern void update_group_policy_update(struct bgp *bgp,
 				       enum bgp_policy_type ptype,
 				       const char *pname, bool route_update,
 				       int start_event);
+extern void update_group_route_map_unchanged(struct bgp *bgp,
+					     const char *pname);
 extern void update_group_af_walk(struct bgp *bgp, afi_t afi, safi_t safi,
 				 updgrp_walkcb cb, void *ctx);
 extern void update_group_walk(struct bgp *bgp, updgrp_walkcb cb, void *ctx);
@@ -416,6 +433,7 @@ unsigned int bpacket_queue_virtual_length(struct peer_af *paf);
 extern void bpacket_queue_show_vty(struct bpacket_queue *q, struct vty *vty);
 bool subgroup_packets_to_build(struct update_subgroup *subgrp);
 extern struct bpacket *subgroup_update_packet(struct update_subgroup *s);
+extern void subgroup_attr_cache_clear(struct update_subgroup *subgrp);
 extern struct bpacket *subgroup_withdraw_packet(struct update_subgroup *s);
 extern struct stream *bpacket_reformat_for_peer(struct bpacket *pkt,
 						struct peer_af *paf);
@@ -467,6 +485,9 @@ extern void bgp_adj_out_unset_subgroup(struct bgp_dest *dest,
 				       char withdraw, uint32_t addpath_tx_id);
 void subgroup_announce_table(struct update_subgroup *subgrp,
 			     struct bgp_table *table);
+extern void subgroup_announce_cancel(struct update_subgroup *subgrp);
+extern void subgroup_announce_inherit(struct update_subgroup *to,
+				      struct update_subgroup *from);
 extern void subgroup_trigger_write(struct update_subgroup *subgrp);
 
 extern int update_group_clear_update_dbg(struct update_group *updgrp,
@@ -543,6 +564,17 @@ static inline void update_group_remove_peer_afs(struct peer *peer)
 	}
 }
 
+/*
+ * subgroup_announce_pending
+ *
+ * Returns true while a table announce to the subgroup is in progress.
+ */
+static inline bool
+subgroup_announce_pending(const struct update_subgroup *subgrp)
+{
+	return subgrp->announce_table != NULL;
+}
+
 /*
  * update_subgroup_needs_refresh
  */
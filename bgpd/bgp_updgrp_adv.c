@@ -91,6 +91,18 @@ static inline struct bgp_adj_out *adj_lookup(struct bgp_dest *dest,
 	return RB_FIND(bgp_adj_out_rb, &dest->adj_out, &lookup);
 }
 
+/* First adj-out of subgrp in dest, they are sorted by subgroup, then ID */
+static inline struct bgp_adj_out *adj_first(struct bgp_dest *dest,
+					    struct update_subgroup *subgrp)
+{
+	struct bgp_adj_out lookup;
+
+	lookup.subgroup = subgrp;
+	lookup.addpath_tx_id = 0;
+
+	return RB_NFIND(bgp_adj_out_rb, &dest->adj_out, &lookup);
+}
+
 static void adj_free(struct bgp_adj_out *adj)
 {
 	TAILQ_REMOVE(&(adj->subgroup->adjq), adj, subgrp_adj_train);
@@ -113,10 +125,13 @@ static void subgrp_withdraw_stale_addpath(struct updwalk_context *ctx,
 	struct peer *peer = SUBGRP_PEER(subgrp);
 
 	/* Look through all of the paths we have advertised for this rn and send
-	 * a withdraw for the ones that are no longer present */
-	RB_FOREACH_SAFE (adj, bgp_adj_out_rb, &ctx->dest->adj_out, adj_next) {
-		if (adj->subgroup != subgrp)
-			continue;
+	 * a withdraw for the ones that are no longer present.  Only this
+	 * subgroup's part of adj_out is visited, not that of every other
+	 * subgroup.
+	 */
+	for (adj = adj_first(ctx->dest, subgrp);
+	     adj && adj->subgroup == subgrp; adj = adj_next) {
+		adj_next = RB_NEXT(bgp_adj_out_rb, adj);
 
 		for (pi = bgp_dest_get_bgp_path_info(ctx->dest); pi;
 		     pi = pi->next) {
@@ -171,15 +186,25 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 
 				for (pi = bgp_dest_get_bgp_path_info(ctx->dest);
 				     pi; pi = pi->next) {
+					uint32_t id;
+
 					/* Skip the bestpath for now */
 					if (pi == ctx->pi)
 						continue;
 
+					/* Not selected by this peer's addpath
+					 * strategy, so it is not advertised;
+					 * if it was before, the withdraw was
+					 * sent above with its old ID.
+					 */
+					id = bgp_addpath_id_for_peer(
+						peer, afi, safi,
+						&pi->tx_addpath);
+					if (id == IDALLOC_INVALID)
+						continue;
+
 					subgroup_process_announce_selected(
-						subgrp, pi, ctx->dest,
-						bgp_addpath_id_for_peer(
-							peer, afi, safi,
-							&pi->tx_addpath));
+						subgrp, pi, ctx->dest, id);
 				}
 
 				/* Process the bestpath last so the "show [ip]
@@ -205,22 +230,18 @@ static int group_announce_route_walkcb(struct update_group *updgrp, void *arg)
 					/* Find the addpath_tx_id of the path we
 					 * had advertised and
 					 * send a withdraw */
-					RB_FOREACH_SAFE (adj, bgp_adj_out_rb,
-							 &ctx->dest->adj_out,
-							 adj_next) {
-						if (adj->subgroup == subgrp) {
-							subgroup_process_announce_selected(
-								subgrp, NULL,
-								ctx->dest,
-								adj->addpath_tx_id);
-						}
+					for (adj = adj_first(ctx->dest, subgrp);
+					     adj && adj->subgroup == subgrp;
+					     adj = adj_next) {
+						adj_next = RB_NEXT(
+							bgp_adj_out_rb, adj);
+						subgroup_process_announce_selected(
+							subgrp, NULL, ctx->dest,
+							adj->addpath_tx_id);
 					}
 				}
 			}
 		}
-
-		/* Notify BGP Conditional advertisement */
-		bgp_notify_conditional_adv_scanner(subgrp);
 	}
 
 	return UPDWALK_CONTINUE;
@@ -466,7 +487,7 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 	struct peer *adv_peer;
 	struct peer_af *paf;
 	struct bgp *bgp;
-	uint32_t attr_hash = attrhash_key_make(attr);
+	struct attr *adv_attr;
 
 	peer = SUBGRP_PEER(subgrp);
 	afi = SUBGRP_AFI(subgrp);
@@ -500,10 +521,18 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 	 * at egress, neighbors will see duplicate UPDATES despite
 	 * the route wasn't changed actually.
 	 * Do not suppress BGP UPDATES for route-refresh.
+	 *
+	 * Compare with what is queued, or else with what was sent.  A
+	 * pending withdraw has no attributes, the route must go out again.
 	 */
+	if (adj->adv)
+		adv_attr = adj->adv->baa ? adj->adv->baa->attr : NULL;
+	else
+		adv_attr = adj->attr;
+
 	if (CHECK_FLAG(bgp->flags, BGP_FLAG_SUPPRESS_DUPLICATES)
 	    && !CHECK_FLAG(subgrp->sflags, SUBGRP_STATUS_FORCE_UPDATES)
-	    && adj->attr_hash == attr_hash) {
+	    && adv_attr && attrhash_cmp(adv_attr, attr)) {
 		if (BGP_DEBUG(update, UPDATE_OUT)) {
 			char attr_str[BUFSIZ] = {0};
 
@@ -527,7 +556,6 @@ void bgp_adj_out_set_subgroup(struct bgp_dest *dest,
 
 	adv->baa = bgp_advertise_attr_intern(subgrp->hash, attr);
 	adv->adj = adj;
-	adj->attr_hash = attr_hash;
 
 	/* Add new advertisement to advertisement attribute list. */
 	bgp_advertise_add(adv->baa, adv);
@@ -643,13 +671,42 @@ void subgroup_clear_table(struct update_subgroup *subgrp)
 		bgp_adj_out_remove_subgroup(aout->dest, aout, subgrp);
 }
 
-/*
- * subgroup_announce_table
- */
-void subgroup_announce_table(struct update_subgroup *subgrp,
-			     struct bgp_table *table)
+static void subgroup_announce_table_task(struct thread *thread);
+
+/* Destinations looked at per run of a background table announce */
+#define SUBGRP_ANNOUNCE_TABLE_MAX_PREFIX 10000
+
+/* labeled unicast routes come from the unicast table */
+static struct bgp_table *subgroup_announce_rib(struct update_subgroup *subgrp)
 {
-	struct bgp_dest *dest;
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+
+	if (safi == SAFI_LABELED_UNICAST)
+		safi = SAFI_UNICAST;
+
+	return peer->bgp->rib[SUBGRP_AFI(subgrp)][safi];
+}
+
+static void subgroup_announce_table_start(struct update_subgroup *subgrp)
+{
+	struct peer *peer = SUBGRP_PEER(subgrp);
+	afi_t afi = SUBGRP_AFI(subgrp);
+	safi_t safi = SUBGRP_SAFI(subgrp);
+
+	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
+	    && CHECK_FLAG(peer->af_flags[afi][safi],
+			  PEER_FLAG_DEFAULT_ORIGINATE))
+		subgroup_default_originate(subgrp, 0);
+
+	subgrp->pscount = 0;
+	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+}
+
+static void subgroup_announce_dest(struct update_subgroup *subgrp,
+				   struct bgp_dest *dest)
+{
+	const struct prefix *dest_p = bgp_dest_get_prefix(dest);
 	struct bgp_path_info *ri;
 	struct attr attr;
 	struct peer *peer;
@@ -671,66 +728,52 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	else
 		safi_rib = safi;
 
-	if (!table)
-		table = peer->bgp->rib[afi][safi_rib];
-
-	if (safi != SAFI_MPLS_VPN && safi != SAFI_ENCAP && safi != SAFI_EVPN
-	    && CHECK_FLAG(peer->af_flags[afi][safi],
-			  PEER_FLAG_DEFAULT_ORIGINATE))
-		subgroup_default_originate(subgrp, 0);
-
-	subgrp->pscount = 0;
-	SET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
-
-	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest)) {
-		const struct prefix *dest_p = bgp_dest_get_prefix(dest);
-
-		/* Check if the route can be advertised */
-		advertise = bgp_check_advertise(bgp, dest);
+	/* Check if the route can be advertised */
+	advertise = bgp_check_advertise(bgp, dest);
 
-		for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
+	for (ri = bgp_dest_get_bgp_path_info(dest); ri; ri = ri->next) {
 
-			if (!bgp_check_selected(ri, peer, addpath_capable, afi,
-						safi_rib))
-				continue;
+		if (!bgp_check_selected(ri, peer, addpath_capable, afi,
+					safi_rib))
+			continue;
 
-			if (subgroup_announce_check(dest, ri, subgrp, dest_p,
-						    &attr, NULL)) {
-				/* Check if route can be advertised */
-				if (advertise) {
-					if (!bgp_check_withdrawal(bgp, dest))
-						bgp_adj_out_set_subgroup(
-							dest, subgrp, &attr,
-							ri);
-					else
-						bgp_adj_out_unset_subgroup(
-							dest, subgrp, 1,
-							bgp_addpath_id_for_peer(
-								peer, afi,
-								safi_rib,
-								&ri->tx_addpath));
-				}
-			} else {
-				/* If default originate is enabled for
-				 * the peer, do not send explicit
-				 * withdraw. This will prevent deletion
-				 * of default route advertised through
-				 * default originate
-				 */
-				if (CHECK_FLAG(peer->af_flags[afi][safi],
-					       PEER_FLAG_DEFAULT_ORIGINATE) &&
-				    is_default_prefix(
-					    bgp_dest_get_prefix(dest)))
-					break;
-
-				bgp_adj_out_unset_subgroup(
-					dest, subgrp, 1,
-					bgp_addpath_id_for_peer(
-						peer, afi, safi_rib,
-						&ri->tx_addpath));
+		if (subgroup_announce_check(dest, ri, subgrp, dest_p, &attr,
+					    NULL)) {
+			/* Check if route can be advertised */
+			if (advertise) {
+				if (!bgp_check_withdrawal(bgp, dest))
+					bgp_adj_out_set_subgroup(dest, subgrp,
+								 &attr, ri);
+				else
+					bgp_adj_out_unset_subgroup(
+						dest, subgrp, 1,
+						bgp_addpath_id_for_peer(
+							peer, afi, safi_rib,
+							&ri->tx_addpath));
 			}
+		} else {
+			/* If default originate is enabled for
+			 * the peer, do not send explicit
+			 * withdraw. This will prevent deletion
+			 * of default route advertised through
+			 * default originate
+			 */
+			if (CHECK_FLAG(peer->af_flags[afi][safi],
+				       PEER_FLAG_DEFAULT_ORIGINATE)
+			    && is_default_prefix(bgp_dest_get_prefix(dest)))
+				break;
+
+			bgp_adj_out_unset_subgroup(
+				dest, subgrp, 1,
+				bgp_addpath_id_for_peer(peer, afi, safi_rib,
+							&ri->tx_addpath));
 		}
 	}
+}
+
+static void subgroup_announce_table_done(struct update_subgroup *subgrp,
+					 struct bgp_table *table)
+{
 	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
 
 	/*
@@ -749,6 +792,112 @@ void subgroup_announce_table(struct update_subgroup *subgrp,
 	update_subgroup_trigger_merge_check(subgrp, 0);
 }
 
+/*
+ * subgroup_announce_table
+ */
+void subgroup_announce_table(struct update_subgroup *subgrp,
+			     struct bgp_table *table)
+{
+	struct bgp_dest *dest;
+
+	if (!table)
+		table = subgroup_announce_rib(subgrp);
+
+	subgroup_announce_table_start(subgrp);
+
+	for (dest = bgp_table_top(table); dest; dest = bgp_route_next(dest))
+		subgroup_announce_dest(subgrp, dest);
+
+	subgroup_announce_table_done(subgrp, table);
+}
+
+/*
+ * Walk on SUBGRP_ANNOUNCE_TABLE_MAX_PREFIX dests of the table being
+ * announced, and schedule a new run for the rest.  The next dest is kept
+ * locked in between, so that it can't go away.  Routes changing meanwhile
+ * make it to the subgroup through the regular update path, ahead or
+ * behind the walk, either way the walk sees the current best path.
+ */
+static void subgroup_announce_table_run(struct update_subgroup *subgrp)
+{
+	struct bgp_dest *dest = subgrp->announce_dest;
+	struct bgp_table *table = subgrp->announce_table;
+	unsigned int count;
+
+	for (count = 0; dest && count < SUBGRP_ANNOUNCE_TABLE_MAX_PREFIX;
+	     count++) {
+		subgroup_announce_dest(subgrp, dest);
+		dest = bgp_route_next(dest);
+	}
+
+	subgrp->announce_dest = dest;
+	if (dest) {
+		thread_add_event(bm->master, subgroup_announce_table_task,
+				 subgrp, 0, &subgrp->t_announce);
+		return;
+	}
+
+	subgrp->announce_table = NULL;
+	subgroup_announce_table_done(subgrp, table);
+
+	/* EoR or EoRR may have been held back for the walk */
+	subgroup_trigger_write(subgrp);
+}
+
+static void subgroup_announce_table_task(struct thread *thread)
+{
+	struct update_subgroup *subgrp = THREAD_ARG(thread);
+
+	if (bgp_debug_update(NULL, NULL, subgrp->update_group, 0))
+		zlog_debug("u%" PRIu64 ":s%" PRIu64
+			   " resuming table announce at %pBD",
+			   subgrp->update_group->id, subgrp->id,
+			   subgrp->announce_dest);
+
+	subgroup_announce_table_run(subgrp);
+}
+
+/*
+ * subgroup_announce_cancel
+ *
+ * Stop a background table announce, e.g. before it is started again or
+ * the subgroup is deleted.
+ */
+void subgroup_announce_cancel(struct update_subgroup *subgrp)
+{
+	if (!subgroup_announce_pending(subgrp))
+		return;
+
+	THREAD_OFF(subgrp->t_announce);
+	if (subgrp->announce_dest)
+		bgp_dest_unlock_node(subgrp->announce_dest);
+	subgrp->announce_dest = NULL;
+	subgrp->announce_table = NULL;
+	UNSET_FLAG(subgrp->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+}
+
+/*
+ * subgroup_announce_inherit
+ *
+ * A subgroup split from one with a table announce in progress inherits
+ * its adj-out, so it carries on the walk from the same point.
+ */
+void subgroup_announce_inherit(struct update_subgroup *to,
+			       struct update_subgroup *from)
+{
+	if (!subgroup_announce_pending(from))
+		return;
+
+	subgroup_announce_cancel(to);
+
+	to->announce_table = from->announce_table;
+	to->announce_dest = bgp_dest_lock_node(from->announce_dest);
+	to->pscount = from->pscount;
+	SET_FLAG(to->sflags, SUBGRP_STATUS_TABLE_REPARSING);
+	thread_add_event(bm->master, subgroup_announce_table_task, to, 0,
+			 &to->t_announce);
+}
+
 /*
  * subgroup_announce_route
  *
@@ -774,11 +923,22 @@ void subgroup_announce_route(struct update_subgroup *subgrp)
 				   PEER_STATUS_ORF_WAIT_REFRESH))
 		return;
 
+	/* Start over, the walk so far may have used an outdated policy */
+	subgroup_announce_cancel(subgrp);
+
 	if (SUBGRP_SAFI(subgrp) != SAFI_MPLS_VPN
 	    && SUBGRP_SAFI(subgrp) != SAFI_ENCAP
-	    && SUBGRP_SAFI(subgrp) != SAFI_EVPN)
-		subgroup_announce_table(subgrp, NULL);
-	else
+	    && SUBGRP_SAFI(subgrp) != SAFI_EVPN) {
+		/*
+		 * Walk the table in the background, a full table for many
+		 * subgroups at once would otherwise stall bgpd.  The first
+		 * run happens right away, small tables are done with it.
+		 */
+		subgroup_announce_table_start(subgrp);
+		subgrp->announce_table = subgroup_announce_rib(subgrp);
+		subgrp->announce_dest = bgp_table_top(subgrp->announce_table);
+		subgroup_announce_table_run(subgrp);
+	} else
 		for (dest = bgp_table_top(update_subgroup_rib(subgrp)); dest;
 		     dest = bgp_route_next(dest)) {
 			table = bgp_dest_get_bgp_table_info(dest);
@@ -652,6 +652,65 @@ bool subgroup_packets_to_build(struct update_subgroup *subgrp)
 }
 
 /* Make BGP update packet.  */
+void subgroup_attr_cache_clear(struct update_subgroup *subgrp)
+{
+	if (subgrp->enc_attr)
+		bgp_attr_unintern(&subgrp->enc_attr);
+	if (subgrp->enc_from) {
+		peer_unlock(subgrp->enc_from);
+		subgrp->enc_from = NULL;
+	}
+	if (subgrp->enc_buf) {
+		stream_free(subgrp->enc_buf);
+		subgrp->enc_buf = NULL;
+	}
+}
+
+/*
+ * Encode the attributes of an UPDATE, except MP_REACH_NLRI.  A path's
+ * prefixes are queued back to back when they share attributes, and often
+ * need several UPDATEs, so the encoding of the last UPDATE is kept and
+ * copied when the attributes and the peer they came from are the same.
+ */
+static bgp_size_t subgroup_packet_attribute(struct update_subgroup *subgrp,
+					    struct peer *peer, struct stream *s,
+					    struct attr *attr,
+					    struct bpacket_attr_vec_arr *vecarr,
+					    afi_t afi, safi_t safi,
+					    struct peer *from,
+					    struct bgp_path_info *path)
+{
+	size_t start = stream_get_endp(s);
+	size_t len;
+
+	if (subgrp->enc_buf && subgrp->enc_attr == attr
+	    && subgrp->enc_from == from) {
+		len = stream_get_endp(subgrp->enc_buf);
+		stream_put(s, STREAM_DATA(subgrp->enc_buf), len);
+		*vecarr = subgrp->enc_vecarr;
+		return len;
+	}
+
+	subgroup_attr_cache_clear(subgrp);
+
+	bgp_packet_attribute(NULL, peer, s, attr, vecarr, NULL, afi, safi,
+			     from, NULL, NULL, 0, 0, 0, path);
+	len = stream_get_endp(s) - start;
+
+	/* The AIGP metric is taken from the path, not from attr */
+	if (!len || CHECK_FLAG(attr->flag, ATTR_FLAG_BIT(BGP_ATTR_AIGP)))
+		return len;
+
+	subgrp->enc_buf = stream_new(len);
+	stream_put(subgrp->enc_buf, STREAM_DATA(s) + start, len);
+	subgrp->enc_vecarr = *vecarr;
+	subgrp->enc_attr = bgp_attr_intern(attr);
+	if (from)
+		subgrp->enc_from = peer_lock(from);
+
+	return len;
+}
+
 struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 {
 	struct bpacket_attr_vec_arr vecarr;
@@ -753,9 +812,9 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 
 			/* 5: Encode all the attributes, except MP_REACH_NLRI
 			 * attr. */
-			total_attr_len = bgp_packet_attribute(
-				NULL, peer, s, adv->baa->attr, &vecarr, NULL,
-				afi, safi, from, NULL, NULL, 0, 0, 0, path);
+			total_attr_len = subgroup_packet_attribute(
+				subgrp, peer, s, adv->baa->attr, &vecarr, afi,
+				safi, from, path);
 
 			space_remaining =
 				STREAM_CONCAT_REMAIN(s, snlri, STREAM_SIZE(s))
@@ -867,6 +926,10 @@ struct bpacket *subgroup_update_packet(struct update_subgroup *subgrp)
 		adv = bgp_advertise_clean_subgroup(subgrp, adj);
 	}
 
+	/* Don't hold on to the attributes once the queue has drained */
+	if (!adv)
+		subgroup_attr_cache_clear(subgrp);
+
 	if (!stream_empty(s)) {
 		if (!stream_empty(snlri)) {
 			bgp_packet_mpattr_end(snlri, mpattrlen_pos);
@@ -79,6 +79,7 @@
 #include "bgpd/rfapi/bgp_rfapi_cfg.h"
 #endif
 #include "bgpd/bgp_orr.h"
+#include "bgpd/bgp_rtc.h"
 
 
 FRR_CFG_DEFAULT_BOOL(BGP_IMPORT_CHECK,
@@ -312,10 +313,8 @@ static int bgp_srv6_locator_unset(struct bgp *bgp)
 	}
 
 	/* refresh functions */
-	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func)) {
-		listnode_delete(bgp->srv6_functions, func);
-		XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-	}
+	frr_each_safe (bgp_srv6_functions, &bgp->srv6_functions, func)
+		bgp_srv6_function_del(bgp, func);
 
 	/* refresh tovpn_sid */
 	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp_vrf)) {
@@ -1909,6 +1908,35 @@ DEFPY (no_bgp_send_extra_data,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_install_nhg,
+       bgp_install_nhg_cmd,
+       "[no] bgp install-nexthop-groups",
+       NO_STR
+       BGP_STR
+       "Install routes with shared nexthop groups in zebra\n")
+{
+	struct listnode *node;
+	struct bgp *bgp;
+	afi_t afi;
+	safi_t safi;
+
+	if (!no == !!CHECK_FLAG(bm->flags, BM_FLAG_INSTALL_NHG))
+		return CMD_SUCCESS;
+
+	if (no)
+		UNSET_FLAG(bm->flags, BM_FLAG_INSTALL_NHG);
+	else
+		SET_FLAG(bm->flags, BM_FLAG_INSTALL_NHG);
+
+	/* Move the installed routes to/from the groups */
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp))
+		FOREACH_AFI_SAFI (afi, safi)
+			if (bgp_fibupd_safi(safi))
+				bgp_zebra_announce_table(bgp, afi, safi);
+
+	return CMD_SUCCESS;
+}
+
 DEFUN (bgp_confederation_identifier,
        bgp_confederation_identifier_cmd,
        "bgp confederation identifier (1-4294967295)",
@@ -3655,6 +3683,20 @@ DEFPY (bgp_bestpath_aigp,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_route_target_constraint,
+       bgp_route_target_constraint_cmd,
+       "[no$no] bgp route-target-constraint",
+       NO_STR
+       BGP_STR
+       "Only receive VPN/EVPN routes with imported route targets (RFC 4684)\n")
+{
+	VTY_DECLVAR_CONTEXT(bgp, bgp);
+
+	bgp_rtc_set(bgp, !no);
+
+	return CMD_SUCCESS;
+}
+
 /* "bgp bestpath compare-routerid" configuration.  */
 DEFUN (bgp_bestpath_compare_router_id,
        bgp_bestpath_compare_router_id_cmd,
@@ -9926,7 +9968,7 @@ DEFPY (show_bgp_srv6,
 	}
 
 	vty_out(vty, "functions:\n");
-	for (ALL_LIST_ELEMENTS_RO(bgp->srv6_functions, node, func)) {
+	frr_each (bgp_srv6_functions, &bgp->srv6_functions, func) {
 		vty_out(vty, "- sid: %pI6\n", &func->sid);
 		vty_out(vty, "  locator: %s\n", func->locator_name);
 	}
@@ -13453,6 +13495,19 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 							       "received");
 			}
 
+			/* Route target constraint */
+			if (CHECK_FLAG(p->cap, PEER_CAP_RTC_RCV) ||
+			    CHECK_FLAG(p->cap, PEER_CAP_RTC_ADV)) {
+				const char *rtc = "received";
+
+				if (bgp_rtc_active(p))
+					rtc = "advertisedAndReceived";
+				else if (CHECK_FLAG(p->cap, PEER_CAP_RTC_ADV))
+					rtc = "advertised";
+				json_object_string_add(
+					json_cap, "routeTargetConstraint", rtc);
+			}
+
 			/* Extended nexthop */
 			if (CHECK_FLAG(p->cap, PEER_CAP_ENHE_RCV) ||
 			    CHECK_FLAG(p->cap, PEER_CAP_ENHE_ADV)) {
@@ -13906,6 +13961,21 @@ static void bgp_show_peer(struct vty *vty, struct peer *p, bool use_json,
 				vty_out(vty, "\n");
 			}
 
+			/* Route target constraint */
+			if (CHECK_FLAG(p->cap, PEER_CAP_RTC_RCV) ||
+			    CHECK_FLAG(p->cap, PEER_CAP_RTC_ADV)) {
+				vty_out(vty, "    Route target constraint:");
+				if (CHECK_FLAG(p->cap, PEER_CAP_RTC_ADV))
+					vty_out(vty, " advertised");
+				if (CHECK_FLAG(p->cap, PEER_CAP_RTC_RCV))
+					vty_out(vty, " %sreceived",
+						CHECK_FLAG(p->cap,
+							   PEER_CAP_RTC_ADV)
+							? "and "
+							: "");
+				vty_out(vty, "\n");
+			}
+
 			/* Extended nexthop */
 			if (CHECK_FLAG(p->cap, PEER_CAP_ENHE_RCV) ||
 			    CHECK_FLAG(p->cap, PEER_CAP_ENHE_ADV)) {
@@ -16759,6 +16829,8 @@ DEFPY(bgp_retain_route_target, bgp_retain_route_target_cmd,
 		/* trigger a flush to re-sync with ADJ-RIB-in */
 		bgp_clear(vty, bgp, bgp_node_afi(vty), bgp_node_safi(vty),
 			  clear_all, BGP_CLEAR_SOFT_IN, NULL);
+		/* retaining everything asks peers for everything */
+		bgp_rtc_local_changed();
 	}
 	return CMD_SUCCESS;
 }
@@ -17812,6 +17884,9 @@ int bgp_config_write(struct vty *vty)
 	if (CHECK_FLAG(bm->flags, BM_FLAG_SEND_EXTRA_DATA_TO_ZEBRA))
 		vty_out(vty, "bgp send-extra-data zebra\n");
 
+	if (CHECK_FLAG(bm->flags, BM_FLAG_INSTALL_NHG))
+		vty_out(vty, "bgp install-nexthop-groups\n");
+
 	/* BGP session DSCP value */
 	if (bm->tcp_dscp != IPTOS_PREC_INTERNETCONTROL)
 		vty_out(vty, "bgp session-dscp %u\n", bm->tcp_dscp >> 2);
@@ -17820,6 +17895,13 @@ int bgp_config_write(struct vty *vty)
 	if (bm->inq_limit != BM_DEFAULT_INQ_LIMIT)
 		vty_out(vty, "bgp input-queue-limit %u\n", bm->inq_limit);
 
+	if (CHECK_FLAG(bm->flags, BM_FLAG_MEMPRESSURE_TEARDOWN))
+		vty_out(vty, "bgp memory-pressure teardown\n");
+
+	/* BGP I/O pthreads */
+	if (bm->io_threads != BM_DEFAULT_IO_THREADS)
+		vty_out(vty, "bgp io-threads %u\n", bm->io_threads);
+
 	/* BGP configuration. */
 	for (ALL_LIST_ELEMENTS(bm->bgp, mnode, mnnode, bgp)) {
 
@@ -18085,6 +18167,8 @@ int bgp_config_write(struct vty *vty)
 			vty_out(vty, " bgp bestpath compare-routerid\n");
 		if (CHECK_FLAG(bgp->flags, BGP_FLAG_COMPARE_AIGP))
 			vty_out(vty, " bgp bestpath aigp\n");
+		if (CHECK_FLAG(bgp->flags, BGP_FLAG_RTC))
+			vty_out(vty, " bgp route-target-constraint\n");
 		if (CHECK_FLAG(bgp->flags, BGP_FLAG_MED_CONFED)
 		    || CHECK_FLAG(bgp->flags, BGP_FLAG_MED_MISSING_AS_WORST)) {
 			vty_out(vty, " bgp bestpath med");
@@ -18559,6 +18643,47 @@ DEFPY (no_bgp_inq_limit,
 	return CMD_SUCCESS;
 }
 
+DEFPY (bgp_mempressure_teardown,
+       bgp_mempressure_teardown_cmd,
+       "[no] bgp memory-pressure teardown",
+       NO_STR
+       BGP_STR
+       "React to memory pressure reported by \"service memory-pressure\"\n"
+       "Shut down the peer with the most prefixes when it is critical\n")
+{
+	if (no)
+		UNSET_FLAG(bm->flags, BM_FLAG_MEMPRESSURE_TEARDOWN);
+	else
+		SET_FLAG(bm->flags, BM_FLAG_MEMPRESSURE_TEARDOWN);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (bgp_io_threads,
+       bgp_io_threads_cmd,
+       "bgp io-threads (1-64)$count",
+       BGP_STR
+       "Set the number of pthreads handling peer socket I/O\n"
+       "Number of I/O pthreads\n")
+{
+	bgp_io_threads_set(count);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_bgp_io_threads,
+       no_bgp_io_threads_cmd,
+       "no bgp io-threads [(1-64)$count]",
+       NO_STR
+       BGP_STR
+       "Set the number of pthreads handling peer socket I/O\n"
+       "Number of I/O pthreads\n")
+{
+	bgp_io_threads_set(BM_DEFAULT_IO_THREADS);
+
+	return CMD_SUCCESS;
+}
+
 /* Initialization of BGP interface. */
 static void bgp_vty_if_init(void)
 {
@@ -18612,6 +18737,11 @@ void bgp_vty_init(void)
 	install_element(CONFIG_NODE, &bgp_inq_limit_cmd);
 	install_element(CONFIG_NODE, &no_bgp_inq_limit_cmd);
 
+	/* "global bgp io-threads command */
+	install_element(CONFIG_NODE, &bgp_io_threads_cmd);
+	install_element(CONFIG_NODE, &bgp_mempressure_teardown_cmd);
+	install_element(CONFIG_NODE, &no_bgp_io_threads_cmd);
+
 	/* "bgp local-mac" hidden commands. */
 	install_element(CONFIG_NODE, &bgp_local_mac_cmd);
 	install_element(CONFIG_NODE, &no_bgp_local_mac_cmd);
@@ -18667,6 +18797,7 @@ void bgp_vty_init(void)
 	install_element(CONFIG_NODE, &no_bgp_norib_cmd);
 
 	install_element(CONFIG_NODE, &no_bgp_send_extra_data_cmd);
+	install_element(CONFIG_NODE, &bgp_install_nhg_cmd);
 
 	/* "bgp confederation" commands. */
 	install_element(BGP_NODE, &bgp_confederation_identifier_cmd);
@@ -18834,6 +18965,7 @@ void bgp_vty_init(void)
 
 	/* "bgp bestpath aigp" commands */
 	install_element(BGP_NODE, &bgp_bestpath_aigp_cmd);
+	install_element(BGP_NODE, &bgp_route_target_constraint_cmd);
 
 	/* "bgp bestpath compare-routerid" commands */
 	install_element(BGP_NODE, &bgp_bestpath_compare_router_id_cmd);
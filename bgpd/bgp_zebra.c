@@ -68,6 +68,7 @@
 #include "bgpd/bgp_community.h"
 #include "bgpd/bgp_lcommunity.h"
 #include "bgpd/bgp_orr.h"
+#include "bgpd/bgp_nhg.h"
 
 /* All information about zebra. */
 struct zclient *zclient = NULL;
@@ -556,7 +557,8 @@ static int zebra_read_route(ZAPI_CALLBACK_ARGS)
 {
 	enum nexthop_types_t nhtype;
 	enum blackhole_type bhtype = BLACKHOLE_UNSPEC;
-	struct zapi_route api;
+	struct zapi_route_view api;
+	struct zapi_nexthop api_nh = {};
 	union g_addr nexthop = {};
 	ifindex_t ifindex;
 	int add, i;
@@ -566,7 +568,7 @@ static int zebra_read_route(ZAPI_CALLBACK_ARGS)
 	if (!bgp)
 		return 0;
 
-	if (zapi_route_decode(zclient->ibuf, &api) < 0)
+	if (zapi_route_view_decode(zclient->ibuf, &api) < 0)
 		return -1;
 
 	/* we completely ignore srcdest routes for now. */
@@ -578,15 +580,17 @@ static int zebra_read_route(ZAPI_CALLBACK_ARGS)
 	    && IN6_IS_ADDR_LINKLOCAL(&api.prefix.u.prefix6))
 		return 0;
 
-	ifindex = api.nexthops[0].ifindex;
-	nhtype = api.nexthops[0].type;
+	/* only the first nexthop is used */
+	zapi_route_view_nexthop(&api, &api_nh);
+	ifindex = api_nh.ifindex;
+	nhtype = api_nh.type;
 
 	/* api_nh structure has union of gate and bh_type */
 	if (nhtype == NEXTHOP_TYPE_BLACKHOLE) {
 		/* bh_type is only applicable if NEXTHOP_TYPE_BLACKHOLE*/
-		bhtype = api.nexthops[0].bh_type;
+		bhtype = api_nh.bh_type;
 	} else
-		nexthop = api.nexthops[0].gate;
+		nexthop = api_nh.gate;
 
 	add = (cmd == ZEBRA_REDISTRIBUTE_ROUTE_ADD);
 	if (add) {
@@ -1295,9 +1299,10 @@ static bool bgp_zebra_use_nhop_weighted(struct bgp *bgp, struct attr *attr,
 	return true;
 }
 
-void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
-			struct bgp_path_info *info, struct bgp *bgp, afi_t afi,
-			safi_t safi)
+static void bgp_zebra_announce_route(struct bgp_dest *dest,
+				     const struct prefix *p,
+				     struct bgp_path_info *info,
+				     struct bgp *bgp, afi_t afi, safi_t safi)
 {
 	struct zapi_route api = { 0 };
 	struct zapi_nexthop *api_nh;
@@ -1320,6 +1325,8 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 	bool do_wt_ecmp;
 	uint64_t cum_bw = 0;
 	uint32_t nhg_id = 0;
+	struct bgp_nhg_cache *nhg = NULL;
+	struct bgp_path_info *nh_paths[MULTIPATH_NUM];
 	bool is_add;
 	uint32_t ttl = 0;
 	uint32_t bos = 0;
@@ -1560,6 +1567,7 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 			SET_FLAG(api_nh->flags, ZAPI_NEXTHOP_FLAG_SEG6);
 		}
 
+		nh_paths[valid_nh_count] = mpinfo;
 		valid_nh_count++;
 	}
 
@@ -1570,18 +1578,21 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 		const char *reason =
 			bgp_path_selection_reason2str(dest->reason);
 
-		strlcpy(bzo.aspath, info->attr->aspath->str,
+		strlcpy(bzo.aspath, aspath_print(info->attr->aspath),
 			sizeof(bzo.aspath));
 
 		if (info->attr->flag & ATTR_FLAG_BIT(BGP_ATTR_COMMUNITIES))
 			strlcpy(bzo.community,
-				bgp_attr_get_community(info->attr)->str,
+				community_str(bgp_attr_get_community(info->attr),
+					      false, true),
 				sizeof(bzo.community));
 
 		if (info->attr->flag
 		    & ATTR_FLAG_BIT(BGP_ATTR_LARGE_COMMUNITIES))
 			strlcpy(bzo.lcommunity,
-				bgp_attr_get_lcommunity(info->attr)->str,
+				lcommunity_str(
+					bgp_attr_get_lcommunity(info->attr),
+					false, true),
 				sizeof(bzo.lcommunity));
 
 		strlcpy(bzo.selection_reason, reason,
@@ -1620,6 +1631,12 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 		api.distance = distance;
 	}
 
+	if (is_add && !nhg_id) {
+		nhg = bgp_nhg_route_get(&api, nh_paths);
+		if (nhg)
+			nhg_id = nhg->id;
+	}
+
 	if (bgp_debug_zebra(p)) {
 		char nh_buf[INET6_ADDRSTRLEN];
 		char eth_buf[ETHER_ADDR_STRLEN + 7] = {'\0'};
@@ -1699,6 +1716,18 @@ void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
 	}
 	zclient_route_send(is_add ? ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
 			   zclient, &api);
+	bgp_nhg_route_done(dest, nhg);
+}
+
+void bgp_zebra_announce(struct bgp_dest *dest, const struct prefix *p,
+			struct bgp_path_info *info, struct bgp *bgp, afi_t afi,
+			safi_t safi)
+{
+	int64_t start = bgp_pipeline_now();
+
+	bgp_zebra_announce_route(dest, p, info, bgp, afi, safi);
+	bgp_pipeline_record(&bgp->pipeline, bgp->name_pretty, afi,
+			    BGP_PIPELINE_ZEBRA, start);
 }
 
 /* Announce all routes of a table to zebra */
@@ -1789,6 +1818,8 @@ void bgp_zebra_withdraw(const struct prefix *p, struct bgp_path_info *info,
 			   &api.prefix);
 
 	zclient_route_send(ZEBRA_ROUTE_DELETE, zclient, &api);
+	if (info->net)
+		bgp_nhg_route_done(info->net, NULL);
 }
 
 /* Withdraw all entries in a BGP instances RIB table from Zebra */
@@ -2394,6 +2425,7 @@ static int rule_notify_owner(ZAPI_CALLBACK_ARGS)
 		} else {
 			bgp_pbr->installed = false;
 			bgp_pbr->install_in_progress = false;
+			timerclear(&bgp_pbr->install_time);
 		}
 		break;
 	case ZAPI_RULE_INSTALLED:
@@ -2406,6 +2438,7 @@ static int rule_notify_owner(ZAPI_CALLBACK_ARGS)
 
 			bgp_pbr->installed = true;
 			bgp_pbr->install_in_progress = false;
+			bgp_pbr_install_done(vrf_id, &bgp_pbr->install_time);
 			bgp_pbr->action->refcnt++;
 			/* link bgp_info to bgp_pbr */
 			path = (struct bgp_path_info *)bgp_pbr->path;
@@ -2499,6 +2532,7 @@ static int ipset_entry_notify_owner(ZAPI_CALLBACK_ARGS)
 				   __func__);
 		bgp_pbime->installed = false;
 		bgp_pbime->install_in_progress = false;
+		timerclear(&bgp_pbime->install_time);
 		break;
 	case ZAPI_IPSET_ENTRY_INSTALLED:
 		{
@@ -2507,6 +2541,7 @@ static int ipset_entry_notify_owner(ZAPI_CALLBACK_ARGS)
 
 		bgp_pbime->installed = true;
 		bgp_pbime->install_in_progress = false;
+		bgp_pbr_install_done(vrf_id, &bgp_pbime->install_time);
 		if (BGP_DEBUG(zebra, ZEBRA))
 			zlog_debug("%s: Received IPSET_ENTRY_INSTALLED",
 				   __func__);
@@ -2824,6 +2859,9 @@ static void bgp_zebra_connected(struct zclient *zclient)
 	/* Send the client registration */
 	bfd_client_sendmsg(zclient, ZEBRA_BFD_CLIENT_REGISTER, VRF_DEFAULT);
 
+	/* Shared nexthop groups must exist before routes reference them */
+	bgp_nhg_zebra_replay();
+
 	/* At this point, we may or may not have BGP instances configured, but
 	 * we're only interested in the default VRF (others wouldn't have learnt
 	 * the VRF from Zebra yet.)
@@ -3281,15 +3319,13 @@ static int bgp_zebra_process_srv6_locator_delete(ZAPI_CALLBACK_ARGS)
 		}
 
 	// refresh functions
-	for (ALL_LIST_ELEMENTS(bgp->srv6_functions, node, nnode, func)) {
+	frr_each_safe (bgp_srv6_functions, &bgp->srv6_functions, func) {
 		tmp_prefi.family = AF_INET6;
 		tmp_prefi.prefixlen = 128;
 		tmp_prefi.prefix = func->sid;
 		if (prefix_match((struct prefix *)&loc.prefix,
-				 (struct prefix *)&tmp_prefi)) {
-			listnode_delete(bgp->srv6_functions, func);
-			XFREE(MTYPE_BGP_SRV6_FUNCTION, func);
-		}
+				 (struct prefix *)&tmp_prefi))
+			bgp_srv6_function_del(bgp, func);
 	}
 
 	// refresh tovpn_sid
@@ -3507,8 +3543,10 @@ void bgp_send_pbr_rule_action(struct bgp_pbr_action *pbra,
 	    && install) {
 		if (!pbr)
 			pbra->install_in_progress = true;
-		else
+		else {
 			pbr->install_in_progress = true;
+			monotime(&pbr->install_time);
+		}
 	}
 }
 
@@ -3563,8 +3601,11 @@ void bgp_send_pbr_ipset_entry_match(struct bgp_pbr_match_entry *pbrime,
 	bgp_encode_pbr_ipset_entry_match(s, pbrime);
 
 	stream_putw_at(s, 0, stream_get_endp(s));
-	if ((zclient_send_message(zclient) != ZCLIENT_SEND_FAILURE) && install)
+	if ((zclient_send_message(zclient) != ZCLIENT_SEND_FAILURE)
+	    && install) {
 		pbrime->install_in_progress = true;
+		monotime(&pbrime->install_time);
+	}
 }
 
 static void bgp_encode_pbr_interface_list(struct bgp *bgp, struct stream *s,
@@ -30,6 +30,7 @@
 #include "sockopt.h"
 #include "network.h"
 #include "memory.h"
+#include "mempressure.h"
 #include "filter.h"
 #include "routemap.h"
 #include "log.h"
@@ -78,6 +79,7 @@
 #include "bgpd/bgp_vty.h"
 #include "bgpd/bgp_mpath.h"
 #include "bgpd/bgp_nht.h"
+#include "bgpd/bgp_nhg.h"
 #include "bgpd/bgp_updgrp.h"
 #include "bgpd/bgp_bfd.h"
 #include "bgpd/bgp_memory.h"
@@ -93,6 +95,8 @@
 #include "bgpd/bgp_evpn_mh.h"
 #include "bgpd/bgp_mac.h"
 #include "bgpd/bgp_orr.h"
+#include "bgpd/bgp_rtc.h"
+#include "bgpd/bgp_snapshot.h"
 
 DEFINE_MTYPE_STATIC(BGPD, PEER_TX_SHUTDOWN_MSG, "Peer shutdown message (TX)");
 DEFINE_MTYPE_STATIC(BGPD, BGP_EVPN_INFO, "BGP EVPN instance information");
@@ -1131,6 +1135,7 @@ static void peer_free(struct peer *peer)
 	thread_cancel_event_ready(bm->master, peer);
 	FOREACH_AFI_SAFI (afi, safi)
 		THREAD_OFF(peer->t_revalidate_all[afi][safi]);
+	bgp_rtc_peer_reset(peer);
 	assert(!peer->t_write);
 	assert(!peer->t_read);
 	BGP_EVENT_FLUSH(peer);
@@ -1150,6 +1155,7 @@ static void peer_free(struct peer *peer)
 		if (peer->filter[afi][safi].advmap.cname)
 			XFREE(MTYPE_BGP_FILTER_NAME,
 			      peer->filter[afi][safi].advmap.cname);
+		bgp_peer_paths_fini(&peer->paths[afi][safi]);
 	}
 
 	XFREE(MTYPE_PEER_TX_SHUTDOWN_MSG, peer->tx_shutdown_message);
@@ -1336,15 +1342,20 @@ static void bgp_srv6_init(struct bgp *bgp)
 	bgp->srv6_enabled = false;
 	memset(bgp->srv6_locator_name, 0, sizeof(bgp->srv6_locator_name));
 	bgp->srv6_locator_chunks = list_new();
-	bgp->srv6_functions = list_new();
+	bgp_srv6_functions_init(&bgp->srv6_functions);
+	bgp_srv6_sid_maps_init(&bgp->srv6_sid_maps);
 }
 
 static void bgp_srv6_cleanup(struct bgp *bgp)
 {
+	struct bgp_srv6_function *func;
+
 	if (bgp->srv6_locator_chunks)
 		list_delete(&bgp->srv6_locator_chunks);
-	if (bgp->srv6_functions)
-		list_delete(&bgp->srv6_functions);
+	frr_each_safe (bgp_srv6_functions, &bgp->srv6_functions, func)
+		bgp_srv6_function_del(bgp, func);
+	bgp_srv6_functions_fini(&bgp->srv6_functions);
+	bgp_srv6_sid_maps_fini(&bgp->srv6_sid_maps);
 }
 
 /* Allocate new peer object, implicitely locked.  */
@@ -1391,6 +1402,7 @@ struct peer *peer_new(struct bgp *bgp)
 			 PEER_FLAG_SEND_LARGE_COMMUNITY);
 		peer->addpath_type[afi][safi] = BGP_ADDPATH_NONE;
 		peer->soo[afi][safi] = NULL;
+		bgp_peer_paths_init(&peer->paths[afi][safi]);
 	}
 
 	/* set nexthop-unchanged for l2vpn evpn by default */
@@ -2629,6 +2641,7 @@ int peer_delete(struct peer *peer)
 		XFREE(MTYPE_ROUTE_MAP_NAME, peer->default_rmap[afi][safi].name);
 		ecommunity_free(&peer->soo[afi][safi]);
 	}
+	bgp_conditional_adv_maps_reset(bgp);
 
 	FOREACH_AFI_SAFI (afi, safi)
 		peer_af_delete(peer, afi, safi);
@@ -3569,6 +3582,7 @@ int bgp_get(struct bgp **bgp_val, as_t *as, const char *name,
 	 */
 	bgp_handle_socket(bgp, vrf, VRF_UNKNOWN, true);
 	listnode_add(bm->bgp, bgp);
+	vpn_leak_import_index_reset();
 
 	if (IS_BGP_INST_KNOWN_TO_ZEBRA(bgp)) {
 		if (BGP_DEBUG(zebra, ZEBRA))
@@ -3707,14 +3721,12 @@ int bgp_delete(struct bgp *bgp)
 
 	hook_call(bgp_inst_delete, bgp);
 
-	FOREACH_AFI_SAFI (afi, safi)
-		THREAD_OFF(bgp->t_revalidate[afi][safi]);
-
 	THREAD_OFF(bgp->t_condition_check);
 	THREAD_OFF(bgp->t_startup);
 	THREAD_OFF(bgp->t_maxmed_onstartup);
 	THREAD_OFF(bgp->t_update_delay);
 	THREAD_OFF(bgp->t_establish_wait);
+	bgp_rtc_delete(bgp);
 
 	/* Set flag indicating bgp instance delete in progress */
 	SET_FLAG(bgp->flags, BGP_FLAG_DELETE_IN_PROGRESS);
@@ -3837,6 +3849,7 @@ int bgp_delete(struct bgp *bgp)
 	 * routes to be processed still referencing the struct bgp.
 	 */
 	listnode_delete(bm->bgp, bgp);
+	vpn_leak_import_index_reset();
 
 	/* Free interfaces in this instance. */
 	bgp_if_finish(bgp);
@@ -3904,6 +3917,7 @@ void bgp_free(struct bgp *bgp)
 	bgp_scan_finish(bgp);
 	bgp_address_destroy(bgp);
 	bgp_tip_hash_destroy(bgp);
+	bgp_conditional_adv_maps_free(bgp);
 
 	/* release the auto RD id */
 	bf_release_index(bm->rd_idspace, bgp->vrf_rd_id);
@@ -4874,6 +4888,10 @@ static int peer_af_flag_modify(struct peer *peer, afi_t afi, safi_t safi,
 		}
 	}
 
+	/* route reflectors ask for all VPN routes (bgp_rtc.c) */
+	if (flag == PEER_FLAG_REFLECTOR_CLIENT && bgp_rtc_safi(safi))
+		bgp_rtc_local_changed();
+
 	return 0;
 }
 
@@ -7938,6 +7956,7 @@ void bgp_master_init(struct thread_master *master, const int buffer_size,
 	bm->wait_for_fib = false;
 	bm->tcp_dscp = IPTOS_PREC_INTERNETCONTROL;
 	bm->inq_limit = BM_DEFAULT_INQ_LIMIT;
+	bm->io_threads = BM_DEFAULT_IO_THREADS;
 
 	bgp_mac_init();
 	/* init the rd id space.
@@ -7951,6 +7970,7 @@ void bgp_master_init(struct thread_master *master, const int buffer_size,
 	bgp_lp_init(bm->master, &bm->labelpool);
 
 	bgp_l3nhg_init();
+	bgp_nhg_init();
 	bgp_evpn_mh_init();
 	QOBJ_REG(bm, bgp_master);
 }
@@ -8045,11 +8065,12 @@ static void bgp_pthreads_init(void)
 
 void bgp_pthreads_run(void)
 {
-	frr_pthread_run(bgp_pth_io, NULL);
+	/* Starts bgp_pth_io and any additional configured I/O pthreads */
+	bgp_io_threads_run();
+
 	frr_pthread_run(bgp_pth_ka, NULL);
 
 	/* Wait until threads are ready. */
-	frr_pthread_wait_running(bgp_pth_io);
 	frr_pthread_wait_running(bgp_pth_ka);
 }
 
@@ -8082,9 +8103,66 @@ static int peer_unshut_after_cfg(struct bgp *bgp)
 	return 0;
 }
 
+/* seconds between two memory pressure teardowns, to let the first one
+ * actually release its routes before judging whether it was enough
+ */
+#define BGP_MEMPRESSURE_HOLDDOWN 30
+
+static int bgp_mempressure_change(enum mempressure_level level,
+				  enum mempressure_level prev)
+{
+	static time_t last_teardown;
+	struct listnode *node, *pnode;
+	struct bgp *bgp;
+	struct peer *peer, *victim = NULL;
+	uint64_t count, most = 0;
+	afi_t afi;
+	safi_t safi;
+
+	if (level != MEMPRESSURE_CRITICAL
+	    || !CHECK_FLAG(bm->flags, BM_FLAG_MEMPRESSURE_TEARDOWN))
+		return 0;
+	if (last_teardown
+	    && monotime(NULL) - last_teardown < BGP_MEMPRESSURE_HOLDDOWN)
+		return 0;
+
+	/* the adj-in / RIB memory of a peer is about its prefix count */
+	for (ALL_LIST_ELEMENTS_RO(bm->bgp, node, bgp)) {
+		for (ALL_LIST_ELEMENTS_RO(bgp->peer, pnode, peer)) {
+			if (!peer_established(peer))
+				continue;
+
+			count = 0;
+			FOREACH_AFI_SAFI (afi, safi)
+				count += peer->pcount[afi][safi];
+			if (count > most) {
+				most = count;
+				victim = peer;
+			}
+		}
+	}
+
+	if (!victim)
+		return 0;
+
+	flog_warn(EC_BGP_MEMORY_PRESSURE_TEARDOWN,
+		  "%pBP: shutting down session with %" PRIu64
+		  " prefixes due to critical memory pressure",
+		  victim, most);
+
+	last_teardown = monotime(NULL);
+
+	/* same as exceeding maximum-prefix: stay down until cleared */
+	SET_FLAG(victim->sflags, PEER_STATUS_PREFIX_OVERFLOW);
+	bgp_notify_send(victim, BGP_NOTIFY_CEASE,
+			BGP_NOTIFY_CEASE_OUT_OF_RESOURCE);
+	return 0;
+}
+
 void bgp_init(unsigned short instance)
 {
 	hook_register(bgp_config_end, peer_unshut_after_cfg);
+	hook_register(mempressure_change, bgp_mempressure_change);
 
 	/* allocates some vital data structures used by peer commands in
 	 * vty_init */
@@ -8139,6 +8217,10 @@ void bgp_init(unsigned short instance)
 	bgp_bfd_init(bm->master);
 
 	bgp_lp_vty_init();
+	bgp_pipeline_vty_init();
+	bgp_snapshot_vty_init();
+	bgp_rtc_init();
+	bgp_rtc_vty_init();
 
 	cmd_variable_handler_register(bgp_viewvrf_var_handlers);
 }
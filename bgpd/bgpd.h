@@ -45,6 +45,7 @@
 #include "bgp_addpath_types.h"
 #include "bgp_nexthop.h"
 #include "bgp_io.h"
+#include "bgp_pipeline.h"
 
 #include "lib/bfd.h"
 #include "lib/orr_msg.h"
@@ -108,6 +109,9 @@ enum bgp_af_index {
 extern struct frr_pthread *bgp_pth_io;
 extern struct frr_pthread *bgp_pth_ka;
 
+/* Upper bound for "bgp io-threads" */
+#define BGP_IO_THREADS_MAX 64
+
 /* BGP master for system wide configurations and variables.  */
 struct bgp_master {
 	/* BGP instance list.  */
@@ -171,6 +175,8 @@ struct bgp_master {
 	uint32_t flags;
 #define BM_FLAG_GRACEFUL_SHUTDOWN        (1 << 0)
 #define BM_FLAG_SEND_EXTRA_DATA_TO_ZEBRA (1 << 1)
+#define BM_FLAG_INSTALL_NHG              (1 << 2)
+#define BM_FLAG_MEMPRESSURE_TEARDOWN     (1 << 3)
 
 	bool terminating;	/* global flag that sigint terminate seen */
 
@@ -180,6 +186,10 @@ struct bgp_master {
 #define BM_DEFAULT_INQ_LIMIT 10000
 	uint32_t inq_limit;
 
+	/* Number of I/O pthreads peers are spread across */
+#define BM_DEFAULT_IO_THREADS 1
+	uint8_t io_threads;
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(bgp_master);
@@ -368,11 +378,40 @@ struct bgp_snmp_stats {
 	uint32_t routes_deleted;
 };
 
+PREDECL_RBTREE_UNIQ(bgp_srv6_functions);
+PREDECL_DLIST(bgp_srv6_sid_maps);
+
+/* Function indexes in use in one locator chunk, SIDs are allocated from
+ * this instead of probing for unused ones.
+ */
+struct bgp_srv6_sid_map {
+	struct bgp_srv6_sid_maps_item itm;
+	struct prefix_ipv6 prefix;
+	uint32_t index_max;
+	/* indexes that give a reserved label are set from the start */
+	bitfield_t used;
+	/* functions allocated from this map */
+	uint32_t count;
+};
+
 struct bgp_srv6_function {
+	struct bgp_srv6_functions_item itm;
 	struct in6_addr sid;
 	char locator_name[SRV6_LOCNAME_SIZE];
+	struct bgp_srv6_sid_map *map;
+	uint32_t index;
 };
 
+static inline int bgp_srv6_function_cmp(const struct bgp_srv6_function *a,
+					const struct bgp_srv6_function *b)
+{
+	return memcmp(&a->sid, &b->sid, sizeof(a->sid));
+}
+
+DECLARE_RBTREE_UNIQ(bgp_srv6_functions, struct bgp_srv6_function, itm,
+		    bgp_srv6_function_cmp);
+DECLARE_DLIST(bgp_srv6_sid_maps, struct bgp_srv6_sid_map, itm);
+
 /* BGP instance structure.  */
 struct bgp {
 	/* AS number of this BGP instance.  */
@@ -470,7 +509,6 @@ struct bgp {
 	/* BGP update delay on startup */
 	struct thread *t_update_delay;
 	struct thread *t_establish_wait;
-	struct thread *t_revalidate[AFI_MAX][SAFI_MAX];
 
 	uint8_t update_delay_over;
 	uint8_t main_zebra_update_hold;
@@ -539,6 +577,8 @@ struct bgp {
 #define BGP_FLAG_HARD_ADMIN_RESET (1ULL << 31)
 /* Evaluate the AIGP attribute during the best path selection process */
 #define BGP_FLAG_COMPARE_AIGP (1ULL << 32)
+/* Negotiate route target constraint (RFC 4684) with VPN/EVPN peers */
+#define BGP_FLAG_RTC (1ULL << 33)
 
 	/* BGP default address-families.
 	 * New peers inherit enabled afi/safis from bgp instance.
@@ -802,6 +842,8 @@ struct bgp {
 
 	/* Process Queue for handling routes */
 	struct work_queue *process_queue;
+	/* latency of the process and zebra stages, per AFI */
+	struct bgp_pipeline pipeline;
 
 	bool fast_convergence;
 
@@ -810,11 +852,21 @@ struct bgp {
 	uint32_t condition_filter_count;
 	struct thread *t_condition_check;
 
+	/* Distinct condition-maps in use per table, rebuilt on demand */
+	bool condition_maps_valid;
+	struct route_map **condition_maps[AFI_MAX][SAFI_MAX];
+	uint32_t condition_map_count[AFI_MAX][SAFI_MAX];
+
+	/* A route changed whether it matches a condition-map */
+	bool condition_table_change[AFI_MAX][SAFI_MAX];
+
 	/* BGP VPN SRv6 backend */
 	bool srv6_enabled;
 	char srv6_locator_name[SRV6_LOCNAME_SIZE];
 	struct list *srv6_locator_chunks;
-	struct list *srv6_functions;
+	/* by SID */
+	struct bgp_srv6_functions_head srv6_functions;
+	struct bgp_srv6_sid_maps_head srv6_sid_maps;
 	uint32_t tovpn_sid_index; /* unset => set to 0 */
 	struct in6_addr *tovpn_sid;
 	struct srv6_locator_chunk *tovpn_sid_locator;
@@ -835,6 +887,9 @@ struct bgp {
 	uint32_t orr_group_count;
 	struct list *orr_group[AFI_MAX][SAFI_MAX];
 
+	/* Route target constraint, local memberships (bgp_rtc.c) */
+	struct bgp_rtc *rtc;
+
 	QOBJ_FIELDS;
 };
 DECLARE_QOBJ_TYPE(bgp);
@@ -1136,6 +1191,9 @@ struct llgr_info {
 	uint8_t flags;
 };
 
+/* bgp_path_infos of a peer, see struct peer's paths */
+PREDECL_DLIST(bgp_peer_paths);
+
 /* BGP neighbor structure. */
 struct peer {
 	/* BGP structure.  */
@@ -1173,14 +1231,14 @@ struct peer {
 	/* Local router ID. */
 	struct in_addr local_id;
 
+	/* Index of the I/O pthread serving this peer, see bgp_io.c */
+	uint8_t io_pth;
+
 	/* Packet receive and send buffer. */
 	pthread_mutex_t io_mtx;   // guards ibuf, obuf
 	struct stream_fifo *ibuf; // packets waiting to be processed
 	struct stream_fifo *obuf; // packets waiting to be written
 
-	/* used as a block to deposit raw wire data to */
-	uint8_t ibuf_scratch[BGP_EXTENDED_MESSAGE_MAX_PACKET_SIZE
-			     * BGP_READ_PACKET_MAX];
 	struct ringbuf *ibuf_work; // WiP buffer used by bgp_read() only
 	struct stream *obuf_work;  // WiP buffer used to construct packets
 
@@ -1288,6 +1346,8 @@ struct peer {
 #define PEER_CAP_GRACEFUL_RESTART_N_BIT_RCV (1U << 24)
 #define PEER_CAP_ROLE_ADV                   (1U << 25) /* role advertised */
 #define PEER_CAP_ROLE_RCV                   (1U << 26) /* role received */
+#define PEER_CAP_RTC_ADV (1U << 27) /* route target constraint advertised */
+#define PEER_CAP_RTC_RCV (1U << 28) /* route target constraint received */
 
 	/* Capability flags (reset in bgp_stop) */
 	uint32_t af_cap[AFI_MAX][SAFI_MAX];
@@ -1508,6 +1568,8 @@ struct peer {
 #define PEER_STATUS_NSF_WAIT          (1U << 6) /* wait comeback peer */
 /* received extended format encoding for OPEN message */
 #define PEER_STATUS_EXT_OPT_PARAMS_LENGTH (1U << 7)
+/* has stale paths restored from a RIB snapshot (bgp_snapshot.c) */
+#define PEER_STATUS_RIB_RESTORED      (1U << 8)
 
 	/* Peer status af flags (reset in bgp_stop) */
 	uint16_t af_sflags[AFI_MAX][SAFI_MAX];
@@ -1527,6 +1589,21 @@ struct peer {
 #define PEER_STATUS_REFRESH_PENDING (1U << 12) /* refresh request from peer */
 #define PEER_STATUS_RTT_SHUTDOWN (1U << 13) /* In shutdown state due to RTT */
 
+	/* Peer is on the soft_reconfig_peers list of bgp->rib[afi][safi],
+	 * see bgp_soft_reconfig_in().
+	 */
+	bool soft_reconfig_pending[AFI_MAX][SAFI_MAX];
+
+	/* All paths from this peer in tables of that AFI/SAFI, between
+	 * bgp_path_info_add() and bgp_path_info_reap().  Besides the peer's
+	 * bgp->rib this includes copies in other tables (EVPN VNI tables,
+	 * VRF leaking), check bgp_dest_table(pi->net) when that matters.
+	 */
+	struct bgp_peer_paths_head paths[AFI_MAX][SAFI_MAX];
+
+	/* Number of bgp_adj_in entries of this peer, per AFI/SAFI. */
+	uint32_t adj_in_count[AFI_MAX][SAFI_MAX];
+
 	/* Configured timer values. */
 	_Atomic uint32_t holdtime;
 	_Atomic uint32_t keepalive;
@@ -1642,6 +1719,13 @@ struct peer {
 	 */
 	time_t last_sendq_ok, last_sendq_warn;
 
+	/* Also under io_mtx: when the oldest packet on ibuf was read and the
+	 * oldest one on obuf was queued, see bgp_pipeline_now()
+	 */
+	int64_t ibuf_stamp, obuf_stamp;
+	/* latency of the read, parse, update and write stages */
+	struct bgp_pipeline pipeline;
+
 	/* Notify data. */
 	struct bgp_notify notify;
 
@@ -1676,12 +1760,27 @@ struct peer {
 	/* ORF Prefix-list */
 	struct prefix_list *orf_plist[AFI_MAX][SAFI_MAX];
 
+	/* Route target constraint, memberships received (bgp_rtc.c), and
+	 * the VPN/EVPN outbound filter built from them.  No filter means
+	 * no constraint.
+	 */
+	struct bgp_rtc_peer *rtc;
+	struct bgp_rtc_filter *rtc_filter;
+
 	/* Text description of last attribute rcvd */
 	char rcvd_attr_str[BUFSIZ];
 
 	/* Track if we printed the attribute in debugs */
 	int rcvd_attr_printed;
 
+	/* Raw path attributes of the last UPDATE parsed in the current
+	 * bgp_process_packet() run and the parse result, so that following
+	 * UPDATEs with identical attributes skip bgp_attr_parse().
+	 */
+	uint8_t *upd_attr_raw;
+	bgp_size_t upd_attr_len;
+	struct attr *upd_attr;
+
 	/* Accepted prefix count */
 	uint32_t pcount[AFI_MAX][SAFI_MAX];
 
@@ -183,6 +183,7 @@ void eigrp_nbr_delete(struct eigrp_neighbor *nbr)
 	eigrp_fifo_free(nbr->multicast_queue);
 	eigrp_fifo_free(nbr->retrans_queue);
 	THREAD_OFF(nbr->t_holddown);
+	eigrp_reply_pending_free(nbr);
 
 	if (nbr->ei)
 		listnode_delete(nbr->ei->nbrs, nbr);
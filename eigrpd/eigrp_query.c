@@ -227,7 +227,7 @@ void eigrp_send_query(struct eigrp_interface *ei)
 			}
 
 			has_tlv = false;
-			length = 0;
+			length = EIGRP_HEADER_LEN;
 			eigrp_packet_free(ep);
 			ep = NULL;
 			new_packet = true;
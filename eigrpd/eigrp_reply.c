@@ -60,46 +60,10 @@
 #include "eigrpd/eigrp_fsm.h"
 #include "eigrpd/eigrp_errors.h"
 
-void eigrp_send_reply(struct eigrp_neighbor *nbr,
-		      struct eigrp_prefix_descriptor *pe)
+static void eigrp_reply_queue(struct eigrp_neighbor *nbr,
+			      struct eigrp_packet *ep, uint16_t length)
 {
-	struct eigrp_packet *ep;
-	uint16_t length = EIGRP_HEADER_LEN;
 	struct eigrp_interface *ei = nbr->ei;
-	struct eigrp *eigrp = ei->eigrp;
-	struct eigrp_prefix_descriptor *pe2;
-
-	// TODO: Work in progress
-	/* Filtering */
-	/* get list from eigrp process */
-	pe2 = XCALLOC(MTYPE_EIGRP_PREFIX_DESCRIPTOR,
-		      sizeof(struct eigrp_prefix_descriptor));
-	memcpy(pe2, pe, sizeof(struct eigrp_prefix_descriptor));
-
-	if (eigrp_update_prefix_apply(eigrp, ei, EIGRP_FILTER_OUT,
-				      pe2->destination)) {
-		zlog_info("REPLY SEND: Setting Metric to max");
-		pe2->reported_metric.delay = EIGRP_MAX_METRIC;
-	}
-
-	/*
-	 * End of filtering
-	 */
-
-	ep = eigrp_packet_new(EIGRP_PACKET_MTU(ei->ifp->mtu), nbr);
-
-	/* Prepare EIGRP INIT UPDATE header */
-	eigrp_packet_header_init(EIGRP_OPC_REPLY, eigrp, ep->s, 0,
-				 eigrp->sequence_number, 0);
-
-	// encode Authentication TLV, if needed
-	if (ei->params.auth_type == EIGRP_AUTH_TYPE_MD5
-	    && (ei->params.auth_keychain != NULL)) {
-		length += eigrp_add_authTLV_MD5_to_stream(ep->s, ei);
-	}
-
-
-	length += eigrp_add_internalTLV_to_stream(ep->s, pe2);
 
 	if ((ei->params.auth_type == EIGRP_AUTH_TYPE_MD5)
 	    && (ei->params.auth_keychain != NULL)) {
@@ -113,7 +77,7 @@ void eigrp_send_reply(struct eigrp_neighbor *nbr,
 	ep->dst.s_addr = nbr->src.s_addr;
 
 	/*This ack number we await from neighbor*/
-	ep->sequence_number = eigrp->sequence_number;
+	ep->sequence_number = ei->eigrp->sequence_number;
 
 	/*Put packet to retransmission queue*/
 	eigrp_fifo_push(nbr->retrans_queue, ep);
@@ -121,8 +85,115 @@ void eigrp_send_reply(struct eigrp_neighbor *nbr,
 	if (nbr->retrans_queue->count == 1) {
 		eigrp_send_packet_reliably(nbr);
 	}
+}
+
+/*
+ * Send the replies queued for a neighbor, as many per packet as fit.
+ * The prefixes are looked up again, a prefix that went away in the
+ * meantime is replied to as unreachable.
+ */
+static void eigrp_reply_send_pending(struct thread *thread)
+{
+	struct eigrp_neighbor *nbr = THREAD_ARG(thread);
+	struct eigrp_interface *ei = nbr->ei;
+	struct eigrp *eigrp = ei->eigrp;
+	struct eigrp_packet *ep = NULL;
+	uint16_t length = EIGRP_HEADER_LEN;
+	uint16_t eigrp_mtu = EIGRP_PACKET_MTU(ei->ifp->mtu);
+	struct listnode *node, *nnode;
+	struct prefix *p;
+
+	for (ALL_LIST_ELEMENTS(nbr->reply_pending, node, nnode, p)) {
+		struct eigrp_prefix_descriptor *pe, pe2;
+
+		// TODO: Work in progress
+		/* Filtering */
+		/* get list from eigrp process */
+		pe = eigrp_topology_table_lookup_ipv4(eigrp->topology_table,
+						      p);
+		if (pe)
+			memcpy(&pe2, pe, sizeof(pe2));
+		else {
+			memset(&pe2, 0, sizeof(pe2));
+			pe2.destination = p;
+			pe2.reported_metric.delay = EIGRP_MAX_METRIC;
+		}
+
+		if (eigrp_update_prefix_apply(eigrp, ei, EIGRP_FILTER_OUT,
+					      pe2.destination)) {
+			zlog_info("REPLY SEND: Setting Metric to max");
+			pe2.reported_metric.delay = EIGRP_MAX_METRIC;
+		}
+
+		/*
+		 * End of filtering
+		 */
+
+		if (!ep) {
+			ep = eigrp_packet_new(eigrp_mtu, nbr);
+
+			/* Prepare EIGRP INIT UPDATE header */
+			eigrp_packet_header_init(EIGRP_OPC_REPLY, eigrp, ep->s,
+						 0, eigrp->sequence_number, 0);
+
+			// encode Authentication TLV, if needed
+			if (ei->params.auth_type == EIGRP_AUTH_TYPE_MD5
+			    && (ei->params.auth_keychain != NULL)) {
+				length += eigrp_add_authTLV_MD5_to_stream(ep->s,
+									  ei);
+			}
+		}
+
+		length += eigrp_add_internalTLV_to_stream(ep->s, &pe2);
+
+		if (length + EIGRP_TLV_MAX_IPV4_BYTE > eigrp_mtu) {
+			eigrp_reply_queue(nbr, ep, length);
+			ep = NULL;
+			length = EIGRP_HEADER_LEN;
+		}
+
+		prefix_free(&p);
+		list_delete_node(nbr->reply_pending, node);
+	}
+
+	if (ep)
+		eigrp_reply_queue(nbr, ep, length);
+}
+
+/*
+ * Replies are not sent right away: the queries in one packet, or a
+ * neighbor going down, usually make us reply for many prefixes at once to
+ * the same neighbor, and those are packed together.
+ */
+void eigrp_send_reply(struct eigrp_neighbor *nbr,
+		      struct eigrp_prefix_descriptor *pe)
+{
+	struct prefix *p;
+
+	if (!nbr->reply_pending)
+		nbr->reply_pending = list_new();
+
+	p = prefix_new();
+	prefix_copy(p, pe->destination);
+	listnode_add(nbr->reply_pending, p);
+
+	thread_add_event(master, eigrp_reply_send_pending, nbr, 0,
+			 &nbr->t_reply);
+}
+
+void eigrp_reply_pending_free(struct eigrp_neighbor *nbr)
+{
+	struct listnode *node, *nnode;
+	struct prefix *p;
+
+	THREAD_OFF(nbr->t_reply);
+
+	if (!nbr->reply_pending)
+		return;
 
-	XFREE(MTYPE_EIGRP_PREFIX_DESCRIPTOR, pe2);
+	for (ALL_LIST_ELEMENTS(nbr->reply_pending, node, nnode, p))
+		prefix_free(&p);
+	list_delete(&nbr->reply_pending);
 }
 
 /*EIGRP REPLY read function*/
@@ -270,6 +270,10 @@ struct eigrp_neighbor {
 	struct list *nbr_gr_prefixes_send;
 	/* if packet is first or last during Graceful restart */
 	enum Packet_part_type nbr_gr_packet_type;
+
+	/* prefixes to reply for, sent together from t_reply */
+	struct list *reply_pending;
+	struct thread *t_reply;
 };
 
 //---------------------------------------------------------------------------------------------------------------------------------------------
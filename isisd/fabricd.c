@@ -35,6 +35,7 @@
 DEFINE_MTYPE_STATIC(ISISD, FABRICD_STATE, "ISIS OpenFabric");
 DEFINE_MTYPE_STATIC(ISISD, FABRICD_NEIGHBOR, "ISIS OpenFabric Neighbor Entry");
 DEFINE_MTYPE_STATIC(ISISD, FABRICD_FLOODING_INFO, "ISIS OpenFabric Flooding Log");
+DEFINE_MTYPE_STATIC(ISISD, FABRICD_FLOOD_CACHE, "ISIS OpenFabric Flood Cache");
 
 /* Tracks initial synchronization as per section 2.4
  *
@@ -47,6 +48,41 @@ enum fabricd_sync_state {
 	FABRICD_SYNC_COMPLETE
 };
 
+struct neighbor_entry;
+
+/*
+ * The outcome of the flooding algorithm only depends on the originator of
+ * an LSP, the SPF tree, the neighbor list and the LSPs of the neighbors.
+ * It is therefore cached per originator until one of those changes.
+ */
+PREDECL_HASH(flood_cache);
+
+struct flood_decision {
+	struct neighbor_entry *neighbor;
+	enum isis_tx_type type;
+};
+
+struct flood_cache_entry {
+	struct flood_cache_item item;
+	uint8_t id[ISIS_SYS_ID_LEN + 1];
+	unsigned int count;
+	struct flood_decision decisions[];
+};
+
+static int flood_cache_cmp(const struct flood_cache_entry *a,
+			   const struct flood_cache_entry *b)
+{
+	return memcmp(a->id, b->id, sizeof(a->id));
+}
+
+static uint32_t flood_cache_hash(const struct flood_cache_entry *e)
+{
+	return jhash(e->id, sizeof(e->id), 0x55aa5a5a);
+}
+
+DECLARE_HASH(flood_cache, struct flood_cache_entry, item, flood_cache_cmp,
+	     flood_cache_hash);
+
 struct fabricd {
 	struct isis_area *area;
 
@@ -67,8 +103,24 @@ struct fabricd {
 
 	int csnp_delay;
 	bool always_send_csnp;
+
+	struct flood_cache_head flood_cache;
+
+	/* flooding statistics */
+	uint64_t flood_lsps;
+	uint64_t flood_cache_hits;
+	uint64_t flood_rf;
+	uint64_t flood_dnr;
 };
 
+static void flood_cache_flush(struct fabricd *f)
+{
+	struct flood_cache_entry *e;
+
+	while ((e = flood_cache_pop(&f->flood_cache)))
+		XFREE(MTYPE_FABRICD_FLOOD_CACHE, e);
+}
+
 /* Code related to maintaining the neighbor lists */
 
 struct neighbor_entry {
@@ -168,6 +220,8 @@ static int fabricd_handle_adj_state_change(struct isis_adjacency *arg)
 	if (!f)
 		return 0;
 
+	/* the cached decisions point at the neighbor entries */
+	flood_cache_flush(f);
 	while (!skiplist_empty(f->neighbors))
 		skiplist_delete_first(f->neighbors);
 
@@ -229,6 +283,7 @@ struct fabricd *fabricd_new(struct isis_area *area)
 	rv->neighbors_neighbors = hash_create(neighbor_entry_hash_key,
 					      neighbor_entry_hash_cmp,
 					      "Fabricd Neighbors");
+	flood_cache_init(&rv->flood_cache);
 
 	rv->tier = rv->tier_config = ISIS_TIER_UNDEFINED;
 
@@ -245,6 +300,8 @@ void fabricd_finish(struct fabricd *f)
 	THREAD_OFF(f->tier_set_timer);
 
 	isis_spftree_del(f->spftree);
+	flood_cache_flush(f);
+	flood_cache_fini(&f->flood_cache);
 	neighbor_lists_clear(f);
 	skiplist_free(f->neighbors);
 	hash_free(f->neighbors_neighbors);
@@ -465,6 +522,7 @@ void fabricd_run_spf(struct isis_area *area)
 		return;
 
 	isis_run_hopcount_spf(area, area->isis->sysid, f->spftree);
+	flood_cache_flush(f);
 	neighbors_neighbors_update(f);
 	fabricd_bump_tier_calculation_timer(f);
 }
@@ -525,11 +583,16 @@ int fabricd_write_settings(struct isis_area *area, struct vty *vty)
 static void move_to_queue(struct isis_lsp *lsp, struct neighbor_entry *n,
 			  enum isis_tx_type type, struct isis_circuit *circuit)
 {
-	n->present = false;
+	struct fabricd *f = lsp->area->fabricd;
 
 	if (n->adj && n->adj->circuit == circuit)
 		return;
 
+	if (type == TX_LSP_NORMAL)
+		f->flood_rf++;
+	else
+		f->flood_dnr++;
+
 	if (IS_DEBUG_FLOODING) {
 		zlog_debug("OpenFabric: Adding %s to %s",
 			   print_sys_hostname(n->id),
@@ -625,16 +688,28 @@ static void fabricd_lsp_reset_flooding_info(struct isis_lsp *lsp,
 	lsp->flooding_circuit_scoped = false;
 }
 
-void fabricd_lsp_flood(struct isis_lsp *lsp, struct isis_circuit *circuit)
+static void add_decision(struct flood_cache_entry *e, struct neighbor_entry *n,
+			 enum isis_tx_type type)
 {
-	struct fabricd *f = lsp->area->fabricd;
-	assert(f);
+	n->present = false;
 
-	fabricd_lsp_reset_flooding_info(lsp, circuit);
+	e->decisions[e->count].neighbor = n;
+	e->decisions[e->count].type = type;
+	e->count++;
+}
 
+static struct flood_cache_entry *flood_decisions_calc(struct fabricd *f,
+						      struct isis_lsp *lsp)
+{
+	struct flood_cache_entry *e;
 	void *cursor = NULL;
 	struct neighbor_entry *n;
 
+	e = XCALLOC(MTYPE_FABRICD_FLOOD_CACHE,
+		    sizeof(*e) + skiplist_count(f->neighbors)
+					 * sizeof(e->decisions[0]));
+	memcpy(e->id, lsp->hdr.lsp_id, sizeof(e->id));
+
 	/* Mark all elements in NL as present */
 	while (!skiplist_next(f->neighbors, NULL, (void **)&n, &cursor))
 		n->present = true;
@@ -665,7 +740,7 @@ void fabricd_lsp_flood(struct isis_lsp *lsp, struct isis_circuit *circuit)
 					   print_sys_hostname(n->id));
 			}
 
-			move_to_queue(lsp, n, TX_LSP_CIRCUIT_SCOPED, circuit);
+			add_decision(e, n, TX_LSP_CIRCUIT_SCOPED);
 			continue;
 		}
 
@@ -696,16 +771,68 @@ void fabricd_lsp_flood(struct isis_lsp *lsp, struct isis_circuit *circuit)
 			}
 		}
 
-		move_to_queue(lsp, n, need_reflood ?
-			      TX_LSP_NORMAL : TX_LSP_CIRCUIT_SCOPED,
-			      circuit);
+		add_decision(e, n, need_reflood ?
+			     TX_LSP_NORMAL : TX_LSP_CIRCUIT_SCOPED);
 	}
 
+	return e;
+}
+
+void fabricd_lsp_flood(struct isis_lsp *lsp, struct isis_circuit *circuit)
+{
+	struct fabricd *f = lsp->area->fabricd;
+	assert(f);
+
+	fabricd_lsp_reset_flooding_info(lsp, circuit);
+
+	struct flood_cache_entry ref, *e;
+	struct neighbor_entry n = {{0}};
+	void *data;
+
+	/* A new LSP of a neighbor may change its neighbors' decisions */
+	memcpy(n.id, lsp->hdr.lsp_id, sizeof(n.id));
+	if (!skiplist_search(f->neighbors, &n, &data))
+		flood_cache_flush(f);
+
+	f->flood_lsps++;
+	memcpy(ref.id, lsp->hdr.lsp_id, sizeof(ref.id));
+	e = flood_cache_find(&f->flood_cache, &ref);
+	if (e) {
+		f->flood_cache_hits++;
+		if (IS_DEBUG_FLOODING)
+			zlog_debug("OpenFabric: Using cached decisions.");
+	} else {
+		e = flood_decisions_calc(f, lsp);
+		flood_cache_add(&f->flood_cache, e);
+	}
+
+	for (unsigned int i = 0; i < e->count; i++)
+		move_to_queue(lsp, e->decisions[i].neighbor,
+			      e->decisions[i].type, circuit);
+
 	if (IS_DEBUG_FLOODING) {
 		zlog_debug("OpenFabric: Flooding algorithm complete.");
 	}
 }
 
+void fabricd_show_flooding_stats(struct vty *vty, struct isis_area *area)
+{
+	struct fabricd *f = area->fabricd;
+	uint64_t sent;
+
+	if (!f)
+		return;
+
+	sent = f->flood_rf + f->flood_dnr;
+	vty_out(vty, "    LSPs flooded: %" PRIu64 " (%" PRIu64
+		     " from cached decisions)\n",
+		f->flood_lsps, f->flood_cache_hits);
+	vty_out(vty, "    Sent as RF: %" PRIu64 ", as DNR: %" PRIu64
+		     " (%" PRIu64 "%% reduction)\n",
+		f->flood_rf, f->flood_dnr,
+		sent ? f->flood_dnr * 100 / sent : 0);
+}
+
 void fabricd_trigger_csnp(struct isis_area *area, bool circuit_scoped)
 {
 	struct fabricd *f = area->fabricd;
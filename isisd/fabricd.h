@@ -45,6 +45,7 @@ void fabricd_configure_tier(struct isis_area *area, uint8_t tier);
 uint8_t fabricd_tier(struct isis_area *area);
 int fabricd_write_settings(struct isis_area *area, struct vty *vty);
 void fabricd_lsp_flood(struct isis_lsp *lsp, struct isis_circuit *circuit);
+void fabricd_show_flooding_stats(struct vty *vty, struct isis_area *area);
 void fabricd_trigger_csnp(struct isis_area *area, bool circuit_scoped);
 struct list *fabricd_ip_addrs(struct isis_circuit *circuit);
 void fabricd_lsp_free(struct isis_lsp *lsp);
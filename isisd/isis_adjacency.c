@@ -32,6 +32,7 @@
 #include "if.h"
 #include "stream.h"
 #include "bfd.h"
+#include "jhash.h"
 
 #include "isisd/isis_constants.h"
 #include "isisd/isis_common.h"
@@ -53,6 +54,77 @@
 DEFINE_MTYPE_STATIC(ISISD, ISIS_ADJACENCY, "ISIS adjacency");
 DEFINE_MTYPE(ISISD, ISIS_ADJACENCY_INFO, "ISIS adjacency info");
 
+static int isis_adj_sysid_cmp(const struct isis_adjacency *a,
+			      const struct isis_adjacency *b)
+{
+	return memcmp(a->sysid, b->sysid, ISIS_SYS_ID_LEN);
+}
+
+static uint32_t isis_adj_sysid_hash(const struct isis_adjacency *adj)
+{
+	return jhash(adj->sysid, ISIS_SYS_ID_LEN, 0x55aa5a5a);
+}
+
+DECLARE_HASH(isis_adj_sysid, struct isis_adjacency, sysid_item,
+	     isis_adj_sysid_cmp, isis_adj_sysid_hash);
+
+static int isis_adj_snpa_cmp(const struct isis_adjacency *a,
+			     const struct isis_adjacency *b)
+{
+	int ret;
+
+	ret = memcmp(a->snpa, b->snpa, ETH_ALEN);
+	if (ret)
+		return ret;
+	return memcmp(a->sysid, b->sysid, ISIS_SYS_ID_LEN);
+}
+
+DECLARE_RBTREE_UNIQ(isis_adj_snpa, struct isis_adjacency, snpa_item,
+		    isis_adj_snpa_cmp);
+
+void isis_adjdb_init(struct isis_circuit *circuit)
+{
+	for (int level = 0; level < ISIS_LEVELS; level++) {
+		circuit->u.bc.adjdb[level] = list_new();
+		isis_adj_sysid_init(&circuit->u.bc.adj_sysid[level]);
+		isis_adj_snpa_init(&circuit->u.bc.adj_snpa[level]);
+	}
+}
+
+void isis_adjdb_finish(struct isis_circuit *circuit)
+{
+	for (int level = 0; level < ISIS_LEVELS; level++) {
+		if (!circuit->u.bc.adjdb[level])
+			continue;
+
+		while (isis_adj_sysid_pop(&circuit->u.bc.adj_sysid[level]))
+			;
+		while (isis_adj_snpa_pop(&circuit->u.bc.adj_snpa[level]))
+			;
+		isis_adj_sysid_fini(&circuit->u.bc.adj_sysid[level]);
+		isis_adj_snpa_fini(&circuit->u.bc.adj_snpa[level]);
+
+		circuit->u.bc.adjdb[level]->del = isis_delete_adj;
+		list_delete(&circuit->u.bc.adjdb[level]);
+	}
+}
+
+static void isis_adjdb_add(struct isis_circuit *circuit, int level,
+			   struct isis_adjacency *adj)
+{
+	listnode_add(circuit->u.bc.adjdb[level - 1], adj);
+	isis_adj_sysid_add(&circuit->u.bc.adj_sysid[level - 1], adj);
+	isis_adj_snpa_add(&circuit->u.bc.adj_snpa[level - 1], adj);
+}
+
+static void isis_adjdb_del(struct isis_circuit *circuit, int level,
+			   struct isis_adjacency *adj)
+{
+	listnode_delete(circuit->u.bc.adjdb[level - 1], adj);
+	isis_adj_sysid_del(&circuit->u.bc.adj_sysid[level - 1], adj);
+	isis_adj_snpa_del(&circuit->u.bc.adj_snpa[level - 1], adj);
+}
+
 static struct isis_adjacency *adj_alloc(struct isis_circuit *circuit,
 					const uint8_t *id)
 {
@@ -91,7 +163,7 @@ struct isis_adjacency *isis_new_adj(const uint8_t *id, const uint8_t *snpa,
 	adj->last_flap = time(NULL);
 	adj->threeway_state = ISIS_THREEWAY_DOWN;
 	if (circuit->circ_type == CIRCUIT_T_BROADCAST) {
-		listnode_add(circuit->u.bc.adjdb[level - 1], adj);
+		isis_adjdb_add(circuit, level, adj);
 		adj->dischanges[level - 1] = 0;
 		for (i = 0; i < DIS_RECORDS;
 		     i++) /* clear N DIS state change records */
@@ -108,31 +180,45 @@ struct isis_adjacency *isis_new_adj(const uint8_t *id, const uint8_t *snpa,
 	return adj;
 }
 
-struct isis_adjacency *isis_adj_lookup(const uint8_t *sysid, struct list *adjdb)
+struct isis_adjacency *isis_adj_lookup(const uint8_t *sysid,
+				       struct isis_circuit *circuit, int level)
 {
-	struct isis_adjacency *adj;
-	struct listnode *node;
-
-	for (ALL_LIST_ELEMENTS_RO(adjdb, node, adj))
-		if (memcmp(adj->sysid, sysid, ISIS_SYS_ID_LEN) == 0)
-			return adj;
+	struct isis_adjacency ref;
 
-	return NULL;
+	memcpy(ref.sysid, sysid, ISIS_SYS_ID_LEN);
+	return isis_adj_sysid_find(&circuit->u.bc.adj_sysid[level - 1], &ref);
 }
 
 struct isis_adjacency *isis_adj_lookup_snpa(const uint8_t *ssnpa,
-					    struct list *adjdb)
+					    struct isis_circuit *circuit,
+					    int level)
 {
-	struct listnode *node;
+	struct isis_adjacency ref;
 	struct isis_adjacency *adj;
 
-	for (ALL_LIST_ELEMENTS_RO(adjdb, node, adj))
-		if (memcmp(adj->snpa, ssnpa, ETH_ALEN) == 0)
-			return adj;
+	memcpy(ref.snpa, ssnpa, ETH_ALEN);
+	memset(ref.sysid, 0, ISIS_SYS_ID_LEN);
+	adj = isis_adj_snpa_find_gteq(&circuit->u.bc.adj_snpa[level - 1], &ref);
+	if (adj && !memcmp(adj->snpa, ssnpa, ETH_ALEN))
+		return adj;
 
 	return NULL;
 }
 
+void isis_adj_update_snpa(struct isis_adjacency *adj, int level,
+			  const uint8_t *snpa)
+{
+	struct isis_adj_snpa_head *head =
+		&adj->circuit->u.bc.adj_snpa[level - 1];
+
+	isis_adj_snpa_del(head, adj);
+	if (snpa)
+		memcpy(adj->snpa, snpa, ETH_ALEN);
+	else
+		memset(adj->snpa, ' ', ETH_ALEN);
+	isis_adj_snpa_add(head, adj);
+}
+
 struct isis_adjacency *isis_adj_find(const struct isis_area *area, int level,
 				     const uint8_t *sysid)
 {
@@ -374,9 +460,7 @@ void isis_adj_state_change(struct isis_adjacency **padj,
 					isis_tx_queue_clean(circuit->tx_queue);
 
 				if (new_state == ISIS_ADJ_DOWN) {
-					listnode_delete(
-						circuit->u.bc.adjdb[level - 1],
-						adj);
+					isis_adjdb_del(circuit, level, adj);
 
 					del = true;
 				}
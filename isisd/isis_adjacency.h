@@ -25,6 +25,7 @@
 #ifndef _ZEBRA_ISIS_ADJACENCY_H
 #define _ZEBRA_ISIS_ADJACENCY_H
 
+#include "typesafe.h"
 #include "isisd/isis_tlvs.h"
 
 DECLARE_MTYPE(ISIS_ADJACENCY_INFO);
@@ -72,8 +73,19 @@ struct isis_dis_record {
 
 struct bfd_session;
 struct isis_area;
+struct isis_circuit;
+
+/*
+ * Indexes of the adjacency databases of broadcast circuits.  The SNPA index
+ * is sorted by SNPA and then system ID, as a neighbor that changed its
+ * system ID is listed twice until the old adjacency expires.
+ */
+PREDECL_HASH(isis_adj_sysid);
+PREDECL_RBTREE_UNIQ(isis_adj_snpa);
 
 struct isis_adjacency {
+	struct isis_adj_sysid_item sysid_item;
+	struct isis_adj_snpa_item snpa_item;
 	uint8_t snpa[ETH_ALEN];		    /* NeighbourSNPAAddress */
 	uint8_t sysid[ISIS_SYS_ID_LEN];     /* neighbourSystemIdentifier */
 	uint8_t lanid[ISIS_SYS_ID_LEN + 1]; /* LAN id on bcast circuits */
@@ -115,10 +127,15 @@ struct isis_adjacency {
 
 struct isis_threeway_adj;
 
+void isis_adjdb_init(struct isis_circuit *circuit);
+void isis_adjdb_finish(struct isis_circuit *circuit);
 struct isis_adjacency *isis_adj_lookup(const uint8_t *sysid,
-				       struct list *adjdb);
+				       struct isis_circuit *circuit, int level);
 struct isis_adjacency *isis_adj_lookup_snpa(const uint8_t *ssnpa,
-					    struct list *adjdb);
+					    struct isis_circuit *circuit,
+					    int level);
+void isis_adj_update_snpa(struct isis_adjacency *adj, int level,
+			  const uint8_t *snpa);
 struct isis_adjacency *isis_adj_find(const struct isis_area *area, int level,
 				     const uint8_t *sysid);
 struct isis_adjacency *isis_new_adj(const uint8_t *id, const uint8_t *snpa,
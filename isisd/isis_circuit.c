@@ -667,8 +667,7 @@ int isis_circuit_up(struct isis_circuit *circuit)
 		 * LSPs or computing the SPF tree
 		 */
 		if (circuit->circ_type == CIRCUIT_T_BROADCAST) {
-			circuit->u.bc.adjdb[0] = list_new();
-			circuit->u.bc.adjdb[1] = list_new();
+			isis_adjdb_init(circuit);
 		} else if (circuit->circ_type == CIRCUIT_T_P2P) {
 			circuit->u.p2p.neighbor = NULL;
 		}
@@ -715,8 +714,7 @@ int isis_circuit_up(struct isis_circuit *circuit)
 				   snpa_print(circuit->u.bc.snpa));
 #endif /* EXTREME_DEBUG */
 
-		circuit->u.bc.adjdb[0] = list_new();
-		circuit->u.bc.adjdb[1] = list_new();
+		isis_adjdb_init(circuit);
 
 		/*
 		 * ISO 10589 - 8.4.1 Enabling of broadcast circuits
@@ -854,16 +852,7 @@ void isis_circuit_down(struct isis_circuit *circuit)
 			circuit->u.bc.lan_neighs[1] = NULL;
 		}
 		/* destroy adjacency databases */
-		if (circuit->u.bc.adjdb[0]) {
-			circuit->u.bc.adjdb[0]->del = isis_delete_adj;
-			list_delete(&circuit->u.bc.adjdb[0]);
-			circuit->u.bc.adjdb[0] = NULL;
-		}
-		if (circuit->u.bc.adjdb[1]) {
-			circuit->u.bc.adjdb[1]->del = isis_delete_adj;
-			list_delete(&circuit->u.bc.adjdb[1]);
-			circuit->u.bc.adjdb[1] = NULL;
-		}
+		isis_adjdb_finish(circuit);
 		if (circuit->u.bc.is_dr[0]) {
 			isis_dr_resign(circuit, 1);
 			circuit->u.bc.is_dr[0] = 0;
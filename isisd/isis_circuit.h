@@ -33,6 +33,7 @@
 #include "isis_constants.h"
 #include "isis_common.h"
 #include "isis_csm.h"
+#include "isis_adjacency.h"
 
 DECLARE_HOOK(isis_if_new_hook, (struct interface *ifp), (ifp));
 
@@ -58,6 +59,8 @@ struct isis_bcast_info {
 	struct thread *t_send_lan_hello[ISIS_LEVELS]; /* send LAN IIHs in this
 							 thread */
 	struct list *adjdb[ISIS_LEVELS];	      /* adjacency dbs */
+	struct isis_adj_sysid_head adj_sysid[ISIS_LEVELS]; /* adjdb indexes */
+	struct isis_adj_snpa_head adj_snpa[ISIS_LEVELS];
 	struct list *lan_neighs[ISIS_LEVELS];     /* list of lx neigh snpa */
 	char is_dr[ISIS_LEVELS];		  /* Are we level x DR ? */
 	uint8_t l1_desig_is[ISIS_SYS_ID_LEN + 1]; /* level-1 DR */
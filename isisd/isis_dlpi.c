@@ -603,4 +603,13 @@ int isis_send_pdu_bcast(struct isis_circuit *circuit, int level)
 	return ISIS_OK;
 }
 
+/* PDUs are written one by one */
+void isis_tx_batch_start(struct isis_circuit *circuit)
+{
+}
+
+void isis_tx_batch_flush(struct isis_circuit *circuit)
+{
+}
+
 #endif /* ISIS_METHOD == ISIS_METHOD_DLPI */
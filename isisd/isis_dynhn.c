@@ -42,11 +42,19 @@
 
 DEFINE_MTYPE_STATIC(ISISD, ISIS_DYNHN, "ISIS dyn hostname");
 
+static int isis_dynhn_cmp(const struct isis_dynhn *a,
+			  const struct isis_dynhn *b)
+{
+	return memcmp(a->id, b->id, ISIS_SYS_ID_LEN);
+}
+
+DECLARE_RBTREE_UNIQ(isis_dynhn_db, struct isis_dynhn, item, isis_dynhn_cmp);
+
 static void dyn_cache_cleanup(struct thread *);
 
 void dyn_cache_init(struct isis *isis)
 {
-	isis->dyn_cache = list_new();
+	isis_dynhn_db_init(&isis->dyn_cache);
 	if (!CHECK_FLAG(im->options, F_ISIS_UNIT_TEST))
 		thread_add_timer(master, dyn_cache_cleanup, isis, 120,
 				 &isis->t_dync_clean);
@@ -54,22 +62,18 @@ void dyn_cache_init(struct isis *isis)
 
 void dyn_cache_finish(struct isis *isis)
 {
-	struct listnode *node, *nnode;
 	struct isis_dynhn *dyn;
 
 	THREAD_OFF(isis->t_dync_clean);
 
-	for (ALL_LIST_ELEMENTS(isis->dyn_cache, node, nnode, dyn)) {
-		list_delete_node(isis->dyn_cache, node);
+	while ((dyn = isis_dynhn_db_pop(&isis->dyn_cache)))
 		XFREE(MTYPE_ISIS_DYNHN, dyn);
-	}
 
-	list_delete(&isis->dyn_cache);
+	isis_dynhn_db_fini(&isis->dyn_cache);
 }
 
 static void dyn_cache_cleanup(struct thread *thread)
 {
-	struct listnode *node, *nnode;
 	struct isis_dynhn *dyn;
 	time_t now = time(NULL);
 	struct isis *isis = NULL;
@@ -78,10 +82,10 @@ static void dyn_cache_cleanup(struct thread *thread)
 
 	isis->t_dync_clean = NULL;
 
-	for (ALL_LIST_ELEMENTS(isis->dyn_cache, node, nnode, dyn)) {
+	frr_each_safe (isis_dynhn_db, &isis->dyn_cache, dyn) {
 		if ((now - dyn->refresh) < MAX_LSP_LIFETIME)
 			continue;
-		list_delete_node(isis->dyn_cache, node);
+		isis_dynhn_db_del(&isis->dyn_cache, dyn);
 		XFREE(MTYPE_ISIS_DYNHN, dyn);
 	}
 
@@ -91,22 +95,18 @@ static void dyn_cache_cleanup(struct thread *thread)
 
 struct isis_dynhn *dynhn_find_by_id(struct isis *isis, const uint8_t *id)
 {
-	struct listnode *node = NULL;
-	struct isis_dynhn *dyn = NULL;
-
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn))
-		if (memcmp(dyn->id, id, ISIS_SYS_ID_LEN) == 0)
-			return dyn;
+	struct isis_dynhn ref;
 
-	return NULL;
+	memcpy(ref.id, id, ISIS_SYS_ID_LEN);
+	return isis_dynhn_db_find(&isis->dyn_cache, &ref);
 }
 
+/* Only used for show commands, so a walk over the cache is good enough */
 struct isis_dynhn *dynhn_find_by_name(struct isis *isis, const char *hostname)
 {
-	struct listnode *node = NULL;
 	struct isis_dynhn *dyn = NULL;
 
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn))
+	frr_each (isis_dynhn_db, &isis->dyn_cache, dyn)
 		if (strncmp(dyn->hostname, hostname, 255) == 0)
 			return dyn;
 
@@ -123,7 +123,7 @@ void isis_dynhn_insert(struct isis *isis, const uint8_t *id,
 		dyn = XCALLOC(MTYPE_ISIS_DYNHN, sizeof(struct isis_dynhn));
 		memcpy(dyn->id, id, ISIS_SYS_ID_LEN);
 		dyn->level = level;
-		listnode_add(isis->dyn_cache, dyn);
+		isis_dynhn_db_add(&isis->dyn_cache, dyn);
 	}
 
 	snprintf(dyn->hostname, sizeof(dyn->hostname), "%s", hostname);
@@ -137,7 +137,7 @@ void isis_dynhn_remove(struct isis *isis, const uint8_t *id)
 	dyn = dynhn_find_by_id(isis, id);
 	if (!dyn)
 		return;
-	listnode_delete(isis->dyn_cache, dyn);
+	isis_dynhn_db_del(&isis->dyn_cache, dyn);
 	XFREE(MTYPE_ISIS_DYNHN, dyn);
 }
 
@@ -149,14 +149,13 @@ void isis_dynhn_remove(struct isis *isis, const uint8_t *id)
  */
 void dynhn_print_all(struct vty *vty, struct isis *isis)
 {
-	struct listnode *node;
 	struct isis_dynhn *dyn;
 
 	vty_out(vty, "vrf     : %s\n", isis->name);
 	if (!isis->sysid_set)
 		return;
 	vty_out(vty, "Level  System ID      Dynamic Hostname\n");
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn)) {
+	frr_each (isis_dynhn_db, &isis->dyn_cache, dyn) {
 		vty_out(vty, "%-7d", dyn->level);
 		vty_out(vty, "%-15s%-15s\n", sysid_print(dyn->id),
 			dyn->hostname);
@@ -170,35 +169,14 @@ void dynhn_print_all(struct vty *vty, struct isis *isis)
 struct isis_dynhn *dynhn_snmp_next(struct isis *isis, const uint8_t *id,
 				   int level)
 {
-	struct listnode *node = NULL;
-	struct isis_dynhn *dyn = NULL;
-	struct isis_dynhn *found_dyn = NULL;
-	int res;
-
-	for (ALL_LIST_ELEMENTS_RO(isis->dyn_cache, node, dyn)) {
-		res = memcmp(dyn->id, id, ISIS_SYS_ID_LEN);
-
-		if (res < 0)
-			continue;
-
-		if (res == 0 && dyn->level <= level)
-			continue;
-
-		if (res == 0) {
-			/*
-			 * This is the best match, we can stop
-			 * searching
-			 */
-
-			found_dyn = dyn;
-			break;
-		}
+	struct isis_dynhn ref;
+	struct isis_dynhn *dyn;
 
-		if (found_dyn == NULL
-		    || memcmp(dyn->id, found_dyn->id, ISIS_SYS_ID_LEN) < 0) {
-			found_dyn = dyn;
-		}
-	}
+	/* the cache holds one entry per system ID */
+	memcpy(ref.id, id, ISIS_SYS_ID_LEN);
+	dyn = isis_dynhn_db_find_gteq(&isis->dyn_cache, &ref);
+	if (dyn && !memcmp(dyn->id, id, ISIS_SYS_ID_LEN) && dyn->level <= level)
+		dyn = isis_dynhn_db_next(&isis->dyn_cache, dyn);
 
-	return found_dyn;
+	return dyn;
 }
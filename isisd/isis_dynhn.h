@@ -23,7 +23,14 @@
 #ifndef _ZEBRA_ISIS_DYNHN_H
 #define _ZEBRA_ISIS_DYNHN_H
 
+#include "typesafe.h"
+
+struct isis;
+
+PREDECL_RBTREE_UNIQ(isis_dynhn_db);
+
 struct isis_dynhn {
+	struct isis_dynhn_db_item item;
 	uint8_t id[ISIS_SYS_ID_LEN];
 	char hostname[256];
 	time_t refresh;
@@ -60,7 +60,7 @@
 #include "isisd/isis_tx_queue.h"
 #include "isisd/isis_nb.h"
 
-DEFINE_MTYPE_STATIC(ISISD, ISIS_LSP, "ISIS LSP");
+DEFINE_MTYPE_POOL_STATIC(ISISD, ISIS_LSP, "ISIS LSP");
 
 static void lsp_refresh(struct thread *thread);
 static void lsp_l1_refresh_pseudo(struct thread *thread);
@@ -111,7 +111,17 @@ static void lsp_clear_data(struct isis_lsp *lsp)
 	lsp->tlvs = NULL;
 }
 
-static void lsp_remove_frags(struct lspdb_head *head, struct list *frags);
+static void lsp_remove_frags(struct lspdb_head *head, struct isis_lsp *lsp0);
+static void lsp_unlink_fragment(struct isis_lsp *lsp);
+
+static struct isis_lsp *lsp_alloc(void)
+{
+	struct isis_lsp *lsp;
+
+	lsp = lsp_alloc();
+	lsp_frags_init(&lsp->frags);
+	return lsp;
+}
 
 static void lsp_destroy(struct isis_lsp *lsp)
 {
@@ -130,20 +140,14 @@ static void lsp_destroy(struct isis_lsp *lsp)
 
 	lsp_clear_data(lsp);
 
-	if (!LSP_FRAGMENT(lsp->hdr.lsp_id)) {
-		if (lsp->lspu.frags) {
-			lsp_remove_frags(&lsp->area->lspdb[lsp->level - 1],
-					lsp->lspu.frags);
-			list_delete(&lsp->lspu.frags);
-		}
-	} else {
-		if (lsp->lspu.zero_lsp
-		    && lsp->lspu.zero_lsp->lspu.frags) {
-			listnode_delete(lsp->lspu.zero_lsp->lspu.frags, lsp);
-		}
-	}
+	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
+		lsp_remove_frags(&lsp->area->lspdb[lsp->level - 1], lsp);
+	else
+		lsp_unlink_fragment(lsp);
+	lsp_frags_fini(&lsp->frags);
 
 	isis_spf_schedule(lsp->area, lsp->level);
+	isis_csnp_cache_flush(lsp->area, lsp->level);
 
 	if (lsp->pdu)
 		stream_free(lsp->pdu);
@@ -155,13 +159,12 @@ static void lsp_destroy(struct isis_lsp *lsp)
 /*
  * Remove all the frags belonging to the given lsp
  */
-static void lsp_remove_frags(struct lspdb_head *head, struct list *frags)
+static void lsp_remove_frags(struct lspdb_head *head, struct isis_lsp *lsp0)
 {
-	struct listnode *lnode, *lnnode;
 	struct isis_lsp *lsp;
 
-	for (ALL_LIST_ELEMENTS(frags, lnode, lnnode, lsp)) {
-		lsp = lsp_search(head, lsp->hdr.lsp_id);
+	while ((lsp = lsp_frags_pop(&lsp0->frags))) {
+		lsp->zero_lsp = NULL;
 		lspdb_del(head, lsp);
 		lsp_destroy(lsp);
 	}
@@ -177,19 +180,14 @@ void lsp_search_and_destroy(struct lspdb_head *head, const uint8_t *id)
 		/*
 		 * If this is a zero lsp, remove all the frags now
 		 */
-		if (LSP_FRAGMENT(lsp->hdr.lsp_id) == 0) {
-			if (lsp->lspu.frags)
-				lsp_remove_frags(head, lsp->lspu.frags);
-		} else {
+		if (LSP_FRAGMENT(lsp->hdr.lsp_id) == 0)
+			lsp_remove_frags(head, lsp);
+		else
 			/*
 			 * else just remove this frag, from the zero lsps' frag
 			 * list
 			 */
-			if (lsp->lspu.zero_lsp
-			    && lsp->lspu.zero_lsp->lspu.frags)
-				listnode_delete(lsp->lspu.zero_lsp->lspu.frags,
-						lsp);
-		}
+			lsp_unlink_fragment(lsp);
 		lsp_destroy(lsp);
 	}
 }
@@ -315,6 +313,7 @@ static void lsp_pack_pdu(struct isis_lsp *lsp)
 	lsp->hdr.checksum =
 		ntohs(fletcher_checksum(STREAM_DATA(lsp->pdu) + 12,
 					stream_get_endp(lsp->pdu) - 12, 12));
+	isis_csnp_cache_flush(lsp->area, lsp->level);
 }
 
 void lsp_inc_seqno(struct isis_lsp *lsp, uint32_t seqno)
@@ -385,14 +384,10 @@ static void lsp_purge(struct isis_lsp *lsp, int level,
 static void lsp_seqno_update(struct isis_lsp *lsp0)
 {
 	struct isis_lsp *lsp;
-	struct listnode *node;
 
 	lsp_inc_seqno(lsp0, 0);
 
-	if (!lsp0->lspu.frags)
-		return;
-
-	for (ALL_LIST_ELEMENTS_RO(lsp0->lspu.frags, node, lsp)) {
+	frr_each (lsp_frags, &lsp0->frags, lsp) {
 		if (lsp->tlvs)
 			lsp_inc_seqno(lsp, 0);
 		else if (lsp->hdr.rem_lifetime) {
@@ -532,6 +527,7 @@ static void lsp_update_data(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	lsp->level = level;
 	lsp->age_out = ZERO_AGE_LIFETIME;
 	lsp->installed = time(NULL);
+	isis_csnp_cache_flush(area, level);
 
 	lsp->tlvs = tlvs;
 
@@ -549,21 +545,31 @@ static void lsp_update_data(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 
 static void lsp_link_fragment(struct isis_lsp *lsp, struct isis_lsp *lsp0)
 {
-	if (!LSP_FRAGMENT(lsp->hdr.lsp_id)) {
-		/* zero lsp -> create list to store fragments */
-		lsp->lspu.frags = list_new();
-	} else {
-		/* fragment -> set backpointer and add to zero lsps list */
-		assert(lsp0);
-		lsp->lspu.zero_lsp = lsp0;
-		listnode_add(lsp0->lspu.frags, lsp);
-	}
+	/* zero lsps keep their fragments in the embedded frags list */
+	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
+		return;
+
+	/* fragment -> set backpointer and add to zero lsps list */
+	assert(lsp0);
+	lsp->zero_lsp = lsp0;
+	lsp_frags_add_tail(&lsp0->frags, lsp);
+}
+
+static void lsp_unlink_fragment(struct isis_lsp *lsp)
+{
+	if (!lsp->zero_lsp)
+		return;
+
+	lsp_frags_del(&lsp->zero_lsp->frags, lsp);
+	lsp->zero_lsp = NULL;
 }
 
 void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		struct isis_tlvs *tlvs, struct stream *stream,
 		struct isis_area *area, int level, bool confusion)
 {
+	bool prefixes_only;
+
 	if (lsp->own_lsp) {
 		flog_err(
 			EC_LIB_DEVELOPMENT,
@@ -573,13 +579,22 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 		lsp->own_lsp = 0;
 	}
 
+	/*
+	 * If only the advertised prefixes changed, the SPT stays the same and
+	 * just the routes have to be recalculated.
+	 */
+	prefixes_only = !confusion && lsp->tlvs && tlvs
+			&& lsp->hdr.rem_lifetime && hdr->rem_lifetime
+			&& lsp->hdr.lsp_bits == hdr->lsp_bits
+			&& isis_tlvs_same_topology(lsp->tlvs, tlvs);
+
 	if (confusion) {
 		lsp_purge(lsp, level, NULL);
 	} else {
 		lsp_update_data(lsp, hdr, tlvs, stream, area, level);
 	}
 
-	if (LSP_FRAGMENT(lsp->hdr.lsp_id) && !lsp->lspu.zero_lsp) {
+	if (LSP_FRAGMENT(lsp->hdr.lsp_id) && !lsp->zero_lsp) {
 		uint8_t lspid[ISIS_SYS_ID_LEN + 2];
 		struct isis_lsp *lsp0;
 
@@ -591,7 +606,10 @@ void lsp_update(struct isis_lsp *lsp, struct isis_lsp_hdr *hdr,
 	}
 
 	if (lsp->hdr.seqno) {
-		isis_spf_schedule(lsp->area, lsp->level);
+		if (prefixes_only)
+			isis_spf_schedule_prefixes(lsp->area, lsp->level);
+		else
+			isis_spf_schedule(lsp->area, lsp->level);
 		isis_te_lsp_event(lsp, LSP_UPD);
 	}
 }
@@ -604,7 +622,7 @@ struct isis_lsp *lsp_new_from_recv(struct isis_lsp_hdr *hdr,
 {
 	struct isis_lsp *lsp;
 
-	lsp = XCALLOC(MTYPE_ISIS_LSP, sizeof(struct isis_lsp));
+	lsp = lsp_alloc();
 	lsp_update_data(lsp, hdr, tlvs, stream, area, level);
 	lsp_link_fragment(lsp, lsp0);
 
@@ -629,7 +647,7 @@ struct isis_lsp *lsp_new(struct isis_area *area, uint8_t *lsp_id,
 {
 	struct isis_lsp *lsp;
 
-	lsp = XCALLOC(MTYPE_ISIS_LSP, sizeof(struct isis_lsp));
+	lsp = lsp_alloc();
 	lsp->area = area;
 
 	lsp_adjust_stream(lsp);
@@ -658,6 +676,7 @@ struct isis_lsp *lsp_new(struct isis_area *area, uint8_t *lsp_id,
 void lsp_insert(struct lspdb_head *head, struct isis_lsp *lsp)
 {
 	lspdb_add(head, lsp);
+	isis_csnp_cache_flush(lsp->area, lsp->level);
 	if (lsp->hdr.seqno) {
 		isis_spf_schedule(lsp->area, lsp->level);
 		isis_te_lsp_event(lsp, LSP_ADD);
@@ -987,7 +1006,7 @@ static struct isis_lsp *lsp_next_frag(uint8_t frag_num, struct isis_lsp *lsp0,
 	lsp = lsp_search(&area->lspdb[level - 1], frag_id);
 	if (lsp) {
 		lsp_clear_data(lsp);
-		if (!lsp->lspu.zero_lsp)
+		if (!lsp->zero_lsp)
 			lsp_link_fragment(lsp, lsp0);
 		return lsp;
 	}
@@ -1012,7 +1031,7 @@ static void lsp_build(struct isis_lsp *lsp, struct isis_area *area)
 	struct isis_lsp *frag;
 
 	lsp_clear_data(lsp);
-	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag))
+	frr_each (lsp_frags, &lsp->frags, frag)
 		lsp_clear_data(frag);
 
 	lsp->tlvs = isis_alloc_tlvs();
@@ -1454,7 +1473,6 @@ static int lsp_regenerate(struct isis_area *area, int level)
 {
 	struct lspdb_head *head;
 	struct isis_lsp *lsp, *frag;
-	struct listnode *node;
 	uint8_t lspid[ISIS_SYS_ID_LEN + 2];
 	uint16_t rem_lifetime, refresh_time;
 
@@ -1481,7 +1499,7 @@ static int lsp_regenerate(struct isis_area *area, int level)
 	lsp->last_generated = time(NULL);
 	lsp_flood(lsp, NULL);
 	area->lsp_gen_count[level - 1]++;
-	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
+	frr_each (lsp_frags, &lsp->frags, frag) {
 		if (!frag->tlvs) {
 			/* Updating and flooding should only affect fragments
 			 * carrying data
@@ -2071,6 +2089,9 @@ void lsp_tick(struct thread *thread)
 	 */
 	for (level = 0; level < ISIS_LEVELS; level++) {
 		struct isis_lsp *next = lspdb_first(&area->lspdb[level]);
+
+		/* remaining lifetimes change, encoded CSNPs are stale */
+		isis_csnp_cache_flush(area, level + 1);
 		frr_each_from (lspdb, &area->lspdb[level], lsp, next) {
 			/*
 			 * The lsp rem_lifetime is kept at 0 for MaxAge
@@ -2167,7 +2188,7 @@ void lsp_purge_non_exist(int level, struct isis_lsp_hdr *hdr,
 	/*
 	 * We need to create the LSP to be purged
 	 */
-	lsp = XCALLOC(MTYPE_ISIS_LSP, sizeof(struct isis_lsp));
+	lsp = lsp_alloc();
 	lsp->area = area;
 	lsp->level = level;
 	lsp_adjust_stream(lsp);
@@ -2249,7 +2270,6 @@ int isis_lsp_iterate_ip_reach(struct isis_lsp *lsp, int family, uint16_t mtid,
 {
 	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
 	struct isis_lsp *frag;
-	struct listnode *node;
 
 	if (lsp->hdr.seqno == 0 || lsp->hdr.rem_lifetime == 0)
 		return LSP_ITER_CONTINUE;
@@ -2326,7 +2346,7 @@ int isis_lsp_iterate_ip_reach(struct isis_lsp *lsp, int family, uint16_t mtid,
 
 	/* Parse LSP fragments if it is not a fragment itself */
 	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
-		for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
+		frr_each (lsp_frags, &lsp->frags, frag) {
 			if (!frag->tlvs)
 				continue;
 
@@ -2348,7 +2368,6 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 {
 	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
 	struct isis_lsp *frag;
-	struct listnode *node;
 	struct isis_item *head;
 	struct isis_item_list *te_neighs;
 
@@ -2380,7 +2399,8 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 				     (struct isis_extended_reach *)head;
 			     reach; reach = reach->next) {
 				if ((*cb)(reach->id, reach->metric, false,
-					  reach->subtlvs, arg)
+					  isis_extended_reach_subtlvs(reach),
+					  arg)
 				    == LSP_ITER_STOP)
 					return LSP_ITER_STOP;
 			}
@@ -2389,7 +2409,7 @@ int isis_lsp_iterate_is_reach(struct isis_lsp *lsp, uint16_t mtid,
 
 	/* Parse LSP fragments if it not a fragment itself. */
 	if (!LSP_FRAGMENT(lsp->hdr.lsp_id))
-		for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
+		frr_each (lsp_frags, &lsp->frags, frag) {
 			if (!frag->tlvs)
 				continue;
 
@@ -28,6 +28,7 @@
 #include "isisd/isis_pdu.h"
 
 PREDECL_RBTREE_UNIQ(lspdb);
+PREDECL_DLIST(lsp_frags);
 
 struct isis;
 /* Structure for isis_lsp, this structure will only support the fixed
@@ -39,10 +40,11 @@ struct isis_lsp {
 
 	struct isis_lsp_hdr hdr;
 	struct stream *pdu; /* full pdu lsp */
-	union {
-		struct list *frags;
-		struct isis_lsp *zero_lsp;
-	} lspu;
+	/* fragments of a zero LSP */
+	struct lsp_frags_head frags;
+	/* linkage of a fragment into the list of its zero LSP */
+	struct lsp_frags_item frag_item;
+	struct isis_lsp *zero_lsp;
 	uint32_t SSNflags[ISIS_MAX_CIRCUITS];
 	int level;     /* L1 or L2? */
 	int scheduled; /* scheduled for sending */
@@ -62,6 +64,7 @@ struct isis_lsp {
 
 extern int lspdb_compare(const struct isis_lsp *a, const struct isis_lsp *b);
 DECLARE_RBTREE_UNIQ(lspdb, struct isis_lsp, dbe, lspdb_compare);
+DECLARE_DLIST(lsp_frags, struct isis_lsp, frag_item);
 
 void lsp_db_init(struct lspdb_head *head);
 void lsp_db_fini(struct lspdb_head *head);
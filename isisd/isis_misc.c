@@ -329,8 +329,9 @@ const char *rawlspid_print(const uint8_t *from)
 const char *isis_format_id(const uint8_t *id, size_t len)
 {
 #define FORMAT_BUF_COUNT 4
-	static char buf_ring[FORMAT_BUF_COUNT][FORMAT_ID_SIZE];
-	static size_t cur_buf = 0;
+	/* per pthread, IDs are also printed while building SPF trees */
+	static __thread char buf_ring[FORMAT_BUF_COUNT][FORMAT_ID_SIZE];
+	static __thread size_t cur_buf = 0;
 
 	char *rv;
 
@@ -34,4 +34,12 @@ int isis_recv_pdu_p2p(struct isis_circuit *circuit, uint8_t *ssnpa);
 int isis_send_pdu_bcast(struct isis_circuit *circuit, int level);
 int isis_send_pdu_p2p(struct isis_circuit *circuit, int level);
 
+/*
+ * PDUs sent on circuit between these two calls may be handed to the kernel
+ * together on flush, if the socket method supports it.  A PDU accepted for
+ * later transmission is reported as sent.
+ */
+void isis_tx_batch_start(struct isis_circuit *circuit);
+void isis_tx_batch_flush(struct isis_circuit *circuit);
+
 #endif /* _ZEBRA_ISIS_NETWORK_H */
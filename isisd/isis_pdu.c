@@ -444,8 +444,7 @@ static int process_p2p_hello(struct iih_info *iih)
 static int process_lan_hello(struct iih_info *iih)
 {
 	struct isis_adjacency *adj;
-	adj = isis_adj_lookup(iih->sys_id,
-			      iih->circuit->u.bc.adjdb[iih->level - 1]);
+	adj = isis_adj_lookup(iih->sys_id, iih->circuit, iih->level);
 	if ((adj == NULL) || (memcmp(adj->snpa, iih->ssnpa, ETH_ALEN))
 	    || (adj->level != iih->level)) {
 		if (!adj) {
@@ -453,11 +452,7 @@ static int process_lan_hello(struct iih_info *iih)
 			adj = isis_new_adj(iih->sys_id, iih->ssnpa, iih->level,
 					   iih->circuit);
 		} else {
-			if (iih->ssnpa) {
-				memcpy(adj->snpa, iih->ssnpa, 6);
-			} else {
-				memset(adj->snpa, ' ', 6);
-			}
+			isis_adj_update_snpa(adj, iih->level, iih->ssnpa);
 			adj->level = iih->level;
 		}
 		isis_adj_state_change(&adj, ISIS_ADJ_INITIALIZING, NULL);
@@ -937,8 +932,8 @@ static int process_lsp(uint8_t pdu_type, struct isis_circuit *circuit,
 	int retval = ISIS_WARNING;
 	const char *error_log;
 
-	if (isis_unpack_tlvs(STREAM_READABLE(circuit->rcv_stream),
-			     circuit->rcv_stream, &tlvs, &error_log)) {
+	if (isis_unpack_tlvs_lazy(STREAM_READABLE(circuit->rcv_stream),
+				  circuit->rcv_stream, &tlvs, &error_log)) {
 		zlog_warn("Something went wrong unpacking the LSP: %s",
 			  error_log);
 #ifndef FABRICD
@@ -1027,8 +1022,7 @@ static int process_lsp(uint8_t pdu_type, struct isis_circuit *circuit,
 	/* for broadcast circuits, snpa should be compared */
 
 	if (circuit->circ_type == CIRCUIT_T_BROADCAST) {
-		if (!isis_adj_lookup_snpa(ssnpa,
-					  circuit->u.bc.adjdb[level - 1])) {
+		if (!isis_adj_lookup_snpa(ssnpa, circuit, level)) {
 			zlog_debug("(%s): DS ======= LSP %s, seq 0x%08x, cksum 0x%04hx, lifetime %hus on %s",
 				   circuit->area->area_tag,
 				   rawlspid_print(hdr.lsp_id), hdr.seqno,
@@ -1393,8 +1387,7 @@ static int process_snp(uint8_t pdu_type, struct isis_circuit *circuit,
 	/* for broadcast circuits, snpa should be compared */
 	/* FIXME : Do we need to check SNPA? */
 	if (circuit->circ_type == CIRCUIT_T_BROADCAST) {
-		if (!isis_adj_lookup(rem_sys_id,
-				     circuit->u.bc.adjdb[level - 1]))
+		if (!isis_adj_lookup(rem_sys_id, circuit, level))
 			return ISIS_OK; /* Silently discard */
 	} else {
 		if (!fabricd && !circuit->u.p2p.neighbor) {
@@ -2124,15 +2117,33 @@ static uint16_t get_max_lsp_count(uint16_t size)
 	return lsp_count;
 }
 
-int send_csnp(struct isis_circuit *circuit, int level)
+void isis_csnp_cache_flush(struct isis_area *area, int level)
 {
-	if (lspdb_count(&circuit->area->lspdb[level - 1]) == 0)
-		return ISIS_OK;
+	struct list **cache = &area->csnp_cache[level - 1];
+
+	if (*cache)
+		list_delete(cache);
+}
+
+static void csnp_cache_del(void *pdu)
+{
+	stream_free(pdu);
+}
+
+/*
+ * Encode the CSNPs describing the whole LSPDB of the level into the
+ * area's CSNP cache, using the PDU size of the given circuit.
+ */
+static int csnp_cache_build(struct isis_circuit *circuit, int level)
+{
+	struct isis_area *area = circuit->area;
+	struct list *cache;
 
 	uint8_t pdu_type = (level == ISIS_LEVEL1) ? L1_COMPLETE_SEQ_NUM
 						  : L2_COMPLETE_SEQ_NUM;
 
-	isis_circuit_stream(circuit, &circuit->snd_stream);
+	isis_csnp_cache_flush(area, level);
+
 	fill_fixed_hdr(pdu_type, circuit->snd_stream);
 
 	size_t len_pointer = stream_get_endp(circuit->snd_stream);
@@ -2148,8 +2159,8 @@ int send_csnp(struct isis_circuit *circuit, int level)
 	stream_put(circuit->snd_stream, 0, ISIS_SYS_ID_LEN + 2);
 
 	struct isis_passwd *passwd = (level == ISIS_LEVEL1)
-					     ? &circuit->area->area_passwd
-					     : &circuit->area->domain_passwd;
+					     ? &area->area_passwd
+					     : &area->domain_passwd;
 
 	struct isis_tlvs *tlvs = isis_alloc_tlvs();
 
@@ -2172,6 +2183,9 @@ int send_csnp(struct isis_circuit *circuit, int level)
 	uint8_t stop[ISIS_SYS_ID_LEN + 2];
 	memset(stop, 0xff, ISIS_SYS_ID_LEN + 2);
 
+	cache = list_new();
+	cache->del = csnp_cache_del;
+
 	bool loop = true;
 	while (loop) {
 		tlvs = isis_alloc_tlvs();
@@ -2180,8 +2194,7 @@ int send_csnp(struct isis_circuit *circuit, int level)
 
 		struct isis_lsp *last_lsp;
 		isis_tlvs_add_csnp_entries(tlvs, start, stop, num_lsps,
-					   &circuit->area->lspdb[level - 1],
-					   &last_lsp);
+					   &area->lspdb[level - 1], &last_lsp);
 		/*
 		 * Update the stop lsp_id before encoding this CSNP.
 		 */
@@ -2199,33 +2212,19 @@ int send_csnp(struct isis_circuit *circuit, int level)
 		if (isis_pack_tlvs(tlvs, circuit->snd_stream, len_pointer,
 				   false, false)) {
 			isis_free_tlvs(tlvs);
+			list_delete(&cache);
 			return ISIS_WARNING;
 		}
 
 		if (IS_DEBUG_SNP_PACKETS) {
-			zlog_debug(
-				"ISIS-Snp (%s): Sending L%d CSNP on %s, length %zd",
-				circuit->area->area_tag, level,
-				circuit->interface->name,
-				stream_get_endp(circuit->snd_stream));
+			zlog_debug("ISIS-Snp (%s): Built L%d CSNP, length %zd",
+				   area->area_tag, level,
+				   stream_get_endp(circuit->snd_stream));
 			log_multiline(LOG_DEBUG, "              ", "%s",
 				      isis_format_tlvs(tlvs, NULL));
-			if (IS_DEBUG_PACKET_DUMP)
-				zlog_dump_data(
-					STREAM_DATA(circuit->snd_stream),
-					stream_get_endp(circuit->snd_stream));
 		}
 
-		pdu_counter_count(circuit->area->pdu_tx_counters, pdu_type);
-		int retval = circuit->tx(circuit, level);
-		if (retval != ISIS_OK) {
-			flog_err(EC_ISIS_PACKET,
-				 "ISIS-Snp (%s): Send L%d CSNP on %s failed",
-				 circuit->area->area_tag, level,
-				 circuit->interface->name);
-			isis_free_tlvs(tlvs);
-			return retval;
-		}
+		listnode_add(cache, stream_dup(circuit->snd_stream));
 
 		/*
 		 * Start lsp_id of the next CSNP should be one plus the
@@ -2244,6 +2243,70 @@ int send_csnp(struct isis_circuit *circuit, int level)
 		isis_free_tlvs(tlvs);
 	}
 
+	area->csnp_cache[level - 1] = cache;
+	area->csnp_cache_pdu_size[level - 1] = STREAM_SIZE(circuit->snd_stream);
+
+	return ISIS_OK;
+}
+
+/*
+ * CSNPs carry nothing specific to the circuit they are sent on, so they are
+ * encoded once and the result is shared by all circuits of the area until
+ * the LSPDB changes - which includes the remaining lifetimes counting down,
+ * so the cache lives for one LSP tick at most.  Circuits with a different
+ * PDU size rebuild it for their size.
+ */
+int send_csnp(struct isis_circuit *circuit, int level)
+{
+	struct isis_area *area = circuit->area;
+	struct listnode *node;
+	struct stream *pdu;
+	int retval;
+
+	if (lspdb_count(&area->lspdb[level - 1]) == 0)
+		return ISIS_OK;
+
+	uint8_t pdu_type = (level == ISIS_LEVEL1) ? L1_COMPLETE_SEQ_NUM
+						  : L2_COMPLETE_SEQ_NUM;
+
+	isis_circuit_stream(circuit, &circuit->snd_stream);
+
+	if (!area->csnp_cache[level - 1] || IS_DEBUG_SNP_PACKETS
+	    || area->csnp_cache_pdu_size[level - 1]
+		       != STREAM_SIZE(circuit->snd_stream)) {
+		retval = csnp_cache_build(circuit, level);
+		if (retval != ISIS_OK)
+			return retval;
+	}
+
+	for (ALL_LIST_ELEMENTS_RO(area->csnp_cache[level - 1], node, pdu)) {
+		stream_reset(circuit->snd_stream);
+		stream_put(circuit->snd_stream, STREAM_DATA(pdu),
+			   stream_get_endp(pdu));
+
+		if (IS_DEBUG_SNP_PACKETS) {
+			zlog_debug(
+				"ISIS-Snp (%s): Sending L%d CSNP on %s, length %zd",
+				area->area_tag, level,
+				circuit->interface->name,
+				stream_get_endp(circuit->snd_stream));
+			if (IS_DEBUG_PACKET_DUMP)
+				zlog_dump_data(
+					STREAM_DATA(circuit->snd_stream),
+					stream_get_endp(circuit->snd_stream));
+		}
+
+		pdu_counter_count(area->pdu_tx_counters, pdu_type);
+		retval = circuit->tx(circuit, level);
+		if (retval != ISIS_OK) {
+			flog_err(EC_ISIS_PACKET,
+				 "ISIS-Snp (%s): Send L%d CSNP on %s failed",
+				 area->area_tag, level,
+				 circuit->interface->name);
+			return retval;
+		}
+	}
+
 	return ISIS_OK;
 }
 
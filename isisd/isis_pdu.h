@@ -210,6 +210,7 @@ void isis_receive(struct thread *thread);
  */
 void send_hello_sched(struct isis_circuit *circuit, int level, long delay);
 int send_csnp(struct isis_circuit *circuit, int level);
+void isis_csnp_cache_flush(struct isis_area *area, int level);
 void send_l1_csnp(struct thread *thread);
 void send_l2_csnp(struct thread *thread);
 void send_l1_psnp(struct thread *thread);
@@ -28,6 +28,7 @@
 #include <linux/filter.h>
 
 #include "log.h"
+#include "memory.h"
 #include "network.h"
 #include "stream.h"
 #include "if.h"
@@ -75,6 +76,25 @@ static const uint8_t ALL_ESS[6] = {0x09, 0x00, 0x2B, 0x00, 0x00, 0x04};
 
 static uint8_t discard_buff[8192];
 
+DEFINE_MTYPE_STATIC(ISISD, ISIS_TX_BATCH, "ISIS TX batch buffer");
+
+/* PDUs of one circuit handed to the kernel with a single sendmmsg() */
+#define ISIS_TX_BATCH_MAX 64
+
+static struct {
+	struct isis_circuit *circuit;
+	unsigned int count;
+
+	struct mmsghdr mmsgs[ISIS_TX_BATCH_MAX];
+	struct sockaddr_ll sa[ISIS_TX_BATCH_MAX];
+	struct iovec iov[ISIS_TX_BATCH_MAX][2];
+	/* copies of the circuit's send stream, buf_size bytes each */
+	uint8_t *bufs[ISIS_TX_BATCH_MAX];
+	size_t buf_size;
+} tx_batch;
+
+static const uint8_t llc_hdr[LLC_LEN] = {ISO_SAP, ISO_SAP, 0x03};
+
 /*
  * if level is 0 we are joining p2p multicast
  * FIXME: and the p2p multicast being ???
@@ -339,6 +359,89 @@ int isis_recv_pdu_p2p(struct isis_circuit *circuit, uint8_t *ssnpa)
 	return ISIS_OK;
 }
 
+void isis_tx_batch_start(struct isis_circuit *circuit)
+{
+	size_t size = stream_get_size(circuit->snd_stream);
+
+	if (tx_batch.circuit)
+		isis_tx_batch_flush(tx_batch.circuit);
+
+	if (size > tx_batch.buf_size) {
+		for (unsigned int i = 0; i < ISIS_TX_BATCH_MAX; i++)
+			XFREE(MTYPE_ISIS_TX_BATCH, tx_batch.bufs[i]);
+		tx_batch.buf_size = size;
+	}
+
+	tx_batch.circuit = circuit;
+	tx_batch.count = 0;
+}
+
+void isis_tx_batch_flush(struct isis_circuit *circuit)
+{
+	unsigned int pos = 0;
+	int ret;
+
+	if (tx_batch.circuit != circuit)
+		return;
+
+	while (pos < tx_batch.count) {
+		ret = sendmmsg(circuit->fd, &tx_batch.mmsgs[pos],
+			       tx_batch.count - pos, 0);
+		if (ret <= 0) {
+			/*
+			 * Nothing more to do for this PDU, a retransmission
+			 * or CSNP will take care of it.
+			 */
+			zlog_warn(
+				"IS-IS pfpacket: could not transmit packet on %s: %s",
+				circuit->interface->name, safe_strerror(errno));
+			pos++;
+			continue;
+		}
+		pos += ret;
+	}
+
+	tx_batch.count = 0;
+	tx_batch.circuit = NULL;
+}
+
+/* Queue the PDU in the circuit's send stream for isis_tx_batch_flush() */
+static int isis_tx_batch_add(struct isis_circuit *circuit,
+			     const struct sockaddr_ll *sa, bool llc)
+{
+	size_t len = stream_get_endp(circuit->snd_stream);
+	unsigned int i;
+	struct msghdr *msg;
+
+	if (tx_batch.count == ISIS_TX_BATCH_MAX) {
+		isis_tx_batch_flush(circuit);
+		tx_batch.circuit = circuit;
+	}
+
+	i = tx_batch.count++;
+	if (!tx_batch.bufs[i])
+		tx_batch.bufs[i] =
+			XMALLOC(MTYPE_ISIS_TX_BATCH, tx_batch.buf_size);
+	memcpy(tx_batch.bufs[i], circuit->snd_stream->data, len);
+	tx_batch.sa[i] = *sa;
+
+	msg = &tx_batch.mmsgs[i].msg_hdr;
+	memset(msg, 0, sizeof(*msg));
+	msg->msg_name = &tx_batch.sa[i];
+	msg->msg_namelen = sizeof(tx_batch.sa[i]);
+	msg->msg_iov = tx_batch.iov[i];
+	if (llc) {
+		tx_batch.iov[i][0].iov_base = (void *)llc_hdr;
+		tx_batch.iov[i][0].iov_len = LLC_LEN;
+		msg->msg_iovlen = 2;
+	} else
+		msg->msg_iovlen = 1;
+	tx_batch.iov[i][msg->msg_iovlen - 1].iov_base = tx_batch.bufs[i];
+	tx_batch.iov[i][msg->msg_iovlen - 1].iov_len = len;
+
+	return ISIS_OK;
+}
+
 int isis_send_pdu_bcast(struct isis_circuit *circuit, int level)
 {
 	struct msghdr msg;
@@ -366,6 +469,9 @@ int isis_send_pdu_bcast(struct isis_circuit *circuit, int level)
 	else
 		memcpy(&sa.sll_addr, ALL_L2_ISS, ETH_ALEN);
 
+	if (tx_batch.circuit == circuit)
+		return isis_tx_batch_add(circuit, &sa, true);
+
 	/* on a broadcast circuit */
 	/* first we put the LLC in */
 	temp_buff[0] = 0xFE;
@@ -410,6 +516,10 @@ int isis_send_pdu_p2p(struct isis_circuit *circuit, int level)
 
 	/* lets try correcting the protocol */
 	sa.sll_protocol = htons(0x00FE);
+
+	if (tx_batch.circuit == circuit)
+		return isis_tx_batch_add(circuit, &sa, false);
+
 	rv = sendto(circuit->fd, circuit->snd_stream->data,
 		    stream_get_endp(circuit->snd_stream), 0,
 		    (struct sockaddr *)&sa, sizeof(struct sockaddr_ll));
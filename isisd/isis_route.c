@@ -177,13 +177,15 @@ void adjinfo2nexthop(int family, struct list *nexthops,
 }
 
 static void isis_route_add_dummy_nexthops(struct isis_route_info *rinfo,
-					  const uint8_t *sysid,
+					  int family, const uint8_t *sysid,
 					  struct isis_sr_psid_info *sr,
 					  struct mpls_label_stack *label_stack)
 {
 	struct isis_nexthop *nh;
 
 	nh = XCALLOC(MTYPE_ISIS_NEXTHOP, sizeof(struct isis_nexthop));
+	/* No address, but good enough to be sent to zebra */
+	nh->family = family;
 	memcpy(nh->sysid, sysid, sizeof(nh->sysid));
 	nh->sr = *sr;
 	nh->label_stack = label_stack;
@@ -213,7 +215,8 @@ isis_route_info_new(struct prefix *prefix, struct prefix_ipv6 *src_p,
 		 * environment.
 		 */
 		if (CHECK_FLAG(im->options, F_ISIS_UNIT_TEST)) {
-			isis_route_add_dummy_nexthops(rinfo, sadj->id, sr,
+			isis_route_add_dummy_nexthops(rinfo, prefix->family,
+						      sadj->id, sr,
 						      label_stack);
 			if (!allow_ecmp)
 				break;
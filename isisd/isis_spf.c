@@ -39,6 +39,7 @@
 #include "spf_backoff.h"
 #include "srcdest_table.h"
 #include "vrf.h"
+#include "frr_pthread.h"
 
 #include "isis_errors.h"
 #include "isis_constants.h"
@@ -454,6 +455,10 @@ static int spf_adj_state_change(struct isis_adjacency *adj)
 {
 	struct isis_area *area = adj->circuit->area;
 
+	/* The next SPF run can't reuse the previous SPT. */
+	for (int level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++)
+		area->spf_topo_changed[level - 1] = true;
+
 	if (adj->adj_state == ISIS_ADJ_UP)
 		return 0;
 
@@ -807,7 +812,7 @@ static int isis_spf_process_lsp(struct isis_spftree *spftree,
 				struct isis_vertex *parent)
 {
 	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
-	struct listnode *fragnode = NULL;
+	struct isis_lsp *lsp0 = lsp, *frag = NULL;
 	uint32_t dist;
 	enum vertextype vtype;
 	static const uint8_t null_sysid[ISIS_SYS_ID_LEN];
@@ -1101,13 +1106,13 @@ end:
 			  parent);
 	}
 
-	if (fragnode == NULL)
-		fragnode = listhead(lsp->lspu.frags);
+	if (frag == NULL)
+		frag = lsp_frags_first(&lsp0->frags);
 	else
-		fragnode = listnextnode(fragnode);
+		frag = lsp_frags_next(&lsp0->frags, frag);
 
-	if (fragnode) {
-		lsp = listgetdata(fragnode);
+	if (frag) {
+		lsp = frag;
 		goto lspfragloop;
 	}
 
@@ -1408,7 +1413,6 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 {
 	bool pseudo_lsp = LSP_PSEUDO_ID(lsp->hdr.lsp_id);
 	struct isis_lsp *frag;
-	struct listnode *node;
 	struct isis_item *head;
 	struct isis_item_list *te_neighs;
 
@@ -1442,7 +1446,8 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 				spf_adj_list_parse_tlv(
 					spftree, adj_list, reach->id,
 					pseudo_nodeid, pseudo_metric,
-					reach->metric, false, reach->subtlvs);
+					reach->metric, false,
+					isis_extended_reach_subtlvs(reach));
 			}
 		}
 	}
@@ -1451,7 +1456,7 @@ static void spf_adj_list_parse_lsp(struct isis_spftree *spftree,
 		return;
 
 	/* Parse LSP fragments. */
-	for (ALL_LIST_ELEMENTS_RO(lsp->lspu.frags, node, frag)) {
+	frr_each (lsp_frags, &lsp->frags, frag) {
 		if (!frag->tlvs)
 			continue;
 
@@ -1654,12 +1659,34 @@ static void spf_path_process(struct isis_spftree *spftree,
 	}
 }
 
+/* Generate routes once the SPT is formed. */
+static void isis_spf_paths_process(struct isis_spftree *spftree)
+{
+	struct isis_vertex *vertex;
+	struct listnode *node;
+
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		/* New-style TLVs take precedence over the old-style TLVs. */
+		switch (vertex->type) {
+		case VTYPE_IPREACH_INTERNAL:
+		case VTYPE_IPREACH_EXTERNAL:
+			if (isis_find_vertex(&spftree->paths, &vertex->N,
+					     VTYPE_IPREACH_TE))
+				continue;
+			break;
+		default:
+			break;
+		}
+
+		spf_path_process(spftree, vertex);
+	}
+}
+
 static void isis_spf_loop(struct isis_spftree *spftree,
 			  uint8_t *root_sysid)
 {
 	struct isis_vertex *vertex;
 	struct isis_lsp *lsp;
-	struct listnode *node;
 
 	while (isis_vertex_queue_count(&spftree->tents)) {
 		vertex = isis_vertex_queue_pop(&spftree->tents);
@@ -1688,23 +1715,6 @@ static void isis_spf_loop(struct isis_spftree *spftree,
 		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
 				     root_sysid, vertex);
 	}
-
-	/* Generate routes once the SPT is formed. */
-	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
-		/* New-style TLVs take precedence over the old-style TLVs. */
-		switch (vertex->type) {
-		case VTYPE_IPREACH_INTERNAL:
-		case VTYPE_IPREACH_EXTERNAL:
-			if (isis_find_vertex(&spftree->paths, &vertex->N,
-					     VTYPE_IPREACH_TE))
-				continue;
-			break;
-		default:
-			break;
-		}
-
-		spf_path_process(spftree, vertex);
-	}
 }
 
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
@@ -1740,27 +1750,38 @@ struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
 	}
 
 	isis_spf_loop(spftree, sysid);
+	isis_spf_paths_process(spftree);
 
 	return spftree;
 }
 
-void isis_run_spf(struct isis_spftree *spftree)
-{
+/* State of one SPF run, across the steps done by the functions below. */
+struct isis_spf_calc {
+	struct isis_spftree *spftree;
 	struct isis_lsp *root_lsp;
 	struct isis_vertex *root_vertex;
 	struct timeval time_start;
-	struct timeval time_end;
+};
+
+/*
+ * C.2.5 Step 0.  The adjacency list is built from the LSPs of the root and
+ * its pseudonodes, whose IS reachability sub-TLVs get decoded on first use,
+ * so this has to be done on the main pthread.
+ */
+static bool isis_spf_calc_start(struct isis_spf_calc *calc)
+{
+	struct isis_spftree *spftree = calc->spftree;
 	struct isis_mt_router_info *mt_router_info;
 	uint16_t mtid = 0;
 
 	/* Get time that can't roll backwards. */
-	monotime(&time_start);
+	monotime(&calc->time_start);
 
-	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
-	if (root_lsp == NULL) {
+	calc->root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (calc->root_lsp == NULL) {
 		zlog_err("ISIS-SPF: could not find own l%d LSP!",
 			 spftree->level);
-		return;
+		return false;
 	}
 
 	/* Get Multi-Topology ID. */
@@ -1770,7 +1791,7 @@ void isis_run_spf(struct isis_spftree *spftree)
 		break;
 	case SPFTREE_IPV6:
 		mt_router_info = isis_tlvs_lookup_mt_router_info(
-			root_lsp->tlvs, ISIS_MT_IPV6_UNICAST);
+			calc->root_lsp->tlvs, ISIS_MT_IPV6_UNICAST);
 		if (mt_router_info)
 			mtid = ISIS_MT_IPV6_UNICAST;
 		else
@@ -1786,15 +1807,26 @@ void isis_run_spf(struct isis_spftree *spftree)
 		exit(1);
 	}
 
-	/*
-	 * C.2.5 Step 0
-	 */
 	init_spt(spftree, mtid);
 	/*              a) */
-	root_vertex = isis_spf_add_root(spftree);
+	calc->root_vertex = isis_spf_add_root(spftree);
 	/*              b) */
-	isis_spf_build_adj_list(spftree, root_lsp);
-	isis_spf_preload_tent(spftree, spftree->sysid, root_lsp, root_vertex);
+	isis_spf_build_adj_list(spftree, calc->root_lsp);
+
+	return true;
+}
+
+/*
+ * Build the SPT.  This only reads the LSPDB and adjacencies and only
+ * modifies the tree itself, so different trees can be built concurrently.
+ */
+static void isis_spf_calc_tree(void *arg)
+{
+	struct isis_spf_calc *calc = arg;
+	struct isis_spftree *spftree = calc->spftree;
+
+	isis_spf_preload_tent(spftree, spftree->sysid, calc->root_lsp,
+			      calc->root_vertex);
 
 	/*
 	 * C.2.7 Step 2
@@ -1806,25 +1838,231 @@ void isis_run_spf(struct isis_spftree *spftree)
 	}
 
 	isis_spf_loop(spftree, spftree->sysid);
+}
+
+/* Generate the routes of the SPT, on the main pthread. */
+static void isis_spf_calc_finish(struct isis_spf_calc *calc)
+{
+	struct isis_spftree *spftree = calc->spftree;
+	struct timeval time_end;
+
+	isis_spf_paths_process(spftree);
+	spftree->runcount++;
+	spftree->last_run_timestamp = time(NULL);
+	spftree->last_run_monotime = monotime(&time_end);
+	spftree->last_run_duration =
+		((time_end.tv_sec - calc->time_start.tv_sec) * 1000000)
+		+ (time_end.tv_usec - calc->time_start.tv_usec);
+}
+
+void isis_run_spf(struct isis_spftree *spftree)
+{
+	struct isis_spf_calc calc = {.spftree = spftree};
+
+	if (!isis_spf_calc_start(&calc))
+		return;
+
+	isis_spf_calc_tree(&calc);
+	isis_spf_calc_finish(&calc);
+}
+
+/*
+ * The trees of the topologies of one level are independent of each other,
+ * and are built on a pool of worker pthreads when more than one of them
+ * needs a full SPF run.
+ */
+#define ISIS_SPF_WORKERS_MAX 8
+
+static struct frr_pthread_pool *isis_spf_pool;
+static bool isis_spf_pool_tried;
+
+static struct frr_pthread_pool *isis_spf_pool_get(void)
+{
+	long nprocs;
+
+	if (!isis_spf_pool_tried) {
+		isis_spf_pool_tried = true;
+
+		nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		if (nprocs > 1)
+			isis_spf_pool = frr_pthread_pool_new(
+				"IS-IS SPF", MIN(nprocs - 1,
+						 ISIS_SPF_WORKERS_MAX));
+	}
+
+	return isis_spf_pool;
+}
+
+void isis_spf_pool_finish(void)
+{
+	frr_pthread_pool_free(&isis_spf_pool);
+}
+
+static void isis_run_spf_trees(struct isis_spftree **trees, int count)
+{
+	struct isis_spf_calc calcs[SPFTREE_COUNT] = {};
+	void *args[SPFTREE_COUNT];
+	struct frr_pthread_pool *pool = NULL;
+	int i, n = 0;
+
+	if (count > 1)
+		pool = isis_spf_pool_get();
+	if (!pool) {
+		for (i = 0; i < count; i++)
+			isis_run_spf(trees[i]);
+		return;
+	}
+
+	for (i = 0; i < count; i++) {
+		calcs[n].spftree = trees[i];
+		if (!isis_spf_calc_start(&calcs[n]))
+			continue;
+		args[n] = &calcs[n];
+		n++;
+	}
+
+	frr_pthread_pool_run(pool, isis_spf_calc_tree, args, n);
+
+	for (i = 0; i < n; i++)
+		isis_spf_calc_finish(&calcs[i]);
+}
+
+/*
+ * Partial route calculation, for when only prefixes changed since the last
+ * SPF run: the IS vertices of the SPT are kept as they are, and only the
+ * prefixes advertised by them are added again.  Returns false if the SPT
+ * turns out to be outdated, in which case a full SPF run is needed.
+ */
+bool isis_run_prc(struct isis_spftree *spftree)
+{
+	struct spf_preload_tent_ip_reach_args ip_reach_args;
+	struct isis_lsp *root_lsp, *lsp;
+	struct isis_vertex *root_vertex, *vertex;
+	struct listnode *node, *nnode;
+	struct timeval time_start;
+	struct timeval time_end;
+
+	if (!spftree->runcount || spftree->type != SPF_TYPE_FORWARD
+	    || CHECK_FLAG(spftree->flags, F_SPFTREE_HOPCOUNT_METRIC)
+	    || !listcount(spftree->paths.l.list))
+		return false;
+
+	monotime(&time_start);
+
+	root_lsp = isis_root_system_lsp(spftree->lspdb, spftree->sysid);
+	if (!root_lsp)
+		return false;
+
+	/* Remove the prefixes of the previous run. */
+	hash_clean(spftree->prefix_sids, NULL);
+	isis_vertex_queue_clear(&spftree->tents);
+	for (ALL_LIST_ELEMENTS(spftree->paths.l.list, node, nnode, vertex)) {
+		if (!VTYPE_IP(vertex->type))
+			continue;
+
+		hash_release(spftree->paths.hash, vertex);
+		list_delete_node(spftree->paths.l.list, node);
+		isis_vertex_del(vertex);
+	}
+	isis_zebra_rlfa_unregister_all(spftree);
+	isis_rlfa_list_clear(spftree);
+	list_delete_all_node(spftree->lfa.remote.pc_spftrees);
+	memset(&spftree->lfa.protection_counters, 0,
+	       sizeof(spftree->lfa.protection_counters));
+
+	/* The root is always the first vertex added to PATHS. */
+	root_vertex = listgetdata(listhead(spftree->paths.l.list));
+	for (ALL_QUEUE_ELEMENTS_RO(&spftree->paths, node, vertex)) {
+		if (vertex == root_vertex) {
+			ip_reach_args.spftree = spftree;
+			ip_reach_args.parent = root_vertex;
+			isis_lsp_iterate_ip_reach(
+				root_lsp, spftree->family, spftree->mtid,
+				isis_spf_preload_tent_ip_reach_cb,
+				&ip_reach_args);
+			continue;
+		}
+
+		lsp = lsp_for_vertex(spftree, vertex);
+		if (!lsp)
+			continue;
+
+		isis_spf_process_lsp(spftree, lsp, vertex->d_N, vertex->depth,
+				     spftree->sysid, vertex);
+	}
+
+	/*
+	 * All systems were already in PATHS, so TENT holds prefixes only.
+	 * Anything else means the topology did change.
+	 */
+	while (isis_vertex_queue_count(&spftree->tents)) {
+		vertex = isis_vertex_queue_pop(&spftree->tents);
+		if (!VTYPE_IP(vertex->type)) {
+			isis_vertex_del(vertex);
+			return false;
+		}
+
+		add_to_paths(spftree, vertex);
+	}
+
+	isis_spf_paths_process(spftree);
 	spftree->runcount++;
 	spftree->last_run_timestamp = time(NULL);
 	spftree->last_run_monotime = monotime(&time_end);
 	spftree->last_run_duration =
 		((time_end.tv_sec - time_start.tv_sec) * 1000000)
 		+ (time_end.tv_usec - time_start.tv_usec);
+
+	return true;
 }
 
-static void isis_run_spf_with_protection(struct isis_area *area,
-					 struct isis_spftree *spftree)
+static bool isis_spf_protection_enabled(struct isis_area *area, int level)
 {
-	/* Run forward SPF locally. */
-	memcpy(spftree->sysid, area->isis->sysid, ISIS_SYS_ID_LEN);
-	isis_run_spf(spftree);
+	return area->lfa_protected_links[level - 1] > 0
+	       || area->tilfa_protected_links[level - 1] > 0;
+}
+
+/*
+ * The (TI-)LFA calculations take one SPF run per protected resource, so
+ * they are done separately after the primary routes have been installed,
+ * which then get their backup paths with another route verification.
+ */
+static void isis_run_lfa_cb(struct thread *thread)
+{
+	struct isis_area *area = THREAD_ARG(thread);
+	struct isis_spftree *spftree;
+	bool have_run = false;
+	int level;
 
-	/* Run LFA protection if configured. */
-	if (area->lfa_protected_links[spftree->level - 1] > 0
-	    || area->tilfa_protected_links[spftree->level - 1] > 0)
-		isis_spf_run_lfa(area, spftree);
+	for (level = ISIS_LEVEL1; level <= ISIS_LEVEL2; level++) {
+		if (!area->lfa_pending[level - 1])
+			continue;
+		area->lfa_pending[level - 1] = false;
+
+		if (!(area->is_type & level)
+		    || !isis_spf_protection_enabled(area, level))
+			continue;
+
+		for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
+			spftree = area->spftree[tree][level - 1];
+			if (!spftree || !spftree->runcount)
+				continue;
+			if (tree == SPFTREE_IPV4 && !area->ip_circuits)
+				continue;
+			if (tree == SPFTREE_IPV6 && !area->ipv6_circuits)
+				continue;
+			if (tree == SPFTREE_DSTSRC
+			    && !(area->ipv6_circuits
+				 && isis_area_ipv6_dstsrc_enabled(area)))
+				continue;
+
+			isis_spf_run_lfa(area, spftree);
+			have_run = true;
+		}
+	}
+
+	if (have_run)
+		isis_area_verify_routes(area);
 }
 
 void isis_spf_verify_routes(struct isis_area *area, struct isis_spftree **trees)
@@ -1867,7 +2105,10 @@ static void isis_run_spf_cb(struct thread *thread)
 	struct isis_spf_run *run = THREAD_ARG(thread);
 	struct isis_area *area = run->area;
 	int level = run->level;
+	struct isis_spftree *trees[SPFTREE_COUNT], *full[SPFTREE_COUNT];
+	int count = 0, nfull = 0, i;
 	int have_run = 0;
+	bool prc;
 
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 
@@ -1881,31 +2122,45 @@ static void isis_run_spf_cb(struct thread *thread)
 	isis_area_delete_backup_adj_sids(area, level);
 	isis_area_invalidate_routes(area, level);
 
+	prc = !area->spf_topo_changed[level - 1];
+	area->spf_topo_changed[level - 1] = false;
+
 	if (IS_DEBUG_SPF_EVENTS)
-		zlog_debug("ISIS-SPF (%s) L%d SPF needed, periodic SPF",
-			   area->area_tag, level);
+		zlog_debug("ISIS-SPF (%s) L%d %s needed, periodic SPF",
+			   area->area_tag, level, prc ? "PRC" : "SPF");
 
-	if (area->ip_circuits) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV4][level - 1]);
-		have_run = 1;
-	}
-	if (area->ipv6_circuits) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_IPV6][level - 1]);
-		have_run = 1;
-	}
-	if (area->ipv6_circuits && isis_area_ipv6_dstsrc_enabled(area)) {
-		isis_run_spf_with_protection(
-			area, area->spftree[SPFTREE_DSTSRC][level - 1]);
-		have_run = 1;
+	if (area->ip_circuits)
+		trees[count++] = area->spftree[SPFTREE_IPV4][level - 1];
+	if (area->ipv6_circuits)
+		trees[count++] = area->spftree[SPFTREE_IPV6][level - 1];
+	if (area->ipv6_circuits && isis_area_ipv6_dstsrc_enabled(area))
+		trees[count++] = area->spftree[SPFTREE_DSTSRC][level - 1];
+
+	/* Run forward SPF locally, or just PRC if that is enough. */
+	for (i = 0; i < count; i++) {
+		memcpy(trees[i]->sysid, area->isis->sysid, ISIS_SYS_ID_LEN);
+		if (!prc || !isis_run_prc(trees[i]))
+			full[nfull++] = trees[i];
 	}
+	isis_run_spf_trees(full, nfull);
+	have_run = count > 0;
+
+	/*
+	 * Run LFA protection if configured, once the primary routes are
+	 * installed.
+	 */
+	if (have_run && isis_spf_protection_enabled(area, level))
+		area->lfa_pending[level - 1] = true;
 
 	if (have_run)
 		area->spf_run_count[level]++;
 
 	isis_area_verify_routes(area);
 
+	if (area->lfa_pending[level - 1])
+		thread_add_event(master, isis_run_lfa_cb, area, 0,
+				 &area->t_lfa_calc);
+
 	/* walk all circuits and reset any spf specific flags */
 	struct listnode *node;
 	struct isis_circuit *circuit;
@@ -1930,7 +2185,7 @@ void isis_spf_timer_free(void *run)
 	XFREE(MTYPE_ISIS_SPF_RUN, run);
 }
 
-int _isis_spf_schedule(struct isis_area *area, int level,
+int _isis_spf_schedule(struct isis_area *area, int level, bool topology,
 		       const char *func, const char *file, int line)
 {
 	struct isis_spftree *spftree;
@@ -1953,6 +2208,9 @@ int _isis_spf_schedule(struct isis_area *area, int level,
 	assert(diff >= 0);
 	assert(area->is_type & level);
 
+	if (topology)
+		area->spf_topo_changed[level - 1] = true;
+
 	if (IS_DEBUG_SPF_EVENTS) {
 		zlog_debug(
 			"ISIS-SPF (%s) L%d SPF schedule called, lastrun %ld sec ago Caller: %s %s:%d",
@@ -70,9 +70,13 @@ void spftree_area_del(struct isis_area *area);
 struct isis_lsp *isis_root_system_lsp(struct lspdb_head *lspdb,
 				      const uint8_t *sysid);
 #define isis_spf_schedule(area, level) \
-	_isis_spf_schedule((area), (level), __func__, \
+	_isis_spf_schedule((area), (level), true, __func__, \
 			   __FILE__, __LINE__)
-int _isis_spf_schedule(struct isis_area *area, int level,
+/* Only prefixes changed, the routes can be recalculated on the old SPT. */
+#define isis_spf_schedule_prefixes(area, level) \
+	_isis_spf_schedule((area), (level), false, __func__, \
+			   __FILE__, __LINE__)
+int _isis_spf_schedule(struct isis_area *area, int level, bool topology,
 		       const char *func, const char *file, int line);
 void isis_print_spftree(struct vty *vty, struct isis_spftree *spftree);
 void isis_print_routes(struct vty *vty, struct isis_spftree *spftree,
@@ -82,6 +86,8 @@ void isis_spf_print(struct isis_spftree *spftree, struct vty *vty);
 void isis_spf_print_json(struct isis_spftree *spftree,
 			 struct json_object *json);
 void isis_run_spf(struct isis_spftree *spftree);
+bool isis_run_prc(struct isis_spftree *spftree);
+void isis_spf_pool_finish(void);
 struct isis_spftree *isis_run_hopcount_spf(struct isis_area *area,
 					   uint8_t *sysid,
 					   struct isis_spftree *spftree);
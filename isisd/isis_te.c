@@ -1330,7 +1330,7 @@ void isis_te_lsp_event(struct isis_lsp *lsp, enum lsp_event event)
 
 	/* Adjust LSP0 in case of fragment */
 	if (LSP_FRAGMENT(lsp->hdr.lsp_id))
-		lsp0 = lsp->lspu.zero_lsp;
+		lsp0 = lsp->zero_lsp;
 	else
 		lsp0 = lsp;
 
@@ -1850,6 +1850,64 @@ static int unpack_item_lsp_entry(uint16_t mtid, uint8_t len, struct stream *s,
 
 /* Functions related to TLVs 22/222 Extended Reach/MT Reach */
 
+/* Set while unpacking with isis_unpack_tlvs_lazy() */
+static bool unpack_lazy;
+
+/*
+ * Check the sub-TLV lengths of an IS reachability entry, the only thing
+ * that makes unpack_item_ext_subtlvs() fail.  Like the latter, trailing
+ * bytes too short for a sub-TLV header are not accounted for in *used.
+ */
+static bool ext_subtlvs_len_valid(const uint8_t *raw, uint8_t len,
+				  uint8_t *used, struct sbuf *log, int indent)
+{
+	uint8_t sum = 0;
+
+	while (len > sum + 2) {
+		uint8_t subtlv_type = raw[sum];
+		uint8_t subtlv_len = raw[sum + 1];
+
+		if (subtlv_len > len - sum - ISIS_SUBTLV_HDR_SIZE) {
+			sbuf_push(
+				log, indent,
+				"TLV %hhu: Available data %u is less than TLV size %u !\n",
+				subtlv_type, len - sum - ISIS_SUBTLV_HDR_SIZE,
+				subtlv_len);
+			return false;
+		}
+		sum += subtlv_len + ISIS_SUBTLV_HDR_SIZE;
+	}
+
+	*used = sum;
+	return true;
+}
+
+struct isis_ext_subtlvs *
+isis_extended_reach_subtlvs(struct isis_extended_reach *r)
+{
+	static struct sbuf log;
+	struct stream *s;
+
+	if (!r->subtlvs_raw)
+		return r->subtlvs;
+
+	if (!sbuf_buf(&log))
+		sbuf_init(&log, NULL, 0);
+	sbuf_reset(&log);
+
+	s = stream_new(r->subtlvs_raw_len);
+	stream_put(s, r->subtlvs_raw, r->subtlvs_raw_len);
+	/* Can't fail, the lengths were checked when unpacking. */
+	(void)unpack_item_ext_subtlvs(r->subtlvs_mtid, r->subtlvs_raw_len, s,
+				      &log, r, 0);
+	stream_free(s);
+
+	XFREE(MTYPE_ISIS_SUBTLV, r->subtlvs_raw);
+	r->subtlvs_raw_len = 0;
+
+	return r->subtlvs;
+}
+
 static struct isis_item *copy_item_extended_reach(struct isis_item *i)
 {
 	struct isis_extended_reach *r = (struct isis_extended_reach *)i;
@@ -1861,6 +1919,13 @@ static struct isis_item *copy_item_extended_reach(struct isis_item *i)
 	if (r->subtlvs)
 		rv->subtlvs = copy_item_ext_subtlvs(r->subtlvs, -1);
 
+	if (r->subtlvs_raw) {
+		rv->subtlvs_raw = XMALLOC(MTYPE_ISIS_SUBTLV, r->subtlvs_raw_len);
+		memcpy(rv->subtlvs_raw, r->subtlvs_raw, r->subtlvs_raw_len);
+		rv->subtlvs_raw_len = r->subtlvs_raw_len;
+		rv->subtlvs_mtid = r->subtlvs_mtid;
+	}
+
 	return (struct isis_item *)rv;
 }
 
@@ -1870,6 +1935,8 @@ static void format_item_extended_reach(uint16_t mtid, struct isis_item *i,
 {
 	struct isis_extended_reach *r = (struct isis_extended_reach *)i;
 
+	isis_extended_reach_subtlvs(r);
+
 	if (json) {
 		struct json_object *reach_json;
 		reach_json = json_object_new_object();
@@ -1907,6 +1974,7 @@ static void free_item_extended_reach(struct isis_item *i)
 
 	if (item->subtlvs != NULL)
 		free_item_ext_subtlvs(item->subtlvs);
+	XFREE(MTYPE_ISIS_SUBTLV, item->subtlvs_raw);
 	XFREE(MTYPE_ISIS_TLV, item);
 }
 
@@ -1927,7 +1995,9 @@ static int pack_item_extended_reach(struct isis_item *i, struct stream *s,
 	len_pos = stream_get_endp(s);
 	 /* Real length will be adjust after adding subTLVs */
 	stream_putc(s, 11);
-	if (r->subtlvs)
+	if (r->subtlvs_raw)
+		stream_put(s, r->subtlvs_raw, r->subtlvs_raw_len);
+	else if (r->subtlvs)
 		pack_item_ext_subtlvs(r->subtlvs, s, min_len);
 	/* Adjust length */
 	len = stream_get_endp(s) - len_pos - 1;
@@ -1975,6 +2045,28 @@ static int unpack_item_extended_reach(uint16_t mtid, uint8_t len,
 	sbuf_push(log, indent, "Storing %hhu bytes of subtlvs\n",
 		  subtlv_len);
 
+	if (unpack_lazy) {
+		if (subtlv_len) {
+			uint8_t raw_len;
+
+			if (!ext_subtlvs_len_valid(stream_pnt(s), subtlv_len,
+						   &raw_len, log, indent + 4))
+				goto out;
+
+			if (raw_len) {
+				rv->subtlvs_raw = XMALLOC(MTYPE_ISIS_SUBTLV,
+							  raw_len);
+				rv->subtlvs_raw_len = raw_len;
+				rv->subtlvs_mtid = mtid;
+				stream_get(rv->subtlvs_raw, s, raw_len);
+			} else
+				rv->subtlvs = isis_alloc_ext_subtlvs();
+		}
+
+		append_item(items, (struct isis_item *)rv);
+		return 0;
+	}
+
 	if (subtlv_len) {
 		if (unpack_item_ext_subtlvs(mtid, subtlv_len, s, log, rv,
 					    indent + 4)) {
@@ -5103,6 +5195,18 @@ int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 	return rv;
 }
 
+int isis_unpack_tlvs_lazy(size_t avail_len, struct stream *stream,
+			  struct isis_tlvs **dest, const char **log)
+{
+	int rv;
+
+	unpack_lazy = true;
+	rv = isis_unpack_tlvs(avail_len, stream, dest, log);
+	unpack_lazy = false;
+
+	return rv;
+}
+
 #define TLV_OPS(_name_, _desc_)                                                \
 	static const struct tlv_ops tlv_##_name_##_ops = {                     \
 		.name = _desc_, .unpack = unpack_tlv_##_name_,                 \
@@ -5437,6 +5541,55 @@ bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 	return false;
 }
 
+/*
+ * Strip the TLVs that don't take part in building the SPT (reachability
+ * information, hostname, authentication) and pack the remainder.
+ */
+static struct stream *tlvs_pack_topology(const struct isis_tlvs *tlvs)
+{
+	struct isis_tlvs topo = *tlvs;
+	struct stream *s = stream_new(UINT16_MAX);
+
+	init_item_list(&topo.isis_auth);
+	topo.purge_originator = NULL;
+	init_item_list(&topo.lsp_entries);
+	init_item_list(&topo.oldstyle_ip_reach);
+	init_item_list(&topo.oldstyle_ip_reach_ext);
+	init_item_list(&topo.extended_ip_reach);
+	RB_INIT(isis_mt_item_list, &topo.mt_ip_reach);
+	init_item_list(&topo.ipv6_reach);
+	RB_INIT(isis_mt_item_list, &topo.mt_ipv6_reach);
+	topo.hostname = NULL;
+
+	if (pack_tlvs(&topo, s, NULL, NULL, NULL)) {
+		stream_free(s);
+		return NULL;
+	}
+
+	return s;
+}
+
+bool isis_tlvs_same_topology(const struct isis_tlvs *a,
+			     const struct isis_tlvs *b)
+{
+	struct stream *sa, *sb;
+	bool same;
+
+	sa = tlvs_pack_topology(a);
+	sb = tlvs_pack_topology(b);
+
+	same = sa && sb && stream_get_endp(sa) == stream_get_endp(sb)
+	       && !memcmp(STREAM_DATA(sa), STREAM_DATA(sb),
+			  stream_get_endp(sa));
+
+	if (sa)
+		stream_free(sa);
+	if (sb)
+		stream_free(sb);
+
+	return same;
+}
+
 static void tlvs_area_addresses_to_adj(struct isis_tlvs *tlvs,
 				       struct isis_adjacency *adj,
 				       bool *changed)
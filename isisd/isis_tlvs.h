@@ -75,6 +75,14 @@ struct isis_extended_reach {
 	uint32_t metric;
 
 	struct isis_ext_subtlvs *subtlvs;
+
+	/*
+	 * Sub-TLVs as received with isis_unpack_tlvs_lazy(), decoded into
+	 * subtlvs by isis_extended_reach_subtlvs() when first needed.
+	 */
+	uint8_t *subtlvs_raw;
+	uint8_t subtlvs_raw_len;
+	uint16_t subtlvs_mtid;
 };
 
 struct isis_extended_ip_reach {
@@ -530,6 +538,15 @@ void isis_free_tlvs(struct isis_tlvs *tlvs);
 struct isis_tlvs *isis_alloc_tlvs(void);
 int isis_unpack_tlvs(size_t avail_len, struct stream *stream,
 		     struct isis_tlvs **dest, const char **error_log);
+/*
+ * Same as isis_unpack_tlvs(), but only checks the length of the sub-TLVs of
+ * IS reachability entries and defers decoding them until they are asked for
+ * with isis_extended_reach_subtlvs().
+ */
+int isis_unpack_tlvs_lazy(size_t avail_len, struct stream *stream,
+			  struct isis_tlvs **dest, const char **error_log);
+struct isis_ext_subtlvs *
+isis_extended_reach_subtlvs(struct isis_extended_reach *r);
 const char *isis_format_tlvs(struct isis_tlvs *tlvs, struct json_object *json);
 struct isis_tlvs *isis_copy_tlvs(struct isis_tlvs *tlvs);
 struct list *isis_fragment_tlvs(struct isis_tlvs *tlvs, size_t size);
@@ -567,6 +584,9 @@ int isis_tlvs_auth_is_valid(struct isis_tlvs *tlvs, struct isis_passwd *passwd,
 			    struct stream *stream, bool is_lsp);
 bool isis_tlvs_area_addresses_match(struct isis_tlvs *tlvs,
 				    struct list *addresses);
+/* True if a and b only differ in TLVs that don't affect the SPT. */
+bool isis_tlvs_same_topology(const struct isis_tlvs *a,
+			     const struct isis_tlvs *b);
 struct isis_adjacency;
 void isis_tlvs_to_adj(struct isis_tlvs *tlvs, struct isis_adjacency *adj,
 		      bool *changed);
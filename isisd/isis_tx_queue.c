@@ -29,26 +29,50 @@
 #include "isisd/isis_circuit.h"
 #include "isisd/isis_lsp.h"
 #include "isisd/isis_misc.h"
+#include "isisd/isis_network.h"
 #include "isisd/isis_tx_queue.h"
 
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE, "ISIS TX Queue");
 DEFINE_MTYPE_STATIC(ISISD, TX_QUEUE_ENTRY, "ISIS TX Queue Entry");
 
+/* Seconds until an LSP is sent again, unless it was removed meanwhile */
+#define TX_QUEUE_RETRY_INTERVAL 5
+/* LSPs sent per run of the queue, handed to the kernel together */
+#define TX_QUEUE_BATCH 64
+
+PREDECL_DLIST(tx_queue_list);
+
+/*
+ * Each queue runs one event for the LSPs waiting to be sent and one timer
+ * for the retransmissions, instead of a timer per LSP.  As the retry
+ * interval is the same for all LSPs, the sent list is ordered by
+ * retransmission time by just appending to it.
+ */
 struct isis_tx_queue {
 	struct isis_circuit *circuit;
 	void (*send_event)(struct isis_circuit *circuit,
 			   struct isis_lsp *, enum isis_tx_type);
 	struct hash *hash;
+
+	struct tx_queue_list_head pending;
+	struct tx_queue_list_head sent;
+	struct thread *t_send;
+	struct thread *t_retry;
 };
 
 struct isis_tx_queue_entry {
 	struct isis_lsp *lsp;
 	enum isis_tx_type type;
-	bool is_retry;
-	struct thread *retry;
 	struct isis_tx_queue *queue;
+
+	/* on either the pending or the sent list of the queue */
+	struct tx_queue_list_item item;
+	struct tx_queue_list_head *list;
+	time_t retry_time;
 };
 
+DECLARE_DLIST(tx_queue_list, struct isis_tx_queue_entry, item);
+
 static unsigned tx_queue_hash_key(const void *p)
 {
 	const struct isis_tx_queue_entry *e = p;
@@ -85,6 +109,8 @@ struct isis_tx_queue *isis_tx_queue_new(
 	rv->send_event = send_event;
 
 	rv->hash = hash_create(tx_queue_hash_key, tx_queue_hash_cmp, NULL);
+	tx_queue_list_init(&rv->pending);
+	tx_queue_list_init(&rv->sent);
 	return rv;
 }
 
@@ -92,7 +118,7 @@ static void tx_queue_element_free(void *element)
 {
 	struct isis_tx_queue_entry *e = element;
 
-	THREAD_OFF(e->retry);
+	tx_queue_list_del(e->list, e);
 
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
 }
@@ -101,6 +127,10 @@ void isis_tx_queue_free(struct isis_tx_queue *queue)
 {
 	hash_clean(queue->hash, tx_queue_element_free);
 	hash_free(queue->hash);
+	THREAD_OFF(queue->t_send);
+	THREAD_OFF(queue->t_retry);
+	tx_queue_list_fini(&queue->pending);
+	tx_queue_list_fini(&queue->sent);
 	XFREE(MTYPE_TX_QUEUE, queue);
 }
 
@@ -114,22 +144,81 @@ static struct isis_tx_queue_entry *tx_queue_find(struct isis_tx_queue *queue,
 	return hash_lookup(queue->hash, &e);
 }
 
-static void tx_queue_send_event(struct thread *thread)
+static void tx_queue_move(struct isis_tx_queue_entry *e,
+			  struct tx_queue_list_head *list)
 {
-	struct isis_tx_queue_entry *e = THREAD_ARG(thread);
-	struct isis_tx_queue *queue = e->queue;
+	if (e->list)
+		tx_queue_list_del(e->list, e);
+	e->list = list;
+	tx_queue_list_add_tail(list, e);
+}
 
-	thread_add_timer(master, tx_queue_send_event, e, 5, &e->retry);
+static void tx_queue_retry(struct thread *thread);
 
-	if (e->is_retry)
-		queue->circuit->area->lsp_rxmt_count++;
-	else
-		e->is_retry = true;
+static void tx_queue_schedule_retry(struct isis_tx_queue *queue)
+{
+	struct isis_tx_queue_entry *e;
+	time_t now;
+
+	e = tx_queue_list_first(&queue->sent);
+	if (!e || queue->t_retry)
+		return;
+
+	now = monotime(NULL);
+	thread_add_timer(master, tx_queue_retry, queue,
+			 e->retry_time > now ? e->retry_time - now : 0,
+			 &queue->t_retry);
+}
+
+/* Send e, it is moved to the sent list before as send_event may free it. */
+static void tx_queue_send(struct isis_tx_queue *queue,
+			  struct isis_tx_queue_entry *e, time_t now)
+{
+	e->retry_time = now + TX_QUEUE_RETRY_INTERVAL;
+	tx_queue_move(e, &queue->sent);
 
 	queue->send_event(queue->circuit, e->lsp, e->type);
 	/* Don't access e here anymore, send_event might have destroyed it */
 }
 
+static void tx_queue_send_pending(struct thread *thread)
+{
+	struct isis_tx_queue *queue = THREAD_ARG(thread);
+	struct isis_tx_queue_entry *e;
+	time_t now = monotime(NULL);
+	unsigned int count = 0;
+
+	isis_tx_batch_start(queue->circuit);
+	while (count++ < TX_QUEUE_BATCH
+	       && (e = tx_queue_list_first(&queue->pending)))
+		tx_queue_send(queue, e, now);
+	isis_tx_batch_flush(queue->circuit);
+
+	if (tx_queue_list_count(&queue->pending))
+		thread_add_event(master, tx_queue_send_pending, queue, 0,
+				 &queue->t_send);
+	tx_queue_schedule_retry(queue);
+}
+
+static void tx_queue_retry(struct thread *thread)
+{
+	struct isis_tx_queue *queue = THREAD_ARG(thread);
+	struct isis_tx_queue_entry *e;
+	time_t now = monotime(NULL);
+	unsigned int count = 0;
+
+	isis_tx_batch_start(queue->circuit);
+	while (count++ < TX_QUEUE_BATCH
+	       && (e = tx_queue_list_first(&queue->sent))
+	       && e->retry_time <= now) {
+		queue->circuit->area->lsp_rxmt_count++;
+		tx_queue_send(queue, e, now);
+	}
+	isis_tx_batch_flush(queue->circuit);
+
+	tx_queue_schedule_retry(queue);
+}
+
 void _isis_tx_queue_add(struct isis_tx_queue *queue,
 			struct isis_lsp *lsp,
 			enum isis_tx_type type,
@@ -161,10 +250,10 @@ void _isis_tx_queue_add(struct isis_tx_queue *queue,
 
 	e->type = type;
 
-	THREAD_OFF(e->retry);
-	thread_add_event(master, tx_queue_send_event, e, 0, &e->retry);
-
-	e->is_retry = false;
+	if (e->list != &queue->pending)
+		tx_queue_move(e, &queue->pending);
+	thread_add_event(master, tx_queue_send_pending, queue, 0,
+			 &queue->t_send);
 }
 
 void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
@@ -184,7 +273,7 @@ void _isis_tx_queue_del(struct isis_tx_queue *queue, struct isis_lsp *lsp,
 			   func, file, line);
 	}
 
-	THREAD_OFF(e->retry);
+	tx_queue_list_del(e->list, e);
 
 	hash_release(queue->hash, e);
 	XFREE(MTYPE_TX_QUEUE_ENTRY, e);
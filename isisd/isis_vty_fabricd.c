@@ -186,6 +186,8 @@ DEFUN (show_lsp_flooding,
 
 		vty_out(vty, "Area %s:\n",
 			area->area_tag ? area->area_tag : "null");
+		fabricd_show_flooding_stats(vty, area);
+		vty_out(vty, "\n");
 		if (lspid) {
 			lsp = lsp_for_sysid(head, lspid, isis);
 			if (lsp)
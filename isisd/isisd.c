@@ -517,6 +517,8 @@ void isis_area_destroy(struct isis_area *area)
 
 	lsp_db_fini(&area->lspdb[0]);
 	lsp_db_fini(&area->lspdb[1]);
+	isis_csnp_cache_flush(area, ISIS_LEVEL1);
+	isis_csnp_cache_flush(area, ISIS_LEVEL2);
 
 	/* invalidate and verify to delete all routes from zebra */
 	isis_area_invalidate_routes(area, area->is_type);
@@ -534,6 +536,7 @@ void isis_area_destroy(struct isis_area *area)
 	if (area->spf_timer[1])
 		isis_spf_timer_free(THREAD_ARG(area->spf_timer[1]));
 	THREAD_OFF(area->spf_timer[1]);
+	THREAD_OFF(area->t_lfa_calc);
 
 	spf_backoff_free(area->spf_delay_ietf[0]);
 	spf_backoff_free(area->spf_delay_ietf[1]);
@@ -729,6 +732,7 @@ void isis_terminate(void)
 	struct listnode *node, *nnode;
 
 	bfd_protocol_integration_set_shutdown(true);
+	isis_spf_pool_finish();
 
 	if (listcount(im->isis) == 0)
 		return;
@@ -3086,8 +3090,19 @@ void isis_area_invalidate_routes(struct isis_area *area, int levels)
 
 void isis_area_verify_routes(struct isis_area *area)
 {
+	/*
+	 * Only changed routes are sent, but after SPF in a large domain
+	 * these can still be many routes and Prefix-SID labels, so they go
+	 * out to zebra as one batch of writes.
+	 */
+	if (zclient)
+		zclient_batch_start(zclient);
+
 	for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++)
 		isis_spf_verify_routes(area, area->spftree[tree]);
+
+	if (zclient)
+		zclient_batch_end(zclient);
 }
 
 void isis_area_switchover_routes(struct isis_area *area, int family,
@@ -3115,6 +3130,7 @@ static void area_resign_level(struct isis_area *area, int level)
 	isis_area_verify_routes(area);
 
 	lsp_db_fini(&area->lspdb[level - 1]);
+	isis_csnp_cache_flush(area, level);
 
 	for (int tree = SPFTREE_IPV4; tree < SPFTREE_COUNT; tree++) {
 		if (area->spftree[tree][level - 1]) {
@@ -3127,6 +3143,7 @@ static void area_resign_level(struct isis_area *area, int level)
 		isis_spf_timer_free(THREAD_ARG(area->spf_timer[level - 1]));
 
 	THREAD_OFF(area->spf_timer[level - 1]);
+	area->lfa_pending[level - 1] = false;
 
 	sched_debug(
 		"ISIS (%s): Resigned from L%d - canceling LSP regeneration timer.",
@@ -35,6 +35,7 @@
 #include "isis_flags.h"
 #include "isis_lsp.h"
 #include "isis_lfa.h"
+#include "isis_dynhn.h"
 #include "qobj.h"
 #include "ldp_sync.h"
 
@@ -105,7 +106,7 @@ struct isis {
 	struct thread *t_dync_clean;      /* dynamic hostname cache cleanup thread */
 	uint32_t circuit_ids_used[8];     /* 256 bits to track circuit ids 1 through 255 */
 	int snmp_notifications;
-	struct list *dyn_cache;
+	struct isis_dynhn_db_head dyn_cache; /* sorted by system ID */
 
 	struct route_table *ext_info[REDIST_PROTOCOL_COUNT];
 };
@@ -134,6 +135,9 @@ enum isis_metric_style {
 struct isis_area {
 	struct isis *isis;			       /* back pointer */
 	struct lspdb_head lspdb[ISIS_LEVELS];	       /* link-state dbs */
+	/* encoded CSNPs of each lspdb, shared by all circuits */
+	struct list *csnp_cache[ISIS_LEVELS];
+	size_t csnp_cache_pdu_size[ISIS_LEVELS];
 	struct isis_spftree *spftree[SPFTREE_COUNT][ISIS_LEVELS];
 #define DEFAULT_LSP_MTU 1497
 	unsigned int lsp_mtu;      /* Size of LSPs to generate */
@@ -234,6 +238,11 @@ struct isis_area {
 							    SPF algo
 							    parameters*/
 	struct thread *spf_timer[ISIS_LEVELS];
+	/* SPF scheduled for a topology change, not for prefixes only */
+	bool spf_topo_changed[ISIS_LEVELS];
+	/* (TI-)LFA backup paths, calculated after the SPF run's routes */
+	struct thread *t_lfa_calc;
+	bool lfa_pending[ISIS_LEVELS];
 
 	struct lsp_refresh_arg lsp_refresh_arg[ISIS_LEVELS];
 
@@ -66,6 +66,8 @@ static bool		 lde_fec_connected(const struct fec_node *);
 static bool		 lde_fec_outside_mpls_network(const struct fec_node *);
 static void		 lde_check_filter_af(int, struct ldpd_af_conf *,
 			     const char *);
+static void		 lde_klabel_queue(int, struct kroute *);
+static void		 lde_klabel_flush(void);
 
 RB_GENERATE(nbr_tree, lde_nbr, entry, lde_nbr_compare)
 RB_GENERATE(lde_map_head, lde_map, entry, lde_map_compare)
@@ -100,6 +102,18 @@ static struct listnode *current_label_chunk;
 /* Synchronous zclient to request labels */
 static struct zclient *zclient_sync;
 
+/*
+ * Kernel label changes and deletions are sent to the parent several per
+ * imsg.  Only consecutive updates of the same kind are merged, so their
+ * order is preserved.
+ */
+#define LDE_KLABEL_BATCH \
+	((MAX_IMSGSIZE - IMSG_HEADER_SIZE) / sizeof(struct kroute))
+static struct kroute	 lde_klabel_batch[LDE_KLABEL_BATCH];
+static size_t		 lde_klabel_batch_cnt;
+static int		 lde_klabel_batch_type;
+static struct thread	*lde_klabel_batch_ev;
+
 /* SIGINT / SIGTERM handler. */
 static void
 sigint(void)
@@ -201,6 +215,7 @@ lde_shutdown(void)
 	lde_gc_stop_timer();
 	lde_nbr_clear();
 	fec_tree_clear();
+	THREAD_OFF(lde_klabel_batch_ev);
 
 	config_clear(ldeconf);
 
@@ -220,9 +235,47 @@ lde_imsg_compose_parent(int type, pid_t pid, void *data, uint16_t datalen)
 {
 	if (iev_main->ibuf.fd == -1)
 		return (0);
+	/* keep queued kernel label updates ahead of this message */
+	lde_klabel_flush();
 	return (imsg_compose_event(iev_main, type, 0, pid, -1, data, datalen));
 }
 
+static void
+lde_klabel_flush(void)
+{
+	size_t	 cnt = lde_klabel_batch_cnt;
+
+	if (cnt == 0)
+		return;
+
+	THREAD_OFF(lde_klabel_batch_ev);
+	lde_klabel_batch_cnt = 0;
+	if (iev_main->ibuf.fd == -1)
+		return;
+	imsg_compose_event(iev_main, lde_klabel_batch_type, 0, 0, -1,
+	    lde_klabel_batch, cnt * sizeof(struct kroute));
+}
+
+static void
+lde_klabel_flush_cb(struct thread *thread)
+{
+	lde_klabel_flush();
+}
+
+static void
+lde_klabel_queue(int type, struct kroute *kr)
+{
+	if (lde_klabel_batch_cnt > 0 &&
+	    (type != lde_klabel_batch_type ||
+	    lde_klabel_batch_cnt == LDE_KLABEL_BATCH))
+		lde_klabel_flush();
+
+	lde_klabel_batch_type = type;
+	lde_klabel_batch[lde_klabel_batch_cnt++] = *kr;
+	thread_add_event(master, lde_klabel_flush_cb, NULL, 0,
+	    &lde_klabel_batch_ev);
+}
+
 void
 lde_imsg_compose_parent_sync(int type, pid_t pid, void *data, uint16_t datalen)
 {
@@ -829,8 +882,7 @@ lde_send_change_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		kr.remote_label = fnh->remote_label;
 		kr.route_type = fnh->route_type;
 		kr.route_instance = fnh->route_instance;
-		lde_imsg_compose_parent(IMSG_KLABEL_CHANGE, 0, &kr,
-		    sizeof(kr));
+		lde_klabel_queue(IMSG_KLABEL_CHANGE, &kr);
 		break;
 	case FEC_TYPE_IPV6:
 		memset(&kr, 0, sizeof(kr));
@@ -844,8 +896,7 @@ lde_send_change_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		kr.route_type = fnh->route_type;
 		kr.route_instance = fnh->route_instance;
 
-		lde_imsg_compose_parent(IMSG_KLABEL_CHANGE, 0, &kr,
-		    sizeof(kr));
+		lde_klabel_queue(IMSG_KLABEL_CHANGE, &kr);
 		break;
 	case FEC_TYPE_PWID:
 		pw = (struct l2vpn_pw *) fn->data;
@@ -882,8 +933,7 @@ lde_send_delete_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		kr.route_type = fnh->route_type;
 		kr.route_instance = fnh->route_instance;
 
-		lde_imsg_compose_parent(IMSG_KLABEL_DELETE, 0, &kr,
-		    sizeof(kr));
+		lde_klabel_queue(IMSG_KLABEL_DELETE, &kr);
 		break;
 	case FEC_TYPE_IPV6:
 		memset(&kr, 0, sizeof(kr));
@@ -897,8 +947,7 @@ lde_send_delete_klabel(struct fec_node *fn, struct fec_nh *fnh)
 		kr.route_type = fnh->route_type;
 		kr.route_instance = fnh->route_instance;
 
-		lde_imsg_compose_parent(IMSG_KLABEL_DELETE, 0, &kr,
-		    sizeof(kr));
+		lde_klabel_queue(IMSG_KLABEL_DELETE, &kr);
 		break;
 	case FEC_TYPE_PWID:
 		pw = (struct l2vpn_pw *) fn->data;
@@ -291,6 +291,19 @@ ldp_zebra_send_mpls_labels(int cmd, struct kroute *kr)
 	return 0;
 }
 
+/* Buffer ZAPI messages sent until ldp_zebra_batch_end() */
+void
+ldp_zebra_batch_start(void)
+{
+	zclient_batch_start(zclient);
+}
+
+void
+ldp_zebra_batch_end(void)
+{
+	zclient_batch_end(zclient);
+}
+
 int
 kr_change(struct kroute *kr)
 {
@@ -635,6 +635,8 @@ static void main_dispatch_lde(struct thread *thread)
 	ssize_t		 n;
 	int		 shut = 0;
 	struct zapi_rlfa_response *rlfa_labels;
+	struct kroute	*kr;
+	size_t		 len;
 
 	iev->ev_read = NULL;
 
@@ -643,6 +645,8 @@ static void main_dispatch_lde(struct thread *thread)
 	if (n == 0)	/* connection closed */
 		shut = 1;
 
+	/* send the label updates of this read to zebra in one go */
+	ldp_zebra_batch_start();
 	for (;;) {
 		if ((n = imsg_get(ibuf, &imsg)) == -1)
 			fatal("imsg_get");
@@ -655,18 +659,25 @@ static void main_dispatch_lde(struct thread *thread)
 			logit(imsg.hdr.pid, "%s", (const char *)imsg.data);
 			break;
 		case IMSG_KLABEL_CHANGE:
-			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
-			    sizeof(struct kroute))
+			/* one or more kroutes */
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(struct kroute))
 				fatalx("invalid size of IMSG_KLABEL_CHANGE");
-			if (kr_change(imsg.data))
-				log_warnx("%s: error changing route", __func__);
+			for (kr = imsg.data; len > 0;
+			    kr++, len -= sizeof(struct kroute))
+				if (kr_change(kr))
+					log_warnx("%s: error changing route",
+					    __func__);
 			break;
 		case IMSG_KLABEL_DELETE:
-			if (imsg.hdr.len - IMSG_HEADER_SIZE !=
-			    sizeof(struct kroute))
+			len = imsg.hdr.len - IMSG_HEADER_SIZE;
+			if (len == 0 || len % sizeof(struct kroute))
 				fatalx("invalid size of IMSG_KLABEL_DELETE");
-			if (kr_delete(imsg.data))
-				log_warnx("%s: error deleting route", __func__);
+			for (kr = imsg.data; len > 0;
+			    kr++, len -= sizeof(struct kroute))
+				if (kr_delete(kr))
+					log_warnx("%s: error deleting route",
+					    __func__);
 			break;
 		case IMSG_KPW_ADD:
 		case IMSG_KPW_DELETE:
@@ -717,6 +728,8 @@ static void main_dispatch_lde(struct thread *thread)
 		}
 		imsg_free(&imsg);
 	}
+	ldp_zebra_batch_end();
+
 	if (!shut)
 		imsg_event_add(iev);
 	else {
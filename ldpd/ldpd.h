@@ -761,6 +761,8 @@ void		 pw2zpw(struct l2vpn_pw *, struct zapi_pw *);
 void		 kif_redistribute(const char *);
 int		 kr_change(struct kroute *);
 int		 kr_delete(struct kroute *);
+void		 ldp_zebra_batch_start(void);
+void		 ldp_zebra_batch_end(void);
 int		 kmpw_add(struct zapi_pw *);
 int		 kmpw_del(struct zapi_pw *);
 int		 kmpw_set(struct zapi_pw *);
@@ -0,0 +1,113 @@
+/*
+ * Bounded lock-free pointer queue.
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <zebra.h>
+
+#include "atomring.h"
+#include "memory.h"
+
+DEFINE_MTYPE_STATIC(LIB, ATOMRING, "Lock-free ring");
+
+struct atomring *atomring_new(size_t size)
+{
+	struct atomring *ring;
+	size_t i, n = 2;
+
+	while (n < size)
+		n <<= 1;
+
+	ring = XCALLOC(MTYPE_ATOMRING,
+		       sizeof(*ring) + n * sizeof(ring->slots[0]));
+	ring->mask = n - 1;
+
+	/* slot i is free for the push at position i */
+	for (i = 0; i < n; i++)
+		atomic_store_explicit(&ring->slots[i].seq, i,
+				      memory_order_relaxed);
+
+	return ring;
+}
+
+void atomring_free(struct atomring **ringp)
+{
+	XFREE(MTYPE_ATOMRING, *ringp);
+}
+
+bool atomring_push(struct atomring *ring, void *item)
+{
+	struct atomring_slot *slot;
+	size_t pos, seq;
+	ssize_t diff;
+
+	pos = atomic_load_explicit(&ring->head, memory_order_relaxed);
+	for (;;) {
+		slot = &ring->slots[pos & ring->mask];
+		seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		diff = (ssize_t)(seq - pos);
+
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(
+				    &ring->head, &pos, pos + 1,
+				    memory_order_relaxed, memory_order_relaxed))
+				break;
+			/* pos was reloaded by the failed exchange */
+		} else if (diff < 0) {
+			/* slot still holds the item from the previous lap */
+			return false;
+		} else
+			pos = atomic_load_explicit(&ring->head,
+						   memory_order_relaxed);
+	}
+
+	slot->item = item;
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+	return true;
+}
+
+void *atomring_pop(struct atomring *ring)
+{
+	struct atomring_slot *slot;
+	size_t pos, seq;
+	ssize_t diff;
+	void *item;
+
+	pos = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	for (;;) {
+		slot = &ring->slots[pos & ring->mask];
+		seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+		diff = (ssize_t)(seq - (pos + 1));
+
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(
+				    &ring->tail, &pos, pos + 1,
+				    memory_order_relaxed, memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			/* nothing pushed at this position yet */
+			return NULL;
+		} else
+			pos = atomic_load_explicit(&ring->tail,
+						   memory_order_relaxed);
+	}
+
+	item = slot->item;
+	/* free the slot for the push one lap ahead */
+	atomic_store_explicit(&slot->seq, pos + ring->mask + 1,
+			      memory_order_release);
+	return item;
+}
@@ -0,0 +1,89 @@
+/*
+ * Bounded lock-free pointer queue.
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifndef _FRR_ATOMRING_H
+#define _FRR_ATOMRING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "frratomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed-size FIFO of pointers for handing items between pthreads, without
+ * a mutex.  Any number of pthreads may push and pop concurrently.  Each
+ * slot carries a sequence number telling whether it is free for the push
+ * of the current lap or filled for the pop of the current lap.
+ *
+ * Unlike the atomlist, pushing can fail when the ring is full, which
+ * gives the producer a natural point to apply backpressure.
+ */
+
+#define ATOMRING_CACHELINE 64
+
+struct atomring_slot {
+	atomic_size_t seq;
+	void *item;
+};
+
+struct atomring {
+	/* next position to push to, and to pop from; kept on separate cache
+	 * lines so producers and consumers don't contend on them
+	 */
+	atomic_size_t head;
+	char _pad_head[ATOMRING_CACHELINE - sizeof(atomic_size_t)];
+	atomic_size_t tail;
+	char _pad_tail[ATOMRING_CACHELINE - sizeof(atomic_size_t)];
+
+	size_t mask;
+	struct atomring_slot slots[];
+};
+
+/* size is rounded up to a power of 2 */
+extern struct atomring *atomring_new(size_t size);
+/* the ring must be empty or no longer in use by other pthreads */
+extern void atomring_free(struct atomring **ringp);
+
+/* returns false if the ring is full; item must not be NULL */
+extern bool atomring_push(struct atomring *ring, void *item);
+/* returns NULL if the ring is empty */
+extern void *atomring_pop(struct atomring *ring);
+
+/* only a snapshot while other pthreads are pushing or popping */
+static inline size_t atomring_count(struct atomring *ring)
+{
+	size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+	size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	return head - tail;
+}
+
+static inline size_t atomring_size(const struct atomring *ring)
+{
+	return ring->mask + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_ATOMRING_H */
@@ -9,18 +9,10 @@
 #include <zebra.h>
 #include "checksum.h"
 
-#define add_carry(dst, add)                                                    \
-	do {                                                                   \
-		typeof(dst) _add = (add);                                      \
-		dst += _add;                                                   \
-		if (dst < _add)                                                \
-			dst++;                                                 \
-	} while (0)
-
 uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 {
 	const struct iovec *iov_end;
-	uint32_t sum = 0;
+	uint64_t sum = 0;
 
 	union {
 		uint8_t bytes[2];
@@ -29,9 +21,15 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 	bool have_oddbyte = false;
 
 	/*
-	 * Our algorithm is simple, using a 32-bit accumulator (sum),
-	 * we add sequential 16-bit words to it, and at the end, fold back
-	 * all the carry bits from the top 16 bits into the lower 16 bits.
+	 * Our algorithm is simple, using a 64-bit accumulator (sum),
+	 * we add sequential 32-bit words to it, and at the end, fold back
+	 * all the carry bits from the top bits into the lower 16 bits.
+	 *
+	 * Since one's complement addition is associative, the carries
+	 * don't need to be added back on every step; a 64-bit accumulator
+	 * can't overflow for any buffer shorter than 16 GiB.  The main loop
+	 * uses 4 independent accumulators so there is no dependency chain
+	 * between the additions (and so the compiler can vectorize it.)
 	 */
 
 	for (iov_end = iov + iov_len; iov < iov_end; iov++) {
@@ -46,17 +44,24 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 			have_oddbyte = false;
 			wordbuf.bytes[1] = *ptr++;
 
-			add_carry(sum, wordbuf.word);
+			sum += wordbuf.word;
 		}
 
-		while (ptr + 8 <= end) {
-			add_carry(sum, *(const uint32_t *)(ptr + 0));
-			add_carry(sum, *(const uint32_t *)(ptr + 4));
-			ptr += 8;
+		if (ptr + 16 <= end) {
+			uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+
+			while (ptr + 16 <= end) {
+				s0 += *(const uint32_t *)(ptr + 0);
+				s1 += *(const uint32_t *)(ptr + 4);
+				s2 += *(const uint32_t *)(ptr + 8);
+				s3 += *(const uint32_t *)(ptr + 12);
+				ptr += 16;
+			}
+			sum += s0 + s1 + s2 + s3;
 		}
 
 		while (ptr + 2 <= end) {
-			add_carry(sum, *(const uint16_t *)ptr);
+			sum += *(const uint16_t *)ptr;
 			ptr += 2;
 		}
 
@@ -69,21 +74,83 @@ uint16_t in_cksumv(const struct iovec *iov, size_t iov_len)
 	/* mop up an odd byte, if necessary */
 	if (have_oddbyte) {
 		wordbuf.bytes[1] = 0;
-		add_carry(sum, wordbuf.word);
+		sum += wordbuf.word;
 	}
 
 	/*
-	 * Add back carry outs from top 16 bits to low 16 bits.
+	 * Add back carry outs from top bits to low 16 bits.
 	 */
 
-	sum = (sum >> 16) + (sum & 0xffff); /* add high-16 to low-16 */
-	sum += (sum >> 16);		    /* add carry */
+	sum = (sum >> 32) + (sum & 0xffffffff); /* add high-32 to low-32 */
+	sum = (sum >> 16) + (sum & 0xffff);	/* add high-16 to low-16 */
+	sum = (sum >> 16) + (sum & 0xffff);	/* add carries */
+	sum += (sum >> 16);			/* add last carry */
 	return ~sum;
 }
 
 /* Fletcher Checksum -- Refer to RFC1008. */
 #define MODX                 4102U   /* 5802 should be fine */
 
+/*
+ * The plain byte loop has c1 depending on c0 on every byte, so it runs at
+ * one byte per (add) latency at best.  Instead, the bulk of the buffer is
+ * cut into FLETCHER_LANES-byte strides and each byte position within a
+ * stride gets its own pair of counters:
+ *
+ *   a[k] = sum of all bytes at position k of the strides seen so far
+ *   b[k] = sum of a[k] before each stride (i.e. prefix sums of a[k])
+ *
+ * Over n strides, the bytes contribute FLETCHER_LANES * sum(b[k]) +
+ * sum((FLETCHER_LANES - k) * a[k]) to c1 and sum(a[k]) to c0, on top of
+ * the n * FLETCHER_LANES * c0 that c0 itself adds.  The lanes are
+ * independent, which is what the compiler needs to vectorize the loop.
+ *
+ * b[k] grows with n^2 * 255 / 2, so FLETCHER_BLOCK strides is the most that
+ * can be done before reducing without overflowing the 32-bit lanes.
+ */
+#define FLETCHER_LANES 16
+#define FLETCHER_BLOCK 4096
+
+static void fletcher_blocks(uint8_t **pp, size_t *leftp, int *c0p, int *c1p)
+{
+	const uint8_t *p = *pp;
+	size_t left = *leftp;
+	uint64_t c0 = *c0p, c1 = *c1p;
+
+	while (left >= FLETCHER_LANES) {
+		uint32_t a[FLETCHER_LANES] = {}, b[FLETCHER_LANES] = {};
+		size_t n = MIN(left / FLETCHER_LANES, FLETCHER_BLOCK), i;
+		uint64_t sa = 0, sb = 0, sw = 0;
+		unsigned int k;
+
+		for (i = 0; i < n; i++) {
+			for (k = 0; k < FLETCHER_LANES; k++) {
+				b[k] += a[k];
+				a[k] += p[k];
+			}
+			p += FLETCHER_LANES;
+		}
+
+		for (k = 0; k < FLETCHER_LANES; k++) {
+			sa += a[k];
+			sb += b[k];
+			sw += (uint64_t)(FLETCHER_LANES - k) * a[k];
+		}
+
+		c1 += FLETCHER_LANES * (n * c0 + sb) + sw;
+		c0 += sa;
+		c0 %= 255;
+		c1 %= 255;
+
+		left -= n * FLETCHER_LANES;
+	}
+
+	*pp = (uint8_t *)p;
+	*leftp = left;
+	*c0p = c0;
+	*c1p = c1;
+}
+
 /* To be consistent, offset is 0-based index, rather than the 1-based
    index required in the specification ISO 8473, Annex C.1 */
 /* calling with offset == FLETCHER_CHECKSUM_VALIDATE will validate the checksum
@@ -110,6 +177,8 @@ uint16_t fletcher_checksum(uint8_t *buffer, const size_t len,
 	c0 = 0;
 	c1 = 0;
 
+	fletcher_blocks(&p, &left, &c0, &c1);
+
 	while (left != 0) {
 		partial_len = MIN(left, MODX);
 
@@ -48,7 +48,10 @@
 #include "lib_errors.h"
 #include "northbound_cli.h"
 #include "network.h"
+#include "mempressure.h"
+#include "memtrack.h"
 #include "routemap.h"
+#include "sigprof.h"
 
 #include "frrscript.h"
 
@@ -483,6 +486,7 @@ static int config_write_host(struct vty *vty)
 					host.enable);
 		}
 		log_config_write(vty);
+		mempressure_config_write(vty);
 
 		/* print disable always, but enable only if default is flipped
 		 * => prep for future removal of compile-time knob
@@ -493,6 +497,9 @@ static int config_write_host(struct vty *vty)
 		else
 			vty_out(vty, "service cputime-stats\n");
 #endif
+		if (cputime_sample > 1)
+			vty_out(vty, "service cputime-stats sample %u\n",
+				cputime_sample);
 
 		if (!cputime_threshold)
 			vty_out(vty, "no service cputime-warning\n");
@@ -1060,7 +1067,8 @@ int cmd_execute_command(vector vline, struct vty *vty,
 
 	if (ret != CMD_SUCCESS && ret != CMD_WARNING
 	    && ret != CMD_ERR_AMBIGUOUS && ret != CMD_ERR_INCOMPLETE
-	    && ret != CMD_NOT_MY_INSTANCE && ret != CMD_WARNING_CONFIG_FAILED) {
+	    && ret != CMD_NOT_MY_INSTANCE && ret != CMD_WARNING_CONFIG_FAILED
+	    && ret != CMD_SUSPEND) {
 		/* This assumes all nodes above CONFIG_NODE are childs of
 		 * CONFIG_NODE */
 		while (vty->node > CONFIG_NODE) {
@@ -1076,7 +1084,8 @@ int cmd_execute_command(vector vline, struct vty *vty,
 			if (ret == CMD_SUCCESS || ret == CMD_WARNING
 			    || ret == CMD_ERR_AMBIGUOUS || ret == CMD_ERR_INCOMPLETE
 			    || ret == CMD_NOT_MY_INSTANCE
-			    || ret == CMD_WARNING_CONFIG_FAILED)
+			    || ret == CMD_WARNING_CONFIG_FAILED
+			    || ret == CMD_SUSPEND)
 				return ret;
 		}
 		/* no command succeeded, reset the vty to the original node */
@@ -2553,6 +2562,9 @@ void cmd_init(int terminal)
 		thread_cmd_init();
 		workqueue_cmd_init();
 		hash_cmd_init();
+		sigprof_cmd_init();
+		memtrack_cmd_init();
+		mempressure_cmd_init();
 	}
 
 	install_element(CONFIG_NODE, &hostname_cmd);
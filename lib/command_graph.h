@@ -38,6 +38,7 @@ extern "C" {
 #endif
 
 DECLARE_MTYPE(CMD_ARG);
+DECLARE_MTYPE(CMD_MATCH_CACHE);
 
 struct vty;
 
@@ -103,6 +104,9 @@ struct cmd_token {
 	char *varname;
 
 	struct graph_node *forkjoin; // paired FORK/JOIN for JOIN/FORK
+
+	// matcher cache of the follow set, [1] for "no" commands
+	struct cmd_nexthops *nexthops[2];
 };
 
 /* Structure of command element. */
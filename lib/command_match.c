@@ -40,12 +40,48 @@ DEFINE_MTYPE_STATIC(LIB, CMD_MATCHSTACK, "Command Match Stack");
 			fprintf(stderr, __VA_ARGS__);                          \
 	} while (0);
 
+/*
+ * Compiled follow set of a graph node: every node add_nexthops() would return
+ * for it, keywords first and sorted by text so that the ones an input token
+ * can match are found with a binary search, then all the other tokens.
+ * Cached in the node's cmd_token until the graph changes.
+ */
+struct cmd_nexthop {
+	struct graph_node *node;
+	unsigned int order; // position in add_nexthops() output
+};
+
+struct cmd_nexthops {
+	uint32_t generation;
+	unsigned int nwords, nothers;
+	struct cmd_nexthop hops[];
+};
+
+/* token types whose match only depends on the input, see match_shape() */
+enum match_shape {
+	SHAPE_IPV4,
+	SHAPE_IPV4_PREFIX,
+	SHAPE_IPV6,
+	SHAPE_IPV6_PREFIX,
+	SHAPE_MAC,
+	SHAPE_MAC_PREFIX,
+	SHAPE_MAX,
+};
+
+/* per command_match() call state */
+struct match_state {
+	struct graph_node *stack[CMD_ARGC_MAX];
+
+	/* match_token() results + 1 by input token and shape, 0 if unknown */
+	uint8_t shapes[CMD_ARGC_MAX][SHAPE_MAX];
+};
+
 /* matcher helper prototypes */
 static int add_nexthops(struct list *, struct graph_node *,
 			struct graph_node **, size_t, bool);
 
 static enum matcher_rv command_match_r(struct graph_node *, vector,
-				       unsigned int, struct graph_node **,
+				       unsigned int, struct match_state *,
 				       struct list **);
 
 static int score_precedence(enum cmd_token_type);
@@ -89,7 +125,7 @@ static bool is_neg(vector vline, size_t idx)
 enum matcher_rv command_match(struct graph *cmdgraph, vector vline,
 			      struct list **argv, const struct cmd_element **el)
 {
-	struct graph_node *stack[CMD_ARGC_MAX];
+	struct match_state state;
 	enum matcher_rv status;
 	*argv = NULL;
 
@@ -100,8 +136,10 @@ enum matcher_rv command_match(struct graph *cmdgraph, vector vline,
 	       sizeof(void *) * vline->alloced);
 	vvline->active = vline->active + 1;
 
+	memset(state.shapes, 0, sizeof(state.shapes));
+
 	struct graph_node *start = vector_slot(cmdgraph->nodes, 0);
-	status = command_match_r(start, vvline, 0, stack, argv);
+	status = command_match_r(start, vvline, 0, &state, argv);
 	if (status == MATCHER_OK) { // successful match
 		struct listnode *head = listhead(*argv);
 		struct listnode *tail = listtail(*argv);
@@ -141,6 +179,182 @@ enum matcher_rv command_match(struct graph *cmdgraph, vector vline,
 	return status;
 }
 
+static int cmd_nexthop_cmp_text(const void *a, const void *b)
+{
+	const struct cmd_nexthop *ha = a, *hb = b;
+	const struct cmd_token *ta = ha->node->data, *tb = hb->node->data;
+
+	return strcmp(ta->text, tb->text);
+}
+
+static int cmd_nexthop_cmp_order(const void *a, const void *b)
+{
+	const struct cmd_nexthop *ha = a, *hb = b;
+
+	return numcmp(ha->order, hb->order);
+}
+
+/* Get the (cached) compiled follow set of a node. */
+static const struct cmd_nexthops *cmd_nexthops_get(struct graph_node *node,
+						   bool neg)
+{
+	struct cmd_token *token = node->data;
+	struct cmd_nexthops *nh = token->nexthops[neg];
+	struct listnode *ln;
+	struct graph_node *gn;
+	unsigned int order = 0, nwords = 0, w, o;
+	struct list *next;
+
+	if (nh && nh->generation == graph_generation)
+		return nh;
+
+	next = list_new();
+	add_nexthops(next, node, NULL, 0, neg);
+
+	for (ALL_LIST_ELEMENTS_RO(next, ln, gn))
+		if (((struct cmd_token *)gn->data)->type == WORD_TKN)
+			nwords++;
+
+	XFREE(MTYPE_CMD_MATCH_CACHE, token->nexthops[neg]);
+	nh = XCALLOC(MTYPE_CMD_MATCH_CACHE,
+		     sizeof(*nh) + listcount(next) * sizeof(nh->hops[0]));
+	nh->generation = graph_generation;
+	nh->nwords = nwords;
+	nh->nothers = listcount(next) - nwords;
+
+	w = 0;
+	o = nwords;
+	for (ALL_LIST_ELEMENTS_RO(next, ln, gn)) {
+		struct cmd_nexthop *hop;
+
+		if (((struct cmd_token *)gn->data)->type == WORD_TKN)
+			hop = &nh->hops[w++];
+		else
+			hop = &nh->hops[o++];
+		hop->node = gn;
+		hop->order = order++;
+	}
+	qsort(nh->hops, nwords, sizeof(nh->hops[0]), cmd_nexthop_cmp_text);
+
+	list_delete(&next);
+
+	token->nexthops[neg] = nh;
+	return nh;
+}
+
+/*
+ * Collect the nexthops of a node worth trying against input token n, in the
+ * order add_nexthops() returns them. At the end of the input only END_TKN can
+ * match; otherwise keywords that don't start with the input are skipped.
+ *
+ * @param[in,out] cands buffer of "size" entries; replaced by an allocated one
+ * (MTYPE_CMD_MATCHSTACK) if too small
+ * @return the number of candidates
+ */
+static size_t match_candidates(struct graph_node *node, vector vline,
+			       unsigned int n, struct graph_node ***cands,
+			       size_t size)
+{
+	const struct cmd_nexthops *nh =
+		cmd_nexthops_get(node, is_neg(vline, 1));
+	const struct cmd_nexthop *words = nh->hops, *first, *last;
+	const struct cmd_nexthop *others = nh->hops + nh->nwords;
+	struct cmd_nexthop buf[32], *sel = buf;
+	bool at_end = (n == vector_active(vline));
+	const char *input = at_end ? NULL : vector_slot(vline, n);
+	size_t count = 0;
+
+	first = last = words;
+	if (input) {
+		size_t len = strlen(input);
+		size_t lo = 0, hi = nh->nwords;
+
+		// lower bound of the keywords starting with the input
+		while (lo < hi) {
+			size_t mid = (lo + hi) / 2;
+			const struct cmd_token *tok = words[mid].node->data;
+
+			if (strcmp(tok->text, input) < 0)
+				lo = mid + 1;
+			else
+				hi = mid;
+		}
+		first = last = words + lo;
+		while (last < words + nh->nwords
+		       && !strncmp(((struct cmd_token *)last->node->data)->text,
+				   input, len))
+			last++;
+	}
+
+	if ((size_t)(last - first) + nh->nothers > array_size(buf))
+		sel = XMALLOC(MTYPE_CMD_MATCHSTACK,
+			      ((last - first) + nh->nothers) * sizeof(*sel));
+
+	for (; first < last; first++)
+		sel[count++] = *first;
+	for (unsigned int i = 0; i < nh->nothers; i++) {
+		const struct cmd_token *tok = others[i].node->data;
+
+		// END_TKN only matters at the end of the input, and only then
+		if (at_end != (tok->type == END_TKN))
+			continue;
+		sel[count++] = others[i];
+	}
+	qsort(sel, count, sizeof(sel[0]), cmd_nexthop_cmp_order);
+
+	if (count > size)
+		*cands = XMALLOC(MTYPE_CMD_MATCHSTACK, count * sizeof(**cands));
+	for (size_t i = 0; i < count; i++)
+		(*cands)[i] = sel[i].node;
+
+	if (sel != buf)
+		XFREE(MTYPE_CMD_MATCHSTACK, sel);
+
+	return count;
+}
+
+/* Map the token types whose match only depends on the input to a shape. */
+static int match_shape(enum cmd_token_type type)
+{
+	switch (type) {
+	case IPV4_TKN:
+		return SHAPE_IPV4;
+	case IPV4_PREFIX_TKN:
+		return SHAPE_IPV4_PREFIX;
+	case IPV6_TKN:
+		return SHAPE_IPV6;
+	case IPV6_PREFIX_TKN:
+		return SHAPE_IPV6_PREFIX;
+	case MAC_TKN:
+		return SHAPE_MAC;
+	case MAC_PREFIX_TKN:
+		return SHAPE_MAC_PREFIX;
+	default:
+		return -1;
+	}
+}
+
+/*
+ * match_token() against input token n, remembering the result for the token
+ * types that don't depend on the token itself: the same input is typically
+ * checked against many A.B.C.D, X:X::X:X, ... tokens of different commands.
+ */
+static enum match_type match_token_state(struct match_state *state,
+					 struct cmd_token *token, vector vline,
+					 unsigned int n)
+{
+	char *input_token = vector_slot(vline, n);
+	int shape = match_shape(token->type);
+
+	if (shape < 0)
+		return match_token(token, input_token);
+
+	if (!state->shapes[n][shape])
+		state->shapes[n][shape] = match_token(token, input_token) + 1;
+
+	return state->shapes[n][shape] - 1;
+}
+
 /**
  * Builds an argument list given a DFA and a matching input line.
  *
@@ -184,6 +398,7 @@ enum matcher_rv command_match(struct graph *cmdgraph, vector vline,
  * @param[in] start the start node.
  * @param[in] vline the vectorized input line.
  * @param[in] n the index of the first input token.
+ * @param[in] state matcher state of this command_match() call.
  * @return A linked list of n elements. The first n-1 elements are pointers to
  * struct cmd_token and represent the sequence of tokens matched by the input.
  * The ->arg field of each token points to a copy of the input matched on it.
@@ -194,7 +409,7 @@ enum matcher_rv command_match(struct graph *cmdgraph, vector vline,
  */
 static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 				       unsigned int n,
-				       struct graph_node **stack,
+				       struct match_state *state,
 				       struct list **currbest)
 {
 	assert(n < vector_active(vline));
@@ -212,7 +427,7 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 		return MATCHER_NO_MATCH;
 	if (!token->allowrepeat)
 		for (size_t s = 0; s < n; s++)
-			if (stack[s] == start)
+			if (state->stack[s] == start)
 				return MATCHER_NO_MATCH;
 
 	// get the current operating input token
@@ -244,21 +459,20 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 #endif
 
 	// if we don't match this node, die
-	if (match_token(token, input_token) < minmatch)
+	if (match_token_state(state, token, vline, n) < minmatch)
 		return MATCHER_NO_MATCH;
 
-	stack[n] = start;
+	state->stack[n] = start;
 
-	// pointers for iterating linklist
-	struct listnode *ln;
-	struct graph_node *gn;
-
-	// get all possible nexthops
-	struct list *next = list_new();
-	add_nexthops(next, start, NULL, 0, is_neg(vline, 1));
+	// get all possible nexthops that can match the next input token
+	struct graph_node *candbuf[32], **cands = candbuf, *gn;
+	size_t ncands = match_candidates(start, vline, n + 1, &cands,
+					 array_size(candbuf));
 
 	// determine the best match
-	for (ALL_LIST_ELEMENTS_RO(next, ln, gn)) {
+	for (size_t c = 0; c < ncands; c++) {
+		gn = cands[c];
+
 		// if we've matched all input we're looking for END_TKN
 		if (n + 1 == vector_active(vline)) {
 			struct cmd_token *tok = gn->data;
@@ -294,7 +508,7 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 		// else recurse on candidate child node
 		struct list *result = NULL;
 		enum matcher_rv rstat =
-			command_match_r(gn, vline, n + 1, stack, &result);
+			command_match_r(gn, vline, n + 1, state, &result);
 
 		// save the best match
 		if (result && *currbest) {
@@ -341,7 +555,8 @@ static enum matcher_rv command_match_r(struct graph_node *start, vector vline,
 		status = MATCHER_INCOMPLETE;
 
 	// cleanup
-	list_delete(&next);
+	if (cands != candbuf)
+		XFREE(MTYPE_CMD_MATCHSTACK, cands);
 
 	return status;
 }
@@ -39,6 +39,9 @@
 /* Link State Memory allocation */
 DEFINE_MTYPE_STATIC(LIB, PCA, "Path Computation Algorithms");
 
+/* Constrained Paths are allocated by chunks of this many in CSPF structure */
+#define CSPF_CHUNK_SIZE 256
+
 /**
  * Create new Constrained Path. Memory is dynamically allocated.
  *
@@ -63,6 +66,40 @@ static struct c_path *cpath_new(uint64_t key)
 	return path;
 }
 
+/**
+ * Get a Constrained Path for the on-going computation from the chunks of the
+ * CSPF structure. They are all released at once by cspf_clean().
+ *
+ * @param algo		CSPF structure
+ * @param key		Vertex key of the destination of this path
+ * @param vertex	Destination Vertex of this path
+ *
+ * @return		Pointer to the initialized Constrained Path structure
+ */
+static struct c_path *cpath_get(struct cspf *algo, uint64_t key,
+				const struct ls_vertex *vertex)
+{
+	uint32_t chunk = algo->used / CSPF_CHUNK_SIZE;
+	struct c_path *path;
+
+	if (chunk == algo->nchunks) {
+		algo->chunks = XREALLOC(MTYPE_PCA, algo->chunks,
+					(algo->nchunks + 1) *
+						sizeof(algo->chunks[0]));
+		algo->chunks[algo->nchunks++] = XCALLOC(
+			MTYPE_PCA, CSPF_CHUNK_SIZE * sizeof(struct c_path));
+	}
+
+	path = &algo->chunks[chunk][algo->used++ % CSPF_CHUNK_SIZE];
+	memset(path, 0, sizeof(*path));
+	path->dst = key;
+	path->vertex = vertex;
+	path->status = IN_PROGRESS;
+	path->weight = MAX_COST;
+
+	return path;
+}
+
 /**
  * Copy src Constrained Path into dst Constrained Path. A new Constrained Path
  * structure is dynamically allocated if dst is NULL. If src is NULL, the
@@ -114,55 +151,22 @@ static void cpath_del(struct c_path *path)
 }
 
 /**
- * Replace the list of edges in the next Constrained Path by the list of edges
- * in the current Constrained Path.
+ * Fill the list of edges of the dest Constrained Path by following the
+ * previous hops of the computed src Constrained Path back to the source.
  *
- * @param next_path	next Constrained Path structure
- * @param cur_path	current Constrained Path structure
+ * @param dest	Destination Constrained Path, with a list of edges
+ * @param src	Computed Constrained Path structure
  */
-static void cpath_replace(struct c_path *next_path, struct c_path *cur_path)
+static void cpath_build(struct c_path *dest, const struct c_path *src)
 {
+	const struct c_path *hop;
 
-	if (next_path->edges)
-		list_delete(&next_path->edges);
+	list_delete_all_node(dest->edges);
+	for (hop = src; hop->prev; hop = hop->prev)
+		listnode_add_head(dest->edges, hop->edge);
 
-	next_path->edges = list_dup(cur_path->edges);
-}
-
-/**
- * Create a new Visited Node structure from the provided Vertex. Structure is
- * dynamically allocated.
- *
- * @param vertex	Vertex structure
- *
- * @return		Pointer to the new Visited Node structure
- */
-static struct v_node *vnode_new(struct ls_vertex *vertex)
-{
-	struct v_node *vnode;
-
-	if (!vertex)
-		return NULL;
-
-	vnode = XCALLOC(MTYPE_PCA, sizeof(struct v_node));
-	vnode->vertex = vertex;
-	vnode->key = vertex->key;
-
-	return vnode;
-}
-
-/**
- * Delete Visited Node structure. Previous allocated memory is freed.
- *
- * @param vnode		Visited Node structure to be deleted
- */
-static void vnode_del(struct v_node *vnode)
-{
-	if (!vnode)
-		return;
-
-	XFREE(MTYPE_PCA, vnode);
-	vnode = NULL;
+	dest->dst = src->dst;
+	dest->weight = src->weight;
 }
 
 /**
@@ -232,10 +236,10 @@ struct cspf *cspf_new(void)
 	/* Allocate New CSPF structure */
 	algo = XCALLOC(MTYPE_PCA, sizeof(struct cspf));
 
-	/* Initialize RB-Trees */
+	/* Initialize Priority Queue, Processed Path and Cache */
 	processed_init(&algo->processed);
-	visited_init(&algo->visited);
 	pqueue_init(&algo->pqueue);
+	cspf_cache_init(&algo->cache);
 
 	algo->path = NULL;
 	algo->pdst = NULL;
@@ -259,14 +263,14 @@ struct cspf *cspf_init(struct cspf *algo, const struct ls_vertex *src,
 
 	/* Initialize Processed Path and Priority Queue with Src & Dst */
 	if (src) {
-		psrc = cpath_new(src->key);
+		psrc = cpath_get(new_algo, src->key, src);
 		psrc->weight = 0;
 		processed_add(&new_algo->processed, psrc);
 		pqueue_add(&new_algo->pqueue, psrc);
 		new_algo->path = psrc;
 	}
 	if (dst) {
-		new_algo->pdst = cpath_new(dst->key);
+		new_algo->pdst = cpath_get(new_algo, dst->key, dst);
 		processed_add(&new_algo->processed, new_algo->pdst);
 	}
 
@@ -327,186 +331,179 @@ struct cspf *cspf_init_v6(struct cspf *algo, struct ls_ted *ted,
 
 void cspf_clean(struct cspf *algo)
 {
-	struct c_path *path;
-	struct v_node *vnode;
-
 	if (!algo)
 		return;
 
 	/* Normally, Priority Queue is empty. Clean it in case of. */
-	if (pqueue_count(&algo->pqueue)) {
-		frr_each_safe (pqueue, &algo->pqueue, path) {
-			pqueue_del(&algo->pqueue, path);
-		}
-	}
+	while (pqueue_pop(&algo->pqueue))
+		;
 
-	/* Empty Processed Path tree and associated Path */
-	if (processed_count(&algo->processed)) {
-		frr_each_safe (processed, &algo->processed, path) {
-			processed_del(&algo->processed, path);
-			cpath_del(path);
-		}
-	}
-
-	/* Empty visited Vertex tree and associated Node */
-	if (visited_count(&algo->visited)) {
-		frr_each_safe (visited, &algo->visited, vnode) {
-			visited_del(&algo->visited, vnode);
-			vnode_del(vnode);
-		}
-	}
+	/* Empty Processed Path hash, Paths go back to the chunks */
+	while (processed_pop(&algo->processed))
+		;
+	algo->used = 0;
 
 	memset(&algo->csts, 0, sizeof(struct constraints));
 	algo->path = NULL;
 	algo->pdst = NULL;
 }
 
+/**
+ * Remove all results from the cache of the CSPF structure.
+ *
+ * @param algo	CSPF structure
+ */
+static void cspf_cache_flush(struct cspf *algo)
+{
+	struct cspf_cached *cached;
+
+	while ((cached = cspf_cache_pop(&algo->cache))) {
+		cpath_del(cached->path);
+		XFREE(MTYPE_PCA, cached);
+	}
+}
+
+void cspf_cache_set(struct cspf *algo, uint32_t max_entries)
+{
+	if (!algo)
+		return;
+
+	algo->cache_max = max_entries;
+	if (!max_entries)
+		cspf_cache_flush(algo);
+}
+
 void cspf_del(struct cspf *algo)
 {
+	uint32_t i;
+
 	if (!algo)
 		return;
 
-	/* Empty Priority Queue and Processes Path */
+	/* Empty Priority Queue, Processed Path and Cache */
 	cspf_clean(algo);
+	cspf_cache_flush(algo);
 
-	/* Then, reset Priority Queue, Processed Path and Visited RB-Tree */
+	/* Then, reset Priority Queue, Processed Path and Cache */
 	pqueue_fini(&algo->pqueue);
 	processed_fini(&algo->processed);
-	visited_fini(&algo->visited);
+	cspf_cache_fini(&algo->cache);
+
+	for (i = 0; i < algo->nchunks; i++)
+		XFREE(MTYPE_PCA, algo->chunks[i]);
+	XFREE(MTYPE_PCA, algo->chunks);
 
 	XFREE(MTYPE_PCA, algo);
 	algo = NULL;
 }
 
 /**
- * Prune Edge if constraints are not met by testing Edge Attributes against
- * given constraints and cumulative cost of the given constrained path.
+ * Prune Link if constraints are not met by testing the Link of the TED graph
+ * against given constraints and cumulative cost of the given constrained path.
  *
  * @param path	On-going Computed Path with cumulative cost constraints
- * @param edge	Edge to be validate against Constraints
+ * @param link	Link to be validate against Constraints
  * @param csts	Constraints for this path
  *
- * @return	True if Edge should be prune, false if Edge is valid
+ * @return	True if Link should be prune, false if Link is valid
  */
-static bool prune_edge(const struct c_path *path, const struct ls_edge *edge,
+static bool prune_link(const struct c_path *path,
+		       const struct ls_graph_link *link,
 		       const struct constraints *csts)
 {
-	struct ls_vertex *dst;
-	struct ls_attributes *attr;
-
-	/* Check that Path, Edge and Constraints are valid */
-	if (!path || !edge || !csts)
-		return true;
-
-	/* Check that Edge has a valid destination */
-	if (!edge->destination)
-		return true;
-	dst = edge->destination;
-
-	/* Check that Edge has valid attributes */
-	if (!edge->attributes)
-		return true;
-	attr = edge->attributes;
-
-	/* Check that Edge belongs to the requested Address Family and type */
+	/* Check that Link belongs to the requested Address Family and type */
 	if (csts->family == AF_INET) {
-		if (IPV4_NET0(attr->standard.local.s_addr))
+		if (!CHECK_FLAG(link->flags, LS_GRAPH_IPV4))
 			return true;
 		if (csts->type == SR_TE)
-			if (!CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID) ||
-			    !CHECK_FLAG(dst->node->flags, LS_NODE_SR))
+			if (!CHECK_FLAG(link->flags, LS_GRAPH_ADJ_SID) ||
+			    !CHECK_FLAG(link->flags, LS_GRAPH_DST_SR))
 				return true;
 	}
 	if (csts->family == AF_INET6) {
-		if (IN6_IS_ADDR_UNSPECIFIED(&attr->standard.local6))
+		if (!CHECK_FLAG(link->flags, LS_GRAPH_IPV6))
 			return true;
 		if (csts->type == SR_TE)
-			if (!CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID6) ||
-			    !CHECK_FLAG(dst->node->flags, LS_NODE_SR))
+			if (!CHECK_FLAG(link->flags, LS_GRAPH_ADJ_SID6) ||
+			    !CHECK_FLAG(link->flags, LS_GRAPH_DST_SR))
 				return true;
 	}
 
 	/*
-	 * Check that total cost, up to this edge, respects the initial
+	 * Check that total cost, up to this link, respects the initial
 	 * constraints
 	 */
 	switch (csts->ctype) {
 	case CSPF_METRIC:
-		if (!CHECK_FLAG(attr->flags, LS_ATTR_METRIC))
+		if (!CHECK_FLAG(link->flags, LS_GRAPH_METRIC))
 			return true;
-		if ((attr->metric + path->weight) > csts->cost)
+		if ((link->metric + path->weight) > csts->cost)
 			return true;
 		break;
 
 	case CSPF_TE_METRIC:
-		if (!CHECK_FLAG(attr->flags, LS_ATTR_TE_METRIC))
+		if (!CHECK_FLAG(link->flags, LS_GRAPH_TE_METRIC))
 			return true;
-		if ((attr->standard.te_metric + path->weight) > csts->cost)
+		if ((link->te_metric + path->weight) > csts->cost)
 			return true;
 		break;
 
 	case CSPF_DELAY:
-		if (!CHECK_FLAG(attr->flags, LS_ATTR_DELAY))
+		if (!CHECK_FLAG(link->flags, LS_GRAPH_DELAY))
 			return true;
-		if ((attr->extended.delay + path->weight) > csts->cost)
+		if ((link->delay + path->weight) > csts->cost)
 			return true;
 		break;
 	}
 
-	/* If specified, check that Edge meet Bandwidth constraint */
-	if (csts->bw > 0.0) {
-		if (attr->standard.max_bw < csts->bw ||
-		    attr->standard.max_rsv_bw < csts->bw ||
-		    attr->standard.unrsv_bw[csts->cos] < csts->bw)
-			return true;
-	}
+	/* If specified, check that Link meet Bandwidth constraint */
+	if (csts->bw > 0.0 && link->bw[csts->cos] < csts->bw)
+		return true;
 
-	/* All is fine. We can consider this Edge valid, so not to be prune */
+	/* All is fine. We can consider this Link valid, so not to be prune */
 	return false;
 }
 
 /**
  * Relax constraints of the current path up to the destination vertex of the
- * provided Edge. This function progress in the network topology by validating
- * the next vertex on the computed path. If Vertex has not already been visited,
- * list of edges of the current path is augmented with this edge if the new cost
- * is lower than prior path up to this vertex. Current path is re-inserted in
- * the Priority Queue with its new cost i.e. current cost + edge cost.
+ * provided Link. This function progress in the network topology by validating
+ * the next vertex on the computed path. If the shortest path to this Vertex is
+ * not already known, the path up to it is replaced by the current path plus
+ * this link if the new cost is lower than prior path up to this vertex. The
+ * path is then (re-)inserted in the Priority Queue with its new cost i.e.
+ * current cost + link cost.
  *
  * @param algo	CSPF structure
- * @param edge	Next Edge to be added to the current computed path
- *
- * @return	True if current path reach destination, false otherwise
+ * @param graph	TED graph
+ * @param link	Next Link to be added to the current computed path
  */
-static bool relax_constraints(struct cspf *algo, struct ls_edge *edge)
+static void relax_constraints(struct cspf *algo, const struct ls_graph *graph,
+			      const struct ls_graph_link *link)
 {
-
 	struct c_path pkey = {};
 	struct c_path *next_path;
-	struct v_node vnode = {};
+	const struct ls_vertex *next = graph->vertices[link->dst];
 	uint32_t total_cost = MAX_COST;
 
 	/* Verify that we have a current computed path */
 	if (!algo->path)
-		return false;
-
-	/* Verify if we have not visited the next Vertex to avoid loop */
-	vnode.key = edge->destination->key;
-	if (visited_member(&algo->visited, &vnode)) {
-		return false;
-	}
+		return;
 
 	/*
 	 * Get Next Computed Path from next vertex key
 	 * or create a new one if it has not yet computed.
 	 */
-	pkey.dst = edge->destination->key;
+	pkey.dst = next->key;
 	next_path = processed_find(&algo->processed, &pkey);
 	if (!next_path) {
-		next_path = cpath_new(pkey.dst);
+		next_path = cpath_get(algo, pkey.dst, next);
 		processed_add(&algo->processed, next_path);
 	}
 
+	/* Shortest path to the next Vertex is already known, avoid loop */
+	if (next_path->visited)
+		return;
+
 	/*
 	 * Add or update the Computed Path in the Priority Queue if total cost
 	 * is lower than cost associated to this next Vertex. This could occurs
@@ -515,53 +512,39 @@ static bool relax_constraints(struct cspf *algo, struct ls_edge *edge)
 	 */
 	switch (algo->csts.ctype) {
 	case CSPF_METRIC:
-		total_cost = edge->attributes->metric + algo->path->weight;
+		total_cost = link->metric + algo->path->weight;
 		break;
 	case CSPF_TE_METRIC:
-		total_cost = edge->attributes->standard.te_metric +
-			     algo->path->weight;
+		total_cost = link->te_metric + algo->path->weight;
 		break;
 	case CSPF_DELAY:
-		total_cost =
-			edge->attributes->extended.delay + algo->path->weight;
+		total_cost = link->delay + algo->path->weight;
 		break;
 	default:
 		break;
 	}
 	if (total_cost < next_path->weight) {
 		/*
-		 * It is not possible to directly update the q_path in the
-		 * Priority Queue. Indeed, if we modify the path weight, the
-		 * Priority Queue must be re-ordered. So, we need fist to remove
-		 * the q_path if it is present in the Priority Queue, then,
-		 * update the Path, in particular the Weight, and finally
-		 * (re-)insert it in the Priority Queue.
+		 * The Priority Queue must be re-ordered if we modify the path
+		 * weight. So, remove the path if it is already queued, i.e.
+		 * if it has got a weight, update it and (re-)insert it.
 		 */
-		struct c_path *path;
-		frr_each_safe (pqueue, &algo->pqueue, path) {
-			if (path->dst == pkey.dst) {
-				pqueue_del(&algo->pqueue, path);
-				break;
-			}
-		}
+		if (next_path->weight != MAX_COST)
+			pqueue_del(&algo->pqueue, next_path);
 		next_path->weight = total_cost;
-		cpath_replace(next_path, algo->path);
-		listnode_add(next_path->edges, edge);
+		next_path->prev = algo->path;
+		next_path->edge = link->edge;
 		pqueue_add(&algo->pqueue, next_path);
 	}
-
-	/* Return True if we reach the destination */
-	return (next_path->dst == algo->pdst->dst);
 }
 
 struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted)
 {
-	struct listnode *node;
-	struct ls_vertex *vertex;
-	struct ls_edge *edge;
+	const struct ls_graph *graph;
+	const struct ls_graph_link *link, *end;
+	const struct ls_vertex *vertex;
 	struct c_path *optim_path;
-	struct v_node *vnode;
-	uint32_t cur_cost;
+	struct cspf_cached key = {}, *cached = NULL;
 
 	optim_path = cpath_new(0xFFFFFFFFFFFFFFFF);
 	optim_path->status = FAILED;
@@ -575,72 +558,112 @@ struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted)
 
 	if (!algo->pdst) {
 		optim_path->status = NO_DESTINATION;
+		cspf_clean(algo);
 		return optim_path;
 	}
 
 	if (!algo->path) {
 		optim_path->status = NO_SOURCE;
+		cspf_clean(algo);
 		return optim_path;
 	}
 
 	if (algo->pdst->dst == algo->path->dst) {
 		optim_path->status = SAME_SRC_DST;
+		cspf_clean(algo);
 		return optim_path;
 	}
 
+	/* Look for a previous result, dropping them if the TED has changed */
+	if (algo->cache_max) {
+		if (algo->cache_ted != ted
+		    || algo->cache_generation != ted->generation) {
+			cspf_cache_flush(algo);
+			algo->cache_ted = ted;
+			algo->cache_generation = ted->generation;
+		}
+
+		key.src = algo->path->dst;
+		key.dst = algo->pdst->dst;
+		key.csts = algo->csts;
+		cached = cspf_cache_find(&algo->cache, &key);
+		if (cached) {
+			cpath_copy(optim_path, cached->path);
+			cspf_clean(algo);
+			return optim_path;
+		}
+	}
+
 	optim_path->dst = algo->pdst->dst;
 	optim_path->status = IN_PROGRESS;
+	graph = ls_ted_graph(ted);
 
 	/*
-	 * Process all Connected Vertex until priority queue becomes empty.
-	 * Connected Vertices are added into the priority queue when
-	 * processing the next Connected Vertex: see relax_constraints()
+	 * Process Connected Vertices by increasing cost until the destination
+	 * is reached or the priority queue becomes empty. Connected Vertices
+	 * are added into the priority queue when processing the next Connected
+	 * Vertex: see relax_constraints()
 	 */
-	cur_cost = MAX_COST;
-	while (pqueue_count(&algo->pqueue) != 0) {
-		/* Got shortest current Path from the Priority Queue */
-		algo->path = pqueue_pop(&algo->pqueue);
-
-		/* Add destination Vertex of this path to the visited RB Tree */
-		vertex = ls_find_vertex_by_key(ted, algo->path->dst);
-		if (!vertex)
+	while ((algo->path = pqueue_pop(&algo->pqueue))) {
+		algo->path->visited = true;
+
+		/* Paths are popped by increasing cost: this one is the best */
+		if (algo->path == algo->pdst) {
+			cpath_build(optim_path, algo->pdst);
+			optim_path->status = SUCCESS;
+			break;
+		}
+
+		/* Skip Vertices which do not belong to this TED */
+		vertex = algo->path->vertex;
+		if (!vertex || vertex->index >= graph->nvertices
+		    || graph->vertices[vertex->index] != vertex)
 			continue;
-		vnode = vnode_new(vertex);
-		visited_add(&algo->visited, vnode);
 
 		/* Process all outgoing links from this Vertex */
-		for (ALL_LIST_ELEMENTS_RO(vertex->outgoing_edges, node, edge)) {
+		link = &graph->links[graph->offset[vertex->index]];
+		end = &graph->links[graph->offset[vertex->index + 1]];
+		for (; link < end; link++) {
 			/*
-			 * Skip Connected Edges that must be prune i.e.
-			 * Edges that not satisfy the given constraints,
+			 * Skip Connected Links that must be prune i.e.
+			 * Links that not satisfy the given constraints,
 			 * in particular the Bandwidth, TE Metric and Delay.
 			 */
-			if (prune_edge(algo->path, edge, &algo->csts))
+			if (prune_link(algo->path, link, &algo->csts))
 				continue;
 
 			/*
-			 * Relax constraints and check if we got a shorter
-			 * candidate path
+			 * Relax constraints to get a shorter candidate path
 			 */
-			if (relax_constraints(algo, edge) &&
-			    algo->pdst->weight < cur_cost) {
-				cur_cost = algo->pdst->weight;
-				cpath_copy(optim_path, algo->pdst);
-				optim_path->status = SUCCESS;
-			}
+			relax_constraints(algo, graph, link);
 		}
 	}
 
 	/*
-	 * The priority queue is empty => all the possible (vertex, path)
-	 * elements have been explored. The optim_path contains the optimal
-	 * path if it exists. Otherwise an empty path with status failed is
-	 * returned.
+	 * The optim_path contains the optimal path if it exists. Otherwise
+	 * all the possible (vertex, path) elements have been explored and an
+	 * empty path with status failed is returned.
 	 */
 	if (optim_path->status == IN_PROGRESS ||
 	    listcount(optim_path->edges) == 0)
 		optim_path->status = FAILED;
 	cspf_clean(algo);
 
+	/* Remember the result, failures included */
+	if (algo->cache_max) {
+		if (cspf_cache_count(&algo->cache) >= algo->cache_max)
+			cspf_cache_flush(algo);
+
+		cached = XCALLOC(MTYPE_PCA, sizeof(*cached));
+		*cached = key;
+		cached->path = cpath_copy(NULL, optim_path);
+		cspf_cache_add(&algo->cache, cached);
+	}
+
 	return optim_path;
 }
+
+void cspf_path_del(struct c_path *path)
+{
+	cpath_del(path);
+}
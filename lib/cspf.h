@@ -26,6 +26,7 @@
 #define _FRR_CSPF_H_
 
 #include "typesafe.h"
+#include "jhash.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -39,6 +40,10 @@ extern "C" {
  *  - A pruning function that keeps only links that meet constraints
  *  - A priority Queue that keeps the shortest on-going computed path
  *  - A main loop over all vertices to find the shortest path
+ *
+ * A CSPF structure can be kept and reused for many computations: the
+ * per-vertex paths are carved out of chunks that stay allocated in it, and
+ * with cspf_cache_set() the results are remembered until the TED changes.
  */
 
 #define MAX_COST	0xFFFFFFFF
@@ -66,55 +71,112 @@ struct constraints {
 };
 
 /* Priority Queue for Constrained Path Computation */
-PREDECL_RBTREE_NONUNIQ(pqueue);
+PREDECL_HEAP(pqueue);
 
 /* Processed Path for Constrained Path Computation */
-PREDECL_RBTREE_UNIQ(processed);
+PREDECL_HASH(processed);
+
+/* Cached results of Constrained Path Computation */
+PREDECL_HASH(cspf_cache);
 
-/* Constrained Path structure */
+/*
+ * Constrained Path structure. During the computation there is one per
+ * reached vertex, holding the best path found so far as a back pointer to
+ * the previous hop; only the paths returned by compute_p2p_path() have the
+ * list of edges.
+ */
 struct c_path {
 	struct pqueue_item q_itm;    /* entry in the Priority Queue */
 	uint32_t weight;             /* Weight to sort path in Priority Queue */
-	struct processed_item p_itm; /* entry in the Processed RB Tree */
+	struct processed_item p_itm; /* entry in the Processed Hash */
 	uint64_t dst;                /* Destination vertex key of this path */
 	struct list *edges;          /* List of Edges that compose this path */
 	enum path_status status;     /* status of the computed path */
+	const struct ls_vertex *vertex; /* Destination vertex of this path */
+	struct c_path *prev;         /* Path up to the previous vertex */
+	struct ls_edge *edge;        /* Edge from the previous vertex */
+	bool visited;                /* Shortest path to dst is known */
 };
 
 macro_inline int q_cmp(const struct c_path *p1, const struct c_path *p2)
 {
 	return numcmp(p1->weight, p2->weight);
 }
-DECLARE_RBTREE_NONUNIQ(pqueue, struct c_path, q_itm, q_cmp);
+DECLARE_HEAP(pqueue, struct c_path, q_itm, q_cmp);
 
 macro_inline int p_cmp(const struct c_path *p1, const struct c_path *p2)
 {
 	return numcmp(p1->dst, p2->dst);
 }
-DECLARE_RBTREE_UNIQ(processed, struct c_path, p_itm, p_cmp);
-
-/* List of visited node */
-PREDECL_RBTREE_UNIQ(visited);
-struct v_node {
-	struct visited_item item; /* entry in the Processed RB Tree */
-	uint64_t key;
-	struct ls_vertex *vertex;
+macro_inline uint32_t p_hash(const struct c_path *p)
+{
+	return jhash_2words(p->dst, p->dst >> 32, 0);
+}
+DECLARE_HASH(processed, struct c_path, p_itm, p_cmp, p_hash);
+
+/* Cached result of a path computation */
+struct cspf_cached {
+	struct cspf_cache_item item;
+
+	uint64_t src;
+	uint64_t dst;
+	struct constraints csts;
+	struct c_path *path;
 };
 
-macro_inline int v_cmp(const struct v_node *p1, const struct v_node *p2)
+macro_inline int cspf_cached_cmp(const struct cspf_cached *a,
+				 const struct cspf_cached *b)
+{
+	if (a->src != b->src)
+		return numcmp(a->src, b->src);
+	if (a->dst != b->dst)
+		return numcmp(a->dst, b->dst);
+	if (a->csts.ctype != b->csts.ctype)
+		return numcmp(a->csts.ctype, b->csts.ctype);
+	if (a->csts.cost != b->csts.cost)
+		return numcmp(a->csts.cost, b->csts.cost);
+	if (a->csts.bw != b->csts.bw)
+		return a->csts.bw < b->csts.bw ? -1 : 1;
+	if (a->csts.cos != b->csts.cos)
+		return numcmp(a->csts.cos, b->csts.cos);
+	if (a->csts.type != b->csts.type)
+		return numcmp(a->csts.type, b->csts.type);
+	return numcmp(a->csts.family, b->csts.family);
+}
+
+macro_inline uint32_t cspf_cached_hash(const struct cspf_cached *c)
 {
-	return numcmp(p1->key, p2->key);
+	uint32_t hash;
+
+	hash = jhash_2words(c->src, c->src >> 32, 0);
+	hash = jhash_2words(c->dst, c->dst >> 32, hash);
+	return jhash_3words(c->csts.cost, c->csts.ctype,
+			    (c->csts.type << 16) | (c->csts.cos << 8)
+				    | c->csts.family,
+			    hash);
 }
-DECLARE_RBTREE_UNIQ(visited, struct v_node, item, v_cmp);
+
+DECLARE_HASH(cspf_cache, struct cspf_cached, item, cspf_cached_cmp,
+	     cspf_cached_hash);
 
 /* Path Computation algorithms structure */
 struct cspf {
 	struct pqueue_head pqueue;       /* Priority Queue */
 	struct processed_head processed; /* Paths that have been processed */
-	struct visited_head visited;     /* Vertices that have been visited */
 	struct constraints csts;         /* Constraints of the path */
 	struct c_path *path;             /* Current Computed Path */
 	struct c_path *pdst;             /* Computed Path to the destination */
+
+	/* Paths of the current computation are carved out of these */
+	struct c_path **chunks;
+	uint32_t nchunks;
+	uint32_t used;
+
+	/* Computed paths, valid as long as the TED generation is unchanged */
+	struct cspf_cache_head cache;
+	uint32_t cache_max;
+	const struct ls_ted *cache_ted;
+	uint64_t cache_generation;
 };
 
 /**
@@ -193,6 +255,16 @@ extern void cspf_clean(struct cspf *algo);
  */
 extern void cspf_del(struct cspf *algo);
 
+/**
+ * Remember the results of compute_p2p_path() for the same source,
+ * destination and constraints. The cache is emptied whenever the generation
+ * of the TED changes, or when it holds max_entries results.
+ *
+ * @param algo		CSPF structure
+ * @param max_entries	Maximum number of cached results, 0 to disable
+ */
+extern void cspf_cache_set(struct cspf *algo, uint32_t max_entries);
+
 /**
  * Compute point-to-point constrained path. cspf_init() function must be call
  * prior to call this function.
@@ -204,6 +276,13 @@ extern void cspf_del(struct cspf *algo);
  */
 extern struct c_path *compute_p2p_path(struct cspf *algo, struct ls_ted *ted);
 
+/**
+ * Delete Constrained Path returned by compute_p2p_path().
+ *
+ * @param path	Constrained Path
+ */
+extern void cspf_path_del(struct c_path *path);
+
 #ifdef __cplusplus
 }
 #endif
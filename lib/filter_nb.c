@@ -48,6 +48,20 @@ static void acl_notify_route_map(struct access_list *acl, int route_map_event)
 	route_map_notify_dependencies(acl->name, route_map_event);
 }
 
+/*
+ * Get the prefix-list entry being edited.  The dependents of its prefix-list
+ * are notified once, from the prefix-list's 'apply_finish' callback.
+ */
+static struct prefix_list_entry *plist_entry_get(const struct lyd_node *dnode)
+{
+	struct prefix_list_entry *ple;
+
+	ple = nb_running_get_entry(dnode, NULL, true);
+	prefix_list_update_begin(ple->pl);
+
+	return ple;
+}
+
 static enum nb_error prefix_list_length_validate(struct nb_cb_modify_args *args)
 {
 	int type = yang_dnode_get_enum(args->dnode, "../../type");
@@ -160,7 +174,7 @@ static int lib_prefix_list_entry_prefix_length_greater_or_equal_modify(
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -181,7 +195,7 @@ static int lib_prefix_list_entry_prefix_length_lesser_or_equal_modify(
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -202,7 +216,7 @@ static int lib_prefix_list_entry_prefix_length_greater_or_equal_destroy(
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -223,7 +237,7 @@ static int lib_prefix_list_entry_prefix_length_lesser_or_equal_destroy(
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1170,6 +1184,15 @@ static int lib_prefix_list_create(struct nb_cb_create_args *args)
 	return NB_OK;
 }
 
+static void lib_prefix_list_apply_finish(struct nb_cb_apply_finish_args *args)
+{
+	struct prefix_list *pl;
+
+	/* Notify the dependents of the entries changed in this transaction. */
+	pl = nb_running_get_entry(args->dnode, NULL, true);
+	prefix_list_update_commit(pl);
+}
+
 static int lib_prefix_list_destroy(struct nb_cb_destroy_args *args)
 {
 	struct prefix_list *pl;
@@ -1247,6 +1270,7 @@ static int lib_prefix_list_entry_destroy(struct nb_cb_destroy_args *args)
 		return NB_OK;
 
 	ple = nb_running_unset_entry(args->dnode);
+	prefix_list_update_begin(ple->pl);
 	if (ple->installed)
 		prefix_list_entry_delete2(ple);
 	else
@@ -1266,7 +1290,7 @@ static int lib_prefix_list_entry_action_modify(struct nb_cb_modify_args *args)
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1291,7 +1315,7 @@ static int lib_prefix_list_entry_prefix_modify(struct nb_cb_modify_args *args)
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1321,7 +1345,7 @@ static int lib_prefix_list_entry_prefix_destroy(struct nb_cb_destroy_args *args)
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1601,7 +1625,7 @@ static int lib_prefix_list_entry_any_create(struct nb_cb_create_args *args)
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1638,7 +1662,7 @@ static int lib_prefix_list_entry_any_destroy(struct nb_cb_destroy_args *args)
 	if (args->event != NB_EV_APPLY)
 		return NB_OK;
 
-	ple = nb_running_get_entry(args->dnode, NULL, true);
+	ple = plist_entry_get(args->dnode);
 
 	/* Start prefix entry update procedure. */
 	prefix_list_entry_update_start(ple);
@@ -1784,6 +1808,7 @@ const struct frr_yang_module_info frr_filter_info = {
 			.cbs = {
 				.create = lib_prefix_list_create,
 				.destroy = lib_prefix_list_destroy,
+				.apply_finish = lib_prefix_list_apply_finish,
 			}
 		},
 		{
@@ -33,6 +33,8 @@
 
 DEFINE_MTYPE_STATIC(LIB, FRR_PTHREAD, "FRR POSIX Thread");
 DEFINE_MTYPE_STATIC(LIB, PTHREAD_PRIM, "POSIX sync primitives");
+DEFINE_MTYPE_STATIC(LIB, FRR_PTHREAD_POOL, "FRR POSIX Thread pool");
+DEFINE_MTYPE_STATIC(LIB, FRR_PTHREAD_JOB, "FRR POSIX Thread pool job");
 
 /* default frr_pthread start/stop routine prototypes */
 static void *fpt_run(void *arg);
@@ -317,3 +319,280 @@ static void *fpt_run(void *arg)
 
 	return NULL;
 }
+
+/*
+ * ----------------------------------------------------------------------------
+ * Worker pool
+ * ----------------------------------------------------------------------------
+ */
+
+PREDECL_DLIST(frr_pthread_jobs);
+
+struct frr_pthread_job {
+	struct frr_pthread_jobs_item item;
+
+	void (*func)(struct thread *);
+	void (*done)(struct thread *);
+	void *arg;
+	struct thread_master *master;
+	const struct xref_threadsched *xref, *done_xref;
+};
+
+DECLARE_DLIST(frr_pthread_jobs, struct frr_pthread_job, item);
+
+/* One per worker, holds the jobs submitted to it */
+struct frr_pthread_pool_queue {
+	struct frr_pthread *fpt;
+	struct frr_pthread_pool *pool;
+
+	pthread_mutex_t mtx;
+	struct frr_pthread_jobs_head jobs;
+	struct thread *t_drain;
+
+	/* worker is running jobs, and not looking at its event loop */
+	atomic_bool busy;
+};
+
+struct frr_pthread_pool {
+	unsigned int size;
+	struct frr_pthread_pool_queue *queues;
+
+	/* worker the next submitted job goes to */
+	atomic_uint_fast32_t rr;
+
+	pthread_mutex_t mtx;
+	pthread_cond_t cond;
+
+	/* current batch */
+	void (*func)(void *arg);
+	void **args;
+	unsigned int count;
+	atomic_uint_fast32_t next;
+
+	/* workers still working on the batch, protected by mtx */
+	unsigned int busy;
+};
+
+struct frr_pthread_pool *frr_pthread_pool_new(const char *name,
+					      unsigned int size)
+{
+	struct frr_pthread_pool *pool;
+	struct frr_pthread_pool_queue *q;
+	unsigned int i;
+
+	pool = XCALLOC(MTYPE_FRR_PTHREAD_POOL, sizeof(*pool));
+	pool->queues = XCALLOC(MTYPE_FRR_PTHREAD_POOL,
+			       size * sizeof(pool->queues[0]));
+	pthread_mutex_init(&pool->mtx, NULL);
+	pthread_cond_init(&pool->cond, NULL);
+
+	for (i = 0; i < size; i++) {
+		q = &pool->queues[i];
+		q->pool = pool;
+		pthread_mutex_init(&q->mtx, NULL);
+		frr_pthread_jobs_init(&q->jobs);
+
+		q->fpt = frr_pthread_new(NULL, name, name);
+		if (frr_pthread_run(q->fpt, NULL)) {
+			frr_pthread_destroy(q->fpt);
+			frr_pthread_jobs_fini(&q->jobs);
+			pthread_mutex_destroy(&q->mtx);
+			break;
+		}
+		frr_pthread_wait_running(q->fpt);
+	}
+	pool->size = i;
+
+	return pool;
+}
+
+void frr_pthread_pool_free(struct frr_pthread_pool **poolp)
+{
+	struct frr_pthread_pool *pool = *poolp;
+	struct frr_pthread_pool_queue *q;
+	struct frr_pthread_job *job;
+	unsigned int i;
+
+	if (!pool)
+		return;
+
+	for (i = 0; i < pool->size; i++) {
+		frr_pthread_stop(pool->queues[i].fpt, NULL);
+		frr_pthread_destroy(pool->queues[i].fpt);
+	}
+
+	/* jobs that did not get to run are dropped, done is not called */
+	for (i = 0; i < pool->size; i++) {
+		q = &pool->queues[i];
+		while ((job = frr_pthread_jobs_pop(&q->jobs)))
+			XFREE(MTYPE_FRR_PTHREAD_JOB, job);
+		frr_pthread_jobs_fini(&q->jobs);
+		pthread_mutex_destroy(&q->mtx);
+	}
+
+	pthread_mutex_destroy(&pool->mtx);
+	pthread_cond_destroy(&pool->cond);
+	XFREE(MTYPE_FRR_PTHREAD_POOL, pool->queues);
+	XFREE(MTYPE_FRR_PTHREAD_POOL, *poolp);
+}
+
+/* Take jobs of the current batch until there are none left */
+static void frr_pthread_pool_work(struct frr_pthread_pool *pool)
+{
+	uint_fast32_t i;
+
+	while ((i = atomic_fetch_add_explicit(&pool->next, 1,
+					      memory_order_relaxed))
+	       < pool->count)
+		pool->func(pool->args[i]);
+}
+
+static void frr_pthread_pool_worker(struct thread *thread)
+{
+	struct frr_pthread_pool *pool = THREAD_ARG(thread);
+
+	frr_pthread_pool_work(pool);
+
+	frr_with_mutex (&pool->mtx) {
+		if (--pool->busy == 0)
+			pthread_cond_signal(&pool->cond);
+	}
+}
+
+void frr_pthread_pool_run(struct frr_pthread_pool *pool,
+			  void (*func)(void *arg), void **args,
+			  unsigned int count)
+{
+	unsigned int i, workers;
+
+	if (!count)
+		return;
+
+	/* the caller takes a share of the jobs, too */
+	workers = MIN(pool->size, count - 1);
+
+	pool->func = func;
+	pool->args = args;
+	pool->count = count;
+	atomic_store_explicit(&pool->next, 0, memory_order_relaxed);
+	pool->busy = workers;
+
+	/* the workers' thread masters do the memory synchronization */
+	for (i = 0; i < workers; i++)
+		thread_add_event(pool->queues[i].fpt->master,
+				 frr_pthread_pool_worker, pool, 0, NULL);
+
+	frr_pthread_pool_work(pool);
+
+	frr_with_mutex (&pool->mtx) {
+		while (pool->busy)
+			pthread_cond_wait(&pool->cond, &pool->mtx);
+	}
+}
+
+/*
+ * Take the next job, from our own queue first.  Our own jobs are taken
+ * from the head and others' from the tail, so a worker and a thief only
+ * meet on the last job of a queue.
+ */
+static struct frr_pthread_job *
+frr_pthread_pool_take(struct frr_pthread_pool_queue *q)
+{
+	struct frr_pthread_pool *pool = q->pool;
+	struct frr_pthread_pool_queue *victim;
+	struct frr_pthread_job *job;
+	unsigned int i, own = q - pool->queues;
+
+	frr_with_mutex (&q->mtx) {
+		job = frr_pthread_jobs_pop(&q->jobs);
+	}
+	if (job)
+		return job;
+
+	for (i = 1; i < pool->size; i++) {
+		victim = &pool->queues[(own + i) % pool->size];
+
+		frr_with_mutex (&victim->mtx) {
+			job = frr_pthread_jobs_last(&victim->jobs);
+			if (job)
+				frr_pthread_jobs_del(&victim->jobs, job);
+		}
+		if (job)
+			return job;
+	}
+
+	return NULL;
+}
+
+static void frr_pthread_pool_drain(struct thread *thread)
+{
+	struct frr_pthread_pool_queue *q = THREAD_ARG(thread);
+	struct frr_pthread_job *job;
+
+	atomic_store_explicit(&q->busy, true, memory_order_relaxed);
+	while ((job = frr_pthread_pool_take(q))) {
+		/* accounted in "show thread cpu" under the job's function */
+		_thread_execute(job->xref, q->fpt->master, job->func, job->arg,
+				0);
+
+		if (job->done)
+			_thread_add_event(job->done_xref, job->master,
+					  job->done, job->arg, 0, NULL);
+		XFREE(MTYPE_FRR_PTHREAD_JOB, job);
+	}
+	atomic_store_explicit(&q->busy, false, memory_order_relaxed);
+}
+
+void _frr_pthread_pool_submit(const struct xref_threadsched *xref,
+			      const struct xref_threadsched *done_xref,
+			      struct frr_pthread_pool *pool,
+			      void (*func)(struct thread *), void *arg,
+			      struct thread_master *master,
+			      void (*done)(struct thread *))
+{
+	struct frr_pthread_pool_queue *q;
+	struct frr_pthread_job *job;
+	unsigned int i;
+
+	job = XCALLOC(MTYPE_FRR_PTHREAD_JOB, sizeof(*job));
+	job->func = func;
+	job->done = done;
+	job->arg = arg;
+	job->master = master;
+	job->xref = xref;
+	job->done_xref = done_xref;
+
+	/* a pool without workers runs the job right away */
+	if (!pool->size) {
+		_thread_execute(xref, master, func, arg, 0);
+		if (done)
+			_thread_add_event(done_xref, master, done, arg, 0,
+					  NULL);
+		XFREE(MTYPE_FRR_PTHREAD_JOB, job);
+		return;
+	}
+
+	i = atomic_fetch_add_explicit(&pool->rr, 1, memory_order_relaxed)
+	    % pool->size;
+	q = &pool->queues[i];
+
+	frr_with_mutex (&q->mtx) {
+		frr_pthread_jobs_add_tail(&q->jobs, job);
+	}
+
+	thread_add_event(q->fpt->master, frr_pthread_pool_drain, q, 0,
+			 &q->t_drain);
+
+	if (!atomic_load_explicit(&q->busy, memory_order_relaxed))
+		return;
+
+	/* that worker is tied up, have an idle one steal the job */
+	for (i = 0; i < pool->size; i++) {
+		q = &pool->queues[i];
+		if (atomic_load_explicit(&q->busy, memory_order_relaxed))
+			continue;
+		thread_add_event(q->fpt->master, frr_pthread_pool_drain, q, 0,
+				 &q->t_drain);
+		break;
+	}
+}
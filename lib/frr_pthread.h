@@ -211,6 +211,64 @@ int frr_pthread_stop(struct frr_pthread *fpt, void **result);
 /* Stops all frr_pthread's. */
 void frr_pthread_stop_all(void);
 
+/*
+ * Pool of worker pthreads, to run a batch of independent jobs in parallel.
+ *
+ * frr_pthread_pool_run() calls func(args[i]) for each of the count args,
+ * spread over the workers and the calling pthread, and returns when all of
+ * them are done.  The jobs run concurrently with each other, but not with
+ * anything else on the calling pthread.
+ *
+ * @param name - name of the worker pthreads
+ * @param size - number of worker pthreads, not counting the caller
+ */
+struct frr_pthread_pool;
+
+struct frr_pthread_pool *frr_pthread_pool_new(const char *name,
+					      unsigned int size);
+void frr_pthread_pool_free(struct frr_pthread_pool **poolp);
+void frr_pthread_pool_run(struct frr_pthread_pool *pool,
+			  void (*func)(void *arg), void **args,
+			  unsigned int count);
+
+/*
+ * Run a job on the pool without waiting for it.  func runs on one of the
+ * workers, then done (if not NULL) is scheduled as an event on master,
+ * normally the submitter's, with the same arg.  Each worker has its own
+ * queue of jobs, and takes jobs from the other queues when its own is
+ * empty.  Jobs are accounted in "show thread cpu" under the worker pthread
+ * and the name of func.  Jobs that have not run yet when the pool is freed
+ * are dropped without calling done.
+ */
+#define frr_pthread_pool_submit(pool, f, a, m, d)                              \
+	({                                                                     \
+		static const struct xref_threadsched _xref                     \
+				__attribute__((used)) = {                      \
+			.xref = XREF_INIT(XREFT_THREADSCHED, NULL, __func__),  \
+			.funcname = #f,                                        \
+			.dest = NULL,                                          \
+			.thread_type = THREAD_EXECUTE,                         \
+		};                                                             \
+		static const struct xref_threadsched _done_xref                \
+				__attribute__((used)) = {                      \
+			.xref = XREF_INIT(XREFT_THREADSCHED, NULL, __func__),  \
+			.funcname = #d,                                        \
+			.dest = NULL,                                          \
+			.thread_type = THREAD_EVENT,                           \
+		};                                                             \
+		XREF_LINK(_xref.xref);                                         \
+		XREF_LINK(_done_xref.xref);                                    \
+		_frr_pthread_pool_submit(&_xref, &_done_xref, pool, f, a, m,   \
+					 d);                                   \
+	}) /* end */
+
+void _frr_pthread_pool_submit(const struct xref_threadsched *xref,
+			      const struct xref_threadsched *done_xref,
+			      struct frr_pthread_pool *pool,
+			      void (*func)(struct thread *), void *arg,
+			      struct thread_master *master,
+			      void (*done)(struct thread *));
+
 #ifndef HAVE_PTHREAD_CONDATTR_SETCLOCK
 #define pthread_condattr_setclock(A, B)
 #endif
@@ -229,6 +229,7 @@ typedef std::atomic<uintptr_t>		atomic_uintptr_t;
 #include <stdbool.h>
 
 typedef _Atomic bool		atomic_bool;
+typedef _Atomic int		atomic_int;
 typedef _Atomic size_t		atomic_size_t;
 typedef _Atomic uint_fast32_t	atomic_uint_fast32_t;
 typedef _Atomic uintptr_t	atomic_uintptr_t;
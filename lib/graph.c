@@ -27,6 +27,9 @@
 
 DEFINE_MTYPE_STATIC(LIB, GRAPH, "Graph");
 DEFINE_MTYPE_STATIC(LIB, GRAPH_NODE, "Graph Node");
+
+uint32_t graph_generation;
+
 struct graph *graph_new(void)
 {
 	struct graph *graph = XCALLOC(MTYPE_GRAPH, sizeof(struct graph));
@@ -118,11 +121,14 @@ struct graph_node *graph_add_edge(struct graph_node *from,
 {
 	vector_set(from->to, to);
 	vector_set(to->from, from);
+	graph_generation++;
 	return to;
 }
 
 void graph_remove_edge(struct graph_node *from, struct graph_node *to)
 {
+	graph_generation++;
+
 	// remove from from to->from
 	for (unsigned int i = vector_active(to->from); i--; /**/)
 		if (vector_slot(to->from, i) == from) {
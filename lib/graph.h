@@ -57,6 +57,12 @@ struct graph *graph_new(void);
 struct graph_node *graph_new_node(struct graph *graph, void *data,
 				  void (*del)(void *));
 
+/*
+ * Bumped whenever an edge is added to or removed from any graph, so users can
+ * cache data derived from the shape of a graph and notice when it's stale.
+ */
+extern uint32_t graph_generation;
+
 /**
  * Deletes a node.
  *
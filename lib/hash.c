@@ -93,48 +93,87 @@ void *hash_alloc_intern(void *arg)
 						  memory_order_relaxed);       \
 	} while (0)
 
-/* Expand hash if the chain length exceeds the threshold. */
-static void hash_expand(struct hash *hash)
+/* Number of buckets in the current round of splits, a power of 2 */
+static inline unsigned int hash_level(const struct hash *hash)
 {
-	unsigned int i, new_size;
-	struct hash_bucket *hb, *hbnext, **new_index;
-
-	new_size = hash->size * 2;
-
-	if (hash->max_size && new_size > hash->max_size)
-		return;
-
-	new_index = XCALLOC(MTYPE_HASH_INDEX,
-			    sizeof(struct hash_bucket *) * new_size);
-
-	hash->stats.empty = new_size;
+	return 1U << (31 - __builtin_clz(hash->size));
+}
 
-	for (i = 0; i < hash->size; i++)
-		for (hb = hash->index[i]; hb; hb = hbnext) {
-			unsigned int h = hb->key & (new_size - 1);
+/*
+ * Buckets below the split pointer (size - level) have already been split
+ * and are addressed with one more bit of the key.
+ */
+static inline unsigned int hash_index(const struct hash *hash,
+				      unsigned int key)
+{
+	unsigned int level = hash_level(hash);
+	unsigned int index = key & (level - 1);
 
-			hbnext = hb->next;
-			hb->next = new_index[h];
+	if (index < hash->size - level)
+		index = key & ((level << 1) - 1);
 
-			int oldlen = hb->next ? hb->next->len : 0;
-			int newlen = oldlen + 1;
+	return index;
+}
 
-			if (newlen == 1)
-				hash->stats.empty--;
-			else
-				hb->next->len = 0;
+/*
+ * Grow the hash by one bucket, splitting the chain at the split pointer
+ * between itself and the new bucket (linear hashing).  This keeps the cost
+ * of an insert bounded instead of rehashing the whole table at once.
+ */
+static void hash_expand(struct hash *hash)
+{
+	unsigned int level, from, to;
+	struct hash_bucket *hb, *hbnext, *keep = NULL, *move = NULL;
+	int oldlen, keeplen = 0, movelen = 0;
 
-			hb->len = newlen;
+	if (hash->max_size && hash->size >= hash->max_size)
+		return;
 
-			hash_update_ssq(hash, oldlen, newlen);
+	level = hash_level(hash);
+	from = hash->size - level;
+	to = hash->size;
+
+	/* starting a new round, make room for twice as many buckets */
+	if (from == 0) {
+		hash->index =
+			XREALLOC(MTYPE_HASH_INDEX, hash->index,
+				 sizeof(struct hash_bucket *) * level * 2);
+		memset(hash->index + level, 0,
+		       sizeof(struct hash_bucket *) * level);
+	}
 
-			new_index[h] = hb;
+	oldlen = hash->index[from] ? hash->index[from]->len : 0;
+	for (hb = hash->index[from]; hb; hb = hbnext) {
+		hbnext = hb->next;
+		if (hb->key & level) {
+			hb->next = move;
+			move = hb;
+			movelen++;
+		} else {
+			hb->next = keep;
+			keep = hb;
+			keeplen++;
 		}
+	}
 
-	/* Switch to new table */
-	XFREE(MTYPE_HASH_INDEX, hash->index);
-	hash->size = new_size;
-	hash->index = new_index;
+	hash->index[from] = keep;
+	hash->index[to] = move;
+	if (keep)
+		keep->len = keeplen;
+	if (move)
+		move->len = movelen;
+
+	/* the new bucket starts out empty */
+	hash->stats.empty++;
+	if (oldlen && !keeplen)
+		hash->stats.empty++;
+	if (movelen)
+		hash->stats.empty--;
+	hash_update_ssq(hash, oldlen, keeplen);
+	hash_update_ssq(hash, 0, movelen);
+	hash->stats.splits++;
+
+	hash->size++;
 }
 
 void *hash_get(struct hash *hash, void *data, void *(*alloc_func)(void *))
@@ -150,7 +189,7 @@ void *hash_get(struct hash *hash, void *data, void *(*alloc_func)(void *))
 		return NULL;
 
 	key = (*hash->hash_key)(data);
-	index = key & (hash->size - 1);
+	index = hash_index(hash, key);
 
 	for (bucket = hash->index[index]; bucket != NULL;
 	     bucket = bucket->next) {
@@ -165,7 +204,7 @@ void *hash_get(struct hash *hash, void *data, void *(*alloc_func)(void *))
 
 		if (HASH_THRESHOLD(hash->count + 1, hash->size)) {
 			hash_expand(hash);
-			index = key & (hash->size - 1);
+			index = hash_index(hash, key);
 		}
 
 		bucket = XCALLOC(MTYPE_HASH_BUCKET, sizeof(struct hash_bucket));
@@ -218,7 +257,7 @@ void *hash_release(struct hash *hash, void *data)
 	struct hash_bucket *pp;
 
 	key = (*hash->hash_key)(data);
-	index = key & (hash->size - 1);
+	index = hash_index(hash, key);
 
 	for (bucket = pp = hash->index[index]; bucket; bucket = bucket->next) {
 		if (bucket->key == key
@@ -359,7 +398,8 @@ DEFUN_NOSH(show_hash_stats,
 	struct listnode *ln;
 	struct ttable *tt = ttable_new(&ttable_styles[TTSTYLE_BLANK]);
 
-	ttable_add_row(tt, "Hash table|Buckets|Entries|Empty|LF|SD|FLF|SD");
+	ttable_add_row(tt,
+		       "Hash table|Buckets|Entries|Empty|LF|SD|FLF|SD|Splits");
 	tt->style.cell.lpad = 2;
 	tt->style.cell.rpad = 1;
 	tt->style.corner = '+';
@@ -388,6 +428,9 @@ DEFUN_NOSH(show_hash_stats,
 	 *   As a rule of thumb this number should be less than 2, and ideally
 	 *   <= 1 for optimal performance. A number larger than 3 generally
 	 *   indicates a poor hash function.
+	 *
+	 * - Splits: the number of buckets the table has been grown by since
+	 *   it was created.  Each split rehashes a single chain.
 	 */
 
 	double lf;    // load factor
@@ -427,10 +470,12 @@ DEFUN_NOSH(show_hash_stats,
 		stdv = sqrt(var);
 		fstdv = sqrt(fvar);
 
-		ttable_add_row(tt, "%s|%d|%ld|%.0f%%|%.2lf|%.2lf|%.2lf|%.2lf",
+		ttable_add_row(tt,
+			       "%s|%d|%ld|%.0f%%|%.2lf|%.2lf|%.2lf|%.2lf|%lu",
 			       h->name, h->size, h->count,
 			       (h->stats.empty / (double)h->size) * 100, lf,
-			       stdv, flf, fstdv);
+			       stdv, flf, fstdv,
+			       (unsigned long)h->stats.splits);
 	}
 	pthread_mutex_unlock(&_hashes_mtx);
 
@@ -58,13 +58,19 @@ struct hashstats {
 	atomic_uint_fast32_t empty;
 	/* sum of squares of bucket length */
 	atomic_uint_fast32_t ssq;
+	/* number of buckets split to grow the table */
+	atomic_uint_fast32_t splits;
 };
 
 struct hash {
 	/* Hash bucket. */
 	struct hash_bucket **index;
 
-	/* Hash table size. Must be power of 2 */
+	/*
+	 * Number of buckets in use.  Starts out as a power of 2 and grows by
+	 * one bucket at a time, the index is allocated up to the next power
+	 * of 2.
+	 */
 	unsigned int size;
 
 	/* If max_size is 0 there is no limit */
@@ -0,0 +1,201 @@
+/*
+ * Heartbeat socket, for watchfrr
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+#include <sys/un.h>
+
+#include "frr_pthread.h"
+#include "heartbeat.h"
+#include "lib_errors.h"
+#include "network.h"
+#include "privs.h"
+#include "thread.h"
+
+/* Everything but start/stop runs on the heartbeat pthread. */
+static struct {
+	struct frr_pthread *pth;
+	/* the event loop whose health is reported */
+	struct thread_master *watched;
+
+	char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+	int sock;
+	struct thread *t_accept;
+
+	/* one client at a time, that is watchfrr */
+	int fd;
+	struct thread *t_read;
+} hb = {
+	.sock = -1,
+	.fd = -1,
+};
+
+static void frr_heartbeat_read(struct thread *thread);
+
+static void frr_heartbeat_close(void)
+{
+	if (hb.fd < 0)
+		return;
+
+	THREAD_OFF(hb.t_read);
+	close(hb.fd);
+	hb.fd = -1;
+}
+
+static void frr_heartbeat_accept(struct thread *thread)
+{
+	int fd;
+
+	thread_add_read(hb.pth->master, frr_heartbeat_accept, NULL, hb.sock,
+			&hb.t_accept);
+
+	fd = accept(hb.sock, NULL, NULL);
+	if (fd < 0)
+		return;
+
+	if (set_nonblocking(fd) < 0 || set_cloexec(fd) < 0) {
+		close(fd);
+		return;
+	}
+
+	/* a new connection means the last client went away, possibly
+	 * without us noticing yet
+	 */
+	frr_heartbeat_close();
+	hb.fd = fd;
+	thread_add_read(hb.pth->master, frr_heartbeat_read, NULL, hb.fd,
+			&hb.t_read);
+}
+
+static void frr_heartbeat_read(struct thread *thread)
+{
+	struct frr_heartbeat_req req;
+	struct frr_heartbeat_resp resp = {};
+	const char *task;
+	ssize_t nbytes;
+
+	nbytes = read(hb.fd, &req, sizeof(req));
+	if (nbytes < 0 && ERRNO_IO_RETRY(errno)) {
+		thread_add_read(hb.pth->master, frr_heartbeat_read, NULL,
+				hb.fd, &hb.t_read);
+		return;
+	}
+	if (nbytes != sizeof(req) || req.magic != FRR_HEARTBEAT_MAGIC) {
+		frr_heartbeat_close();
+		return;
+	}
+
+	resp.magic = FRR_HEARTBEAT_MAGIC;
+	resp.seq = req.seq;
+	resp.pid = getpid();
+	resp.task_time = thread_master_task_time(hb.watched, &task);
+	if (task)
+		strlcpy(resp.task, task, sizeof(resp.task));
+
+	/* one request in flight, the answer fits in the socket buffer */
+	if (write(hb.fd, &resp, sizeof(resp)) != sizeof(resp)) {
+		frr_heartbeat_close();
+		return;
+	}
+
+	thread_add_read(hb.pth->master, frr_heartbeat_read, NULL, hb.fd,
+			&hb.t_read);
+}
+
+void frr_heartbeat_start(struct thread_master *master, const char *path)
+{
+	struct sockaddr_un sa;
+	struct zprivs_ids_t ids;
+	mode_t old_mask;
+	socklen_t len;
+	int sock;
+
+	if (strlcpy(hb.path, path, sizeof(hb.path)) >= sizeof(hb.path)) {
+		flog_err(EC_LIB_SOCKET, "heartbeat socket path too long: %s",
+			 path);
+		return;
+	}
+
+	unlink(hb.path);
+
+	sock = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (sock < 0) {
+		flog_err_sys(EC_LIB_SOCKET,
+			     "Cannot create heartbeat socket: %s",
+			     safe_strerror(errno));
+		return;
+	}
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sun_family = AF_UNIX;
+	strlcpy(sa.sun_path, hb.path, sizeof(sa.sun_path));
+#ifdef HAVE_STRUCT_SOCKADDR_UN_SUN_LEN
+	len = sa.sun_len = SUN_LEN(&sa);
+#else
+	len = sizeof(sa.sun_family) + strlen(sa.sun_path);
+#endif /* HAVE_STRUCT_SOCKADDR_UN_SUN_LEN */
+
+	old_mask = umask(0007);
+	if (bind(sock, (struct sockaddr *)&sa, len) < 0
+	    || listen(sock, 2) < 0) {
+		flog_err_sys(EC_LIB_SOCKET, "Cannot listen on %s: %s",
+			     hb.path, safe_strerror(errno));
+		umask(old_mask);
+		close(sock);
+		return;
+	}
+	umask(old_mask);
+
+	/* same access as the vty socket */
+	zprivs_get_ids(&ids);
+	if ((int)ids.gid_vty > 0 && chown(hb.path, -1, ids.gid_vty))
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "%s: could not chown socket, %s", __func__,
+			     safe_strerror(errno));
+
+	set_nonblocking(sock);
+	set_cloexec(sock);
+	hb.sock = sock;
+	hb.watched = master;
+
+	hb.pth = frr_pthread_new(NULL, "Heartbeat", "heartbeat");
+	thread_add_read(hb.pth->master, frr_heartbeat_accept, NULL, hb.sock,
+			&hb.t_accept);
+	frr_pthread_run(hb.pth, NULL);
+	frr_pthread_wait_running(hb.pth);
+}
+
+void frr_heartbeat_stop(void)
+{
+	if (!hb.pth)
+		return;
+
+	/* the daemon may have stopped all its pthreads already; the tasks
+	 * left on the pthread's master go away with it
+	 */
+	if (atomic_load_explicit(&hb.pth->running, memory_order_relaxed))
+		frr_pthread_stop(hb.pth, NULL);
+	hb.pth = NULL;
+
+	if (hb.fd >= 0)
+		close(hb.fd);
+	hb.fd = -1;
+	close(hb.sock);
+	hb.sock = -1;
+	unlink(hb.path);
+}
@@ -0,0 +1,72 @@
+/*
+ * Heartbeat socket, for watchfrr
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_HEARTBEAT_H
+#define _FRR_HEARTBEAT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct thread_master;
+
+/*
+ * Next to its vty socket ("zebra.vty"), each daemon listens on a
+ * heartbeat socket ("zebra.hb").  Requests on it are answered by a small
+ * pthread of its own, so an answer only says the process is alive; what it
+ * contains says whether the main event loop is keeping up:  the task it
+ * is running, if any, and for how long.  A daemon busy with a long but
+ * legitimate task keeps answering, one stuck in a task reports an ever
+ * growing time.
+ *
+ * Messages are fixed size, host byte order, over a unix stream socket.
+ */
+#define FRR_HEARTBEAT_SUFFIX ".hb"
+#define FRR_HEARTBEAT_MAGIC 0x46524842 /* "FRHB" */
+
+struct frr_heartbeat_req {
+	uint32_t magic;
+	uint32_t seq;
+};
+
+#define FRR_HEARTBEAT_TASKLEN 64
+
+struct frr_heartbeat_resp {
+	uint32_t magic;
+	/* seq of the request */
+	uint32_t seq;
+	uint32_t pid;
+	/* milliseconds the main pthread's current task has been running,
+	 * 0 if it is idle
+	 */
+	uint32_t task_time;
+	/* the task's function name, empty if idle */
+	char task[FRR_HEARTBEAT_TASKLEN];
+};
+
+/* started by frr_run() on path, watching master */
+extern void frr_heartbeat_start(struct thread_master *master,
+				const char *path);
+extern void frr_heartbeat_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_HEARTBEAT_H */
@@ -49,6 +49,7 @@ typedef enum {
 	IANA_SAFI_ENCAP = 7,
 	IANA_SAFI_EVPN = 70,
 	IANA_SAFI_MPLS_VPN = 128,
+	IANA_SAFI_RTC = 132,
 	IANA_SAFI_FLOWSPEC = 133
 } iana_safi_t;
 
@@ -380,6 +380,12 @@ static struct log_ref ferr_lib_err[] = {
 		.description = "An error was detected while attempting to resolve a hostname",
 		.suggestion = "Ensure that DNS is working properly and the hostname is configured in dns.  If you are still seeing this error, open an issue"
 	},
+	{
+		.code = EC_LIB_MEMORY_PRESSURE,
+		.title = "Memory pressure",
+		.description = "The daemon's memory use is approaching its configured limit, the limit of its cgroup, or the cgroup is stalling on memory reclaim",
+		.suggestion = "Check \"show memory\" and \"show memory pressure\" for what is using the memory.  Protocols may shed state, e.g. tear down sessions, to avoid being killed"
+	},
 	{
 		.code = END_FERR,
 	}
@@ -88,6 +88,7 @@ enum lib_log_refs {
 	EC_LIB_ID_CONSISTENCY,
 	EC_LIB_ID_EXHAUST,
 	EC_LIB_RESOLVER,
+	EC_LIB_MEMORY_PRESSURE,
 };
 
 extern void lib_error_init(void);
@@ -45,6 +45,7 @@
 #include "defaults.h"
 #include "frrscript.h"
 #include "systemd.h"
+#include "heartbeat.h"
 
 DEFINE_HOOK(frr_early_init, (struct thread_master * tm), (tm));
 DEFINE_HOOK(frr_late_init, (struct thread_master * tm), (tm));
@@ -1043,8 +1044,11 @@ void frr_config_fork(void)
 	zlog_tls_buffer_init();
 }
 
-static void frr_vty_serv(void)
+static void frr_vty_serv(struct thread_master *master)
 {
+	char hbpath[sizeof(vtypath_default)];
+	size_t len;
+
 	/* allow explicit override of vty_path in the future
 	 * (not currently set anywhere) */
 	if (!di->vty_path) {
@@ -1066,6 +1070,14 @@ static void frr_vty_serv(void)
 	}
 
 	vty_serv_sock(di->vty_addr, di->vty_port, di->vty_path);
+
+	/* the heartbeat socket sits next to the vty socket, for watchfrr */
+	len = strlen(di->vty_path);
+	if (len > 4 && !strcmp(di->vty_path + len - 4, ".vty"))
+		len -= 4;
+	snprintf(hbpath, sizeof(hbpath), "%.*s%s", (int)len, di->vty_path,
+		 FRR_HEARTBEAT_SUFFIX);
+	frr_heartbeat_start(master, hbpath);
 }
 
 static void frr_check_detach(void)
@@ -1156,7 +1168,7 @@ void frr_run(struct thread_master *master)
 {
 	char instanceinfo[64] = "";
 
-	frr_vty_serv();
+	frr_vty_serv(master);
 
 	if (di->instance)
 		snprintf(instanceinfo, sizeof(instanceinfo), "instance %u ",
@@ -1223,6 +1235,7 @@ void frr_fini(void)
 #ifdef HAVE_SCRIPTING
 	frrscript_fini();
 #endif
+	frr_heartbeat_stop();
 	frr_pthread_finish();
 	zprivs_terminate(di->privs);
 	/* signal_init -> nothing needed */
@@ -468,6 +468,7 @@ struct ls_vertex *ls_vertex_add(struct ls_ted *ted, struct ls_node *node)
 	new->prefixes = list_new();
 	new->prefixes->cmp = (int (*)(void *, void *))subnet_cmp;
 	vertices_add(&ted->vertices, new);
+	ted->generation++;
 
 	return new;
 }
@@ -501,6 +502,7 @@ void ls_vertex_del(struct ls_ted *ted, struct ls_vertex *vertex)
 
 	/* Then remove Vertex from Link State Data Base and free memory */
 	vertices_del(&ted->vertices, vertex);
+	ted->generation++;
 	XFREE(MTYPE_LS_DB, vertex);
 	vertex = NULL;
 }
@@ -529,6 +531,7 @@ struct ls_vertex *ls_vertex_update(struct ls_ted *ted, struct ls_node *node)
 		if (!ls_node_same(old->node, node)) {
 			ls_node_del(old->node);
 			old->node = node;
+			ted->generation++;
 		}
 		old->status = UPDATE;
 		return old;
@@ -740,6 +743,7 @@ struct ls_edge *ls_edge_add(struct ls_ted *ted,
 	new->status = NEW;
 	new->type = EDGE;
 	edges_add(&ted->edges, new);
+	ted->generation++;
 
 	/* Finally, connect Edge to Vertices */
 	ls_edge_connect_to(ted, new);
@@ -803,6 +807,7 @@ struct ls_edge *ls_edge_update(struct ls_ted *ted,
 		if (!ls_attributes_same(old->attributes, attributes)) {
 			ls_attributes_del(old->attributes);
 			old->attributes = attributes;
+			ted->generation++;
 		}
 		old->status = UPDATE;
 		return old;
@@ -838,6 +843,7 @@ void ls_edge_del(struct ls_ted *ted, struct ls_edge *edge)
 	ls_disconnect_edge(edge);
 	/* Then remove it from the Data Base */
 	edges_del(&ted->edges, edge);
+	ted->generation++;
 	XFREE(MTYPE_LS_DB, edge);
 }
 
@@ -884,6 +890,7 @@ struct ls_subnet *ls_subnet_add(struct ls_ted *ted,
 	listnode_add_sort_nodup(vertex->prefixes, new);
 
 	subnets_add(&ted->subnets, new);
+	ted->generation++;
 
 	return new;
 }
@@ -900,6 +907,7 @@ struct ls_subnet *ls_subnet_update(struct ls_ted *ted, struct ls_prefix *pref)
 		if (!ls_prefix_same(old->ls_pref, pref)) {
 			ls_prefix_del(old->ls_pref);
 			old->ls_pref = pref;
+			ted->generation++;
 		}
 		old->status = UPDATE;
 		return old;
@@ -934,6 +942,7 @@ void ls_subnet_del(struct ls_ted *ted, struct ls_subnet *subnet)
 	listnode_delete(subnet->vertex->prefixes, subnet);
 	/* Then delete Subnet */
 	subnets_del(&ted->subnets, subnet);
+	ted->generation++;
 	XFREE(MTYPE_LS_DB, subnet);
 }
 
@@ -956,9 +965,35 @@ struct ls_subnet *ls_find_subnet(struct ls_ted *ted, const struct prefix prefix)
 	return subnets_find(&ted->subnets, &subnet);
 }
 
+/*
+ * Background synchronization: the walk resumes after the key of the last
+ * element sent, so TED changes in between don't matter.
+ */
+#define LS_SYNC_CHUNK 256
+
+struct ls_sync {
+	struct ls_syncs_item entry;
+
+	struct ls_ted *ted;
+	struct zclient *zclient;
+	struct zapi_opaque_reg_info dst;
+
+	/* Last element sent, in the order Vertices, Edges, Subnets */
+	enum ls_type type;
+	bool started;
+	uint64_t key;
+	struct prefix prefix;
+
+	struct thread *t_walk;
+};
+
+DECLARE_DLIST(ls_syncs, struct ls_sync, entry);
+
 /**
  * Link State TED management functions
  */
+static void ls_sync_cancel_all(struct ls_ted *ted);
+
 struct ls_ted *ls_ted_new(const uint32_t key, const char *name,
 			  uint32_t as_number)
 {
@@ -975,6 +1010,7 @@ struct ls_ted *ls_ted_new(const uint32_t key, const char *name,
 	vertices_init(&new->vertices);
 	edges_init(&new->edges);
 	subnets_init(&new->subnets);
+	ls_syncs_init(&new->syncs);
 
 	return new;
 }
@@ -989,10 +1025,17 @@ void ls_ted_del(struct ls_ted *ted)
 	    || subnets_count(&ted->subnets))
 		return;
 
+	ls_sync_cancel_all(ted);
+
+	XFREE(MTYPE_LS_DB, ted->graph.vertices);
+	XFREE(MTYPE_LS_DB, ted->graph.offset);
+	XFREE(MTYPE_LS_DB, ted->graph.links);
+
 	/* Release RB Tree */
 	vertices_fini(&ted->vertices);
 	edges_fini(&ted->edges);
 	subnets_fini(&ted->subnets);
+	ls_syncs_fini(&ted->syncs);
 
 	XFREE(MTYPE_LS_DB, ted);
 }
@@ -1045,6 +1088,100 @@ void ls_ted_clean(struct ls_ted *ted)
 
 }
 
+static void ls_graph_link_set(struct ls_graph_link *link,
+			      struct ls_edge *edge)
+{
+	struct ls_attributes *attr = edge->attributes;
+	struct ls_standard *std = &attr->standard;
+	float bw;
+	int i;
+
+	link->dst = edge->destination->index;
+	link->edge = edge;
+	link->flags = 0;
+	if (!IPV4_NET0(std->local.s_addr))
+		SET_FLAG(link->flags, LS_GRAPH_IPV4);
+	if (!IN6_IS_ADDR_UNSPECIFIED(&std->local6))
+		SET_FLAG(link->flags, LS_GRAPH_IPV6);
+	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID))
+		SET_FLAG(link->flags, LS_GRAPH_ADJ_SID);
+	if (CHECK_FLAG(attr->flags, LS_ATTR_ADJ_SID6))
+		SET_FLAG(link->flags, LS_GRAPH_ADJ_SID6);
+	if (edge->destination->node
+	    && CHECK_FLAG(edge->destination->node->flags, LS_NODE_SR))
+		SET_FLAG(link->flags, LS_GRAPH_DST_SR);
+	if (CHECK_FLAG(attr->flags, LS_ATTR_METRIC))
+		SET_FLAG(link->flags, LS_GRAPH_METRIC);
+	if (CHECK_FLAG(attr->flags, LS_ATTR_TE_METRIC))
+		SET_FLAG(link->flags, LS_GRAPH_TE_METRIC);
+	if (CHECK_FLAG(attr->flags, LS_ATTR_DELAY))
+		SET_FLAG(link->flags, LS_GRAPH_DELAY);
+
+	link->metric = attr->metric;
+	link->te_metric = std->te_metric;
+	link->delay = attr->extended.delay;
+
+	bw = MIN(std->max_bw, std->max_rsv_bw);
+	for (i = 0; i < 8; i++)
+		link->bw[i] = MIN(bw, std->unrsv_bw[i]);
+}
+
+const struct ls_graph *ls_ted_graph(struct ls_ted *ted)
+{
+	struct ls_graph *graph = &ted->graph;
+	struct ls_vertex *vertex;
+	struct listnode *node;
+	struct ls_edge *edge;
+	uint32_t count, nlinks = 0;
+
+	if (graph->built && graph->generation == ted->generation)
+		return graph;
+
+	/* Number the Vertices and size the arrays */
+	count = vertices_count(&ted->vertices);
+	if (count > graph->vertices_max) {
+		graph->vertices_max = count;
+		graph->vertices =
+			XREALLOC(MTYPE_LS_DB, graph->vertices,
+				 count * sizeof(*graph->vertices));
+		graph->offset = XREALLOC(MTYPE_LS_DB, graph->offset,
+					 (count + 1) * sizeof(*graph->offset));
+	}
+	if (!graph->offset)
+		graph->offset = XCALLOC(MTYPE_LS_DB, sizeof(*graph->offset));
+
+	graph->nvertices = 0;
+	frr_each (vertices, &ted->vertices, vertex) {
+		vertex->index = graph->nvertices;
+		graph->vertices[graph->nvertices++] = vertex;
+		nlinks += listcount(vertex->outgoing_edges);
+	}
+	if (nlinks > graph->links_max) {
+		graph->links_max = nlinks;
+		graph->links = XREALLOC(MTYPE_LS_DB, graph->links,
+					nlinks * sizeof(*graph->links));
+	}
+
+	/* Then copy the usable outgoing Edges of each Vertex */
+	graph->nlinks = 0;
+	for (count = 0; count < graph->nvertices; count++) {
+		vertex = graph->vertices[count];
+		graph->offset[count] = graph->nlinks;
+		for (ALL_LIST_ELEMENTS_RO(vertex->outgoing_edges, node, edge)) {
+			if (!edge->destination || !edge->attributes)
+				continue;
+			ls_graph_link_set(&graph->links[graph->nlinks++],
+					  edge);
+		}
+	}
+	graph->offset[graph->nvertices] = graph->nlinks;
+
+	graph->generation = ted->generation;
+	graph->built = true;
+
+	return graph;
+}
+
 void ls_connect(struct ls_vertex *vertex, struct ls_edge *edge, bool source)
 {
 	if (vertex == NULL || edge == NULL)
@@ -1891,27 +2028,130 @@ void ls_delete_msg(struct ls_message *msg)
 	XFREE(MTYPE_LS_DB, msg);
 }
 
-int ls_sync_ted(struct ls_ted *ted, struct zclient *zclient,
-		struct zapi_opaque_reg_info *dst)
+static void ls_sync_walk(struct thread *thread)
 {
-	struct ls_vertex *vertex;
-	struct ls_edge *edge;
-	struct ls_subnet *subnet;
+	struct ls_sync *sync = THREAD_ARG(thread);
+	struct ls_ted *ted = sync->ted;
+	struct ls_vertex *vertex, vertex_ref;
+	struct ls_edge *edge, edge_ref;
+	struct ls_subnet *subnet, subnet_ref;
 	struct ls_message msg;
+	unsigned int count = 0;
+
+	if (sync->type == VERTEX) {
+		if (sync->started) {
+			vertex_ref.key = sync->key;
+			vertex = vertices_find_gteq(&ted->vertices, &vertex_ref);
+			if (vertex && vertex->key == sync->key)
+				vertex = vertices_next(&ted->vertices, vertex);
+		} else
+			vertex = vertices_first(&ted->vertices);
+
+		for (; vertex && count < LS_SYNC_CHUNK;
+		     vertex = vertices_next(&ted->vertices, vertex)) {
+			ls_vertex2msg(&msg, vertex);
+			ls_send_msg(sync->zclient, &msg, &sync->dst);
+			sync->key = vertex->key;
+			sync->started = true;
+			count++;
+		}
+		if (vertex)
+			goto more;
+
+		sync->type = EDGE;
+		sync->started = false;
+	}
+
+	if (sync->type == EDGE) {
+		if (sync->started) {
+			edge_ref.key = sync->key;
+			edge = edges_find_gteq(&ted->edges, &edge_ref);
+			if (edge && edge->key == sync->key)
+				edge = edges_next(&ted->edges, edge);
+		} else
+			edge = edges_first(&ted->edges);
+
+		for (; edge && count < LS_SYNC_CHUNK;
+		     edge = edges_next(&ted->edges, edge)) {
+			ls_edge2msg(&msg, edge);
+			ls_send_msg(sync->zclient, &msg, &sync->dst);
+			sync->key = edge->key;
+			sync->started = true;
+			count++;
+		}
+		if (edge)
+			goto more;
 
-	/* Loop TED, start sending Node, then Attributes and finally Prefix */
-	frr_each(vertices, &ted->vertices, vertex) {
-		ls_vertex2msg(&msg, vertex);
-		ls_send_msg(zclient, &msg, dst);
+		sync->type = SUBNET;
+		sync->started = false;
 	}
-	frr_each(edges, &ted->edges, edge) {
-		ls_edge2msg(&msg, edge);
-		ls_send_msg(zclient, &msg, dst);
-	}
-	frr_each(subnets, &ted->subnets, subnet) {
+
+	if (sync->started) {
+		subnet_ref.key = sync->prefix;
+		subnet = subnets_find_gteq(&ted->subnets, &subnet_ref);
+		if (subnet && !subnet_cmp(subnet, &subnet_ref))
+			subnet = subnets_next(&ted->subnets, subnet);
+	} else
+		subnet = subnets_first(&ted->subnets);
+
+	for (; subnet && count < LS_SYNC_CHUNK;
+	     subnet = subnets_next(&ted->subnets, subnet)) {
 		ls_subnet2msg(&msg, subnet);
-		ls_send_msg(zclient, &msg, dst);
+		ls_send_msg(sync->zclient, &msg, &sync->dst);
+		sync->prefix = subnet->key;
+		sync->started = true;
+		count++;
 	}
+	if (subnet)
+		goto more;
+
+	/* Done */
+	ls_syncs_del(&ted->syncs, sync);
+	XFREE(MTYPE_LS_DB, sync);
+	return;
+
+more:
+	thread_add_event(sync->zclient->master, ls_sync_walk, sync, 0,
+			 &sync->t_walk);
+}
+
+static void ls_sync_cancel_all(struct ls_ted *ted)
+{
+	struct ls_sync *sync;
+
+	while ((sync = ls_syncs_pop(&ted->syncs))) {
+		THREAD_OFF(sync->t_walk);
+		XFREE(MTYPE_LS_DB, sync);
+	}
+}
+
+int ls_sync_ted(struct ls_ted *ted, struct zclient *zclient,
+		struct zapi_opaque_reg_info *dst)
+{
+	struct ls_sync *sync;
+
+	frr_each (ls_syncs, &ted->syncs, sync)
+		if (sync->zclient == zclient && sync->dst.proto == dst->proto
+		    && sync->dst.instance == dst->instance
+		    && sync->dst.session_id == dst->session_id)
+			break;
+
+	if (sync) {
+		/* Start over */
+		THREAD_OFF(sync->t_walk);
+	} else {
+		sync = XCALLOC(MTYPE_LS_DB, sizeof(*sync));
+		sync->ted = ted;
+		sync->zclient = zclient;
+		ls_syncs_add_tail(&ted->syncs, sync);
+	}
+	sync->dst = *dst;
+	sync->type = VERTEX;
+	sync->started = false;
+
+	thread_add_event(zclient->master, ls_sync_walk, sync, 0,
+			 &sync->t_walk);
+
 	return 0;
 }
 
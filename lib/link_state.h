@@ -390,6 +390,7 @@ struct ls_vertex {
 	struct list *incoming_edges;	/* List of incoming Link State links */
 	struct list *outgoing_edges;	/* List of outgoing Link State links */
 	struct list *prefixes;		/* List of advertised prefix */
+	uint32_t index;			/* Index in the TED graph */
 };
 
 /* Link State Edge structure */
@@ -450,6 +451,48 @@ macro_inline int subnet_cmp(const struct ls_subnet *a,
 }
 DECLARE_RBTREE_UNIQ(subnets, struct ls_subnet, entry, subnet_cmp);
 
+/* Synchronizations of other daemons in progress, see ls_sync_ted() */
+PREDECL_DLIST(ls_syncs);
+
+/*
+ * Compact copy of the TED topology for path computation. Vertices are
+ * numbered by the order of the vertices RB tree and the outgoing links of
+ * Vertex i are links[offset[i]] to links[offset[i + 1] - 1]. Each link holds
+ * what is needed to prune and relax it, so that path computation walks
+ * arrays instead of Edge lists and Attributes. See ls_ted_graph().
+ */
+#define LS_GRAPH_IPV4		0x01	/* Edge has an IPv4 local address */
+#define LS_GRAPH_IPV6		0x02	/* Edge has an IPv6 local address */
+#define LS_GRAPH_ADJ_SID	0x04	/* Edge has an IPv4 Adjacency SID */
+#define LS_GRAPH_ADJ_SID6	0x08	/* Edge has an IPv6 Adjacency SID */
+#define LS_GRAPH_DST_SR		0x10	/* Destination Node is SR capable */
+#define LS_GRAPH_METRIC		0x20	/* metric is valid */
+#define LS_GRAPH_TE_METRIC	0x40	/* te_metric is valid */
+#define LS_GRAPH_DELAY		0x80	/* delay is valid */
+struct ls_graph_link {
+	uint32_t dst;			/* Index of the destination Vertex */
+	uint32_t flags;			/* LS_GRAPH_* flags */
+	uint32_t metric;		/* IGP standard metric */
+	uint32_t te_metric;		/* Traffic Engineering metric */
+	uint32_t delay;			/* Unidirectional average delay */
+	float bw[8];			/* Usable BW per CT i.e. min of Max,
+					 * Max Reservable and Unreserved BW
+					 */
+	struct ls_edge *edge;		/* Corresponding Link State Edge */
+};
+
+struct ls_graph {
+	bool built;			/* Arrays below are valid */
+	uint64_t generation;		/* TED generation of the arrays */
+	uint32_t nvertices;		/* Number of Vertices */
+	uint32_t nlinks;		/* Number of links */
+	uint32_t vertices_max;		/* Allocated size of vertices */
+	uint32_t links_max;		/* Allocated size of links */
+	struct ls_vertex **vertices;	/* Vertices by index */
+	uint32_t *offset;		/* First link of each Vertex */
+	struct ls_graph_link *links;	/* Links sorted by source Vertex */
+};
+
 /* Link State TED Structure */
 struct ls_ted {
 	uint32_t key;			/* Unique identifier */
@@ -459,6 +502,14 @@ struct ls_ted {
 	struct vertices_head vertices;	/* List of Vertices */
 	struct edges_head edges;	/* List of Edges */
 	struct subnets_head subnets;	/* List of Subnets */
+	struct ls_syncs_head syncs;	/* Synchronizations in progress */
+	/*
+	 * Bumped by every change made through the functions below, e.g. to
+	 * invalidate computed paths. Code modifying Vertices, Edges or
+	 * Subnets in place must bump it as well.
+	 */
+	uint64_t generation;
+	struct ls_graph graph;		/* See ls_ted_graph() */
 };
 
 /* Generic Link State Element */
@@ -756,6 +807,18 @@ extern void ls_ted_del_all(struct ls_ted **ted);
  */
 extern void ls_ted_clean(struct ls_ted *ted);
 
+/**
+ * Get the compact graph of the TED, building it again if the TED has been
+ * modified since the last call, i.e. if its generation has changed. Vertices
+ * index are only valid until the next modification of the TED. Edges without
+ * destination or attributes are not part of the graph.
+ *
+ * @param ted	Link State Data Base
+ *
+ * @return	Graph of the TED
+ */
+extern const struct ls_graph *ls_ted_graph(struct ls_ted *ted);
+
 /**
  * Connect Source and Destination Vertices by given Edge. Only non NULL source
  * and destination vertices are connected.
@@ -1021,6 +1084,12 @@ extern struct ls_element *ls_stream2ted(struct ls_ted *ted, struct stream *s,
  * This function must be used when a daemon request a Link State Data Base
  * Synchronization.
  *
+ * The content is sent in chunks from a background walk of the TED, so a
+ * large TED doesn't block the daemon.  Elements changed during the walk
+ * are sent again as usual, those not walked yet are sent in their current
+ * state.  A new request from a destination still being synchronized
+ * restarts its walk.
+ *
  * @param ted		Link State Data Base. Must not be NULL
  * @param zclient	Zebra Client. Must not be NULL
  * @param dst		Destination FRR daemon. Must not be NULL
@@ -25,8 +25,8 @@
 #include "memory.h"
 #include "libfrr_trace.h"
 
-DEFINE_MTYPE_STATIC(LIB, LINK_LIST, "Link List");
-DEFINE_MTYPE_STATIC(LIB, LINK_NODE, "Link Node");
+DEFINE_MTYPE_POOL_STATIC(LIB, LINK_LIST, "Link List");
+DEFINE_MTYPE_POOL_STATIC(LIB, LINK_NODE, "Link Node");
 
 /* these *do not* cleanup list nodes and referenced data, as the functions
  * do - these macros simply {de,at}tach a listnode from/to a list.
@@ -17,6 +17,7 @@
 #include <zebra.h>
 
 #include <stdlib.h>
+#include <pthread.h>
 #ifdef HAVE_MALLOC_H
 #include <malloc.h>
 #endif
@@ -81,6 +82,9 @@ static inline void mt_count_free(struct memtype *mt, void *ptr)
 {
 	frrtrace(2, frr_libfrr, memfree, mt, ptr);
 
+	if (atomic_load_explicit(&mt->tracked, memory_order_relaxed))
+		qmem_track_free(mt, ptr);
+
 	assert(mt->n_alloc);
 	atomic_fetch_sub_explicit(&mt->n_alloc, 1, memory_order_relaxed);
 
@@ -91,7 +95,117 @@ static inline void mt_count_free(struct memtype *mt, void *ptr)
 #endif
 }
 
-static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
+/*
+ * Per-pthread cache of freed objects for DEFINE_MTYPE_POOL types.
+ *
+ * Objects are still individually malloc()ed, cached objects are simply not
+ * given back to free() and are reused by the next allocation of the same
+ * type on the same pthread that roughly matches their size.  This avoids the allocator's
+ * locking and bookkeeping for types churning at a high rate, and keeps
+ * handing out the same chunks instead of fragmenting the heap.  Cached
+ * objects are not counted as allocated.
+ *
+ * Needs malloc_usable_size() to tell whether a cached object fits, and is
+ * disabled under AddressSanitizer, to not hide use-after-free bugs.
+ */
+#if defined(HAVE_MALLOC_USABLE_SIZE) && !defined(__SANITIZE_ADDRESS__)        \
+	&& !defined(__OpenBSD__)
+#define MT_POOL 1
+
+#define MT_POOL_MAX	32	/* number of types that can be pooled */
+#define MT_POOL_DEPTH	1024	/* objects cached per type and pthread */
+
+struct mt_pool {
+	void *head;
+	unsigned int count;
+};
+
+static unsigned int mt_pool_num;
+static pthread_key_t mt_pool_key;
+static bool mt_pool_finished;
+
+static __thread struct mt_pool mt_pools[MT_POOL_MAX];
+static __thread bool mt_pool_armed;
+
+static void mt_pool_flush(void *arg)
+{
+	struct mt_pool *pools = arg;
+	struct mt_pool *pool;
+	void *ptr;
+
+	for (pool = pools; pool < pools + MT_POOL_MAX; pool++) {
+		while ((ptr = pool->head)) {
+			pool->head = *(void **)ptr;
+			free(ptr);
+		}
+		pool->count = 0;
+	}
+	mt_pool_armed = false;
+}
+
+static void mt_pool_init(void) __attribute__((_CONSTRUCTOR(1000)));
+static void mt_pool_init(void)
+{
+	/* drops the cache of exiting pthreads */
+	pthread_key_create(&mt_pool_key, mt_pool_flush);
+}
+
+static void mt_pool_fini(void) __attribute__((_DESTRUCTOR(1000)));
+static void mt_pool_fini(void)
+{
+	mt_pool_finished = true;
+	mt_pool_flush(mt_pools);
+}
+
+static inline void *mt_pool_get(struct memtype *mt, size_t size)
+{
+	struct mt_pool *pool = &mt_pools[mt->pool_idx - 1];
+	void *ptr = pool->head;
+	size_t usable;
+
+	if (!ptr)
+		return NULL;
+
+	/* don't waste a large object on a small allocation either */
+	usable = malloc_usable_size(ptr);
+	if (usable < size || usable / 2 > size)
+		return NULL;
+
+	pool->head = *(void **)ptr;
+	pool->count--;
+	return ptr;
+}
+
+static inline bool mt_pool_put(struct memtype *mt, void *ptr)
+{
+	struct mt_pool *pool = &mt_pools[mt->pool_idx - 1];
+
+	if (pool->count >= MT_POOL_DEPTH || mt_pool_finished)
+		return false;
+
+	if (!mt_pool_armed) {
+		pthread_setspecific(mt_pool_key, mt_pools);
+		mt_pool_armed = true;
+	}
+
+	*(void **)ptr = pool->head;
+	pool->head = ptr;
+	pool->count++;
+	return true;
+}
+#endif /* MT_POOL */
+
+void qmem_pool_register(struct memtype *mt)
+{
+#ifdef MT_POOL
+	/* called from constructors, i.e. before any pthread is started */
+	if (mt_pool_num < MT_POOL_MAX)
+		mt->pool_idx = ++mt_pool_num;
+#endif
+}
+
+static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size,
+				  const void *caller)
 {
 	frrtrace(3, frr_libfrr, memalloc, mt, ptr, size);
 
@@ -103,29 +217,49 @@ static inline void *mt_checkalloc(struct memtype *mt, void *ptr, size_t size)
 		return NULL;
 	}
 	mt_count_alloc(mt, size, ptr);
+	if (atomic_load_explicit(&mt->tracked, memory_order_relaxed))
+		qmem_track_alloc(mt, ptr, size, caller);
 	return ptr;
 }
 
+/* the q*() functions are never inlined, this is their caller */
+#define MT_CALLER __builtin_return_address(0)
+
 void *qmalloc(struct memtype *mt, size_t size)
 {
-	return mt_checkalloc(mt, malloc(size), size);
+#ifdef MT_POOL
+	void *ptr;
+
+	if (mt->pool_idx && (ptr = mt_pool_get(mt, size)))
+		return mt_checkalloc(mt, ptr, size, MT_CALLER);
+#endif
+	return mt_checkalloc(mt, malloc(size), size, MT_CALLER);
 }
 
 void *qcalloc(struct memtype *mt, size_t size)
 {
-	return mt_checkalloc(mt, calloc(size, 1), size);
+#ifdef MT_POOL
+	void *ptr;
+
+	if (mt->pool_idx && (ptr = mt_pool_get(mt, size)))
+		return mt_checkalloc(mt, memset(ptr, 0, size), size,
+				     MT_CALLER);
+#endif
+	return mt_checkalloc(mt, calloc(size, 1), size, MT_CALLER);
 }
 
 void *qrealloc(struct memtype *mt, void *ptr, size_t size)
 {
 	if (ptr)
 		mt_count_free(mt, ptr);
-	return mt_checkalloc(mt, ptr ? realloc(ptr, size) : malloc(size), size);
+	return mt_checkalloc(mt, ptr ? realloc(ptr, size) : malloc(size), size,
+			     MT_CALLER);
 }
 
 void *qstrdup(struct memtype *mt, const char *str)
 {
-	return str ? mt_checkalloc(mt, strdup(str), strlen(str) + 1) : NULL;
+	return str ? mt_checkalloc(mt, strdup(str), strlen(str) + 1, MT_CALLER)
+		   : NULL;
 }
 
 void qcountfree(struct memtype *mt, void *ptr)
@@ -136,8 +270,14 @@ void qcountfree(struct memtype *mt, void *ptr)
 
 void qfree(struct memtype *mt, void *ptr)
 {
-	if (ptr)
-		mt_count_free(mt, ptr);
+	if (!ptr)
+		return;
+
+	mt_count_free(mt, ptr);
+#ifdef MT_POOL
+	if (mt->pool_idx && mt_pool_put(mt, ptr))
+		return;
+#endif
 	free(ptr);
 }
 
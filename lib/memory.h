@@ -43,6 +43,13 @@ struct memtype {
 	atomic_size_t total;
 	atomic_size_t max_size;
 #endif
+	/* freed objects are kept in a per-pthread cache, see DEFINE_MTYPE_POOL
+	 * pool_idx is assigned at startup, 0 if the type is not cached
+	 */
+	bool pooled;
+	unsigned int pool_idx;
+	/* allocation sites are recorded, see "debug memory track" */
+	atomic_bool tracked;
 };
 
 struct memgroup {
@@ -115,7 +122,7 @@ struct memgroup {
 	extern struct memtype MTYPE_##name[1]                                  \
 	/* end */
 
-#define DEFINE_MTYPE_ATTR(group, mname, attr, desc)                            \
+#define _DEFINE_MTYPE(group, mname, attr, desc, ...)                           \
 	attr struct memtype MTYPE_##mname[1]                                   \
 		__attribute__((section(".data.mtypes"))) = { {                 \
 			.name = desc,                                          \
@@ -123,6 +130,7 @@ struct memgroup {
 			.n_alloc = 0,                                          \
 			.size = 0,                                             \
 			.ref = NULL,                                           \
+			__VA_ARGS__                                            \
 	} };                                                                   \
 	static void _mtinit_##mname(void) __attribute__((_CONSTRUCTOR(1001))); \
 	static void _mtinit_##mname(void)                                      \
@@ -132,6 +140,8 @@ struct memgroup {
 		MTYPE_##mname->ref = _mg_##group.insert;                       \
 		*_mg_##group.insert = MTYPE_##mname;                           \
 		_mg_##group.insert = &MTYPE_##mname->next;                      \
+		if (MTYPE_##mname->pooled)                                     \
+			qmem_pool_register(MTYPE_##mname);                     \
 	}                                                                      \
 	static void _mtfini_##mname(void) __attribute__((_DESTRUCTOR(1001)));  \
 	static void _mtfini_##mname(void)                                      \
@@ -142,6 +152,10 @@ struct memgroup {
 	}                                                                      \
 	MACRO_REQUIRE_SEMICOLON() /* end */
 
+#define DEFINE_MTYPE_ATTR(group, mname, attr, desc)                            \
+	_DEFINE_MTYPE(group, mname, attr, desc, )                              \
+	/* end */
+
 #define DEFINE_MTYPE(group, name, desc)                                        \
 	DEFINE_MTYPE_ATTR(group, name, , desc)                                 \
 	/* end */
@@ -150,9 +164,29 @@ struct memgroup {
 	DEFINE_MTYPE_ATTR(group, name, static, desc)                           \
 	/* end */
 
+/* for hot, mostly fixed size types: freed objects are cached per pthread
+ * and handed out again by the next allocation, instead of going through
+ * free() and malloc().
+ */
+#define DEFINE_MTYPE_POOL(group, name, desc)                                   \
+	_DEFINE_MTYPE(group, name, , desc, .pooled = true)                     \
+	/* end */
+
+#define DEFINE_MTYPE_POOL_STATIC(group, name, desc)                            \
+	_DEFINE_MTYPE(group, name, static, desc, .pooled = true)               \
+	/* end */
+
 DECLARE_MGROUP(LIB);
 DECLARE_MTYPE(TMP);
 
+/* internal, used by DEFINE_MTYPE_POOL */
+extern void qmem_pool_register(struct memtype *mt);
+
+/* internal, allocation site tracking in memtrack.c */
+extern void qmem_track_alloc(struct memtype *mt, void *ptr, size_t size,
+			     const void *caller);
+extern void qmem_track_free(struct memtype *mt, void *ptr);
+
 
 extern void *qmalloc(struct memtype *mt, size_t size)
 	__attribute__((malloc, _ALLOC_SIZE(2), nonnull(1) _RET_NONNULL));
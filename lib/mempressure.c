@@ -0,0 +1,475 @@
+/*
+ * Memory pressure monitoring
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "frratomic.h"
+#include "hook.h"
+#include "json.h"
+#include "lib_errors.h"
+#include "libfrr.h"
+#include "mempressure.h"
+#include "monotime.h"
+#include "thread.h"
+#include "vty.h"
+
+#include "lib/mempressure_clippy.c"
+
+DEFINE_HOOK(mempressure_change,
+	    (enum mempressure_level level, enum mempressure_level prev),
+	    (level, prev));
+
+#define MP_POLL_INTERVAL 1
+
+#define MP_DEFAULT_MODERATE 80
+#define MP_DEFAULT_CRITICAL 95
+
+/* percentage points a level's threshold is lowered by to leave it again */
+#define MP_HYSTERESIS 5
+
+/*
+ * PSI avg10 percentages: "some" is time at least one task of the cgroup
+ * stalled on memory, "full" is time all of them did, i.e. the cgroup was
+ * spending its time in reclaim instead of doing work.  Leaving a level
+ * takes the figure to drop below half the threshold.
+ */
+#define MP_PSI_SOME_MODERATE 10.0
+#define MP_PSI_FULL_CRITICAL 10.0
+
+#define MP_CGROUP_ROOT "/sys/fs/cgroup"
+
+static struct mempressure {
+	bool enabled;
+	/* bytes of resident memory, 0 if not configured */
+	uint64_t limit;
+	unsigned int moderate, critical;
+
+	/* "debug memory pressure simulate", -1 if not */
+	int simulate;
+
+	struct thread_master *master;
+	struct thread *t_poll;
+
+	/* cgroup v2 directory of the daemon, empty if none or the root */
+	char cgroup[PATH_MAX];
+
+	/* last sample; 0 / negative if not available */
+	uint64_t rss;
+	uint64_t cg_current, cg_max;
+	double psi_some, psi_full;
+
+	struct timeval since;
+	uint64_t entered[MEMPRESSURE_CRITICAL + 1];
+} mp = {
+	.moderate = MP_DEFAULT_MODERATE,
+	.critical = MP_DEFAULT_CRITICAL,
+	.simulate = -1,
+	.psi_some = -1.0,
+	.psi_full = -1.0,
+};
+
+/* read from other pthreads through mempressure_level() */
+static atomic_uint mp_level;
+
+static const char *const mp_level_names[] = {
+	[MEMPRESSURE_NONE] = "none",
+	[MEMPRESSURE_MODERATE] = "moderate",
+	[MEMPRESSURE_CRITICAL] = "critical",
+};
+
+enum mempressure_level mempressure_level(void)
+{
+	return atomic_load_explicit(&mp_level, memory_order_relaxed);
+}
+
+const char *mempressure_level_str(enum mempressure_level level)
+{
+	if (level > MEMPRESSURE_CRITICAL)
+		return "unknown";
+	return mp_level_names[level];
+}
+
+static ssize_t mp_read_file(const char *path, char *buf, size_t size)
+{
+	ssize_t len;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return -1;
+	len = read(fd, buf, size - 1);
+	close(fd);
+
+	if (len < 0)
+		return -1;
+	buf[len] = '\0';
+	return len;
+}
+
+static void mp_cgroup_find(void)
+{
+	char buf[PATH_MAX + 64], *pos, *end;
+
+	mp.cgroup[0] = '\0';
+
+	/* unified hierarchy entry is "0::/path" */
+	if (mp_read_file("/proc/self/cgroup", buf, sizeof(buf)) <= 0)
+		return;
+
+	pos = strstr(buf, "0::/");
+	if (!pos || (pos != buf && pos[-1] != '\n'))
+		return;
+	pos += 3;
+	end = strchr(pos, '\n');
+	if (end)
+		*end = '\0';
+
+	/* the root cgroup has no limit and its PSI figures are system wide */
+	if (!strcmp(pos, "/"))
+		return;
+
+	snprintf(mp.cgroup, sizeof(mp.cgroup), MP_CGROUP_ROOT "%s", pos);
+}
+
+static uint64_t mp_cgroup_read(const char *file)
+{
+	char path[PATH_MAX + 32], buf[64];
+
+	snprintf(path, sizeof(path), "%s/%s", mp.cgroup, file);
+	if (mp_read_file(path, buf, sizeof(buf)) <= 0)
+		return 0;
+	/* memory.max reads "max" when unlimited, which parses as 0 */
+	return strtoull(buf, NULL, 10);
+}
+
+static void mp_sample(void)
+{
+	char path[PATH_MAX + 32], buf[256], *pos;
+	unsigned long long pages;
+
+	mp.rss = 0;
+	if (mp_read_file("/proc/self/statm", buf, sizeof(buf)) > 0
+	    && sscanf(buf, "%*u %llu", &pages) == 1)
+		mp.rss = pages * sysconf(_SC_PAGESIZE);
+
+	mp.cg_current = mp.cg_max = 0;
+	mp.psi_some = mp.psi_full = -1.0;
+	if (!mp.cgroup[0])
+		return;
+
+	mp.cg_current = mp_cgroup_read("memory.current");
+	mp.cg_max = mp_cgroup_read("memory.max");
+
+	snprintf(path, sizeof(path), "%s/memory.pressure", mp.cgroup);
+	if (mp_read_file(path, buf, sizeof(buf)) <= 0)
+		return;
+	if ((pos = strstr(buf, "some avg10=")))
+		mp.psi_some = strtod(pos + strlen("some avg10="), NULL);
+	if ((pos = strstr(buf, "full avg10=")))
+		mp.psi_full = strtod(pos + strlen("full avg10="), NULL);
+}
+
+static enum mempressure_level mp_level_usage(uint64_t used, uint64_t max,
+					     enum mempressure_level cur)
+{
+	unsigned int moderate = mp.moderate, critical = mp.critical;
+	uint64_t pct;
+
+	if (!used || !max)
+		return MEMPRESSURE_NONE;
+
+	if (cur >= MEMPRESSURE_CRITICAL && critical > MP_HYSTERESIS)
+		critical -= MP_HYSTERESIS;
+	if (cur >= MEMPRESSURE_MODERATE && moderate > MP_HYSTERESIS)
+		moderate -= MP_HYSTERESIS;
+
+	pct = used * 100 / max;
+	if (pct >= critical)
+		return MEMPRESSURE_CRITICAL;
+	if (pct >= moderate)
+		return MEMPRESSURE_MODERATE;
+	return MEMPRESSURE_NONE;
+}
+
+static enum mempressure_level mp_level_psi(enum mempressure_level cur)
+{
+	double some = MP_PSI_SOME_MODERATE, full = MP_PSI_FULL_CRITICAL;
+
+	if (cur >= MEMPRESSURE_CRITICAL)
+		full /= 2;
+	if (cur >= MEMPRESSURE_MODERATE)
+		some /= 2;
+
+	if (mp.psi_full >= full)
+		return MEMPRESSURE_CRITICAL;
+	if (mp.psi_some >= some)
+		return MEMPRESSURE_MODERATE;
+	return MEMPRESSURE_NONE;
+}
+
+static void mp_update(void)
+{
+	enum mempressure_level prev = mempressure_level(), level;
+
+	mp_sample();
+
+	if (mp.simulate >= 0)
+		level = mp.simulate;
+	else if (!mp.enabled)
+		level = MEMPRESSURE_NONE;
+	else {
+		level = mp_level_usage(mp.rss, mp.limit, prev);
+		level = MAX(level, mp_level_usage(mp.cg_current, mp.cg_max,
+						  prev));
+		level = MAX(level, mp_level_psi(prev));
+	}
+
+	if (level != prev) {
+		atomic_store_explicit(&mp_level, level, memory_order_relaxed);
+		monotime(&mp.since);
+		mp.entered[level]++;
+
+		if (level > prev)
+			flog_warn(EC_LIB_MEMORY_PRESSURE,
+				  "Memory pressure %s (resident %" PRIu64
+				  " MB, cgroup %" PRIu64 "/%" PRIu64
+				  " MB, PSI some %.2f full %.2f)",
+				  mempressure_level_str(level),
+				  mp.rss >> 20, mp.cg_current >> 20,
+				  mp.cg_max >> 20, mp.psi_some, mp.psi_full);
+		else
+			zlog_info("Memory pressure down to %s",
+				  mempressure_level_str(level));
+	}
+
+	if (level != prev || level == MEMPRESSURE_CRITICAL)
+		hook_call(mempressure_change, level, prev);
+}
+
+static void mp_poll(struct thread *thread)
+{
+	mp_update();
+
+	if (mp.enabled || mp.simulate >= 0)
+		thread_add_timer(mp.master, mp_poll, NULL, MP_POLL_INTERVAL,
+				 &mp.t_poll);
+}
+
+/* (re)start sampling after a configuration change */
+static void mp_restart(void)
+{
+	THREAD_OFF(mp.t_poll);
+
+	if (mp.enabled)
+		mp_cgroup_find();
+	mp_update();
+
+	if (mp.master && (mp.enabled || mp.simulate >= 0))
+		thread_add_timer(mp.master, mp_poll, NULL, MP_POLL_INTERVAL,
+				 &mp.t_poll);
+}
+
+DEFPY (service_memory_pressure,
+       service_memory_pressure_cmd,
+       "[no] service memory-pressure [limit (1-4194304)$mb]",
+       NO_STR
+       "Set up miscellaneous service\n"
+       "Monitor memory pressure and notify protocols about it\n"
+       "Resident memory limit for this daemon\n"
+       "Limit in megabytes\n")
+{
+	mp.enabled = !no;
+	mp.limit = (!no && mb_str) ? (uint64_t)mb << 20 : 0;
+
+	mp_restart();
+	return CMD_SUCCESS;
+}
+
+DEFPY (service_memory_pressure_threshold,
+       service_memory_pressure_threshold_cmd,
+       "[no] service memory-pressure threshold ![moderate (1-100)$moderate critical (1-100)$critical]",
+       NO_STR
+       "Set up miscellaneous service\n"
+       "Monitor memory pressure and notify protocols about it\n"
+       "Usage thresholds, in percent of the limit\n"
+       "Moderate pressure threshold\n"
+       "Percent of the limit\n"
+       "Critical pressure threshold\n"
+       "Percent of the limit\n")
+{
+	if (no) {
+		mp.moderate = MP_DEFAULT_MODERATE;
+		mp.critical = MP_DEFAULT_CRITICAL;
+		return CMD_SUCCESS;
+	}
+
+	if (moderate > critical) {
+		vty_out(vty,
+			"%% Moderate threshold must not exceed the critical one\n");
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+
+	mp.moderate = moderate;
+	mp.critical = critical;
+	return CMD_SUCCESS;
+}
+
+DEFPY (debug_memory_pressure_simulate,
+       debug_memory_pressure_simulate_cmd,
+       "[no] debug memory pressure simulate ![<none|moderate|critical>$level]",
+       NO_STR
+       DEBUG_STR
+       "Memory allocation debugging\n"
+       "Memory pressure monitoring\n"
+       "Pretend to be under memory pressure, to test the reactions to it\n"
+       "No pressure\n"
+       "Moderate pressure\n"
+       "Critical pressure\n")
+{
+	if (no)
+		mp.simulate = -1;
+	else if (!strcmp(level, "critical"))
+		mp.simulate = MEMPRESSURE_CRITICAL;
+	else if (!strcmp(level, "moderate"))
+		mp.simulate = MEMPRESSURE_MODERATE;
+	else
+		mp.simulate = MEMPRESSURE_NONE;
+
+	mp_restart();
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_memory_pressure,
+       show_memory_pressure_cmd,
+       "show memory pressure [json$uj]",
+       SHOW_STR
+       "Memory statistics\n"
+       "Memory pressure monitoring\n"
+       JSON_STR)
+{
+	enum mempressure_level level = mempressure_level();
+	int64_t secs = 0;
+
+	if (mp.since.tv_sec)
+		secs = monotime_since(&mp.since, NULL) / 1000000;
+
+	if (uj) {
+		json_object *json = json_object_new_object();
+
+		json_object_boolean_add(json, "enabled", mp.enabled);
+		json_object_string_add(json, "level",
+				       mempressure_level_str(level));
+		json_object_int_add(json, "levelSecs", secs);
+		json_object_boolean_add(json, "simulated", mp.simulate >= 0);
+		json_object_int_add(json, "moderatePercent", mp.moderate);
+		json_object_int_add(json, "criticalPercent", mp.critical);
+		json_object_int_add(json, "residentBytes", mp.rss);
+		json_object_int_add(json, "limitBytes", mp.limit);
+		if (mp.cgroup[0]) {
+			json_object_string_add(json, "cgroup", mp.cgroup);
+			json_object_int_add(json, "cgroupCurrentBytes",
+					    mp.cg_current);
+			json_object_int_add(json, "cgroupMaxBytes", mp.cg_max);
+		}
+		if (mp.psi_some >= 0)
+			json_object_double_add(json, "psiSomeAvg10",
+					       mp.psi_some);
+		if (mp.psi_full >= 0)
+			json_object_double_add(json, "psiFullAvg10",
+					       mp.psi_full);
+		json_object_int_add(json, "moderateCount",
+				    mp.entered[MEMPRESSURE_MODERATE]);
+		json_object_int_add(json, "criticalCount",
+				    mp.entered[MEMPRESSURE_CRITICAL]);
+		vty_json(vty, json);
+		return CMD_SUCCESS;
+	}
+
+	if (!mp.enabled && mp.simulate < 0) {
+		vty_out(vty, "Memory pressure monitoring is disabled\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Memory pressure: %s%s, for %" PRId64 " seconds\n",
+		mempressure_level_str(level),
+		mp.simulate >= 0 ? " (simulated)" : "", secs);
+	vty_out(vty, "Thresholds: moderate %u%%, critical %u%%\n", mp.moderate,
+		mp.critical);
+	vty_out(vty, "Resident memory: %" PRIu64 " MB", mp.rss >> 20);
+	if (mp.limit)
+		vty_out(vty, " of %" PRIu64 " MB", mp.limit >> 20);
+	vty_out(vty, "\n");
+	if (mp.cgroup[0]) {
+		vty_out(vty, "cgroup %s: %" PRIu64 " MB", mp.cgroup,
+			mp.cg_current >> 20);
+		if (mp.cg_max)
+			vty_out(vty, " of %" PRIu64 " MB", mp.cg_max >> 20);
+		vty_out(vty, "\n");
+	}
+	if (mp.psi_some >= 0)
+		vty_out(vty, "PSI avg10: some %.2f%%, full %.2f%%\n",
+			mp.psi_some, mp.psi_full);
+	vty_out(vty, "Entered moderate %" PRIu64 " times, critical %" PRIu64
+		" times\n", mp.entered[MEMPRESSURE_MODERATE],
+		mp.entered[MEMPRESSURE_CRITICAL]);
+
+	return CMD_SUCCESS;
+}
+
+void mempressure_config_write(struct vty *vty)
+{
+	if (mp.enabled) {
+		if (mp.limit)
+			vty_out(vty, "service memory-pressure limit %" PRIu64
+				"\n", mp.limit >> 20);
+		else
+			vty_out(vty, "service memory-pressure\n");
+	}
+
+	if (mp.moderate != MP_DEFAULT_MODERATE
+	    || mp.critical != MP_DEFAULT_CRITICAL)
+		vty_out(vty,
+			"service memory-pressure threshold moderate %u critical %u\n",
+			mp.moderate, mp.critical);
+}
+
+static int mp_late_init(struct thread_master *master)
+{
+	mp.master = master;
+	mp_restart();
+	return 0;
+}
+
+static int mp_fini(void)
+{
+	THREAD_OFF(mp.t_poll);
+	return 0;
+}
+
+void mempressure_cmd_init(void)
+{
+	hook_register(frr_late_init, mp_late_init);
+	hook_register(frr_fini, mp_fini);
+
+	install_element(VIEW_NODE, &show_memory_pressure_cmd);
+	install_element(ENABLE_NODE, &debug_memory_pressure_simulate_cmd);
+	install_element(CONFIG_NODE, &service_memory_pressure_cmd);
+	install_element(CONFIG_NODE, &service_memory_pressure_threshold_cmd);
+}
@@ -0,0 +1,64 @@
+/*
+ * Memory pressure monitoring
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_MEMPRESSURE_H
+#define _FRR_MEMPRESSURE_H
+
+#include "hook.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum mempressure_level {
+	MEMPRESSURE_NONE = 0,
+	/* getting close to the limit, stop growing if possible */
+	MEMPRESSURE_MODERATE,
+	/* about to run out, shed state before the OOM killer does it */
+	MEMPRESSURE_CRITICAL,
+};
+
+/*
+ * With "service memory-pressure" configured, the daemon's memory use is
+ * sampled every second against the configured limit, the cgroup v2
+ * memory.max of the daemon and the cgroup's PSI memory stall figures.
+ *
+ * The hook is called on the main pthread whenever the level changes, and
+ * again on every sample (with level == prev) while the level is critical,
+ * so that users can escalate if what they did so far was not enough.
+ * Users are expected to rate limit their own actions.
+ */
+DECLARE_HOOK(mempressure_change,
+	     (enum mempressure_level level, enum mempressure_level prev),
+	     (level, prev));
+
+/* Current level; can be called from any pthread */
+extern enum mempressure_level mempressure_level(void);
+extern const char *mempressure_level_str(enum mempressure_level level);
+
+struct vty;
+
+extern void mempressure_config_write(struct vty *vty);
+extern void mempressure_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MEMPRESSURE_H */
@@ -0,0 +1,513 @@
+/*
+ * Allocation site tracking for selected memory types
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <dlfcn.h>
+
+#include "command.h"
+#include "hook.h"
+#include "jhash.h"
+#include "json.h"
+#include "libfrr.h"
+#include "memory.h"
+#include "memtrack.h"
+#include "monotime.h"
+#include "thread.h"
+#include "typesafe.h"
+#include "vty.h"
+
+#include "lib/memtrack_clippy.c"
+
+DEFINE_MTYPE_STATIC(LIB, MEMTRACK, "Allocation site tracking");
+
+/*
+ * Every live allocation of a tracked type has an entry in memtrack_allocs,
+ * pointing at the (type, caller) site that made it.  Both hashes are under
+ * memtrack_mtx.  Any allocation made while holding it, e.g. for the hashes
+ * themselves, is not tracked: memtrack_busy makes the hooks return early.
+ */
+PREDECL_HASH(memtrack_sites);
+PREDECL_HASH(memtrack_allocs);
+
+struct memtrack_site {
+	struct memtrack_sites_item item;
+
+	struct memtype *mt;
+	const void *caller;
+
+	size_t count, bytes;
+	/* as of the last snapshot */
+	size_t snap_count, snap_bytes;
+};
+
+struct memtrack_alloc {
+	struct memtrack_allocs_item item;
+
+	const void *ptr;
+	size_t size;
+	struct memtrack_site *site;
+};
+
+static int memtrack_site_cmp(const struct memtrack_site *a,
+			     const struct memtrack_site *b)
+{
+	if (a->mt != b->mt)
+		return a->mt < b->mt ? -1 : 1;
+	if (a->caller != b->caller)
+		return a->caller < b->caller ? -1 : 1;
+	return 0;
+}
+
+static uint32_t memtrack_site_hash(const struct memtrack_site *a)
+{
+	return jhash_2words((uintptr_t)a->mt, (uintptr_t)a->caller,
+			    0x6d747273);
+}
+
+DECLARE_HASH(memtrack_sites, struct memtrack_site, item, memtrack_site_cmp,
+	     memtrack_site_hash);
+
+static int memtrack_alloc_cmp(const struct memtrack_alloc *a,
+			      const struct memtrack_alloc *b)
+{
+	return numcmp((uintptr_t)a->ptr, (uintptr_t)b->ptr);
+}
+
+static uint32_t memtrack_alloc_hash(const struct memtrack_alloc *a)
+{
+	uintptr_t p = (uintptr_t)a->ptr;
+
+	return jhash_2words(p, (uint64_t)p >> 32, 0x6d747261);
+}
+
+DECLARE_HASH(memtrack_allocs, struct memtrack_alloc, item,
+	     memtrack_alloc_cmp, memtrack_alloc_hash);
+
+static pthread_mutex_t memtrack_mtx = PTHREAD_MUTEX_INITIALIZER;
+static struct memtrack_sites_head memtrack_sites[1];
+static struct memtrack_allocs_head memtrack_allocs[1];
+static __thread bool memtrack_busy;
+
+static struct timeval memtrack_snap_time;
+static unsigned int memtrack_interval;
+static struct thread_master *memtrack_master;
+static struct thread *memtrack_t_snap;
+
+#define MEMTRACK_LOG_TOP 10
+
+static void memtrack_lock(void)
+{
+	memtrack_busy = true;
+	pthread_mutex_lock(&memtrack_mtx);
+}
+
+static void memtrack_unlock(void)
+{
+	pthread_mutex_unlock(&memtrack_mtx);
+	memtrack_busy = false;
+}
+
+void qmem_track_alloc(struct memtype *mt, void *ptr, size_t size,
+		      const void *caller)
+{
+	struct memtrack_site ref = { .mt = mt, .caller = caller }, *site;
+	struct memtrack_alloc *alloc;
+
+	if (memtrack_busy)
+		return;
+
+	memtrack_lock();
+
+	/* tracking may have been turned off since the check */
+	if (!atomic_load_explicit(&mt->tracked, memory_order_relaxed)) {
+		memtrack_unlock();
+		return;
+	}
+
+	site = memtrack_sites_find(memtrack_sites, &ref);
+	if (!site) {
+		site = XCALLOC(MTYPE_MEMTRACK, sizeof(*site));
+		*site = ref;
+		memtrack_sites_add(memtrack_sites, site);
+	}
+	site->count++;
+	site->bytes += size;
+
+	alloc = XMALLOC(MTYPE_MEMTRACK, sizeof(*alloc));
+	alloc->ptr = ptr;
+	alloc->size = size;
+	alloc->site = site;
+	memtrack_allocs_add(memtrack_allocs, alloc);
+
+	memtrack_unlock();
+}
+
+void qmem_track_free(struct memtype *mt, void *ptr)
+{
+	struct memtrack_alloc ref = { .ptr = ptr }, *alloc;
+
+	if (memtrack_busy)
+		return;
+
+	memtrack_lock();
+
+	/* not found if allocated before tracking was turned on */
+	alloc = memtrack_allocs_find(memtrack_allocs, &ref);
+	if (alloc) {
+		memtrack_allocs_del(memtrack_allocs, alloc);
+		alloc->site->count--;
+		alloc->site->bytes -= alloc->size;
+		XFREE(MTYPE_MEMTRACK, alloc);
+	}
+
+	memtrack_unlock();
+}
+
+static void memtrack_untrack(struct memtype *mt)
+{
+	struct memtrack_alloc *alloc;
+	struct memtrack_site *site;
+
+	atomic_store_explicit(&mt->tracked, false, memory_order_relaxed);
+
+	memtrack_lock();
+
+	frr_each_safe (memtrack_allocs, memtrack_allocs, alloc) {
+		if (alloc->site->mt != mt)
+			continue;
+		memtrack_allocs_del(memtrack_allocs, alloc);
+		XFREE(MTYPE_MEMTRACK, alloc);
+	}
+	frr_each_safe (memtrack_sites, memtrack_sites, site) {
+		if (site->mt != mt)
+			continue;
+		memtrack_sites_del(memtrack_sites, site);
+		XFREE(MTYPE_MEMTRACK, site);
+	}
+
+	memtrack_unlock();
+}
+
+/* Copy of a site, for output without holding the lock */
+struct memtrack_line {
+	const char *name;
+	const void *caller;
+	size_t count, bytes;
+	ssize_t d_count, d_bytes;
+};
+
+static int memtrack_line_cmp(const void *a, const void *b)
+{
+	const struct memtrack_line *la = a, *lb = b;
+
+	if (la->bytes != lb->bytes)
+		return la->bytes < lb->bytes ? 1 : -1;
+	return numcmp((uintptr_t)la->caller, (uintptr_t)lb->caller);
+}
+
+static int memtrack_line_dcmp(const void *a, const void *b)
+{
+	const struct memtrack_line *la = a, *lb = b;
+
+	if (la->d_bytes != lb->d_bytes)
+		return la->d_bytes < lb->d_bytes ? 1 : -1;
+	return memtrack_line_cmp(a, b);
+}
+
+/* Copy all sites and optionally take a snapshot; caller frees the array */
+static struct memtrack_line *memtrack_lines(size_t *countp, bool snapshot)
+{
+	struct memtrack_line *lines;
+	struct memtrack_site *site;
+	size_t n = 0;
+
+	memtrack_lock();
+
+	lines = XCALLOC(MTYPE_TMP, (memtrack_sites_count(memtrack_sites) + 1) *
+					   sizeof(lines[0]));
+
+	frr_each (memtrack_sites, memtrack_sites, site) {
+		lines[n].name = site->mt->name;
+		lines[n].caller = site->caller;
+		lines[n].count = site->count;
+		lines[n].bytes = site->bytes;
+		lines[n].d_count = site->count - site->snap_count;
+		lines[n].d_bytes = site->bytes - site->snap_bytes;
+		n++;
+
+		if (snapshot) {
+			site->snap_count = site->count;
+			site->snap_bytes = site->bytes;
+		}
+	}
+
+	if (snapshot)
+		monotime(&memtrack_snap_time);
+
+	memtrack_unlock();
+
+	*countp = n;
+	return lines;
+}
+
+/* "function+0x1f" if the caller can be resolved, else "binary+0x1234" */
+static const char *memtrack_caller_str(char *buf, size_t size,
+				       const void *caller)
+{
+	Dl_info info;
+	const char *file;
+
+	if (!dladdr(caller, &info) || !info.dli_fname) {
+		snprintf(buf, size, "%p", caller);
+		return buf;
+	}
+	if (info.dli_sname) {
+		snprintf(buf, size, "%s+%#tx", info.dli_sname,
+			 (const char *)caller - (const char *)info.dli_saddr);
+		return buf;
+	}
+
+	file = strrchr(info.dli_fname, '/');
+	file = file ? file + 1 : info.dli_fname;
+	snprintf(buf, size, "%s+%#tx", file,
+		 (const char *)caller - (const char *)info.dli_fbase);
+	return buf;
+}
+
+static void memtrack_snapshot(struct thread *t)
+{
+	struct memtrack_line *lines;
+	char buf[128];
+	size_t n, i;
+
+	lines = memtrack_lines(&n, true);
+
+	/* log what grew over the last interval when running periodically */
+	if (t) {
+		qsort(lines, n, sizeof(lines[0]), memtrack_line_dcmp);
+		for (i = 0; i < n && i < MEMTRACK_LOG_TOP; i++) {
+			if (lines[i].d_bytes <= 0)
+				break;
+			zlog_info("memory growth: %s at %s: %+zd allocations, %+zd bytes (now %zu, %zu bytes)",
+				  lines[i].name,
+				  memtrack_caller_str(buf, sizeof(buf),
+						      lines[i].caller),
+				  lines[i].d_count, lines[i].d_bytes,
+				  lines[i].count, lines[i].bytes);
+		}
+	}
+	XFREE(MTYPE_TMP, lines);
+
+	if (memtrack_interval && memtrack_master)
+		thread_add_timer(memtrack_master, memtrack_snapshot, NULL,
+				 memtrack_interval, &memtrack_t_snap);
+}
+
+struct memtrack_find_arg {
+	const char *name;
+	struct memtype *mt;
+	unsigned int count;
+	bool all, track;
+};
+
+static int memtrack_find_walker(void *arg, struct memgroup *mg,
+				struct memtype *mt)
+{
+	struct memtrack_find_arg *fa = arg;
+
+	if (!mt || mt == MTYPE_MEMTRACK)
+		return 0;
+	if (!fa->all && strcasecmp(mt->name, fa->name))
+		return 0;
+
+	if (fa->track)
+		atomic_store_explicit(&mt->tracked, true,
+				      memory_order_relaxed);
+	else if (atomic_load_explicit(&mt->tracked, memory_order_relaxed))
+		memtrack_untrack(mt);
+	fa->count++;
+	return 0;
+}
+
+DEFPY (debug_memory_track,
+       debug_memory_track_cmd,
+       "[no] debug memory track LINE...",
+       NO_STR
+       DEBUG_STR
+       "Memory allocation debugging\n"
+       "Record allocation sites for a memory type\n"
+       "Memory type, as displayed by \"show memory\", or \"all\"\n")
+{
+	struct memtrack_find_arg fa = { .track = !no };
+	char *name;
+	int idx = no ? 4 : 3;
+
+	name = argv_concat(argv, argc, idx);
+	fa.name = name;
+	fa.all = !strcasecmp(name, "all");
+	qmem_walk(memtrack_find_walker, &fa);
+	XFREE(MTYPE_TMP, name);
+
+	if (!fa.count) {
+		vty_out(vty, "%% No such memory type\n");
+		return CMD_WARNING;
+	}
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (debug_memory_snapshot,
+       debug_memory_snapshot_cmd,
+       "debug memory snapshot",
+       DEBUG_STR
+       "Memory allocation debugging\n"
+       "Remember current allocation site usage, for \"show memory sites diff\"\n")
+{
+	memtrack_snapshot(NULL);
+	return CMD_SUCCESS;
+}
+
+DEFPY (debug_memory_snapshot_interval,
+       debug_memory_snapshot_interval_cmd,
+       "[no] debug memory snapshot interval ![(1-86400)$secs]",
+       NO_STR
+       DEBUG_STR
+       "Memory allocation debugging\n"
+       "Remember current allocation site usage\n"
+       "Periodically, logging the sites that grew the most in between\n"
+       "Interval in seconds\n")
+{
+	THREAD_OFF(memtrack_t_snap);
+	memtrack_interval = no ? 0 : secs;
+
+	if (memtrack_interval)
+		thread_add_timer(memtrack_master, memtrack_snapshot, NULL,
+				 memtrack_interval, &memtrack_t_snap);
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_memory_sites,
+       show_memory_sites_cmd,
+       "show memory sites [diff$diff] [json$uj]",
+       SHOW_STR
+       "Memory statistics\n"
+       "Allocation sites of tracked memory types\n"
+       "Change since the last snapshot, largest growth first\n"
+       JSON_STR)
+{
+	struct memtrack_line *lines;
+	json_object *json = NULL, *json_sites = NULL, *json_site;
+	char buf[128];
+	size_t n, i;
+
+	lines = memtrack_lines(&n, false);
+	qsort(lines, n, sizeof(lines[0]),
+	      diff ? memtrack_line_dcmp : memtrack_line_cmp);
+
+	if (uj) {
+		json = json_object_new_object();
+		if (memtrack_snap_time.tv_sec)
+			json_object_int_add(
+				json, "snapshotAgeSecs",
+				monotime_since(&memtrack_snap_time, NULL) /
+					1000000);
+		json_sites = json_object_new_array();
+		json_object_object_add(json, "sites", json_sites);
+	} else {
+		if (memtrack_snap_time.tv_sec)
+			vty_out(vty, "Last snapshot %" PRId64 " seconds ago\n",
+				monotime_since(&memtrack_snap_time, NULL) /
+					1000000);
+		vty_out(vty, "%-30s %-40s %10s %12s", "Type", "Site", "Count",
+			"Bytes");
+		if (diff)
+			vty_out(vty, " %10s %12s", "+Count", "+Bytes");
+		vty_out(vty, "\n");
+	}
+
+	for (i = 0; i < n; i++) {
+		if (!lines[i].count && !lines[i].d_count)
+			continue;
+
+		memtrack_caller_str(buf, sizeof(buf), lines[i].caller);
+
+		if (uj) {
+			json_site = json_object_new_object();
+			json_object_string_add(json_site, "type",
+					       lines[i].name);
+			json_object_string_add(json_site, "site", buf);
+			json_object_int_add(json_site, "count",
+					    lines[i].count);
+			json_object_int_add(json_site, "bytes",
+					    lines[i].bytes);
+			json_object_int_add(json_site, "countDiff",
+					    lines[i].d_count);
+			json_object_int_add(json_site, "bytesDiff",
+					    lines[i].d_bytes);
+			json_object_array_add(json_sites, json_site);
+			continue;
+		}
+
+		vty_out(vty, "%-30s %-40s %10zu %12zu", lines[i].name, buf,
+			lines[i].count, lines[i].bytes);
+		if (diff)
+			vty_out(vty, " %+10zd %+12zd", lines[i].d_count,
+				lines[i].d_bytes);
+		vty_out(vty, "\n");
+	}
+
+	XFREE(MTYPE_TMP, lines);
+
+	if (uj)
+		vty_json(vty, json);
+	return CMD_SUCCESS;
+}
+
+static int memtrack_late_init(struct thread_master *master)
+{
+	memtrack_master = master;
+	return 0;
+}
+
+static int memtrack_fini(void)
+{
+	struct memtrack_find_arg fa = { .all = true };
+
+	THREAD_OFF(memtrack_t_snap);
+	qmem_walk(memtrack_find_walker, &fa);
+
+	memtrack_sites_fini(memtrack_sites);
+	memtrack_allocs_fini(memtrack_allocs);
+	return 0;
+}
+
+void memtrack_cmd_init(void)
+{
+	memtrack_sites_init(memtrack_sites);
+	memtrack_allocs_init(memtrack_allocs);
+
+	hook_register(frr_late_init, memtrack_late_init);
+	hook_register(frr_fini, memtrack_fini);
+
+	install_element(VIEW_NODE, &show_memory_sites_cmd);
+	install_element(ENABLE_NODE, &debug_memory_track_cmd);
+	install_element(ENABLE_NODE, &debug_memory_snapshot_cmd);
+	install_element(ENABLE_NODE, &debug_memory_snapshot_interval_cmd);
+}
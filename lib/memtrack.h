@@ -0,0 +1,39 @@
+/*
+ * Allocation site tracking for selected memory types
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_MEMTRACK_H
+#define _FRR_MEMTRACK_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * "debug memory track TYPE" makes qmalloc() & co. record the caller of each
+ * allocation of that memory type until it is freed, so "show memory sites"
+ * can tell which code holds the memory.  Types not tracked only pay for
+ * checking their tracked flag.
+ */
+extern void memtrack_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_MEMTRACK_H */
@@ -23,6 +23,7 @@
 #include "log.h"
 #include "lib_errors.h"
 #include "hash.h"
+#include "jhash.h"
 #include "command.h"
 #include "debug.h"
 #include "db.h"
@@ -35,6 +36,7 @@
 DEFINE_MTYPE_STATIC(LIB, NB_NODE, "Northbound Node");
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG, "Northbound Configuration");
 DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_ENTRY, "Northbound Configuration Entry");
+DEFINE_MTYPE_STATIC(LIB, NB_CONFIG_EDIT, "Northbound Configuration Edit");
 
 /* Running configuration - shouldn't be modified directly. */
 struct nb_config *running_config;
@@ -83,12 +85,11 @@ static int nb_transaction_process(enum nb_event event,
 				  char *errmsg, size_t errmsg_len);
 static void nb_transaction_apply_finish(struct nb_transaction *transaction,
 					char *errmsg, size_t errmsg_len);
+struct nb_oper_data_iter;
 static int nb_oper_data_iter_node(const struct lysc_node *snode,
 				  const char *xpath, const void *list_entry,
 				  const struct yang_list_keys *list_keys,
-				  struct yang_translator *translator,
-				  bool first, uint32_t flags,
-				  nb_oper_data_cb cb, void *arg);
+				  bool first, struct nb_oper_data_iter *it);
 
 static int nb_node_check_config_only(const struct lysc_node *snode, void *arg)
 {
@@ -258,7 +259,9 @@ static unsigned int nb_node_validate_cbs(const struct nb_node *nb_node)
 	error += nb_node_validate_cb(nb_node, NB_OP_GET_ELEM,
 				     !!nb_node->cbs.get_elem, false);
 	error += nb_node_validate_cb(nb_node, NB_OP_GET_NEXT,
-				     !!nb_node->cbs.get_next, false);
+				     nb_node->cbs.get_next
+					     || nb_node->cbs.get_next_batch,
+				     false);
 	error += nb_node_validate_cb(nb_node, NB_OP_GET_KEYS,
 				     !!nb_node->cbs.get_keys, false);
 	error += nb_node_validate_cb(nb_node, NB_OP_LOOKUP_ENTRY,
@@ -299,6 +302,152 @@ static int nb_node_validate(const struct lysc_node *snode, void *arg)
 	return YANG_ITER_CONTINUE;
 }
 
+/*
+ * Maximum number of edits tracked in a candidate configuration. Past that
+ * point diffing the edited subtrees one by one stops paying off and the
+ * candidate falls back to a full diff against the running configuration.
+ */
+#define NB_CONFIG_EDITS_MAX 10000
+
+/* Subtree edited in a candidate configuration. */
+struct nb_config_edit {
+	struct nb_config_edits_item itm;
+	struct nb_config_edits_hash_item hitm;
+
+	/* Module owning the top-level data node of the edited subtree. */
+	const struct lys_module *module;
+
+	char *xpath;
+};
+
+static int nb_config_edit_cmp(const struct nb_config_edit *a,
+			      const struct nb_config_edit *b)
+{
+	return strcmp(a->xpath, b->xpath);
+}
+
+static uint32_t nb_config_edit_hash(const struct nb_config_edit *edit)
+{
+	return string_hash_make(edit->xpath);
+}
+
+DECLARE_DLIST(nb_config_edits, struct nb_config_edit, itm);
+DECLARE_HASH(nb_config_edits_hash, struct nb_config_edit, hitm,
+	     nb_config_edit_cmp, nb_config_edit_hash);
+
+/* Drop all tracked edits and (re)start or stop change tracking. */
+static void nb_config_track_reset(struct nb_config *config, bool tracked)
+{
+	struct nb_config_edit *edit;
+
+	while ((edit = nb_config_edits_pop(&config->edits))) {
+		nb_config_edits_hash_del(&config->edits_hash, edit);
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit->xpath);
+		XFREE(MTYPE_NB_CONFIG_EDIT, edit);
+	}
+	config->tracked = tracked;
+}
+
+/*
+ * Check whether the tracked edits of a configuration fully describe how it
+ * differs from the running configuration.
+ */
+static bool nb_config_track_usable(const struct nb_config *config)
+{
+	return config->tracked && config != running_config
+	       && config->version == running_config->version;
+}
+
+static void nb_config_track_edit(struct nb_config *config, const char *xpath,
+				 const struct lys_module *module)
+{
+	struct nb_config_edit *edit, ref = {};
+
+	if (!config->tracked)
+		return;
+
+	ref.xpath = (char *)xpath;
+	if (nb_config_edits_hash_find(&config->edits_hash, &ref))
+		return;
+
+	if (nb_config_edits_count(&config->edits) >= NB_CONFIG_EDITS_MAX) {
+		nb_config_track_reset(config, false);
+		return;
+	}
+
+	edit = XCALLOC(MTYPE_NB_CONFIG_EDIT, sizeof(*edit));
+	edit->module = module;
+	edit->xpath = XSTRDUP(MTYPE_NB_CONFIG_EDIT, xpath);
+	nb_config_edits_add_tail(&config->edits, edit);
+	nb_config_edits_hash_add(&config->edits_hash, edit);
+}
+
+/* Module owning the top-level data node of the given schema node. */
+static const struct lys_module *
+nb_snode_top_module(const struct lysc_node *snode)
+{
+	while (snode->parent)
+		snode = snode->parent;
+
+	return snode->module;
+}
+
+/*
+ * Return the length of the XPath of the parent of the data node identified by
+ * the first "len" characters of "xpath", or zero for top-level nodes. Slashes
+ * inside predicates (e.g. prefix keys) are not path separators.
+ */
+static size_t nb_xpath_parent_len(const char *xpath, size_t len)
+{
+	size_t parent = 0;
+	int depth = 0;
+	char quote = 0;
+
+	for (size_t i = 0; i < len; i++) {
+		char c = xpath[i];
+
+		if (quote) {
+			if (c == quote)
+				quote = 0;
+		} else if (c == '\'' || c == '"')
+			quote = c;
+		else if (c == '[')
+			depth++;
+		else if (c == ']')
+			depth--;
+		else if (c == '/' && depth == 0 && i > 0)
+			parent = i;
+	}
+
+	return parent;
+}
+
+/* Find the data node of an edit, or its closest existing ancestor. */
+static struct lyd_node *nb_config_track_dnode(const struct nb_config *config,
+					      const char *xpath, bool *exact)
+{
+	char buf[XPATH_MAXLEN];
+	struct lyd_node *dnode;
+	size_t len;
+
+	len = strlcpy(buf, xpath, sizeof(buf));
+	if (len >= sizeof(buf))
+		return NULL;
+
+	*exact = true;
+	for (;;) {
+		dnode = yang_dnode_get(config->dnode, buf);
+		if (dnode)
+			return dnode;
+
+		len = nb_xpath_parent_len(buf, len);
+		if (!len)
+			return NULL;
+		buf[len] = '\0';
+		*exact = false;
+	}
+}
+
 struct nb_config *nb_config_new(struct lyd_node *dnode)
 {
 	struct nb_config *config;
@@ -309,6 +458,8 @@ struct nb_config *nb_config_new(struct lyd_node *dnode)
 	else
 		config->dnode = yang_dnode_new(ly_native_ctx, true);
 	config->version = 0;
+	nb_config_edits_init(&config->edits);
+	nb_config_edits_hash_init(&config->edits_hash);
 
 	return config;
 }
@@ -317,6 +468,9 @@ void nb_config_free(struct nb_config *config)
 {
 	if (config->dnode)
 		yang_dnode_free(config->dnode);
+	nb_config_track_reset(config, false);
+	nb_config_edits_hash_fini(&config->edits_hash);
+	nb_config_edits_fini(&config->edits);
 	XFREE(MTYPE_NB_CONFIG, config);
 }
 
@@ -327,6 +481,11 @@ struct nb_config *nb_config_dup(const struct nb_config *config)
 	dup = XCALLOC(MTYPE_NB_CONFIG, sizeof(*dup));
 	dup->dnode = yang_dnode_dup(config->dnode);
 	dup->version = config->version;
+	nb_config_edits_init(&dup->edits);
+	nb_config_edits_hash_init(&dup->edits_hash);
+
+	/* A copy of the running configuration starts tracking its edits. */
+	dup->tracked = (config == running_config);
 
 	return dup;
 }
@@ -339,6 +498,7 @@ int nb_config_merge(struct nb_config *config_dst, struct nb_config *config_src,
 	ret = lyd_merge_siblings(&config_dst->dnode, config_src->dnode, 0);
 	if (ret != 0)
 		flog_warn(EC_LIB_LIBYANG, "%s: lyd_merge() failed", __func__);
+	nb_config_track_reset(config_dst, false);
 
 	if (!preserve_source)
 		nb_config_free(config_src);
@@ -353,6 +513,9 @@ void nb_config_replace(struct nb_config *config_dst,
 	if (config_src->version != 0)
 		config_dst->version = config_src->version;
 
+	/* Update change tracking. */
+	nb_config_track_reset(config_dst, config_src == running_config);
+
 	/* Update dnode. */
 	if (config_dst->dnode)
 		yang_dnode_free(config_dst->dnode);
@@ -538,51 +701,17 @@ static inline void nb_config_diff_dnode_log(const char *context,
 }
 #endif
 
-/* Calculate the delta between two different configurations. */
-static void nb_config_diff(const struct nb_config *config1,
-			   const struct nb_config *config2,
-			   struct nb_config_cbs *changes)
+/* Translate a libyang diff tree into northbound configuration changes. */
+static void nb_config_diff_process(const struct lyd_node *diff,
+				   const struct nb_config *config1,
+				   const struct nb_config *config2,
+				   uint32_t *seq, struct nb_config_cbs *changes)
 {
-	struct lyd_node *diff = NULL;
 	const struct lyd_node *root, *dnode;
 	struct lyd_node *target;
 	int op;
-	LY_ERR err;
 	char *path;
 
-#if 0 /* Useful (noisy) when debugging diff code, and for improving later */
-	if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
-		LY_LIST_FOR(config1->dnode, root) {
-			LYD_TREE_DFS_BEGIN(root, dnode) {
-				nb_config_diff_dnode_log("from", dnode);
-				LYD_TREE_DFS_END(root, dnode);
-			}
-		}
-		LY_LIST_FOR(config2->dnode, root) {
-			LYD_TREE_DFS_BEGIN(root, dnode) {
-				nb_config_diff_dnode_log("to", dnode);
-				LYD_TREE_DFS_END(root, dnode);
-			}
-		}
-	}
-#endif
-
-	err = lyd_diff_siblings(config1->dnode, config2->dnode,
-				LYD_DIFF_DEFAULTS, &diff);
-	assert(!err);
-
-	if (diff && DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
-		char *s;
-
-		if (!lyd_print_mem(&s, diff, LYD_JSON,
-				   LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL)) {
-			zlog_debug("%s: %s", __func__, s);
-			free(s);
-		}
-	}
-
-	uint32_t seq = 0;
-
 	LY_LIST_FOR (diff, root) {
 		LYD_TREE_DFS_BEGIN (root, dnode) {
 			op = nb_lyd_diff_get_op(dnode);
@@ -593,7 +722,7 @@ static void nb_config_diff(const struct nb_config *config1,
 			if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
 				char context[80];
 				snprintf(context, sizeof(context),
-					 "iterating diff: oper: %c seq: %u", op, seq);
+					 "iterating diff: oper: %c seq: %u", op, *seq);
 				nb_config_diff_dnode_log_path(context, path, dnode);
 			}
 #endif
@@ -608,7 +737,7 @@ static void nb_config_diff(const struct nb_config *config1,
 				   */
 				target = yang_dnode_get(config2->dnode, path);
 				assert(target);
-				nb_config_diff_created(target, &seq, changes);
+				nb_config_diff_created(target, seq, changes);
 
 				/* Skip rest of sub-tree, move to next sibling
 				 */
@@ -617,7 +746,7 @@ static void nb_config_diff(const struct nb_config *config1,
 			case 'd': /* delete */
 				target = yang_dnode_get(config1->dnode, path);
 				assert(target);
-				nb_config_diff_deleted(target, &seq, changes);
+				nb_config_diff_deleted(target, seq, changes);
 
 				/* Skip rest of sub-tree, move to next sibling
 				 */
@@ -628,7 +757,7 @@ static void nb_config_diff(const struct nb_config *config1,
 				target = yang_dnode_get(config2->dnode, path);
 				assert(target);
 				nb_config_diff_add_change(changes, NB_OP_MODIFY,
-							  &seq, target);
+							  seq, target);
 				break;
 			case 'n': /* none */
 			default:
@@ -638,6 +767,257 @@ static void nb_config_diff(const struct nb_config *config1,
 			LYD_TREE_DFS_END(root, dnode);
 		}
 	}
+}
+
+/*
+ * Subtree that needs to be diffed, derived from an edit tracked in the
+ * candidate configuration.
+ */
+PREDECL_DLIST(nb_config_diff_roots);
+PREDECL_HASH(nb_config_diff_roots_hash);
+
+struct nb_config_diff_root {
+	struct nb_config_diff_roots_item itm;
+	struct nb_config_diff_roots_hash_item hitm;
+
+	/*
+	 * 'c': subtree only present in the candidate configuration.
+	 * 'd': subtree only present in the running configuration.
+	 * 'r': subtree present in both ("peer" is the running one).
+	 * 'n': running side of an 'r' subtree, only used for lookups.
+	 */
+	char op;
+	const struct lyd_node *dnode;
+	const struct lyd_node *peer;
+};
+
+static int nb_config_diff_root_cmp(const struct nb_config_diff_root *a,
+				   const struct nb_config_diff_root *b)
+{
+	return numcmp((uintptr_t)a->dnode, (uintptr_t)b->dnode);
+}
+
+static uint32_t nb_config_diff_root_hash(const struct nb_config_diff_root *root)
+{
+	return jhash(&root->dnode, sizeof(root->dnode), 0x4e42d1ff);
+}
+
+DECLARE_DLIST(nb_config_diff_roots, struct nb_config_diff_root, itm);
+DECLARE_HASH(nb_config_diff_roots_hash, struct nb_config_diff_root, hitm,
+	     nb_config_diff_root_cmp, nb_config_diff_root_hash);
+
+/*
+ * Climb from a node that exists only in one of the configurations to the
+ * topmost ancestor that is also missing from the other one.
+ */
+static const struct lyd_node *
+nb_config_diff_climb(const struct lyd_node *dnode,
+		     const struct lyd_node *other_tree)
+{
+	const struct lyd_node *parent;
+	char path[XPATH_MAXLEN];
+
+	while ((parent = lyd_parent(dnode))) {
+		if (!lyd_path(parent, LYD_PATH_STD, path, sizeof(path))
+		    || yang_dnode_exists(other_tree, path))
+			break;
+		dnode = parent;
+	}
+
+	return dnode;
+}
+
+static void nb_config_diff_root_add(struct nb_config_diff_roots_head *roots,
+				    struct nb_config_diff_roots_hash_head *hash,
+				    char op, const struct lyd_node *dnode,
+				    const struct lyd_node *peer)
+{
+	struct nb_config_diff_root *root, ref = {};
+
+	ref.dnode = dnode;
+	if (nb_config_diff_roots_hash_find(hash, &ref))
+		return;
+
+	root = XCALLOC(MTYPE_TMP, sizeof(*root));
+	root->op = op;
+	root->dnode = dnode;
+	root->peer = peer;
+	nb_config_diff_roots_add_tail(roots, root);
+	nb_config_diff_roots_hash_add(hash, root);
+}
+
+/* Check if an ancestor of a subtree is already going to be diffed. */
+static bool
+nb_config_diff_root_covered(struct nb_config_diff_roots_hash_head *hash,
+			    const struct lyd_node *dnode)
+{
+	struct nb_config_diff_root ref = {};
+
+	for (ref.dnode = lyd_parent(dnode); ref.dnode;
+	     ref.dnode = lyd_parent(ref.dnode)) {
+		if (nb_config_diff_roots_hash_find(hash, &ref))
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Calculate the delta between the running configuration and a candidate that
+ * tracked its edits, looking only at the edited subtrees.
+ */
+static void nb_config_diff_tracked(const struct nb_config *config1,
+				   const struct nb_config *config2,
+				   struct nb_config_cbs *changes)
+{
+	struct nb_config_diff_roots_head roots;
+	struct nb_config_diff_roots_hash_head hash;
+	struct nb_config_diff_root *root;
+	const struct nb_config_edit *edit;
+	uint32_t seq = 0;
+
+	nb_config_diff_roots_init(&roots);
+	nb_config_diff_roots_hash_init(&hash);
+
+	frr_each (nb_config_edits_const, &config2->edits, edit) {
+		const struct lyd_node *dnode1, *dnode2;
+
+		dnode1 = yang_dnode_get(config1->dnode, edit->xpath);
+		dnode2 = yang_dnode_get(config2->dnode, edit->xpath);
+		if (dnode1 && dnode2) {
+			nb_config_diff_root_add(&roots, &hash, 'r', dnode2,
+						dnode1);
+			nb_config_diff_root_add(&roots, &hash, 'n', dnode1,
+						NULL);
+		} else if (dnode2)
+			nb_config_diff_root_add(
+				&roots, &hash, 'c',
+				nb_config_diff_climb(dnode2, config1->dnode),
+				NULL);
+		else if (dnode1)
+			nb_config_diff_root_add(
+				&roots, &hash, 'd',
+				nb_config_diff_climb(dnode1, config2->dnode),
+				NULL);
+	}
+
+	if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL))
+		zlog_debug("%s: %zu edits, %zu subtrees to diff", __func__,
+			   nb_config_edits_count(&config2->edits),
+			   nb_config_diff_roots_count(&roots));
+
+	frr_each (nb_config_diff_roots, &roots, root) {
+		struct lyd_node *diff = NULL;
+
+		if (nb_config_diff_root_covered(&hash, root->dnode))
+			continue;
+
+		switch (root->op) {
+		case 'c':
+			nb_config_diff_created(root->dnode, &seq, changes);
+			break;
+		case 'd':
+			nb_config_diff_deleted(root->dnode, &seq, changes);
+			break;
+		case 'r':
+			if (lyd_diff_tree(root->peer, root->dnode,
+					  LYD_DIFF_DEFAULTS, &diff)
+			    != LY_SUCCESS) {
+				flog_warn(EC_LIB_LIBYANG,
+					  "%s: lyd_diff_tree() failed",
+					  __func__);
+				break;
+			}
+			nb_config_diff_process(diff, config1, config2, &seq,
+					       changes);
+			lyd_free_all(diff);
+			break;
+		default:
+			break;
+		}
+	}
+
+	while ((root = nb_config_diff_roots_pop(&roots))) {
+		nb_config_diff_roots_hash_del(&hash, root);
+		XFREE(MTYPE_TMP, root);
+	}
+	nb_config_diff_roots_hash_fini(&hash);
+	nb_config_diff_roots_fini(&roots);
+}
+
+/* Check whether a configuration holds nothing but default nodes. */
+static bool nb_config_is_default(const struct nb_config *config)
+{
+	const struct lyd_node *root;
+
+	LY_LIST_FOR (config->dnode, root) {
+		if (!CHECK_FLAG(root->flags, LYD_DEFAULT))
+			return false;
+	}
+
+	return true;
+}
+
+/* Calculate the delta between two different configurations. */
+static void nb_config_diff(const struct nb_config *config1,
+			   const struct nb_config *config2,
+			   struct nb_config_cbs *changes)
+{
+	struct lyd_node *diff = NULL;
+	const struct lyd_node *root;
+	uint32_t seq = 0;
+	LY_ERR err;
+
+	if (config1 == running_config && nb_config_track_usable(config2)) {
+		nb_config_diff_tracked(config1, config2, changes);
+		return;
+	}
+
+	/*
+	 * Fast path for the initial configuration load (e.g. "vtysh -b"):
+	 * everything in the candidate is new, so there's no need to build a
+	 * diff tree and look up each of its nodes again.
+	 */
+	if (nb_config_is_default(config1)) {
+		LY_LIST_FOR (config2->dnode, root)
+			nb_config_diff_created(root, &seq, changes);
+		return;
+	}
+
+#if 0 /* Useful (noisy) when debugging diff code, and for improving later */
+	if (DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
+		const struct lyd_node *dnode;
+
+		LY_LIST_FOR(config1->dnode, root) {
+			LYD_TREE_DFS_BEGIN(root, dnode) {
+				nb_config_diff_dnode_log("from", dnode);
+				LYD_TREE_DFS_END(root, dnode);
+			}
+		}
+		LY_LIST_FOR(config2->dnode, root) {
+			LYD_TREE_DFS_BEGIN(root, dnode) {
+				nb_config_diff_dnode_log("to", dnode);
+				LYD_TREE_DFS_END(root, dnode);
+			}
+		}
+	}
+#endif
+
+	err = lyd_diff_siblings(config1->dnode, config2->dnode,
+				LYD_DIFF_DEFAULTS, &diff);
+	assert(!err);
+
+	if (diff && DEBUG_MODE_CHECK(&nb_dbg_cbs_config, DEBUG_MODE_ALL)) {
+		char *s;
+
+		if (!lyd_print_mem(&s, diff, LYD_JSON,
+				   LYD_PRINT_WITHSIBLINGS | LYD_PRINT_WD_ALL)) {
+			zlog_debug("%s: %s", __func__, s);
+			free(s);
+		}
+	}
+
+	nb_config_diff_process(diff, config1, config2, &seq, changes);
 
 	lyd_free_all(diff);
 }
@@ -671,7 +1051,10 @@ int nb_candidate_edit(struct nb_config *candidate,
 				  "%s: lyd_new_path(%s) failed: %d", __func__,
 				  xpath_edit, err);
 			return NB_ERR;
-		} else if (dnode) {
+		}
+		nb_config_track_edit(candidate, xpath_edit,
+				     nb_snode_top_module(nb_node->snode));
+		if (dnode) {
 			/* Create default nodes */
 			LY_ERR err = lyd_new_implicit_tree(
 				dnode, LYD_IMPLICIT_NO_STATE, NULL);
@@ -707,6 +1090,10 @@ int nb_candidate_edit(struct nb_config *candidate,
 						__func__, dep_xpath, err);
 					return NB_ERR;
 				}
+				if (dep_dnode)
+					nb_config_track_edit(
+						candidate, dep_xpath,
+						lyd_owner_module(dep_dnode));
 			}
 		}
 		break;
@@ -723,9 +1110,15 @@ int nb_candidate_edit(struct nb_config *candidate,
 			nb_node->dep_cbs.get_dependant_xpath(dnode, dep_xpath);
 
 			dep_dnode = yang_dnode_get(candidate->dnode, dep_xpath);
-			if (dep_dnode)
+			if (dep_dnode) {
+				nb_config_track_edit(
+					candidate, dep_xpath,
+					lyd_owner_module(dep_dnode));
 				lyd_free_tree(dep_dnode);
+			}
 		}
+		nb_config_track_edit(candidate, xpath_edit,
+				     lyd_owner_module(dnode));
 		lyd_free_tree(dnode);
 		break;
 	case NB_OP_MOVE:
@@ -762,6 +1155,126 @@ int nb_candidate_update(struct nb_config *candidate)
 	return NB_OK;
 }
 
+/* Track the nodes created or deleted by libyang as part of the validation. */
+static void nb_config_track_validation_diff(struct nb_config *config,
+					    const struct lyd_node *diff)
+{
+	const struct lyd_node *root, *dnode;
+	char *path;
+
+	LY_LIST_FOR (diff, root) {
+		LYD_TREE_DFS_BEGIN (root, dnode) {
+			switch (nb_lyd_diff_get_op(dnode)) {
+			case 'c':
+			case 'd':
+				path = lyd_path(dnode, LYD_PATH_STD, NULL, 0);
+				nb_config_track_edit(config, path,
+						     lyd_owner_module(dnode));
+				free(path);
+				LYD_TREE_DFS_continue = 1;
+				break;
+			default:
+				break;
+			}
+			LYD_TREE_DFS_END(root, dnode);
+		}
+	}
+}
+
+/* Check if a module (or one of its submodules) imports another one. */
+static bool nb_module_imports(const struct lys_module *module,
+			      const struct lys_module *imported)
+{
+	const struct lysp_module *pmod = module->parsed;
+
+	/* Be conservative when the parsed schema isn't available. */
+	if (!pmod)
+		return true;
+
+	for (unsigned int i = 0; i < LY_ARRAY_COUNT(pmod->imports); i++) {
+		if (pmod->imports[i].module == imported)
+			return true;
+	}
+	for (unsigned int i = 0; i < LY_ARRAY_COUNT(pmod->includes); i++) {
+		const struct lysp_submodule *submod;
+
+		submod = pmod->includes[i].submodule;
+		if (!submod)
+			continue;
+		for (unsigned int j = 0; j < LY_ARRAY_COUNT(submod->imports);
+		     j++) {
+			if (submod->imports[j].module == imported)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Collect the modules whose data needs to be validated again after the edits
+ * tracked in a candidate: the modules owning the edited subtrees, plus every
+ * module importing one of those (recursively), as only these can reference
+ * the edited data from leafref, must or when statements.
+ *
+ * Returns the number of modules stored in "modules" (allocated with
+ * MTYPE_TMP), or -1 if all modules need to be validated.
+ */
+static int nb_candidate_validate_modules(const struct nb_config *candidate,
+					 const struct lys_module ***modules)
+{
+	const struct nb_config_edit *edit;
+	const struct lys_module *module;
+	const struct lys_module **set;
+	uint32_t idx = 0;
+	int count = 0, total = 0;
+	bool changed;
+
+	while (ly_ctx_get_module_iter(ly_native_ctx, &idx))
+		total++;
+	set = XCALLOC(MTYPE_TMP, (total + 1) * sizeof(*set));
+
+	frr_each (nb_config_edits_const, &candidate->edits, edit) {
+		int i;
+
+		if (!edit->module) {
+			XFREE(MTYPE_TMP, set);
+			return -1;
+		}
+		for (i = 0; i < count; i++)
+			if (set[i] == edit->module)
+				break;
+		if (i == count)
+			set[count++] = edit->module;
+	}
+
+	do {
+		changed = false;
+		idx = 0;
+		while ((module = ly_ctx_get_module_iter(ly_native_ctx, &idx))) {
+			int i;
+
+			if (!module->implemented)
+				continue;
+			for (i = 0; i < count; i++)
+				if (set[i] == module)
+					break;
+			if (i < count)
+				continue;
+			for (i = 0; i < count; i++) {
+				if (nb_module_imports(module, set[i])) {
+					set[count++] = module;
+					changed = true;
+					break;
+				}
+			}
+		}
+	} while (changed);
+
+	*modules = set;
+	return count;
+}
+
 /*
  * Perform YANG syntactic and semantic validation.
  *
@@ -771,11 +1284,75 @@ int nb_candidate_update(struct nb_config *candidate)
 static int nb_candidate_validate_yang(struct nb_config *candidate, char *errmsg,
 				      size_t errmsg_len)
 {
-	if (lyd_validate_all(&candidate->dnode, ly_native_ctx,
-			     LYD_VALIDATE_NO_STATE, NULL)
-	    != 0) {
-		yang_print_errors(ly_native_ctx, errmsg, errmsg_len);
-		return NB_ERR_VALIDATION;
+	const struct lys_module **modules = NULL;
+	struct lyd_node *diff = NULL;
+	int count = -1;
+	LY_ERR err;
+
+	if (nb_config_track_usable(candidate))
+		count = nb_candidate_validate_modules(candidate, &modules);
+
+	if (count < 0) {
+		if (lyd_validate_all(&candidate->dnode, ly_native_ctx,
+				     LYD_VALIDATE_NO_STATE, NULL)
+		    != 0) {
+			yang_print_errors(ly_native_ctx, errmsg, errmsg_len);
+			return NB_ERR_VALIDATION;
+		}
+
+		return NB_OK;
+	}
+
+	/*
+	 * Only validate the data of the modules affected by the edits. Nodes
+	 * added or removed by libyang in the process are tracked as well, so
+	 * that they're taken into account when calculating the diff.
+	 */
+	for (int i = 0; i < count; i++) {
+		err = lyd_validate_module(&candidate->dnode, modules[i],
+					  LYD_VALIDATE_NO_STATE, &diff);
+		if (err != LY_SUCCESS) {
+			XFREE(MTYPE_TMP, modules);
+			lyd_free_all(diff);
+			yang_print_errors(ly_native_ctx, errmsg, errmsg_len);
+			return NB_ERR_VALIDATION;
+		}
+		nb_config_track_validation_diff(candidate, diff);
+		lyd_free_all(diff);
+		diff = NULL;
+	}
+	XFREE(MTYPE_TMP, modules);
+
+	return NB_OK;
+}
+
+static int nb_candidate_pre_validate_node(struct nb_context *context,
+					  struct lyd_node *dnode, char *errmsg,
+					  size_t errmsg_len)
+{
+	struct nb_node *nb_node = dnode->schema->priv;
+
+	if (!nb_node || !nb_node->cbs.pre_validate)
+		return NB_OK;
+
+	return nb_callback_pre_validate(context, nb_node, dnode, errmsg,
+					errmsg_len);
+}
+
+static int nb_candidate_pre_validate_tree(struct nb_context *context,
+					  struct lyd_node *root, char *errmsg,
+					  size_t errmsg_len)
+{
+	struct lyd_node *child;
+	int ret;
+
+	LYD_TREE_DFS_BEGIN (root, child) {
+		ret = nb_candidate_pre_validate_node(context, child, errmsg,
+						     errmsg_len);
+		if (ret != NB_OK)
+			return ret;
+
+		LYD_TREE_DFS_END(root, child);
 	}
 
 	return NB_OK;
@@ -788,28 +1365,50 @@ static int nb_candidate_validate_code(struct nb_context *context,
 				      char *errmsg, size_t errmsg_len)
 {
 	struct nb_config_cb *cb;
-	struct lyd_node *root, *child;
+	struct lyd_node *root;
+	const struct nb_config_edit *edit;
 	int ret;
 
-	/* First validate the candidate as a whole. */
-	LY_LIST_FOR (candidate->dnode, root) {
-		LYD_TREE_DFS_BEGIN (root, child) {
-			struct nb_node *nb_node;
+	if (!nb_config_track_usable(candidate)) {
+		/* First validate the candidate as a whole. */
+		LY_LIST_FOR (candidate->dnode, root) {
+			ret = nb_candidate_pre_validate_tree(
+				context, root, errmsg, errmsg_len);
+			if (ret != NB_OK)
+				return NB_ERR_VALIDATION;
+		}
+		goto changes;
+	}
 
-			nb_node = child->schema->priv;
-			if (!nb_node || !nb_node->cbs.pre_validate)
-				goto next;
+	/*
+	 * The rest of the candidate was already validated when it was
+	 * committed, so only look at the edited subtrees and their ancestors.
+	 */
+	frr_each (nb_config_edits_const, &candidate->edits, edit) {
+		struct lyd_node *dnode;
+		bool exact;
+
+		dnode = nb_config_track_dnode(candidate, edit->xpath, &exact);
+		if (!dnode)
+			continue;
 
-			ret = nb_callback_pre_validate(context, nb_node, child,
-						       errmsg, errmsg_len);
+		if (exact) {
+			ret = nb_candidate_pre_validate_tree(
+				context, dnode, errmsg, errmsg_len);
+			if (ret != NB_OK)
+				return NB_ERR_VALIDATION;
+			dnode = lyd_parent(dnode);
+		}
+		for (; dnode; dnode = lyd_parent(dnode)) {
+			ret = nb_candidate_pre_validate_node(
+				context, dnode, errmsg, errmsg_len);
 			if (ret != NB_OK)
 				return NB_ERR_VALIDATION;
-
-		next:
-			LYD_TREE_DFS_END(root, child);
 		}
 	}
 
+changes:
+
 	/* Now validate the configuration changes. */
 	RB_FOREACH (cb, nb_config_cbs, changes) {
 		struct nb_config_change *change = (struct nb_config_change *)cb;
@@ -911,6 +1510,9 @@ void nb_candidate_commit_apply(struct nb_transaction *transaction,
 	transaction->config->version++;
 	nb_config_replace(running_config, transaction->config, true);
 
+	/* The candidate is now identical to running, start tracking afresh. */
+	nb_config_track_reset(transaction->config, true);
+
 	/* Record transaction. */
 	if (save_transaction && nb_db_enabled
 	    && nb_db_transaction_save(transaction, transaction_id) != NB_OK)
@@ -1277,6 +1879,24 @@ const void *nb_callback_get_next(const struct nb_node *nb_node,
 	return nb_node->cbs.get_next(&args);
 }
 
+size_t nb_callback_get_next_batch(const struct nb_node *nb_node,
+				  const void *parent_list_entry,
+				  const void *list_entry, const void **entries,
+				  size_t max_entries)
+{
+	struct nb_cb_get_next_batch_args args = {};
+
+	DEBUGD(&nb_dbg_cbs_state,
+	       "northbound callback (get_next_batch): node [%s] parent_list_entry [%p] list_entry [%p]",
+	       nb_node->xpath, parent_list_entry, list_entry);
+
+	args.parent_list_entry = parent_list_entry;
+	args.list_entry = list_entry;
+	args.entries = entries;
+	args.max_entries = max_entries;
+	return nb_node->cbs.get_next_batch(&args);
+}
+
 int nb_callback_get_keys(const struct nb_node *nb_node, const void *list_entry,
 			 struct yang_list_keys *keys)
 {
@@ -1596,12 +2216,70 @@ static void nb_transaction_apply_finish(struct nb_transaction *transaction,
 	}
 }
 
+/*
+ * State of an operational data iteration, shared by all the levels of the
+ * recursion.
+ */
+struct nb_oper_data_iter {
+	struct yang_translator *translator;
+	uint32_t flags;
+	nb_oper_data_cb cb;
+	nb_oper_data_entry_cb entry_cb;
+	void *arg;
+
+	/* Number of list entries the iteration is currently inside of. */
+	unsigned int list_depth;
+
+	/*
+	 * Skipping over the data already passed on before the iteration was
+	 * paused, until the list entry to resume from is reached.
+	 */
+	struct nb_oper_data_resume *resume;
+	bool resuming;
+};
+
+/* Number of (leaf-)list entries fetched per 'get_next_batch' call. */
+#define NB_OPER_DATA_BATCH 64
+
+struct nb_oper_data_batch {
+	const void *entries[NB_OPER_DATA_BATCH];
+	size_t num, pos;
+	bool last;
+};
+
+/*
+ * Obtain the (leaf-)list entry following list_entry, either through the
+ * 'get_next' callback or from the entries prefetched by 'get_next_batch'.
+ */
+static const void *nb_oper_data_next(const struct nb_node *nb_node,
+				     const void *parent_list_entry,
+				     const void *list_entry,
+				     struct nb_oper_data_batch *batch)
+{
+	if (!nb_node->cbs.get_next_batch)
+		return nb_callback_get_next(nb_node, parent_list_entry,
+					    list_entry);
+
+	if (batch->pos == batch->num) {
+		if (batch->last)
+			return NULL;
+
+		batch->num = nb_callback_get_next_batch(
+			nb_node, parent_list_entry, list_entry, batch->entries,
+			array_size(batch->entries));
+		batch->pos = 0;
+		batch->last = batch->num < array_size(batch->entries);
+		if (batch->num == 0)
+			return NULL;
+	}
+
+	return batch->entries[batch->pos++];
+}
+
 static int nb_oper_data_iter_children(const struct lysc_node *snode,
 				      const char *xpath, const void *list_entry,
 				      const struct yang_list_keys *list_keys,
-				      struct yang_translator *translator,
-				      bool first, uint32_t flags,
-				      nb_oper_data_cb cb, void *arg)
+				      struct nb_oper_data_iter *it)
 {
 	const struct lysc_node *child;
 
@@ -1609,8 +2287,7 @@ static int nb_oper_data_iter_children(const struct lysc_node *snode,
 		int ret;
 
 		ret = nb_oper_data_iter_node(child, xpath, list_entry,
-					     list_keys, translator, false,
-					     flags, cb, arg);
+					     list_keys, false, it);
 		if (ret != NB_OK)
 			return ret;
 	}
@@ -1621,12 +2298,11 @@ static int nb_oper_data_iter_children(const struct lysc_node *snode,
 static int nb_oper_data_iter_leaf(const struct nb_node *nb_node,
 				  const char *xpath, const void *list_entry,
 				  const struct yang_list_keys *list_keys,
-				  struct yang_translator *translator,
-				  uint32_t flags, nb_oper_data_cb cb, void *arg)
+				  struct nb_oper_data_iter *it)
 {
 	struct yang_data *data;
 
-	if (CHECK_FLAG(nb_node->snode->flags, LYS_CONFIG_W))
+	if (CHECK_FLAG(nb_node->snode->flags, LYS_CONFIG_W) || it->resuming)
 		return NB_OK;
 
 	/* Ignore list keys. */
@@ -1638,16 +2314,14 @@ static int nb_oper_data_iter_leaf(const struct nb_node *nb_node,
 		/* Leaf of type "empty" is not present. */
 		return NB_OK;
 
-	return (*cb)(nb_node->snode, translator, data, arg);
+	return (*it->cb)(nb_node->snode, it->translator, data, it->arg);
 }
 
 static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 				       const char *xpath,
 				       const void *list_entry,
 				       const struct yang_list_keys *list_keys,
-				       struct yang_translator *translator,
-				       uint32_t flags, nb_oper_data_cb cb,
-				       void *arg)
+				       struct nb_oper_data_iter *it)
 {
 	const struct lysc_node *snode = nb_node->snode;
 
@@ -1655,7 +2329,7 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 		return NB_OK;
 
 	/* Read-only presence containers. */
-	if (nb_node->cbs.get_elem) {
+	if (nb_node->cbs.get_elem && !it->resuming) {
 		struct yang_data *data;
 		int ret;
 
@@ -1664,7 +2338,7 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 			/* Presence container is not present. */
 			return NB_OK;
 
-		ret = (*cb)(snode, translator, data, arg);
+		ret = (*it->cb)(snode, it->translator, data, it->arg);
 		if (ret != NB_OK)
 			return ret;
 	}
@@ -1681,27 +2355,27 @@ static int nb_oper_data_iter_container(const struct nb_node *nb_node,
 
 	/* Iterate over the child nodes. */
 	return nb_oper_data_iter_children(snode, xpath, list_entry, list_keys,
-					  translator, false, flags, cb, arg);
+					  it);
 }
 
 static int
 nb_oper_data_iter_leaflist(const struct nb_node *nb_node, const char *xpath,
 			   const void *parent_list_entry,
 			   const struct yang_list_keys *parent_list_keys,
-			   struct yang_translator *translator, uint32_t flags,
-			   nb_oper_data_cb cb, void *arg)
+			   struct nb_oper_data_iter *it)
 {
+	struct nb_oper_data_batch batch = {};
 	const void *list_entry = NULL;
 
-	if (CHECK_FLAG(nb_node->snode->flags, LYS_CONFIG_W))
+	if (CHECK_FLAG(nb_node->snode->flags, LYS_CONFIG_W) || it->resuming)
 		return NB_OK;
 
 	do {
 		struct yang_data *data;
 		int ret;
 
-		list_entry = nb_callback_get_next(nb_node, parent_list_entry,
-						  list_entry);
+		list_entry = nb_oper_data_next(nb_node, parent_list_entry,
+					       list_entry, &batch);
 		if (!list_entry)
 			/* End of the list. */
 			break;
@@ -1710,7 +2384,7 @@ nb_oper_data_iter_leaflist(const struct nb_node *nb_node, const char *xpath,
 		if (data == NULL)
 			continue;
 
-		ret = (*cb)(nb_node->snode, translator, data, arg);
+		ret = (*it->cb)(nb_node->snode, it->translator, data, it->arg);
 		if (ret != NB_OK)
 			return ret;
 	} while (list_entry);
@@ -1722,16 +2396,40 @@ static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 				  const char *xpath_list,
 				  const void *parent_list_entry,
 				  const struct yang_list_keys *parent_list_keys,
-				  struct yang_translator *translator,
-				  uint32_t flags, nb_oper_data_cb cb, void *arg)
+				  struct nb_oper_data_iter *it)
 {
 	const struct lysc_node *snode = nb_node->snode;
+	struct nb_oper_data_batch batch = {};
 	const void *list_entry = NULL;
 	uint32_t position = 1;
 
 	if (CHECK_FLAG(nb_node->flags, F_NB_NODE_CONFIG_ONLY))
 		return NB_OK;
 
+	if (it->resuming) {
+		struct nb_oper_data_resume *resume = it->resume;
+
+		/* Lists before the one to resume in were done already. */
+		if (it->list_depth > 0 || snode != resume->snode)
+			return NB_OK;
+		it->resuming = false;
+
+		if (CHECK_FLAG(nb_node->flags, F_NB_NODE_KEYLESS_LIST)) {
+			for (; position <= resume->position; position++) {
+				list_entry = nb_oper_data_next(
+					nb_node, parent_list_entry, list_entry,
+					&batch);
+				if (!list_entry)
+					return NB_OK;
+			}
+		} else {
+			list_entry = nb_callback_lookup_entry(
+				nb_node, parent_list_entry, &resume->keys);
+			if (!list_entry)
+				return NB_ERR_NOT_FOUND;
+		}
+	}
+
 	/* Iterate over all list entries. */
 	do {
 		const struct lysc_node_leaf *skey;
@@ -1740,8 +2438,8 @@ static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 		int ret;
 
 		/* Obtain list entry. */
-		list_entry = nb_callback_get_next(nb_node, parent_list_entry,
-						  list_entry);
+		list_entry = nb_oper_data_next(nb_node, parent_list_entry,
+					       list_entry, &batch);
 		if (!list_entry)
 			/* End of the list. */
 			break;
@@ -1758,14 +2456,15 @@ static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 			}
 
 			/* Build XPath of the list entry. */
-			strlcpy(xpath, xpath_list, sizeof(xpath));
+			size_t len = strlcpy(xpath, xpath_list, sizeof(xpath));
 			unsigned int i = 0;
 			LY_FOR_KEYS (snode, skey) {
 				assert(i < list_keys.num);
-				snprintf(xpath + strlen(xpath),
-					 sizeof(xpath) - strlen(xpath),
-					 "[%s='%s']", skey->name,
-					 list_keys.key[i]);
+				if (len < sizeof(xpath))
+					len += snprintf(xpath + len,
+							sizeof(xpath) - len,
+							"[%s='%s']", skey->name,
+							list_keys.key[i]);
 				i++;
 			}
 			assert(i == list_keys.num);
@@ -1779,11 +2478,24 @@ static int nb_oper_data_iter_list(const struct nb_node *nb_node,
 		}
 
 		/* Iterate over the child nodes. */
-		ret = nb_oper_data_iter_children(
-			nb_node->snode, xpath, list_entry, &list_keys,
-			translator, false, flags, cb, arg);
+		it->list_depth++;
+		ret = nb_oper_data_iter_children(nb_node->snode, xpath,
+						 list_entry, &list_keys, it);
+		it->list_depth--;
 		if (ret != NB_OK)
 			return ret;
+
+		/* All data of an outermost list entry has been passed on. */
+		if (it->entry_cb && it->list_depth == 0) {
+			ret = (*it->entry_cb)(snode, xpath, it->arg);
+			if (ret == NB_YIELD && it->resume) {
+				it->resume->snode = snode;
+				it->resume->keys = list_keys;
+				it->resume->position = position - 1;
+			}
+			if (ret != NB_OK)
+				return ret;
+		}
 	} while (list_entry);
 
 	return NB_OK;
@@ -1793,15 +2505,13 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 				  const char *xpath_parent,
 				  const void *list_entry,
 				  const struct yang_list_keys *list_keys,
-				  struct yang_translator *translator,
-				  bool first, uint32_t flags,
-				  nb_oper_data_cb cb, void *arg)
+				  bool first, struct nb_oper_data_iter *it)
 {
 	struct nb_node *nb_node;
 	char xpath[XPATH_MAXLEN];
 	int ret = NB_OK;
 
-	if (!first && CHECK_FLAG(flags, NB_OPER_DATA_ITER_NORECURSE)
+	if (!first && CHECK_FLAG(it->flags, NB_OPER_DATA_ITER_NORECURSE)
 	    && CHECK_FLAG(snode->nodetype, LYS_CONTAINER | LYS_LIST))
 		return NB_OK;
 
@@ -1831,28 +2541,23 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 	switch (snode->nodetype) {
 	case LYS_CONTAINER:
 		ret = nb_oper_data_iter_container(nb_node, xpath, list_entry,
-						  list_keys, translator, flags,
-						  cb, arg);
+						  list_keys, it);
 		break;
 	case LYS_LEAF:
 		ret = nb_oper_data_iter_leaf(nb_node, xpath, list_entry,
-					     list_keys, translator, flags, cb,
-					     arg);
+					     list_keys, it);
 		break;
 	case LYS_LEAFLIST:
 		ret = nb_oper_data_iter_leaflist(nb_node, xpath, list_entry,
-						 list_keys, translator, flags,
-						 cb, arg);
+						 list_keys, it);
 		break;
 	case LYS_LIST:
 		ret = nb_oper_data_iter_list(nb_node, xpath, list_entry,
-					     list_keys, translator, flags, cb,
-					     arg);
+					     list_keys, it);
 		break;
 	case LYS_USES:
 		ret = nb_oper_data_iter_children(snode, xpath, list_entry,
-						 list_keys, translator, false,
-						 flags, cb, arg);
+						 list_keys, it);
 		break;
 	default:
 		break;
@@ -1861,9 +2566,21 @@ static int nb_oper_data_iter_node(const struct lysc_node *snode,
 	return ret;
 }
 
-int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
-			 uint32_t flags, nb_oper_data_cb cb, void *arg)
-{
+int nb_oper_data_iterate_stream(const char *xpath,
+				struct yang_translator *translator,
+				uint32_t flags, nb_oper_data_cb cb,
+				nb_oper_data_entry_cb entry_cb, void *arg,
+				struct nb_oper_data_resume *resume)
+{
+	struct nb_oper_data_iter it = {
+		.translator = translator,
+		.flags = flags,
+		.cb = cb,
+		.entry_cb = entry_cb,
+		.arg = arg,
+		.resume = resume,
+		.resuming = resume && resume->snode,
+	};
 	struct nb_node *nb_node;
 	const void *list_entry = NULL;
 	struct yang_list_keys list_keys;
@@ -1961,13 +2678,11 @@ int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
 
 	/* If a list entry was given, iterate over that list entry only. */
 	if (dnode->schema->nodetype == LYS_LIST && lyd_child(dnode))
-		ret = nb_oper_data_iter_children(
-			nb_node->snode, xpath, list_entry, &list_keys,
-			translator, true, flags, cb, arg);
+		ret = nb_oper_data_iter_children(nb_node->snode, xpath,
+						 list_entry, &list_keys, &it);
 	else
 		ret = nb_oper_data_iter_node(nb_node->snode, xpath, list_entry,
-					     &list_keys, translator, true,
-					     flags, cb, arg);
+					     &list_keys, true, &it);
 
 	list_delete(&list_dnodes);
 	yang_dnode_free(dnode);
@@ -1975,6 +2690,13 @@ int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
 	return ret;
 }
 
+int nb_oper_data_iterate(const char *xpath, struct yang_translator *translator,
+			 uint32_t flags, nb_oper_data_cb cb, void *arg)
+{
+	return nb_oper_data_iterate_stream(xpath, translator, flags, cb, NULL,
+					   arg, NULL);
+}
+
 bool nb_operation_is_valid(enum nb_operation operation,
 			   const struct lysc_node *snode)
 {
@@ -2373,6 +3095,8 @@ const char *nb_err_name(enum nb_error error)
 		return "failed to allocate resource";
 	case NB_ERR_INCONSISTENCY:
 		return "internal inconsistency";
+	case NB_YIELD:
+		return "iteration paused";
 	default:
 		return "unknown";
 	}
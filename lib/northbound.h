@@ -24,6 +24,7 @@
 #include "hook.h"
 #include "linklist.h"
 #include "openbsd-tree.h"
+#include "typesafe.h"
 #include "yang.h"
 #include "yang_translator.h"
 
@@ -230,6 +231,23 @@ struct nb_cb_get_next_args {
 	const void *list_entry;
 };
 
+struct nb_cb_get_next_batch_args {
+	/* Pointer to parent list entry. */
+	const void *parent_list_entry;
+
+	/*
+	 * Pointer to the last (leaf-)list entry returned by the previous
+	 * call, or NULL on the first invocation.
+	 */
+	const void *list_entry;
+
+	/* Array to be filled with the (leaf-)list entries that follow. */
+	const void **entries;
+
+	/* Size of the 'entries' array. */
+	size_t max_entries;
+};
+
 struct nb_cb_get_keys_args {
 	/* Pointer to list entry. */
 	const void *list_entry;
@@ -426,6 +444,28 @@ struct nb_callbacks {
 	 */
 	const void *(*get_next)(struct nb_cb_get_next_args *args);
 
+	/*
+	 * Operational data callback for YANG lists and leaf-lists.
+	 *
+	 * Batched alternative to 'get_next', for lists that can have a large
+	 * number of entries.  The callback function should store up to
+	 * 'max_entries' entries following 'list_entry' in the 'entries'
+	 * array, saving the cost of finding the current position again for
+	 * every single entry.  The returned entries must remain valid until
+	 * the iteration is done with them.  When this callback is implemented
+	 * 'get_next' isn't used and doesn't need to be provided.
+	 *
+	 * args
+	 *    Refer to the documentation comments of nb_cb_get_next_batch_args
+	 *    for details.
+	 *
+	 * Returns:
+	 *    Number of entries stored in the 'entries' array.  Returning less
+	 *    than 'max_entries' signals that the end of the (leaf-)list was
+	 *    reached.
+	 */
+	size_t (*get_next_batch)(struct nb_cb_get_next_batch_args *args);
+
 	/*
 	 * Operational data callback for YANG lists.
 	 *
@@ -610,6 +650,7 @@ enum nb_error {
 	NB_ERR_VALIDATION,
 	NB_ERR_RESOURCE,
 	NB_ERR_INCONSISTENCY,
+	NB_YIELD,
 };
 
 /* Default priority. */
@@ -653,10 +694,22 @@ struct nb_context {
 #endif
 };
 
+PREDECL_DLIST(nb_config_edits);
+PREDECL_HASH(nb_config_edits_hash);
+
 /* Northbound configuration. */
 struct nb_config {
 	struct lyd_node *dnode;
 	uint32_t version;
+
+	/*
+	 * Change tracking: when "tracked" is set, this configuration is a copy
+	 * of the running configuration (same version) plus the subtrees listed
+	 * in "edits". Commits then diff and validate only those subtrees.
+	 */
+	bool tracked;
+	struct nb_config_edits_head edits;
+	struct nb_config_edits_hash_head edits_hash;
 };
 
 /* Northbound configuration callback. */
@@ -690,6 +743,29 @@ typedef int (*nb_oper_data_cb)(const struct lysc_node *snode,
 			       struct yang_translator *translator,
 			       struct yang_data *data, void *arg);
 
+/*
+ * Callback function used by nb_oper_data_iterate_stream(), called once all
+ * the data of an entry of the outermost list being iterated over was passed
+ * to the nb_oper_data_cb callback.
+ */
+typedef int (*nb_oper_data_entry_cb)(const struct lysc_node *snode,
+				     const char *xpath, void *arg);
+
+/*
+ * Position at which a streaming iteration was paused, to continue from with
+ * a later nb_oper_data_iterate_stream() call.
+ */
+struct nb_oper_data_resume {
+	/* Outermost list the iteration stopped in (NULL: start over). */
+	const struct lysc_node *snode;
+
+	/* Keys of the last list entry that was completed. */
+	struct yang_list_keys keys;
+
+	/* Same, as a 1-based position for keyless lists. */
+	uint32_t position;
+};
+
 /* Iterate over direct child nodes only. */
 #define NB_OPER_DATA_ITER_NORECURSE 0x0001
 
@@ -717,6 +793,11 @@ extern struct yang_data *nb_callback_get_elem(const struct nb_node *nb_node,
 extern const void *nb_callback_get_next(const struct nb_node *nb_node,
 					const void *parent_list_entry,
 					const void *list_entry);
+extern size_t nb_callback_get_next_batch(const struct nb_node *nb_node,
+					 const void *parent_list_entry,
+					 const void *list_entry,
+					 const void **entries,
+					 size_t max_entries);
 extern int nb_callback_get_keys(const struct nb_node *nb_node,
 				const void *list_entry,
 				struct yang_list_keys *keys);
@@ -1103,6 +1184,36 @@ extern int nb_oper_data_iterate(const char *xpath,
 				struct yang_translator *translator,
 				uint32_t flags, nb_oper_data_cb cb, void *arg);
 
+/*
+ * Same as nb_oper_data_iterate(), but additionally call 'entry_cb' after
+ * each entry of the outermost list that is iterated over.  This allows the
+ * caller to serialize and release the data of each list entry as it goes,
+ * rather than building a data tree of the whole list first.  Data that
+ * isn't part of any list entry is left for the caller to handle after the
+ * iteration returns.
+ *
+ * entry_cb
+ *    Function to call after each outermost list entry (might be NULL).
+ *    It receives the same 'arg' as 'cb'.  Returning NB_YIELD pauses the
+ *    iteration, anything else other than NB_OK aborts it.
+ *
+ * resume
+ *    Where to store the position when 'entry_cb' returns NB_YIELD (might
+ *    be NULL if it never does).  Passing the same structure back together
+ *    with the same xpath and flags continues the iteration after the last
+ *    completed list entry; zero-initialize it to start at the beginning.
+ *
+ * Returns:
+ *    NB_OK when done, NB_YIELD when paused, NB_ERR_NOT_FOUND if the entry
+ *    to resume from doesn't exist anymore, NB_ERR otherwise.
+ */
+extern int nb_oper_data_iterate_stream(const char *xpath,
+				       struct yang_translator *translator,
+				       uint32_t flags, nb_oper_data_cb cb,
+				       nb_oper_data_entry_cb entry_cb,
+				       void *arg,
+				       struct nb_oper_data_resume *resume);
+
 /*
  * Validate if the northbound operation is valid for the given node.
  *
@@ -1456,6 +1456,50 @@ error:
 	return NB_ERR;
 }
 
+/* State of "show yang operational-data ... stream". */
+struct nb_cli_oper_stream {
+	struct vty *vty;
+	struct ly_ctx *ly_ctx;
+	LYD_FORMAT format;
+	struct lyd_node *dnode;
+	bool pending;
+};
+
+static int nb_cli_oper_stream_cb(const struct lysc_node *snode,
+				 struct yang_translator *translator,
+				 struct yang_data *data, void *arg)
+{
+	struct nb_cli_oper_stream *stream = arg;
+
+	stream->pending = true;
+	return nb_cli_oper_data_cb(snode, translator, data, stream->dnode);
+}
+
+/* Print what was collected so far and start over with an empty tree. */
+static int nb_cli_oper_stream_flush(const struct lysc_node *snode,
+				    const char *xpath, void *arg)
+{
+	struct nb_cli_oper_stream *stream = arg;
+	char *strp;
+
+	if (!stream->pending)
+		return NB_OK;
+
+	if (lyd_print_mem(&strp, stream->dnode, stream->format,
+			  LYD_PRINT_WITHSIBLINGS)
+		    != 0
+	    || !strp)
+		return NB_ERR;
+	vty_out(stream->vty, "%s", strp);
+	free(strp);
+
+	yang_dnode_free(stream->dnode);
+	stream->dnode = yang_dnode_new(stream->ly_ctx, false);
+	stream->pending = false;
+
+	return NB_OK;
+}
+
 DEFPY (show_yang_operational_data,
        show_yang_operational_data_cmd,
        "show yang operational-data XPATH$xpath\
@@ -1463,6 +1507,7 @@ DEFPY (show_yang_operational_data,
 	   format <json$json|xml$xml>\
 	   |translate WORD$translator_family\
 	   |with-config$with_config\
+	   |stream$stream\
 	 }]",
        SHOW_STR
        "YANG information\n"
@@ -1473,7 +1518,8 @@ DEFPY (show_yang_operational_data,
        "Extensible Markup Language\n"
        "Translate operational data\n"
        "YANG module translator\n"
-       "Merge configuration data\n")
+       "Merge configuration data\n"
+       "Display each list entry as soon as it was fetched\n")
 {
 	LYD_FORMAT format;
 	struct yang_translator *translator = NULL;
@@ -1499,6 +1545,35 @@ DEFPY (show_yang_operational_data,
 	} else
 		ly_ctx = ly_native_ctx;
 
+	if (stream) {
+		struct nb_cli_oper_stream state = {
+			.vty = vty,
+			.ly_ctx = ly_ctx,
+			.format = format,
+		};
+		int ret;
+
+		if (with_config) {
+			vty_out(vty,
+				"%% with-config can't be used together with stream\n");
+			return CMD_WARNING;
+		}
+
+		state.dnode = yang_dnode_new(ly_ctx, false);
+		ret = nb_oper_data_iterate_stream(xpath, translator, 0,
+						  nb_cli_oper_stream_cb,
+						  nb_cli_oper_stream_flush,
+						  &state, NULL);
+		if (ret == NB_OK)
+			ret = nb_cli_oper_stream_flush(NULL, NULL, &state);
+		yang_dnode_free(state.dnode);
+		if (ret != NB_OK) {
+			vty_out(vty, "%% Failed to fetch operational data.\n");
+			return CMD_WARNING;
+		}
+		return CMD_SUCCESS;
+	}
+
 	/* Obtain data. */
 	dnode = yang_dnode_new(ly_ctx, false);
 	if (nb_oper_data_iterate(xpath, translator, 0, nb_cli_oper_data_cb,
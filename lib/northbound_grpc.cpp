@@ -20,6 +20,7 @@
 
 #include <zebra.h>
 #include <grpcpp/grpcpp.h>
+#include <grpcpp/alarm.h>
 #include "grpc/frr-northbound.grpc.pb.h"
 
 #include "log.h"
@@ -32,6 +33,7 @@
 #include "northbound_db.h"
 #include "frr_pthread.h"
 
+#include <chrono>
 #include <iostream>
 #include <sstream>
 #include <memory>
@@ -159,6 +161,7 @@ class RpcStateBase
 		 * We enter in either CREATE or MORE state, and transition to
 		 * PROCESS state.
 		 */
+		this->cq = cq;
 		this->entered_state = this->state;
 		this->state = PROCESS;
 		grpc_debug("%s RPC: %s -> %s on grpc-io-thread", name,
@@ -227,6 +230,9 @@ class RpcStateBase
 
       public:
 	const char *name;
+
+	// Completion queue of the last run, e.g. to set alarms on.
+	grpc::ServerCompletionQueue *cq = NULL;
 };
 
 /*
@@ -452,6 +458,71 @@ static int get_oper_data_cb(const struct lysc_node *snode,
 	return (ret == 0) ? NB_OK : NB_ERR;
 }
 
+struct get_chunk {
+	struct lyd_node *dnode;
+	uint32_t entries;
+	uint32_t max_entries;
+};
+
+static int get_chunk_data_cb(const struct lysc_node *snode,
+			     struct yang_translator *translator,
+			     struct yang_data *data, void *arg)
+{
+	struct get_chunk *chunk = static_cast<struct get_chunk *>(arg);
+
+	return get_oper_data_cb(snode, translator, data, chunk->dnode);
+}
+
+static int get_chunk_entry_cb(const struct lysc_node *snode,
+			      const char *xpath, void *arg)
+{
+	struct get_chunk *chunk = static_cast<struct get_chunk *>(arg);
+
+	return ++chunk->entries < chunk->max_entries ? NB_OK : NB_YIELD;
+}
+
+/*
+ * Fetch the next chunk of at most 'max_entries' list entries of the state
+ * data at 'path', continuing where the previous chunk stopped.
+ */
+static grpc::Status get_path_state_chunk(frr::DataTree *dt,
+					 const std::string &path,
+					 LYD_FORMAT lyd_format,
+					 bool with_defaults,
+					 uint32_t max_entries,
+					 struct nb_oper_data_resume *resume,
+					 bool *more)
+{
+	struct get_chunk chunk = {};
+	LY_ERR err;
+	int ret;
+
+	chunk.dnode = yang_dnode_new(ly_native_ctx, false);
+	chunk.max_entries = max_entries;
+	ret = nb_oper_data_iterate_stream(path.c_str(), NULL, 0,
+					  get_chunk_data_cb, get_chunk_entry_cb,
+					  &chunk, resume);
+	if (ret != NB_OK && ret != NB_YIELD) {
+		yang_dnode_free(chunk.dnode);
+		return grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+				    "Failed to fetch operational data");
+	}
+	*more = (ret == NB_YIELD);
+
+	err = lyd_validate_all(&chunk.dnode, ly_native_ctx, 0, NULL);
+	if (err)
+		flog_warn(EC_LIB_LIBYANG, "%s: lyd_validate_all() failed: %s",
+			  __func__, ly_errmsg(ly_native_ctx));
+	if (!err)
+		err = data_tree_from_dnode(dt, chunk.dnode, lyd_format,
+					   with_defaults);
+	yang_dnode_free(chunk.dnode);
+	if (err)
+		return grpc::Status(grpc::StatusCode::INTERNAL,
+				    "Failed to dump data");
+	return grpc::Status::OK;
+}
+
 static struct lyd_node *get_dnode_state(const std::string &path)
 {
 	struct lyd_node *dnode = yang_dnode_new(ly_native_ctx, false);
@@ -583,14 +654,19 @@ grpc::Status HandleUnaryGetCapabilities(
 }
 
 // Define the context variable type for this streaming handler
-typedef std::list<std::string> GetContextType;
+struct GetContextType {
+	std::list<std::string> paths;
+
+	// Position in the state data of paths.back() when sent in chunks.
+	struct nb_oper_data_resume resume = {};
+};
 
 bool HandleStreamingGet(
 	StreamRpcState<frr::GetRequest, frr::GetResponse, GetContextType> *tag)
 {
 	grpc_debug("%s: entered", __func__);
 
-	auto mypathps = &tag->context;
+	auto mypathps = &tag->context.paths;
 	if (tag->is_initial_process()) {
 		// Fill our context container first time through
 		grpc_debug("%s: initialize streaming state", __func__);
@@ -606,6 +682,9 @@ bool HandleStreamingGet(
 	frr::Encoding encoding = tag->request.encoding();
 	// Request: bool with_defaults = 3;
 	bool with_defaults = tag->request.with_defaults();
+	// Request: uint32 chunk_size = 5;
+	uint32_t chunk_size = tag->request.chunk_size();
+	bool more = false;
 
 	if (mypathps->empty()) {
 		tag->async_responder.Finish(grpc::Status::OK, tag);
@@ -621,8 +700,13 @@ bool HandleStreamingGet(
 	// Response: DataTree data = 2;
 	auto *data = response.mutable_data();
 	data->set_encoding(tag->request.encoding());
-	status = get_path(data, mypathps->back().c_str(), type,
-			  encoding2lyd_format(encoding), with_defaults);
+	if (chunk_size && type == frr::GetRequest_DataType_STATE)
+		status = get_path_state_chunk(
+			data, mypathps->back(), encoding2lyd_format(encoding),
+			with_defaults, chunk_size, &tag->context.resume, &more);
+	else
+		status = get_path(data, mypathps->back().c_str(), type,
+				  encoding2lyd_format(encoding), with_defaults);
 
 	if (!status.ok()) {
 		tag->async_responder.WriteAndFinish(
@@ -630,6 +714,13 @@ bool HandleStreamingGet(
 		return false;
 	}
 
+	// The next chunk is only fetched once this one was sent.
+	if (more) {
+		tag->async_responder.Write(response, tag);
+		return true;
+	}
+
+	tag->context.resume = {};
 	mypathps->pop_back();
 	if (mypathps->empty()) {
 		tag->async_responder.WriteAndFinish(
@@ -990,6 +1081,244 @@ bool HandleStreamingListTransactions(
 	}
 }
 
+// ------------------------------------------------------
+//                  Telemetry subscriptions
+// ------------------------------------------------------
+
+// Default and minimum interval between two samples, in milliseconds.
+#define GRPC_SUBSCRIBE_DFLT_INTERVAL 10000
+#define GRPC_SUBSCRIBE_MIN_INTERVAL 100
+
+// Notifications queued for a client that doesn't keep up are dropped.
+#define GRPC_SUBSCRIBE_MAX_PENDING 1024
+
+struct SubscribeContextType {
+	~SubscribeContextType();
+
+	typedef StreamRpcState<frr::SubscribeRequest, frr::SubscribeResponse,
+			       SubscribeContextType>
+		tag_t;
+
+	tag_t *tag = NULL;
+	frr::SubscribeRequest_Mode mode;
+	LYD_FORMAT lyd_format;
+	std::chrono::milliseconds interval;
+	std::chrono::system_clock::time_point next_sample;
+
+	// Responses waiting to be written, accessed on the main thread only.
+	std::list<frr::SubscribeResponse> pending;
+
+	// Set when no write or alarm is outstanding (main thread only).
+	bool parked = false;
+	bool alarm_armed = false;
+	grpc::Alarm alarm;
+};
+
+/*
+ * Subscriptions currently active.  The list is walked by the main thread
+ * (notifications, shutdown) while the gRPC pthread removes subscriptions
+ * whose client went away.
+ */
+static pthread_mutex_t s_subscriptions_lock = PTHREAD_MUTEX_INITIALIZER;
+static std::list<SubscribeContextType *> s_subscriptions;
+
+SubscribeContextType::~SubscribeContextType()
+{
+	if (!tag)
+		return;
+
+	pthread_mutex_lock(&s_subscriptions_lock);
+	s_subscriptions.remove(this);
+	pthread_mutex_unlock(&s_subscriptions_lock);
+}
+
+// Wake up a parked subscription right away (main thread only).
+static void subscribe_wakeup(SubscribeContextType *sub)
+{
+	if (!sub->parked)
+		return;
+
+	sub->parked = false;
+	sub->alarm_armed = true;
+	sub->alarm.Set(sub->tag->cq, std::chrono::system_clock::now(),
+		       sub->tag);
+}
+
+static bool subscribe_path_match(const frr::SubscribeRequest &request,
+				 const char *xpath)
+{
+	if (request.path_size() == 0)
+		return true;
+
+	for (const std::string &path : request.path())
+		if (!strncmp(xpath, path.c_str(), path.size()))
+			return true;
+
+	return false;
+}
+
+static int grpc_notification_send(const char *xpath, struct list *arguments)
+{
+	struct lyd_node *dnode = NULL;
+	struct yang_data *data;
+	struct listnode *node;
+
+	pthread_mutex_lock(&s_subscriptions_lock);
+	for (auto sub : s_subscriptions) {
+		if (sub->mode != frr::SubscribeRequest::ON_CHANGE
+		    || !subscribe_path_match(sub->tag->request, xpath))
+			continue;
+
+		if (!dnode) {
+			if (lyd_new_path(NULL, ly_native_ctx, xpath, NULL, 0,
+					 &dnode)
+			    != LY_SUCCESS) {
+				flog_warn(EC_LIB_LIBYANG,
+					  "%s: lyd_new_path(%s) failed: %s",
+					  __func__, xpath,
+					  ly_errmsg(ly_native_ctx));
+				break;
+			}
+			if (arguments)
+				for (ALL_LIST_ELEMENTS_RO(arguments, node,
+							  data))
+					(void)yang_dnode_edit(dnode,
+							      data->xpath,
+							      data->value);
+		}
+
+		if (sub->pending.size() >= GRPC_SUBSCRIBE_MAX_PENDING) {
+			grpc_debug("%s: subscriber queue full, dropping %s",
+				   __func__,
+				   sub->pending.front().path().c_str());
+			sub->pending.pop_front();
+		}
+
+		sub->pending.emplace_back();
+		frr::SubscribeResponse &response = sub->pending.back();
+		response.set_timestamp(time(NULL));
+		response.set_path(xpath);
+		auto *dt = response.mutable_data();
+		dt->set_encoding(sub->tag->request.encoding());
+		if (data_tree_from_dnode(dt, dnode, sub->lyd_format, false)) {
+			sub->pending.pop_back();
+			continue;
+		}
+
+		subscribe_wakeup(sub);
+	}
+	pthread_mutex_unlock(&s_subscriptions_lock);
+
+	if (dnode)
+		yang_dnode_free(dnode);
+
+	return 0;
+}
+
+// Cancel all subscriptions, called on the main thread on shutdown.
+static void subscribe_cancel_all(void)
+{
+	pthread_mutex_lock(&s_subscriptions_lock);
+	for (auto sub : s_subscriptions) {
+		if (sub->parked) {
+			sub->parked = false;
+			sub->alarm_armed = true;
+			sub->alarm.Set(sub->tag->cq,
+				       std::chrono::system_clock::now()
+					       + std::chrono::hours(1),
+				       sub->tag);
+		}
+		if (sub->alarm_armed)
+			sub->alarm.Cancel();
+	}
+	pthread_mutex_unlock(&s_subscriptions_lock);
+}
+
+bool HandleStreamingSubscribe(SubscribeContextType::tag_t *tag)
+{
+	auto sub = &tag->context;
+	auto now = std::chrono::system_clock::now();
+
+	grpc_debug("%s: entered", __func__);
+
+	if (tag->is_initial_process()) {
+		uint32_t interval = tag->request.sample_interval();
+
+		// Request: Mode mode = 1;
+		sub->mode = tag->request.mode();
+		// Request: Encoding encoding = 2;
+		sub->lyd_format = encoding2lyd_format(tag->request.encoding());
+		// Request: uint32 sample_interval = 3;
+		if (!interval)
+			interval = GRPC_SUBSCRIBE_DFLT_INTERVAL;
+		else if (interval < GRPC_SUBSCRIBE_MIN_INTERVAL)
+			interval = GRPC_SUBSCRIBE_MIN_INTERVAL;
+		sub->interval = std::chrono::milliseconds(interval);
+		sub->next_sample = now;
+
+		// Request: repeated string path = 4;
+		if (sub->mode == frr::SubscribeRequest::SAMPLE
+		    && tag->request.path_size() == 0) {
+			tag->async_responder.Finish(
+				grpc::Status(grpc::StatusCode::INVALID_ARGUMENT,
+					     "No data path to sample"),
+				tag);
+			return false;
+		}
+
+		sub->tag = tag;
+		pthread_mutex_lock(&s_subscriptions_lock);
+		s_subscriptions.push_back(sub);
+		pthread_mutex_unlock(&s_subscriptions_lock);
+	}
+
+	sub->parked = false;
+	sub->alarm_armed = false;
+
+	if (sub->mode == frr::SubscribeRequest::SAMPLE
+	    && now >= sub->next_sample) {
+		for (const std::string &path : tag->request.path()) {
+			sub->pending.emplace_back();
+			frr::SubscribeResponse &response = sub->pending.back();
+
+			// Response: int64 timestamp = 1;
+			response.set_timestamp(time(NULL));
+			// Response: string path = 2;
+			response.set_path(path);
+			// Response: DataTree data = 3;
+			auto *dt = response.mutable_data();
+			dt->set_encoding(tag->request.encoding());
+			grpc::Status status =
+				get_path(dt, path, frr::GetRequest::STATE,
+					 sub->lyd_format, false);
+			if (!status.ok()) {
+				tag->async_responder.Finish(status, tag);
+				return false;
+			}
+		}
+
+		// Keep the sampling period, unless we fell behind.
+		sub->next_sample += sub->interval;
+		if (sub->next_sample <= now)
+			sub->next_sample = now + sub->interval;
+	}
+
+	if (!sub->pending.empty()) {
+		tag->async_responder.Write(sub->pending.front(), tag);
+		sub->pending.pop_front();
+		return true;
+	}
+
+	// Nothing to send: wait for the next sample or notification.
+	if (sub->mode == frr::SubscribeRequest::SAMPLE) {
+		sub->alarm_armed = true;
+		sub->alarm.Set(tag->cq, sub->next_sample, tag);
+	} else
+		sub->parked = true;
+
+	return true;
+}
+
 grpc::Status HandleUnaryGetTransaction(
 	UnaryRpcState<frr::GetTransactionRequest, frr::GetTransactionResponse>
 		*tag)
@@ -1173,6 +1502,7 @@ static void *grpc_pthread_start(void *arg)
 	/* Schedule streaming RPC handlers */
 	REQUEST_NEWRPC_STREAMING(Get);
 	REQUEST_NEWRPC_STREAMING(ListTransactions);
+	REQUEST_NEWRPC_STREAMING(Subscribe);
 
 	zlog_notice("gRPC server listening on %s",
 		    server_address.str().c_str());
@@ -1189,12 +1519,26 @@ static void *grpc_pthread_start(void *arg)
 		grpc_debug("%s: got next from CQ tag: %p ok: %d", __func__, tag,
 			   ok);
 
-		if (!ok) {
-			delete static_cast<RpcStateBase *>(tag);
+		RpcStateBase *rpc = static_cast<RpcStateBase *>(tag);
+		if (!ok && rpc->get_state() == CREATE) {
+			delete rpc;
 			break;
 		}
 
-		RpcStateBase *rpc = static_cast<RpcStateBase *>(tag);
+		/*
+		 * A write or alarm of a streaming RPC failed (client went away,
+		 * or we're shutting down).  Nothing else is outstanding for it,
+		 * so drop it and be ready for a new request of the same type.
+		 */
+		if (!ok || !grpc_running) {
+			grpc_debug("%s RPC %s -> [delete]", rpc->name,
+				   call_states[rpc->get_state()]);
+			if (grpc_running && rpc->get_state() == MORE)
+				rpc->do_request(&service, cq.get(), false);
+			delete rpc;
+			continue;
+		}
+
 		if (rpc->get_state() != FINISH)
 			rpc->run(&service, cq.get());
 		else {
@@ -1256,12 +1600,19 @@ static int frr_grpc_finish(void)
 	if (!fpt)
 		return 0;
 
+	hook_unregister(nb_notification_send, grpc_notification_send);
+
+	pthread_mutex_lock(&s_server_lock);
+	grpc_running = false;
+	pthread_mutex_unlock(&s_server_lock);
+
+	subscribe_cancel_all();
+
 	/*
 	 * Shut the server down here in main thread. This will cause the wait on
 	 * the completion queue (cq.Next()) to exit and cleanup everything else.
 	 */
 	pthread_mutex_lock(&s_server_lock);
-	grpc_running = false;
 	if (s_server) {
 		grpc_debug("%s: shutdown server", __func__);
 		s_server->Shutdown();
@@ -1315,6 +1666,7 @@ static int frr_grpc_module_late_init(struct thread_master *tm)
 {
 	main_master = tm;
 	hook_register(frr_fini, frr_grpc_finish);
+	hook_register(nb_notification_send, grpc_notification_send);
 	thread_add_event(tm, frr_grpc_module_very_late_init, NULL, 0, NULL);
 	return 0;
 }
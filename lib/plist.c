@@ -30,6 +30,7 @@
 #include "routemap.h"
 #include "lib/json.h"
 #include "libfrr.h"
+#include "jhash.h"
 
 #include <typesafe.h>
 #include "plist_int.h"
@@ -42,15 +43,22 @@ DEFINE_MTYPE_STATIC(LIB, PREFIX_LIST_TRIE, "Prefix List Trie Table");
 /* not currently changeable, code assumes bytes further down */
 #define PLC_BITS	8
 #define PLC_LEN		(1 << PLC_BITS)
-#define PLC_MAXLEVELV4	2	/* /24 for IPv4 */
-#define PLC_MAXLEVELV6	4	/* /48 for IPv6 */
-#define PLC_MAXLEVEL	4	/* max(v4,v6) */
-
+#define PLC_MAXLEVELV4	4	/* /32 for IPv4 */
+#define PLC_MAXLEVELV6	16	/* /128 for IPv6 */
+#define PLC_MAXLEVEL	16	/* max(v4,v6) */
+
+/* final_chain length at which a slot gets its next level */
+#define PLC_CHAIN_MAX	8
+
+/*
+ * Levels below the first one are only created where they are needed:
+ * entries longer than a level are kept on the slot's final_chain until
+ * there are more than PLC_CHAIN_MAX of them, then the slot is split into
+ * a next_table.  A slot never has both.
+ */
 struct pltrie_entry {
-	union {
-		struct pltrie_table *next_table;
-		struct prefix_list_entry *final_chain;
-	};
+	struct pltrie_table *next_table;
+	struct prefix_list_entry *final_chain;
 
 	struct prefix_list_entry *up_chain;
 };
@@ -122,6 +130,25 @@ afi_t prefix_list_afi(struct prefix_list *plist)
 	return AFI_IP6;
 }
 
+uint32_t prefix_list_hash(const struct prefix_list *plist)
+{
+	const struct prefix_list_entry *pentry;
+	uint32_t hash;
+
+	if (!plist)
+		return 0;
+
+	hash = jhash_1word(plist->count, 0);
+	for (pentry = plist->head; pentry; pentry = pentry->next) {
+		hash = jhash_3words((uint32_t)pentry->seq, pentry->type,
+				    pentry->any, hash);
+		hash = jhash_3words(pentry->le, pentry->ge,
+				    prefix_hash_key(&pentry->prefix), hash);
+	}
+
+	return hash;
+}
+
 static int prefix_list_compare_func(const struct prefix_list *a,
 				    const struct prefix_list *b)
 {
@@ -142,9 +169,8 @@ static struct prefix_list *prefix_list_lookup_do(afi_t afi, int orf,
 	if (master == NULL)
 		return NULL;
 
-	lookup.name = XSTRDUP(MTYPE_TMP, name);
+	lookup.name = (char *)name;
 	plist = plist_find(&master->str, &lookup);
-	XFREE(MTYPE_TMP, lookup.name);
 	return plist;
 }
 
@@ -282,6 +308,60 @@ prefix_list_entry_make(struct prefix *prefix, enum prefix_list_type type,
 	return pentry;
 }
 
+#define PLIST_BATCH_ADDED   (1 << 0)
+#define PLIST_BATCH_DELETED (1 << 1)
+
+static void prefix_list_notify_added(struct prefix_list *plist)
+{
+	if (plist->batch) {
+		SET_FLAG(plist->batch_events, PLIST_BATCH_ADDED);
+		return;
+	}
+
+	/* Run hook function. */
+	if (plist->master->add_hook)
+		(*plist->master->add_hook)(plist);
+
+	route_map_notify_dependencies(plist->name, RMAP_EVENT_PLIST_ADDED);
+}
+
+static void prefix_list_notify_deleted(struct prefix_list *plist)
+{
+	if (plist->batch) {
+		SET_FLAG(plist->batch_events, PLIST_BATCH_DELETED);
+		return;
+	}
+
+	route_map_notify_dependencies(plist->name, RMAP_EVENT_PLIST_DELETED);
+	if (plist->master->delete_hook)
+		(*plist->master->delete_hook)(plist);
+}
+
+void prefix_list_update_begin(struct prefix_list *plist)
+{
+	plist->batch = true;
+}
+
+void prefix_list_update_commit(struct prefix_list *plist)
+{
+	uint8_t events = plist->batch_events;
+
+	if (!plist->batch)
+		return;
+
+	plist->batch = false;
+	plist->batch_events = 0;
+
+	/*
+	 * Entries (re)installed: dependents re-evaluate the whole list
+	 * anyway, so one "added" notification covers any removals too.
+	 */
+	if (CHECK_FLAG(events, PLIST_BATCH_ADDED))
+		prefix_list_notify_added(plist);
+	else if (CHECK_FLAG(events, PLIST_BATCH_DELETED))
+		prefix_list_notify_deleted(plist);
+}
+
 /* Add hook function. */
 void prefix_list_add_hook(void (*func)(struct prefix_list *plist))
 {
@@ -384,7 +464,8 @@ static int trie_table_empty(struct pltrie_table *table)
 {
 	size_t i;
 	for (i = 0; i < PLC_LEN; i++)
-		if (table->entries[i].next_table || table->entries[i].up_chain)
+		if (table->entries[i].next_table || table->entries[i].final_chain
+		    || table->entries[i].up_chain)
 			return 0;
 	return 1;
 }
@@ -392,15 +473,17 @@ static int trie_table_empty(struct pltrie_table *table)
 static void prefix_list_trie_del(struct prefix_list *plist,
 				 struct prefix_list_entry *pentry)
 {
-	size_t depth, maxdepth = plist->master->trie_depth;
+	size_t depth;
 	uint8_t *bytes = pentry->prefix.u.val;
 	size_t validbits = pentry->prefix.prefixlen;
 	struct pltrie_table *table, **tables[PLC_MAXLEVEL];
 
 	table = plist->trie;
-	for (depth = 0; validbits > PLC_BITS && depth < maxdepth - 1; depth++) {
+	for (depth = 0; validbits > PLC_BITS; depth++) {
 		uint8_t byte = bytes[depth];
-		assert(table->entries[byte].next_table);
+
+		if (!table->entries[byte].next_table)
+			break;
 
 		tables[depth + 1] = &table->entries[byte].next_table;
 		table = table->entries[byte].next_table;
@@ -443,10 +526,7 @@ void prefix_list_entry_delete(struct prefix_list *plist,
 	plist->count--;
 
 	if (update_list) {
-		route_map_notify_dependencies(plist->name,
-					      RMAP_EVENT_PLIST_DELETED);
-		if (plist->master->delete_hook)
-			(*plist->master->delete_hook)(plist);
+		prefix_list_notify_deleted(plist);
 
 		if (plist->head == NULL && plist->tail == NULL
 		    && plist->desc == NULL)
@@ -478,27 +558,63 @@ static void trie_install_fn(struct prefix_list_entry *object,
 	*updptr = object;
 }
 
-static void prefix_list_trie_add(struct prefix_list *plist,
-				 struct prefix_list_entry *pentry)
+static void trie_install(struct pltrie_table *table, size_t depth,
+			 size_t maxdepth, struct prefix_list_entry *pentry);
+
+/* Move the final_chain of a slot at depth into a new next level. */
+static void trie_split(struct pltrie_entry *slot, size_t depth,
+		       size_t maxdepth)
 {
-	size_t depth = plist->master->trie_depth;
-	uint8_t *bytes = pentry->prefix.u.val;
-	size_t validbits = pentry->prefix.prefixlen;
-	struct pltrie_table *table;
+	struct prefix_list_entry *chain, *pentry;
 
-	table = plist->trie;
-	while (validbits > PLC_BITS && depth > 1) {
-		if (!table->entries[*bytes].next_table)
-			table->entries[*bytes].next_table =
-				XCALLOC(MTYPE_PREFIX_LIST_TRIE,
-					sizeof(struct pltrie_table));
-		table = table->entries[*bytes].next_table;
-		bytes++;
-		depth--;
+	chain = slot->final_chain;
+	slot->final_chain = NULL;
+	slot->next_table =
+		XCALLOC(MTYPE_PREFIX_LIST_TRIE, sizeof(struct pltrie_table));
+
+	while ((pentry = chain)) {
+		chain = pentry->next_best;
+		pentry->next_best = NULL;
+		trie_install(slot->next_table, depth + 1, maxdepth, pentry);
+	}
+}
+
+static void trie_install(struct pltrie_table *table, size_t depth,
+			 size_t maxdepth, struct prefix_list_entry *pentry)
+{
+	uint8_t *bytes = pentry->prefix.u.val;
+	size_t validbits = pentry->prefix.prefixlen - depth * PLC_BITS;
+	struct prefix_list_entry *walk;
+	struct pltrie_entry *slot;
+	size_t count = 0;
+
+	while (validbits > PLC_BITS && table->entries[bytes[depth]].next_table) {
+		table = table->entries[bytes[depth]].next_table;
+		depth++;
 		validbits -= PLC_BITS;
 	}
 
-	trie_walk_affected(validbits, table, *bytes, pentry, trie_install_fn);
+	if (validbits <= PLC_BITS) {
+		trie_walk_affected(validbits, table, bytes[depth], pentry,
+				   trie_install_fn);
+		return;
+	}
+
+	slot = &table->entries[bytes[depth]];
+	trie_install_fn(pentry, &slot->final_chain);
+
+	if (depth + 1 >= maxdepth)
+		return;
+	for (walk = slot->final_chain; walk; walk = walk->next_best)
+		count++;
+	if (count > PLC_CHAIN_MAX)
+		trie_split(slot, depth, maxdepth);
+}
+
+static void prefix_list_trie_add(struct prefix_list *plist,
+				 struct prefix_list_entry *pentry)
+{
+	trie_install(plist->trie, 0, plist->master->trie_depth, pentry);
 }
 
 static void prefix_list_entry_add(struct prefix_list *plist,
@@ -554,11 +670,7 @@ static void prefix_list_entry_add(struct prefix_list *plist,
 	route_map_notify_pentry_dependencies(plist->name, pentry,
 					     RMAP_EVENT_PLIST_ADDED);
 
-	/* Run hook function. */
-	if (plist->master->add_hook)
-		(*plist->master->add_hook)(plist);
-
-	route_map_notify_dependencies(plist->name, RMAP_EVENT_PLIST_ADDED);
+	prefix_list_notify_added(plist);
 	plist->master->recent = plist;
 }
 
@@ -593,9 +705,7 @@ void prefix_list_entry_update_start(struct prefix_list_entry *ple)
 					     RMAP_EVENT_PLIST_DELETED);
 	pl->count--;
 
-	route_map_notify_dependencies(pl->name, RMAP_EVENT_PLIST_DELETED);
-	if (pl->master->delete_hook)
-		(*pl->master->delete_hook)(pl);
+	prefix_list_notify_deleted(pl);
 
 	if (pl->head || pl->tail || pl->desc)
 		pl->master->recent = pl;
@@ -665,11 +775,7 @@ void prefix_list_entry_update_finish(struct prefix_list_entry *ple)
 	route_map_notify_pentry_dependencies(pl->name, ple,
 					     RMAP_EVENT_PLIST_ADDED);
 
-	/* Run hook function. */
-	if (pl->master->add_hook)
-		(*pl->master->add_hook)(pl);
-
-	route_map_notify_dependencies(pl->name, RMAP_EVENT_PLIST_ADDED);
+	prefix_list_notify_added(pl);
 	pl->master->recent = pl;
 
 	ple->installed = true;
@@ -744,9 +850,9 @@ enum prefix_list_type prefix_list_apply_ext(
 
 	const struct prefix *p = object.p;
 	const uint8_t *byte = p->u.val;
-	size_t depth;
 	size_t validbits = p->prefixlen;
 	struct pltrie_table *table;
+	struct pltrie_entry *slot;
 
 	if (plist == NULL) {
 		if (which)
@@ -760,10 +866,11 @@ enum prefix_list_type prefix_list_apply_ext(
 		return PREFIX_PERMIT;
 	}
 
-	depth = plist->master->trie_depth;
 	table = plist->trie;
 	while (1) {
-		for (pentry = table->entries[*byte].up_chain; pentry;
+		slot = &table->entries[*byte];
+
+		for (pentry = slot->up_chain; pentry;
 		     pentry = pentry->next_best) {
 			if (pbest && pbest->seq < pentry->seq)
 				continue;
@@ -775,16 +882,13 @@ enum prefix_list_type prefix_list_apply_ext(
 			break;
 		validbits -= PLC_BITS;
 
-		if (--depth) {
-			if (!table->entries[*byte].next_table)
-				break;
-
-			table = table->entries[*byte].next_table;
+		if (slot->next_table) {
+			table = slot->next_table;
 			byte++;
 			continue;
 		}
 
-		for (pentry = table->entries[*byte].final_chain; pentry;
+		for (pentry = slot->final_chain; pentry;
 		     pentry = pentry->next_best) {
 			if (pbest && pbest->seq < pentry->seq)
 				continue;
@@ -840,7 +944,7 @@ static void __attribute__((unused)) prefix_list_print(struct prefix_list *plist)
 static struct prefix_list_entry *
 prefix_entry_dup_check(struct prefix_list *plist, struct prefix_list_entry *new)
 {
-	size_t depth, maxdepth = plist->master->trie_depth;
+	size_t depth;
 	uint8_t byte, *bytes = new->prefix.u.val;
 	size_t validbits = new->prefix.prefixlen;
 	struct pltrie_table *table;
@@ -853,10 +957,10 @@ prefix_entry_dup_check(struct prefix_list *plist, struct prefix_list_entry *new)
 		seq = new->seq;
 
 	table = plist->trie;
-	for (depth = 0; validbits > PLC_BITS && depth < maxdepth - 1; depth++) {
+	for (depth = 0; validbits > PLC_BITS; depth++) {
 		byte = bytes[depth];
 		if (!table->entries[byte].next_table)
-			return NULL;
+			break;
 
 		table = table->entries[byte].next_table;
 		validbits -= PLC_BITS;
@@ -53,6 +53,17 @@ extern void prefix_list_add_hook(void (*func)(struct prefix_list *));
 extern void prefix_list_delete_hook(void (*func)(struct prefix_list *));
 
 extern const char *prefix_list_name(struct prefix_list *);
+/*
+ * Defer notifying dependents (add/delete hooks, route-map dependencies) of
+ * changes to a prefix-list's entries until prefix_list_update_commit(), which
+ * notifies them once.  Calling it again while a batch is open is a no-op.
+ * Per-entry route-map prefix table updates are not deferred.
+ */
+extern void prefix_list_update_begin(struct prefix_list *plist);
+extern void prefix_list_update_commit(struct prefix_list *plist);
+
+/* Hash of the entries of a prefix-list, 0 for a NULL prefix-list. */
+extern uint32_t prefix_list_hash(const struct prefix_list *plist);
 extern afi_t prefix_list_afi(struct prefix_list *);
 extern struct prefix_list *prefix_list_lookup(afi_t, const char *);
 
@@ -45,6 +45,10 @@ struct prefix_list {
 	struct prefix_list_entry *tail;
 
 	struct pltrie_table *trie;
+
+	/* Batched update in progress, and the notifications it deferred. */
+	bool batch;
+	uint8_t batch_events;
 };
 
 /* Each prefix-list's entry. */
@@ -1033,33 +1033,42 @@ static const char *prefixevpn2str(const struct prefix_evpn *p, char *str,
 	return str;
 }
 
-const char *prefix2str(union prefixconstptr pu, char *str, int size)
+/* IPv4/IPv6 prefix into buf (PREFIX2STR_BUFFER bytes), returns the length */
+static size_t prefix_inet2str(const struct prefix *p, char *buf)
 {
-	const struct prefix *p = pu.p;
-	char buf[PREFIX2STR_BUFFER];
 	int byte, tmp, a, b;
 	bool z = false;
 	size_t l;
 
+	inet_ntop(p->family, &p->u.prefix, buf, PREFIX2STR_BUFFER);
+	l = strlen(buf);
+	buf[l++] = '/';
+	byte = p->prefixlen;
+	tmp = p->prefixlen - 100;
+	if (tmp >= 0) {
+		buf[l++] = '1';
+		z = true;
+		byte = tmp;
+	}
+	b = byte % 10;
+	a = byte / 10;
+	if (a || z)
+		buf[l++] = '0' + a;
+	buf[l++] = '0' + b;
+	buf[l] = '\0';
+
+	return l;
+}
+
+const char *prefix2str(union prefixconstptr pu, char *str, int size)
+{
+	const struct prefix *p = pu.p;
+	char buf[PREFIX2STR_BUFFER];
+
 	switch (p->family) {
 	case AF_INET:
 	case AF_INET6:
-		inet_ntop(p->family, &p->u.prefix, buf, sizeof(buf));
-		l = strlen(buf);
-		buf[l++] = '/';
-		byte = p->prefixlen;
-		tmp = p->prefixlen - 100;
-		if (tmp >= 0) {
-			buf[l++] = '1';
-			z = true;
-			byte = tmp;
-		}
-		b = byte % 10;
-		a = byte / 10;
-		if (a || z)
-			buf[l++] = '0' + a;
-		buf[l++] = '0' + b;
-		buf[l] = '\0';
+		prefix_inet2str(p, buf);
 		strlcpy(str, buf, size);
 		break;
 
@@ -1579,9 +1588,16 @@ static ssize_t printfrr_pfx(struct fbuf *buf, struct printfrr_eargs *ea,
 	if (host_only)
 		return prefixhost2str(buf, (struct prefix *)ptr);
 	else {
-		char cbuf[PREFIX_STRLEN];
+		const struct prefix *p = ptr;
+		char cbuf[PREFIX2STR_BUFFER];
+
+		/* common case, without the copy into the caller's buffer */
+		if (p->family == AF_INET || p->family == AF_INET6) {
+			prefix_inet2str(p, cbuf);
+			return bputs(buf, cbuf);
+		}
 
-		prefix2str(ptr, cbuf, sizeof(cbuf));
+		prefix2str(p, cbuf, sizeof(cbuf));
 		return bputs(buf, cbuf);
 	}
 }
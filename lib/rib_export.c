@@ -0,0 +1,383 @@
+/*
+ * Shared memory, read-only RIB export
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <sys/mman.h>
+
+#include "memory.h"
+#include "rib_export.h"
+
+DEFINE_MTYPE_STATIC(LIB, RIB_EXPORT, "RIB export");
+
+#define RIB_EXPORT_INITIAL 1024
+
+_Static_assert(sizeof(struct rib_export_hdr) <= RIB_EXPORT_HDR_SIZE,
+	       "rib_export_hdr must fit in the space reserved for it");
+
+/* readers give up on a record being rewritten all the time */
+#define RIB_EXPORT_RETRIES 1000
+
+struct rib_export {
+	char *path;
+	int fd;
+
+	struct rib_export_hdr *hdr;
+	size_t size;
+
+	/* free slots, LIFO */
+	uint32_t *free;
+	uint32_t nfree;
+	/* slots below this were handed out at some point */
+	uint32_t next;
+};
+
+struct rib_export_reader {
+	int fd;
+	const struct rib_export_hdr *hdr;
+	size_t size;
+	uint32_t nrecs;
+};
+
+static inline size_t rib_export_file_size(uint32_t nrecs)
+{
+	return RIB_EXPORT_HDR_SIZE
+	       + (size_t)nrecs * sizeof(struct rib_export_rec);
+}
+
+static inline struct rib_export_rec *
+rib_export_rec(const struct rib_export_hdr *hdr, uint32_t slot)
+{
+	return (struct rib_export_rec *)((char *)hdr + RIB_EXPORT_HDR_SIZE) +
+	       (slot - 1);
+}
+
+struct rib_export *rib_export_create(const char *path)
+{
+	struct rib_export *rx;
+	char tmp[MAXPATHLEN];
+	struct timeval now;
+	int fd;
+
+	/* readers may still have the previous file mapped, which must not
+	 * be truncated under them;  they notice the pid going to 0
+	 */
+	snprintf(tmp, sizeof(tmp), "%s.new", path);
+	fd = open(tmp, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+	if (fd < 0)
+		return NULL;
+
+	rx = XCALLOC(MTYPE_RIB_EXPORT, sizeof(*rx));
+	rx->fd = fd;
+	rx->size = rib_export_file_size(RIB_EXPORT_INITIAL);
+	rx->free = XCALLOC(MTYPE_RIB_EXPORT,
+			   RIB_EXPORT_INITIAL * sizeof(*rx->free));
+	rx->next = 1;
+
+	if (ftruncate(fd, rx->size) < 0)
+		goto fail;
+	rx->hdr = mmap(NULL, rx->size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		       0);
+	if (rx->hdr == MAP_FAILED)
+		goto fail;
+
+	gettimeofday(&now, NULL);
+	rx->hdr->magic = RIB_EXPORT_MAGIC;
+	rx->hdr->version = RIB_EXPORT_VERSION;
+	rx->hdr->hdr_size = RIB_EXPORT_HDR_SIZE;
+	rx->hdr->rec_size = sizeof(struct rib_export_rec);
+	rx->hdr->started = now.tv_sec;
+	atomic_store_explicit(&rx->hdr->nrecs, RIB_EXPORT_INITIAL,
+			      memory_order_relaxed);
+	atomic_store_explicit(&rx->hdr->pid, getpid(), memory_order_release);
+
+	if (rename(tmp, path) < 0) {
+		munmap(rx->hdr, rx->size);
+		goto fail;
+	}
+
+	rx->path = XSTRDUP(MTYPE_RIB_EXPORT, path);
+	return rx;
+
+fail:
+	close(fd);
+	unlink(tmp);
+	XFREE(MTYPE_RIB_EXPORT, rx->free);
+	XFREE(MTYPE_RIB_EXPORT, rx);
+	return NULL;
+}
+
+void rib_export_destroy(struct rib_export **rxp)
+{
+	struct rib_export *rx = *rxp;
+
+	if (!rx)
+		return;
+
+	atomic_store_explicit(&rx->hdr->pid, 0, memory_order_release);
+	munmap(rx->hdr, rx->size);
+	close(rx->fd);
+
+	XFREE(MTYPE_RIB_EXPORT, rx->free);
+	XFREE(MTYPE_RIB_EXPORT, rx->path);
+	XFREE(MTYPE_RIB_EXPORT, rx);
+	*rxp = NULL;
+}
+
+static bool rib_export_grow(struct rib_export *rx)
+{
+	uint32_t nrecs = atomic_load_explicit(&rx->hdr->nrecs,
+					      memory_order_relaxed);
+	size_t size = rib_export_file_size(nrecs * 2);
+	void *map;
+
+	if (ftruncate(rx->fd, size) < 0)
+		return false;
+
+	/* readers keep their mapping of the part that already existed */
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, rx->fd, 0);
+	if (map == MAP_FAILED)
+		return false;
+	munmap(rx->hdr, rx->size);
+	rx->hdr = map;
+	rx->size = size;
+
+	rx->free = XREALLOC(MTYPE_RIB_EXPORT, rx->free,
+			    nrecs * 2 * sizeof(*rx->free));
+	atomic_store_explicit(&rx->hdr->nrecs, nrecs * 2,
+			      memory_order_release);
+	return true;
+}
+
+uint32_t rib_export_alloc(struct rib_export *rx)
+{
+	uint32_t nrecs;
+
+	if (rx->nfree)
+		return rx->free[--rx->nfree];
+
+	nrecs = atomic_load_explicit(&rx->hdr->nrecs, memory_order_relaxed);
+	if (rx->next > nrecs && !rib_export_grow(rx))
+		return 0;
+	return rx->next++;
+}
+
+static void rib_export_write(struct rib_export *rx, uint32_t slot,
+			     const struct rib_export_route *route)
+{
+	struct rib_export_rec *rec = rib_export_rec(rx->hdr, slot);
+	uint64_t gen = atomic_load_explicit(&rx->hdr->generation,
+					    memory_order_relaxed) + 1;
+	uint32_t seq = atomic_load_explicit(&rec->seq, memory_order_relaxed);
+
+	atomic_store_explicit(&rec->seq, seq + 1, memory_order_relaxed);
+	atomic_thread_fence(memory_order_release);
+
+	if (route)
+		rec->route = *route;
+	else
+		memset(&rec->route, 0, sizeof(rec->route));
+	rec->route.generation = gen;
+
+	atomic_store_explicit(&rec->seq, seq + 2, memory_order_release);
+	/* only published once the record is complete, see rib_export_walk */
+	atomic_store_explicit(&rx->hdr->generation, gen, memory_order_release);
+}
+
+void rib_export_set(struct rib_export *rx, uint32_t slot,
+		    const struct rib_export_route *route)
+{
+	if (!slot)
+		return;
+
+	if (!rib_export_rec(rx->hdr, slot)->route.family)
+		atomic_fetch_add_explicit(&rx->hdr->count, 1,
+					  memory_order_relaxed);
+	rib_export_write(rx, slot, route);
+}
+
+void rib_export_release(struct rib_export *rx, uint32_t slot)
+{
+	if (!slot)
+		return;
+
+	if (rib_export_rec(rx->hdr, slot)->route.family) {
+		atomic_fetch_sub_explicit(&rx->hdr->count, 1,
+					  memory_order_relaxed);
+		rib_export_write(rx, slot, NULL);
+	}
+	rx->free[rx->nfree++] = slot;
+}
+
+const char *rib_export_path(const struct rib_export *rx)
+{
+	return rx->path;
+}
+
+uint64_t rib_export_generation(const struct rib_export *rx)
+{
+	return atomic_load_explicit(&rx->hdr->generation,
+				    memory_order_relaxed);
+}
+
+uint32_t rib_export_count(const struct rib_export *rx)
+{
+	return atomic_load_explicit(&rx->hdr->count, memory_order_relaxed);
+}
+
+uint32_t rib_export_size(const struct rib_export *rx)
+{
+	return atomic_load_explicit(&rx->hdr->nrecs, memory_order_relaxed);
+}
+
+static bool rib_export_map(struct rib_export_reader *rd)
+{
+	struct stat st;
+	void *map;
+
+	if (fstat(rd->fd, &st) < 0
+	    || (size_t)st.st_size < rib_export_file_size(0))
+		return false;
+
+	map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, rd->fd, 0);
+	if (map == MAP_FAILED)
+		return false;
+	if (rd->hdr)
+		munmap((void *)rd->hdr, rd->size);
+	rd->hdr = map;
+	rd->size = st.st_size;
+
+	/* the writer grows the file before raising nrecs */
+	rd->nrecs = MIN(atomic_load_explicit(&rd->hdr->nrecs,
+					     memory_order_acquire),
+			(rd->size - RIB_EXPORT_HDR_SIZE)
+				/ sizeof(struct rib_export_rec));
+	return true;
+}
+
+struct rib_export_reader *rib_export_open(const char *path)
+{
+	struct rib_export_reader *rd;
+
+	rd = XCALLOC(MTYPE_RIB_EXPORT, sizeof(*rd));
+	rd->fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (rd->fd < 0)
+		goto fail;
+	if (!rib_export_map(rd))
+		goto fail;
+
+	if (rd->hdr->magic != RIB_EXPORT_MAGIC
+	    || rd->hdr->version != RIB_EXPORT_VERSION
+	    || rd->hdr->hdr_size != RIB_EXPORT_HDR_SIZE
+	    || rd->hdr->rec_size != sizeof(struct rib_export_rec)) {
+		errno = EPROTO;
+		goto fail;
+	}
+	return rd;
+
+fail:
+	rib_export_close(&rd);
+	return NULL;
+}
+
+void rib_export_close(struct rib_export_reader **rdp)
+{
+	struct rib_export_reader *rd = *rdp;
+	int err = errno;
+
+	if (!rd)
+		return;
+
+	if (rd->hdr)
+		munmap((void *)rd->hdr, rd->size);
+	if (rd->fd >= 0)
+		close(rd->fd);
+	XFREE(MTYPE_RIB_EXPORT, rd);
+	*rdp = NULL;
+	errno = err;
+}
+
+bool rib_export_alive(struct rib_export_reader *rd)
+{
+	pid_t pid = atomic_load_explicit(&rd->hdr->pid, memory_order_acquire);
+
+	return pid && (kill(pid, 0) == 0 || errno == EPERM);
+}
+
+uint64_t rib_export_reader_generation(struct rib_export_reader *rd)
+{
+	return atomic_load_explicit(&rd->hdr->generation,
+				    memory_order_acquire);
+}
+
+/* false if the record kept changing under us */
+static bool rib_export_read(const struct rib_export_rec *rec,
+			    struct rib_export_route *route)
+{
+	struct rib_export_rec *wrec = (struct rib_export_rec *)rec;
+	uint32_t seq1, seq2;
+	unsigned int tries;
+
+	for (tries = 0; tries < RIB_EXPORT_RETRIES; tries++) {
+		seq1 = atomic_load_explicit(&wrec->seq, memory_order_acquire);
+		if (seq1 & 1)
+			continue;
+
+		memcpy(route, &rec->route, sizeof(*route));
+		atomic_thread_fence(memory_order_acquire);
+
+		seq2 = atomic_load_explicit(&wrec->seq, memory_order_relaxed);
+		if (seq1 == seq2)
+			return true;
+	}
+	return false;
+}
+
+uint64_t rib_export_walk(struct rib_export_reader *rd, uint64_t since,
+			 int (*cb)(uint32_t slot,
+				   const struct rib_export_route *route,
+				   void *arg),
+			 void *arg)
+{
+	struct rib_export_route route;
+	uint64_t start;
+	uint32_t slot;
+
+	/* records up to this generation are complete, see rib_export_write */
+	start = atomic_load_explicit(&rd->hdr->generation,
+				     memory_order_acquire);
+
+	if (atomic_load_explicit(&rd->hdr->nrecs, memory_order_acquire)
+		    != rd->nrecs
+	    && !rib_export_map(rd))
+		return since;
+
+	for (slot = 1; slot <= rd->nrecs; slot++) {
+		if (!rib_export_read(rib_export_rec(rd->hdr, slot), &route))
+			/* make the next walk look at it again */
+			start = MIN(start, since);
+		else if (route.generation <= since
+			 || (!since && !route.family))
+			continue;
+		else if (cb(slot, &route, arg))
+			/* the rest wasn't looked at */
+			return since;
+	}
+	return start;
+}
@@ -0,0 +1,175 @@
+/*
+ * Shared memory, read-only RIB export
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_RIB_EXPORT_H
+#define _FRR_RIB_EXPORT_H
+
+#include "frratomic.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * A daemon keeps an image of its selected routes in a file, typically on
+ * tmpfs, that other processes mmap() read-only.  The image is one fixed
+ * size record per route, updated in place by the daemon's main pthread.
+ * Each record has a sequence number that is odd while it is being
+ * written, so readers retry instead of taking locks, and the daemon never
+ * waits for them.
+ *
+ * The header generation goes up with every change, and each route
+ * carries the generation it was last written at, so a consumer can poll
+ * the header and only look at what changed since its last walk.
+ *
+ * The format is versioned but host specific (byte order, alignment),
+ * the file is meant for processes on the same system.
+ */
+#define RIB_EXPORT_MAGIC 0x46525258 /* "FRRX" */
+#define RIB_EXPORT_VERSION 1
+
+#define RIB_EXPORT_NEXTHOPS 8
+
+/* nexthop flags */
+#define RIB_EXPORT_NH_ONLINK (1 << 0)
+#define RIB_EXPORT_NH_DUPLICATE (1 << 1)
+
+struct rib_export_nexthop {
+	/* enum nexthop_types_t */
+	uint8_t type;
+	uint8_t flags;
+	uint8_t weight;
+	/* 0 or 1 label, the outermost one */
+	uint8_t num_labels;
+	uint32_t label;
+	uint32_t ifindex;
+	uint32_t vrf_id;
+	/* IPv4 in the first 4 octets, or IPv6, network order */
+	uint8_t gate[16];
+};
+
+/* route flags */
+#define RIB_EXPORT_INSTALLED (1 << 0)
+#define RIB_EXPORT_QUEUED (1 << 1)
+#define RIB_EXPORT_FAILED (1 << 2)
+
+struct rib_export_route {
+	/* AF_INET or AF_INET6, 0 for an unused record */
+	uint8_t family;
+	uint8_t prefixlen;
+	uint8_t src_prefixlen;
+	/* ZEBRA_ROUTE_* of the selected route */
+	uint8_t type;
+	/* SAFI_UNICAST or SAFI_MULTICAST */
+	uint8_t safi;
+	uint8_t distance;
+	uint16_t instance;
+	uint32_t vrf_id;
+	uint32_t table;
+	uint32_t metric;
+	uint32_t mtu;
+	uint32_t tag;
+	uint32_t flags;
+	/* active nexthops, only the first RIB_EXPORT_NEXTHOPS are stored */
+	uint16_t nexthop_num;
+	uint16_t nexthop_total;
+	uint32_t reserved;
+	/* wall clock seconds of the last change of the selected route */
+	int64_t uptime;
+	/* header generation when this record was last written */
+	uint64_t generation;
+	uint8_t prefix[16];
+	uint8_t src_prefix[16];
+	struct rib_export_nexthop nexthops[RIB_EXPORT_NEXTHOPS];
+};
+
+struct rib_export_rec {
+	/* odd while the record is being written */
+	_Atomic uint32_t seq;
+	uint32_t reserved;
+	struct rib_export_route route;
+};
+
+#define RIB_EXPORT_HDR_SIZE 64
+
+struct rib_export_hdr {
+	uint32_t magic;
+	uint16_t version;
+	uint16_t hdr_size;
+	uint32_t rec_size;
+	/* records in the file, readers remap when this grows */
+	_Atomic uint32_t nrecs;
+	_Atomic uint64_t generation;
+	/* routes currently exported */
+	_Atomic uint32_t count;
+	/* writer pid, 0 once the writer has stopped */
+	_Atomic int32_t pid;
+	int64_t started;
+};
+
+/* Writer side, for the daemon.  Slots are numbered from 1 so that 0 can
+ * mean "not exported" in the daemon's own structures.
+ */
+struct rib_export;
+
+extern struct rib_export *rib_export_create(const char *path);
+/* marks the image as stopped, readers keep what they have mapped */
+extern void rib_export_destroy(struct rib_export **rxp);
+
+extern uint32_t rib_export_alloc(struct rib_export *rx);
+extern void rib_export_set(struct rib_export *rx, uint32_t slot,
+			   const struct rib_export_route *route);
+extern void rib_export_release(struct rib_export *rx, uint32_t slot);
+
+extern const char *rib_export_path(const struct rib_export *rx);
+extern uint64_t rib_export_generation(const struct rib_export *rx);
+extern uint32_t rib_export_count(const struct rib_export *rx);
+extern uint32_t rib_export_size(const struct rib_export *rx);
+
+/* Reader side, for consumers.  The reader never writes to the file. */
+struct rib_export_reader;
+
+extern struct rib_export_reader *rib_export_open(const char *path);
+extern void rib_export_close(struct rib_export_reader **rdp);
+
+/* false once the writer has stopped or exited; reopen the file then */
+extern bool rib_export_alive(struct rib_export_reader *rd);
+extern uint64_t rib_export_reader_generation(struct rib_export_reader *rd);
+
+/*
+ * Call cb with a consistent copy of every record written after generation
+ * "since".  With since = 0 that is every route in the image, otherwise
+ * removed routes are reported too, as an unused record (family 0) in the
+ * slot they had.  A consumer mirroring the image by slot number therefore
+ * stays in sync.  cb returns non-zero to stop the walk.
+ *
+ * Returns the generation the walk started at, to pass as "since" the next
+ * time.
+ */
+extern uint64_t rib_export_walk(struct rib_export_reader *rd, uint64_t since,
+				int (*cb)(uint32_t slot,
+					  const struct rib_export_route *route,
+					  void *arg),
+				void *arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_RIB_EXPORT_H */
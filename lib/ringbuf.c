@@ -71,6 +71,34 @@ size_t ringbuf_put(struct ringbuf *buf, const void *data, size_t size)
 	return copysize;
 }
 
+ssize_t ringbuf_read(struct ringbuf *buf, int fd)
+{
+	struct iovec iov[2];
+	int iovcnt = 1;
+	ssize_t nbytes;
+
+	if (ringbuf_space(buf) == 0)
+		return 0;
+
+	iov[0].iov_base = buf->data + buf->end;
+	if (buf->end < buf->start)
+		iov[0].iov_len = buf->start - buf->end;
+	else {
+		iov[0].iov_len = buf->size - buf->end;
+		iov[1].iov_base = buf->data;
+		iov[1].iov_len = buf->start;
+		iovcnt += !!buf->start;
+	}
+
+	nbytes = readv(fd, iov, iovcnt);
+	if (nbytes <= 0)
+		return nbytes;
+
+	buf->end = (buf->end + nbytes) % buf->size;
+	buf->empty = false;
+	return nbytes;
+}
+
 size_t ringbuf_get(struct ringbuf *buf, void *data, size_t size)
 {
 	uint8_t *dp = data;
@@ -77,6 +77,18 @@ size_t ringbuf_space(struct ringbuf *buf);
  */
 size_t ringbuf_put(struct ringbuf *buf, const void *data, size_t size);
 
+/*
+ * Read data from a file descriptor directly into the ring buffer.
+ *
+ * Fills as much of the free space as the descriptor provides, with a single
+ * readv() call, without going through an intermediate buffer.
+ *
+ * @param fd	the file descriptor to read from
+ * @return the return value of readv(); errno is preserved on failure.
+ * Returns 0 without reading if the buffer is full.
+ */
+ssize_t ringbuf_read(struct ringbuf *buf, int fd);
+
 /*
  * Get data from the ring buffer.
  *
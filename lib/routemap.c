@@ -850,6 +850,120 @@ void route_map_walk_update_list(void (*route_map_update_fn)(char *name))
 	}
 }
 
+/* Content hash of the list of the given dependency type named "name". */
+static bool route_map_dep_content(route_map_event_t type, const char *name,
+				  uint32_t *hash)
+{
+	switch (type) {
+	case RMAP_EVENT_PLIST_ADDED:
+		*hash = jhash_2words(
+			prefix_list_hash(prefix_list_lookup(AFI_IP, name)),
+			prefix_list_hash(prefix_list_lookup(AFI_IP6, name)), 0);
+		return true;
+	case RMAP_EVENT_CLIST_ADDED:
+	case RMAP_EVENT_ECLIST_ADDED:
+	case RMAP_EVENT_LLIST_ADDED:
+	case RMAP_EVENT_ASLIST_ADDED:
+	case RMAP_EVENT_FILTER_ADDED:
+		if (!route_map_master.content_hook)
+			return false;
+		return (*route_map_master.content_hook)(type, name, hash);
+	default:
+		/* not a dependency on a named list */
+		*hash = 0;
+		return true;
+	}
+}
+
+static bool route_map_rule_hash(const struct route_map_rule *rule,
+				uint32_t *hash)
+{
+	const char *key = rule->rule_str;
+	uint32_t dep = 0;
+
+	*hash = jhash(rule->cmd->str, strlen(rule->cmd->str), *hash);
+	if (!rule->rule_str)
+		return true;
+
+	*hash = jhash(rule->rule_str, strlen(rule->rule_str), *hash);
+
+	if (rule->value && rule->cmd->func_get_rmap_rule_key)
+		key = (*rule->cmd->func_get_rmap_rule_key)(rule->value);
+	if (!route_map_dep_content(rule->dep_type, key, &dep))
+		return false;
+
+	*hash = jhash_1word(dep, *hash);
+	return true;
+}
+
+/*
+ * Hash everything affecting the result of applying a route-map.  The
+ * description and applied counters are deliberately left out.
+ */
+static bool route_map_content_hash(const struct route_map *map,
+				   unsigned int depth, uint32_t *hash)
+{
+	const struct route_map_index *index;
+	const struct route_map_rule *rule;
+	uint32_t h = 0;
+
+	if (depth > RMAP_RECURSION_LIMIT)
+		return false;
+
+	for (index = map->head; index; index = index->next) {
+		h = jhash_3words(index->pref, index->type, index->exitpolicy,
+				 h);
+		h = jhash_1word(index->nextpref, h);
+
+		if (index->nextrm) {
+			struct route_map *called;
+			uint32_t ch = 0;
+
+			h = jhash(index->nextrm, strlen(index->nextrm), h);
+			called = route_map_lookup_by_name(index->nextrm);
+			if (called
+			    && !route_map_content_hash(called, depth + 1, &ch))
+				return false;
+			h = jhash_1word(ch, h);
+		}
+
+		for (rule = index->match_list.head; rule; rule = rule->next)
+			if (!route_map_rule_hash(rule, &h))
+				return false;
+		for (rule = index->set_list.head; rule; rule = rule->next)
+			if (!route_map_rule_hash(rule, &h))
+				return false;
+	}
+
+	*hash = h;
+	return true;
+}
+
+bool route_map_content_changed(const char *name)
+{
+	struct route_map *map;
+	uint32_t hash;
+
+	map = route_map_lookup_by_name(name);
+	if (!map)
+		return true;
+
+	if (!route_map_content_hash(map, 0, &hash)) {
+		map->content_valid = false;
+		return true;
+	}
+
+	if (map->content_valid && map->content_hash == hash) {
+		if (rmap_debug)
+			zlog_debug("Route-map %s content unchanged", name);
+		return false;
+	}
+
+	map->content_hash = hash;
+	map->content_valid = true;
+	return true;
+}
+
 /* Return route map's type string. */
 static const char *route_map_type_str(enum route_map_type type)
 {
@@ -1517,6 +1631,7 @@ enum rmap_compile_rets route_map_add_match(struct route_map_index *index,
 	rule = route_map_rule_new();
 	rule->cmd = cmd;
 	rule->value = compile;
+	rule->dep_type = type;
 	if (match_arg)
 		rule->rule_str = XSTRDUP(MTYPE_ROUTE_MAP_RULE_STR, match_arg);
 	else
@@ -2754,6 +2869,12 @@ void route_map_event_hook(void (*func)(const char *name))
 	route_map_master.event_hook = func;
 }
 
+void route_map_content_hook(bool (*func)(route_map_event_t type,
+					 const char *name, uint32_t *hash))
+{
+	route_map_master.content_hook = func;
+}
+
 /* Routines for route map dependency lists and dependency processing */
 static bool route_map_rmap_hash_cmp(const void *p1, const void *p2)
 {
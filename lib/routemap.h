@@ -142,6 +142,9 @@ struct route_map_rule {
 	/* Pre-compiled match rule. */
 	void *value;
 
+	/* Dependency event type a match rule was added with. */
+	route_map_event_t dep_type;
+
 	/* Linked list. */
 	struct route_map_rule *next;
 	struct route_map_rule *prev;
@@ -218,6 +221,10 @@ struct route_map {
 	bool deleted;         /* If 1, then this node will be deleted */
 	bool optimization_disabled;
 
+	/* Content hash as of the last route_map_content_changed() call */
+	uint32_t content_hash;
+	bool content_valid;
+
 	/* How many times have we applied this route-map */
 	uint64_t applied;
 	uint64_t applied_clear;
@@ -504,6 +511,25 @@ extern void route_map_delete_hook(void (*func)(const char *));
 extern void route_map_event_hook(void (*func)(const char *name));
 extern int route_map_mark_updated(const char *name);
 extern void route_map_walk_update_list(void (*update_fn)(char *name));
+
+/*
+ * Check whether a route-map, including the prefix-lists, community-lists
+ * and route-maps it uses, changed since the last call for it.  Daemons use
+ * this from their update_fn to skip re-evaluating routes when definitions
+ * were re-applied with identical content.
+ *
+ * Returns true on the first call, for deleted route-maps, and when the
+ * route-map depends on lists whose content can't be hashed.
+ */
+extern bool route_map_content_changed(const char *name);
+
+/*
+ * Daemon specific content hash of the lists route-map match rules of the
+ * given dependency type refer to.  Returns false if not supported.
+ */
+extern void route_map_content_hook(bool (*func)(route_map_event_t type,
+						const char *name,
+						uint32_t *hash));
 extern void route_map_upd8_dependency(route_map_event_t type, const char *arg,
 				      const char *rmap_name);
 extern void route_map_notify_dependencies(const char *affected_name,
@@ -953,6 +979,8 @@ struct route_map_list {
 	void (*add_hook)(const char *);
 	void (*delete_hook)(const char *);
 	void (*event_hook)(const char *);
+	bool (*content_hook)(route_map_event_t type, const char *name,
+			     uint32_t *hash);
 };
 
 extern struct route_map_list route_map_master;
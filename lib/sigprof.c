@@ -0,0 +1,587 @@
+/*
+ * SIGPROF based sampling profiler
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <dlfcn.h>
+#include <signal.h>
+#include <sys/time.h>
+
+#ifdef HAVE_LIBUNWIND
+#define UNW_LOCAL_ONLY
+#include <libunwind.h>
+#endif
+
+#include "atomring.h"
+#include "command.h"
+#include "hook.h"
+#include "jhash.h"
+#include "json.h"
+#include "libfrr.h"
+#include "lib_errors.h"
+#include "memory.h"
+#include "monotime.h"
+#include "sigprof.h"
+#include "thread.h"
+#include "typesafe.h"
+#include "vty.h"
+
+#include "lib/sigprof_clippy.c"
+
+DEFINE_MTYPE_STATIC(LIB, SIGPROF_SAMPLES, "Profiler samples");
+DEFINE_MTYPE_STATIC(LIB, SIGPROF_STACK, "Profiler stack");
+
+/*
+ * Linux can point a per-pthread CPU clock timer at its own pthread, so
+ * every pthread is sampled according to the CPU it uses.  Elsewhere a
+ * process-wide ITIMER_PROF is used, which only the main pthread receives
+ * since all other pthreads block signals.
+ */
+#if defined(__linux__) && defined(SIGEV_THREAD_ID)
+#define SIGPROF_PER_PTHREAD
+#include <sys/syscall.h>
+#ifndef sigev_notify_thread_id
+#define sigev_notify_thread_id _sigev_un._tid
+#endif
+#endif
+
+#define SIGPROF_DEFAULT_HZ 99
+#define SIGPROF_DEPTH 32
+/* frames of the handler itself and of the signal trampoline */
+#define SIGPROF_SKIP 2
+/* samples in flight between the handlers and the main pthread */
+#define SIGPROF_POOL 4096
+#define SIGPROF_DRAIN_MSEC 100
+
+struct sigprof_sample {
+	char tname[16];
+	const struct xref_threadsched *xref;
+	unsigned int depth;
+	void *pc[SIGPROF_DEPTH];
+};
+
+PREDECL_HASH(sigprof_stacks);
+
+struct sigprof_stack {
+	struct sigprof_stacks_item item;
+	uint64_t count;
+	struct sigprof_sample s;
+};
+
+static int sigprof_stack_cmp(const struct sigprof_stack *a,
+			     const struct sigprof_stack *b)
+{
+	int ret;
+
+	if (a->s.xref != b->s.xref)
+		return a->s.xref < b->s.xref ? -1 : 1;
+	if (a->s.depth != b->s.depth)
+		return a->s.depth < b->s.depth ? -1 : 1;
+	ret = strcmp(a->s.tname, b->s.tname);
+	if (ret)
+		return ret;
+	return memcmp(a->s.pc, b->s.pc, a->s.depth * sizeof(a->s.pc[0]));
+}
+
+static uint32_t sigprof_stack_hash(const struct sigprof_stack *a)
+{
+	uint32_t h;
+
+	h = jhash(a->s.tname, strlen(a->s.tname), (uintptr_t)a->s.xref);
+	return jhash(a->s.pc, a->s.depth * sizeof(a->s.pc[0]), h);
+}
+
+DECLARE_HASH(sigprof_stacks, struct sigprof_stack, item, sigprof_stack_cmp,
+	     sigprof_stack_hash);
+
+static struct sigprof {
+	struct thread_master *master;
+	struct thread *t_drain;
+
+	/* samples cycle from free, through a handler, to full and back */
+	struct atomring *free;
+	struct atomring *full;
+	struct sigprof_sample *pool;
+
+	/* checked by the handlers */
+	atomic_bool running;
+	atomic_uint_fast64_t dropped;
+
+	unsigned int hz;
+	struct timeval started, stopped;
+
+	uint64_t samples;
+	struct sigprof_stacks_head stacks;
+} sp;
+
+#ifdef SIGPROF_PER_PTHREAD
+static __thread bool sp_armed;
+static __thread bool sp_was_blocked;
+static __thread timer_t sp_timer;
+#endif
+
+static void sigprof_handler(int signo, siginfo_t *info, void *context)
+{
+	struct sigprof_sample *s;
+	struct thread *thread;
+	const char *name;
+	void *pc[SIGPROF_DEPTH + SIGPROF_SKIP];
+	int depth = 0, saved_errno = errno;
+	size_t i;
+
+	if (!atomic_load_explicit(&sp.running, memory_order_relaxed))
+		return;
+
+	s = atomring_pop(sp.free);
+	if (!s) {
+		atomic_fetch_add_explicit(&sp.dropped, 1,
+					  memory_order_relaxed);
+		errno = saved_errno;
+		return;
+	}
+
+	/* set by thread_call() on this pthread, so it can't go away here */
+	thread = pthread_getspecific(thread_current);
+	s->xref = thread ? thread->xref : NULL;
+
+	name = thread ? (thread->master->name ? thread->master->name : "main")
+		      : "-";
+	for (i = 0; i < sizeof(s->tname) - 1 && name[i]; i++)
+		s->tname[i] = name[i];
+	s->tname[i] = '\0';
+
+#ifdef HAVE_LIBUNWIND
+	depth = unw_backtrace(pc, array_size(pc));
+#elif defined(HAVE_GLIBC_BACKTRACE)
+	depth = backtrace(pc, array_size(pc));
+#endif
+	depth -= SIGPROF_SKIP;
+	s->depth = depth > 0 ? depth : 0;
+	memcpy(s->pc, pc + SIGPROF_SKIP, s->depth * sizeof(s->pc[0]));
+
+	/* can't fail, the ring has room for the whole pool */
+	atomring_push(sp.full, s);
+
+	errno = saved_errno;
+}
+
+#ifdef SIGPROF_PER_PTHREAD
+/* Runs on each event loop's pthread */
+static void sigprof_arm(struct thread *t)
+{
+	struct sigevent sev = {};
+	struct itimerspec its = {};
+	sigset_t set, old;
+
+	if (sp_armed || !atomic_load_explicit(&sp.running,
+					      memory_order_relaxed))
+		return;
+
+	sev.sigev_notify = SIGEV_THREAD_ID;
+	sev.sigev_signo = SIGPROF;
+	sev.sigev_notify_thread_id = syscall(__NR_gettid);
+
+	if (timer_create(CLOCK_THREAD_CPUTIME_ID, &sev, &sp_timer) < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "profiler: timer_create() failed: %s",
+			     safe_strerror(errno));
+		return;
+	}
+
+	its.it_interval.tv_nsec = 1000000000L / sp.hz;
+	its.it_value = its.it_interval;
+	timer_settime(sp_timer, 0, &its, NULL);
+
+	/* background pthreads run with all signals blocked */
+	sigemptyset(&set);
+	sigaddset(&set, SIGPROF);
+	pthread_sigmask(SIG_UNBLOCK, &set, &old);
+	sp_was_blocked = sigismember(&old, SIGPROF);
+
+	sp_armed = true;
+}
+
+static void sigprof_disarm(struct thread *t)
+{
+	sigset_t set;
+
+	if (!sp_armed)
+		return;
+
+	timer_delete(sp_timer);
+
+	if (sp_was_blocked) {
+		sigemptyset(&set);
+		sigaddset(&set, SIGPROF);
+		pthread_sigmask(SIG_BLOCK, &set, NULL);
+	}
+
+	sp_armed = false;
+}
+#endif /* SIGPROF_PER_PTHREAD */
+
+static void sigprof_drain(struct thread *t)
+{
+	struct sigprof_sample *s;
+	struct sigprof_stack ref, *stack;
+
+	while ((s = atomring_pop(sp.full))) {
+		ref.s = *s;
+		atomring_push(sp.free, s);
+
+		stack = sigprof_stacks_find(&sp.stacks, &ref);
+		if (!stack) {
+			stack = XCALLOC(MTYPE_SIGPROF_STACK, sizeof(*stack));
+			stack->s = ref.s;
+			sigprof_stacks_add(&sp.stacks, stack);
+		}
+		stack->count++;
+		sp.samples++;
+	}
+
+	if (atomic_load_explicit(&sp.running, memory_order_relaxed))
+		thread_add_timer_msec(sp.master, sigprof_drain, NULL,
+				      SIGPROF_DRAIN_MSEC, &sp.t_drain);
+}
+
+bool sigprof_start(unsigned int hz)
+{
+	struct sigaction sa = {};
+	void *warmup[4];
+	size_t i;
+
+	if (atomic_load_explicit(&sp.running, memory_order_relaxed))
+		return false;
+
+	if (!sp.pool) {
+		sp.pool = XCALLOC(MTYPE_SIGPROF_SAMPLES,
+				  SIGPROF_POOL * sizeof(sp.pool[0]));
+		sp.free = atomring_new(SIGPROF_POOL);
+		sp.full = atomring_new(SIGPROF_POOL);
+		for (i = 0; i < SIGPROF_POOL; i++)
+			atomring_push(sp.free, &sp.pool[i]);
+	}
+
+	/* the first backtrace may allocate, don't let that be in the handler */
+#ifdef HAVE_LIBUNWIND
+	unw_backtrace(warmup, array_size(warmup));
+#elif defined(HAVE_GLIBC_BACKTRACE)
+	backtrace(warmup, array_size(warmup));
+#endif
+	(void)warmup;
+
+	sa.sa_sigaction = sigprof_handler;
+	sa.sa_flags = SA_SIGINFO | SA_RESTART;
+	sigemptyset(&sa.sa_mask);
+	sigaction(SIGPROF, &sa, NULL);
+
+	sp.hz = hz;
+	monotime(&sp.started);
+	atomic_store_explicit(&sp.running, true, memory_order_relaxed);
+
+#ifdef SIGPROF_PER_PTHREAD
+	thread_master_broadcast(sigprof_arm, NULL);
+#else
+	struct itimerval itv = {};
+
+	itv.it_interval.tv_usec = 1000000 / hz;
+	itv.it_value = itv.it_interval;
+	setitimer(ITIMER_PROF, &itv, NULL);
+#endif
+
+	thread_add_timer_msec(sp.master, sigprof_drain, NULL,
+			      SIGPROF_DRAIN_MSEC, &sp.t_drain);
+	return true;
+}
+
+void sigprof_stop(void)
+{
+	if (!atomic_load_explicit(&sp.running, memory_order_relaxed))
+		return;
+
+	atomic_store_explicit(&sp.running, false, memory_order_relaxed);
+	monotime(&sp.stopped);
+
+#ifdef SIGPROF_PER_PTHREAD
+	thread_master_broadcast(sigprof_disarm, NULL);
+#else
+	struct itimerval itv = {};
+
+	setitimer(ITIMER_PROF, &itv, NULL);
+#endif
+
+	/* late samples are dropped by the handlers, pick up the rest */
+	THREAD_OFF(sp.t_drain);
+	sigprof_drain(NULL);
+}
+
+static void sigprof_clear(void)
+{
+	struct sigprof_stack *stack;
+
+	while ((stack = sigprof_stacks_pop(&sp.stacks)))
+		XFREE(MTYPE_SIGPROF_STACK, stack);
+
+	sp.samples = 0;
+	atomic_store_explicit(&sp.dropped, 0, memory_order_relaxed);
+	monotime(&sp.started);
+	sp.stopped = sp.started;
+}
+
+static const char *sigprof_event_name(const struct sigprof_sample *s)
+{
+	return s->xref ? s->xref->funcname : "(event loop)";
+}
+
+/* Per pthread and event totals, summed up from the stacks */
+struct sigprof_event {
+	const char *tname;
+	const char *funcname;
+	uint64_t count;
+};
+
+static int sigprof_event_cmp(const void *a, const void *b)
+{
+	const struct sigprof_event *ea = a, *eb = b;
+
+	if (ea->count != eb->count)
+		return ea->count < eb->count ? 1 : -1;
+	return strcmp(ea->funcname, eb->funcname);
+}
+
+static struct sigprof_event *sigprof_events(size_t *countp)
+{
+	struct sigprof_event *events;
+	const struct sigprof_stack *stack;
+	const char *funcname;
+	size_t n = 0, i;
+
+	events = XCALLOC(MTYPE_TMP, (sigprof_stacks_count(&sp.stacks) + 1) *
+					    sizeof(events[0]));
+
+	frr_each (sigprof_stacks_const, &sp.stacks, stack) {
+		funcname = sigprof_event_name(&stack->s);
+		for (i = 0; i < n; i++)
+			if (events[i].funcname == funcname &&
+			    !strcmp(events[i].tname, stack->s.tname))
+				break;
+		if (i == n) {
+			events[n].tname = stack->s.tname;
+			events[n].funcname = funcname;
+			n++;
+		}
+		events[i].count += stack->count;
+	}
+
+	qsort(events, n, sizeof(events[0]), sigprof_event_cmp);
+	*countp = n;
+	return events;
+}
+
+static int64_t sigprof_elapsed_msec(void)
+{
+	struct timeval now;
+
+	if (atomic_load_explicit(&sp.running, memory_order_relaxed))
+		monotime(&now);
+	else
+		now = sp.stopped;
+
+	return monotime_since(&sp.started, &now) / 1000;
+}
+
+DEFPY (profile_start,
+       profile_start_cmd,
+       "profile start [frequency (1-1000)$hz]",
+       "Sampling CPU profiler\n"
+       "Start sampling\n"
+       "Sampling frequency, per second of CPU time used\n"
+       "Samples per second\n")
+{
+	if (!sigprof_start(hz_str ? hz : SIGPROF_DEFAULT_HZ)) {
+		vty_out(vty, "%% Profiler is already running\n");
+		return CMD_WARNING;
+	}
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (profile_stop,
+       profile_stop_cmd,
+       "profile stop",
+       "Sampling CPU profiler\n"
+       "Stop sampling, keeping the samples taken\n")
+{
+	sigprof_stop();
+	return CMD_SUCCESS;
+}
+
+DEFPY (clear_profile,
+       clear_profile_cmd,
+       "clear profile",
+       CLEAR_STR
+       "Sampling CPU profiler samples\n")
+{
+	sigprof_clear();
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_profile,
+       show_profile_cmd,
+       "show profile [json$uj]",
+       SHOW_STR
+       "Sampling CPU profiler\n"
+       JSON_STR)
+{
+	struct sigprof_event *events;
+	json_object *json = NULL, *json_events = NULL, *json_event;
+	bool running;
+	size_t n, i;
+
+	running = atomic_load_explicit(&sp.running, memory_order_relaxed);
+	events = sigprof_events(&n);
+
+	if (uj) {
+		json = json_object_new_object();
+		json_object_boolean_add(json, "running", running);
+		json_object_int_add(json, "frequency", sp.hz);
+		json_object_int_add(json, "elapsedMsec",
+				    sigprof_elapsed_msec());
+		json_object_int_add(json, "samples", sp.samples);
+		json_object_int_add(json, "dropped",
+				    atomic_load_explicit(&sp.dropped,
+							 memory_order_relaxed));
+		json_object_int_add(json, "stacks",
+				    sigprof_stacks_count(&sp.stacks));
+		json_events = json_object_new_array();
+		json_object_object_add(json, "events", json_events);
+	} else {
+		vty_out(vty, "Profiler %s, %u Hz, %" PRId64 " ms\n",
+			running ? "running" : "stopped", sp.hz,
+			sigprof_elapsed_msec());
+		vty_out(vty,
+			"Samples: %" PRIu64 ", dropped: %" PRIu64
+			", distinct stacks: %zu\n\n",
+			sp.samples,
+			(uint64_t)atomic_load_explicit(&sp.dropped,
+						       memory_order_relaxed),
+			sigprof_stacks_count(&sp.stacks));
+		vty_out(vty, "%-15s %-40s %10s %6s\n", "Pthread", "Event",
+			"Samples", "%");
+	}
+
+	for (i = 0; i < n; i++) {
+		if (uj) {
+			json_event = json_object_new_object();
+			json_object_string_add(json_event, "pthread",
+					       events[i].tname);
+			json_object_string_add(json_event, "event",
+					       events[i].funcname);
+			json_object_int_add(json_event, "samples",
+					    events[i].count);
+			json_object_array_add(json_events, json_event);
+			continue;
+		}
+		vty_out(vty, "%-15s %-40s %10" PRIu64 " %6.2f\n",
+			events[i].tname, events[i].funcname, events[i].count,
+			100.0 * events[i].count / sp.samples);
+	}
+
+	XFREE(MTYPE_TMP, events);
+
+	if (uj)
+		vty_json(vty, json);
+	return CMD_SUCCESS;
+}
+
+static void sigprof_frame(struct vty *vty, void *pc)
+{
+	Dl_info info;
+	const char *file;
+
+	if (!dladdr(pc, &info) || !info.dli_fname) {
+		vty_out(vty, ";%p", pc);
+		return;
+	}
+	if (info.dli_sname) {
+		vty_out(vty, ";%s", info.dli_sname);
+		return;
+	}
+
+	file = strrchr(info.dli_fname, '/');
+	file = file ? file + 1 : info.dli_fname;
+	vty_out(vty, ";%s+%#tx", file,
+		(ptrdiff_t)((char *)pc - (char *)info.dli_fbase));
+}
+
+DEFPY (show_profile_folded,
+       show_profile_folded_cmd,
+       "show profile folded",
+       SHOW_STR
+       "Sampling CPU profiler\n"
+       "Folded stacks, for flamegraph.pl and similar tools\n")
+{
+	const struct sigprof_stack *stack;
+	unsigned int i;
+
+	/* root frames are daemon, pthread and event; then outermost first */
+	frr_each (sigprof_stacks_const, &sp.stacks, stack) {
+		vty_out(vty, "%s;%s;%s", frr_get_progname(), stack->s.tname,
+			sigprof_event_name(&stack->s));
+		for (i = stack->s.depth; i > 0; i--)
+			sigprof_frame(vty, stack->s.pc[i - 1]);
+		vty_out(vty, " %" PRIu64 "\n", stack->count);
+	}
+
+	return CMD_SUCCESS;
+}
+
+static int sigprof_late_init(struct thread_master *master)
+{
+	sp.master = master;
+	return 0;
+}
+
+static int sigprof_fini(void)
+{
+	sigprof_stop();
+	sigprof_clear();
+	sigprof_stacks_fini(&sp.stacks);
+
+	if (sp.pool) {
+		atomring_free(&sp.free);
+		atomring_free(&sp.full);
+		XFREE(MTYPE_SIGPROF_SAMPLES, sp.pool);
+	}
+	return 0;
+}
+
+void sigprof_cmd_init(void)
+{
+	sigprof_stacks_init(&sp.stacks);
+
+	hook_register(frr_late_init, sigprof_late_init);
+	hook_register(frr_fini, sigprof_fini);
+
+	install_element(VIEW_NODE, &show_profile_cmd);
+	install_element(VIEW_NODE, &show_profile_folded_cmd);
+	install_element(ENABLE_NODE, &profile_start_cmd);
+	install_element(ENABLE_NODE, &profile_stop_cmd);
+	install_element(ENABLE_NODE, &clear_profile_cmd);
+}
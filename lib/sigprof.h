@@ -0,0 +1,41 @@
+/*
+ * SIGPROF based sampling profiler
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _FRR_SIGPROF_H
+#define _FRR_SIGPROF_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * The profiler is idle until "profile start" is issued.  While running,
+ * each event loop pthread gets a SIGPROF for every 1/hz seconds of CPU time
+ * it uses; the handler records the running event (struct thread xref) and
+ * a backtrace, which the main pthread aggregates into folded stacks.
+ */
+extern bool sigprof_start(unsigned int hz);
+extern void sigprof_stop(void);
+extern void sigprof_cmd_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _FRR_SIGPROF_H */
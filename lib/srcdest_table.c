@@ -29,6 +29,7 @@
 #include "prefix.h"
 #include "table.h"
 #include "printfrr.h"
+#include "jhash.h"
 
 DEFINE_MTYPE_STATIC(LIB, ROUTE_SRC_NODE, "Route source node");
 
@@ -84,6 +85,42 @@ route_table_delegate_t _srcdest_dstnode_delegate = {
 
 /* ----- functions to manage rnodes _in_ srcdest table ----- */
 
+/* The source tables don't keep a hash index of their own (most have a few
+ * entries), but some destinations - typically ::/0 - have lots of sources.
+ * Exact-match lookups of (destination, source) go through one index shared
+ * by all source tables instead, so they don't walk the source trie. */
+PREDECL_HASH(srcdest_sn);
+
+struct srcdest_srcnode {
+	/* must be first in structure for casting to/from route_node */
+	ROUTE_NODE_FIELDS;
+
+	/* destination node, NULL if not in the index */
+	struct srcdest_rnode *dst;
+	struct srcdest_sn_item sn_item;
+};
+
+static int srcdest_sn_cmp(const struct srcdest_srcnode *a,
+			  const struct srcdest_srcnode *b)
+{
+	if (a->dst != b->dst)
+		return a->dst < b->dst ? -1 : 1;
+	return prefix_cmp(&a->p, &b->p);
+}
+
+static uint32_t srcdest_sn_hash(const struct srcdest_srcnode *sn)
+{
+	return jhash_2words((uint32_t)(uintptr_t)sn->dst,
+			    prefix_hash_key(&sn->p), 0xd5e7);
+}
+
+DECLARE_HASH(srcdest_sn, struct srcdest_srcnode, sn_item, srcdest_sn_cmp,
+	     srcdest_sn_hash);
+
+static struct srcdest_sn_head srcdest_sn_index[1] = {
+	INIT_HASH(srcdest_sn_index[0]),
+};
+
 /* node creation / deletion for srcdest source prefix nodes.
  * the route_node isn't actually different from the normal route_node,
  * but the cleanup is special to free the table (and possibly the
@@ -93,15 +130,18 @@ static struct route_node *
 srcdest_srcnode_create(route_table_delegate_t *delegate,
 		       struct route_table *table)
 {
-	return XCALLOC(MTYPE_ROUTE_SRC_NODE, sizeof(struct route_node));
+	return XCALLOC(MTYPE_ROUTE_SRC_NODE, sizeof(struct srcdest_srcnode));
 }
 
 static void srcdest_srcnode_destroy(route_table_delegate_t *delegate,
 				    struct route_table *table,
 				    struct route_node *rn)
 {
+	struct srcdest_srcnode *sn = (struct srcdest_srcnode *)rn;
 	struct srcdest_rnode *srn;
 
+	if (sn->dst)
+		srcdest_sn_del(srcdest_sn_index, sn);
 	XFREE(MTYPE_ROUTE_SRC_NODE, rn);
 
 	srn = route_table_get_info(table);
@@ -124,18 +164,41 @@ static void srcdest_srcnode_destroy(route_table_delegate_t *delegate,
 
 route_table_delegate_t _srcdest_srcnode_delegate = {
 	.create_node = srcdest_srcnode_create,
-	.destroy_node = srcdest_srcnode_destroy};
+	.destroy_node = srcdest_srcnode_destroy,
+	/* exact-match lookups use srcdest_sn_index */
+	.nohash = true};
+
+/* Find the source node of an existing destination node in the index. */
+static struct srcdest_srcnode *
+srcdest_srcnode_find(struct srcdest_rnode *srn,
+		     const struct prefix_ipv6 *src_p)
+{
+	struct srcdest_srcnode search;
+
+	search.dst = srn;
+	prefix_copy(&search.p, (const struct prefix *)src_p);
+	apply_mask(&search.p);
+
+	return srcdest_sn_find(srcdest_sn_index, &search);
+}
 
 /* NB: read comments in code for refcounting before using! */
 static struct route_node *srcdest_srcnode_get(struct route_node *rn,
 					      const struct prefix_ipv6 *src_p)
 {
 	struct srcdest_rnode *srn;
+	struct srcdest_srcnode *sn;
 
 	if (!src_p || src_p->prefixlen == 0)
 		return rn;
 
 	srn = srcdest_rnode_from_rnode(rn);
+	if (srn->src_table && (sn = srcdest_srcnode_find(srn, src_p))) {
+		/* same as below, the src_table holds a reference on rn */
+		route_unlock_node(rn);
+		return route_lock_node((struct route_node *)sn);
+	}
+
 	if (!srn->src_table) {
 		/* this won't use srcdest_rnode, we're already on the source
 		 * here */
@@ -159,7 +222,13 @@ static struct route_node *srcdest_srcnode_get(struct route_node *rn,
 		route_unlock_node(rn);
 	}
 
-	return route_node_get(srn->src_table, (const struct prefix *)src_p);
+	sn = (struct srcdest_srcnode *)route_node_get(
+		srn->src_table, (const struct prefix *)src_p);
+	if (!sn->dst) {
+		sn->dst = srn;
+		srcdest_sn_add(srcdest_sn_index, sn);
+	}
+	return (struct route_node *)sn;
 }
 
 static struct route_node *srcdest_srcnode_lookup(
@@ -167,6 +236,7 @@ static struct route_node *srcdest_srcnode_lookup(
 	const struct prefix_ipv6 *src_p)
 {
 	struct srcdest_rnode *srn;
+	struct srcdest_srcnode *sn;
 
 	if (!rn || !src_p || src_p->prefixlen == 0)
 		return rn;
@@ -182,7 +252,12 @@ static struct route_node *srcdest_srcnode_lookup(
 	if (!srn->src_table)
 		return NULL;
 
-	return route_node_lookup(srn->src_table, (const struct prefix *)src_p);
+	/* like route_node_lookup(), only nodes carrying info */
+	sn = srcdest_srcnode_find(srn, src_p);
+	if (!sn || !sn->info)
+		return NULL;
+
+	return route_lock_node((struct route_node *)sn);
 }
 
 /* ----- exported functions ----- */
@@ -312,15 +387,16 @@ static ssize_t printfrr_rn(struct fbuf *buf, struct printfrr_eargs *ea,
 {
 	const struct route_node *rn = ptr;
 	const struct prefix *dst_p, *src_p;
-	char cbuf[PREFIX_STRLEN * 2 + 6];
+	ssize_t ret;
 
 	if (!rn)
 		return bputs(buf, "(null)");
 
 	srcdest_rnode_prefixes(rn, &dst_p, &src_p);
-	srcdest2str(dst_p, (const struct prefix_ipv6 *)src_p,
-		    cbuf, sizeof(cbuf));
-	return bputs(buf, cbuf);
+	ret = bprintfrr(buf, "%pFX", dst_p);
+	if (src_p && src_p->prefixlen)
+		ret += bprintfrr(buf, " from %pFX", src_p);
+	return ret;
 }
 
 struct route_table *srcdest_srcnode_table(struct route_node *rn)
@@ -52,6 +52,7 @@ route_table_init_with_delegate(route_table_delegate_t *delegate)
 
 	rt = XCALLOC(MTYPE_ROUTE_TABLE, sizeof(struct route_table));
 	rt->delegate = delegate;
+	rt->nohash = delegate->nohash;
 	rn_hash_node_init(&rt->hash);
 	return rt;
 }
@@ -78,7 +79,8 @@ static struct route_node *route_node_set(struct route_table *table,
 	prefix_copy(&node->p, prefix);
 	node->table = table;
 
-	rn_hash_node_add(&node->table->hash, node);
+	if (!table->nohash)
+		rn_hash_node_add(&table->hash, node);
 
 	return node;
 }
@@ -122,7 +124,8 @@ static void route_table_free(struct route_table *rt)
 		tmp_node->table->count--;
 		tmp_node->lock =
 			0; /* to cause assert if unlocked after this */
-		rn_hash_node_del(&rt->hash, tmp_node);
+		if (!rt->nohash)
+			rn_hash_node_del(&rt->hash, tmp_node);
 		route_node_free(rt, tmp_node);
 
 		if (node != NULL) {
@@ -192,6 +195,28 @@ static void set_link(struct route_node *node, struct route_node *new)
 	new->parent = node;
 }
 
+/* Find the node with exactly the prefix of search, with or without info. */
+static struct route_node *route_node_find(struct route_table *table,
+					  const struct route_node *search)
+{
+	const struct prefix *p = &search->p;
+	struct route_node *node;
+
+	if (!table->nohash)
+		return rn_hash_node_find(&table->hash, search);
+
+	node = table->top;
+	while (node && node->p.prefixlen <= p->prefixlen
+	       && prefix_match(&node->p, p)) {
+		if (node->p.prefixlen == p->prefixlen)
+			return node;
+
+		node = node->link[prefix_bit(&p->u.prefix, node->p.prefixlen)];
+	}
+
+	return NULL;
+}
+
 /* Find matched prefix. */
 struct route_node *route_node_match(struct route_table *table,
 				    union prefixconstptr pu)
@@ -257,7 +282,7 @@ struct route_node *route_node_lookup(struct route_table *table,
 	prefix_copy(&rn.p, pu.p);
 	apply_mask(&rn.p);
 
-	node = rn_hash_node_find(&table->hash, &rn);
+	node = route_node_find(table, &rn);
 	return (node && node->info) ? route_lock_node(node) : NULL;
 }
 
@@ -269,7 +294,7 @@ struct route_node *route_node_lookup_maynull(struct route_table *table,
 	prefix_copy(&rn.p, pu.p);
 	apply_mask(&rn.p);
 
-	node = rn_hash_node_find(&table->hash, &rn);
+	node = route_node_find(table, &rn);
 	return node ? route_lock_node(node) : NULL;
 }
 
@@ -295,9 +320,11 @@ struct route_node *route_node_get(struct route_table *table,
 	uint16_t prefixlen = p->prefixlen;
 	const uint8_t *prefix = &p->u.prefix;
 
-	node = rn_hash_node_find(&table->hash, &search);
-	if (node && node->info)
-		return route_lock_node(node);
+	if (!table->nohash) {
+		node = rn_hash_node_find(&table->hash, &search);
+		if (node && node->info)
+			return route_lock_node(node);
+	}
 
 	match = NULL;
 	node = table->top;
@@ -322,7 +349,8 @@ struct route_node *route_node_get(struct route_table *table,
 		new->p.family = p->family;
 		new->table = table;
 		set_link(new, node);
-		rn_hash_node_add(&table->hash, new);
+		if (!table->nohash)
+			rn_hash_node_add(&table->hash, new);
 
 		if (match)
 			set_link(match, new);
@@ -374,7 +402,8 @@ void route_node_delete(struct route_node *node)
 
 	node->table->count--;
 
-	rn_hash_node_del(&node->table->hash, node);
+	if (!node->table->nohash)
+		rn_hash_node_del(&node->table->hash, node);
 
 	/* WARNING: FRAGILE CODE!
 	 * route_node_free may have the side effect of free'ing the entire
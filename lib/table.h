@@ -57,6 +57,13 @@ typedef void (*route_table_destroy_node_func_t)(route_table_delegate_t *,
 struct route_table_delegate_t_ {
 	route_table_create_node_func_t create_node;
 	route_table_destroy_node_func_t destroy_node;
+
+	/*
+	 * Don't keep the hash index for exact-match lookups; these walk the
+	 * tree instead.  For tables that are small, or mostly iterated over
+	 * or searched with route_node_match().
+	 */
+	bool nohash;
 };
 
 PREDECL_HASH(rn_hash_node);
@@ -65,6 +72,7 @@ PREDECL_HASH(rn_hash_node);
 struct route_table {
 	struct route_node *top;
 	struct rn_hash_node_head hash;
+	bool nohash;
 
 	/*
 	 * Delegate that performs certain functions for this table.
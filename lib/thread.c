@@ -22,6 +22,9 @@
 
 #include <zebra.h>
 #include <sys/resource.h>
+#ifdef HAVE_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include "thread.h"
 #include "memory.h"
@@ -69,6 +72,147 @@ static int thread_timer_cmp(const struct thread *a, const struct thread *b)
 }
 
 DECLARE_HEAP(thread_timer_list, struct thread, timeritem, thread_timer_cmp);
+DECLARE_DLIST(thread_wheel_list, struct thread, wheelitem);
+
+#define THREAD_WHEEL_MASK (THREAD_WHEEL_SLOTS - 1)
+
+/* Timing wheel ------------------------------------------------------------ */
+
+/* wheel tick a timer expiring at tv runs at, rounded up to never run early */
+static uint64_t thread_wheel_tick(const struct timeval *tv, bool roundup)
+{
+	uint64_t usec = (uint64_t)tv->tv_sec * 1000000 + tv->tv_usec;
+	uint64_t tick_usec = THREAD_WHEEL_TICK_MSEC * 1000;
+
+	if (roundup)
+		usec += tick_usec - 1;
+	return usec / tick_usec;
+}
+
+static void thread_wheel_init(struct thread_wheel *wheel)
+{
+	struct timeval now;
+	unsigned int i;
+
+	for (i = 0; i < THREAD_WHEEL_SLOTS; i++) {
+		thread_wheel_list_init(&wheel->slots[0][i]);
+		thread_wheel_list_init(&wheel->slots[1][i]);
+	}
+	monotime(&now);
+	wheel->tick = thread_wheel_tick(&now, false);
+	wheel->count = 0;
+}
+
+/* File timer into the wheel, if it isn't too far out */
+static bool thread_wheel_add(struct thread_wheel *wheel, struct thread *thread)
+{
+	struct thread_wheel_list_head *slot;
+	uint64_t tick = thread_wheel_tick(&thread->u.sands, true);
+
+	if (tick <= wheel->tick)
+		tick = wheel->tick + 1;
+
+	if (tick - wheel->tick < THREAD_WHEEL_SLOTS)
+		slot = &wheel->slots[0][tick & THREAD_WHEEL_MASK];
+	else if (tick - wheel->tick < THREAD_WHEEL_SLOTS * THREAD_WHEEL_SLOTS)
+		slot = &wheel->slots[1][(tick >> THREAD_WHEEL_BITS)
+					& THREAD_WHEEL_MASK];
+	else
+		return false;
+
+	thread_wheel_list_add_tail(slot, thread);
+	thread->wheel_slot = slot;
+	wheel->count++;
+	return true;
+}
+
+static void thread_wheel_del(struct thread_wheel *wheel, struct thread *thread)
+{
+	thread_wheel_list_del(thread->wheel_slot, thread);
+	thread->wheel_slot = NULL;
+	wheel->count--;
+}
+
+/* Turn the wheel up to now, moving expired timers to the ready list */
+static unsigned int thread_wheel_process(struct thread_master *m,
+					 struct timeval *timenow)
+{
+	struct thread_wheel *wheel = &m->wheel;
+	struct thread_wheel_list_head *slot;
+	uint64_t now = thread_wheel_tick(timenow, false);
+	uint64_t tick;
+	struct thread *thread;
+	unsigned int ready = 0;
+
+	while (wheel->count && wheel->tick < now) {
+		tick = wheel->tick + 1;
+
+		/* move the second level slot starting here down */
+		if ((tick & THREAD_WHEEL_MASK) == 0) {
+			slot = &wheel->slots[1][(tick >> THREAD_WHEEL_BITS)
+						& THREAD_WHEEL_MASK];
+			while ((thread = thread_wheel_list_pop(slot))) {
+				uint64_t expiry;
+
+				expiry = thread_wheel_tick(&thread->u.sands,
+							   true);
+				if (expiry < tick)
+					expiry = tick;
+				thread->wheel_slot =
+					&wheel->slots[0]
+						     [expiry & THREAD_WHEEL_MASK];
+				thread_wheel_list_add_tail(thread->wheel_slot,
+							   thread);
+			}
+		}
+
+		wheel->tick = tick;
+
+		slot = &wheel->slots[0][tick & THREAD_WHEEL_MASK];
+		while ((thread = thread_wheel_list_pop(slot))) {
+			thread->wheel_slot = NULL;
+			wheel->count--;
+			thread->ready = thread->u.sands;
+			thread->type = THREAD_READY;
+			thread_list_add_tail(&m->ready, thread);
+			ready++;
+		}
+	}
+
+	if (wheel->tick < now)
+		wheel->tick = now;
+
+	return ready;
+}
+
+/* Time of the next tick with work to do, NULL if the wheel is empty */
+static struct timeval *thread_wheel_next(struct thread_wheel *wheel,
+					 struct timeval *tv)
+{
+	uint64_t tick, msec;
+	unsigned int i;
+
+	if (!wheel->count)
+		return NULL;
+
+	/* worst case, the next time a second level slot moves down */
+	tick = ((wheel->tick >> THREAD_WHEEL_BITS) + 1) << THREAD_WHEEL_BITS;
+
+	for (i = 1; i < THREAD_WHEEL_SLOTS; i++) {
+		if (thread_wheel_list_count(
+			    &wheel->slots[0][(wheel->tick + i)
+					     & THREAD_WHEEL_MASK])) {
+			if (wheel->tick + i < tick)
+				tick = wheel->tick + i;
+			break;
+		}
+	}
+
+	msec = tick * THREAD_WHEEL_TICK_MSEC;
+	tv->tv_sec = msec / 1000;
+	tv->tv_usec = (msec % 1000) * 1000;
+	return tv;
+}
 
 #if defined(__APPLE__)
 #include <mach/mach.h>
@@ -89,6 +233,203 @@ static pthread_mutex_t masters_mtx = PTHREAD_MUTEX_INITIALIZER;
 static struct list *masters;
 
 static void thread_free(struct thread_master *master, struct thread *thread);
+static int thread_process_io_helper(struct thread_master *m,
+				    struct thread *thread, short state,
+				    short actual_state, int pos);
+
+/* I/O backend --------------------------------------------------------------
+ *
+ * The scheduled fds are always kept in m->handler.pfds.  With the poll()
+ * backend that array is copied and handed to poll() on every iteration of
+ * thread_fetch(), so the cost of each iteration grows with the number of
+ * scheduled fds.  With epoll the fds are registered with the kernel when
+ * the task is added, pfds merely lists them (indexed by pfdidx for O(1)
+ * lookup) and each iteration only touches the fds that are actually ready.
+ *
+ * Tasks are one-shot, so fds are registered with EPOLLONESHOT: once an
+ * event has been reported for a fd it is disarmed until a task is scheduled
+ * on it again.  This means a fd whose handler ran but did not reschedule
+ * (and maybe closed it) never needs an extra syscall to quiesce it.
+ */
+static const char *fd_poll_backend(struct thread_master *m)
+{
+#ifdef HAVE_EPOLL
+	if (m->handler.epfd >= 0)
+		return "epoll";
+#endif
+	return "poll";
+}
+
+/* Find position of fd in m->handler.pfds, pfdcount if it's not there */
+static nfds_t fd_poll_index(struct thread_master *m, int fd)
+{
+	nfds_t i;
+
+#ifdef HAVE_EPOLL
+	if (m->handler.epfd >= 0) {
+		if (m->handler.pfdidx[fd])
+			return m->handler.pfdidx[fd] - 1;
+		return m->handler.pfdcount;
+	}
+#endif
+	for (i = 0; i < m->handler.pfdcount; i++)
+		if (m->handler.pfds[i].fd == fd)
+			break;
+	return i;
+}
+
+#ifdef HAVE_EPOLL
+/* Upper bound on events fetched by a single epoll_pwait() call; anything
+ * beyond that stays armed and is picked up on the next iteration.
+ */
+#define EPOLL_EVENTS_MAX 1024
+
+static void fd_epoll_init(struct thread_master *m)
+{
+	struct fd_handler *h = &m->handler;
+	struct epoll_event ev = {};
+
+	h->epfd = epoll_create1(EPOLL_CLOEXEC);
+	if (h->epfd < 0) {
+		flog_err(EC_LIB_SYSTEM_CALL,
+			 "%s: epoll_create1() failed, falling back to poll(): %s",
+			 m->name, safe_strerror(errno));
+		return;
+	}
+
+	/* the pipe poker is always watched, level-triggered */
+	ev.events = EPOLLIN;
+	ev.data.fd = m->io_pipe[0];
+	if (epoll_ctl(h->epfd, EPOLL_CTL_ADD, m->io_pipe[0], &ev) < 0) {
+		flog_err(EC_LIB_SYSTEM_CALL,
+			 "%s: epoll_ctl() failed, falling back to poll(): %s",
+			 m->name, safe_strerror(errno));
+		close(h->epfd);
+		h->epfd = -1;
+		return;
+	}
+
+	h->pfdidx = XCALLOC(MTYPE_THREAD_POLL, sizeof(nfds_t) * m->fd_limit);
+	h->epoll_reg = XCALLOC(MTYPE_THREAD_POLL, sizeof(bool) * m->fd_limit);
+	h->eventsize = MIN(m->fd_limit, EPOLL_EVENTS_MAX);
+	h->events = XCALLOC(MTYPE_THREAD_POLL,
+			    sizeof(struct epoll_event) * h->eventsize);
+}
+
+static void fd_epoll_fini(struct thread_master *m)
+{
+	struct fd_handler *h = &m->handler;
+
+	if (h->epfd < 0)
+		return;
+
+	close(h->epfd);
+	h->epfd = -1;
+	XFREE(MTYPE_THREAD_POLL, h->pfdidx);
+	XFREE(MTYPE_THREAD_POLL, h->epoll_reg);
+	XFREE(MTYPE_THREAD_POLL, h->events);
+}
+
+/* (Re-)arm fd in the epoll instance for the POLLIN/POLLOUT bits in state */
+static int fd_epoll_arm(struct thread_master *m, int fd, short state)
+{
+	struct fd_handler *h = &m->handler;
+	struct epoll_event ev = {};
+	int op;
+
+	ev.data.fd = fd;
+	ev.events = EPOLLONESHOT;
+	if (state & POLLIN)
+		ev.events |= EPOLLIN;
+	if (state & POLLOUT)
+		ev.events |= EPOLLOUT;
+
+	op = h->epoll_reg[fd] ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+	if (epoll_ctl(h->epfd, op, fd, &ev) < 0) {
+		/*
+		 * The kernel drops a registration when its fd is closed, so
+		 * a fd number that was closed and reused since we last saw
+		 * it needs to be added again.
+		 */
+		if (errno != (op == EPOLL_CTL_MOD ? ENOENT : EEXIST))
+			return -1;
+
+		op = (op == EPOLL_CTL_MOD) ? EPOLL_CTL_ADD : EPOLL_CTL_MOD;
+		if (epoll_ctl(h->epfd, op, fd, &ev) < 0)
+			return -1;
+	}
+
+	h->epoll_reg[fd] = true;
+	return 0;
+}
+
+static void fd_epoll_disarm(struct thread_master *m, int fd)
+{
+	struct fd_handler *h = &m->handler;
+
+	if (!h->epoll_reg[fd])
+		return;
+
+	/* errors are fine, the fd might be closed already */
+	epoll_ctl(h->epfd, EPOLL_CTL_DEL, fd, NULL);
+	h->epoll_reg[fd] = false;
+}
+
+/* Remove pfds[idx]; order of pfds doesn't matter with epoll */
+static void fd_epoll_pfd_del(struct thread_master *m, nfds_t idx)
+{
+	struct fd_handler *h = &m->handler;
+	int fd = h->pfds[idx].fd;
+
+	h->pfdcount--;
+	if (idx != h->pfdcount) {
+		h->pfds[idx] = h->pfds[h->pfdcount];
+		h->pfdidx[h->pfds[idx].fd] = idx + 1;
+	}
+	h->pfds[h->pfdcount].fd = 0;
+	h->pfds[h->pfdcount].events = 0;
+	h->pfdidx[fd] = 0;
+}
+
+/*
+ * Bring the kernel in line with pfds[idx] after some of its events fired
+ * or were canceled.  If the fd can't be watched (e.g. it is a regular
+ * file, which poll() would report as ready right away), all tasks on it
+ * are made ready so their handlers get to see the fd's state.
+ *
+ * Returns true if pfds[idx] was removed.
+ */
+static bool fd_epoll_update(struct thread_master *m, nfds_t idx, bool fired)
+{
+	struct fd_handler *h = &m->handler;
+	int fd = h->pfds[idx].fd;
+
+	if (h->pfds[idx].events == 0) {
+		/* a disarmed one-shot fd can stay registered */
+		if (!fired)
+			fd_epoll_disarm(m, fd);
+		fd_epoll_pfd_del(m, idx);
+		return true;
+	}
+
+	if (fd_epoll_arm(m, fd, h->pfds[idx].events) == 0)
+		return false;
+
+	if (errno != EPERM)
+		flog_err(EC_LIB_SYSTEM_CALL,
+			 "%s: epoll_ctl() failed for fd %d: %s", m->name, fd,
+			 safe_strerror(errno));
+
+	if (h->pfds[idx].events & POLLIN)
+		thread_process_io_helper(m, m->read[fd], POLLIN, POLLIN, idx);
+	if (h->pfds[idx].events & POLLOUT)
+		thread_process_io_helper(m, m->write[fd], POLLOUT, POLLOUT,
+					 idx);
+	fd_epoll_disarm(m, fd);
+	fd_epoll_pfd_del(m, idx);
+	return true;
+}
+#endif /* HAVE_EPOLL */
 
 #ifndef EXCLUDE_CPU_TIME
 #define EXCLUDE_CPU_TIME 0
@@ -98,6 +439,8 @@ static void thread_free(struct thread_master *master, struct thread *thread);
 #endif
 
 bool cputime_enabled = !EXCLUDE_CPU_TIME;
+/* measure the CPU time of only one in this many tasks */
+unsigned int cputime_sample = 1;
 unsigned long cputime_threshold = CONSUMED_TIME_CHECK;
 unsigned long walltime_threshold = CONSUMED_TIME_CHECK;
 
@@ -262,6 +605,100 @@ static void cpu_record_print(struct vty *vty, uint8_t filter)
 		vty_out_cpu_thread_history(vty, &tmp);
 }
 
+/* Copy of a struct thread_delay_hist, for display */
+struct thread_delay_snap {
+	size_t count[THREAD_DELAY_BUCKETS];
+	size_t total, max;
+};
+
+static void thread_delay_snap(struct thread_delay_snap *snap,
+			      struct thread_delay_hist *hist)
+{
+	unsigned int i;
+
+	snap->total = 0;
+	for (i = 0; i < THREAD_DELAY_BUCKETS; i++) {
+		snap->count[i] = atomic_load_explicit(&hist->count[i],
+						      memory_order_relaxed);
+		snap->total += snap->count[i];
+	}
+	snap->max = atomic_load_explicit(&hist->max, memory_order_relaxed);
+}
+
+/* Upper bound of the pct percentile, exact only to a power of 2 */
+static size_t thread_delay_pct(const struct thread_delay_snap *snap,
+			       unsigned int pct)
+{
+	size_t want = (snap->total * pct + 99) / 100, sum = 0;
+	unsigned int i;
+
+	for (i = 0; i < THREAD_DELAY_BUCKETS - 1; i++) {
+		sum += snap->count[i];
+		if (sum >= want)
+			return MIN((size_t)1 << i, snap->max);
+	}
+	return snap->max;
+}
+
+static void vty_out_thread_delay(struct vty *vty,
+				 const struct thread_delay_snap *snap,
+				 const char *name)
+{
+	vty_out(vty, "%10zu %9zu %9zu %9zu %10zu  %s\n", snap->total,
+		thread_delay_pct(snap, 50), thread_delay_pct(snap, 90),
+		thread_delay_pct(snap, 99), snap->max, name);
+}
+
+static void thread_delay_hash_print(struct hash_bucket *bucket, void *arg)
+{
+	struct cpu_thread_history *a = bucket->data;
+	struct thread_delay_snap snap;
+	struct vty *vty = arg;
+
+	thread_delay_snap(&snap, &a->delay);
+	if (snap.total)
+		vty_out_thread_delay(vty, &snap, a->funcname);
+}
+
+static void thread_delay_print(struct vty *vty)
+{
+	struct thread_delay_snap snap;
+	struct thread_master *m;
+	struct listnode *ln;
+
+	vty_out(vty,
+		"Time from a task becoming ready (event added, timer or I/O due)\n"
+		"until it ran, in microseconds; percentiles are upper bounds.\n");
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+			const char *name = m->name ? m->name : "main";
+
+			char underline[strlen(name) + 1];
+			memset(underline, '-', sizeof(underline));
+			underline[sizeof(underline) - 1] = '\0';
+
+			vty_out(vty, "\n");
+			vty_out(vty,
+				"Showing scheduling delay for pthread %s\n",
+				name);
+			vty_out(vty,
+				"-------------------------------------%s\n",
+				underline);
+			vty_out(vty, "%10s %9s %9s %9s %10s  %s\n", "Tasks",
+				"p50", "p90", "p99", "Max", "Thread");
+
+			thread_delay_snap(&snap, &m->delay);
+			vty_out_thread_delay(vty, &snap, "(all)");
+
+			frr_with_mutex (&m->mtx) {
+				hash_iterate(m->cpu_record,
+					     thread_delay_hash_print, vty);
+			}
+		}
+	}
+}
+
 static void cpu_record_hash_clear(struct hash_bucket *bucket, void *args[])
 {
 	uint8_t *filter = args[0];
@@ -283,6 +720,17 @@ static void cpu_record_clear(uint8_t filter)
 
 	frr_with_mutex (&masters_mtx) {
 		for (ALL_LIST_ELEMENTS_RO(masters, ln, m)) {
+			if (filter == (uint8_t)-1U) {
+				unsigned int i;
+
+				for (i = 0; i < THREAD_DELAY_BUCKETS; i++)
+					atomic_store_explicit(
+						&m->delay.count[i], 0,
+						memory_order_relaxed);
+				atomic_store_explicit(&m->delay.max, 0,
+						      memory_order_relaxed);
+			}
+
 			frr_with_mutex (&m->mtx) {
 				void *args[2] = {tmp, m->cpu_record};
 				hash_iterate(
@@ -366,6 +814,30 @@ DEFPY (service_cputime_stats,
 	return CMD_SUCCESS;
 }
 
+DEFPY (service_cputime_stats_sample,
+       service_cputime_stats_sample_cmd,
+       "[no] service cputime-stats sample (2-1000)$rate",
+       NO_STR
+       "Set up miscellaneous service\n"
+       "Collect CPU usage statistics\n"
+       "Measure the CPU time of only some tasks\n"
+       "Measure one in this many tasks\n")
+{
+	if (no)
+		cputime_sample = 1;
+	else
+		cputime_sample = rate;
+	return CMD_SUCCESS;
+}
+
+ALIAS (service_cputime_stats_sample,
+       no_service_cputime_stats_sample_cmd,
+       "no service cputime-stats sample",
+       NO_STR
+       "Set up miscellaneous service\n"
+       "Collect CPU usage statistics\n"
+       "Measure the CPU time of only some tasks\n")
+
 DEFPY (service_cputime_warning,
        service_cputime_warning_cmd,
        "[no] service cputime-warning (1-4294967295)",
@@ -422,6 +894,7 @@ static void show_thread_poll_helper(struct vty *vty, struct thread_master *m)
 
 	vty_out(vty, "\nShowing poll FD's for %s\n", name);
 	vty_out(vty, "----------------------%s\n", underline);
+	vty_out(vty, "Backend: %s\n", fd_poll_backend(m));
 	vty_out(vty, "Count: %u/%d\n", (uint32_t)m->handler.pfdcount,
 		m->fd_limit);
 	for (i = 0; i < m->handler.pfdcount; i++) {
@@ -451,6 +924,17 @@ static void show_thread_poll_helper(struct vty *vty, struct thread_master *m)
 	}
 }
 
+DEFUN_NOSH (show_thread_latency,
+	    show_thread_latency_cmd,
+	    "show thread latency",
+	    SHOW_STR
+	    "Thread information\n"
+	    "Delay between tasks becoming ready and running\n")
+{
+	thread_delay_print(vty);
+	return CMD_SUCCESS;
+}
+
 DEFUN_NOSH (show_thread_poll,
 	    show_thread_poll_cmd,
 	    "show thread poll",
@@ -501,6 +985,7 @@ static void show_thread_timers_helper(struct vty *vty, struct thread_master *m)
 	const char *name = m->name ? m->name : "main";
 	char underline[strlen(name) + 1];
 	struct thread *thread;
+	unsigned int i, level;
 
 	memset(underline, '-', sizeof(underline));
 	underline[sizeof(underline) - 1] = '\0';
@@ -511,6 +996,12 @@ static void show_thread_timers_helper(struct vty *vty, struct thread_master *m)
 	frr_each (thread_timer_list, &m->timer, thread) {
 		vty_out(vty, "  %-50s%pTH\n", thread->hist->funcname, thread);
 	}
+	for (i = 0; i < THREAD_WHEEL_SLOTS; i++)
+		for (level = 0; level < 2; level++)
+			frr_each (thread_wheel_list, &m->wheel.slots[level][i],
+				  thread)
+				vty_out(vty, "  %-50s%pTH (coarse)\n",
+					thread->hist->funcname, thread);
 }
 
 DEFPY_NOSH (show_thread_timers,
@@ -534,10 +1025,13 @@ DEFPY_NOSH (show_thread_timers,
 void thread_cmd_init(void)
 {
 	install_element(VIEW_NODE, &show_thread_cpu_cmd);
+	install_element(VIEW_NODE, &show_thread_latency_cmd);
 	install_element(VIEW_NODE, &show_thread_poll_cmd);
 	install_element(ENABLE_NODE, &clear_thread_cpu_cmd);
 
 	install_element(CONFIG_NODE, &service_cputime_stats_cmd);
+	install_element(CONFIG_NODE, &service_cputime_stats_sample_cmd);
+	install_element(CONFIG_NODE, &no_service_cputime_stats_sample_cmd);
 	install_element(CONFIG_NODE, &service_cputime_warning_cmd);
 	install_element(CONFIG_NODE, &no_service_cputime_warning_cmd);
 	install_element(CONFIG_NODE, &service_walltime_warning_cmd);
@@ -603,6 +1097,7 @@ struct thread_master *thread_master_create(const char *name)
 	thread_list_init(&rv->ready);
 	thread_list_init(&rv->unuse);
 	thread_timer_list_init(&rv->timer);
+	thread_wheel_init(&rv->wheel);
 
 	/* Initialize thread_fetch() settings */
 	rv->spin = true;
@@ -627,6 +1122,10 @@ struct thread_master *thread_master_create(const char *name)
 	rv->handler.copy = XCALLOC(MTYPE_THREAD_MASTER,
 				   sizeof(struct pollfd) * rv->handler.pfdsize);
 
+#ifdef HAVE_EPOLL
+	fd_epoll_init(rv);
+#endif
+
 	/* add to list of threadmasters */
 	frr_with_mutex (&masters_mtx) {
 		if (!masters)
@@ -646,6 +1145,37 @@ void thread_master_set_name(struct thread_master *master, const char *name)
 	}
 }
 
+const char *thread_master_backend(struct thread_master *m)
+{
+	return fd_poll_backend(m);
+}
+
+bool thread_master_use_poll(struct thread_master *m)
+{
+	bool ret = true;
+
+#ifdef HAVE_EPOLL
+	frr_with_mutex (&m->mtx) {
+		if (m->handler.pfdcount)
+			ret = false;
+		else
+			fd_epoll_fini(m);
+	}
+#endif
+	return ret;
+}
+
+void thread_master_broadcast(void (*func)(struct thread *), void *arg)
+{
+	struct thread_master *m;
+	struct listnode *ln;
+
+	frr_with_mutex (&masters_mtx) {
+		for (ALL_LIST_ELEMENTS_RO(masters, ln, m))
+			thread_add_event(m, func, arg, 0, NULL);
+	}
+}
+
 #define THREAD_UNUSED_DEPTH 10
 
 /* Move thread to unuse list. */
@@ -717,6 +1247,7 @@ void thread_master_free_unused(struct thread_master *m)
 void thread_master_free(struct thread_master *m)
 {
 	struct thread *t;
+	unsigned int i, level;
 
 	frr_with_mutex (&masters_mtx) {
 		listnode_delete(masters, m);
@@ -729,6 +1260,11 @@ void thread_master_free(struct thread_master *m)
 	thread_array_free(m, m->write);
 	while ((t = thread_timer_list_pop(&m->timer)))
 		thread_free(m, t);
+	for (i = 0; i < THREAD_WHEEL_SLOTS; i++)
+		for (level = 0; level < 2; level++)
+			while ((t = thread_wheel_list_pop(
+					&m->wheel.slots[level][i])))
+				thread_free(m, t);
 	thread_list_free(m, &m->event);
 	thread_list_free(m, &m->ready);
 	thread_list_free(m, &m->unuse);
@@ -746,6 +1282,9 @@ void thread_master_free(struct thread_master *m)
 	XFREE(MTYPE_THREAD_MASTER, m->name);
 	XFREE(MTYPE_THREAD_MASTER, m->handler.pfds);
 	XFREE(MTYPE_THREAD_MASTER, m->handler.copy);
+#ifdef HAVE_EPOLL
+	fd_epoll_fini(m);
+#endif
 	XFREE(MTYPE_THREAD_MASTER, m);
 }
 
@@ -904,11 +1443,16 @@ static int fd_poll(struct thread_master *m, const struct timeval *timer_wait,
 	rcu_read_unlock();
 	rcu_assert_read_unlocked();
 
-	/* add poll pipe poker */
-	assert(count + 1 < m->handler.pfdsize);
-	m->handler.copy[count].fd = m->io_pipe[0];
-	m->handler.copy[count].events = POLLIN;
-	m->handler.copy[count].revents = 0x00;
+	/* add poll pipe poker (always registered with epoll) */
+#ifdef HAVE_EPOLL
+	if (m->handler.epfd < 0)
+#endif
+	{
+		assert(count + 1 < m->handler.pfdsize);
+		m->handler.copy[count].fd = m->io_pipe[0];
+		m->handler.copy[count].events = POLLIN;
+		m->handler.copy[count].revents = 0x00;
+	}
 
 	/* We need to deal with a signal-handling race here: we
 	 * don't want to miss a crucial signal, such as SIGTERM or SIGINT,
@@ -933,6 +1477,15 @@ static int fd_poll(struct thread_master *m, const struct timeval *timer_wait,
 		pthread_sigmask(SIG_SETMASK, NULL, &origsigs);
 	}
 
+#ifdef HAVE_EPOLL
+	if (m->handler.epfd >= 0) {
+		num = epoll_pwait(m->handler.epfd, m->handler.events,
+				  m->handler.eventsize, timeout, &origsigs);
+		pthread_sigmask(SIG_SETMASK, &origsigs, NULL);
+		goto done;
+	}
+#endif
+
 #if defined(HAVE_PPOLL)
 	struct timespec ts, *tsp;
 
@@ -956,7 +1509,12 @@ done:
 	if (num < 0 && errno == EINTR)
 		*eintr_p = true;
 
-	if (num > 0 && m->handler.copy[count].revents != 0 && num--)
+	if (num > 0
+#ifdef HAVE_EPOLL
+	    /* with epoll, the pipe poker is drained in fd_epoll_process_io() */
+	    && m->handler.epfd < 0
+#endif
+	    && m->handler.copy[count].revents != 0 && num--)
 		while (read(m->io_pipe[0], &trash, sizeof(trash)) > 0)
 			;
 
@@ -993,8 +1551,7 @@ void _thread_add_read_write(const struct xref_threadsched *xref,
 			// thread is already scheduled; don't reschedule
 			break;
 
-		/* default to a new pollfd */
-		nfds_t queuepos = m->handler.pfdcount;
+		nfds_t queuepos;
 
 		if (dir == THREAD_READ)
 			thread_array = m->read;
@@ -1002,21 +1559,17 @@ void _thread_add_read_write(const struct xref_threadsched *xref,
 			thread_array = m->write;
 
 		/* if we already have a pollfd for our file descriptor, find and
-		 * use it */
-		for (nfds_t i = 0; i < m->handler.pfdcount; i++)
-			if (m->handler.pfds[i].fd == fd) {
-				queuepos = i;
+		 * use it, otherwise default to a new pollfd */
+		queuepos = fd_poll_index(m, fd);
 
 #ifdef DEV_BUILD
-				/*
-				 * What happens if we have a thread already
-				 * created for this event?
-				 */
-				if (thread_array[fd])
-					assert(!"Thread already scheduled for file descriptor");
+		/*
+		 * What happens if we have a thread already
+		 * created for this event?
+		 */
+		if (queuepos < m->handler.pfdcount && thread_array[fd])
+			assert(!"Thread already scheduled for file descriptor");
 #endif
-				break;
-			}
 
 		/* make sure we have room for this fd + pipe poker fd */
 		assert(queuepos + 1 < m->handler.pfdsize);
@@ -1027,8 +1580,13 @@ void _thread_add_read_write(const struct xref_threadsched *xref,
 		m->handler.pfds[queuepos].events |=
 			(dir == THREAD_READ ? POLLIN : POLLOUT);
 
-		if (queuepos == m->handler.pfdcount)
+		if (queuepos == m->handler.pfdcount) {
 			m->handler.pfdcount++;
+#ifdef HAVE_EPOLL
+			if (m->handler.epfd >= 0)
+				m->handler.pfdidx[fd] = queuepos + 1;
+#endif
+		}
 
 		if (thread) {
 			frr_with_mutex (&thread->mtx) {
@@ -1042,6 +1600,16 @@ void _thread_add_read_write(const struct xref_threadsched *xref,
 			}
 		}
 
+#ifdef HAVE_EPOLL
+		/*
+		 * The kernel watches the fd right away, even if the owning
+		 * pthread is asleep in epoll_pwait() already, so no need to
+		 * wake it up - unless the task went straight to ready.
+		 */
+		if (m->handler.epfd >= 0 && !fd_epoll_update(m, queuepos, false))
+			break;
+#endif
+
 		AWAKEN(m);
 	}
 }
@@ -1050,7 +1618,7 @@ static void _thread_add_timer_timeval(const struct xref_threadsched *xref,
 				      struct thread_master *m,
 				      void (*func)(struct thread *), void *arg,
 				      struct timeval *time_relative,
-				      struct thread **t_ptr)
+				      struct thread **t_ptr, bool coarse)
 {
 	struct thread *thread;
 	struct timeval t;
@@ -1076,7 +1644,10 @@ static void _thread_add_timer_timeval(const struct xref_threadsched *xref,
 
 		frr_with_mutex (&thread->mtx) {
 			thread->u.sands = t;
-			thread_timer_list_add(&m->timer, thread);
+			if (!coarse || !thread_wheel_add(&m->wheel, thread)) {
+				coarse = false;
+				thread_timer_list_add(&m->timer, thread);
+			}
 			if (t_ptr) {
 				*t_ptr = thread;
 				thread->ref = t_ptr;
@@ -1085,9 +1656,14 @@ static void _thread_add_timer_timeval(const struct xref_threadsched *xref,
 
 		/* The timer list is sorted - if this new timer
 		 * might change the time we'll wait for, give the pthread
-		 * a chance to re-compute.
+		 * a chance to re-compute.  The wheel doesn't keep track of
+		 * its first timer; the owning pthread recomputes the wait
+		 * anyway before polling again.
 		 */
-		if (thread_timer_list_first(&m->timer) == thread)
+		if (coarse) {
+			if (m->owner != pthread_self())
+				AWAKEN(m);
+		} else if (thread_timer_list_first(&m->timer) == thread)
 			AWAKEN(m);
 	}
 #define ONEYEAR2SEC (60 * 60 * 24 * 365)
@@ -1111,7 +1687,7 @@ void _thread_add_timer(const struct xref_threadsched *xref,
 	trel.tv_sec = timer;
 	trel.tv_usec = 0;
 
-	_thread_add_timer_timeval(xref, m, func, arg, &trel, t_ptr);
+	_thread_add_timer_timeval(xref, m, func, arg, &trel, t_ptr, false);
 }
 
 /* Add timer event thread with "millisecond" resolution */
@@ -1127,7 +1703,7 @@ void _thread_add_timer_msec(const struct xref_threadsched *xref,
 	trel.tv_sec = timer / 1000;
 	trel.tv_usec = 1000 * (timer % 1000);
 
-	_thread_add_timer_timeval(xref, m, func, arg, &trel, t_ptr);
+	_thread_add_timer_timeval(xref, m, func, arg, &trel, t_ptr, false);
 }
 
 /* Add timer event thread with "timeval" resolution */
@@ -1136,7 +1712,23 @@ void _thread_add_timer_tv(const struct xref_threadsched *xref,
 			  void (*func)(struct thread *), void *arg,
 			  struct timeval *tv, struct thread **t_ptr)
 {
-	_thread_add_timer_timeval(xref, m, func, arg, tv, t_ptr);
+	_thread_add_timer_timeval(xref, m, func, arg, tv, t_ptr, false);
+}
+
+/* Add timer event thread with second resolution, on the timing wheel */
+void _thread_add_timer_coarse(const struct xref_threadsched *xref,
+			      struct thread_master *m,
+			      void (*func)(struct thread *), void *arg,
+			      long timer, struct thread **t_ptr)
+{
+	struct timeval trel;
+
+	assert(m != NULL);
+
+	trel.tv_sec = timer;
+	trel.tv_usec = 0;
+
+	_thread_add_timer_timeval(xref, m, func, arg, &trel, t_ptr, true);
 }
 
 /* Add simple event thread. */
@@ -1160,6 +1752,7 @@ void _thread_add_event(const struct xref_threadsched *xref,
 		thread = thread_get(m, THREAD_EVENT, func, arg, xref);
 		frr_with_mutex (&thread->mtx) {
 			thread->u.val = val;
+			monotime(&thread->ready);
 			thread_list_add_tail(&m->event, thread);
 		}
 
@@ -1205,11 +1798,8 @@ static void thread_cancel_rw(struct thread_master *master, int fd, short state,
 		found = true;
 	} else {
 		/* Have to look for the fd in the pfd array */
-		for (i = 0; i < master->handler.pfdcount; i++)
-			if (master->handler.pfds[i].fd == fd) {
-				found = true;
-				break;
-			}
+		i = fd_poll_index(master, fd);
+		found = i < master->handler.pfdcount;
 	}
 
 	if (!found) {
@@ -1223,6 +1813,13 @@ static void thread_cancel_rw(struct thread_master *master, int fd, short state,
 	/* NOT out event. */
 	master->handler.pfds[i].events &= ~(state);
 
+#ifdef HAVE_EPOLL
+	if (master->handler.epfd >= 0) {
+		fd_epoll_update(master, i, false);
+		return;
+	}
+#endif
+
 	/* If all events are canceled, delete / resize the pollfd array. */
 	if (master->handler.pfds[i].events == 0) {
 		memmove(master->handler.pfds + i, master->handler.pfds + i + 1,
@@ -1259,6 +1856,7 @@ static void cancel_arg_helper(struct thread_master *master,
 {
 	struct thread *t;
 	nfds_t i;
+	unsigned int level;
 	int fd;
 	struct pollfd *pfd;
 
@@ -1337,6 +1935,18 @@ static void cancel_arg_helper(struct thread_master *master,
 
 		t = t_next;
 	}
+
+	for (i = 0; i < THREAD_WHEEL_SLOTS; i++)
+		for (level = 0; level < 2; level++)
+			frr_each_safe (thread_wheel_list,
+				       &master->wheel.slots[level][i], t) {
+				if (t->arg != cr->eventobj)
+					continue;
+				thread_wheel_del(&master->wheel, t);
+				if (t->ref)
+					*t->ref = NULL;
+				thread_add_unuse(master, t);
+			}
 }
 
 /**
@@ -1391,7 +2001,10 @@ static void do_thread_cancel(struct thread_master *master)
 			thread_array = master->write;
 			break;
 		case THREAD_TIMER:
-			thread_timer_list_del(&master->timer, thread);
+			if (thread->wheel_slot)
+				thread_wheel_del(&master->wheel, thread);
+			else
+				thread_timer_list_del(&master->timer, thread);
 			break;
 		case THREAD_EVENT:
 			list = &master->event;
@@ -1577,14 +2190,24 @@ void thread_cancel_async(struct thread_master *master, struct thread **thread,
 }
 /* ------------------------------------------------------------------------- */
 
-static struct timeval *thread_timer_wait(struct thread_timer_list_head *timers,
+static struct timeval *thread_timer_wait(struct thread_master *m,
 					 struct timeval *timer_val)
 {
-	if (!thread_timer_list_count(timers))
+	struct timeval wheel_next, *next = NULL;
+	struct thread *next_timer;
+
+	if (thread_timer_list_count(&m->timer)) {
+		next_timer = thread_timer_list_first(&m->timer);
+		next = &next_timer->u.sands;
+	}
+	if (thread_wheel_next(&m->wheel, &wheel_next)
+	    && (!next || timercmp(&wheel_next, next, <)))
+		next = &wheel_next;
+
+	if (!next)
 		return NULL;
 
-	struct thread *next_timer = thread_timer_list_first(timers);
-	monotime_until(&next_timer->u.sands, timer_val);
+	monotime_until(next, timer_val);
 	return timer_val;
 }
 
@@ -1629,6 +2252,7 @@ static int thread_process_io_helper(struct thread_master *m,
 		thread_array = m->write;
 
 	thread_array[thread->u.fd] = NULL;
+	thread->ready = m->poll_time;
 	thread_list_add_tail(&m->ready, thread);
 	thread->type = THREAD_READY;
 
@@ -1701,6 +2325,58 @@ static void thread_process_io(struct thread_master *m, unsigned int num)
 	}
 }
 
+#ifdef HAVE_EPOLL
+/**
+ * Process I/O events reported by epoll_pwait().
+ *
+ * @param m the thread master
+ * @param num the number of entries in m->handler.events
+ */
+static void fd_epoll_process_io(struct thread_master *m, unsigned int num)
+{
+	struct epoll_event *events = m->handler.events;
+	unsigned char trash[64];
+
+	for (unsigned int i = 0; i < num; i++) {
+		int fd = events[i].data.fd;
+		short revents = events[i].events;
+		nfds_t idx;
+		short state;
+
+		if (fd == m->io_pipe[0]) {
+			while (read(fd, &trash, sizeof(trash)) > 0)
+				;
+			continue;
+		}
+
+		/* canceled by another pthread while we were asleep */
+		if (!m->handler.pfdidx[fd])
+			continue;
+
+		idx = m->handler.pfdidx[fd] - 1;
+		state = m->handler.pfds[idx].events;
+
+		/*
+		 * Same as with poll(), errors are handed to the read task so
+		 * that its read fails and is handled.  If there is no read
+		 * task, give them to the write task instead of spinning.
+		 */
+		if ((state & POLLIN) && (revents & (POLLIN | POLLHUP | POLLERR)))
+			thread_process_io_helper(m, m->read[fd], POLLIN,
+						 revents, idx);
+		if ((state & POLLOUT)
+		    && ((revents & POLLOUT)
+			|| (!(state & POLLIN)
+			    && (revents & (POLLHUP | POLLERR)))))
+			thread_process_io_helper(m, m->write[fd], POLLOUT,
+						 revents, idx);
+
+		/* EPOLLONESHOT disarmed the fd, re-arm what's left */
+		fd_epoll_update(m, idx, true);
+	}
+}
+#endif /* HAVE_EPOLL */
+
 /* Add all timers that have popped to the ready list. */
 static unsigned int thread_process_timers(struct thread_master *m,
 					  struct timeval *timenow)
@@ -1735,11 +2411,14 @@ static unsigned int thread_process_timers(struct thread_master *m,
 		}
 
 		thread_timer_list_pop(&m->timer);
+		thread->ready = thread->u.sands;
 		thread->type = THREAD_READY;
 		thread_list_add_tail(&m->ready, thread);
 		ready++;
 	}
 
+	ready += thread_wheel_process(m, timenow);
+
 	return ready;
 }
 
@@ -1790,6 +2469,7 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 			pthread_mutex_unlock(&m->mtx);
 			if (!m->ready_run_loop)
 				GETRUSAGE(&m->last_getrusage);
+			m->last_getrusage_cpu = cputime_enabled;
 			m->ready_run_loop = true;
 			break;
 		}
@@ -1820,7 +2500,7 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 		 * once per loop to avoid starvation by events
 		 */
 		if (!thread_list_count(&m->ready))
-			tw = thread_timer_wait(&m->timer, &tv);
+			tw = thread_timer_wait(m, &tv);
 
 		if (thread_list_count(&m->ready) ||
 				(tw && !timercmp(tw, &zerotime, >)))
@@ -1836,9 +2516,14 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 		 * Copy pollfd array + # active pollfds in it. Not necessary to
 		 * copy the array size as this is fixed.
 		 */
-		m->handler.copycount = m->handler.pfdcount;
-		memcpy(m->handler.copy, m->handler.pfds,
-		       m->handler.copycount * sizeof(struct pollfd));
+#ifdef HAVE_EPOLL
+		if (m->handler.epfd < 0)
+#endif
+		{
+			m->handler.copycount = m->handler.pfdcount;
+			memcpy(m->handler.copy, m->handler.pfds,
+			       m->handler.copycount * sizeof(struct pollfd));
+		}
 
 		pthread_mutex_unlock(&m->mtx);
 		{
@@ -1865,9 +2550,15 @@ struct thread *thread_fetch(struct thread_master *m, struct thread *fetch)
 
 		/* Post timers to ready queue. */
 		monotime(&now);
+		m->poll_time = now;
 		thread_process_timers(m, &now);
 
 		/* Post I/O to ready queue. */
+#ifdef HAVE_EPOLL
+		if (num > 0 && m->handler.epfd >= 0)
+			fd_epoll_process_io(m, num);
+		else
+#endif
 		if (num > 0)
 			thread_process_io(m, num);
 
@@ -1884,6 +2575,23 @@ static unsigned long timeval_elapsed(struct timeval a, struct timeval b)
 		+ (a.tv_usec - b.tv_usec));
 }
 
+static void thread_delay_add(struct thread_delay_hist *hist, uint64_t delay)
+{
+	unsigned int i = delay ? 64 - __builtin_clzll(delay) : 0;
+	size_t exp;
+
+	if (i >= THREAD_DELAY_BUCKETS)
+		i = THREAD_DELAY_BUCKETS - 1;
+	atomic_fetch_add_explicit(&hist->count[i], 1, memory_order_relaxed);
+
+	exp = atomic_load_explicit(&hist->max, memory_order_relaxed);
+	while (exp < delay
+	       && !atomic_compare_exchange_weak_explicit(
+		       &hist->max, &exp, delay, memory_order_relaxed,
+		       memory_order_relaxed))
+		;
+}
+
 unsigned long thread_consumed_time(RUSAGE_T *now, RUSAGE_T *start,
 				   unsigned long *cputime)
 {
@@ -1946,10 +2654,10 @@ void thread_set_yield_time(struct thread *thread, unsigned long yield_time)
 	}
 }
 
-void thread_getrusage(RUSAGE_T *r)
+static void thread_getrusage_cpu(RUSAGE_T *r, bool cpu)
 {
 	monotime(&r->real);
-	if (!cputime_enabled) {
+	if (!cpu) {
 		memset(&r->cpu, 0, sizeof(r->cpu));
 		return;
 	}
@@ -1969,6 +2677,48 @@ void thread_getrusage(RUSAGE_T *r)
 #endif
 }
 
+void thread_getrusage(RUSAGE_T *r)
+{
+	thread_getrusage_cpu(r, cputime_enabled);
+}
+
+uint32_t thread_master_task_time(struct thread_master *m,
+				 const char **funcname)
+{
+	struct timeval now;
+	uintptr_t name;
+	uint32_t start;
+
+	name = atomic_load_explicit(&m->task_name, memory_order_acquire);
+	if (funcname)
+		*funcname = (const char *)name;
+	if (!name)
+		return 0;
+
+	start = atomic_load_explicit(&m->task_start, memory_order_relaxed);
+	monotime(&now);
+	/* wraps after 49 days, the difference does not */
+	return (uint32_t)(now.tv_sec * 1000 + now.tv_usec / 1000) - start;
+}
+
+/*
+ * With "service cputime-stats sample N", only every Nth task has its CPU
+ * time measured, the others only get the (cheap) monotonic clock read.
+ */
+static bool thread_cputime_sampled(struct thread_master *m)
+{
+	unsigned int sample = cputime_sample;
+
+	if (sample <= 1)
+		return true;
+	if (m->cputime_skip && m->cputime_skip < sample) {
+		m->cputime_skip--;
+		return false;
+	}
+	m->cputime_skip = sample - 1;
+	return true;
+}
+
 /*
  * Call a thread.
  *
@@ -1989,11 +2739,20 @@ void thread_call(struct thread *thread)
 	 * and very confusing warnings
 	 */
 	bool cputime_enabled_here = cputime_enabled;
+	/* sampled CPU time is scaled up to estimate the total */
+	unsigned int cputime_scale = cputime_sample;
+	bool measure_cpu;
+	uintptr_t prev_name;
+	uint_fast32_t prev_start;
+
+	measure_cpu = cputime_enabled_here
+		      && thread_cputime_sampled(thread->master);
 
-	if (thread->master->ready_run_loop)
+	if (thread->master->ready_run_loop
+	    && (!measure_cpu || thread->master->last_getrusage_cpu))
 		before = thread->master->last_getrusage;
 	else
-		GETRUSAGE(&before);
+		thread_getrusage_cpu(&before, measure_cpu);
 
 	thread->real = before.real;
 
@@ -2002,16 +2761,49 @@ void thread_call(struct thread *thread)
 		 thread->xref->xref.line, NULL, thread->u.fd,
 		 thread->u.val, thread->arg, thread->u.sands.tv_sec);
 
+	/* tasks run through thread_execute() nest */
+	prev_name = atomic_load_explicit(&thread->master->task_name,
+					 memory_order_relaxed);
+	prev_start = atomic_load_explicit(&thread->master->task_start,
+					  memory_order_relaxed);
+	atomic_store_explicit(&thread->master->task_start,
+			      before.real.tv_sec * 1000
+				      + before.real.tv_usec / 1000,
+			      memory_order_relaxed);
+	atomic_store_explicit(&thread->master->task_name,
+			      (uintptr_t)thread->xref->funcname,
+			      memory_order_release);
+
 	pthread_setspecific(thread_current, thread);
 	(*thread->func)(thread);
 	pthread_setspecific(thread_current, NULL);
 
-	GETRUSAGE(&after);
+	atomic_store_explicit(&thread->master->task_name, prev_name,
+			      memory_order_relaxed);
+	atomic_store_explicit(&thread->master->task_start, prev_start,
+			      memory_order_relaxed);
+
+	thread_getrusage_cpu(&after, measure_cpu);
 	thread->master->last_getrusage = after;
+	thread->master->last_getrusage_cpu = measure_cpu;
 
 	unsigned long walltime, cputime;
 	unsigned long exp;
 
+	/* tasks run through thread_execute() were never queued */
+	if (thread->add_type != THREAD_EXECUTE) {
+		int64_t delay;
+
+		delay = (before.real.tv_sec - thread->ready.tv_sec)
+				* TIMER_SECOND_MICRO
+			+ (before.real.tv_usec - thread->ready.tv_usec);
+
+		if (delay < 0)
+			delay = 0;
+		thread_delay_add(&thread->master->delay, delay);
+		thread_delay_add(&thread->hist->delay, delay);
+	}
+
 	walltime = thread_consumed_time(&after, &before, &cputime);
 
 	/* update walltime */
@@ -2025,9 +2817,10 @@ void thread_call(struct thread *thread)
 		       memory_order_seq_cst, memory_order_seq_cst))
 		;
 
-	if (cputime_enabled_here && cputime_enabled) {
+	if (measure_cpu && cputime_enabled) {
 		/* update cputime */
-		atomic_fetch_add_explicit(&thread->hist->cpu.total, cputime,
+		atomic_fetch_add_explicit(&thread->hist->cpu.total,
+					  cputime * MAX(cputime_scale, 1),
 					  memory_order_seq_cst);
 		exp = atomic_load_explicit(&thread->hist->cpu.max,
 					   memory_order_seq_cst);
@@ -2043,7 +2836,7 @@ void thread_call(struct thread *thread)
 	atomic_fetch_or_explicit(&thread->hist->types, 1 << thread->add_type,
 				 memory_order_seq_cst);
 
-	if (cputime_enabled_here && cputime_enabled && cputime_threshold
+	if (measure_cpu && cputime_enabled && cputime_threshold
 	    && cputime > cputime_threshold) {
 		/*
 		 * We have a CPU Hog on our hands.  The time FRR has spent
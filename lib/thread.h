@@ -34,6 +34,7 @@ extern "C" {
 #endif
 
 extern bool cputime_enabled;
+extern unsigned int cputime_sample;
 extern unsigned long cputime_threshold;
 /* capturing wallclock time is always enabled since it is fast (reading
  * hardware TSC w/o syscalls)
@@ -54,6 +55,25 @@ struct rusage_t {
 
 PREDECL_LIST(thread_list);
 PREDECL_HEAP(thread_timer_list);
+PREDECL_DLIST(thread_wheel_list);
+
+/* Timing wheel for coarse timers, see thread_add_timer_coarse().  Timers
+ * are filed by tick of expiry, either directly in one of the first level
+ * slots or, if further out, in the second level slot covering it.  Second
+ * level slots are moved down into the first level as the wheel turns.
+ * Timers further out than the second level go into the timer heap.
+ */
+#define THREAD_WHEEL_TICK_MSEC 100
+#define THREAD_WHEEL_BITS 8
+#define THREAD_WHEEL_SLOTS (1U << THREAD_WHEEL_BITS)
+
+struct thread_wheel {
+	/* last tick processed */
+	uint64_t tick;
+	/* number of timers in the wheel */
+	size_t count;
+	struct thread_wheel_list_head slots[2][THREAD_WHEEL_SLOTS];
+};
 
 struct fd_handler {
 	/* number of pfd that fit in the allocated space of pfds. This is a
@@ -70,6 +90,20 @@ struct fd_handler {
 	struct pollfd *copy;
 	/* number of pollfds stored in copy */
 	nfds_t copycount;
+
+#ifdef HAVE_EPOLL
+	/* epoll instance, -1 if the poll() backend is used.  With epoll,
+	 * pfds only serves as the list of scheduled fds and copy is unused.
+	 */
+	int epfd;
+	/* position + 1 of each fd in pfds, 0 if the fd is not in pfds */
+	nfds_t *pfdidx;
+	/* fd is known to the epoll instance (possibly disarmed) */
+	bool *epoll_reg;
+	/* result buffer for epoll_pwait() */
+	struct epoll_event *events;
+	int eventsize;
+#endif
 };
 
 struct xref_threadsched {
@@ -80,6 +114,18 @@ struct xref_threadsched {
 	uint32_t thread_type;
 };
 
+/*
+ * Scheduling delay, i.e. how long tasks waited to run after they became
+ * ready: bucket i counts delays of less than 2^i microseconds, the last
+ * bucket everything longer.
+ */
+#define THREAD_DELAY_BUCKETS 24
+
+struct thread_delay_hist {
+	atomic_size_t count[THREAD_DELAY_BUCKETS];
+	atomic_size_t max;
+};
+
 /* Master of the theads. */
 struct thread_master {
 	char *name;
@@ -87,6 +133,7 @@ struct thread_master {
 	struct thread **read;
 	struct thread **write;
 	struct thread_timer_list_head timer;
+	struct thread_wheel wheel;
 	struct thread_list_head event, ready, unuse;
 	struct list *cancel_req;
 	bool canceled;
@@ -104,6 +151,18 @@ struct thread_master {
 
 	bool ready_run_loop;
 	RUSAGE_T last_getrusage;
+	bool last_getrusage_cpu; /* last_getrusage includes the CPU time */
+	unsigned int cputime_skip; /* tasks until the next sampled one */
+
+	/* time the last poll() returned, when I/O tasks became ready */
+	struct timeval poll_time;
+	struct thread_delay_hist delay;
+
+	/* task currently running (its funcname, 0 while idle) and when it
+	 * started, in monotonic milliseconds; read from other pthreads
+	 */
+	atomic_uintptr_t task_name;
+	atomic_uint_fast32_t task_start;
 };
 
 /* Thread itself. */
@@ -112,6 +171,9 @@ struct thread {
 	uint8_t add_type;	  /* thread type */
 	struct thread_list_item threaditem;
 	struct thread_timer_list_item timeritem;
+	struct thread_wheel_list_item wheelitem;
+	/* wheel slot of a coarse timer, NULL if not in the wheel */
+	struct thread_wheel_list_head *wheel_slot;
 	struct thread **ref;	  /* external reference (if given) */
 	struct thread_master *master; /* pointer to the struct thread_master */
 	void (*func)(struct thread *); /* event function */
@@ -122,6 +184,7 @@ struct thread {
 		struct timeval sands; /* rest of time sands value. */
 	} u;
 	struct timeval real;
+	struct timeval ready;		 /* time it became ready to run */
 	struct cpu_thread_history *hist; /* cache pointer to cpu_history */
 	unsigned long yield;		 /* yield time in microseconds */
 	const struct xref_threadsched *xref;   /* origin location */
@@ -144,6 +207,7 @@ struct cpu_thread_history {
 		atomic_size_t total, max;
 	} real;
 	struct time_stats cpu;
+	struct thread_delay_hist delay;
 	atomic_uint_fast32_t types;
 	const char *funcname;
 };
@@ -204,6 +268,7 @@ struct cpu_thread_history {
 #define thread_add_timer(m,f,a,v,t)      _xref_t_a(timer,      TIMER, m,f,a,v,t)
 #define thread_add_timer_msec(m,f,a,v,t) _xref_t_a(timer_msec, TIMER, m,f,a,v,t)
 #define thread_add_timer_tv(m,f,a,v,t)   _xref_t_a(timer_tv,   TIMER, m,f,a,v,t)
+#define thread_add_timer_coarse(m,f,a,v,t) _xref_t_a(timer_coarse, TIMER, m,f,a,v,t)
 #define thread_add_event(m,f,a,v,t)      _xref_t_a(event,      EVENT, m,f,a,v,t)
 
 #define thread_execute(m,f,a,v)                                                \
@@ -222,6 +287,18 @@ struct cpu_thread_history {
 /* Prototypes. */
 extern struct thread_master *thread_master_create(const char *);
 void thread_master_set_name(struct thread_master *master, const char *name);
+/* Name of the I/O backend in use, "poll" or "epoll" */
+extern const char *thread_master_backend(struct thread_master *m);
+/*
+ * Use poll() even if epoll is available, e.g. to compare them.  Only
+ * possible while no fds are scheduled, returns false otherwise.
+ */
+extern bool thread_master_use_poll(struct thread_master *m);
+/*
+ * Schedule func as an event on every thread_master, so that it runs once
+ * on each event loop's own pthread.
+ */
+extern void thread_master_broadcast(void (*func)(struct thread *), void *arg);
 extern void thread_master_free(struct thread_master *);
 extern void thread_master_free_unused(struct thread_master *);
 
@@ -245,6 +322,15 @@ extern void _thread_add_timer_tv(const struct xref_threadsched *xref,
 				 void (*fn)(struct thread *), void *arg,
 				 struct timeval *tv, struct thread **tref);
 
+/* Like _thread_add_timer(), for timers that can run up to
+ * THREAD_WHEEL_TICK_MSEC late, as most protocol timers can.  Adding and
+ * cancelling these is O(1).
+ */
+extern void _thread_add_timer_coarse(const struct xref_threadsched *xref,
+				     struct thread_master *master,
+				     void (*fn)(struct thread *), void *arg,
+				     long t, struct thread **tref);
+
 extern void _thread_add_event(const struct xref_threadsched *xref,
 			      struct thread_master *master,
 			      void (*fn)(struct thread *), void *arg, int val,
@@ -272,6 +358,11 @@ extern void thread_set_yield_time(struct thread *, unsigned long);
 
 /* Internal libfrr exports */
 extern void thread_getrusage(RUSAGE_T *);
+/* Milliseconds the task running on m has been running for, 0 while m is
+ * idle.  Safe to call from any pthread.
+ */
+extern uint32_t thread_master_task_time(struct thread_master *m,
+					const char **funcname);
 extern void thread_cmd_init(void);
 
 /* Returns elapsed real (wall clock) time. */
@@ -27,6 +27,7 @@
 #include "network.h"
 
 DEFINE_MTYPE_STATIC(LIB, TYPEDHASH_BUCKET, "Typed-hash bucket");
+DEFINE_MTYPE_STATIC(LIB, TYPEDFLATHASH, "Typed-flathash table");
 DEFINE_MTYPE_STATIC(LIB, SKIPLIST_OFLOW, "Skiplist overflow");
 DEFINE_MTYPE_STATIC(LIB, HEAP_ARRAY, "Typed-heap array");
 
@@ -197,6 +198,55 @@ void typesafe_hash_shrink(struct thash_head *head)
 	hash_consistency_check(head);
 }
 
+/* flat hash */
+
+void typesafe_flathash_resize(struct tflathash_head *head, uint8_t tabshift)
+{
+	struct tflathash_head old = *head;
+	uint32_t size, i;
+
+	if (!tabshift) {
+		assert(!head->count);
+		XFREE(MTYPE_TYPEDFLATHASH, head->slots);
+		head->ctrl = NULL;
+		head->deleted = 0;
+		head->tabshift = 0;
+		return;
+	}
+
+	size = 1U << tabshift;
+	assert(head->count * 8 <= size * 7);
+
+	/* one allocation, slot pointers first then control bytes */
+	head->slots = XCALLOC(MTYPE_TYPEDFLATHASH,
+			      size * (sizeof(head->slots[0]) + 1));
+	head->ctrl = (uint8_t *)(head->slots + size);
+	memset(head->ctrl, FLATHASH_EMPTY, size);
+	head->count = 0;
+	head->deleted = 0;
+	head->tabshift = tabshift;
+
+	for (i = 0; i < FLATHASH_SIZE(old); i++)
+		if (!(old.ctrl[i] & 0x80))
+			typesafe_flathash_insert(head, old.slots[i]);
+	assert(head->count == old.count);
+
+	XFREE(MTYPE_TYPEDFLATHASH, old.slots);
+}
+
+void typesafe_flathash_grow(struct tflathash_head *head)
+{
+	uint8_t tabshift = head->tabshift;
+
+	if (!tabshift)
+		tabshift = FLATHASH_MINSHIFT;
+	/* mostly full of deleted markers, just clean those up */
+	else if (head->deleted < head->count / 2)
+		tabshift++;
+
+	typesafe_flathash_resize(head, tabshift);
+}
+
 /* skiplist */
 
 static inline struct sskip_item *sl_level_get(const struct sskip_item *item,
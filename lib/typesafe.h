@@ -22,6 +22,10 @@
 #include <stdbool.h>
 #include "compiler.h"
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -959,6 +963,299 @@ macro_pure bool prefix ## _member(const struct prefix##_head *h,               \
 }                                                                              \
 MACRO_REQUIRE_SEMICOLON() /* end */
 
+/* hash with open addressing, in the style of "Swiss tables": besides the
+ * array of item pointers, there is one control byte per slot, holding 7
+ * bits of the item's hash value.  Lookups compare a group of 16 control
+ * bytes at once (with SSE2 where available) and only look at the items
+ * whose bits match, which mostly saves following a chain of items through
+ * the cache.  Iteration order is arbitrary like with HASH.
+ *
+ * Deleting items does not move other items, so frr_each_safe can delete
+ * the current item.  The table only shrinks in _pop().
+ */
+
+/* don't use these structs directly */
+struct tflathash_item {
+	uint32_t hashval;
+};
+
+struct tflathash_head {
+	struct tflathash_item **slots;
+	uint8_t *ctrl;
+	uint32_t count, deleted;
+
+	uint8_t tabshift;
+};
+
+#define FLATHASH_GROUP		16
+#define FLATHASH_MINSHIFT	4
+#define FLATHASH_EMPTY		0x80
+#define FLATHASH_DELETED	0xfe
+#define FLATHASH_TAG(hval)	((uint8_t)((hval) & 0x7f))
+
+#define FLATHASH_SIZE(head) \
+	((head).tabshift ? 1U << (head).tabshift : 0U)
+#define FLATHASH_GROUPS(head) \
+	(FLATHASH_SIZE(head) / FLATHASH_GROUP)
+/* first group to probe, from the top bits of the hash value */
+#define FLATHASH_START(head, hval) \
+	((uint32_t)(((uint64_t)(hval) << ((head).tabshift - 4)) >> 32))
+
+extern void typesafe_flathash_resize(struct tflathash_head *head,
+				     uint8_t tabshift);
+extern void typesafe_flathash_grow(struct tflathash_head *head);
+
+/* bit i is set if control byte i of the group is equal to val */
+static inline unsigned int typesafe_flathash_match(const uint8_t *ctrl,
+						   uint8_t val)
+{
+#ifdef __SSE2__
+	__m128i grp = _mm_loadu_si128((const __m128i *)ctrl);
+
+	return _mm_movemask_epi8(_mm_cmpeq_epi8(grp, _mm_set1_epi8(val)));
+#else
+	unsigned int i, bits = 0;
+
+	for (i = 0; i < FLATHASH_GROUP; i++)
+		bits |= (unsigned int)(ctrl[i] == val) << i;
+	return bits;
+#endif
+}
+
+/* bit i is set if slot i of the group is empty or deleted */
+static inline unsigned int typesafe_flathash_free(const uint8_t *ctrl)
+{
+#ifdef __SSE2__
+	return _mm_movemask_epi8(_mm_loadu_si128((const __m128i *)ctrl));
+#else
+	unsigned int i, bits = 0;
+
+	for (i = 0; i < FLATHASH_GROUP; i++)
+		bits |= (unsigned int)(ctrl[i] >> 7) << i;
+	return bits;
+#endif
+}
+
+/* slot holding item, or -1 */
+static inline int64_t
+typesafe_flathash_slot(const struct tflathash_head *head,
+		       const struct tflathash_item *item)
+{
+	uint32_t mask, g, i, bits;
+
+	if (!head->tabshift)
+		return -1;
+
+	mask = FLATHASH_GROUPS(*head) - 1;
+	g = FLATHASH_START(*head, item->hashval);
+	for (i = 0; i <= mask; i++, g = (g + i) & mask) {
+		const uint8_t *ctrl = &head->ctrl[g * FLATHASH_GROUP];
+
+		bits = typesafe_flathash_match(ctrl,
+					       FLATHASH_TAG(item->hashval));
+		while (bits) {
+			uint32_t s = g * FLATHASH_GROUP + __builtin_ctz(bits);
+
+			if (head->slots[s] == item)
+				return s;
+			bits &= bits - 1;
+		}
+		if (typesafe_flathash_match(ctrl, FLATHASH_EMPTY))
+			break;
+	}
+	return -1;
+}
+
+/* first used slot at or after pos, or -1 */
+static inline int64_t typesafe_flathash_used(const struct tflathash_head *head,
+					     uint32_t pos)
+{
+	uint32_t g, bits;
+
+	for (g = pos / FLATHASH_GROUP; g < FLATHASH_GROUPS(*head); g++) {
+		bits = ~typesafe_flathash_free(&head->ctrl[g * FLATHASH_GROUP]);
+		bits &= 0xffff;
+		if (g == pos / FLATHASH_GROUP)
+			bits &= ~0U << (pos % FLATHASH_GROUP);
+		if (bits)
+			return g * FLATHASH_GROUP + __builtin_ctz(bits);
+	}
+	return -1;
+}
+
+/* put item into the first free slot of its probe sequence */
+static inline void typesafe_flathash_insert(struct tflathash_head *head,
+					    struct tflathash_item *item)
+{
+	uint32_t mask, g, i, bits, s;
+
+	mask = FLATHASH_GROUPS(*head) - 1;
+	g = FLATHASH_START(*head, item->hashval);
+	for (i = 0;; i++, g = (g + i) & mask) {
+		bits = typesafe_flathash_free(&head->ctrl[g * FLATHASH_GROUP]);
+		if (bits)
+			break;
+	}
+
+	s = g * FLATHASH_GROUP + __builtin_ctz(bits);
+	if (head->ctrl[s] == FLATHASH_DELETED)
+		head->deleted--;
+	head->ctrl[s] = FLATHASH_TAG(item->hashval);
+	head->slots[s] = item;
+	head->count++;
+}
+
+static inline void typesafe_flathash_remove(struct tflathash_head *head,
+					    uint32_t s)
+{
+	const uint8_t *ctrl = &head->ctrl[s & ~(FLATHASH_GROUP - 1)];
+
+	/* no probe sequence goes past a group with an empty slot, so there
+	 * is no need to leave a marker behind
+	 */
+	if (typesafe_flathash_match(ctrl, FLATHASH_EMPTY))
+		head->ctrl[s] = FLATHASH_EMPTY;
+	else {
+		head->ctrl[s] = FLATHASH_DELETED;
+		head->deleted++;
+	}
+	head->slots[s] = NULL;
+	head->count--;
+}
+
+/* use as:
+ *
+ * PREDECL_FLATHASH(namelist)
+ * struct name {
+ *   struct namelist_item nlitem;
+ * }
+ * DECLARE_FLATHASH(namelist, struct name, nlitem, cmpfunc, hashfunc)
+ */
+#define PREDECL_FLATHASH(prefix)                                               \
+struct prefix ## _head { struct tflathash_head fh; };                          \
+struct prefix ## _item { struct tflathash_item fi; };                          \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
+#define INIT_FLATHASH(var)	{ }
+
+#define DECLARE_FLATHASH(prefix, type, field, cmpfn, hashfn)                   \
+                                                                               \
+macro_inline void prefix ## _init(struct prefix##_head *h)                     \
+{                                                                              \
+	memset(h, 0, sizeof(*h));                                              \
+}                                                                              \
+macro_inline void prefix ## _fini(struct prefix##_head *h)                     \
+{                                                                              \
+	assert(h->fh.count == 0);                                              \
+	typesafe_flathash_resize(&h->fh, 0);                                   \
+	memset(h, 0, sizeof(*h));                                              \
+}                                                                              \
+macro_inline const type *prefix ## _find_hval(const struct prefix##_head *h,   \
+					      const type *item, uint32_t hval) \
+{                                                                              \
+	uint32_t mask, g, i, bits;                                             \
+	if (!h->fh.tabshift)                                                   \
+		return NULL;                                                   \
+	mask = FLATHASH_GROUPS(h->fh) - 1;                                     \
+	g = FLATHASH_START(h->fh, hval);                                       \
+	for (i = 0; i <= mask; i++, g = (g + i) & mask) {                      \
+		const uint8_t *ctrl = &h->fh.ctrl[g * FLATHASH_GROUP];         \
+		bits = typesafe_flathash_match(ctrl, FLATHASH_TAG(hval));      \
+		while (bits) {                                                 \
+			const struct tflathash_item *hitem;                    \
+			hitem = h->fh.slots[g * FLATHASH_GROUP                 \
+					    + __builtin_ctz(bits)];            \
+			if (hitem->hashval == hval                             \
+			    && !cmpfn(container_of(hitem, type, field.fi),     \
+				      item))                                   \
+				return container_of(hitem, type, field.fi);    \
+			bits &= bits - 1;                                      \
+		}                                                              \
+		if (typesafe_flathash_match(ctrl, FLATHASH_EMPTY))             \
+			break;                                                 \
+	}                                                                      \
+	return NULL;                                                           \
+}                                                                              \
+macro_inline type *prefix ## _add(struct prefix##_head *h, type *item)         \
+{                                                                              \
+	uint32_t hval = hashfn(item);                                          \
+	const type *prev = prefix ## _find_hval(h, item, hval);                \
+	if (prev)                                                              \
+		return (type *)prev;                                           \
+	item->field.fi.hashval = hval;                                         \
+	if ((h->fh.count + h->fh.deleted + 1) * 8 > FLATHASH_SIZE(h->fh) * 7)  \
+		typesafe_flathash_grow(&h->fh);                                \
+	typesafe_flathash_insert(&h->fh, &item->field.fi);                     \
+	return NULL;                                                           \
+}                                                                              \
+macro_inline const type *prefix ## _const_find(const struct prefix##_head *h,  \
+					       const type *item)               \
+{                                                                              \
+	return prefix ## _find_hval(h, item, hashfn(item));                    \
+}                                                                              \
+TYPESAFE_FIND(prefix, type)                                                    \
+macro_inline type *prefix ## _del(struct prefix##_head *h, type *item)         \
+{                                                                              \
+	int64_t s = typesafe_flathash_slot(&h->fh, &item->field.fi);           \
+	if (s < 0)                                                             \
+		return NULL;                                                   \
+	typesafe_flathash_remove(&h->fh, s);                                   \
+	if (!h->fh.count)                                                      \
+		typesafe_flathash_resize(&h->fh, 0);                           \
+	return item;                                                           \
+}                                                                              \
+macro_inline type *prefix ## _pop(struct prefix##_head *h)                     \
+{                                                                              \
+	struct tflathash_item *hitem;                                          \
+	int64_t s = typesafe_flathash_used(&h->fh, 0);                         \
+	if (s < 0)                                                             \
+		return NULL;                                                   \
+	hitem = h->fh.slots[s];                                                \
+	typesafe_flathash_remove(&h->fh, s);                                   \
+	if (!h->fh.count)                                                      \
+		typesafe_flathash_resize(&h->fh, 0);                           \
+	else if (h->fh.tabshift > FLATHASH_MINSHIFT                            \
+		 && h->fh.count * 8 < FLATHASH_SIZE(h->fh))                    \
+		typesafe_flathash_resize(&h->fh, h->fh.tabshift - 1);          \
+	return container_of(hitem, type, field.fi);                            \
+}                                                                              \
+TYPESAFE_SWAP_ALL_SIMPLE(prefix)                                               \
+macro_pure const type *prefix ## _const_first(const struct prefix##_head *h)   \
+{                                                                              \
+	int64_t s = typesafe_flathash_used(&h->fh, 0);                         \
+	if (s < 0)                                                             \
+		return NULL;                                                   \
+	return container_of(h->fh.slots[s], type, field.fi);                   \
+}                                                                              \
+macro_pure const type *prefix ## _const_next(const struct prefix##_head *h,    \
+					     const type *item)                 \
+{                                                                              \
+	int64_t s = typesafe_flathash_slot(&h->fh, &item->field.fi);           \
+	if (s < 0)                                                             \
+		return NULL;                                                   \
+	s = typesafe_flathash_used(&h->fh, s + 1);                             \
+	if (s < 0)                                                             \
+		return NULL;                                                   \
+	return container_of(h->fh.slots[s], type, field.fi);                   \
+}                                                                              \
+TYPESAFE_FIRST_NEXT(prefix, type)                                              \
+macro_pure type *prefix ## _next_safe(struct prefix##_head *h, type *item)     \
+{                                                                              \
+	if (!item)                                                             \
+		return NULL;                                                   \
+	return prefix ## _next(h, item);                                       \
+}                                                                              \
+macro_pure size_t prefix ## _count(const struct prefix##_head *h)              \
+{                                                                              \
+	return h->fh.count;                                                    \
+}                                                                              \
+macro_pure bool prefix ## _member(const struct prefix##_head *h,               \
+				  const type *item)                            \
+{                                                                              \
+	return typesafe_flathash_slot(&h->fh, &item->field.fi) >= 0;           \
+}                                                                              \
+MACRO_REQUIRE_SEMICOLON() /* end */
+
 /* skiplist, sorted.
  * can be used as priority queue with add / pop
  */
@@ -35,6 +35,7 @@
 #include "lib_errors.h"
 #include "northbound.h"
 #include "northbound_cli.h"
+#include "jhash.h"
 
 /* default VRF name value used when VRF backend is not NETNS */
 #define VRF_DEFAULT_NAME_INTERNAL "default"
@@ -53,6 +54,20 @@ RB_GENERATE(vrf_name_head, vrf, name_entry, vrf_name_compare);
 struct vrf_id_head vrfs_by_id = RB_INITIALIZER(&vrfs_by_id);
 struct vrf_name_head vrfs_by_name = RB_INITIALIZER(&vrfs_by_name);
 
+static int vrf_id_hash_cmp(const struct vrf *a, const struct vrf *b);
+static uint32_t vrf_id_hash_key(const struct vrf *vrf);
+static int vrf_name_hash_cmp(const struct vrf *a, const struct vrf *b);
+static uint32_t vrf_name_hash_key(const struct vrf *vrf);
+
+DECLARE_HASH(vrf_id_hash, struct vrf, id_hitem, vrf_id_hash_cmp,
+	     vrf_id_hash_key);
+DECLARE_HASH(vrf_name_hash, struct vrf, name_hitem, vrf_name_hash_cmp,
+	     vrf_name_hash_key);
+
+/* lookups go through these, the RB trees only serve ordered walks */
+static struct vrf_id_hash_head vrf_id_hash = INIT_HASH(vrf_id_hash);
+static struct vrf_name_hash_head vrf_name_hash = INIT_HASH(vrf_name_hash);
+
 static int vrf_backend;
 static int vrf_backend_configured;
 static char vrf_default_name[VRF_NAMSIZ] = VRF_DEFAULT_NAME_INTERNAL;
@@ -80,7 +95,7 @@ struct vrf *vrf_lookup_by_name(const char *name)
 {
 	struct vrf vrf;
 	strlcpy(vrf.name, name, sizeof(vrf.name));
-	return (RB_FIND(vrf_name_head, &vrfs_by_name, &vrf));
+	return vrf_name_hash_find(&vrf_name_hash, &vrf);
 }
 
 static __inline int vrf_id_compare(const struct vrf *a, const struct vrf *b)
@@ -93,6 +108,53 @@ static int vrf_name_compare(const struct vrf *a, const struct vrf *b)
 	return strcmp(a->name, b->name);
 }
 
+static int vrf_id_hash_cmp(const struct vrf *a, const struct vrf *b)
+{
+	return numcmp(a->vrf_id, b->vrf_id);
+}
+
+static uint32_t vrf_id_hash_key(const struct vrf *vrf)
+{
+	return jhash_1word(vrf->vrf_id, 0xbf3a2d09);
+}
+
+static int vrf_name_hash_cmp(const struct vrf *a, const struct vrf *b)
+{
+	return strcmp(a->name, b->name);
+}
+
+static uint32_t vrf_name_hash_key(const struct vrf *vrf)
+{
+	return jhash(vrf->name, strlen(vrf->name), 0x5c2e7a41);
+}
+
+/* Keep both indexes on each key in step with the struct */
+void vrf_set_id(struct vrf *vrf, vrf_id_t vrf_id)
+{
+	if (vrf->vrf_id != VRF_UNKNOWN) {
+		RB_REMOVE(vrf_id_head, &vrfs_by_id, vrf);
+		vrf_id_hash_del(&vrf_id_hash, vrf);
+	}
+	vrf->vrf_id = vrf_id;
+	if (vrf_id != VRF_UNKNOWN) {
+		RB_INSERT(vrf_id_head, &vrfs_by_id, vrf);
+		vrf_id_hash_add(&vrf_id_hash, vrf);
+	}
+}
+
+static void vrf_set_name(struct vrf *vrf, const char *name)
+{
+	if (vrf->name[0] != '\0') {
+		RB_REMOVE(vrf_name_head, &vrfs_by_name, vrf);
+		vrf_name_hash_del(&vrf_name_hash, vrf);
+	}
+	strlcpy(vrf->name, name, sizeof(vrf->name));
+	if (vrf->name[0] != '\0') {
+		RB_INSERT(vrf_name_head, &vrfs_by_name, vrf);
+		vrf_name_hash_add(&vrf_name_hash, vrf);
+	}
+}
+
 int vrf_switch_to_netns(vrf_id_t vrf_id)
 {
 	char *name;
@@ -162,23 +224,17 @@ struct vrf *vrf_get(vrf_id_t vrf_id, const char *name)
 	}
 
 	/* Set identifier */
-	if (vrf_id != VRF_UNKNOWN && vrf->vrf_id == VRF_UNKNOWN) {
-		vrf->vrf_id = vrf_id;
-		RB_INSERT(vrf_id_head, &vrfs_by_id, vrf);
-	}
+	if (vrf_id != VRF_UNKNOWN && vrf->vrf_id == VRF_UNKNOWN)
+		vrf_set_id(vrf, vrf_id);
 
 	/* Set name */
 	if (name && vrf->name[0] != '\0' && strcmp(name, vrf->name)) {
 		/* update the vrf name */
-		RB_REMOVE(vrf_name_head, &vrfs_by_name, vrf);
 		strlcpy(vrf->data.l.netns_name,
 			name, NS_NAMSIZ);
-		strlcpy(vrf->name, name, sizeof(vrf->name));
-		RB_INSERT(vrf_name_head, &vrfs_by_name, vrf);
-	} else if (name && vrf->name[0] == '\0') {
-		strlcpy(vrf->name, name, sizeof(vrf->name));
-		RB_INSERT(vrf_name_head, &vrfs_by_name, vrf);
-	}
+		vrf_set_name(vrf, name);
+	} else if (name && vrf->name[0] == '\0')
+		vrf_set_name(vrf, name);
 	if (new &&vrf_master.vrf_new_hook)
 		(*vrf_master.vrf_new_hook)(vrf);
 
@@ -217,10 +273,7 @@ struct vrf *vrf_update(vrf_id_t new_vrf_id, const char *name)
 		 */
 		vrf_disable(vrf);
 
-
-		RB_REMOVE(vrf_id_head, &vrfs_by_id, vrf);
-		vrf->vrf_id = new_vrf_id;
-		RB_INSERT(vrf_id_head, &vrfs_by_id, vrf);
+		vrf_set_id(vrf, new_vrf_id);
 
 	} else {
 
@@ -244,10 +297,8 @@ void vrf_delete(struct vrf *vrf)
 	if (vrf_is_enabled(vrf))
 		vrf_disable(vrf);
 
-	if (vrf->vrf_id != VRF_UNKNOWN) {
-		RB_REMOVE(vrf_id_head, &vrfs_by_id, vrf);
-		vrf->vrf_id = VRF_UNKNOWN;
-	}
+	if (vrf->vrf_id != VRF_UNKNOWN)
+		vrf_set_id(vrf, VRF_UNKNOWN);
 
 	/* If the VRF is user configured, it'll stick around, just remove
 	 * the ID mapping. Interfaces assigned to this VRF should've been
@@ -265,8 +316,7 @@ void vrf_delete(struct vrf *vrf)
 
 	QOBJ_UNREG(vrf);
 
-	if (vrf->name[0] != '\0')
-		RB_REMOVE(vrf_name_head, &vrfs_by_name, vrf);
+	vrf_set_name(vrf, "");
 
 	XFREE(MTYPE_VRF, vrf);
 }
@@ -276,7 +326,7 @@ struct vrf *vrf_lookup_by_id(vrf_id_t vrf_id)
 {
 	struct vrf vrf;
 	vrf.vrf_id = vrf_id;
-	return (RB_FIND(vrf_id_head, &vrfs_by_id, &vrf));
+	return vrf_id_hash_find(&vrf_id_hash, &vrf);
 }
 
 /*
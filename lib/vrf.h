@@ -23,6 +23,7 @@
 #define _ZEBRA_VRF_H
 
 #include "openbsd-tree.h"
+#include "typesafe.h"
 #include "linklist.h"
 #include "qobj.h"
 #include "vty.h"
@@ -68,8 +69,14 @@ struct vrf_data {
 	};
 };
 
+PREDECL_HASH(vrf_id_hash);
+PREDECL_HASH(vrf_name_hash);
+
 struct vrf {
 	RB_ENTRY(vrf) id_entry, name_entry;
+	/* same indexes, for lookups; the trees are kept for ordered walks */
+	struct vrf_id_hash_item id_hitem;
+	struct vrf_name_hash_item name_hitem;
 
 	/* Identifier, same as the vector index */
 	vrf_id_t vrf_id;
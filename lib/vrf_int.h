@@ -56,6 +56,14 @@ extern int vrf_enable(struct vrf *);
  */
 extern void vrf_delete(struct vrf *);
 
+/*
+ * vrf_set_id
+ *
+ * Change the identifier of a vrf, VRF_UNKNOWN takes it
+ * out of the id lookups
+ */
+extern void vrf_set_id(struct vrf *vrf, vrf_id_t vrf_id);
+
 #ifdef __cplusplus
 }
 #endif
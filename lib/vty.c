@@ -76,7 +76,8 @@ enum vty_event {
 #ifdef VTYSH
 	VTYSH_SERV,
 	VTYSH_READ,
-	VTYSH_WRITE
+	VTYSH_WRITE,
+	VTYSH_WALK
 #endif /* VTYSH */
 };
 
@@ -299,6 +300,28 @@ int vty_json(struct vty *vty, struct json_object *json)
 	return CMD_SUCCESS;
 }
 
+void vty_json_stream_start(struct vty *vty)
+{
+	vty_out(vty, "{\n");
+}
+
+void vty_json_stream_add(struct vty *vty, bool *first, const char *key,
+			 struct json_object *json)
+{
+	const char *text;
+
+	text = json_object_to_json_string_ext(
+		json, JSON_C_TO_STRING_PRETTY | JSON_C_TO_STRING_NOSLASHESCAPE);
+	vty_out(vty, "%s  \"%s\":%s", *first ? "" : ",\n", key, text);
+	json_object_free(json);
+	*first = false;
+}
+
+void vty_json_stream_end(struct vty *vty, bool first)
+{
+	vty_out(vty, "%s}\n", first ? "" : "\n");
+}
+
 /* Output current time to the vty. */
 void vty_time_print(struct vty *vty, int cr)
 {
@@ -1885,6 +1908,16 @@ static void vty_serv_sock_addrinfo(const char *hostname, unsigned short port)
 	freeaddrinfo(ainfo_save);
 }
 
+static void vty_walk_finish(struct vty *vty)
+{
+	THREAD_OFF(vty->t_walk);
+	if (vty->walk_free)
+		vty->walk_free(vty->walk_arg);
+	vty->walk_fn = NULL;
+	vty->walk_free = NULL;
+	vty->walk_arg = NULL;
+}
+
 #ifdef VTYSH
 /* For sockaddr_un. */
 #include <sys/un.h>
@@ -2201,15 +2234,60 @@ static void vtysh_read(struct thread *thread)
 		vty_event(VTYSH_READ, vty);
 }
 
-static void vtysh_write(struct thread *thread)
+static void vty_walk_next(struct thread *thread)
 {
 	struct vty *vty = THREAD_ARG(thread);
+	unsigned char header[4] = {0, 0, 0, CMD_SUCCESS};
+
+	if (!vty->walk_fn(vty, vty->walk_arg)) {
+		/* continue once the client has taken this part */
+		if (vtysh_flush(vty) == 0 && !vty->t_write)
+			vty_event(VTYSH_WALK, vty);
+		return;
+	}
+
+	vty_walk_finish(vty);
 
+	buffer_put(vty->obuf, header, 4);
 	vtysh_flush(vty);
 }
 
+static void vtysh_write(struct thread *thread)
+{
+	struct vty *vty = THREAD_ARG(thread);
+
+	if (vtysh_flush(vty) < 0)
+		return;
+
+	if (vty->walk_fn && !vty->t_write)
+		vty_event(VTYSH_WALK, vty);
+}
+
 #endif /* VTYSH */
 
+int vty_walk(struct vty *vty, bool (*fn)(struct vty *vty, void *arg),
+	     void *arg, void (*free_fn)(void *arg))
+{
+#ifdef VTYSH
+	/* the result header is written when the walk is done */
+	if (vty->type == VTY_SHELL_SERV && !vty->walk_fn
+	    && vty->pass_fd == -1) {
+		vty->walk_fn = fn;
+		vty->walk_free = free_fn;
+		vty->walk_arg = arg;
+		vty_event(VTYSH_WALK, vty);
+		return CMD_SUSPEND;
+	}
+#endif /* VTYSH */
+
+	while (!fn(vty, arg))
+		;
+	if (free_fn)
+		free_fn(arg);
+
+	return CMD_SUCCESS;
+}
+
 /* Determine address family to bind. */
 void vty_serv_sock(const char *addr, unsigned short port, const char *path)
 {
@@ -2245,6 +2323,7 @@ void vty_close(struct vty *vty)
 	THREAD_OFF(vty->t_read);
 	THREAD_OFF(vty->t_write);
 	THREAD_OFF(vty->t_timeout);
+	vty_walk_finish(vty);
 
 	if (vty->pass_fd != -1) {
 		close(vty->pass_fd);
@@ -2717,6 +2796,10 @@ static void vty_event(enum vty_event event, struct vty *vty)
 		thread_add_write(vty_master, vtysh_write, vty, vty->wfd,
 				 &vty->t_write);
 		break;
+	case VTYSH_WALK:
+		thread_add_event(vty_master, vty_walk_next, vty, 0,
+				 &vty->t_walk);
+		break;
 #endif /* VTYSH */
 	case VTY_READ:
 		thread_add_read(vty_master, vty_read, vty, vty->fd,
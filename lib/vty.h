@@ -181,6 +181,12 @@ struct vty {
 	/* CLI command return value (likely CMD_SUCCESS) when pass_fd != -1 */
 	uint8_t pass_fd_status[4];
 
+	/* resumable show command in progress, see vty_walk() */
+	bool (*walk_fn)(struct vty *vty, void *arg);
+	void (*walk_free)(void *arg);
+	void *walk_arg;
+	struct thread *t_walk;
+
 	/* live logging target / terminal monitor */
 	struct zlog_live_cfg live_log;
 
@@ -356,6 +362,30 @@ extern bool vty_set_include(struct vty *vty, const char *regexp);
  */
 extern int vty_json(struct vty *vty, struct json_object *json);
 
+/* Print a large JSON object one member at a time, so the whole tree never
+ * has to be built in memory.  first must be true before the first
+ * vty_json_stream_add().  The key is printed as is and json is freed.
+ */
+extern void vty_json_stream_start(struct vty *vty);
+extern void vty_json_stream_add(struct vty *vty, bool *first, const char *key,
+				struct json_object *json);
+extern void vty_json_stream_end(struct vty *vty, bool first);
+
+/* Run a show command that walks a large table in steps, from the event
+ * loop, instead of all at once from the command handler.  fn is called
+ * with arg until it returns true, and should output a bounded amount
+ * (e.g. a few hundred table nodes) per call.  The next call is only made
+ * once the previous output has been written to the vtysh socket.  fn must
+ * not keep pointers into the table across calls.  free_fn (may be NULL)
+ * is called on arg when the walk is done or the vty closes.
+ *
+ * Returns the value the command handler should return.  It is not
+ * possible to output anything after the walk from the handler.  Other
+ * vty types run the whole walk before returning.
+ */
+extern int vty_walk(struct vty *vty, bool (*fn)(struct vty *vty, void *arg),
+		    void *arg, void (*free_fn)(void *arg));
+
 /* post fd to be passed to the vtysh client
  * fd is owned by the VTY code after this and will be closed when done
  */
@@ -29,7 +29,7 @@
 #include "log.h"
 
 DEFINE_MTYPE(LIB, WORK_QUEUE, "Work queue");
-DEFINE_MTYPE_STATIC(LIB, WORK_QUEUE_ITEM, "Work queue item");
+DEFINE_MTYPE_POOL_STATIC(LIB, WORK_QUEUE_ITEM, "Work queue item");
 DEFINE_MTYPE_STATIC(LIB, WORK_QUEUE_NAME, "Work queue name string");
 
 /* master list of work_queues */
@@ -41,6 +41,12 @@ static struct list *work_queues = &_work_queues;
 
 #define WORK_QUEUE_MIN_GRANULARITY 1
 
+/* lower bound for the yield time adjusted for spec.latency, in us */
+#define WORK_QUEUE_MIN_YIELD 500
+
+/* most items handed to spec.batchfunc at once */
+#define WORK_QUEUE_MAX_BATCH 256
+
 static struct work_queue_item *work_queue_item_new(struct work_queue *wq)
 {
 	struct work_queue_item *item;
@@ -140,10 +146,20 @@ static int work_queue_schedule(struct work_queue *wq, unsigned int delay)
 			thread_add_event(wq->master, work_queue_run, wq, 0,
 					 &wq->thread);
 
+		monotime(&wq->sched_time);
+		wq->sched_time.tv_sec += delay / 1000;
+		wq->sched_time.tv_usec += (delay % 1000) * 1000;
+		if (wq->sched_time.tv_usec >= TIMER_SECOND_MICRO) {
+			wq->sched_time.tv_sec++;
+			wq->sched_time.tv_usec -= TIMER_SECOND_MICRO;
+		}
+
 		/* set thread yield time, if needed */
+		if (!wq->yield_cur)
+			wq->yield_cur = wq->spec.yield;
 		if (thread_is_scheduled(wq->thread) &&
-		    wq->spec.yield != THREAD_YIELD_TIME_SLOT)
-			thread_set_yield_time(wq->thread, wq->spec.yield);
+		    wq->yield_cur != THREAD_YIELD_TIME_SLOT)
+			thread_set_yield_time(wq->thread, wq->yield_cur);
 		return 1;
 	} else
 		return 0;
@@ -200,6 +216,20 @@ DEFUN (show_work_queues,
 			wq->name);
 	}
 
+	vty_out(vty, "\n%8s %34s\n", "Yield", "Event loop latency (us)");
+	vty_out(vty, "%8s %6s %6s %6s %6s %6s %6s %8s %s\n", "(us)", "<10",
+		"<100", "<1k", "<10k", "<100k", ">=100k", "Max", "Name");
+
+	for (ALL_LIST_ELEMENTS_RO(work_queues, node, wq)) {
+		unsigned int i;
+
+		vty_out(vty, "%8lu", wq->yield_cur ? wq->yield_cur
+						   : wq->spec.yield);
+		for (i = 0; i < WQ_LATENCY_BUCKETS; i++)
+			vty_out(vty, " %6lu", wq->latency[i]);
+		vty_out(vty, " %8lu %s\n", wq->latency_max, wq->name);
+	}
+
 	return CMD_SUCCESS;
 }
 
@@ -229,6 +259,64 @@ void work_queue_unplug(struct work_queue *wq)
 	work_queue_schedule(wq, wq->spec.hold);
 }
 
+/* account how long this run waited for the event loop, and adapt the
+ * yield time to spec.latency
+ */
+static void work_queue_latency(struct work_queue *wq, struct thread *thread)
+{
+	int64_t latency = monotime_since(&wq->sched_time, NULL);
+	unsigned int i;
+	int64_t bound = 10;
+
+	if (latency < 0)
+		latency = 0;
+
+	for (i = 0; i < WQ_LATENCY_BUCKETS - 1 && latency >= bound; i++)
+		bound *= 10;
+	wq->latency[i]++;
+	if ((unsigned long)latency > wq->latency_max)
+		wq->latency_max = latency;
+
+	if (!wq->yield_cur)
+		wq->yield_cur = wq->spec.yield;
+
+	if (wq->spec.latency && (unsigned long)latency > wq->spec.latency)
+		wq->yield_cur = MAX(wq->yield_cur / 2,
+				    MIN(WORK_QUEUE_MIN_YIELD, wq->spec.yield));
+	else if (wq->yield_cur < wq->spec.yield)
+		wq->yield_cur = MIN(wq->yield_cur + wq->yield_cur / 4 + 1,
+				    wq->spec.yield);
+	else
+		wq->yield_cur = wq->spec.yield;
+
+	thread_set_yield_time(thread, wq->yield_cur);
+}
+
+/* Process up to granularity items with spec.batchfunc */
+static unsigned int work_queue_run_batch(struct work_queue *wq,
+					 bool *stopped)
+{
+	void *data[WORK_QUEUE_MAX_BATCH];
+	unsigned int max = MIN(wq->cycles.granularity, WORK_QUEUE_MAX_BATCH);
+	struct work_queue_item *item;
+	unsigned int count = 0, done, i;
+
+	STAILQ_FOREACH (item, &wq->items, wq) {
+		if (count == max)
+			break;
+		data[count++] = item->data;
+	}
+
+	done = wq->spec.batchfunc(wq, data, count);
+	assert(done <= count);
+
+	for (i = 0; i < done; i++)
+		work_queue_item_remove(wq, STAILQ_FIRST(&wq->items));
+
+	*stopped = done < count;
+	return done;
+}
+
 /* timer thread to process a work queue
  * will reschedule itself if required,
  * otherwise work_queue_item_add
@@ -267,6 +355,25 @@ void work_queue_run(struct thread *thread)
 	if (wq->cycles.granularity == 0)
 		wq->cycles.granularity = WORK_QUEUE_MIN_GRANULARITY;
 
+	work_queue_latency(wq, thread);
+
+	if (wq->spec.batchfunc) {
+		bool stopped = false;
+
+		while (!work_queue_empty(wq)) {
+			cycles += work_queue_run_batch(wq, &stopped);
+			if (stopped) {
+				ret = WQ_RETRY_LATER;
+				break;
+			}
+			if (thread_should_yield(thread)) {
+				yielded = 1;
+				break;
+			}
+		}
+		goto stats;
+	}
+
 	STAILQ_FOREACH_SAFE (item, &wq->items, wq, titem) {
 		assert(item->data);
 
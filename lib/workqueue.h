@@ -79,6 +79,15 @@ struct work_queue {
 		 */
 		wq_item_status (*workfunc)(struct work_queue *, void *);
 
+		/* alternative to workfunc, processes several items per call:
+		 * gets the data of up to count items from the head of the
+		 * queue and returns how many of them it is done with, these
+		 * are removed.  Returning less than count stops the run like
+		 * WQ_RETRY_LATER.  max_retries does not apply.
+		 */
+		unsigned int (*batchfunc)(struct work_queue *, void **data,
+					  unsigned int count);
+
 		/* callback to delete user specific item data */
 		void (*del_item_data)(struct work_queue *, void *);
 
@@ -95,6 +104,13 @@ struct work_queue {
 			yield; /* yield time in us for associated thread */
 
 		uint32_t retry; /* Optional retry timeout if queue is blocked */
+
+		/* Optional target in us for how long the queue's runs may
+		 * wait for the event loop.  When they wait longer, the yield
+		 * time is reduced so other tasks get to run sooner, and it
+		 * grows back to 'yield' when they don't.
+		 */
+		unsigned long latency;
 	} spec;
 
 	/* remaining fields should be opaque to users */
@@ -110,6 +126,13 @@ struct work_queue {
 		unsigned long total;
 	} cycles; /* cycle counts */
 
+	/* time the run was scheduled for, and observed event loop latency */
+	struct timeval sched_time;
+	unsigned long yield_cur; /* current yield time, in us */
+#define WQ_LATENCY_BUCKETS 6
+	unsigned long latency[WQ_LATENCY_BUCKETS]; /* <10us, <100us, ... */
+	unsigned long latency_max;
+
 	/* private state */
 	uint16_t flags; /* user set flag */
 };
@@ -50,6 +50,9 @@ DEFINE_MTYPE_STATIC(LIB, REDIST_INST, "Redistribution instance IDs");
 /* Zebra client events. */
 enum zclient_event { ZCLIENT_SCHEDULE, ZCLIENT_READ, ZCLIENT_CONNECT };
 
+/* Messages handled per run of zclient_read() */
+#define ZCLIENT_READ_MAX 100
+
 /* Prototype for event manager. */
 static void zclient_event(enum zclient_event, struct zclient *);
 
@@ -77,6 +80,7 @@ struct zclient *zclient_new(struct thread_master *master,
 	zclient = XCALLOC(MTYPE_ZCLIENT, sizeof(struct zclient));
 
 	zclient->ibuf = stream_new(stream_size);
+	zclient->ibuf_work = stream_new(stream_size);
 	zclient->obuf = stream_new(stream_size);
 	zclient->wb = buffer_new(0);
 	zclient->master = master;
@@ -99,10 +103,14 @@ void zclient_free(struct zclient *zclient)
 {
 	if (zclient->ibuf)
 		stream_free(zclient->ibuf);
+	if (zclient->ibuf_work)
+		stream_free(zclient->ibuf_work);
 	if (zclient->obuf)
 		stream_free(zclient->obuf);
 	if (zclient->wb)
 		buffer_free(zclient->wb);
+	if (zclient->bulk)
+		stream_free(zclient->bulk);
 
 	XFREE(MTYPE_ZCLIENT, zclient);
 }
@@ -181,10 +189,14 @@ void zclient_stop(struct zclient *zclient)
 
 	/* Reset streams. */
 	stream_reset(zclient->ibuf);
+	stream_reset(zclient->ibuf_work);
 	stream_reset(zclient->obuf);
 
 	/* Empty the write buffer. */
 	buffer_reset(zclient->wb);
+	if (zclient->bulk)
+		stream_reset(zclient->bulk);
+	zclient->route_bulk = false;
 
 	/* Close socket. */
 	if (zclient->sock >= 0) {
@@ -291,6 +303,138 @@ static void zclient_flush_data(struct thread *thread)
 	}
 }
 
+/* Offset of the prefix length in an encoded ZAPI route message, following
+ * type, instance, flags, message, safi and family.
+ */
+#define ZAPI_ROUTE_PREFIX_OFFSET (ZEBRA_HEADER_SIZE + 13)
+
+/* Queue the pending ZEBRA_ROUTE_ADD_BULK message, if any, on wb. */
+static void zclient_route_bulk_flush(struct zclient *zclient)
+{
+	struct stream *s = zclient->bulk;
+
+	if (!s || !stream_get_endp(s))
+		return;
+
+	if (zclient->bulk_pbr) {
+		stream_putl_at(s, ZEBRA_HEADER_SIZE, zclient->bulk_num);
+		stream_putw_at(s, 0, stream_get_endp(s));
+		buffer_put(zclient->wb, STREAM_DATA(s), stream_get_endp(s));
+	} else if (zclient->bulk_num) {
+		stream_putw_at(s, ZAPI_HEADER_CMD_LOCATION, ZEBRA_ROUTE_ADD_BULK);
+		stream_putw_at(s, zclient->bulk_cnt, zclient->bulk_num);
+		stream_putw_at(s, 0, stream_get_endp(s));
+		buffer_put(zclient->wb, STREAM_DATA(s), stream_get_endp(s));
+	} else
+		/* a single route goes out as the ZEBRA_ROUTE_ADD it was */
+		buffer_put(zclient->wb, STREAM_DATA(s), zclient->bulk_cnt);
+
+	stream_reset(s);
+}
+
+/*
+ * obuf holds an encoded ZEBRA_ROUTE_ADD.  Append its prefix to the pending
+ * bulk message if everything else in the encoding is identical, otherwise
+ * start a new bulk message with it.
+ */
+static void zclient_route_bulk_add(struct zclient *zclient)
+{
+	struct stream *bulk = zclient->bulk;
+	uint8_t *data = STREAM_DATA(zclient->obuf);
+	size_t len = stream_get_endp(zclient->obuf);
+	size_t pfx = ZAPI_ROUTE_PREFIX_OFFSET;
+	size_t rest;
+
+	if (!bulk)
+		bulk = zclient->bulk = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	rest = pfx + 1 + PSIZE(data[pfx]);
+	if (rest > len) {
+		zclient_route_bulk_flush(zclient);
+		buffer_put(zclient->wb, data, len);
+		return;
+	}
+
+	if (stream_get_endp(bulk)) {
+		uint8_t *bdata = STREAM_DATA(bulk);
+
+		/* skip the length field, which differs with the prefix */
+		if (!zclient->bulk_pbr
+		    && zclient->bulk_num < ZAPI_ROUTE_BULK_MAX
+		    && rest - pfx <= STREAM_WRITEABLE(bulk)
+		    && len - rest == zclient->bulk_cnt - zclient->bulk_rest
+		    && !memcmp(data + 2, bdata + 2, pfx - 2)
+		    && !memcmp(data + rest, bdata + zclient->bulk_rest,
+			       len - rest)) {
+			stream_put(bulk, data + pfx, rest - pfx);
+			zclient->bulk_num++;
+			return;
+		}
+		zclient_route_bulk_flush(zclient);
+	}
+
+	stream_put(bulk, data, len);
+	zclient->bulk_pbr = false;
+	zclient->bulk_rest = rest;
+	zclient->bulk_cnt = len;
+	zclient->bulk_num = 0;
+	stream_putw(bulk, 0);
+}
+
+/*
+ * PBR messages carry a count of the objects they hold, and zebra has always
+ * accepted more than one.  Inside a batch, consecutive ones with the same
+ * command are merged, instead of sending one message for each ipset entry or
+ * rule.  Returns false if obuf holds another kind of message.
+ */
+static bool zclient_pbr_bulk_add(struct zclient *zclient)
+{
+	struct stream *bulk = zclient->bulk;
+	uint8_t *data = STREAM_DATA(zclient->obuf);
+	size_t len = stream_get_endp(zclient->obuf);
+	size_t hdr = ZEBRA_HEADER_SIZE + sizeof(uint32_t);
+	uint16_t cmd;
+	uint32_t num;
+
+	if (len < hdr)
+		return false;
+
+	cmd = stream_getw_from(zclient->obuf, ZAPI_HEADER_CMD_LOCATION);
+	switch (cmd) {
+	case ZEBRA_RULE_ADD:
+	case ZEBRA_RULE_DELETE:
+	case ZEBRA_IPSET_CREATE:
+	case ZEBRA_IPSET_DESTROY:
+	case ZEBRA_IPSET_ENTRY_ADD:
+	case ZEBRA_IPSET_ENTRY_DELETE:
+		break;
+	default:
+		return false;
+	}
+
+	num = stream_getl_from(zclient->obuf, ZEBRA_HEADER_SIZE);
+
+	if (!bulk)
+		bulk = zclient->bulk = stream_new(ZEBRA_MAX_PACKET_SIZ);
+
+	/* the header only differs in its length field */
+	if (stream_get_endp(bulk) && zclient->bulk_pbr
+	    && num <= UINT16_MAX - zclient->bulk_num
+	    && len - hdr <= STREAM_WRITEABLE(bulk)
+	    && !memcmp(data + 2, STREAM_DATA(bulk) + 2,
+		       ZEBRA_HEADER_SIZE - 2)) {
+		stream_put(bulk, data + hdr, len - hdr);
+		zclient->bulk_num += num;
+		return true;
+	}
+
+	zclient_route_bulk_flush(zclient);
+	stream_put(bulk, data, len);
+	zclient->bulk_pbr = true;
+	zclient->bulk_num = num;
+	return true;
+}
+
 /*
  * Returns:
  * ZCLIENT_SEND_FAILED   - is a failure
@@ -301,6 +445,14 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 {
 	if (zclient->sock < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (zclient->batch) {
+		if (zclient_pbr_bulk_add(zclient))
+			return ZCLIENT_SEND_BUFFERED;
+		zclient_route_bulk_flush(zclient);
+		buffer_put(zclient->wb, STREAM_DATA(zclient->obuf),
+			   stream_get_endp(zclient->obuf));
+		return ZCLIENT_SEND_BUFFERED;
+	}
 	switch (buffer_write(zclient->wb, zclient->sock,
 			     STREAM_DATA(zclient->obuf),
 			     stream_get_endp(zclient->obuf))) {
@@ -322,6 +474,39 @@ enum zclient_send_status zclient_send_message(struct zclient *zclient)
 	return ZCLIENT_SEND_SUCCESS;
 }
 
+void zclient_batch_start(struct zclient *zclient)
+{
+	zclient->batch++;
+}
+
+enum zclient_send_status zclient_batch_end(struct zclient *zclient)
+{
+	assert(zclient->batch);
+	if (--zclient->batch)
+		return ZCLIENT_SEND_BUFFERED;
+
+	if (zclient->sock < 0)
+		return ZCLIENT_SEND_FAILURE;
+	zclient_route_bulk_flush(zclient);
+	switch (buffer_flush_available(zclient->wb, zclient->sock)) {
+	case BUFFER_ERROR:
+		flog_err(EC_LIB_ZAPI_SOCKET,
+			 "%s: buffer_flush_available failed to zclient fd %d, closing",
+			 __func__, zclient->sock);
+		return zclient_failed(zclient);
+	case BUFFER_EMPTY:
+		THREAD_OFF(zclient->t_write);
+		return ZCLIENT_SEND_SUCCESS;
+	case BUFFER_PENDING:
+		thread_add_write(zclient->master, zclient_flush_data, zclient,
+				 zclient->sock, &zclient->t_write);
+		return ZCLIENT_SEND_BUFFERED;
+	}
+
+	/* should not get here */
+	return ZCLIENT_SEND_SUCCESS;
+}
+
 /*
  * If we add more data to this structure please ensure that
  * struct zmsghdr in lib/zclient.h is updated as appropriate.
@@ -829,6 +1014,12 @@ zclient_route_send(uint8_t cmd, struct zclient *zclient, struct zapi_route *api)
 {
 	if (zapi_route_encode(cmd, zclient->obuf, api) < 0)
 		return ZCLIENT_SEND_FAILURE;
+	if (cmd == ZEBRA_ROUTE_ADD && zclient->batch && zclient->route_bulk
+	    && zclient->sock >= 0
+	    && !CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
+		zclient_route_bulk_add(zclient);
+		return ZCLIENT_SEND_BUFFERED;
+	}
 	return zclient_send_message(zclient);
 }
 
@@ -952,7 +1143,7 @@ static int zapi_nexthop_cmp_no_labels(const struct zapi_nexthop *next1,
 	return 0;
 }
 
-static int zapi_nexthop_cmp(const void *item1, const void *item2)
+int zapi_nexthop_cmp(const void *item1, const void *item2)
 {
 	int ret = 0;
 
@@ -1149,7 +1340,8 @@ static int zapi_nhg_encode(struct stream *s, int cmd, struct zapi_nhg *api_nhg)
 {
 	int i;
 
-	if (cmd != ZEBRA_NHG_DEL && cmd != ZEBRA_NHG_ADD) {
+	if (cmd != ZEBRA_NHG_DEL && cmd != ZEBRA_NHG_ADD
+	    && cmd != ZEBRA_NHG_MEMBER_ADD && cmd != ZEBRA_NHG_MEMBER_DEL) {
 		flog_err(EC_LIB_ZAPI_ENCODE,
 			 "%s: Specified zapi NHG command (%d) doesn't exist",
 			 __func__, cmd);
@@ -1173,7 +1365,7 @@ static int zapi_nhg_encode(struct stream *s, int cmd, struct zapi_nhg *api_nhg)
 	stream_putl(s, api_nhg->resilience.idle_timer);
 	stream_putl(s, api_nhg->resilience.unbalanced_timer);
 
-	if (cmd == ZEBRA_NHG_ADD) {
+	if (cmd != ZEBRA_NHG_DEL) {
 		/* Nexthops */
 		zapi_nexthop_group_sort(api_nhg->nexthops,
 					api_nhg->nexthop_num);
@@ -1450,78 +1642,53 @@ stream_failure:
 	return ret;
 }
 
-int zapi_route_decode(struct stream *s, struct zapi_route *api)
+/* Destination and source prefixes of a route message */
+static int zapi_route_prefix_decode(struct stream *s, uint32_t message,
+				    struct prefix *p,
+				    struct prefix_ipv6 *src_p)
 {
-	struct zapi_nexthop *api_nh;
-	int i;
-
-	memset(api, 0, sizeof(*api));
-
-	/* Type, flags, message. */
-	STREAM_GETC(s, api->type);
-	if (api->type >= ZEBRA_ROUTE_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route type: %d is not a legal value",
-			 __func__, api->type);
-		return -1;
-	}
-
-	STREAM_GETW(s, api->instance);
-	STREAM_GETL(s, api->flags);
-	STREAM_GETL(s, api->message);
-	STREAM_GETC(s, api->safi);
-	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
-		flog_err(EC_LIB_ZAPI_ENCODE,
-			 "%s: Specified route SAFI (%u) is not a legal value",
-			 __func__, api->safi);
-		return -1;
-	}
-
-	/* Prefix. */
-	STREAM_GETC(s, api->prefix.family);
-	STREAM_GETC(s, api->prefix.prefixlen);
-	switch (api->prefix.family) {
+	STREAM_GETC(s, p->family);
+	STREAM_GETC(s, p->prefixlen);
+	switch (p->family) {
 	case AF_INET:
-		if (api->prefix.prefixlen > IPV4_MAX_BITLEN) {
+		if (p->prefixlen > IPV4_MAX_BITLEN) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: V4 prefixlen is %d which should not be more than 32",
-				__func__, api->prefix.prefixlen);
+				__func__, p->prefixlen);
 			return -1;
 		}
 		break;
 	case AF_INET6:
-		if (api->prefix.prefixlen > IPV6_MAX_BITLEN) {
+		if (p->prefixlen > IPV6_MAX_BITLEN) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: v6 prefixlen is %d which should not be more than 128",
-				__func__, api->prefix.prefixlen);
+				__func__, p->prefixlen);
 			return -1;
 		}
 		break;
 	default:
 		flog_err(EC_LIB_ZAPI_ENCODE,
 			 "%s: Specified family %d is not v4 or v6", __func__,
-			 api->prefix.family);
+			 p->family);
 		return -1;
 	}
-	STREAM_GET(&api->prefix.u.prefix, s, PSIZE(api->prefix.prefixlen));
+	STREAM_GET(&p->u.prefix, s, PSIZE(p->prefixlen));
 
-	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
-		api->src_prefix.family = AF_INET6;
-		STREAM_GETC(s, api->src_prefix.prefixlen);
-		if (api->src_prefix.prefixlen > IPV6_MAX_BITLEN) {
+	if (CHECK_FLAG(message, ZAPI_MESSAGE_SRCPFX)) {
+		src_p->family = AF_INET6;
+		STREAM_GETC(s, src_p->prefixlen);
+		if (src_p->prefixlen > IPV6_MAX_BITLEN) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: SRC Prefix prefixlen received: %d is too large",
-				__func__, api->src_prefix.prefixlen);
+				__func__, src_p->prefixlen);
 			return -1;
 		}
-		STREAM_GET(&api->src_prefix.prefix, s,
-			   PSIZE(api->src_prefix.prefixlen));
+		STREAM_GET(&src_p->prefix, s, PSIZE(src_p->prefixlen));
 
-		if (api->prefix.family != AF_INET6
-		    || api->src_prefix.prefixlen == 0) {
+		if (p->family != AF_INET6 || src_p->prefixlen == 0) {
 			flog_err(
 				EC_LIB_ZAPI_ENCODE,
 				"%s: SRC prefix specified in some manner that makes no sense",
@@ -1530,6 +1697,56 @@ int zapi_route_decode(struct stream *s, struct zapi_route *api)
 		}
 	}
 
+	return 0;
+stream_failure:
+	return -1;
+}
+
+int zapi_route_decode(struct stream *s, struct zapi_route *api)
+{
+	struct zapi_nexthop *api_nh;
+	int i;
+
+	/*
+	 * The nexthop arrays and the opaque data make up almost all of the
+	 * struct (tens of KB with a large MULTIPATH_NUM), so only clear what
+	 * is going to be used.  Nexthops are cleared as they are decoded; the
+	 * first ones are always cleared in case a caller peeks at them.
+	 */
+	memset(api, 0, offsetof(struct zapi_route, nexthops));
+	memset(&api->nexthops[0], 0, sizeof(api->nexthops[0]));
+	api->backup_nexthop_num = 0;
+	memset(&api->backup_nexthops[0], 0, sizeof(api->backup_nexthops[0]));
+	memset(&api->nhgid, 0,
+	       offsetof(struct zapi_route, opaque.data)
+		       - offsetof(struct zapi_route, nhgid));
+
+	/* Type, flags, message. */
+	STREAM_GETC(s, api->type);
+	if (api->type >= ZEBRA_ROUTE_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route type: %d is not a legal value",
+			 __func__, api->type);
+		return -1;
+	}
+
+	STREAM_GETW(s, api->instance);
+	STREAM_GETL(s, api->flags);
+	STREAM_GETL(s, api->message);
+	STREAM_GETC(s, api->safi);
+	if (api->safi < SAFI_UNICAST || api->safi >= SAFI_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route SAFI (%u) is not a legal value",
+			 __func__, api->safi);
+		return -1;
+	}
+
+	/* Prefix. */
+	if (zapi_route_prefix_decode(s, api->message, &api->prefix,
+				     &api->src_prefix)
+	    < 0)
+		return -1;
+
 	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG))
 		STREAM_GETL(s, api->nhgid);
 
@@ -1545,6 +1762,7 @@ int zapi_route_decode(struct stream *s, struct zapi_route *api)
 
 		for (i = 0; i < api->nexthop_num; i++) {
 			api_nh = &api->nexthops[i];
+			memset(api_nh, 0, sizeof(*api_nh));
 
 			if (zapi_nexthop_decode(s, api_nh, api->flags,
 						api->message)
@@ -1565,6 +1783,7 @@ int zapi_route_decode(struct stream *s, struct zapi_route *api)
 
 		for (i = 0; i < api->backup_nexthop_num; i++) {
 			api_nh = &api->backup_nexthops[i];
+			memset(api_nh, 0, sizeof(*api_nh));
 
 			if (zapi_nexthop_decode(s, api_nh, api->flags,
 						api->message)
@@ -1603,6 +1822,187 @@ stream_failure:
 	return -1;
 }
 
+/* Step over count nexthops, they are variable length */
+static int zapi_route_view_skip(struct zapi_route_view *view, uint16_t count)
+{
+	struct zapi_nexthop api_nh;
+
+	while (count--) {
+		memset(&api_nh, 0, sizeof(api_nh));
+		if (zapi_nexthop_decode(view->s, &api_nh, view->flags,
+					view->message)
+		    != 0)
+			return -1;
+	}
+	return 0;
+}
+
+int zapi_route_view_decode(struct stream *s, struct zapi_route_view *view)
+{
+	memset(view, 0, sizeof(*view));
+	view->s = s;
+
+	STREAM_GETC(s, view->type);
+	if (view->type >= ZEBRA_ROUTE_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route type: %d is not a legal value",
+			 __func__, view->type);
+		return -1;
+	}
+
+	STREAM_GETW(s, view->instance);
+	STREAM_GETL(s, view->flags);
+	STREAM_GETL(s, view->message);
+	STREAM_GETC(s, view->safi);
+	if (view->safi < SAFI_UNICAST || view->safi >= SAFI_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: Specified route SAFI (%u) is not a legal value",
+			 __func__, view->safi);
+		return -1;
+	}
+
+	if (zapi_route_prefix_decode(s, view->message, &view->prefix,
+				     &view->src_prefix)
+	    < 0)
+		return -1;
+
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_NHG))
+		STREAM_GETL(s, view->nhgid);
+
+	/*
+	 * Only remember where the nexthops are, the attributes after them
+	 * still need them to be stepped over once.
+	 */
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_NEXTHOP)) {
+		STREAM_GETW(s, view->nexthop_num);
+		if (view->nexthop_num > MULTIPATH_NUM) {
+			flog_err(EC_LIB_ZAPI_ENCODE,
+				 "%s: invalid number of nexthops (%u)",
+				 __func__, view->nexthop_num);
+			return -1;
+		}
+		view->nh_pos = stream_get_getp(s);
+		if (zapi_route_view_skip(view, view->nexthop_num) < 0)
+			return -1;
+	}
+
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_BACKUP_NEXTHOPS)) {
+		STREAM_GETW(s, view->backup_nexthop_num);
+		if (view->backup_nexthop_num > MULTIPATH_NUM) {
+			flog_err(EC_LIB_ZAPI_ENCODE,
+				 "%s: invalid number of backup nexthops (%u)",
+				 __func__, view->backup_nexthop_num);
+			return -1;
+		}
+		view->backup_pos = stream_get_getp(s);
+		if (zapi_route_view_skip(view, view->backup_nexthop_num) < 0)
+			return -1;
+	}
+
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_DISTANCE))
+		STREAM_GETC(s, view->distance);
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_METRIC))
+		STREAM_GETL(s, view->metric);
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_TAG))
+		STREAM_GETL(s, view->tag);
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_MTU))
+		STREAM_GETL(s, view->mtu);
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_TABLEID))
+		STREAM_GETL(s, view->tableid);
+
+	if (CHECK_FLAG(view->message, ZAPI_MESSAGE_OPAQUE)) {
+		STREAM_GETW(s, view->opaque_len);
+		if (view->opaque_len > ZAPI_MESSAGE_OPAQUE_LENGTH) {
+			flog_err(
+				EC_LIB_ZAPI_ENCODE,
+				"%s: opaque length %u is greater than allowed value",
+				__func__, view->opaque_len);
+			return -1;
+		}
+		if (STREAM_READABLE(s) < view->opaque_len)
+			goto stream_failure;
+		view->opaque = stream_pnt(s);
+		stream_forward_getp(s, view->opaque_len);
+	}
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
+static bool zapi_route_view_next(struct zapi_route_view *view,
+				 struct zapi_nexthop *api_nh, size_t *pos,
+				 uint16_t *next, uint16_t num)
+{
+	size_t getp;
+	int ret;
+
+	if (*next >= num)
+		return false;
+
+	getp = stream_get_getp(view->s);
+	stream_set_getp(view->s, *pos);
+	memset(api_nh, 0, sizeof(*api_nh));
+	ret = zapi_nexthop_decode(view->s, api_nh, view->flags, view->message);
+	*pos = stream_get_getp(view->s);
+	stream_set_getp(view->s, getp);
+
+	/* the view decode already went over these, this can't fail */
+	if (ret != 0)
+		return false;
+
+	(*next)++;
+	return true;
+}
+
+bool zapi_route_view_nexthop(struct zapi_route_view *view,
+			     struct zapi_nexthop *api_nh)
+{
+	return zapi_route_view_next(view, api_nh, &view->nh_pos,
+				    &view->nh_next, view->nexthop_num);
+}
+
+bool zapi_route_view_backup_nexthop(struct zapi_route_view *view,
+				    struct zapi_nexthop *api_nh)
+{
+	return zapi_route_view_next(view, api_nh, &view->backup_pos,
+				    &view->backup_next,
+				    view->backup_nexthop_num);
+}
+
+int zapi_route_bulk_decode(struct stream *s, const struct zapi_route *api,
+			   struct prefix *prefixes, uint16_t *count)
+{
+	struct prefix *p;
+	uint16_t i;
+
+	STREAM_GETW(s, *count);
+	if (*count > ZAPI_ROUTE_BULK_MAX) {
+		flog_err(EC_LIB_ZAPI_ENCODE,
+			 "%s: bulk route count %u is greater than allowed value",
+			 __func__, *count);
+		return -1;
+	}
+
+	for (i = 0; i < *count; i++) {
+		p = &prefixes[i];
+		memset(p, 0, sizeof(*p));
+		p->family = api->prefix.family;
+		STREAM_GETC(s, p->prefixlen);
+		if (p->prefixlen > prefix_blen(p) * 8) {
+			flog_err(EC_LIB_ZAPI_ENCODE,
+				 "%s: prefixlen %u is too large for family %u",
+				 __func__, p->prefixlen, p->family);
+			return -1;
+		}
+		STREAM_GET(&p->u.prefix, s, PSIZE(p->prefixlen));
+	}
+
+	return 0;
+stream_failure:
+	return -1;
+}
+
 static void zapi_encode_prefix(struct stream *s, struct prefix *p,
 			       uint8_t family)
 {
@@ -3759,6 +4159,9 @@ static int zclient_capability_decode(ZAPI_CALLBACK_ARGS)
 	cap.mpls_enabled = !!mpls_enabled;
 	STREAM_GETL(s, cap.ecmp);
 	STREAM_GETC(s, cap.role);
+	STREAM_GETC(s, cap.route_bulk);
+	zclient->route_bulk = cap.route_bulk;
+	STREAM_GETC(s, cap.nhg_members);
 
 	if (zclient->zebra_capabilities)
 		(*zclient->zebra_capabilities)(&cap);
@@ -4013,86 +4416,132 @@ static zclient_handler *const lib_handlers[] = {
 /* Zebra client message read function. */
 static void zclient_read(struct thread *thread)
 {
-	size_t already;
 	uint16_t length, command;
 	uint8_t marker, version;
 	vrf_id_t vrf_id;
 	struct zclient *zclient;
+	struct stream *work;
+	size_t start, want;
+	ssize_t nbyte;
+	unsigned int count = 0;
 
 	/* Get socket to zebra. */
 	zclient = THREAD_ARG(thread);
 	zclient->t_read = NULL;
 
-	/* Read zebra header (if we don't have it already). */
-	already = stream_get_endp(zclient->ibuf);
-	if (already < ZEBRA_HEADER_SIZE) {
-		ssize_t nbyte;
-		if (((nbyte = stream_read_try(zclient->ibuf, zclient->sock,
-					      ZEBRA_HEADER_SIZE - already))
-		     == 0)
-		    || (nbyte == -1)) {
-			if (zclient_debug)
-				zlog_debug(
-					"zclient connection closed socket [%d].",
-					zclient->sock);
+	while (count < ZCLIENT_READ_MAX) {
+		work = zclient->ibuf_work;
+
+		/* Read zebra header (if we don't have it already). */
+		want = ZEBRA_HEADER_SIZE;
+		if (STREAM_READABLE(work) < want)
+			goto read_more;
+
+		/* Fetch header values. */
+		start = stream_get_getp(work);
+		length = stream_getw(work);
+		marker = stream_getc(work);
+		version = stream_getc(work);
+		vrf_id = stream_getl(work);
+		command = stream_getw(work);
+		stream_set_getp(work, start);
+
+		if (marker != ZEBRA_HEADER_MARKER || version != ZSERV_VERSION) {
+			flog_err(
+				EC_LIB_ZAPI_MISSMATCH,
+				"%s: socket %d version mismatch, marker %d, version %d",
+				__func__, zclient->sock, marker, version);
 			zclient_failed(zclient);
 			return;
 		}
-		if (nbyte != (ssize_t)(ZEBRA_HEADER_SIZE - already)) {
-			zclient_event(ZCLIENT_READ, zclient);
+
+		if (length < ZEBRA_HEADER_SIZE) {
+			flog_err(EC_LIB_ZAPI_MISSMATCH,
+				 "%s: socket %d message length %u is less than %d ",
+				 __func__, zclient->sock, length,
+				 ZEBRA_HEADER_SIZE);
+			zclient_failed(zclient);
 			return;
 		}
-		already = ZEBRA_HEADER_SIZE;
-	}
 
-	/* Reset to read from the beginning of the incoming packet. */
-	stream_set_getp(zclient->ibuf, 0);
+		/* Length check. */
+		if (length > STREAM_SIZE(work)) {
+			struct stream *ns;
+			flog_err(
+				EC_LIB_ZAPI_ENCODE,
+				"%s: message size %u exceeds buffer size %lu, expanding...",
+				__func__, length,
+				(unsigned long)STREAM_SIZE(work));
+			stream_pulldown(work);
+			ns = stream_new(length);
+			stream_copy(ns, work);
+			stream_free(work);
+			zclient->ibuf_work = work = ns;
+		}
 
-	/* Fetch header values. */
-	length = stream_getw(zclient->ibuf);
-	marker = stream_getc(zclient->ibuf);
-	version = stream_getc(zclient->ibuf);
-	vrf_id = stream_getl(zclient->ibuf);
-	command = stream_getw(zclient->ibuf);
+		/* Read rest of zebra packet. */
+		want = length;
+		if (STREAM_READABLE(work) < want)
+			goto read_more;
 
-	if (marker != ZEBRA_HEADER_MARKER || version != ZSERV_VERSION) {
-		flog_err(
-			EC_LIB_ZAPI_MISSMATCH,
-			"%s: socket %d version mismatch, marker %d, version %d",
-			__func__, zclient->sock, marker, version);
-		zclient_failed(zclient);
-		return;
-	}
+		/*
+		 * Hand the message to the handlers in a stream of its own.
+		 * When it is all that was read, as is usual outside of
+		 * bursts, the buffers are swapped instead of copied.
+		 */
+		if (stream_get_getp(work) == 0
+		    && STREAM_READABLE(work) == length
+		    && STREAM_SIZE(zclient->ibuf) >= ZEBRA_MAX_PACKET_SIZ) {
+			zclient->ibuf_work = zclient->ibuf;
+			zclient->ibuf = work;
+			stream_reset(zclient->ibuf_work);
+		} else {
+			if (length > STREAM_SIZE(zclient->ibuf)) {
+				stream_free(zclient->ibuf);
+				zclient->ibuf = stream_new(length);
+			}
+			stream_reset(zclient->ibuf);
+			stream_put(zclient->ibuf, stream_pnt(work), length);
+			stream_forward_getp(work, length);
+		}
+		stream_set_getp(zclient->ibuf, ZEBRA_HEADER_SIZE);
 
-	if (length < ZEBRA_HEADER_SIZE) {
-		flog_err(EC_LIB_ZAPI_MISSMATCH,
-			 "%s: socket %d message length %u is less than %d ",
-			 __func__, zclient->sock, length, ZEBRA_HEADER_SIZE);
-		zclient_failed(zclient);
-		return;
-	}
+		length -= ZEBRA_HEADER_SIZE;
 
-	/* Length check. */
-	if (length > STREAM_SIZE(zclient->ibuf)) {
-		struct stream *ns;
-		flog_err(
-			EC_LIB_ZAPI_ENCODE,
-			"%s: message size %u exceeds buffer size %lu, expanding...",
-			__func__, length,
-			(unsigned long)STREAM_SIZE(zclient->ibuf));
-		ns = stream_new(length);
-		stream_copy(ns, zclient->ibuf);
-		stream_free(zclient->ibuf);
-		zclient->ibuf = ns;
-	}
+		if (zclient_debug)
+			zlog_debug("zclient %p command %s VRF %u", zclient,
+				   zserv_command_string(command), vrf_id);
+
+		if (command < array_size(lib_handlers)
+		    && lib_handlers[command])
+			lib_handlers[command](command, zclient, length, vrf_id);
+		if (command < zclient->n_handlers
+		    && zclient->handlers[command])
+			zclient->handlers[command](command, zclient, length,
+						   vrf_id);
+
+		if (zclient->sock < 0)
+			/* Connection was closed during packet processing. */
+			return;
+
+		count++;
+		continue;
 
-	/* Read rest of zebra packet. */
-	if (already < length) {
-		ssize_t nbyte;
-		if (((nbyte = stream_read_try(zclient->ibuf, zclient->sock,
-					      length - already))
-		     == 0)
-		    || (nbyte == -1)) {
+	read_more:
+		/*
+		 * Read as much as is available, so a burst of messages is
+		 * handled in one go.  Synchronous clients also read replies
+		 * straight from the socket, don't read ahead for those.
+		 */
+		stream_pulldown(work);
+		nbyte = stream_read_try(work, zclient->sock,
+					zclient->synchronous
+						? want - STREAM_READABLE(work)
+						: STREAM_WRITEABLE(work));
+		if (nbyte == -2)
+			/* Try again later. */
+			break;
+		if (nbyte == 0 || nbyte == -1) {
 			if (zclient_debug)
 				zlog_debug(
 					"zclient connection closed socket [%d].",
@@ -4100,31 +4549,16 @@ static void zclient_read(struct thread *thread)
 			zclient_failed(zclient);
 			return;
 		}
-		if (nbyte != (ssize_t)(length - already)) {
-			/* Try again later. */
-			zclient_event(ZCLIENT_READ, zclient);
-			return;
-		}
 	}
 
-	length -= ZEBRA_HEADER_SIZE;
-
-	if (zclient_debug)
-		zlog_debug("zclient %p command %s VRF %u", zclient,
-			   zserv_command_string(command), vrf_id);
-
-	if (command < array_size(lib_handlers) && lib_handlers[command])
-		lib_handlers[command](command, zclient, length, vrf_id);
-	if (command < zclient->n_handlers && zclient->handlers[command])
-		zclient->handlers[command](command, zclient, length, vrf_id);
-
-	if (zclient->sock < 0)
-		/* Connection was closed during packet processing. */
-		return;
-
 	/* Register read thread. */
-	stream_reset(zclient->ibuf);
-	zclient_event(ZCLIENT_READ, zclient);
+	if (count == ZCLIENT_READ_MAX
+	    && STREAM_READABLE(zclient->ibuf_work))
+		/* the socket won't signal what was read already */
+		thread_add_event(zclient->master, zclient_read, zclient, 0,
+				 &zclient->t_read);
+	else
+		zclient_event(ZCLIENT_READ, zclient);
 }
 
 void zclient_redistribute(int command, struct zclient *zclient, afi_t afi,
@@ -249,6 +249,9 @@ typedef enum {
 	ZEBRA_TC_CLASS_DELETE,
 	ZEBRA_TC_FILTER_ADD,
 	ZEBRA_TC_FILTER_DELETE,
+	ZEBRA_ROUTE_ADD_BULK,
+	ZEBRA_NHG_MEMBER_ADD,
+	ZEBRA_NHG_MEMBER_DEL,
 } zebra_message_types_t;
 
 enum zebra_error_types {
@@ -285,6 +288,10 @@ struct zclient_capabilities {
 	uint32_t ecmp;
 	bool mpls_enabled;
 	enum mlag_role role;
+	/* zebra accepts ZEBRA_ROUTE_ADD_BULK */
+	bool route_bulk;
+	/* zebra accepts ZEBRA_NHG_MEMBER_ADD/DEL */
+	bool nhg_members;
 };
 
 /* Graceful Restart Capabilities message */
@@ -332,6 +339,8 @@ struct zclient {
 
 	/* Input buffer for zebra message. */
 	struct stream *ibuf;
+	/* Data read from the socket, not yet handed out through ibuf */
+	struct stream *ibuf_work;
 
 	/* Output buffer for zebra message. */
 	struct stream *obuf;
@@ -346,6 +355,27 @@ struct zclient {
 	/* Thread to write buffered data to zebra. */
 	struct thread *t_write;
 
+	/* Nesting depth of zclient_batch_start().  While non-zero, messages
+	 * are only queued on wb and written out by zclient_batch_end().
+	 */
+	unsigned int batch;
+
+	/* Set from ZEBRA_CAPABILITIES when zebra accepts
+	 * ZEBRA_ROUTE_ADD_BULK.  Route adds sent inside a batch are then
+	 * merged into bulk messages while their encoding only differs in
+	 * the prefix.
+	 */
+	bool route_bulk;
+	struct stream *bulk;
+	size_t bulk_rest; /* offset just after the leading route's prefix */
+	size_t bulk_cnt;  /* offset of the count of further prefixes */
+	uint16_t bulk_num;
+
+	/* bulk holds consecutive PBR messages merged into one, see
+	 * zclient_pbr_bulk_add(); bulk_num is then their total count.
+	 */
+	bool bulk_pbr;
+
 	/* Redistribute information. */
 	uint8_t redist_default; /* clients protocol */
 	unsigned short instance;
@@ -602,6 +632,44 @@ struct zapi_route {
 
 extern char *zclient_dump_route_flags(uint32_t flags, char *buf, size_t len);
 
+/*
+ * Route message decoded without its nexthops, for handlers that don't need
+ * a struct zapi_route (which is tens of KB with its nexthop arrays).  The
+ * nexthops are decoded one at a time from the stream, in order, with
+ * zapi_route_view_nexthop() and zapi_route_view_backup_nexthop().
+ *
+ * The view points into the stream it was decoded from (zclient->ibuf), it
+ * is only valid inside the handler.
+ */
+struct zapi_route_view {
+	uint8_t type;
+	unsigned short instance;
+	uint32_t flags;
+	uint32_t message;
+	safi_t safi;
+
+	struct prefix prefix;
+	struct prefix_ipv6 src_prefix;
+
+	uint16_t nexthop_num;
+	uint16_t backup_nexthop_num;
+
+	uint32_t nhgid;
+	uint8_t distance;
+	uint32_t metric;
+	route_tag_t tag;
+	uint32_t mtu;
+	uint32_t tableid;
+
+	uint16_t opaque_len;
+	const uint8_t *opaque;
+
+	/* Private, where the next nexthops are */
+	struct stream *s;
+	size_t nh_pos, backup_pos;
+	uint16_t nh_next, backup_next;
+};
+
 struct zapi_labels {
 	uint8_t message;
 #define ZAPI_LABELS_FTN           0x01
@@ -965,6 +1033,13 @@ extern void zclient_redistribute_default(int command, struct zclient *,
  */
 extern enum zclient_send_status zclient_send_message(struct zclient *);
 
+/*
+ * Coalesce the messages sent between zclient_batch_start() and
+ * zclient_batch_end() into as few socket writes as possible.  Calls nest.
+ */
+extern void zclient_batch_start(struct zclient *zclient);
+extern enum zclient_send_status zclient_batch_end(struct zclient *zclient);
+
 /* create header for command, length to be filled in by user later */
 extern void zclient_create_header(struct stream *, uint16_t, vrf_id_t);
 /*
@@ -1097,6 +1172,24 @@ int zapi_nexthop_encode(struct stream *s, const struct zapi_nexthop *api_nh,
 			uint32_t api_flags, uint32_t api_message);
 extern int zapi_route_encode(uint8_t, struct stream *, struct zapi_route *);
 extern int zapi_route_decode(struct stream *s, struct zapi_route *api);
+extern int zapi_route_view_decode(struct stream *s,
+				  struct zapi_route_view *view);
+/* false once all of them were returned */
+extern bool zapi_route_view_nexthop(struct zapi_route_view *view,
+				    struct zapi_nexthop *api_nh);
+extern bool zapi_route_view_backup_nexthop(struct zapi_route_view *view,
+					   struct zapi_nexthop *api_nh);
+/*
+ * ZEBRA_ROUTE_ADD_BULK carries one route encoded as for ZEBRA_ROUTE_ADD,
+ * followed by a 16-bit count and that many further prefixes (length and
+ * address bytes, same family) sharing all the other route information.
+ * After zapi_route_decode(), this decodes those prefixes into an array
+ * of ZAPI_ROUTE_BULK_MAX entries.
+ */
+#define ZAPI_ROUTE_BULK_MAX 1024
+extern int zapi_route_bulk_decode(struct stream *s,
+				  const struct zapi_route *api,
+				  struct prefix *prefixes, uint16_t *count);
 extern int zapi_nexthop_decode(struct stream *s, struct zapi_nexthop *api_nh,
 			       uint32_t api_flags, uint32_t api_message);
 bool zapi_nhg_notify_decode(struct stream *s, uint32_t *id,
@@ -1112,7 +1205,13 @@ bool zapi_ipset_notify_decode(struct stream *s,
 			      uint32_t *unique,
 			     enum zapi_ipset_notify_owner *note);
 
-/* Nexthop-group message apis */
+/* Nexthop-group message apis
+ *
+ * ZEBRA_NHG_MEMBER_ADD and ZEBRA_NHG_MEMBER_DEL add or remove the nexthops
+ * in api_nhg to or from the existing group api_nhg->id, which is replaced
+ * in the dataplane without touching the routes using it.  Only sent to
+ * a zebra with zclient_capabilities.nhg_members.
+ */
 extern enum zclient_send_status
 zclient_nhg_send(struct zclient *zclient, int cmd, struct zapi_nhg *api_nhg);
 
@@ -1132,6 +1231,8 @@ int zapi_nexthop_from_nexthop(struct zapi_nexthop *znh,
 			      const struct nexthop *nh);
 int zapi_backup_nexthop_from_nexthop(struct zapi_nexthop *znh,
 				     const struct nexthop *nh);
+/* Order of nexthops in ZAPI routes, usable with qsort() */
+extern int zapi_nexthop_cmp(const void *item1, const void *item2);
 /*
  * match -> is the prefix that the calling daemon asked to be matched
  * against.
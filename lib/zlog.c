@@ -89,6 +89,10 @@ static gid_t zlog_gid = -1;
 DECLARE_ATOMLIST(zlog_targets, struct zlog_target, head);
 static struct zlog_targets_head zlog_targets;
 
+/* nothing is filtered until the first target is installed */
+atomic_int zlog_prio_max = LOG_DEBUG;
+static pthread_mutex_t zlog_prio_mtx = PTHREAD_MUTEX_INITIALIZER;
+
 /* Global setting for buffered vs immediate output. The default is
  * per-pthread buffering.
  */
@@ -629,6 +633,9 @@ void vzlogx(const struct xref_logmsg *xref, int prio,
 	XFREE(MTYPE_LOG_MESSAGE, msg);
 #endif
 
+	if (!zlog_prio_enabled(prio))
+		return;
+
 	if (zlog_tls)
 		vzlog_tls(zlog_tls, xref, prio, fmt, ap);
 	else
@@ -950,13 +957,31 @@ struct zlog_target *zlog_target_clone(struct memtype *mt,
 	return newzt;
 }
 
+static void zlog_prio_max_update(void)
+{
+	struct zlog_target *zt;
+	int prio_max = ZLOG_DISABLED;
+
+	rcu_read_lock();
+	frr_each (zlog_targets, &zlog_targets, zt)
+		if (zt->prio_min > prio_max)
+			prio_max = zt->prio_min;
+	rcu_read_unlock();
+
+	atomic_store_explicit(&zlog_prio_max, prio_max, memory_order_relaxed);
+}
+
 struct zlog_target *zlog_target_replace(struct zlog_target *oldzt,
 					struct zlog_target *newzt)
 {
+	/* serialized so a stale maximum can't be stored last */
+	pthread_mutex_lock(&zlog_prio_mtx);
 	if (newzt)
 		zlog_targets_add_tail(&zlog_targets, newzt);
 	if (oldzt)
 		zlog_targets_del(&zlog_targets, oldzt);
+	zlog_prio_max_update();
+	pthread_mutex_unlock(&zlog_prio_mtx);
 	return oldzt;
 }
 
@@ -75,6 +75,23 @@ extern void vzlogx(const struct xref_logmsg *xref, int prio,
 		   const char *fmt, va_list ap);
 #define vzlog(prio, ...) vzlogx(NULL, prio, __VA_ARGS__)
 
+/* least severe priority accepted by any log target, updated whenever a
+ * target is added or replaced.  Messages above it are dropped before any
+ * work is done on them.
+ */
+extern atomic_int zlog_prio_max;
+
+static inline bool zlog_prio_enabled(int prio)
+{
+#ifdef HAVE_LTTNG
+	/* all messages go to the trace buffer as well */
+	return true;
+#else
+	return (prio & LOG_PRIMASK)
+	       <= atomic_load_explicit(&zlog_prio_max, memory_order_relaxed);
+#endif
+}
+
 PRINTFRR(2, 3)
 static inline void zlog(int prio, const char *fmt, ...)
 {
@@ -91,6 +108,9 @@ static inline void zlog_ref(const struct xref_logmsg *xref,
 {
 	va_list ap;
 
+	if (!zlog_prio_enabled(xref->priority))
+		return;
+
 	va_start(ap, fmt);
 	vzlogx(xref, xref->priority, fmt, ap);
 	va_end(ap);
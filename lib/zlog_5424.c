@@ -38,12 +38,23 @@
 #include "command.h"
 #include "monotime.h"
 #include "thread.h"
+#include "network.h"
+#include "jhash.h"
+#include "atomlist.h"
 
 #include "lib/version.h"
 #include "lib/lib_errors.h"
 
 DEFINE_MTYPE_STATIC(LOG, LOG_5424, "extended log target");
 DEFINE_MTYPE_STATIC(LOG, LOG_5424_ROTATE, "extended log rotate helper");
+DEFINE_MTYPE_STATIC(LOG, LOG_5424_WRITER, "extended log async writer");
+DEFINE_MTYPE_STATIC(LOG, LOG_5424_REC, "extended log queued message");
+
+/* rate limiting state, one slot per hash of the xref: upper 32 bits are the
+ * second (from the message timestamp), lower 32 bits the message count in
+ * that second.  Call sites hashing to the same slot share their budget.
+ */
+#define ZLOG_5424_RL_SLOTS 256
 
 /* the actual log target data structure
  *
@@ -93,10 +104,54 @@ struct zlt_5424 {
 	atomic_size_t lost_msgs;
 	struct timeval last_err_ts;
 
+	/* NULL unless async; owned by the config & outlives this target */
+	struct zlog_5424_writer *writer;
+
+	uint32_t rate_limit;
+	atomic_size_t ratelimit_msgs;
+	atomic_uint_fast64_t rl_slots[ZLOG_5424_RL_SLOTS];
+
 	struct rcu_head_close head_close;
 };
 
+/* asynchronous writer
+ *
+ * Messages are fully formatted by the logging thread into a zlog_5424_rec
+ * and put on a lock-free queue; the writer pthread does the actual, possibly
+ * blocking, writev()/sendmsg().  "count" includes messages being added by
+ * a logging thread, the one that raises it from 0 wakes up the writer
+ * through the pipe.
+ */
+PREDECL_ATOMLIST(zlog_5424_recs);
+
+struct zlog_5424_rec {
+	struct zlog_5424_recs_item item;
+
+	size_t len;
+	char text[];
+};
+
+DECLARE_ATOMLIST(zlog_5424_recs, struct zlog_5424_rec, item);
+
+struct zlog_5424_writer {
+	struct zlog_cfg_5424 *zcf;
+	struct frr_pthread *fpt;
+	struct thread *t_wake, *t_retry;
+	int wake[2];
+
+	struct zlog_5424_recs_head recs;
+	atomic_size_t count;
+	atomic_size_t dropped;
+	_Atomic uint32_t queue_max;
+
+	struct rcu_head rcu_head;
+};
+
+/* records handed to the kernel in one go */
+#define ZLOG_5424_WRITER_BATCH 64
+
 static int zlog_5424_open(struct zlog_cfg_5424 *zcf, int sock_type);
+static void zlog_5424_enqueue(struct zlt_5424 *zte, struct zlog_msg *msg);
 
 /* rough header length estimate
  * ============================
@@ -425,6 +480,41 @@ static void zlog_5424_err(struct zlt_5424 *zte, size_t count)
 	monotime(&zte->last_err_ts);
 }
 
+static bool zlog_5424_ratelimited(struct zlt_5424 *zte,
+				  struct zlog_msg *msg)
+{
+	const struct xref_logmsg *xref;
+	atomic_uint_fast64_t *slot;
+	uint_fast64_t cur, next;
+	struct timespec ts;
+
+	if (!zte->rate_limit)
+		return false;
+
+	xref = zlog_msg_xref(msg);
+	if (!xref)
+		return false;
+
+	zlog_msg_tsraw(msg, &ts);
+	slot = &zte->rl_slots[jhash(&xref, sizeof(xref), 0) %
+			      ZLOG_5424_RL_SLOTS];
+
+	cur = atomic_load_explicit(slot, memory_order_relaxed);
+	do {
+		if ((cur >> 32) != (uint32_t)ts.tv_sec)
+			next = ((uint_fast64_t)(uint32_t)ts.tv_sec << 32) | 1;
+		else if ((cur & 0xffffffff) >= zte->rate_limit) {
+			atomic_fetch_add_explicit(&zte->ratelimit_msgs, 1,
+						  memory_order_relaxed);
+			return true;
+		} else
+			next = cur + 1;
+	} while (!atomic_compare_exchange_weak_explicit(
+		slot, &cur, next, memory_order_relaxed, memory_order_relaxed));
+
+	return false;
+}
+
 static void zlog_5424(struct zlog_target *zt, struct zlog_msg *msgs[],
 		      size_t nmsgs)
 {
@@ -449,6 +539,14 @@ static void zlog_5424(struct zlog_target *zt, struct zlog_msg *msgs[],
 		.iov = iov,
 	};
 
+	if (zte->writer) {
+		for (i = 0; i < nmsgs; i++)
+			if (zlog_msg_prio(msgs[i]) <= zte->zt.prio_min &&
+			    !zlog_5424_ratelimited(zte, msgs[i]))
+				zlog_5424_enqueue(zte, msgs[i]);
+		return;
+	}
+
 	fd = atomic_load_explicit(&zte->fd, memory_order_relaxed);
 
 	memset(mmsg, 0, sizeof(mmsg));
@@ -464,7 +562,8 @@ static void zlog_5424(struct zlog_target *zt, struct zlog_msg *msgs[],
 		int prio = zlog_msg_prio(msgs[i]);
 		size_t need = 0;
 
-		if (prio <= zte->zt.prio_min) {
+		if (prio <= zte->zt.prio_min &&
+		    !zlog_5424_ratelimited(zte, msgs[i])) {
 			if (zte->packets)
 				mpos->msg_hdr.msg_iov = state.iov;
 
@@ -706,6 +805,251 @@ static void zlog_5424_sigsafe(struct zlog_target *zt, const char *text,
 	}
 }
 
+/* asynchronous writer */
+
+static void zlog_5424_rec_add(struct zlog_5424_writer *zw,
+			      const struct iovec *iov,
+			      const struct iovec *iov_end, bool wake)
+{
+	struct zlog_5424_rec *rec;
+	const struct iovec *iovp;
+	size_t len = 0;
+	char *pos;
+
+	for (iovp = iov; iovp < iov_end; iovp++)
+		len += iovp->iov_len;
+
+	rec = XMALLOC(MTYPE_LOG_5424_REC, sizeof(*rec) + len);
+	rec->len = len;
+	pos = rec->text;
+	for (iovp = iov; iovp < iov_end; iovp++) {
+		memcpy(pos, iovp->iov_base, iovp->iov_len);
+		pos += iovp->iov_len;
+	}
+
+	zlog_5424_recs_add_tail(&zw->recs, rec);
+
+	if (wake) {
+		static const char wakebyte = 0;
+
+		/* pipe full => the writer has a wakeup pending anyway */
+		if (write(zw->wake[1], &wakebyte, 1) < 0)
+			return;
+	}
+}
+
+/* runs in the logging thread;  this must not block or take any locks */
+static void zlog_5424_enqueue(struct zlt_5424 *zte, struct zlog_msg *msg)
+{
+	struct zlog_5424_writer *zw = zte->writer;
+	struct iovec iov[IOV_PER_MSG];
+	size_t prev, need, low_space;
+	char hdr_buf[zlog_5424_bufsz(zte, 1, &low_space)];
+	struct fbuf hdr_pos = {
+		.buf = hdr_buf,
+		.pos = hdr_buf,
+		.len = sizeof(hdr_buf),
+	};
+	struct state state = {
+		.fbuf = &hdr_pos,
+		.iov = iov,
+	};
+
+	/* reserve a slot first so the queue can't overshoot queue_max */
+	prev = atomic_fetch_add_explicit(&zw->count, 1, memory_order_relaxed);
+	if (prev >= atomic_load_explicit(&zw->queue_max,
+					 memory_order_relaxed)) {
+		atomic_fetch_sub_explicit(&zw->count, 1, memory_order_relaxed);
+		atomic_fetch_add_explicit(&zw->dropped, 1,
+					  memory_order_relaxed);
+		return;
+	}
+
+	need = zlog_one(zte, msg, &state);
+	if (need == 0) {
+		zlog_5424_rec_add(zw, iov, state.iov, prev == 0);
+		return;
+	}
+
+	/* same as in zlog_5424(), the record is a copy anyway */
+	char buf2[need];
+	struct fbuf fbuf2 = {
+		.buf = buf2,
+		.pos = buf2,
+		.len = sizeof(buf2),
+	};
+
+	state.fbuf = &fbuf2;
+	state.iov = iov;
+	need = zlog_one(zte, msg, &state);
+	assert(need == 0);
+
+	zlog_5424_rec_add(zw, iov, state.iov, prev == 0);
+}
+
+/* write out (at most) one batch of queued messages, returns the number of
+ * records taken off the queue.  Writer pthread or zlog_5424_writer_stop().
+ */
+static size_t zlog_5424_writer_flush(struct zlog_5424_writer *zw)
+{
+	struct zlog_5424_rec *recs[ZLOG_5424_WRITER_BATCH];
+	struct iovec iov[ZLOG_5424_WRITER_BATCH];
+	struct zlt_5424 *zte;
+	struct msghdr mh = {};
+	size_t i, n = 0;
+	ssize_t ret;
+	int fd;
+
+	while (n < array_size(recs) && n < IOV_MAX &&
+	       (recs[n] = zlog_5424_recs_pop(&zw->recs))) {
+		iov[n].iov_base = recs[n]->text;
+		iov[n].iov_len = recs[n]->len;
+		n++;
+	}
+	if (!n)
+		return 0;
+
+	/* the target's fd is rcu_close()d, so it remains valid as long as we
+	 * hold the RCU read lock.  All records were formatted for the same
+	 * destination;  metadata changes only affect messages yet to come.
+	 */
+	rcu_read_lock();
+	frr_with_mutex (&zw->zcf->cfg_mtx) {
+		zte = zw->zcf->active;
+	}
+
+	if (!zte) {
+		atomic_fetch_add_explicit(&zw->dropped, n,
+					  memory_order_relaxed);
+	} else {
+		fd = atomic_load_explicit(&zte->fd, memory_order_relaxed);
+
+		if (zte->sa_len) {
+			mh.msg_name = (struct sockaddr *)&zte->sa;
+			mh.msg_namelen = zte->sa_len;
+		}
+
+		if (zte->packets) {
+			size_t errs = 0;
+
+			for (i = 0; i < n; i++) {
+				mh.msg_iov = &iov[i];
+				mh.msg_iovlen = 1;
+				if (sendmsg(fd, &mh, 0) < 0)
+					errs++;
+			}
+			zlog_5424_err(zte, errs);
+		} else {
+			if (!zte->sa_len)
+				ret = writev(fd, iov, n);
+			else {
+				mh.msg_iov = iov;
+				mh.msg_iovlen = n;
+				ret = sendmsg(fd, &mh, 0);
+			}
+			zlog_5424_err(zte, ret < 0 ? n : 0);
+		}
+	}
+	rcu_read_unlock();
+
+	for (i = 0; i < n; i++)
+		XFREE(MTYPE_LOG_5424_REC, recs[i]);
+	atomic_fetch_sub_explicit(&zw->count, n, memory_order_relaxed);
+	return n;
+}
+
+static void zlog_5424_writer_retry(struct thread *t)
+{
+	struct zlog_5424_writer *zw = THREAD_ARG(t);
+
+	while (zlog_5424_writer_flush(zw))
+		;
+
+	/* a logging thread may have reserved a slot but not yet queued its
+	 * message;  it won't poke the pipe since count was nonzero.
+	 */
+	if (atomic_load_explicit(&zw->count, memory_order_relaxed))
+		thread_add_timer_msec(t->master, zlog_5424_writer_retry, zw, 1,
+				      &zw->t_retry);
+}
+
+static void zlog_5424_writer_run(struct thread *t)
+{
+	struct zlog_5424_writer *zw = THREAD_ARG(t);
+	char dummy[64];
+
+	while (read(zw->wake[0], dummy, sizeof(dummy)) > 0)
+		;
+
+	zlog_5424_writer_retry(t);
+
+	thread_add_read(t->master, zlog_5424_writer_run, zw, zw->wake[0],
+			&zw->t_wake);
+}
+
+static void zlog_5424_writer_free(struct zlog_5424_writer *zw)
+{
+	struct zlog_5424_rec *rec;
+
+	/* logging threads that were still on the old target */
+	while ((rec = zlog_5424_recs_pop(&zw->recs)))
+		XFREE(MTYPE_LOG_5424_REC, rec);
+
+	close(zw->wake[0]);
+	close(zw->wake[1]);
+	XFREE(MTYPE_LOG_5424_WRITER, zw);
+}
+
+static void zlog_5424_writer_start(struct zlog_cfg_5424 *zcf)
+{
+	struct zlog_5424_writer *zw;
+
+	zw = XCALLOC(MTYPE_LOG_5424_WRITER, sizeof(*zw));
+	zw->zcf = zcf;
+	zlog_5424_recs_init(&zw->recs);
+
+	if (pipe(zw->wake) < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "extended log async writer pipe(): %m");
+		XFREE(MTYPE_LOG_5424_WRITER, zw);
+		return;
+	}
+	set_nonblocking(zw->wake[0]);
+	set_nonblocking(zw->wake[1]);
+
+	zw->fpt = frr_pthread_new(NULL, "extlog writer", "extlog");
+	if (frr_pthread_run(zw->fpt, NULL) < 0) {
+		frr_pthread_destroy(zw->fpt);
+		close(zw->wake[0]);
+		close(zw->wake[1]);
+		XFREE(MTYPE_LOG_5424_WRITER, zw);
+		return;
+	}
+	frr_pthread_wait_running(zw->fpt);
+
+	thread_add_read(zw->fpt->master, zlog_5424_writer_run, zw, zw->wake[0],
+			&zw->t_wake);
+	zcf->writer = zw;
+}
+
+/* the active target must no longer reference the writer at this point */
+static void zlog_5424_writer_stop(struct zlog_cfg_5424 *zcf)
+{
+	struct zlog_5424_writer *zw = zcf->writer;
+
+	zcf->writer = NULL;
+
+	frr_pthread_stop(zw->fpt, NULL);
+	frr_pthread_destroy(zw->fpt);
+	zw->fpt = NULL;
+
+	/* anything still queued goes out synchronously */
+	while (zlog_5424_writer_flush(zw))
+		;
+
+	rcu_call(zlog_5424_writer_free, zw, rcu_head);
+}
+
 /* housekeeping & configuration */
 
 void zlog_5424_init(struct zlog_cfg_5424 *zcf)
@@ -722,8 +1066,19 @@ static void zlog_5424_target_free(struct zlt_5424 *zlt)
 	rcu_free(MTYPE_LOG_5424, zlt, zt.rcu_head);
 }
 
+static void zlog_5424_cycle(struct zlog_cfg_5424 *zcf, int fd);
+
 void zlog_5424_fini(struct zlog_cfg_5424 *zcf, bool keepopen)
 {
+	if (zcf->writer) {
+		zcf->async = false;
+		frr_with_mutex (&zcf->cfg_mtx) {
+			if (zcf->active)
+				zlog_5424_cycle(zcf, zcf->active->fd);
+		}
+		zlog_5424_writer_stop(zcf);
+	}
+
 	if (keepopen)
 		zcf->active = NULL;
 
@@ -771,6 +1126,16 @@ static void zlog_5424_cycle(struct zlog_cfg_5424 *zcf, int fd)
 		zlt->zt.prio_min = zcf->prio_min;
 		zlt->zt.logfn = zlog_5424;
 		zlt->zt.logfn_sigsafe = zlog_5424_sigsafe;
+		zlt->rate_limit = zcf->rate_limit;
+
+		if (zcf->async && !zcf->writer)
+			zlog_5424_writer_start(zcf);
+		if (zcf->async && zcf->writer) {
+			zlt->writer = zcf->writer;
+			atomic_store_explicit(&zlt->writer->queue_max,
+					      zcf->queue_max,
+					      memory_order_relaxed);
+		}
 
 		switch (zcf->fmt) {
 		case ZLOG_FMT_5424:
@@ -1071,6 +1436,9 @@ bool zlog_5424_apply_dst(struct zlog_cfg_5424 *zcf)
 	frr_with_mutex (&zcf->cfg_mtx) {
 		zlog_5424_cycle(zcf, fd);
 	}
+
+	if (zcf->writer && (!zcf->async || fd == -1))
+		zlog_5424_writer_stop(zcf);
 	return fd != -1;
 }
 
@@ -1082,6 +1450,8 @@ bool zlog_5424_apply_meta(struct zlog_cfg_5424 *zcf)
 			zlog_5424_cycle(zcf, zcf->active->fd);
 	}
 
+	if (zcf->writer && (!zcf->async || !zcf->active))
+		zlog_5424_writer_stop(zcf);
 	return true;
 }
 
@@ -1102,6 +1472,26 @@ void zlog_5424_state(struct zlog_cfg_5424 *zcf, size_t *lost_msgs,
 		*err_ts = zcf->active->last_err_ts;
 }
 
+void zlog_5424_drops(struct zlog_cfg_5424 *zcf, size_t *ratelimited,
+		     size_t *dropped, size_t *queued)
+{
+	struct zlog_5424_writer *zw = zcf->writer;
+	struct zlt_5424 *zte = zcf->active;
+
+	if (ratelimited)
+		*ratelimited = zte ? atomic_load_explicit(&zte->ratelimit_msgs,
+							  memory_order_relaxed)
+				   : 0;
+	if (dropped)
+		*dropped = zw ? atomic_load_explicit(&zw->dropped,
+						     memory_order_relaxed)
+			      : 0;
+	if (queued)
+		*queued = zw ? atomic_load_explicit(&zw->count,
+						    memory_order_relaxed)
+			     : 0;
+}
+
 struct rcu_close_rotate {
 	struct rcu_head_close head_close;
 	struct rcu_head head_self;
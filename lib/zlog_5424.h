@@ -26,6 +26,7 @@
 
 struct thread;
 struct thread_master;
+struct zlog_5424_writer;
 
 enum zlog_5424_dst {
 	/* can be used to disable a target temporarily */
@@ -84,6 +85,16 @@ struct zlog_cfg_5424 {
 	uid_t file_uid;
 	gid_t file_gid;
 
+	/* hand messages to a dedicated writer pthread instead of writing them
+	 * from the logging thread.  At most queue_max messages are pending,
+	 * more are dropped.
+	 */
+	bool async;
+	uint32_t queue_max;
+
+	/* max messages per second per log call site (xref), 0 = no limit */
+	uint32_t rate_limit;
+
 	/* remaining fields are internally used & updated by the 5424
 	 * code - *not* config.  don't set these.
 	 */
@@ -95,6 +106,9 @@ struct zlog_cfg_5424 {
 	int sock_type;
 	struct sockaddr_storage sa;
 	socklen_t sa_len;
+
+	/* async only - the writer pthread & its queue */
+	struct zlog_5424_writer *writer;
 };
 
 /* these don't do malloc/free to allow using a static global */
@@ -119,6 +133,12 @@ extern void zlog_5424_state(struct zlog_cfg_5424 *zcf, size_t *lost_msgs,
 			    int *last_errno, bool *stale_errno,
 			    struct timeval *err_ts);
 
+/* messages dropped by rate limiting, dropped by the async writer (queue
+ * full or no destination) and currently queued for the async writer
+ */
+extern void zlog_5424_drops(struct zlog_cfg_5424 *zcf, size_t *ratelimited,
+			    size_t *dropped, size_t *queued);
+
 /* this is the dynamically allocated "variant" */
 PREDECL_RBTREE_UNIQ(targets);
 
@@ -64,6 +64,7 @@ static struct log_option log_opts[] = {
 #define DFLT_TS_FLAGS		(6 | ZLOG_TS_UTC)
 #define DFLT_FACILITY		LOG_DAEMON
 #define DFLT_PRIO_MIN		LOG_DEBUG
+#define DFLT_QUEUE_MAX		4096
 /* clang-format on */
 
 enum unix_special {
@@ -85,6 +86,7 @@ static struct zlog_cfg_5424_user *log_5424_alloc(const char *name)
 	cfg->cfg.facility = DFLT_FACILITY;
 	cfg->cfg.prio_min = DFLT_PRIO_MIN;
 	cfg->cfg.ts_flags = DFLT_TS_FLAGS;
+	cfg->cfg.queue_max = DFLT_QUEUE_MAX;
 	clear_dst(cfg);
 
 	for (struct log_option *opt = log_opts; opt->name; opt++) {
@@ -662,6 +664,43 @@ DEFPY(log_5424_ts_local,
 	return reconf_meta(cfg, vty);
 }
 
+DEFPY(log_5424_async,
+      log_5424_async_cmd,
+      "[no] writer async [queue-size (16-1048576)$queue_size]",
+      NO_STR
+      "Message writing options\n"
+      "Write messages from a separate thread, never blocking the daemon\n"
+      "Maximum number of queued messages, more are dropped\n"
+      "Maximum number of queued messages, more are dropped\n")
+{
+	VTY_DECLVAR_CONTEXT(zlog_cfg_5424_user, cfg);
+	uint32_t queue_max = queue_size_str ? queue_size : DFLT_QUEUE_MAX;
+
+	if (cfg->cfg.async == !no && cfg->cfg.queue_max == queue_max)
+		return CMD_SUCCESS;
+
+	cfg->cfg.async = !no;
+	cfg->cfg.queue_max = queue_max;
+	return reconf_meta(cfg, vty);
+}
+
+DEFPY(log_5424_rate_limit,
+      log_5424_rate_limit_cmd,
+      "[no] rate-limit (1-1000000)$rate",
+      NO_STR
+      "Limit the number of messages written per log call site\n"
+      "Messages per second for each call site\n")
+{
+	VTY_DECLVAR_CONTEXT(zlog_cfg_5424_user, cfg);
+	uint32_t rate_limit = no ? 0 : rate;
+
+	if (cfg->cfg.rate_limit == rate_limit)
+		return CMD_SUCCESS;
+
+	cfg->cfg.rate_limit = rate_limit;
+	return reconf_meta(cfg, vty);
+}
+
 static int log_5424_node_exit(struct vty *vty)
 {
 	VTY_DECLVAR_CONTEXT(zlog_cfg_5424_user, cfg);
@@ -800,6 +839,16 @@ static int log_5424_config_write(struct vty *vty)
 				vty_out(vty, " timestamp local-time\n");
 		}
 
+		if (cfg->cfg.async) {
+			vty_out(vty, " writer async");
+			if (cfg->cfg.queue_max != DFLT_QUEUE_MAX)
+				vty_out(vty, " queue-size %u",
+					cfg->cfg.queue_max);
+			vty_out(vty, "\n");
+		}
+		if (cfg->cfg.rate_limit)
+			vty_out(vty, " rate-limit %u\n", cfg->cfg.rate_limit);
+
 		vty_out(vty, "!\n");
 	}
 	return 0;
@@ -848,6 +897,18 @@ static int log_5424_show(struct vty *vty)
 			zlog_priority_str(cfg->cfg.prio_min),
 			facility_name(cfg->cfg.facility));
 
+		size_t ratelimited, dropped, queued;
+
+		zlog_5424_drops(&cfg->cfg, &ratelimited, &dropped, &queued);
+		if (cfg->cfg.async)
+			vty_out(vty,
+				"  async writer: %zu queued (max %u), %zu dropped\n",
+				queued, cfg->cfg.queue_max, dropped);
+		if (cfg->cfg.rate_limit)
+			vty_out(vty,
+				"  rate limit: %u/s per call site, %zu suppressed\n",
+				cfg->cfg.rate_limit, ratelimited);
+
 		bool any_meta = false, first = true;
 
 		for (struct log_option *opt = log_opts; opt->name; opt++) {
@@ -956,6 +1017,8 @@ void log_5424_cmd_init(void)
 	install_element(EXTLOG_NODE, &log_5424_facility_cmd);
 	install_element(EXTLOG_NODE, &log_5424_ts_prec_cmd);
 	install_element(EXTLOG_NODE, &log_5424_ts_local_cmd);
+	install_element(EXTLOG_NODE, &log_5424_async_cmd);
+	install_element(EXTLOG_NODE, &log_5424_rate_limit_cmd);
 }
 
 /* hooks */
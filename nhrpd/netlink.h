@@ -18,5 +18,7 @@ extern int netlink_mcast_nflog_group;
 int netlink_configure_arp(unsigned int ifindex, int pf);
 void netlink_update_binding(struct interface *ifp, union sockunion *proto,
 			    union sockunion *nbma);
+/* send what is queued, later updates are dropped */
+void netlink_update_binding_terminate(void);
 void netlink_set_nflog_group(int nlgroup);
 
@@ -21,18 +21,109 @@
 #include "thread.h"
 #include "stream.h"
 #include "prefix.h"
+#include "jhash.h"
 #include "nhrpd.h"
 #include "netlink.h"
 #include "znl.h"
 
+DEFINE_MTYPE_STATIC(NHRPD, NHRP_BINDING, "NHRP pending neighbor binding");
+
 int netlink_nflog_group;
 static int netlink_log_fd = -1;
 static struct thread *netlink_log_thread;
 
+/*
+ * Neighbor entries are programmed through zebra.  Cache changes, hub
+ * restarts in particular, often update the same entry more than once in
+ * a row (delete then add on re-registration), so updates are queued and
+ * only the last one for each entry is sent, from an event.
+ */
+PREDECL_HASH(nhrp_bindings);
+
+struct nhrp_binding {
+	struct nhrp_bindings_item item;
+	ifindex_t ifindex;
+	union sockunion proto;
+	/* AF_UNSPEC to remove the entry */
+	union sockunion nbma;
+};
+
+static int nhrp_binding_cmp(const struct nhrp_binding *a,
+			    const struct nhrp_binding *b)
+{
+	if (a->ifindex != b->ifindex)
+		return a->ifindex < b->ifindex ? -1 : 1;
+	return sockunion_cmp(&a->proto, &b->proto);
+}
+
+static uint32_t nhrp_binding_hash(const struct nhrp_binding *b)
+{
+	return jhash_1word(b->ifindex, sockunion_hash(&b->proto));
+}
+
+DECLARE_HASH(nhrp_bindings, struct nhrp_binding, item, nhrp_binding_cmp,
+	     nhrp_binding_hash);
+
+static struct nhrp_bindings_head nhrp_bindings_pending =
+	INIT_HASH(nhrp_bindings_pending);
+static struct thread *nhrp_bindings_thread;
+static bool nhrp_bindings_stopped;
+
+static void netlink_update_binding_flush(void)
+{
+	struct nhrp_binding *b;
+	struct interface *ifp;
+
+	while ((b = nhrp_bindings_pop(&nhrp_bindings_pending))) {
+		ifp = if_lookup_by_index(b->ifindex, VRF_DEFAULT);
+		if (ifp)
+			nhrp_send_zebra_nbr(&b->proto,
+					    sockunion_family(&b->nbma)
+							== AF_UNSPEC
+						    ? NULL
+						    : &b->nbma,
+					    ifp);
+		XFREE(MTYPE_NHRP_BINDING, b);
+	}
+}
+
+static void netlink_update_binding_run(struct thread *t)
+{
+	netlink_update_binding_flush();
+}
+
 void netlink_update_binding(struct interface *ifp, union sockunion *proto,
 			    union sockunion *nbma)
 {
-	nhrp_send_zebra_nbr(proto, nbma, ifp);
+	struct nhrp_binding ref, *b;
+
+	if (nhrp_bindings_stopped)
+		return;
+
+	ref.ifindex = ifp->ifindex;
+	ref.proto = *proto;
+	b = nhrp_bindings_find(&nhrp_bindings_pending, &ref);
+	if (!b) {
+		b = XCALLOC(MTYPE_NHRP_BINDING, sizeof(*b));
+		b->ifindex = ifp->ifindex;
+		b->proto = *proto;
+		nhrp_bindings_add(&nhrp_bindings_pending, b);
+	}
+
+	if (nbma)
+		b->nbma = *nbma;
+	else
+		memset(&b->nbma, 0, sizeof(b->nbma));
+
+	thread_add_event(master, netlink_update_binding_run, NULL, 0,
+			 &nhrp_bindings_thread);
+}
+
+void netlink_update_binding_terminate(void)
+{
+	THREAD_OFF(nhrp_bindings_thread);
+	netlink_update_binding_flush();
+	nhrp_bindings_stopped = true;
 }
 
 static void netlink_log_register(int fd, int group)
@@ -17,6 +17,7 @@
 #include "stream.h"
 #include "log.h"
 #include "zclient.h"
+#include "netlink.h"
 
 DEFINE_MTYPE_STATIC(NHRPD, NHRP_ROUTE, "NHRP routing entry");
 
@@ -465,6 +466,7 @@ int nhrp_send_zebra_gre_request(struct interface *ifp)
 
 void nhrp_zebra_terminate(void)
 {
+	netlink_update_binding_terminate();
 	nhrp_zebra_register_neigh(VRF_DEFAULT, AFI_IP, false);
 	nhrp_zebra_register_neigh(VRF_DEFAULT, AFI_IP6, false);
 	zclient_stop(zclient);
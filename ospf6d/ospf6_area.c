@@ -299,6 +299,8 @@ struct ospf6_area *ospf6_area_create(uint32_t area_id, struct ospf6 *o, int df)
 
 	oa->spf_table = OSPF6_ROUTE_TABLE_CREATE(AREA, SPF_RESULTS);
 	oa->spf_table->scope = oa;
+	oa->spf_table_prev = OSPF6_ROUTE_TABLE_CREATE(AREA, SPF_RESULTS);
+	oa->spf_table_prev->scope = oa;
 	oa->route_table = OSPF6_ROUTE_TABLE_CREATE(AREA, ROUTES);
 	oa->route_table->scope = oa;
 	oa->route_table->hook_add = ospf6_area_route_hook_add;
@@ -367,6 +369,8 @@ void ospf6_area_delete(struct ospf6_area *oa)
 
 	ospf6_spf_table_finish(oa->spf_table);
 	ospf6_route_table_delete(oa->spf_table);
+	ospf6_spf_table_finish(oa->spf_table_prev);
+	ospf6_route_table_delete(oa->spf_table_prev);
 	ospf6_route_table_delete(oa->route_table);
 
 	ospf6_route_table_delete(oa->range_table);
@@ -434,6 +438,7 @@ void ospf6_area_disable(struct ospf6_area *oa)
 	ospf6_lsdb_remove_all(oa->lsdb_self);
 
 	ospf6_spf_table_finish(oa->spf_table);
+	ospf6_spf_table_finish(oa->spf_table_prev);
 	ospf6_route_remove_all(oa->route_table);
 
 	THREAD_OFF(oa->thread_router_lsa);
@@ -71,6 +71,7 @@ struct ospf6_area {
 	struct ospf6_lsdb *temp_router_lsa_lsdb;
 
 	struct ospf6_route_table *spf_table;
+	struct ospf6_route_table *spf_table_prev; /* result of the last SPF */
 	struct ospf6_route_table *route_table;
 
 	uint32_t spf_calculation; /* SPF calculation count */
@@ -2063,6 +2063,115 @@ void ospf6_intra_prefix_lsa_remove(struct ospf6_lsa *lsa)
 		zlog_debug("Trailing garbage ignored");
 }
 
+/*
+ * The routes of an intra-area-prefix LSA only depend on the LSA itself,
+ * which is handled by the LSDB hooks, and on the SPF result for the router
+ * or network it references.  After an SPF run it is therefore enough to
+ * re-examine the LSAs whose referenced vertex appeared, disappeared or
+ * changed its cost or nexthops, together with the other LSAs sharing a
+ * route with them.  The summaries originated by an ABR may change with
+ * any route, so ABRs, configuration changes and graceful restart still
+ * take the full path.
+ */
+static bool ospf6_intra_route_calculation_incremental(struct ospf6_area *oa)
+{
+	struct ospf6 *ospf6 = oa->ospf6;
+
+	if (CHECK_FLAG(ospf6->flag, OSPF6_FLAG_ABR))
+		return false;
+	if (CHECK_FLAG(ospf6->spf_reason,
+		       OSPF6_SPF_FLAGS_CONFIG_CHANGE
+			       | OSPF6_SPF_FLAGS_ASBR_STATUS_CHANGE
+			       | OSPF6_SPF_FLAGS_GR_FINISH))
+		return false;
+	if (ospf6->gr_info.restart_in_progress)
+		return false;
+
+	return true;
+}
+
+static bool ospf6_intra_ls_entry_changed(struct ospf6_area *oa,
+					 struct ospf6_lsa *lsa)
+{
+	struct ospf6_intra_prefix_lsa *intra_prefix_lsa;
+	struct prefix ls_prefix;
+	struct ospf6_route *new, *old;
+
+	intra_prefix_lsa =
+		(struct ospf6_intra_prefix_lsa *)OSPF6_LSA_HEADER_END(
+			lsa->header);
+	if (intra_prefix_lsa->ref_type != htons(OSPF6_LSTYPE_ROUTER)
+	    && intra_prefix_lsa->ref_type != htons(OSPF6_LSTYPE_NETWORK))
+		return false;
+
+	ospf6_linkstate_prefix(intra_prefix_lsa->ref_adv_router,
+			       intra_prefix_lsa->ref_id, &ls_prefix);
+	new = ospf6_route_lookup(&ls_prefix, oa->spf_table);
+	old = ospf6_route_lookup(&ls_prefix, oa->spf_table_prev);
+	if (!new || !old)
+		return new != old;
+
+	return new->path.cost != old->path.cost
+	       || !ospf6_route_cmp_nexthops(new, old);
+}
+
+/* A route whose origin is gone is treated as marked, so it is dropped */
+static bool ospf6_intra_path_marked(struct ospf6_area *oa,
+				    struct ospf6_path *path)
+{
+	struct ospf6_lsa *lsa;
+
+	lsa = ospf6_lsdb_lookup(path->origin.type, path->origin.id,
+				path->origin.adv_router, oa->lsdb);
+
+	return !lsa || CHECK_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+}
+
+/*
+ * Flag the routes with a path from a marked LSA for removal, and mark the
+ * LSAs of their other paths, as re-adding the route needs all of them.
+ */
+static void ospf6_intra_route_mark(struct ospf6_area *oa)
+{
+	struct ospf6_route *route;
+	struct ospf6_path *path;
+	struct listnode *node;
+	struct ospf6_lsa *lsa;
+	bool marked, more;
+
+	do {
+		more = false;
+
+		for (route = ospf6_route_head(oa->route_table); route;
+		     route = ospf6_route_next(route)) {
+			if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE))
+				continue;
+
+			marked = ospf6_intra_path_marked(oa, &route->path);
+			for (ALL_LIST_ELEMENTS_RO(route->paths, node, path))
+				if (!marked)
+					marked = ospf6_intra_path_marked(oa,
+									 path);
+			if (!marked)
+				continue;
+
+			SET_FLAG(route->flag, OSPF6_ROUTE_REMOVE);
+			for (ALL_LIST_ELEMENTS_RO(route->paths, node, path)) {
+				lsa = ospf6_lsdb_lookup(path->origin.type,
+							path->origin.id,
+							path->origin.adv_router,
+							oa->lsdb);
+				if (!lsa
+				    || CHECK_FLAG(lsa->flag, OSPF6_LSA_RECALC))
+					continue;
+
+				SET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+				more = true;
+			}
+		}
+	} while (more);
+}
+
 void ospf6_intra_route_calculation(struct ospf6_area *oa)
 {
 	struct ospf6_route *route, *nroute;
@@ -2071,34 +2180,74 @@ void ospf6_intra_route_calculation(struct ospf6_area *oa)
 	void (*hook_add)(struct ospf6_route *) = NULL;
 	void (*hook_remove)(struct ospf6_route *) = NULL;
 	char buf[PREFIX2STR_BUFFER];
+	bool incremental;
+	unsigned int examined = 0;
+
+	incremental = ospf6_intra_route_calculation_incremental(oa);
 
 	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
-		zlog_debug("Re-examin intra-routes for area %s", oa->name);
+		zlog_debug("Re-examin intra-routes for area %s%s", oa->name,
+			   incremental ? " (incremental)" : "");
 
 	hook_add = oa->route_table->hook_add;
 	hook_remove = oa->route_table->hook_remove;
 	oa->route_table->hook_add = NULL;
 	oa->route_table->hook_remove = NULL;
 
-	for (route = ospf6_route_head(oa->route_table); route;
-	     route = ospf6_route_next(route))
-		route->flag = OSPF6_ROUTE_REMOVE;
-
 	type = htons(OSPF6_LSTYPE_INTRA_PREFIX);
-	for (ALL_LSDB_TYPED(oa->lsdb, type, lsa))
-		ospf6_intra_prefix_lsa_add(lsa);
+	if (incremental) {
+		for (route = ospf6_route_head(oa->route_table); route;
+		     route = ospf6_route_next(route))
+			UNSET_FLAG(route->flag, OSPF6_ROUTE_ADD
+							| OSPF6_ROUTE_CHANGE
+							| OSPF6_ROUTE_REMOVE);
+
+		for (ALL_LSDB_TYPED(oa->lsdb, type, lsa)) {
+			UNSET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+			if (ospf6_intra_ls_entry_changed(oa, lsa))
+				SET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+		}
+
+		ospf6_intra_route_mark(oa);
+
+		for (ALL_LSDB_TYPED(oa->lsdb, type, lsa)) {
+			if (!CHECK_FLAG(lsa->flag, OSPF6_LSA_RECALC))
+				continue;
+
+			UNSET_FLAG(lsa->flag, OSPF6_LSA_RECALC);
+			ospf6_intra_prefix_lsa_add(lsa);
+			examined++;
+		}
+	} else {
+		for (route = ospf6_route_head(oa->route_table); route;
+		     route = ospf6_route_next(route))
+			route->flag = OSPF6_ROUTE_REMOVE;
+
+		for (ALL_LSDB_TYPED(oa->lsdb, type, lsa)) {
+			ospf6_intra_prefix_lsa_add(lsa);
+			examined++;
+		}
+	}
 
 	oa->route_table->hook_add = hook_add;
 	oa->route_table->hook_remove = hook_remove;
 
 	for (route = ospf6_route_head(oa->route_table); route; route = nroute) {
+		nroute = ospf6_route_next(route);
+
+		/* not affected by the changes */
+		if (incremental
+		    && !CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD
+							| OSPF6_ROUTE_CHANGE
+							| OSPF6_ROUTE_REMOVE))
+			continue;
+
 		if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX)) {
 			prefix2str(&route->prefix, buf, sizeof(buf));
 			zlog_debug("%s: route %s, flag 0x%x", __func__, buf,
 				   route->flag);
 		}
 
-		nroute = ospf6_route_next(route);
 		if (CHECK_FLAG(route->flag, OSPF6_ROUTE_REMOVE)
 		    && CHECK_FLAG(route->flag, OSPF6_ROUTE_ADD)) {
 			UNSET_FLAG(route->flag, OSPF6_ROUTE_REMOVE);
@@ -2123,8 +2272,8 @@ void ospf6_intra_route_calculation(struct ospf6_area *oa)
 	}
 
 	if (IS_OSPF6_DEBUG_EXAMIN(INTRA_PREFIX))
-		zlog_debug("Re-examin intra-routes for area %s: Done",
-			   oa->name);
+		zlog_debug("Re-examin intra-routes for area %s: Done, %u LSAs",
+			   oa->name, examined);
 }
 
 static void ospf6_brouter_debug_print(struct ospf6_route *brouter)
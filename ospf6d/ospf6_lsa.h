@@ -20,6 +20,7 @@
 
 #ifndef OSPF6_LSA_H
 #define OSPF6_LSA_H
+#include "typesafe.h"
 #include "ospf6_top.h"
 #include "lib/json.h"
 
@@ -121,10 +122,13 @@ struct ospf6_lsa_header {
 #define OSPF6_LSA_IS_SEQWRAP(L) ((L)->header->seqnum == htonl(OSPF_MAX_SEQUENCE_NUMBER + 1))
 
 
+PREDECL_HASH(ospf6_lsdb_hash);
+
 struct ospf6_lsa {
 	char name[64]; /* dump string */
 
 	struct route_node *rn;
+	struct ospf6_lsdb_hash_item hash_item; /* exact match index of lsdb */
 
 	unsigned char lock; /* reference counter */
 	unsigned char flag; /* special meaning (e.g. floodback) */
@@ -157,6 +161,7 @@ struct ospf6_lsa {
 #define OSPF6_LSA_UNAPPROVED 0x10
 #define OSPF6_LSA_SEQWRAPPED 0x20
 #define OSPF6_LSA_FLUSH      0x40
+#define OSPF6_LSA_RECALC     0x80 /* intra-prefix LSA to be re-examined */
 
 struct ospf6_lsa_handler {
 	uint16_t lh_type; /* host byte order */
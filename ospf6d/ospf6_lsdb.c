@@ -26,6 +26,7 @@
 #include "prefix.h"
 #include "table.h"
 #include "vty.h"
+#include "jhash.h"
 
 #include "ospf6_proto.h"
 #include "ospf6_lsa.h"
@@ -37,6 +38,31 @@
 
 DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_LSDB, "OSPF6 LSA database");
 
+/*
+ * The route_table keeps the LSAs sorted for the walks by type and
+ * advertising router, the hash serves the lookups of single LSAs.
+ */
+static int ospf6_lsdb_hash_cmp(const struct ospf6_lsa *a,
+			       const struct ospf6_lsa *b)
+{
+	if (a->header->type != b->header->type)
+		return a->header->type < b->header->type ? -1 : 1;
+	if (a->header->id != b->header->id)
+		return a->header->id < b->header->id ? -1 : 1;
+	if (a->header->adv_router != b->header->adv_router)
+		return a->header->adv_router < b->header->adv_router ? -1 : 1;
+	return 0;
+}
+
+static uint32_t ospf6_lsdb_hash_key(const struct ospf6_lsa *lsa)
+{
+	return jhash_3words(lsa->header->type, lsa->header->id,
+			    lsa->header->adv_router, 0xa8d2e1f5);
+}
+
+DECLARE_HASH(ospf6_lsdb_hash, struct ospf6_lsa, hash_item, ospf6_lsdb_hash_cmp,
+	     ospf6_lsdb_hash_key);
+
 struct ospf6_lsdb *ospf6_lsdb_create(void *data)
 {
 	struct ospf6_lsdb *lsdb;
@@ -46,6 +72,7 @@ struct ospf6_lsdb *ospf6_lsdb_create(void *data)
 
 	lsdb->data = data;
 	lsdb->table = route_table_init();
+	ospf6_lsdb_hash_init(&lsdb->hash);
 	return lsdb;
 }
 
@@ -54,6 +81,7 @@ void ospf6_lsdb_delete(struct ospf6_lsdb *lsdb)
 	if (lsdb != NULL) {
 		ospf6_lsdb_remove_all(lsdb);
 		route_table_finish(lsdb->table);
+		ospf6_lsdb_hash_fini(&lsdb->hash);
 		XFREE(MTYPE_OSPF6_LSDB, lsdb);
 	}
 }
@@ -120,6 +148,10 @@ void ospf6_lsdb_add(struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
 	lsa->rn = current;
 	ospf6_lsa_lock(lsa);
 
+	if (old)
+		ospf6_lsdb_hash_del(&lsdb->hash, old);
+	ospf6_lsdb_hash_add(&lsdb->hash, lsa);
+
 	if (!old) {
 		lsdb->count++;
 		ospf6_lsdb_stats_update(lsa, lsdb, 1);
@@ -173,6 +205,7 @@ void ospf6_lsdb_remove(struct ospf6_lsa *lsa, struct ospf6_lsdb *lsdb)
 	assert(node && node->info == lsa);
 
 	node->info = NULL;
+	ospf6_lsdb_hash_del(&lsdb->hash, lsa);
 	lsdb->count--;
 	ospf6_lsdb_stats_update(lsa, lsdb, -1);
 
@@ -190,23 +223,18 @@ struct ospf6_lsa *ospf6_lsdb_lookup(uint16_t type, uint32_t id,
 				    uint32_t adv_router,
 				    struct ospf6_lsdb *lsdb)
 {
-	struct route_node *node;
-	struct prefix_ipv6 key;
+	struct ospf6_lsa_header header;
+	struct ospf6_lsa ref;
 
 	if (lsdb == NULL)
 		return NULL;
 
-	memset(&key, 0, sizeof(key));
-	ospf6_lsdb_set_key(&key, &type, sizeof(type));
-	ospf6_lsdb_set_key(&key, &adv_router, sizeof(adv_router));
-	ospf6_lsdb_set_key(&key, &id, sizeof(id));
-
-	node = route_node_lookup(lsdb->table, (struct prefix *)&key);
-	if (node == NULL || node->info == NULL)
-		return NULL;
+	header.type = type;
+	header.id = id;
+	header.adv_router = adv_router;
+	ref.header = &header;
 
-	route_unlock_node(node);
-	return (struct ospf6_lsa *)node->info;
+	return ospf6_lsdb_hash_find(&lsdb->hash, &ref);
 }
 
 struct ospf6_lsa *ospf6_find_external_lsa(struct ospf6 *ospf6, struct prefix *p)
@@ -24,10 +24,12 @@
 #include "prefix.h"
 #include "table.h"
 #include "ospf6_route.h"
+#include "ospf6_lsa.h"
 
 struct ospf6_lsdb {
 	void *data; /* data structure that holds this lsdb */
 	struct route_table *table;
+	struct ospf6_lsdb_hash_head hash; /* for lookups of a single LSA */
 	uint32_t count;
 	uint32_t stats[OSPF6_LSTYPE_SIZE];
 	void (*hook_add)(struct ospf6_lsa *);
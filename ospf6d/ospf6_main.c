@@ -48,6 +48,7 @@
 #include "ospf6_lsa.h"
 #include "ospf6_interface.h"
 #include "ospf6_zebra.h"
+#include "ospf6_spf.h"
 #include "ospf6_routemap_nb.h"
 
 /* Default configuration file name for ospf6d. */
@@ -118,6 +119,7 @@ static void __attribute__((noreturn)) ospf6_exit(int status)
 		zclient_free(zclient);
 	}
 
+	ospf6_spf_pool_finish();
 	frr_fini();
 	exit(status);
 }
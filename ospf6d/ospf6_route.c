@@ -48,7 +48,7 @@ unsigned char conf_debug_ospf6_route = 0;
 
 static char *ospf6_route_table_name(struct ospf6_route_table *table)
 {
-	static char name[64];
+	static __thread char name[64];
 	switch (table->scope_type) {
 	case OSPF6_SCOPE_TYPE_GLOBAL: {
 		switch (table->table_type) {
@@ -30,6 +30,7 @@
 #include "linklist.h"
 #include "thread.h"
 #include "lib_errors.h"
+#include "frr_pthread.h"
 
 #include "ospf6_lsa.h"
 #include "ospf6_lsdb.h"
@@ -46,7 +47,7 @@
 #include "ospf6_nssa.h"
 #include "ospf6_zebra.h"
 
-DEFINE_MTYPE_STATIC(OSPF6D, OSPF6_VERTEX, "OSPF6 vertex");
+DEFINE_MTYPE_POOL_STATIC(OSPF6D, OSPF6_VERTEX, "OSPF6 vertex");
 
 unsigned char conf_debug_ospf6_spf = 0;
 
@@ -90,8 +91,7 @@ static int ospf6_vertex_cmp(const struct ospf6_vertex *va,
 		return (va->hops - vb->hops);
 	return 0;
 }
-DECLARE_SKIPLIST_NONUNIQ(vertex_pqueue, struct ospf6_vertex, pqi,
-		ospf6_vertex_cmp);
+DECLARE_HEAP(vertex_pqueue, struct ospf6_vertex, pqi, ospf6_vertex_cmp);
 
 static int ospf6_vertex_id_cmp(void *a, void *b)
 {
@@ -574,7 +574,7 @@ void ospf6_spf_calculation(uint32_t router_id,
 		}
 	}
 
-	//vertex_pqueue_fini(&candidate_list);
+	vertex_pqueue_fini(&candidate_list);
 
 	ospf6_remove_temp_router_lsa(oa);
 
@@ -605,6 +605,101 @@ static void ospf6_spf_log_database(struct ospf6_area *oa)
 	zlog_debug("%s", buffer);
 }
 
+/*
+ * The shortest-path trees of the areas only depend on the areas' own LSDBs,
+ * and are built concurrently on a pool of worker pthreads when there is
+ * more than one area.  The intra-area routes and border routers are then
+ * calculated into the global tables on the main pthread, in the usual
+ * order: backbone last.
+ */
+#define OSPF6_SPF_WORKERS_MAX 8
+
+static struct frr_pthread_pool *ospf6_spf_pool;
+static bool ospf6_spf_pool_tried;
+
+static void ospf6_spf_job_run(void *arg)
+{
+	struct ospf6_area *oa = arg;
+
+	ospf6_spf_calculation(oa->ospf6->router_id, oa->spf_table, oa);
+}
+
+static struct frr_pthread_pool *ospf6_spf_pool_get(void)
+{
+	long nprocs;
+
+	if (!ospf6_spf_pool_tried) {
+		ospf6_spf_pool_tried = true;
+
+		nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		if (nprocs > 1)
+			ospf6_spf_pool = frr_pthread_pool_new(
+				"OSPF6 SPF", MIN(nprocs - 1,
+						 OSPF6_SPF_WORKERS_MAX));
+	}
+
+	return ospf6_spf_pool;
+}
+
+void ospf6_spf_pool_finish(void)
+{
+	frr_pthread_pool_free(&ospf6_spf_pool);
+}
+
+static void ospf6_spf_calculation_area_prepare(struct ospf6_area *oa)
+{
+	struct ospf6_route_table *table;
+
+	/*
+	 * The previous result is kept for the intra-area route calculation,
+	 * which only re-examines the prefixes of changed vertices.
+	 */
+	table = oa->spf_table_prev;
+	oa->spf_table_prev = oa->spf_table;
+	oa->spf_table = table;
+
+	monotime(&oa->ts_spf);
+	if (IS_OSPF6_DEBUG_SPF(PROCESS)) {
+		if (oa == oa->ospf6->backbone)
+			zlog_debug("SPF calculation for Backbone area %s",
+				   oa->name);
+		else
+			zlog_debug("SPF calculation for Area %s", oa->name);
+	}
+	if (IS_OSPF6_DEBUG_SPF(DATABASE))
+		ospf6_spf_log_database(oa);
+}
+
+/* Build all the areas' trees on the pool, false if it can't be used */
+static bool ospf6_spf_calculation_parallel(struct ospf6 *ospf6)
+{
+	struct frr_pthread_pool *pool;
+	struct ospf6_area *oa;
+	struct listnode *node;
+	unsigned int count, i = 0;
+	void **args;
+
+	count = listcount(ospf6->area_list);
+	if (count < 2)
+		return false;
+
+	pool = ospf6_spf_pool_get();
+	if (!pool)
+		return false;
+
+	args = XCALLOC(MTYPE_TMP, count * sizeof(*args));
+	for (ALL_LIST_ELEMENTS_RO(ospf6->area_list, node, oa)) {
+		ospf6_spf_calculation_area_prepare(oa);
+		args[i++] = oa;
+	}
+
+	frr_pthread_pool_run(pool, ospf6_spf_job_run, args, count);
+
+	XFREE(MTYPE_TMP, args);
+
+	return true;
+}
+
 static void ospf6_spf_calculation_thread(struct thread *t)
 {
 	struct ospf6_area *oa;
@@ -613,6 +708,7 @@ static void ospf6_spf_calculation_thread(struct thread *t)
 	struct listnode *node;
 	int areas_processed = 0;
 	char rbuf[32];
+	bool parallel;
 
 	ospf6 = (struct ospf6 *)THREAD_ARG(t);
 
@@ -623,18 +719,18 @@ static void ospf6_spf_calculation_thread(struct thread *t)
 	if (ospf6_check_and_set_router_abr(ospf6))
 		ospf6_abr_range_reset_cost(ospf6);
 
+	parallel = ospf6_spf_calculation_parallel(ospf6);
+
 	for (ALL_LIST_ELEMENTS_RO(ospf6->area_list, node, oa)) {
 
 		if (oa == ospf6->backbone)
 			continue;
 
-		monotime(&oa->ts_spf);
-		if (IS_OSPF6_DEBUG_SPF(PROCESS))
-			zlog_debug("SPF calculation for Area %s", oa->name);
-		if (IS_OSPF6_DEBUG_SPF(DATABASE))
-			ospf6_spf_log_database(oa);
-
-		ospf6_spf_calculation(ospf6->router_id, oa->spf_table, oa);
+		if (!parallel) {
+			ospf6_spf_calculation_area_prepare(oa);
+			ospf6_spf_calculation(ospf6->router_id, oa->spf_table,
+					      oa);
+		}
 		ospf6_intra_route_calculation(oa);
 		ospf6_intra_brouter_calculation(oa);
 
@@ -642,16 +738,12 @@ static void ospf6_spf_calculation_thread(struct thread *t)
 	}
 
 	if (ospf6->backbone) {
-		monotime(&ospf6->backbone->ts_spf);
-		if (IS_OSPF6_DEBUG_SPF(PROCESS))
-			zlog_debug("SPF calculation for Backbone area %s",
-				   ospf6->backbone->name);
-		if (IS_OSPF6_DEBUG_SPF(DATABASE))
-			ospf6_spf_log_database(ospf6->backbone);
-
-		ospf6_spf_calculation(ospf6->router_id,
-				      ospf6->backbone->spf_table,
-				      ospf6->backbone);
+		if (!parallel) {
+			ospf6_spf_calculation_area_prepare(ospf6->backbone);
+			ospf6_spf_calculation(ospf6->router_id,
+					      ospf6->backbone->spf_table,
+					      ospf6->backbone);
+		}
 		ospf6_intra_route_calculation(ospf6->backbone);
 		ospf6_intra_brouter_calculation(ospf6->backbone);
 		areas_processed++;
@@ -678,6 +770,13 @@ static void ospf6_spf_calculation_thread(struct thread *t)
 			areas_processed, (long long)runtime.tv_sec,
 			(long long)runtime.tv_usec, rbuf);
 
+	/* these may change external routes without changing any brouter */
+	if (CHECK_FLAG(ospf6->spf_reason,
+		       OSPF6_SPF_FLAGS_CONFIG_CHANGE
+			       | OSPF6_SPF_FLAGS_ASBR_STATUS_CHANGE
+			       | OSPF6_SPF_FLAGS_GR_FINISH))
+		ospf6->ase_calc_full = true;
+
 	ospf6->last_spf_reason = ospf6->spf_reason;
 	ospf6_reset_spf_reason(ospf6);
 }
@@ -1243,20 +1342,95 @@ int ospf6_ase_calculate_route(struct ospf6 *ospf6, struct ospf6_lsa *lsa,
 	return 0;
 }
 
+/*
+ * Has the border router entry of adv_router changed since the previous
+ * ASE calculation?  The external routes derived from the LSAs of an ASBR
+ * only depend on its entries, unless they carry a forwarding address.
+ */
+static bool ospf6_ase_brouter_changed(struct ospf6 *ospf6, uint32_t adv_router)
+{
+	struct ospf6_route *cur, *prev;
+	struct prefix asbr_id;
+
+	ospf6_linkstate_prefix(adv_router, htonl(0), &asbr_id);
+	cur = ospf6_route_lookup(&asbr_id, ospf6->brouter_table);
+	prev = ospf6_route_lookup(&asbr_id, ospf6->ase_brouter_table);
+
+	while (cur && prev && ospf6_route_is_same(cur, prev)) {
+		if (cur->path.area_id != prev->path.area_id
+		    || cur->path.type != prev->path.type
+		    || cur->path.cost != prev->path.cost
+		    || cur->path.router_bits != prev->path.router_bits
+		    || !ospf6_route_cmp_nexthops(cur, prev))
+			return true;
+		cur = cur->next;
+		prev = prev->next;
+	}
+
+	/* one of them has more entries for the router than the other */
+	if (cur && prefix_same(&cur->prefix, &asbr_id))
+		return true;
+	if (prev && prefix_same(&prev->prefix, &asbr_id))
+		return true;
+	return false;
+}
+
+/* Should lsa be recalculated by this ASE run? */
+static bool ospf6_ase_lsa_needs_calc(struct ospf6 *ospf6,
+				     struct ospf6_lsa *lsa, bool full,
+				     uint32_t *last_adv_router,
+				     bool *last_changed)
+{
+	struct ospf6_as_external_lsa *external;
+
+	if (full)
+		return true;
+
+	external = (struct ospf6_as_external_lsa *)OSPF6_LSA_HEADER_END(
+		lsa->header);
+	if (CHECK_FLAG(external->bits_metric, OSPF6_ASBR_BIT_F))
+		return true;
+
+	/* the LSDB is walked in advertising router order */
+	if (lsa->header->adv_router != *last_adv_router) {
+		*last_adv_router = lsa->header->adv_router;
+		*last_changed = ospf6_ase_brouter_changed(
+			ospf6, lsa->header->adv_router);
+	}
+	return *last_changed;
+}
+
 static void ospf6_ase_calculate_timer(struct thread *t)
 {
 	struct ospf6 *ospf6;
 	struct ospf6_lsa *lsa;
 	struct listnode *node, *nnode;
 	struct ospf6_area *area;
+	struct ospf6_route *brouter;
+	uint32_t last_adv_router;
+	bool last_changed = false;
+	bool full;
 	uint16_t type;
 
 	ospf6 = THREAD_ARG(t);
 
+	/*
+	 * Only the LSAs of ASBRs whose border router entry changed since the
+	 * last run need recalculating, everything else is already up to date.
+	 */
+	full = ospf6->ase_calc_full || ospf6->gr_info.finishing_restart
+	       || ospf6->ase_calc_abr != !!IS_OSPF6_ABR(ospf6);
+	ospf6->ase_calc_full = false;
+	ospf6->ase_calc_abr = !!IS_OSPF6_ABR(ospf6);
+
 	/* Calculate external route for each AS-external-LSA */
+	last_adv_router = 0;
 	type = htons(OSPF6_LSTYPE_AS_EXTERNAL);
-	for (ALL_LSDB_TYPED(ospf6->lsdb, type, lsa))
-		ospf6_ase_calculate_route(ospf6, lsa, NULL);
+	for (ALL_LSDB_TYPED(ospf6->lsdb, type, lsa)) {
+		if (ospf6_ase_lsa_needs_calc(ospf6, lsa, full,
+					     &last_adv_router, &last_changed))
+			ospf6_ase_calculate_route(ospf6, lsa, NULL);
+	}
 
 	/*  This version simple adds to the table all NSSA areas  */
 	if (ospf6->anyNSSA) {
@@ -1265,12 +1439,24 @@ static void ospf6_ase_calculate_timer(struct thread *t)
 				zlog_debug("%s : looking at area %s", __func__,
 					   area->name);
 
+			last_adv_router = 0;
 			type = htons(OSPF6_LSTYPE_TYPE_7);
-			for (ALL_LSDB_TYPED(area->lsdb, type, lsa))
-				ospf6_ase_calculate_route(ospf6, lsa, area);
+			for (ALL_LSDB_TYPED(area->lsdb, type, lsa)) {
+				if (ospf6_ase_lsa_needs_calc(
+					    ospf6, lsa, full, &last_adv_router,
+					    &last_changed))
+					ospf6_ase_calculate_route(ospf6, lsa,
+								  area);
+			}
 		}
 	}
 
+	ospf6_route_remove_all(ospf6->ase_brouter_table);
+	for (brouter = ospf6_route_head(ospf6->brouter_table); brouter;
+	     brouter = ospf6_route_next(brouter))
+		ospf6_route_add(ospf6_route_copy(brouter),
+				ospf6->ase_brouter_table);
+
 	if (ospf6->gr_info.finishing_restart) {
 		/*
 		 * The routing table computation is complete. Uninstall remnant
@@ -37,7 +37,7 @@ extern unsigned char conf_debug_ospf6_spf;
 
 #define OSPF6_ASE_CALC_INTERVAL 1
 
-PREDECL_SKIPLIST_NONUNIQ(vertex_pqueue);
+PREDECL_HEAP(vertex_pqueue);
 /* Transit Vertex */
 struct ospf6_vertex {
 	/* type of this vertex */
@@ -159,6 +159,7 @@ extern void ospf6_spf_config_write(struct vty *vty, struct ospf6 *ospf6);
 extern int config_write_ospf6_debug_spf(struct vty *vty);
 extern void install_element_ospf6_debug_spf(void);
 extern void ospf6_spf_init(void);
+extern void ospf6_spf_pool_finish(void);
 extern void ospf6_spf_reason_string(unsigned int reason, char *buf, int size);
 extern struct ospf6_lsa *ospf6_create_single_router_lsa(struct ospf6_area *area,
 							struct ospf6_lsdb *lsdb,
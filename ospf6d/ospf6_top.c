@@ -406,6 +406,8 @@ static struct ospf6 *ospf6_create(const char *name)
 	o->brouter_table->scope = o;
 	o->brouter_table->hook_add = ospf6_top_brouter_hook_add;
 	o->brouter_table->hook_remove = ospf6_top_brouter_hook_remove;
+	o->ase_brouter_table = OSPF6_ROUTE_TABLE_CREATE(NONE, BORDER_ROUTERS);
+	o->ase_calc_full = true;
 
 	o->external_table = OSPF6_ROUTE_TABLE_CREATE(GLOBAL, EXTERNAL_ROUTES);
 	o->external_table->scope = o;
@@ -523,6 +525,7 @@ void ospf6_delete(struct ospf6 *o)
 
 	ospf6_route_table_delete(o->route_table);
 	ospf6_route_table_delete(o->brouter_table);
+	ospf6_route_table_delete(o->ase_brouter_table);
 
 	ospf6_route_table_delete(o->external_table);
 
@@ -566,6 +569,7 @@ static void ospf6_disable(struct ospf6 *o)
 		ospf6_lsdb_remove_all(o->lsdb);
 		ospf6_route_remove_all(o->route_table);
 		ospf6_route_remove_all(o->brouter_table);
+		o->ase_calc_full = true;
 
 		THREAD_OFF(o->maxage_remover);
 		THREAD_OFF(o->t_spf_calc);
@@ -741,6 +745,7 @@ static void ospf6_db_clear(struct ospf6 *ospf6)
 		ospf6_lsdb_remove_all(oa->lsdb_self);
 
 		ospf6_spf_table_finish(oa->spf_table);
+		ospf6_spf_table_finish(oa->spf_table_prev);
 		ospf6_route_remove_all(oa->route_table);
 	}
 
@@ -748,6 +753,7 @@ static void ospf6_db_clear(struct ospf6 *ospf6)
 	ospf6_lsdb_remove_all(ospf6->lsdb_self);
 	ospf6_route_remove_all(ospf6->route_table);
 	ospf6_route_remove_all(ospf6->brouter_table);
+	ospf6->ase_calc_full = true;
 }
 
 static void ospf6_process_reset(struct ospf6 *ospf6)
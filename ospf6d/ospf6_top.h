@@ -185,6 +185,10 @@ struct ospf6 {
 	/* Threads */
 	struct thread *t_spf_calc; /* SPF calculation timer. */
 	struct thread *t_ase_calc; /* ASE calculation timer. */
+	/* border routers as of the last ASE calculation */
+	struct ospf6_route_table *ase_brouter_table;
+	bool ase_calc_full; /* recalculate the routes of all ASBRs */
+	bool ase_calc_abr;  /* ABR status at the last ASE calculation */
 	struct thread *maxage_remover;
 	struct thread *t_distribute_update; /* Distirbute update timer. */
 	struct thread *t_ospf6_receive; /* OSPF6 receive timer */
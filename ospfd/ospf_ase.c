@@ -564,6 +564,296 @@ static int ospf_ase_compare_tables(struct ospf *ospf,
 	return 0;
 }
 
+/*
+ * Recalculate the external route to one destination from all LSAs for it,
+ * and install the difference.
+ */
+static void ospf_ase_update_prefix(struct ospf *ospf, struct prefix_ipv4 *p)
+{
+	struct list *lsas;
+	struct listnode *node;
+	struct route_node *rn, *rn2;
+	struct route_table *tmp_old;
+	struct ospf_lsa *lsa;
+
+	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)p);
+	assert(rn);
+	assert(rn->info);
+	lsas = rn->info;
+	route_unlock_node(rn);
+
+	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
+		ospf_ase_calculate_route(ospf, lsa);
+
+	/* prepare temporary old routing table for compare */
+	tmp_old = route_table_init();
+	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)p);
+	if (rn && rn->info) {
+		rn2 = route_node_get(tmp_old, (struct prefix *)p);
+		rn2->info = rn->info;
+		route_unlock_node(rn);
+	}
+
+	/* install changes to zebra */
+	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
+
+	/* update ospf->old_external_route table */
+	if (rn && rn->info)
+		ospf_route_free((struct ospf_route *)rn->info);
+
+	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)p);
+	/* if new route exists, install it to ospf->old_external_route */
+	if (rn2 && rn2->info) {
+		if (!rn)
+			rn = route_node_get(ospf->old_external_route,
+					    (struct prefix *)p);
+		rn->info = rn2->info;
+	} else {
+		/* remove route node from ospf->old_external_route */
+		if (rn) {
+			rn->info = NULL;
+			route_unlock_node(rn);
+		}
+	}
+
+	if (rn2) {
+		/* rn2->info is stored in route node of ospf->old_external_route
+		 */
+		rn2->info = NULL;
+		route_unlock_node(rn2);
+		route_unlock_node(rn2);
+	}
+
+	route_table_finish(tmp_old);
+}
+
+static void ospf_ase_mark_changed(struct route_table **rt,
+				  const struct prefix *p)
+{
+	struct route_node *rn;
+
+	if (!*rt)
+		*rt = route_table_init();
+
+	rn = route_node_get(*rt, p);
+	if (rn->info)
+		route_unlock_node(rn);
+	else
+		rn->info = (void *)1;
+}
+
+static void ospf_ase_changes_clear(struct ospf *ospf)
+{
+	if (ospf->ase_changed_nets)
+		route_table_finish(ospf->ase_changed_nets);
+	if (ospf->ase_changed_asbrs)
+		route_table_finish(ospf->ase_changed_asbrs);
+	ospf->ase_changed_nets = NULL;
+	ospf->ase_changed_asbrs = NULL;
+}
+
+/* Would an external route via r1 be the same as one via r2? */
+static bool ospf_ase_intra_route_same(const struct ospf_route *r1,
+				      const struct ospf_route *r2)
+{
+	struct listnode *n1, *n2;
+	struct ospf_path *op1, *op2;
+
+	if (r1->type != r2->type || r1->path_type != r2->path_type
+	    || r1->cost != r2->cost
+	    || !IPV4_ADDR_SAME(&r1->u.std.area_id, &r2->u.std.area_id)
+	    || r1->u.std.flags != r2->u.std.flags
+	    || r1->u.std.external_routing != r2->u.std.external_routing)
+		return false;
+
+	if (!r1->paths || !r2->paths)
+		return r1->paths == r2->paths;
+	if (listcount(r1->paths) != listcount(r2->paths))
+		return false;
+
+	for (n1 = listhead(r1->paths), n2 = listhead(r2->paths); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2)) {
+		op1 = listgetdata(n1);
+		op2 = listgetdata(n2);
+
+		if (!IPV4_ADDR_SAME(&op1->nexthop, &op2->nexthop)
+		    || op1->ifindex != op2->ifindex)
+			return false;
+	}
+
+	return true;
+}
+
+static bool ospf_ase_asbr_routes_same(struct list *l1, struct list *l2)
+{
+	struct listnode *n1, *n2;
+
+	if (!l1 || !l2)
+		return l1 == l2;
+	if (listcount(l1) != listcount(l2))
+		return false;
+
+	for (n1 = listhead(l1), n2 = listhead(l2); n1 && n2;
+	     n1 = listnextnode_unchecked(n1), n2 = listnextnode_unchecked(n2))
+		if (!ospf_ase_intra_route_same(listgetdata(n1),
+					       listgetdata(n2)))
+			return false;
+
+	return true;
+}
+
+/*
+ * Record the destinations and ASBRs whose routes differ between the routing
+ * tables of the previous SPF run (still in ospf->new_table and new_rtrs) and
+ * the one just calculated.  Only the external routes depending on those are
+ * recalculated, unless a full calculation is scheduled.
+ */
+void ospf_ase_spf_changes(struct ospf *ospf, struct route_table *new_table,
+			  struct route_table *new_rtrs)
+{
+	struct route_node *rn, *rn2;
+
+	if (!ospf->new_table || !ospf->new_rtrs) {
+		ospf_ase_calculate_schedule(ospf);
+		return;
+	}
+
+	/* A full calculation is pending anyway */
+	if (ospf->ase_calc)
+		return;
+
+	for (rn = route_top(ospf->new_table); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(new_table, &rn->p);
+		if (rn2)
+			route_unlock_node(rn2);
+		if (!rn2 || !rn2->info
+		    || !ospf_ase_intra_route_same(rn->info, rn2->info))
+			ospf_ase_mark_changed(&ospf->ase_changed_nets, &rn->p);
+	}
+	for (rn = route_top(new_table); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(ospf->new_table, &rn->p);
+		if (rn2)
+			route_unlock_node(rn2);
+		if (!rn2 || !rn2->info)
+			ospf_ase_mark_changed(&ospf->ase_changed_nets, &rn->p);
+	}
+
+	for (rn = route_top(ospf->new_rtrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(new_rtrs, &rn->p);
+		if (rn2)
+			route_unlock_node(rn2);
+		if (!rn2 || !ospf_ase_asbr_routes_same(rn->info, rn2->info))
+			ospf_ase_mark_changed(&ospf->ase_changed_asbrs,
+					      &rn->p);
+	}
+	for (rn = route_top(new_rtrs); rn; rn = route_next(rn)) {
+		if (!rn->info)
+			continue;
+
+		rn2 = route_node_lookup(ospf->new_rtrs, &rn->p);
+		if (rn2)
+			route_unlock_node(rn2);
+		if (!rn2 || !rn2->info)
+			ospf_ase_mark_changed(&ospf->ase_changed_asbrs,
+					      &rn->p);
+	}
+}
+
+/* Does the external route from lsa depend on a changed intra-AS route? */
+static bool ospf_ase_lsa_affected(struct ospf *ospf, struct ospf_lsa *lsa)
+{
+	struct as_external_lsa *al = (struct as_external_lsa *)lsa->data;
+	struct prefix_ipv4 p;
+	struct route_node *rn;
+
+	p.family = AF_INET;
+	p.prefixlen = IPV4_MAX_BITLEN;
+
+	if (ospf->ase_changed_asbrs) {
+		p.prefix = al->header.adv_router;
+		rn = route_node_lookup(ospf->ase_changed_asbrs,
+				       (struct prefix *)&p);
+		if (rn) {
+			route_unlock_node(rn);
+			return true;
+		}
+	}
+
+	if (ospf->ase_changed_nets && al->e[0].fwd_addr.s_addr != INADDR_ANY) {
+		p.prefix = al->e[0].fwd_addr;
+		rn = route_node_match(ospf->ase_changed_nets,
+				      (struct prefix *)&p);
+		if (rn) {
+			route_unlock_node(rn);
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Recalculate the external routes to destinations that have an intra-AS
+ * route change themselves, or with an LSA from a changed ASBR or with a
+ * forwarding address in a changed destination.
+ */
+static void ospf_ase_calculate_changes(struct ospf *ospf)
+{
+	struct route_table *todo = NULL;
+	struct route_node *rn, *rn2;
+	struct listnode *node;
+	struct ospf_lsa *lsa;
+	struct list *lsas;
+
+	if (ospf->ase_changed_nets)
+		for (rn = route_top(ospf->ase_changed_nets); rn;
+		     rn = route_next(rn)) {
+			if (!rn->info)
+				continue;
+
+			rn2 = route_node_lookup(ospf->external_lsas, &rn->p);
+			if (!rn2)
+				continue;
+			route_unlock_node(rn2);
+			if (rn2->info)
+				ospf_ase_mark_changed(&todo, &rn->p);
+		}
+
+	for (rn = route_top(ospf->external_lsas); rn; rn = route_next(rn)) {
+		if ((lsas = rn->info) == NULL)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
+			if (ospf_ase_lsa_affected(ospf, lsa)) {
+				ospf_ase_mark_changed(&todo, &rn->p);
+				break;
+			}
+	}
+
+	if (!todo)
+		return;
+
+	for (rn = route_top(todo); rn; rn = route_next(rn))
+		if (rn->info)
+			ospf_ase_update_prefix(ospf,
+					       (struct prefix_ipv4 *)&rn->p);
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: recalculated %lu external destinations",
+			   __func__, todo->count);
+
+	route_table_finish(todo);
+}
+
 static void ospf_ase_calculate_timer(struct thread *t)
 {
 	struct ospf *ospf;
@@ -611,6 +901,8 @@ static void ospf_ase_calculate_timer(struct thread *t)
 		ospf->old_external_route = ospf->new_external_route;
 		ospf->new_external_route = route_table_init();
 
+		ospf_ase_changes_clear(ospf);
+
 		monotime(&stop_time);
 
 		if (IS_DEBUG_OSPF_EVENT)
@@ -620,6 +912,21 @@ static void ospf_ase_calculate_timer(struct thread *t)
 						* 1000000LL
 					+ (stop_time.tv_usec
 					   - start_time.tv_usec));
+	} else if (ospf->ase_changed_nets || ospf->ase_changed_asbrs) {
+		monotime(&start_time);
+
+		ospf_ase_calculate_changes(ospf);
+		ospf_ase_changes_clear(ospf);
+
+		monotime(&stop_time);
+
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_info(
+				"SPF Processing Time(usecs): External Routes (changes only): %lld",
+				(stop_time.tv_sec - start_time.tv_sec)
+						* 1000000LL
+					+ (stop_time.tv_usec
+					   - start_time.tv_usec));
 	}
 
 	/*
@@ -640,6 +947,11 @@ void ospf_ase_calculate_schedule(struct ospf *ospf)
 	ospf->ase_calc = 1;
 }
 
+void ospf_ase_finish(struct ospf *ospf)
+{
+	ospf_ase_changes_clear(ospf);
+}
+
 void ospf_ase_calculate_timer_add(struct ospf *ospf)
 {
 	if (ospf == NULL)
@@ -720,11 +1032,8 @@ void ospf_ase_external_lsas_finish(struct route_table *rt)
 
 void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 {
-	struct list *lsas;
-	struct listnode *node;
-	struct route_node *rn, *rn2;
+	struct route_node *rn;
 	struct prefix_ipv4 p;
-	struct route_table *tmp_old;
 	struct as_external_lsa *al;
 
 	al = (struct as_external_lsa *)lsa->data;
@@ -749,53 +1058,5 @@ void ospf_ase_incremental_update(struct ospf *ospf, struct ospf_lsa *lsa)
 			return;
 	}
 
-	rn = route_node_lookup(ospf->external_lsas, (struct prefix *)&p);
-	assert(rn);
-	assert(rn->info);
-	lsas = rn->info;
-	route_unlock_node(rn);
-
-	for (ALL_LIST_ELEMENTS_RO(lsas, node, lsa))
-		ospf_ase_calculate_route(ospf, lsa);
-
-	/* prepare temporary old routing table for compare */
-	tmp_old = route_table_init();
-	rn = route_node_lookup(ospf->old_external_route, (struct prefix *)&p);
-	if (rn && rn->info) {
-		rn2 = route_node_get(tmp_old, (struct prefix *)&p);
-		rn2->info = rn->info;
-		route_unlock_node(rn);
-	}
-
-	/* install changes to zebra */
-	ospf_ase_compare_tables(ospf, ospf->new_external_route, tmp_old);
-
-	/* update ospf->old_external_route table */
-	if (rn && rn->info)
-		ospf_route_free((struct ospf_route *)rn->info);
-
-	rn2 = route_node_lookup(ospf->new_external_route, (struct prefix *)&p);
-	/* if new route exists, install it to ospf->old_external_route */
-	if (rn2 && rn2->info) {
-		if (!rn)
-			rn = route_node_get(ospf->old_external_route,
-					    (struct prefix *)&p);
-		rn->info = rn2->info;
-	} else {
-		/* remove route node from ospf->old_external_route */
-		if (rn) {
-			rn->info = NULL;
-			route_unlock_node(rn);
-		}
-	}
-
-	if (rn2) {
-		/* rn2->info is stored in route node of ospf->old_external_route
-		 */
-		rn2->info = NULL;
-		route_unlock_node(rn2);
-		route_unlock_node(rn2);
-	}
-
-	route_table_finish(tmp_old);
+	ospf_ase_update_prefix(ospf, &p);
 }
@@ -31,6 +31,10 @@ ospf_find_asbr_route_through_area(struct route_table *, struct prefix_ipv4 *,
 extern int ospf_ase_calculate_route(struct ospf *, struct ospf_lsa *);
 extern void ospf_ase_calculate_schedule(struct ospf *);
 extern void ospf_ase_calculate_timer_add(struct ospf *);
+extern void ospf_ase_spf_changes(struct ospf *ospf,
+				 struct route_table *new_table,
+				 struct route_table *new_rtrs);
+extern void ospf_ase_finish(struct ospf *ospf);
 
 extern void ospf_ase_external_lsas_finish(struct route_table *);
 extern void ospf_ase_incremental_update(struct ospf *, struct ospf_lsa *);
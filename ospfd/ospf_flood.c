@@ -1017,17 +1017,33 @@ static void ospf_ls_retransmit_delete_nbr_if(struct ospf_interface *oi,
 			if (lsr != NULL &&
 			    lsr->data->ls_seqnum == lsa->data->ls_seqnum)
 				ospf_ls_retransmit_delete(nbr, lsr);
+
+			/* Removed from the last list it was on */
+			if (lsr == lsa && lsa->retransmit_counter == 0) {
+				route_unlock_node(rn);
+				break;
+			}
 		}
 }
 
+/*
+ * Only LSDB instances are put on retransmit lists, and an instance is
+ * removed from all of them before it is replaced in the LSDB.  So an LSA
+ * with a zero retransmit_counter is not on any list, and the walk over all
+ * neighbors can be skipped or stopped early.  On a refresh wave, most LSAs
+ * have been acknowledged by then.
+ */
 void ospf_ls_retransmit_delete_nbr_area(struct ospf_area *area,
 					struct ospf_lsa *lsa)
 {
 	struct listnode *node, *nnode;
 	struct ospf_interface *oi;
 
-	for (ALL_LIST_ELEMENTS(area->oiflist, node, nnode, oi))
+	for (ALL_LIST_ELEMENTS(area->oiflist, node, nnode, oi)) {
+		if (lsa->retransmit_counter == 0)
+			break;
 		ospf_ls_retransmit_delete_nbr_if(oi, lsa);
+	}
 }
 
 void ospf_ls_retransmit_delete_nbr_as(struct ospf *ospf, struct ospf_lsa *lsa)
@@ -1035,8 +1051,11 @@ void ospf_ls_retransmit_delete_nbr_as(struct ospf *ospf, struct ospf_lsa *lsa)
 	struct listnode *node, *nnode;
 	struct ospf_interface *oi;
 
-	for (ALL_LIST_ELEMENTS(ospf->oiflist, node, nnode, oi))
+	for (ALL_LIST_ELEMENTS(ospf->oiflist, node, nnode, oi)) {
+		if (lsa->retransmit_counter == 0)
+			break;
 		ospf_ls_retransmit_delete_nbr_if(oi, lsa);
+	}
 }
 
 
@@ -849,6 +849,8 @@ int ospf_if_down(struct ospf_interface *oi)
 	}
 
 	OSPF_ISM_EVENT_EXECUTE(oi, ISM_InterfaceDown);
+	/* Kept SPF trees may have nexthops over this interface */
+	ospf_spf_tree_flush(ospf);
 	/* delete position in router LSA */
 	oi->lsa_pos_beg = 0;
 	oi->lsa_pos_end = 0;
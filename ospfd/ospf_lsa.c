@@ -2618,9 +2618,13 @@ struct ospf_lsa *ospf_external_lsa_refresh(struct ospf *ospf,
 
 /* LSA installation functions. */
 
-/* Install router-LSA to an area. */
-static struct ospf_lsa *
-ospf_router_lsa_install(struct ospf *ospf, struct ospf_lsa *new, int rt_recalc)
+/*
+ * Install router-LSA to an area.  If only its stub links changed, a partial
+ * route calculation does instead of a full SPF run.
+ */
+static struct ospf_lsa *ospf_router_lsa_install(struct ospf *ospf,
+						struct ospf_lsa *new,
+						int rt_recalc, bool prefix_only)
 {
 	struct ospf_area *area = new->area;
 
@@ -2653,7 +2657,10 @@ ospf_router_lsa_install(struct ospf *ospf, struct ospf_lsa *new, int rt_recalc)
 	}
 
 	if (rt_recalc)
-		ospf_spf_calculate_schedule(ospf, SPF_FLAG_ROUTER_LSA_INSTALL);
+		ospf_spf_calculate_schedule(ospf,
+					    prefix_only
+						    ? SPF_FLAG_ROUTER_LSA_PREFIX
+						    : SPF_FLAG_ROUTER_LSA_INSTALL);
 	return new;
 }
 
@@ -2818,6 +2825,7 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 	struct ospf_lsa *old = NULL;
 	struct ospf_lsdb *lsdb = NULL;
 	int rt_recalc;
+	bool prefix_only = false;
 
 	/* Set LSDB. */
 	switch (lsa->data->type) {
@@ -2883,6 +2891,11 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 		}
 
 		rt_recalc = 1;
+
+		/* Changed stub links of another router only move prefixes */
+		if (old && lsa->data->type == OSPF_ROUTER_LSA
+		    && !IS_LSA_SELF(lsa))
+			prefix_only = ospf_router_lsa_same_topology(old, lsa);
 	}
 
 	/*
@@ -2936,7 +2949,8 @@ struct ospf_lsa *ospf_lsa_install(struct ospf *ospf, struct ospf_interface *oi,
 	/* Do LSA specific installation process. */
 	switch (lsa->data->type) {
 	case OSPF_ROUTER_LSA:
-		new = ospf_router_lsa_install(ospf, lsa, rt_recalc);
+		new = ospf_router_lsa_install(ospf, lsa, rt_recalc,
+					      prefix_only);
 		break;
 	case OSPF_NETWORK_LSA:
 		assert(oi);
@@ -3199,6 +3213,10 @@ void ospf_lsa_maxage(struct ospf *ospf, struct ospf_lsa *lsa)
 		return;
 	}
 
+	/* The LSA no longer counts for SPF, though still in the LSDB */
+	if (lsa->lsdb)
+		lsa->lsdb->generation++;
+
 	memset(&lsa_prefix, 0, sizeof(lsa_prefix));
 	lsa_prefix.family = AF_UNSPEC;
 	lsa_prefix.prefixlen = sizeof(lsa_prefix.u.ptr) * CHAR_BIT;
@@ -3985,6 +4003,50 @@ struct ospf_lsa *ospf_lsa_refresh(struct ospf *ospf, struct ospf_lsa *lsa)
 	return new;
 }
 
+static unsigned int ospf_refresher_slot_count(struct ospf *ospf,
+					      uint16_t index)
+{
+	struct list *q = ospf->lsa_refresh_queue.qs[index];
+
+	return q ? listcount(q) : 0;
+}
+
+/*
+ * Mass origination, e.g. when redistributing many routes at once, puts
+ * all those LSAs into the few slots of the jitter window, and they would
+ * be refreshed in the same burst every refresh interval.  Instead, move
+ * LSAs for a busy slot to the least loaded one, up to half of the refresh
+ * time earlier.  Refreshing earlier is harmless and ends the burst.
+ */
+static uint16_t ospf_refresher_quiet_slot(struct ospf *ospf,
+					  uint16_t current_index,
+					  int max_delay, uint16_t index)
+{
+	unsigned int best = ospf_refresher_slot_count(ospf, index);
+	unsigned int count;
+	int first, last, start, n, d;
+	uint16_t i;
+
+	first = MAX(max_delay / 2 / OSPF_LSA_REFRESHER_GRANULARITY, 1);
+	last = max_delay / OSPF_LSA_REFRESHER_GRANULARITY;
+	if (last < first)
+		return index;
+
+	/* random start, so equally loaded slots fill evenly */
+	start = frr_weak_random() % (last - first + 1);
+	for (n = 0; n <= last - first && best; n++) {
+		d = first + (start + n) % (last - first + 1);
+		i = (current_index + d) % OSPF_LSA_REFRESHER_SLOTS;
+		count = ospf_refresher_slot_count(ospf, i);
+		if (count < best) {
+			best = count;
+			index = i;
+		}
+	}
+
+	return index;
+}
+
 void ospf_refresher_register_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
 {
 	uint16_t index, current_index;
@@ -4016,6 +4078,11 @@ void ospf_refresher_register_lsa(struct ospf *ospf, struct ospf_lsa *lsa)
 		index = (current_index + delay / OSPF_LSA_REFRESHER_GRANULARITY)
 			% (OSPF_LSA_REFRESHER_SLOTS);
 
+		if (ospf_refresher_slot_count(ospf, index)
+		    >= OSPF_LSA_REFRESHER_SLOT_BUSY)
+			index = ospf_refresher_quiet_slot(ospf, current_index,
+							  max_delay, index);
+
 		if (IS_DEBUG_OSPF(lsa, LSA_REFRESH))
 			zlog_debug(
 				"LSA[Refresh:Type%d:%pI4]: age %d, added to index %d",
@@ -25,6 +25,7 @@
 #include "table.h"
 #include "memory.h"
 #include "log.h"
+#include "jhash.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
@@ -32,6 +33,42 @@
 #include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_orr.h"
 
+DEFINE_MTYPE_POOL_STATIC(OSPFD, OSPF_LSDB_ENTRY, "OSPF LSDB index entry");
+
+static int ospf_lsdb_entry_cmp(const struct ospf_lsdb_entry *a,
+			       const struct ospf_lsdb_entry *b)
+{
+	if (a->type != b->type)
+		return a->type < b->type ? -1 : 1;
+	if (a->id.s_addr != b->id.s_addr)
+		return a->id.s_addr < b->id.s_addr ? -1 : 1;
+	if (a->adv_router.s_addr != b->adv_router.s_addr)
+		return a->adv_router.s_addr < b->adv_router.s_addr ? -1 : 1;
+	return 0;
+}
+
+static uint32_t ospf_lsdb_entry_hash(const struct ospf_lsdb_entry *e)
+{
+	return jhash_3words(e->type, e->id.s_addr, e->adv_router.s_addr,
+			    0x0f5fd6b5);
+}
+
+DECLARE_HASH(ospf_lsdb_hash, struct ospf_lsdb_entry, hitem,
+	     ospf_lsdb_entry_cmp, ospf_lsdb_entry_hash);
+
+static struct ospf_lsdb_entry *ospf_lsdb_find(struct ospf_lsdb *lsdb,
+					      uint8_t type, struct in_addr id,
+					      struct in_addr adv_router)
+{
+	struct ospf_lsdb_entry ref;
+
+	ref.type = type;
+	ref.id = id;
+	ref.adv_router = adv_router;
+
+	return ospf_lsdb_hash_find(lsdb->hash, &ref);
+}
+
 struct ospf_lsdb *ospf_lsdb_new(void)
 {
 	struct ospf_lsdb *new;
@@ -48,6 +85,7 @@ void ospf_lsdb_init(struct ospf_lsdb *lsdb)
 
 	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
 		lsdb->type[i].db = route_table_init();
+	ospf_lsdb_hash_init(lsdb->hash);
 }
 
 void ospf_lsdb_free(struct ospf_lsdb *lsdb)
@@ -66,6 +104,7 @@ void ospf_lsdb_cleanup(struct ospf_lsdb *lsdb)
 
 	for (i = OSPF_MIN_LSA; i < OSPF_MAX_LSA; i++)
 		route_table_finish(lsdb->type[i].db);
+	ospf_lsdb_hash_fini(lsdb->hash);
 }
 
 void ls_prefix_set(struct prefix_ls *lp, struct ospf_lsa *lsa)
@@ -82,12 +121,19 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 				   struct route_node *rn)
 {
 	struct ospf_lsa *lsa = rn->info;
+	struct ospf_lsdb_entry *entry;
 
 	if (!lsa)
 		return;
 
 	assert(rn->table == lsdb->type[lsa->data->type].db);
 
+	entry = ospf_lsdb_find(lsdb, lsa->data->type, lsa->data->id,
+			       lsa->data->adv_router);
+	assert(entry && entry->rn == rn);
+	ospf_lsdb_hash_del(lsdb->hash, entry);
+	XFREE(MTYPE_OSPF_LSDB_ENTRY, entry);
+
 	/* Update ORR Root table MPLS-TE Router address's advertise router */
 	if (lsa->data->type == OSPF_OPAQUE_AREA_LSA)
 		ospf_orr_root_table_update(lsa, false);
@@ -97,6 +143,7 @@ static void ospf_lsdb_delete_entry(struct ospf_lsdb *lsdb,
 	lsdb->type[lsa->data->type].count--;
 	lsdb->type[lsa->data->type].checksum -= ntohs(lsa->data->checksum);
 	lsdb->total--;
+	lsdb->generation++;
 	rn->info = NULL;
 	route_unlock_node(rn);
 #ifdef MONITOR_LSDB_CHANGE
@@ -113,25 +160,38 @@ void ospf_lsdb_add(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 	struct route_table *table;
 	struct prefix_ls lp;
 	struct route_node *rn;
+	struct ospf_lsdb_entry *entry;
 
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	rn = route_node_get(table, (struct prefix *)&lp);
+	entry = ospf_lsdb_find(lsdb, lsa->data->type, lsa->data->id,
+			       lsa->data->adv_router);
+	if (entry) {
+		rn = entry->rn;
 
-	/* nothing to do? */
-	if (rn->info && rn->info == lsa) {
-		route_unlock_node(rn);
-		return;
-	}
+		/* nothing to do? */
+		if (rn->info == lsa)
+			return;
 
-	/* purge old entry? */
-	if (rn->info)
+		/* purge old entry, keeping the node */
+		route_lock_node(rn);
 		ospf_lsdb_delete_entry(lsdb, rn);
+	} else {
+		table = lsdb->type[lsa->data->type].db;
+		ls_prefix_set(&lp, lsa);
+		rn = route_node_get(table, (struct prefix *)&lp);
+	}
+
+	entry = XMALLOC(MTYPE_OSPF_LSDB_ENTRY, sizeof(*entry));
+	entry->type = lsa->data->type;
+	entry->id = lsa->data->id;
+	entry->adv_router = lsa->data->adv_router;
+	entry->rn = rn;
+	ospf_lsdb_hash_add(lsdb->hash, entry);
 
 	if (IS_LSA_SELF(lsa))
 		lsdb->type[lsa->data->type].count_self++;
 	lsdb->type[lsa->data->type].count++;
 	lsdb->total++;
+	lsdb->generation++;
 
 #ifdef MONITOR_LSDB_CHANGE
 	if (lsdb->new_lsa_hook != NULL)
@@ -147,21 +207,16 @@ void ospf_lsdb_add(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 
 void ospf_lsdb_delete(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
-	struct route_node *rn;
+	struct ospf_lsdb_entry *entry;
 
 	if (!lsdb || !lsa)
 		return;
 
 	assert(lsa->data->type < OSPF_MAX_LSA);
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	if ((rn = route_node_lookup(table, (struct prefix *)&lp))) {
-		if (rn->info == lsa)
-			ospf_lsdb_delete_entry(lsdb, rn);
-		route_unlock_node(rn); /* route_node_lookup */
-	}
+	entry = ospf_lsdb_find(lsdb, lsa->data->type, lsa->data->id,
+			       lsa->data->adv_router);
+	if (entry && entry->rn->info == lsa)
+		ospf_lsdb_delete_entry(lsdb, entry->rn);
 }
 
 void ospf_lsdb_delete_all(struct ospf_lsdb *lsdb)
@@ -180,46 +235,18 @@ void ospf_lsdb_delete_all(struct ospf_lsdb *lsdb)
 
 struct ospf_lsa *ospf_lsdb_lookup(struct ospf_lsdb *lsdb, struct ospf_lsa *lsa)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
-	struct route_node *rn;
-	struct ospf_lsa *find;
-
-	table = lsdb->type[lsa->data->type].db;
-	ls_prefix_set(&lp, lsa);
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	return ospf_lsdb_lookup_by_id(lsdb, lsa->data->type, lsa->data->id,
+				      lsa->data->adv_router);
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id(struct ospf_lsdb *lsdb, uint8_t type,
 					struct in_addr id,
 					struct in_addr adv_router)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
-	struct route_node *rn;
-	struct ospf_lsa *find;
-
-	table = lsdb->type[type].db;
-
-	memset(&lp, 0, sizeof(lp));
-	lp.family = AF_UNSPEC;
-	lp.prefixlen = 64;
-	lp.id = id;
-	lp.adv_router = adv_router;
+	struct ospf_lsdb_entry *entry;
 
-	rn = route_node_lookup(table, (struct prefix *)&lp);
-	if (rn) {
-		find = rn->info;
-		route_unlock_node(rn);
-		return find;
-	}
-	return NULL;
+	entry = ospf_lsdb_find(lsdb, type, id, adv_router);
+	return entry ? entry->rn->info : NULL;
 }
 
 struct ospf_lsa *ospf_lsdb_lookup_by_id_next(struct ospf_lsdb *lsdb,
@@ -227,25 +254,17 @@ struct ospf_lsa *ospf_lsdb_lookup_by_id_next(struct ospf_lsdb *lsdb,
 					     struct in_addr adv_router,
 					     int first)
 {
-	struct route_table *table;
-	struct prefix_ls lp;
 	struct route_node *rn;
 	struct ospf_lsa *find;
-
-	table = lsdb->type[type].db;
-
-	memset(&lp, 0, sizeof(lp));
-	lp.family = AF_UNSPEC;
-	lp.prefixlen = 64;
-	lp.id = id;
-	lp.adv_router = adv_router;
+	struct ospf_lsdb_entry *entry;
 
 	if (first)
-		rn = route_top(table);
+		rn = route_top(lsdb->type[type].db);
 	else {
-		if ((rn = route_node_lookup(table, (struct prefix *)&lp))
-		    == NULL)
+		entry = ospf_lsdb_find(lsdb, type, id, adv_router);
+		if (!entry)
 			return NULL;
+		rn = route_lock_node(entry->rn);
 		rn = route_next(rn);
 	}
 
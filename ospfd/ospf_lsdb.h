@@ -22,6 +22,25 @@
 #ifndef _ZEBRA_OSPF_LSDB_H
 #define _ZEBRA_OSPF_LSDB_H
 
+#include "typesafe.h"
+
+PREDECL_HASH(ospf_lsdb_hash);
+
+/*
+ * Exact match index of the LSDB route tables.  An LSA may be in several
+ * LSDBs at once (area, retransmit and request lists), so this is a
+ * separate entry per LSDB rather than an item in struct ospf_lsa.
+ */
+struct ospf_lsdb_entry {
+	struct ospf_lsdb_hash_item hitem;
+
+	uint8_t type;
+	struct in_addr id;
+	struct in_addr adv_router;
+
+	struct route_node *rn;
+};
+
 /* OSPF LSDB structure. */
 struct ospf_lsdb {
 	struct {
@@ -31,6 +50,12 @@ struct ospf_lsdb {
 		struct route_table *db;
 	} type[OSPF_MAX_LSA];
 	unsigned long total;
+
+	/* Bumped on every change, to tell if anything derived is stale */
+	unsigned long generation;
+
+	/* (type, id, adv_router) -> node in type[].db, for lookups */
+	struct ospf_lsdb_hash_head hash[1];
 #define MONITOR_LSDB_CHANGE 1 /* XXX */
 #ifdef MONITOR_LSDB_CHANGE
 	/* Hooks for callback functions to catch every add/del event. */
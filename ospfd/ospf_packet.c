@@ -618,18 +618,137 @@ static void ospf_write_frags(int fd, struct ospf_packet *op, struct ip *iph,
 }
 #endif /* WANT_OSPF_WRITE_FRAGMENT */
 
-static void ospf_write(struct thread *thread)
-{
-	struct ospf *ospf = THREAD_ARG(thread);
+/*
+ * Packets handed to the kernel together by ospf_write(), with sendmmsg().
+ * At most write-multiplier packets are sent per call, which is capped at
+ * 100 by the CLI.
+ */
+#define OSPF_WRITE_BATCH_MAX 100
+
+struct ospf_write_msg {
 	struct ospf_interface *oi;
 	struct ospf_packet *op;
+	uint8_t type;
+
 	struct sockaddr_in sa_dst;
 	struct ip iph;
-	struct msghdr msg;
 	struct iovec iov[2];
-	uint8_t type;
+#ifdef GNU_LINUX
+	unsigned char cmsgbuf[64];
+#endif
+};
+
+static struct ospf_write_msg ospf_write_msgs[OSPF_WRITE_BATCH_MAX];
+static struct mmsghdr ospf_write_mmsgs[OSPF_WRITE_BATCH_MAX];
+
+/* Account for a packet sent (or not) and release it. */
+static void ospf_write_msg_done(struct ospf_write_msg *wm, bool sent,
+				int err)
+{
+	struct ospf_interface *oi = wm->oi;
+	struct ospf_packet *op = wm->op;
+	struct ip *iph = &wm->iph;
+	uint8_t type = wm->type;
+
+	sockopt_iphdrincl_swab_systoh(iph);
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug(
+			"%s to %pI4, id %d, off %d, len %d, interface %s, mtu %u:",
+			"ospf_write", &iph->ip_dst, iph->ip_id, iph->ip_off,
+			iph->ip_len, oi->ifp->name, oi->ifp->mtu);
+
+	/* sendmsg will return EPERM if firewall is blocking sending.
+	 * This is a normal situation when 'ip nhrp map multicast xxx'
+	 * is being used to send multicast packets to DMVPN peers. In
+	 * that case the original message is blocked with iptables rule
+	 * causing the EPERM result
+	 */
+	if (!sent && err != EPERM)
+		flog_err(
+			EC_LIB_SOCKET,
+			"*** sendmsg in %s failed to %pI4, id %d, off %d, len %d, interface %s, mtu %u: %s",
+			"ospf_write", &iph->ip_dst, iph->ip_id, iph->ip_off,
+			iph->ip_len, oi->ifp->name, oi->ifp->mtu,
+			safe_strerror(err));
+
+	/* Show debug sending packet. */
+	if (IS_DEBUG_OSPF_PACKET(type - 1, SEND)) {
+		if (IS_DEBUG_OSPF_PACKET(type - 1, DETAIL)) {
+			zlog_debug(
+				"-----------------------------------------------------");
+			stream_set_getp(op->s, 0);
+			ospf_packet_dump(op->s);
+		}
+
+		zlog_debug("%s sent to [%pI4] via [%s].",
+			   lookup_msg(ospf_packet_type_str, type, NULL),
+			   &op->dst, IF_NAME(oi));
+
+		if (IS_DEBUG_OSPF_PACKET(type - 1, DETAIL))
+			zlog_debug(
+				"-----------------------------------------------------");
+	}
+
+	switch (type) {
+	case OSPF_MSG_HELLO:
+		oi->hello_out++;
+		break;
+	case OSPF_MSG_DB_DESC:
+		oi->db_desc_out++;
+		break;
+	case OSPF_MSG_LS_REQ:
+		oi->ls_req_out++;
+		break;
+	case OSPF_MSG_LS_UPD:
+		oi->ls_upd_out++;
+		break;
+	case OSPF_MSG_LS_ACK:
+		oi->ls_ack_out++;
+		break;
+	default:
+		break;
+	}
+
+	ospf_packet_free(op);
+}
+
+static void ospf_write_flush(struct ospf *ospf, unsigned int count, int flags)
+{
+	unsigned int pos = 0, i;
 	int ret;
-	int flags = 0;
+
+	while (pos < count) {
+#if defined(HAVE_STRUCT_MMSGHDR_MSG_HDR) && defined(HAVE_SENDMMSG)
+		ret = sendmmsg(ospf->fd, &ospf_write_mmsgs[pos], count - pos,
+			       flags);
+#else
+		/* the fallback sendmmsg() does not pass on flags */
+		ret = sendmsg(ospf->fd, &ospf_write_mmsgs[pos].msg_hdr, flags);
+		if (ret >= 0)
+			ret = 1;
+#endif
+		if (ret <= 0) {
+			/* The first packet failed, skip past it */
+			ospf_write_msg_done(&ospf_write_msgs[pos], false, errno);
+			pos++;
+			continue;
+		}
+
+		for (i = pos; i < pos + ret; i++)
+			ospf_write_msg_done(&ospf_write_msgs[i], true, 0);
+		pos += ret;
+	}
+}
+
+static void ospf_write(struct thread *thread)
+{
+	struct ospf *ospf = THREAD_ARG(thread);
+	struct ospf_interface *oi;
+	struct ospf_packet *op;
+	struct ospf_write_msg *wm;
+	struct msghdr *msg;
+	unsigned int batch = 0;
+	int flags = 0, pkt_flags;
 	struct listnode *node;
 #ifdef WANT_OSPF_WRITE_FRAGMENT
 	static uint16_t ipid = 0;
@@ -639,8 +758,7 @@ static void ospf_write(struct thread *thread)
 	int pkt_count = 0;
 
 #ifdef GNU_LINUX
-	unsigned char cmsgbuf[64] = {};
-	struct cmsghdr *cm = (struct cmsghdr *)cmsgbuf;
+	struct cmsghdr *cm;
 	struct in_pktinfo *pi;
 #endif
 
@@ -672,6 +790,27 @@ static void ospf_write(struct thread *thread)
 		assert(op);
 		assert(op->length >= OSPF_HEADER_SIZE);
 
+		/* Set DONTROUTE flag if dst is unicast. */
+		pkt_flags = 0;
+		if (oi->type != OSPF_IFTYPE_VIRTUALLINK)
+			if (!IN_MULTICAST(htonl(op->dst.s_addr)))
+				pkt_flags = MSG_DONTROUTE;
+
+		/* One sendmmsg() call takes the same flags for all packets */
+		if (batch && pkt_flags != flags) {
+			ospf_write_flush(ospf, batch, flags);
+			batch = 0;
+		}
+		flags = pkt_flags;
+
+#ifdef WANT_OSPF_WRITE_FRAGMENT
+		/* Fragments are sent right away, keep the packets in order */
+		if (batch && op->length > maxdatasize) {
+			ospf_write_flush(ospf, batch, flags);
+			batch = 0;
+		}
+#endif /* WANT_OSPF_WRITE_FRAGMENT */
+
 		if (op->dst.s_addr == htonl(OSPF_ALLSPFROUTERS)
 		    || op->dst.s_addr == htonl(OSPF_ALLDROUTERS))
 			ospf_if_ipmulticast(ospf, oi->address,
@@ -680,46 +819,46 @@ static void ospf_write(struct thread *thread)
 		/* Rewrite the md5 signature & update the seq */
 		ospf_make_md5_digest(oi, op);
 
+		wm = &ospf_write_msgs[batch];
+		msg = &ospf_write_mmsgs[batch].msg_hdr;
+		memset(wm, 0, sizeof(*wm));
+		memset(msg, 0, sizeof(*msg));
+		wm->oi = oi;
+		wm->op = op;
+
 		/* Retrieve OSPF packet type. */
 		stream_set_getp(op->s, 1);
-		type = stream_getc(op->s);
+		wm->type = stream_getc(op->s);
 
 		/* reset get pointer */
 		stream_set_getp(op->s, 0);
 
-		memset(&iph, 0, sizeof(iph));
-		memset(&sa_dst, 0, sizeof(sa_dst));
-
-		sa_dst.sin_family = AF_INET;
+		wm->sa_dst.sin_family = AF_INET;
 #ifdef HAVE_STRUCT_SOCKADDR_IN_SIN_LEN
-		sa_dst.sin_len = sizeof(sa_dst);
+		wm->sa_dst.sin_len = sizeof(wm->sa_dst);
 #endif /* HAVE_STRUCT_SOCKADDR_IN_SIN_LEN */
-		sa_dst.sin_addr = op->dst;
-		sa_dst.sin_port = htons(0);
-
-		/* Set DONTROUTE flag if dst is unicast. */
-		if (oi->type != OSPF_IFTYPE_VIRTUALLINK)
-			if (!IN_MULTICAST(htonl(op->dst.s_addr)))
-				flags = MSG_DONTROUTE;
+		wm->sa_dst.sin_addr = op->dst;
+		wm->sa_dst.sin_port = htons(0);
 
-		iph.ip_hl = sizeof(struct ip) >> OSPF_WRITE_IPHL_SHIFT;
+		wm->iph.ip_hl = sizeof(struct ip) >> OSPF_WRITE_IPHL_SHIFT;
 		/* it'd be very strange for header to not be 4byte-word aligned
 		 * but.. */
 		if (sizeof(struct ip)
-		    > (unsigned int)(iph.ip_hl << OSPF_WRITE_IPHL_SHIFT))
-			iph.ip_hl++; /* we presume sizeof(struct ip) cant
-					overflow ip_hl.. */
+		    > (unsigned int)(wm->iph.ip_hl << OSPF_WRITE_IPHL_SHIFT))
+			wm->iph.ip_hl++; /* we presume sizeof(struct ip) cant
+					    overflow ip_hl.. */
 
-		iph.ip_v = IPVERSION;
-		iph.ip_tos = IPTOS_PREC_INTERNETCONTROL;
-		iph.ip_len = (iph.ip_hl << OSPF_WRITE_IPHL_SHIFT) + op->length;
+		wm->iph.ip_v = IPVERSION;
+		wm->iph.ip_tos = IPTOS_PREC_INTERNETCONTROL;
+		wm->iph.ip_len =
+			(wm->iph.ip_hl << OSPF_WRITE_IPHL_SHIFT) + op->length;
 
 #if defined(__DragonFly__)
 		/*
 		 * DragonFly's raw socket expects ip_len/ip_off in network byte
 		 * order.
 		 */
-		iph.ip_len = htons(iph.ip_len);
+		wm->iph.ip_len = htons(wm->iph.ip_len);
 #endif
 
 #ifdef WANT_OSPF_WRITE_FRAGMENT
@@ -728,39 +867,39 @@ static void ospf_write(struct thread *thread)
 		 * packets
 		 * otherwise, no guarantee ipid will be unique
 		 */
-		iph.ip_id = ++ipid;
+		wm->iph.ip_id = ++ipid;
 #endif /* WANT_OSPF_WRITE_FRAGMENT */
 
-		iph.ip_off = 0;
+		wm->iph.ip_off = 0;
 		if (oi->type == OSPF_IFTYPE_VIRTUALLINK)
-			iph.ip_ttl = OSPF_VL_IP_TTL;
+			wm->iph.ip_ttl = OSPF_VL_IP_TTL;
 		else
-			iph.ip_ttl = OSPF_IP_TTL;
-		iph.ip_p = IPPROTO_OSPFIGP;
-		iph.ip_sum = 0;
-		iph.ip_src.s_addr = oi->address->u.prefix4.s_addr;
-		iph.ip_dst.s_addr = op->dst.s_addr;
-
-		memset(&msg, 0, sizeof(msg));
-		msg.msg_name = (caddr_t)&sa_dst;
-		msg.msg_namelen = sizeof(sa_dst);
-		msg.msg_iov = iov;
-		msg.msg_iovlen = 2;
-
-		iov[0].iov_base = (char *)&iph;
-		iov[0].iov_len = iph.ip_hl << OSPF_WRITE_IPHL_SHIFT;
-		iov[1].iov_base = stream_pnt(op->s);
-		iov[1].iov_len = op->length;
+			wm->iph.ip_ttl = OSPF_IP_TTL;
+		wm->iph.ip_p = IPPROTO_OSPFIGP;
+		wm->iph.ip_sum = 0;
+		wm->iph.ip_src.s_addr = oi->address->u.prefix4.s_addr;
+		wm->iph.ip_dst.s_addr = op->dst.s_addr;
+
+		msg->msg_name = (caddr_t)&wm->sa_dst;
+		msg->msg_namelen = sizeof(wm->sa_dst);
+		msg->msg_iov = wm->iov;
+		msg->msg_iovlen = 2;
+
+		wm->iov[0].iov_base = (char *)&wm->iph;
+		wm->iov[0].iov_len = wm->iph.ip_hl << OSPF_WRITE_IPHL_SHIFT;
+		wm->iov[1].iov_base = stream_pnt(op->s);
+		wm->iov[1].iov_len = op->length;
 
 #ifdef GNU_LINUX
-		msg.msg_control = (caddr_t)cm;
+		cm = (struct cmsghdr *)wm->cmsgbuf;
+		msg->msg_control = (caddr_t)cm;
 		cm->cmsg_level = SOL_IP;
 		cm->cmsg_type = IP_PKTINFO;
 		cm->cmsg_len = CMSG_LEN(sizeof(struct in_pktinfo));
 		pi = (struct in_pktinfo *)CMSG_DATA(cm);
 		pi->ipi_ifindex = oi->ifp->ifindex;
 
-		msg.msg_controllen = cm->cmsg_len;
+		msg->msg_controllen = cm->cmsg_len;
 #endif
 
 /* Sadly we can not rely on kernels to fragment packets
@@ -770,74 +909,25 @@ static void ospf_write(struct thread *thread)
 
 #ifdef WANT_OSPF_WRITE_FRAGMENT
 		if (op->length > maxdatasize)
-			ospf_write_frags(ospf->fd, op, &iph, &msg, maxdatasize,
-					 oi->ifp->mtu, flags, type);
+			ospf_write_frags(ospf->fd, op, &wm->iph, msg,
+					 maxdatasize, oi->ifp->mtu, flags,
+					 wm->type);
 #endif /* WANT_OSPF_WRITE_FRAGMENT */
 
-		/* send final fragment (could be first) */
-		sockopt_iphdrincl_swab_htosys(&iph);
-		ret = sendmsg(ospf->fd, &msg, flags);
-		sockopt_iphdrincl_swab_systoh(&iph);
-		if (IS_DEBUG_OSPF_EVENT)
-			zlog_debug(
-				"%s to %pI4, id %d, off %d, len %d, interface %s, mtu %u:",
-				__func__, &iph.ip_dst, iph.ip_id, iph.ip_off,
-				iph.ip_len, oi->ifp->name, oi->ifp->mtu);
-
-		/* sendmsg will return EPERM if firewall is blocking sending.
-		 * This is a normal situation when 'ip nhrp map multicast xxx'
-		 * is being used to send multicast packets to DMVPN peers. In
-		 * that case the original message is blocked with iptables rule
-		 * causing the EPERM result
-		 */
-		if (ret < 0 && errno != EPERM)
-			flog_err(
-				EC_LIB_SOCKET,
-				"*** sendmsg in %s failed to %pI4, id %d, off %d, len %d, interface %s, mtu %u: %s",
-				__func__, &iph.ip_dst, iph.ip_id, iph.ip_off,
-				iph.ip_len, oi->ifp->name, oi->ifp->mtu,
-				safe_strerror(errno));
-
-		/* Show debug sending packet. */
-		if (IS_DEBUG_OSPF_PACKET(type - 1, SEND)) {
-			if (IS_DEBUG_OSPF_PACKET(type - 1, DETAIL)) {
-				zlog_debug(
-					"-----------------------------------------------------");
-				stream_set_getp(op->s, 0);
-				ospf_packet_dump(op->s);
-			}
-
-			zlog_debug("%s sent to [%pI4] via [%s].",
-				   lookup_msg(ospf_packet_type_str, type, NULL),
-				   &op->dst, IF_NAME(oi));
-
-			if (IS_DEBUG_OSPF_PACKET(type - 1, DETAIL))
-				zlog_debug(
-					"-----------------------------------------------------");
-		}
+		/* final fragment (could be first) is sent with the batch */
+		sockopt_iphdrincl_swab_htosys(&wm->iph);
+		batch++;
 
-		switch (type) {
-		case OSPF_MSG_HELLO:
-			oi->hello_out++;
-			break;
-		case OSPF_MSG_DB_DESC:
-			oi->db_desc_out++;
-			break;
-		case OSPF_MSG_LS_REQ:
-			oi->ls_req_out++;
-			break;
-		case OSPF_MSG_LS_UPD:
-			oi->ls_upd_out++;
-			break;
-		case OSPF_MSG_LS_ACK:
-			oi->ls_ack_out++;
-			break;
-		default:
-			break;
-		}
-
-		/* Now delete packet from queue. */
-		ospf_packet_delete(oi);
+		/*
+		 * Now delete packet from queue, it is freed once sent.  On
+		 * other systems than Linux the multicast interface is a
+		 * socket option set above, so send right away.
+		 */
+		ospf_fifo_pop(oi->obuf);
+#ifndef GNU_LINUX
+		ospf_write_flush(ospf, batch, flags);
+		batch = 0;
+#endif
 
 		/* Move this interface to the tail of write_q to
 		       serve everyone in a round robin fashion */
@@ -855,6 +945,9 @@ static void ospf_write(struct thread *thread)
 		}
 	}
 
+	if (batch)
+		ospf_write_flush(ospf, batch, flags);
+
 	/* If packets still remain in queue, call write thread. */
 	if (!list_isempty(ospf->oi_write_q))
 		thread_add_write(master, ospf_write, ospf, ospf->fd,
@@ -30,6 +30,7 @@
 #include "table.h"
 #include "log.h"
 #include "sockunion.h" /* for inet_ntop () */
+#include "frr_pthread.h"
 
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_interface.h"
@@ -64,6 +65,17 @@ static const struct vertex vertex_in_spftree = {};
 #define LSA_SPF_IN_SPFTREE	(struct vertex *)&vertex_in_spftree
 #define LSA_SPF_NOT_EXPLORED	NULL
 
+/*
+ * SPF triggers after which only the external routes depending on changed
+ * intra-AS routes need to be recalculated, rather than all of them.
+ */
+#define SPF_ASE_CHANGES_REASONS                                                \
+	((1 << SPF_FLAG_ROUTER_LSA_INSTALL)                                    \
+	 | (1 << SPF_FLAG_NETWORK_LSA_INSTALL)                                 \
+	 | (1 << SPF_FLAG_SUMMARY_LSA_INSTALL)                                 \
+	 | (1 << SPF_FLAG_ASBR_SUMMARY_LSA_INSTALL) | (1 << SPF_FLAG_MAXAGE)   \
+	 | (1 << SPF_FLAG_ROUTER_LSA_PREFIX))
+
 static void ospf_clear_spf_reason_flags(void)
 {
 	spf_reason_flags = 0;
@@ -95,7 +107,7 @@ static int vertex_cmp(const struct vertex *v1, const struct vertex *v2)
 	}
 	return 0;
 }
-DECLARE_SKIPLIST_NONUNIQ(vertex_pqueue, struct vertex, pqi, vertex_cmp);
+DECLARE_HEAP(vertex_pqueue, struct vertex, pqi, vertex_cmp);
 
 static void lsdb_clean_stat(struct ospf_lsdb *lsdb)
 {
@@ -228,10 +240,11 @@ static void ospf_vertex_free(void *data)
 {
 	struct vertex *v = data;
 
+	/* v->lsa may be gone already for the trees kept by TI-LFA */
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("%s: Free %s vertex %pI4", __func__,
 			   v->type == OSPF_VERTEX_ROUTER ? "Router" : "Network",
-			   &v->lsa->id);
+			   &v->id);
 
 	if (v->children)
 		list_delete(&v->children);
@@ -1707,12 +1720,145 @@ void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list)
 		list_delete(&vertex_list);
 }
 
+static int vertex_list_cmp(const void **a, const void **b)
+{
+	return vertex_cmp(*a, *b);
+}
+
+/*
+ * Keep the tree just calculated for the area, for partial route calculation
+ * later on.  The vertices hold on to their LSAs, which may be replaced in the
+ * LSDB in the meantime.  The vertex list is put in the order in which the
+ * vertices were added to the tree.
+ */
+void ospf_spf_tree_keep(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v))
+		ospf_lsa_lock(v->lsa_p);
+	list_sort(area->spf_vertex_list, vertex_list_cmp);
+
+	area->spf_last = area->spf;
+	area->spf_last_vertex_list = area->spf_vertex_list;
+	area->spf_last_dry_run = area->spf_dry_run;
+}
+
+/* Free the tree kept from the last full SPF run of the area, if any. */
+void ospf_spf_tree_free(struct ospf_area *area)
+{
+	struct list *vertex_list = area->spf_last_vertex_list;
+	struct ospf_lsa *lsa;
+	struct vertex *v;
+
+	if (!vertex_list)
+		return;
+
+	ospf_canonical_nexthops_free(area->spf_last);
+
+	while ((v = listnode_head(vertex_list)) != NULL) {
+		lsa = v->lsa_p;
+		listnode_delete(vertex_list, v);
+		ospf_vertex_free(v);
+		ospf_lsa_unlock(&lsa);
+	}
+	list_delete(&vertex_list);
+
+	area->spf_last = NULL;
+	area->spf_last_vertex_list = NULL;
+}
+
+/*
+ * Drop the trees kept for all areas, e.g. because the interfaces their
+ * nexthops point to are going away.  The next SPF run is a full one.
+ */
+void ospf_spf_tree_flush(struct ospf *ospf)
+{
+	struct listnode *node;
+	struct ospf_area *area;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		ospf_spf_tree_free(area);
+}
+
+/* Return the next non-stub link of a router-LSA, or NULL */
+static struct router_lsa_link *ospf_router_lsa_next_transit(uint8_t **p,
+							    uint8_t *lim)
+{
+	struct router_lsa_link *l;
+
+	while (*p + OSPF_ROUTER_LSA_LINK_SIZE <= lim) {
+		l = (struct router_lsa_link *)*p;
+		*p += OSPF_ROUTER_LSA_LINK_SIZE
+		      + (l->m[0].tos_count * OSPF_ROUTER_LSA_TOS_SIZE);
+		if (*p > lim)
+			break;
+
+		if (l->m[0].type != LSA_LINK_TYPE_STUB)
+			return l;
+	}
+
+	return NULL;
+}
+
+/*
+ * Do two instances of a router-LSA differ in their stub links only?  If so,
+ * the shortest-path tree is not affected by replacing one with the other,
+ * only the stub networks hanging off it are.
+ */
+bool ospf_router_lsa_same_topology(struct ospf_lsa *l1, struct ospf_lsa *l2)
+{
+	struct router_lsa *rl1 = (struct router_lsa *)l1->data;
+	struct router_lsa *rl2 = (struct router_lsa *)l2->data;
+	struct router_lsa_link *k1, *k2;
+	uint8_t *p1, *p2, *lim1, *lim2;
+
+	if (l1->data->type != OSPF_ROUTER_LSA
+	    || l2->data->type != OSPF_ROUTER_LSA)
+		return false;
+
+	if (IS_LSA_MAXAGE(l1) || IS_LSA_MAXAGE(l2))
+		return false;
+
+	if (l1->size < OSPF_LSA_HEADER_SIZE + 4
+	    || l2->size < OSPF_LSA_HEADER_SIZE + 4)
+		return false;
+
+	if (l1->data->options != l2->data->options || rl1->flags != rl2->flags)
+		return false;
+
+	p1 = ((uint8_t *)l1->data) + OSPF_LSA_HEADER_SIZE + 4;
+	lim1 = ((uint8_t *)l1->data) + ntohs(l1->data->length);
+	p2 = ((uint8_t *)l2->data) + OSPF_LSA_HEADER_SIZE + 4;
+	lim2 = ((uint8_t *)l2->data) + ntohs(l2->data->length);
+
+	for (;;) {
+		k1 = ospf_router_lsa_next_transit(&p1, lim1);
+		k2 = ospf_router_lsa_next_transit(&p2, lim2);
+		if (!k1 || !k2)
+			return k1 == k2;
+
+		if (k1->m[0].tos_count != k2->m[0].tos_count
+		    || memcmp(k1, k2,
+			      OSPF_ROUTER_LSA_LINK_SIZE
+				      + k1->m[0].tos_count
+						* OSPF_ROUTER_LSA_TOS_SIZE))
+			return false;
+	}
+}
+
 /* Calculating the shortest-path tree for an area, see RFC2328 16.1. */
-void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
-			struct route_table *new_table,
-			struct route_table *all_rtrs,
-			struct route_table *new_rtrs, bool is_dry_run,
-			bool is_root_node)
+/*
+ * Build the shortest-path tree of the area (RFC2328 16.1. (1) - (3) and
+ * (5)), appending the vertices to order as they are added to the tree.
+ * This only touches the area's LSDB and tree, so the trees of different
+ * areas can be built concurrently.
+ */
+static void ospf_spf_calculate_tree(struct ospf_area *area,
+				    struct ospf_lsa *root_lsa,
+				    struct list *order, bool is_dry_run,
+				    bool is_root_node)
 {
 	struct vertex_pqueue_head candidate;
 	struct vertex *v;
@@ -1722,19 +1868,6 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			   __func__, &area->area_id);
 	}
 
-	/*
-	 * If the router LSA of the root is not yet allocated, return this
-	 * area's calculation. In the 'usual' case the root_lsa is the
-	 * self-originated router LSA of the node itself.
-	 */
-	if (!root_lsa) {
-		if (IS_DEBUG_OSPF_EVENT)
-			zlog_debug(
-				"%s: Skip area %pI4's calculation due to empty root LSA",
-				__func__, &area->area_id);
-		return;
-	}
-
 	/* Initialize the algorithm's data structures, see RFC2328 16.1. (1). */
 
 	/*
@@ -1777,6 +1910,29 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 
 		ospf_vertex_add_parent(v);
 
+		listnode_add(order, v);
+
+		/* Iterate back to (2), see RFC2328 16.1. (5). */
+	}
+
+	vertex_pqueue_fini(&candidate);
+}
+
+/*
+ * Add the routes to the transit networks and routers of the tree built by
+ * ospf_spf_calculate_tree(), in the order the vertices were added to it,
+ * and the stub networks.
+ */
+static void ospf_spf_calculate_routes(struct ospf_area *area,
+				      struct list *order,
+				      struct route_table *new_table,
+				      struct route_table *all_rtrs,
+				      struct route_table *new_rtrs)
+{
+	struct listnode *node;
+	struct vertex *v;
+
+	for (ALL_LIST_ELEMENTS_RO(order, node, v)) {
 		/* RFC2328 16.1. (4). */
 		if (v->type != OSPF_VERTEX_ROUTER)
 			ospf_intra_add_transit(new_table, v, area);
@@ -1785,8 +1941,6 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			if (all_rtrs)
 				ospf_intra_add_router(all_rtrs, v, area, true);
 		}
-
-		/* Iterate back to (2), see RFC2328 16.1. (5). */
 	}
 
 	if (IS_DEBUG_OSPF_EVENT) {
@@ -1815,22 +1969,183 @@ void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
 			   mtype_stats_alloc(MTYPE_OSPF_VERTEX));
 }
 
+void ospf_spf_calculate(struct ospf_area *area, struct ospf_lsa *root_lsa,
+			struct route_table *new_table,
+			struct route_table *all_rtrs,
+			struct route_table *new_rtrs, bool is_dry_run,
+			bool is_root_node)
+{
+	struct list *order;
+
+	/*
+	 * If the router LSA of the root is not yet allocated, return this
+	 * area's calculation. In the 'usual' case the root_lsa is the
+	 * self-originated router LSA of the node itself.
+	 */
+	if (!root_lsa) {
+		if (IS_DEBUG_OSPF_EVENT)
+			zlog_debug(
+				"%s: Skip area %pI4's calculation due to empty root LSA",
+				__func__, &area->area_id);
+		return;
+	}
+
+	order = list_new();
+	ospf_spf_calculate_tree(area, root_lsa, order, is_dry_run,
+				is_root_node);
+	ospf_spf_calculate_routes(area, order, new_table, all_rtrs, new_rtrs);
+	list_delete(&order);
+}
+
+/* Second half of ospf_spf_calculate_area(), once the tree is built */
+static void ospf_spf_calculate_area_finish(struct ospf *ospf,
+					   struct ospf_area *area,
+					   struct route_table *new_table,
+					   struct route_table *all_rtrs,
+					   struct route_table *new_rtrs)
+{
+	/*
+	 * TI-LFA backup paths are calculated once the primary routes are
+	 * installed, from the tree kept here, unless they are already known.
+	 */
+	if (ospf->ti_lfa_enabled)
+		ospf_ti_lfa_compute_cached(area, new_table);
+	else
+		ospf_ti_lfa_flush(area);
+
+	if (area->spf)
+		ospf_spf_tree_keep(area);
+	else
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+}
+
 void ospf_spf_calculate_area(struct ospf *ospf, struct ospf_area *area,
 			     struct route_table *new_table,
 			     struct route_table *all_rtrs,
 			     struct route_table *new_rtrs)
 {
+	ospf_spf_tree_free(area);
+
 	ospf_spf_calculate(area, area->router_lsa_self, new_table, all_rtrs,
 			   new_rtrs, false, true);
 
-	if (ospf->ti_lfa_enabled)
-		ospf_ti_lfa_compute(area, new_table,
-				    ospf->ti_lfa_protection_type);
+	ospf_spf_calculate_area_finish(ospf, area, new_table, all_rtrs,
+				       new_rtrs);
+}
 
-	ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+/*
+ * The shortest-path trees of the areas other than the backbone don't
+ * depend on each other, and are built on a pool of worker pthreads.  Adding
+ * the routes, TI-LFA and the backbone, whose virtual links depend on the
+ * transit areas' routes, are done afterwards on the main pthread.
+ */
+#define OSPF_SPF_WORKERS_MAX 8
 
-	area->spf = NULL;
-	area->spf_vertex_list = NULL;
+static struct frr_pthread_pool *ospf_spf_pool;
+static bool ospf_spf_pool_tried;
+
+struct ospf_spf_job {
+	struct ospf_area *area;
+	struct list *order;
+};
+
+static void ospf_spf_job_run(void *arg)
+{
+	struct ospf_spf_job *job = arg;
+
+	ospf_spf_calculate_tree(job->area, job->area->router_lsa_self,
+				job->order, false, true);
+}
+
+static struct frr_pthread_pool *ospf_spf_pool_get(void)
+{
+	long nprocs;
+
+	if (!ospf_spf_pool_tried) {
+		ospf_spf_pool_tried = true;
+
+		nprocs = sysconf(_SC_NPROCESSORS_ONLN);
+		if (nprocs > 1)
+			ospf_spf_pool = frr_pthread_pool_new(
+				"OSPF SPF", MIN(nprocs - 1,
+						OSPF_SPF_WORKERS_MAX));
+	}
+
+	return ospf_spf_pool;
+}
+
+void ospf_spf_pool_finish(void)
+{
+	frr_pthread_pool_free(&ospf_spf_pool);
+}
+
+static bool ospf_spf_calculate_areas_parallel(struct ospf *ospf,
+					      struct route_table *new_table,
+					      struct route_table *all_rtrs,
+					      struct route_table *new_rtrs)
+{
+	struct frr_pthread_pool *pool;
+	struct ospf_spf_job *jobs;
+	struct ospf_area *area;
+	struct listnode *node;
+	unsigned int count = 0, i;
+	void **args;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (area != ospf->backbone && area->router_lsa_self)
+			count++;
+	if (count < 2)
+		return false;
+
+	pool = ospf_spf_pool_get();
+	if (!pool)
+		return false;
+
+	jobs = XCALLOC(MTYPE_TMP, count * sizeof(*jobs));
+	args = XCALLOC(MTYPE_TMP, count * sizeof(*args));
+
+	i = 0;
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (area == ospf->backbone || !area->router_lsa_self)
+			continue;
+
+		ospf_spf_tree_free(area);
+		jobs[i].area = area;
+		jobs[i].order = list_new();
+		args[i] = &jobs[i];
+		i++;
+	}
+
+	frr_pthread_pool_run(pool, ospf_spf_job_run, args, count);
+
+	/* Same order as the serial calculation */
+	i = 0;
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (area == ospf->backbone)
+			continue;
+
+		if (area->router_lsa_self) {
+			assert(jobs[i].area == area);
+			ospf_spf_calculate_routes(area, jobs[i].order,
+						  new_table, all_rtrs,
+						  new_rtrs);
+			list_delete(&jobs[i].order);
+			i++;
+		} else
+			/* nothing to calculate, just as serially */
+			ospf_spf_tree_free(area);
+
+		ospf_spf_calculate_area_finish(ospf, area, new_table, all_rtrs,
+					       new_rtrs);
+	}
+
+	XFREE(MTYPE_TMP, args);
+	XFREE(MTYPE_TMP, jobs);
+
+	return true;
 }
 
 void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
@@ -1841,15 +2156,18 @@ void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
 	struct listnode *node, *nnode;
 
 	/* Calculate SPF for each area. */
-	for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
-		/* Do backbone last, so as to first discover intra-area paths
-		 * for any back-bone virtual-links */
-		if (ospf->backbone && ospf->backbone == area)
-			continue;
+	if (!ospf_spf_calculate_areas_parallel(ospf, new_table, all_rtrs,
+					       new_rtrs))
+		for (ALL_LIST_ELEMENTS(ospf->areas, node, nnode, area)) {
+			/* Do backbone last, so as to first discover
+			 * intra-area paths for any back-bone virtual-links
+			 */
+			if (ospf->backbone && ospf->backbone == area)
+				continue;
 
-		ospf_spf_calculate_area(ospf, area, new_table, all_rtrs,
-					new_rtrs);
-	}
+			ospf_spf_calculate_area(ospf, area, new_table,
+						all_rtrs, new_rtrs);
+		}
 
 	/* SPF for backbone, if required */
 	if (ospf->backbone)
@@ -1857,6 +2175,149 @@ void ospf_spf_calculate_areas(struct ospf *ospf, struct route_table *new_table,
 					all_rtrs, new_rtrs);
 }
 
+/*
+ * Is the tree kept for the area still valid, i.e. does the LSDB hold an LSA
+ * for each of its vertices that differs from the one the tree was built
+ * from, if at all, in stub links only?  The own router-LSA must not change,
+ * as its stub links are used for nexthop calculation.
+ */
+static bool ospf_spf_tree_valid(struct ospf_area *area)
+{
+	struct listnode *node;
+	struct vertex *v;
+	struct ospf_lsa *lsa;
+
+	if (!area->spf_last || !area->router_lsa_self)
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(area->spf_last_vertex_list, node, v)) {
+		lsa = ospf_lsdb_lookup_by_id(area->lsdb, v->type, v->id,
+					     v->lsa->adv_router);
+		if (!lsa || IS_LSA_MAXAGE(lsa))
+			return false;
+		if (lsa == v->lsa_p)
+			continue;
+
+		if (v == area->spf_last) {
+			if (lsa != area->router_lsa_self
+			    || ospf_lsa_different(v->lsa_p, lsa, true))
+				return false;
+		} else if (v->type == OSPF_VERTEX_NETWORK) {
+			if (ospf_lsa_different(v->lsa_p, lsa, true))
+				return false;
+		} else if (!ospf_router_lsa_same_topology(v->lsa_p, lsa))
+			return false;
+	}
+
+	return true;
+}
+
+/*
+ * Partial route calculation for an area: the shortest-path tree is the one
+ * of the last full run, its vertices are moved to the current LSAs and the
+ * transit networks, routers and stub networks are added from there.
+ */
+static void ospf_spf_calculate_area_partial(struct ospf_area *area,
+					    struct route_table *new_table,
+					    struct route_table *all_rtrs,
+					    struct route_table *new_rtrs)
+{
+	struct listnode *node, *pnode;
+	struct vertex *v;
+	struct vertex_parent *vp;
+	struct ospf_lsa *lsa;
+
+	/* Move the vertices to the current instances of their LSAs */
+	for (ALL_LIST_ELEMENTS_RO(area->spf_last_vertex_list, node, v)) {
+		lsa = ospf_lsdb_lookup_by_id(area->lsdb, v->type, v->id,
+					     v->lsa->adv_router);
+		if (lsa == v->lsa_p)
+			continue;
+
+		ospf_lsa_unlock(&v->lsa_p);
+		v->lsa_p = ospf_lsa_lock(lsa);
+		v->lsa = lsa->data;
+	}
+
+	/* Stub links may have moved, so link indices need to be redone */
+	for (ALL_LIST_ELEMENTS_RO(area->spf_last_vertex_list, node, v))
+		for (ALL_LIST_ELEMENTS_RO(v->parents, pnode, vp))
+			vp->backlink = ospf_lsa_has_link(v->lsa,
+							 vp->parent->lsa);
+
+	area->spf = area->spf_last;
+	area->spf_vertex_list = area->spf_last_vertex_list;
+	area->spf_dry_run = area->spf_last_dry_run;
+	area->spf_root_node = !area->spf_last_dry_run;
+	area->abr_count = 0;
+	area->asbr_count = 0;
+	area->shortcut_capability = 1;
+
+	/* See RFC2328 16.1. (4), in the order of the full run */
+	for (ALL_LIST_ELEMENTS_RO(area->spf_vertex_list, node, v)) {
+		UNSET_FLAG(v->flags, OSPF_VERTEX_PROCESSED);
+		if (v == area->spf)
+			continue;
+
+		if (v->type != OSPF_VERTEX_ROUTER)
+			ospf_intra_add_transit(new_table, v, area);
+		else {
+			ospf_intra_add_router(new_rtrs, v, area, false);
+			if (all_rtrs)
+				ospf_intra_add_router(all_rtrs, v, area, true);
+		}
+	}
+
+	ospf_spf_process_stubs(area, area->spf, new_table, 0);
+
+	if (IS_DEBUG_OSPF_EVENT)
+		zlog_debug("%s: area %pI4, %u vertices", __func__,
+			   &area->area_id,
+			   listcount(area->spf_last_vertex_list));
+
+	monotime(&area->ospf->ts_spf);
+	area->ts_spf = area->ospf->ts_spf;
+
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+}
+
+/*
+ * Partial route calculation (PRC) for all areas, if only stub links changed
+ * since the last full SPF run.  Returns false, without touching the tables,
+ * if a full run is needed.
+ */
+bool ospf_spf_calculate_areas_partial(struct ospf *ospf,
+				      struct route_table *new_table,
+				      struct route_table *all_rtrs,
+				      struct route_table *new_rtrs)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	if (ospf->ti_lfa_enabled || !listcount(ospf->areas))
+		return false;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (!ospf_spf_tree_valid(area))
+			return false;
+
+	/* Same order as the full run, backbone last */
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (ospf->backbone && ospf->backbone == area)
+			continue;
+
+		ospf_spf_calculate_area_partial(area, new_table, all_rtrs,
+						new_rtrs);
+	}
+
+	if (ospf->backbone)
+		ospf_spf_calculate_area_partial(ospf->backbone, new_table,
+						all_rtrs, new_rtrs);
+
+	return true;
+}
+
 /* Print Reason for SPF calculation */
 static void ospf_spf_calculation_reason2str(char *rbuf, size_t len)
 {
@@ -1878,6 +2339,8 @@ static void ospf_spf_calculation_reason2str(char *rbuf, size_t len)
 			strlcat(rbuf, "M, ", len);
 		if (spf_reason_flags & (1 << SPF_FLAG_ORR_ROOT_CHANGE))
 			strlcat(rbuf, "ORR, ", len);
+		if (spf_reason_flags & (1 << SPF_FLAG_ROUTER_LSA_PREFIX))
+			strlcat(rbuf, "RP, ", len);
 
 		size_t rbuflen = strlen(rbuf);
 		if (rbuflen >= 2)
@@ -1897,6 +2360,7 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 	unsigned long ia_time, prune_time, rt_time;
 	unsigned long abr_time, total_spf_time, spf_time;
 	char rbuf[32]; /* reason_buf */
+	bool partial = false;
 
 	if (IS_DEBUG_OSPF_EVENT)
 		zlog_debug("SPF: Timer (SPF calculation expire)");
@@ -1914,7 +2378,13 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 	if (CHECK_FLAG(ospf->opaque, OPAQUE_OPERATION_READY_BIT))
 		all_rtrs = route_table_init();
 
-	ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
+	/* Stub link changes only, the trees of the last run still apply */
+	if (!ospf->spf_topo_changed)
+		partial = ospf_spf_calculate_areas_partial(ospf, new_table,
+							   all_rtrs, new_rtrs);
+	if (!partial)
+		ospf_spf_calculate_areas(ospf, new_table, all_rtrs, new_rtrs);
+	ospf->spf_topo_changed = false;
 	spf_time = monotime_since(&spf_start_time, NULL);
 
 	ospf_vl_shut_unapproved(ospf);
@@ -1939,7 +2409,9 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 	 * There is a dedicated routing table for external routes which is not
 	 * handled here directly
 	 */
-	ospf_ase_calculate_schedule(ospf);
+	if (spf_reason_flags & ~SPF_ASE_CHANGES_REASONS)
+		ospf_ase_calculate_schedule(ospf);
+	ospf_ase_spf_changes(ospf, new_table, new_rtrs);
 	ospf_ase_calculate_timer_add(ospf);
 
 	ospf_orr_spf_calculate_schedule(ospf);
@@ -1989,6 +2461,9 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 	/* Schedule Segment Routing update */
 	ospf_sr_update_task(ospf);
 
+	/* TI-LFA backup paths that weren't known yet */
+	ospf_ti_lfa_schedule(ospf);
+
 	total_spf_time =
 		monotime_since(&spf_start_time, &ospf->ts_spf_duration);
 
@@ -1996,7 +2471,8 @@ static void ospf_spf_calculate_schedule_worker(struct thread *thread)
 
 	if (IS_DEBUG_OSPF_EVENT) {
 		zlog_info("SPF Processing Time(usecs): %ld", total_spf_time);
-		zlog_info("            SPF Time: %ld", spf_time);
+		zlog_info("            SPF Time: %ld%s", spf_time,
+			  partial ? " (partial)" : "");
 		zlog_info("           InterArea: %ld", ia_time);
 		zlog_info("               Prune: %ld", prune_time);
 		zlog_info("        RouteInstall: %ld", rt_time);
@@ -2165,6 +2641,9 @@ void ospf_spf_calculate_schedule(struct ospf *ospf, ospf_spf_reason_t reason)
 
 	ospf_spf_set_reason(reason);
 
+	if (reason != SPF_FLAG_ROUTER_LSA_PREFIX)
+		ospf->spf_topo_changed = true;
+
 	/* SPF calculation timer is already scheduled. */
 	if (ospf->t_spf_calc) {
 		if (IS_DEBUG_OSPF_EVENT)
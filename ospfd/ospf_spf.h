@@ -33,7 +33,7 @@
 
 /* The "root" is the node running the SPF calculation */
 
-PREDECL_SKIPLIST_NONUNIQ(vertex_pqueue);
+PREDECL_HEAP(vertex_pqueue);
 /* A router or network in an area */
 struct vertex {
 	struct vertex_pqueue_item pqi;
@@ -71,6 +71,7 @@ typedef enum {
 	SPF_FLAG_CONFIG_CHANGE,
 	SPF_FLAG_GR_FINISH,
 	SPF_FLAG_ORR_ROOT_CHANGE,
+	SPF_FLAG_ROUTER_LSA_PREFIX,
 } ospf_spf_reason_t;
 
 extern unsigned int ospf_get_spf_reason_flags(void);
@@ -89,6 +90,16 @@ extern void ospf_spf_calculate_areas(struct ospf *ospf,
 				     struct route_table *new_table,
 				     struct route_table *all_rtrs,
 				     struct route_table *new_rtrs);
+extern void ospf_spf_pool_finish(void);
+extern bool ospf_spf_calculate_areas_partial(struct ospf *ospf,
+					     struct route_table *new_table,
+					     struct route_table *all_rtrs,
+					     struct route_table *new_rtrs);
+extern void ospf_spf_tree_keep(struct ospf_area *area);
+extern void ospf_spf_tree_free(struct ospf_area *area);
+extern void ospf_spf_tree_flush(struct ospf *ospf);
+extern bool ospf_router_lsa_same_topology(struct ospf_lsa *l1,
+					  struct ospf_lsa *l2);
 extern void ospf_rtrs_free(struct route_table *);
 extern void ospf_spf_cleanup(struct vertex *spf, struct list *vertex_list);
 extern void ospf_spf_copy(struct vertex *vertex, struct list *vertex_list);
@@ -1986,9 +1986,12 @@ void ospf_sr_update_task(struct ospf *ospf)
 
 	osr_debug("SR (%s): Start SPF update", __func__);
 
+	/* All Prefix-SID labels go out to zebra as one batch of writes */
+	zclient_batch_start(zclient);
 	hash_iterate(OspfSR.neighbors, (void (*)(struct hash_bucket *,
 						 void *))ospf_sr_nhlfe_update,
 		     NULL);
+	zclient_batch_end(zclient);
 
 	monotime(&stop_time);
 
@@ -29,11 +29,13 @@
 #include "ospfd/ospfd.h"
 #include "ospfd/ospf_asbr.h"
 #include "ospfd/ospf_lsa.h"
+#include "ospfd/ospf_lsdb.h"
 #include "ospfd/ospf_spf.h"
 #include "ospfd/ospf_sr.h"
 #include "ospfd/ospf_route.h"
 #include "ospfd/ospf_ti_lfa.h"
 #include "ospfd/ospf_dump.h"
+#include "ospfd/ospf_zebra.h"
 
 
 DECLARE_RBTREE_UNIQ(p_spaces, struct p_space, p_spaces_item,
@@ -1074,6 +1076,9 @@ void ospf_ti_lfa_free_p_spaces(struct ospf_area *area)
 	struct p_space *p_space;
 	struct q_space *q_space;
 
+	if (!area->p_spaces)
+		return;
+
 	while ((p_space = p_spaces_pop(area->p_spaces))) {
 		while ((q_space = q_spaces_pop(p_space->q_spaces))) {
 			ospf_spf_cleanup(q_space->root, q_space->vertex_list);
@@ -1115,3 +1120,111 @@ void ospf_ti_lfa_compute(struct ospf_area *area, struct route_table *new_table,
 	/* Cleanup P spaces and related datastructures including Q spaces. */
 	ospf_ti_lfa_free_p_spaces(area);
 }
+
+/*
+ * The P/Q spaces of an area only depend on its LSDB, and are kept from one
+ * SPF run to the next until it changes.  Only the backup paths need to be
+ * inserted into the routing table again then, which is cheap enough to be
+ * done right away.  Otherwise the backup paths are calculated after the
+ * primary routes have been installed, see ospf_ti_lfa_schedule().
+ */
+void ospf_ti_lfa_flush(struct ospf_area *area)
+{
+	ospf_ti_lfa_free_p_spaces(area);
+	area->ti_lfa_pending = false;
+}
+
+bool ospf_ti_lfa_compute_cached(struct ospf_area *area,
+				struct route_table *new_table)
+{
+	struct ospf *ospf = area->ospf;
+
+	if (area->p_spaces
+	    && area->ti_lfa_lsdb_generation == area->lsdb->generation
+	    && area->ti_lfa_protection_type == ospf->ti_lfa_protection_type) {
+		ospf_ti_lfa_insert_backup_paths(area, new_table);
+		area->ti_lfa_pending = false;
+		return true;
+	}
+
+	ospf_ti_lfa_flush(area);
+
+	/* The P/Q spaces will be those of the LSDB the primary SPF used */
+	area->ti_lfa_lsdb_generation = area->lsdb->generation;
+	area->ti_lfa_protection_type = ospf->ti_lfa_protection_type;
+	area->ti_lfa_pending = true;
+	return false;
+}
+
+static void ospf_ti_lfa_calculate_worker(struct thread *thread)
+{
+	struct ospf *ospf = THREAD_ARG(thread);
+	struct ospf_area *area;
+	struct listnode *node;
+	struct route_node *rn;
+	struct ospf_route *or;
+	struct ospf_path *path;
+	struct timeval start_time;
+	bool done = false;
+
+	if (!ospf->ti_lfa_enabled || !ospf->new_table)
+		return;
+
+	monotime(&start_time);
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area)) {
+		if (!area->ti_lfa_pending)
+			continue;
+		area->ti_lfa_pending = false;
+
+		/* The tree kept from the primary SPF run */
+		if (!area->spf_last)
+			continue;
+
+		area->spf = area->spf_last;
+		area->spf_vertex_list = area->spf_last_vertex_list;
+
+		ospf_ti_lfa_generate_p_spaces(area,
+					      area->ti_lfa_protection_type);
+		ospf_ti_lfa_insert_backup_paths(area, ospf->new_table);
+
+		area->spf = NULL;
+		area->spf_vertex_list = NULL;
+		done = true;
+	}
+
+	if (!done)
+		return;
+
+	/* Update the routes which got a backup path */
+	for (rn = route_top(ospf->new_table); rn; rn = route_next(rn)) {
+		or = rn->info;
+		if (!or || or->type != OSPF_DESTINATION_NETWORK)
+			continue;
+
+		for (ALL_LIST_ELEMENTS_RO(or->paths, node, path))
+			if (path->srni.backup_label_stack)
+				break;
+		if (node)
+			ospf_zebra_add(ospf, (struct prefix_ipv4 *)&rn->p, or);
+	}
+
+	ospf_sr_update_task(ospf);
+
+	if (IS_DEBUG_OSPF_TI_LFA)
+		zlog_debug("%s: backup paths calculated in %ld usecs",
+			   __func__, (long)monotime_since(&start_time, NULL));
+}
+
+void ospf_ti_lfa_schedule(struct ospf *ospf)
+{
+	struct ospf_area *area;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(ospf->areas, node, area))
+		if (area->ti_lfa_pending) {
+			thread_add_event(master, ospf_ti_lfa_calculate_worker,
+					 ospf, 0, &ospf->t_ti_lfa_calc);
+			return;
+		}
+}
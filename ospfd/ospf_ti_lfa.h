@@ -29,6 +29,16 @@ extern void ospf_ti_lfa_compute(struct ospf_area *area,
 				struct route_table *new_table,
 				enum protection_type protection_type);
 
+/*
+ * Insert the backup paths from the P/Q spaces kept for the area if they are
+ * still valid, else mark the area for ospf_ti_lfa_schedule().
+ */
+extern bool ospf_ti_lfa_compute_cached(struct ospf_area *area,
+				       struct route_table *new_table);
+/* Calculate the backup paths of marked areas, after route installation */
+extern void ospf_ti_lfa_schedule(struct ospf *ospf);
+extern void ospf_ti_lfa_flush(struct ospf_area *area);
+
 /* unit testing */
 extern void ospf_ti_lfa_generate_p_spaces(struct ospf_area *area,
 					  enum protection_type protection_type);
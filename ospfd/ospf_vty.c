@@ -11382,6 +11382,55 @@ DEFUN (show_ip_ospf_instance_border_routers,
 	return show_ip_ospf_border_routers_common(vty, ospf, 0, NULL);
 }
 
+DEFPY (show_ip_ospf_refresher,
+       show_ip_ospf_refresher_cmd,
+       "show ip ospf [vrf NAME$vrf_name] refresher",
+       SHOW_STR
+       IP_STR
+       "OSPF information\n"
+       VRF_CMD_HELP_STR
+       "Self-originated LSA refresh queue\n")
+{
+	struct ospf *ospf;
+	unsigned long total = 0;
+	unsigned int count, current, i, slot;
+
+	if (vrf_name)
+		ospf = ospf_lookup_by_inst_name(0, vrf_name);
+	else
+		ospf = ospf_lookup_by_vrf_id(VRF_DEFAULT);
+	if (!ospf || !ospf->oi_running) {
+		vty_out(vty, "%% OSPF is not enabled in vrf %s\n",
+			vrf_name ? vrf_name : VRF_DEFAULT_NAME);
+		return CMD_SUCCESS;
+	}
+
+	current = (ospf->lsa_refresh_queue.index
+		   + (monotime(NULL) - ospf->lsa_refresher_started)
+			     / OSPF_LSA_REFRESHER_GRANULARITY)
+		  % OSPF_LSA_REFRESHER_SLOTS;
+
+	vty_out(vty, " Refresh walk every %us, LSAs refreshed after %us\n",
+		ospf->lsa_refresh_interval, ospf->lsa_refresh_timer);
+	vty_out(vty, "\n   Slot  Due(s)     LSAs\n");
+
+	/* in refresh order */
+	for (i = 0; i < OSPF_LSA_REFRESHER_SLOTS; i++) {
+		slot = (current + i) % OSPF_LSA_REFRESHER_SLOTS;
+		if (!ospf->lsa_refresh_queue.qs[slot])
+			continue;
+
+		count = listcount(ospf->lsa_refresh_queue.qs[slot]);
+		total += count;
+		vty_out(vty, " %6u  %6u  %7u\n", slot,
+			i * OSPF_LSA_REFRESHER_GRANULARITY, count);
+	}
+
+	vty_out(vty, "\n Total %lu LSAs queued\n", total);
+
+	return CMD_SUCCESS;
+}
+
 static int show_ip_ospf_route_common(struct vty *vty, struct ospf *ospf,
 				     json_object *json, uint8_t use_vrf)
 {
@@ -12872,6 +12921,7 @@ void ospf_vty_show_init(void)
 	/* "show ip ospf route" commands. */
 	install_element(VIEW_NODE, &show_ip_ospf_route_cmd);
 	install_element(VIEW_NODE, &show_ip_ospf_border_routers_cmd);
+	install_element(VIEW_NODE, &show_ip_ospf_refresher_cmd);
 	install_element(VIEW_NODE, &show_ip_ospf_reachable_routers_cmd);
 	install_element(VIEW_NODE, &show_ip_ospf_route_orr_cmd);
 
@@ -1279,7 +1279,8 @@ int ospf_zebra_gr_disable(struct ospf *ospf)
 /* Zebra route add and delete treatment. */
 static int ospf_zebra_read_route(ZAPI_CALLBACK_ARGS)
 {
-	struct zapi_route api;
+	struct zapi_route_view api;
+	struct zapi_nexthop api_nh = {};
 	struct prefix_ipv4 p;
 	struct prefix pgen;
 	unsigned long ifindex;
@@ -1293,11 +1294,13 @@ static int ospf_zebra_read_route(ZAPI_CALLBACK_ARGS)
 	if (ospf == NULL)
 		return 0;
 
-	if (zapi_route_decode(zclient->ibuf, &api) < 0)
+	if (zapi_route_view_decode(zclient->ibuf, &api) < 0)
 		return -1;
 
-	ifindex = api.nexthops[0].ifindex;
-	nexthop = api.nexthops[0].gate.ipv4;
+	/* only the first nexthop is used */
+	zapi_route_view_nexthop(&api, &api_nh);
+	ifindex = api_nh.ifindex;
+	nexthop = api_nh.gate.ipv4;
 	rt_type = api.type;
 
 	memcpy(&p, &api.prefix, sizeof(p));
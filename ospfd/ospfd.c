@@ -52,6 +52,7 @@
 #include "ospfd/ospf_neighbor.h"
 #include "ospfd/ospf_nsm.h"
 #include "ospfd/ospf_spf.h"
+#include "ospfd/ospf_ti_lfa.h"
 #include "ospfd/ospf_packet.h"
 #include "ospfd/ospf_dump.h"
 #include "ospfd/ospf_route.h"
@@ -601,6 +602,7 @@ static void ospf_deferred_shutdown_finish(struct ospf *ospf)
 	/* ospfd being shut-down? If so, was this the last ospf instance? */
 	if (CHECK_FLAG(om->options, OSPF_MASTER_SHUTDOWN)
 	    && (listcount(om->ospf) == 0)) {
+		ospf_spf_pool_finish();
 		frr_fini();
 		exit(0);
 	}
@@ -692,6 +694,7 @@ void ospf_terminate(void)
 	zclient_free(zclient);
 
 done:
+	ospf_spf_pool_finish();
 	frr_fini();
 }
 
@@ -815,6 +818,7 @@ static void ospf_finish_final(struct ospf *ospf)
 	THREAD_OFF(ospf->t_spf_calc);
 	THREAD_OFF(ospf->t_ase_calc);
 	THREAD_OFF(ospf->t_orr_calc);
+	THREAD_OFF(ospf->t_ti_lfa_calc);
 	THREAD_OFF(ospf->t_maxage);
 	THREAD_OFF(ospf->t_maxage_walker);
 	THREAD_OFF(ospf->t_abr_task);
@@ -865,6 +869,8 @@ static void ospf_finish_final(struct ospf *ospf)
 			ospf_route_delete(ospf, ospf->new_external_route);
 		ospf_route_table_free(ospf->new_external_route);
 	}
+	ospf_ase_finish(ospf);
+
 	if (ospf->old_external_route) {
 		if (!ospf->gr_info.prepare_in_progress)
 			ospf_route_delete(ospf, ospf->old_external_route);
@@ -1002,6 +1008,9 @@ static void ospf_area_free(struct ospf_area *area)
 {
 	ospf_opaque_type10_lsa_term(area);
 
+	ospf_spf_tree_free(area);
+	ospf_ti_lfa_flush(area);
+
 	/* Free LSDBs. */
 	ospf_area_lsdb_discard_delete(area);
 
@@ -209,6 +209,8 @@ struct ospf {
 	unsigned int spf_max_holdtime; /* SPF maximum-holdtime */
 	unsigned int
 		spf_hold_multiplier; /* Adaptive multiplier for hold time */
+	bool spf_topo_changed; /* Topology changed since the last SPF, a
+				  partial route calculation won't do */
 
 	int default_originate;	/* Default information originate. */
 #define DEFAULT_ORIGINATE_NONE		0
@@ -230,6 +232,12 @@ struct ospf {
 	/* Flags. */
 	int ase_calc;	/* ASE calculation flag. */
 
+	/* Destinations and ASBRs with changed routes since the last external
+	 * route calculation, if not a full one (see ospf_ase_spf_changes)
+	 */
+	struct route_table *ase_changed_nets;
+	struct route_table *ase_changed_asbrs;
+
 	struct list *opaque_lsa_self; /* Type-11 Opaque-LSAs */
 
 	/* Routing tables. */
@@ -264,6 +272,7 @@ struct ospf {
 	struct thread *t_spf_calc;	  /* SPF calculation timer. */
 	struct thread *t_ase_calc;	  /* ASE calculation timer. */
 	struct thread *t_orr_calc;	/* ORR calculation timer. */
+	struct thread *t_ti_lfa_calc;	/* TI-LFA backup paths calculation. */
 	struct thread
 		*t_opaque_lsa_self; /* Type-11 Opaque-LSAs origin event. */
 	struct thread *t_sr_update; /* Segment Routing update timer */
@@ -307,6 +316,8 @@ struct ospf {
 	((OSPF_LS_REFRESH_TIME + OSPF_LS_REFRESH_SHIFT)                        \
 		 / OSPF_LSA_REFRESHER_GRANULARITY                              \
 	 + 1)
+/* Slots with more LSAs than this are spread (ospf_refresher_register_lsa) */
+#define OSPF_LSA_REFRESHER_SLOT_BUSY 100
 	struct {
 		uint16_t index;
 		struct list *qs[OSPF_LSA_REFRESHER_SLOTS];
@@ -566,6 +577,11 @@ struct ospf_area {
 	struct vertex *spf;
 	struct list *spf_vertex_list;
 
+	/* Tree of the last full SPF run, kept for partial route calculation */
+	struct vertex *spf_last;
+	struct list *spf_last_vertex_list;
+	bool spf_last_dry_run;
+
 	bool spf_dry_run;   /* flag for checking if the SPF calculation is
 			       intended for the local RIB */
 	bool spf_root_node; /* flag for checking if the calculating node is the
@@ -577,6 +593,14 @@ struct ospf_area {
 	/* P/Q spaces for TI-LFA */
 	struct p_spaces_head *p_spaces;
 
+	/*
+	 * The P/Q spaces are kept until the LSDB changes, the backup paths of
+	 * a new SPF run are only (re)calculated off the SPF run if needed.
+	 */
+	unsigned long ti_lfa_lsdb_generation;
+	enum protection_type ti_lfa_protection_type;
+	bool ti_lfa_pending;
+
 	/* Threads. */
 	struct thread *t_stub_router;     /* Stub-router timer */
 	struct thread *t_opaque_lsa_self; /* Type-10 Opaque-LSAs origin. */
@@ -311,7 +311,7 @@ int path_pcep_config_initiate_path(struct path *path)
 				  __func__);
 			return ERROR_19_3;
 		}
-		srte_apply_changes();
+		srte_apply_policy_changes(candidate->policy, NULL);
 	} else {
 		assert(!IS_IPADDR_NONE(&path->nbkey.endpoint));
 
@@ -455,7 +455,7 @@ int path_pcep_config_update_path(struct path *path)
 	if (number_of_sid_clashed)
 		SET_FLAG(segment_list->flags, F_SEGMENT_LIST_SID_CONFLICT);
 	else
-		srte_apply_changes();
+		srte_apply_policy_changes(candidate->policy, segment_list);
 
 	return 0;
 }
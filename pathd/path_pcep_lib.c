@@ -328,6 +328,26 @@ struct pcep_message *pcep_lib_format_report(struct pcep_caps *caps,
 	return pcep_msg_create_report(objs);
 }
 
+/* Add the state report of the given path to a PCRpt message, a new message is
+ * created if report is NULL. RFC 8231 allows a PCRpt to carry a list of state
+ * reports, this is used to pack the reports of the initial synchronization */
+struct pcep_message *pcep_lib_append_report(struct pcep_message *report,
+					    struct pcep_caps *caps,
+					    struct path *path)
+{
+	double_linked_list *objs = pcep_lib_format_path(caps, path);
+	void *obj;
+
+	if (report == NULL)
+		return pcep_msg_create_report(objs);
+
+	while ((obj = dll_delete_first_node(objs)) != NULL)
+		dll_append(report->obj_list, obj);
+	dll_destroy(objs);
+
+	return report;
+}
+
 static struct pcep_object_rp *create_rp(uint32_t reqid)
 {
 	double_linked_list *rp_tlvs;
@@ -33,6 +33,9 @@ pcep_lib_connect(struct ipaddr *src_addr, int src_port, struct ipaddr *dst_addr,
 void pcep_lib_disconnect(pcep_session *sess);
 struct pcep_message *pcep_lib_format_report(struct pcep_caps *caps,
 					    struct path *path);
+struct pcep_message *pcep_lib_append_report(struct pcep_message *report,
+					    struct pcep_caps *caps,
+					    struct path *path);
 struct pcep_message *pcep_lib_format_request(struct pcep_caps *caps,
 					     struct path *path);
 struct pcep_message *pcep_lib_format_request_cancelled(uint32_t reqid);
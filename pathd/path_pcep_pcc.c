@@ -53,6 +53,9 @@
 #define OTHER_FAMILY_MAX_RETRIES 4
 #define MAX_ERROR_MSG_SIZE 256
 #define MAX_COMPREQ_TRIES 3
+/* Maximum number of state reports packed in a synchronization PCRpt, keeps
+ * the message well below the 64KB PCEP message size limit */
+#define SYNC_REPORT_BATCH 32
 
 pthread_mutex_t g_pcc_info_mtx = PTHREAD_MUTEX_INITIALIZER;
 
@@ -96,6 +99,9 @@ static void send_pcep_error(struct pcc_state *pcc_state,
 			    enum pcep_error_value error_value,
 			    struct path *trigger_path);
 static void send_report(struct pcc_state *pcc_state, struct path *path);
+static void queue_sync_report(struct pcc_state *pcc_state, struct path *path);
+static void flush_sync_report(struct pcc_state *pcc_state);
+static void discard_sync_report(struct pcc_state *pcc_state);
 static void send_comp_request(struct ctrl_state *ctrl_state,
 			      struct pcc_state *pcc_state,
 			      struct req_entry *req);
@@ -441,6 +447,7 @@ int pcep_pcc_disable(struct ctrl_state *ctrl_state, struct pcc_state *pcc_state)
 	case PCEP_PCC_OPERATING:
 		PCEP_DEBUG("%s Disconnecting PCC...", pcc_state->tag);
 		cancel_comp_requests(ctrl_state, pcc_state);
+		discard_sync_report(pcc_state);
 		pcep_lib_disconnect(pcc_state->sess);
 		/* No need to remove if any PCEs is connected */
 		if (get_pce_count_connected(ctrl_state->pcc) == 0) {
@@ -484,7 +491,10 @@ void pcep_pcc_sync_path(struct ctrl_state *ctrl_state,
 		if (filter_path(pcc_state, path)) {
 			PCEP_DEBUG("%s Synchronizing path %s", pcc_state->tag,
 				   path->name);
-			send_report(pcc_state, path);
+			if (path->is_synching)
+				queue_sync_report(pcc_state, path);
+			else
+				send_report(pcc_state, path);
 		} else {
 			PCEP_DEBUG(
 				"%s Skipping %s candidate path %s synchronization",
@@ -519,7 +529,9 @@ void pcep_pcc_sync_done(struct ctrl_state *ctrl_state,
 				      .is_delegated = false,
 				      .first_hop = NULL,
 				      .first_metric = NULL};
-		send_report(pcc_state, path);
+		/* The end of synchronization marker closes the last batch */
+		queue_sync_report(pcc_state, path);
+		flush_sync_report(pcc_state);
 		pcep_free_path(path);
 	}
 
@@ -1596,6 +1608,45 @@ void send_report(struct pcc_state *pcc_state, struct path *path)
 	send_pcep_message(pcc_state, report);
 }
 
+/* Same as send_report() but the report is added to the synchronization PCRpt
+ * being built, which is sent once SYNC_REPORT_BATCH reports are queued */
+void queue_sync_report(struct pcc_state *pcc_state, struct path *path)
+{
+	path->req_id = 0;
+	specialize_outgoing_path(pcc_state, path);
+	PCEP_DEBUG_PATH("%s Queuing path %s: %s", pcc_state->tag, path->name,
+			format_path(path));
+	pcc_state->sync_report = pcep_lib_append_report(
+		pcc_state->sync_report, &pcc_state->caps, path);
+	if (++pcc_state->sync_report_count >= SYNC_REPORT_BATCH)
+		flush_sync_report(pcc_state);
+}
+
+void flush_sync_report(struct pcc_state *pcc_state)
+{
+	if (pcc_state->sync_report == NULL)
+		return;
+
+	if (pcc_state->sess == NULL) {
+		discard_sync_report(pcc_state);
+		return;
+	}
+
+	PCEP_DEBUG("%s Sending %u synchronization reports", pcc_state->tag,
+		   pcc_state->sync_report_count);
+	send_pcep_message(pcc_state, pcc_state->sync_report);
+	pcc_state->sync_report = NULL;
+	pcc_state->sync_report_count = 0;
+}
+
+void discard_sync_report(struct pcc_state *pcc_state)
+{
+	if (pcc_state->sync_report != NULL)
+		pcep_msg_free_message(pcc_state->sync_report);
+	pcc_state->sync_report = NULL;
+	pcc_state->sync_report_count = 0;
+}
+
 /* Updates the path for the PCE, updating the delegation and creation flags */
 void specialize_outgoing_path(struct pcc_state *pcc_state, struct path *path)
 {
@@ -68,6 +68,8 @@ srte_candidate_metric_name(enum srte_candidate_metric_type type);
 static void srte_set_metric(struct srte_metric *metric, float value,
 			    bool required, bool is_bound, bool is_computed);
 static void srte_unset_metric(struct srte_metric *metric);
+static void srte_policy_commit(struct srte_policy *policy);
+static void srte_segment_list_commit(struct srte_segment_list *segment_list);
 
 
 /* Generate rb-tree of Segment List Segment instances. */
@@ -556,29 +558,56 @@ void srte_apply_changes(void)
 	struct srte_policy *policy, *safe_pol;
 	struct srte_segment_list *segment_list, *safe_sl;
 
-	RB_FOREACH_SAFE (policy, srte_policy_head, &srte_policies, safe_pol) {
-		if (CHECK_FLAG(policy->flags, F_POLICY_DELETED)) {
-			if (policy->status != SRTE_POLICY_STATUS_DOWN) {
-				policy->status = SRTE_POLICY_STATUS_DOWN;
-				srte_policy_status_log(policy);
-			}
-			srte_policy_del(policy);
-			continue;
-		}
-		srte_policy_apply_changes(policy);
-		UNSET_FLAG(policy->flags, F_POLICY_NEW);
-		UNSET_FLAG(policy->flags, F_POLICY_MODIFIED);
-	}
+	RB_FOREACH_SAFE (policy, srte_policy_head, &srte_policies, safe_pol)
+		srte_policy_commit(policy);
 
 	RB_FOREACH_SAFE (segment_list, srte_segment_list_head,
-			 &srte_segment_lists, safe_sl) {
-		if (CHECK_FLAG(segment_list->flags, F_SEGMENT_LIST_DELETED)) {
-			srte_segment_list_del(segment_list);
-			continue;
+			 &srte_segment_lists, safe_sl)
+		srte_segment_list_commit(segment_list);
+}
+
+/**
+ * Same as `void srte_apply_changes(void)` but only for the given policy and
+ * segment list.
+ *
+ * This is meant for the PCEP updates that only modify one candidate path
+ * and its segment list, so that installing a large number of them does not
+ * walk all the policies and segment lists for each one.
+ *
+ * @param policy The modified policy
+ * @param segment_list The modified segment list, may be NULL
+ */
+void srte_apply_policy_changes(struct srte_policy *policy,
+			       struct srte_segment_list *segment_list)
+{
+	srte_policy_commit(policy);
+	if (segment_list)
+		srte_segment_list_commit(segment_list);
+}
+
+static void srte_policy_commit(struct srte_policy *policy)
+{
+	if (CHECK_FLAG(policy->flags, F_POLICY_DELETED)) {
+		if (policy->status != SRTE_POLICY_STATUS_DOWN) {
+			policy->status = SRTE_POLICY_STATUS_DOWN;
+			srte_policy_status_log(policy);
 		}
-		UNSET_FLAG(segment_list->flags, F_SEGMENT_LIST_NEW);
-		UNSET_FLAG(segment_list->flags, F_SEGMENT_LIST_MODIFIED);
+		srte_policy_del(policy);
+		return;
+	}
+	srte_policy_apply_changes(policy);
+	UNSET_FLAG(policy->flags, F_POLICY_NEW);
+	UNSET_FLAG(policy->flags, F_POLICY_MODIFIED);
+}
+
+static void srte_segment_list_commit(struct srte_segment_list *segment_list)
+{
+	if (CHECK_FLAG(segment_list->flags, F_SEGMENT_LIST_DELETED)) {
+		srte_segment_list_del(segment_list);
+		return;
 	}
+	UNSET_FLAG(segment_list->flags, F_SEGMENT_LIST_NEW);
+	UNSET_FLAG(segment_list->flags, F_SEGMENT_LIST_MODIFIED);
 }
 
 /**
@@ -410,6 +410,8 @@ int srte_policy_update_ted_sid(void);
 void srte_policy_update_binding_sid(struct srte_policy *policy,
 				    uint32_t binding_sid);
 void srte_apply_changes(void);
+void srte_apply_policy_changes(struct srte_policy *policy,
+			       struct srte_segment_list *segment_list);
 void srte_clean_zebra(void);
 void srte_policy_apply_changes(struct srte_policy *policy);
 struct srte_candidate *srte_candidate_add(struct srte_policy *policy,
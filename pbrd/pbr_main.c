@@ -83,6 +83,7 @@ static void sigint(void)
 	zlog_notice("Terminating on signal");
 
 	pbr_vrf_terminate();
+	pbr_zebra_terminate();
 
 	frr_fini();
 
@@ -565,6 +565,37 @@ static void pbr_encode_pbr_map_sequence(struct stream *s,
 	stream_put(s, ifp->name, INTERFACE_NAMSIZ);
 }
 
+/*
+ * Rules changed while handling one event, e.g. a configuration change or an
+ * interface coming up, go to zebra as one zclient batch.  zclient merges the
+ * consecutive ZEBRA_RULE_ADD / ZEBRA_RULE_DELETE messages into ones carrying
+ * many rules, keeping their order.
+ */
+static struct thread *t_rule_batch;
+
+static void pbr_rule_batch_end(struct thread *thread)
+{
+	zclient_batch_end(zclient);
+}
+
+static void pbr_rule_batch(void)
+{
+	if (t_rule_batch)
+		return;
+
+	zclient_batch_start(zclient);
+	thread_add_event(master, pbr_rule_batch_end, NULL, 0, &t_rule_batch);
+}
+
+void pbr_zebra_terminate(void)
+{
+	if (!t_rule_batch)
+		return;
+
+	THREAD_OFF(t_rule_batch);
+	zclient_batch_end(zclient);
+}
+
 bool pbr_send_pbr_map(struct pbr_map_sequence *pbrms,
 		      struct pbr_map_interface *pmi, bool install, bool changed)
 {
@@ -590,6 +621,8 @@ bool pbr_send_pbr_map(struct pbr_map_sequence *pbrms,
 	if (!install && !is_installed)
 		return false;
 
+	pbr_rule_batch();
+
 	s = zclient->obuf;
 	stream_reset(s);
 
@@ -598,7 +631,7 @@ bool pbr_send_pbr_map(struct pbr_map_sequence *pbrms,
 			      VRF_DEFAULT);
 
 	/*
-	 * We are sending one item at a time at the moment
+	 * One rule per message, they are merged by the zclient batch
 	 */
 	stream_putl(s, 1);
 
@@ -27,6 +27,8 @@ struct pbr_interface {
 extern struct thread_master *master;
 
 extern void pbr_zebra_init(void);
+/* send any rules still batched */
+extern void pbr_zebra_terminate(void);
 
 extern void route_add(struct pbr_nexthop_group_cache *pnhgc,
 		      struct nexthop_group nhg, afi_t install_afi);
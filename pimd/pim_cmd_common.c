@@ -1911,9 +1911,7 @@ void pim_show_jp_agg_list(struct pim_instance *pim, struct vty *vty)
 	struct pim_interface *pim_ifp;
 	struct listnode *n_node;
 	struct pim_neighbor *neigh;
-	struct listnode *jag_node;
 	struct pim_jp_agg_group *jag;
-	struct listnode *js_node;
 	struct pim_jp_sources *js;
 	struct ttable *tt;
 	char *table;
@@ -1932,10 +1930,9 @@ void pim_show_jp_agg_list(struct pim_instance *pim, struct vty *vty)
 
 		for (ALL_LIST_ELEMENTS_RO(pim_ifp->pim_neighbor_list, n_node,
 					  neigh)) {
-			for (ALL_LIST_ELEMENTS_RO(neigh->upstream_jp_agg,
-						  jag_node, jag)) {
-				for (ALL_LIST_ELEMENTS_RO(jag->sources, js_node,
-							  js)) {
+			frr_each (pim_jp_agg_groups, neigh->upstream_jp_agg,
+				  jag) {
+				frr_each (pim_jp_agg_srcs, jag->sources, js) {
 					pim_show_jp_agg_helper(ifp, neigh,
 							       js->up,
 							       js->is_join, tt);
@@ -30,6 +30,7 @@
 
 #include "pim_igmp.h"
 #include "pim_upstream.h"
+#include "pim_jp_agg.h"
 #include "bfd.h"
 #include "pim_str.h"
 
@@ -55,7 +56,7 @@
 
 struct pim_iface_upstream_switch {
 	pim_addr address;
-	struct list *us;
+	struct pim_jp_agg_groups_head us[1];
 };
 
 enum pim_secondary_addr_flags {
@@ -81,7 +81,8 @@ static void pim_ifchannel_remove_children(struct pim_ifchannel *ch)
 	while (!list_isempty(ch->sources)) {
 		child = listnode_head(ch->sources);
 		child->parent = NULL;
-		listnode_delete(ch->sources, child);
+		child->parent_node = NULL;
+		list_delete_node(ch->sources, listhead(ch->sources));
 	}
 }
 
@@ -89,10 +90,12 @@ static void pim_ifchannel_remove_children(struct pim_ifchannel *ch)
  * A (*,G) or a (*,*) is being created
  * find all the children that would point
  * at us.
+ *
+ * Must be called once ch is in the interface tree: it is sorted by group
+ * first, with the (*,G) right before its (S,G)s.
  */
 static void pim_ifchannel_find_new_children(struct pim_ifchannel *ch)
 {
-	struct pim_interface *pim_ifp = ch->interface->info;
 	struct pim_ifchannel *child;
 
 	// Basic Sanity that we are not being silly
@@ -102,12 +105,17 @@ static void pim_ifchannel_find_new_children(struct pim_ifchannel *ch)
 	if (pim_addr_is_any(ch->sg.src) && pim_addr_is_any(ch->sg.grp))
 		return;
 
-	RB_FOREACH (child, pim_ifchannel_rb, &pim_ifp->ifchannel_rb) {
-		if (!pim_addr_is_any(ch->sg.grp) &&
-		    !pim_addr_cmp(child->sg.grp, ch->sg.grp) && (child != ch)) {
-			child->parent = ch;
-			listnode_add_sort(ch->sources, child);
-		}
+	if (pim_addr_is_any(ch->sg.grp))
+		return;
+
+	for (child = RB_NEXT(pim_ifchannel_rb, ch); child;
+	     child = RB_NEXT(pim_ifchannel_rb, child)) {
+		if (pim_addr_cmp(child->sg.grp, ch->sg.grp))
+			break;
+
+		child->parent = ch;
+		/* Walked in order, appending keeps the list sorted */
+		child->parent_node = listnode_add(ch->sources, child);
 	}
 }
 
@@ -211,8 +219,10 @@ void pim_ifchannel_delete(struct pim_ifchannel *ch)
 	THREAD_OFF(ch->t_ifassert_timer);
 
 	if (ch->parent) {
-		listnode_delete(ch->parent->sources, ch);
+		if (ch->parent_node)
+			list_delete_node(ch->parent->sources, ch->parent_node);
 		ch->parent = NULL;
+		ch->parent_node = NULL;
 	}
 
 	RB_REMOVE(pim_ifchannel_rb, &pim_ifp->ifchannel_rb, ch);
@@ -517,7 +527,7 @@ static struct pim_ifchannel *pim_ifchannel_find_parent(struct pim_ifchannel *ch)
 		parent = pim_ifchannel_find(ch->interface, &parent_sg);
 
 		if (parent)
-			listnode_add(parent->sources, ch);
+			ch->parent_node = listnode_add(parent->sources, ch);
 		return parent;
 	}
 
@@ -564,7 +574,6 @@ struct pim_ifchannel *pim_ifchannel_add(struct interface *ifp, pim_sgaddr *sg,
 	} else
 		ch->sources = NULL;
 
-	pim_ifchannel_find_new_children(ch);
 	ch->local_ifmembership = PIM_IFMEMBERSHIP_NOINFO;
 
 	ch->ifjoin_state = PIM_IFJOIN_NOINFO;
@@ -573,6 +582,7 @@ struct pim_ifchannel *pim_ifchannel_add(struct interface *ifp, pim_sgaddr *sg,
 	ch->ifjoin_creation = 0;
 
 	RB_INSERT(pim_ifchannel_rb, &pim_ifp->ifchannel_rb, ch);
+	pim_ifchannel_find_new_children(ch);
 
 	up = pim_upstream_add(pim_ifp->pim, sg, NULL, up_flags, __func__, ch);
 
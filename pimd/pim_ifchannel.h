@@ -88,6 +88,8 @@ struct pim_ifchannel {
 	RB_ENTRY(rb_ifchannel) pim_ifp_rb;
 
 	struct pim_ifchannel *parent;
+	/* Our node in parent->sources */
+	struct listnode *parent_node;
 	struct list *sources;
 	pim_sgaddr sg;
 	char sg_str[PIM_SG_LEN];
@@ -1007,6 +1007,7 @@ void igmp_startup_mode_on(struct gm_sock *igmp)
 static void igmp_group_free(struct gm_group *group)
 {
 	list_delete(&group->group_source_list);
+	gm_source_hash_fini(group->group_source_hash);
 
 	XFREE(MTYPE_PIM_IGMP_GROUP, group);
 }
@@ -1444,6 +1445,7 @@ struct gm_group *igmp_add_group_by_addr(struct gm_sock *igmp,
 
 	group->group_source_list = list_new();
 	group->group_source_list->del = (void (*)(void *))igmp_source_free;
+	gm_source_hash_init(group->group_source_hash);
 
 	group->t_group_timer = NULL;
 	group->t_group_query_retransmit_timer = NULL;
@@ -392,6 +392,7 @@ void igmp_source_delete(struct gm_source *source)
 	  called by list_delete_all_node()
 	*/
 	listnode_delete(group->group_source_list, source);
+	gm_source_hash_del(group->group_source_hash, source);
 
 	src.s_addr = source->source_addr.s_addr;
 	igmp_source_free(source);
@@ -430,14 +431,10 @@ void igmp_source_delete_expired(struct list *source_list)
 struct gm_source *igmp_find_source_by_addr(struct gm_group *group,
 					   struct in_addr src_addr)
 {
-	struct listnode *src_node;
-	struct gm_source *src;
+	struct gm_source ref;
 
-	for (ALL_LIST_ELEMENTS_RO(group->group_source_list, src_node, src))
-		if (src_addr.s_addr == src->source_addr.s_addr)
-			return src;
-
-	return 0;
+	ref.source_addr = src_addr;
+	return gm_source_hash_find(group->group_source_hash, &ref);
 }
 
 struct gm_source *igmp_get_source_by_addr(struct gm_group *group,
@@ -478,6 +475,7 @@ struct gm_source *igmp_get_source_by_addr(struct gm_group *group,
 	src->source_channel_oil = NULL;
 
 	listnode_add(group->group_source_list, src);
+	gm_source_hash_add(group->group_source_hash, src);
 
 	/* Any source (*,G) is forwarded only if mode is EXCLUDE {empty} */
 	igmp_anysource_forward_stop(group);
@@ -77,6 +77,9 @@ enum pim_mlag_flags {
 	PIM_MLAGF_PEER_ZEBRA_UP = (1 << 4)
 };
 
+PREDECL_DLIST(pim_mlag_updq);
+PREDECL_HASH(pim_mlag_updh);
+
 struct pim_router {
 	struct thread_master *master;
 
@@ -103,8 +106,11 @@ struct pim_router {
 	 * with the peer MLAG process
 	 */
 	bool connected_to_mlag;
-	/* Holds the client data(unencoded) that need to be pushed to MCLAGD*/
-	struct stream_fifo *mlag_fifo;
+	/* Holds the client data(unencoded) that need to be pushed to MCLAGD,
+	 * at most one mroute add or del per (S,G)
+	 */
+	struct pim_mlag_updq_head mlag_updq;
+	struct pim_mlag_updh_head mlag_updh;
 	struct stream *mlag_stream;
 	struct thread *zpthread_mlag_write;
 	struct in_addr anycast_vtep_ip;
@@ -143,6 +149,10 @@ struct pim_instance {
 	int64_t mroute_del_events;
 	int64_t mroute_del_last;
 
+	/* Installed mroutes whose MFC update has been deferred */
+	struct pim_mfc_pending_head mfc_pending;
+	struct thread *t_mfc_pending;
+
 	struct interface *regiface;
 
 	// List of static routes;
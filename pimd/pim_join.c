@@ -440,13 +440,22 @@ int pim_joinprune_recv(struct interface *ifp, struct pim_neighbor *neigh,
  *  |        Pruned Source Address n (Encoded-Source format)        |
  *  +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
  */
-int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
+int pim_joinprune_send(struct pim_rpf *rpf,
+		       struct pim_jp_agg_groups_head *groups)
+{
+	struct pim_jp_agg_group *pos = pim_jp_agg_groups_first(groups);
+
+	return pim_joinprune_send_groups(rpf, groups, &pos, SIZE_MAX);
+}
+
+int pim_joinprune_send_groups(struct pim_rpf *rpf,
+			      struct pim_jp_agg_groups_head *groups,
+			      struct pim_jp_agg_group **pos, size_t max_groups)
 {
 	struct pim_jp_agg_group *group;
 	struct pim_interface *pim_ifp = NULL;
 	struct pim_jp_groups *grp = NULL;
 	struct pim_jp *msg = NULL;
-	struct listnode *node, *nnode;
 	uint8_t pim_msg[10000];
 	uint8_t *curr_ptr = pim_msg;
 	bool new_packet = true;
@@ -458,6 +467,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 		pim_ifp = rpf->source_nexthop.interface->info;
 	else {
 		zlog_warn("%s: RPF interface is not present", __func__);
+		*pos = NULL;
 		return -1;
 	}
 
@@ -467,6 +477,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 	if (!pim_ifp) {
 		zlog_warn("%s: multicast not enabled on interface %s", __func__,
 			  rpf->source_nexthop.interface->name);
+		*pos = NULL;
 		return -1;
 	}
 
@@ -476,6 +487,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 				"%s: upstream=%pPA is myself on interface %s",
 				__func__, &rpf->rpf_addr,
 				rpf->source_nexthop.interface->name);
+		*pos = NULL;
 		return 0;
 	}
 
@@ -490,7 +502,8 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 	*/
 	pim_hello_require(rpf->source_nexthop.interface);
 
-	for (ALL_LIST_ELEMENTS(groups, node, nnode, group)) {
+	for (group = *pos; group && max_groups;
+	     group = pim_jp_agg_groups_next(groups, group), max_groups--) {
 		if (new_packet) {
 			msg = (struct pim_jp *)pim_msg;
 
@@ -519,7 +532,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 				__func__, &group->group, &rpf->rpf_addr,
 				rpf->source_nexthop.interface->name);
 
-		group_size = pim_msg_get_jp_group_size(group->sources);
+		group_size = pim_msg_get_jp_group_size(group);
 		if (group_size > packet_left) {
 			pim_msg_build_header(pim_ifp->primary_address,
 					     qpim_all_pim_routers_addr, pim_msg,
@@ -614,5 +627,7 @@ int pim_joinprune_send(struct pim_rpf *rpf, struct list *groups)
 				__func__, rpf->source_nexthop.interface->name);
 		}
 	}
+
+	*pos = group;
 	return 0;
 }
@@ -29,6 +29,14 @@
 int pim_joinprune_recv(struct interface *ifp, struct pim_neighbor *neigh,
 		       pim_addr src_addr, uint8_t *tlv_buf, int tlv_buf_size);
 
-int pim_joinprune_send(struct pim_rpf *nexthop, struct list *groups);
+int pim_joinprune_send(struct pim_rpf *nexthop,
+		       struct pim_jp_agg_groups_head *groups);
+/*
+ * Send up to max_groups groups, starting with *pos.  On return *pos is the
+ * first group not sent yet, NULL once all of them went out.
+ */
+int pim_joinprune_send_groups(struct pim_rpf *nexthop,
+			      struct pim_jp_agg_groups_head *groups,
+			      struct pim_jp_agg_group **pos, size_t max_groups);
 
 #endif /* PIM_JOIN_H */
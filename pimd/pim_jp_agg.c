@@ -31,13 +31,6 @@
 #include "pim_join.h"
 #include "pim_iface.h"
 
-void pim_jp_agg_group_list_free(struct pim_jp_agg_group *jag)
-{
-	list_delete(&jag->sources);
-
-	XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
-}
-
 static void pim_jp_agg_src_free(struct pim_jp_sources *js)
 {
 	struct pim_upstream *up = js->up;
@@ -54,21 +47,15 @@ static void pim_jp_agg_src_free(struct pim_jp_sources *js)
 	XFREE(MTYPE_PIM_JP_AGG_SOURCE, js);
 }
 
-int pim_jp_agg_group_list_cmp(void *arg1, void *arg2)
+int pim_jp_agg_group_cmp(const struct pim_jp_agg_group *jag1,
+			 const struct pim_jp_agg_group *jag2)
 {
-	const struct pim_jp_agg_group *jag1 =
-		(const struct pim_jp_agg_group *)arg1;
-	const struct pim_jp_agg_group *jag2 =
-		(const struct pim_jp_agg_group *)arg2;
-
 	return pim_addr_cmp(jag1->group, jag2->group);
 }
 
-static int pim_jp_agg_src_cmp(void *arg1, void *arg2)
+int pim_jp_agg_src_cmp(const struct pim_jp_sources *js1,
+		       const struct pim_jp_sources *js2)
 {
-	const struct pim_jp_sources *js1 = (const struct pim_jp_sources *)arg1;
-	const struct pim_jp_sources *js2 = (const struct pim_jp_sources *)arg2;
-
 	if (js1->is_join && !js2->is_join)
 		return -1;
 
@@ -78,27 +65,85 @@ static int pim_jp_agg_src_cmp(void *arg1, void *arg2)
 	return pim_addr_cmp(js1->up->sg.src, js2->up->sg.src);
 }
 
+static struct pim_jp_agg_group *
+pim_jp_agg_group_find(struct pim_jp_agg_groups_head *groups, pim_addr group)
+{
+	struct pim_jp_agg_group ref;
+
+	ref.group = group;
+	return pim_jp_agg_groups_find(groups, &ref);
+}
+
+/* An upstream is in a group once, either as a join or as a prune */
+static struct pim_jp_sources *pim_jp_agg_src_find(struct pim_jp_agg_group *jag,
+						  struct pim_upstream *up)
+{
+	struct pim_jp_sources ref;
+	struct pim_jp_sources *js;
+
+	ref.up = up;
+	ref.is_join = 1;
+	js = pim_jp_agg_srcs_find(jag->sources, &ref);
+	if (!js) {
+		ref.is_join = 0;
+		js = pim_jp_agg_srcs_find(jag->sources, &ref);
+	}
+
+	return (js && js->up == up) ? js : NULL;
+}
+
+static void pim_jp_agg_group_free(struct pim_jp_agg_group *jag)
+{
+	struct pim_jp_sources *js;
+
+	while ((js = pim_jp_agg_srcs_pop(jag->sources)))
+		pim_jp_agg_src_free(js);
+	pim_jp_agg_srcs_fini(jag->sources);
+
+	XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
+}
+
+void pim_jp_agg_groups_free(struct pim_jp_agg_groups_head *groups)
+{
+	struct pim_jp_agg_group *jag;
+
+	while ((jag = pim_jp_agg_groups_pop(groups)))
+		pim_jp_agg_group_free(jag);
+	pim_jp_agg_groups_fini(groups);
+}
+
+void pim_jp_agg_upstream_switch_free(struct pim_iface_upstream_switch *pius)
+{
+	pim_jp_agg_groups_free(pius->us);
+
+	XFREE(MTYPE_PIM_JP_AGG_GROUP, pius);
+}
+
+int pim_jp_agg_upstream_switch_cmp(void *arg1, void *arg2)
+{
+	const struct pim_iface_upstream_switch *pius1 = arg1;
+	const struct pim_iface_upstream_switch *pius2 = arg2;
+
+	return pim_addr_cmp(pius1->address, pius2->address);
+}
+
 /*
  * This function is used by scan_oil to clear
  * the created jp_agg_group created when
  * figuring out where to send prunes
  * and joins.
  */
-void pim_jp_agg_clear_group(struct list *group)
+void pim_jp_agg_clear_group(struct pim_jp_agg_groups_head *groups)
 {
-	struct listnode *gnode, *gnnode;
-	struct listnode *snode, *snnode;
 	struct pim_jp_agg_group *jag;
 	struct pim_jp_sources *js;
 
-	for (ALL_LIST_ELEMENTS(group, gnode, gnnode, jag)) {
-		for (ALL_LIST_ELEMENTS(jag->sources, snode, snnode, js)) {
-			listnode_delete(jag->sources, js);
+	while ((jag = pim_jp_agg_groups_pop(groups))) {
+		while ((js = pim_jp_agg_srcs_pop(jag->sources))) {
 			js->up = NULL;
 			XFREE(MTYPE_PIM_JP_AGG_SOURCE, js);
 		}
-		list_delete(&jag->sources);
-		listnode_delete(group, jag);
+		pim_jp_agg_srcs_fini(jag->sources);
 		XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
 	}
 }
@@ -130,32 +175,24 @@ pim_jp_agg_get_interface_upstream_switch_list(struct pim_rpf *rpf)
 		pius = XCALLOC(MTYPE_PIM_JP_AGG_GROUP,
 			       sizeof(struct pim_iface_upstream_switch));
 		pius->address = rpf->rpf_addr;
-		pius->us = list_new();
+		pim_jp_agg_groups_init(pius->us);
 		listnode_add_sort(pim_ifp->upstream_switch_list, pius);
 	}
 
 	return pius;
 }
 
-void pim_jp_agg_remove_group(struct list *group, struct pim_upstream *up,
-		struct pim_neighbor *nbr)
+void pim_jp_agg_remove_group(struct pim_jp_agg_groups_head *groups,
+			     struct pim_upstream *up, struct pim_neighbor *nbr)
 {
-	struct listnode *node, *nnode;
-	struct pim_jp_agg_group *jag = NULL;
-	struct pim_jp_sources *js = NULL;
-
-	for (ALL_LIST_ELEMENTS(group, node, nnode, jag)) {
-		if (!pim_addr_cmp(jag->group, up->sg.grp))
-			break;
-	}
+	struct pim_jp_agg_group *jag;
+	struct pim_jp_sources *js;
 
+	jag = pim_jp_agg_group_find(groups, up->sg.grp);
 	if (!jag)
 		return;
 
-	for (ALL_LIST_ELEMENTS(jag->sources, node, nnode, js)) {
-		if (js->up == up)
-			break;
-	}
+	js = pim_jp_agg_src_find(jag, up);
 
 	if (nbr) {
 		if (PIM_DEBUG_TRACE)
@@ -165,38 +202,28 @@ void pim_jp_agg_remove_group(struct list *group, struct pim_upstream *up,
 	}
 
 	if (js) {
+		pim_jp_agg_srcs_del(jag->sources, js);
 		js->up = NULL;
-		listnode_delete(jag->sources, js);
 		XFREE(MTYPE_PIM_JP_AGG_SOURCE, js);
 	}
 
-	if (jag->sources->count == 0) {
-		list_delete(&jag->sources);
-		listnode_delete(group, jag);
+	if (pim_jp_agg_srcs_count(jag->sources) == 0) {
+		pim_jp_agg_srcs_fini(jag->sources);
+		pim_jp_agg_groups_del(groups, jag);
 		XFREE(MTYPE_PIM_JP_AGG_GROUP, jag);
 	}
 }
 
-int pim_jp_agg_is_in_list(struct list *group, struct pim_upstream *up)
+int pim_jp_agg_is_in_list(struct pim_jp_agg_groups_head *groups,
+			  struct pim_upstream *up)
 {
-	struct listnode *node, *nnode;
-	struct pim_jp_agg_group *jag = NULL;
-	struct pim_jp_sources *js = NULL;
-
-	for (ALL_LIST_ELEMENTS(group, node, nnode, jag)) {
-		if (!pim_addr_cmp(jag->group, up->sg.grp))
-			break;
-	}
+	struct pim_jp_agg_group *jag;
 
+	jag = pim_jp_agg_group_find(groups, up->sg.grp);
 	if (!jag)
 		return 0;
 
-	for (ALL_LIST_ELEMENTS(jag->sources, node, nnode, js)) {
-		if (js->up == up)
-			return 1;
-	}
-
-	return 0;
+	return pim_jp_agg_src_find(jag, up) ? 1 : 0;
 }
 
 //#define PIM_JP_AGG_DEBUG 1
@@ -250,32 +277,22 @@ void pim_jp_agg_upstream_verification(struct pim_upstream *up, bool ignore)
 #endif
 }
 
-void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
-			  bool is_join, struct pim_neighbor *nbr)
+void pim_jp_agg_add_group(struct pim_jp_agg_groups_head *groups,
+			  struct pim_upstream *up, bool is_join,
+			  struct pim_neighbor *nbr)
 {
-	struct listnode *node, *nnode;
-	struct pim_jp_agg_group *jag = NULL;
+	struct pim_jp_agg_group *jag;
 	struct pim_jp_sources *js = NULL;
 
-	for (ALL_LIST_ELEMENTS(group, node, nnode, jag)) {
-		if (!pim_addr_cmp(jag->group, up->sg.grp))
-			break;
-	}
-
+	jag = pim_jp_agg_group_find(groups, up->sg.grp);
 	if (!jag) {
 		jag = XCALLOC(MTYPE_PIM_JP_AGG_GROUP,
 			      sizeof(struct pim_jp_agg_group));
 		jag->group = up->sg.grp;
-		jag->sources = list_new();
-		jag->sources->cmp = pim_jp_agg_src_cmp;
-		jag->sources->del = (void (*)(void *))pim_jp_agg_src_free;
-		listnode_add_sort(group, jag);
-	}
-
-	for (ALL_LIST_ELEMENTS(jag->sources, node, nnode, js)) {
-		if (js->up == up)
-			break;
-	}
+		pim_jp_agg_srcs_init(jag->sources);
+		pim_jp_agg_groups_add(groups, jag);
+	} else
+		js = pim_jp_agg_src_find(jag, up);
 
 	if (nbr) {
 		if (PIM_DEBUG_TRACE)
@@ -290,12 +307,12 @@ void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
 			     sizeof(struct pim_jp_sources));
 		js->up = up;
 		js->is_join = is_join;
-		listnode_add_sort(jag->sources, js);
+		pim_jp_agg_srcs_add(jag->sources, js);
 	} else {
 		if (js->is_join != is_join) {
-			listnode_delete(jag->sources, js);
+			pim_jp_agg_srcs_del(jag->sources, js);
 			js->is_join = is_join;
-			listnode_add_sort(jag->sources, js);
+			pim_jp_agg_srcs_add(jag->sources, js);
 		}
 	}
 }
@@ -336,7 +353,7 @@ void pim_jp_agg_switch_interface(struct pim_rpf *orpf, struct pim_rpf *nrpf,
 void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 				     struct pim_upstream *up, bool is_join)
 {
-	struct list groups, sources;
+	struct pim_jp_agg_groups_head groups;
 	struct pim_jp_agg_group jag;
 	struct pim_jp_sources js;
 
@@ -347,19 +364,20 @@ void pim_jp_agg_single_upstream_send(struct pim_rpf *rpf,
 		if_is_loopback(rpf->source_nexthop.interface))
 		return;
 
-	memset(&groups, 0, sizeof(groups));
-	memset(&sources, 0, sizeof(sources));
-	jag.sources = &sources;
-
-	listnode_add(&groups, &jag);
-	listnode_add(jag.sources, &js);
+	pim_jp_agg_groups_init(&groups);
+	pim_jp_agg_srcs_init(jag.sources);
 
 	jag.group = up->sg.grp;
 	js.up = up;
 	js.is_join = is_join;
 
+	pim_jp_agg_srcs_add(jag.sources, &js);
+	pim_jp_agg_groups_add(&groups, &jag);
+
 	pim_joinprune_send(rpf, &groups);
 
-	list_delete_all_node(jag.sources);
-	list_delete_all_node(&groups);
+	pim_jp_agg_srcs_del(jag.sources, &js);
+	pim_jp_agg_groups_del(&groups, &jag);
+	pim_jp_agg_srcs_fini(jag.sources);
+	pim_jp_agg_groups_fini(&groups);
 }
@@ -20,30 +20,57 @@
 #ifndef __PIM_JP_AGG_H__
 #define __PIM_JP_AGG_H__
 
+#include "typesafe.h"
+
 #include "pim_rpf.h"
 
+struct pim_iface_upstream_switch;
+
+PREDECL_RBTREE_UNIQ(pim_jp_agg_groups);
+PREDECL_RBTREE_UNIQ(pim_jp_agg_srcs);
+
 struct pim_jp_sources {
+	struct pim_jp_agg_srcs_item item;
+
 	struct pim_upstream *up;
 	int is_join;
 };
 
 struct pim_jp_agg_group {
+	struct pim_jp_agg_groups_item item;
+
 	pim_addr group;
-	struct list *sources;
+	/* Joins first, then prunes, each sorted by source */
+	struct pim_jp_agg_srcs_head sources[1];
 };
 
+extern int pim_jp_agg_group_cmp(const struct pim_jp_agg_group *jag1,
+				const struct pim_jp_agg_group *jag2);
+DECLARE_RBTREE_UNIQ(pim_jp_agg_groups, struct pim_jp_agg_group, item,
+		    pim_jp_agg_group_cmp);
+
+extern int pim_jp_agg_src_cmp(const struct pim_jp_sources *js1,
+			      const struct pim_jp_sources *js2);
+DECLARE_RBTREE_UNIQ(pim_jp_agg_srcs, struct pim_jp_sources, item,
+		    pim_jp_agg_src_cmp);
+
 void pim_jp_agg_upstream_verification(struct pim_upstream *up, bool ignore);
-int pim_jp_agg_is_in_list(struct list *group, struct pim_upstream *up);
+int pim_jp_agg_is_in_list(struct pim_jp_agg_groups_head *groups,
+			  struct pim_upstream *up);
+
+/* Free all groups, restarting the join timer of their upstreams */
+void pim_jp_agg_groups_free(struct pim_jp_agg_groups_head *groups);
 
-void pim_jp_agg_group_list_free(struct pim_jp_agg_group *jag);
-int pim_jp_agg_group_list_cmp(void *arg1, void *arg2);
+void pim_jp_agg_upstream_switch_free(struct pim_iface_upstream_switch *pius);
+int pim_jp_agg_upstream_switch_cmp(void *arg1, void *arg2);
 
-void pim_jp_agg_clear_group(struct list *group);
-void pim_jp_agg_remove_group(struct list *group, struct pim_upstream *up,
-		struct pim_neighbor *nbr);
+void pim_jp_agg_clear_group(struct pim_jp_agg_groups_head *groups);
+void pim_jp_agg_remove_group(struct pim_jp_agg_groups_head *groups,
+			     struct pim_upstream *up, struct pim_neighbor *nbr);
 
-void pim_jp_agg_add_group(struct list *group, struct pim_upstream *up,
-		bool is_join, struct pim_neighbor *nbr);
+void pim_jp_agg_add_group(struct pim_jp_agg_groups_head *groups,
+			  struct pim_upstream *up, bool is_join,
+			  struct pim_neighbor *nbr);
 
 void pim_jp_agg_switch_interface(struct pim_rpf *orpf, struct pim_rpf *nrpf,
 				 struct pim_upstream *up);
@@ -32,6 +32,35 @@ extern struct zclient *zclient;
 
 #define PIM_MLAG_METADATA_LEN 4
 
+DEFINE_MTYPE_STATIC(PIMD, PIM_MLAG_UPDATE, "PIM MLAG queued mroute update");
+
+struct pim_mlag_update {
+	struct pim_mlag_updq_item itm;
+	struct pim_mlag_updh_item hitm;
+
+	vrf_id_t vrf_id;
+	pim_sgaddr sg;
+	/* the encoded add or del */
+	struct stream *s;
+};
+
+static int pim_mlag_update_cmp(const struct pim_mlag_update *a,
+			       const struct pim_mlag_update *b)
+{
+	if (a->vrf_id != b->vrf_id)
+		return a->vrf_id < b->vrf_id ? -1 : 1;
+	return pim_sgaddr_cmp(a->sg, b->sg);
+}
+
+static uint32_t pim_mlag_update_hash(const struct pim_mlag_update *upd)
+{
+	return pim_sgaddr_hash(upd->sg, upd->vrf_id);
+}
+
+DECLARE_DLIST(pim_mlag_updq, struct pim_mlag_update, itm);
+DECLARE_HASH(pim_mlag_updh, struct pim_mlag_update, hitm, pim_mlag_update_cmp,
+	     pim_mlag_update_hash);
+
 /*********************ACtual Data processing *****************************/
 /* TBD: There can be duplicate updates to FIB***/
 #define PIM_MLAG_ADD_OIF_TO_OIL(ch, ch_oil)                                    \
@@ -412,6 +441,57 @@ static void pim_mlag_up_peer_del_all(void)
 	list_delete(&temp);
 }
 
+/*
+ * The MLAG peer only needs the last state of an (S,G).  An update for an
+ * (S,G) that still has one queued, e.g. while DF roles are re-evaluated or
+ * an entry flaps, replaces the queued one and keeps its place in the queue.
+ */
+static void pim_mlag_up_local_queue(struct pim_instance *pim,
+				    struct pim_upstream *up, struct stream *s)
+{
+	struct pim_mlag_update ref, *upd;
+
+	ref.vrf_id = pim->vrf->vrf_id;
+	ref.sg = up->sg;
+	upd = pim_mlag_updh_find(&router->mlag_updh, &ref);
+	if (upd) {
+		if (PIM_DEBUG_MLAG)
+			zlog_debug("local MLAG mroute %s:%s already queued",
+				   pim->vrf->name, up->sg_str);
+		stream_free(upd->s);
+		upd->s = s;
+		return;
+	}
+
+	upd = XCALLOC(MTYPE_PIM_MLAG_UPDATE, sizeof(*upd));
+	upd->vrf_id = ref.vrf_id;
+	upd->sg = up->sg;
+	upd->s = s;
+	pim_mlag_updq_add_tail(&router->mlag_updq, upd);
+	pim_mlag_updh_add(&router->mlag_updh, upd);
+	pim_mlag_signal_zpthread();
+}
+
+size_t pim_mlag_update_count(void)
+{
+	return pim_mlag_updq_count(&router->mlag_updq);
+}
+
+struct stream *pim_mlag_update_next(void)
+{
+	struct pim_mlag_update *upd;
+	struct stream *s;
+
+	upd = pim_mlag_updq_pop(&router->mlag_updq);
+	if (!upd)
+		return NULL;
+
+	pim_mlag_updh_del(&router->mlag_updh, upd);
+	s = upd->s;
+	XFREE(MTYPE_PIM_MLAG_UPDATE, upd);
+	return s;
+}
+
 /* Send upstream entry to the local MLAG daemon (which will subsequently
  * send it to the peer MLAG switch).
  */
@@ -449,8 +529,7 @@ static void pim_mlag_up_local_add_send(struct pim_instance *pim,
 	/* XXX - this field is a No-op for VXLAN*/
 	stream_put(s, NULL, INTERFACE_NAMSIZ);
 
-	stream_fifo_push_safe(router->mlag_fifo, s);
-	pim_mlag_signal_zpthread();
+	pim_mlag_up_local_queue(pim, up, s);
 }
 
 static void pim_mlag_up_local_del_send(struct pim_instance *pim,
@@ -482,9 +561,7 @@ static void pim_mlag_up_local_del_send(struct pim_instance *pim,
 	/* XXX - this field is a No-op for VXLAN */
 	stream_put(s, NULL, INTERFACE_NAMSIZ);
 
-	/* XXX - is this the the most optimal way to do things */
-	stream_fifo_push_safe(router->mlag_fifo, s);
-	pim_mlag_signal_zpthread();
+	pim_mlag_up_local_queue(pim, up, s);
 }
 
 
@@ -493,7 +570,6 @@ void pim_mlag_up_local_add(struct pim_instance *pim,
 		struct pim_upstream *up)
 {
 	pim_mlag_up_df_role_elect(pim, up);
-	/* XXX - need to add some dup checks here */
 	pim_mlag_up_local_add_send(pim, up);
 }
 
@@ -1081,10 +1157,14 @@ void pim_instance_mlag_terminate(struct pim_instance *pim)
 
 void pim_mlag_terminate(void)
 {
+	struct stream *s;
+
 	stream_free(router->mlag_stream);
 	router->mlag_stream = NULL;
-	stream_fifo_free(router->mlag_fifo);
-	router->mlag_fifo = NULL;
+	while ((s = pim_mlag_update_next()))
+		stream_free(s);
+	pim_mlag_updh_fini(&router->mlag_updh);
+	pim_mlag_updq_fini(&router->mlag_updq);
 }
 
 void pim_mlag_init(void)
@@ -1092,7 +1172,8 @@ void pim_mlag_init(void)
 	pim_mlag_param_reset();
 	router->pim_mlag_intf_cnt = 0;
 	router->connected_to_mlag = false;
-	router->mlag_fifo = stream_fifo_new();
+	pim_mlag_updq_init(&router->mlag_updq);
+	pim_mlag_updh_init(&router->mlag_updh);
 	router->zpthread_mlag_write = NULL;
 	router->mlag_stream = stream_new(MLAG_BUF_LIMIT);
 }
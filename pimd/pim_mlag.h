@@ -41,6 +41,9 @@ extern int pim_zebra_mlag_handle_msg(ZAPI_CALLBACK_ARGS);
 
 /* pm_zpthread.c */
 extern int pim_mlag_signal_zpthread(void);
+/* queued mroute updates, for the zebra write task */
+extern size_t pim_mlag_update_count(void);
+extern struct stream *pim_mlag_update_next(void);
 extern void pim_zpthread_init(void);
 extern void pim_zpthread_terminate(void);
 
@@ -1033,18 +1033,12 @@ static inline void pim_mroute_copy(struct channel_oil *out,
 	}
 }
 
-/* This function must not be called directly 0
- * use pim_upstream_mroute_add or pim_static_mroute_add instead
- */
-static int pim_mroute_add(struct channel_oil *c_oil, const char *name)
+static int pim_mroute_program(struct channel_oil *c_oil, const char *name)
 {
 	struct pim_instance *pim = c_oil->pim;
 	struct channel_oil tmp_oil[1] = { };
 	int err;
 
-	pim->mroute_add_last = pim_time_monotonic_sec();
-	++pim->mroute_add_events;
-
 	/* Copy the oil to a temporary structure to fixup (without need to
 	 * later restore) before sending the mroute add to the dataplane
 	 */
@@ -1058,6 +1052,12 @@ static int pim_mroute_add(struct channel_oil *c_oil, const char *name)
 		oil_if_set(tmp_oil, *oil_parent(c_oil), 1);
 	}
 
+	/* Nothing changed since the last update, skip the syscall */
+	if (c_oil->installed
+	    && !memcmp(&tmp_oil->oil, &c_oil->oil_programmed,
+		       sizeof(tmp_oil->oil)))
+		return 0;
+
 	/*
 	 * If we have an unresolved cache entry for the S,G
 	 * it is owned by the pimreg for the incoming IIF
@@ -1089,6 +1089,8 @@ static int pim_mroute_add(struct channel_oil *c_oil, const char *name)
 		return -2;
 	}
 
+	c_oil->oil_programmed = tmp_oil->oil;
+
 	if (PIM_DEBUG_MROUTE) {
 		char buf[1000];
 		zlog_debug("%s(%s), vrf %s Added Route: %s", __func__, name,
@@ -1104,6 +1106,47 @@ static int pim_mroute_add(struct channel_oil *c_oil, const char *name)
 	return 0;
 }
 
+static void pim_mroute_pending_cb(struct thread *t)
+{
+	struct pim_instance *pim = THREAD_ARG(t);
+	struct channel_oil *c_oil;
+
+	while ((c_oil = pim_mfc_pending_pop(&pim->mfc_pending)))
+		pim_mroute_program(c_oil, __func__);
+}
+
+/* This function must not be called directly 0
+ * use pim_upstream_mroute_add or pim_static_mroute_add instead
+ */
+static int pim_mroute_add(struct channel_oil *c_oil, const char *name)
+{
+	struct pim_instance *pim = c_oil->pim;
+
+	pim->mroute_add_last = pim_time_monotonic_sec();
+	++pim->mroute_add_events;
+
+	/*
+	 * Changes to an installed state machine entry tend to come in
+	 * bursts (e.g. one per OIF on an IGMP storm).  Queue them and
+	 * write the MFC once per (S,G) with the final OIL, from an event
+	 * run after the current burst.  New entries go out right away so
+	 * forwarding can start, and so do static mroutes, which report
+	 * failures back to the CLI.
+	 */
+	if (c_oil->installed && c_oil->up) {
+		if (!pim_mfc_pending_anywhere(c_oil))
+			pim_mfc_pending_add_tail(&pim->mfc_pending, c_oil);
+		thread_add_event(router->master, pim_mroute_pending_cb, pim, 0,
+				 &pim->t_mfc_pending);
+		return 0;
+	}
+
+	if (pim_mfc_pending_anywhere(c_oil))
+		pim_mfc_pending_del(&pim->mfc_pending, c_oil);
+
+	return pim_mroute_program(c_oil, name);
+}
+
 static int pim_upstream_get_mroute_iif(struct channel_oil *c_oil,
 		const char *name)
 {
@@ -1259,6 +1302,9 @@ int pim_mroute_del(struct channel_oil *c_oil, const char *name)
 		return -2;
 	}
 
+	if (pim_mfc_pending_anywhere(c_oil))
+		pim_mfc_pending_del(&pim->mfc_pending, c_oil);
+
 	err = setsockopt(pim->mroute_socket, PIM_IPPROTO, MRT_DEL_MFC,
 			 &c_oil->oil, sizeof(c_oil->oil));
 	if (err) {
@@ -1283,7 +1329,8 @@ int pim_mroute_del(struct channel_oil *c_oil, const char *name)
 	return 0;
 }
 
-void pim_mroute_update_counters(struct channel_oil *c_oil)
+static void pim_mroute_read_counters(struct channel_oil *c_oil,
+				     bool lastused)
 {
 	struct pim_instance *pim = c_oil->pim;
 	pim_sioc_sg_req sgreq;
@@ -1308,8 +1355,6 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 
 	memset(&sgreq, 0, sizeof(sgreq));
 
-	pim_zlookup_sg_statistics(c_oil);
-
 #if PIM_IPV == 4
 	sgreq.src = *oil_origin(c_oil);
 	sgreq.grp = *oil_mcastgrp(c_oil);
@@ -1333,5 +1378,27 @@ void pim_mroute_update_counters(struct channel_oil *c_oil)
 	c_oil->cc.pktcnt = sgreq.pktcnt;
 	c_oil->cc.bytecnt = sgreq.bytecnt;
 	c_oil->cc.wrong_if = sgreq.wrong_if;
-	return;
+
+	/*
+	 * lastused needs a synchronous round trip to zebra, which asks the
+	 * kernel in turn.  If packets went through since the previous
+	 * read, the entry was used within the last interval, which is all
+	 * the periodic checks want to know.
+	 */
+	if (!lastused && c_oil->cc.pktcnt != c_oil->cc.oldpktcnt) {
+		c_oil->cc.lastused = 0;
+		return;
+	}
+
+	pim_zlookup_sg_statistics(c_oil);
+}
+
+void pim_mroute_update_counters(struct channel_oil *c_oil)
+{
+	pim_mroute_read_counters(c_oil, true);
+}
+
+void pim_mroute_update_pkt_counters(struct channel_oil *c_oil)
+{
+	pim_mroute_read_counters(c_oil, false);
 }
@@ -167,6 +167,10 @@ void pim_static_mroute_iif_update(struct channel_oil *c_oil,
 int pim_mroute_del(struct channel_oil *c_oil, const char *name);
 
 void pim_mroute_update_counters(struct channel_oil *c_oil);
+/* Same, but leaves lastused at 0 when packets were forwarded since the
+ * previous read, without asking zebra.  For periodic activity checks.
+ */
+void pim_mroute_update_pkt_counters(struct channel_oil *c_oil);
 bool pim_mroute_allow_iif_in_oil(struct channel_oil *c_oil,
 		int oif_index);
 int pim_mroute_msg(struct pim_instance *pim, const char *buf, size_t buf_size,
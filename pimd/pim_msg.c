@@ -181,23 +181,24 @@ uint8_t *pim_msg_addr_encode_source(uint8_t *buf, pim_addr addr, uint8_t bits)
 }
 
 /*
- * For the given 'struct pim_jp_sources' list
+ * For the given group's 'struct pim_jp_sources'
  * determine the size_t it would take up.
  */
-size_t pim_msg_get_jp_group_size(struct list *sources)
+size_t pim_msg_get_jp_group_size(struct pim_jp_agg_group *jag)
 {
 	struct pim_jp_sources *js;
 	size_t size = 0;
 
-	if (!sources)
+	if (!jag)
 		return 0;
 
 	size += sizeof(pim_encoded_group);
 	size += 4; // Joined sources (2) + Pruned Sources (2)
 
-	size += sizeof(pim_encoded_source) * sources->count;
+	size += sizeof(pim_encoded_source)
+		* pim_jp_agg_srcs_count(jag->sources);
 
-	js = listgetdata(listhead(sources));
+	js = pim_jp_agg_srcs_first(jag->sources);
 	if (js && pim_addr_is_any(js->up->sg.src) && js->is_join) {
 		struct pim_upstream *child, *up;
 		struct listnode *up_node;
@@ -267,7 +268,7 @@ size_t pim_msg_build_jp_groups(struct pim_jp_groups *grp,
 	memset(grp, 0, size);
 	pim_msg_addr_encode_group((uint8_t *)&grp->g, sgs->group);
 
-	for (ALL_LIST_ELEMENTS(sgs->sources, node, nnode, source)) {
+	frr_each (pim_jp_agg_srcs, sgs->sources, source) {
 		/* number of joined/pruned sources */
 		if (source->is_join)
 			grp->joins++;
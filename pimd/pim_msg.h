@@ -237,7 +237,7 @@ uint8_t *pim_msg_addr_encode_ucast(uint8_t *buf, pim_addr addr);
 uint8_t *pim_msg_addr_encode_group(uint8_t *buf, pim_addr addr);
 uint8_t *pim_msg_addr_encode_source(uint8_t *buf, pim_addr addr, uint8_t bits);
 
-size_t pim_msg_get_jp_group_size(struct list *sources);
+size_t pim_msg_get_jp_group_size(struct pim_jp_agg_group *jag);
 size_t pim_msg_build_jp_groups(struct pim_jp_groups *grp,
 			       struct pim_jp_agg_group *sgs, size_t size);
 #endif /* PIM_MSG_H */
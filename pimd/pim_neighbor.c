@@ -251,21 +251,53 @@ void pim_neighbor_timer_reset(struct pim_neighbor *neigh, uint16_t holdtime)
 			 neigh->holdtime, &neigh->t_expire_timer);
 }
 
+/*
+ * The periodic J/P refresh of a neighbor with many groups is sent in
+ * slices, spread over the first half of t_periodic, so a single timer
+ * run does not burst out every message at once.
+ */
+#define PIM_JP_SLICE_MSEC 100
+#define PIM_JP_SLICE_MIN_GROUPS 256
+
 static void on_neighbor_jp_timer(struct thread *t)
 {
 	struct pim_neighbor *neigh = THREAD_ARG(t);
+	struct pim_jp_agg_group *jag, ref;
 	struct pim_rpf rpf;
+	size_t count, slices, max_groups;
+
+	count = pim_jp_agg_groups_count(neigh->upstream_jp_agg);
 
 	if (PIM_DEBUG_PIM_TRACE)
-		zlog_debug("%s:Sending JP Agg to %pPA on %s with %d groups",
+		zlog_debug("%s:Sending JP Agg to %pPA on %s with %zu groups%s",
 			   __func__, &neigh->source_addr,
-			   neigh->interface->name,
-			   neigh->upstream_jp_agg->count);
+			   neigh->interface->name, count,
+			   neigh->jp_resume ? " (continued)" : "");
+
+	if (neigh->jp_resume) {
+		ref.group = neigh->jp_resume_group;
+		jag = pim_jp_agg_groups_find_gteq(neigh->upstream_jp_agg, &ref);
+	} else
+		jag = pim_jp_agg_groups_first(neigh->upstream_jp_agg);
+
+	slices = router->t_periodic * 1000 / 2 / PIM_JP_SLICE_MSEC;
+	max_groups = MAX(count / MAX(slices, 1) + 1, PIM_JP_SLICE_MIN_GROUPS);
 
 	rpf.source_nexthop.interface = neigh->interface;
 	rpf.rpf_addr = neigh->source_addr;
-	pim_joinprune_send(&rpf, neigh->upstream_jp_agg);
+	pim_joinprune_send_groups(&rpf, neigh->upstream_jp_agg, &jag,
+				  max_groups);
+
+	if (jag) {
+		neigh->jp_resume = true;
+		neigh->jp_resume_group = jag->group;
+		thread_add_timer_msec(router->master, on_neighbor_jp_timer,
+				      neigh, PIM_JP_SLICE_MSEC,
+				      &neigh->jp_timer);
+		return;
+	}
 
+	neigh->jp_resume = false;
 	thread_add_timer(router->master, on_neighbor_jp_timer, neigh,
 			 router->t_periodic, &neigh->jp_timer);
 }
@@ -273,6 +305,7 @@ static void on_neighbor_jp_timer(struct thread *t)
 static void pim_neighbor_start_jp_timer(struct pim_neighbor *neigh)
 {
 	THREAD_OFF(neigh->jp_timer);
+	neigh->jp_resume = false;
 	thread_add_timer(router->master, on_neighbor_jp_timer, neigh,
 			 router->t_periodic, &neigh->jp_timer);
 }
@@ -304,10 +337,7 @@ pim_neighbor_new(struct interface *ifp, pim_addr source_addr,
 	neigh->t_expire_timer = NULL;
 	neigh->interface = ifp;
 
-	neigh->upstream_jp_agg = list_new();
-	neigh->upstream_jp_agg->cmp = pim_jp_agg_group_list_cmp;
-	neigh->upstream_jp_agg->del =
-		(void (*)(void *))pim_jp_agg_group_list_free;
+	pim_jp_agg_groups_init(neigh->upstream_jp_agg);
 	pim_neighbor_start_jp_timer(neigh);
 
 	pim_neighbor_timer_reset(neigh, holdtime);
@@ -387,7 +417,7 @@ void pim_neighbor_free(struct pim_neighbor *neigh)
 
 	delete_prefix_list(neigh);
 
-	list_delete(&neigh->upstream_jp_agg);
+	pim_jp_agg_groups_free(neigh->upstream_jp_agg);
 	THREAD_OFF(neigh->jp_timer);
 
 	bfd_sess_free(&neigh->bfd_session);
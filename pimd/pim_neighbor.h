@@ -44,7 +44,10 @@ struct pim_neighbor {
 	struct interface *interface;
 
 	struct thread *jp_timer;
-	struct list *upstream_jp_agg;
+	struct pim_jp_agg_groups_head upstream_jp_agg[1];
+	/* Periodic J/P refresh in progress, continue at this group */
+	bool jp_resume;
+	pim_addr jp_resume_group;
 	struct bfd_session_params *bfd_session;
 };
 
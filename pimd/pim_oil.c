@@ -80,6 +80,7 @@ int pim_channel_oil_compare(const struct channel_oil *cc1,
 void pim_oil_init(struct pim_instance *pim)
 {
 	rb_pim_oil_init(&pim->channel_oil_head);
+	pim_mfc_pending_init(&pim->mfc_pending);
 }
 
 void pim_oil_terminate(struct pim_instance *pim)
@@ -90,10 +91,15 @@ void pim_oil_terminate(struct pim_instance *pim)
 		pim_channel_oil_free(c_oil);
 
 	rb_pim_oil_fini(&pim->channel_oil_head);
+
+	THREAD_OFF(pim->t_mfc_pending);
+	pim_mfc_pending_fini(&pim->mfc_pending);
 }
 
 void pim_channel_oil_free(struct channel_oil *c_oil)
 {
+	if (pim_mfc_pending_anywhere(c_oil))
+		pim_mfc_pending_del(&c_oil->pim->mfc_pending, c_oil);
 	XFREE(MTYPE_PIM_CHANNEL_OIL, c_oil);
 }
 
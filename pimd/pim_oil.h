@@ -92,6 +92,7 @@ struct channel_counts {
 
 */
 PREDECL_RBTREE_UNIQ(rb_pim_oil);
+PREDECL_DLIST(pim_mfc_pending);
 
 struct channel_oil {
 	struct pim_instance *pim;
@@ -104,6 +105,14 @@ struct channel_oil {
 	struct mf6cctl oil;
 #endif
 	int installed;
+	/* What the kernel was last given, to suppress identical writes */
+#if PIM_IPV == 4
+	struct mfcctl oil_programmed;
+#else
+	struct mf6cctl oil_programmed;
+#endif
+	/* Queued for a deferred MFC update, see pim_mroute_add() */
+	struct pim_mfc_pending_item mfc_pending;
 	int oil_inherited_rescan;
 	int oil_size;
 	int oil_ref_count;
@@ -186,6 +195,7 @@ extern int pim_channel_oil_compare(const struct channel_oil *c1,
 				   const struct channel_oil *c2);
 DECLARE_RBTREE_UNIQ(rb_pim_oil, struct channel_oil, oil_rb,
                     pim_channel_oil_compare);
+DECLARE_DLIST(pim_mfc_pending, struct channel_oil, mfc_pending);
 
 void pim_oil_init(struct pim_instance *pim);
 void pim_oil_terminate(struct pim_instance *pim);
@@ -74,7 +74,8 @@ static void pim_upstream_remove_children(struct pim_instance *pim,
 
 	while (!list_isempty(up->sources)) {
 		child = listnode_head(up->sources);
-		listnode_delete(up->sources, child);
+		list_delete_node(up->sources, listhead(up->sources));
+		child->parent_node = NULL;
 		if (PIM_UPSTREAM_FLAG_TEST_SRC_LHR(child->flags)) {
 			PIM_UPSTREAM_FLAG_UNSET_SRC_LHR(child->flags);
 			child = pim_upstream_del(pim, child, __func__);
@@ -94,6 +95,9 @@ static void pim_upstream_remove_children(struct pim_instance *pim,
  * A (*,G) or a (*,*) is being created
  * Find the children that would point
  * at us.
+ *
+ * The tree is sorted by group first, and the (*,G) comes before its
+ * (S,G)s, so the children are the entries right after us.
  */
 static void pim_upstream_find_new_children(struct pim_instance *pim,
 					   struct pim_upstream *up)
@@ -106,16 +110,20 @@ static void pim_upstream_find_new_children(struct pim_instance *pim,
 	if (pim_addr_is_any(up->sg.src) && pim_addr_is_any(up->sg.grp))
 		return;
 
-	frr_each (rb_pim_upstream, &pim->upstream_head, child) {
-		if (!pim_addr_is_any(up->sg.grp) &&
-		    !pim_addr_cmp(child->sg.grp, up->sg.grp) && (child != up)) {
-			child->parent = up;
-			listnode_add_sort(up->sources, child);
-			if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
-				pim_upstream_mroute_iif_update(
-						child->channel_oil,
-						__func__);
-		}
+	if (pim_addr_is_any(up->sg.grp))
+		return;
+
+	for (child = rb_pim_upstream_next(&pim->upstream_head, up); child;
+	     child = rb_pim_upstream_next(&pim->upstream_head, child)) {
+		if (pim_addr_cmp(child->sg.grp, up->sg.grp))
+			break;
+
+		child->parent = up;
+		/* Walked in order, appending keeps the list sorted */
+		child->parent_node = listnode_add(up->sources, child);
+		if (PIM_UPSTREAM_FLAG_TEST_USE_RPT(child->flags))
+			pim_upstream_mroute_iif_update(child->channel_oil,
+						       __func__);
 	}
 }
 
@@ -137,7 +145,7 @@ static struct pim_upstream *pim_upstream_find_parent(struct pim_instance *pim,
 		up = pim_upstream_find(pim, &any);
 
 		if (up)
-			listnode_add(up->sources, child);
+			child->parent_node = listnode_add(up->sources, child);
 
 		/*
 		 * In case parent is MLAG entry copy the data to child
@@ -247,9 +255,10 @@ struct pim_upstream *pim_upstream_del(struct pim_instance *pim,
 	if (up->sources)
 		list_delete(&up->sources);
 
-	if (up->parent && up->parent->sources)
-		listnode_delete(up->parent->sources, up);
+	if (up->parent && up->parent->sources && up->parent_node)
+		list_delete_node(up->parent->sources, up->parent_node);
 	up->parent = NULL;
+	up->parent_node = NULL;
 
 	rb_pim_upstream_del(&pim->upstream_head, up);
 
@@ -2009,7 +2018,7 @@ static bool pim_upstream_sg_running_proc(struct pim_upstream *up)
 	if (!up->channel_oil->installed)
 		return rv;
 
-	pim_mroute_update_counters(up->channel_oil);
+	pim_mroute_update_pkt_counters(up->channel_oil);
 
 	// Have we seen packets?
 	if ((up->channel_oil->cc.oldpktcnt >= up->channel_oil->cc.pktcnt)
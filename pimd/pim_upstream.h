@@ -229,6 +229,7 @@ struct pim_upstream {
 	struct pim_instance *pim;
 	struct rb_pim_upstream_item upstream_rb;
 	struct pim_upstream *parent;
+	struct listnode *parent_node;	  /* Our node in parent->sources */
 	pim_addr upstream_addr;		  /* Who we are talking to */
 	pim_addr upstream_register;       /*Who we received a register from*/
 	pim_sgaddr sg;			  /* (S,G) group key */
@@ -149,7 +149,7 @@ static void pim_mlag_zthread_handler(struct thread *event)
 	uint32_t curr_msg_type = MLAG_MSG_NONE;
 
 	router->zpthread_mlag_write = NULL;
-	wr_count = stream_fifo_count_safe(router->mlag_fifo);
+	wr_count = pim_mlag_update_count();
 
 	if (PIM_DEBUG_MLAG)
 		zlog_debug(":%s: Processing MLAG write, %d messages in queue",
@@ -160,10 +160,10 @@ static void pim_mlag_zthread_handler(struct thread *event)
 
 	for (wr_count = 0; wr_count < PIM_MLAG_POST_LIMIT; wr_count++) {
 		/* FIFO is empty,wait for teh message to be add */
-		if (stream_fifo_count_safe(router->mlag_fifo) == 0)
+		if (pim_mlag_update_count() == 0)
 			break;
 
-		read_s = stream_fifo_pop_safe(router->mlag_fifo);
+		read_s = pim_mlag_update_next();
 		if (!read_s) {
 			zlog_debug(":%s: Got a NULL Messages, some thing wrong",
 				   __func__);
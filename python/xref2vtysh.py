@@ -56,6 +56,9 @@ daemon_flags = {
     "lib/resolver.c": "VTYSH_NHRPD|VTYSH_BGPD",
     "lib/routemap.c": "VTYSH_RMAP",
     "lib/routemap_cli.c": "VTYSH_RMAP",
+    "lib/mempressure.c": "VTYSH_ALL",
+    "lib/memtrack.c": "VTYSH_ALL",
+    "lib/sigprof.c": "VTYSH_ALL",
     "lib/spf_backoff.c": "VTYSH_ISISD",
     "lib/thread.c": "VTYSH_ALL",
     "lib/vrf.c": "VTYSH_VRF",
@@ -101,6 +101,7 @@ static struct rip_interface *rip_interface_new(void)
 	struct rip_interface *ri;
 
 	ri = XCALLOC(MTYPE_RIP_INTERFACE, sizeof(struct rip_interface));
+	rip_update_cache_init(&ri->update_cache);
 
 	rip_interface_reset(ri);
 
@@ -429,6 +430,7 @@ static void rip_interface_clean(struct rip_interface *ri)
 	ri->running = 0;
 
 	THREAD_OFF(ri->t_wakeup);
+	rip_update_cache_flush(ri);
 }
 
 void rip_interfaces_clean(struct rip *rip)
@@ -619,6 +621,9 @@ int rip_interface_address_delete(ZAPI_CALLBACK_ARGS)
 
 			/* Chech whether this prefix needs to be removed */
 			rip_apply_address_del(ifc);
+
+			/* updates encoded for this address are keyed by ifc */
+			rip_update_cache_flush(ifc->ifp->info);
 		}
 
 		connected_free(&ifc);
@@ -1140,7 +1145,10 @@ static int rip_interface_new_hook(struct interface *ifp)
 /* Called when interface structure deleted. */
 static int rip_interface_delete_hook(struct interface *ifp)
 {
-	rip_interface_reset(ifp->info);
+	struct rip_interface *ri = ifp->info;
+
+	rip_interface_reset(ri);
+	rip_update_cache_fini(&ri->update_cache);
 	XFREE(MTYPE_RIP_INTERFACE, ifp->info);
 	return 0;
 }
@@ -31,6 +31,7 @@ const struct frr_yang_module_info frr_ripd_info = {
 		{
 			.xpath = "/frr-ripd:ripd/instance",
 			.cbs = {
+				.apply_finish = ripd_instance_apply_finish,
 				.cli_show = cli_show_router_rip,
 				.create = ripd_instance_create,
 				.destroy = ripd_instance_destroy,
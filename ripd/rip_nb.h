@@ -123,6 +123,7 @@ int lib_interface_rip_authentication_key_chain_destroy(
 	struct nb_cb_destroy_args *args);
 
 /* Optional 'apply_finish' callbacks. */
+void ripd_instance_apply_finish(struct nb_cb_apply_finish_args *args);
 void ripd_instance_redistribute_apply_finish(
 	struct nb_cb_apply_finish_args *args);
 void ripd_instance_timers_apply_finish(struct nb_cb_apply_finish_args *args);
@@ -98,6 +98,18 @@ int ripd_instance_destroy(struct nb_cb_destroy_args *args)
 	return NB_OK;
 }
 
+void ripd_instance_apply_finish(struct nb_cb_apply_finish_args *args)
+{
+	struct rip *rip;
+
+	rip = nb_running_get_entry(args->dnode, NULL, true);
+
+	/* Default metric, offset-lists, redistribution... all go into the
+	 * full updates.
+	 */
+	rip_update_invalidate(rip);
+}
+
 /*
  * XPath: /frr-ripd:ripd/instance/allow-ecmp
  */
@@ -842,6 +854,7 @@ int lib_interface_rip_split_horizon_modify(struct nb_cb_modify_args *args)
 	ifp = nb_running_get_entry(args->dnode, NULL, true);
 	ri = ifp->info;
 	ri->split_horizon = yang_dnode_get_enum(args->dnode, NULL);
+	rip_update_cache_flush(ri);
 
 	return NB_OK;
 }
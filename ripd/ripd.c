@@ -61,6 +61,7 @@ DEFINE_MTYPE_STATIC(RIPD, RIP, "RIP structure");
 DEFINE_MTYPE_STATIC(RIPD, RIP_VRF_NAME, "RIP VRF name");
 DEFINE_MTYPE_STATIC(RIPD, RIP_INFO, "RIP route info");
 DEFINE_MTYPE_STATIC(RIPD, RIP_DISTANCE, "RIP distance");
+DEFINE_MTYPE_STATIC(RIPD, RIP_UPDATE_CACHE, "RIP encoded update");
 
 /* Prototypes. */
 static void rip_output_process(struct connected *, struct sockaddr_in *, int,
@@ -149,6 +150,9 @@ static void rip_garbage_collect(struct thread *t)
 	/* Get route_node pointer. */
 	rp = rinfo->rp;
 
+	/* The route is not announced with infinity metric anymore. */
+	rip_update_invalidate(rip_info_get_instance(rinfo));
+
 	/* Unlock route_node. */
 	listnode_delete(rp->info, rinfo);
 	if (list_isempty((struct list *)rp->info)) {
@@ -2029,77 +2033,29 @@ static int rip_write_rte(int num, struct stream *s, struct prefix_ipv4 *p,
 	return ++num;
 }
 
-/* Send update to the ifp or spcified neighbor. */
-void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
-			int route_type, uint8_t version)
+/* Write the RTEs of an update sent from ifc to s, applying filters,
+ * route-maps, offset-lists and split horizon.  Returns the number of RTEs
+ * written.
+ */
+static int rip_output_rtes(struct connected *ifc, int route_type,
+			   uint8_t version, struct stream *s)
 {
 	struct rip *rip;
 	int ret;
-	struct stream *s;
 	struct route_node *rp;
 	struct rip_info *rinfo;
 	struct rip_interface *ri;
 	struct prefix_ipv4 *p;
 	struct prefix_ipv4 classfull;
 	struct prefix_ipv4 ifaddrclass;
-	struct key *key = NULL;
-	/* this might need to made dynamic if RIP ever supported auth methods
-	   with larger key string sizes */
-	char auth_str[RIP_AUTH_SIMPLE_SIZE];
-	size_t doff = 0; /* offset of digest offset field */
 	int num = 0;
-	int rtemax;
 	int subnetted = 0;
 	struct list *list = NULL;
 	struct listnode *listnode = NULL;
 
-	/* Logging output event. */
-	if (IS_RIP_DEBUG_EVENT) {
-		if (to)
-			zlog_debug("update routes to neighbor %pI4",
-				   &to->sin_addr);
-		else
-			zlog_debug("update routes on interface %s ifindex %d",
-				   ifc->ifp->name, ifc->ifp->ifindex);
-	}
-
-	/* Get RIP interface. */
 	ri = ifc->ifp->info;
 	rip = ri->rip;
 
-	/* Set output stream. */
-	s = rip->obuf;
-
-	/* Reset stream and RTE counter. */
-	stream_reset(s);
-	rtemax = RIP_MAX_RTE;
-
-	/* If output interface is in simple password authentication mode, we
-	   need space for authentication data.  */
-	if (ri->auth_type == RIP_AUTH_SIMPLE_PASSWORD)
-		rtemax -= 1;
-
-	/* If output interface is in MD5 authentication mode, we need space
-	   for authentication header and data. */
-	if (ri->auth_type == RIP_AUTH_MD5)
-		rtemax -= 2;
-
-	/* If output interface is in simple password authentication mode
-	   and string or keychain is specified we need space for auth. data */
-	if (ri->auth_type != RIP_NO_AUTH) {
-		if (ri->key_chain) {
-			struct keychain *keychain;
-
-			keychain = keychain_lookup(ri->key_chain);
-			if (keychain)
-				key = key_lookup_for_send(keychain);
-		}
-		/* to be passed to auth functions later */
-		rip_auth_prepare_str_send(ri, key, auth_str, sizeof(auth_str));
-		if (strlen(auth_str) == 0)
-			return;
-	}
-
 	if (version == RIPv1) {
 		memcpy(&ifaddrclass, ifc->address, sizeof(ifaddrclass));
 		apply_classful_mask_ipv4(&ifaddrclass);
@@ -2310,41 +2266,41 @@ void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
 			}
 		}
 
-		/* Prepare preamble, auth headers, if needs be */
-		if (num == 0) {
-			stream_putc(s, RIP_RESPONSE);
-			stream_putc(s, version);
-			stream_putw(s, 0);
-
-			/* auth header for !v1 && !no_auth */
-			if ((ri->auth_type != RIP_NO_AUTH) &&
-			    (version != RIPv1))
-				doff = rip_auth_header_write(
-					s, ri, key, auth_str,
-					RIP_AUTH_SIMPLE_SIZE);
-		}
-
 		/* Write RTE to the stream. */
 		num = rip_write_rte(num, s, p, version, rinfo);
-		if (num == rtemax) {
-			if (version == RIPv2 && ri->auth_type == RIP_AUTH_MD5)
-				rip_auth_md5_set(s, ri, doff, auth_str,
-						 RIP_AUTH_SIMPLE_SIZE);
+	}
 
-			ret = rip_send_packet(STREAM_DATA(s),
-					      stream_get_endp(s), to, ifc);
+	return num;
+}
 
-			if (ret >= 0 && IS_RIP_DEBUG_SEND)
-				rip_packet_dump(
-					(struct rip_packet *)STREAM_DATA(s),
-					stream_get_endp(s), "SEND");
-			num = 0;
-			stream_reset(s);
-		}
-	}
+/* Send num RTEs from rtes, in as many packets as needed. */
+static void rip_output_send(struct connected *ifc, struct sockaddr_in *to,
+			    uint8_t version, struct key *key, char *auth_str,
+			    int rtemax, struct stream *rtes, int num)
+{
+	struct rip_interface *ri = ifc->ifp->info;
+	struct stream *s = ri->rip->obuf;
+	size_t doff = 0; /* offset of digest offset field */
+	int ret;
+	int i, n;
+
+	for (i = 0; i < num; i += n) {
+		n = MIN(num - i, rtemax);
+
+		/* Prepare preamble, auth headers, if needs be */
+		stream_reset(s);
+		stream_putc(s, RIP_RESPONSE);
+		stream_putc(s, version);
+		stream_putw(s, 0);
+
+		/* auth header for !v1 && !no_auth */
+		if ((ri->auth_type != RIP_NO_AUTH) && (version != RIPv1))
+			doff = rip_auth_header_write(s, ri, key, auth_str,
+						     RIP_AUTH_SIMPLE_SIZE);
+
+		stream_put(s, STREAM_DATA(rtes) + i * RIP_RTE_SIZE,
+			   n * RIP_RTE_SIZE);
 
-	/* Flush unwritten RTE. */
-	if (num != 0) {
 		if (version == RIPv2 && ri->auth_type == RIP_AUTH_MD5)
 			rip_auth_md5_set(s, ri, doff, auth_str,
 					 RIP_AUTH_SIMPLE_SIZE);
@@ -2355,7 +2311,133 @@ void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
 		if (ret >= 0 && IS_RIP_DEBUG_SEND)
 			rip_packet_dump((struct rip_packet *)STREAM_DATA(s),
 					stream_get_endp(s), "SEND");
-		stream_reset(s);
+	}
+
+	stream_reset(s);
+}
+
+/* Room for the RTEs of any update. */
+static size_t rip_output_size(struct rip *rip)
+{
+	return MAX(route_table_count(rip->table), 1) * RIP_RTE_SIZE;
+}
+
+static struct rip_update_cache *
+rip_update_cache_get(struct rip_interface *ri, struct connected *ifc,
+		     uint8_t version)
+{
+	struct rip_update_cache *uc;
+
+	frr_each (rip_update_cache, &ri->update_cache, uc)
+		if (uc->ifc == ifc && uc->version == version)
+			return uc;
+
+	uc = XCALLOC(MTYPE_RIP_UPDATE_CACHE, sizeof(*uc));
+	uc->ifc = ifc;
+	uc->version = version;
+	rip_update_cache_add_tail(&ri->update_cache, uc);
+
+	return uc;
+}
+
+void rip_update_cache_flush(struct rip_interface *ri)
+{
+	struct rip_update_cache *uc;
+
+	while ((uc = rip_update_cache_pop(&ri->update_cache))) {
+		stream_free(uc->rtes);
+		XFREE(MTYPE_RIP_UPDATE_CACHE, uc);
+	}
+}
+
+void rip_update_invalidate(struct rip *rip)
+{
+	rip->update_gen++;
+}
+
+/* Send update to the ifp or spcified neighbor. */
+void rip_output_process(struct connected *ifc, struct sockaddr_in *to,
+			int route_type, uint8_t version)
+{
+	struct rip *rip;
+	struct rip_interface *ri;
+	struct rip_update_cache *uc;
+	struct stream *rtes;
+	struct key *key = NULL;
+	/* this might need to made dynamic if RIP ever supported auth methods
+	   with larger key string sizes */
+	char auth_str[RIP_AUTH_SIMPLE_SIZE];
+	int num;
+	int rtemax;
+
+	/* Logging output event. */
+	if (IS_RIP_DEBUG_EVENT) {
+		if (to)
+			zlog_debug("update routes to neighbor %pI4",
+				   &to->sin_addr);
+		else
+			zlog_debug("update routes on interface %s ifindex %d",
+				   ifc->ifp->name, ifc->ifp->ifindex);
+	}
+
+	/* Get RIP interface. */
+	ri = ifc->ifp->info;
+	rip = ri->rip;
+
+	/* Reset RTE counter. */
+	rtemax = RIP_MAX_RTE;
+
+	/* If output interface is in simple password authentication mode, we
+	   need space for authentication data.  */
+	if (ri->auth_type == RIP_AUTH_SIMPLE_PASSWORD)
+		rtemax -= 1;
+
+	/* If output interface is in MD5 authentication mode, we need space
+	   for authentication header and data. */
+	if (ri->auth_type == RIP_AUTH_MD5)
+		rtemax -= 2;
+
+	/* If output interface is in simple password authentication mode
+	   and string or keychain is specified we need space for auth. data */
+	if (ri->auth_type != RIP_NO_AUTH) {
+		if (ri->key_chain) {
+			struct keychain *keychain;
+
+			keychain = keychain_lookup(ri->key_chain);
+			if (keychain)
+				key = key_lookup_for_send(keychain);
+		}
+		/* to be passed to auth functions later */
+		rip_auth_prepare_str_send(ri, key, auth_str, sizeof(auth_str));
+		if (strlen(auth_str) == 0)
+			return;
+	}
+
+	if (route_type == rip_changed_route) {
+		/* Triggered updates only carry what changed since the last
+		 * one, there is nothing worth keeping.
+		 */
+		rtes = stream_new(rip_output_size(rip));
+		num = rip_output_rtes(ifc, route_type, version, rtes);
+		rip_output_send(ifc, to, version, key, auth_str, rtemax, rtes,
+				num);
+		stream_free(rtes);
+	} else {
+		/* Full updates are the same every time until a route or
+		 * the output policy changes, keep them encoded.
+		 */
+		uc = rip_update_cache_get(ri, ifc, version);
+		if (!uc->rtes || uc->gen != rip->update_gen) {
+			stream_free(uc->rtes);
+			uc->rtes = stream_new(rip_output_size(rip));
+			uc->num = rip_output_rtes(ifc, route_type, version,
+						  uc->rtes);
+			uc->gen = rip->update_gen;
+		} else if (IS_RIP_DEBUG_EVENT)
+			zlog_debug("reusing %d encoded routes for %pFX",
+				   uc->num, ifc->address);
+		rip_output_send(ifc, to, version, key, auth_str, rtemax,
+				uc->rtes, uc->num);
 	}
 
 	/* Statistics updates. */
@@ -2791,6 +2873,8 @@ void rip_event(struct rip *rip, enum rip_event event, int sock)
 				 &rip->t_update);
 		break;
 	case RIP_TRIGGERED_UPDATE:
+		/* a route changed, full updates have to be rebuilt */
+		rip_update_invalidate(rip);
 		if (rip->t_triggered_interval)
 			rip->trigger = 1;
 		else
@@ -3302,6 +3386,8 @@ static void rip_distribute_update(struct distribute_ctx *ctx,
 			ri->prefix[RIP_FILTER_OUT] = NULL;
 	} else
 		ri->prefix[RIP_FILTER_OUT] = NULL;
+
+	rip_update_cache_flush(ri);
 }
 
 void rip_distribute_update_interface(struct interface *ifp)
@@ -3399,6 +3485,8 @@ static void rip_if_rmap_update(struct if_rmap_ctx *ctx,
 			ri->routemap[IF_RMAP_OUT] = NULL;
 	} else
 		ri->routemap[RIP_FILTER_OUT] = NULL;
+
+	rip_update_cache_flush(ri);
 }
 
 void rip_if_rmap_update_interface(struct interface *ifp)
@@ -3441,8 +3529,10 @@ static void rip_routemap_update(const char *notused)
 		rip_if_rmap_update_interface(ifp);
 
 	rip = vrf->info;
-	if (rip)
+	if (rip) {
 		rip_routemap_update_redistribute(rip);
+		rip_update_invalidate(rip);
+	}
 }
 
 /* Link RIP instance to VRF. */
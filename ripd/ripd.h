@@ -25,6 +25,7 @@
 #include "nexthop.h"
 #include "distribute.h"
 #include "memory.h"
+#include "typesafe.h"
 
 /* RIP version number. */
 #define RIPv1                            1
@@ -122,6 +123,9 @@ struct rip {
 	/* Output buffer of RIP. */
 	struct stream *obuf;
 
+	/* Bumped whenever encoded full updates have to be rebuilt. */
+	uint32_t update_gen;
+
 	/* RIP routing information base. */
 	struct route_table *table;
 
@@ -269,6 +273,25 @@ struct rip_info {
 	uint8_t distance;
 };
 
+PREDECL_DLIST(rip_update_cache);
+
+/* RTEs of the last full update sent from one address with one version,
+ * reused until something that goes into them changes.
+ */
+struct rip_update_cache {
+	struct rip_update_cache_item itm;
+
+	struct connected *ifc;
+	uint8_t version;
+
+	/* rip->update_gen these were encoded at */
+	uint32_t gen;
+	int num;
+	struct stream *rtes;
+};
+
+DECLARE_DLIST(rip_update_cache, struct rip_update_cache, itm);
+
 typedef enum {
 	RIP_NO_SPLIT_HORIZON = 0,
 	RIP_SPLIT_HORIZON,
@@ -333,6 +356,9 @@ struct rip_interface {
 
 	/* Passive interface. */
 	int passive;
+
+	/* Encoded full updates sent on this interface. */
+	struct rip_update_cache_head update_cache;
 };
 
 /* RIP peer information. */
@@ -453,6 +479,8 @@ extern int rip_enable_if_add(struct rip *rip, const char *ifname);
 extern int rip_enable_if_delete(struct rip *rip, const char *ifname);
 
 extern void rip_event(struct rip *rip, enum rip_event event, int sock);
+extern void rip_update_invalidate(struct rip *rip);
+extern void rip_update_cache_flush(struct rip_interface *ri);
 extern void rip_ecmp_disable(struct rip *rip);
 
 extern int rip_create_socket(struct vrf *vrf);
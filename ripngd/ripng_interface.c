@@ -171,6 +171,7 @@ static int ripng_if_down(struct interface *ifp)
 	ri = ifp->info;
 
 	THREAD_OFF(ri->t_wakeup);
+	ripng_update_cache_flush(ri);
 
 	ripng = ri->ripng;
 
@@ -317,6 +318,7 @@ void ripng_interface_clean(struct ripng *ripng)
 		ri->running = 0;
 
 		THREAD_OFF(ri->t_wakeup);
+		ripng_update_cache_flush(ri);
 	}
 }
 
@@ -904,6 +906,7 @@ static int ripng_if_new_hook(struct interface *ifp)
 /* Called when interface structure deleted. */
 static int ripng_if_delete_hook(struct interface *ifp)
 {
+	ripng_update_cache_flush(ifp->info);
 	XFREE(MTYPE_RIPNG_IF, ifp->info);
 	return 0;
 }
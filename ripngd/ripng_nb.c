@@ -31,6 +31,7 @@ const struct frr_yang_module_info frr_ripngd_info = {
 		{
 			.xpath = "/frr-ripngd:ripngd/instance",
 			.cbs = {
+				.apply_finish = ripngd_instance_apply_finish,
 				.cli_show = cli_show_router_ripng,
 				.create = ripngd_instance_create,
 				.destroy = ripngd_instance_destroy,
@@ -96,6 +96,7 @@ int clear_ripng_route_rpc(struct nb_cb_rpc_args *args);
 int lib_interface_ripng_split_horizon_modify(struct nb_cb_modify_args *args);
 
 /* Optional 'apply_finish' callbacks. */
+void ripngd_instance_apply_finish(struct nb_cb_apply_finish_args *args);
 void ripngd_instance_redistribute_apply_finish(
 	struct nb_cb_apply_finish_args *args);
 void ripngd_instance_timers_apply_finish(struct nb_cb_apply_finish_args *args);
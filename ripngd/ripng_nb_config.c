@@ -99,6 +99,18 @@ int ripngd_instance_destroy(struct nb_cb_destroy_args *args)
 	return NB_OK;
 }
 
+void ripngd_instance_apply_finish(struct nb_cb_apply_finish_args *args)
+{
+	struct ripng *ripng;
+
+	ripng = nb_running_get_entry(args->dnode, NULL, true);
+
+	/* Default metric, offset-lists, aggregates... all go into the full
+	 * updates.
+	 */
+	ripng_update_invalidate(ripng);
+}
+
 const void *ripngd_instance_get_next(struct nb_cb_get_next_args *args)
 {
 	struct ripng *ripng = (struct ripng *)args->list_entry;
@@ -668,6 +680,7 @@ int lib_interface_ripng_split_horizon_modify(struct nb_cb_modify_args *args)
 	ifp = nb_running_get_entry(args->dnode, NULL, true);
 	ri = ifp->info;
 	ri->split_horizon = yang_dnode_get_enum(args->dnode, NULL);
+	ripng_update_cache_flush(ri);
 
 	return NB_OK;
 }
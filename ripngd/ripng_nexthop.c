@@ -109,10 +109,10 @@ void ripng_rte_add(struct list *ripng_rte_list, struct prefix_ipv6 *p,
 	listnode_add_sort(ripng_rte_list, data);
 }
 
-/* Send the RTE with the nexthop support
+/* Encode the RTE with the nexthop support into packets sized for ifp
  */
-void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
-		    struct sockaddr_in6 *to)
+void ripng_rte_encode(struct list *ripng_rte_list, struct interface *ifp,
+		      struct stream_fifo *packets)
 {
 	struct ripng_interface *ri = ifp->info;
 	struct ripng *ripng = ri->ripng;
@@ -126,7 +126,6 @@ void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
 	int num;
 	int mtu;
 	int rtemax;
-	int ret;
 
 	/* Most of the time, there is no nexthop */
 	memset(&last_nexthop, 0, sizeof(last_nexthop));
@@ -161,15 +160,7 @@ void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
 			/* A nexthop entry should be at least followed by 1 RTE
 			 */
 			if (num == (rtemax - 1)) {
-				ret = ripng_send_packet((caddr_t)STREAM_DATA(s),
-							stream_get_endp(s), to,
-							ifp);
-
-				if (ret >= 0 && IS_RIPNG_DEBUG_SEND)
-					ripng_packet_dump(
-						(struct ripng_packet *)
-							STREAM_DATA(s),
-						stream_get_endp(s), "SEND");
+				stream_fifo_push(packets, stream_dup(s));
 				num = 0;
 				stream_reset(s);
 			}
@@ -199,13 +190,7 @@ void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
 				      METRIC_OUT(data));
 
 		if (num == rtemax) {
-			ret = ripng_send_packet((caddr_t)STREAM_DATA(s),
-						stream_get_endp(s), to, ifp);
-
-			if (ret >= 0 && IS_RIPNG_DEBUG_SEND)
-				ripng_packet_dump(
-					(struct ripng_packet *)STREAM_DATA(s),
-					stream_get_endp(s), "SEND");
+			stream_fifo_push(packets, stream_dup(s));
 			num = 0;
 			stream_reset(s);
 		}
@@ -213,12 +198,24 @@ void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
 
 	/* If unwritten RTE exist, flush it. */
 	if (num != 0) {
+		stream_fifo_push(packets, stream_dup(s));
+		stream_reset(s);
+	}
+}
+
+/* Send packets encoded by ripng_rte_encode() */
+void ripng_rte_send(struct stream_fifo *packets, struct interface *ifp,
+		    struct sockaddr_in6 *to)
+{
+	struct stream *s;
+	int ret;
+
+	for (s = stream_fifo_head(packets); s; s = s->next) {
 		ret = ripng_send_packet((caddr_t)STREAM_DATA(s),
 					stream_get_endp(s), to, ifp);
 
 		if (ret >= 0 && IS_RIPNG_DEBUG_SEND)
 			ripng_packet_dump((struct ripng_packet *)STREAM_DATA(s),
 					  stream_get_endp(s), "SEND");
-		stream_reset(s);
 	}
 }
@@ -31,7 +31,10 @@ extern void ripng_rte_free(struct list *ripng_rte_list);
 extern void ripng_rte_add(struct list *ripng_rte_list, struct prefix_ipv6 *p,
 			  struct ripng_info *rinfo,
 			  struct ripng_aggregate *aggregate);
-extern void ripng_rte_send(struct list *ripng_rte_list, struct interface *ifp,
+extern void ripng_rte_encode(struct list *ripng_rte_list,
+			     struct interface *ifp,
+			     struct stream_fifo *packets);
+extern void ripng_rte_send(struct stream_fifo *packets, struct interface *ifp,
 			   struct sockaddr_in6 *to);
 
 /***
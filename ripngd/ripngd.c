@@ -436,6 +436,9 @@ static void ripng_garbage_collect(struct thread *t)
 	/* Get route_node pointer. */
 	rp = rinfo->rp;
 
+	/* The route is not announced with infinity metric anymore. */
+	ripng_update_invalidate(ripng_info_get_instance(rinfo));
+
 	/* Unlock route_node. */
 	listnode_delete(rp->info, rinfo);
 	if (list_isempty((struct list *)rp->info)) {
@@ -1540,6 +1543,18 @@ int ripng_write_rte(int num, struct stream *s, struct prefix_ipv6 *p,
 	return ++num;
 }
 
+void ripng_update_cache_flush(struct ripng_interface *ri)
+{
+	if (ri->update_cache.packets)
+		stream_fifo_free(ri->update_cache.packets);
+	ri->update_cache.packets = NULL;
+}
+
+void ripng_update_invalidate(struct ripng *ripng)
+{
+	ripng->update_gen++;
+}
+
 /* Send RESPONSE message to specified destination. */
 void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 			  int route_type)
@@ -1554,6 +1569,7 @@ void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 	struct list *ripng_rte_list;
 	struct list *list = NULL;
 	struct listnode *listnode = NULL;
+	struct stream_fifo *packets;
 
 	if (IS_RIPNG_DEBUG_EVENT) {
 		if (to)
@@ -1568,6 +1584,19 @@ void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 	ri = ifp->info;
 	ripng = ri->ripng;
 
+	/* Full updates are the same every time until a route or the output
+	 * policy changes, send the packets built last time.
+	 */
+	if (route_type == ripng_all_route && ri->update_cache.packets
+	    && ri->update_cache.gen == ripng->update_gen
+	    && ri->update_cache.mtu == ifp->mtu6) {
+		if (IS_RIPNG_DEBUG_EVENT)
+			zlog_debug("RIPng reusing encoded update on %s",
+				   ifp->name);
+		ripng_rte_send(ri->update_cache.packets, ifp, to);
+		return;
+	}
+
 	ripng_rte_list = ripng_rte_new();
 
 	for (rp = agg_route_top(ripng->table); rp; rp = agg_route_next(rp)) {
@@ -1786,8 +1815,18 @@ void ripng_output_process(struct interface *ifp, struct sockaddr_in6 *to,
 	}
 
 	/* Flush the list */
-	ripng_rte_send(ripng_rte_list, ifp, to);
+	packets = stream_fifo_new();
+	ripng_rte_encode(ripng_rte_list, ifp, packets);
 	ripng_rte_free(ripng_rte_list);
+	ripng_rte_send(packets, ifp, to);
+
+	if (route_type == ripng_all_route) {
+		ripng_update_cache_flush(ri);
+		ri->update_cache.packets = packets;
+		ri->update_cache.gen = ripng->update_gen;
+		ri->update_cache.mtu = ifp->mtu6;
+	} else
+		stream_fifo_free(packets);
 }
 
 struct ripng *ripng_lookup_by_vrf_id(vrf_id_t vrf_id)
@@ -1927,6 +1966,8 @@ void ripng_event(struct ripng *ripng, enum ripng_event event, int sock)
 				 &ripng->t_update);
 		break;
 	case RIPNG_TRIGGERED_UPDATE:
+		/* a route changed, full updates have to be rebuilt */
+		ripng_update_invalidate(ripng);
 		if (ripng->t_triggered_interval)
 			ripng->trigger = 1;
 		else
@@ -2323,6 +2364,8 @@ static void ripng_distribute_update(struct distribute_ctx *ctx,
 			ri->prefix[RIPNG_FILTER_OUT] = NULL;
 	} else
 		ri->prefix[RIPNG_FILTER_OUT] = NULL;
+
+	ripng_update_cache_flush(ri);
 }
 
 void ripng_distribute_update_interface(struct interface *ifp)
@@ -2419,6 +2462,8 @@ static void ripng_if_rmap_update(struct if_rmap_ctx *ctx,
 			ri->routemap[IF_RMAP_OUT] = NULL;
 	} else
 		ri->routemap[RIPNG_FILTER_OUT] = NULL;
+
+	ripng_update_cache_flush(ri);
 }
 
 void ripng_if_rmap_update_interface(struct interface *ifp)
@@ -2461,8 +2506,10 @@ static void ripng_routemap_update(const char *unused)
 		ripng_if_rmap_update_interface(ifp);
 
 	ripng = vrf->info;
-	if (ripng)
+	if (ripng) {
 		ripng_routemap_update_redistribute(ripng);
+		ripng_update_invalidate(ripng);
+	}
 }
 
 /* Link RIPng instance to VRF. */
@@ -117,6 +117,9 @@ struct ripng {
 	struct stream *ibuf;
 	struct stream *obuf;
 
+	/* Bumped whenever encoded full updates have to be rebuilt. */
+	uint32_t update_gen;
+
 	/* RIPng routing information base. */
 	struct agg_table *table;
 
@@ -273,6 +276,16 @@ struct ripng_interface {
 
 	/* Passive interface. */
 	int passive;
+
+	/* Last full update sent on this interface, reused until something
+	 * that goes into it changes.
+	 */
+	struct {
+		/* ripng->update_gen and MTU it was encoded for */
+		uint32_t gen;
+		int mtu;
+		struct stream_fifo *packets;
+	} update_cache;
 };
 
 /* RIPng peer information. */
@@ -392,6 +405,8 @@ extern struct ripng_info *ripng_info_new(void);
 extern void ripng_info_free(struct ripng_info *rinfo);
 extern struct ripng *ripng_info_get_instance(const struct ripng_info *rinfo);
 extern void ripng_event(struct ripng *ripng, enum ripng_event event, int sock);
+extern void ripng_update_invalidate(struct ripng *ripng);
+extern void ripng_update_cache_flush(struct ripng_interface *ri);
 extern int ripng_request(struct interface *ifp);
 extern void ripng_redistribute_add(struct ripng *ripng, int type, int sub_type,
 				   struct prefix_ipv6 *p, ifindex_t ifindex,
@@ -27,6 +27,7 @@
 #include "vty.h"
 #include "typesafe.h"
 #include "zclient.h"
+#include "json.h"
 
 #include "sharp_nht.h"
 #include "sharp_globals.h"
@@ -55,14 +56,45 @@ struct sharp_nh_tracker *sharp_nh_tracker_get(struct prefix *p)
 	return nht;
 }
 
-void sharp_nh_tracker_dump(struct vty *vty)
+void sharp_nh_tracker_dump(struct vty *vty, bool uj)
 {
 	struct listnode *node;
 	struct sharp_nh_tracker *nht;
+	json_object *json = NULL, *json_nht;
+	struct timeval r;
 
-	for (ALL_LIST_ELEMENTS_RO(sg.nhs, node, nht))
-		vty_out(vty, "%pFX: Nexthops: %u Updates: %u\n", &nht->p,
-			nht->nhop_num, nht->updates);
+	if (uj)
+		json = json_object_new_object();
+
+	for (ALL_LIST_ELEMENTS_RO(sg.nhs, node, nht)) {
+		if (!json) {
+			vty_out(vty, "%pFX: Nexthops: %u Updates: %u\n",
+				&nht->p, nht->nhop_num, nht->updates);
+			continue;
+		}
+
+		json_nht = json_object_new_object();
+		json_object_int_add(json_nht, "nexthops", nht->nhop_num);
+		json_object_int_add(json_nht, "updates", nht->updates);
+
+		/*
+		 * Time from the start of the last route install/removal to
+		 * the last update, i.e. the NHT latency if that batch of
+		 * routes changed the resolution of this nexthop.
+		 */
+		if (nht->updates
+		    && timercmp(&nht->t_update, &sg.r.t_start, >)) {
+			timersub(&nht->t_update, &sg.r.t_start, &r);
+			json_object_int_add(json_nht, "updateLatencyUsec",
+					    (int64_t)r.tv_sec * 1000000
+						    + r.tv_usec);
+		}
+
+		json_object_object_addf(json, json_nht, "%pFX", &nht->p);
+	}
+
+	if (json)
+		vty_json(vty, json);
 }
 
 PREDECL_RBTREE_UNIQ(sharp_nhg_rb);
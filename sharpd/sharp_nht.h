@@ -30,11 +30,14 @@ struct sharp_nh_tracker {
 	uint32_t nhop_num;
 
 	uint32_t updates;
+
+	/* When the last update was received */
+	struct timeval t_update;
 };
 
 extern struct sharp_nh_tracker *sharp_nh_tracker_get(struct prefix *p);
 
-extern void sharp_nh_tracker_dump(struct vty *vty);
+extern void sharp_nh_tracker_dump(struct vty *vty, bool uj);
 
 extern uint32_t sharp_nhgroup_get_id(const char *name);
 extern void sharp_nhgroup_id_set_installed(uint32_t id, bool installed);
@@ -33,6 +33,7 @@
 #include "link_state.h"
 #include "cspf.h"
 #include "tc.h"
+#include "json.h"
 
 #include "sharpd/sharp_globals.h"
 #include "sharpd/sharp_zebra.h"
@@ -160,29 +161,57 @@ DEFPY(watch_nexthop_v4, watch_nexthop_v4_cmd,
 
 DEFPY(sharp_nht_data_dump,
       sharp_nht_data_dump_cmd,
-      "sharp data nexthop",
+      "sharp data nexthop [json$json]",
       "Sharp routing Protocol\n"
       "Data about what is going on\n"
-      "Nexthop information\n")
+      "Nexthop information\n"
+      JSON_STR)
 {
-	sharp_nh_tracker_dump(vty);
+	sharp_nh_tracker_dump(vty, !!json);
 
 	return CMD_SUCCESS;
 }
 
 DEFPY (install_routes_data_dump,
        install_routes_data_dump_cmd,
-       "sharp data route",
+       "sharp data route [json$json]",
        "Sharp routing Protocol\n"
        "Data about what is going on\n"
-       "Route Install/Removal Information\n")
+       "Route Install/Removal Information\n"
+       JSON_STR)
 {
 	struct timeval r;
+	json_object *jo;
+	int64_t usec;
+	uint32_t done;
 
 	timersub(&sg.r.t_end, &sg.r.t_start, &r);
-	vty_out(vty, "Prefix: %pFX Total: %u %u %u Time: %jd.%ld\n",
-		&sg.r.orig_prefix, sg.r.total_routes, sg.r.installed_routes,
-		sg.r.removed_routes, (intmax_t)r.tv_sec, (long)r.tv_usec);
+	if (!json) {
+		vty_out(vty, "Prefix: %pFX Total: %u %u %u Time: %jd.%ld\n",
+			&sg.r.orig_prefix, sg.r.total_routes,
+			sg.r.installed_routes, sg.r.removed_routes,
+			(intmax_t)r.tv_sec, (long)r.tv_usec);
+		return CMD_SUCCESS;
+	}
+
+	/* t_end is only set once all routes of the batch are acked */
+	done = MAX(sg.r.installed_routes, sg.r.removed_routes);
+	usec = (int64_t)r.tv_sec * 1000000 + r.tv_usec;
+
+	jo = json_object_new_object();
+	json_object_string_addf(jo, "prefix", "%pFX", &sg.r.orig_prefix);
+	json_object_int_add(jo, "totalRoutes", sg.r.total_routes);
+	json_object_int_add(jo, "installedRoutes", sg.r.installed_routes);
+	json_object_int_add(jo, "removedRoutes", sg.r.removed_routes);
+	json_object_boolean_add(jo, "complete",
+				sg.r.total_routes && done == sg.r.total_routes
+					&& usec >= 0);
+	json_object_int_add(jo, "timeUsec", usec);
+	if (usec > 0)
+		json_object_int_add(jo, "routesPerSecond",
+				    (int64_t)sg.r.total_routes * 1000000
+					    / usec);
+	vty_json(vty, jo);
 
 	return CMD_SUCCESS;
 }
@@ -1260,6 +1289,7 @@ DEFPY (show_sharp_cspf,
 	}
 	if (path->status != SUCCESS) {
 		vty_out(vty, "Path computation failed: %d\n", path->status);
+		cspf_path_del(path);
 		return CMD_SUCCESS;
 	}
 
@@ -1275,6 +1305,7 @@ DEFPY (show_sharp_cspf,
 				&edge->attributes->standard.remote6);
 	}
 	vty_out(vty, "\n");
+	cspf_path_del(path);
 
 	return CMD_SUCCESS;
 }
@@ -694,6 +694,7 @@ static int sharp_nexthop_update(ZAPI_CALLBACK_ARGS)
 	nht = sharp_nh_tracker_get(&matched);
 	nht->nhop_num = nhr.nexthop_num;
 	nht->updates++;
+	monotime(&nht->t_update);
 
 	sharp_debug_nexthops(&nhr);
 
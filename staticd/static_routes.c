@@ -500,8 +500,12 @@ static void static_fixup_vrf(struct static_vrf *svrf,
 				    != 0)
 					continue;
 
+				/* drop the tracking reference taken for the
+				 * previous vrf_id
+				 */
+				if (nh->nh_registered)
+					static_zebra_nht_register(nh, false);
 				nh->nh_vrf_id = svrf->vrf->vrf_id;
-				nh->nh_registered = false;
 				if (nh->ifindex) {
 					ifp = if_lookup_by_name(nh->ifname,
 								nh->nh_vrf_id);
@@ -78,6 +78,7 @@ enum static_install_states {
 
 PREDECL_DLIST(static_path_list);
 PREDECL_DLIST(static_nexthop_list);
+PREDECL_DLIST(static_nht_nexthops);
 
 /* Static route information */
 struct static_route_info {
@@ -133,6 +134,8 @@ struct static_nexthop {
 	ifindex_t ifindex;
 	bool nh_registered;
 	bool nh_valid;
+	/* While nh_registered, on the nexthops of the tracked address */
+	struct static_nht_nexthops_item nht_itm;
 
 	char ifname[INTERFACE_NAMSIZ + 1];
 
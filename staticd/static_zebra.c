@@ -58,8 +58,13 @@ struct static_nht_data {
 	uint32_t refcount;
 	uint8_t nh_num;
 	bool registered;
+
+	/* static nexthops using this, one per reference */
+	struct static_nht_nexthops_head nexthops;
 };
 
+DECLARE_DLIST(static_nht_nexthops, struct static_nexthop, nht_itm);
+
 static int static_nht_data_cmp(const struct static_nht_data *nhtd1,
 			       const struct static_nht_data *nhtd2)
 {
@@ -88,6 +93,29 @@ static struct static_nht_hash_head static_nht_hash[1];
 struct zclient *zclient;
 uint32_t zebra_ecmp_count = MULTIPATH_NUM;
 
+/*
+ * Routes and nexthop registrations sent while handling one event, e.g. a
+ * configuration commit or a nexthop update, go to zebra as one zclient
+ * batch.  zclient merges consecutive route adds that only differ in their
+ * prefix into ZEBRA_ROUTE_ADD_BULK messages.
+ */
+static struct thread *t_zebra_batch;
+
+static void static_zebra_batch_end(struct thread *thread)
+{
+	zclient_batch_end(zclient);
+}
+
+static void static_zebra_batch(void)
+{
+	if (t_zebra_batch)
+		return;
+
+	zclient_batch_start(zclient);
+	thread_add_event(master, static_zebra_batch_end, NULL, 0,
+			 &t_zebra_batch);
+}
+
 /* Interface addition message from zebra. */
 static int static_ifp_create(struct interface *ifp)
 {
@@ -204,16 +232,12 @@ static int static_zebra_nexthop_update(ZAPI_CALLBACK_ARGS)
 	struct static_nht_data *nhtd, lookup;
 	struct zapi_route nhr;
 	struct prefix matched;
-	afi_t afi = AFI_IP;
 
 	if (!zapi_nexthop_update_decode(zclient->ibuf, &matched, &nhr)) {
 		zlog_err("Failure to decode nexthop update message");
 		return 1;
 	}
 
-	if (matched.family == AF_INET6)
-		afi = AFI_IP6;
-
 	if (nhr.type == ZEBRA_ROUTE_CONNECT) {
 		if (static_nexthop_is_local(vrf_id, &matched,
 					    nhr.prefix.family))
@@ -228,12 +252,23 @@ static int static_zebra_nexthop_update(ZAPI_CALLBACK_ARGS)
 	nhtd = static_nht_hash_find(static_nht_hash, &lookup);
 
 	if (nhtd) {
+		struct static_nexthop *nh;
+
 		nhtd->nh_num = nhr.nexthop_num;
 
-		static_nht_reset_start(&matched, afi, nhr.safi,
-				       nhtd->nh_vrf_id);
-		static_nht_update(NULL, &matched, nhr.nexthop_num, afi,
-				  nhr.safi, nhtd->nh_vrf_id);
+		/*
+		 * Only the static nexthops using this address need to be
+		 * looked at; reset their state machine so that their routes
+		 * are sent again.  Sending one route moves all its nexthops
+		 * out of STATIC_START, so each route is sent once.
+		 */
+		frr_each (static_nht_nexthops, &nhtd->nexthops, nh) {
+			nh->state = STATIC_START;
+			nh->nh_valid = !!nhtd->nh_num;
+		}
+		frr_each (static_nht_nexthops, &nhtd->nexthops, nh)
+			if (nh->state == STATIC_START)
+				static_zebra_route_add(nh->pn, true);
 	} else
 		zlog_err("No nhtd?");
 
@@ -258,6 +293,7 @@ static_nht_hash_getref(const struct static_nht_data *ref)
 		prefix_copy(&nhtd->nh, &ref->nh);
 		nhtd->nh_vrf_id = ref->nh_vrf_id;
 		nhtd->safi = ref->safi;
+		static_nht_nexthops_init(&nhtd->nexthops);
 
 		static_nht_hash_add(static_nht_hash, nhtd);
 	}
@@ -276,6 +312,7 @@ static bool static_nht_hash_decref(struct static_nht_data **nhtd_p)
 		return true;
 
 	static_nht_hash_del(static_nht_hash, nhtd);
+	static_nht_nexthops_fini(&nhtd->nexthops);
 	XFREE(MTYPE_STATIC_NHT_DATA, nhtd);
 	return false;
 }
@@ -337,6 +374,7 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 			&lookup.nh);
 	} else if (reg) {
 		nhtd = static_nht_hash_getref(&lookup);
+		static_nht_nexthops_add_tail(&nhtd->nexthops, nh);
 
 		if (nhtd->refcount > 1)
 			DEBUGD(&static_dbg_route,
@@ -354,12 +392,11 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 	if (reg) {
 		if (nhtd->nh_num) {
 			/* refresh with existing data */
-			afi_t afi = prefix_afi(&lookup.nh);
-
 			if (nh->state == STATIC_NOT_INSTALLED)
 				nh->state = STATIC_START;
-			static_nht_update(&rn->p, &nhtd->nh, nhtd->nh_num, afi,
-					  si->safi, nh->nh_vrf_id);
+			nh->nh_valid = true;
+			if (nh->state == STATIC_START)
+				static_zebra_route_add(pn, true);
 			return;
 		}
 
@@ -374,6 +411,7 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 		bool was_zebra_registered;
 
 		was_zebra_registered = nhtd->registered;
+		static_nht_nexthops_del(&nhtd->nexthops, nh);
 		if (static_nht_hash_decref(&nhtd))
 			/* still got references alive */
 			return;
@@ -387,6 +425,7 @@ void static_zebra_nht_register(struct static_nexthop *nh, bool reg)
 		       "Unregistering nexthop(%pFX) for %pRN", &lookup.nh, rn);
 	}
 
+	static_zebra_batch();
 	if (zclient_send_rnh(zclient, cmd, &lookup.nh, si->safi, false, false,
 			     nh->nh_vrf_id) == ZCLIENT_SEND_FAILURE)
 		zlog_warn("%s: Failure to send nexthop %pFX for %pRN to zebra",
@@ -518,6 +557,7 @@ extern void static_zebra_route_add(struct static_path *pn, bool install)
 	if (!nh_num && install)
 		install = false;
 
+	static_zebra_batch();
 	zclient_route_send(install ?
 			   ZEBRA_ROUTE_ADD : ZEBRA_ROUTE_DELETE,
 			   zclient, &api);
@@ -555,6 +595,7 @@ void static_zebra_stop(void)
 
 	if (!zclient)
 		return;
+	THREAD_OFF(t_zebra_batch);
 	zclient_stop(zclient);
 	zclient_free(zclient);
 	zclient = NULL;
@@ -1262,15 +1262,16 @@ static int handle_attr_test(struct aspath_tests *t)
 		failed++;
 	}
 	if (t->shouldbe && attr.aspath
-	    && strcmp(attr.aspath->str, t->shouldbe)) {
+	    && strcmp(aspath_print(attr.aspath), t->shouldbe)) {
 		printf("attr str and 'shouldbe' mismatched!\n"
 		       "attr str:  %s\n"
 		       "shouldbe:  %s\n",
-		       attr.aspath->str, t->shouldbe);
+		       aspath_print(attr.aspath), t->shouldbe);
 		failed++;
 	}
 	if (!t->shouldbe && attr.aspath) {
-		printf("aspath should be NULL, but is: %s\n", attr.aspath->str);
+		printf("aspath should be NULL, but is: %s\n",
+		       aspath_print(attr.aspath));
 		failed++;
 	}
 
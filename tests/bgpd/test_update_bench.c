@@ -0,0 +1,834 @@
+/*
+ * BGP UPDATE ingest and advertise benchmark
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Replays a stream of BGP UPDATE messages into bgpd with fake peers and
+ * times the stages of the receive and advertise path separately:
+ *
+ *  parse     - bgp_attr_parse() of every UPDATE
+ *  intern    - bgp_attr_intern() of the parsed attributes
+ *  rib       - bgp_nlri_parse(), i.e. Adj-RIB-In and path insertion
+ *  bestpath  - running bgpd's process queue (best path selection and
+ *              update-group announcement)
+ *  advertise - subgroup_withdraw_packet()/subgroup_update_packet() and
+ *              the per-peer reformatting done by the write path
+ *
+ * The input is either a file of raw BGP messages (as sent on the wire,
+ * starting with the 16 byte marker) or an MRT file with BGP4MP messages,
+ * one fake peer being created per MRT peer.  Without a file, a synthetic
+ * table is generated.  Where the kernel allows it, cycles, instructions,
+ * cache and branch misses are reported per stage as well.
+ *
+ * This is not run as part of "make check".
+ */
+
+#include <zebra.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#endif
+
+#include "qobj.h"
+#include "vty.h"
+#include "stream.h"
+#include "privs.h"
+#include "memory.h"
+#include "queue.h"
+#include "filter.h"
+#include "workqueue.h"
+
+#include "bgpd/bgpd.h"
+#include "bgpd/bgp_attr.h"
+#include "bgpd/bgp_aspath.h"
+#include "bgpd/bgp_dump.h"
+#include "bgpd/bgp_packet.h"
+#include "bgpd/bgp_route.h"
+#include "bgpd/bgp_table.h"
+#include "bgpd/bgp_updgrp.h"
+#include "bgpd/bgp_network.h"
+
+/* need these to link in libbgp */
+struct zebra_privs_t bgpd_privs = {};
+struct thread_master *master = NULL;
+
+static struct bgp *bgp;
+static as_t asn = 64512;
+
+#define BENCH_PEERS_MAX 256
+
+struct bench_peer {
+	union sockunion su;
+	as_t as;
+	bool as4;
+	struct peer *peer;
+};
+
+static struct bench_peer in_peers[BENCH_PEERS_MAX];
+static unsigned int in_peer_count;
+
+static struct peer **out_peers;
+static unsigned int out_peer_count = 1;
+
+enum bench_nlri {
+	BENCH_NLRI_UPDATE,
+	BENCH_NLRI_WITHDRAW,
+	BENCH_NLRI_MP_UPDATE,
+	BENCH_NLRI_MP_WITHDRAW,
+	BENCH_NLRI_MAX
+};
+
+struct bench_update {
+	struct bench_peer *bp;
+	size_t offset;
+	bgp_size_t length;
+
+	enum bgp_attr_parse_ret ret;
+	struct attr attr;
+	struct attr *interned;
+	struct bgp_nlri nlris[BENCH_NLRI_MAX];
+};
+
+/* UPDATE bodies (without the BGP header), back to back */
+static struct stream *msgs;
+static struct bench_update *updates;
+static size_t update_count, update_alloc;
+
+/* Hardware counters */
+enum bench_hw {
+	BENCH_HW_CYCLES,
+	BENCH_HW_INSNS,
+	BENCH_HW_CACHE_MISSES,
+	BENCH_HW_BRANCH_MISSES,
+	BENCH_HW_MAX
+};
+
+static int hw_fd[BENCH_HW_MAX] = {-1, -1, -1, -1};
+
+struct bench_phase {
+	const char *name;
+	const char *unit;
+
+	uint64_t items;
+	struct timeval start;
+	int64_t usec;
+	uint64_t hw_start[BENCH_HW_MAX];
+	uint64_t hw[BENCH_HW_MAX];
+};
+
+enum {
+	PHASE_PARSE,
+	PHASE_INTERN,
+	PHASE_RIB,
+	PHASE_BESTPATH,
+	PHASE_ADVERTISE,
+	PHASE_MAX
+};
+
+static struct bench_phase phases[PHASE_MAX] = {
+	[PHASE_PARSE] = {.name = "parse", .unit = "msgs"},
+	[PHASE_INTERN] = {.name = "intern", .unit = "attrs"},
+	[PHASE_RIB] = {.name = "rib", .unit = "msgs"},
+	[PHASE_BESTPATH] = {.name = "bestpath", .unit = "dests"},
+	[PHASE_ADVERTISE] = {.name = "advertise", .unit = "pkts"},
+};
+
+static void bench_hw_init(void)
+{
+#ifdef __linux__
+	static const uint64_t config[BENCH_HW_MAX] = {
+		[BENCH_HW_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+		[BENCH_HW_INSNS] = PERF_COUNT_HW_INSTRUCTIONS,
+		[BENCH_HW_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+		[BENCH_HW_BRANCH_MISSES] = PERF_COUNT_HW_BRANCH_MISSES,
+	};
+	struct perf_event_attr pea;
+	int i;
+
+	for (i = 0; i < BENCH_HW_MAX; i++) {
+		memset(&pea, 0, sizeof(pea));
+		pea.type = PERF_TYPE_HARDWARE;
+		pea.size = sizeof(pea);
+		pea.config = config[i];
+		pea.exclude_kernel = 1;
+		pea.exclude_hv = 1;
+
+		hw_fd[i] = syscall(__NR_perf_event_open, &pea, 0, -1, -1, 0);
+	}
+#endif
+	if (hw_fd[BENCH_HW_CYCLES] < 0)
+		printf("hardware counters not available\n");
+}
+
+static void bench_hw_read(uint64_t *vals)
+{
+	int i;
+
+	for (i = 0; i < BENCH_HW_MAX; i++)
+		if (hw_fd[i] < 0
+		    || read(hw_fd[i], &vals[i], sizeof(vals[i]))
+			       != (ssize_t)sizeof(vals[i]))
+			vals[i] = 0;
+}
+
+static void bench_phase_start(struct bench_phase *ph)
+{
+	bench_hw_read(ph->hw_start);
+	monotime(&ph->start);
+}
+
+static void bench_phase_stop(struct bench_phase *ph)
+{
+	uint64_t now[BENCH_HW_MAX];
+	int i;
+
+	ph->usec += monotime_since(&ph->start, NULL);
+	bench_hw_read(now);
+	for (i = 0; i < BENCH_HW_MAX; i++)
+		ph->hw[i] += now[i] - ph->hw_start[i];
+}
+
+static void bench_report(void)
+{
+	struct bench_phase *ph;
+	double items;
+
+	printf("%-10s %10s %-6s %10s %12s", "phase", "count", "unit", "usec",
+	       "unit/s");
+	if (hw_fd[BENCH_HW_CYCLES] >= 0)
+		printf(" %10s %10s %5s %10s %10s", "cyc/unit", "insn/unit",
+		       "IPC", "cmiss/unit", "bmiss/unit");
+	printf("\n");
+
+	for (ph = phases; ph < phases + PHASE_MAX; ph++) {
+		items = ph->items ? ph->items : 1;
+		printf("%-10s %10" PRIu64 " %-6s %10" PRId64 " %12.0f",
+		       ph->name, ph->items, ph->unit, ph->usec,
+		       ph->usec ? ph->items * 1000000.0 / ph->usec : 0.0);
+		if (hw_fd[BENCH_HW_CYCLES] >= 0)
+			printf(" %10.0f %10.0f %5.2f %10.2f %10.2f",
+			       ph->hw[BENCH_HW_CYCLES] / items,
+			       ph->hw[BENCH_HW_INSNS] / items,
+			       ph->hw[BENCH_HW_CYCLES]
+				       ? (double)ph->hw[BENCH_HW_INSNS]
+						 / ph->hw[BENCH_HW_CYCLES]
+				       : 0.0,
+			       ph->hw[BENCH_HW_CACHE_MISSES] / items,
+			       ph->hw[BENCH_HW_BRANCH_MISSES] / items);
+		printf("\n");
+	}
+}
+
+/*
+ * Input handling
+ */
+static struct bench_peer *bench_peer_get(const union sockunion *su, as_t as,
+					 bool as4)
+{
+	struct bench_peer *bp;
+
+	for (bp = in_peers; bp < in_peers + in_peer_count; bp++)
+		if (sockunion_same(&bp->su, su))
+			return bp;
+
+	if (in_peer_count == BENCH_PEERS_MAX)
+		return NULL;
+
+	bp = &in_peers[in_peer_count++];
+	bp->su = *su;
+	bp->as = as;
+	bp->as4 = as4;
+	return bp;
+}
+
+static void bench_add_update(struct bench_peer *bp, const uint8_t *body,
+			     size_t len)
+{
+	struct bench_update *upd;
+
+	if (!bp)
+		return;
+
+	if (update_count == update_alloc) {
+		update_alloc = update_alloc ? update_alloc * 2 : 1024;
+		updates = XREALLOC(MTYPE_TMP, updates,
+				   update_alloc * sizeof(*updates));
+	}
+
+	upd = &updates[update_count++];
+	memset(upd, 0, sizeof(*upd));
+	upd->bp = bp;
+	upd->offset = stream_get_endp(msgs);
+	upd->length = len;
+	stream_put(msgs, body, len);
+}
+
+static bool bgp_msg_valid(const uint8_t *p, size_t avail, size_t *msglen)
+{
+	static const uint8_t marker[BGP_MARKER_SIZE] = {
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+		0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+	};
+
+	if (avail < BGP_HEADER_SIZE || memcmp(p, marker, sizeof(marker)))
+		return false;
+
+	*msglen = (p[16] << 8) | p[17];
+	return *msglen >= BGP_HEADER_SIZE && *msglen <= avail;
+}
+
+static void bench_load_raw(const uint8_t *buf, size_t len)
+{
+	struct bench_peer *bp;
+	union sockunion su = {};
+	size_t off = 0, msglen;
+
+	su.sin.sin_family = AF_INET;
+	su.sin.sin_addr.s_addr = htonl(0xc0000201); /* 192.0.2.1 */
+	bp = bench_peer_get(&su, 65001, true);
+
+	while (bgp_msg_valid(buf + off, len - off, &msglen)) {
+		if (buf[off + 18] == BGP_MSG_UPDATE)
+			bench_add_update(bp, buf + off + BGP_HEADER_SIZE,
+					 msglen - BGP_HEADER_SIZE);
+		off += msglen;
+	}
+
+	if (off != len)
+		printf("trailing garbage at offset %zu ignored\n", off);
+}
+
+static void bench_load_mrt(const uint8_t *buf, size_t len)
+{
+	size_t off = 0, mlen, msglen, iplen;
+	uint16_t type, subtype, afi;
+	const uint8_t *p, *end;
+	union sockunion su;
+	as_t as;
+	bool as4;
+
+	while (off + BGP_DUMP_HEADER_SIZE <= len) {
+		type = (buf[off + 4] << 8) | buf[off + 5];
+		subtype = (buf[off + 6] << 8) | buf[off + 7];
+		mlen = ((uint32_t)buf[off + 8] << 24) | (buf[off + 9] << 16)
+		       | (buf[off + 10] << 8) | buf[off + 11];
+		p = buf + off + BGP_DUMP_HEADER_SIZE;
+		if (mlen > len - off - BGP_DUMP_HEADER_SIZE)
+			break;
+		end = p + mlen;
+		off += BGP_DUMP_HEADER_SIZE + mlen;
+
+		if (type == MSG_PROTOCOL_BGP4MP_ET)
+			p += 4;
+		else if (type != MSG_PROTOCOL_BGP4MP)
+			continue;
+		if (subtype != BGP4MP_MESSAGE && subtype != BGP4MP_MESSAGE_AS4)
+			continue;
+
+		as4 = subtype == BGP4MP_MESSAGE_AS4;
+		if (p + (as4 ? 8 : 4) + 4 > end)
+			continue;
+		if (as4)
+			as = ((uint32_t)p[0] << 24) | (p[1] << 16) | (p[2] << 8)
+			     | p[3];
+		else
+			as = (p[0] << 8) | p[1];
+		p += as4 ? 8 : 4;
+
+		/* interface index, AFI */
+		afi = (p[2] << 8) | p[3];
+		p += 4;
+
+		memset(&su, 0, sizeof(su));
+		if (afi == IANA_AFI_IPV4) {
+			iplen = 4;
+			su.sin.sin_family = AF_INET;
+			if (p + 2 * iplen <= end)
+				memcpy(&su.sin.sin_addr, p, iplen);
+		} else if (afi == IANA_AFI_IPV6) {
+			iplen = 16;
+			su.sin6.sin6_family = AF_INET6;
+			if (p + 2 * iplen <= end)
+				memcpy(&su.sin6.sin6_addr, p, iplen);
+		} else
+			continue;
+		p += 2 * iplen;
+
+		if (p > end || !bgp_msg_valid(p, end - p, &msglen)
+		    || p[18] != BGP_MSG_UPDATE)
+			continue;
+
+		bench_add_update(bench_peer_get(&su, as, as4),
+				 p + BGP_HEADER_SIZE,
+				 msglen - BGP_HEADER_SIZE);
+	}
+}
+
+static int bench_load_file(const char *path)
+{
+	struct stat st;
+	uint8_t *buf;
+	FILE *f;
+	size_t len;
+
+	f = fopen(path, "r");
+	if (!f || fstat(fileno(f), &st) < 0) {
+		fprintf(stderr, "%s: %s\n", path, safe_strerror(errno));
+		if (f)
+			fclose(f);
+		return -1;
+	}
+
+	len = st.st_size;
+	buf = XMALLOC(MTYPE_TMP, len ? len : 1);
+	if (fread(buf, 1, len, f) != len) {
+		fprintf(stderr, "%s: short read\n", path);
+		fclose(f);
+		XFREE(MTYPE_TMP, buf);
+		return -1;
+	}
+	fclose(f);
+
+	msgs = stream_new(len ? len : 1);
+
+	if (len >= BGP_MARKER_SIZE && buf[0] == 0xff && buf[15] == 0xff)
+		bench_load_raw(buf, len);
+	else
+		bench_load_mrt(buf, len);
+
+	XFREE(MTYPE_TMP, buf);
+	return 0;
+}
+
+/*
+ * Synthetic input: `prefixes` /24s out of 16.0.0.0/4, `per_update` of them
+ * per UPDATE, cycling through `paths` different AS paths and a handful of
+ * community sets.
+ */
+static void bench_generate(unsigned int prefixes, unsigned int per_update,
+			   unsigned int paths)
+{
+	struct bench_peer *bp;
+	union sockunion su = {};
+	struct stream *s;
+	unsigned int i, n, k, hops;
+	size_t attrlen_pos;
+	uint32_t addr;
+
+	su.sin.sin_family = AF_INET;
+	su.sin.sin_addr.s_addr = htonl(0xc0000201); /* 192.0.2.1 */
+	bp = bench_peer_get(&su, 65001, true);
+
+	msgs = stream_new(((prefixes + per_update - 1) / per_update + 1)
+			  * BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE);
+	s = stream_new(BGP_STANDARD_MESSAGE_MAX_PACKET_SIZE);
+
+	for (i = 0, k = 0; i < prefixes; k++) {
+		stream_reset(s);
+
+		/* withdrawn routes length */
+		stream_putw(s, 0);
+		attrlen_pos = stream_get_endp(s);
+		stream_putw(s, 0);
+
+		stream_putc(s, BGP_ATTR_FLAG_TRANS);
+		stream_putc(s, BGP_ATTR_ORIGIN);
+		stream_putc(s, 1);
+		stream_putc(s, BGP_ORIGIN_IGP);
+
+		hops = 2 + k % 4;
+		stream_putc(s, BGP_ATTR_FLAG_TRANS);
+		stream_putc(s, BGP_ATTR_AS_PATH);
+		stream_putc(s, 2 + hops * 4);
+		stream_putc(s, AS_SEQUENCE);
+		stream_putc(s, hops);
+		stream_putl(s, bp->as);
+		for (n = 1; n < hops; n++)
+			stream_putl(s, 65100 + (k % paths) * 4 + n);
+
+		stream_putc(s, BGP_ATTR_FLAG_TRANS);
+		stream_putc(s, BGP_ATTR_NEXT_HOP);
+		stream_putc(s, 4);
+		stream_put_in_addr(s, &su.sin.sin_addr);
+
+		stream_putc(s, BGP_ATTR_FLAG_OPTIONAL | BGP_ATTR_FLAG_TRANS);
+		stream_putc(s, BGP_ATTR_COMMUNITIES);
+		stream_putc(s, 8);
+		stream_putl(s, (bp->as << 16) | (k % 8));
+		stream_putl(s, (bp->as << 16) | 1000);
+
+		stream_putw_at(s, attrlen_pos,
+			       stream_get_endp(s) - attrlen_pos - 2);
+
+		for (n = 0; n < per_update && i < prefixes; n++, i++) {
+			addr = (16U << 24) + (i << 8);
+			stream_putc(s, 24);
+			stream_putc(s, addr >> 24);
+			stream_putc(s, addr >> 16);
+			stream_putc(s, addr >> 8);
+		}
+
+		bench_add_update(bp, STREAM_DATA(s), stream_get_endp(s));
+	}
+
+	stream_free(s);
+}
+
+/*
+ * Fake peers
+ */
+static void bench_peers_create(void)
+{
+	struct bench_peer *bp;
+	union sockunion su = {};
+	struct peer_af *paf;
+	struct peer *peer;
+	unsigned int i;
+	afi_t afi;
+
+	for (bp = in_peers; bp < in_peers + in_peer_count; bp++) {
+		peer = peer_create(&bp->su, NULL, bgp, asn, bp->as,
+				   AS_SPECIFIED, NULL, true);
+		peer_activate(peer, AFI_IP6, SAFI_UNICAST);
+		peer->status = Established;
+		if (bp->as4)
+			SET_FLAG(peer->cap,
+				 PEER_CAP_AS4_RCV | PEER_CAP_AS4_ADV);
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+			peer->afc_nego[afi][SAFI_UNICAST] = 1;
+		peer->curr = msgs;
+		bp->peer = peer;
+	}
+
+	out_peers = XCALLOC(MTYPE_TMP, out_peer_count * sizeof(*out_peers));
+	for (i = 0; i < out_peer_count; i++) {
+		su.sin.sin_family = AF_INET;
+		/* 198.51.100.1 and up */
+		su.sin.sin_addr.s_addr = htonl(0xc6336401 + i);
+		peer = peer_create(&su, NULL, bgp, asn, 65000, AS_SPECIFIED,
+				   NULL, true);
+		peer_activate(peer, AFI_IP6, SAFI_UNICAST);
+		peer->status = Established;
+		SET_FLAG(peer->cap, PEER_CAP_AS4_RCV | PEER_CAP_AS4_ADV);
+
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+			peer->afc_nego[afi][SAFI_UNICAST] = 1;
+			paf = peer_af_find(peer, afi, SAFI_UNICAST);
+			update_group_adjust_peer(paf);
+		}
+		out_peers[i] = peer;
+	}
+}
+
+/*
+ * Stages
+ */
+static void bench_parse(void)
+{
+	struct bench_phase *ph = &phases[PHASE_PARSE];
+	struct bench_update *upd;
+	struct peer *peer;
+	bgp_size_t withdraw_len, attribute_len;
+	size_t end;
+
+	bench_phase_start(ph);
+	for (upd = updates; upd < updates + update_count; upd++) {
+		peer = upd->bp->peer;
+		stream_set_getp(msgs, upd->offset);
+		end = upd->offset + upd->length;
+
+		memset(&upd->attr, 0, sizeof(upd->attr));
+		upd->attr.label_index = BGP_INVALID_LABEL_INDEX;
+		upd->attr.label = MPLS_INVALID_LABEL;
+
+		if (upd->length < 4)
+			goto malformed;
+
+		withdraw_len = stream_getw(msgs);
+		if (stream_get_getp(msgs) + withdraw_len + 2 > end)
+			goto malformed;
+		if (withdraw_len) {
+			upd->nlris[BENCH_NLRI_WITHDRAW].afi = AFI_IP;
+			upd->nlris[BENCH_NLRI_WITHDRAW].safi = SAFI_UNICAST;
+			upd->nlris[BENCH_NLRI_WITHDRAW].nlri = stream_pnt(msgs);
+			upd->nlris[BENCH_NLRI_WITHDRAW].length = withdraw_len;
+			stream_forward_getp(msgs, withdraw_len);
+		}
+
+		attribute_len = stream_getw(msgs);
+		if (stream_get_getp(msgs) + attribute_len > end)
+			goto malformed;
+		if (attribute_len) {
+			upd->ret = bgp_attr_parse(
+				peer, &upd->attr, attribute_len,
+				&upd->nlris[BENCH_NLRI_MP_UPDATE],
+				&upd->nlris[BENCH_NLRI_MP_WITHDRAW]);
+			if (upd->ret == BGP_ATTR_PARSE_ERROR) {
+				/* we don't want the session to go down */
+				peer->status = Established;
+				bgp_attr_unintern_sub(&upd->attr);
+				goto malformed;
+			}
+		}
+
+		if (stream_get_getp(msgs) < end) {
+			upd->nlris[BENCH_NLRI_UPDATE].afi = AFI_IP;
+			upd->nlris[BENCH_NLRI_UPDATE].safi = SAFI_UNICAST;
+			upd->nlris[BENCH_NLRI_UPDATE].nlri = stream_pnt(msgs);
+			upd->nlris[BENCH_NLRI_UPDATE].length =
+				end - stream_get_getp(msgs);
+		}
+		ph->items++;
+		continue;
+
+	malformed:
+		upd->ret = BGP_ATTR_PARSE_ERROR;
+		memset(upd->nlris, 0, sizeof(upd->nlris));
+	}
+	bench_phase_stop(ph);
+
+	if (ph->items != update_count)
+		printf("%zu malformed UPDATEs skipped\n",
+		       update_count - (size_t)ph->items);
+}
+
+static void bench_intern(void)
+{
+	struct bench_phase *ph = &phases[PHASE_INTERN];
+	struct bench_update *upd;
+
+	bench_phase_start(ph);
+	for (upd = updates; upd < updates + update_count; upd++) {
+		if (upd->ret != BGP_ATTR_PARSE_PROCEED || !upd->attr.flag)
+			continue;
+		upd->interned = bgp_attr_intern(&upd->attr);
+		ph->items++;
+	}
+	bench_phase_stop(ph);
+}
+
+static void bench_rib(void)
+{
+	struct bench_phase *ph = &phases[PHASE_RIB];
+	struct bench_update *upd;
+	struct bgp_nlri *nlri;
+	struct peer *peer;
+	struct attr *attr;
+	int i;
+
+	bench_phase_start(ph);
+	for (upd = updates; upd < updates + update_count; upd++) {
+		if (upd->ret == BGP_ATTR_PARSE_ERROR)
+			continue;
+
+		peer = upd->bp->peer;
+		attr = upd->ret == BGP_ATTR_PARSE_WITHDRAW ? NULL : &upd->attr;
+		for (i = 0; i < BENCH_NLRI_MAX; i++) {
+			nlri = &upd->nlris[i];
+			if (!nlri->nlri || !nlri->length
+			    || !peer->afc[nlri->afi][nlri->safi])
+				continue;
+
+			if (i == BENCH_NLRI_WITHDRAW
+			    || i == BENCH_NLRI_MP_WITHDRAW)
+				bgp_nlri_parse(peer, &upd->attr, nlri, 1);
+			else
+				bgp_nlri_parse(peer, attr, nlri, 0);
+		}
+		ph->items++;
+	}
+	bench_phase_stop(ph);
+}
+
+static void bench_bestpath(void)
+{
+	struct bench_phase *ph = &phases[PHASE_BESTPATH];
+	struct work_queue *wq = bgp->process_queue;
+	struct thread t = {};
+	struct bgp_dest *dest;
+	afi_t afi;
+
+	/*
+	 * Run the process queue directly rather than through the event loop:
+	 * that would also run the write path we want to measure separately.
+	 */
+	pthread_mutex_init(&t.mtx, NULL);
+	t.arg = wq;
+	t.yield = ULONG_MAX / 2;
+
+	bench_phase_start(ph);
+	while (!work_queue_empty(wq)) {
+		monotime(&t.real);
+		work_queue_run(&t);
+	}
+	bench_phase_stop(ph);
+
+	pthread_mutex_destroy(&t.mtx);
+
+	for (afi = AFI_IP; afi <= AFI_IP6; afi++)
+		for (dest = bgp_table_top(bgp->rib[afi][SAFI_UNICAST]); dest;
+		     dest = bgp_route_next(dest))
+			if (bgp_dest_has_bgp_path_info_data(dest))
+				ph->items++;
+}
+
+static void bench_advertise(void)
+{
+	struct bench_phase *ph = &phases[PHASE_ADVERTISE];
+	struct update_subgroup *subgrp;
+	struct bpacket *pkt;
+	struct peer_af *paf;
+	struct stream *s;
+	uint64_t bytes = 0;
+	unsigned int i;
+	afi_t afi;
+
+	bench_phase_start(ph);
+	for (i = 0; i < out_peer_count; i++) {
+		for (afi = AFI_IP; afi <= AFI_IP6; afi++) {
+			paf = peer_af_find(out_peers[i], afi, SAFI_UNICAST);
+			if (!paf || !PAF_SUBGRP(paf))
+				continue;
+			subgrp = PAF_SUBGRP(paf);
+
+			/* same sequence as bgp_generate_updgrp_packets() */
+			for (;;) {
+				pkt = paf->next_pkt_to_send;
+				if (!pkt || !pkt->buffer) {
+					pkt = subgroup_withdraw_packet(subgrp);
+					if (!pkt || !pkt->buffer)
+						subgroup_update_packet(subgrp);
+					pkt = paf->next_pkt_to_send;
+				}
+				if (!pkt || !pkt->buffer)
+					break;
+
+				s = bpacket_reformat_for_peer(pkt, paf);
+				bytes += stream_get_endp(s);
+				stream_free(s);
+				bpacket_queue_advance_peer(paf);
+				ph->items++;
+			}
+		}
+	}
+	bench_phase_stop(ph);
+
+	printf("%" PRIu64 " bytes advertised to %u peer(s)\n", bytes,
+	       out_peer_count);
+}
+
+static void bench_cleanup(void)
+{
+	struct bench_update *upd;
+
+	for (upd = updates; upd < updates + update_count; upd++) {
+		if (upd->interned)
+			bgp_attr_unintern(&upd->interned);
+		if (upd->ret != BGP_ATTR_PARSE_ERROR)
+			bgp_attr_unintern_sub(&upd->attr);
+	}
+	XFREE(MTYPE_TMP, updates);
+	XFREE(MTYPE_TMP, out_peers);
+	stream_free(msgs);
+}
+
+static void usage(const char *progname)
+{
+	fprintf(stderr,
+		"usage: %s [-n prefixes] [-p prefixes-per-update] [-a paths]\n"
+		"       [-o peers] [FILE]\n"
+		"\n"
+		"FILE is either raw BGP messages or MRT (BGP4MP) data;\n"
+		"without it, a table of synthetic routes is generated.\n",
+		progname);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned int prefixes = 100000, per_update = 50, paths = 1000;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "n:p:a:o:h")) != -1) {
+		switch (opt) {
+		case 'n':
+			prefixes = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			per_update = strtoul(optarg, NULL, 10);
+			break;
+		case 'a':
+			paths = strtoul(optarg, NULL, 10);
+			break;
+		case 'o':
+			out_peer_count = strtoul(optarg, NULL, 10);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	/* 4096 byte UPDATEs only hold ~900 /24s with the generated attrs */
+	if (!per_update || per_update > 900 || !paths || !out_peer_count)
+		usage(argv[0]);
+
+	qobj_init();
+	bgp_attr_init();
+	master = thread_master_create("update bench");
+	bgp_master_init(master, BGP_SOCKET_SNDBUF_SIZE, list_new());
+	vrf_init(NULL, NULL, NULL, NULL);
+	bgp_option_set(BGP_OPT_NO_LISTEN);
+	bgp_option_set(BGP_OPT_NO_FIB);
+
+	if (optind < argc) {
+		if (bench_load_file(argv[optind]) < 0)
+			return 1;
+	} else
+		bench_generate(prefixes, per_update, paths);
+
+	if (!update_count) {
+		fprintf(stderr, "no UPDATE messages found\n");
+		return 1;
+	}
+
+	if (bgp_get(&bgp, &asn, NULL, BGP_INSTANCE_TYPE_DEFAULT) < 0)
+		return 1;
+
+	/* announce right away, and without policy towards eBGP peers */
+	bgp->heuristic_coalesce = false;
+	bgp->coalesce_time = 0;
+	UNSET_FLAG(bgp->flags, BGP_FLAG_EBGP_REQUIRES_POLICY);
+
+	bench_peers_create();
+	bench_hw_init();
+
+	printf("%zu UPDATEs from %u peer(s)\n", update_count, in_peer_count);
+
+	bench_parse();
+	bench_intern();
+	bench_rib();
+	bench_bestpath();
+	bench_advertise();
+
+	bench_report();
+	bench_cleanup();
+
+	return 0;
+}
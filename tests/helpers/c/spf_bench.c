@@ -0,0 +1,402 @@
+/*
+ * Synthetic topologies and timing for the SPF benchmarks
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <assert.h>
+#include <math.h>
+
+#include "monotime.h"
+#include "json.h"
+
+#include "prng.h"
+#include "spf_bench.h"
+
+static struct prng *prng;
+
+static const char *const topo_names[] = {
+	[SPF_BENCH_GRID] = "grid",
+	[SPF_BENCH_CLOS] = "clos",
+	[SPF_BENCH_RANDOM] = "random",
+};
+
+static void usage(const char *progname, int status)
+{
+	fprintf(status ? stderr : stdout,
+		"usage: %s [-t grid|clos|random] [-n NODES] [-d DEGREE]\n"
+		"       [-p PREFIXES] [-r RUNS] [-s SEED] [-N] [-j FILE]\n"
+		"       [-b BASELINE] [-T TOLERANCE]\n"
+		"\n"
+		"  -t  topology (grid)\n"
+		"  -n  number of nodes (1000)\n"
+		"  -d  average degree of a random topology (4), number of\n"
+		"      spines of a Clos topology (4)\n"
+		"  -p  prefixes advertised per node (4)\n"
+		"  -r  runs per phase (10)\n"
+		"  -s  random seed (1)\n"
+		"  -N  TI-LFA node protection instead of link protection\n"
+		"  -j  write the results to FILE as JSON\n"
+		"  -b  compare against the JSON results of an earlier run and\n"
+		"      fail if a phase got slower by more than TOLERANCE\n"
+		"  -T  tolerance for -b (0.1, i.e. 10%%)\n",
+		progname);
+	exit(status);
+}
+
+void spf_bench_parse_args(struct spf_bench_opts *opts, int argc, char **argv)
+{
+	int opt, i;
+
+	memset(opts, 0, sizeof(*opts));
+	opts->topo = SPF_BENCH_GRID;
+	opts->nodes = 1000;
+	opts->degree = 4;
+	opts->prefixes = 4;
+	opts->runs = 10;
+	opts->seed = 1;
+	opts->tolerance = 0.1;
+
+	while ((opt = getopt(argc, argv, "t:n:d:p:r:s:Nj:b:T:h")) != -1) {
+		switch (opt) {
+		case 't':
+			for (i = 0; i < (int)array_size(topo_names); i++)
+				if (strmatch(optarg, topo_names[i]))
+					break;
+			if (i == (int)array_size(topo_names))
+				usage(argv[0], 1);
+			opts->topo = i;
+			break;
+		case 'n':
+			opts->nodes = strtoul(optarg, NULL, 10);
+			break;
+		case 'd':
+			opts->degree = strtoul(optarg, NULL, 10);
+			break;
+		case 'p':
+			opts->prefixes = strtoul(optarg, NULL, 10);
+			break;
+		case 'r':
+			opts->runs = strtoul(optarg, NULL, 10);
+			break;
+		case 's':
+			opts->seed = strtoull(optarg, NULL, 10);
+			break;
+		case 'N':
+			opts->node_protection = true;
+			break;
+		case 'j':
+			opts->json_file = optarg;
+			break;
+		case 'b':
+			opts->baseline_file = optarg;
+			break;
+		case 'T':
+			opts->tolerance = strtod(optarg, NULL);
+			break;
+		case 'h':
+			usage(argv[0], 0);
+			break;
+		default:
+			usage(argv[0], 1);
+		}
+	}
+
+	/* the addressing plan has room for 2^18 nodes of 16 prefixes */
+	if (opts->nodes < 2 || opts->nodes > (1U << 18) || !opts->degree
+	    || !opts->prefixes || opts->prefixes > 16 || !opts->runs)
+		usage(argv[0], 1);
+	if (opts->topo == SPF_BENCH_CLOS && opts->degree >= opts->nodes)
+		usage(argv[0], 1);
+}
+
+uint32_t spf_bench_random(void)
+{
+	return prng_rand(prng);
+}
+
+static void graph_add_link(struct spf_bench_graph *graph, uint32_t *alloc,
+			   uint32_t a, uint32_t b, uint32_t metric)
+{
+	struct spf_bench_link *link;
+
+	if (graph->link_count == *alloc) {
+		*alloc = *alloc ? *alloc * 2 : 1024;
+		graph->links = realloc(graph->links,
+				       *alloc * sizeof(*graph->links));
+		assert(graph->links);
+	}
+
+	link = &graph->links[graph->link_count++];
+	link->from = MIN(a, b);
+	link->to = MAX(a, b);
+	link->metric = metric;
+}
+
+static int link_cmp(const void *a, const void *b)
+{
+	const struct spf_bench_link *la = a, *lb = b;
+
+	if (la->from != lb->from)
+		return la->from < lb->from ? -1 : 1;
+	if (la->to != lb->to)
+		return la->to < lb->to ? -1 : 1;
+	return 0;
+}
+
+/* Randomly added links may duplicate others, keep the first one only */
+static void graph_dedup(struct spf_bench_graph *graph)
+{
+	uint32_t i, n = 0;
+
+	qsort(graph->links, graph->link_count, sizeof(*graph->links),
+	      link_cmp);
+	for (i = 0; i < graph->link_count; i++) {
+		if (n && !link_cmp(&graph->links[n - 1], &graph->links[i]))
+			continue;
+		graph->links[n++] = graph->links[i];
+	}
+	graph->link_count = n;
+}
+
+static void graph_index(struct spf_bench_graph *graph)
+{
+	uint32_t *fill;
+	uint32_t i, n;
+
+	graph->adj_first = calloc(graph->node_count + 1, sizeof(uint32_t));
+	graph->adj = calloc(2 * graph->link_count, sizeof(uint32_t));
+	fill = calloc(graph->node_count, sizeof(uint32_t));
+	assert(graph->adj_first && graph->adj && fill);
+
+	for (i = 0; i < graph->link_count; i++) {
+		graph->adj_first[graph->links[i].from + 1]++;
+		graph->adj_first[graph->links[i].to + 1]++;
+	}
+	for (n = 0; n < graph->node_count; n++)
+		graph->adj_first[n + 1] += graph->adj_first[n];
+	for (i = 0; i < graph->link_count; i++) {
+		n = graph->links[i].from;
+		graph->adj[graph->adj_first[n] + fill[n]++] = i;
+		n = graph->links[i].to;
+		graph->adj[graph->adj_first[n] + fill[n]++] = i;
+	}
+
+	free(fill);
+}
+
+struct spf_bench_graph *spf_bench_graph_new(const struct spf_bench_opts *opts)
+{
+	struct spf_bench_graph *graph;
+	uint32_t alloc = 0, n, i, cols, spines, leaves, target;
+
+	prng = prng_new(opts->seed);
+
+	graph = calloc(1, sizeof(*graph));
+	assert(graph);
+	graph->node_count = opts->nodes;
+	n = opts->nodes;
+
+	switch (opts->topo) {
+	case SPF_BENCH_GRID:
+		/* rows of `cols` nodes, the last one possibly shorter */
+		cols = ceil(sqrt(n));
+		for (i = 0; i < n; i++) {
+			if ((i + 1) % cols && i + 1 < n)
+				graph_add_link(graph, &alloc, i, i + 1, 10);
+			if (i + cols < n)
+				graph_add_link(graph, &alloc, i, i + cols, 10);
+		}
+		break;
+	case SPF_BENCH_CLOS:
+		/* leaf-spine, leaves first so that the root is a leaf */
+		spines = opts->degree;
+		leaves = n - spines;
+		for (i = 0; i < leaves; i++)
+			for (uint32_t s = 0; s < spines; s++)
+				graph_add_link(graph, &alloc, i, leaves + s,
+					       10);
+		break;
+	case SPF_BENCH_RANDOM:
+		/* a random spanning tree, then random links up to degree */
+		for (i = 1; i < n; i++)
+			graph_add_link(graph, &alloc, i, prng_rand(prng) % i,
+				       1 + prng_rand(prng) % 64);
+		target = (uint64_t)n * opts->degree / 2;
+		while (graph->link_count < target) {
+			uint32_t a = prng_rand(prng) % n;
+			uint32_t b = prng_rand(prng) % n;
+
+			if (a == b)
+				continue;
+			graph_add_link(graph, &alloc, a, b,
+				       1 + prng_rand(prng) % 64);
+		}
+		graph_dedup(graph);
+		break;
+	}
+
+	graph_index(graph);
+	return graph;
+}
+
+void spf_bench_graph_free(struct spf_bench_graph *graph)
+{
+	free(graph->links);
+	free(graph->adj_first);
+	free(graph->adj);
+	free(graph);
+	prng_free(prng);
+	prng = NULL;
+}
+
+void spf_bench_start(struct spf_bench *bench, const char *phase)
+{
+	struct spf_bench_phase *ph = NULL;
+	unsigned int i;
+
+	for (i = 0; i < bench->phase_count; i++)
+		if (strmatch(bench->phases[i].name, phase))
+			ph = &bench->phases[i];
+	if (!ph) {
+		assert(bench->phase_count < SPF_BENCH_PHASES_MAX);
+		ph = &bench->phases[bench->phase_count++];
+		ph->name = phase;
+		ph->min_usec = UINT64_MAX;
+	}
+
+	bench->current = ph;
+	monotime(&bench->t_start);
+}
+
+void spf_bench_stop(struct spf_bench *bench)
+{
+	struct spf_bench_phase *ph = bench->current;
+	uint64_t usec = monotime_since(&bench->t_start, NULL);
+
+	ph->runs++;
+	ph->total_usec += usec;
+	ph->min_usec = MIN(ph->min_usec, usec);
+	ph->max_usec = MAX(ph->max_usec, usec);
+	bench->current = NULL;
+}
+
+static uint64_t phase_avg(const struct spf_bench_phase *ph)
+{
+	return ph->runs ? ph->total_usec / ph->runs : 0;
+}
+
+static int spf_bench_compare(struct spf_bench *bench)
+{
+	const struct spf_bench_opts *opts = bench->opts;
+	struct json_object *base, *jphases, *jphase, *javg;
+	struct spf_bench_phase *ph;
+	unsigned int i;
+	int64_t avg;
+	int ret = 0;
+
+	base = json_object_from_file(opts->baseline_file);
+	if (!base) {
+		fprintf(stderr, "%s: cannot read baseline\n",
+			opts->baseline_file);
+		return 1;
+	}
+
+	if (!json_object_object_get_ex(base, "phases", &jphases)) {
+		json_object_put(base);
+		return 0;
+	}
+
+	printf("\ncompared to %s:\n", opts->baseline_file);
+	for (i = 0; i < bench->phase_count; i++) {
+		ph = &bench->phases[i];
+		if (!json_object_object_get_ex(jphases, ph->name, &jphase)
+		    || !json_object_object_get_ex(jphase, "avgUsec", &javg))
+			continue;
+		avg = json_object_get_int64(javg);
+		if (avg <= 0)
+			continue;
+
+		printf("  %-10s %+.1f%%\n", ph->name,
+		       100.0 * ((double)phase_avg(ph) - avg) / avg);
+		if (phase_avg(ph) > avg * (1.0 + opts->tolerance)) {
+			printf("  %-10s regressed: %" PRIu64
+			       "us vs %" PRId64 "us\n",
+			       ph->name, phase_avg(ph), avg);
+			ret = 1;
+		}
+	}
+
+	json_object_put(base);
+	return ret;
+}
+
+int spf_bench_report(struct spf_bench *bench)
+{
+	const struct spf_bench_opts *opts = bench->opts;
+	struct json_object *json, *jphases, *jphase;
+	struct spf_bench_phase *ph;
+	unsigned int i;
+
+	printf("%s %s topology: %u nodes, %u links, %lu routes\n\n",
+	       bench->protocol, topo_names[opts->topo],
+	       bench->graph->node_count, bench->graph->link_count,
+	       bench->routes);
+	printf("  %-10s %6s %12s %12s %12s\n", "phase", "runs", "avg (us)",
+	       "min (us)", "max (us)");
+	for (i = 0; i < bench->phase_count; i++) {
+		ph = &bench->phases[i];
+		printf("  %-10s %6u %12" PRIu64 " %12" PRIu64 " %12" PRIu64
+		       "\n",
+		       ph->name, ph->runs, phase_avg(ph), ph->min_usec,
+		       ph->max_usec);
+	}
+
+	if (opts->json_file) {
+		json = json_object_new_object();
+		json_object_string_add(json, "protocol", bench->protocol);
+		json_object_string_add(json, "topology",
+				       topo_names[opts->topo]);
+		json_object_int_add(json, "nodes", bench->graph->node_count);
+		json_object_int_add(json, "links", bench->graph->link_count);
+		json_object_int_add(json, "routes", bench->routes);
+		jphases = json_object_new_object();
+		for (i = 0; i < bench->phase_count; i++) {
+			ph = &bench->phases[i];
+			jphase = json_object_new_object();
+			json_object_int_add(jphase, "runs", ph->runs);
+			json_object_int_add(jphase, "avgUsec", phase_avg(ph));
+			json_object_int_add(jphase, "minUsec", ph->min_usec);
+			json_object_int_add(jphase, "maxUsec", ph->max_usec);
+			json_object_object_add(jphases, ph->name, jphase);
+		}
+		json_object_object_add(json, "phases", jphases);
+		if (json_object_to_file_ext(opts->json_file, json,
+					    JSON_C_TO_STRING_PRETTY) < 0)
+			fprintf(stderr, "%s: cannot write results\n",
+				opts->json_file);
+		json_object_free(json);
+	}
+
+	if (opts->baseline_file)
+		return spf_bench_compare(bench);
+
+	return 0;
+}
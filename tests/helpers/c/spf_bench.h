@@ -0,0 +1,117 @@
+/*
+ * Synthetic topologies and timing for the SPF benchmarks
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#ifndef _SPF_BENCH_H
+#define _SPF_BENCH_H
+
+enum spf_bench_topo {
+	SPF_BENCH_GRID,
+	SPF_BENCH_CLOS,
+	SPF_BENCH_RANDOM,
+};
+
+/* Point-to-point link between two nodes, from < to */
+struct spf_bench_link {
+	uint32_t from;
+	uint32_t to;
+	uint32_t metric;
+};
+
+/*
+ * The links of node n are links[adj[i]] for i in
+ * [adj_first[n], adj_first[n + 1]).  Node 0 is the root.
+ */
+struct spf_bench_graph {
+	uint32_t node_count;
+	uint32_t link_count;
+	struct spf_bench_link *links;
+	uint32_t *adj_first;
+	uint32_t *adj;
+};
+
+static inline uint32_t spf_bench_peer(const struct spf_bench_link *link,
+				      uint32_t node)
+{
+	return link->from == node ? link->to : link->from;
+}
+
+struct spf_bench_opts {
+	enum spf_bench_topo topo;
+	uint32_t nodes;
+	/* random: average degree, Clos: number of spines */
+	unsigned int degree;
+	/* prefixes advertised per node, the first is the loopback */
+	unsigned int prefixes;
+	unsigned int runs;
+	unsigned long long seed;
+	bool node_protection;
+	const char *json_file;
+	const char *baseline_file;
+	double tolerance;
+};
+
+#define SPF_BENCH_PHASES_MAX 8
+
+struct spf_bench_phase {
+	const char *name;
+	unsigned int runs;
+	uint64_t total_usec;
+	uint64_t min_usec;
+	uint64_t max_usec;
+};
+
+struct spf_bench {
+	const char *protocol;
+	const struct spf_bench_opts *opts;
+	const struct spf_bench_graph *graph;
+	/* number of routes in the table, reported once */
+	unsigned long routes;
+
+	struct spf_bench_phase phases[SPF_BENCH_PHASES_MAX];
+	unsigned int phase_count;
+	struct spf_bench_phase *current;
+	struct timeval t_start;
+};
+
+/*
+ * Parses the options common to all SPF benchmarks, printing `usage` and
+ * exiting on error.
+ */
+extern void spf_bench_parse_args(struct spf_bench_opts *opts, int argc,
+				 char **argv);
+
+extern struct spf_bench_graph *
+spf_bench_graph_new(const struct spf_bench_opts *opts);
+extern void spf_bench_graph_free(struct spf_bench_graph *graph);
+
+/* Deterministic pseudo random number for the prefix changes */
+extern uint32_t spf_bench_random(void);
+
+extern void spf_bench_start(struct spf_bench *bench, const char *phase);
+extern void spf_bench_stop(struct spf_bench *bench);
+
+/*
+ * Prints the results, writes them to the JSON file and compares them
+ * against the baseline, if given.  Returns the exit code: non-zero if a
+ * phase got slower than the baseline by more than the tolerance.
+ */
+extern int spf_bench_report(struct spf_bench *bench);
+
+#endif /* _SPF_BENCH_H */
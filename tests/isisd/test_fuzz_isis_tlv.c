@@ -111,6 +111,26 @@ static int test(FILE *input, FILE *output)
 	const char *s_tlvs = isis_format_tlvs(tlvs, NULL);
 	fprintf(output, "Unpacked TLVs:\n%s", s_tlvs);
 
+	/* Decoding sub-TLVs on demand has to give the same result */
+	char *eager_tlvs = XSTRDUP(MTYPE_TMP, s_tlvs);
+	struct isis_tlvs *lazy_tlvs;
+
+	stream_set_getp(s, 0);
+	rv = isis_unpack_tlvs_lazy(STREAM_READABLE(s), s, &lazy_tlvs, &log);
+	if (rv) {
+		fprintf(output, "Could not lazily unpack TLVs:\n%s\n", log);
+		assert(0);
+	}
+
+	s_tlvs = isis_format_tlvs(lazy_tlvs, NULL);
+	if (strcmp(eager_tlvs, s_tlvs)) {
+		fprintf(output, "Lazily unpacked TLVs seem to differ.\n");
+		fprintf(output, "Lazily Unpacked TLVs:\n%s", s_tlvs);
+		assert(0);
+	}
+	isis_free_tlvs(lazy_tlvs);
+	XFREE(MTYPE_TMP, eager_tlvs);
+
 	struct isis_item *orig_auth = tlvs->isis_auth.head;
 	tlvs->isis_auth.head = NULL;
 	s_tlvs = isis_format_tlvs(tlvs, NULL);
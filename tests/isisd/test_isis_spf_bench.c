@@ -0,0 +1,330 @@
+/*
+ * IS-IS SPF benchmark
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Generates a grid, Clos or random topology of level-2 LSPs with Segment
+ * Routing and times, from the point of view of node 0:
+ *
+ *  spf     - isis_run_spf() on a new SPT
+ *  install - isis_route_verify_table() of all routes of that SPT
+ *  prc     - isis_run_prc() after one system advertised another prefix
+ *  update  - isis_route_verify_table() after that
+ *  tilfa   - reverse SPF, neighbor SPFs and TI-LFA for every adjacency
+ *
+ * Routes are sent to zebra through a zclient writing to /dev/null, so that
+ * install includes the ZAPI encoding.  This is not run as part of
+ * "make check".
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "vty.h"
+#include "command.h"
+#include "log.h"
+#include "table.h"
+#include "yang.h"
+#include "zclient.h"
+
+#include "isisd/isisd.h"
+#include "isisd/isis_lsp.h"
+#include "isisd/isis_mt.h"
+#include "isisd/isis_route.h"
+#include "isisd/isis_spf.h"
+#include "isisd/isis_spf_private.h"
+#include "isisd/isis_zebra.h"
+
+#include "test_common.h"
+#include "spf_bench.h"
+
+static struct spf_bench_opts opts;
+static struct spf_bench_graph *graph;
+static struct spf_bench bench = {
+	.protocol = "isis",
+	.opts = &opts,
+};
+
+#define BENCH_SRGB_LOWER_BOUND 16000
+
+static void node_sysid(uint32_t node, uint8_t *sysid)
+{
+	memset(sysid, 0, ISIS_SYS_ID_LEN);
+	sysid[2] = (node + 1) >> 24;
+	sysid[3] = (node + 1) >> 16;
+	sysid[4] = (node + 1) >> 8;
+	sysid[5] = node + 1;
+}
+
+static void node_prefix(uint32_t node, unsigned int idx,
+			struct prefix_ipv4 *p)
+{
+	memset(p, 0, sizeof(*p));
+	p->family = AF_INET;
+	if (idx == 0) {
+		/* loopback out of 10.0.0.0/8 */
+		p->prefixlen = IPV4_MAX_BITLEN;
+		p->prefix.s_addr = htonl((10U << 24) + node + 1);
+	} else {
+		/* /24s from 20.0.0.0 on */
+		p->prefixlen = 24;
+		p->prefix.s_addr = htonl(
+			(20U << 24)
+			+ ((node * (opts.prefixes - 1) + idx - 1) << 8));
+	}
+}
+
+static void lsp_add_node(struct isis_area *area, struct lspdb_head *lspdb,
+			 uint32_t node)
+{
+	struct isis_router_cap cap = {};
+	struct sr_prefix_cfg pcfg = {};
+	struct nlpids nlpids = {.count = 1, .nlpids = {NLPID_IP}};
+	uint8_t lspid[ISIS_SYS_ID_LEN + 2];
+	uint8_t neighbor[ISIS_SYS_ID_LEN + 1];
+	mpls_label_t next_label = 16;
+	struct isis_lsp *lsp;
+	struct prefix_ipv4 p;
+	uint32_t i;
+
+	node_sysid(node, lspid);
+	LSP_PSEUDO_ID(lspid) = 0;
+	LSP_FRAGMENT(lspid) = 0;
+
+	lsp = lsp_new(area, lspid, 6000, 1, 0, 0, NULL, ISIS_LEVEL2);
+	lsp->tlvs = isis_alloc_tlvs();
+	lspdb_add(lspdb, lsp);
+
+	isis_tlvs_add_mt_router_info(lsp->tlvs, ISIS_MT_IPV4_UNICAST, 0,
+				     false);
+	isis_tlvs_set_protocols_supported(lsp->tlvs, &nlpids);
+
+	cap.router_id.s_addr = htonl((10U << 24) + node + 1);
+	cap.srgb.flags = ISIS_SUBTLV_SRGB_FLAG_I | ISIS_SUBTLV_SRGB_FLAG_V;
+	cap.srgb.lower_bound = BENCH_SRGB_LOWER_BOUND;
+	cap.srgb.range_size = graph->node_count + 1;
+	cap.algo[0] = SR_ALGORITHM_SPF;
+	cap.algo[1] = SR_ALGORITHM_UNSET;
+	isis_tlvs_set_router_capability(lsp->tlvs, &cap);
+
+	/* Prefix-SID on the loopback */
+	for (i = 0; i < opts.prefixes; i++) {
+		node_prefix(node, i, &p);
+		pcfg.sid = node + 1;
+		pcfg.sid_type = SR_SID_VALUE_TYPE_INDEX;
+		pcfg.node_sid = true;
+		pcfg.last_hop_behavior = SR_LAST_HOP_BEHAVIOR_PHP;
+		isis_tlvs_add_extended_ip_reach(lsp->tlvs, &p, 10, false,
+						i == 0 ? &pcfg : NULL);
+	}
+
+	/* Adj-SID on every adjacency */
+	for (i = graph->adj_first[node]; i < graph->adj_first[node + 1];
+	     i++) {
+		const struct spf_bench_link *link;
+		struct isis_ext_subtlvs *ext;
+		struct isis_adj_sid *adj_sid;
+
+		link = &graph->links[graph->adj[i]];
+
+		adj_sid = XCALLOC(MTYPE_ISIS_SUBTLV, sizeof(*adj_sid));
+		adj_sid->family = AF_INET;
+		SET_FLAG(adj_sid->flags, EXT_SUBTLV_LINK_ADJ_SID_VFLG);
+		SET_FLAG(adj_sid->flags, EXT_SUBTLV_LINK_ADJ_SID_LFLG);
+		adj_sid->sid = next_label++;
+		ext = isis_alloc_ext_subtlvs();
+		isis_tlvs_add_adj_sid(ext, adj_sid);
+
+		node_sysid(spf_bench_peer(link, node), neighbor);
+		LSP_PSEUDO_ID(neighbor) = 0;
+		isis_tlvs_add_extended_reach(lsp->tlvs, ISIS_MT_IPV4_UNICAST,
+					     neighbor, link->metric, ext);
+	}
+}
+
+static struct isis_lsp *lsp_find_node(struct lspdb_head *lspdb,
+				      uint32_t node)
+{
+	uint8_t lspid[ISIS_SYS_ID_LEN + 2];
+
+	node_sysid(node, lspid);
+	LSP_PSEUDO_ID(lspid) = 0;
+	LSP_FRAGMENT(lspid) = 0;
+
+	return lsp_search(lspdb, lspid);
+}
+
+static struct isis_spftree *bench_spftree(struct isis_area *area,
+					  struct lspdb_head *lspdb)
+{
+	return isis_spftree_new(area, lspdb, area->isis->sysid, ISIS_LEVEL2,
+				SPFTREE_IPV4, SPF_TYPE_FORWARD,
+				F_SPFTREE_NO_ADJACENCIES);
+}
+
+static void bench_verify(struct isis_area *area, struct isis_spftree *tree)
+{
+	isis_route_verify_table(area, tree->route_table,
+				tree->route_table_backup);
+}
+
+static void bench_tilfa(struct isis_area *area, struct isis_spftree *tree)
+{
+	struct isis_spftree *spftree_reverse, *spftree_pc;
+	struct isis_spf_node *adj_node;
+
+	spftree_reverse = isis_spf_reverse_run(tree);
+	isis_spf_run_neighbors(tree);
+
+	RB_FOREACH (adj_node, isis_spf_nodes, &tree->adj_nodes) {
+		struct lfa_protected_resource resource = {};
+
+		resource.type = opts.node_protection ? LFA_NODE_PROTECTION
+						     : LFA_LINK_PROTECTION;
+		memcpy(resource.adjacency, adj_node->sysid, ISIS_SYS_ID_LEN);
+		LSP_PSEUDO_ID(resource.adjacency) = 0;
+
+		spftree_pc = isis_tilfa_compute(area, tree, spftree_reverse,
+						&resource);
+		isis_spftree_del(spftree_pc);
+	}
+
+	isis_spftree_del(spftree_reverse);
+}
+
+static int bench_run(void)
+{
+	struct isis_area *area;
+	struct lspdb_head *lspdb;
+	struct isis_spftree *tree = NULL;
+	unsigned int run, prc_fallbacks = 0;
+	struct isis_lsp *lsp;
+	struct prefix_ipv4 p;
+	uint32_t i;
+
+	area = isis_area_create("1", NULL);
+	node_sysid(0, area->isis->sysid);
+	area->is_type = IS_LEVEL_2;
+	area->srdb.enabled = true;
+	lspdb = &area->lspdb[ISIS_LEVEL2 - 1];
+
+	for (i = 0; i < graph->node_count; i++)
+		lsp_add_node(area, lspdb, i);
+
+	/* Full SPF and installing all routes of a new tree */
+	for (run = 0; run < opts.runs; run++) {
+		if (tree)
+			isis_spftree_del(tree);
+		tree = bench_spftree(area, lspdb);
+
+		spf_bench_start(&bench, "spf");
+		isis_run_spf(tree);
+		spf_bench_stop(&bench);
+
+		spf_bench_start(&bench, "install");
+		bench_verify(area, tree);
+		spf_bench_stop(&bench);
+	}
+	bench.routes = tree->route_table->count;
+
+	/* One more prefix on some other system per run */
+	for (run = 0; run < opts.runs; run++) {
+		lsp = lsp_find_node(lspdb,
+				    1 + spf_bench_random()
+						% (graph->node_count - 1));
+		memset(&p, 0, sizeof(p));
+		p.family = AF_INET;
+		p.prefixlen = IPV4_MAX_BITLEN;
+		p.prefix.s_addr = htonl((200U << 24) + run);
+		isis_tlvs_add_extended_ip_reach(lsp->tlvs, &p, 10, false,
+						NULL);
+
+		isis_spf_invalidate_routes(tree);
+
+		spf_bench_start(&bench, "prc");
+		if (!isis_run_prc(tree)) {
+			isis_run_spf(tree);
+			prc_fallbacks++;
+		}
+		spf_bench_stop(&bench);
+
+		spf_bench_start(&bench, "update");
+		bench_verify(area, tree);
+		spf_bench_stop(&bench);
+	}
+	if (prc_fallbacks)
+		printf("%u of %u partial route calculations fell back to SPF\n",
+		       prc_fallbacks, opts.runs);
+
+	for (run = 0; run < opts.runs; run++) {
+		/* TI-LFA needs the neighbor trees of a fresh run */
+		isis_spf_invalidate_routes(tree);
+		isis_run_spf(tree);
+
+		spf_bench_start(&bench, "tilfa");
+		bench_tilfa(area, tree);
+		spf_bench_stop(&bench);
+	}
+
+	isis_spftree_del(tree);
+	isis_area_destroy(area);
+
+	return spf_bench_report(&bench);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	spf_bench_parse_args(&opts, argc, argv);
+
+	/* master init. */
+	master = thread_master_create(NULL);
+	isis_master_init(master);
+
+	/* Library inits. */
+	cmd_init(1);
+	cmd_hostname_set("test");
+	vty_init(master, false);
+	yang_init(true, false);
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+
+	/* IS-IS inits. */
+	yang_module_load("frr-isisd");
+	SET_FLAG(im->options, F_ISIS_UNIT_TEST);
+
+	zclient = zclient_new(master, &zclient_options_default, NULL, 0);
+	zclient->sock = open("/dev/null", O_WRONLY);
+
+	graph = spf_bench_graph_new(&opts);
+	bench.graph = graph;
+	ret = bench_run();
+	spf_bench_graph_free(graph);
+
+	close(zclient->sock);
+	zclient->sock = -1;
+	zclient_free(zclient);
+	zclient = NULL;
+
+	cmd_terminate();
+	vty_terminate();
+	yang_terminate();
+	thread_master_free(master);
+
+	return ret;
+}
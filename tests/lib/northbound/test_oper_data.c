@@ -132,11 +132,12 @@ static const void *frr_test_module_vrfs_vrf_interfaces_interface_get_next(
 /*
  * XPath: /frr-test-module:frr-test-module/vrfs/vrf/routes/route
  */
-static const void *
-frr_test_module_vrfs_vrf_routes_route_get_next(struct nb_cb_get_next_args *args)
+static size_t frr_test_module_vrfs_vrf_routes_route_get_next_batch(
+	struct nb_cb_get_next_batch_args *args)
 {
 	const struct tvrf *vrf;
 	struct listnode *node;
+	size_t num = 0;
 
 	vrf = listgetdata((struct listnode *)args->parent_list_entry);
 	if (args->list_entry == NULL)
@@ -144,7 +145,10 @@ frr_test_module_vrfs_vrf_routes_route_get_next(struct nb_cb_get_next_args *args)
 	else
 		node = listnextnode((struct listnode *)args->list_entry);
 
-	return node;
+	for (; node && num < args->max_entries; node = listnextnode(node))
+		args->entries[num++] = node;
+
+	return num;
 }
 
 /*
@@ -233,7 +237,7 @@ const struct frr_yang_module_info frr_test_module_info = {
 		},
 		{
 			.xpath = "/frr-test-module:frr-test-module/vrfs/vrf/routes/route",
-			.cbs.get_next = frr_test_module_vrfs_vrf_routes_route_get_next,
+			.cbs.get_next_batch = frr_test_module_vrfs_vrf_routes_route_get_next_batch,
 		},
 		{
 			.xpath = "/frr-test-module:frr-test-module/vrfs/vrf/routes/route/prefix",
@@ -0,0 +1,116 @@
+/*
+ * Lock-free ring tests.
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <zebra.h>
+#include <pthread.h>
+#include <sched.h>
+
+#include "atomring.h"
+
+#define NITEM 20000
+#define NTHREADS 4
+#define RINGSIZE 64
+
+static uintptr_t items[NITEM];
+static atomic_size_t seen[NITEM];
+static atomic_size_t popped;
+static struct atomring *ring;
+
+static void *producer(void *arg)
+{
+	uintptr_t offset = (uintptr_t)arg;
+	size_t i;
+
+	for (i = offset; i < NITEM; i += NTHREADS)
+		while (!atomring_push(ring, &items[i]))
+			sched_yield();
+	return NULL;
+}
+
+static void *consumer(void *arg)
+{
+	uintptr_t *item;
+
+	while (atomic_load_explicit(&popped, memory_order_relaxed) < NITEM) {
+		item = atomring_pop(ring);
+		if (!item) {
+			sched_yield();
+			continue;
+		}
+
+		atomic_fetch_add_explicit(&seen[*item], 1,
+					  memory_order_relaxed);
+		atomic_fetch_add_explicit(&popped, 1, memory_order_relaxed);
+	}
+	return NULL;
+}
+
+int main(int argc, char **argv)
+{
+	pthread_t prod[NTHREADS], cons[NTHREADS];
+	uintptr_t i;
+
+	for (i = 0; i < NITEM; i++)
+		items[i] = i;
+
+	printf("Validating size rounding...\n");
+	ring = atomring_new(RINGSIZE - 1);
+	assert(atomring_size(ring) == RINGSIZE);
+	assert(atomring_count(ring) == 0);
+	assert(atomring_pop(ring) == NULL);
+
+	printf("Validating FIFO order and full ring...\n");
+	for (i = 0; i < RINGSIZE; i++)
+		assert(atomring_push(ring, &items[i]));
+	assert(atomring_count(ring) == RINGSIZE);
+	assert(!atomring_push(ring, &items[RINGSIZE]));
+
+	for (i = 0; i < RINGSIZE / 2; i++)
+		assert(atomring_pop(ring) == &items[i]);
+
+	printf("Validating wraparound...\n");
+	for (i = RINGSIZE; i < RINGSIZE * 3 / 2; i++)
+		assert(atomring_push(ring, &items[i]));
+	assert(!atomring_push(ring, &items[i]));
+	for (i = RINGSIZE / 2; i < RINGSIZE * 3 / 2; i++)
+		assert(atomring_pop(ring) == &items[i]);
+	assert(atomring_pop(ring) == NULL);
+	assert(atomring_count(ring) == 0);
+
+	printf("Validating %d producers vs. %d consumers...\n", NTHREADS,
+	       NTHREADS);
+	for (i = 0; i < NTHREADS; i++) {
+		pthread_create(&prod[i], NULL, producer, (void *)i);
+		pthread_create(&cons[i], NULL, consumer, NULL);
+	}
+	for (i = 0; i < NTHREADS; i++) {
+		pthread_join(prod[i], NULL);
+		pthread_join(cons[i], NULL);
+	}
+
+	for (i = 0; i < NITEM; i++)
+		assert(atomic_load_explicit(&seen[i], memory_order_relaxed)
+		       == 1);
+	assert(atomring_pop(ring) == NULL);
+
+	atomring_free(&ring);
+	assert(ring == NULL);
+
+	printf("Done.\n");
+	return 0;
+}
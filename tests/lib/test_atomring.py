@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestAtomring(frrtest.TestMultiOut):
+    program = "./test_atomring"
+
+
+TestAtomring.exit_cleanly()
@@ -23,6 +23,7 @@
 #include <time.h>
 
 #include "checksum.h"
+#include "monotime.h"
 #include "network.h"
 #include "prng.h"
 
@@ -460,6 +461,62 @@ static int /* return checksum in low-order 16 bits */
 	return ~sum;
 }
 
+/* Compare the lib functions against the reference ones above.  Run as
+ * "test_checksum bench"; the default mode is the endless verification loop.
+ */
+static void bench_one(const char *name, uint8_t *buffer, size_t len,
+		      unsigned int iters, int which)
+{
+	struct timeval start;
+	unsigned int i;
+	volatile int res = 0;
+	int64_t usec;
+
+	monotime(&start);
+	for (i = 0; i < iters; i++) {
+		switch (which) {
+		case 0:
+			res = in_cksum_rfc(buffer, len);
+			break;
+		case 1:
+			res = in_cksum(buffer, len);
+			break;
+		case 2:
+			res = ospfd_checksum(buffer, len, len - 2);
+			break;
+		case 3:
+			res = fletcher_checksum(buffer, len, len - 2);
+			break;
+		}
+	}
+	usec = monotime_since(&start, NULL);
+	(void)res;
+
+	printf("%-20s %6zu bytes: %8.1f ns/call %8.2f MB/s\n", name, len,
+	       usec * 1000.0 / iters,
+	       usec ? (double)len * iters / usec : 0.0);
+}
+
+static void bench(uint8_t *buffer, size_t bufsize, struct prng *prng)
+{
+	static const size_t lens[] = {64, 1500, 9000, 60000};
+	static const char *const names[] = {
+		"in_cksum (rfc1071)", "in_cksum (lib)",
+		"fletcher (ospfd)", "fletcher (lib)",
+	};
+	size_t i, j;
+
+	for (i = 0; i < bufsize; i++)
+		buffer[i] = prng_rand(prng);
+
+	for (i = 0; i < array_size(lens); i++) {
+		unsigned int iters = (64U << 20) / lens[i];
+
+		assert(lens[i] <= bufsize);
+		for (j = 0; j < array_size(names); j++)
+			bench_one(names[j], buffer, lens[i], iters, j);
+	}
+}
 
 int main(int argc, char **argv)
 {
@@ -471,6 +528,11 @@ int main(int argc, char **argv)
 #define EXERCISESTEP 257
 	struct prng *prng = prng_new(0);
 
+	if (argc > 1 && !strcmp(argv[1], "bench")) {
+		bench(buffer, sizeof(buffer), prng);
+		return 0;
+	}
+
 	while (1) {
 		uint16_t ospfd, isisd, lib, in_csum, in_csum_res, in_csum_rfc;
 		int i;
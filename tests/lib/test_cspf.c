@@ -0,0 +1,228 @@
+/*
+ * Constrained Shortest Path First tests.
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+#include <zebra.h>
+
+#include "linklist.h"
+#include "prefix.h"
+#include "stream.h"
+#include "link_state.h"
+#include "cspf.h"
+
+/*
+ * Test topology, OSPF metrics, bandwidth of 10 except A-B which has 1:
+ *
+ *      1     1
+ *   A --- B --- D
+ *    \         /
+ *   5 \       / 1
+ *      \     /
+ *        C --
+ */
+#define NODES 4
+#define BW_HIGH 10.0
+#define BW_LOW 1.0
+
+static struct ls_ted *ted;
+static struct ls_node_id adv[NODES];
+
+static struct in_addr rid(int n)
+{
+	struct in_addr addr = { .s_addr = htonl(0x0a000001 + n) };
+
+	return addr;
+}
+
+static void add_node(int n)
+{
+	struct ls_node *node;
+	struct prefix p = { .family = AF_INET, .prefixlen = IPV4_MAX_BITLEN };
+
+	adv[n].origin = OSPFv2;
+	adv[n].id.ip.addr = rid(n);
+
+	node = ls_node_new(adv[n], rid(n), in6addr_any);
+	assert(ls_vertex_add(ted, node));
+
+	p.u.prefix4 = rid(n);
+	assert(ls_subnet_add(ted, ls_prefix_new(adv[n], p)));
+}
+
+static struct ls_attributes *link_attr(int from, int to, uint32_t metric,
+				       float bw)
+{
+	struct ls_attributes *attr;
+	struct in_addr local, remote;
+	int i;
+
+	/* 10.<from+1>.<to+1>.1 on the "from" side */
+	local.s_addr = htonl(0x0a000001 | (from + 1) << 16 | (to + 1) << 8);
+	remote.s_addr = htonl(0x0a000001 | (to + 1) << 16 | (from + 1) << 8);
+
+	attr = ls_attributes_new(adv[from], local, in6addr_any, 0);
+	assert(attr);
+	attr->standard.remote = remote;
+	SET_FLAG(attr->flags, LS_ATTR_NEIGH_ADDR);
+	attr->metric = metric;
+	SET_FLAG(attr->flags, LS_ATTR_METRIC);
+	attr->standard.max_bw = bw;
+	attr->standard.max_rsv_bw = bw;
+	for (i = 0; i < 8; i++)
+		attr->standard.unrsv_bw[i] = bw;
+	SET_FLAG(attr->flags,
+		 LS_ATTR_MAX_BW | LS_ATTR_MAX_RSV_BW | LS_ATTR_UNRSV_BW);
+
+	return attr;
+}
+
+static void add_link(int a, int b, uint32_t metric, float bw)
+{
+	assert(ls_edge_add(ted, link_attr(a, b, metric, bw)));
+	assert(ls_edge_add(ted, link_attr(b, a, metric, bw)));
+}
+
+/* Compute with the given workspace, or a temporary one if NULL */
+static struct c_path *compute(struct cspf *algo, int src, int dst,
+			      uint32_t cost, float bw)
+{
+	struct constraints csts = {
+		.ctype = CSPF_METRIC,
+		.cost = cost,
+		.bw = bw,
+		.type = RSVP_TE,
+	};
+	struct cspf *work;
+	struct c_path *path;
+
+	work = cspf_init_v4(algo, ted, rid(src), rid(dst), &csts);
+	path = compute_p2p_path(work, ted);
+	if (!algo)
+		cspf_del(work);
+	return path;
+}
+
+/* Check status, cost and the sequence of vertices of a computed path */
+static void check(struct c_path *path, enum path_status status,
+		  uint32_t weight, const char *hops)
+{
+	struct listnode *node;
+	struct ls_edge *edge;
+	char buf[NODES + 1];
+	size_t len = 0;
+
+	assert(path);
+	assert(path->status == status);
+	if (status != SUCCESS) {
+		cspf_path_del(path);
+		return;
+	}
+
+	assert(path->weight == weight);
+	for (ALL_LIST_ELEMENTS_RO(path->edges, node, edge)) {
+		assert(len < NODES);
+		buf[len++] = 'A' + (ntohl(edge->destination->node->router_id
+						  .s_addr) -
+				    0x0a000001);
+	}
+	buf[len] = '\0';
+	assert(!strcmp(buf, hops));
+
+	cspf_path_del(path);
+}
+
+int main(int argc, char **argv)
+{
+	struct cspf *algo;
+	const struct ls_graph *graph;
+	struct ls_attributes *attr;
+	struct ls_edge *edge;
+	uint64_t generation;
+	int i;
+
+	ted = ls_ted_new(1, "test", 0);
+	for (i = 0; i < NODES; i++)
+		add_node(i);
+	add_link(0, 1, 1, BW_LOW);
+	add_link(1, 3, 1, BW_HIGH);
+	add_link(0, 2, 5, BW_HIGH);
+	add_link(2, 3, 1, BW_HIGH);
+
+	printf("Validating graph...\n");
+	graph = ls_ted_graph(ted);
+	assert(graph->nvertices == NODES);
+	assert(graph->nlinks == 8);
+	for (i = 0; i < NODES; i++)
+		assert(graph->vertices[i]->index == (uint32_t)i);
+	assert(graph->offset[NODES] == graph->nlinks);
+	assert(graph->generation == ted->generation);
+	assert(ls_ted_graph(ted) == graph);
+
+	printf("Validating shortest path...\n");
+	check(compute(NULL, 0, 3, 100, 0.0), SUCCESS, 2, "BD");
+	check(compute(NULL, 3, 0, 100, 0.0), SUCCESS, 2, "BA");
+
+	printf("Validating constraints...\n");
+	check(compute(NULL, 0, 3, 100, 5.0), SUCCESS, 6, "CD");
+	check(compute(NULL, 0, 3, 5, 5.0), FAILED, 0, NULL);
+	check(compute(NULL, 0, 3, 1, 0.0), FAILED, 0, NULL);
+	check(compute(NULL, 0, 0, 100, 0.0), SAME_SRC_DST, 0, NULL);
+
+	printf("Validating workspace reuse...\n");
+	algo = cspf_new();
+	for (i = 0; i < 1000; i++) {
+		check(compute(algo, 0, 3, 100, 0.0), SUCCESS, 2, "BD");
+		check(compute(algo, 0, 3, 100, 5.0), SUCCESS, 6, "CD");
+		check(compute(algo, 1, 2, 100, 0.0), SUCCESS, 2, "DC");
+	}
+	assert(algo->used == 0);
+	assert(algo->nchunks == 1);
+
+	printf("Validating path cache...\n");
+	cspf_cache_set(algo, 16);
+	check(compute(algo, 0, 3, 100, 5.0), SUCCESS, 6, "CD");
+	check(compute(algo, 0, 3, 5, 5.0), FAILED, 0, NULL);
+	assert(cspf_cache_count(&algo->cache) == 2);
+	check(compute(algo, 0, 3, 100, 5.0), SUCCESS, 6, "CD");
+	assert(cspf_cache_count(&algo->cache) == 2);
+
+	/* A cheaper A-C link must invalidate the cached results */
+	generation = ted->generation;
+	assert(ls_edge_update(ted, link_attr(0, 2, 1, BW_HIGH)));
+	assert(ted->generation != generation);
+	assert(ted->graph.generation != ted->generation);
+	check(compute(algo, 0, 3, 100, 5.0), SUCCESS, 2, "CD");
+	assert(cspf_cache_count(&algo->cache) == 1);
+
+	/* Unchanged attributes leave the TED generation alone */
+	generation = ted->generation;
+	attr = link_attr(0, 2, 1, BW_HIGH);
+	edge = ls_edge_update(ted, attr);
+	assert(edge && edge->attributes != attr);
+	ls_attributes_del(attr);
+	assert(ted->generation == generation);
+
+	cspf_cache_set(algo, 0);
+	assert(cspf_cache_count(&algo->cache) == 0);
+	cspf_del(algo);
+
+	ls_ted_del_all(&ted);
+	assert(ted == NULL);
+
+	printf("Done.\n");
+	return 0;
+}
@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestCspf(frrtest.TestMultiOut):
+    program = "./test_cspf"
+
+
+TestCspf.exit_cleanly()
@@ -0,0 +1,584 @@
+/*
+ * Event loop scalability benchmark
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Measures the latency of the thread_master event loop under load, using
+ * nothing but the public API, so that it runs against any I/O or timer
+ * backend:
+ *
+ *  fd     - N socketpairs with a read task each; every round a random
+ *           share of them becomes readable.  Reports the time from the
+ *           write to the read task running, and for the whole round.
+ *  timer  - M sessions with a jittered keepalive timer each, which on
+ *           expiry cancels and rearms the session's hold timer, like
+ *           bgpd does on receiving a KEEPALIVE.  Reports how late the
+ *           keepalives ran and what cancel + rearm cost.
+ *  event  - P pthreads adding events to the main thread_master with
+ *           thread_add_event().  Reports the rate and the time from the
+ *           add to the event running.
+ *
+ * This is not run as part of "make check".
+ */
+
+#include <zebra.h>
+
+#include <pthread.h>
+#include <sys/resource.h>
+
+#include "thread.h"
+#include "network.h"
+#include "frratomic.h"
+#include "prng.h"
+
+struct thread_master *master;
+
+static struct prng *prng;
+static bool done;
+
+static struct {
+	unsigned int fds;
+	unsigned int ready_pct;
+	unsigned int rounds;
+	unsigned int timers;
+	unsigned int keepalive_msec;
+	unsigned int duration_sec;
+	bool coarse;
+	unsigned int producers;
+	unsigned int events;
+	unsigned int window;
+} opts = {
+	.fds = 1000,
+	.ready_pct = 10,
+	.rounds = 1000,
+	.timers = 10000,
+	.keepalive_msec = 1000,
+	.duration_sec = 5,
+	.producers = 4,
+	.events = 100000,
+	.window = 1000,
+};
+
+static uint64_t now_nsec(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/* Latency samples -------------------------------------------------------- */
+
+struct lat {
+	const char *name;
+	uint64_t *v;
+	size_t count;
+	size_t size;
+};
+
+static void lat_add(struct lat *lat, uint64_t nsec)
+{
+	if (lat->count == lat->size) {
+		lat->size = lat->size ? lat->size * 2 : 4096;
+		lat->v = realloc(lat->v, lat->size * sizeof(*lat->v));
+		assert(lat->v);
+	}
+	lat->v[lat->count++] = nsec;
+}
+
+static int lat_cmp(const void *a, const void *b)
+{
+	uint64_t va = *(const uint64_t *)a, vb = *(const uint64_t *)b;
+
+	return va < vb ? -1 : va > vb;
+}
+
+static double lat_pct(const struct lat *lat, unsigned int permille)
+{
+	size_t idx = (lat->count - 1) * permille / 1000;
+
+	return lat->v[idx] / 1000.0;
+}
+
+static void lat_print_header(void)
+{
+	printf("%-22s %9s %9s %9s %9s %9s %9s %9s\n", "usec", "count", "min",
+	       "p50", "p90", "p99", "p99.9", "max");
+}
+
+static void lat_print(struct lat *lat)
+{
+	if (!lat->count) {
+		printf("%-22s %9u\n", lat->name, 0);
+		return;
+	}
+
+	qsort(lat->v, lat->count, sizeof(*lat->v), lat_cmp);
+	printf("%-22s %9zu %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f\n", lat->name,
+	       lat->count, lat_pct(lat, 0), lat_pct(lat, 500),
+	       lat_pct(lat, 900), lat_pct(lat, 990), lat_pct(lat, 999),
+	       lat_pct(lat, 1000));
+}
+
+static void lat_free(struct lat *lat)
+{
+	free(lat->v);
+	lat->v = NULL;
+	lat->count = lat->size = 0;
+}
+
+static void bench_loop(void)
+{
+	struct thread thread;
+
+	done = false;
+	while (!done && thread_fetch(master, &thread))
+		thread_call(&thread);
+}
+
+/* N fds with mixed readiness --------------------------------------------- */
+
+struct fd_reader {
+	int fd[2];
+	uint64_t t_write;
+	struct thread *t_read;
+};
+
+static struct fd_reader *readers;
+static unsigned int *reader_order;
+static unsigned int fd_round, fd_pending;
+static uint64_t fd_round_start;
+static struct lat lat_fd_read = {.name = "fd write to read"};
+static struct lat lat_fd_round = {.name = "fd round"};
+
+static void fd_round_start_cb(struct thread *thread);
+
+static void fd_read_cb(struct thread *thread)
+{
+	struct fd_reader *r = THREAD_ARG(thread);
+	uint64_t now = now_nsec();
+	char c;
+
+	if (read(r->fd[0], &c, 1) != 1)
+		abort();
+	thread_add_read(master, fd_read_cb, r, r->fd[0], &r->t_read);
+	lat_add(&lat_fd_read, now - r->t_write);
+
+	if (--fd_pending)
+		return;
+
+	lat_add(&lat_fd_round, now - fd_round_start);
+	if (++fd_round < opts.rounds)
+		thread_add_event(master, fd_round_start_cb, NULL, 0, NULL);
+	else
+		done = true;
+}
+
+static void fd_round_start_cb(struct thread *thread)
+{
+	unsigned int ready, i, j, tmp;
+
+	ready = MAX(opts.fds * opts.ready_pct / 100, 1U);
+
+	/* the first `ready` entries of a partial shuffle */
+	for (i = 0; i < ready; i++) {
+		j = i + prng_rand(prng) % (opts.fds - i);
+		tmp = reader_order[i];
+		reader_order[i] = reader_order[j];
+		reader_order[j] = tmp;
+	}
+
+	fd_pending = ready;
+	fd_round_start = now_nsec();
+	for (i = 0; i < ready; i++) {
+		struct fd_reader *r = &readers[reader_order[i]];
+
+		r->t_write = now_nsec();
+		if (write(r->fd[1], "x", 1) != 1)
+			abort();
+	}
+}
+
+static void bench_fd(void)
+{
+	unsigned int i;
+
+	printf("\n%u fds, %u%% ready per round, %u rounds\n", opts.fds,
+	       opts.ready_pct, opts.rounds);
+
+	readers = calloc(opts.fds, sizeof(*readers));
+	reader_order = calloc(opts.fds, sizeof(*reader_order));
+	for (i = 0; i < opts.fds; i++) {
+		struct fd_reader *r = &readers[i];
+
+		if (socketpair(AF_UNIX, SOCK_DGRAM, 0, r->fd) < 0) {
+			fprintf(stderr, "socketpair: %s (raise ulimit -n?)\n",
+				strerror(errno));
+			exit(1);
+		}
+		set_nonblocking(r->fd[0]);
+		thread_add_read(master, fd_read_cb, r, r->fd[0], &r->t_read);
+		reader_order[i] = i;
+	}
+
+	fd_round = 0;
+	thread_add_event(master, fd_round_start_cb, NULL, 0, NULL);
+	bench_loop();
+
+	lat_print_header();
+	lat_print(&lat_fd_read);
+	lat_print(&lat_fd_round);
+
+	for (i = 0; i < opts.fds; i++) {
+		THREAD_OFF(readers[i].t_read);
+		close(readers[i].fd[0]);
+		close(readers[i].fd[1]);
+	}
+	free(reader_order);
+	free(readers);
+	lat_free(&lat_fd_read);
+	lat_free(&lat_fd_round);
+}
+
+/* M keepalive and hold timers -------------------------------------------- */
+
+struct session {
+	struct thread *t_keepalive;
+	struct thread *t_hold;
+	uint64_t t_expect;
+};
+
+static struct session *sessions;
+static unsigned int hold_expired;
+static struct lat lat_timer_late = {.name = "keepalive lateness"};
+static struct lat lat_timer_rearm = {.name = "hold cancel + rearm"};
+
+/* Coarse timers are in seconds, returns the interval actually used */
+static unsigned long session_timer_add(void (*func)(struct thread *),
+				       struct session *s, unsigned long msec,
+				       struct thread **ref)
+{
+	if (opts.coarse) {
+		msec = MAX((msec + 500) / 1000, 1UL);
+		thread_add_timer_coarse(master, func, s, msec, ref);
+		return msec * 1000;
+	}
+
+	thread_add_timer_msec(master, func, s, msec, ref);
+	return msec;
+}
+
+static void session_hold_cb(struct thread *thread)
+{
+	struct session *s = THREAD_ARG(thread);
+
+	/* only if the loop fell far behind */
+	hold_expired++;
+	session_timer_add(session_hold_cb, s, opts.keepalive_msec * 3,
+			  &s->t_hold);
+}
+
+static void session_keepalive_cb(struct thread *thread)
+{
+	struct session *s = THREAD_ARG(thread);
+	uint64_t now = now_nsec(), t_rearm;
+	unsigned long msec;
+
+	lat_add(&lat_timer_late, now > s->t_expect ? now - s->t_expect : 0);
+
+	/* the peer's KEEPALIVE came in */
+	t_rearm = now_nsec();
+	THREAD_OFF(s->t_hold);
+	session_timer_add(session_hold_cb, s, opts.keepalive_msec * 3,
+			  &s->t_hold);
+	lat_add(&lat_timer_rearm, now_nsec() - t_rearm);
+
+	/* 75% to 100% of the interval, like bgpd's jitter */
+	msec = opts.keepalive_msec
+	       - prng_rand(prng) % (opts.keepalive_msec / 4 + 1);
+	now = now_nsec();
+	msec = session_timer_add(session_keepalive_cb, s, msec,
+				 &s->t_keepalive);
+	s->t_expect = now + msec * 1000000ULL;
+}
+
+static void bench_stop_cb(struct thread *thread)
+{
+	done = true;
+}
+
+static void bench_timer(void)
+{
+	struct thread *t_stop = NULL;
+	unsigned long msec;
+	unsigned int i;
+
+	printf("\n%u sessions, %u ms keepalive, %s timers, %u s\n",
+	       opts.timers, opts.keepalive_msec,
+	       opts.coarse ? "coarse" : "precise", opts.duration_sec);
+
+	hold_expired = 0;
+	sessions = calloc(opts.timers, sizeof(*sessions));
+	for (i = 0; i < opts.timers; i++) {
+		struct session *s = &sessions[i];
+
+		/* spread the sessions over the first interval */
+		msec = prng_rand(prng) % opts.keepalive_msec;
+		s->t_expect = now_nsec();
+		msec = session_timer_add(session_keepalive_cb, s, msec,
+					 &s->t_keepalive);
+		s->t_expect += msec * 1000000ULL;
+		session_timer_add(session_hold_cb, s, opts.keepalive_msec * 3,
+				  &s->t_hold);
+	}
+
+	thread_add_timer(master, bench_stop_cb, NULL, opts.duration_sec,
+			 &t_stop);
+	bench_loop();
+
+	lat_print_header();
+	lat_print(&lat_timer_late);
+	lat_print(&lat_timer_rearm);
+	if (hold_expired)
+		printf("%u hold timers expired\n", hold_expired);
+
+	for (i = 0; i < opts.timers; i++) {
+		THREAD_OFF(sessions[i].t_keepalive);
+		THREAD_OFF(sessions[i].t_hold);
+	}
+	free(sessions);
+	lat_free(&lat_timer_late);
+	lat_free(&lat_timer_rearm);
+}
+
+/* Cross-pthread events --------------------------------------------------- */
+
+struct producer;
+
+struct event_stamp {
+	struct producer *producer;
+	uint64_t t_add;
+};
+
+struct producer {
+	pthread_t pthread;
+	struct event_stamp *stamps;
+	_Atomic unsigned int received;
+};
+
+static struct producer *producers;
+static unsigned int events_received;
+static struct lat lat_event = {.name = "event add to run"};
+
+static void event_cb(struct thread *thread)
+{
+	struct event_stamp *stamp = THREAD_ARG(thread);
+
+	lat_add(&lat_event, now_nsec() - stamp->t_add);
+	atomic_fetch_add_explicit(&stamp->producer->received, 1,
+				  memory_order_release);
+
+	if (++events_received == opts.producers * opts.events)
+		done = true;
+}
+
+static void *producer_run(void *arg)
+{
+	struct producer *p = arg;
+	unsigned int i;
+
+	for (i = 0; i < opts.events; i++) {
+		/* don't let the event list grow without bounds */
+		while (i - atomic_load_explicit(&p->received,
+						memory_order_acquire)
+		       >= opts.window)
+			sched_yield();
+
+		p->stamps[i].producer = p;
+		p->stamps[i].t_add = now_nsec();
+		thread_add_event(master, event_cb, &p->stamps[i], 0, NULL);
+	}
+
+	return NULL;
+}
+
+static void bench_event(void)
+{
+	uint64_t t_start, t_total;
+	unsigned int i;
+
+	printf("\n%u pthreads adding %u events each, window %u\n",
+	       opts.producers, opts.events, opts.window);
+
+	events_received = 0;
+	producers = calloc(opts.producers, sizeof(*producers));
+
+	t_start = now_nsec();
+	for (i = 0; i < opts.producers; i++) {
+		struct producer *p = &producers[i];
+
+		p->stamps = calloc(opts.events, sizeof(*p->stamps));
+		atomic_store_explicit(&p->received, 0, memory_order_relaxed);
+		pthread_create(&p->pthread, NULL, producer_run, p);
+	}
+	bench_loop();
+	t_total = now_nsec() - t_start;
+
+	for (i = 0; i < opts.producers; i++) {
+		pthread_join(producers[i].pthread, NULL);
+		free(producers[i].stamps);
+	}
+	free(producers);
+
+	printf("%u events in %.3f s, %.0f events/s\n", events_received,
+	       t_total / 1e9, events_received / (t_total / 1e9));
+	lat_print_header();
+	lat_print(&lat_event);
+	lat_free(&lat_event);
+}
+
+static void usage(const char *progname, int status)
+{
+	fprintf(status ? stderr : stdout,
+		"usage: %s [-P] [fd|timer|event]...\n"
+		"  -P       use poll() even if epoll is available\n"
+		"  -s SEED  pseudo random seed (1)\n"
+		"fd:\n"
+		"  -n FDS   number of fds (1000)\n"
+		"  -r PCT   percentage of fds ready per round (10)\n"
+		"  -R N     rounds (1000)\n"
+		"timer:\n"
+		"  -t N     number of sessions (10000)\n"
+		"  -k MSEC  keepalive interval (1000), hold time is 3x\n"
+		"  -D SEC   duration (5)\n"
+		"  -c       use coarse timers (whole seconds)\n"
+		"event:\n"
+		"  -p N     number of pthreads (4)\n"
+		"  -e N     events per pthread (100000)\n"
+		"  -w N     events in flight per pthread (1000)\n",
+		progname);
+	exit(status);
+}
+
+static unsigned int parse_uint(const char *progname, const char *arg,
+			       unsigned int min)
+{
+	char *end;
+	unsigned long val = strtoul(arg, &end, 10);
+
+	if (*end || val < min || val > UINT_MAX)
+		usage(progname, 1);
+	return val;
+}
+
+int main(int argc, char **argv)
+{
+	bool use_poll = false;
+	bool run_fd = false, run_timer = false, run_event = false;
+	unsigned long long seed = 1;
+	struct rlimit rlim;
+	int opt, i;
+
+	while ((opt = getopt(argc, argv, "Ps:n:r:R:t:k:D:cp:e:w:h")) != -1) {
+		switch (opt) {
+		case 'P':
+			use_poll = true;
+			break;
+		case 's':
+			seed = strtoull(optarg, NULL, 0);
+			break;
+		case 'n':
+			opts.fds = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'r':
+			opts.ready_pct = parse_uint(argv[0], optarg, 0);
+			if (opts.ready_pct > 100)
+				usage(argv[0], 1);
+			break;
+		case 'R':
+			opts.rounds = parse_uint(argv[0], optarg, 1);
+			break;
+		case 't':
+			opts.timers = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'k':
+			opts.keepalive_msec = parse_uint(argv[0], optarg, 4);
+			break;
+		case 'D':
+			opts.duration_sec = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'c':
+			opts.coarse = true;
+			break;
+		case 'p':
+			opts.producers = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'e':
+			opts.events = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'w':
+			opts.window = parse_uint(argv[0], optarg, 1);
+			break;
+		case 'h':
+			usage(argv[0], 0);
+			break;
+		default:
+			usage(argv[0], 1);
+		}
+	}
+
+	for (i = optind; i < argc; i++) {
+		if (!strcmp(argv[i], "fd"))
+			run_fd = true;
+		else if (!strcmp(argv[i], "timer"))
+			run_timer = true;
+		else if (!strcmp(argv[i], "event"))
+			run_event = true;
+		else
+			usage(argv[0], 1);
+	}
+	if (optind == argc)
+		run_fd = run_timer = run_event = true;
+
+	/* the thread_master only takes fds below its limit */
+	if (getrlimit(RLIMIT_NOFILE, &rlim) == 0) {
+		rlim.rlim_cur = rlim.rlim_max;
+		setrlimit(RLIMIT_NOFILE, &rlim);
+	}
+
+	master = thread_master_create(NULL);
+	if (use_poll && !thread_master_use_poll(master)) {
+		fprintf(stderr, "cannot switch to poll()\n");
+		return 1;
+	}
+	prng = prng_new(seed);
+
+	printf("backend: %s\n", thread_master_backend(master));
+	if (run_fd)
+		bench_fd();
+	if (run_timer)
+		bench_timer();
+	if (run_event)
+		bench_event();
+
+	prng_free(prng);
+	thread_master_free(master);
+	return 0;
+}
@@ -0,0 +1,138 @@
+/*
+ * Shared memory RIB export tests
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "rib_export.h"
+
+#include <assert.h>
+
+/* more than the initial image size, to make it grow */
+#define NROUTES 3000
+
+struct walk_state {
+	unsigned int seen;
+	unsigned int removed;
+	uint32_t last_slot;
+};
+
+static int walk_cb(uint32_t slot, const struct rib_export_route *route,
+		   void *arg)
+{
+	struct walk_state *ws = arg;
+
+	assert(slot > ws->last_slot);
+	ws->last_slot = slot;
+	ws->seen++;
+	if (!route->family) {
+		ws->removed++;
+		return 0;
+	}
+
+	assert(route->family == AF_INET);
+	assert(route->prefixlen == 32);
+	/* route i is 10.0.x.y with x.y = i, in slot i + 1 */
+	assert(route->prefix[2] * 256 + route->prefix[3] == slot - 1);
+	assert(route->nexthop_num == 1);
+	return 0;
+}
+
+static void make_route(unsigned int i, struct rib_export_route *route)
+{
+	memset(route, 0, sizeof(*route));
+	route->family = AF_INET;
+	route->prefixlen = 32;
+	route->prefix[0] = 10;
+	route->prefix[2] = i / 256;
+	route->prefix[3] = i % 256;
+	route->metric = i;
+	route->nexthop_num = route->nexthop_total = 1;
+	route->nexthops[0].ifindex = 1;
+}
+
+int main(int argc, char **argv)
+{
+	char path[] = "/tmp/test_rib_export.XXXXXX";
+	struct rib_export_route route;
+	struct rib_export_reader *rd;
+	struct walk_state ws;
+	struct rib_export *rx;
+	uint32_t slots[NROUTES];
+	uint64_t gen;
+	unsigned int i;
+	int fd;
+
+	fd = mkstemp(path);
+	assert(fd >= 0);
+	close(fd);
+
+	rx = rib_export_create(path);
+	assert(rx);
+	for (i = 0; i < NROUTES; i++) {
+		slots[i] = rib_export_alloc(rx);
+		assert(slots[i] == i + 1);
+		make_route(i, &route);
+		rib_export_set(rx, slots[i], &route);
+	}
+	assert(rib_export_count(rx) == NROUTES);
+	assert(rib_export_size(rx) >= NROUTES);
+	assert(rib_export_generation(rx) == NROUTES);
+
+	/* 1. full walk */
+	rd = rib_export_open(path);
+	assert(rd);
+	assert(rib_export_alive(rd));
+	memset(&ws, 0, sizeof(ws));
+	gen = rib_export_walk(rd, 0, walk_cb, &ws);
+	assert(gen == NROUTES);
+	assert(ws.seen == NROUTES && !ws.removed);
+
+	/* 2. incremental walk sees the changes only, removals included */
+	make_route(7, &route);
+	route.metric = 1;
+	rib_export_set(rx, slots[7], &route);
+	rib_export_release(rx, slots[9]);
+	assert(rib_export_count(rx) == NROUTES - 1);
+
+	memset(&ws, 0, sizeof(ws));
+	gen = rib_export_walk(rd, gen, walk_cb, &ws);
+	assert(gen == NROUTES + 2);
+	assert(ws.seen == 2 && ws.removed == 1);
+
+	memset(&ws, 0, sizeof(ws));
+	assert(rib_export_walk(rd, gen, walk_cb, &ws) == gen);
+	assert(ws.seen == 0);
+
+	/* 3. released slots are reused, a full walk skips the unused ones */
+	assert(rib_export_alloc(rx) == slots[9]);
+	memset(&ws, 0, sizeof(ws));
+	rib_export_walk(rd, 0, walk_cb, &ws);
+	assert(ws.seen == NROUTES - 1);
+
+	/* 4. the reader notices the writer going away */
+	rib_export_destroy(&rx);
+	assert(!rx);
+	assert(!rib_export_alive(rd));
+	rib_export_close(&rd);
+	assert(!rd);
+
+	unlink(path);
+	printf("RIB export test successful.\n");
+	return 0;
+}
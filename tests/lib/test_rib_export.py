@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestRibExport(frrtest.TestMultiOut):
+    program = "./test_rib_export"
+
+
+TestRibExport.onesimple("RIB export test successful.")
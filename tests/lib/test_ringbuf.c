@@ -182,6 +182,28 @@ int main(int argc, char **argv)
 	printf("Retrieved: %s\n", sixteen);
 	assert(!strcmp(sixteen, "vascular plants"));
 
+	/* validate fd read across ring boundary */
+	printf("Validating fd read...\n");
+	int pipefd[2];
+	assert(pipe(pipefd) == 0);
+	ringbuf_reset(soil);
+	soil->start = soil->end = 10;
+	assert(write(pipefd[1], twenty, strlen(twenty)) == (ssize_t)strlen(twenty));
+	assert(ringbuf_read(soil, pipefd[0]) == 15);
+	validate_state(soil, 15, 15);
+	assert(soil->end == 10);
+	assert(ringbuf_read(soil, pipefd[0]) == 0);
+	assert(ringbuf_get(soil, sixteen, 20) == 15);
+	sixteen[15] = '\0';
+	assert(!strcmp(sixteen, "vascular plants"));
+	assert(ringbuf_read(soil, pipefd[0]) == 4);
+	validate_state(soil, 15, 4);
+	assert(ringbuf_get(soil, sixteen, 20) == 4);
+	sixteen[4] = '\0';
+	assert(!strcmp(sixteen, "----"));
+	close(pipefd[0]);
+	close(pipefd[1]);
+
 	printf("Deleting...\n");
 	ringbuf_del(soil);
 
@@ -490,6 +490,67 @@ static void test_iter_pause(void)
 	route_table_finish(table);
 }
 
+/*
+ * verify_lookup
+ *
+ * Verify that exact-match lookups find the prefixes in the table, and only
+ * those.
+ */
+static void verify_lookup(struct route_table *table, const char *target,
+			  bool present)
+{
+	struct prefix_ipv4 p;
+	struct route_node *rn;
+
+	assert(str2prefix_ipv4(target, &p) > 0);
+
+	rn = route_node_lookup(table, (struct prefix *)&p);
+	if (!present) {
+		assert(!rn);
+		return;
+	}
+
+	assert(rn && rn->info);
+	assert(!strcmp(((test_node_t *)rn->info)->prefix_str, target));
+	route_unlock_node(rn);
+}
+
+/*
+ * test_lookup_nohash
+ */
+static void test_lookup_nohash(void)
+{
+	static route_table_delegate_t nohash_delegate = {
+		.create_node = route_node_create,
+		.destroy_node = route_node_destroy,
+		.nohash = true};
+	struct route_table *table;
+	int i, num_prefixes;
+	const char *prefixes[] = {"1.0.1.0/24", "1.0.1.0/25", "1.0.1.128/25",
+				  "1.0.2.0/24", "2.0.0.0/8", "0.0.0.0/0"};
+	const char *absent[] = {"1.0.0.0/23", "1.0.1.0/26", "2.0.0.0/9",
+				"3.0.0.0/8"};
+
+	printf("\n\nTesting lookups in a table without hash index\n");
+	table = route_table_init_with_delegate(&nohash_delegate);
+
+	num_prefixes = array_size(prefixes);
+	for (i = 0; i < num_prefixes; i++)
+		add_nodes(table, prefixes[i], NULL);
+
+	for (i = 0; i < num_prefixes; i++)
+		verify_lookup(table, prefixes[i], true);
+	for (i = 0; i < (int)array_size(absent); i++)
+		verify_lookup(table, absent[i], false);
+
+	/* a branch node without info exists, but is not returned */
+	verify_lookup(table, "1.0.0.0/22", false);
+
+	clear_table(table);
+	route_table_finish(table);
+	printf("Verified lookup without hash index\n");
+}
+
 /*
  * run_tests
  */
@@ -498,6 +559,7 @@ static void run_tests(void)
 	test_prefix_iter_cmp();
 	test_get_next();
 	test_iter_pause();
+	test_lookup_nohash();
 }
 
 /*
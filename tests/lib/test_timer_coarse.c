@@ -0,0 +1,124 @@
+/*
+ * Test program to verify that coarse timers, which live on the
+ * thread_master timing wheel, run neither early nor much late.
+ *
+ * Copyright (C) 2022 The FRRouting Project
+ *
+ * This file is part of FRR.
+ *
+ * FRR is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the
+ * Free Software Foundation; either version 2, or (at your option) any
+ * later version.
+ *
+ * FRR is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <stdio.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "prng.h"
+#include "thread.h"
+
+#define SCHEDULE_TIMERS 800
+#define REMOVE_TIMERS   200
+
+/* allowed lateness: one wheel tick, plus slack for a loaded test host */
+#define LATE_USEC ((THREAD_WHEEL_TICK_MSEC + 500) * 1000)
+
+struct thread_master *master;
+
+static struct prng *prng;
+
+static struct thread **timers;
+static struct timeval *deadlines;
+
+static int timers_pending;
+static int errors;
+
+static void terminate_test(void)
+{
+	int exit_code;
+
+	if (errors) {
+		fprintf(stderr, "%d timers ran early or late.\n", errors);
+		exit_code = 1;
+	} else {
+		printf("All coarse timers ran in time.\n");
+		exit_code = 0;
+	}
+
+	thread_master_free(master);
+	prng_free(prng);
+	XFREE(MTYPE_TMP, timers);
+	XFREE(MTYPE_TMP, deadlines);
+
+	exit(exit_code);
+}
+
+static void timer_func(struct thread *thread)
+{
+	struct timeval *deadline = THREAD_ARG(thread);
+	struct timeval now, late;
+	int64_t diff;
+
+	monotime(&now);
+	timersub(&now, deadline, &late);
+	diff = late.tv_sec * 1000000LL + late.tv_usec;
+	if (diff < 0 || diff > LATE_USEC) {
+		fprintf(stderr, "timer %td ran %lld usec after its deadline\n",
+			deadline - deadlines, (long long)diff);
+		errors++;
+	}
+
+	timers_pending--;
+	if (!timers_pending)
+		terminate_test();
+}
+
+int main(int argc, char **argv)
+{
+	int i;
+	struct thread t;
+
+	master = thread_master_create(NULL);
+
+	prng = prng_new(0);
+
+	timers = XCALLOC(MTYPE_TMP, SCHEDULE_TIMERS * sizeof(*timers));
+	deadlines = XCALLOC(MTYPE_TMP, SCHEDULE_TIMERS * sizeof(*deadlines));
+
+	for (i = 0; i < SCHEDULE_TIMERS; i++) {
+		/* Schedule timers to expire in 0..3 seconds */
+		thread_add_timer_coarse(master, timer_func, &deadlines[i],
+					prng_rand(prng) % 4, &timers[i]);
+		deadlines[i] = timers[i]->u.sands;
+		timers_pending++;
+	}
+
+	for (i = 0; i < REMOVE_TIMERS; i++) {
+		int index;
+
+		index = prng_rand(prng) % SCHEDULE_TIMERS;
+		if (!timers[index])
+			continue;
+
+		thread_cancel(&timers[index]);
+		timers_pending--;
+	}
+
+	while (thread_fetch(master, &t))
+		thread_call(&t);
+
+	return 0;
+}
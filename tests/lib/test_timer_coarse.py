@@ -0,0 +1,8 @@
+import frrtest
+
+
+class TestTimerCoarse(frrtest.TestMultiOut):
+    program = "./test_timer_coarse"
+
+
+TestTimerCoarse.onesimple("All coarse timers ran in time.")
@@ -67,6 +67,7 @@
 #define _T_SORTLIST_UNIQ	(T_SORTED | T_UNIQ)
 #define _T_SORTLIST_NONUNIQ	(T_SORTED)
 #define _T_HASH			(T_SORTED | T_UNIQ | T_HASH)
+#define _T_FLATHASH		(T_SORTED | T_UNIQ | T_HASH)
 #define _T_SKIPLIST_UNIQ	(T_SORTED | T_UNIQ)
 #define _T_SKIPLIST_NONUNIQ	(T_SORTED)
 #define _T_RBTREE_UNIQ		(T_SORTED | T_UNIQ | T_REVERSE)
@@ -130,6 +131,15 @@ static void ts_end(void)
 #include "test_typelist.h"
 #undef SHITTY_HASH
 
+#define TYPE FLATHASH
+#include "test_typelist.h"
+
+#define TYPE FLATHASH_collisions
+#define REALTYPE FLATHASH
+#define SHITTY_HASH
+#include "test_typelist.h"
+#undef SHITTY_HASH
+
 #define TYPE SKIPLIST_UNIQ
 #include "test_typelist.h"
 
@@ -160,6 +170,8 @@ int main(int argc, char **argv)
 	test_SORTLIST_NONUNIQ();
 	test_HASH();
 	test_HASH_collisions();
+	test_FLATHASH();
+	test_FLATHASH_collisions();
 	test_SKIPLIST_UNIQ();
 	test_SKIPLIST_NONUNIQ();
 	test_RBTREE_UNIQ();
@@ -13,6 +13,8 @@ TestTypelist.onesimple("SORTLIST_UNIQ end")
 TestTypelist.onesimple("SORTLIST_NONUNIQ end")
 TestTypelist.onesimple("HASH end")
 TestTypelist.onesimple("HASH_collisions end")
+TestTypelist.onesimple("FLATHASH end")
+TestTypelist.onesimple("FLATHASH_collisions end")
 TestTypelist.onesimple("SKIPLIST_UNIQ end")
 TestTypelist.onesimple("SKIPLIST_NONUNIQ end")
 TestTypelist.onesimple("RBTREE_UNIQ end")
@@ -0,0 +1,379 @@
+/*
+ * OSPF SPF benchmark
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Generates a grid, Clos or random topology of router-LSAs with point to
+ * point links in the backbone, fills the SR DB and times, from the point of
+ * view of node 0:
+ *
+ *  spf     - ospf_spf_calculate()
+ *  install - ospf_route_install() of all routes
+ *  tilfa   - P/Q spaces and backup paths for every protected resource
+ *  prc     - partial route calculation after one router advertised
+ *            another stub
+ *  update  - ospf_route_install() after that
+ *
+ * Like the SPF unit test, the tree is calculated as a dry run, i.e.
+ * nexthops are found from the LSAs only, as there are no interfaces.
+ * Routes are sent to zebra through a zclient writing to /dev/null, so that
+ * install includes the ZAPI encoding.  This is not run as part of
+ * "make check".
+ */
+
+#include <zebra.h>
+
+#include "thread.h"
+#include "vty.h"
+#include "command.h"
+#include "log.h"
+#include "table.h"
+#include "mpls.h"
+#include "zclient.h"
+
+#include "ospfd/ospfd.h"
+#include "ospfd/ospf_asbr.h"
+#include "ospfd/ospf_lsa.h"
+#include "ospfd/ospf_lsdb.h"
+#include "ospfd/ospf_route.h"
+#include "ospfd/ospf_spf.h"
+#include "ospfd/ospf_ti_lfa.h"
+#include "ospfd/ospf_vty.h"
+#include "ospfd/ospf_sr.h"
+
+#include "common.h"
+#include "spf_bench.h"
+
+static struct spf_bench_opts opts;
+static struct spf_bench_graph *graph;
+static struct spf_bench bench = {
+	.protocol = "ospf",
+	.opts = &opts,
+};
+
+/* extra stubs advertised per node for the prefix changes */
+static uint32_t *node_extra;
+
+static struct in_addr node_router_id(uint32_t node)
+{
+	struct in_addr id = {.s_addr = htonl((10U << 24) + node + 1)};
+
+	return id;
+}
+
+/* Both ends of a link are numbered out of a /30 from 128.0.0.0/2 */
+static struct in_addr link_addr(uint32_t link_idx, bool from)
+{
+	struct in_addr addr = {
+		.s_addr = htonl((128U << 24) + link_idx * 4 + (from ? 1 : 2))};
+
+	return addr;
+}
+
+static void node_lsa_install(struct ospf *ospf, uint32_t node)
+{
+	struct ospf_area *area = ospf->backbone;
+	struct in_addr router_id = node_router_id(node);
+	struct in_addr id, data;
+	struct lsa_header *lsah;
+	struct ospf_lsa *new;
+	struct stream *s;
+	unsigned long putp;
+	uint16_t link_count = 0;
+	uint32_t i, seqnum = node_extra[node] + 1;
+	int length;
+
+	s = stream_new(OSPF_MAX_LSA_SIZE * 8);
+	lsa_header_set(s, LSA_OPTIONS_GET(area) | LSA_OPTIONS_NSSA_GET(area),
+		       OSPF_ROUTER_LSA, router_id, router_id);
+
+	stream_putc(s, router_lsa_flags(area));
+	stream_putc(s, 0);
+
+	putp = stream_get_endp(s);
+	stream_putw(s, 0);
+
+	for (i = graph->adj_first[node]; i < graph->adj_first[node + 1];
+	     i++) {
+		uint32_t link_idx = graph->adj[i];
+		const struct spf_bench_link *link = &graph->links[link_idx];
+
+		link_info_set(&s, node_router_id(spf_bench_peer(link, node)),
+			      link_addr(link_idx, link->from == node),
+			      LSA_LINK_TYPE_POINTOPOINT, 0, link->metric);
+
+		id.s_addr = htonl((128U << 24) + link_idx * 4);
+		masklen2ip(30, &data);
+		link_info_set(&s, id, data, LSA_LINK_TYPE_STUB, 0,
+			      link->metric);
+		link_count += 2;
+	}
+
+	/* Loopback, further prefixes and the stubs added later on */
+	data.s_addr = 0xffffffff;
+	link_info_set(&s, router_id, data, LSA_LINK_TYPE_STUB, 0, 0);
+	link_count++;
+	masklen2ip(24, &data);
+	for (i = 1; i < opts.prefixes; i++) {
+		id.s_addr = htonl(
+			(20U << 24)
+			+ ((node * (opts.prefixes - 1) + i - 1) << 8));
+		link_info_set(&s, id, data, LSA_LINK_TYPE_STUB, 0, 10);
+		link_count++;
+	}
+	data.s_addr = 0xffffffff;
+	for (i = 0; i < node_extra[node]; i++) {
+		id.s_addr = htonl((200U << 24) + (node << 6) + i);
+		link_info_set(&s, id, data, LSA_LINK_TYPE_STUB, 0, 10);
+		link_count++;
+	}
+
+	stream_putw_at(s, putp, link_count);
+
+	length = stream_get_endp(s);
+	lsah = (struct lsa_header *)STREAM_DATA(s);
+	lsah->ls_seqnum = htonl(OSPF_INITIAL_SEQUENCE_NUMBER + seqnum);
+	lsah->length = htons(length);
+
+	new = ospf_lsa_new_and_data(length);
+	new->area = area;
+	new->vrf_id = area->ospf->vrf_id;
+	if (node == 0)
+		SET_FLAG(new->flags, OSPF_LSA_SELF | OSPF_LSA_SELF_CHECKED);
+
+	memcpy(new->data, lsah, length);
+	stream_free(s);
+
+	ospf_lsdb_add(area->lsdb, new);
+
+	if (node == 0) {
+		ospf_lsa_unlock(&area->router_lsa_self);
+		area->router_lsa_self = ospf_lsa_lock(new);
+	}
+}
+
+/* As in the SPF unit test, the SR DB is filled directly */
+static void node_sr_install(uint32_t node)
+{
+	struct in_addr router_id = node_router_id(node);
+	struct sr_node *srn;
+	struct sr_prefix *srp;
+	struct sr_link *srl;
+	uint32_t i, label = 0;
+
+	srn = ospf_sr_node_create(&router_id);
+	srn->srgb.range_size = graph->node_count + 1;
+	srn->srgb.lower_bound = 16000;
+	srn->msd = 16;
+	srn->srlb.range_size = 1000;
+	srn->srlb.lower_bound = 15000;
+
+	srp = XCALLOC(MTYPE_OSPF_SR_PARAMS, sizeof(struct sr_prefix));
+	srp->adv_router = router_id;
+	srp->sid = node + 1;
+	srp->srn = srn;
+	listnode_add(srn->ext_prefix, srp);
+
+	for (i = graph->adj_first[node]; i < graph->adj_first[node + 1];
+	     i++) {
+		const struct spf_bench_link *link;
+
+		link = &graph->links[graph->adj[i]];
+		srl = XCALLOC(MTYPE_OSPF_SR_PARAMS, sizeof(struct sr_link));
+		srl->adv_router = router_id;
+		srl->remote_id = node_router_id(spf_bench_peer(link, node));
+		srl->type = ADJ_SID;
+		srl->sid[0] = srn->srlb.lower_bound + label++;
+		srl->srn = srn;
+		listnode_add(srn->ext_link, srl);
+	}
+}
+
+static void bench_spf(struct ospf_area *area, struct route_table *new_table,
+		      struct route_table *new_rtrs)
+{
+	ospf_spf_calculate(area, area->router_lsa_self, new_table, NULL,
+			   new_rtrs, true, false);
+}
+
+/* The next install has to send every route again */
+static void bench_forget_routes(struct ospf *ospf)
+{
+	if (ospf->new_table) {
+		ospf_route_table_free(ospf->new_table);
+		ospf->new_table = NULL;
+	}
+}
+
+static int bench_run(void)
+{
+	struct route_table *new_table, *new_rtrs;
+	struct ospf *ospf;
+	struct ospf_area *area;
+	struct in_addr area_id = {.s_addr = OSPF_AREA_BACKBONE};
+	enum protection_type protection;
+	unsigned int run, prc_fallbacks = 0;
+	uint32_t i;
+	bool partial;
+
+	ospf = ospf_new_alloc(0, VRF_DEFAULT_NAME);
+	area = ospf_area_new(ospf, area_id);
+	listnode_add_sort(ospf->areas, area);
+	ospf->router_id = node_router_id(0);
+	ospf->router_id_static = ospf->router_id;
+	/* also makes a dry run find P2P nexthops, as in the unit test */
+	ospf->ti_lfa_enabled = true;
+
+	node_extra = calloc(graph->node_count, sizeof(*node_extra));
+	for (i = 0; i < graph->node_count; i++) {
+		node_lsa_install(ospf, i);
+		node_sr_install(i);
+	}
+
+	/* Full SPF and installing all routes */
+	for (run = 0; run < opts.runs; run++) {
+		new_table = route_table_init();
+		new_rtrs = route_table_init();
+
+		spf_bench_start(&bench, "spf");
+		bench_spf(area, new_table, new_rtrs);
+		spf_bench_stop(&bench);
+
+		bench_forget_routes(ospf);
+		spf_bench_start(&bench, "install");
+		ospf_route_install(ospf, new_table);
+		spf_bench_stop(&bench);
+
+		bench.routes = new_table->count;
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+		area->spf = NULL;
+		area->spf_vertex_list = NULL;
+		ospf_rtrs_free(new_rtrs);
+	}
+
+	protection = opts.node_protection ? OSPF_TI_LFA_NODE_PROTECTION
+					  : OSPF_TI_LFA_LINK_PROTECTION;
+	for (run = 0; run < opts.runs; run++) {
+		new_table = route_table_init();
+		new_rtrs = route_table_init();
+		bench_spf(area, new_table, new_rtrs);
+
+		spf_bench_start(&bench, "tilfa");
+		ospf_ti_lfa_generate_p_spaces(area, protection);
+		ospf_ti_lfa_insert_backup_paths(area, new_table);
+		spf_bench_stop(&bench);
+
+		ospf_ti_lfa_free_p_spaces(area);
+		ospf_spf_cleanup(area->spf, area->spf_vertex_list);
+		area->spf = NULL;
+		area->spf_vertex_list = NULL;
+		ospf_route_table_free(new_table);
+		ospf_rtrs_free(new_rtrs);
+	}
+
+	/* Keep a tree for the partial route calculation */
+	new_table = route_table_init();
+	new_rtrs = route_table_init();
+	bench_spf(area, new_table, new_rtrs);
+	ospf_spf_tree_keep(area);
+	area->spf = NULL;
+	area->spf_vertex_list = NULL;
+	ospf_route_install(ospf, new_table);
+	ospf_rtrs_free(new_rtrs);
+
+	/* One more stub on some other router per run */
+	for (run = 0; run < opts.runs; run++) {
+		i = 1 + spf_bench_random() % (graph->node_count - 1);
+		node_extra[i]++;
+		node_lsa_install(ospf, i);
+
+		new_table = route_table_init();
+		new_rtrs = route_table_init();
+
+		/* Backup paths aren't kept up to date by a partial run */
+		ospf->ti_lfa_enabled = false;
+		spf_bench_start(&bench, "prc");
+		partial = ospf_spf_calculate_areas_partial(ospf, new_table,
+							   NULL, new_rtrs);
+		if (!partial) {
+			ospf->ti_lfa_enabled = true;
+			ospf_spf_tree_free(area);
+			bench_spf(area, new_table, new_rtrs);
+			ospf_spf_tree_keep(area);
+			area->spf = NULL;
+			area->spf_vertex_list = NULL;
+			prc_fallbacks++;
+		}
+		spf_bench_stop(&bench);
+		ospf->ti_lfa_enabled = true;
+
+		spf_bench_start(&bench, "update");
+		ospf_route_install(ospf, new_table);
+		spf_bench_stop(&bench);
+
+		ospf_rtrs_free(new_rtrs);
+	}
+	if (prc_fallbacks)
+		printf("%u of %u partial route calculations fell back to SPF\n",
+		       prc_fallbacks, opts.runs);
+
+	ospf_spf_tree_free(area);
+	bench_forget_routes(ospf);
+	free(node_extra);
+
+	return spf_bench_report(&bench);
+}
+
+int main(int argc, char **argv)
+{
+	int ret;
+
+	spf_bench_parse_args(&opts, argc, argv);
+
+	/* master init. */
+	master = thread_master_create(NULL);
+
+	/* Library inits. */
+	cmd_init(1);
+	cmd_hostname_set("test");
+	vty_init(master, false);
+	zlog_aux_init("NONE: ", ZLOG_DISABLED);
+
+	/* needed for SR DB init */
+	ospf_vty_init();
+	ospf_sr_init();
+
+	zclient = zclient_new(master, &zclient_options_default, NULL, 0);
+	zclient->sock = open("/dev/null", O_WRONLY);
+
+	graph = spf_bench_graph_new(&opts);
+	bench.graph = graph;
+	ret = bench_run();
+	spf_bench_graph_free(graph);
+
+	close(zclient->sock);
+	zclient->sock = -1;
+	zclient_free(zclient);
+	zclient = NULL;
+
+	cmd_terminate();
+	vty_terminate();
+	thread_master_free(master);
+
+	return ret;
+}
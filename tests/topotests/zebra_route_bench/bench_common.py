@@ -0,0 +1,248 @@
+#!/usr/bin/env python
+
+#
+# bench_common.py
+#
+# Copyright (c) 2022 by
+# Network Device Education Foundation, Inc. ("NetDEF")
+#
+# Permission to use, copy, modify, and/or distribute this software
+# for any purpose with or without fee is hereby granted, provided
+# that the above copyright notice and this permission notice appear
+# in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND NETDEF DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL NETDEF BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+# DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+# WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS
+# ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+# OF THIS SOFTWARE.
+#
+
+"""
+bench_common.py: Common routines for the route convergence benchmarks
+
+Every benchmark installs and then removes a batch of sharpd routes and
+records:
+
+- routes per second as reported by sharpd once zebra acked the whole batch,
+- the number of nexthop groups zebra needed for the batch (NHG reuse),
+- the NHT latency for a nexthop resolved by the last route of the batch,
+- the maximum dataplane route queue depth.
+
+The results are written as JSON to $FRR_BENCH_RESULTS (a directory, the
+router log directory by default). If $FRR_BENCH_BASELINE points to a
+results file of an earlier run, every rate is compared against it and the
+test fails if it regressed by more than $FRR_BENCH_TOLERANCE (0.1, i.e.
+10%, by default). The batch size is $FRR_BENCH_ROUTES (100000 by default).
+"""
+
+import ipaddress
+import json
+import os
+import re
+import sys
+import pytest
+from functools import partial
+
+# Save the Current Working Directory to find configuration files.
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+# Import topogen and topotest helpers
+from lib import topotest
+from lib.topogen import Topogen, TopoRouter, get_topogen
+from lib.topolog import logger
+
+BENCH_ROUTES = int(os.environ.get("FRR_BENCH_ROUTES", "100000"))
+BENCH_TOLERANCE = float(os.environ.get("FRR_BENCH_TOLERANCE", "0.1"))
+
+# Metrics compared against the baseline: higher is better for all of them
+BENCH_RATES = ["installRoutesPerSecond", "removeRoutesPerSecond"]
+
+bench_results = {}
+
+
+def bench_build(tgen):
+    "Build function"
+
+    tgen.add_router("r1")
+
+    for switchn in range(1, 5):
+        switch = tgen.add_switch("sw{}".format(switchn))
+        switch.add_link(tgen.gears["r1"])
+
+
+def bench_setup_module(module, variant, zebra_param=None):
+    "Setup topology, zebra_param are extra zebra arguments (modules)"
+    tgen = Topogen(bench_build, module.__name__)
+    tgen.start_topology()
+
+    r1 = tgen.gears["r1"]
+    r1.load_config(
+        TopoRouter.RD_ZEBRA, os.path.join(CWD, "r1/zebra.conf"), zebra_param
+    )
+    r1.load_config(TopoRouter.RD_SHARP, os.path.join(CWD, "r1/sharpd.conf"))
+
+    tgen.start_router()
+
+    bench_results.clear()
+    bench_results["variant"] = variant
+    bench_results["routes"] = BENCH_ROUTES
+    bench_results["runs"] = {}
+
+
+def bench_teardown_module(_mod):
+    "Teardown the pytest environment"
+    tgen = get_topogen()
+
+    tgen.stop_topology()
+
+
+def bench_converge_protocols():
+    "Wait for protocol convergence"
+
+    tgen = get_topogen()
+    # Don't run this test if we have any failure; this is also the case
+    # when the dataplane module of this variant isn't available.
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+
+def bench_route_count(router, expected):
+    "Number of sharp routes in the RIB is `expected`"
+    output = router.vtysh_cmd("show ip route summary json", isjson=True)
+    for d in output.get("routes", []):
+        if d["type"] == "sharp":
+            if d["fib"] == expected:
+                return None
+            return "{} of {} routes in the fib".format(d["fib"], expected)
+
+    if expected == 0:
+        return None
+    return "no sharp routes"
+
+
+def bench_wait(router, expected):
+    "Wait until zebra and sharpd agree that the batch is done"
+    test_func = partial(bench_route_count, router, expected)
+    # Allow roughly 10k routes/s at worst before giving up
+    retries = max(30, BENCH_ROUTES // 5000)
+    success, result = topotest.run_and_expect(test_func, None, retries, 2)
+    assert success, "Route batch did not converge: {}".format(result)
+
+    def sharp_done():
+        data = router.vtysh_cmd("sharp data route json", isjson=True)
+        if data.get("complete"):
+            return data
+        return None
+
+    _, data = topotest.run_and_expect_type(sharp_done, dict, 30, 1)
+    assert data, "sharpd did not see the batch acked"
+    return data
+
+
+def bench_dplane_queue_max(router):
+    "Maximum dataplane route queue depth since zebra started"
+    output = router.vtysh_cmd("show zebra dplane", isjson=False)
+    m = re.search(r"Route update queue max:\s+(\d+)", output)
+    return int(m.group(1)) if m else None
+
+
+def bench_run(nhg):
+    "Install and remove one batch of routes using nexthop-group `nhg`"
+
+    tgen = get_topogen()
+    if tgen.routers_have_failure():
+        pytest.skip(tgen.errors)
+
+    r1 = tgen.gears["r1"]
+    result = {"nexthopGroup": nhg}
+
+    # The last route of the batch resolves this nexthop
+    watch = ipaddress.IPv4Address("1.0.0.0") + BENCH_ROUTES - 1
+    r1.vtysh_cmd("sharp watch nexthop {}".format(watch), isjson=False)
+
+    logger.info("Installing {} routes via {}".format(BENCH_ROUTES, nhg))
+    r1.vtysh_cmd(
+        "sharp install route 1.0.0.0 nexthop-group {} {}".format(nhg, BENCH_ROUTES),
+        isjson=False,
+    )
+    data = bench_wait(r1, BENCH_ROUTES)
+    result["installRoutesPerSecond"] = data.get("routesPerSecond", 0)
+    result["installTimeUsec"] = data["timeUsec"]
+
+    nhgs = r1.vtysh_cmd("show nexthop-group rib sharp json", isjson=True)
+    result["nexthopGroups"] = len(nhgs)
+
+    nht = r1.vtysh_cmd("sharp data nexthop json", isjson=True)
+    latency = nht.get("{}/32".format(watch), {}).get("updateLatencyUsec")
+    if latency is not None:
+        result["nhtLatencyUsec"] = latency
+
+    logger.info("Removing {} routes".format(BENCH_ROUTES))
+    r1.vtysh_cmd("sharp remove route 1.0.0.0 {}".format(BENCH_ROUTES), isjson=False)
+    data = bench_wait(r1, 0)
+    result["removeRoutesPerSecond"] = data.get("routesPerSecond", 0)
+    result["removeTimeUsec"] = data["timeUsec"]
+
+    result["dplaneQueueMax"] = bench_dplane_queue_max(r1)
+
+    logger.info("Benchmark {}: {}".format(nhg, json.dumps(result)))
+    bench_results["runs"][nhg] = result
+
+
+def bench_report():
+    "Write the results and compare them against the baseline, if any"
+
+    tgen = get_topogen()
+    if not bench_results.get("runs"):
+        pytest.skip("No benchmark results")
+
+    outdir = os.environ.get("FRR_BENCH_RESULTS", tgen.logdir)
+    outfile = os.path.join(
+        outdir, "route_bench_{}.json".format(bench_results["variant"])
+    )
+    with open(outfile, "w") as f:
+        json.dump(bench_results, f, indent=2, sort_keys=True)
+    logger.info("Benchmark results written to {}".format(outfile))
+
+    baseline_file = os.environ.get("FRR_BENCH_BASELINE")
+    if not baseline_file:
+        return
+
+    # The baseline may either be a single results file or a directory
+    # holding the results of all variants.
+    if os.path.isdir(baseline_file):
+        baseline_file = os.path.join(baseline_file, os.path.basename(outfile))
+    if not os.path.exists(baseline_file):
+        pytest.skip("No baseline {}".format(baseline_file))
+
+    with open(baseline_file) as f:
+        baseline = json.load(f)
+
+    regressions = []
+    for nhg, run in bench_results["runs"].items():
+        base = baseline.get("runs", {}).get(nhg)
+        if not base:
+            continue
+        for metric in BENCH_RATES:
+            if not base.get(metric):
+                continue
+            change = (run[metric] - base[metric]) / float(base[metric])
+            logger.info(
+                "{} {}: {} (baseline {}, {:+.1%})".format(
+                    nhg, metric, run[metric], base[metric], change
+                )
+            )
+            if change < -BENCH_TOLERANCE:
+                regressions.append(
+                    "{} {}: {} vs baseline {}".format(
+                        nhg, metric, run[metric], base[metric]
+                    )
+                )
+
+    assert not regressions, "Benchmark regressed:\n{}".format("\n".join(regressions))
@@ -0,0 +1,84 @@
+#!/usr/bin/env python
+
+#
+# test_route_bench_null.py
+#
+# Copyright (c) 2022 by
+# Network Device Education Foundation, Inc. ("NetDEF")
+#
+# Permission to use, copy, modify, and/or distribute this software
+# for any purpose with or without fee is hereby granted, provided
+# that the above copyright notice and this permission notice appear
+# in all copies.
+#
+# THE SOFTWARE IS PROVIDED "AS IS" AND NETDEF DISCLAIMS ALL WARRANTIES
+# WITH REGARD TO THIS SOFTWARE INCLUDING ALL IMPLIED WARRANTIES OF
+# MERCHANTABILITY AND FITNESS. IN NO EVENT SHALL NETDEF BE LIABLE FOR
+# ANY SPECIAL, DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY
+# DAMAGES WHATSOEVER RESULTING FROM LOSS OF USE, DATA OR PROFITS,
+# WHETHER IN AN ACTION OF CONTRACT, NEGLIGENCE OR OTHER TORTIOUS
+# ACTION, ARISING OUT OF OR IN CONNECTION WITH THE USE OR PERFORMANCE
+# OF THIS SOFTWARE.
+#
+
+"""
+test_route_bench_null.py: Route convergence benchmark, null dataplane
+
+zebra acks every update without programming the kernel, so this measures
+zebra's own processing cost. The sample dataplane plugin is only built
+with --enable-dev-build; zebra fails to start without it and the test is
+skipped.
+"""
+import os
+import sys
+import pytest
+
+# Save the Current Working Directory to find configuration files.
+CWD = os.path.dirname(os.path.realpath(__file__))
+sys.path.append(os.path.join(CWD, "../"))
+
+# pylint: disable=C0413
+from bench_common import (
+    bench_build,
+    bench_setup_module,
+    bench_teardown_module,
+    bench_converge_protocols,
+    bench_run,
+    bench_report,
+)
+
+
+pytestmark = [pytest.mark.sharpd]
+
+
+def build(tgen):
+    bench_build(tgen)
+
+
+def setup_module(module):
+    bench_setup_module(module, "null", "-M dplane_sample_plugin:null")
+
+
+def teardown_module(_mod):
+    bench_teardown_module(_mod)
+
+
+def test_converge_protocols():
+    bench_converge_protocols()
+
+
+def test_route_bench_1nh():
+    bench_run("one")
+
+
+def test_route_bench_4nh():
+    bench_run("four")
+
+
+def test_route_bench_report():
+    bench_report()
+
+
+if __name__ == "__main__":
+    args = ["-s"] + sys.argv[1:]
+    sys.exit(pytest.main(args))
@@ -22,6 +22,7 @@
 #include "lib/hash.h"
 #include "lib/hook.h"
 #include "lib/if.h"
+#include "lib/jhash.h"
 #include "lib/linklist.h"
 #include "lib/memory.h"
 #include "lib/network.h"
@@ -42,6 +43,9 @@
 
 DEFINE_MTYPE_STATIC(VRRPD, VRRP_IP, "VRRP IP address");
 DEFINE_MTYPE_STATIC(VRRPD, VRRP_RTR, "VRRP Router");
+DEFINE_MTYPE_STATIC(VRRPD, VRRP_SOCK, "VRRP sockets");
+DEFINE_MTYPE_STATIC(VRRPD, VRRP_TXPKT, "VRRP queued advertisement");
+DEFINE_MTYPE_STATIC(VRRPD, VRRP_TBUCKET, "VRRP timer bucket");
 
 /* statics */
 struct hash *vrrp_vrouters_hash;
@@ -518,6 +522,129 @@ int vrrp_del_ipv4(struct vrrp_vrouter *vr, struct in_addr v4)
 }
 
 
+/* Timers ------------------------------------------------------------------ */
+
+PREDECL_HASH(vrrp_tbuckets);
+
+/* Forward decls */
+static void vrrp_adver_timer_expire(struct vrrp_router *r);
+static void vrrp_master_down_timer_expire(struct vrrp_router *r);
+
+/* All VRRP Router timers expiring in the same centisecond */
+struct vrrp_tbucket {
+	struct vrrp_tbuckets_item itm;
+
+	/* Expiry, monotonic time in centiseconds */
+	int64_t when;
+	/* Timers are running, the bucket is freed afterwards */
+	bool expiring;
+
+	struct vrrp_tbucket_timers_head timers;
+	struct thread *t_expire;
+};
+
+static int vrrp_tbucket_cmp(const struct vrrp_tbucket *a,
+			    const struct vrrp_tbucket *b)
+{
+	return numcmp(a->when, b->when);
+}
+
+static uint32_t vrrp_tbucket_hash(const struct vrrp_tbucket *b)
+{
+	return jhash_2words((uint32_t)b->when, (uint32_t)(b->when >> 32), 0);
+}
+
+DECLARE_HASH(vrrp_tbuckets, struct vrrp_tbucket, itm, vrrp_tbucket_cmp,
+	     vrrp_tbucket_hash);
+DECLARE_DLIST(vrrp_tbucket_timers, struct vrrp_timer, itm);
+
+static struct vrrp_tbuckets_head vrrp_tbuckets;
+
+static void vrrp_timer_init(struct vrrp_timer *t, struct vrrp_router *r,
+			    void (*expire)(struct vrrp_router *r))
+{
+	t->bucket = NULL;
+	t->r = r;
+	t->expire = expire;
+}
+
+static void vrrp_tbucket_expire(struct thread *thread)
+{
+	struct vrrp_tbucket *b = THREAD_ARG(thread);
+	struct vrrp_timer *t;
+
+	/* Timers restarted from here go into new buckets */
+	vrrp_tbuckets_del(&vrrp_tbuckets, b);
+	b->expiring = true;
+
+	while ((t = vrrp_tbucket_timers_pop(&b->timers))) {
+		t->bucket = NULL;
+		t->expire(t->r);
+	}
+
+	vrrp_tbucket_timers_fini(&b->timers);
+	XFREE(MTYPE_VRRP_TBUCKET, b);
+}
+
+/*
+ * Start a VRRP Router timer.
+ *
+ * Like thread_add_timer(), this does nothing if the timer is already running.
+ * The expiry is rounded up to the next centisecond, the timer never expires
+ * early.
+ *
+ * t
+ *    Timer to start
+ *
+ * cs
+ *    Interval, in centiseconds
+ */
+static void vrrp_timer_start(struct vrrp_timer *t, uint32_t cs)
+{
+	struct vrrp_tbucket ref, *b;
+	struct timeval now;
+	int64_t now_ms;
+
+	if (t->bucket)
+		return;
+
+	monotime(&now);
+	now_ms = (int64_t)now.tv_sec * 1000 + now.tv_usec / 1000;
+	ref.when = (now_ms + (int64_t)cs * CS2MS + CS2MS - 1) / CS2MS;
+
+	b = vrrp_tbuckets_find(&vrrp_tbuckets, &ref);
+	if (!b) {
+		b = XCALLOC(MTYPE_VRRP_TBUCKET, sizeof(*b));
+		b->when = ref.when;
+		vrrp_tbucket_timers_init(&b->timers);
+		vrrp_tbuckets_add(&vrrp_tbuckets, b);
+		thread_add_timer_msec(master, vrrp_tbucket_expire, b,
+				      b->when * CS2MS - now_ms, &b->t_expire);
+	}
+
+	t->bucket = b;
+	vrrp_tbucket_timers_add_tail(&b->timers, t);
+}
+
+static void vrrp_timer_stop(struct vrrp_timer *t)
+{
+	struct vrrp_tbucket *b = t->bucket;
+
+	if (!b)
+		return;
+
+	vrrp_tbucket_timers_del(&b->timers, t);
+	t->bucket = NULL;
+
+	if (b->expiring || vrrp_tbucket_timers_count(&b->timers))
+		return;
+
+	THREAD_OFF(b->t_expire);
+	vrrp_tbuckets_del(&vrrp_tbuckets, b);
+	vrrp_tbucket_timers_fini(&b->timers);
+	XFREE(MTYPE_VRRP_TBUCKET, b);
+}
+
 /* Creation and destruction ------------------------------------------------ */
 
 static void vrrp_router_addr_list_del_cb(void *val)
@@ -599,14 +726,15 @@ static struct vrrp_router *vrrp_router_create(struct vrrp_vrouter *vr,
 		XCALLOC(MTYPE_VRRP_RTR, sizeof(struct vrrp_router));
 
 	r->family = family;
-	r->sock_rx = -1;
-	r->sock_tx = -1;
 	r->vr = vr;
 	r->addrs = list_new();
 	r->addrs->del = vrrp_router_addr_list_del_cb;
 	r->priority = vr->priority;
 	r->fsm.state = VRRP_STATE_INITIALIZE;
 	vrrp_mac_set(&r->vmac, family == AF_INET6, vr->vrid);
+	vrrp_timer_init(&r->adver_timer, r, vrrp_adver_timer_expire);
+	vrrp_timer_init(&r->master_down_timer, r,
+			vrrp_master_down_timer_expire);
 
 	vrrp_attach_interface(r);
 
@@ -618,11 +746,6 @@ static void vrrp_router_destroy(struct vrrp_router *r)
 	if (r->is_active)
 		vrrp_event(r, VRRP_EVENT_SHUTDOWN);
 
-	if (r->sock_rx >= 0)
-		close(r->sock_rx);
-	if (r->sock_tx >= 0)
-		close(r->sock_tx);
-
 	/* FIXME: also delete list elements */
 	list_delete(&r->addrs);
 	XFREE(MTYPE_VRRP_RTR, r);
@@ -683,15 +806,54 @@ struct vrrp_vrouter *vrrp_lookup(const struct interface *ifp, uint8_t vrid)
 
 /* Forward decls */
 static void vrrp_change_state(struct vrrp_router *r, int to);
-static void vrrp_adver_timer_expire(struct thread *thread);
-static void vrrp_master_down_timer_expire(struct thread *thread);
+
+/* Advertisements handed to the kernel with a single sendmmsg() */
+#define VRRP_TX_BATCH_MAX 64
+/* Datagrams read per socket wakeup before yielding */
+#define VRRP_RX_BATCH_MAX 64
+
+/* Advertisement waiting in a vrrp_sock's txq */
+struct vrrp_txpkt {
+	struct vrrp_txq_item itm;
+
+	struct vrrp_router *r;
+	ifindex_t ifindex;
+	struct ipaddr src;
+
+	struct vrrp_pkt *pkt;
+	size_t pktsz;
+};
+
+DECLARE_DLIST(vrrp_txq, struct vrrp_txpkt, itm);
+DECLARE_DLIST(vrrp_sock_routers, struct vrrp_router, sock_itm);
+
+static int vrrp_sock_cmp(const struct vrrp_sock *a, const struct vrrp_sock *b)
+{
+	if (a->vrf_id != b->vrf_id)
+		return numcmp(a->vrf_id, b->vrf_id);
+	if (a->ifindex != b->ifindex)
+		return numcmp(a->ifindex, b->ifindex);
+	return numcmp(a->family, b->family);
+}
+
+static uint32_t vrrp_sock_hash(const struct vrrp_sock *s)
+{
+	return jhash_3words(s->vrf_id, s->ifindex, s->family, 0);
+}
+
+DECLARE_HASH(vrrp_socks, struct vrrp_sock, itm, vrrp_sock_cmp, vrrp_sock_hash);
+
+static struct vrrp_socks_head vrrp_sockets;
+
+/* Shared by all sockets, datagrams are processed as soon as they are read */
+static uint8_t vrrp_ibuf[IP_MAXPACKET];
 
 /*
  * Finds the first connected address of the appropriate family on a VRRP
- * router's interface and binds the Tx socket of the VRRP router to that
- * address.
+ * router's interface and uses it as the source address of the VRRP router's
+ * advertisements.
  *
- * Also sets src field of vrrp_router.
+ * Sets src field of vrrp_router.
  *
  * r
  *    VRRP router to operate on
@@ -700,7 +862,7 @@ static void vrrp_master_down_timer_expire(struct thread *thread);
  *     0 on success
  *    -1 on failure
  */
-static int vrrp_bind_to_primary_connected(struct vrrp_router *r)
+static int vrrp_set_source(struct vrrp_router *r)
 {
 	struct interface *ifp;
 
@@ -724,55 +886,159 @@ static int vrrp_bind_to_primary_connected(struct vrrp_router *r)
 
 	if (c == NULL) {
 		zlog_err(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-			 "Failed to find address to bind on %s",
+			 "Failed to find source address on %s",
 			 r->vr->vrid, family2str(r->family), ifp->name);
 		return -1;
 	}
 
-	union sockunion su;
-
-	memset(&su, 0x00, sizeof(su));
-
 	switch (r->family) {
 	case AF_INET:
 		r->src.ipa_type = IPADDR_V4;
 		r->src.ipaddr_v4 = c->address->u.prefix4;
-		su.sin.sin_family = AF_INET;
-		su.sin.sin_addr = c->address->u.prefix4;
 		break;
 	case AF_INET6:
 		r->src.ipa_type = IPADDR_V6;
 		r->src.ipaddr_v6 = c->address->u.prefix6;
-		su.sin6.sin6_family = AF_INET6;
-		su.sin6.sin6_scope_id = ifp->ifindex;
-		su.sin6.sin6_addr = c->address->u.prefix6;
 		break;
 	}
 
-	int ret = 0;
+	DEBUGD(&vrrp_dbg_sock,
+	       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+	       "Using primary IP address %pFX as source address",
+	       r->vr->vrid, family2str(r->family), c->address);
 
-	sockopt_reuseaddr(r->sock_tx);
-	if (bind(r->sock_tx, (const struct sockaddr *)&su, sizeof(su)) < 0) {
-		zlog_err(
-			VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-			"Failed to bind Tx socket to primary IP address %pFX: %s",
-			r->vr->vrid, family2str(r->family), c->address,
-			safe_strerror(errno));
-		ret = -1;
+	return 0;
+}
+
+/*
+ * Fill in the message for a queued advertisement: multicast to the VRRP group,
+ * out of the VRRP router's macvlan, from its source address.
+ */
+static void vrrp_txpkt_msg(struct vrrp_sock *s, struct vrrp_txpkt *tp,
+			   union sockunion *dest, struct msghdr *msg,
+			   struct iovec *iov, uint8_t *cbuf, size_t cbufsz)
+{
+	struct cmsghdr *c;
+
+	memset(msg, 0x00, sizeof(*msg));
+	memset(cbuf, 0x00, cbufsz);
+
+	iov->iov_base = tp->pkt;
+	iov->iov_len = tp->pktsz;
+
+	msg->msg_name = &dest->sa;
+	msg->msg_namelen = sockunion_sizeof(dest);
+	msg->msg_iov = iov;
+	msg->msg_iovlen = 1;
+	msg->msg_control = cbuf;
+
+	if (s->family == AF_INET) {
+		struct in_pktinfo *pi;
+
+		msg->msg_controllen = CMSG_SPACE(sizeof(*pi));
+		c = CMSG_FIRSTHDR(msg);
+		c->cmsg_level = IPPROTO_IP;
+		c->cmsg_type = IP_PKTINFO;
+		c->cmsg_len = CMSG_LEN(sizeof(*pi));
+
+		pi = (struct in_pktinfo *)CMSG_DATA(c);
+		pi->ipi_ifindex = tp->ifindex;
+		pi->ipi_spec_dst = tp->src.ipaddr_v4;
 	} else {
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Bound Tx socket to primary IP address %pFX",
-		       r->vr->vrid, family2str(r->family), c->address);
+		struct in6_pktinfo *pi;
+
+		msg->msg_controllen = CMSG_SPACE(sizeof(*pi));
+		c = CMSG_FIRSTHDR(msg);
+		c->cmsg_level = IPPROTO_IPV6;
+		c->cmsg_type = IPV6_PKTINFO;
+		c->cmsg_len = CMSG_LEN(sizeof(*pi));
+
+		pi = (struct in6_pktinfo *)CMSG_DATA(c);
+		pi->ipi6_ifindex = tp->ifindex;
+		pi->ipi6_addr = tp->src.ipaddr_v6;
 	}
+}
 
-	return ret;
+/*
+ * Send all advertisements queued on a socket.
+ *
+ * s
+ *    Sockets to flush
+ */
+static void vrrp_sock_flush(struct vrrp_sock *s)
+{
+	struct mmsghdr mmsgs[VRRP_TX_BATCH_MAX];
+	struct iovec iov[VRRP_TX_BATCH_MAX];
+	union {
+		uint8_t buf[CMSG_SPACE(sizeof(struct in6_pktinfo))];
+		struct cmsghdr align;
+	} cmsgs[VRRP_TX_BATCH_MAX];
+	struct vrrp_txpkt *pkts[VRRP_TX_BATCH_MAX];
+	struct vrrp_txpkt *tp;
+	union sockunion dest;
+	unsigned int count, pos, i;
+	int ret;
+
+	THREAD_OFF(s->t_write);
+
+	const char *group = s->family == AF_INET ? VRRP_MCASTV4_GROUP_STR
+						 : VRRP_MCASTV6_GROUP_STR;
+	(void)str2sockunion(group, &dest);
+
+	while (vrrp_txq_count(&s->txq)) {
+		memset(mmsgs, 0x00, sizeof(mmsgs));
+
+		for (count = 0; count < VRRP_TX_BATCH_MAX; count++) {
+			tp = vrrp_txq_pop(&s->txq);
+			if (!tp)
+				break;
+
+			pkts[count] = tp;
+			vrrp_txpkt_msg(s, tp, &dest, &mmsgs[count].msg_hdr,
+				       &iov[count], cmsgs[count].buf,
+				       sizeof(cmsgs[count].buf));
+		}
+
+		pos = 0;
+		while (pos < count) {
+			ret = sendmmsg(s->sock_tx, &mmsgs[pos], count - pos, 0);
+			if (ret <= 0) {
+				struct vrrp_router *r = pkts[pos]->r;
+
+				zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID
+					  VRRP_LOGPFX_FAM
+					  "Failed to send VRRP Advertisement: %s",
+					  r->vr->vrid, family2str(r->family),
+					  safe_strerror(errno));
+				pos++;
+				continue;
+			}
+
+			for (i = pos; i < pos + (unsigned int)ret; i++)
+				++pkts[i]->r->stats.adver_tx_cnt;
+			pos += ret;
+		}
+
+		for (i = 0; i < count; i++) {
+			vrrp_pkt_free(pkts[i]->pkt);
+			XFREE(MTYPE_VRRP_TXPKT, pkts[i]);
+		}
+	}
 }
 
+static void vrrp_sock_write(struct thread *thread)
+{
+	struct vrrp_sock *s = THREAD_ARG(thread);
+
+	vrrp_sock_flush(s);
+}
 
 /*
  * Create and multicast a VRRP ADVERTISEMENT message.
  *
+ * The advertisement is queued on the VRRP router's sockets, and sent together
+ * with the advertisements of other VRRP routers that are due at the same time.
+ *
  * r
  *    VRRP Router for which to send ADVERTISEMENT
  */
@@ -781,10 +1047,13 @@ static void vrrp_send_advertisement(struct vrrp_router *r)
 	struct vrrp_pkt *pkt;
 	ssize_t pktsz;
 	struct ipaddr *addrs[r->addrs->count];
-	union sockunion dest;
+	struct vrrp_sock *s = r->sock;
+	struct vrrp_txpkt *tp;
+
+	if (!s)
+		return;
 
-	if (r->src.ipa_type == IPADDR_NONE
-	    && vrrp_bind_to_primary_connected(r) < 0)
+	if (r->src.ipa_type == IPADDR_NONE && vrrp_set_source(r) < 0)
 		return;
 
 	list_to_array(r->addrs, (void **)addrs, r->addrs->count);
@@ -797,23 +1066,18 @@ static void vrrp_send_advertisement(struct vrrp_router *r)
 	if (DEBUG_MODE_CHECK(&vrrp_dbg_pkt, DEBUG_MODE_ALL))
 		zlog_hexdump(pkt, (size_t)pktsz);
 
-	const char *group = r->family == AF_INET ? VRRP_MCASTV4_GROUP_STR
-						 : VRRP_MCASTV6_GROUP_STR;
-	(void)str2sockunion(group, &dest);
-
-	ssize_t sent = sendto(r->sock_tx, pkt, (size_t)pktsz, 0, &dest.sa,
-			      sockunion_sizeof(&dest));
-
-	vrrp_pkt_free(pkt);
+	tp = XCALLOC(MTYPE_VRRP_TXPKT, sizeof(*tp));
+	tp->r = r;
+	tp->ifindex = r->mvl_ifp->ifindex;
+	tp->src = r->src;
+	tp->pkt = pkt;
+	tp->pktsz = (size_t)pktsz;
+	vrrp_txq_add_tail(&s->txq, tp);
 
-	if (sent < 0) {
-		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-			  "Failed to send VRRP Advertisement: %s",
-			  r->vr->vrid, family2str(r->family),
-			  safe_strerror(errno));
-	} else {
-		++r->stats.adver_tx_cnt;
-	}
+	if (vrrp_txq_count(&s->txq) >= VRRP_TX_BATCH_MAX)
+		vrrp_sock_flush(s);
+	else
+		thread_add_event(master, vrrp_sock_write, s, 0, &s->t_write);
 }
 
 /*
@@ -910,11 +1174,9 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 
 		if (pkt->hdr.priority == 0) {
 			vrrp_send_advertisement(r);
-			THREAD_OFF(r->t_adver_timer);
-			thread_add_timer_msec(
-				master, vrrp_adver_timer_expire, r,
-				r->vr->advertisement_interval * CS2MS,
-				&r->t_adver_timer);
+			vrrp_timer_stop(&r->adver_timer);
+			vrrp_timer_start(&r->adver_timer,
+					 r->vr->advertisement_interval);
 		} else if (pkt->hdr.priority > r->priority
 			   || ((pkt->hdr.priority == r->priority)
 			       && addrcmp > 0)) {
@@ -923,17 +1185,15 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 				"Received advertisement from %s w/ priority %hhu; switching to Backup",
 				r->vr->vrid, family2str(r->family), sipstr,
 				pkt->hdr.priority);
-			THREAD_OFF(r->t_adver_timer);
+			vrrp_timer_stop(&r->adver_timer);
 			if (r->vr->version == 3) {
 				r->master_adver_interval =
 					htons(pkt->hdr.v3.adver_int);
 			}
 			vrrp_recalculate_timers(r);
-			THREAD_OFF(r->t_master_down_timer);
-			thread_add_timer_msec(master,
-					      vrrp_master_down_timer_expire, r,
-					      r->master_down_interval * CS2MS,
-					      &r->t_master_down_timer);
+			vrrp_timer_stop(&r->master_down_timer);
+			vrrp_timer_start(&r->master_down_timer,
+					 r->master_down_interval);
 			vrrp_change_state(r, VRRP_STATE_BACKUP);
 		} else {
 			/* Discard advertisement */
@@ -946,10 +1206,8 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 		break;
 	case VRRP_STATE_BACKUP:
 		if (pkt->hdr.priority == 0) {
-			THREAD_OFF(r->t_master_down_timer);
-			thread_add_timer_msec(
-				master, vrrp_master_down_timer_expire, r,
-				r->skew_time * CS2MS, &r->t_master_down_timer);
+			vrrp_timer_stop(&r->master_down_timer);
+			vrrp_timer_start(&r->master_down_timer, r->skew_time);
 		} else if (!r->vr->preempt_mode
 			   || pkt->hdr.priority >= r->priority) {
 			if (r->vr->version == 3) {
@@ -957,11 +1215,9 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 					ntohs(pkt->hdr.v3.adver_int);
 			}
 			vrrp_recalculate_timers(r);
-			THREAD_OFF(r->t_master_down_timer);
-			thread_add_timer_msec(master,
-					      vrrp_master_down_timer_expire, r,
-					      r->master_down_interval * CS2MS,
-					      &r->t_master_down_timer);
+			vrrp_timer_stop(&r->master_down_timer);
+			vrrp_timer_start(&r->master_down_timer,
+					 r->master_down_interval);
 		} else if (r->vr->preempt_mode
 			   && pkt->hdr.priority < r->priority) {
 			/* Discard advertisement */
@@ -983,43 +1239,40 @@ static int vrrp_recv_advertisement(struct vrrp_router *r, struct ipaddr *src,
 	return 0;
 }
 
+static void vrrp_sock_shutdown(struct vrrp_sock *s);
+
 /*
- * Read and process next IPvX datagram.
+ * Process one datagram read from a socket.
+ *
+ * The VRRP Router it is for is looked up by the VRID in the packet, before it
+ * is validated against that router's version and checksum settings.
  */
-static void vrrp_read(struct thread *thread)
+static void vrrp_sock_recv(struct vrrp_sock *s, struct msghdr *m,
+			   size_t nbytes)
 {
-	struct vrrp_router *r = THREAD_ARG(thread);
-
 	struct vrrp_pkt *pkt;
 	ssize_t pktsize;
-	ssize_t nbytes;
-	bool resched;
 	char errbuf[BUFSIZ];
-	struct sockaddr_storage sa;
-	uint8_t control[64];
 	struct ipaddr src = {};
+	struct interface *ifp;
+	struct vrrp_vrouter *vr = NULL;
+	struct vrrp_router *r = NULL;
+	int vrid;
 
-	struct msghdr m = {};
-	struct iovec iov;
-
-	iov.iov_base = r->ibuf;
-	iov.iov_len = sizeof(r->ibuf);
-	m.msg_name = &sa;
-	m.msg_namelen = sizeof(sa);
-	m.msg_iov = &iov;
-	m.msg_iovlen = 1;
-	m.msg_control = control;
-	m.msg_controllen = sizeof(control);
+	vrid = vrrp_pkt_peek_vrid(s->family, vrrp_ibuf, nbytes);
+	ifp = if_lookup_by_index(s->ifindex, s->vrf_id);
 
-	nbytes = recvmsg(r->sock_rx, &m, MSG_DONTWAIT);
+	if (vrid >= 0 && ifp)
+		vr = vrrp_lookup(ifp, vrid);
+	if (vr)
+		r = s->family == AF_INET ? vr->v4 : vr->v6;
 
-	if ((nbytes < 0 && ERRNO_IO_RETRY(errno))) {
-		resched = true;
-		goto done;
-	} else if (nbytes <= 0) {
-		vrrp_event(r, VRRP_EVENT_SHUTDOWN);
-		resched = false;
-		goto done;
+	if (!r || r->sock != s) {
+		DEBUGD(&vrrp_dbg_pkt,
+		       VRRP_LOGPFX VRRP_LOGPFX_FAM
+		       "Datagram rx on %s for VRID %d; no such VRRP router, ignoring",
+		       family2str(s->family), ifp ? ifp->name : "?", vrid);
+		return;
 	}
 
 	if (DEBUG_MODE_CHECK(&vrrp_dbg_pkt, DEBUG_MODE_ALL)) {
@@ -1027,12 +1280,12 @@ static void vrrp_read(struct thread *thread)
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Datagram rx: ",
 		       r->vr->vrid, family2str(r->family));
-		zlog_hexdump(r->ibuf, nbytes);
+		zlog_hexdump(vrrp_ibuf, nbytes);
 	}
 
 	pktsize = vrrp_pkt_parse_datagram(
 		r->family, r->vr->version,
-		r->vr->checksum_with_ipv4_pseudoheader, &m, nbytes, &src, &pkt,
+		r->vr->checksum_with_ipv4_pseudoheader, m, nbytes, &src, &pkt,
 		errbuf, sizeof(errbuf));
 
 	if (pktsize < 0)
@@ -1042,57 +1295,97 @@ static void vrrp_read(struct thread *thread)
 		       r->vr->vrid, family2str(r->family), errbuf);
 	else
 		vrrp_recv_advertisement(r, &src, pkt, pktsize);
+}
 
-	resched = true;
+/*
+ * Read and process pending IPvX datagrams.
+ */
+static void vrrp_read(struct thread *thread)
+{
+	struct vrrp_sock *s = THREAD_ARG(thread);
 
-done:
-	memset(r->ibuf, 0x00, sizeof(r->ibuf));
+	ssize_t nbytes;
+	struct sockaddr_storage sa;
+	uint8_t control[64];
+	struct msghdr m;
+	struct iovec iov;
+
+	for (int i = 0; i < VRRP_RX_BATCH_MAX; i++) {
+		memset(&m, 0x00, sizeof(m));
+		iov.iov_base = vrrp_ibuf;
+		iov.iov_len = sizeof(vrrp_ibuf);
+		m.msg_name = &sa;
+		m.msg_namelen = sizeof(sa);
+		m.msg_iov = &iov;
+		m.msg_iovlen = 1;
+		m.msg_control = control;
+		m.msg_controllen = sizeof(control);
+
+		nbytes = recvmsg(s->sock_rx, &m, MSG_DONTWAIT);
+
+		if (nbytes < 0 && ERRNO_IO_RETRY(errno))
+			break;
+		if (nbytes <= 0) {
+			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_FAM
+				  "Failed to read from Rx socket: %s",
+				  family2str(s->family), safe_strerror(errno));
+			vrrp_sock_shutdown(s);
+			return;
+		}
+
+		vrrp_sock_recv(s, &m, nbytes);
+	}
 
-	if (resched)
-		thread_add_read(master, vrrp_read, r, r->sock_rx, &r->t_read);
+	thread_add_read(master, vrrp_read, s, s->sock_rx, &s->t_read);
 }
 
 /*
- * Creates and configures VRRP router sockets.
+ * Creates and configures the sockets shared by the VRRP routers of one address
+ * family on one interface.
  *
  * This function:
  * - Creates two sockets, one for Tx, one for Rx
- * - Binds the Tx socket to the macvlan device, if necessary (VRF case)
- * - Binds the Rx socket to the base interface
+ * - Binds the Rx socket to the interface
  * - Joins the Rx socket to the appropriate VRRP multicast group
  * - Sets the Tx socket to set the TTL (v4) or Hop Limit (v6) field to 255 for
  *   all transmitted IPvX packets
  * - Requests the kernel to deliver IPv6 header values needed to validate VRRP
  *   packets
  *
+ * The Tx socket is not bound to any device or address; each advertisement
+ * carries the macvlan device and source address of its VRRP router as
+ * pktinfo. That is also what selects the macvlan device over the vrf device
+ * in the VRF case.
+ *
  * If any of the above fail, the sockets are closed. The only exception is if
  * the TTL / Hop Limit settings fail; these are logged, but configuration
  * proceeds.
  *
- * The first connected address on the Virtual Router's interface is used as the
- * interface address.
+ * s
+ *    Sockets to open
  *
  * r
- *    VRRP Router for which to create listen socket
+ *    VRRP Router the sockets are opened for, for logging
  *
  * Returns:
  *     0 on success
  *    -1 on failure
  */
-static int vrrp_socket(struct vrrp_router *r)
+static int vrrp_sock_open(struct vrrp_sock *s, struct vrrp_router *r)
 {
+	struct interface *ifp = r->vr->ifp;
 	int ret;
 	bool failed = false;
 
 	frr_with_privs(&vrrp_privs) {
-		r->sock_rx = vrf_socket(r->family, SOCK_RAW, IPPROTO_VRRP,
-					r->vr->ifp->vrf->vrf_id, NULL);
-		r->sock_tx = vrf_socket(r->family, SOCK_RAW, IPPROTO_VRRP,
-					r->vr->ifp->vrf->vrf_id, NULL);
+		s->sock_rx = vrf_socket(s->family, SOCK_RAW, IPPROTO_VRRP,
+					s->vrf_id, NULL);
+		s->sock_tx = vrf_socket(s->family, SOCK_RAW, IPPROTO_VRRP,
+					s->vrf_id, NULL);
 	}
 
-	if (r->sock_rx < 0 || r->sock_tx < 0) {
-		const char *rxtx = r->sock_rx < 0 ? "Rx" : "Tx";
+	if (s->sock_rx < 0 || s->sock_tx < 0) {
+		const char *rxtx = s->sock_rx < 0 ? "Rx" : "Tx";
 
 		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 			  "Can't create VRRP %s socket",
@@ -1101,33 +1394,12 @@ static int vrrp_socket(struct vrrp_router *r)
 		goto done;
 	}
 
-	/*
-	 * Bind Tx socket to macvlan device - necessary for VRF support,
-	 * otherwise the kernel will select the vrf device
-	 */
-	if (r->vr->ifp->vrf->vrf_id != VRF_DEFAULT) {
-		frr_with_privs (&vrrp_privs) {
-			ret = setsockopt(r->sock_tx, SOL_SOCKET,
-					 SO_BINDTODEVICE, r->mvl_ifp->name,
-					 strlen(r->mvl_ifp->name));
-		}
-
-		if (ret < 0) {
-			zlog_warn(
-				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				"Failed to bind Tx socket to macvlan device '%s'",
-				r->vr->vrid, family2str(r->family),
-				r->mvl_ifp->name);
-			failed = true;
-			goto done;
-		}
-	}
 	/* Configure sockets */
-	if (r->family == AF_INET) {
+	if (s->family == AF_INET) {
 		/* Set Tx socket to always Tx with TTL set to 255 */
 		int ttl = 255;
 
-		ret = setsockopt(r->sock_tx, IPPROTO_IP, IP_MULTICAST_TTL, &ttl,
+		ret = setsockopt(s->sock_tx, IPPROTO_IP, IP_MULTICAST_TTL, &ttl,
 				 sizeof(ttl));
 		if (ret < 0) {
 			zlog_warn(
@@ -1137,36 +1409,36 @@ static int vrrp_socket(struct vrrp_router *r)
 		}
 
 		/* Set Tx socket DSCP byte */
-		setsockopt_ipv4_tos(r->sock_tx, IPTOS_PREC_INTERNETCONTROL);
+		setsockopt_ipv4_tos(s->sock_tx, IPTOS_PREC_INTERNETCONTROL);
 
 		/* Turn off multicast loop on Tx */
-		setsockopt_ipv4_multicast_loop(r->sock_tx, 0);
+		setsockopt_ipv4_multicast_loop(s->sock_tx, 0);
 
 		/* Bind Rx socket to exact interface */
 		frr_with_privs(&vrrp_privs) {
-			ret = setsockopt(r->sock_rx, SOL_SOCKET,
-					 SO_BINDTODEVICE, r->vr->ifp->name,
-					 strlen(r->vr->ifp->name));
+			ret = setsockopt(s->sock_rx, SOL_SOCKET,
+					 SO_BINDTODEVICE, ifp->name,
+					 strlen(ifp->name));
 		}
 		if (ret) {
 			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 				  "Failed to bind Rx socket to %s: %s",
 				  r->vr->vrid, family2str(r->family),
-				  r->vr->ifp->name, safe_strerror(errno));
+				  ifp->name, safe_strerror(errno));
 			failed = true;
 			goto done;
 		}
 		DEBUGD(&vrrp_dbg_sock,
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Bound Rx socket to %s",
-		       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
+		       r->vr->vrid, family2str(r->family), ifp->name);
 
 		/* Bind Rx socket to v4 multicast address */
 		struct sockaddr_in sa = {0};
 
 		sa.sin_family = AF_INET;
 		sa.sin_addr.s_addr = htonl(VRRP_MCASTV4_GROUP);
-		if (bind(r->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
+		if (bind(s->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
 			zlog_err(
 				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 				"Failed to bind Rx socket to VRRP multicast group: %s",
@@ -1181,13 +1453,13 @@ static int vrrp_socket(struct vrrp_router *r)
 		       r->vr->vrid, family2str(r->family));
 
 		/* Join Rx socket to VRRP IPv4 multicast group */
-		assert(listhead(r->vr->ifp->connected));
-		struct connected *c = listhead(r->vr->ifp->connected)->data;
+		assert(listhead(ifp->connected));
+		struct connected *c = listhead(ifp->connected)->data;
 		struct in_addr v4 = c->address->u.prefix4;
 
-		ret = setsockopt_ipv4_multicast(r->sock_rx, IP_ADD_MEMBERSHIP,
+		ret = setsockopt_ipv4_multicast(s->sock_rx, IP_ADD_MEMBERSHIP,
 						v4, htonl(VRRP_MCASTV4_GROUP),
-						r->vr->ifp->ifindex);
+						ifp->ifindex);
 		if (ret < 0) {
 			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID
 				  "Failed to join VRRP %s multicast group",
@@ -1199,36 +1471,9 @@ static int vrrp_socket(struct vrrp_router *r)
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Joined VRRP multicast group",
 		       r->vr->vrid, family2str(r->family));
-
-		/* Set outgoing interface for advertisements */
-		struct ip_mreqn mreqn = {};
-
-		mreqn.imr_ifindex = r->mvl_ifp->ifindex;
-		ret = setsockopt(r->sock_tx, IPPROTO_IP, IP_MULTICAST_IF,
-				 (void *)&mreqn, sizeof(mreqn));
-		if (ret < 0) {
-			zlog_warn(
-				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				"Could not set %s as outgoing multicast interface",
-				r->vr->vrid, family2str(r->family),
-				r->mvl_ifp->name);
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Set %s as outgoing multicast interface",
-		       r->vr->vrid, family2str(r->family), r->mvl_ifp->name);
-
-		/* Select and bind source address */
-		if (vrrp_bind_to_primary_connected(r) < 0) {
-			failed = true;
-			goto done;
-		}
-
-	} else if (r->family == AF_INET6) {
+	} else if (s->family == AF_INET6) {
 		/* Always transmit IPv6 packets with hop limit set to 255 */
-		ret = setsockopt_ipv6_multicast_hops(r->sock_tx, 255);
+		ret = setsockopt_ipv6_multicast_hops(s->sock_tx, 255);
 		if (ret < 0) {
 			zlog_warn(
 				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
@@ -1237,10 +1482,10 @@ static int vrrp_socket(struct vrrp_router *r)
 		}
 
 		/* Set Tx socket DSCP byte */
-		setsockopt_ipv6_tclass(r->sock_tx, IPTOS_PREC_INTERNETCONTROL);
+		setsockopt_ipv6_tclass(s->sock_tx, IPTOS_PREC_INTERNETCONTROL);
 
 		/* Request hop limit delivery */
-		setsockopt_ipv6_hoplimit(r->sock_rx, 1);
+		setsockopt_ipv6_hoplimit(s->sock_rx, 1);
 		if (ret < 0) {
 			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 				  "Failed to request IPv6 Hop Limit delivery",
@@ -1250,33 +1495,33 @@ static int vrrp_socket(struct vrrp_router *r)
 		}
 
 		/* Turn off multicast loop on Tx */
-		setsockopt_ipv6_multicast_loop(r->sock_tx, 0);
+		setsockopt_ipv6_multicast_loop(s->sock_tx, 0);
 
 		/* Bind Rx socket to exact interface */
 		frr_with_privs(&vrrp_privs) {
-			ret = setsockopt(r->sock_rx, SOL_SOCKET,
-					 SO_BINDTODEVICE, r->vr->ifp->name,
-					 strlen(r->vr->ifp->name));
+			ret = setsockopt(s->sock_rx, SOL_SOCKET,
+					 SO_BINDTODEVICE, ifp->name,
+					 strlen(ifp->name));
 		}
 		if (ret) {
 			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 				  "Failed to bind Rx socket to %s: %s",
 				  r->vr->vrid, family2str(r->family),
-				  r->vr->ifp->name, safe_strerror(errno));
+				  ifp->name, safe_strerror(errno));
 			failed = true;
 			goto done;
 		}
 		DEBUGD(&vrrp_dbg_sock,
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Bound Rx socket to %s",
-		       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
+		       r->vr->vrid, family2str(r->family), ifp->name);
 
 		/* Bind Rx socket to v6 multicast address */
 		struct sockaddr_in6 sa = {0};
 
 		sa.sin6_family = AF_INET6;
 		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR, &sa.sin6_addr);
-		if (bind(r->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
+		if (bind(s->sock_rx, (struct sockaddr *)&sa, sizeof(sa))) {
 			zlog_err(
 				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 				"Failed to bind Rx socket to VRRP multicast group: %s",
@@ -1295,8 +1540,8 @@ static int vrrp_socket(struct vrrp_router *r)
 
 		inet_pton(AF_INET6, VRRP_MCASTV6_GROUP_STR,
 			  &mreq.ipv6mr_multiaddr);
-		mreq.ipv6mr_interface = r->vr->ifp->ifindex;
-		ret = setsockopt(r->sock_rx, IPPROTO_IPV6, IPV6_JOIN_GROUP,
+		mreq.ipv6mr_interface = ifp->ifindex;
+		ret = setsockopt(s->sock_rx, IPPROTO_IPV6, IPV6_JOIN_GROUP,
 				 &mreq, sizeof(mreq));
 		if (ret < 0) {
 			zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
@@ -1309,23 +1554,6 @@ static int vrrp_socket(struct vrrp_router *r)
 		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		       "Joined VRRP multicast group",
 		       r->vr->vrid, family2str(r->family));
-
-		/* Set outgoing interface for advertisements */
-		ret = setsockopt(r->sock_tx, IPPROTO_IPV6, IPV6_MULTICAST_IF,
-				 &r->mvl_ifp->ifindex, sizeof(ifindex_t));
-		if (ret < 0) {
-			zlog_warn(
-				VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-				"Could not set %s as outgoing multicast interface",
-				r->vr->vrid, family2str(r->family),
-				r->mvl_ifp->name);
-			failed = true;
-			goto done;
-		}
-		DEBUGD(&vrrp_dbg_sock,
-		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
-		       "Set %s as outgoing multicast interface",
-		       r->vr->vrid, family2str(r->family), r->mvl_ifp->name);
 	}
 
 done:
@@ -1334,13 +1562,13 @@ done:
 		zlog_warn(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 			  "Failed to initialize VRRP router",
 			  r->vr->vrid, family2str(r->family));
-		if (r->sock_rx >= 0) {
-			close(r->sock_rx);
-			r->sock_rx = -1;
+		if (s->sock_rx >= 0) {
+			close(s->sock_rx);
+			s->sock_rx = -1;
 		}
-		if (r->sock_tx >= 0) {
-			close(r->sock_tx);
-			r->sock_tx = -1;
+		if (s->sock_tx >= 0) {
+			close(s->sock_tx);
+			s->sock_tx = -1;
 		}
 		ret = -1;
 	}
@@ -1348,6 +1576,113 @@ done:
 	return ret;
 }
 
+static void vrrp_sock_unref(struct vrrp_sock *s)
+{
+	struct vrrp_txpkt *tp;
+
+	if (--s->refcnt)
+		return;
+
+	while ((tp = vrrp_txq_pop(&s->txq))) {
+		vrrp_pkt_free(tp->pkt);
+		XFREE(MTYPE_VRRP_TXPKT, tp);
+	}
+	THREAD_OFF(s->t_read);
+	THREAD_OFF(s->t_write);
+	close(s->sock_rx);
+	close(s->sock_tx);
+
+	vrrp_socks_del(&vrrp_sockets, s);
+	vrrp_sock_routers_fini(&s->routers);
+	vrrp_txq_fini(&s->txq);
+	XFREE(MTYPE_VRRP_SOCK, s);
+}
+
+/*
+ * Attach a VRRP Router to the sockets of its interface and address family,
+ * creating them if it is the first one.
+ *
+ * Returns:
+ *     0 on success
+ *    -1 if the sockets could not be created
+ */
+static int vrrp_sock_attach(struct vrrp_router *r)
+{
+	struct vrrp_sock ref, *s;
+
+	ref.vrf_id = r->vr->ifp->vrf->vrf_id;
+	ref.ifindex = r->vr->ifp->ifindex;
+	ref.family = r->family;
+
+	s = vrrp_socks_find(&vrrp_sockets, &ref);
+	if (!s) {
+		s = XCALLOC(MTYPE_VRRP_SOCK, sizeof(*s));
+		s->vrf_id = ref.vrf_id;
+		s->ifindex = ref.ifindex;
+		s->family = ref.family;
+		s->sock_rx = -1;
+		s->sock_tx = -1;
+
+		if (vrrp_sock_open(s, r) < 0) {
+			XFREE(MTYPE_VRRP_SOCK, s);
+			return -1;
+		}
+
+		vrrp_sock_routers_init(&s->routers);
+		vrrp_txq_init(&s->txq);
+		vrrp_socks_add(&vrrp_sockets, s);
+
+		/* Schedule listener */
+		thread_add_read(master, vrrp_read, s, s->sock_rx, &s->t_read);
+
+		DEBUGD(&vrrp_dbg_sock,
+		       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
+		       "Opened VRRP sockets on %s",
+		       r->vr->vrid, family2str(r->family), r->vr->ifp->name);
+	}
+
+	s->refcnt++;
+	vrrp_sock_routers_add_tail(&s->routers, r);
+	r->sock = s;
+
+	return 0;
+}
+
+/*
+ * Detach a VRRP Router from its sockets. Its queued advertisements are sent
+ * first, and the sockets are closed after the last router is gone.
+ */
+static void vrrp_sock_detach(struct vrrp_router *r)
+{
+	struct vrrp_sock *s = r->sock;
+
+	if (!s)
+		return;
+
+	if (vrrp_txq_count(&s->txq))
+		vrrp_sock_flush(s);
+
+	vrrp_sock_routers_del(&s->routers, r);
+	r->sock = NULL;
+	vrrp_sock_unref(s);
+}
+
+/*
+ * The Rx socket failed; shut down every VRRP Router using it.
+ */
+static void vrrp_sock_shutdown(struct vrrp_sock *s)
+{
+	struct vrrp_router *r;
+
+	/* Keep s around until all of them are done */
+	s->refcnt++;
+
+	frr_each_safe (vrrp_sock_routers, &s->routers, r)
+		vrrp_event(r, VRRP_EVENT_SHUTDOWN);
+
+	vrrp_sock_unref(s);
+}
+
 
 /* State machine ----------------------------------------------------------- */
 
@@ -1415,7 +1750,7 @@ static void vrrp_change_state_backup(struct vrrp_router *r)
 		vrrp_zebra_radv_set(r, false);
 
 	/* Disable Adver_Timer */
-	THREAD_OFF(r->t_adver_timer);
+	vrrp_timer_stop(&r->adver_timer);
 
 	r->advert_pending = false;
 	r->garp_pending = false;
@@ -1483,10 +1818,8 @@ static void vrrp_change_state(struct vrrp_router *r, int to)
 /*
  * Called when Adver_Timer expires.
  */
-static void vrrp_adver_timer_expire(struct thread *thread)
+static void vrrp_adver_timer_expire(struct vrrp_router *r)
 {
-	struct vrrp_router *r = THREAD_ARG(thread);
-
 	DEBUGD(&vrrp_dbg_proto,
 	       VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 	       "Adver_Timer expired",
@@ -1497,9 +1830,8 @@ static void vrrp_adver_timer_expire(struct thread *thread)
 		vrrp_send_advertisement(r);
 
 		/* Reset the Adver_Timer to Advertisement_Interval */
-		thread_add_timer_msec(master, vrrp_adver_timer_expire, r,
-				      r->vr->advertisement_interval * CS2MS,
-				      &r->t_adver_timer);
+		vrrp_timer_start(&r->adver_timer,
+				 r->vr->advertisement_interval);
 	} else {
 		zlog_err(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 			 "Adver_Timer expired in state '%s'; this is a bug",
@@ -1511,17 +1843,13 @@ static void vrrp_adver_timer_expire(struct thread *thread)
 /*
  * Called when Master_Down_Timer expires.
  */
-static void vrrp_master_down_timer_expire(struct thread *thread)
+static void vrrp_master_down_timer_expire(struct vrrp_router *r)
 {
-	struct vrrp_router *r = THREAD_ARG(thread);
-
 	zlog_info(VRRP_LOGPFX VRRP_LOGPFX_VRID VRRP_LOGPFX_FAM
 		  "Master_Down_Timer expired",
 		  r->vr->vrid, family2str(r->family));
 
-	thread_add_timer_msec(master, vrrp_adver_timer_expire, r,
-			      r->vr->advertisement_interval * CS2MS,
-			      &r->t_adver_timer);
+	vrrp_timer_start(&r->adver_timer, r->vr->advertisement_interval);
 	vrrp_change_state(r, VRRP_STATE_MASTER);
 }
 
@@ -1562,17 +1890,16 @@ static int vrrp_startup(struct vrrp_router *r)
 	if (r->family == AF_INET6 && !vrrp_ndisc_is_init())
 		vrrp_ndisc_init();
 
-	/* Create socket */
-	if (r->sock_rx < 0 || r->sock_tx < 0) {
-		int ret = vrrp_socket(r);
+	/* Attach to the interface's sockets, creating them if necessary */
+	if (!r->sock && vrrp_sock_attach(r) < 0)
+		return -1;
 
-		if (ret < 0 || r->sock_tx < 0 || r->sock_rx < 0)
-			return ret;
+	/* Select IPv4 source address; IPv6 waits for the macvlan link-local */
+	if (r->family == AF_INET && vrrp_set_source(r) < 0) {
+		vrrp_sock_detach(r);
+		return -1;
 	}
 
-	/* Schedule listener */
-	thread_add_read(master, vrrp_read, r, r->sock_rx, &r->t_read);
-
 	/* Configure effective priority */
 	assert(listhead(r->addrs));
 	struct ipaddr *primary = (struct ipaddr *)listhead(r->addrs)->data;
@@ -1593,16 +1920,14 @@ static int vrrp_startup(struct vrrp_router *r)
 	}
 
 	if (r->priority == VRRP_PRIO_MASTER) {
-		thread_add_timer_msec(master, vrrp_adver_timer_expire, r,
-				      r->vr->advertisement_interval * CS2MS,
-				      &r->t_adver_timer);
+		vrrp_timer_start(&r->adver_timer,
+				 r->vr->advertisement_interval);
 		vrrp_change_state(r, VRRP_STATE_MASTER);
 	} else {
 		r->master_adver_interval = r->vr->advertisement_interval;
 		vrrp_recalculate_timers(r);
-		thread_add_timer_msec(master, vrrp_master_down_timer_expire, r,
-				      r->master_down_interval * CS2MS,
-				      &r->t_master_down_timer);
+		vrrp_timer_start(&r->master_down_timer,
+				 r->master_down_interval);
 		vrrp_change_state(r, VRRP_STATE_BACKUP);
 	}
 
@@ -1642,10 +1967,8 @@ static int vrrp_shutdown(struct vrrp_router *r)
 	}
 
 	/* Cancel all timers */
-	THREAD_OFF(r->t_adver_timer);
-	THREAD_OFF(r->t_master_down_timer);
-	THREAD_OFF(r->t_read);
-	THREAD_OFF(r->t_write);
+	vrrp_timer_stop(&r->adver_timer);
+	vrrp_timer_stop(&r->master_down_timer);
 
 	/* Protodown macvlan */
 	if (r->mvl_ifp)
@@ -1654,14 +1977,8 @@ static int vrrp_shutdown(struct vrrp_router *r)
 	/* Throw away our source address */
 	memset(&r->src, 0x00, sizeof(r->src));
 
-	if (r->sock_rx > 0) {
-		close(r->sock_rx);
-		r->sock_rx = -1;
-	}
-	if (r->sock_tx > 0) {
-		close(r->sock_tx);
-		r->sock_tx = -1;
-	}
+	/* Send the Priority = 0 ADVERTISEMENT, leave the sockets */
+	vrrp_sock_detach(r);
 
 	vrrp_change_state(r, VRRP_STATE_INITIALIZE);
 
@@ -2405,6 +2722,8 @@ void vrrp_init(void)
 	vrrp_autoconfig_version = 3;
 	vrrp_vrouters_hash = hash_create(&vrrp_hash_key, vrrp_hash_cmp,
 					 "VRRP virtual router hash");
+	vrrp_socks_init(&vrrp_sockets);
+	vrrp_tbuckets_init(&vrrp_tbuckets);
 	vrf_init(NULL, NULL, NULL, NULL);
 }
 
@@ -2423,4 +2742,7 @@ void vrrp_fini(void)
 
 	hash_clean(vrrp_vrouters_hash, NULL);
 	hash_free(vrrp_vrouters_hash);
+
+	vrrp_tbuckets_fini(&vrrp_tbuckets);
+	vrrp_socks_fini(&vrrp_sockets);
 }
@@ -32,6 +32,7 @@
 #include "lib/privs.h"
 #include "lib/stream.h"
 #include "lib/thread.h"
+#include "lib/typesafe.h"
 #include "lib/vty.h"
 
 /* Global definitions */
@@ -86,6 +87,62 @@ extern struct zebra_privs_t vrrp_privs;
 /* Global hash of all Virtual Routers */
 extern struct hash *vrrp_vrouters_hash;
 
+PREDECL_HASH(vrrp_socks);
+PREDECL_DLIST(vrrp_sock_routers);
+PREDECL_DLIST(vrrp_txq);
+PREDECL_DLIST(vrrp_tbucket_timers);
+
+struct vrrp_router;
+
+/*
+ * Sockets shared by all VRRP Routers of one address family on one interface.
+ *
+ * Advertisements are received on the interface and handed to the VRRP Router
+ * owning the VRID in the packet. They are sent on each VRRP Router's macvlan
+ * interface, selected per packet, and queued so that the advertisements of
+ * all VRRP Routers whose timers expire together go out in one sendmmsg().
+ */
+struct vrrp_sock {
+	struct vrrp_socks_item itm;
+
+	/* Interface the VRRP Routers run on */
+	vrf_id_t vrf_id;
+	ifindex_t ifindex;
+	int family;
+
+	/* Rx socket: Rx from the interface */
+	int sock_rx;
+	/* Tx socket: Tx from the macvlan given in each packet's pktinfo */
+	int sock_tx;
+
+	/* VRRP Routers using these sockets, plus a temporary reference */
+	struct vrrp_sock_routers_head routers;
+	unsigned int refcnt;
+
+	/* Advertisements waiting for t_write */
+	struct vrrp_txq_head txq;
+
+	struct thread *t_read;
+	struct thread *t_write;
+};
+
+/*
+ * VRRP Router timer.
+ *
+ * Timers of all VRRP Routers expiring in the same centisecond, the unit of all
+ * VRRP intervals, share one thread timer; see vrrp_timer_start().
+ */
+struct vrrp_tbucket;
+
+struct vrrp_timer {
+	struct vrrp_tbucket_timers_item itm;
+	/* NULL while not running */
+	struct vrrp_tbucket *bucket;
+
+	struct vrrp_router *r;
+	void (*expire)(struct vrrp_router *r);
+};
+
 /*
  * VRRP Router.
  *
@@ -101,10 +158,9 @@ struct vrrp_router {
 	/* Whether we are the address owner */
 	bool is_owner;
 
-	/* Rx socket: Rx from parent of mvl_ifp */
-	int sock_rx;
-	/* Tx socket; Tx from mvl_ifp */
-	int sock_tx;
+	/* Sockets while active, shared with the interface's other routers */
+	struct vrrp_sock *sock;
+	struct vrrp_sock_routers_item sock_itm;
 
 	/* macvlan interface */
 	struct interface *mvl_ifp;
@@ -112,9 +168,6 @@ struct vrrp_router {
 	/* Source address for advertisements */
 	struct ipaddr src;
 
-	/* Socket read buffer */
-	uint8_t ibuf[IP_MAXPACKET];
-
 	/*
 	 * Address family of this Virtual Router.
 	 * Either AF_INET or AF_INET6.
@@ -206,10 +259,8 @@ struct vrrp_router {
 		uint32_t trans_cnt;
 	} stats;
 
-	struct thread *t_master_down_timer;
-	struct thread *t_adver_timer;
-	struct thread *t_read;
-	struct thread *t_write;
+	struct vrrp_timer master_down_timer;
+	struct vrrp_timer adver_timer;
 };
 
 /*
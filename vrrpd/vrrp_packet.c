@@ -191,6 +191,22 @@ size_t vrrp_pkt_adver_dump(char *buf, size_t buflen, struct vrrp_pkt *pkt)
 	return rs;
 }
 
+int vrrp_pkt_peek_vrid(int family, const uint8_t *buf, size_t read)
+{
+	size_t offset = 0;
+
+	if (family == AF_INET) {
+		if (read < sizeof(struct ip))
+			return -1;
+		offset = ((const struct ip *)buf)->ip_hl << 2;
+	}
+
+	if (read < offset + VRRP_HDR_SIZE)
+		return -1;
+
+	return ((const struct vrrp_hdr *)(buf + offset))->vrid;
+}
+
 ssize_t vrrp_pkt_parse_datagram(int family, int version, bool ipv4_ph,
 				struct msghdr *m, size_t read,
 				struct ipaddr *src, struct vrrp_pkt **pkt,
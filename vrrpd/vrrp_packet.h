@@ -155,6 +155,23 @@ void vrrp_pkt_free(struct vrrp_pkt *pkt);
  */
 size_t vrrp_pkt_adver_dump(char *buf, size_t buflen, struct vrrp_pkt *pkt);
 
+/*
+ * Finds the VRID of a received datagram, so that it can be handed to the VRRP
+ * router it is for before being parsed. Nothing else is validated.
+ *
+ * family
+ *    Address family of received packet
+ *
+ * buf
+ *    Datagram as returned by recvmsg(), IPv4 header included
+ *
+ * read
+ *    Return value of recvmsg()
+ *
+ * Returns:
+ *    VRID, or -1 if the datagram is too short to contain one
+ */
+int vrrp_pkt_peek_vrid(int family, const uint8_t *buf, size_t read);
 
 /*
  * Parses a VRRP packet, checking for illegal or invalid data.
@@ -25,6 +25,7 @@
 #include <sys/wait.h>
 #include <sys/resource.h>
 #include <sys/stat.h>
+#include <poll.h>
 
 /* readline carries some ancient definitions around */
 #pragma GCC diagnostic push
@@ -54,6 +55,8 @@
 #include "bgpd/bgp_vty.h"
 
 DEFINE_MTYPE_STATIC(MVTYSH, VTYSH_CMD, "Vtysh cmd copy");
+DEFINE_MTYPE_STATIC(MVTYSH, VTYSH_BATCH, "Vtysh config batch");
+DEFINE_MTYPE_STATIC(MVTYSH, VTYSH_CONFIG_RX, "Vtysh running config");
 
 /* Struct VTY. */
 struct vty *vty;
@@ -191,6 +194,40 @@ static void vclient_close(struct vtysh_client *vclient)
 	}
 }
 
+/*
+ * Batched configuration transfer.
+ *
+ * Sending every line of a configuration file to each daemon and waiting for
+ * the answer before reading the next line makes loading large configurations
+ * painfully slow. While reading a configuration file, lines are queued
+ * instead, and each daemon then gets its whole share of the configuration
+ * in a single stream, with up to VTYSH_BATCH_WINDOW commands in flight. The
+ * daemons group the YANG-modeled commands received between
+ * XFRR_start_configuration and XFRR_end_configuration into a single
+ * transaction.
+ */
+#define VTYSH_BATCH_WINDOW 128
+
+struct vtysh_batch_line {
+	char *line;
+	int lineno;
+	int daemon;
+
+	/* Instances of the daemon being streamed that (didn't) take it. */
+	uint16_t hits, misses;
+};
+
+static struct {
+	bool active;
+	struct vtysh_batch_line *lines;
+	size_t count, size;
+
+	/* Status code of the last failure, if any. */
+	int retcode;
+} vtysh_batch;
+
+static void vtysh_batch_send(void);
+
 static ssize_t vtysh_client_receive(struct vtysh_client *vclient, char *buf,
 				    size_t bufsz, int *pass_fd)
 {
@@ -281,6 +318,9 @@ static int vtysh_client_run(struct vtysh_client *vclient, const char *line,
 	if (vclient->fd < 0)
 		return CMD_SUCCESS;
 
+	/* Don't overtake configuration lines that are still queued. */
+	vtysh_batch_send();
+
 	ret = write(vclient->fd, line, strlen(line) + 1);
 	if (ret <= 0) {
 		/* close connection and try to reconnect */
@@ -498,31 +538,394 @@ static int vtysh_client_execute_name(const char *name, const char *line)
 	return ret;
 }
 
+void vtysh_config_batch_start(void)
+{
+	vtysh_batch.active = true;
+	vtysh_batch.retcode = CMD_SUCCESS;
+}
+
+static void vtysh_config_batch_add(int lineno, int daemon, const char *line)
+{
+	struct vtysh_batch_line *bl;
+
+	if (vtysh_batch.count == vtysh_batch.size) {
+		vtysh_batch.size = vtysh_batch.size ? vtysh_batch.size * 2
+						    : 1024;
+		vtysh_batch.lines = XREALLOC(
+			MTYPE_VTYSH_BATCH, vtysh_batch.lines,
+			vtysh_batch.size * sizeof(*vtysh_batch.lines));
+	}
+
+	bl = &vtysh_batch.lines[vtysh_batch.count++];
+	bl->line = XSTRDUP(MTYPE_VTYSH_BATCH, line);
+	bl->lineno = lineno;
+	bl->daemon = daemon;
+	bl->hits = bl->misses = 0;
+}
+
+static int vtysh_batch_write(struct vtysh_client *vclient, const char *line)
+{
+	size_t len = strlen(line) + 1;
+
+	while (len) {
+		ssize_t nwrite = write(vclient->fd, line, len);
+
+		if (nwrite < 0 && (errno == EINTR || errno == EAGAIN))
+			continue;
+		if (nwrite <= 0)
+			return -1;
+		line += nwrite;
+		len -= nwrite;
+	}
+
+	return 0;
+}
+
+struct vtysh_batch_rx {
+	char buf[4096];
+	size_t len;
+};
+
+/*
+ * Read the answer to the oldest command in flight, printing its output.
+ *
+ * Returns:
+ *    the status code of the command, or -1 on I/O errors
+ */
+static int vtysh_batch_recv(struct vtysh_client *vclient,
+			    struct vtysh_batch_rx *rx)
+{
+	for (;;) {
+		char *end = memchr(rx->buf, '\0', rx->len);
+		ssize_t nread;
+
+		if (end) {
+			size_t textlen = end - rx->buf;
+
+			/* Output, followed by the 4-byte terminator. */
+			if (textlen && vty->of)
+				vty_out(vty, "%.*s", (int)textlen, rx->buf);
+			memmove(rx->buf, end, rx->len - textlen);
+			rx->len -= textlen;
+			if (rx->len >= 4) {
+				int ret = rx->buf[3];
+
+				rx->len -= 4;
+				memmove(rx->buf, rx->buf + 4, rx->len);
+				return ret;
+			}
+		} else if (rx->len) {
+			/* No terminator yet, just output. */
+			if (vty->of)
+				vty_out(vty, "%.*s", (int)rx->len, rx->buf);
+			rx->len = 0;
+		}
+
+		nread = vtysh_client_receive(vclient, rx->buf + rx->len,
+					     sizeof(rx->buf) - rx->len, NULL);
+		if (nread <= 0) {
+			if (vty->of)
+				vty_out(vty,
+					"vtysh: error reading from %s: %s (%d)",
+					vclient->name, safe_strerror(errno),
+					errno);
+			return -1;
+		}
+		rx->len += nread;
+	}
+}
+
+/* Stream the queued lines meant for one daemon instance. */
+static int vtysh_batch_stream(struct vtysh_client *vclient, int flag,
+			      struct vtysh_batch_line *lines, size_t count)
+{
+	struct vtysh_batch_rx rx = {};
+	size_t sent = 0, acked = 0, inflight = 0;
+	int retcode = CMD_SUCCESS;
+
+	for (;;) {
+		struct vtysh_batch_line *bl;
+		int ret;
+
+		/* Keep the pipeline full. */
+		for (; sent < count && inflight < VTYSH_BATCH_WINDOW; sent++) {
+			if (!(lines[sent].daemon & flag))
+				continue;
+			if (vtysh_batch_write(vclient, lines[sent].line) < 0)
+				goto out_err;
+			inflight++;
+		}
+		if (!inflight)
+			break;
+
+		/* Answers come back in order. */
+		while (!(lines[acked].daemon & flag))
+			acked++;
+		bl = &lines[acked++];
+		inflight--;
+
+		ret = vtysh_batch_recv(vclient, &rx);
+		if (ret < 0)
+			goto out_err;
+		if (ret == CMD_NOT_MY_INSTANCE) {
+			bl->misses++;
+			continue;
+		}
+		bl->hits++;
+
+		/* See vtysh_config_from_file() for why warnings are fine. */
+		if (ret != CMD_SUCCESS && ret != CMD_WARNING) {
+			fprintf(stderr,
+				"line %d: Failure to communicate[%d] to %s, line: %s\n",
+				bl->lineno, ret, vclient->name, bl->line);
+			retcode = ret;
+		}
+	}
+
+	return retcode;
+
+out_err:
+	fprintf(stderr,
+		"vtysh: lost connection to %s, its configuration was only partially applied\n",
+		vclient->name);
+	vclient_close(vclient);
+	return CMD_WARNING_CONFIG_FAILED;
+}
+
+/* Send all queued lines, one daemon after the other. */
+static void vtysh_batch_send(void)
+{
+	struct vtysh_batch_line *lines = vtysh_batch.lines;
+	size_t count = vtysh_batch.count;
+
+	if (!count)
+		return;
+
+	/* Anything sent from here on must not see these lines again. */
+	vtysh_batch.lines = NULL;
+	vtysh_batch.count = vtysh_batch.size = 0;
+
+	for (unsigned int i = 0; i < array_size(vtysh_client); i++) {
+		struct vtysh_client *head = &vtysh_client[i], *client;
+		int ret;
+
+		for (client = head; client; client = client->next) {
+			if (client->fd < 0)
+				continue;
+			ret = vtysh_batch_stream(client, head->flag, lines,
+						 count);
+			if (ret != CMD_SUCCESS)
+				vtysh_batch.retcode = ret;
+		}
+
+		for (size_t j = 0; j < count; j++) {
+			struct vtysh_batch_line *bl = &lines[j];
+
+			if (!(bl->daemon & head->flag))
+				continue;
+			if (bl->misses && !bl->hits) {
+				if (vty->of)
+					vty_out(vty,
+						"%% [%s]: command ignored as it targets an instance that is not running\n",
+						head->name);
+				fprintf(stderr,
+					"line %d: Failure to communicate[%d] to %s, line: %s\n",
+					bl->lineno, CMD_WARNING_CONFIG_FAILED,
+					head->name, bl->line);
+				vtysh_batch.retcode = CMD_WARNING_CONFIG_FAILED;
+			}
+			bl->hits = bl->misses = 0;
+		}
+	}
+
+	for (size_t j = 0; j < count; j++)
+		XFREE(MTYPE_VTYSH_BATCH, lines[j].line);
+	XFREE(MTYPE_VTYSH_BATCH, lines);
+}
+
+int vtysh_config_batch_flush(void)
+{
+	if (!vtysh_batch.active)
+		return CMD_SUCCESS;
+
+	vtysh_batch_send();
+	vtysh_batch.active = false;
+
+	return vtysh_batch.retcode;
+}
+
+/*
+ * Running configuration of one daemon instance, as received.  The request
+ * is sent to all daemons before any answer is read, so they build their
+ * configuration at the same time rather than one after the other; the
+ * answers are then parsed in the usual daemon order, the merged result
+ * does not depend on which daemon was fastest.
+ */
+struct vtysh_config_rx {
+	struct vtysh_client *vclient;
+	char *buf;
+	size_t len, size;
+	bool done;
+};
+
+static int vtysh_config_request(struct vtysh_client *vclient, const char *line)
+{
+	if (vclient->fd == VTYSH_WAS_ACTIVE && vtysh_reconnect(vclient) < 0)
+		return -1;
+	if (vclient->fd < 0)
+		return -1;
+
+	if (vtysh_batch_write(vclient, line) == 0)
+		return 0;
+
+	/* close connection and try to reconnect, as vtysh_client_run() */
+	vclient_close(vclient);
+	if (vtysh_reconnect(vclient) < 0)
+		return -1;
+	if (vtysh_batch_write(vclient, line) == 0)
+		return 0;
+
+	vclient_close(vclient);
+	return -1;
+}
+
+static void vtysh_config_rx_read(struct vtysh_config_rx *rx)
+{
+	char *end;
+	ssize_t nread;
+
+	if (rx->size - rx->len < 4096) {
+		rx->size = rx->size ? rx->size * 2 : 65536;
+		rx->buf = XREALLOC(MTYPE_VTYSH_CONFIG_RX, rx->buf, rx->size);
+	}
+
+	nread = vtysh_client_receive(rx->vclient, rx->buf + rx->len,
+				     rx->size - rx->len - 1, NULL);
+	if (nread < 0 && (errno == EINTR || errno == EAGAIN))
+		return;
+	if (nread <= 0) {
+		/* keep what was received, as the line by line parsing did */
+		vclient_close(rx->vclient);
+		rx->done = true;
+		return;
+	}
+
+	/* daemons send text, the first NUL starts the 4 byte terminator */
+	end = memchr(rx->buf + (rx->len > 3 ? rx->len - 3 : 0), '\0',
+		     rx->len + nread - (rx->len > 3 ? rx->len - 3 : 0));
+	rx->len += nread;
+	if (end && rx->buf + rx->len - end >= 4) {
+		rx->len = end - rx->buf;
+		rx->done = true;
+	}
+	rx->buf[rx->len] = '\0';
+}
+
+static void vtysh_config_rx_parse(struct vtysh_config_rx *rx)
+{
+	char *line = rx->buf, *textend = rx->buf + rx->len;
+
+	while (line < textend) {
+		char *eol = memchr(line, '\n', textend - line);
+
+		if (eol)
+			*eol++ = '\0';
+		else
+			eol = textend;
+		vtysh_config_parse_line(NULL, line);
+		line = eol;
+	}
+}
+
 /*
  * Retrieve all running config from daemons and parse it with the vtysh config
  * parser. Returned output is not displayed to the user.
  *
- * head_client
- *    where to start walking in the daemon list
+ * name
+ *    the daemon to retrieve the configuration of, NULL for all of them
  *
  * line
  *    the specific command to execute
  */
-static void vtysh_client_config(struct vtysh_client *head_client, char *line)
+static void vtysh_client_config(const char *name, const char *line)
 {
-	/* watchfrr currently doesn't load any config, and has some hardcoded
-	 * settings that show up in "show run".  skip it here (for now at
-	 * least) so we don't get that mangled up in config-write.
-	 */
-	if (head_client->flag == VTYSH_WATCHFRR)
-		return;
+	struct vtysh_config_rx *rxs;
+	struct pollfd *pfds;
+	size_t nrx = 0, max = 0, pending;
+	struct vtysh_client *client;
+
+	/* Don't overtake configuration lines that are still queued. */
+	vtysh_batch_send();
 
 	/* suppress output to user */
 	vty->of_saved = vty->of;
 	vty->of = NULL;
-	vtysh_client_run_all(head_client, line, 1, vtysh_config_parse_line,
-			     NULL);
+
+	for (unsigned int i = 0; i < array_size(vtysh_client); i++)
+		for (client = &vtysh_client[i]; client; client = client->next)
+			max++;
+	rxs = XCALLOC(MTYPE_VTYSH_CONFIG_RX, max * sizeof(*rxs));
+	pfds = XCALLOC(MTYPE_VTYSH_CONFIG_RX, max * sizeof(*pfds));
+
+	for (unsigned int i = 0; i < array_size(vtysh_client); i++) {
+		struct vtysh_client *head = &vtysh_client[i];
+
+		/* watchfrr currently doesn't load any config, and has some
+		 * hardcoded settings that show up in "show run".  skip it here
+		 * (for now at least) so we don't get that mangled up in
+		 * config-write.
+		 */
+		if (head->flag == VTYSH_WATCHFRR)
+			continue;
+		if (name && !strmatch(head->name, name))
+			continue;
+
+		for (client = head; client; client = client->next) {
+			if (vtysh_config_request(client, line) < 0)
+				continue;
+			rxs[nrx++].vclient = client;
+		}
+	}
+
+	for (pending = nrx; pending;) {
+		size_t npfds = 0;
+
+		for (size_t j = 0; j < nrx; j++) {
+			if (rxs[j].done)
+				continue;
+			pfds[npfds].fd = rxs[j].vclient->fd;
+			pfds[npfds].events = POLLIN;
+			pfds[npfds].revents = 0;
+			npfds++;
+		}
+
+		if (poll(pfds, npfds, -1) < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			break;
+		}
+
+		for (size_t j = 0, k = 0; j < nrx; j++) {
+			if (rxs[j].done)
+				continue;
+			if (pfds[k++].revents) {
+				vtysh_config_rx_read(&rxs[j]);
+				if (rxs[j].done)
+					pending--;
+			}
+		}
+	}
+
+	for (size_t j = 0; j < nrx; j++) {
+		if (rxs[j].buf)
+			vtysh_config_rx_parse(&rxs[j]);
+		XFREE(MTYPE_VTYSH_CONFIG_RX, rxs[j].buf);
+	}
+
 	vty->of = vty->of_saved;
+
+	XFREE(MTYPE_VTYSH_CONFIG_RX, pfds);
+	XFREE(MTYPE_VTYSH_CONFIG_RX, rxs);
 }
 
 /* Command execution over the vty interface. */
@@ -935,6 +1338,14 @@ int vtysh_config_from_file(struct vty *vty, FILE *fp)
 			unsigned int i;
 			int cmd_stat = CMD_SUCCESS;
 
+			if (vtysh_batch.active) {
+				vtysh_config_batch_add(lineno, cmd->daemon,
+						       vty->buf);
+				if (cmd->func)
+					(*cmd->func)(cmd, vty, 0, NULL);
+				break;
+			}
+
 			for (i = 0; i < array_size(vtysh_client); i++) {
 				if (cmd->daemon & vtysh_client[i].flag) {
 					cmd_stat = vtysh_client_execute(
@@ -2822,6 +3233,16 @@ DEFUN (vtysh_show_thread,
 	return show_per_daemon(vty, argv, argc, "Thread statistics for %s:\n");
 }
 
+DEFUN (vtysh_show_thread_latency,
+       vtysh_show_thread_latency_cmd,
+       "show thread latency",
+       SHOW_STR
+       "Thread information\n"
+       "Delay between tasks becoming ready and running\n")
+{
+	return show_per_daemon(vty, argv, argc, "Thread latency for %s:\n");
+}
+
 DEFUN (vtysh_show_work_queues,
        vtysh_show_work_queues_cmd,
        "show work-queues",
@@ -2972,6 +3393,7 @@ DEFUN (show_yang_operational_data,
 	   format <json|xml>\
 	   |translate WORD\
 	   |with-config\
+	   |stream\
 	 }] " DAEMONS_LIST,
        SHOW_STR
        "YANG information\n"
@@ -2983,6 +3405,7 @@ DEFUN (show_yang_operational_data,
        "Translate operational data\n"
        "YANG module translator\n"
        "Merge configuration data\n"
+       "Display each list entry as soon as it was fetched\n"
        DAEMONS_STR)
 {
 	return show_one_daemon(vty, argv, argc - 1, argv[argc - 1]->text);
@@ -3233,8 +3656,7 @@ DEFUN (vtysh_write_terminal,
        DAEMONS_STR
        "Skip \"Building configuration...\" header\n")
 {
-	unsigned int i;
-	char line[] = "do write terminal";
+	const char *line = "do write terminal";
 
 	if (!strcmp(argv[argc - 1]->arg, "no-header"))
 		argc--;
@@ -3244,10 +3666,7 @@ DEFUN (vtysh_write_terminal,
 		vty_out(vty, "!\n");
 	}
 
-	for (i = 0; i < array_size(vtysh_client); i++)
-		if ((argc < 3)
-		    || (strmatch(vtysh_client[i].name, argv[2]->text)))
-			vtysh_client_config(&vtysh_client[i], line);
+	vtysh_client_config(argc < 3 ? NULL : argv[2]->text, line);
 
 	/* Integrate vtysh specific configuration. */
 	vty_open_pager(vty);
@@ -3312,8 +3731,7 @@ static void backup_config_file(const char *fbackup)
 
 int vtysh_write_config_integrated(void)
 {
-	unsigned int i;
-	char line[] = "do write terminal";
+	const char *line = "do write terminal";
 	FILE *fp;
 	int fd;
 #ifdef FRR_USER
@@ -3339,8 +3757,7 @@ int vtysh_write_config_integrated(void)
 	}
 	fd = fileno(fp);
 
-	for (i = 0; i < array_size(vtysh_client); i++)
-		vtysh_client_config(&vtysh_client[i], line);
+	vtysh_client_config(NULL, line);
 
 	vtysh_config_write();
 	vty->of_saved = vty->of;
@@ -4957,6 +5374,7 @@ void vtysh_init_vty(void)
 	install_element(VIEW_NODE, &vtysh_show_work_queues_cmd);
 	install_element(VIEW_NODE, &vtysh_show_work_queues_daemon_cmd);
 	install_element(VIEW_NODE, &vtysh_show_thread_cmd);
+	install_element(VIEW_NODE, &vtysh_show_thread_latency_cmd);
 	install_element(VIEW_NODE, &vtysh_show_poll_cmd);
 	install_element(VIEW_NODE, &vtysh_show_thread_timer_cmd);
 
@@ -102,6 +102,13 @@ void vtysh_config_write(void);
 
 int vtysh_config_from_file(struct vty *, FILE *);
 
+/*
+ * Queue the daemon commands of configuration files until
+ * vtysh_config_batch_flush(), which streams them to each daemon.
+ */
+void vtysh_config_batch_start(void);
+int vtysh_config_batch_flush(void);
+
 void config_add_line(struct list *, const char *);
 
 int vtysh_mark_file(const char *filename);
@@ -619,14 +619,21 @@ static int vtysh_read_file(FILE *confp, bool dry_run)
 	vtysh_execute_no_pager("enable");
 	vtysh_execute_no_pager("configure terminal");
 
-	if (!dry_run)
+	if (!dry_run) {
 		vtysh_execute_no_pager("XFRR_start_configuration");
+		vtysh_config_batch_start();
+	}
 
 	/* Execute configuration file. */
 	ret = vtysh_config_from_file(vty, confp);
 
-	if (!dry_run)
+	if (!dry_run) {
+		int batch_ret = vtysh_config_batch_flush();
+
+		if (ret == CMD_SUCCESS)
+			ret = batch_ret;
 		vtysh_execute_no_pager("XFRR_end_configuration");
+	}
 
 	vtysh_execute_no_pager("end");
 	vtysh_execute_no_pager("disable");
@@ -30,6 +30,7 @@
 #include "zlog_targets.h"
 #include "network.h"
 #include "printfrr.h"
+#include "heartbeat.h"
 
 #include <getopt.h>
 #include <sys/un.h>
@@ -161,6 +162,13 @@ struct daemon {
 	enum daemon_state state;
 	int fd;
 	struct timeval echo_sent;
+	/* heartbeat socket, -1 to ping over the vty */
+	int hb_fd;
+	uint32_t hb_seq;
+	struct thread *t_hb_read;
+	/* last reported by the daemon */
+	uint32_t hb_task_time;
+	char hb_task[FRR_HEARTBEAT_TASKLEN];
 	unsigned int connect_tries;
 	struct thread *t_wakeup;
 	struct thread *t_read;
@@ -208,6 +216,8 @@ static const struct option longopts[] = {
 	{NULL, 0, NULL, 0}};
 
 static int try_connect(struct daemon *dmn);
+static void hb_connect(struct daemon *dmn);
+static void hb_close(struct daemon *dmn);
 static void wakeup_send_echo(struct thread *t_wakeup);
 static void try_restart(struct daemon *dmn);
 static void phase_check(void);
@@ -621,6 +631,7 @@ static void daemon_down(struct daemon *dmn, const char *why)
 		close(dmn->fd);
 		dmn->fd = -1;
 	}
+	hb_close(dmn);
 	THREAD_OFF(dmn->t_read);
 	THREAD_OFF(dmn->t_write);
 	THREAD_OFF(dmn->t_wakeup);
@@ -701,6 +712,77 @@ static void handle_read(struct thread *t_read)
 	SET_WAKEUP_ECHO(dmn);
 }
 
+static void handle_hb_read(struct thread *t_read)
+{
+	struct daemon *dmn = THREAD_ARG(t_read);
+	struct frr_heartbeat_resp resp;
+	struct timeval delay;
+	ssize_t rc;
+
+	dmn->t_hb_read = NULL;
+	rc = read(dmn->hb_fd, &resp, sizeof(resp));
+	if (rc < 0 && ERRNO_IO_RETRY(errno)) {
+		thread_add_read(master, handle_hb_read, dmn, dmn->hb_fd,
+				&dmn->t_hb_read);
+		return;
+	}
+	if (rc != sizeof(resp) || resp.magic != FRR_HEARTBEAT_MAGIC) {
+		/* if the daemon is gone, the vty connection will tell */
+		zlog_warn("%s: heartbeat connection failed, pinging over vty",
+			  dmn->name);
+		hb_close(dmn);
+		if (dmn->echo_sent.tv_sec) {
+			dmn->echo_sent.tv_sec = 0;
+			thread_cancel(&dmn->t_wakeup);
+			SET_WAKEUP_ECHO(dmn);
+		}
+		return;
+	}
+
+	thread_add_read(master, handle_hb_read, dmn, dmn->hb_fd,
+			&dmn->t_hb_read);
+
+	/* answer to a request that timed out */
+	if (!dmn->echo_sent.tv_sec || resp.seq != dmn->hb_seq)
+		return;
+
+	time_elapsed(&delay, &dmn->echo_sent);
+	dmn->echo_sent.tv_sec = 0;
+	resp.task[sizeof(resp.task) - 1] = '\0';
+	dmn->hb_task_time = resp.task_time;
+	strlcpy(dmn->hb_task, resp.task, sizeof(dmn->hb_task));
+
+	/* The daemon's own pthread answered, so the process is alive.  Its
+	 * main pthread is only considered hung if it has been in the same
+	 * task for longer than the timeout, a busy event loop is fine.
+	 */
+	if (resp.task_time >= gs.timeout * 1000) {
+		if (dmn->state != DAEMON_UNRESPONSIVE)
+			flog_err(EC_WATCHFRR_CONNECTION,
+				 "%s state -> unresponsive : stuck in %s for %u.%03u seconds",
+				 dmn->name, dmn->hb_task,
+				 resp.task_time / 1000, resp.task_time % 1000);
+		dmn->state = DAEMON_UNRESPONSIVE;
+		if (!dmn->ignore_timeout)
+			try_restart(dmn);
+	} else if (dmn->state == DAEMON_UNRESPONSIVE) {
+		dmn->state = DAEMON_UP;
+		zlog_warn(
+			"%s state -> up : heartbeat response received after %ld.%06ld seconds",
+			dmn->name, (long)delay.tv_sec, (long)delay.tv_usec);
+	} else if (resp.task_time >= gs.period)
+		zlog_info("%s: busy in %s for %u.%03u seconds", dmn->name,
+			  dmn->hb_task, resp.task_time / 1000,
+			  resp.task_time % 1000);
+	else if (gs.loglevel > LOG_DEBUG + 1)
+		zlog_debug(
+			"%s: heartbeat response received after %ld.%06ld seconds",
+			dmn->name, (long)delay.tv_sec, (long)delay.tv_usec);
+
+	thread_cancel(&dmn->t_wakeup);
+	SET_WAKEUP_ECHO(dmn);
+}
+
 /*
  * Wait till we notice that all daemons are ready before
  * we send we are ready to systemd
@@ -746,6 +828,7 @@ static void daemon_up(struct daemon *dmn, const char *why)
 	gs.numdown--;
 	dmn->connect_tries = 0;
 	zlog_notice("%s state -> up : %s", dmn->name, why);
+	hb_connect(dmn);
 	if (gs.numdown == 0) {
 		daemon_send_ready(0);
 
@@ -871,6 +954,59 @@ static int try_connect(struct daemon *dmn)
 	return 1;
 }
 
+/*
+ * Daemons answer on the heartbeat socket from a pthread of their own, with
+ * how long their main pthread has been in its current task.  The vty
+ * connection stays open to notice the daemon going away; without the
+ * heartbeat socket (older daemon) pings go over the vty.
+ */
+static void hb_connect(struct daemon *dmn)
+{
+	struct sockaddr_un addr;
+	socklen_t len;
+	int sock;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	snprintf(addr.sun_path, sizeof(addr.sun_path),
+		 "%s/%s" FRR_HEARTBEAT_SUFFIX, gs.vtydir, dmn->name);
+#ifdef HAVE_STRUCT_SOCKADDR_UN_SUN_LEN
+	len = addr.sun_len = SUN_LEN(&addr);
+#else
+	len = sizeof(addr.sun_family) + strlen(addr.sun_path);
+#endif /* HAVE_STRUCT_SOCKADDR_UN_SUN_LEN */
+
+	hb_close(dmn);
+
+	if ((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0)
+		return;
+
+	/* unix sockets connect right away or not at all */
+	if (set_nonblocking(sock) < 0 || set_cloexec(sock) < 0
+	    || connect(sock, (struct sockaddr *)&addr, len) < 0) {
+		if (gs.loglevel > LOG_DEBUG)
+			zlog_debug("%s: no heartbeat on %s, pinging over vty",
+				   dmn->name, addr.sun_path);
+		close(sock);
+		return;
+	}
+
+	dmn->hb_fd = sock;
+	thread_add_read(master, handle_hb_read, dmn, dmn->hb_fd,
+			&dmn->t_hb_read);
+}
+
+static void hb_close(struct daemon *dmn)
+{
+	THREAD_OFF(dmn->t_hb_read);
+	if (dmn->hb_fd >= 0) {
+		close(dmn->hb_fd);
+		dmn->hb_fd = -1;
+	}
+	dmn->hb_task_time = 0;
+	dmn->hb_task[0] = '\0';
+}
+
 static void phase_hanging(struct thread *t_hanging)
 {
 	gs.t_phase_hanging = NULL;
@@ -1034,6 +1170,23 @@ static void wakeup_send_echo(struct thread *t_wakeup)
 	struct daemon *dmn = THREAD_ARG(t_wakeup);
 
 	dmn->t_wakeup = NULL;
+	if (dmn->hb_fd >= 0) {
+		struct frr_heartbeat_req req = {
+			.magic = FRR_HEARTBEAT_MAGIC,
+			.seq = ++dmn->hb_seq,
+		};
+
+		if (write(dmn->hb_fd, &req, sizeof(req)) == sizeof(req)) {
+			gettimeofday(&dmn->echo_sent, NULL);
+			thread_add_timer(master, wakeup_no_answer, dmn,
+					 gs.timeout, &dmn->t_wakeup);
+			return;
+		}
+		zlog_warn("%s: heartbeat write failed, pinging over vty",
+			  dmn->name);
+		hb_close(dmn);
+	}
+
 	if (((rc = write(dmn->fd, echocmd, sizeof(echocmd))) < 0)
 	    || ((size_t)rc != sizeof(echocmd))) {
 		char why[100 + sizeof(echocmd)];
@@ -1079,6 +1232,9 @@ void watchfrr_status(struct vty *vty)
 	for (dmn = gs.daemons; dmn; dmn = dmn->next) {
 		vty_out(vty, "  %-20s %s%s", dmn->name, state_str[dmn->state],
 			dmn->ignore_timeout ? "/Ignoring Timeout\n" : "\n");
+		if (IS_UP(dmn) && dmn->hb_task_time)
+			vty_out(vty, "      busy in %s for %u ms\n",
+				dmn->hb_task, dmn->hb_task_time);
 		if (dmn->restart.pid)
 			vty_out(vty, "      restart running, pid %ld\n",
 				(long)dmn->restart.pid);
@@ -1305,6 +1461,7 @@ static void watchfrr_init(int argc, char **argv)
 		gs.numdaemons++;
 		gs.numdown++;
 		dmn->fd = -1;
+		dmn->hb_fd = -1;
 		thread_add_timer_msec(master, wakeup_init, dmn, 0,
 				      &dmn->t_wakeup);
 		dmn->restart.interval = gs.min_restart_interval;
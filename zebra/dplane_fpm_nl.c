@@ -27,6 +27,7 @@
 
 #include <sys/types.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 
 #include <errno.h>
 #include <string.h>
@@ -248,15 +249,45 @@ ask_reconnect:
 	return CMD_SUCCESS;
 }
 
+DEFUN(fpm_set_address_unix, fpm_set_address_unix_cmd,
+      "fpm address unix PATH",
+      FPM_STR
+      "FPM remote listening server address\n"
+      "Local FPM server on a unix stream socket\n"
+      "Path of the server's socket\n")
+{
+	struct sockaddr_un *sun;
+	const char *path = argv[3]->arg;
+
+	sun = (struct sockaddr_un *)&gfnc->addr;
+	if (strlen(path) >= sizeof(sun->sun_path)) {
+		vty_out(vty, "%% Socket path is too long: %s\n", path);
+		return CMD_WARNING;
+	}
+
+	memset(sun, 0, sizeof(*sun));
+	sun->sun_family = AF_UNIX;
+	strlcpy(sun->sun_path, path, sizeof(sun->sun_path));
+#ifdef HAVE_STRUCT_SOCKADDR_UN_SUN_LEN
+	sun->sun_len = SUN_LEN(sun);
+#endif /* HAVE_STRUCT_SOCKADDR_UN_SUN_LEN */
+
+	thread_add_event(gfnc->fthread->master, fpm_process_event, gfnc,
+			 FNE_RECONNECT, &gfnc->t_event);
+	return CMD_SUCCESS;
+}
+
 DEFUN(no_fpm_set_address, no_fpm_set_address_cmd,
-      "no fpm address [<A.B.C.D|X:X::X:X> [port <1-65535>]]",
+      "no fpm address [<A.B.C.D|X:X::X:X> [port <1-65535>]|unix PATH]",
       NO_STR
       FPM_STR
       "FPM remote listening server address\n"
       "Remote IPv4 FPM server\n"
       "Remote IPv6 FPM server\n"
       "FPM remote listening server port\n"
-      "Remote FPM server port\n")
+      "Remote FPM server port\n"
+      "Local FPM server on a unix stream socket\n"
+      "Path of the server's socket\n")
 {
 	thread_add_event(gfnc->fthread->master, fpm_process_event, gfnc,
 			 FNE_DISABLE, &gfnc->t_event);
@@ -374,6 +405,7 @@ static int fpm_write_config(struct vty *vty)
 {
 	struct sockaddr_in *sin;
 	struct sockaddr_in6 *sin6;
+	struct sockaddr_un *sun;
 	int written = 0;
 
 	if (gfnc->disabled)
@@ -398,6 +430,11 @@ static int fpm_write_config(struct vty *vty)
 
 		vty_out(vty, "\n");
 		break;
+	case AF_UNIX:
+		written = 1;
+		sun = (struct sockaddr_un *)&gfnc->addr;
+		vty_out(vty, "fpm address unix %s\n", sun->sun_path);
+		break;
 
 	default:
 		break;
@@ -728,6 +765,7 @@ static void fpm_connect(struct thread *t)
 	struct fpm_nl_ctx *fnc = THREAD_ARG(t);
 	struct sockaddr_in *sin = (struct sockaddr_in *)&fnc->addr;
 	struct sockaddr_in6 *sin6 = (struct sockaddr_in6 *)&fnc->addr;
+	struct sockaddr_un *sun = (struct sockaddr_un *)&fnc->addr;
 	socklen_t slen;
 	int rv, sock;
 	char addrstr[INET6_ADDRSTRLEN];
@@ -743,17 +781,27 @@ static void fpm_connect(struct thread *t)
 
 	set_nonblocking(sock);
 
-	if (fnc->addr.ss_family == AF_INET) {
-		inet_ntop(AF_INET, &sin->sin_addr, addrstr, sizeof(addrstr));
-		slen = sizeof(*sin);
+	if (fnc->addr.ss_family == AF_UNIX) {
+		slen = sizeof(*sun);
+
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug("%s: attempting to connect to unix:%s",
+				   __func__, sun->sun_path);
 	} else {
-		inet_ntop(AF_INET6, &sin6->sin6_addr, addrstr, sizeof(addrstr));
-		slen = sizeof(*sin6);
-	}
+		if (fnc->addr.ss_family == AF_INET) {
+			inet_ntop(AF_INET, &sin->sin_addr, addrstr,
+				  sizeof(addrstr));
+			slen = sizeof(*sin);
+		} else {
+			inet_ntop(AF_INET6, &sin6->sin6_addr, addrstr,
+				  sizeof(addrstr));
+			slen = sizeof(*sin6);
+		}
 
-	if (IS_ZEBRA_DEBUG_FPM)
-		zlog_debug("%s: attempting to connect to %s:%d", __func__,
-			   addrstr, ntohs(sin->sin_port));
+		if (IS_ZEBRA_DEBUG_FPM)
+			zlog_debug("%s: attempting to connect to %s:%d",
+				   __func__, addrstr, ntohs(sin->sin_port));
+	}
 
 	rv = connect(sock, (struct sockaddr *)&fnc->addr, slen);
 	if (rv == -1 && errno != EINPROGRESS) {
@@ -1612,6 +1660,7 @@ static int fpm_nl_new(struct thread_master *tm)
 	install_element(ENABLE_NODE, &fpm_show_counters_json_cmd);
 	install_element(ENABLE_NODE, &fpm_reset_counters_cmd);
 	install_element(CONFIG_NODE, &fpm_set_address_cmd);
+	install_element(CONFIG_NODE, &fpm_set_address_unix_cmd);
 	install_element(CONFIG_NODE, &no_fpm_set_address_cmd);
 	install_element(CONFIG_NODE, &fpm_use_nhg_cmd);
 	install_element(CONFIG_NODE, &no_fpm_use_nhg_cmd);
@@ -1153,6 +1153,104 @@ netlink_put_gre_set_msg(struct nl_batch *bth, struct zebra_dplane_ctx *ctx)
 	return ret;
 }
 
+/* One RTM_NEWSTATS message of a statistics dump */
+static int netlink_link_stats(struct nlmsghdr *h, ns_id_t ns_id, int startup)
+{
+	int len;
+	struct if_stats_msg *ifsm;
+	struct rtattr *tb[IFLA_STATS_MAX + 1];
+	const struct rtnl_link_stats64 *st;
+	struct interface *ifp;
+	struct zebra_if *zif;
+	struct zebra_if_stats *zst;
+
+	if (h->nlmsg_type != RTM_NEWSTATS)
+		return 0;
+
+	len = h->nlmsg_len - NLMSG_LENGTH(sizeof(struct if_stats_msg));
+	if (len < 0) {
+		zlog_err(
+			"%s: Message received from netlink is of a broken size: %d %zu",
+			__func__, h->nlmsg_len,
+			(size_t)NLMSG_LENGTH(sizeof(struct if_stats_msg)));
+		return -1;
+	}
+
+	ifsm = NLMSG_DATA(h);
+	ifp = if_lookup_by_index_per_ns(zebra_ns_lookup(ns_id),
+					ifsm->ifindex);
+	if (!ifp || !ifp->info)
+		return 0;
+
+	netlink_parse_rtattr(tb, IFLA_STATS_MAX,
+			     (struct rtattr *)((char *)ifsm
+					       + NLMSG_ALIGN(sizeof(*ifsm))),
+			     len);
+	if (!tb[IFLA_STATS_LINK_64]
+	    || RTA_PAYLOAD(tb[IFLA_STATS_LINK_64]) < sizeof(*st))
+		return 0;
+
+	st = RTA_DATA(tb[IFLA_STATS_LINK_64]);
+	zif = ifp->info;
+	zst = &zif->stats;
+
+	zst->rx_packets = st->rx_packets;
+	zst->tx_packets = st->tx_packets;
+	zst->rx_bytes = st->rx_bytes;
+	zst->tx_bytes = st->tx_bytes;
+	zst->rx_errors = st->rx_errors;
+	zst->tx_errors = st->tx_errors;
+	zst->rx_dropped = st->rx_dropped;
+	zst->tx_dropped = st->tx_dropped;
+	zst->rx_multicast = st->multicast;
+	zst->collisions = st->collisions;
+	zst->rx_length_errors = st->rx_length_errors;
+	zst->rx_over_errors = st->rx_over_errors;
+	zst->rx_crc_errors = st->rx_crc_errors;
+	zst->rx_frame_errors = st->rx_frame_errors;
+	zst->rx_fifo_errors = st->rx_fifo_errors;
+	zst->rx_missed_errors = st->rx_missed_errors;
+	zst->tx_aborted_errors = st->tx_aborted_errors;
+	zst->tx_carrier_errors = st->tx_carrier_errors;
+	zst->tx_fifo_errors = st->tx_fifo_errors;
+	zst->tx_heartbeat_errors = st->tx_heartbeat_errors;
+	zst->tx_window_errors = st->tx_window_errors;
+	zst->updated = monotime(NULL);
+
+	return 0;
+}
+
+/*
+ * The counters of every interface of the namespace in a single dump,
+ * rather than one request per interface.
+ */
+int interface_stats_netlink(struct zebra_ns *zns)
+{
+	struct {
+		struct nlmsghdr n;
+		struct if_stats_msg ifsm;
+	} req;
+	struct zebra_dplane_info dp_info;
+	struct nlsock *netlink_cmd = &zns->netlink_cmd;
+	int ret;
+
+	memset(&req, 0, sizeof(req));
+	req.n.nlmsg_type = RTM_GETSTATS;
+	req.n.nlmsg_flags = NLM_F_DUMP | NLM_F_REQUEST;
+	req.n.nlmsg_len = NLMSG_LENGTH(sizeof(struct if_stats_msg));
+	req.ifsm.family = AF_UNSPEC;
+	req.ifsm.filter_mask = IFLA_STATS_FILTER_BIT(IFLA_STATS_LINK_64);
+
+	zebra_dplane_info_from_zns(&dp_info, zns, true /*is_cmd*/);
+
+	ret = netlink_request(netlink_cmd, &req);
+	if (ret < 0)
+		return ret;
+
+	return netlink_parse_info(netlink_link_stats, netlink_cmd, &dp_info, 0,
+				  false);
+}
+
 /* Interface lookup by netlink socket. */
 int interface_lookup_netlink(struct zebra_ns *zns)
 {
@@ -39,6 +39,8 @@ int netlink_interface_addr_dplane(struct nlmsghdr *h, ns_id_t ns_id,
 
 extern int netlink_link_change(struct nlmsghdr *h, ns_id_t ns_id, int startup);
 extern int interface_lookup_netlink(struct zebra_ns *zns);
+/* refresh the statistics of all interfaces in the namespace */
+extern int interface_stats_netlink(struct zebra_ns *zns);
 
 extern ssize_t netlink_intf_msg_encode(uint16_t cmd,
 				       const struct zebra_dplane_ctx *ctx,
@@ -138,7 +138,9 @@ static void zebra_if_nhg_dependents_init(struct zebra_if *zebra_if)
 
 route_table_delegate_t zebra_if_table_delegate = {
 	.create_node = route_node_create,
-	.destroy_node = zebra_if_node_destroy};
+	.destroy_node = zebra_if_node_destroy,
+	/* per-interface subnet table, with a few entries each */
+	.nohash = true};
 
 /* Called when new interface is added. */
 static int if_zebra_new_hook(struct interface *ifp)
@@ -304,15 +306,20 @@ struct interface *if_lookup_by_index_per_ns(struct zebra_ns *ns,
 struct interface *if_lookup_by_name_per_ns(struct zebra_ns *ns,
 					   const char *ifname)
 {
-	struct route_node *rn;
+	struct vrf *vrf;
 	struct interface *ifp;
 
-	for (rn = route_top(ns->if_table); rn; rn = route_next(rn)) {
-		ifp = (struct interface *)rn->info;
-		if (ifp && strcmp(ifp->name, ifname) == 0) {
-			route_unlock_node(rn);
-			return (ifp);
-		}
+	/*
+	 * Every interface is in the name tree of its VRF, so look it up there
+	 * instead of walking all interfaces of the NS; this is called for each
+	 * link message.  The same name may exist in other namespaces, so only
+	 * accept interfaces linked into this NS.
+	 */
+	RB_FOREACH (vrf, vrf_id_head, &vrfs_by_id) {
+		ifp = if_lookup_by_name_vrf(ifname, vrf);
+		if (ifp && ifp->ifindex != IFINDEX_INTERNAL
+		    && if_lookup_by_index_per_ns(ns, ifp->ifindex) == ifp)
+			return ifp;
 	}
 
 	return NULL;
@@ -2222,6 +2229,44 @@ static void if_dump_vty(struct vty *vty, struct interface *ifp)
 	vty_out(vty, "    collisions %llu\n",
 		(unsigned long long)ifp->stats.ifi_collisions);
 #endif /* HAVE_NET_RT_IFLIST */
+
+#ifdef HAVE_NETLINK
+	if (zebra_if->stats.updated) {
+		const struct zebra_if_stats *st = &zebra_if->stats;
+
+		vty_out(vty, "  Statistics, %lld seconds old:\n",
+			(long long)(monotime(NULL) - st->updated));
+		vty_out(vty,
+			"    %" PRIu64 " input packets (%" PRIu64
+			" multicast), %" PRIu64 " bytes, %" PRIu64
+			" dropped\n",
+			st->rx_packets, st->rx_multicast, st->rx_bytes,
+			st->rx_dropped);
+		vty_out(vty,
+			"    %" PRIu64 " input errors, %" PRIu64
+			" length, %" PRIu64 " overrun, %" PRIu64
+			" CRC, %" PRIu64 " frame\n",
+			st->rx_errors, st->rx_length_errors,
+			st->rx_over_errors, st->rx_crc_errors,
+			st->rx_frame_errors);
+		vty_out(vty, "    %" PRIu64 " fifo, %" PRIu64 " missed\n",
+			st->rx_fifo_errors, st->rx_missed_errors);
+		vty_out(vty,
+			"    %" PRIu64 " output packets, %" PRIu64
+			" bytes, %" PRIu64 " dropped\n",
+			st->tx_packets, st->tx_bytes, st->tx_dropped);
+		vty_out(vty,
+			"    %" PRIu64 " output errors, %" PRIu64
+			" aborted, %" PRIu64 " carrier, %" PRIu64
+			" fifo, %" PRIu64 " heartbeat\n",
+			st->tx_errors, st->tx_aborted_errors,
+			st->tx_carrier_errors, st->tx_fifo_errors,
+			st->tx_heartbeat_errors);
+		vty_out(vty, "    %" PRIu64 " window, %" PRIu64
+			" collisions\n",
+			st->tx_window_errors, st->collisions);
+	}
+#endif /* HAVE_NETLINK */
 }
 
 static void if_dump_vty_json(struct vty *vty, struct interface *ifp,
@@ -2595,6 +2640,49 @@ static void if_dump_vty_json(struct vty *vty, struct interface *ifp,
 	json_object_int_add(json_if, "outputErrors", ifp->stats.ifi_oerrors);
 	json_object_int_add(json_if, "collisions", ifp->stats.ifi_collisions);
 #endif /* HAVE_NET_RT_IFLIST */
+
+#ifdef HAVE_NETLINK
+	if (zebra_if->stats.updated) {
+		const struct zebra_if_stats *st = &zebra_if->stats;
+
+		json_object_int_add(json_if, "statisticsAge",
+				    monotime(NULL) - st->updated);
+		json_object_int_add(json_if, "inputPackets", st->rx_packets);
+		json_object_int_add(json_if, "inputBytes", st->rx_bytes);
+		json_object_int_add(json_if, "inputDropped", st->rx_dropped);
+		json_object_int_add(json_if, "inputMulticastPackets",
+				    st->rx_multicast);
+		json_object_int_add(json_if, "inputErrors", st->rx_errors);
+		json_object_int_add(json_if, "inputLengthErrors",
+				    st->rx_length_errors);
+		json_object_int_add(json_if, "inputOverrunErrors",
+				    st->rx_over_errors);
+		json_object_int_add(json_if, "inputCrcErrors",
+				    st->rx_crc_errors);
+		json_object_int_add(json_if, "inputFrameErrors",
+				    st->rx_frame_errors);
+		json_object_int_add(json_if, "inputFifoErrors",
+				    st->rx_fifo_errors);
+		json_object_int_add(json_if, "inputMissedErrors",
+				    st->rx_missed_errors);
+		json_object_int_add(json_if, "outputPackets", st->tx_packets);
+		json_object_int_add(json_if, "outputBytes", st->tx_bytes);
+		json_object_int_add(json_if, "outputDroppedPackets",
+				    st->tx_dropped);
+		json_object_int_add(json_if, "outputErrors", st->tx_errors);
+		json_object_int_add(json_if, "outputAbortedErrors",
+				    st->tx_aborted_errors);
+		json_object_int_add(json_if, "outputCarrierErrors",
+				    st->tx_carrier_errors);
+		json_object_int_add(json_if, "outputFifoErrors",
+				    st->tx_fifo_errors);
+		json_object_int_add(json_if, "outputHeartbeatErrors",
+				    st->tx_heartbeat_errors);
+		json_object_int_add(json_if, "outputWindowErrors",
+				    st->tx_window_errors);
+		json_object_int_add(json_if, "collisions", st->collisions);
+	}
+#endif /* HAVE_NETLINK */
 }
 
 static void interface_update_stats(void)
@@ -2607,6 +2695,45 @@ static void interface_update_stats(void)
 #ifdef HAVE_NET_RT_IFLIST
 	ifstat_update_sysctl();
 #endif /* HAVE_NET_RT_IFLIST */
+	/* with netlink the shows use what the periodic refresh got */
+}
+
+#ifdef HAVE_NETLINK
+static struct thread *t_if_stats;
+
+static int zebra_ns_if_stats(struct ns *ns,
+			     void *param_in __attribute__((unused)),
+			     void **param_out __attribute__((unused)))
+{
+	struct zebra_ns *zns = ns->info;
+
+	if (zns)
+		interface_stats_netlink(zns);
+	return NS_WALK_CONTINUE;
+}
+
+static void zebra_if_stats_timer(struct thread *thread)
+{
+	ns_walk_func(zebra_ns_if_stats, NULL, NULL);
+	zebra_if_stats_timer_set();
+}
+#endif /* HAVE_NETLINK */
+
+void zebra_if_stats_timer_set(void)
+{
+#ifdef HAVE_NETLINK
+	THREAD_OFF(t_if_stats);
+	if (zrouter.ifstats_interval)
+		thread_add_timer(zrouter.master, zebra_if_stats_timer, NULL,
+				 zrouter.ifstats_interval, &t_if_stats);
+#endif /* HAVE_NETLINK */
+}
+
+void zebra_if_stats_stop(void)
+{
+#ifdef HAVE_NETLINK
+	THREAD_OFF(t_if_stats);
+#endif /* HAVE_NETLINK */
 }
 
 #include "zebra/interface_clippy.c"
@@ -4730,4 +4857,6 @@ void zebra_if_init(void)
 
 	/* setup EVPN MH elements */
 	zebra_evpn_interface_init();
+
+	zebra_if_stats_timer_set();
 }
@@ -112,6 +112,40 @@ enum zebra_if_flags {
 /* Mem type for zif desc */
 DECLARE_MTYPE(ZIF_DESC);
 
+#ifdef HAVE_NETLINK
+/* Interface counters, refreshed for all interfaces at once by a periodic
+ * statistics dump, readers never go to the kernel themselves
+ */
+struct zebra_if_stats {
+	uint64_t rx_packets;
+	uint64_t tx_packets;
+	uint64_t rx_bytes;
+	uint64_t tx_bytes;
+	uint64_t rx_errors;
+	uint64_t tx_errors;
+	uint64_t rx_dropped;
+	uint64_t tx_dropped;
+	uint64_t rx_multicast;
+	uint64_t collisions;
+
+	uint64_t rx_length_errors;
+	uint64_t rx_over_errors;
+	uint64_t rx_crc_errors;
+	uint64_t rx_frame_errors;
+	uint64_t rx_fifo_errors;
+	uint64_t rx_missed_errors;
+
+	uint64_t tx_aborted_errors;
+	uint64_t tx_carrier_errors;
+	uint64_t tx_fifo_errors;
+	uint64_t tx_heartbeat_errors;
+	uint64_t tx_window_errors;
+
+	/* monotonic time of the last refresh, 0 if there was none yet */
+	time_t updated;
+};
+#endif /* HAVE_NETLINK */
+
 /* `zebra' daemon local interface structure. */
 struct zebra_if {
 	/* back pointer to the interface */
@@ -225,6 +259,10 @@ struct zebra_if {
 
 	/* The description of the interface */
 	char *desc;
+
+#ifdef HAVE_NETLINK
+	struct zebra_if_stats stats;
+#endif /* HAVE_NETLINK */
 };
 
 DECLARE_HOOK(zebra_if_extra_info, (struct vty * vty, struct interface *ifp),
@@ -337,6 +375,9 @@ void zebra_if_dplane_result(struct zebra_dplane_ctx *ctx);
 #ifdef HAVE_PROC_NET_DEV
 extern void ifstat_update_proc(void);
 #endif /* HAVE_PROC_NET_DEV */
+/* (re)start the periodic statistics refresh, zrouter.ifstats_interval */
+extern void zebra_if_stats_timer_set(void);
+extern void zebra_if_stats_stop(void);
 #ifdef HAVE_NET_RT_IFLIST
 extern void ifstat_update_sysctl(void);
 
@@ -91,6 +91,15 @@
  */
 #define NL_DEFAULT_BATCH_SEND_THRESHOLD (15 * NL_PKT_BUF_SIZE)
 
+/*
+ * The kernel queues one error message for every failed request of a batch,
+ * and drops them if the socket's receive buffer overflows.  When that
+ * happens, the send threshold of later batches is halved (not going below
+ * the minimum), and then grown again by one packet buffer per full batch
+ * that went through cleanly, up to the configured threshold.
+ */
+#define NL_BATCH_SEND_THRESHOLD_MIN NL_PKT_BUF_SIZE
+
 static const struct message nlmsg_str[] = {{RTM_NEWROUTE, "RTM_NEWROUTE"},
 					   {RTM_DELROUTE, "RTM_DELROUTE"},
 					   {RTM_GETROUTE, "RTM_GETROUTE"},
@@ -191,6 +200,9 @@ char *nl_batch_tx_buf;
 _Atomic uint32_t nl_batch_bufsize = NL_DEFAULT_BATCH_BUFSIZE;
 _Atomic uint32_t nl_batch_send_threshold = NL_DEFAULT_BATCH_SEND_THRESHOLD;
 
+/* Effective send threshold, only used by the dplane pthread */
+static uint32_t nl_batch_adapt_threshold;
+
 struct nl_batch {
 	void *buf;
 	size_t bufsiz;
@@ -941,8 +953,11 @@ static ssize_t netlink_send_msg(const struct nlsock *nl, void *buf,
  * netlink_recv_msg - receive a netlink message.
  *
  * Returns -1 on error, 0 if read would block or the number of bytes received.
+ * A receive buffer overrun is fatal, unless nobufs_ok is set in which case
+ * -2 is returned.
  */
-static int netlink_recv_msg(struct nlsock *nl, struct msghdr *msg)
+static int netlink_recv_msg(struct nlsock *nl, struct msghdr *msg,
+			    bool nobufs_ok)
 {
 	struct iovec iov;
 	int status;
@@ -970,6 +985,8 @@ static int netlink_recv_msg(struct nlsock *nl, struct msghdr *msg)
 	if (status == -1) {
 		if (errno == EWOULDBLOCK || errno == EAGAIN)
 			return 0;
+		if (errno == ENOBUFS && nobufs_ok)
+			return -2;
 		flog_err(EC_ZEBRA_RECVMSG_OVERRUN, "%s recvmsg overrun: %s",
 			 nl->name, safe_strerror(errno));
 		/*
@@ -1122,7 +1139,7 @@ int netlink_parse_info(int (*filter)(struct nlmsghdr *, ns_id_t, int),
 		if (count && read_in >= count)
 			return 0;
 
-		status = netlink_recv_msg(nl, &msg);
+		status = netlink_recv_msg(nl, &msg, false);
 		if (status == -1)
 			return -1;
 		else if (status == 0)
@@ -1310,25 +1327,39 @@ static int nl_batch_read_resp(struct nl_batch *bth)
 	 * message at a time.
 	 */
 	while (true) {
-		status = netlink_recv_msg(nl, &msg);
+		status = netlink_recv_msg(nl, &msg, true);
 		/*
 		 * status == -1 is a full on failure somewhere
 		 * since we don't know where the problem happened
 		 * we must mark all as failed
 		 *
+		 * status == -2 means the kernel dropped some of the
+		 * error messages, so again the remaining ones can't
+		 * be told apart and are marked as failed.
+		 *
 		 * Else we mark everything as worked
 		 *
 		 */
-		if (status == -1 || status == 0) {
+		if (status == -2) {
+			flog_warn(EC_ZEBRA_RECVMSG_OVERRUN,
+				  "%s: %s receive buffer overrun, %zu messages in batch",
+				  __func__, nl->name, bth->msgcnt);
+			nl_batch_adapt_threshold =
+				MAX(nl_batch_adapt_threshold / 2,
+				    NL_BATCH_SEND_THRESHOLD_MIN);
+			bth->limit = nl_batch_adapt_threshold;
+		}
+
+		if (status <= 0) {
 			while ((ctx = dplane_ctx_dequeue(&(bth->ctx_list))) !=
 			       NULL) {
-				if (status == -1)
+				if (status < 0)
 					dplane_ctx_set_status(
 						ctx,
 						ZEBRA_DPLANE_REQUEST_FAILURE);
 				dplane_ctx_enqueue_tail(bth->ctx_out_q, ctx);
 			}
-			return status;
+			return status < 0 ? -1 : 0;
 		}
 
 		h = (struct nlmsghdr *)nl->buf;
@@ -1457,6 +1488,8 @@ static void nl_batch_init(struct nl_batch *bth, struct dplane_ctx_q *ctx_out_q)
 	 */
 	size_t bufsize =
 		atomic_load_explicit(&nl_batch_bufsize, memory_order_relaxed);
+	uint32_t threshold;
+
 	if (bufsize != nl_batch_tx_bufsize) {
 		if (nl_batch_tx_buf)
 			XFREE(MTYPE_NL_BUF, nl_batch_tx_buf);
@@ -1467,8 +1500,12 @@ static void nl_batch_init(struct nl_batch *bth, struct dplane_ctx_q *ctx_out_q)
 
 	bth->buf = nl_batch_tx_buf;
 	bth->bufsiz = bufsize;
-	bth->limit = atomic_load_explicit(&nl_batch_send_threshold,
-					  memory_order_relaxed);
+
+	threshold = atomic_load_explicit(&nl_batch_send_threshold,
+					 memory_order_relaxed);
+	if (!nl_batch_adapt_threshold || nl_batch_adapt_threshold > threshold)
+		nl_batch_adapt_threshold = threshold;
+	bth->limit = nl_batch_adapt_threshold;
 
 	bth->ctx_out_q = ctx_out_q;
 
@@ -1496,6 +1533,17 @@ static void nl_batch_send(struct nl_batch *bth)
 			if (nl_batch_read_resp(bth) == -1)
 				err = true;
 		}
+
+		/* A full batch went through, try a bigger one next time */
+		if (!err && bth->curlen > bth->limit) {
+			uint32_t threshold = atomic_load_explicit(
+				&nl_batch_send_threshold, memory_order_relaxed);
+
+			nl_batch_adapt_threshold =
+				MIN(nl_batch_adapt_threshold + NL_PKT_BUF_SIZE,
+				    threshold);
+			bth->limit = nl_batch_adapt_threshold;
+		}
 	}
 
 	/* Move remaining contexts to the outbound queue. */
@@ -59,6 +59,10 @@
 #include "zebra/zebra_srte.h"
 #include "zebra/zebra_srv6.h"
 #include "zebra/zebra_srv6_vty.h"
+#include "zebra/zebra_latency.h"
+#include "zebra/zebra_snapshot.h"
+#include "zebra/zebra_rib_export.h"
+#include "zebra/interface.h"
 
 #define ZEBRA_PTM_SUPPORT
 
@@ -85,6 +89,7 @@ uint32_t rcvbufsize = 128 * 1024;
 
 #define OPTION_V6_RR_SEMANTICS 2000
 #define OPTION_ASIC_OFFLOAD    2001
+#define OPTION_RIB_SNAPSHOT    2002
 
 /* Command line options. */
 const struct option longopts[] = {
@@ -95,6 +100,7 @@ const struct option longopts[] = {
 	{"retain", no_argument, NULL, 'r'},
 	{"graceful_restart", required_argument, NULL, 'K'},
 	{"asic-offload", optional_argument, NULL, OPTION_ASIC_OFFLOAD},
+	{"rib-snapshot", required_argument, NULL, OPTION_RIB_SNAPSHOT},
 #ifdef HAVE_NETLINK
 	{"vrfwnetns", no_argument, NULL, 'n'},
 	{"nl-bufsize", required_argument, NULL, 's'},
@@ -151,6 +157,10 @@ static void sigint(void)
 	atomic_store_explicit(&zrouter.in_shutdown, true,
 			      memory_order_relaxed);
 
+	/* keep the snapshot as it is, routes are about to go away */
+	zebra_snapshot_finish();
+	zebra_rib_export_finish();
+
 	/* send RA lifetime of 0 before stopping. rfc4861/6.2.5 */
 	rtadv_stop_ra_all();
 
@@ -189,6 +199,8 @@ static void sigint(void)
 	if (zrouter.lsp_process_q)
 		work_queue_free_and_null(&zrouter.lsp_process_q);
 
+	zebra_if_stats_stop();
+
 	vrf_terminate();
 
 	ns_walk_func(zebra_ns_early_shutdown, NULL, NULL);
@@ -292,6 +304,7 @@ int main(int argc, char **argv)
 	socklen_t dummylen;
 	bool asic_offload = false;
 	bool notify_on_ack = true;
+	const char *rib_snapshot = NULL;
 
 	graceful_restart = 0;
 	vrf_configure_backend(VRF_BACKEND_VRF_LITE);
@@ -312,6 +325,7 @@ int main(int argc, char **argv)
 		"  -r, --retain             When program terminates, retain added route by zebra.\n"
 		"  -K, --graceful_restart   Graceful restart at the kernel level, timer in seconds for expiration\n"
 		"  -A, --asic-offload       FRR is interacting with an asic underneath the linux kernel\n"
+		"      --rib-snapshot       Keep a RIB snapshot in this file for warm restarts\n"
 #ifdef HAVE_NETLINK
 		"  -s, --nl-bufsize         Set netlink receive buffer size\n"
 		"  -n, --vrfwnetns          Use NetNS as VRF backend\n"
@@ -366,6 +380,9 @@ int main(int argc, char **argv)
 		case 'K':
 			graceful_restart = atoi(optarg);
 			break;
+		case OPTION_RIB_SNAPSHOT:
+			rib_snapshot = optarg;
+			break;
 		case 's':
 			rcvbufsize = atoi(optarg);
 			if (rcvbufsize < RCVBUFSIZE_MIN)
@@ -424,6 +441,9 @@ int main(int argc, char **argv)
 	zebra_srte_init();
 	zebra_srv6_init();
 	zebra_srv6_vty_init();
+	zebra_route_latency_vty_init();
+	zebra_snapshot_vty_init();
+	zebra_rib_export_vty_init();
 
 	/* For debug purpose. */
 	/* SET_FLAG (zebra_debug_event, ZEBRA_DEBUG_EVENT); */
@@ -445,6 +465,9 @@ int main(int argc, char **argv)
 	*  will be equal to the current getpid(). To know about such routes,
 	* we have to have route_read() called before.
 	*/
+	if (rib_snapshot)
+		zebra_snapshot_init(rib_snapshot);
+
 	zrouter.startup_time = monotime(NULL);
 	thread_add_timer(zrouter.master, rib_sweep_route, NULL,
 			 graceful_restart, &zrouter.sweeper);
@@ -467,6 +490,9 @@ int main(int argc, char **argv)
 	/* RNH init */
 	zebra_rnh_init();
 
+	/* Initialize redistribution batching */
+	zebra_redistribute_init();
+
 	/* Config handler Init */
 	zebra_evpn_init();
 
@@ -31,6 +31,9 @@
 #include "log.h"
 #include "vrf.h"
 #include "srcdest_table.h"
+#include "jhash.h"
+#include "memory.h"
+#include "typesafe.h"
 
 #include "zebra/rib.h"
 #include "zebra/zebra_router.h"
@@ -46,6 +49,195 @@
 
 #define ZEBRA_PTM_SUPPORT
 
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_PENDING, "Redistribution pending message");
+DEFINE_MTYPE_STATIC(ZEBRA, REDIST_WALK, "Redistribution table walk");
+
+/*
+ * Redistribution messages are not handed to the clients one by one.  They
+ * collect here until the current task is done, or REDIST_BATCH_MAX are
+ * pending, and are then passed to each client in one batch.  A message
+ * for the same client, vrf, prefix and route type as a pending one
+ * replaces it, so a route flapping within that window costs one message.
+ */
+#define REDIST_BATCH_MAX 4096
+
+PREDECL_DLIST(redist_batch);
+PREDECL_HASH(redist_batch_hash);
+
+struct redist_pending {
+	struct redist_batch_item item;
+	struct redist_batch_hash_item hitem;
+
+	struct zserv *client;
+	vrf_id_t vrf_id;
+	uint8_t type;
+	unsigned short instance;
+	struct prefix p;
+	struct prefix src_p;
+
+	struct stream *msg;
+};
+
+static int redist_pending_cmp(const struct redist_pending *a,
+			      const struct redist_pending *b)
+{
+	int ret;
+
+	if (a->client != b->client)
+		return a->client < b->client ? -1 : 1;
+	if (a->vrf_id != b->vrf_id)
+		return a->vrf_id < b->vrf_id ? -1 : 1;
+	if (a->type != b->type)
+		return a->type < b->type ? -1 : 1;
+	if (a->instance != b->instance)
+		return a->instance < b->instance ? -1 : 1;
+	ret = prefix_cmp(&a->p, &b->p);
+	if (ret)
+		return ret;
+	return prefix_cmp(&a->src_p, &b->src_p);
+}
+
+static uint32_t redist_pending_hash(const struct redist_pending *rp)
+{
+	uint32_t key;
+
+	key = jhash_3words(rp->vrf_id, (rp->type << 16) | rp->instance,
+			   (uintptr_t)rp->client, prefix_hash_key(&rp->p));
+	if (rp->src_p.family)
+		key = jhash_1word(prefix_hash_key(&rp->src_p), key);
+	return key;
+}
+
+DECLARE_DLIST(redist_batch, struct redist_pending, item);
+DECLARE_HASH(redist_batch_hash, struct redist_pending, hitem,
+	     redist_pending_cmp, redist_pending_hash);
+
+static struct redist_batch_head redist_batch[1];
+static struct redist_batch_hash_head redist_batch_hash[1];
+static struct thread *t_redist_batch;
+
+/*
+ * Initial dumps of a table to a client that asked for redistribution are
+ * sent REDIST_WALK_CHUNK destinations at a time, so large tables do not
+ * block the main pthread.  Routes changing in the meantime are sent
+ * through redistribute_update()/redistribute_delete() as usual.
+ */
+#define REDIST_WALK_CHUNK 1000
+
+PREDECL_DLIST(redist_walks);
+
+struct redist_walk {
+	struct redist_walks_item item;
+
+	struct zserv *client;
+	int type;
+	unsigned short instance;
+	vrf_id_t vrf_id;
+	afi_t afi;
+
+	/* last destination completely sent, unset on the first run */
+	bool started;
+	struct prefix last;
+};
+
+DECLARE_DLIST(redist_walks, struct redist_walk, item);
+
+static struct redist_walks_head redist_walks[1];
+static struct thread *t_redist_walk;
+
+static void redist_pending_free(struct redist_pending *rp)
+{
+	redist_batch_del(redist_batch, rp);
+	redist_batch_hash_del(redist_batch_hash, rp);
+	XFREE(MTYPE_REDIST_PENDING, rp);
+}
+
+/* Hand all pending messages over to their clients */
+static void redist_batch_flush(void)
+{
+	struct stream_fifo fifo;
+	struct listnode *node;
+	struct redist_pending *rp;
+	struct zserv *client;
+
+	THREAD_OFF(t_redist_batch);
+
+	if (!redist_batch_count(redist_batch))
+		return;
+
+	stream_fifo_init(&fifo);
+	for (ALL_LIST_ELEMENTS_RO(zrouter.client_list, node, client)) {
+		frr_each_safe (redist_batch, redist_batch, rp) {
+			if (rp->client != client)
+				continue;
+			stream_fifo_push(&fifo, rp->msg);
+			redist_pending_free(rp);
+		}
+		if (fifo.count)
+			zserv_send_batch(client, &fifo);
+	}
+	stream_fifo_deinit(&fifo);
+
+	/* clients are purged on close, so this should be empty */
+	while ((rp = redist_batch_first(redist_batch))) {
+		stream_free(rp->msg);
+		redist_pending_free(rp);
+	}
+}
+
+static void redist_batch_flush_event(struct thread *thread)
+{
+	redist_batch_flush();
+}
+
+static void redist_batch_send(int cmd, struct zserv *client,
+			      const struct route_node *rn,
+			      const struct route_entry *re)
+{
+	struct redist_pending lookup, *rp;
+	const struct prefix *p, *src_p;
+	struct stream *msg;
+
+	msg = zapi_redistribute_route_encode(cmd, client, rn, re);
+	if (!msg)
+		return;
+
+	srcdest_rnode_prefixes(rn, &p, &src_p);
+
+	memset(&lookup, 0, sizeof(lookup));
+	lookup.client = client;
+	lookup.vrf_id = re->vrf_id;
+	lookup.type = re->type;
+	lookup.instance = re->instance;
+	prefix_copy(&lookup.p, p);
+	if (src_p)
+		prefix_copy(&lookup.src_p, src_p);
+
+	rp = redist_batch_hash_find(redist_batch_hash, &lookup);
+	if (rp) {
+		stream_free(rp->msg);
+		rp->msg = msg;
+		return;
+	}
+
+	rp = XCALLOC(MTYPE_REDIST_PENDING, sizeof(*rp));
+	rp->client = client;
+	rp->vrf_id = lookup.vrf_id;
+	rp->type = lookup.type;
+	rp->instance = lookup.instance;
+	prefix_copy(&rp->p, &lookup.p);
+	prefix_copy(&rp->src_p, &lookup.src_p);
+	rp->msg = msg;
+	redist_batch_add_tail(redist_batch, rp);
+	redist_batch_hash_add(redist_batch_hash, rp);
+
+	if (redist_batch_count(redist_batch) >= REDIST_BATCH_MAX)
+		redist_batch_flush();
+	else
+		thread_add_event(zrouter.master, redist_batch_flush_event, NULL,
+				 0, &t_redist_batch);
+}
+
 /* array holding redistribute info about table redistribution */
 /* bit AFI is set if that AFI is redistributing routes from this table */
 static int zebra_import_table_used[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
@@ -92,7 +284,7 @@ static void zebra_redistribute_default(struct zserv *client, vrf_id_t vrf_id)
 
 		RNODE_FOREACH_RE (rn, newre) {
 			if (CHECK_FLAG(newre->flags, ZEBRA_FLAG_SELECTED))
-				zsend_redistribute_route(
+				redist_batch_send(
 					ZEBRA_REDISTRIBUTE_ROUTE_ADD, client,
 					rn, newre);
 		}
@@ -101,20 +293,41 @@ static void zebra_redistribute_default(struct zserv *client, vrf_id_t vrf_id)
 	}
 }
 
-/* Redistribute routes. */
-static void zebra_redistribute(struct zserv *client, int type,
-			       unsigned short instance, vrf_id_t vrf_id,
-			       int afi)
+/*
+ * Send the next chunk of a table walk.  Returns false once the walk is
+ * done.
+ */
+static bool zebra_redistribute_walk(struct redist_walk *walk)
 {
+	struct zserv *client = walk->client;
+	int type = walk->type;
+	unsigned short instance = walk->instance;
+	vrf_id_t vrf_id = walk->vrf_id;
 	struct route_entry *newre;
 	struct route_table *table;
 	struct route_node *rn;
+	unsigned int count = 0;
 
-	table = zebra_vrf_table(afi, SAFI_UNICAST, vrf_id);
+	table = zebra_vrf_table(walk->afi, SAFI_UNICAST, vrf_id);
 	if (!table)
-		return;
+		return false;
+
+	if (walk->started)
+		rn = route_table_get_next(table, &walk->last);
+	else
+		rn = route_top(table);
+	walk->started = true;
+
+	for (; rn; rn = srcdest_route_next(rn)) {
+		/* only stop between destinations, not in a source table */
+		if (!rnode_is_srcnode(rn)) {
+			if (count++ >= REDIST_WALK_CHUNK) {
+				route_unlock_node(rn);
+				return true;
+			}
+			prefix_copy(&walk->last, &rn->p);
+		}
 
-	for (rn = route_top(table); rn; rn = srcdest_route_next(rn))
 		RNODE_FOREACH_RE (rn, newre) {
 			if (IS_ZEBRA_DEBUG_RIB)
 				zlog_debug(
@@ -137,9 +350,78 @@ static void zebra_redistribute(struct zserv *client, int type,
 			if (!zebra_check_addr(&rn->p))
 				continue;
 
-			zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD,
-						 client, rn, newre);
+			redist_batch_send(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client,
+					  rn, newre);
 		}
+	}
+
+	return false;
+}
+
+static void zebra_redistribute_walk_event(struct thread *thread)
+{
+	struct redist_walk *walk;
+
+	/* round-robin between walks, one chunk each */
+	walk = redist_walks_pop(redist_walks);
+	if (!walk)
+		return;
+
+	if (zebra_redistribute_walk(walk))
+		redist_walks_add_tail(redist_walks, walk);
+	else
+		XFREE(MTYPE_REDIST_WALK, walk);
+
+	if (redist_walks_count(redist_walks))
+		thread_add_event(zrouter.master, zebra_redistribute_walk_event,
+				 NULL, 0, &t_redist_walk);
+}
+
+/* Redistribute routes. */
+static void zebra_redistribute(struct zserv *client, int type,
+			       unsigned short instance, vrf_id_t vrf_id,
+			       int afi)
+{
+	struct redist_walk *walk;
+
+	walk = XCALLOC(MTYPE_REDIST_WALK, sizeof(*walk));
+	walk->client = client;
+	walk->type = type;
+	walk->instance = instance;
+	walk->vrf_id = vrf_id;
+	walk->afi = afi;
+
+	/* the first chunk goes out right away */
+	if (!zebra_redistribute_walk(walk)) {
+		XFREE(MTYPE_REDIST_WALK, walk);
+		return;
+	}
+
+	redist_walks_add_tail(redist_walks, walk);
+	thread_add_event(zrouter.master, zebra_redistribute_walk_event, NULL, 0,
+			 &t_redist_walk);
+}
+
+/* Stop table walks for client matching type/instance/vrf/afi, or all of
+ * them if type is ZEBRA_ROUTE_ALL.
+ */
+static void zebra_redistribute_walk_cancel(struct zserv *client, int type,
+					   unsigned short instance,
+					   vrf_id_t vrf_id, afi_t afi)
+{
+	struct redist_walk *walk;
+
+	frr_each_safe (redist_walks, redist_walks, walk) {
+		if (walk->client != client)
+			continue;
+		if (type != ZEBRA_ROUTE_ALL
+		    && (walk->type != type || walk->instance != instance
+			|| walk->vrf_id != vrf_id || walk->afi != afi))
+			continue;
+
+		redist_walks_del(redist_walks, walk);
+		XFREE(MTYPE_REDIST_WALK, walk);
+	}
 }
 
 /*
@@ -223,11 +505,11 @@ void redistribute_update(const struct route_node *rn,
 					re->vrf_id, re->table, re->type,
 					re->distance, re->metric);
 			}
-			zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_ADD,
-						 client, rn, re);
+			redist_batch_send(ZEBRA_REDISTRIBUTE_ROUTE_ADD, client,
+					  rn, re);
 		} else if (zebra_redistribute_check(rn, prev_re, client))
-			zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_DEL,
-						 client, rn, prev_re);
+			redist_batch_send(ZEBRA_REDISTRIBUTE_ROUTE_DEL, client,
+					  rn, prev_re);
 	}
 }
 
@@ -300,8 +582,8 @@ void redistribute_delete(const struct route_node *rn,
 
 		/* Send a delete for the 'old' re to any subscribed client. */
 		if (zebra_redistribute_check(rn, old_re, client))
-			zsend_redistribute_route(ZEBRA_REDISTRIBUTE_ROUTE_DEL,
-						 client, rn, old_re);
+			redist_batch_send(ZEBRA_REDISTRIBUTE_ROUTE_DEL, client,
+					  rn, old_re);
 	}
 }
 
@@ -396,7 +678,14 @@ void zebra_redistribute_delete(ZAPI_HANDLER_ARGS)
 	 * clients
 	 * themselves should keep track of the received routes from zebra and
 	 * withdraw them when necessary.
+	 *
+	 * Messages queued until now are still sent, as they would have been
+	 * without batching.
 	 */
+	redist_batch_flush();
+	zebra_redistribute_walk_cancel(client, type, instance, zvrf_id(zvrf),
+				       afi);
+
 	if (instance)
 		redist_del_instance(&client->mi_redist[afi][type], instance);
 	else
@@ -437,12 +726,38 @@ void zebra_redistribute_default_delete(ZAPI_HANDLER_ARGS)
 		return;
 	}
 
+	redist_batch_flush();
 	vrf_bitmap_unset(client->redist_default[afi], zvrf_id(zvrf));
 
 stream_failure:
 	return;
 }
 
+static int zebra_redistribute_client_close(struct zserv *client)
+{
+	struct redist_pending *rp;
+
+	frr_each_safe (redist_batch, redist_batch, rp) {
+		if (rp->client != client)
+			continue;
+		stream_free(rp->msg);
+		redist_pending_free(rp);
+	}
+	zebra_redistribute_walk_cancel(client, ZEBRA_ROUTE_ALL, 0, VRF_UNKNOWN,
+				       AFI_UNSPEC);
+
+	return 0;
+}
+
+void zebra_redistribute_init(void)
+{
+	redist_batch_init(redist_batch);
+	redist_batch_hash_init(redist_batch_hash);
+	redist_walks_init(redist_walks);
+
+	hook_register(zserv_client_close, zebra_redistribute_client_close);
+}
+
 /* Interface up information. */
 void zebra_interface_up_update(struct interface *ifp)
 {
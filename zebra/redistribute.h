@@ -33,6 +33,8 @@
 extern "C" {
 #endif
 
+extern void zebra_redistribute_init(void);
+
 /* ZAPI command handlers */
 extern void zebra_redistribute_add(ZAPI_HANDLER_ARGS);
 extern void zebra_redistribute_delete(ZAPI_HANDLER_ARGS);
@@ -85,12 +85,28 @@ struct rnh {
 #define ZEBRA_KERNEL_TABLE_MAX 252 /* support for no more than this rt tables */
 
 PREDECL_LIST(re_list);
+PREDECL_DLIST(rib_kernel_dests);
+PREDECL_DLIST(rib_export_dests);
 
 struct re_opaque {
 	uint16_t length;
 	uint8_t data[];
 };
 
+/* Nexthop groups from FIB, reflecting what is actually installed in the
+ * FIB if that differs. The 'backup' group is used when backup nexthops
+ * are present in the route's nhg.
+ */
+struct re_fib_nhg {
+	struct nexthop_group fib_ng;
+	struct nexthop_group fib_backup_ng;
+};
+
+/*
+ * Fields are ordered by size to avoid padding, this structure exists
+ * once per route and protocol.  Data only some routes need is kept out of
+ * line (fib, opaque).
+ */
 struct route_entry {
 	/* Link list. */
 	struct re_list_item next;
@@ -100,12 +116,16 @@ struct route_entry {
 	 */
 	struct nhg_hash_entry *nhe;
 
-	/* Nexthop group from FIB (optional), reflecting what is actually
-	 * installed in the FIB if that differs. The 'backup' group is used
-	 * when backup nexthops are present in the route's nhg.
-	 */
-	struct nexthop_group fib_ng;
-	struct nexthop_group fib_backup_ng;
+	/* FIB nexthop groups (optional), allocated on first use */
+	struct re_fib_nhg *fib;
+
+	struct re_opaque *opaque;
+
+	/* Uptime. */
+	time_t uptime;
+
+	/* zapi receipt, for install latency tracking; 0 if not tracked */
+	int64_t lat_zapi;
 
 	/* Nexthop group hash entry IDs. The "installed" id is the id
 	 * used in linux/netlink, if available.
@@ -116,12 +136,6 @@ struct route_entry {
 	/* Tag */
 	route_tag_t tag;
 
-	/* Uptime. */
-	time_t uptime;
-
-	/* Type of this route. */
-	int type;
-
 	/* VRF identifier. */
 	vrf_id_t vrf_id;
 
@@ -169,13 +183,17 @@ struct route_entry {
 	/* Sequence value incremented for each dataplane operation */
 	uint32_t dplane_sequence;
 
+	/* Record in the RIB snapshot, 0 if none */
+	uint32_t snap_slot;
+
 	/* Source protocol instance */
 	uint16_t instance;
 
+	/* Type of this route. */
+	uint8_t type;
+
 	/* Distance. */
 	uint8_t distance;
-
-	struct re_opaque *opaque;
 };
 
 #define RIB_SYSTEM_ROUTE(R) RSYSTEM_ROUTE((R)->type)
@@ -199,6 +217,14 @@ struct route_entry {
 struct meta_queue {
 	struct list *subq[MQ_SIZE];
 	uint32_t size; /* sum of lengths of all subqueues */
+
+	/* Last early route ahead of the BGP (and other) ones, see
+	 * rib_meta_queue_early_route_add()
+	 */
+	struct listnode *early_route_prio;
+
+	/* Highest length seen of each subqueue */
+	uint32_t max_len[MQ_SIZE];
 };
 
 /*
@@ -224,6 +250,19 @@ typedef struct rib_dest_t_ {
 	 */
 	uint32_t flags;
 
+	/*
+	 * Number of kernel routes for this prefix, and linkage on the
+	 * table's list of such destinations while nonzero.
+	 */
+	uint32_t kernel_routes;
+	struct rib_kernel_dests_item kernel_item;
+
+	/*
+	 * When rib_process() last dequeued this destination, if route
+	 * latency tracking is on.
+	 */
+	int64_t lat_dequeue;
+
 	/*
 	 * The list of nht prefixes that have ended up
 	 * depending on this route node.
@@ -238,10 +277,19 @@ typedef struct rib_dest_t_ {
 	 */
 	TAILQ_ENTRY(rib_dest_t_) fpm_q_entries;
 
+	/*
+	 * Record in the shared memory RIB export, and linkage on its update
+	 * queue (zebra_rib_export.c).
+	 */
+	uint32_t export_slot;
+	struct rib_export_dests_item export_item;
+
 } rib_dest_t;
 
 DECLARE_LIST(rnh_list, struct rnh, rnh_list_item);
 DECLARE_LIST(re_list, struct route_entry, next);
+DECLARE_DLIST(rib_kernel_dests, rib_dest_t, kernel_item);
+DECLARE_DLIST(rib_export_dests, rib_dest_t, export_item);
 
 #define RIB_ROUTE_QUEUED(x)	(1 << (x))
 // If MQ_SIZE is modified this value needs to be updated.
@@ -266,6 +314,12 @@ DECLARE_LIST(re_list, struct route_entry, next);
 
 #define RIB_DEST_UPDATE_LSPS   (1 << (ZEBRA_MAX_QINDEX + 3))
 
+/*
+ * Queued for, and present in the shared memory RIB export.
+ */
+#define RIB_DEST_UPDATE_EXPORT (1 << (ZEBRA_MAX_QINDEX + 4))
+#define RIB_DEST_EXPORTED      (1 << (ZEBRA_MAX_QINDEX + 5))
+
 /*
  * Macro to iterate over each route for a destination (prefix).
  */
@@ -312,6 +366,12 @@ struct rib_table_info {
 	afi_t afi;
 	safi_t safi;
 	uint32_t table_id;
+
+	/*
+	 * Destinations holding kernel routes.  Interface and address events
+	 * only need to re-evaluate these, see rib_update_table().
+	 */
+	struct rib_kernel_dests_head kernel_dests;
 };
 
 enum rib_tables_iter_state {
@@ -357,6 +417,11 @@ zebra_rib_route_entry_new(vrf_id_t vrf_id, int type, uint8_t instance,
 			  uint32_t metric, uint32_t mtu, uint8_t distance,
 			  route_tag_t tag);
 
+/* Get the FIB nexthop groups of re, allocating them if needed */
+extern struct re_fib_nhg *route_entry_fib_get(struct route_entry *re);
+/* Free the FIB nexthop groups of re, if any */
+extern void route_entry_fib_free(struct route_entry *re);
+
 #define ZEBRA_RIB_LOOKUP_ERROR -1
 #define ZEBRA_RIB_FOUND_EXACT 0
 #define ZEBRA_RIB_FOUND_NOGATE 1
@@ -439,6 +504,9 @@ extern int rib_queue_nhg_ctx_add(struct nhg_ctx *ctx);
 /* Enqueue incoming nhg from proto daemon for processing */
 extern int rib_queue_nhe_add(struct nhg_hash_entry *nhe);
 
+/* Enqueue nhg members from proto daemon to add to or remove from a group */
+extern int rib_queue_nhe_members(struct nhg_hash_entry *nhe, bool add);
+
 /* Enqueue evpn route for processing */
 int zebra_rib_queue_evpn_route_add(vrf_id_t vrf_id, const struct ethaddr *rmac,
 				   const struct ipaddr *vtep_ip,
@@ -470,6 +538,7 @@ int zebra_rib_queue_evpn_rem_vtep_del(vrf_id_t vrf_id, vni_t vni,
 				      struct in_addr vtep_ip);
 
 extern void meta_queue_free(struct meta_queue *mq, struct zebra_vrf *zvrf);
+extern void meta_queue_show(struct vty *vty, const struct meta_queue *mq);
 extern int zebra_rib_labeled_unicast(struct route_entry *re);
 extern struct route_table *rib_table_ipv6;
 
@@ -598,13 +667,15 @@ DECLARE_HOOK(rib_shutdown, (struct route_node * rn), (rn));
  * Access installed/fib nexthops, which may be a subset of the
  * rib nexthops.
  */
+extern struct nexthop_group rib_empty_nhg;
+
 static inline struct nexthop_group *rib_get_fib_nhg(struct route_entry *re)
 {
 	/* If the fib set is a subset of the active rib set,
 	 * use the dedicated fib list.
 	 */
 	if (CHECK_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG))
-		return &(re->fib_ng);
+		return re->fib ? &(re->fib->fib_ng) : &rib_empty_nhg;
 	else
 		return &(re->nhe->nhg);
 }
@@ -616,7 +687,7 @@ static inline struct nexthop_group *rib_get_fib_nhg(struct route_entry *re)
 static inline struct nexthop_group *rib_get_fib_backup_nhg(
 	struct route_entry *re)
 {
-	return &(re->fib_backup_ng);
+	return re->fib ? &(re->fib->fib_backup_ng) : &rib_empty_nhg;
 }
 
 extern void zebra_vty_init(void);
@@ -27,6 +27,11 @@
  * where 'frr' is a configured and built frr sandbox.
  *
  * Run zebra with '-M /path/to/sample_plugin.so' to load the module.
+ *
+ * Loading the module as '-M dplane_sample_plugin:null' turns it into a null
+ * dataplane: every update is acknowledged as successful without being
+ * programmed into the kernel. This is useful to measure zebra's own
+ * processing cost, e.g. when benchmarking route convergence.
  */
 
 #include "config.h" /* Include this explicitly */
@@ -39,6 +44,9 @@ static const char *plugin_name = "SAMPLE";
 
 static struct zebra_dplane_provider *prov_p;
 
+/* Skip kernel programming for all updates */
+static bool sample_null;
+
 /*
  * Startup/init callback, called from the dataplane.
  */
@@ -79,6 +87,8 @@ static int sample_process(struct zebra_dplane_provider *prov)
 
 		/* Just set 'success' status and return to the dataplane */
 		dplane_ctx_set_status(ctx, ZEBRA_DPLANE_REQUEST_SUCCESS);
+		if (sample_null)
+			dplane_ctx_set_skip_kernel(ctx);
 		dplane_provider_enqueue_out_ctx(prov_p, ctx);
 	}
 
@@ -121,6 +131,9 @@ static int init_sample_plugin(struct thread_master *tm)
  */
 static int module_init(void)
 {
+	if (THIS_MODULE->load_args && strmatch(THIS_MODULE->load_args, "null"))
+		sample_null = true;
+
 	hook_register(frr_late_init, init_sample_plugin);
 	return 0;
 }
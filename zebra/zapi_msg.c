@@ -62,8 +62,10 @@
 #include "zebra/zebra_opaque.h"
 #include "zebra/zebra_srte.h"
 #include "zebra/zebra_srv6.h"
+#include "zebra/zebra_latency.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, RE_OPAQUE, "Route Opaque Data");
+DEFINE_MTYPE_STATIC(ZEBRA, NOTIFY_BATCH, "Route notify batch");
 
 static int zapi_nhg_decode(struct stream *s, int cmd, struct zapi_nhg *api_nhg);
 
@@ -541,10 +543,15 @@ int zsend_interface_update(int cmd, struct zserv *client, struct interface *ifp)
 	return zserv_send_message(client, s);
 }
 
-int zsend_redistribute_route(int cmd, struct zserv *client,
-			     const struct route_node *rn,
-			     const struct route_entry *re)
+/*
+ * Encode a redistribution message for re.  The returned stream is only as
+ * large as the message, redistribution can queue many of them.
+ */
+struct stream *zapi_redistribute_route_encode(int cmd, struct zserv *client,
+					      const struct route_node *rn,
+					      const struct route_entry *re)
 {
+	static struct stream *scratch;
 	struct zapi_route api;
 	struct zapi_nexthop *api_nh;
 	struct nexthop *nexthop;
@@ -553,6 +560,7 @@ int zsend_redistribute_route(int cmd, struct zserv *client,
 	afi_t afi;
 	size_t stream_size =
 		MAX(ZEBRA_MAX_PACKET_SIZ, sizeof(struct zapi_route));
+	struct stream *s;
 
 	srcdest_rnode_prefixes(rn, &p, &src_p);
 	memset(&api, 0, sizeof(api));
@@ -634,13 +642,13 @@ int zsend_redistribute_route(int cmd, struct zserv *client,
 	SET_FLAG(api.message, ZAPI_MESSAGE_MTU);
 	api.mtu = re->mtu;
 
-	struct stream *s = stream_new(stream_size);
+	if (!scratch)
+		scratch = stream_new(stream_size);
+	stream_reset(scratch);
 
-	/* Encode route and send. */
-	if (zapi_route_encode(cmd, s, &api) < 0) {
-		stream_free(s);
-		return -1;
-	}
+	/* Encode route. */
+	if (zapi_route_encode(cmd, scratch, &api) < 0)
+		return NULL;
 
 	if (IS_ZEBRA_DEBUG_SEND)
 		zlog_debug("%s: %s to client %s: type %s, vrf_id %d, p %pFX",
@@ -648,7 +656,10 @@ int zsend_redistribute_route(int cmd, struct zserv *client,
 			   zebra_route_string(client->proto),
 			   zebra_route_string(api.type), api.vrf_id,
 			   &api.prefix);
-	return zserv_send_message(client, s);
+
+	s = stream_new(stream_get_endp(scratch));
+	stream_put(s, STREAM_DATA(scratch), stream_get_endp(scratch));
+	return s;
 }
 
 /*
@@ -746,6 +757,63 @@ int zsend_nhg_notify(uint16_t type, uint16_t instance, uint32_t session_id,
  * Common utility send route notification, called from a path using a
  * route_entry and from a path using a dataplane context.
  */
+/*
+ * While a list of dataplane results is processed, route owner
+ * notifications are collected per client and handed over in one go by
+ * zsend_route_notify_owner_flush().
+ */
+struct route_notify_batch {
+	struct zserv *client;
+	struct stream_fifo fifo;
+};
+
+static bool route_notify_batching;
+static struct list *route_notify_batches;
+
+void zsend_route_notify_owner_batch(void)
+{
+	if (!route_notify_batches)
+		route_notify_batches = list_new();
+
+	route_notify_batching = true;
+}
+
+void zsend_route_notify_owner_flush(void)
+{
+	struct route_notify_batch *batch;
+
+	route_notify_batching = false;
+
+	if (!route_notify_batches)
+		return;
+
+	while ((batch = listnode_head(route_notify_batches))) {
+		listnode_delete(route_notify_batches, batch);
+		zserv_send_batch(batch->client, &batch->fifo);
+		stream_fifo_deinit(&batch->fifo);
+		XFREE(MTYPE_NOTIFY_BATCH, batch);
+	}
+}
+
+static void route_notify_batch_add(struct zserv *client, struct stream *s)
+{
+	struct route_notify_batch *batch;
+	struct listnode *node;
+
+	for (ALL_LIST_ELEMENTS_RO(route_notify_batches, node, batch))
+		if (batch->client == client)
+			break;
+
+	if (!batch) {
+		batch = XCALLOC(MTYPE_NOTIFY_BATCH, sizeof(*batch));
+		batch->client = client;
+		stream_fifo_init(&batch->fifo);
+		listnode_add(route_notify_batches, batch);
+	}
+
+	stream_fifo_push(&batch->fifo, s);
+}
+
 static int route_notify_internal(const struct route_node *rn, int type,
 				 uint16_t instance, vrf_id_t vrf_id,
 				 uint32_t table_id,
@@ -796,6 +864,11 @@ static int route_notify_internal(const struct route_node *rn, int type,
 
 	stream_putw_at(s, 0, stream_get_endp(s));
 
+	if (route_notify_batching) {
+		route_notify_batch_add(client, s);
+		return 0;
+	}
+
 	return zserv_send_message(client, s);
 }
 
@@ -1959,6 +2032,7 @@ static void zread_nhg_del(ZAPI_HANDLER_ARGS)
 				 ZAPI_NHG_REMOVE_FAIL);
 }
 
+/* Also ZEBRA_NHG_MEMBER_ADD/DEL, which are encoded the same way */
 static void zread_nhg_add(ZAPI_HANDLER_ARGS)
 {
 	struct stream *s;
@@ -2017,7 +2091,11 @@ static void zread_nhg_add(ZAPI_HANDLER_ARGS)
 	 */
 
 	/* Enqueue to workqueue for processing */
-	rib_queue_nhe_add(nhe);
+	if (hdr->command == ZEBRA_NHG_ADD)
+		rib_queue_nhe_add(nhe);
+	else
+		rib_queue_nhe_members(nhe,
+				      hdr->command == ZEBRA_NHG_MEMBER_ADD);
 
 	/* Free any local allocations */
 	nexthop_group_delete(&nhg);
@@ -2025,163 +2103,194 @@ static void zread_nhg_add(ZAPI_HANDLER_ARGS)
 
 }
 
-static void zread_route_add(ZAPI_HANDLER_ARGS)
+/*
+ * Install the route in api for its own prefix and, for ZEBRA_ROUTE_ADD_BULK,
+ * for each of the further prefixes sharing its information.  The nexthops
+ * are only parsed once for all of them.
+ */
+static void zapi_route_add(struct zserv *client, struct zebra_vrf *zvrf,
+			   struct zapi_route *api,
+			   const struct prefix *prefixes, uint16_t count,
+			   int64_t rx_stamp)
 {
-	struct stream *s;
-	struct zapi_route api;
 	afi_t afi;
+	struct prefix pfx;
 	struct prefix_ipv6 *src_p = NULL;
 	struct route_entry *re;
 	struct nexthop_group *ng = NULL;
 	struct nhg_backup_info *bnhg = NULL;
 	int ret;
+	int i;
 	vrf_id_t vrf_id;
 	struct nhg_hash_entry nhe, *n = NULL;
 
-	s = msg;
-	if (zapi_route_decode(s, &api) < 0) {
-		if (IS_ZEBRA_DEBUG_RECV)
-			zlog_debug("%s: Unable to decode zapi_route sent",
-				   __func__);
-		return;
-	}
-
 	vrf_id = zvrf_id(zvrf);
 
-	if (IS_ZEBRA_DEBUG_RECV)
-		zlog_debug("%s: p=(%u:%u)%pFX, msg flags=0x%x, flags=0x%x",
-			   __func__, vrf_id, api.tableid, &api.prefix,
-			   (int)api.message, api.flags);
-
-	/* Allocate new route. */
-	re = zebra_rib_route_entry_new(
-		vrf_id, api.type, api.instance, api.flags, api.nhgid,
-		api.tableid ? api.tableid : zvrf->table_id, api.metric, api.mtu,
-		api.distance, api.tag);
-
-	if (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NHG)
-	    && (!CHECK_FLAG(api.message, ZAPI_MESSAGE_NEXTHOP)
-		|| api.nexthop_num == 0)) {
+	if (!CHECK_FLAG(api->message, ZAPI_MESSAGE_NHG)
+	    && (!CHECK_FLAG(api->message, ZAPI_MESSAGE_NEXTHOP)
+		|| api->nexthop_num == 0)) {
 		flog_warn(
 			EC_ZEBRA_RX_ROUTE_NO_NEXTHOPS,
 			"%s: received a route without nexthops for prefix %pFX from client %s",
-			__func__, &api.prefix,
+			__func__, &api->prefix,
 			zebra_route_string(client->proto));
-
-		XFREE(MTYPE_RE, re);
 		return;
 	}
 
 	/* Report misuse of the backup flag */
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_BACKUP_NEXTHOPS)
-	    && api.backup_nexthop_num == 0) {
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_BACKUP_NEXTHOPS)
+	    && api->backup_nexthop_num == 0) {
 		if (IS_ZEBRA_DEBUG_RECV || IS_ZEBRA_DEBUG_EVENT)
 			zlog_debug(
 				"%s: client %s: BACKUP flag set but no backup nexthops, prefix %pFX",
 				__func__, zebra_route_string(client->proto),
-				&api.prefix);
-	}
-
-	if (!re->nhe_id
-	    && (!zapi_read_nexthops(client, &api.prefix, api.nexthops,
-				    api.flags, api.message, api.nexthop_num,
-				    api.backup_nexthop_num, &ng, NULL)
-		|| !zapi_read_nexthops(client, &api.prefix, api.backup_nexthops,
-				       api.flags, api.message,
-				       api.backup_nexthop_num,
-				       api.backup_nexthop_num, NULL, &bnhg))) {
-
-		nexthop_group_delete(&ng);
-		zebra_nhg_backup_free(&bnhg);
-		XFREE(MTYPE_RE, re);
-		return;
-	}
-
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_OPAQUE)) {
-		re->opaque =
-			XMALLOC(MTYPE_RE_OPAQUE,
-				sizeof(struct re_opaque) + api.opaque.length);
-		re->opaque->length = api.opaque.length;
-		memcpy(re->opaque->data, api.opaque.data, re->opaque->length);
+				&api->prefix);
 	}
 
-	afi = family2afi(api.prefix.family);
-	if (afi != AFI_IP6 && CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX)) {
+	afi = family2afi(api->prefix.family);
+	if (afi != AFI_IP6 && CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX)) {
 		flog_warn(EC_ZEBRA_RX_SRCDEST_WRONG_AFI,
 			  "%s: Received SRC Prefix but afi is not v6",
 			  __func__);
-		nexthop_group_delete(&ng);
-		zebra_nhg_backup_free(&bnhg);
-		XFREE(MTYPE_RE_OPAQUE, re->opaque);
-		XFREE(MTYPE_RE, re);
 		return;
 	}
-	if (CHECK_FLAG(api.message, ZAPI_MESSAGE_SRCPFX))
-		src_p = &api.src_prefix;
+	if (CHECK_FLAG(api->message, ZAPI_MESSAGE_SRCPFX))
+		src_p = &api->src_prefix;
 
-	if (api.safi != SAFI_UNICAST && api.safi != SAFI_MULTICAST) {
+	if (api->safi != SAFI_UNICAST && api->safi != SAFI_MULTICAST) {
 		flog_warn(EC_LIB_ZAPI_MISSMATCH,
 			  "%s: Received safi: %d but we can only accept UNICAST or MULTICAST",
-			  __func__, api.safi);
+			  __func__, api->safi);
+		return;
+	}
+
+	if (!api->nhgid
+	    && (!zapi_read_nexthops(client, &api->prefix, api->nexthops,
+				    api->flags, api->message, api->nexthop_num,
+				    api->backup_nexthop_num, &ng, NULL)
+		|| !zapi_read_nexthops(client, &api->prefix,
+				       api->backup_nexthops, api->flags,
+				       api->message, api->backup_nexthop_num,
+				       api->backup_nexthop_num, NULL, &bnhg))) {
+
 		nexthop_group_delete(&ng);
 		zebra_nhg_backup_free(&bnhg);
-		XFREE(MTYPE_RE_OPAQUE, re->opaque);
-		XFREE(MTYPE_RE, re);
 		return;
 	}
 
-	/*
-	 * If we have an ID, this proto owns the NHG it sent along with the
-	 * route, so we just send the ID into rib code with it.
-	 *
-	 * Havent figured out how to handle backup NHs with this yet, so lets
-	 * keep that separate.
-	 * Include backup info with the route. We use a temporary nhe here;
-	 * if this is a new/unknown nhe, a new copy will be allocated
-	 * and stored.
-	 */
-	if (!re->nhe_id) {
-		zebra_nhe_init(&nhe, afi, ng->nexthop);
-		nhe.nhg.nexthop = ng->nexthop;
-		nhe.backup_info = bnhg;
-		n = zebra_nhe_copy(&nhe, 0);
-	}
-	ret = rib_add_multipath_nhe(afi, api.safi, &api.prefix, src_p, re, n,
-				    false);
+	for (i = -1; i < count; i++) {
+		pfx = i < 0 ? api->prefix : prefixes[i];
 
-	/*
-	 * rib_add_multipath_nhe only fails in a couple spots
-	 * and in those spots we have not freed memory
-	 */
-	if (ret == -1) {
-		client->error_cnt++;
-		XFREE(MTYPE_RE_OPAQUE, re->opaque);
-		XFREE(MTYPE_RE, re);
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: p=(%u:%u)%pFX, msg flags=0x%x, flags=0x%x",
+				   __func__, vrf_id, api->tableid, &pfx,
+				   (int)api->message, api->flags);
+
+		/* Allocate new route. */
+		re = zebra_rib_route_entry_new(
+			vrf_id, api->type, api->instance, api->flags,
+			api->nhgid, api->tableid ? api->tableid
+						 : zvrf->table_id,
+			api->metric, api->mtu, api->distance, api->tag);
+		re->lat_zapi = rx_stamp;
+
+		if (CHECK_FLAG(api->message, ZAPI_MESSAGE_OPAQUE)) {
+			re->opaque = XMALLOC(MTYPE_RE_OPAQUE,
+					     sizeof(struct re_opaque)
+						     + api->opaque.length);
+			re->opaque->length = api->opaque.length;
+			memcpy(re->opaque->data, api->opaque.data,
+			       re->opaque->length);
+		}
+
+		/*
+		 * If we have an ID, this proto owns the NHG it sent along
+		 * with the route, so we just send the ID into rib code with
+		 * it.
+		 *
+		 * Havent figured out how to handle backup NHs with this yet,
+		 * so lets keep that separate.
+		 * Include backup info with the route. We use a temporary nhe
+		 * here; if this is a new/unknown nhe, a new copy will be
+		 * allocated and stored.
+		 */
+		n = NULL;
+		if (!re->nhe_id) {
+			zebra_nhe_init(&nhe, afi, ng->nexthop);
+			nhe.nhg.nexthop = ng->nexthop;
+			nhe.backup_info = bnhg;
+			n = zebra_nhe_copy(&nhe, 0);
+		}
+		ret = rib_add_multipath_nhe(afi, api->safi, &pfx, src_p, re, n,
+					    false);
+
+		/*
+		 * rib_add_multipath_nhe only fails in a couple spots
+		 * and in those spots we have not freed memory
+		 */
+		if (ret == -1) {
+			client->error_cnt++;
+			XFREE(MTYPE_RE_OPAQUE, re->opaque);
+			XFREE(MTYPE_RE, re);
+		}
+
+		/* Stats */
+		switch (pfx.family) {
+		case AF_INET:
+			if (ret == 0)
+				client->v4_route_add_cnt++;
+			else if (ret == 1)
+				client->v4_route_upd8_cnt++;
+			break;
+		case AF_INET6:
+			if (ret == 0)
+				client->v6_route_add_cnt++;
+			else if (ret == 1)
+				client->v6_route_upd8_cnt++;
+			break;
+		}
 	}
 
-	/* At this point, these allocations are not needed: 're' has been
-	 * retained or freed, and if 're' still exists, it is using
+	/* At this point, these allocations are not needed: each 're' has
+	 * been retained or freed, and if it still exists, it is using
 	 * a reference to a shared group object.
 	 */
 	nexthop_group_delete(&ng);
 	if (bnhg)
 		zebra_nhg_backup_free(&bnhg);
+}
 
-	/* Stats */
-	switch (api.prefix.family) {
-	case AF_INET:
-		if (ret == 0)
-			client->v4_route_add_cnt++;
-		else if (ret == 1)
-			client->v4_route_upd8_cnt++;
-		break;
-	case AF_INET6:
-		if (ret == 0)
-			client->v6_route_add_cnt++;
-		else if (ret == 1)
-			client->v6_route_upd8_cnt++;
-		break;
+static void zread_route_add(ZAPI_HANDLER_ARGS)
+{
+	struct zapi_route api;
+	int64_t rx_stamp = zebra_route_latency_stamp();
+
+	if (zapi_route_decode(msg, &api) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route sent",
+				   __func__);
+		return;
 	}
+
+	zapi_route_add(client, zvrf, &api, NULL, 0, rx_stamp);
+}
+
+static void zread_route_add_bulk(ZAPI_HANDLER_ARGS)
+{
+	static struct prefix prefixes[ZAPI_ROUTE_BULK_MAX];
+	struct zapi_route api;
+	uint16_t count;
+	int64_t rx_stamp = zebra_route_latency_stamp();
+
+	if (zapi_route_decode(msg, &api) < 0
+	    || zapi_route_bulk_decode(msg, &api, prefixes, &count) < 0) {
+		if (IS_ZEBRA_DEBUG_RECV)
+			zlog_debug("%s: Unable to decode zapi_route sent",
+				   __func__);
+		return;
+	}
+
+	zapi_route_add(client, zvrf, &api, prefixes, count, rx_stamp);
 }
 
 void zapi_re_opaque_free(struct re_opaque *opaque)
@@ -2332,6 +2441,10 @@ static void zsend_capabilities(struct zserv *client, struct zebra_vrf *zvrf)
 	stream_putc(s, mpls_enabled);
 	stream_putl(s, zrouter.multipath_num);
 	stream_putc(s, zebra_mlag_get_role());
+	/* ZEBRA_ROUTE_ADD_BULK is accepted */
+	stream_putc(s, 1);
+	/* ZEBRA_NHG_MEMBER_ADD/DEL are accepted */
+	stream_putc(s, 1);
 
 	stream_putw_at(s, 0, stream_get_endp(s));
 	zserv_send_message(client, s);
@@ -3944,6 +4057,9 @@ void (*const zserv_handlers[])(ZAPI_HANDLER_ARGS) = {
 	[ZEBRA_TC_CLASS_DELETE] = zread_tc_class,
 	[ZEBRA_TC_FILTER_ADD] = zread_tc_filter,
 	[ZEBRA_TC_FILTER_DELETE] = zread_tc_filter,
+	[ZEBRA_ROUTE_ADD_BULK] = zread_route_add_bulk,
+	[ZEBRA_NHG_MEMBER_ADD] = zread_nhg_add,
+	[ZEBRA_NHG_MEMBER_DEL] = zread_nhg_add,
 };
 
 /*
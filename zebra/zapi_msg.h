@@ -64,9 +64,10 @@ extern void nbr_connected_delete_ipv6(struct interface *ifp,
 				      struct in6_addr *address);
 extern int zsend_interface_update(int cmd, struct zserv *client,
 				  struct interface *ifp);
-extern int zsend_redistribute_route(int cmd, struct zserv *zclient,
-				    const struct route_node *rn,
-				    const struct route_entry *re);
+extern struct stream *
+zapi_redistribute_route_encode(int cmd, struct zserv *zclient,
+			       const struct route_node *rn,
+			       const struct route_entry *re);
 
 extern int zsend_router_id_update(struct zserv *zclient, afi_t afi,
 				  struct prefix *p, vrf_id_t vrf_id);
@@ -81,6 +82,9 @@ extern int zsend_route_notify_owner(const struct route_node *rn,
 				    afi_t afi, safi_t safi);
 extern int zsend_route_notify_owner_ctx(const struct zebra_dplane_ctx *ctx,
 					enum zapi_route_notify_owner note);
+/* Collect route owner notifications until zsend_route_notify_owner_flush() */
+extern void zsend_route_notify_owner_batch(void);
+extern void zsend_route_notify_owner_flush(void);
 
 extern void zsend_rule_notify_owner(const struct zebra_dplane_ctx *ctx,
 				    enum zapi_rule_notify_owner note);
@@ -38,11 +38,13 @@
 #include "zebra/zebra_pbr.h"
 #include "zebra/zebra_neigh.h"
 #include "zebra/zebra_tc.h"
+#include "zebra/zebra_latency.h"
 #include "printfrr.h"
 
 /* Memory types */
-DEFINE_MTYPE_STATIC(ZEBRA, DP_CTX, "Zebra DPlane Ctx");
+DEFINE_MTYPE_POOL_STATIC(ZEBRA, DP_CTX, "Zebra DPlane Ctx");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_INTF, "Zebra DPlane Intf");
+DEFINE_MTYPE_STATIC(ZEBRA, DP_NH_GRP, "Zebra DPlane Nexthop Group");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_PROV, "Zebra DPlane Provider");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_NETFILTER, "Zebra Netfilter Internal Object");
 DEFINE_MTYPE_STATIC(ZEBRA, DP_NS, "DPlane NSes");
@@ -90,7 +92,11 @@ struct dplane_nexthop_info {
 	int type;
 
 	struct nexthop_group ng;
-	struct nh_grp nh_grp[MULTIPATH_NUM];
+
+	/* Members of a group, only allocated for nexthop group updates so
+	 * route contexts don't carry MULTIPATH_NUM entries along.
+	 */
+	struct nh_grp *nh_grp;
 	uint8_t nh_grp_count;
 };
 
@@ -153,6 +159,9 @@ struct dplane_route_info {
 
 	/* Optional list of extra interface info */
 	TAILQ_HEAD(dp_intf_extra_q, dplane_intf_extra) intf_extra_q;
+
+	/* Install latency timestamps, if tracked */
+	struct zebra_route_stamps zd_stamps;
 };
 
 /*
@@ -649,8 +658,8 @@ struct zebra_dplane_ctx *dplane_ctx_alloc(void)
 {
 	struct zebra_dplane_ctx *p;
 
-	/* TODO -- just alloc'ing memory, but would like to maintain
-	 * a pool
+	/* Reuses contexts returned with dplane_ctx_fini(), through the
+	 * DP_CTX pool
 	 */
 	p = XCALLOC(MTYPE_DP_CTX, sizeof(struct zebra_dplane_ctx));
 
@@ -731,6 +740,8 @@ static void dplane_ctx_free_internal(struct zebra_dplane_ctx *ctx)
 
 			ctx->u.rinfo.nhe.ng.nexthop = NULL;
 		}
+		XFREE(MTYPE_DP_NH_GRP, ctx->u.rinfo.nhe.nh_grp);
+		ctx->u.rinfo.nhe.nh_grp_count = 0;
 		break;
 	}
 
@@ -793,7 +804,7 @@ static void dplane_ctx_free_internal(struct zebra_dplane_ctx *ctx)
 		/* Maybe free label string, if allocated */
 		if (ctx->u.intf.label != NULL &&
 		    ctx->u.intf.label != ctx->u.intf.label_buf) {
-			XFREE(MTYPE_DP_CTX, ctx->u.intf.label);
+			XFREE(MTYPE_DP_INTF, ctx->u.intf.label);
 			ctx->u.intf.label = NULL;
 		}
 		break;
@@ -854,10 +865,6 @@ static void dplane_ctx_free(struct zebra_dplane_ctx **pctx)
 
 	DPLANE_CTX_VALID(*pctx);
 
-	/* TODO -- just freeing memory, but would like to maintain
-	 * a pool
-	 */
-
 	/* Some internal allocations may need to be freed, depending on
 	 * the type of info captured in the ctx.
 	 */
@@ -881,7 +888,7 @@ void dplane_ctx_reset(struct zebra_dplane_ctx *ctx)
  */
 void dplane_ctx_fini(struct zebra_dplane_ctx **pctx)
 {
-	/* TODO -- maintain pool; for now, just free */
+	/* The memory goes back to the DP_CTX pool */
 	dplane_ctx_free(pctx);
 }
 
@@ -1201,6 +1208,25 @@ const struct prefix *dplane_ctx_get_dest(const struct zebra_dplane_ctx *ctx)
 	return &(ctx->u.rinfo.zd_dest);
 }
 
+static bool dplane_ctx_route_tracked(const struct zebra_dplane_ctx *ctx)
+{
+	return (ctx->zd_op == DPLANE_OP_ROUTE_INSTALL ||
+		ctx->zd_op == DPLANE_OP_ROUTE_UPDATE) &&
+	       ctx->u.rinfo.zd_stamps.zapi;
+}
+
+/* Latency timestamps of a tracked route update, NULL otherwise */
+const struct zebra_route_stamps *
+dplane_ctx_get_route_stamps(const struct zebra_dplane_ctx *ctx)
+{
+	DPLANE_CTX_VALID(ctx);
+
+	if (!dplane_ctx_route_tracked(ctx))
+		return NULL;
+
+	return &(ctx->u.rinfo.zd_stamps);
+}
+
 void dplane_ctx_set_src(struct zebra_dplane_ctx *ctx, const struct prefix *src)
 {
 	DPLANE_CTX_VALID(ctx);
@@ -2169,7 +2195,7 @@ void dplane_ctx_set_intf_label(struct zebra_dplane_ctx *ctx, const char *label)
 	DPLANE_CTX_VALID(ctx);
 
 	if (ctx->u.intf.label && ctx->u.intf.label != ctx->u.intf.label_buf)
-		XFREE(MTYPE_DP_CTX, ctx->u.intf.label);
+		XFREE(MTYPE_DP_INTF, ctx->u.intf.label);
 
 	ctx->u.intf.label = NULL;
 
@@ -2184,7 +2210,7 @@ void dplane_ctx_set_intf_label(struct zebra_dplane_ctx *ctx, const char *label)
 				sizeof(ctx->u.intf.label_buf));
 			ctx->u.intf.label = ctx->u.intf.label_buf;
 		} else {
-			ctx->u.intf.label = XSTRDUP(MTYPE_DP_CTX, label);
+			ctx->u.intf.label = XSTRDUP(MTYPE_DP_INTF, label);
 		}
 	} else {
 		ctx->u.intf.flags &= ~DPLANE_INTF_HAS_LABEL;
@@ -2953,6 +2979,15 @@ int dplane_ctx_route_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 	re->dplane_sequence = zebra_router_get_next_sequence();
 	ctx->zd_seq = re->dplane_sequence;
 
+	/* Carry the latency timestamps of a route fresh from zapi */
+	if (re->lat_zapi && (op == DPLANE_OP_ROUTE_INSTALL ||
+			     op == DPLANE_OP_ROUTE_UPDATE)) {
+		ctx->u.rinfo.zd_stamps.zapi = re->lat_zapi;
+		ctx->u.rinfo.zd_stamps.dequeue =
+			rib_dest_from_rnode(rn)->lat_dequeue;
+		ctx->u.rinfo.zd_stamps.enqueue = zebra_route_latency_now();
+	}
+
 	return AOK;
 }
 
@@ -3080,9 +3115,19 @@ int dplane_ctx_nexthop_init(struct zebra_dplane_ctx *ctx, enum dplane_op_e op,
 
 	/* If this is a group, convert it to a grp array of ids */
 	if (!zebra_nhg_depends_is_empty(nhe)
-	    && !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_RECURSIVE))
-		ctx->u.rinfo.nhe.nh_grp_count = zebra_nhg_nhe2grp(
-			ctx->u.rinfo.nhe.nh_grp, nhe, MULTIPATH_NUM);
+	    && !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_RECURSIVE)) {
+		struct nh_grp grp[MULTIPATH_NUM];
+		uint8_t count;
+
+		count = zebra_nhg_nhe2grp(grp, nhe, MULTIPATH_NUM);
+		if (count) {
+			ctx->u.rinfo.nhe.nh_grp = XMALLOC(
+				MTYPE_DP_NH_GRP, count * sizeof(grp[0]));
+			memcpy(ctx->u.rinfo.nhe.nh_grp, grp,
+			       count * sizeof(grp[0]));
+		}
+		ctx->u.rinfo.nhe.nh_grp_count = count;
+	}
 
 	zvrf = vrf_info_lookup(nhe->vrf_id);
 
@@ -4537,7 +4582,7 @@ static enum zebra_dplane_result intf_addr_update_internal(
 				sizeof(ctx->u.intf.label_buf));
 			ctx->u.intf.label = ctx->u.intf.label_buf;
 		} else {
-			ctx->u.intf.label = XSTRDUP(MTYPE_DP_CTX, ifc->label);
+			ctx->u.intf.label = XSTRDUP(MTYPE_DP_INTF, ifc->label);
 		}
 	}
 
@@ -5506,6 +5551,31 @@ int dplane_show_helper(struct vty *vty, bool detailed)
 				    memory_order_relaxed);
 	vty_out(vty, "GRE set updates:       %"PRIu64"\n", incoming);
 	vty_out(vty, "GRE set errors:        %"PRIu64"\n", errs);
+
+	if (detailed) {
+		vty_out(vty, "Context size:             %zu bytes\n",
+			sizeof(struct zebra_dplane_ctx));
+		vty_out(vty, "  route info:             %zu\n",
+			sizeof(struct dplane_route_info));
+		vty_out(vty, "  LSP info:               %zu\n",
+			sizeof(struct zebra_lsp));
+		vty_out(vty, "  PW info:                %zu\n",
+			sizeof(struct dplane_pw_info));
+		vty_out(vty, "  interface info:         %zu\n",
+			sizeof(struct dplane_intf_info));
+		vty_out(vty, "  MAC info:               %zu\n",
+			sizeof(struct dplane_mac_info));
+		vty_out(vty, "  neighbor info:          %zu\n",
+			sizeof(struct dplane_neigh_info));
+		vty_out(vty, "  rule info:              %zu\n",
+			sizeof(struct dplane_rule_info));
+		vty_out(vty, "  TC filter info:         %zu\n",
+			sizeof(struct dplane_tc_filter_info));
+		vty_out(vty, "  IPset entry info:       %zu\n",
+			sizeof(struct zebra_pbr_ipset_entry)
+				+ sizeof(struct zebra_pbr_ipset_info));
+	}
+
 	return CMD_SUCCESS;
 }
 
@@ -6324,6 +6394,7 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 	struct zebra_dplane_ctx *ctx, *tctx;
 	struct dplane_ctx_q work_list;
 	int counter, limit;
+	int64_t now = 0;
 
 	TAILQ_INIT(&work_list);
 
@@ -6354,9 +6425,26 @@ static int kernel_dplane_process_func(struct zebra_dplane_provider *prov)
 			TAILQ_INSERT_TAIL(&work_list, ctx, zd_q_entries);
 	}
 
+	/*
+	 * The batch is sent and its results read in one go, so every
+	 * tracked route in it gets the same send and ack stamps.
+	 */
+	TAILQ_FOREACH (ctx, &work_list, zd_q_entries) {
+		if (dplane_ctx_route_tracked(ctx)) {
+			now = now ? now : zebra_route_latency_now();
+			ctx->u.rinfo.zd_stamps.send = now;
+		}
+	}
+
 	kernel_update_multi(&work_list);
 
+	if (now)
+		now = zebra_route_latency_now();
+
 	TAILQ_FOREACH_SAFE (ctx, &work_list, zd_q_entries, tctx) {
+		if (now && dplane_ctx_route_tracked(ctx))
+			ctx->u.rinfo.zd_stamps.ack = now;
+
 		kernel_dplane_handle_result(ctx);
 
 		TAILQ_REMOVE(&work_list, ctx, zd_q_entries);
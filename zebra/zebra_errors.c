@@ -800,6 +800,12 @@ static struct log_ref ferr_zebra_err[] = {
 		.suggestion =
 			"Wait for Zebra to reattempt update.",
 	},
+	{
+		.code = EC_ZEBRA_ROUTE_INSTALL_SLOW,
+		.title = "Route took too long to reach the dataplane",
+		.description = "With route latency tracking enabled, a route took longer than the configured outlier threshold from being received over zapi until its dataplane result was processed.",
+		.suggestion = "Check the per-stage times in the message and 'show zebra route latency' to find which stage is backed up.",
+	},
 	{
 		.code = END_FERR,
 	}
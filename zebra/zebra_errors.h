@@ -137,6 +137,7 @@ enum zebra_log_refs {
 	EC_ZEBRA_GRE_SET_UPDATE,
 	EC_ZEBRA_SRV6M_UNRELEASED_LOCATOR_CHUNK,
 	EC_ZEBRA_INTF_UPDATE_FAILURE,
+	EC_ZEBRA_ROUTE_INSTALL_SLOW,
 };
 
 void zebra_error_init(void);
@@ -389,7 +389,6 @@ static void zebra_evpn_dad_mac_auto_recovery_exp(struct thread *t)
 	struct zebra_vrf *zvrf = NULL;
 	struct zebra_mac *mac = NULL;
 	struct zebra_evpn *zevpn = NULL;
-	struct listnode *node = NULL;
 	struct zebra_neigh *nbr = NULL;
 
 	mac = THREAD_ARG(t);
@@ -411,15 +410,16 @@ static void zebra_evpn_dad_mac_auto_recovery_exp(struct thread *t)
 		char mac_buf[MAC_BUF_SIZE];
 
 		zlog_debug(
-			"%s: duplicate addr mac %pEA flags %slearn count %u host count %u auto recovery expired",
+			"%s: duplicate addr mac %pEA flags %slearn count %u host count %zu auto recovery expired",
 			__func__, &mac->macaddr,
 			zebra_evpn_zebra_mac_flag_dump(mac, mac_buf,
 						       sizeof(mac_buf)),
-			mac->dad_count, listcount(mac->neigh_list));
+			mac->dad_count,
+			zebra_mac_neigh_count(&mac->neigh_list));
 	}
 
 	/* Remove all IPs as duplicate associcated with this MAC */
-	for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, nbr)) {
+	frr_each (zebra_mac_neigh, &mac->neigh_list, nbr) {
 		if (CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_DUPLICATE)) {
 			if (CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_LOCAL))
 				ZEBRA_NEIGH_SET_INACTIVE(nbr);
@@ -467,7 +467,6 @@ static void zebra_evpn_dup_addr_detect_for_mac(struct zebra_vrf *zvrf,
 					       bool is_local)
 {
 	struct zebra_neigh *nbr;
-	struct listnode *node = NULL;
 	struct timeval elapsed = {0, 0};
 	bool reset_params = false;
 
@@ -564,7 +563,7 @@ static void zebra_evpn_dup_addr_detect_for_mac(struct zebra_vrf *zvrf,
 		/* Mark all IPs/Neighs as duplicate
 		 * associcated with this MAC
 		 */
-		for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, nbr)) {
+		frr_each (zebra_mac_neigh, &mac->neigh_list, nbr) {
 
 			/* Ony Mark IPs which are Local */
 			if (!CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_LOCAL))
@@ -615,7 +614,6 @@ void zebra_evpn_print_mac(struct zebra_mac *mac, void *ctxt, json_object *json)
 {
 	struct vty *vty;
 	struct zebra_neigh *n = NULL;
-	struct listnode *node = NULL;
 	char buf1[ETHER_ADDR_STRLEN];
 	char buf2[INET6_ADDRSTRLEN];
 	struct zebra_vrf *zvrf;
@@ -700,7 +698,7 @@ void zebra_evpn_print_mac(struct zebra_mac *mac, void *ctxt, json_object *json)
 			json_object_string_add(json_mac, "esi",
 					mac->es->esi_str);
 		/* print all the associated neigh */
-		if (!listcount(mac->neigh_list))
+		if (!zebra_mac_neigh_count(&mac->neigh_list))
 			json_object_string_add(json_mac, "neighbors", "none");
 		else {
 			json_object *json_active_nbrs = json_object_new_array();
@@ -708,7 +706,7 @@ void zebra_evpn_print_mac(struct zebra_mac *mac, void *ctxt, json_object *json)
 				json_object_new_array();
 			json_object *json_nbrs = json_object_new_object();
 
-			for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, n)) {
+			frr_each (zebra_mac_neigh, &mac->neigh_list, n) {
 				if (IS_ZEBRA_NEIGH_ACTIVE(n))
 					json_object_array_add(
 						json_active_nbrs,
@@ -811,10 +809,10 @@ void zebra_evpn_print_mac(struct zebra_mac *mac, void *ctxt, json_object *json)
 
 		/* print all the associated neigh */
 		vty_out(vty, " Neighbors:\n");
-		if (!listcount(mac->neigh_list))
+		if (!zebra_mac_neigh_count(&mac->neigh_list))
 			vty_out(vty, "    No Neighbors\n");
 		else {
-			for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, n)) {
+			frr_each (zebra_mac_neigh, &mac->neigh_list, n) {
 				vty_out(vty, "    %s %s\n",
 					ipaddr2str(&n->ip, buf2, sizeof(buf2)),
 					(IS_ZEBRA_NEIGH_ACTIVE(n)
@@ -1107,8 +1105,7 @@ struct zebra_mac *zebra_evpn_mac_add(struct zebra_evpn *zevpn,
 	mac->zevpn = zevpn;
 	mac->dad_mac_auto_recovery_timer = NULL;
 
-	mac->neigh_list = list_new();
-	mac->neigh_list->cmp = neigh_list_cmp;
+	zebra_mac_neigh_init(&mac->neigh_list);
 
 	mac->uptime = monotime(NULL);
 	if (IS_ZEBRA_DEBUG_VXLAN || IS_ZEBRA_DEBUG_EVPN_MH_MAC) {
@@ -1158,19 +1155,19 @@ int zebra_evpn_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 	 * Instead of deleting remote MAC, if its neigh list is non-empty
 	 * (associated to local neighs), mark the MAC as AUTO.
 	 */
-	if (!list_isempty(mac->neigh_list)) {
+	if (zebra_mac_neigh_count(&mac->neigh_list)) {
 		if (IS_ZEBRA_DEBUG_VXLAN)
 			zlog_debug(
 				"MAC %pEA (flags 0x%x vni %u) has non-empty neigh list "
-				"count %u, mark MAC as AUTO",
+				"count %zu, mark MAC as AUTO",
 				&mac->macaddr, mac->flags, zevpn->vni,
-				listcount(mac->neigh_list));
+				zebra_mac_neigh_count(&mac->neigh_list));
 
 		SET_FLAG(mac->flags, ZEBRA_MAC_AUTO);
 		return 0;
 	}
 
-	list_delete(&mac->neigh_list);
+	zebra_mac_neigh_fini(&mac->neigh_list);
 
 	/* Free the VNI hash entry and allocated memory. */
 	tmp_mac = hash_release(zevpn->mac_table, mac);
@@ -1211,7 +1208,7 @@ static bool zebra_evpn_check_mac_del_from_db(struct mac_walk_ctx *wctx,
 		 && IPV4_ADDR_SAME(&mac->fwd_info.r_vtep_ip, &wctx->r_vtep_ip))
 		return true;
 	else if ((wctx->flags & DEL_LOCAL_MAC) && (mac->flags & ZEBRA_MAC_AUTO)
-		 && !listcount(mac->neigh_list)) {
+		 && !zebra_mac_neigh_count(&mac->neigh_list)) {
 		if (IS_ZEBRA_DEBUG_VXLAN) {
 			char mac_buf[MAC_BUF_SIZE];
 
@@ -1956,7 +1953,7 @@ void zebra_evpn_rem_mac_del(struct zebra_evpn *zevpn, struct zebra_mac *mac)
 		UNSET_FLAG(mac->flags, ZEBRA_MAC_REMOTE);
 	}
 
-	if (list_isempty(mac->neigh_list))
+	if (!zebra_mac_neigh_count(&mac->neigh_list))
 		zebra_evpn_mac_del(zevpn, mac);
 	else
 		SET_FLAG(mac->flags, ZEBRA_MAC_AUTO);
@@ -2381,9 +2378,10 @@ int zebra_evpn_del_local_mac(struct zebra_evpn *zevpn, struct zebra_mac *mac,
 	bool new_bgp_ready;
 
 	if (IS_ZEBRA_DEBUG_VXLAN)
-		zlog_debug("DEL MAC %pEA VNI %u seq %u flags 0x%x nbr count %u",
-			   &mac->macaddr, zevpn->vni, mac->loc_seq, mac->flags,
-			   listcount(mac->neigh_list));
+		zlog_debug(
+			"DEL MAC %pEA VNI %u seq %u flags 0x%x nbr count %zu",
+			&mac->macaddr, zevpn->vni, mac->loc_seq, mac->flags,
+			zebra_mac_neigh_count(&mac->neigh_list));
 
 	old_bgp_ready = zebra_evpn_mac_is_ready_for_bgp(mac->flags);
 	if (!clear_static && zebra_evpn_mac_is_static(mac)) {
@@ -2439,7 +2437,7 @@ int zebra_evpn_del_local_mac(struct zebra_evpn *zevpn, struct zebra_mac *mac,
 	 * If there are no neigh associated with the mac delete the mac
 	 * else mark it as AUTO for forward reference
 	 */
-	if (!listcount(mac->neigh_list)) {
+	if (!zebra_mac_neigh_count(&mac->neigh_list)) {
 		zebra_evpn_mac_del(zevpn, mac);
 	} else {
 		UNSET_FLAG(mac->flags, ZEBRA_MAC_ALL_LOCAL_FLAGS);
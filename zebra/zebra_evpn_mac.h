@@ -39,6 +39,10 @@ struct host_rb_entry {
 RB_HEAD(host_rb_tree_entry, host_rb_entry);
 RB_PROTOTYPE(host_rb_tree_entry, host_rb_entry, hl_entry,
 	     host_rb_entry_compare);
+
+/* Neighbors using a MAC, sorted by IP; see zebra_evpn_neigh.h */
+PREDECL_SORTLIST_UNIQ(zebra_mac_neigh);
+
 /*
  * MAC hash table.
  *
@@ -122,7 +126,7 @@ struct zebra_mac {
 	uint32_t loc_seq;
 
 	/* List of neigh associated with this mac */
-	struct list *neigh_list;
+	struct zebra_mac_neigh_head neigh_list;
 
 	/* List of nexthop associated with this RMAC */
 	struct list *nh_list;
@@ -203,12 +207,6 @@ static inline void zebra_evpn_mac_clear_sync_info(struct zebra_mac *mac)
 	zebra_evpn_mac_stop_hold_timer(mac);
 }
 
-static inline bool zebra_evpn_mac_in_use(struct zebra_mac *mac)
-{
-	return !list_isempty(mac->neigh_list)
-	       || CHECK_FLAG(mac->flags, ZEBRA_MAC_SVI);
-}
-
 struct hash *zebra_mac_db_create(const char *desc);
 uint32_t num_valid_macs(struct zebra_evpn *zevi);
 uint32_t num_dup_detected_macs(struct zebra_evpn *zevi);
@@ -38,8 +38,8 @@
 #include "zebra/zebra_vrf.h"
 #include "zebra/zebra_evpn.h"
 #include "zebra/zebra_evpn_mh.h"
-#include "zebra/zebra_evpn_neigh.h"
 #include "zebra/zebra_evpn_mac.h"
+#include "zebra/zebra_evpn_neigh.h"
 
 DEFINE_MTYPE_STATIC(ZEBRA, NEIGH, "EVI Neighbor");
 
@@ -75,14 +75,6 @@ static bool neigh_cmp(const void *p1, const void *p2)
 	return ipaddr_cmp(&n1->ip, &n2->ip) == 0;
 }
 
-int neigh_list_cmp(void *p1, void *p2)
-{
-	const struct zebra_neigh *n1 = p1;
-	const struct zebra_neigh *n2 = p2;
-
-	return ipaddr_cmp(&n1->ip, &n2->ip);
-}
-
 struct hash *zebra_neigh_db_create(const char *desc)
 {
 	return hash_create_size(8, neigh_hash_keymake, neigh_cmp, desc);
@@ -136,10 +128,9 @@ void zebra_evpn_find_neigh_addr_width(struct hash_bucket *bucket, void *ctxt)
 int remote_neigh_count(struct zebra_mac *zmac)
 {
 	struct zebra_neigh *n = NULL;
-	struct listnode *node = NULL;
 	int count = 0;
 
-	for (ALL_LIST_ELEMENTS_RO(zmac->neigh_list, node, n)) {
+	frr_each (zebra_mac_neigh, &zmac->neigh_list, n) {
 		if (CHECK_FLAG(n->flags, ZEBRA_NEIGH_REMOTE))
 			count++;
 	}
@@ -218,7 +209,7 @@ static void zebra_evpn_local_neigh_ref_mac(struct zebra_neigh *n,
 	if (!mac)
 		return;
 
-	listnode_add_sort(mac->neigh_list, n);
+	zebra_mac_neigh_add(&mac->neigh_list, n);
 	if (n->flags & ZEBRA_NEIGH_ALL_PEER_FLAGS) {
 		old_static = zebra_evpn_mac_is_static(mac);
 		++mac->sync_neigh_cnt;
@@ -490,7 +481,7 @@ static void zebra_evpn_local_neigh_deref_mac(struct zebra_neigh *n,
 				false /* force_clear_static */, __func__);
 	}
 
-	listnode_delete(mac->neigh_list, n);
+	zebra_mac_neigh_del(&mac->neigh_list, n);
 	zebra_evpn_deref_ip2mac(zevpn, mac);
 }
 
@@ -587,7 +578,7 @@ int zebra_evpn_neigh_del(struct zebra_evpn *zevpn, struct zebra_neigh *n)
 	struct zebra_neigh *tmp_n;
 
 	if (n->mac)
-		listnode_delete(n->mac->neigh_list, n);
+		zebra_mac_neigh_del(&n->mac->neigh_list, n);
 
 	/* Cancel auto recovery */
 	THREAD_OFF(n->dad_ip_auto_recovery_timer);
@@ -922,7 +913,6 @@ void zebra_evpn_process_neigh_on_local_mac_change(struct zebra_evpn *zevpn,
 						  bool es_change)
 {
 	struct zebra_neigh *n = NULL;
-	struct listnode *node = NULL;
 	struct zebra_vrf *zvrf = NULL;
 
 	zvrf = zevpn->vxlan_if->vrf->info;
@@ -938,7 +928,7 @@ void zebra_evpn_process_neigh_on_local_mac_change(struct zebra_evpn *zevpn,
 	 * NOTE: We can't simply uninstall remote neighbors as the kernel may
 	 * accidentally end up deleting a just-learnt local neighbor.
 	 */
-	for (ALL_LIST_ELEMENTS_RO(zmac->neigh_list, node, n)) {
+	frr_each (zebra_mac_neigh, &zmac->neigh_list, n) {
 		if (CHECK_FLAG(n->flags, ZEBRA_NEIGH_LOCAL)) {
 			if (IS_ZEBRA_NEIGH_INACTIVE(n) || seq_change
 			    || es_change) {
@@ -964,7 +954,6 @@ void zebra_evpn_process_neigh_on_local_mac_del(struct zebra_evpn *zevpn,
 					       struct zebra_mac *zmac)
 {
 	struct zebra_neigh *n = NULL;
-	struct listnode *node = NULL;
 
 	if (IS_ZEBRA_DEBUG_VXLAN)
 		zlog_debug("Processing neighbors on local MAC %pEA DEL, VNI %u",
@@ -976,7 +965,7 @@ void zebra_evpn_process_neigh_on_local_mac_del(struct zebra_evpn *zevpn,
 	 * don't expect them to exist, if they do, do we install the MAC
 	 * as a remote MAC and the neighbor as remote?
 	 */
-	for (ALL_LIST_ELEMENTS_RO(zmac->neigh_list, node, n)) {
+	frr_each (zebra_mac_neigh, &zmac->neigh_list, n) {
 		if (CHECK_FLAG(n->flags, ZEBRA_NEIGH_LOCAL)) {
 			if (IS_ZEBRA_NEIGH_ACTIVE(n)) {
 				ZEBRA_NEIGH_SET_INACTIVE(n);
@@ -997,7 +986,6 @@ void zebra_evpn_process_neigh_on_remote_mac_add(struct zebra_evpn *zevpn,
 						struct zebra_mac *zmac)
 {
 	struct zebra_neigh *n = NULL;
-	struct listnode *node = NULL;
 
 	if (IS_ZEBRA_DEBUG_VXLAN)
 		zlog_debug("Processing neighbors on remote MAC %pEA ADD, VNI %u",
@@ -1006,7 +994,7 @@ void zebra_evpn_process_neigh_on_remote_mac_add(struct zebra_evpn *zevpn,
 	/* Walk all local neighbors and mark as inactive and inform
 	 * BGP, if needed.
 	 */
-	for (ALL_LIST_ELEMENTS_RO(zmac->neigh_list, node, n)) {
+	frr_each (zebra_mac_neigh, &zmac->neigh_list, n) {
 		if (CHECK_FLAG(n->flags, ZEBRA_NEIGH_LOCAL)) {
 			if (IS_ZEBRA_NEIGH_ACTIVE(n)) {
 				ZEBRA_NEIGH_SET_INACTIVE(n);
@@ -2100,12 +2088,13 @@ void zebra_evpn_neigh_remote_macip_add(struct zebra_evpn *zevpn,
 				old_mac =
 					zebra_evpn_mac_lookup(zevpn, &n->emac);
 				if (old_mac) {
-					listnode_delete(old_mac->neigh_list, n);
+					zebra_mac_neigh_del(
+						&old_mac->neigh_list, n);
 					n->mac = NULL;
 					zebra_evpn_deref_ip2mac(zevpn, old_mac);
 				}
 				n->mac = mac;
-				listnode_add_sort(mac->neigh_list, n);
+				zebra_mac_neigh_add(&mac->neigh_list, n);
 				memcpy(&n->emac, &mac->macaddr, ETH_ALEN);
 
 				/* Check Neigh's curent state is local
@@ -57,6 +57,8 @@ struct zebra_neigh {
 
 	/* Back pointer to MAC. Only applicable to hosts in a L2-VNI. */
 	struct zebra_mac *mac;
+	/* mac->neigh_list linkage */
+	struct zebra_mac_neigh_item mac_item;
 
 	/* Underlying interface. */
 	ifindex_t ifindex;
@@ -117,6 +119,21 @@ struct zebra_neigh {
 	struct thread *hold_timer;
 };
 
+static inline int zebra_mac_neigh_cmp(const struct zebra_neigh *n1,
+				      const struct zebra_neigh *n2)
+{
+	return ipaddr_cmp(&n1->ip, &n2->ip);
+}
+
+DECLARE_SORTLIST_UNIQ(zebra_mac_neigh, struct zebra_neigh, mac_item,
+		      zebra_mac_neigh_cmp);
+
+static inline bool zebra_evpn_mac_in_use(struct zebra_mac *mac)
+{
+	return zebra_mac_neigh_count(&mac->neigh_list)
+	       || CHECK_FLAG(mac->flags, ZEBRA_MAC_SVI);
+}
+
 /*
  * Context for neighbor hash walk - used by callbacks.
  */
@@ -207,7 +224,6 @@ static inline bool zebra_evpn_neigh_clear_sync_info(struct zebra_neigh *n)
 
 int remote_neigh_count(struct zebra_mac *zmac);
 
-int neigh_list_cmp(void *p1, void *p2);
 struct hash *zebra_neigh_db_create(const char *desc);
 uint32_t num_dup_detected_neighs(struct zebra_evpn *zevpn);
 void zebra_evpn_find_neigh_addr_width(struct hash_bucket *bucket, void *ctxt);
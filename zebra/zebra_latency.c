@@ -0,0 +1,315 @@
+/*
+ * Zebra route install latency tracking
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "json.h"
+#include "vty.h"
+
+#include "zebra/zebra_latency.h"
+#include "zebra/zebra_dplane.h"
+#include "zebra/zebra_errors.h"
+
+#include "zebra/zebra_latency_clippy.c"
+
+bool zebra_route_latency_enabled;
+
+#define ZEBRA_ROUTE_LATENCY_OUTLIER_DEFAULT 1000
+
+/* Outliers logged per second at most, the rest is only counted */
+#define ZEBRA_ROUTE_LATENCY_LOG_MAX 10
+
+enum zebra_route_latency_stage {
+	ZRL_QUEUE,
+	ZRL_RIB,
+	ZRL_DPLANE,
+	ZRL_KERNEL,
+	ZRL_RESULT,
+	ZRL_TOTAL,
+	ZRL_STAGE_MAX,
+};
+
+static const char *const zrl_stage_names[ZRL_STAGE_MAX] = {
+	[ZRL_QUEUE] = "queue",
+	[ZRL_RIB] = "rib",
+	[ZRL_DPLANE] = "dplane",
+	[ZRL_KERNEL] = "kernel",
+	[ZRL_RESULT] = "result",
+	[ZRL_TOTAL] = "total",
+};
+
+/* Bucket i counts samples below 2^i usec, the last one everything else */
+#define ZRL_BUCKETS 24
+
+struct zrl_hist {
+	uint64_t count;
+	uint64_t sum_usec;
+	uint64_t max_usec;
+	uint32_t buckets[ZRL_BUCKETS];
+};
+
+static struct zebra_route_latency {
+	uint32_t outlier_msec;
+
+	struct zrl_hist hist[ZRL_STAGE_MAX];
+
+	uint64_t outliers;
+	uint64_t suppressed;
+	time_t log_second;
+	unsigned int log_count;
+} zrl = {
+	.outlier_msec = ZEBRA_ROUTE_LATENCY_OUTLIER_DEFAULT,
+};
+
+static void zrl_hist_add(struct zrl_hist *h, int64_t start, int64_t end)
+{
+	uint64_t usec;
+	unsigned int bucket = 0;
+
+	/* Stage skipped, e.g. no kernel provider in the path */
+	if (!start || !end)
+		return;
+
+	usec = end > start ? end - start : 0;
+	while (bucket < ZRL_BUCKETS - 1 && usec >= (1ULL << bucket))
+		bucket++;
+
+	h->count++;
+	h->sum_usec += usec;
+	h->buckets[bucket]++;
+	if (usec > h->max_usec)
+		h->max_usec = usec;
+}
+
+static int64_t zrl_delta(int64_t start, int64_t end)
+{
+	return (start && end && end > start) ? end - start : 0;
+}
+
+static void zrl_outlier(const struct zebra_dplane_ctx *ctx,
+			const struct zebra_route_stamps *st, int64_t now)
+{
+	time_t second = now / 1000000;
+
+	zrl.outliers++;
+
+	if (second != zrl.log_second) {
+		if (zrl.suppressed)
+			zlog_warn("%" PRIu64
+				  " more slow route installs were not logged",
+				  zrl.suppressed);
+		zrl.log_second = second;
+		zrl.log_count = 0;
+		zrl.suppressed = 0;
+	}
+
+	if (zrl.log_count >= ZEBRA_ROUTE_LATENCY_LOG_MAX) {
+		zrl.suppressed++;
+		return;
+	}
+	zrl.log_count++;
+
+	flog_warn(EC_ZEBRA_ROUTE_INSTALL_SLOW,
+		  "Route %pFX vrf %u (%s) took %" PRId64
+		  " usec to install: queue %" PRId64 " rib %" PRId64
+		  " dplane %" PRId64 " kernel %" PRId64 " result %" PRId64,
+		  dplane_ctx_get_dest(ctx), dplane_ctx_get_vrf(ctx),
+		  zebra_route_string(dplane_ctx_get_type(ctx)),
+		  zrl_delta(st->zapi, now), zrl_delta(st->zapi, st->dequeue),
+		  zrl_delta(st->dequeue, st->enqueue),
+		  zrl_delta(st->enqueue, st->send),
+		  zrl_delta(st->send, st->ack), zrl_delta(st->ack, now));
+}
+
+void zebra_route_latency_record(const struct zebra_dplane_ctx *ctx)
+{
+	const struct zebra_route_stamps *st;
+	int64_t now;
+
+	st = dplane_ctx_get_route_stamps(ctx);
+	if (!st || !st->zapi)
+		return;
+
+	now = zebra_route_latency_now();
+
+	zrl_hist_add(&zrl.hist[ZRL_QUEUE], st->zapi, st->dequeue);
+	zrl_hist_add(&zrl.hist[ZRL_RIB], st->dequeue, st->enqueue);
+	zrl_hist_add(&zrl.hist[ZRL_DPLANE], st->enqueue, st->send);
+	zrl_hist_add(&zrl.hist[ZRL_KERNEL], st->send, st->ack);
+	zrl_hist_add(&zrl.hist[ZRL_RESULT], st->ack, now);
+	zrl_hist_add(&zrl.hist[ZRL_TOTAL], st->zapi, now);
+
+	if (zrl_delta(st->zapi, now) >= zrl.outlier_msec * 1000LL)
+		zrl_outlier(ctx, st, now);
+}
+
+/* Upper bound of the bucket holding the given percentile */
+static uint64_t zrl_pct(const struct zrl_hist *h, unsigned int pct)
+{
+	uint64_t seen = 0, want;
+	unsigned int b;
+
+	want = (h->count * pct + 99) / 100;
+
+	for (b = 0; b < ZRL_BUCKETS - 1; b++) {
+		seen += h->buckets[b];
+		if (seen >= want && seen)
+			return MIN(1ULL << b, h->max_usec);
+	}
+	return h->max_usec;
+}
+
+static void zrl_show_json(struct vty *vty)
+{
+	json_object *json, *json_stage, *json_buckets;
+	const struct zrl_hist *h;
+	unsigned int stage, b;
+	char key[16];
+
+	json = json_object_new_object();
+	json_object_boolean_add(json, "enabled", zebra_route_latency_enabled);
+	json_object_int_add(json, "outlierMsec", zrl.outlier_msec);
+	json_object_int_add(json, "outliers", zrl.outliers);
+
+	for (stage = 0; stage < ZRL_STAGE_MAX; stage++) {
+		h = &zrl.hist[stage];
+		if (!h->count)
+			continue;
+
+		json_stage = json_object_new_object();
+		json_object_int_add(json_stage, "count", h->count);
+		json_object_int_add(json_stage, "avgUsec",
+				    h->sum_usec / h->count);
+		json_object_int_add(json_stage, "p50Usec", zrl_pct(h, 50));
+		json_object_int_add(json_stage, "p90Usec", zrl_pct(h, 90));
+		json_object_int_add(json_stage, "p99Usec", zrl_pct(h, 99));
+		json_object_int_add(json_stage, "maxUsec", h->max_usec);
+
+		/* keyed by upper bound in usec, "inf" for the last */
+		json_buckets = json_object_new_object();
+		for (b = 0; b < ZRL_BUCKETS; b++) {
+			if (!h->buckets[b])
+				continue;
+			if (b == ZRL_BUCKETS - 1)
+				snprintf(key, sizeof(key), "inf");
+			else
+				snprintf(key, sizeof(key), "%llu", 1ULL << b);
+			json_object_int_add(json_buckets, key, h->buckets[b]);
+		}
+		json_object_object_add(json_stage, "buckets", json_buckets);
+
+		json_object_object_add(json, zrl_stage_names[stage],
+				       json_stage);
+	}
+
+	vty_json(vty, json);
+}
+
+DEFPY (show_zebra_route_latency,
+       show_zebra_route_latency_cmd,
+       "show zebra route latency [json$uj]",
+       SHOW_STR
+       ZEBRA_STR
+       "Route information\n"
+       "Route install latency, from zapi receipt to dataplane result\n"
+       JSON_STR)
+{
+	const struct zrl_hist *h;
+	unsigned int stage;
+
+	if (uj) {
+		zrl_show_json(vty);
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "Route latency tracking is %s, outlier threshold %u ms\n",
+		zebra_route_latency_enabled ? "enabled" : "disabled",
+		zrl.outlier_msec);
+	vty_out(vty, "Outliers: %" PRIu64 "\n\n", zrl.outliers);
+
+	vty_out(vty, "%-8s %10s %9s %9s %9s %9s %9s\n", "Stage", "Count",
+		"Avg(us)", "p50(us)", "p90(us)", "p99(us)", "Max(us)");
+	for (stage = 0; stage < ZRL_STAGE_MAX; stage++) {
+		h = &zrl.hist[stage];
+		if (!h->count)
+			continue;
+
+		vty_out(vty,
+			"%-8s %10" PRIu64 " %9" PRIu64 " %9" PRIu64
+			" %9" PRIu64 " %9" PRIu64 " %9" PRIu64 "\n",
+			zrl_stage_names[stage], h->count,
+			h->sum_usec / h->count, zrl_pct(h, 50),
+			zrl_pct(h, 90), zrl_pct(h, 99), h->max_usec);
+	}
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (clear_zebra_route_latency,
+       clear_zebra_route_latency_cmd,
+       "clear zebra route latency",
+       CLEAR_STR
+       ZEBRA_STR
+       "Route information\n"
+       "Route install latency statistics\n")
+{
+	memset(zrl.hist, 0, sizeof(zrl.hist));
+	zrl.outliers = 0;
+	zrl.suppressed = 0;
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (zebra_route_latency,
+       zebra_route_latency_cmd,
+       "[no] zebra route latency [outlier (1-600000)$msec]",
+       NO_STR
+       ZEBRA_STR
+       "Route information\n"
+       "Track route install latency, from zapi receipt to dataplane result\n"
+       "Log routes slower than a threshold\n"
+       "Threshold in milliseconds\n")
+{
+	zebra_route_latency_enabled = !no;
+	zrl.outlier_msec = (!no && msec_str)
+				   ? msec
+				   : ZEBRA_ROUTE_LATENCY_OUTLIER_DEFAULT;
+
+	return CMD_SUCCESS;
+}
+
+void zebra_route_latency_config_write(struct vty *vty)
+{
+	if (!zebra_route_latency_enabled)
+		return;
+
+	if (zrl.outlier_msec != ZEBRA_ROUTE_LATENCY_OUTLIER_DEFAULT)
+		vty_out(vty, "zebra route latency outlier %u\n",
+			zrl.outlier_msec);
+	else
+		vty_out(vty, "zebra route latency\n");
+}
+
+void zebra_route_latency_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_zebra_route_latency_cmd);
+	install_element(ENABLE_NODE, &clear_zebra_route_latency_cmd);
+	install_element(CONFIG_NODE, &zebra_route_latency_cmd);
+}
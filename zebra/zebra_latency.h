@@ -0,0 +1,79 @@
+/*
+ * Zebra route install latency tracking
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _ZEBRA_LATENCY_H
+#define _ZEBRA_LATENCY_H
+
+#include "monotime.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Timestamps (monotonic usec) a route picks up on its way from the zapi
+ * message to the kernel.  They travel in the dplane context; a zero zapi
+ * stamp means the route is not being tracked.
+ */
+struct zebra_route_stamps {
+	/* zapi message received, before decode */
+	int64_t zapi;
+	/* route node dequeued from the meta-queue by rib_process() */
+	int64_t dequeue;
+	/* dplane context built and handed to the dataplane */
+	int64_t enqueue;
+	/* kernel provider started sending the batch holding the route */
+	int64_t send;
+	/* kernel provider got the result for that batch */
+	int64_t ack;
+};
+
+extern bool zebra_route_latency_enabled;
+
+static inline int64_t zebra_route_latency_now(void)
+{
+	struct timeval tv;
+
+	monotime(&tv);
+	return tv.tv_sec * 1000000LL + tv.tv_usec;
+}
+
+/* Current time if latency tracking is on, 0 otherwise */
+static inline int64_t zebra_route_latency_stamp(void)
+{
+	return zebra_route_latency_enabled ? zebra_route_latency_now() : 0;
+}
+
+struct zebra_dplane_ctx;
+struct vty;
+
+/*
+ * Account a route update result coming back from the dataplane into the
+ * histograms and log it if it is an outlier.  Main pthread only.
+ */
+extern void zebra_route_latency_record(const struct zebra_dplane_ctx *ctx);
+
+extern void zebra_route_latency_config_write(struct vty *vty);
+extern void zebra_route_latency_vty_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_LATENCY_H */
@@ -3381,6 +3381,31 @@ static void mpls_lsp_uninstall_all_type(struct hash_bucket *bucket, void *ctxt)
 	mpls_lsp_uninstall_all(lsp_table, lsp, args->type);
 }
 
+/*
+ * Does the nhe carry labels of the given LSP type, on a primary or backup
+ * nexthop?
+ */
+static bool mpls_nhe_has_lsp_type(struct nhg_hash_entry *nhe,
+				  enum lsp_types_t lsp_type)
+{
+	struct nexthop *nexthop;
+	struct nexthop_group *nhg;
+
+	for (nexthop = nhe->nhg.nexthop; nexthop; nexthop = nexthop->next)
+		if (nexthop->nh_label_type == lsp_type)
+			return true;
+
+	nhg = zebra_nhg_get_backup_nhg(nhe);
+	if (nhg == NULL)
+		return false;
+
+	for (nexthop = nhg->nexthop; nexthop; nexthop = nexthop->next)
+		if (nexthop->nh_label_type == lsp_type)
+			return true;
+
+	return false;
+}
+
 /*
  * Uninstall all FEC-To-NHLFE (FTN) bindings of the given address-family and
  * LSP type.
@@ -3406,6 +3431,12 @@ static void mpls_ftn_uninstall_all(struct zebra_vrf *zvrf,
 		RNODE_FOREACH_RE (rn, re) {
 			struct nhg_hash_entry *new_nhe;
 
+			/* Most routes carry no labels of this type; don't
+			 * copy their nexthops just to find that out.
+			 */
+			if (!mpls_nhe_has_lsp_type(re->nhe, lsp_type))
+				continue;
+
 			new_nhe = zebra_nhe_copy(re->nhe, 0);
 
 			nhg = &new_nhe->nhg;
@@ -1088,6 +1088,43 @@ static void zebra_nhg_set_invalid(struct nhg_hash_entry *nhe)
 		zebra_nhg_check_valid(rb_node_dep->nhe);
 }
 
+/*
+ * A member of the group nhe has gone away, but the group is still usable.
+ * Replace the group in the dataplane with its remaining members, so
+ * routes using it converge without being reinstalled one by one.
+ */
+static void zebra_nhg_refresh_kernel(struct nhg_hash_entry *nhe)
+{
+	enum zebra_dplane_result ret;
+
+	if (zebra_router_in_shutdown())
+		return;
+
+	if (!nhg_connected_tree_count(&nhe->nhg_depends)
+	    || !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED)
+	    || CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_QUEUED))
+		return;
+
+	if (IS_ZEBRA_DEBUG_NHG_DETAIL)
+		zlog_debug("%s: nhe %p (%pNG) lost a member, updating",
+			   __func__, nhe, nhe);
+
+	ret = dplane_nexthop_update(nhe);
+
+	switch (ret) {
+	case ZEBRA_DPLANE_REQUEST_QUEUED:
+		SET_FLAG(nhe->flags, NEXTHOP_GROUP_QUEUED);
+		break;
+	case ZEBRA_DPLANE_REQUEST_FAILURE:
+		flog_err(EC_ZEBRA_DP_INSTALL_FAIL,
+			 "Failed to update Nexthop ID (%pNG) in the kernel",
+			 nhe);
+		break;
+	case ZEBRA_DPLANE_REQUEST_SUCCESS:
+		break;
+	}
+}
+
 void zebra_nhg_check_valid(struct nhg_hash_entry *nhe)
 {
 	struct nhg_connected *rb_node_dep = NULL;
@@ -1102,9 +1139,10 @@ void zebra_nhg_check_valid(struct nhg_hash_entry *nhe)
 	}
 
 done:
-	if (valid)
+	if (valid) {
 		zebra_nhg_set_valid(nhe);
-	else
+		zebra_nhg_refresh_kernel(nhe);
+	} else
 		zebra_nhg_set_invalid(nhe);
 }
 
@@ -3309,24 +3347,11 @@ bool zebra_nhg_proto_nexthops_only(void)
 	return proto_nexthops_only;
 }
 
-/* Add NHE from upper level proto */
-struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
-					   uint16_t instance, uint32_t session,
-					   struct nexthop_group *nhg, afi_t afi)
+/* Check the nexthops of a proto NHG, and set them active */
+static bool zebra_nhg_proto_nexthops_check(uint32_t id,
+					   struct nexthop_group *nhg)
 {
-	struct nhg_hash_entry lookup;
-	struct nhg_hash_entry *new, *old;
-	struct nhg_connected *rb_node_dep = NULL;
 	struct nexthop *newhop;
-	bool replace = false;
-
-	if (!nhg->nexthop) {
-		if (IS_ZEBRA_DEBUG_NHG)
-			zlog_debug("%s: id %u, no nexthops passed to add",
-				   __func__, id);
-		return NULL;
-	}
-
 
 	/* Set nexthop list as active, since they wont go through rib
 	 * processing.
@@ -3341,7 +3366,7 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 				zlog_debug(
 					"%s: id %u, backup nexthops not supported",
 					__func__, id);
-			return NULL;
+			return false;
 		}
 
 		if (newhop->type == NEXTHOP_TYPE_BLACKHOLE) {
@@ -3349,7 +3374,7 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 				zlog_debug(
 					"%s: id %u, blackhole nexthop not supported",
 					__func__, id);
-			return NULL;
+			return false;
 		}
 
 		if (newhop->type == NEXTHOP_TYPE_IFINDEX) {
@@ -3357,7 +3382,7 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 				zlog_debug(
 					"%s: id %u, nexthop without gateway not supported",
 					__func__, id);
-			return NULL;
+			return false;
 		}
 
 		if (!newhop->ifindex) {
@@ -3365,11 +3390,35 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 				zlog_debug(
 					"%s: id %u, nexthop without ifindex is not supported",
 					__func__, id);
-			return NULL;
+			return false;
 		}
 		SET_FLAG(newhop->flags, NEXTHOP_FLAG_ACTIVE);
 	}
 
+	return true;
+}
+
+/* Add NHE from upper level proto */
+struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
+					   uint16_t instance, uint32_t session,
+					   struct nexthop_group *nhg, afi_t afi)
+{
+	struct nhg_hash_entry lookup;
+	struct nhg_hash_entry *new, *old;
+	struct nhg_connected *rb_node_dep = NULL;
+	bool replace = false;
+
+	if (!nhg->nexthop) {
+		if (IS_ZEBRA_DEBUG_NHG)
+			zlog_debug("%s: id %u, no nexthops passed to add",
+				   __func__, id);
+		return NULL;
+	}
+
+
+	if (!zebra_nhg_proto_nexthops_check(id, nhg))
+		return NULL;
+
 	zebra_nhe_init(&lookup, afi, nhg->nexthop);
 	lookup.nhg.nexthop = nhg->nexthop;
 	lookup.nhg.nhgr = nhg->nhgr;
@@ -3442,6 +3491,135 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 	return new;
 }
 
+/*
+ * Add or remove members of an existing proto NHE in place.  The NHE keeps
+ * its id, and the routes using it are not touched: only the group object
+ * is replaced in the dataplane.
+ */
+struct nhg_hash_entry *zebra_nhg_proto_members(uint32_t id, int type,
+					       uint16_t instance,
+					       uint32_t session,
+					       struct nexthop_group *members,
+					       bool add)
+{
+	struct nhg_hash_entry *nhe;
+	struct nhg_connected_tree_head depends, old_depends;
+	struct nhg_connected *rb_node_dep = NULL;
+	struct nexthop_group nhg = {};
+	struct nexthop *nh, *found;
+	bool changed = false;
+	int i;
+
+	nhe = zebra_nhg_lookup_id(id);
+
+	if (!nhe || type != nhe->type
+	    || CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_PROTO_RELEASED)) {
+		if (IS_ZEBRA_DEBUG_NHG)
+			zlog_debug("%s: id %u, no group of type %s to update",
+				   __func__, id, zebra_route_string(type));
+		return NULL;
+	}
+
+	if (add && !zebra_nhg_proto_nexthops_check(id, members))
+		return NULL;
+
+	nexthop_group_copy(&nhg, &nhe->nhg);
+
+	for (nh = members->nexthop; nh; nh = nh->next) {
+		found = nexthop_exists(&nhg, nh);
+
+		if (add && !found) {
+			nexthop_group_add_sorted(&nhg, nexthop_dup(nh, NULL));
+			changed = true;
+		} else if (!add && found) {
+			_nexthop_del(&nhg, found);
+			nexthop_free(found);
+			changed = true;
+		}
+	}
+
+	if (!nhg.nexthop) {
+		if (IS_ZEBRA_DEBUG_NHG)
+			zlog_debug("%s: id %u, can't remove all the members",
+				   __func__, id);
+		return NULL;
+	}
+
+	nhe->zapi_instance = instance;
+	nhe->zapi_session = session;
+	nhe->uptime = monotime(NULL);
+
+	if (!changed) {
+		nexthops_free(nhg.nexthop);
+		if (CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED)
+		    && !CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_QUEUED))
+			zsend_nhg_notify(nhe->type, nhe->zapi_instance,
+					 nhe->zapi_session, nhe->id,
+					 ZAPI_NHG_INSTALLED);
+		return nhe;
+	}
+
+	/*
+	 * Take the refs the group passes on to its singletons, once for
+	 * the connection and once per ref of the group, before letting go
+	 * of the old ones so members kept in the group are never released.
+	 */
+	nhg_connected_tree_init(&depends);
+	for (nh = nhg.nexthop; nh; nh = nh->next)
+		depends_find_add(&depends, nh, nhe->afi, nhe->type, false);
+
+	frr_each (nhg_connected_tree, &depends, rb_node_dep)
+		for (i = 0; i < nhe->refcnt; i++)
+			zebra_nhg_increment_ref(rb_node_dep->nhe);
+
+	zebra_nhg_depends_release(nhe);
+	old_depends = nhe->nhg_depends;
+	nhe->nhg_depends = depends;
+	frr_each (nhg_connected_tree, &nhe->nhg_depends, rb_node_dep)
+		zebra_nhg_dependents_add(rb_node_dep->nhe, nhe);
+
+	nexthops_free(nhe->nhg.nexthop);
+	nhe->nhg.nexthop = nhg.nexthop;
+
+	zebra_nhg_set_valid_if_active(nhe);
+
+	/* Replace the group before the removed members may go away */
+	if (CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_INSTALLED)
+	    || CHECK_FLAG(nhe->flags, NEXTHOP_GROUP_QUEUED)) {
+		frr_each (nhg_connected_tree, &nhe->nhg_depends, rb_node_dep)
+			zebra_nhg_install_kernel(rb_node_dep->nhe);
+
+		switch (dplane_nexthop_update(nhe)) {
+		case ZEBRA_DPLANE_REQUEST_QUEUED:
+			SET_FLAG(nhe->flags, NEXTHOP_GROUP_QUEUED);
+			break;
+		case ZEBRA_DPLANE_REQUEST_FAILURE:
+			flog_err(EC_ZEBRA_DP_INSTALL_FAIL,
+				 "Failed to update Nexthop ID (%pNG) in the kernel",
+				 nhe);
+			break;
+		case ZEBRA_DPLANE_REQUEST_SUCCESS:
+			break;
+		}
+	} else
+		zebra_nhg_install_kernel(nhe);
+
+	frr_each (nhg_connected_tree, &old_depends, rb_node_dep)
+		for (i = 0; i < nhe->refcnt; i++)
+			zebra_nhg_decrement_ref(rb_node_dep->nhe);
+
+	/* Decrement to remove connection ref */
+	nhg_connected_tree_decrement_ref(&old_depends);
+	nhg_connected_tree_free(&old_depends);
+
+	if (IS_ZEBRA_DEBUG_NHG_DETAIL)
+		zlog_debug("%s: %s members of nhe %p (%pNG), refcnt %d",
+			   __func__, (add ? "added" : "removed"), nhe, nhe,
+			   nhe->refcnt);
+
+	return nhe;
+}
+
 /* Delete NHE from upper level proto, caller must decrement ref */
 struct nhg_hash_entry *zebra_nhg_proto_del(uint32_t id, int type)
 {
@@ -343,6 +343,18 @@ struct nhg_hash_entry *zebra_nhg_proto_add(uint32_t id, int type,
 					   struct nexthop_group *nhg,
 					   afi_t afi);
 
+/*
+ * Add members to, or remove members from, an existing NHE in place.  The
+ * group is replaced in the dataplane, routes using it are not reinstalled.
+ *
+ * Returns the updated NHE on success, otherwise NULL.
+ */
+struct nhg_hash_entry *zebra_nhg_proto_members(uint32_t id, int type,
+					       uint16_t instance,
+					       uint32_t session,
+					       struct nexthop_group *members,
+					       bool add);
+
 /*
  * Del NHE.
  *
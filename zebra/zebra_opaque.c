@@ -43,6 +43,21 @@ struct opq_client_reg {
 	struct opq_client_reg *prev;
 };
 
+/*
+ * Messages for one zapi client, collected while dispatching a batch of
+ * incoming messages, so that the client is acquired and its output queue
+ * locked only once per batch.
+ */
+struct opq_client_batch {
+	int proto;
+	int instance;
+	uint32_t session_id;
+
+	struct stream_fifo fifo;
+
+	struct opq_client_batch *next;
+};
+
 /* Opaque message registration info */
 struct opq_msg_reg {
 	struct opq_regh_item item;
@@ -338,18 +353,85 @@ done:
 	stream_fifo_deinit(&fifo);
 }
 
+/*
+ * Queue a message for a client on the batch list, keeping the order of
+ * messages per client.
+ */
+static void opq_batch_add(struct opq_client_batch **batches,
+			  const struct opq_client_reg *client,
+			  struct stream *msg)
+{
+	struct opq_client_batch *batch;
+
+	for (batch = *batches; batch; batch = batch->next) {
+		if (batch->proto == client->proto
+		    && batch->instance == client->instance
+		    && batch->session_id == client->session_id)
+			break;
+	}
+
+	if (batch == NULL) {
+		batch = XCALLOC(MTYPE_OPQ, sizeof(*batch));
+		batch->proto = client->proto;
+		batch->instance = client->instance;
+		batch->session_id = client->session_id;
+		stream_fifo_init(&batch->fifo);
+
+		batch->next = *batches;
+		*batches = batch;
+	}
+
+	stream_fifo_push(&batch->fifo, msg);
+}
+
+/*
+ * Hand each client's batch of messages to its zapi io pthread.
+ */
+static void opq_batch_send(struct opq_client_batch *batches)
+{
+	struct opq_client_batch *batch;
+	struct zserv *zclient;
+
+	while ((batch = batches) != NULL) {
+		batches = batch->next;
+
+		zclient = zserv_acquire_client(batch->proto, batch->instance,
+					       batch->session_id);
+		if (zclient) {
+			if (IS_ZEBRA_DEBUG_SEND && IS_ZEBRA_DEBUG_DETAIL)
+				zlog_debug("%s: sending %zu msgs to client %s[%u:%u]",
+					   __func__,
+					   stream_fifo_count_safe(&batch->fifo),
+					   zebra_route_string(batch->proto),
+					   batch->instance,
+					   batch->session_id);
+
+			zserv_send_batch(zclient, &batch->fifo);
+			zserv_release_client(zclient);
+		} else if (IS_ZEBRA_DEBUG_RECV && IS_ZEBRA_DEBUG_DETAIL) {
+			zlog_debug("%s: no zclient for %s[%u:%u]", __func__,
+				   zebra_route_string(batch->proto),
+				   batch->instance, batch->session_id);
+		}
+
+		/* Frees messages of a client that went away */
+		stream_fifo_deinit(&batch->fifo);
+		XFREE(MTYPE_OPQ, batch);
+	}
+}
+
 /*
  * Process (dispatch) or drop opaque messages.
  */
 static int dispatch_opq_messages(struct stream_fifo *msg_fifo)
 {
-	struct stream *msg, *dup;
+	struct stream *msg;
 	struct zmsghdr hdr;
 	struct zapi_opaque_msg info;
 	struct opq_msg_reg *reg;
 	int ret;
 	struct opq_client_reg *client;
-	struct zserv *zclient;
+	struct opq_client_batch *batches = NULL;
 	char buf[50];
 
 	while ((msg = stream_fifo_pop(msg_fifo)) != NULL) {
@@ -388,10 +470,11 @@ static int dispatch_opq_messages(struct stream_fifo *msg_fifo)
 		/* Reset read pointer, since we'll be re-sending message */
 		stream_set_getp(msg, 0);
 
-		/* Send a copy of the message to all registered clients */
+		/*
+		 * Queue a copy of the message for all registered clients;
+		 * the last one gets the original.
+		 */
 		for (client = reg->clients; client; client = client->next) {
-			dup = NULL;
-
 			if (CHECK_FLAG(info.flags, ZAPI_OPAQUE_FLAG_UNICAST)) {
 
 				if (client->proto != info.proto ||
@@ -407,58 +490,20 @@ static int dispatch_opq_messages(struct stream_fifo *msg_fifo)
 								  sizeof(buf),
 								  client));
 
-			} else {
-				/* Copy message if more clients */
-				if (client->next)
-					dup = stream_dup(msg);
-			}
+				opq_batch_add(&batches, client, msg);
+				msg = NULL;
 
-			/*
-			 * TODO -- this isn't ideal: we're going through an
-			 * acquire/release cycle for each client for each
-			 * message. Replace this with a batching version.
-			 */
-			zclient = zserv_acquire_client(client->proto,
-						       client->instance,
-						       client->session_id);
-			if (zclient) {
-				if (IS_ZEBRA_DEBUG_SEND &&
-				    IS_ZEBRA_DEBUG_DETAIL)
-					zlog_debug("%s: sending %s to client %s",
-						   __func__,
-						   (dup ? "dup" : "msg"),
-						   opq_client2str(buf,
-								  sizeof(buf),
-								  client));
+				/* If unicast, we're done */
+				break;
+			}
 
-				/*
-				 * Sending a message actually means enqueuing
-				 * it for a zapi io pthread to send - so we
-				 * don't touch the message after this call.
-				 */
-				zserv_send_message(zclient, dup ? dup : msg);
-				if (dup)
-					dup = NULL;
-				else
-					msg = NULL;
-
-				zserv_release_client(zclient);
+			if (client->next) {
+				opq_batch_add(&batches, client,
+					      stream_dup(msg));
 			} else {
-				if (IS_ZEBRA_DEBUG_RECV &&
-				    IS_ZEBRA_DEBUG_DETAIL)
-					zlog_debug("%s: type %u: no zclient for %s",
-						   __func__, info.type,
-						   opq_client2str(buf,
-								  sizeof(buf),
-								  client));
-				/* Registered but gone? */
-				if (dup)
-					stream_free(dup);
+				opq_batch_add(&batches, client, msg);
+				msg = NULL;
 			}
-
-			/* If unicast, we're done */
-			if (CHECK_FLAG(info.flags, ZAPI_OPAQUE_FLAG_UNICAST))
-				break;
 		}
 
 drop_it:
@@ -467,6 +512,8 @@ drop_it:
 			stream_free(msg);
 	}
 
+	opq_batch_send(batches);
+
 	return 0;
 }
 
@@ -234,40 +234,34 @@ bool zebra_pbr_rules_hash_equal(const void *arg1, const void *arg2)
 	return true;
 }
 
-struct pbr_rule_unique_lookup {
-	struct zebra_pbr_rule *rule;
-	uint32_t unique;
-	char ifname[INTERFACE_NAMSIZ + 1];
-	vrf_id_t vrf_id;
-};
-
-static int pbr_rule_lookup_unique_walker(struct hash_bucket *b, void *data)
+/*
+ * Rules indexed by what identifies them for their owner: the unique ID,
+ * interface and VRF.  rules_hash is keyed on the whole rule, so finding
+ * the rule an update replaces would otherwise mean walking all of them.
+ */
+uint32_t zebra_pbr_rules_unique_key(const void *arg)
 {
-	struct pbr_rule_unique_lookup *pul = data;
-	struct zebra_pbr_rule *rule = b->data;
+	const struct zebra_pbr_rule *rule = arg;
 
-	if (pul->unique == rule->rule.unique
-	    && strncmp(pul->ifname, rule->rule.ifname, INTERFACE_NAMSIZ) == 0
-	    && pul->vrf_id == rule->vrf_id) {
-		pul->rule = rule;
-		return HASHWALK_ABORT;
-	}
+	return jhash(rule->rule.ifname,
+		     strnlen(rule->rule.ifname, INTERFACE_NAMSIZ),
+		     jhash_2words(rule->rule.unique, rule->vrf_id, 0));
+}
 
-	return HASHWALK_CONTINUE;
+bool zebra_pbr_rules_unique_equal(const void *arg1, const void *arg2)
+{
+	const struct zebra_pbr_rule *r1 = arg1, *r2 = arg2;
+
+	return r1->rule.unique == r2->rule.unique
+	       && strncmp(r1->rule.ifname, r2->rule.ifname, INTERFACE_NAMSIZ)
+			  == 0
+	       && r1->vrf_id == r2->vrf_id;
 }
 
 static struct zebra_pbr_rule *
 pbr_rule_lookup_unique(struct zebra_pbr_rule *zrule)
 {
-	struct pbr_rule_unique_lookup pul;
-
-	pul.unique = zrule->rule.unique;
-	strlcpy(pul.ifname, zrule->rule.ifname, INTERFACE_NAMSIZ);
-	pul.rule = NULL;
-	pul.vrf_id = zrule->vrf_id;
-	hash_walk(zrouter.rules_hash, &pbr_rule_lookup_unique_walker, &pul);
-
-	return pul.rule;
+	return hash_lookup(zrouter.rules_unique_hash, zrule);
 }
 
 void zebra_pbr_ipset_free(void *arg)
@@ -486,12 +480,25 @@ static void *pbr_rule_alloc_intern(void *arg)
 	return new;
 }
 
+/* Insert into rules_hash, and the unique ID index */
+static struct zebra_pbr_rule *pbr_rule_get(struct zebra_pbr_rule *zrule)
+{
+	struct zebra_pbr_rule *new;
+
+	new = hash_get(zrouter.rules_hash, zrule, pbr_rule_alloc_intern);
+	(void)hash_get(zrouter.rules_unique_hash, new, hash_alloc_intern);
+
+	return new;
+}
+
 static struct zebra_pbr_rule *pbr_rule_free(struct zebra_pbr_rule *hash_data,
 					    bool free_data)
 {
 	if (hash_data->action.neigh)
 		zebra_neigh_deref(hash_data);
 	hash_release(zrouter.rules_hash, hash_data);
+	if (hash_lookup(zrouter.rules_unique_hash, hash_data) == hash_data)
+		hash_release(zrouter.rules_unique_hash, hash_data);
 	if (free_data) {
 		XFREE(MTYPE_PBR_OBJ, hash_data);
 		return NULL;
@@ -663,8 +670,8 @@ void zebra_pbr_add_rule(struct zebra_pbr_rule *rule)
 	struct zebra_pbr_rule *new;
 
 	/**
-	 * Check if we already have it (this checks via a unique ID, walking
-	 * over the hash table, not via a hash operation).
+	 * Check if we already have it (this checks via a unique ID, in the
+	 * unique ID index, not in rules_hash).
 	 */
 	found = pbr_rule_lookup_unique(rule);
 
@@ -682,7 +689,7 @@ void zebra_pbr_add_rule(struct zebra_pbr_rule *rule)
 		old = pbr_rule_release(found, false);
 
 		/* insert new entry into hash */
-		new = hash_get(zrouter.rules_hash, rule, pbr_rule_alloc_intern);
+		new = pbr_rule_get(rule);
 		/* expand the action if needed */
 		zebra_pbr_expand_rule(new);
 		/* update dataplane */
@@ -698,7 +705,7 @@ void zebra_pbr_add_rule(struct zebra_pbr_rule *rule)
 				rule->rule.unique, rule->rule.ifname);
 
 		/* insert new entry into hash */
-		new = hash_get(zrouter.rules_hash, rule, pbr_rule_alloc_intern);
+		new = pbr_rule_get(rule);
 		/* expand the action if needed */
 		zebra_pbr_expand_rule(new);
 		(void)dplane_pbr_rule_add(new);
@@ -59,11 +59,15 @@
 #include "zebra/zebra_dplane.h"
 #include "zebra/zebra_evpn_mh.h"
 #include "zebra/zebra_script.h"
+#include "zebra/zebra_latency.h"
+#include "zebra/zebra_snapshot.h"
+#include "zebra/zebra_tc.h"
 
 DEFINE_MGROUP(ZEBRA, "zebra");
 
-DEFINE_MTYPE(ZEBRA, RE,       "Route Entry");
+DEFINE_MTYPE_POOL(ZEBRA, RE, "Route Entry");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_DEST,       "RIB destination");
+DEFINE_MTYPE_STATIC(ZEBRA, RE_FIB_NHG, "Route Entry FIB nexthops");
 DEFINE_MTYPE_STATIC(ZEBRA, RIB_UPDATE_CTX, "Rib update context object");
 DEFINE_MTYPE_STATIC(ZEBRA, WQ_WRAPPER, "WQ wrapper");
 
@@ -153,6 +157,8 @@ struct wq_nhg_wrapper {
 
 #define WQ_NHG_WRAPPER_TYPE_CTX  0x01
 #define WQ_NHG_WRAPPER_TYPE_NHG  0x02
+#define WQ_NHG_WRAPPER_TYPE_MEMBER_ADD 0x03
+#define WQ_NHG_WRAPPER_TYPE_MEMBER_DEL 0x04
 
 /* Wrapper structs for evpn/vxlan workqueue items. */
 struct wq_evpn_wrapper {
@@ -398,8 +404,10 @@ int route_entry_update_nhe(struct route_entry *re,
 
 done:
 	/* Detach / deref previous nhg */
-	if (old_nhg)
+	if (old_nhg) {
 		zebra_nhg_decrement_ref(old_nhg);
+		zebra_snapshot_route_update(re);
+	}
 
 	return ret;
 }
@@ -720,9 +728,9 @@ void rib_install_kernel(struct route_node *rn, struct route_entry *re,
 
 			/* Free old FIB nexthop group */
 			UNSET_FLAG(old->status, ROUTE_ENTRY_USE_FIB_NHG);
-			if (old->fib_ng.nexthop) {
-				nexthops_free(old->fib_ng.nexthop);
-				old->fib_ng.nexthop = NULL;
+			if (old->fib && old->fib->fib_ng.nexthop) {
+				nexthops_free(old->fib->fib_ng.nexthop);
+				old->fib->fib_ng.nexthop = NULL;
 			}
 		}
 
@@ -813,6 +821,11 @@ static int rib_can_delete_dest(rib_dest_t *dest)
 	    || CHECK_FLAG(dest->flags, RIB_DEST_SENT_TO_FPM))
 		return 0;
 
+	/* Same for the RIB export */
+	if (CHECK_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT)
+	    || CHECK_FLAG(dest->flags, RIB_DEST_EXPORTED))
+		return 0;
+
 	return 1;
 }
 
@@ -820,6 +833,7 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 				    bool rt_delete)
 {
 	rib_dest_t *dest = rib_dest_from_rnode(rn);
+	struct route_node *changed = rn;
 	struct rnh *rnh;
 
 	/*
@@ -829,7 +843,9 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 	 * of the tree list.( 0.0.0.0/0 for v4 and 0::0/0 for v6 )
 	 * As such for each rn we need to walk up the tree
 	 * and see if any rnh's need to see if they
-	 * would match a more specific route
+	 * would match a more specific route.  Only rnh's
+	 * covered by the changed route can, the others are
+	 * still resolved by the route they are stored on.
 	 */
 	while (rn) {
 		if (IS_ZEBRA_DEBUG_NHT_DETAILED)
@@ -857,10 +873,14 @@ void zebra_rib_evaluate_rn_nexthops(struct route_node *rn, uint32_t seq,
 		 * nexthop tracking evaluation code
 		 */
 		frr_each_safe(rnh_list, &dest->nht, rnh) {
-			struct zebra_vrf *zvrf =
-				zebra_vrf_lookup_by_id(rnh->vrf_id);
+			struct zebra_vrf *zvrf;
 			struct prefix *p = &rnh->node->p;
 
+			if (rn != changed && !prefix_match(&changed->p, p))
+				continue;
+
+			zvrf = zebra_vrf_lookup_by_id(rnh->vrf_id);
+
 			if (IS_ZEBRA_DEBUG_NHT_DETAILED)
 				zlog_debug(
 					"%s(%u):%pRN has Nexthop(%pRN) depending on it, evaluating %u:%u",
@@ -1227,6 +1247,8 @@ static void rib_process(struct route_node *rn)
 
 	vrf = vrf_lookup_by_id(vrf_id);
 
+	dest->lat_dequeue = zebra_route_latency_stamp();
+
 	/*
 	 * we can have rn's that have a NULL info pointer
 	 * (dest).  As such let's not let the deref happen
@@ -1426,6 +1448,9 @@ static void rib_process(struct route_node *rn)
 
 	/* Remove all RE entries queued for removal */
 	RNODE_FOREACH_RE_SAFE (rn, re, next) {
+		/* Latency is only tracked up to the first install attempt */
+		re->lat_zapi = 0;
+
 		if (CHECK_FLAG(re->status, ROUTE_ENTRY_REMOVED)) {
 			if (IS_ZEBRA_DEBUG_RIB) {
 				rnode_debug(rn, vrf_id, "rn %p, removing re %p",
@@ -1710,8 +1735,8 @@ static bool rib_update_re_from_ctx(struct route_entry *re,
 	/* TODO -- this isn't testing or comparing the FIB flags; we should
 	 * do a more explicit loop, checking the incoming notification's flags.
 	 */
-	if (re->fib_ng.nexthop && ctxnhg->nexthop &&
-	    nexthop_group_equal(&re->fib_ng, ctxnhg))
+	if (re->fib && re->fib->fib_ng.nexthop && ctxnhg->nexthop
+	    && nexthop_group_equal(&re->fib->fib_ng, ctxnhg))
 		matched = true;
 
 	/* If the new FIB set matches the existing FIB set, we're done. */
@@ -1730,8 +1755,10 @@ static bool rib_update_re_from_ctx(struct route_entry *re,
 			zlog_debug(
 				"%s(%u:%u):%pRN update_from_ctx(): replacing fib nhg",
 				VRF_LOGNAME(vrf), re->vrf_id, re->table, rn);
-		nexthops_free(re->fib_ng.nexthop);
-		re->fib_ng.nexthop = NULL;
+		if (re->fib) {
+			nexthops_free(re->fib->fib_ng.nexthop);
+			re->fib->fib_ng.nexthop = NULL;
+		}
 
 		UNSET_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG);
 
@@ -1789,7 +1816,8 @@ no_nexthops:
 	/* Set the flag about the dedicated fib list */
 	SET_FLAG(re->status, ROUTE_ENTRY_USE_FIB_NHG);
 	if (ctxnhg->nexthop)
-		copy_nexthops(&(re->fib_ng.nexthop), ctxnhg->nexthop, NULL);
+		copy_nexthops(&(route_entry_fib_get(re)->fib_ng.nexthop),
+			      ctxnhg->nexthop, NULL);
 
 check_backups:
 
@@ -1805,7 +1833,7 @@ check_backups:
 	/* First check the route's 'fib' list of backups, if it's present
 	 * from some previous event.
 	 */
-	re_nhg = &re->fib_backup_ng;
+	re_nhg = rib_get_fib_backup_nhg(re);
 	ctxnhg = dplane_ctx_get_backup_ng(ctx);
 
 	matched = false;
@@ -1820,7 +1848,7 @@ check_backups:
 				VRF_LOGNAME(vrf), re->vrf_id, rn);
 		goto done;
 
-	} else if (re->fib_backup_ng.nexthop) {
+	} else if (re_nhg->nexthop) {
 		/*
 		 * Free stale fib backup list and move on to check
 		 * the route's backups.
@@ -1829,8 +1857,8 @@ check_backups:
 			zlog_debug(
 				"%s(%u):%pRN update_from_ctx(): replacing fib backup nhg",
 				VRF_LOGNAME(vrf), re->vrf_id, rn);
-		nexthops_free(re->fib_backup_ng.nexthop);
-		re->fib_backup_ng.nexthop = NULL;
+		nexthops_free(re_nhg->nexthop);
+		re_nhg->nexthop = NULL;
 
 		/* Note that the installed nexthops have changed */
 		changed_p = true;
@@ -1862,8 +1890,8 @@ check_backups:
 				VRF_LOGNAME(vrf), re->vrf_id, rn,
 				(changed_p ? "true" : "false"));
 
-		copy_nexthops(&(re->fib_backup_ng.nexthop), ctxnhg->nexthop,
-			      NULL);
+		copy_nexthops(&(route_entry_fib_get(re)->fib_backup_ng.nexthop),
+			      ctxnhg->nexthop, NULL);
 	}
 
 done:
@@ -2181,7 +2209,7 @@ static int rib_count_installed_nh(struct route_entry *re)
 		/* The meaningful flag depends on where the installed
 		 * nexthops reside.
 		 */
-		if (nhg == &(re->fib_ng)) {
+		if (re->fib && nhg == &(re->fib->fib_ng)) {
 			if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_FIB))
 				count++;
 		} else {
@@ -2533,6 +2561,25 @@ static void process_subq_nhg(struct listnode *lnode)
 
 		/* Free temp nhe - we own that memory. */
 		zebra_nhg_free(nhe);
+	} else {
+		nhe = w->u.nhe;
+
+		if (IS_ZEBRA_DEBUG_RIB_DETAILED)
+			zlog_debug("NHG %u members dequeued from sub-queue %s",
+				   nhe->id, subqueue2str(qindex));
+
+		/* Update the members of an existing nhg in place */
+		newnhe = zebra_nhg_proto_members(
+			nhe->id, nhe->type, nhe->zapi_instance,
+			nhe->zapi_session, &nhe->nhg,
+			w->type == WQ_NHG_WRAPPER_TYPE_MEMBER_ADD);
+
+		if (newnhe == NULL)
+			zsend_nhg_notify(nhe->type, nhe->zapi_instance,
+					 nhe->zapi_session, nhe->id,
+					 ZAPI_NHG_FAIL_INSTALL);
+
+		zebra_nhg_free(nhe);
 	}
 
 	XFREE(MTYPE_WQ_WRAPPER, w);
@@ -2611,7 +2658,7 @@ static void rib_re_nhg_free(struct route_entry *re)
 	} else if (re->nhe && re->nhe->nhg.nexthop)
 		nexthops_free(re->nhe->nhg.nexthop);
 
-	nexthops_free(re->fib_ng.nexthop);
+	route_entry_fib_free(re);
 }
 
 struct zebra_early_route {
@@ -3123,14 +3170,38 @@ static wq_item_status meta_queue_process(struct work_queue *dummy, void *data)
 		return WQ_QUEUE_BLOCKED;
 	}
 
-	for (i = 0; i < MQ_SIZE; i++)
+	for (i = 0; i < MQ_SIZE; i++) {
+		if (i == META_QUEUE_EARLY_ROUTE
+		    && mq->early_route_prio == listhead(mq->subq[i]))
+			mq->early_route_prio = NULL;
+
 		if (process_subq(mq->subq[i], i)) {
 			mq->size--;
 			break;
 		}
+	}
 	return mq->size ? WQ_REQUEUE : WQ_SUCCESS;
 }
 
+static void meta_queue_count(struct meta_queue *mq, uint8_t qindex)
+{
+	uint32_t len = listcount(mq->subq[qindex]);
+
+	mq->size++;
+	if (len > mq->max_len[qindex])
+		mq->max_len[qindex] = len;
+}
+
+void meta_queue_show(struct vty *vty, const struct meta_queue *mq)
+{
+	enum meta_queue_indexes i;
+
+	vty_out(vty, "%-32s %10s %10s\n", "Sub-queue", "Length", "Max");
+	for (i = 0; i < MQ_SIZE; i++)
+		vty_out(vty, "%-32s %10u %10u\n", subqueue2str(i),
+			listcount(mq->subq[i]), mq->max_len[i]);
+	vty_out(vty, "%-32s %10u\n", "Total", mq->size);
+}
 
 /*
  * Look into the RN and queue it into the highest priority queue
@@ -3184,7 +3255,7 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 	SET_FLAG(rib_dest_from_rnode(rn)->flags, RIB_ROUTE_QUEUED(qindex));
 	listnode_add(mq->subq[qindex], rn);
 	route_lock_node(rn);
-	mq->size++;
+	meta_queue_count(mq, qindex);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED)
 		rnode_debug(rn, re->vrf_id, "queued rn %p into sub-queue %s",
@@ -3196,7 +3267,7 @@ static int rib_meta_queue_add(struct meta_queue *mq, void *data)
 static int early_label_meta_queue_add(struct meta_queue *mq, void *data)
 {
 	listnode_add(mq->subq[META_QUEUE_EARLY_LABEL], data);
-	mq->size++;
+	meta_queue_count(mq, META_QUEUE_EARLY_LABEL);
 	return 0;
 }
 
@@ -3217,7 +3288,7 @@ static int rib_meta_queue_nhg_ctx_add(struct meta_queue *mq, void *data)
 	w->u.ctx = ctx;
 
 	listnode_add(mq->subq[qindex], w);
-	mq->size++;
+	meta_queue_count(mq, qindex);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED)
 		zlog_debug("NHG Context id=%u queued into sub-queue %s",
@@ -3226,24 +3297,22 @@ static int rib_meta_queue_nhg_ctx_add(struct meta_queue *mq, void *data)
 	return 0;
 }
 
-static int rib_meta_queue_nhg_add(struct meta_queue *mq, void *data)
+static int rib_meta_queue_nhe(struct meta_queue *mq,
+			      struct nhg_hash_entry *nhe, int type)
 {
-	struct nhg_hash_entry *nhe = NULL;
 	uint8_t qindex = META_QUEUE_NHG;
 	struct wq_nhg_wrapper *w;
 
-	nhe = (struct nhg_hash_entry *)data;
-
 	if (!nhe)
 		return -1;
 
 	w = XCALLOC(MTYPE_WQ_WRAPPER, sizeof(struct wq_nhg_wrapper));
 
-	w->type = WQ_NHG_WRAPPER_TYPE_NHG;
+	w->type = type;
 	w->u.nhe = nhe;
 
 	listnode_add(mq->subq[qindex], w);
-	mq->size++;
+	meta_queue_count(mq, qindex);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED)
 		zlog_debug("NHG id=%u queued into sub-queue %s", nhe->id,
@@ -3252,10 +3321,25 @@ static int rib_meta_queue_nhg_add(struct meta_queue *mq, void *data)
 	return 0;
 }
 
+static int rib_meta_queue_nhg_add(struct meta_queue *mq, void *data)
+{
+	return rib_meta_queue_nhe(mq, data, WQ_NHG_WRAPPER_TYPE_NHG);
+}
+
+static int rib_meta_queue_nhg_member_add(struct meta_queue *mq, void *data)
+{
+	return rib_meta_queue_nhe(mq, data, WQ_NHG_WRAPPER_TYPE_MEMBER_ADD);
+}
+
+static int rib_meta_queue_nhg_member_del(struct meta_queue *mq, void *data)
+{
+	return rib_meta_queue_nhe(mq, data, WQ_NHG_WRAPPER_TYPE_MEMBER_DEL);
+}
+
 static int rib_meta_queue_evpn_add(struct meta_queue *mq, void *data)
 {
 	listnode_add(mq->subq[META_QUEUE_EVPN], data);
-	mq->size++;
+	meta_queue_count(mq, META_QUEUE_EVPN);
 
 	return 0;
 }
@@ -3359,6 +3443,19 @@ int rib_queue_nhe_add(struct nhg_hash_entry *nhe)
 	return mq_add_handler(nhe, rib_meta_queue_nhg_add);
 }
 
+/*
+ * Enqueue members to add to or remove from an existing nhg, sent by
+ * a proto daemon
+ */
+int rib_queue_nhe_members(struct nhg_hash_entry *nhe, bool add)
+{
+	if (nhe == NULL)
+		return -1;
+
+	return mq_add_handler(nhe, add ? rib_meta_queue_nhg_member_add
+				       : rib_meta_queue_nhg_member_del);
+}
+
 /*
  * Enqueue evpn route for processing
  */
@@ -3619,13 +3716,13 @@ static void nhg_meta_queue_free(struct meta_queue *mq, struct list *l,
 			if (w->type == WQ_NHG_WRAPPER_TYPE_CTX &&
 			    w->u.ctx->vrf_id != vrf_id)
 				continue;
-			else if (w->type == WQ_NHG_WRAPPER_TYPE_NHG &&
+			else if (w->type != WQ_NHG_WRAPPER_TYPE_CTX &&
 				 w->u.nhe->vrf_id != vrf_id)
 				continue;
 		}
 		if (w->type == WQ_NHG_WRAPPER_TYPE_CTX)
 			nhg_ctx_free(&w->u.ctx);
-		else if (w->type == WQ_NHG_WRAPPER_TYPE_NHG)
+		else
 			zebra_nhg_free(w->u.nhe);
 
 		node->data = NULL;
@@ -3693,6 +3790,14 @@ static void early_route_meta_queue_free(struct meta_queue *mq, struct list *l,
 		list_delete_node(l, node);
 		mq->size--;
 	}
+
+	/* Find the last high priority route left */
+	mq->early_route_prio = NULL;
+	for (ALL_LIST_ELEMENTS(l, node, nnode, ere)) {
+		if (route_info[ere->re->type].meta_q_map >= META_QUEUE_BGP)
+			break;
+		mq->early_route_prio = node;
+	}
 }
 
 void meta_queue_free(struct meta_queue *mq, struct zebra_vrf *zvrf)
@@ -3808,6 +3913,28 @@ rib_dest_t *zebra_rib_create_dest(struct route_node *rn)
  *
  */
 
+/* Keep track of the destinations that have kernel routes */
+static void rib_kernel_dest_update(rib_dest_t *dest, struct route_entry *re,
+				   bool add)
+{
+	struct rib_table_info *info;
+
+	if (re->type != ZEBRA_ROUTE_KERNEL)
+		return;
+
+	info = rib_table_info(rib_dest_table(dest));
+	if (!info)
+		return;
+
+	if (add) {
+		if (dest->kernel_routes++ == 0)
+			rib_kernel_dests_add_tail(&info->kernel_dests, dest);
+	} else {
+		if (--dest->kernel_routes == 0)
+			rib_kernel_dests_del(&info->kernel_dests, dest);
+	}
+}
+
 /* Add RE to head of the route node. */
 static void rib_link(struct route_node *rn, struct route_entry *re, int process)
 {
@@ -3826,6 +3953,8 @@ static void rib_link(struct route_node *rn, struct route_entry *re, int process)
 	}
 
 	re_list_add_head(&dest->routes, re);
+	rib_kernel_dest_update(dest, re, true);
+	zebra_snapshot_route_add(rn, re);
 
 	afi = (rn->p.family == AF_INET)
 		      ? AFI_IP
@@ -3878,10 +4007,12 @@ void rib_unlink(struct route_node *rn, struct route_entry *re)
 	dest = rib_dest_from_rnode(rn);
 
 	re_list_del(&dest->routes, re);
+	rib_kernel_dest_update(dest, re, false);
 
 	if (dest->selected_fib == re)
 		dest->selected_fib = NULL;
 
+	zebra_snapshot_route_del(re);
 	rib_re_nhg_free(re);
 
 	zapi_re_opaque_free(re->opaque);
@@ -4064,9 +4195,21 @@ void _route_entry_dump(const char *func, union prefixconstptr pp,
 static int rib_meta_queue_early_route_add(struct meta_queue *mq, void *data)
 {
 	struct zebra_early_route *ere = data;
+	struct list *subq = mq->subq[META_QUEUE_EARLY_ROUTE];
 
-	listnode_add(mq->subq[META_QUEUE_EARLY_ROUTE], data);
-	mq->size++;
+	/*
+	 * Routes are handled in the order they are received, but a burst
+	 * from BGP must not hold back connected, static and IGP routes for
+	 * the whole burst: those are queued ahead of the BGP (and other
+	 * low priority) ones.  This keeps the order of the routes of each
+	 * protocol.
+	 */
+	if (route_info[ere->re->type].meta_q_map < META_QUEUE_BGP)
+		mq->early_route_prio =
+			listnode_add_after(subq, mq->early_route_prio, data);
+	else
+		listnode_add(subq, data);
+	meta_queue_count(mq, META_QUEUE_EARLY_ROUTE);
 
 	if (IS_ZEBRA_DEBUG_RIB_DETAILED)
 		zlog_debug(
@@ -4101,6 +4244,27 @@ struct route_entry *zebra_rib_route_entry_new(vrf_id_t vrf_id, int type,
 
 	return re;
 }
+
+/* Empty group handed out for routes without FIB nexthops */
+struct nexthop_group rib_empty_nhg;
+
+struct re_fib_nhg *route_entry_fib_get(struct route_entry *re)
+{
+	if (!re->fib)
+		re->fib = XCALLOC(MTYPE_RE_FIB_NHG, sizeof(*re->fib));
+
+	return re->fib;
+}
+
+void route_entry_fib_free(struct route_entry *re)
+{
+	if (!re->fib)
+		return;
+
+	nexthops_free(re->fib->fib_ng.nexthop);
+	nexthops_free(re->fib->fib_backup_ng.nexthop);
+	XFREE(MTYPE_RE_FIB_NHG, re->fib);
+}
 /*
  * Internal route-add implementation; there are a couple of different public
  * signatures. Callers in this path are responsible for the memory they
@@ -4277,7 +4441,9 @@ static void rib_update_route_node(struct route_node *rn, int type)
 void rib_update_table(struct route_table *table, enum rib_update_event event,
 		      int rtype)
 {
+	struct rib_table_info *info = rib_table_info(table);
 	struct route_node *rn;
+	rib_dest_t *dest;
 
 	if (IS_ZEBRA_DEBUG_EVENT) {
 		struct zebra_vrf *zvrf;
@@ -4296,6 +4462,21 @@ void rib_update_table(struct route_table *table, enum rib_update_event event,
 			   rib_update_event2str(event), zebra_route_string(rtype));
 	}
 
+	/*
+	 * Only kernel routes are of interest, so there is no need to walk
+	 * the whole table.
+	 */
+	if (info
+	    && (event == RIB_UPDATE_KERNEL || rtype == ZEBRA_ROUTE_KERNEL)) {
+		frr_each (rib_kernel_dests, &info->kernel_dests, dest) {
+			if (CHECK_FLAG(dest->flags, RIB_ROUTE_ANY_QUEUED))
+				continue;
+
+			rib_update_route_node(dest->rnode, ZEBRA_ROUTE_KERNEL);
+		}
+		return;
+	}
+
 	/* Walk all routes and queue for processing, if appropriate for
 	 * the trigger event.
 	 */
@@ -4500,6 +4681,7 @@ void rib_sweep_route(struct thread *t)
 
 	zebra_router_sweep_route();
 	zebra_router_sweep_nhgs();
+	zebra_snapshot_sweep();
 }
 
 /* Remove specific by protocol routes from 'table'. */
@@ -4652,6 +4834,8 @@ static void rib_process_dplane_results(struct thread *thread)
 		}
 #endif /* HAVE_SCRIPTING */
 
+		zsend_route_notify_owner_batch();
+
 		while (ctx) {
 
 #ifdef HAVE_SCRIPTING
@@ -4670,8 +4854,10 @@ static void rib_process_dplane_results(struct thread *thread)
 				 * we don't want to continue processing these
 				 * in the rib.
 				 */
-				if (dplane_ctx_get_notif_provider(ctx) == 0)
+				if (dplane_ctx_get_notif_provider(ctx) == 0) {
+					zebra_route_latency_record(ctx);
 					rib_process_result(ctx);
+				}
 				break;
 
 			case DPLANE_OP_ROUTE_NOTIFY:
@@ -4742,6 +4928,7 @@ static void rib_process_dplane_results(struct thread *thread)
 			case DPLANE_OP_TC_FILTER_ADD:
 			case DPLANE_OP_TC_FILTER_DELETE:
 			case DPLANE_OP_TC_FILTER_UPDATE:
+				zebra_tc_dplane_result(ctx);
 				break;
 
 			/* Some op codes not handled here */
@@ -4767,6 +4954,8 @@ static void rib_process_dplane_results(struct thread *thread)
 			ctx = dplane_ctx_dequeue(&ctxlist);
 		}
 
+		zsend_route_notify_owner_flush();
+
 	} while (1);
 }
 
@@ -0,0 +1,374 @@
+/*
+ * Zebra shared memory RIB export
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include "command.h"
+#include "hook.h"
+#include "rib_export.h"
+#include "srcdest_table.h"
+#include "vty.h"
+
+#include "zebra/rib.h"
+#include "zebra/zebra_router.h"
+#include "zebra/zebra_rib_export.h"
+
+#include "zebra/zebra_rib_export_clippy.c"
+
+/* Destinations written per event run, before yielding */
+#define ZRX_BATCH 1000
+
+static struct zebra_rib_export {
+	struct rib_export *rx;
+
+	/* destinations to write out, see RIB_DEST_UPDATE_EXPORT */
+	struct rib_export_dests_head queue;
+	struct thread *t_process;
+
+	uint64_t updates;
+	uint64_t removals;
+	/* routes with more than RIB_EXPORT_NEXTHOPS active nexthops */
+	uint64_t truncated;
+	uint64_t alloc_failures;
+} zrx;
+
+static void zrx_process(struct thread *thread);
+
+static void zrx_fill(struct route_node *rn, struct route_entry *re,
+		     struct rib_export_route *out)
+{
+	const struct rib_table_info *info = srcdest_rnode_table_info(rn);
+	const struct prefix *p, *src_p;
+	struct nexthop_group *nhg;
+	struct nexthop *nexthop;
+	struct rib_export_nexthop *xnh;
+
+	memset(out, 0, sizeof(*out));
+
+	srcdest_rnode_prefixes(rn, &p, &src_p);
+	out->family = p->family;
+	out->prefixlen = p->prefixlen;
+	memcpy(out->prefix, &p->u.prefix, prefix_blen(p));
+	if (src_p && src_p->prefixlen) {
+		out->src_prefixlen = src_p->prefixlen;
+		memcpy(out->src_prefix, &src_p->u.prefix, prefix_blen(src_p));
+	}
+
+	out->type = re->type;
+	out->instance = re->instance;
+	out->distance = re->distance;
+	out->safi = info->safi;
+	out->vrf_id = re->vrf_id;
+	out->table = re->table;
+	out->metric = re->metric;
+	out->mtu = re->mtu;
+	out->tag = re->tag;
+	if (CHECK_FLAG(re->status, ROUTE_ENTRY_INSTALLED))
+		SET_FLAG(out->flags, RIB_EXPORT_INSTALLED);
+	if (CHECK_FLAG(re->status, ROUTE_ENTRY_QUEUED))
+		SET_FLAG(out->flags, RIB_EXPORT_QUEUED);
+	if (CHECK_FLAG(re->status, ROUTE_ENTRY_FAILED))
+		SET_FLAG(out->flags, RIB_EXPORT_FAILED);
+	/* re->uptime is monotonic, consumers want the wall clock */
+	out->uptime = time(NULL) - (monotime(NULL) - re->uptime);
+
+	nhg = rib_get_fib_nhg(re);
+	for (ALL_NEXTHOPS_PTR(nhg, nexthop)) {
+		if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_RECURSIVE)
+		    || !CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_ACTIVE))
+			continue;
+
+		out->nexthop_total++;
+		if (out->nexthop_num >= RIB_EXPORT_NEXTHOPS)
+			continue;
+
+		xnh = &out->nexthops[out->nexthop_num++];
+		xnh->type = nexthop->type;
+		xnh->weight = nexthop->weight;
+		xnh->ifindex = nexthop->ifindex;
+		xnh->vrf_id = nexthop->vrf_id;
+		if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_ONLINK))
+			SET_FLAG(xnh->flags, RIB_EXPORT_NH_ONLINK);
+		if (CHECK_FLAG(nexthop->flags, NEXTHOP_FLAG_DUPLICATE))
+			SET_FLAG(xnh->flags, RIB_EXPORT_NH_DUPLICATE);
+
+		switch (nexthop->type) {
+		case NEXTHOP_TYPE_IPV4:
+		case NEXTHOP_TYPE_IPV4_IFINDEX:
+			memcpy(xnh->gate, &nexthop->gate.ipv4,
+			       sizeof(nexthop->gate.ipv4));
+			break;
+		case NEXTHOP_TYPE_IPV6:
+		case NEXTHOP_TYPE_IPV6_IFINDEX:
+			memcpy(xnh->gate, &nexthop->gate.ipv6,
+			       sizeof(nexthop->gate.ipv6));
+			break;
+		case NEXTHOP_TYPE_IFINDEX:
+		case NEXTHOP_TYPE_BLACKHOLE:
+			break;
+		}
+
+		if (nexthop->nh_label && nexthop->nh_label->num_labels) {
+			xnh->num_labels = 1;
+			xnh->label = nexthop->nh_label->label[0];
+		}
+	}
+
+	if (out->nexthop_total > out->nexthop_num)
+		zrx.truncated++;
+}
+
+static void zrx_update(rib_dest_t *dest)
+{
+	struct route_entry *re = dest->selected_fib;
+	struct rib_export_route route;
+
+	if (re) {
+		if (!dest->export_slot) {
+			dest->export_slot = rib_export_alloc(zrx.rx);
+			if (!dest->export_slot) {
+				zrx.alloc_failures++;
+				rib_gc_dest(dest->rnode);
+				return;
+			}
+			SET_FLAG(dest->flags, RIB_DEST_EXPORTED);
+		}
+
+		zrx_fill(dest->rnode, re, &route);
+		rib_export_set(zrx.rx, dest->export_slot, &route);
+		zrx.updates++;
+		return;
+	}
+
+	if (dest->export_slot) {
+		rib_export_release(zrx.rx, dest->export_slot);
+		dest->export_slot = 0;
+		UNSET_FLAG(dest->flags, RIB_DEST_EXPORTED);
+		zrx.removals++;
+	}
+
+	/* the dest was kept around for us, it may go now */
+	rib_gc_dest(dest->rnode);
+}
+
+static void zrx_process(struct thread *thread)
+{
+	unsigned int count = 0;
+	rib_dest_t *dest;
+
+	while (count++ < ZRX_BATCH
+	       && (dest = rib_export_dests_pop(&zrx.queue))) {
+		UNSET_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT);
+		zrx_update(dest);
+	}
+
+	if (rib_export_dests_count(&zrx.queue))
+		thread_add_event(zrouter.master, zrx_process, NULL, 0,
+				 &zrx.t_process);
+}
+
+/*
+ * rib_update hook, selected_fib is not final yet, the dest is only looked
+ * at once rib_process() is done.
+ */
+static int zrx_trigger_update(struct route_node *rn, const char *reason)
+{
+	rib_dest_t *dest;
+
+	if (!zrx.rx)
+		return 0;
+
+	dest = rib_dest_from_rnode(rn);
+	if (!dest || CHECK_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT))
+		return 0;
+
+	SET_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT);
+	rib_export_dests_add_tail(&zrx.queue, dest);
+	thread_add_event(zrouter.master, zrx_process, NULL, 0,
+			 &zrx.t_process);
+
+	return 0;
+}
+
+/* rib_shutdown hook, the dest is about to be freed with its table */
+static int zrx_trigger_remove(struct route_node *rn)
+{
+	rib_dest_t *dest;
+
+	if (!zrx.rx)
+		return 0;
+
+	dest = rib_dest_from_rnode(rn);
+	if (!dest)
+		return 0;
+
+	if (CHECK_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT)) {
+		rib_export_dests_del(&zrx.queue, dest);
+		UNSET_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT);
+	}
+
+	if (dest->export_slot) {
+		rib_export_release(zrx.rx, dest->export_slot);
+		dest->export_slot = 0;
+		UNSET_FLAG(dest->flags, RIB_DEST_EXPORTED);
+	}
+
+	return 0;
+}
+
+static int zrx_start(const char *path)
+{
+	struct zebra_router_table *zrt;
+	struct route_node *rn;
+	rib_dest_t *dest;
+
+	zrx.rx = rib_export_create(path);
+	if (!zrx.rx)
+		return -1;
+
+	rib_export_dests_init(&zrx.queue);
+
+	RB_FOREACH (zrt, zebra_router_table_head, &zrouter.tables) {
+		for (rn = route_top(zrt->table); rn;
+		     rn = srcdest_route_next(rn)) {
+			dest = rib_dest_from_rnode(rn);
+			if (dest && dest->selected_fib)
+				zrx_trigger_update(rn, NULL);
+		}
+	}
+
+	return 0;
+}
+
+static void zrx_stop(bool shutdown)
+{
+	struct zebra_router_table *zrt;
+	struct route_node *rn;
+	rib_dest_t *dest;
+
+	THREAD_OFF(zrx.t_process);
+
+	while ((dest = rib_export_dests_pop(&zrx.queue)))
+		UNSET_FLAG(dest->flags, RIB_DEST_UPDATE_EXPORT);
+	rib_export_dests_fini(&zrx.queue);
+
+	/* the RIB is torn down right after, don't bother with the slots */
+	if (!shutdown) {
+		RB_FOREACH (zrt, zebra_router_table_head, &zrouter.tables) {
+			for (rn = route_top(zrt->table); rn;
+			     rn = srcdest_route_next(rn)) {
+				dest = rib_dest_from_rnode(rn);
+				if (!dest)
+					continue;
+				dest->export_slot = 0;
+				UNSET_FLAG(dest->flags, RIB_DEST_EXPORTED);
+			}
+		}
+	}
+
+	rib_export_destroy(&zrx.rx);
+}
+
+void zebra_rib_export_finish(void)
+{
+	if (zrx.rx)
+		zrx_stop(true);
+}
+
+DEFPY (zebra_rib_export,
+       zebra_rib_export_cmd,
+       "zebra rib-export FILE$file",
+       ZEBRA_STR
+       "Export the selected routes to a shared memory file\n"
+       "File name, usually on tmpfs\n")
+{
+	if (zrx.rx) {
+		if (strmatch(rib_export_path(zrx.rx), file))
+			return CMD_SUCCESS;
+		zrx_stop(false);
+	}
+
+	if (zrx_start(file) < 0) {
+		vty_out(vty, "%% Cannot create %s: %s\n", file,
+			safe_strerror(errno));
+		return CMD_WARNING_CONFIG_FAILED;
+	}
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (no_zebra_rib_export,
+       no_zebra_rib_export_cmd,
+       "no zebra rib-export [FILE]",
+       NO_STR
+       ZEBRA_STR
+       "Export the selected routes to a shared memory file\n"
+       "File name, usually on tmpfs\n")
+{
+	if (zrx.rx)
+		zrx_stop(false);
+
+	return CMD_SUCCESS;
+}
+
+DEFPY (show_zebra_rib_export,
+       show_zebra_rib_export_cmd,
+       "show zebra rib-export",
+       SHOW_STR
+       ZEBRA_STR
+       "Shared memory RIB export\n")
+{
+	if (!zrx.rx) {
+		vty_out(vty, "RIB export is not enabled\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "RIB export %s, generation %" PRIu64 "\n",
+		rib_export_path(zrx.rx), rib_export_generation(zrx.rx));
+	vty_out(vty, "  %u routes exported, %u records (%zu bytes each)\n",
+		rib_export_count(zrx.rx), rib_export_size(zrx.rx),
+		sizeof(struct rib_export_rec));
+	vty_out(vty, "  %zu destinations queued\n",
+		rib_export_dests_count(&zrx.queue));
+	vty_out(vty, "  %" PRIu64 " updates, %" PRIu64 " removals\n",
+		zrx.updates, zrx.removals);
+	vty_out(vty, "  %" PRIu64 " routes with truncated nexthops\n",
+		zrx.truncated);
+	if (zrx.alloc_failures)
+		vty_out(vty, "  %" PRIu64 " routes not exported, image full\n",
+			zrx.alloc_failures);
+
+	return CMD_SUCCESS;
+}
+
+void zebra_rib_export_config_write(struct vty *vty)
+{
+	if (zrx.rx)
+		vty_out(vty, "zebra rib-export %s\n", rib_export_path(zrx.rx));
+}
+
+void zebra_rib_export_vty_init(void)
+{
+	hook_register(rib_update, zrx_trigger_update);
+	hook_register(rib_shutdown, zrx_trigger_remove);
+
+	install_element(CONFIG_NODE, &zebra_rib_export_cmd);
+	install_element(CONFIG_NODE, &no_zebra_rib_export_cmd);
+	install_element(VIEW_NODE, &show_zebra_rib_export_cmd);
+}
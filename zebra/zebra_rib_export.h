@@ -0,0 +1,45 @@
+/*
+ * Zebra shared memory RIB export
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _ZEBRA_RIB_EXPORT_H
+#define _ZEBRA_RIB_EXPORT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * "zebra rib-export FILE" keeps the selected FIB route of every
+ * destination in a lib/rib_export.h image.  Destinations are queued from
+ * the rib_update hook, like for the FPM, and written from an event once
+ * rib_process() is done with them.
+ */
+struct vty;
+
+/* stop exporting on shutdown, readers see the writer go away */
+extern void zebra_rib_export_finish(void);
+
+extern void zebra_rib_export_config_write(struct vty *vty);
+extern void zebra_rib_export_vty_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_RIB_EXPORT_H */
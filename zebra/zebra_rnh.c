@@ -149,6 +149,12 @@ struct rnh *zebra_add_rnh(struct prefix *p, vrf_id_t vrfid, safi_t safi,
 	}
 
 	table = get_rnh_table(vrfid, afi, safi);
+	if (!table && safi == SAFI_MULTICAST) {
+		struct zebra_vrf *zvrf = zebra_vrf_lookup_by_id(vrfid);
+
+		if (zvrf)
+			table = zebra_vrf_rnh_table_multicast(zvrf, afi);
+	}
 	if (!table) {
 		struct vrf *vrf = vrf_lookup_by_id(vrfid);
 
@@ -775,7 +781,7 @@ void zebra_evaluate_rnh(struct zebra_vrf *zvrf, afi_t afi, int force,
 	struct route_node *nrn;
 
 	rnh_table = get_rnh_table(zvrf->vrf->vrf_id, afi, safi);
-	if (!rnh_table) // unexpected
+	if (!rnh_table) /* no multicast registration yet */
 		return;
 
 	if (p) {
@@ -837,6 +843,7 @@ static void free_state(vrf_id_t vrf_id, struct route_entry *re,
 
 	/* free RE and nexthops */
 	zebra_nhg_free(re->nhe);
+	route_entry_fib_free(re);
 	XFREE(MTYPE_RE, re);
 }
 
@@ -865,10 +872,15 @@ static void copy_state(struct rnh *rnh, const struct route_entry *re,
 	/* Copy the 'fib' nexthops also, if present - we want to capture
 	 * the true installed nexthops.
 	 */
-	if (re->fib_ng.nexthop)
-		nexthop_group_copy(&state->fib_ng, &re->fib_ng);
-	if (re->fib_backup_ng.nexthop)
-		nexthop_group_copy(&state->fib_backup_ng, &re->fib_backup_ng);
+	if (re->fib) {
+		route_entry_fib_get(state);
+		if (re->fib->fib_ng.nexthop)
+			nexthop_group_copy(&state->fib->fib_ng,
+					   &re->fib->fib_ng);
+		if (re->fib->fib_backup_ng.nexthop)
+			nexthop_group_copy(&state->fib->fib_backup_ng,
+					   &re->fib->fib_backup_ng);
+	}
 
 	rnh->state = state;
 }
@@ -888,7 +900,7 @@ static struct nexthop *next_valid_primary_nh(struct route_entry *re,
 	/* Fib backup ng present: some backups are installed,
 	 * and we're configured for special handling if there are backups.
 	 */
-	if (rnh_hide_backups && (re->fib_backup_ng.nexthop != NULL))
+	if (rnh_hide_backups && (rib_get_fib_backup_nhg(re)->nexthop != NULL))
 		default_path = false;
 
 	/* Default path: no special handling, just using the 'installed'
@@ -1486,12 +1498,16 @@ static int zebra_client_cleanup_rnh(struct zserv *client)
 		if (zvrf) {
 			zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP,
 						 SAFI_UNICAST, client);
-			zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP,
-						 SAFI_MULTICAST, client);
+			if (zvrf->rnh_table_multicast[AFI_IP])
+				zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP,
+							 SAFI_MULTICAST,
+							 client);
 			zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP6,
 						 SAFI_UNICAST, client);
-			zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP6,
-						 SAFI_MULTICAST, client);
+			if (zvrf->rnh_table_multicast[AFI_IP6])
+				zebra_cleanup_rnh_client(zvrf_id(zvrf), AFI_IP6,
+							 SAFI_MULTICAST,
+							 client);
 		}
 	}
 
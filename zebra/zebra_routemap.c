@@ -44,6 +44,26 @@
 
 static uint32_t zebra_rmap_update_timer = ZEBRA_RMAP_DEFAULT_UPDATE_TIMER;
 static struct thread *zebra_t_rmap_update = NULL;
+
+/* VRFs with a protocol or nht route-map configured, route-map updates
+ * only need to look at these
+ */
+DECLARE_DLIST(zebra_rmap_vrfs, struct zebra_vrf, rmap_item);
+static struct zebra_rmap_vrfs_head zebra_rmap_vrfs =
+	INIT_DLIST(zebra_rmap_vrfs);
+
+static void zebra_rmap_vrf_ref(struct zebra_vrf *zvrf)
+{
+	if (zvrf->rmap_count++ == 0)
+		zebra_rmap_vrfs_add_tail(&zebra_rmap_vrfs, zvrf);
+}
+
+static void zebra_rmap_vrf_unref(struct zebra_vrf *zvrf)
+{
+	assert(zvrf->rmap_count);
+	if (--zvrf->rmap_count == 0)
+		zebra_rmap_vrfs_del(&zebra_rmap_vrfs, zvrf);
+}
 char *zebra_import_table_routemap[AFI_MAX][ZEBRA_KERNEL_TABLE_MAX];
 
 struct nh_rmap_obj {
@@ -313,7 +333,8 @@ static int ip_protocol_rm_add(struct zebra_vrf *zvrf, const char *rmap,
 			return CMD_SUCCESS;
 
 		XFREE(MTYPE_ROUTE_MAP_NAME, PROTO_RM_NAME(zvrf, afi, rtype));
-	}
+	} else
+		zebra_rmap_vrf_ref(zvrf);
 	route_map_counter_decrement(PROTO_RM_MAP(zvrf, afi, rtype));
 	PROTO_RM_NAME(zvrf, afi, rtype) = XSTRDUP(MTYPE_ROUTE_MAP_NAME, rmap);
 	PROTO_RM_MAP(zvrf, afi, rtype) =
@@ -361,6 +382,7 @@ static int ip_protocol_rm_del(struct zebra_vrf *zvrf, const char *rmap,
 						 rtype);
 		}
 		XFREE(MTYPE_ROUTE_MAP_NAME, PROTO_RM_NAME(zvrf, afi, rtype));
+		zebra_rmap_vrf_unref(zvrf);
 	}
 	return CMD_SUCCESS;
 }
@@ -374,7 +396,8 @@ static int ip_nht_rm_add(struct zebra_vrf *zvrf, const char *rmap, int rtype,
 			return CMD_SUCCESS;
 
 		XFREE(MTYPE_ROUTE_MAP_NAME, NHT_RM_NAME(zvrf, afi, rtype));
-	}
+	} else
+		zebra_rmap_vrf_ref(zvrf);
 	route_map_counter_decrement(NHT_RM_MAP(zvrf, afi, rtype));
 	NHT_RM_NAME(zvrf, afi, rtype) = XSTRDUP(MTYPE_ROUTE_MAP_NAME, rmap);
 	NHT_RM_MAP(zvrf, afi, rtype) =
@@ -406,6 +429,7 @@ static int ip_nht_rm_del(struct zebra_vrf *zvrf, const char *rmap, int rtype,
 			zebra_evaluate_rnh(zvrf, AFI_IP, 1, NULL, SAFI_UNICAST);
 		}
 		XFREE(MTYPE_ROUTE_MAP_NAME, NHT_RM_NAME(zvrf, afi, rtype));
+		zebra_rmap_vrf_unref(zvrf);
 	}
 	return CMD_SUCCESS;
 }
@@ -1546,15 +1570,11 @@ static void zebra_rib_table_rm_update(const char *rmap)
 {
 	int i = 0;
 	struct route_table *table;
-	struct vrf *vrf = NULL;
 	struct zebra_vrf *zvrf = NULL;
 	char *rmap_name;
 	struct route_map *old = NULL;
 
-	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
-		zvrf = vrf->info;
-		if (!zvrf)
-			continue;
+	frr_each (zebra_rmap_vrfs, &zebra_rmap_vrfs, zvrf) {
 		for (i = 0; i <= ZEBRA_ROUTE_MAX; i++) {
 			rmap_name = PROTO_RM_NAME(zvrf, AFI_IP, i);
 			if (rmap_name && (strcmp(rmap_name, rmap) == 0)) {
@@ -1624,17 +1644,15 @@ static void zebra_nht_rm_update(const char *rmap)
 {
 	int i = 0;
 	struct route_table *table;
-	struct vrf *vrf = NULL;
 	struct zebra_vrf *zvrf = NULL;
 	char *rmap_name;
-	char afi_ip = 0;
-	char afi_ipv6 = 0;
+	char afi_ip;
+	char afi_ipv6;
 	struct route_map *old = NULL;
 
-	RB_FOREACH (vrf, vrf_name_head, &vrfs_by_name) {
-		zvrf = vrf->info;
-		if (!zvrf)
-			continue;
+	frr_each (zebra_rmap_vrfs, &zebra_rmap_vrfs, zvrf) {
+		/* evaluate once per vrf */
+		afi_ip = afi_ipv6 = 0;
 		for (i = 0; i <= ZEBRA_ROUTE_MAX; i++) {
 			rmap_name = NHT_RM_NAME(zvrf, AFI_IP, i);
 			if (rmap_name && (strcmp(rmap_name, rmap) == 0)) {
@@ -1703,6 +1721,10 @@ static void zebra_nht_rm_update(const char *rmap)
 
 static void zebra_route_map_process_update_cb(char *rmap_name)
 {
+	/* re-applied with identical content, nothing to re-evaluate */
+	if (!route_map_content_changed(rmap_name))
+		return;
+
 	if (IS_ZEBRA_DEBUG_EVENT)
 		zlog_debug("Event handler for route-map: %s",
 			   rmap_name);
@@ -1908,6 +1930,11 @@ void zebra_routemap_vrf_delete(struct zebra_vrf *zvrf)
 				      NHT_RM_NAME(zvrf, afi, type));
 		}
 	}
+
+	if (zvrf->rmap_count) {
+		zebra_rmap_vrfs_del(&zebra_rmap_vrfs, zvrf);
+		zvrf->rmap_count = 0;
+	}
 }
 
 /* ip protocol configuration write function */
@@ -137,6 +137,7 @@ struct route_table *zebra_router_get_table(struct zebra_vrf *zvrf,
 	info->afi = afi;
 	info->safi = safi;
 	info->table_id = tableid;
+	rib_kernel_dests_init(&info->kernel_dests);
 	route_table_set_info(zrt->table, info);
 	zrt->table->cleanup = zebra_rtable_node_cleanup;
 
@@ -181,12 +182,13 @@ void zebra_router_sweep_nhgs(void)
 
 static void zebra_router_free_table(struct zebra_router_table *zrt)
 {
-	void *table_info;
+	struct rib_table_info *table_info;
 
 	table_info = route_table_get_info(zrt->table);
 	route_table_finish(zrt->table);
 	RB_REMOVE(zebra_router_table_head, &zrouter.tables, zrt);
 
+	rib_kernel_dests_fini(&table_info->kernel_dests);
 	XFREE(MTYPE_RIB_TABLE_INFO, table_info);
 	XFREE(MTYPE_ZEBRA_RT_TABLE, zrt);
 }
@@ -253,6 +255,8 @@ void zebra_router_terminate(void)
 	hash_clean(zrouter.nhgs, NULL);
 	hash_free(zrouter.nhgs);
 
+	hash_clean(zrouter.rules_unique_hash, NULL);
+	hash_free(zrouter.rules_unique_hash);
 	hash_clean(zrouter.rules_hash, zebra_pbr_rules_free);
 	hash_free(zrouter.rules_hash);
 
@@ -286,14 +290,12 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack)
 
 	zrouter.nhg_keep = ZEBRA_DEFAULT_NHG_KEEP_TIMER;
 
+	zrouter.ifstats_interval = ZEBRA_DEFAULT_IFSTATS_INTERVAL;
+
 	zebra_vxlan_init();
 	zebra_mlag_init();
 	zebra_neigh_init();
 
-	zrouter.rules_hash = hash_create_size(8, zebra_pbr_rules_hash_key,
-					      zebra_pbr_rules_hash_equal,
-					      "Rules Hash");
-
 	zrouter.ipset_hash =
 		hash_create_size(8, zebra_pbr_ipset_hash_key,
 				 zebra_pbr_ipset_hash_equal, "IPset Hash");
@@ -316,6 +318,9 @@ void zebra_router_init(bool asic_offload, bool notify_on_ack)
 	zrouter.rules_hash =
 		hash_create_size(8, zebra_pbr_rules_hash_key,
 				 zebra_pbr_rules_hash_equal, "Rules Hash");
+	zrouter.rules_unique_hash = hash_create_size(
+		8, zebra_pbr_rules_unique_key, zebra_pbr_rules_unique_equal,
+		"Rules Hash unique ID index");
 
 	zrouter.qdisc_hash =
 		hash_create_size(8, zebra_tc_qdisc_hash_key,
@@ -165,6 +165,8 @@ struct zebra_router {
 	struct hash *evpn_vlan_table;
 
 	struct hash *rules_hash;
+	/* rules_hash indexed by unique ID, interface and VRF */
+	struct hash *rules_unique_hash;
 
 	struct hash *ipset_hash;
 
@@ -242,6 +244,10 @@ struct zebra_router {
 #define ZEBRA_DEFAULT_NHG_KEEP_TIMER 180
 	uint32_t nhg_keep;
 
+	/* Interface statistics refresh, 0 to not collect them */
+#define ZEBRA_DEFAULT_IFSTATS_INTERVAL 10
+	uint32_t ifstats_interval;
+
 	/* Should we allow non FRR processes to delete our routes */
 	bool allow_delete;
 };
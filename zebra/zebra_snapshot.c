@@ -0,0 +1,535 @@
+/*
+ * Zebra RIB snapshot for warm restarts
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <zebra.h>
+
+#include <sys/mman.h>
+
+#include "command.h"
+#include "memory.h"
+#include "nexthop.h"
+#include "nexthop_group.h"
+#include "srcdest_table.h"
+#include "vty.h"
+#include "lib_errors.h"
+#include "zclient.h"
+
+#include "zebra/rib.h"
+#include "zebra/rt.h"
+#include "zebra/zebra_nhg.h"
+#include "zebra/zebra_snapshot.h"
+
+#include "zebra/zebra_snapshot_clippy.c"
+
+DEFINE_MTYPE_STATIC(ZEBRA, RIB_SNAPSHOT, "RIB snapshot free slots");
+
+#define ZEBRA_SNAP_MAGIC 0x5a534e50 /* "ZSNP" */
+/* bump when changing any of the structs below */
+#define ZEBRA_SNAP_VERSION 1
+
+/* routes with more nexthops or labels are not persisted */
+#define ZEBRA_SNAP_NEXTHOPS 4
+#define ZEBRA_SNAP_LABELS 2
+
+#define ZEBRA_SNAP_MIN_SLOTS 4096
+
+/* nexthop flags that are configuration rather than state */
+#define ZEBRA_SNAP_NH_FLAGS NEXTHOP_FLAG_ONLINK
+/* ... and those we can't represent */
+#define ZEBRA_SNAP_NH_UNSUPP                                                   \
+	(NEXTHOP_FLAG_HAS_BACKUP | NEXTHOP_FLAG_SRTE | NEXTHOP_FLAG_EVPN)
+
+struct zebra_snap_nh {
+	uint8_t type;
+	uint8_t flags;
+	uint8_t bh_type;
+	uint8_t weight;
+	uint8_t label_type;
+	uint8_t num_labels;
+	uint8_t pad[2];
+	vrf_id_t vrf_id;
+	ifindex_t ifindex;
+	union g_addr gate;
+	union g_addr src;
+	mpls_label_t labels[ZEBRA_SNAP_LABELS];
+};
+
+enum zebra_snap_state {
+	ZEBRA_SNAP_FREE = 0,
+	ZEBRA_SNAP_USED,
+};
+
+struct zebra_snap_rec {
+	/* only ZEBRA_SNAP_USED once everything else is written */
+	uint32_t state;
+	/* zebra_snap_hdr->boot this record was written in */
+	uint32_t boot;
+
+	uint8_t afi;
+	uint8_t safi;
+	uint8_t type;
+	uint8_t distance;
+	uint16_t instance;
+	uint8_t prefixlen;
+	uint8_t src_prefixlen;
+
+	vrf_id_t vrf_id;
+	uint32_t table;
+	uint32_t flags;
+	uint32_t metric;
+	uint32_t mtu;
+	route_tag_t tag;
+
+	union g_addr prefix;
+	struct in6_addr src_prefix;
+
+	uint32_t nexthop_num;
+	struct zebra_snap_nh nh[ZEBRA_SNAP_NEXTHOPS];
+};
+
+struct zebra_snap_hdr {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t rec_size;
+	uint32_t boot;
+	uint64_t nslots;
+};
+
+static struct zebra_snapshot {
+	const char *path;
+	int fd;
+
+	struct zebra_snap_hdr *hdr;
+	size_t map_size;
+
+	/* free slot numbers, as a stack */
+	uint32_t *free;
+	uint32_t nfree;
+
+	uint32_t used;
+	uint64_t loaded, skipped;
+} zsnap = {
+	.fd = -1,
+};
+
+/* slot numbers are 1-based, 0 in re->snap_slot means "not persisted" */
+static inline struct zebra_snap_rec *zsnap_rec(uint32_t slot)
+{
+	struct zebra_snap_rec *recs = (struct zebra_snap_rec *)(zsnap.hdr + 1);
+
+	return &recs[slot - 1];
+}
+
+static size_t zsnap_size(uint64_t nslots)
+{
+	return sizeof(struct zebra_snap_hdr) +
+	       nslots * sizeof(struct zebra_snap_rec);
+}
+
+static bool zsnap_map(uint64_t nslots)
+{
+	size_t size = zsnap_size(nslots);
+	void *map;
+
+	if (ftruncate(zsnap.fd, size) < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL,
+			     "RIB snapshot %s: ftruncate(): %m", zsnap.path);
+		return false;
+	}
+
+	map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, zsnap.fd, 0);
+	if (map == MAP_FAILED) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL, "RIB snapshot %s: mmap(): %m",
+			     zsnap.path);
+		return false;
+	}
+
+	if (zsnap.hdr)
+		munmap(zsnap.hdr, zsnap.map_size);
+	zsnap.hdr = map;
+	zsnap.map_size = size;
+	return true;
+}
+
+/* double the file, new slots go on the free stack highest first */
+static bool zsnap_grow(void)
+{
+	uint64_t old = zsnap.hdr->nslots, new = old * 2, slot;
+
+	if (new > UINT32_MAX || !zsnap_map(new))
+		return false;
+
+	zsnap.hdr->nslots = new;
+	zsnap.free = XREALLOC(MTYPE_RIB_SNAPSHOT, zsnap.free,
+			      new * sizeof(zsnap.free[0]));
+	for (slot = new; slot > old; slot--)
+		zsnap.free[zsnap.nfree++] = slot;
+	return true;
+}
+
+static void zsnap_release(uint32_t slot)
+{
+	zsnap_rec(slot)->state = ZEBRA_SNAP_FREE;
+	zsnap.free[zsnap.nfree++] = slot;
+	zsnap.used--;
+}
+
+static bool zsnap_fill_nh(struct zebra_snap_rec *rec,
+			  const struct nhg_hash_entry *nhe)
+{
+	const struct nexthop *nexthop;
+	struct zebra_snap_nh *snh;
+	unsigned int i;
+
+	rec->nexthop_num = 0;
+	if (!nhe)
+		return false;
+
+	for (nexthop = nhe->nhg.nexthop; nexthop; nexthop = nexthop->next) {
+		if (rec->nexthop_num == ZEBRA_SNAP_NEXTHOPS ||
+		    CHECK_FLAG(nexthop->flags, ZEBRA_SNAP_NH_UNSUPP) ||
+		    nexthop->nh_srv6 || nexthop->nh_encap_type == NET_VXLAN)
+			return false;
+		if (nexthop->nh_label &&
+		    nexthop->nh_label->num_labels > ZEBRA_SNAP_LABELS)
+			return false;
+
+		snh = &rec->nh[rec->nexthop_num++];
+		memset(snh, 0, sizeof(*snh));
+		snh->type = nexthop->type;
+		snh->flags = nexthop->flags & ZEBRA_SNAP_NH_FLAGS;
+		snh->weight = nexthop->weight;
+		snh->vrf_id = nexthop->vrf_id;
+		snh->ifindex = nexthop->ifindex;
+		if (nexthop->type == NEXTHOP_TYPE_BLACKHOLE)
+			snh->bh_type = nexthop->bh_type;
+		else
+			snh->gate = nexthop->gate;
+		snh->src = nexthop->src;
+
+		if (nexthop->nh_label) {
+			snh->label_type = nexthop->nh_label_type;
+			snh->num_labels = nexthop->nh_label->num_labels;
+			for (i = 0; i < snh->num_labels; i++)
+				snh->labels[i] = nexthop->nh_label->label[i];
+		}
+	}
+
+	return rec->nexthop_num > 0;
+}
+
+static bool zsnap_persist(const struct route_entry *re)
+{
+	/* kernel & connected routes are re-read from the kernel, table
+	 * imports are re-created from the configuration
+	 */
+	return !RIB_SYSTEM_ROUTE(re) && re->type != ZEBRA_ROUTE_TABLE;
+}
+
+void zebra_snapshot_route_add(struct route_node *rn, struct route_entry *re)
+{
+	const struct prefix *p, *src_p;
+	struct rib_table_info *info;
+	struct zebra_snap_rec *rec;
+	uint32_t slot;
+
+	if (!zsnap.hdr || re->snap_slot || !zsnap_persist(re))
+		return;
+
+	if (!zsnap.nfree && !zsnap_grow()) {
+		zsnap.skipped++;
+		return;
+	}
+
+	slot = zsnap.free[zsnap.nfree - 1];
+	rec = zsnap_rec(slot);
+
+	srcdest_rnode_prefixes(rn, &p, &src_p);
+	info = srcdest_rnode_table_info(rn);
+
+	rec->state = ZEBRA_SNAP_FREE;
+	rec->boot = zsnap.hdr->boot;
+	rec->afi = info->afi;
+	rec->safi = info->safi;
+	rec->type = re->type;
+	rec->distance = re->distance;
+	rec->instance = re->instance;
+	rec->vrf_id = re->vrf_id;
+	rec->table = re->table;
+	rec->flags = re->flags;
+	rec->metric = re->metric;
+	rec->mtu = re->mtu;
+	rec->tag = re->tag;
+	rec->prefixlen = p->prefixlen;
+	memcpy(&rec->prefix, &p->u.prefix, prefix_blen(p));
+	rec->src_prefixlen = src_p ? src_p->prefixlen : 0;
+	if (src_p)
+		rec->src_prefix = src_p->u.prefix6;
+
+	if (!zsnap_fill_nh(rec, re->nhe)) {
+		zsnap.skipped++;
+		return;
+	}
+
+	/* a torn record (zebra killed right here) stays free */
+	atomic_thread_fence(memory_order_release);
+	rec->state = ZEBRA_SNAP_USED;
+
+	zsnap.nfree--;
+	zsnap.used++;
+	re->snap_slot = slot;
+}
+
+/* the route's nexthop group was replaced (proto-owned NHGs) */
+void zebra_snapshot_route_update(struct route_entry *re)
+{
+	struct zebra_snap_rec *rec;
+
+	if (!zsnap.hdr || !re->snap_slot)
+		return;
+
+	rec = zsnap_rec(re->snap_slot);
+	rec->state = ZEBRA_SNAP_FREE;
+	if (!zsnap_fill_nh(rec, re->nhe)) {
+		zsnap.free[zsnap.nfree++] = re->snap_slot;
+		zsnap.used--;
+		zsnap.skipped++;
+		re->snap_slot = 0;
+		return;
+	}
+
+	atomic_thread_fence(memory_order_release);
+	rec->state = ZEBRA_SNAP_USED;
+}
+
+void zebra_snapshot_route_del(struct route_entry *re)
+{
+	if (!zsnap.hdr || !re->snap_slot)
+		return;
+
+	zsnap_release(re->snap_slot);
+	re->snap_slot = 0;
+}
+
+static void zsnap_load_rec(const struct zebra_snap_rec *rec)
+{
+	const struct zebra_snap_nh *snh;
+	struct nexthop_group *ng;
+	struct nexthop *nexthop;
+	struct route_entry *re;
+	struct prefix p = {};
+	struct prefix_ipv6 src_p = {};
+	unsigned int i;
+
+	if ((rec->afi != AFI_IP && rec->afi != AFI_IP6) ||
+	    rec->safi >= SAFI_MAX || rec->nexthop_num == 0 ||
+	    rec->nexthop_num > ZEBRA_SNAP_NEXTHOPS)
+		return;
+
+	p.family = afi2family(rec->afi);
+	p.prefixlen = rec->prefixlen;
+	if (p.prefixlen > prefix_blen(&p) * 8)
+		return;
+	memcpy(&p.u.prefix, &rec->prefix, prefix_blen(&p));
+
+	if (rec->src_prefixlen) {
+		if (rec->afi != AFI_IP6 || rec->src_prefixlen > IPV6_MAX_BITLEN)
+			return;
+		src_p.family = AF_INET6;
+		src_p.prefixlen = rec->src_prefixlen;
+		src_p.prefix = rec->src_prefix;
+	}
+
+	ng = nexthop_group_new();
+	for (i = 0; i < rec->nexthop_num; i++) {
+		snh = &rec->nh[i];
+
+		nexthop = nexthop_new();
+		nexthop->type = snh->type;
+		nexthop->flags = snh->flags & ZEBRA_SNAP_NH_FLAGS;
+		nexthop->weight = snh->weight;
+		nexthop->vrf_id = snh->vrf_id;
+		nexthop->ifindex = snh->ifindex;
+		if (snh->type == NEXTHOP_TYPE_BLACKHOLE)
+			nexthop->bh_type = snh->bh_type;
+		else
+			nexthop->gate = snh->gate;
+		nexthop->src = snh->src;
+		if (snh->num_labels && snh->num_labels <= ZEBRA_SNAP_LABELS)
+			nexthop_add_labels(nexthop, snh->label_type,
+					   snh->num_labels, snh->labels);
+
+		nexthop_group_add_sorted(ng, nexthop);
+	}
+
+	/* SELFROUTE and the uptime make rib_sweep_table() treat these like
+	 * routes read from the kernel: replaced when the client re-adds
+	 * them, removed when the -K timer fires otherwise.
+	 */
+	re = zebra_rib_route_entry_new(rec->vrf_id, rec->type, rec->instance,
+				       rec->flags | ZEBRA_FLAG_SELFROUTE, 0,
+				       rec->table, rec->metric, rec->mtu,
+				       rec->distance, rec->tag);
+
+	if (rib_add_multipath(rec->afi, rec->safi, &p,
+			      rec->src_prefixlen ? &src_p : NULL, re, ng,
+			      true) >= 0)
+		zsnap.loaded++;
+
+	nexthop_group_delete(&ng);
+}
+
+/* routes from the previous run are re-added to the RIB, which writes them
+ * out again as new records;  the old records are kept until the sweep so
+ * the snapshot survives zebra dying again before then.
+ */
+static void zsnap_load(void)
+{
+	struct zebra_snap_rec *rec;
+	uint64_t slot;
+
+	for (slot = zsnap.hdr->nslots; slot > 0; slot--) {
+		rec = zsnap_rec(slot);
+
+		if (rec->state != ZEBRA_SNAP_USED) {
+			zsnap.free[zsnap.nfree++] = slot;
+			continue;
+		}
+
+		zsnap.used++;
+		zsnap_load_rec(rec);
+	}
+}
+
+static bool zsnap_hdr_valid(size_t size)
+{
+	const struct zebra_snap_hdr *hdr = zsnap.hdr;
+
+	return hdr->magic == ZEBRA_SNAP_MAGIC &&
+	       hdr->version == ZEBRA_SNAP_VERSION &&
+	       hdr->rec_size == sizeof(struct zebra_snap_rec) &&
+	       hdr->nslots >= ZEBRA_SNAP_MIN_SLOTS &&
+	       hdr->nslots <= UINT32_MAX && zsnap_size(hdr->nslots) == size;
+}
+
+void zebra_snapshot_init(const char *path)
+{
+	struct stat st;
+	uint64_t nslots = ZEBRA_SNAP_MIN_SLOTS;
+	bool valid = false;
+
+	zsnap.path = path;
+	zsnap.fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+	if (zsnap.fd < 0) {
+		flog_err_sys(EC_LIB_SYSTEM_CALL, "RIB snapshot %s: open(): %m",
+			     path);
+		return;
+	}
+
+	if (fstat(zsnap.fd, &st) == 0 &&
+	    (size_t)st.st_size >= zsnap_size(ZEBRA_SNAP_MIN_SLOTS)) {
+		nslots = (st.st_size - sizeof(struct zebra_snap_hdr)) /
+			 sizeof(struct zebra_snap_rec);
+		if (zsnap_map(nslots))
+			valid = zsnap_hdr_valid(st.st_size);
+	}
+
+	if (!valid) {
+		if (zsnap.hdr)
+			zlog_warn("RIB snapshot %s: unusable, starting over",
+				  path);
+
+		nslots = ZEBRA_SNAP_MIN_SLOTS;
+		if (ftruncate(zsnap.fd, 0) < 0 || !zsnap_map(nslots)) {
+			zebra_snapshot_finish();
+			return;
+		}
+		zsnap.hdr->magic = ZEBRA_SNAP_MAGIC;
+		zsnap.hdr->version = ZEBRA_SNAP_VERSION;
+		zsnap.hdr->rec_size = sizeof(struct zebra_snap_rec);
+		zsnap.hdr->nslots = nslots;
+	}
+
+	zsnap.hdr->boot++;
+	zsnap.free = XCALLOC(MTYPE_RIB_SNAPSHOT,
+			     zsnap.hdr->nslots * sizeof(zsnap.free[0]));
+	zsnap_load();
+
+	zlog_info("RIB snapshot %s: %" PRIu64 " routes restored", path,
+		  zsnap.loaded);
+}
+
+void zebra_snapshot_sweep(void)
+{
+	struct zebra_snap_rec *rec;
+	uint64_t slot;
+
+	if (!zsnap.hdr)
+		return;
+
+	for (slot = 1; slot <= zsnap.hdr->nslots; slot++) {
+		rec = zsnap_rec(slot);
+		if (rec->state == ZEBRA_SNAP_USED &&
+		    rec->boot != zsnap.hdr->boot)
+			zsnap_release(slot);
+	}
+}
+
+void zebra_snapshot_finish(void)
+{
+	if (zsnap.hdr) {
+		msync(zsnap.hdr, zsnap.map_size, MS_SYNC);
+		munmap(zsnap.hdr, zsnap.map_size);
+		zsnap.hdr = NULL;
+	}
+	if (zsnap.fd >= 0) {
+		close(zsnap.fd);
+		zsnap.fd = -1;
+	}
+	XFREE(MTYPE_RIB_SNAPSHOT, zsnap.free);
+	zsnap.nfree = 0;
+}
+
+DEFPY (show_zebra_rib_snapshot,
+       show_zebra_rib_snapshot_cmd,
+       "show zebra rib-snapshot",
+       SHOW_STR
+       ZEBRA_STR
+       "RIB snapshot for warm restarts\n")
+{
+	if (!zsnap.hdr) {
+		vty_out(vty, "RIB snapshot is not enabled\n");
+		return CMD_SUCCESS;
+	}
+
+	vty_out(vty, "RIB snapshot %s, boot %u\n", zsnap.path,
+		zsnap.hdr->boot);
+	vty_out(vty, "  %u of %" PRIu64 " records in use (%zu bytes each)\n",
+		zsnap.used, zsnap.hdr->nslots, sizeof(struct zebra_snap_rec));
+	vty_out(vty, "  %" PRIu64 " routes restored at startup\n",
+		zsnap.loaded);
+	vty_out(vty, "  %" PRIu64 " routes not persisted\n", zsnap.skipped);
+
+	return CMD_SUCCESS;
+}
+
+void zebra_snapshot_vty_init(void)
+{
+	install_element(VIEW_NODE, &show_zebra_rib_snapshot_cmd);
+}
@@ -0,0 +1,60 @@
+/*
+ * Zebra RIB snapshot for warm restarts
+ * Copyright (C) 2022 Network Device Education Foundation, Inc. ("NetDEF")
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; see the file COPYING; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef _ZEBRA_SNAPSHOT_H
+#define _ZEBRA_SNAPSHOT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct route_node;
+struct route_entry;
+
+/*
+ * The snapshot is an mmap()ed file of fixed size records, one per route
+ * entry owned by a client (protocol daemon or static).  Records are
+ * updated in place as routes are linked to and unlinked from the RIB, so
+ * the file is current even if zebra is killed.
+ *
+ * At startup, the routes in the snapshot are added back to the RIB with
+ * ZEBRA_FLAG_SELFROUTE, just like routes zebra finds in the kernel from
+ * a previous run, but with the client's original type, instance,
+ * distance, metric, tag and (unresolved) nexthops.  Clients re-sending
+ * their routes replace them; whatever is left is swept with the -K timer.
+ */
+extern void zebra_snapshot_init(const char *path);
+/* stop updating the file, before zebra tears down the RIB on shutdown */
+extern void zebra_snapshot_finish(void);
+
+extern void zebra_snapshot_route_add(struct route_node *rn,
+				     struct route_entry *re);
+extern void zebra_snapshot_route_update(struct route_entry *re);
+extern void zebra_snapshot_route_del(struct route_entry *re);
+
+/* free records of routes loaded at startup that were not re-added */
+extern void zebra_snapshot_sweep(void);
+
+extern void zebra_snapshot_vty_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _ZEBRA_SNAPSHOT_H */
@@ -255,44 +255,176 @@ static int proto_trans(int type)
 	}
 }
 
-static void check_replace(struct route_node *np2, struct route_entry *re2,
-			  struct route_node **np, struct route_entry **re)
+DEFINE_MTYPE_STATIC(ZEBRA, SNMP_IPFW_INDEX, "SNMP ipForwardTable index");
+
+/*
+ * ipForwardTable rows in OID order.  Finding the next row used to take a
+ * walk of the whole table, for every GETNEXT.  The index only holds keys,
+ * rows are looked up in the RIB again before use and vanished ones are
+ * skipped; RIB changes mark it stale, and a stale index is rebuilt at most
+ * once per IPFW_INDEX_HOLD seconds so that route churn doesn't turn every
+ * request into a rebuild.  New routes can thus take that long to show.
+ */
+#define IPFW_INDEX_HOLD 1
+
+struct ipfw_ent {
+	struct in_addr dest;
+	struct in_addr nexthop;
+	int proto;
+	uint8_t prefixlen;
+	uint8_t type;
+};
+
+static struct ipfw_index {
+	struct ipfw_ent *ent;
+	uint32_t count;
+	uint32_t size;
+	bool built;
+	bool stale;
+	time_t built_at;
+} ipfw_index;
+
+/* order of the INDEX: ipForwardDest, ipForwardProto, ipForwardPolicy
+ * (always 0 here), ipForwardNextHop
+ */
+static int ipfw_key_cmp(const struct ipfw_ent *ent,
+			const struct in_addr *dest, int proto, int policy,
+			const struct in_addr *nexthop)
 {
-	int proto, proto2;
+	int ret;
+
+	ret = memcmp(&ent->dest, dest, sizeof(*dest));
+	if (ret)
+		return ret;
+	if (ent->proto != proto)
+		return ent->proto < proto ? -1 : 1;
+	if (policy)
+		return -1;
+	return memcmp(&ent->nexthop, nexthop, sizeof(*nexthop));
+}
 
-	if (!*np) {
-		*np = np2;
-		*re = re2;
+static int ipfw_ent_cmp(const void *a, const void *b)
+{
+	const struct ipfw_ent *e1 = a, *e2 = b;
+	int ret;
+
+	ret = ipfw_key_cmp(e1, &e2->dest, e2->proto, 0, &e2->nexthop);
+	if (ret)
+		return ret;
+	if (e1->prefixlen != e2->prefixlen)
+		return e1->prefixlen < e2->prefixlen ? -1 : 1;
+	return e1->type < e2->type ? -1 : (e1->type > e2->type);
+}
+
+static void ipfw_index_build(struct route_table *table)
+{
+	struct route_node *rn;
+	struct route_entry *re;
+
+	if (ipfw_index.built && (!ipfw_index.stale
+				 || monotime(NULL) - ipfw_index.built_at
+					    < IPFW_INDEX_HOLD))
 		return;
+
+	ipfw_index.count = 0;
+	for (rn = route_top(table); rn; rn = route_next(rn)) {
+		RNODE_FOREACH_RE (rn, re) {
+			struct ipfw_ent *ent;
+
+			if (!re->nhe || !re->nhe->nhg.nexthop)
+				continue;
+
+			if (ipfw_index.count == ipfw_index.size) {
+				ipfw_index.size = MAX(64, ipfw_index.size * 2);
+				ipfw_index.ent = XREALLOC(
+					MTYPE_SNMP_IPFW_INDEX, ipfw_index.ent,
+					ipfw_index.size
+						* sizeof(*ipfw_index.ent));
+			}
+
+			ent = &ipfw_index.ent[ipfw_index.count++];
+			ent->dest = rn->p.u.prefix4;
+			ent->prefixlen = rn->p.prefixlen;
+			ent->type = re->type;
+			ent->proto = proto_trans(re->type);
+			ent->nexthop = re->nhe->nhg.nexthop->gate.ipv4;
+		}
 	}
 
-	if (prefix_cmp(&(*np)->p, &np2->p) < 0)
-		return;
-	if (prefix_cmp(&(*np)->p, &np2->p) > 0) {
-		*np = np2;
-		*re = re2;
-		return;
+	if (ipfw_index.count > 1)
+		qsort(ipfw_index.ent, ipfw_index.count,
+		      sizeof(*ipfw_index.ent), ipfw_ent_cmp);
+
+	ipfw_index.built = true;
+	ipfw_index.stale = false;
+	ipfw_index.built_at = monotime(NULL);
+}
+
+/* first entry not below the key */
+static uint32_t ipfw_index_lower(const struct in_addr *dest, int proto,
+				 int policy, const struct in_addr *nexthop)
+{
+	uint32_t lo = 0, hi = ipfw_index.count;
+
+	while (lo < hi) {
+		uint32_t mid = lo + (hi - lo) / 2;
+
+		if (ipfw_key_cmp(&ipfw_index.ent[mid], dest, proto, policy,
+				 nexthop)
+		    < 0)
+			lo = mid + 1;
+		else
+			hi = mid;
 	}
 
-	proto = proto_trans((*re)->type);
-	proto2 = proto_trans(re2->type);
+	return lo;
+}
 
-	if (proto2 > proto)
-		return;
-	if (proto2 < proto) {
-		*np = np2;
+/* the RIB entry an index entry stands for, if it is still there */
+static bool ipfw_ent_resolve(struct route_table *table,
+			     const struct ipfw_ent *ent,
+			     struct route_node **np, struct route_entry **re)
+{
+	struct prefix p = {};
+	struct route_node *rn;
+	struct route_entry *re2;
+
+	p.family = AF_INET;
+	p.prefixlen = ent->prefixlen;
+	p.u.prefix4 = ent->dest;
+
+	rn = route_node_lookup(table, &p);
+	if (!rn)
+		return false;
+	route_unlock_node(rn);
+
+	RNODE_FOREACH_RE (rn, re2) {
+		if (re2->type != ent->type || !re2->nhe
+		    || !re2->nhe->nhg.nexthop)
+			continue;
+		if (re2->nhe->nhg.nexthop->gate.ipv4.s_addr
+		    != ent->nexthop.s_addr)
+			continue;
+
+		*np = rn;
 		*re = re2;
-		return;
+		return true;
 	}
 
-	if (in_addr_cmp((uint8_t *)&(*re)->nhe->nhg.nexthop->gate.ipv4,
-			(uint8_t *)&re2->nhe->nhg.nexthop->gate.ipv4)
-	    <= 0)
-		return;
+	return false;
+}
 
-	*np = np2;
-	*re = re2;
-	return;
+static int ipfw_index_stale(struct route_node *rn, const char *reason)
+{
+	if (srcdest_rnode_table(rn)
+	    == zebra_vrf_table(AFI_IP, SAFI_UNICAST, VRF_DEFAULT))
+		ipfw_index.stale = true;
+	return 0;
+}
+
+static int ipfw_index_remove(struct route_node *rn)
+{
+	return ipfw_index_stale(rn, NULL);
 }
 
 static void get_fwtable_route_node(struct variable *v, oid objid[],
@@ -302,8 +434,7 @@ static void get_fwtable_route_node(struct variable *v, oid objid[],
 {
 	struct in_addr dest;
 	struct route_table *table;
-	struct route_node *np2;
-	struct route_entry *re2;
+	uint32_t idx;
 	int proto;
 	int policy;
 	struct in_addr nexthop;
@@ -362,58 +493,30 @@ static void get_fwtable_route_node(struct variable *v, oid objid[],
 			return;
 	}
 
-	/* For exact: search matching entry in rib table. */
+	ipfw_index_build(table);
+	idx = ipfw_index_lower(&dest, proto, policy, &nexthop);
+
+	/* For exact: an index entry with the same key. */
 
 	if (exact) {
 		if (policy) /* Not supported (yet?) */
 			return;
-		for (*np = route_top(table); *np; *np = route_next(*np)) {
-			if (!in_addr_cmp(&(*np)->p.u.prefix,
-					 (uint8_t *)&dest)) {
-				RNODE_FOREACH_RE (*np, *re) {
-					if (!in_addr_cmp((uint8_t *)&(*re)->nhe
-							 ->nhg.nexthop
-							 ->gate.ipv4,
-							 (uint8_t *)&nexthop))
-						if (proto
-						    == proto_trans((*re)->type))
-							return;
-				}
-			}
+		for (; idx < ipfw_index.count; idx++) {
+			if (ipfw_key_cmp(&ipfw_index.ent[idx], &dest, proto,
+					 policy, &nexthop))
+				break;
+			if (ipfw_ent_resolve(table, &ipfw_index.ent[idx], np,
+					     re))
+				return;
 		}
 		return;
 	}
 
 	/* Search next best entry */
 
-	for (np2 = route_top(table); np2; np2 = route_next(np2)) {
-
-		/* Check destination first */
-		if (in_addr_cmp(&np2->p.u.prefix, (uint8_t *)&dest) > 0)
-			RNODE_FOREACH_RE (np2, re2) {
-				check_replace(np2, re2, np, re);
-			}
-
-		if (in_addr_cmp(&np2->p.u.prefix, (uint8_t *)&dest)
-		    == 0) { /* have to look at each re individually */
-			RNODE_FOREACH_RE (np2, re2) {
-				int proto2, policy2;
-
-				proto2 = proto_trans(re2->type);
-				policy2 = 0;
-
-				if ((policy < policy2)
-				    || ((policy == policy2) && (proto < proto2))
-				    || ((policy == policy2) && (proto == proto2)
-					&& (in_addr_cmp(
-						    (uint8_t *)&re2->nhe
-						    ->nhg.nexthop->gate.ipv4,
-						    (uint8_t *)&nexthop)
-					    >= 0)))
-					check_replace(np2, re2, np, re);
-			}
-		}
-	}
+	for (; idx < ipfw_index.count; idx++)
+		if (ipfw_ent_resolve(table, &ipfw_index.ent[idx], np, re))
+			break;
 
 	if (!*re)
 		return;
@@ -560,6 +663,8 @@ static int zebra_snmp_init(struct thread_master *tm)
 
 static int zebra_snmp_module_init(void)
 {
+	hook_register(rib_update, ipfw_index_stale);
+	hook_register(rib_shutdown, ipfw_index_remove);
 	hook_register(frr_late_init, zebra_snmp_init);
 	return 0;
 }
@@ -100,37 +100,6 @@ bool zebra_tc_qdisc_hash_equal(const void *arg1, const void *arg2)
 	return true;
 }
 
-struct tc_qdisc_ifindex_lookup {
-	struct zebra_tc_qdisc *qdisc;
-	ifindex_t ifindex;
-};
-
-
-static int tc_qdisc_lookup_ifindex_walker(struct hash_bucket *b, void *data)
-{
-	struct tc_qdisc_ifindex_lookup *lookup = data;
-	struct zebra_tc_qdisc *qdisc = b->data;
-
-	if (lookup->ifindex == qdisc->qdisc.ifindex) {
-		lookup->qdisc = qdisc;
-		return HASHWALK_ABORT;
-	}
-
-	return HASHWALK_CONTINUE;
-}
-
-static struct zebra_tc_qdisc *
-tc_qdisc_lookup_ifindex(struct zebra_tc_qdisc *qdisc)
-{
-	struct tc_qdisc_ifindex_lookup lookup;
-
-	lookup.ifindex = qdisc->qdisc.ifindex;
-	lookup.qdisc = NULL;
-	hash_walk(zrouter.rules_hash, &tc_qdisc_lookup_ifindex_walker, &lookup);
-
-	return lookup.qdisc;
-}
-
 static void *tc_qdisc_alloc_intern(void *arg)
 {
 	struct zebra_tc_qdisc *ztq;
@@ -182,10 +151,12 @@ void zebra_tc_qdisc_install(struct zebra_tc_qdisc *qdisc)
 	struct zebra_tc_qdisc *old;
 	struct zebra_tc_qdisc *new;
 
-	found = tc_qdisc_lookup_ifindex(qdisc);
+	/* one qdisc per interface, the hash is keyed by ifindex */
+	found = hash_lookup(zrouter.qdisc_hash, qdisc);
 
 	if (found) {
-		if (!zebra_tc_qdisc_hash_equal(qdisc, found)) {
+		if (memcmp(&qdisc->qdisc, &found->qdisc,
+			   sizeof(qdisc->qdisc))) {
 			old = tc_qdisc_release(found, false);
 			(void)dplane_tc_qdisc_uninstall(old);
 			new = hash_get(zrouter.qdisc_hash, qdisc,
@@ -298,17 +269,22 @@ void zebra_tc_class_add(struct zebra_tc_class *class)
 	/*
 	 * We find the class in the hash by (ifindex, handle) directly, and by
 	 * testing their deep equality to seek out whether it's an update.
-	 *
-	 * Currently deep equality is not checked since it will be okay to
-	 * update the totally same class again.
+	 * Clients tend to resend their whole configuration, re-adding a class
+	 * that is already there as it is does not go to the kernel again.
 	 */
 	found = hash_lookup(zrouter.class_hash, class);
-	new = hash_get(zrouter.class_hash, class, tc_class_alloc_intern);
+	if (found) {
+		if (!memcmp(&found->class, &class->class, sizeof(class->class)))
+			return;
+
+		found->sock = class->sock;
+		found->class = class->class;
+		(void)dplane_tc_class_update(found);
+		return;
+	}
 
-	if (found)
-		(void)dplane_tc_class_update(new);
-	else
-		(void)dplane_tc_class_add(new);
+	new = hash_get(zrouter.class_hash, class, tc_class_alloc_intern);
+	(void)dplane_tc_class_add(new);
 }
 
 void zebra_tc_class_delete(struct zebra_tc_class *class)
@@ -418,18 +394,26 @@ void zebra_tc_filter_add(struct zebra_tc_filter *filter)
 	struct zebra_tc_filter *found;
 	struct zebra_tc_filter *new;
 
+	/* same as classes, identical filters are not sent again */
 	found = hash_lookup(zrouter.filter_hash, filter);
-	new = hash_get(zrouter.filter_hash, filter, tc_filter_alloc_intern);
+	if (found) {
+		if (!memcmp(&found->filter, &filter->filter,
+			    sizeof(filter->filter)))
+			return;
+
+		found->sock = filter->sock;
+		found->filter = filter->filter;
+		(void)dplane_tc_filter_update(found);
+		return;
+	}
 
-	if (found)
-		(void)dplane_tc_filter_update(new);
-	else
-		(void)dplane_tc_filter_add(new);
+	new = hash_get(zrouter.filter_hash, filter, tc_filter_alloc_intern);
+	(void)dplane_tc_filter_add(new);
 }
 
 void zebra_tc_filter_delete(struct zebra_tc_filter *filter)
 {
-	if (IS_ZEBRA_DEBUG_PBR)
+	if (IS_ZEBRA_DEBUG_TC)
 		zlog_debug(
 			"%s: delete tc filter ifindex %d priority %u handle %08x kind %s",
 			__func__, filter->filter.ifindex,
@@ -442,3 +426,44 @@ void zebra_tc_filter_delete(struct zebra_tc_filter *filter)
 		zlog_debug("%s: tc filter being deleted we know nothing about",
 			   __func__);
 }
+
+/*
+ * Handle results from the dataplane.  The kernel is programmed
+ * asynchronously, in batches; an object the kernel refused to install is
+ * forgotten, so that it is not skipped as a duplicate when the client
+ * sends it again.
+ */
+void zebra_tc_dplane_result(struct zebra_dplane_ctx *ctx)
+{
+	enum dplane_op_e op = dplane_ctx_get_op(ctx);
+	struct zebra_tc_qdisc qdisc = {};
+	struct zebra_tc_class class = {};
+	struct zebra_tc_filter filter = {};
+
+	if (dplane_ctx_get_status(ctx) == ZEBRA_DPLANE_REQUEST_SUCCESS)
+		return;
+
+	zlog_warn("%s: %s failed on ifindex %u", __func__, dplane_op2str(op),
+		  dplane_ctx_get_ifindex(ctx));
+
+	switch (op) {
+	case DPLANE_OP_TC_QDISC_INSTALL:
+		qdisc.qdisc.ifindex = dplane_ctx_get_ifindex(ctx);
+		tc_qdisc_release(&qdisc, true);
+		break;
+	case DPLANE_OP_TC_CLASS_ADD:
+	case DPLANE_OP_TC_CLASS_UPDATE:
+		class.class.ifindex = dplane_ctx_get_ifindex(ctx);
+		class.class.handle = dplane_ctx_tc_class_get_handle(ctx);
+		tc_class_release(&class, true);
+		break;
+	case DPLANE_OP_TC_FILTER_ADD:
+	case DPLANE_OP_TC_FILTER_UPDATE:
+		filter.filter.ifindex = dplane_ctx_get_ifindex(ctx);
+		filter.filter.handle = dplane_ctx_tc_filter_get_handle(ctx);
+		tc_filter_release(&filter, true);
+		break;
+	default:
+		break;
+	}
+}
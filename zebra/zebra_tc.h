@@ -72,6 +72,9 @@ bool zebra_tc_filter_hash_equal(const void *arg1, const void *arg2);
 
 void kernel_read_tc_qdisc(struct zebra_ns *zns);
 
+struct zebra_dplane_ctx;
+void zebra_tc_dplane_result(struct zebra_dplane_ctx *ctx);
+
 #ifdef __cplusplus
 }
 #endif
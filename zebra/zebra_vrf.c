@@ -29,6 +29,7 @@
 #include "memory.h"
 #include "srcdest_table.h"
 #include "vrf.h"
+#include "vrf_int.h"
 #include "vty.h"
 
 #include "zebra/zebra_router.h"
@@ -156,9 +157,7 @@ static int zebra_vrf_enable(struct vrf *vrf)
 		table->cleanup = zebra_rnhtable_node_cleanup;
 		zvrf->rnh_table[afi] = table;
 
-		table = route_table_init();
-		table->cleanup = zebra_rnhtable_node_cleanup;
-		zvrf->rnh_table_multicast[afi] = table;
+		/* the multicast one is created on first registration */
 	}
 
 	/* Kick off any VxLAN-EVPN processing. */
@@ -410,6 +409,23 @@ struct zebra_vrf *zebra_vrf_lookup_by_name(const char *name)
 	return NULL;
 }
 
+/* Nexthop tracking table for multicast in an enabled VRF, few VRFs ever
+ * see such a registration so it is only created when needed.
+ */
+struct route_table *zebra_vrf_rnh_table_multicast(struct zebra_vrf *zvrf,
+						  afi_t afi)
+{
+	struct route_table *table = zvrf->rnh_table_multicast[afi];
+
+	if (!table && zvrf->rnh_table[afi]) {
+		table = route_table_init();
+		table->cleanup = zebra_rnhtable_node_cleanup;
+		zvrf->rnh_table_multicast[afi] = table;
+	}
+
+	return table;
+}
+
 /* Lookup the routing table in an enabled VRF. */
 struct route_table *zebra_vrf_table(afi_t afi, safi_t safi, vrf_id_t vrf_id)
 {
@@ -556,10 +572,7 @@ static void vrf_update_vrf_id(ns_id_t ns_id, void *opaqueptr)
 	old_vrf_id = vrf->vrf_id;
 	if (vrf_id == vrf->vrf_id)
 		return;
-	if (vrf->vrf_id != VRF_UNKNOWN)
-		RB_REMOVE(vrf_id_head, &vrfs_by_id, vrf);
-	vrf->vrf_id = vrf_id;
-	RB_INSERT(vrf_id_head, &vrfs_by_id, vrf);
+	vrf_set_id(vrf, vrf_id);
 	if (old_vrf_id == VRF_UNKNOWN)
 		vrf_enable(vrf);
 }
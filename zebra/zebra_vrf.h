@@ -45,6 +45,7 @@ struct zebra_rmap {
 };
 
 PREDECL_RBTREE_UNIQ(otable);
+PREDECL_DLIST(zebra_rmap_vrfs);
 
 struct other_route_table {
 	struct otable_item next;
@@ -124,6 +125,11 @@ struct zebra_vrf {
 
 	struct zebra_rmap proto_rm[AFI_MAX][ZEBRA_ROUTE_MAX + 1];
 	struct zebra_rmap nht_rm[AFI_MAX][ZEBRA_ROUTE_MAX + 1];
+	/* Number of the above that are configured, the vrf is on the
+	 * route-map update list while this is non-zero
+	 */
+	uint16_t rmap_count;
+	struct zebra_rmap_vrfs_item rmap_item;
 
 	/* MPLS processing flags */
 	uint16_t mpls_flags;
@@ -254,6 +260,8 @@ extern struct zebra_vrf *zebra_vrf_lookup_by_id(vrf_id_t vrf_id);
 extern struct zebra_vrf *zebra_vrf_lookup_by_name(const char *);
 extern struct zebra_vrf *zebra_vrf_alloc(struct vrf *vrf);
 extern struct route_table *zebra_vrf_table(afi_t, safi_t, vrf_id_t);
+extern struct route_table *zebra_vrf_rnh_table_multicast(struct zebra_vrf *zvrf,
+							 afi_t afi);
 
 /*
  * API to associate a VRF with a NETNS.
@@ -63,6 +63,8 @@
 #include "zebra/zebra_script.h"
 #include "zebra/rtadv.h"
 #include "zebra/zebra_neigh.h"
+#include "zebra/zebra_latency.h"
+#include "zebra/zebra_rib_export.h"
 
 /* context to manage dumps in multiple tables or vrfs */
 struct route_show_ctx {
@@ -1183,6 +1185,119 @@ static void vty_show_ip_route_detail_json(struct vty *vty,
 	vty_json(vty, json);
 }
 
+/* Filters and output state of one table dump */
+struct route_show_walk {
+	/* the table, looked up again each time a paused walk resumes */
+	vrf_id_t vrf_id;
+	afi_t afi;
+	safi_t safi;
+	uint32_t tableid;
+
+	bool use_fib;
+	route_tag_t tag;
+	const struct prefix *longer_prefix_p;
+	struct prefix longer_prefix;
+	bool supernets_only;
+	int type;
+	unsigned short ospf_instance_id;
+	bool use_json;
+	bool show_ng;
+
+	struct route_show_ctx *ctx;
+	struct route_show_ctx walk_ctx;
+	bool first;
+	bool json_first;
+
+	/* last destination shown before pausing */
+	bool started;
+	struct prefix last;
+};
+
+/* Number of route nodes shown per step of a paused walk */
+#define ROUTE_SHOW_WALK_NODES 500
+
+DEFINE_MTYPE_STATIC(ZEBRA, ROUTE_SHOW_WALK, "Route show walk");
+
+static void route_show_node(struct vty *vty, struct route_show_walk *w,
+			    struct zebra_vrf *zvrf, struct route_node *rn)
+{
+	struct route_show_ctx *ctx = w->ctx;
+	struct route_entry *re;
+	rib_dest_t *dest;
+	json_object *json_prefix = NULL;
+	uint32_t addr;
+	char buf[BUFSIZ];
+
+	dest = rib_dest_from_rnode(rn);
+
+	RNODE_FOREACH_RE (rn, re) {
+		if (w->use_fib && re != dest->selected_fib)
+			continue;
+
+		if (w->tag && re->tag != w->tag)
+			continue;
+
+		if (w->longer_prefix_p
+		    && !prefix_match(w->longer_prefix_p, &rn->p))
+			continue;
+
+		/* This can only be true when the afi is IPv4 */
+		if (w->supernets_only) {
+			addr = ntohl(rn->p.u.prefix4.s_addr);
+
+			if (IN_CLASSC(addr) && rn->p.prefixlen >= 24)
+				continue;
+
+			if (IN_CLASSB(addr) && rn->p.prefixlen >= 16)
+				continue;
+
+			if (IN_CLASSA(addr) && rn->p.prefixlen >= 8)
+				continue;
+		}
+
+		if (w->type && re->type != w->type)
+			continue;
+
+		if (w->ospf_instance_id
+		    && (re->type != ZEBRA_ROUTE_OSPF
+			|| re->instance != w->ospf_instance_id))
+			continue;
+
+		if (w->use_json) {
+			if (!json_prefix)
+				json_prefix = json_object_new_array();
+		} else if (w->first) {
+			if (!ctx->header_done) {
+				if (w->afi == AFI_IP)
+					vty_out(vty, SHOW_ROUTE_V4_HEADER);
+				else
+					vty_out(vty, SHOW_ROUTE_V6_HEADER);
+			}
+			if (ctx->multi && ctx->header_done)
+				vty_out(vty, "\n");
+			if (ctx->multi || zvrf_id(zvrf) != VRF_DEFAULT
+			    || w->tableid) {
+				if (!w->tableid)
+					vty_out(vty, "VRF %s:\n",
+						zvrf_name(zvrf));
+				else
+					vty_out(vty, "VRF %s table %u:\n",
+						zvrf_name(zvrf), w->tableid);
+			}
+			ctx->header_done = true;
+			w->first = false;
+		}
+
+		vty_show_ip_route(vty, rn, re, json_prefix, w->use_fib,
+				  w->show_ng);
+	}
+
+	if (json_prefix) {
+		prefix2str(&rn->p, buf, sizeof(buf));
+		vty_json_stream_add(vty, &w->json_first, buf, json_prefix);
+	}
+}
+
 static void do_show_route_helper(struct vty *vty, struct zebra_vrf *zvrf,
 				 struct route_table *table, afi_t afi,
 				 bool use_fib, route_tag_t tag,
@@ -1193,13 +1308,21 @@ static void do_show_route_helper(struct vty *vty, struct zebra_vrf *zvrf,
 				 struct route_show_ctx *ctx)
 {
 	struct route_node *rn;
-	struct route_entry *re;
-	int first = 1;
-	rib_dest_t *dest;
-	json_object *json = NULL;
-	json_object *json_prefix = NULL;
-	uint32_t addr;
-	char buf[BUFSIZ];
+	struct route_show_walk w = {
+		.afi = afi,
+		.tableid = tableid,
+		.use_fib = use_fib,
+		.tag = tag,
+		.longer_prefix_p = longer_prefix_p,
+		.supernets_only = supernets_only,
+		.type = type,
+		.ospf_instance_id = ospf_instance_id,
+		.use_json = use_json,
+		.show_ng = show_ng,
+		.ctx = ctx,
+		.first = true,
+		.json_first = true,
+	};
 
 	/*
 	 * ctx->multi indicates if we are dumping multiple tables or vrfs.
@@ -1212,88 +1335,86 @@ static void do_show_route_helper(struct vty *vty, struct zebra_vrf *zvrf,
 	 *   => display the VRF and table if specific
 	 */
 
+	/*
+	 * A full table is too big to build as a single json object, each
+	 * prefix is printed as soon as its routes have been walked.
+	 */
 	if (use_json)
-		json = json_object_new_object();
+		vty_json_stream_start(vty);
 
 	/* Show all routes. */
-	for (rn = route_top(table); rn; rn = srcdest_route_next(rn)) {
-		dest = rib_dest_from_rnode(rn);
-
-		RNODE_FOREACH_RE (rn, re) {
-			if (use_fib && re != dest->selected_fib)
-				continue;
-
-			if (tag && re->tag != tag)
-				continue;
-
-			if (longer_prefix_p
-			    && !prefix_match(longer_prefix_p, &rn->p))
-				continue;
-
-			/* This can only be true when the afi is IPv4 */
-			if (supernets_only) {
-				addr = ntohl(rn->p.u.prefix4.s_addr);
+	for (rn = route_top(table); rn; rn = srcdest_route_next(rn))
+		route_show_node(vty, &w, zvrf, rn);
 
-				if (IN_CLASSC(addr) && rn->p.prefixlen >= 24)
-					continue;
+	if (use_json)
+		vty_json_stream_end(vty, w.json_first);
+}
 
-				if (IN_CLASSB(addr) && rn->p.prefixlen >= 16)
-					continue;
+static struct route_table *route_show_walk_table(struct route_show_walk *w,
+						 struct zebra_vrf **zvrfp)
+{
+	struct zebra_vrf *zvrf;
 
-				if (IN_CLASSA(addr) && rn->p.prefixlen >= 8)
-					continue;
-			}
+	*zvrfp = zvrf = zebra_vrf_lookup_by_id(w->vrf_id);
+	if (!zvrf)
+		return NULL;
 
-			if (type && re->type != type)
-				continue;
+	if (w->tableid)
+		return zebra_router_find_table(zvrf, w->tableid, w->afi,
+					       SAFI_UNICAST);
+	return zebra_vrf_table(w->afi, w->safi, w->vrf_id);
+}
 
-			if (ospf_instance_id
-			    && (re->type != ZEBRA_ROUTE_OSPF
-				|| re->instance != ospf_instance_id))
-				continue;
+/*
+ * One step of a single table dump run with vty_walk().  Nothing is held
+ * between steps: the table is looked up again and the walk continues
+ * after the last destination shown.  Steps only end on a destination,
+ * never between the source prefixes of a src-dest route.
+ */
+static bool route_show_walk_step(struct vty *vty, void *arg)
+{
+	struct route_show_walk *w = arg;
+	struct zebra_vrf *zvrf;
+	struct route_table *table;
+	struct route_node *rn;
+	unsigned int count = 0;
 
-			if (use_json) {
-				if (!json_prefix)
-					json_prefix = json_object_new_array();
-			} else if (first) {
-				if (!ctx->header_done) {
-					if (afi == AFI_IP)
-						vty_out(vty,
-							SHOW_ROUTE_V4_HEADER);
-					else
-						vty_out(vty,
-							SHOW_ROUTE_V6_HEADER);
-				}
-				if (ctx->multi && ctx->header_done)
-					vty_out(vty, "\n");
-				if (ctx->multi || zvrf_id(zvrf) != VRF_DEFAULT
-				    || tableid) {
-					if (!tableid)
-						vty_out(vty, "VRF %s:\n",
-							zvrf_name(zvrf));
-					else
-						vty_out(vty,
-							"VRF %s table %u:\n",
-							zvrf_name(zvrf),
-							tableid);
-				}
-				ctx->header_done = true;
-				first = 0;
+	table = route_show_walk_table(w, &zvrf);
+	if (!table) {
+		rn = NULL;
+	} else if (!w->started) {
+		w->started = true;
+		if (w->use_json)
+			vty_json_stream_start(vty);
+		rn = route_top(table);
+	} else
+		rn = route_table_get_next(table, &w->last);
+
+	for (; rn; rn = srcdest_route_next(rn)) {
+		if (!rnode_is_srcnode(rn)) {
+			if (count >= ROUTE_SHOW_WALK_NODES) {
+				route_unlock_node(rn);
+				return false;
 			}
-
-			vty_show_ip_route(vty, rn, re, json_prefix, use_fib,
-					  show_ng);
+			prefix_copy(&w->last, &rn->p);
 		}
 
-		if (json_prefix) {
-			prefix2str(&rn->p, buf, sizeof(buf));
-			json_object_object_add(json, buf, json_prefix);
-			json_prefix = NULL;
-		}
+		route_show_node(vty, w, zvrf, rn);
+		count++;
 	}
 
-	if (use_json)
-		vty_json(vty, json);
+	if (w->use_json) {
+		if (w->started)
+			vty_json_stream_end(vty, w->json_first);
+		else
+			vty_out(vty, "{}\n");
+	}
+	return true;
+}
+
+static void route_show_walk_free(void *arg)
+{
+	XFREE(MTYPE_ROUTE_SHOW_WALK, arg);
 }
 
 static void do_show_ip_route_all(struct vty *vty, struct zebra_vrf *zvrf,
@@ -1361,6 +1482,35 @@ static int do_show_ip_route(struct vty *vty, const char *vrf_name, afi_t afi,
 		return CMD_SUCCESS;
 	}
 
+	if (!ctx->multi) {
+		struct route_show_walk *w;
+
+		/* a single table can be shown in steps, see vty_walk() */
+		w = XCALLOC(MTYPE_ROUTE_SHOW_WALK, sizeof(*w));
+		w->vrf_id = zvrf_id(zvrf);
+		w->afi = afi;
+		w->safi = safi;
+		w->tableid = tableid;
+		w->use_fib = use_fib;
+		w->tag = tag;
+		if (longer_prefix_p) {
+			prefix_copy(&w->longer_prefix, longer_prefix_p);
+			w->longer_prefix_p = &w->longer_prefix;
+		}
+		w->supernets_only = supernets_only;
+		w->type = type;
+		w->ospf_instance_id = ospf_instance_id;
+		w->use_json = use_json;
+		w->show_ng = show_ng;
+		w->walk_ctx = *ctx;
+		w->ctx = &w->walk_ctx;
+		w->first = true;
+		w->json_first = true;
+
+		return vty_walk(vty, route_show_walk_step, w,
+				route_show_walk_free);
+	}
+
 	do_show_route_helper(vty, zvrf, table, afi, use_fib, tag,
 			     longer_prefix_p, supernets_only, type,
 			     ospf_instance_id, use_json, tableid, show_ng, ctx);
@@ -2171,11 +2321,12 @@ DEFPY (show_route,
 					     !!supernets_only, type,
 					     ospf_instance_id, !!ng, &ctx);
 		else
-			do_show_ip_route(vty, vrf->name, afi, SAFI_UNICAST,
-					 !!fib, !!json, tag,
-					 prefix_str ? prefix : NULL,
-					 !!supernets_only, type,
-					 ospf_instance_id, table, !!ng, &ctx);
+			return do_show_ip_route(vty, vrf->name, afi,
+						SAFI_UNICAST, !!fib, !!json,
+						tag, prefix_str ? prefix : NULL,
+						!!supernets_only, type,
+						ospf_instance_id, table, !!ng,
+						&ctx);
 	}
 
 	return CMD_SUCCESS;
@@ -4145,6 +4296,25 @@ DEFPY (zebra_nexthop_group_keep,
 	return CMD_SUCCESS;
 }
 
+DEFPY (zebra_interface_statistics,
+       zebra_interface_statistics_cmd,
+       "[no] zebra interface-statistics interval (0-3600)",
+       NO_STR
+       ZEBRA_STR
+       "Interface counters\n"
+       "How often to refresh them\n"
+       "Time in seconds, 0 to not collect them\n")
+{
+	if (no)
+		zrouter.ifstats_interval = ZEBRA_DEFAULT_IFSTATS_INTERVAL;
+	else
+		zrouter.ifstats_interval = interval;
+
+	zebra_if_stats_timer_set();
+
+	return CMD_SUCCESS;
+}
+
 static int config_write_protocol(struct vty *vty)
 {
 	if (zrouter.allow_delete)
@@ -4153,6 +4323,10 @@ static int config_write_protocol(struct vty *vty)
 	if (zrouter.nhg_keep != ZEBRA_DEFAULT_NHG_KEEP_TIMER)
 		vty_out(vty, "zebra nexthop-group keep %u\n", zrouter.nhg_keep);
 
+	if (zrouter.ifstats_interval != ZEBRA_DEFAULT_IFSTATS_INTERVAL)
+		vty_out(vty, "zebra interface-statistics interval %u\n",
+			zrouter.ifstats_interval);
+
 	if (zrouter.ribq->spec.hold != ZEBRA_RIB_PROCESS_HOLD_TIME)
 		vty_out(vty, "zebra work-queue %u\n", zrouter.ribq->spec.hold);
 
@@ -4160,6 +4334,9 @@ static int config_write_protocol(struct vty *vty)
 		vty_out(vty, "zebra zapi-packets %u\n",
 			zrouter.packets_to_process);
 
+	zebra_route_latency_config_write(vty);
+	zebra_rib_export_config_write(vty);
+
 	enum multicast_mode ipv4_multicast_mode = multicast_mode_ipv4_get();
 
 	if (ipv4_multicast_mode != MCAST_NO_CONFIG)
@@ -4207,6 +4384,17 @@ static int config_write_protocol(struct vty *vty)
 	return 1;
 }
 
+DEFUN (show_zebra_meta_queue,
+       show_zebra_meta_queue_cmd,
+       "show zebra meta-queue",
+       SHOW_STR
+       ZEBRA_STR
+       "Route processing queue\n")
+{
+	meta_queue_show(vty, zrouter.mq);
+	return CMD_SUCCESS;
+}
+
 DEFUN (show_zebra,
        show_zebra_cmd,
        "show zebra",
@@ -4749,6 +4937,7 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &ip_forwarding_cmd);
 	install_element(CONFIG_NODE, &no_ip_forwarding_cmd);
 	install_element(ENABLE_NODE, &show_zebra_cmd);
+	install_element(ENABLE_NODE, &show_zebra_meta_queue_cmd);
 
 	install_element(VIEW_NODE, &show_ipv6_forwarding_cmd);
 	install_element(CONFIG_NODE, &ipv6_forwarding_cmd);
@@ -4767,6 +4956,7 @@ void zebra_vty_init(void)
 	install_element(CONFIG_NODE, &no_ip_multicast_mode_cmd);
 
 	install_element(CONFIG_NODE, &zebra_nexthop_group_keep_cmd);
+	install_element(CONFIG_NODE, &zebra_interface_statistics_cmd);
 	install_element(CONFIG_NODE, &ip_zebra_import_table_distance_cmd);
 	install_element(CONFIG_NODE, &no_ip_zebra_import_table_cmd);
 	install_element(CONFIG_NODE, &zebra_workqueue_timer_cmd);
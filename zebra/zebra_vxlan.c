@@ -3106,7 +3106,6 @@ int zebra_vxlan_clear_dup_detect_vni_mac(struct zebra_vrf *zvrf, vni_t vni,
 {
 	struct zebra_evpn *zevpn;
 	struct zebra_mac *mac;
-	struct listnode *node = NULL;
 	struct zebra_neigh *nbr = NULL;
 
 	if (!is_evpn_enabled())
@@ -3132,7 +3131,7 @@ int zebra_vxlan_clear_dup_detect_vni_mac(struct zebra_vrf *zvrf, vni_t vni,
 	}
 
 	/* Remove all IPs as duplicate associcated with this MAC */
-	for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, nbr)) {
+	frr_each (zebra_mac_neigh, &mac->neigh_list, nbr) {
 		/* For local neigh mark inactive so MACIP update is generated
 		 * to BGP. This is a scenario where MAC update received
 		 * and detected as duplicate which marked neigh as duplicate.
@@ -3260,7 +3259,6 @@ static void zevpn_clear_dup_mac_hash(struct hash_bucket *bucket, void *ctxt)
 	struct mac_walk_ctx *wctx = ctxt;
 	struct zebra_mac *mac;
 	struct zebra_evpn *zevpn;
-	struct listnode *node = NULL;
 	struct zebra_neigh *nbr = NULL;
 
 	mac = (struct zebra_mac *)bucket->data;
@@ -3280,7 +3278,7 @@ static void zevpn_clear_dup_mac_hash(struct hash_bucket *bucket, void *ctxt)
 	THREAD_OFF(mac->dad_mac_auto_recovery_timer);
 
 	/* Remove all IPs as duplicate associcated with this MAC */
-	for (ALL_LIST_ELEMENTS_RO(mac->neigh_list, node, nbr)) {
+	frr_each (zebra_mac_neigh, &mac->neigh_list, nbr) {
 		if (CHECK_FLAG(nbr->flags, ZEBRA_NEIGH_LOCAL)
 		    && nbr->dad_count)
 			ZEBRA_NEIGH_SET_INACTIVE(nbr);
@@ -4026,7 +4024,7 @@ static int zebra_vxlan_check_del_local_mac(struct interface *ifp,
 	 * If there are no neigh associated with the mac delete the mac
 	 * else mark it as AUTO for forward reference
 	 */
-	if (!listcount(mac->neigh_list)) {
+	if (!zebra_mac_neigh_count(&mac->neigh_list)) {
 		zebra_evpn_mac_del(zevpn, mac);
 	} else {
 		zebra_evpn_mac_clear_fwd_info(mac);
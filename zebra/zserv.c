@@ -81,6 +81,9 @@ static struct zserv *find_client_internal(uint8_t proto,
 /* Mem type for zclients. */
 DEFINE_MTYPE_STATIC(ZEBRA, ZSERV_CLIENT, "ZClients");
 
+/* Size of a client's input queue, in multiples of packets_to_process */
+#define ZSERV_IBUF_RING_BATCHES 4
+
 /*
  * Client thread events.
  *
@@ -296,6 +299,29 @@ zwrite_fail:
 	zserv_client_fail(client);
 }
 
+/*
+ * Move the messages read from the socket onto the input queue.  Returns
+ * false if the queue is full; the rest stays pending and the main pthread
+ * schedules zserv_read() again once it has made room.
+ */
+static bool zserv_ibuf_publish(struct zserv *client)
+{
+	struct stream *msg;
+
+	while ((msg = stream_fifo_head(client->ibuf_pending))) {
+		if (!atomring_push(client->ibuf_ring, msg)) {
+			atomic_store_explicit(&client->ibuf_blocked, true,
+					      memory_order_seq_cst);
+			/* the queue may have been drained in the meantime */
+			if (!atomring_push(client->ibuf_ring, msg))
+				return false;
+		}
+		stream_fifo_pop(client->ibuf_pending);
+	}
+
+	return true;
+}
+
 /*
  * Read and process data from a client socket.
  *
@@ -304,71 +330,61 @@ zwrite_fail:
  * onto the input queue and then notify the main thread that there is new data
  * available.
  *
- * This function first looks for any data in the client structure's working
- * input buffer. If data is present, it is assumed that reading stopped in a
- * previous invocation of this task and needs to be resumed to finish a message.
- * Otherwise, the socket data stream is assumed to be at the beginning of a new
- * ZAPI message (specifically at the header). The header is read and validated.
- * If the header passed validation then the length field found in the header is
- * used to compute the total length of the message. That much data is read (but
- * not inspected), appended to the header, placed into a stream and pushed onto
- * the client's input queue. A task is then scheduled on the main thread to
- * process the client's input queue. Finally, if all of this was successful,
- * this task reschedules itself.
+ * Socket data is read in chunks as large as the client structure's working
+ * input buffer allows, so that a burst of small messages costs one read() per
+ * buffer rather than two per message. Complete ZAPI messages are then carved
+ * out of the working buffer: each header is validated and the length field
+ * found in it is used to copy that much data into a stream, which is pushed
+ * onto the client's input queue. A trailing partial message is kept at the
+ * start of the working buffer for the next read. A task is then scheduled on
+ * the main thread to process the client's input queue. Finally, if all of
+ * this was successful, this task reschedules itself; if it stopped with
+ * complete messages still buffered, it runs again without waiting on the
+ * socket.
  *
  * Any failure in any of these actions is handled by terminating the client.
  */
 static void zserv_read(struct thread *thread)
 {
 	struct zserv *client = THREAD_ARG(thread);
+	struct stream *ibuf = client->ibuf_work;
 	int sock;
-	size_t already;
-	struct stream_fifo *cache;
+	size_t start;
+	struct stream_fifo *cache = client->ibuf_pending;
 	uint32_t p2p_orig;
 
 	uint32_t p2p;
 	struct zmsghdr hdr;
+	bool blocked = false;
+
+	/* still waiting for room on the input queue */
+	if (!zserv_ibuf_publish(client))
+		return;
 
 	p2p_orig = atomic_load_explicit(&zrouter.packets_to_process,
 					memory_order_relaxed);
-	cache = stream_fifo_new();
 	p2p = p2p_orig;
-	sock = THREAD_FD(thread);
+	sock = client->sock;
 
 	while (p2p) {
 		ssize_t nb;
 		bool hdrvalid;
 		char errmsg[256];
-
-		already = stream_get_endp(client->ibuf_work);
+		struct stream *msg;
 
 		/* Read length and command (if we don't have it already). */
-		if (already < ZEBRA_HEADER_SIZE) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     ZEBRA_HEADER_SIZE - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug("connection closed socket [%d]",
-						   sock);
-				goto zread_fail;
-			}
-			if (nb != (ssize_t)(ZEBRA_HEADER_SIZE - already)) {
-				/* Try again later. */
-				break;
-			}
-			already = ZEBRA_HEADER_SIZE;
-		}
-
-		/* Reset to read from the beginning of the incoming packet. */
-		stream_set_getp(client->ibuf_work, 0);
+		if (STREAM_READABLE(ibuf) < ZEBRA_HEADER_SIZE)
+			goto zread_more;
 
 		/* Fetch header values */
-		hdrvalid = zapi_parse_header(client->ibuf_work, &hdr);
+		start = stream_get_getp(ibuf);
+		hdrvalid = zapi_parse_header(ibuf, &hdr);
+		stream_set_getp(ibuf, start);
 
 		if (!hdrvalid) {
 			snprintf(errmsg, sizeof(errmsg),
 				 "%s: Message has corrupt header", __func__);
-			zserv_log_message(errmsg, client->ibuf_work, NULL);
+			zserv_log_message(errmsg, ibuf, NULL);
 			goto zread_fail;
 		}
 
@@ -379,7 +395,7 @@ static void zserv_read(struct thread *thread)
 				errmsg, sizeof(errmsg),
 				"Message has corrupt header\n%s: socket %d version mismatch, marker %d, version %d",
 				__func__, sock, hdr.marker, hdr.version);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
+			zserv_log_message(errmsg, ibuf, &hdr);
 			goto zread_fail;
 		}
 		if (hdr.length < ZEBRA_HEADER_SIZE) {
@@ -387,35 +403,22 @@ static void zserv_read(struct thread *thread)
 				errmsg, sizeof(errmsg),
 				"Message has corrupt header\n%s: socket %d message length %u is less than header size %d",
 				__func__, sock, hdr.length, ZEBRA_HEADER_SIZE);
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
+			zserv_log_message(errmsg, ibuf, &hdr);
 			goto zread_fail;
 		}
-		if (hdr.length > STREAM_SIZE(client->ibuf_work)) {
+		if (hdr.length > STREAM_SIZE(ibuf)) {
 			snprintf(
 				errmsg, sizeof(errmsg),
 				"Message has corrupt header\n%s: socket %d message length %u exceeds buffer size %lu",
 				__func__, sock, hdr.length,
-				(unsigned long)STREAM_SIZE(client->ibuf_work));
-			zserv_log_message(errmsg, client->ibuf_work, &hdr);
+				(unsigned long)STREAM_SIZE(ibuf));
+			zserv_log_message(errmsg, ibuf, &hdr);
 			goto zread_fail;
 		}
 
 		/* Read rest of data. */
-		if (already < hdr.length) {
-			nb = stream_read_try(client->ibuf_work, sock,
-					     hdr.length - already);
-			if ((nb == 0 || nb == -1)) {
-				if (IS_ZEBRA_DEBUG_EVENT)
-					zlog_debug(
-						   "connection closed [%d] when reading zebra data",
-						   sock);
-				goto zread_fail;
-			}
-			if (nb != (ssize_t)(hdr.length - already)) {
-				/* Try again later. */
-				break;
-			}
-		}
+		if (STREAM_READABLE(ibuf) < hdr.length)
+			goto zread_more;
 
 		/* Debug packet information. */
 		if (IS_ZEBRA_DEBUG_PACKET)
@@ -424,12 +427,28 @@ static void zserv_read(struct thread *thread)
 				   hdr.vrf_id, hdr.length,
 				   sock);
 
-		stream_set_getp(client->ibuf_work, 0);
-		struct stream *msg = stream_dup(client->ibuf_work);
+		msg = stream_new(hdr.length);
+		stream_put(msg, stream_pnt(ibuf), hdr.length);
+		stream_forward_getp(ibuf, hdr.length);
 
 		stream_fifo_push(cache, msg);
-		stream_reset(client->ibuf_work);
 		p2p--;
+		continue;
+
+	zread_more:
+		/* Make room behind the partial message and fill it all */
+		stream_pulldown(ibuf);
+		nb = stream_read_try(ibuf, sock, STREAM_WRITEABLE(ibuf));
+		if (nb == -2) {
+			/* Try again later. */
+			break;
+		}
+		if (nb == 0 || nb == -1) {
+			if (IS_ZEBRA_DEBUG_EVENT)
+				zlog_debug("connection closed socket [%d]",
+					   sock);
+			goto zread_fail;
+		}
 	}
 
 	if (p2p < p2p_orig) {
@@ -440,11 +459,7 @@ static void zserv_read(struct thread *thread)
 				      memory_order_relaxed);
 
 		/* publish read packets on client's input queue */
-		frr_with_mutex (&client->ibuf_mtx) {
-			while (cache->head)
-				stream_fifo_push(client->ibuf_fifo,
-						 stream_fifo_pop(cache));
-		}
+		blocked = !zserv_ibuf_publish(client);
 
 		/* Schedule job to process those packets */
 		zserv_event(client, ZSERV_PROCESS_MESSAGES);
@@ -455,15 +470,21 @@ static void zserv_read(struct thread *thread)
 		zlog_debug("Read %d packets from client: %s", p2p_orig - p2p,
 			   zebra_route_string(client->proto));
 
-	/* Reschedule ourselves */
-	zserv_client_event(client, ZSERV_CLIENT_READ);
-
-	stream_fifo_free(cache);
+	/*
+	 * Reschedule ourselves. Messages left in the working buffer may
+	 * already be complete, the socket would not signal those.
+	 */
+	if (blocked)
+		return;
+	if (!p2p && STREAM_READABLE(ibuf))
+		thread_add_event(client->pthread->master, zserv_read, client,
+				 0, &client->t_read);
+	else
+		zserv_client_event(client, ZSERV_CLIENT_READ);
 
 	return;
 
 zread_fail:
-	stream_fifo_free(cache);
 	zserv_client_fail(client);
 }
 
@@ -508,23 +529,24 @@ static void zserv_process_messages(struct thread *thread)
 	struct stream_fifo *cache = stream_fifo_new();
 	uint32_t p2p = zrouter.packets_to_process;
 	bool need_resched = false;
+	uint32_t i;
 
-	frr_with_mutex (&client->ibuf_mtx) {
-		uint32_t i;
-		for (i = 0; i < p2p && stream_fifo_head(client->ibuf_fifo);
-		     ++i) {
-			msg = stream_fifo_pop(client->ibuf_fifo);
-			stream_fifo_push(cache, msg);
-		}
+	for (i = 0; i < p2p && (msg = atomring_pop(client->ibuf_ring)); ++i)
+		stream_fifo_push(cache, msg);
 
-		msg = NULL;
+	msg = NULL;
 
-		/* Need to reschedule processing work if there are still
-		 * packets in the fifo.
-		 */
-		if (stream_fifo_head(client->ibuf_fifo))
-			need_resched = true;
-	}
+	/* Need to reschedule processing work if there are still
+	 * packets in the queue.
+	 */
+	if (atomring_count(client->ibuf_ring))
+		need_resched = true;
+
+	/* the client pthread stopped reading because the queue was full */
+	if (i && atomic_exchange_explicit(&client->ibuf_blocked, false,
+					  memory_order_seq_cst))
+		thread_add_event(client->pthread->master, zserv_read, client,
+				 0, &client->t_read);
 
 	/* Process the batch of messages */
 	if (stream_fifo_head(cache))
@@ -623,8 +645,15 @@ static void zserv_client_free(struct zserv *client)
 		stream_free(client->ibuf_work);
 	if (client->obuf_work)
 		stream_free(client->obuf_work);
-	if (client->ibuf_fifo)
-		stream_fifo_free(client->ibuf_fifo);
+	if (client->ibuf_ring) {
+		struct stream *msg;
+
+		while ((msg = atomring_pop(client->ibuf_ring)))
+			stream_free(msg);
+		atomring_free(&client->ibuf_ring);
+	}
+	if (client->ibuf_pending)
+		stream_fifo_free(client->ibuf_pending);
 	if (client->obuf_fifo)
 		stream_fifo_free(client->obuf_fifo);
 	if (client->wb)
@@ -632,7 +661,6 @@ static void zserv_client_free(struct zserv *client)
 
 	/* Free buffer mutexes */
 	pthread_mutex_destroy(&client->obuf_mtx);
-	pthread_mutex_destroy(&client->ibuf_mtx);
 
 	/* Free bitmaps. */
 	for (afi_t afi = AFI_IP; afi < AFI_MAX; afi++) {
@@ -747,11 +775,12 @@ static struct zserv *zserv_client_create(int sock)
 
 	/* Make client input/output buffer. */
 	client->sock = sock;
-	client->ibuf_fifo = stream_fifo_new();
+	client->ibuf_ring = atomring_new(ZSERV_IBUF_RING_BATCHES
+					 * zrouter.packets_to_process);
+	client->ibuf_pending = stream_fifo_new();
 	client->obuf_fifo = stream_fifo_new();
 	client->ibuf_work = stream_new(stream_size);
 	client->obuf_work = stream_new(stream_size);
-	pthread_mutex_init(&client->ibuf_mtx, NULL);
 	pthread_mutex_init(&client->obuf_mtx, NULL);
 	client->wb = buffer_new(0);
 	TAILQ_INIT(&(client->gr_info_queue));
@@ -1101,9 +1130,10 @@ static void zebra_show_client_detail(struct vty *vty, struct zserv *client)
 	vty_out(vty, "Errors: %u\n", client->error_cnt);
 
 #if defined DEV_BUILD
-	vty_out(vty, "Input Fifo: %zu:%zu Output Fifo: %zu:%zu\n",
-		client->ibuf_fifo->count, client->ibuf_fifo->max_count,
-		client->obuf_fifo->count, client->obuf_fifo->max_count);
+	vty_out(vty, "Input Queue: %zu:%zu Output Fifo: %zu:%zu\n",
+		atomring_count(client->ibuf_ring),
+		atomring_size(client->ibuf_ring), client->obuf_fifo->count,
+		client->obuf_fifo->max_count);
 #endif
 	vty_out(vty, "\n");
 }
@@ -36,6 +36,7 @@
 #include "lib/linklist.h"     /* for list */
 #include "lib/workqueue.h"    /* for work_queue */
 #include "lib/hook.h"         /* for DECLARE_HOOK, DECLARE_KOOH */
+#include "lib/atomring.h"     /* for atomring */
 /* clang-format on */
 
 #ifdef __cplusplus
@@ -104,9 +105,16 @@ struct zserv {
 	int busy_count;
 	bool is_closed;
 
-	/* Input/output buffer to the client. */
-	pthread_mutex_t ibuf_mtx;
-	struct stream_fifo *ibuf_fifo;
+	/*
+	 * Input queue to the main pthread.  When it is full, the client
+	 * pthread keeps what it has read in ibuf_pending, stops reading and
+	 * sets ibuf_blocked for the main pthread to wake it up.
+	 */
+	struct atomring *ibuf_ring;
+	struct stream_fifo *ibuf_pending;
+	atomic_bool ibuf_blocked;
+
+	/* Output buffer to the client. */
 	pthread_mutex_t obuf_mtx;
 	struct stream_fifo *obuf_fifo;
 